@@ -62,6 +62,16 @@ void TFE_OpReset(TFE_Op* op_to_reset, const char* op_or_function_name,
   }
 }
 
+void TFE_OpPrepare(TFE_Op* op, TF_Status* status) {
+  status->status = tensorflow::unwrap(op)->Prepare();
+}
+
+void TFE_OpSetFlatInput(TFE_Op* op, int index, TFE_TensorHandle* input,
+                        TF_Status* status) {
+  status->status =
+      tensorflow::unwrap(op)->SetInput(index, tensorflow::unwrap(input));
+}
+
 void TFE_ContextEnableGraphCollection(TFE_Context* ctx) {
   tensorflow::unwrap(ctx)->SetShouldStoreGraphs(true);
 }
@@ -35,6 +35,20 @@ TF_CAPI_EXPORT extern void TFE_OpReset(TFE_Op* op_to_reset,
                                        const char* raw_device_name,
                                        TF_Status* status);
 
+// Prepares the primitive operation `op` for repeated execution. The kernel
+// picked when `op` is next executed is kept with it, and later calls to
+// TFE_Execute on `op` reuse that kernel without selecting a device or looking
+// up the kernel cache, as long as its attributes, its device and the dtypes
+// and devices of its inputs stay the same. Change the inputs between
+// executions with TFE_OpSetFlatInput. TFE_OpReset drops the kept kernel.
+TF_CAPI_EXPORT extern void TFE_OpPrepare(TFE_Op* op, TF_Status* status);
+
+// Replaces the `index`-th flat input of `op` (see TFE_OpGetFlatInput) with
+// `input`.
+TF_CAPI_EXPORT extern void TFE_OpSetFlatInput(TFE_Op* op, int index,
+                                              TFE_TensorHandle* input,
+                                              TF_Status* status);
+
 // Enables only graph collection in RunMetadata on the functions executed from
 // this context.
 TF_CAPI_EXPORT extern void TFE_ContextEnableGraphCollection(TFE_Context* ctx);
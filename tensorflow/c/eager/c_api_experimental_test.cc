@@ -18,6 +18,8 @@ limitations under the License.
 #include <string.h>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/c/eager/c_api.h"
 #include "tensorflow/c/eager/c_api_internal.h"
@@ -402,6 +404,56 @@ void Executor_MatMul_CPU(bool async) {
 TEST(CAPI, Executor_MatMul_CPU) { Executor_MatMul_CPU(false); }
 TEST(CAPI, Executor_MatMul_CPUAsync) { Executor_MatMul_CPU(true); }
 
+TEST(CAPI, PreparedOp) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  TFE_OpPrepare(matmul, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  float data[] = {1.0f, 0.0f, 0.0f, 2.0f};
+  int64_t dims[] = {2, 2};
+  TFE_TensorHandle* d = TestMatrixTensorHandleWithInput(ctx, data, dims, 2);
+  // The first execution picks the kernel, the others reuse it with new inputs.
+  std::vector<std::vector<float>> expected = {
+      {7, 10, 15, 22}, {1, 0, 0, 4}, {1, 4, 3, 8}};
+  std::vector<std::pair<TFE_TensorHandle*, TFE_TensorHandle*>> inputs = {
+      {m, m}, {d, d}, {d, m}};
+  for (int i = 0; i < inputs.size(); ++i) {
+    TFE_OpSetFlatInput(matmul, 0, inputs[i].first, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpSetFlatInput(matmul, 1, inputs[i].second, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_TensorHandle* retval = nullptr;
+    int num_retvals = 1;
+    TFE_Execute(matmul, &retval, &num_retvals, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    ASSERT_EQ(1, num_retvals);
+    TF_Tensor* t = TFE_TensorHandleResolve(retval, status);
+    ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(retval);
+    float product[4] = {0};
+    EXPECT_EQ(sizeof(product), TF_TensorByteSize(t));
+    memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+    TF_DeleteTensor(t);
+    EXPECT_EQ(expected[i], std::vector<float>(product, product + 4));
+  }
+
+  TFE_OpSetFlatInput(matmul, 2, m, status);
+  EXPECT_EQ(TF_INVALID_ARGUMENT, TF_GetCode(status)) << TF_Message(status);
+
+  TFE_DeleteOp(matmul);
+  TFE_DeleteTensorHandle(d);
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 void Deleter(void* data, size_t unused, void* tensor_handle) {
   TFE_DeleteTensorHandle(static_cast<TFE_TensorHandle*>(tensor_handle));
 }
@@ -74,6 +74,11 @@ class ImmediateExecutionOperation : public AbstractOperation {
 
   virtual void SetStepId(int64_t step_id) = 0;
 
+  // Prepares this op for repeated execution with inputs of the same dtypes on
+  // the same devices, letting the implementation keep the kernel picked by the
+  // next execution.
+  virtual Status Prepare() = 0;
+
   // For LLVM style RTTI.
   static bool classof(const AbstractOperation* ptr) {
     return ptr->getKind() == kEager || ptr->getKind() == kTfrt;
@@ -77,6 +77,21 @@ inline constexpr char kObjectGraphProtoKey[] = "_CHECKPOINTABLE_OBJECT_GRAPH";
 // Filename for the FingerprintDef protocol buffer.
 inline constexpr char kFingerprintFilenamePb[] = "fingerprint.pb";
 
+// Filename, in the assets.extra directory, of an optional KernelCostStats
+// protocol buffer used to warm start the kernel cost estimates of the session.
+inline constexpr char kKernelCostStatsFilenamePb[] = "kernel_cost_stats.pb";
+
+// Filename, in the assets.extra directory, of an optional
+// OptimizedGraphCacheDef protocol buffer with graphs already optimized by
+// Grappler for the session.
+inline constexpr char kOptimizedGraphCacheFilenamePb[] =
+    "optimized_graph_cache.pb";
+
+// Filename, in the assets.extra directory, of an optional memmapped package
+// with the constants read by the ImmutableConst nodes of the graphs.
+inline constexpr char kSavedModelMemmappedPackageFilename[] =
+    "saved_model.mmap";
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CC_SAVED_MODEL_CONSTANTS_H_
@@ -15,14 +15,22 @@ limitations under the License.
 
 #include "tensorflow/cc/saved_model/loader.h"
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/fingerprinting.h"
 #include "tensorflow/cc/saved_model/loader_util.h"
+#include "tensorflow/cc/saved_model/memmapped_package.h"
 #include "tensorflow/cc/saved_model/metrics.h"
 #include "tensorflow/cc/saved_model/reader.h"
 #include "tensorflow/cc/saved_model/util.h"
@@ -31,21 +39,27 @@ limitations under the License.
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system_helper.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/protobuf/fingerprint.pb.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -265,6 +279,110 @@ Status RunRestore(const RunOptions& run_options, const string& export_dir,
                  nullptr /* outputs */, &run_metadata, session);
 }
 
+// Runs the init op of `meta_graph`, once its variables are restored, and
+// records the wall time spent in both stages.
+Status InitializeSession(const RunOptions& run_options,
+                         const MetaGraphDef& meta_graph,
+                         const string& export_dir,
+                         const std::vector<AssetFileDef>& asset_file_defs,
+                         const uint64 restore_graph_walltime,
+                         Session* session) {
+  const uint64 graph_init_start_microseconds = Env::Default()->NowMicros();
+  string init_op_name;
+  TF_RETURN_IF_ERROR(
+      internal::GetInitOp(export_dir, meta_graph, &init_op_name));
+  TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, meta_graph,
+                               asset_file_defs, session, init_op_name));
+  load_latency_by_stage->GetCell(export_dir, "restore_graph")
+      ->Add(restore_graph_walltime);
+  // Record wall time spent in init op.
+  load_latency_by_stage->GetCell(export_dir, "init_graph")
+      ->Add(GetLatencyMicroseconds(graph_init_start_microseconds));
+  return OkStatus();
+}
+
+// The upper bound of the bytes of the variables fed to a single run of the
+// restore graph, to bound the memory held by the feeds.
+constexpr int64_t kMaxRestoreBatchBytes = 256 << 20;
+// The default upper bound of the number of threads reading the checkpoint.
+constexpr int kMaxRestoreThreads = 16;
+
+// Returns the node `input` comes from, skipping Identity nodes.
+const NodeDef* GetInputNode(
+    const absl::flat_hash_map<StringPiece, const NodeDef*>& nodes,
+    StringPiece input, int* output_index) {
+  while (true) {
+    const TensorId tensor_id = ParseTensorName(input);
+    auto it = nodes.find(tensor_id.node());
+    if (it == nodes.end()) {
+      return nullptr;
+    }
+    if (it->second->op() != "Identity" || it->second->input_size() < 1) {
+      *output_index = tensor_id.index();
+      return it->second;
+    }
+    input = it->second->input(0);
+  }
+}
+
+// Returns element `index` of the string Const `node`.
+StatusOr<string> GetConstString(const NodeDef* node, int index) {
+  Tensor tensor;
+  if (node == nullptr || node->op() != "Const" ||
+      !node->attr().contains("value") ||
+      !tensor.FromProto(node->attr().at("value").tensor()) ||
+      tensor.dtype() != DT_STRING || index < 0 ||
+      index >= tensor.NumElements()) {
+    return absl::UnimplementedError(
+        "The inputs of the RestoreV2 ops of the restore graph must be string "
+        "constants");
+  }
+  return string(tensor.flat<tstring>()(index));
+}
+
+// Restores `variables` from the checkpoint at `variables_path`, feeding them
+// to their assignments in batches.
+Status RestoreVariablesFromReader(
+    const RunOptions& run_options, const string& variables_path,
+    absl::Span<const SignatureRestorer::Variable* const> variables,
+    Session* session) {
+  BundleReader reader(Env::Default(), variables_path);
+  TF_RETURN_IF_ERROR(reader.status());
+  std::vector<std::pair<string, Tensor>> inputs;
+  std::vector<string> targets;
+  int64_t batch_bytes = 0;
+  // Each batch feeds other tensors, so it runs with RunOnce(), whose callable
+  // is released afterwards, rather than with Session::Run(), which would keep
+  // the executors built for every batch cached in the session.
+  auto run_batch = [&]() -> Status {
+    if (targets.empty()) {
+      return OkStatus();
+    }
+    RunMetadata run_metadata;
+    Status status = RunOnce(run_options, inputs, {}, targets,
+                            nullptr /* outputs */, &run_metadata, session);
+    inputs.clear();
+    targets.clear();
+    batch_bytes = 0;
+    return status;
+  };
+  for (const SignatureRestorer::Variable* variable : variables) {
+    DataType dtype;
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        reader.LookupDtypeAndShape(variable->tensor_key, &dtype, &shape));
+    Tensor tensor(dtype, shape);
+    TF_RETURN_IF_ERROR(reader.Lookup(variable->tensor_key, &tensor));
+    batch_bytes += tensor.TotalBytes();
+    inputs.emplace_back(variable->restored_tensor, std::move(tensor));
+    targets.push_back(variable->assign_node);
+    if (batch_bytes >= kMaxRestoreBatchBytes) {
+      TF_RETURN_IF_ERROR(run_batch());
+    }
+  }
+  return run_batch();
+}
+
 }  // namespace
 
 SavedModelBundleInterface::~SavedModelBundleInterface() {}
@@ -279,26 +397,95 @@ Status LoadMetagraphIntoSession(const SessionOptions& session_options,
   return (*session)->Create(meta_graph.graph_def());
 }
 
+// Restores the variables of the signatures `lazy_signature_keys` with a
+// SignatureRestorer if they are not null, or all the variables otherwise.
+static Status RestoreSessionLazily(
+    const RunOptions& run_options, const MetaGraphDef& meta_graph,
+    const string& export_dir, const std::vector<string>* lazy_signature_keys,
+    std::unique_ptr<Session>* session,
+    std::unique_ptr<SignatureRestorer>* restorer) {
+  if (lazy_signature_keys == nullptr) {
+    return RestoreSession(run_options, meta_graph, export_dir, session);
+  }
+  StatusOr<std::unique_ptr<SignatureRestorer>> signature_restorer =
+      SignatureRestorer::Create(meta_graph, export_dir);
+  if (!signature_restorer.ok()) {
+    LOG(INFO) << "Restoring all the variables of the SavedModel: "
+              << signature_restorer.status();
+    restorer->reset();
+    return RestoreSession(run_options, meta_graph, export_dir, session);
+  }
+  const uint64 read_start_microseconds = Env::Default()->NowMicros();
+  std::vector<AssetFileDef> asset_file_defs;
+  TF_RETURN_IF_ERROR(internal::GetAssetFileDefs(meta_graph, &asset_file_defs));
+  TF_RETURN_IF_ERROR((*signature_restorer)
+                         ->Restore(run_options, *lazy_signature_keys,
+                                   session->get()));
+  const uint64 restore_graph_walltime =
+      GetLatencyMicroseconds(read_start_microseconds);
+  TF_RETURN_IF_ERROR(InitializeSession(run_options, meta_graph, export_dir,
+                                       asset_file_defs, restore_graph_walltime,
+                                       session->get()));
+  *restorer = std::move(*signature_restorer);
+  return OkStatus();
+}
+
 Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
-                              SavedModelBundle* const bundle) {
+                              const std::vector<string>* lazy_signature_keys,
+                              SavedModelBundle* const bundle,
+                              std::unique_ptr<SignatureRestorer>* restorer) {
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
   TF_RETURN_IF_ERROR(
       ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
-  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(
-      session_options, bundle->meta_graph_def, &bundle->session));
-  TF_RETURN_IF_ERROR(RestoreSession(run_options, bundle->meta_graph_def,
-                                    export_dir, &bundle->session));
+  // Kernel cost statistics given in the options take precedence over the ones
+  // stored with the model.
+  SessionOptions options(session_options);
+  if (!options.config.experimental().has_kernel_cost_stats()) {
+    KernelCostStats kernel_cost_stats;
+    TF_RETURN_IF_ERROR(
+        ReadKernelCostStatsIfPresent(export_dir, &kernel_cost_stats));
+    if (kernel_cost_stats.dev_stats_size() > 0) {
+      *options.config.mutable_experimental()->mutable_kernel_cost_stats() =
+          std::move(kernel_cost_stats);
+    }
+  }
+  if (options.config.experimental().optimized_graph_cache_file().empty()) {
+    const string optimized_graph_cache_path =
+        io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                     kOptimizedGraphCacheFilenamePb);
+    if (Env::Default()->FileExists(optimized_graph_cache_path).ok()) {
+      LOG(INFO) << "Reusing the optimized graphs of: "
+                << optimized_graph_cache_path;
+      options.config.mutable_experimental()->set_optimized_graph_cache_file(
+          optimized_graph_cache_path);
+    }
+  }
+  std::unique_ptr<Env> memmapped_env;
+  TF_RETURN_IF_ERROR(saved_model::MaybeCreateMemmappedEnv(
+      export_dir, options.env, &memmapped_env));
+  if (memmapped_env != nullptr) {
+    LOG(INFO) << "Mapping the constants of the SavedModel at " << export_dir;
+    options.env = memmapped_env.get();
+    bundle->env = std::move(memmapped_env);
+  }
+  TF_RETURN_IF_ERROR(LoadMetagraphIntoSession(options, bundle->meta_graph_def,
+                                              &bundle->session));
+  TF_RETURN_IF_ERROR(RestoreSessionLazily(run_options, bundle->meta_graph_def,
+                                          export_dir, lazy_signature_keys,
+                                          &bundle->session, restorer));
   return OkStatus();
 }
 
-Status LoadSavedModel(const SessionOptions& session_options,
-                      const RunOptions& run_options, const string& export_dir,
-                      const std::unordered_set<string>& tags,
-                      SavedModelBundle* const bundle) {
+static Status LoadSavedModelAndRecordMetrics(
+    const SessionOptions& session_options, const RunOptions& run_options,
+    const string& export_dir, const std::unordered_set<string>& tags,
+    const std::vector<string>* lazy_signature_keys,
+    SavedModelBundle* const bundle,
+    std::unique_ptr<SignatureRestorer>* restorer) {
   metrics::SavedModelReadApi(kCCLoadLabel).IncrementBy(1);
   auto fingerprint_proto =
       saved_model::fingerprinting::ReadSavedModelFingerprint(export_dir);
@@ -310,8 +497,9 @@ Status LoadSavedModel(const SessionOptions& session_options,
 
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status =
+      LoadSavedModelInternal(session_options, run_options, export_dir, tags,
+                             lazy_signature_keys, bundle, restorer);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -329,6 +517,28 @@ Status LoadSavedModel(const SessionOptions& session_options,
   return status;
 }
 
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle) {
+  return LoadSavedModelAndRecordMetrics(session_options, run_options,
+                                        export_dir, tags,
+                                        /*lazy_signature_keys=*/nullptr,
+                                        bundle, /*restorer=*/nullptr);
+}
+
+Status LoadSavedModelLazily(const SessionOptions& session_options,
+                            const RunOptions& run_options,
+                            const string& export_dir,
+                            const std::unordered_set<string>& tags,
+                            const std::vector<string>& signature_keys,
+                            SavedModelBundle* const bundle,
+                            std::unique_ptr<SignatureRestorer>* restorer) {
+  return LoadSavedModelAndRecordMetrics(session_options, run_options,
+                                        export_dir, tags, &signature_keys,
+                                        bundle, restorer);
+}
+
 namespace {
 // Session wrapper that prevents calls to Session::Create(), Session::Extend(),
 // and the deprecated partial-run methods.
@@ -338,8 +548,9 @@ namespace {
 // users.
 class LiteSessionWrapper : public Session {
  public:
-  explicit LiteSessionWrapper(std::unique_ptr<Session> wrapped)
-      : wrapped_(std::move(wrapped)) {}
+  LiteSessionWrapper(std::unique_ptr<Session> wrapped,
+                     std::unique_ptr<Env> env)
+      : env_(std::move(env)), wrapped_(std::move(wrapped)) {}
 
   Status Create(const GraphDef& graph) override {
     return absl::UnimplementedError("Session::Create()");
@@ -436,6 +647,8 @@ class LiteSessionWrapper : public Session {
   Status Finalize() override { return wrapped_->Finalize(); }
 
  private:
+  // Outlives `wrapped_`, which may read the memmapped package it serves.
+  const std::unique_ptr<Env> env_;
   const std::unique_ptr<Session> wrapped_;
 };
 }  // namespace
@@ -456,18 +669,298 @@ Status RestoreSession(const RunOptions& run_options,
   // increments until graph init finishes.
   const uint64 restore_graph_walltime =
       GetLatencyMicroseconds(read_start_microseconds);
+  return InitializeSession(run_options, meta_graph, export_dir,
+                           asset_file_defs, restore_graph_walltime,
+                           session->get());
+}
 
-  const uint64 graph_init_start_microseconds = Env::Default()->NowMicros();
-  string init_op_name;
+/*static*/ StatusOr<std::unique_ptr<SignatureRestorer>>
+SignatureRestorer::Create(const MetaGraphDef& meta_graph,
+                          const string& export_dir, int num_threads) {
+  if (!meta_graph.has_saver_def()) {
+    return absl::UnimplementedError("The SavedModel has no Saver");
+  }
+  if (num_threads <= 0) {
+    num_threads = std::min(port::MaxParallelism(), kMaxRestoreThreads);
+  }
+  std::unique_ptr<SignatureRestorer> restorer(new SignatureRestorer(
+      io::JoinPath(export_dir, kSavedModelVariablesDirectory,
+                   kSavedModelVariablesFilename),
+      num_threads));
+
+  const GraphDef& graph_def = meta_graph.graph_def();
+  absl::flat_hash_map<StringPiece, const NodeDef*> nodes;
+  for (const NodeDef& node : graph_def.node()) {
+    nodes[node.name()] = &node;
+  }
+
+  // The assignments of the restore graph, and the variables they assign.
+  absl::flat_hash_map<StringPiece, std::vector<int>> variables_by_node;
+  std::vector<StringPiece> stack = {
+      ParseTensorName(meta_graph.saver_def().restore_op_name()).node()};
+  absl::flat_hash_set<StringPiece> visited;
+  while (!stack.empty()) {
+    const StringPiece name = stack.back();
+    stack.pop_back();
+    auto it = nodes.find(name);
+    if (it == nodes.end() || !visited.insert(name).second) {
+      continue;
+    }
+    const NodeDef& node = *it->second;
+    if (node.op() != "Assign" && node.op() != "AssignVariableOp") {
+      for (const string& input : node.input()) {
+        stack.push_back(ParseTensorName(input).node());
+      }
+      continue;
+    }
+    int unused_index;
+    int restored_index;
+    const NodeDef* variable =
+        node.input_size() == 2
+            ? GetInputNode(nodes, node.input(0), &unused_index)
+            : nullptr;
+    const NodeDef* restore =
+        variable != nullptr
+            ? GetInputNode(nodes, node.input(1), &restored_index)
+            : nullptr;
+    if (restore == nullptr || restore->op() != "RestoreV2" ||
+        restore->input_size() != 3) {
+      return absl::UnimplementedError(absl::StrCat(
+          "The restore graph assigns ", node.name(),
+          " with another op than RestoreV2"));
+    }
+    Variable restored;
+    TF_ASSIGN_OR_RETURN(
+        restored.tensor_key,
+        GetConstString(GetInputNode(nodes, restore->input(1), &unused_index),
+                       restored_index));
+    TF_ASSIGN_OR_RETURN(
+        const string shape_and_slice,
+        GetConstString(GetInputNode(nodes, restore->input(2), &unused_index),
+                       restored_index));
+    if (!shape_and_slice.empty()) {
+      return absl::UnimplementedError(absl::StrCat(
+          "The restore graph restores a slice of ", restored.tensor_key));
+    }
+    restored.restored_tensor =
+        strings::StrCat(restore->name(), ":", restored_index);
+    restored.assign_node = node.name();
+    variables_by_node[variable->name()].push_back(
+        restorer->variables_.size());
+    restorer->variables_.push_back(std::move(restored));
+  }
+  if (restorer->variables_.empty()) {
+    return absl::UnimplementedError(
+        "The restore graph has no assignments of restored variables");
+  }
+
+  // The variables used by each signature: those its inputs and outputs depend
+  // on.
+  for (const auto& [signature_key, signature_def] :
+       meta_graph.signature_def()) {
+    stack.clear();
+    visited.clear();
+    for (const auto& [key, tensor_info] : signature_def.inputs()) {
+      stack.push_back(ParseTensorName(tensor_info.name()).node());
+    }
+    for (const auto& [key, tensor_info] : signature_def.outputs()) {
+      stack.push_back(ParseTensorName(tensor_info.name()).node());
+    }
+    std::vector<int>& signature_variables =
+        restorer->signature_variables_[signature_key];
+    while (!stack.empty()) {
+      const StringPiece name = stack.back();
+      stack.pop_back();
+      auto it = nodes.find(name);
+      if (it == nodes.end() || !visited.insert(name).second) {
+        continue;
+      }
+      auto variables = variables_by_node.find(name);
+      if (variables != variables_by_node.end()) {
+        signature_variables.insert(signature_variables.end(),
+                                   variables->second.begin(),
+                                   variables->second.end());
+      }
+      for (const string& input : it->second->input()) {
+        stack.push_back(ParseTensorName(input).node());
+      }
+    }
+  }
+
+  mutex_lock lock(restorer->mu_);
+  restorer->states_.assign(restorer->variables_.size(),
+                           VariableState::kNotRestored);
+  return restorer;
+}
+
+Status SignatureRestorer::Restore(const RunOptions& run_options,
+                                  const std::vector<string>& signature_keys,
+                                  Session* session) {
+  std::vector<int> indices;
+  for (const string& signature_key : signature_keys) {
+    auto it = signature_variables_.find(signature_key);
+    if (it == signature_variables_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("No signature ", signature_key, " in the SavedModel"));
+    }
+    indices.insert(indices.end(), it->second.begin(), it->second.end());
+  }
+  return RestoreIndices(run_options, indices, session);
+}
+
+Status SignatureRestorer::RestoreAll(const RunOptions& run_options,
+                                     Session* session) {
+  for (const auto& [signature_key, unused] : signature_variables_) {
+    TF_RETURN_IF_ERROR(Restore(run_options, {signature_key}, session));
+  }
+  // The variables which no signature uses.
+  std::vector<int> indices(variables_.size());
+  for (size_t index = 0; index < variables_.size(); ++index) {
+    indices[index] = index;
+  }
+  return RestoreIndices(run_options, indices, session);
+}
+
+bool SignatureRestorer::IsRestored(const string& signature_key) const {
+  auto it = signature_variables_.find(signature_key);
+  if (it == signature_variables_.end()) {
+    return false;
+  }
+  mutex_lock lock(mu_);
+  for (int index : it->second) {
+    if (states_[index] != VariableState::kRestored) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Status SignatureRestorer::RestoreIndices(const RunOptions& run_options,
+                                         const std::vector<int>& indices,
+                                         Session* session) {
+  // Claims the variables which are not restored yet, after waiting for those
+  // restored by concurrent calls, which may fail.
+  std::vector<int> claimed;
+  {
+    mutex_lock lock(mu_);
+    bool waited = true;
+    while (waited) {
+      waited = false;
+      for (int index : indices) {
+        if (states_[index] == VariableState::kRestoring) {
+          cond_var_.wait(lock);
+          waited = true;
+          break;
+        }
+      }
+    }
+    for (int index : indices) {
+      if (states_[index] == VariableState::kNotRestored) {
+        states_[index] = VariableState::kRestoring;
+        claimed.push_back(index);
+      }
+    }
+  }
+  // The lock is not held while restoring, so that IsRestored() and the
+  // restores of other variables don't wait for it.
+  std::vector<const Variable*> variables;
+  variables.reserve(claimed.size());
+  for (int index : claimed) {
+    variables.push_back(&variables_[index]);
+  }
+  const Status status =
+      RestoreVariables(run_options, std::move(variables), session);
+  {
+    mutex_lock lock(mu_);
+    for (int index : claimed) {
+      states_[index] = status.ok() ? VariableState::kRestored
+                                   : VariableState::kNotRestored;
+    }
+  }
+  cond_var_.notify_all();
+  return status;
+}
+
+Status SignatureRestorer::RestoreChanged(const RunOptions& run_options,
+                                         const string& previous_export_dir,
+                                         Session* session, int* num_restored) {
+  BundleReader reader(Env::Default(), variables_path_);
+  TF_RETURN_IF_ERROR(reader.status());
+  BundleReader previous_reader(
+      Env::Default(), io::JoinPath(previous_export_dir,
+                                   kSavedModelVariablesDirectory,
+                                   kSavedModelVariablesFilename));
+  TF_RETURN_IF_ERROR(previous_reader.status());
+  std::vector<const Variable*> variables;
+  for (const Variable& variable : variables_) {
+    uint32 crc32c, previous_crc32c;
+    int64_t size, previous_size;
+    DataType dtype, previous_dtype;
+    TensorShape shape, previous_shape;
+    TF_RETURN_IF_ERROR(
+        reader.LookupChecksum(variable.tensor_key, &crc32c, &size));
+    TF_RETURN_IF_ERROR(
+        reader.LookupDtypeAndShape(variable.tensor_key, &dtype, &shape));
+    if (!previous_reader
+             .LookupChecksum(variable.tensor_key, &previous_crc32c,
+                             &previous_size)
+             .ok() ||
+        !previous_reader
+             .LookupDtypeAndShape(variable.tensor_key, &previous_dtype,
+                                  &previous_shape)
+             .ok() ||
+        crc32c != previous_crc32c || size != previous_size ||
+        dtype != previous_dtype || shape != previous_shape) {
+      variables.push_back(&variable);
+    }
+  }
+  *num_restored = variables.size();
   TF_RETURN_IF_ERROR(
-      internal::GetInitOp(export_dir, meta_graph, &init_op_name));
-  TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, meta_graph,
-                               asset_file_defs, session->get(), init_op_name));
-  load_latency_by_stage->GetCell(export_dir, "restore_graph")
-      ->Add(restore_graph_walltime);
-  // Record wall time spent in init op.
-  load_latency_by_stage->GetCell(export_dir, "init_graph")
-      ->Add(GetLatencyMicroseconds(graph_init_start_microseconds));
+      RestoreVariables(run_options, std::move(variables), session));
+  mutex_lock lock(mu_);
+  states_.assign(variables_.size(), VariableState::kRestored);
+  return OkStatus();
+}
+
+Status SignatureRestorer::RestoreVariables(
+    const RunOptions& run_options, std::vector<const Variable*> variables,
+    Session* session) const {
+  if (variables.empty()) {
+    return OkStatus();
+  }
+  {
+    BundleReader reader(Env::Default(), variables_path_);
+    TF_RETURN_IF_ERROR(reader.status());
+    TF_RETURN_IF_ERROR(reader.SortForSequentialAccess<const Variable*>(
+        variables, [](const Variable* variable) {
+          return variable->tensor_key;
+        }));
+  }
+  // Each thread reads a contiguous range of the checkpoint with its own
+  // reader.
+  const int num_threads = std::min<int>(num_threads_, variables.size());
+  if (num_threads <= 1) {
+    return RestoreVariablesFromReader(run_options, variables_path_, variables,
+                                      session);
+  }
+  const size_t per_thread = (variables.size() + num_threads - 1) / num_threads;
+  std::vector<Status> statuses(
+      (variables.size() + per_thread - 1) / per_thread);
+  {
+    thread::ThreadPool pool(Env::Default(), "restore_signature_variables",
+                            num_threads);
+    const absl::Span<const Variable* const> all_variables(variables);
+    for (size_t i = 0; i < statuses.size(); ++i) {
+      pool.Schedule([&, i]() {
+        statuses[i] = RestoreVariablesFromReader(
+            run_options, variables_path_,
+            all_variables.subspan(i * per_thread, per_thread), session);
+      });
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
   return OkStatus();
 }
 
@@ -491,11 +984,61 @@ Status LoadSavedModel(const SessionOptions& session_options,
   TF_RETURN_IF_ERROR(LoadSavedModel(rewritten_options, run_options, export_dir,
                                     tags, &legacy_bundle));
   *bundle = SavedModelBundleLite(
-      absl::make_unique<LiteSessionWrapper>(std::move(legacy_bundle.session)),
+      absl::make_unique<LiteSessionWrapper>(std::move(legacy_bundle.session),
+                                            std::move(legacy_bundle.env)),
       std::move(*legacy_bundle.meta_graph_def.mutable_signature_def()));
   return OkStatus();
 }
 
+namespace {
+// Returns the fingerprint of the SavedModel at `export_dir`, computing it if
+// the SavedModel was saved without one.
+StatusOr<FingerprintDef> GetFingerprint(const string& export_dir) {
+  StatusOr<FingerprintDef> fingerprint =
+      saved_model::fingerprinting::ReadSavedModelFingerprint(export_dir);
+  if (fingerprint.ok()) {
+    return fingerprint;
+  }
+  return saved_model::fingerprinting::CreateFingerprintDef(export_dir);
+}
+}  // namespace
+
+Status UpdateSavedModel(const RunOptions& run_options,
+                        const string& previous_export_dir,
+                        const string& export_dir,
+                        SavedModelBundle* const bundle) {
+  TF_ASSIGN_OR_RETURN(const FingerprintDef previous_fingerprint,
+                      GetFingerprint(previous_export_dir));
+  TF_ASSIGN_OR_RETURN(const FingerprintDef fingerprint,
+                      GetFingerprint(export_dir));
+  if (fingerprint.graph_def_program_hash() !=
+          previous_fingerprint.graph_def_program_hash() ||
+      fingerprint.signature_def_hash() !=
+          previous_fingerprint.signature_def_hash()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("The graphs or the signatures of the SavedModels at ",
+                     previous_export_dir, " and ", export_dir, " differ"));
+  }
+  if (fingerprint.checkpoint_hash() ==
+      previous_fingerprint.checkpoint_hash()) {
+    LOG(INFO) << "The variables of the SavedModel at " << export_dir
+              << " are the same as those at " << previous_export_dir;
+    return OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(
+      std::unique_ptr<SignatureRestorer> restorer,
+      SignatureRestorer::Create(bundle->meta_graph_def, export_dir));
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  int num_restored = 0;
+  TF_RETURN_IF_ERROR(restorer->RestoreChanged(
+      run_options, previous_export_dir, bundle->session.get(), &num_restored));
+  LOG(INFO) << "Updated the SavedModel at " << previous_export_dir << " to "
+            << export_dir << ": restored " << num_restored
+            << " changed variables. Took "
+            << GetLatencyMicroseconds(start_microseconds) << " microseconds.";
+  return OkStatus();
+}
+
 bool MaybeSavedModelDirectory(const string& export_dir) {
   const string saved_model_pb_path =
       io::JoinPath(export_dir, kSavedModelFilenamePb);
@@ -18,11 +18,18 @@ limitations under the License.
 #ifndef TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 #define TENSORFLOW_CC_SAVED_MODEL_LOADER_H_
 
+#include <memory>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/public/session.h"
 
@@ -62,6 +69,9 @@ struct SavedModelBundle : public SavedModelBundleInterface {
     return meta_graph_def.signature_def();
   }
 
+  /// Serves the memmapped package of the SavedModel to `session`, if the
+  /// SavedModel has one. Declared first so that it outlives `session`.
+  std::unique_ptr<Env> env;
   std::unique_ptr<Session> session;
   MetaGraphDef meta_graph_def;
   std::unique_ptr<GraphDebugInfo> debug_info;
@@ -135,6 +145,118 @@ Status LoadSavedModel(const SessionOptions& session_options,
                       const std::unordered_set<string>& tags,
                       SavedModelBundleLite* const bundle);
 
+/// Restores the variables of a SavedModel loaded into a session signature by
+/// signature, so that each signature can be served as soon as the variables
+/// it uses are restored, and rarely used signatures can be restored on their
+/// first use. See LoadSavedModelLazily().
+///
+/// The variables are read from the checkpoint with a BundleReader per thread,
+/// and fed to the assignments of the restore graph of the Saver, in place of
+/// the outputs of its RestoreV2 ops. Only the restore graphs of TF1 Savers are
+/// supported: the SavedModels of TF2 restore their variables in a function.
+///
+/// Thread-safe.
+class SignatureRestorer {
+ public:
+  /// Returns an Unimplemented error if the restore graph of `meta_graph` is not
+  /// supported. `num_threads` bounds the number of threads reading the
+  /// checkpoint, or is 0 for the default.
+  static StatusOr<std::unique_ptr<SignatureRestorer>> Create(
+      const MetaGraphDef& meta_graph, const string& export_dir,
+      int num_threads = 0);
+
+  /// Restores the variables used by the signatures `signature_keys` which are
+  /// not restored yet.
+  Status Restore(const RunOptions& run_options,
+                 const std::vector<string>& signature_keys, Session* session);
+
+  /// Restores all the variables which are not restored yet, signature by
+  /// signature.
+  Status RestoreAll(const RunOptions& run_options, Session* session);
+
+  /// Returns whether all the variables used by `signature_key` are restored.
+  bool IsRestored(const string& signature_key) const;
+
+  /// Restores only the variables whose checksum, size, dtype or shape in the
+  /// checkpoint index differ from those in the checkpoint of
+  /// `previous_export_dir`, e.g. a previous version of the same model, all the
+  /// variables of which are restored in `session`. Sets `*num_restored` to the
+  /// number of restored variables.
+  Status RestoreChanged(const RunOptions& run_options,
+                        const string& previous_export_dir, Session* session,
+                        int* num_restored);
+
+  /// The assignment of a variable in the restore graph.
+  struct Variable {
+    /// The checkpoint key of the variable.
+    string tensor_key;
+    /// The output of the RestoreV2 op fed to `assign_node`.
+    string restored_tensor;
+    string assign_node;
+  };
+
+ private:
+  SignatureRestorer(const string& variables_path, int num_threads)
+      : variables_path_(variables_path), num_threads_(num_threads) {}
+
+  enum class VariableState { kNotRestored, kRestoring, kRestored };
+
+  // Restores the variables at `indices` in `variables_` which are not
+  // restored yet, and waits for those being restored by concurrent calls.
+  Status RestoreIndices(const RunOptions& run_options,
+                        const std::vector<int>& indices, Session* session);
+
+  // Restores `variables` in parallel, with at most `num_threads_` readers.
+  Status RestoreVariables(const RunOptions& run_options,
+                          std::vector<const Variable*> variables,
+                          Session* session) const;
+
+  const string variables_path_;
+  const int num_threads_;
+  std::vector<Variable> variables_;
+  // The indices in `variables_` of the variables used by each signature.
+  absl::flat_hash_map<string, std::vector<int>> signature_variables_;
+
+  mutable mutex mu_;
+  // Notified when variables are no longer being restored.
+  condition_variable cond_var_;
+  std::vector<VariableState> states_ TF_GUARDED_BY(mu_);
+};
+
+/// Loads a SavedModel like LoadSavedModel(), but only restores the variables
+/// used by the signatures `signature_keys` before running the init op.
+/// `*restorer` restores the variables of the other signatures, which must be
+/// done before they are run, e.g. on their first use or in the background.
+///
+/// Restores all the variables, and sets `*restorer` to null, if the restore
+/// graph of the SavedModel is not supported by SignatureRestorer.
+///
+/// NOTE: The variables used by the init op must be used by one of
+/// `signature_keys` too.
+Status LoadSavedModelLazily(const SessionOptions& session_options,
+                            const RunOptions& run_options,
+                            const string& export_dir,
+                            const std::unordered_set<string>& tags,
+                            const std::vector<string>& signature_keys,
+                            SavedModelBundle* const bundle,
+                            std::unique_ptr<SignatureRestorer>* restorer);
+
+/// Updates `bundle`, loaded from `previous_export_dir`, in place to the version
+/// of the same model at `export_dir`, by only restoring the variables which
+/// differ between the checkpoints of both versions (see
+/// SignatureRestorer::RestoreChanged()). Nothing is restored if the checkpoints
+/// are the same.
+///
+/// Returns a FailedPrecondition error if the graphs or the signatures of both
+/// versions differ according to their fingerprints, or another error if the
+/// restore graph is not supported by SignatureRestorer, in which case the new
+/// version must be loaded with LoadSavedModel(). The init op is not run again,
+/// so the assets of both versions must be the same too.
+Status UpdateSavedModel(const RunOptions& run_options,
+                        const string& previous_export_dir,
+                        const string& export_dir,
+                        SavedModelBundle* const bundle);
+
 /// Checks whether the provided directory could contain a SavedModel. Note that
 /// the method does not load any data by itself. If the method returns `false`,
 /// the export directory definitely does not contain a SavedModel. If the method
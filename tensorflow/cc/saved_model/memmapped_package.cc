@@ -0,0 +1,187 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/memmapped_package.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/fingerprinting.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/protobuf/fingerprint.pb.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/memmapped_file_system.h"
+#include "tensorflow/core/util/memmapped_file_system_writer.h"
+
+namespace tensorflow {
+namespace saved_model {
+namespace {
+
+string GetPackagePath(const string& export_dir) {
+  return io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                      kSavedModelMemmappedPackageFilename);
+}
+
+// Returns whether `device` requests a CPU device, or no device type if
+// `allow_unset`.
+bool RequestsCpu(absl::string_view device, bool allow_unset) {
+  DeviceNameUtils::ParsedName parsed;
+  if (!DeviceNameUtils::ParseFullOrLocalName(device, &parsed)) return false;
+  return parsed.has_type ? parsed.type == DEVICE_CPU : allow_unset;
+}
+
+// Returns whether `node` can be replaced by an ImmutableConst node, which only
+// has a CPU kernel: it must not request another device, and must only be
+// colocated with nodes requesting a CPU device, so that its colocation group
+// isn't moved to the CPU or made unplaceable. `devices` maps the names of the
+// nodes of the graph to their requested devices.
+bool CanPlaceOnCpu(const NodeDef& node,
+                   const absl::flat_hash_map<string, string>& devices) {
+  if (!RequestsCpu(node.device(), /*allow_unset=*/true)) return false;
+  const auto class_it = node.attr().find(kColocationAttrName);
+  if (class_it == node.attr().end()) return true;
+  for (const string& group : class_it->second.list().s()) {
+    absl::string_view name = group;
+    if (!absl::ConsumePrefix(&name, kColocationGroupPrefix) ||
+        name == node.name()) {
+      continue;
+    }
+    const auto device_it = devices.find(name);
+    if (device_it == devices.end() ||
+        !RequestsCpu(device_it->second, /*allow_unset=*/false)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Saves the value of the Const `node` in `writer` and turns `node` into an
+// ImmutableConst node reading it, if the value has at least
+// `min_constant_bytes` bytes that can be mapped, and the node can be placed on
+// the CPU.
+Status MaybeMoveConstant(int64_t min_constant_bytes,
+                         const absl::flat_hash_map<string, string>& devices,
+                         NodeDef* node, MemmappedFileSystemWriter* writer,
+                         int* num_regions) {
+  const auto value_it = node->attr().find("value");
+  if (node->op() != "Const" || value_it == node->attr().end() ||
+      !CanPlaceOnCpu(*node, devices)) {
+    return OkStatus();
+  }
+  Tensor tensor;
+  if (!tensor.FromProto(value_it->second.tensor())) {
+    return errors::InvalidArgument("Invalid value of Const node ",
+                                   node->name());
+  }
+  const int64_t num_bytes = tensor.TotalBytes();
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) || num_bytes == 0 ||
+      num_bytes < min_constant_bytes) {
+    return OkStatus();
+  }
+  // Node names are not valid region names, so the regions are numbered.
+  const string region_name =
+      absl::StrCat(MemmappedFileSystem::kMemmappedPackagePrefix, "const_",
+                   (*num_regions)++);
+  TF_RETURN_IF_ERROR(writer->SaveTensor(tensor, region_name));
+  node->set_op("ImmutableConst");
+  auto* attr = node->mutable_attr();
+  attr->erase("value");
+  (*attr)["dtype"].set_type(tensor.dtype());
+  tensor.shape().AsProto((*attr)["shape"].mutable_shape());
+  (*attr)["memory_region_name"].set_s(region_name);
+  return OkStatus();
+}
+
+}  // namespace
+
+Status WriteMemmappedPackage(const string& export_dir,
+                             int64_t min_constant_bytes) {
+  Env* env = Env::Default();
+  const string package_path = GetPackagePath(export_dir);
+  if (env->FileExists(package_path).ok()) {
+    return errors::AlreadyExists("The SavedModel at ", export_dir,
+                                 " already has a memmapped package");
+  }
+  const string saved_model_path =
+      io::JoinPath(export_dir, kSavedModelFilenamePb);
+  SavedModel saved_model;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, saved_model_path, &saved_model));
+
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory)));
+  MemmappedFileSystemWriter writer;
+  TF_RETURN_IF_ERROR(writer.InitializeToFile(env, package_path));
+  int num_regions = 0;
+  for (MetaGraphDef& meta_graph : *saved_model.mutable_meta_graphs()) {
+    GraphDef* graph = meta_graph.mutable_graph_def();
+    absl::flat_hash_map<string, string> devices;
+    for (const NodeDef& node : graph->node()) {
+      devices[node.name()] = node.device();
+    }
+    for (NodeDef& node : *graph->mutable_node()) {
+      TF_RETURN_IF_ERROR(MaybeMoveConstant(min_constant_bytes, devices, &node,
+                                           &writer, &num_regions));
+    }
+  }
+  TF_RETURN_IF_ERROR(writer.FlushAndClose());
+  if (num_regions == 0) {
+    LOG(INFO) << "The SavedModel at " << export_dir
+              << " has no constants to map";
+    return env->DeleteFile(package_path);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, saved_model_path, saved_model));
+
+  // The graphs changed, so a stored fingerprint would be stale.
+  const string fingerprint_path =
+      io::JoinPath(export_dir, kFingerprintFilenamePb);
+  if (env->FileExists(fingerprint_path).ok()) {
+    TF_ASSIGN_OR_RETURN(const FingerprintDef fingerprint,
+                        fingerprinting::CreateFingerprintDef(export_dir));
+    TF_RETURN_IF_ERROR(WriteBinaryProto(env, fingerprint_path, fingerprint));
+  }
+  LOG(INFO) << "Moved " << num_regions << " constants of the SavedModel at "
+            << export_dir << " to " << package_path;
+  return OkStatus();
+}
+
+Status MaybeCreateMemmappedEnv(const string& export_dir, Env* base_env,
+                               std::unique_ptr<Env>* env) {
+  const string package_path = GetPackagePath(export_dir);
+  if (!base_env->FileExists(package_path).ok()) {
+    return OkStatus();
+  }
+  auto memmapped_env = std::make_unique<MemmappedEnv>(base_env);
+  TF_RETURN_IF_ERROR(memmapped_env->InitializeFromFile(package_path));
+  *env = std::move(memmapped_env);
+  return OkStatus();
+}
+
+}  // namespace saved_model
+}  // namespace tensorflow
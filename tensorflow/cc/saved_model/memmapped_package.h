@@ -0,0 +1,57 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+/// Functions to store the constants of a SavedModel in a memmapped package.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_MEMMAPPED_PACKAGE_H_
+#define TENSORFLOW_CC_SAVED_MODEL_MEMMAPPED_PACKAGE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace saved_model {
+
+// Moves the constants of at least `min_constant_bytes` bytes out of the graphs
+// of the SavedModel at `export_dir`, into a memmapped package in its
+// assets.extra directory, and replaces them with ImmutableConst nodes reading
+// them from the package. LoadSavedModel() maps the package, so the constants
+// are used in place instead of being copied to the heap, and the processes
+// loading the same SavedModel share them through the page cache.
+//
+// Only the constants of the top-level graphs are moved: those of functions and
+// the variables are left in place. ImmutableConst only has a CPU kernel, so the
+// constants requesting another device, or colocated with nodes that don't
+// request a CPU device, are left in place too. The moved constants are placed
+// on the CPU, and copied to the devices of their consumers on each run, so the
+// package is meant for models running on the CPU. The SavedModel must be
+// stored as a saved_model.pb file, and must not have a package already.
+Status WriteMemmappedPackage(const string& export_dir,
+                             int64_t min_constant_bytes);
+
+// If the SavedModel at `export_dir` has a memmapped package, maps it and stores
+// in `*env` an Env wrapping `base_env` that serves the constants of the
+// package. Leaves `*env` unchanged otherwise.
+Status MaybeCreateMemmappedEnv(const string& export_dir, Env* base_env,
+                               std::unique_ptr<Env>* env);
+
+}  // namespace saved_model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_MEMMAPPED_PACKAGE_H_
@@ -0,0 +1,159 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/memmapped_package.h"
+
+#include <vector>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/reader.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/saved_model.pb.h"
+
+namespace tensorflow {
+namespace saved_model {
+namespace {
+
+// Writes a SavedModel computing "sum" = "large" + "small", where "large" has
+// 4KB and "small" 4 bytes.
+void WriteTestSavedModel(const string& export_dir) {
+  Tensor large(DT_FLOAT, TensorShape({1024}));
+  large.flat<float>().setConstant(2.0f);
+  Tensor small(DT_FLOAT, TensorShape({}));
+  small.scalar<float>()() = 1.0f;
+
+  SavedModel saved_model;
+  MetaGraphDef* meta_graph = saved_model.add_meta_graphs();
+  meta_graph->mutable_meta_info_def()->add_tags(kSavedModelTagServe);
+  GraphDef* graph = meta_graph->mutable_graph_def();
+  TF_ASSERT_OK(NodeDefBuilder("large", "Const")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("value", large)
+                   .Finalize(graph->add_node()));
+  TF_ASSERT_OK(NodeDefBuilder("small", "Const")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("value", small)
+                   .Finalize(graph->add_node()));
+  TF_ASSERT_OK(NodeDefBuilder("sum", "Add")
+                   .Input("large", 0, DT_FLOAT)
+                   .Input("small", 0, DT_FLOAT)
+                   .Finalize(graph->add_node()));
+
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(),
+                                io::JoinPath(export_dir, kSavedModelFilenamePb),
+                                saved_model));
+}
+
+TEST(MemmappedPackageTest, LoadsConstantsFromPackage) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "memmapped_package_test");
+  WriteTestSavedModel(export_dir);
+  TF_ASSERT_OK(WriteMemmappedPackage(export_dir, /*min_constant_bytes=*/1024));
+
+  SavedModel saved_model;
+  TF_ASSERT_OK(ReadSavedModel(export_dir, &saved_model));
+  const GraphDef& graph = saved_model.meta_graphs(0).graph_def();
+  EXPECT_EQ(graph.node(0).op(), "ImmutableConst");
+  EXPECT_EQ(graph.node(1).op(), "Const");
+
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  EXPECT_NE(bundle.env, nullptr);
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(bundle.session->Run({}, {"sum:0"}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  Tensor expected(DT_FLOAT, TensorShape({1024}));
+  expected.flat<float>().setConstant(3.0f);
+  test::ExpectTensorEqual<float>(outputs[0], expected);
+
+  // The constants were already moved.
+  EXPECT_EQ(WriteMemmappedPackage(export_dir, /*min_constant_bytes=*/1024)
+                .code(),
+            absl::StatusCode::kAlreadyExists);
+}
+
+TEST(MemmappedPackageTest, NoConstantsToMove) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "memmapped_package_test_no_constants");
+  WriteTestSavedModel(export_dir);
+  TF_ASSERT_OK(WriteMemmappedPackage(export_dir, /*min_constant_bytes=*/8192));
+
+  EXPECT_FALSE(Env::Default()
+                   ->FileExists(io::JoinPath(export_dir,
+                                             kSavedModelAssetsExtraDirectory,
+                                             kSavedModelMemmappedPackageFilename))
+                   .ok());
+  SavedModelBundle bundle;
+  TF_ASSERT_OK(LoadSavedModel(SessionOptions(), RunOptions(), export_dir,
+                              {kSavedModelTagServe}, &bundle));
+  EXPECT_EQ(bundle.env, nullptr);
+}
+
+TEST(MemmappedPackageTest, LeavesConstantsOffCpuInPlace) {
+  const string export_dir =
+      io::JoinPath(testing::TmpDir(), "memmapped_package_test_devices");
+  Tensor large(DT_FLOAT, TensorShape({1024}));
+  large.flat<float>().setConstant(2.0f);
+  SavedModel saved_model;
+  MetaGraphDef* meta_graph = saved_model.add_meta_graphs();
+  meta_graph->mutable_meta_info_def()->add_tags(kSavedModelTagServe);
+  GraphDef* graph = meta_graph->mutable_graph_def();
+  TF_ASSERT_OK(NodeDefBuilder("on_gpu", "Const")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("value", large)
+                   .Device("/device:GPU:0")
+                   .Finalize(graph->add_node()));
+  TF_ASSERT_OK(NodeDefBuilder("with_gpu", "Const")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("value", large)
+                   .Attr("_class", {"loc:@on_gpu"})
+                   .Finalize(graph->add_node()));
+  TF_ASSERT_OK(NodeDefBuilder("on_cpu", "Const")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("value", large)
+                   .Device("/device:CPU:0")
+                   .Finalize(graph->add_node()));
+  TF_ASSERT_OK(NodeDefBuilder("with_cpu", "Const")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("value", large)
+                   .Attr("_class", {"loc:@on_cpu"})
+                   .Finalize(graph->add_node()));
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(export_dir));
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(),
+                                io::JoinPath(export_dir, kSavedModelFilenamePb),
+                                saved_model));
+  TF_ASSERT_OK(WriteMemmappedPackage(export_dir, /*min_constant_bytes=*/1024));
+
+  TF_ASSERT_OK(ReadSavedModel(export_dir, &saved_model));
+  const GraphDef& written = saved_model.meta_graphs(0).graph_def();
+  EXPECT_EQ(written.node(0).op(), "Const");
+  EXPECT_EQ(written.node(1).op(), "Const");
+  EXPECT_EQ(written.node(2).op(), "ImmutableConst");
+  EXPECT_EQ(written.node(3).op(), "ImmutableConst");
+}
+
+}  // namespace
+}  // namespace saved_model
+}  // namespace tensorflow
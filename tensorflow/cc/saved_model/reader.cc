@@ -159,4 +159,20 @@ Status ReadSavedModelDebugInfoIfPresent(
   return OkStatus();
 }
 
+Status ReadKernelCostStatsIfPresent(const string& export_dir,
+                                    KernelCostStats* kernel_cost_stats) {
+  const string kernel_cost_stats_path = io::JoinPath(
+      export_dir, kSavedModelAssetsExtraDirectory, kKernelCostStatsFilenamePb);
+  TF_ASSIGN_OR_RETURN(
+      bool kernel_cost_stats_exists,
+      internal::FileExists(Env::Default(), kernel_cost_stats_path));
+  if (kernel_cost_stats_exists) {
+    LOG(INFO) << "Reading kernel cost statistics from: "
+              << kernel_cost_stats_path;
+    TF_RETURN_IF_ERROR(ReadBinaryProto(Env::Default(), kernel_cost_stats_path,
+                                       kernel_cost_stats));
+  }
+  return OkStatus();
+}
+
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include <unordered_set>
 
 #include "tensorflow/core/framework/graph_debug_info.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/protobuf/saved_model.pb.h"
@@ -44,6 +45,12 @@ Status ReadSavedModelDebugInfoIfPresent(
     const string& export_dir,
     std::unique_ptr<GraphDebugInfo>* debug_info_proto);
 
+// Reads the kernel cost statistics stored in the assets.extra directory of the
+// SavedModel export dir into `kernel_cost_stats`, if present. Leaves
+// `kernel_cost_stats` unchanged otherwise.
+Status ReadKernelCostStatsIfPresent(const string& export_dir,
+                                    KernelCostStats* kernel_cost_stats);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CC_SAVED_MODEL_READER_H_
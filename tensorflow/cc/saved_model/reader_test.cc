@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/resource_loader.h"
 
@@ -113,6 +114,33 @@ TEST_F(ReaderTest, ReadSavedModelDebugInfoIfPresent) {
   TF_ASSERT_OK(ReadSavedModelDebugInfoIfPresent(export_dir, &debug_info_proto));
 }
 
+TEST_F(ReaderTest, ReadKernelCostStatsIfPresent) {
+  const string export_dir = io::JoinPath(testing::TmpDir(), "cost_stats");
+  KernelCostStats kernel_cost_stats;
+  kernel_cost_stats.add_dev_stats()->set_device("/device:CPU:0");
+
+  // Absent statistics leave the proto unchanged.
+  TF_ASSERT_OK(ReadKernelCostStatsIfPresent(export_dir, &kernel_cost_stats));
+  EXPECT_EQ(1, kernel_cost_stats.dev_stats_size());
+
+  KernelCostStats stored;
+  NodeCostStats* node_stats = stored.add_dev_stats()->add_node_stats();
+  node_stats->set_node_name("matmul");
+  node_stats->set_cost_estimate_cycles(1234);
+  const string assets_extra_dir =
+      io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory);
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(assets_extra_dir));
+  TF_ASSERT_OK(WriteBinaryProto(
+      Env::Default(),
+      io::JoinPath(assets_extra_dir, kKernelCostStatsFilenamePb), stored));
+
+  TF_ASSERT_OK(ReadKernelCostStatsIfPresent(export_dir, &kernel_cost_stats));
+  ASSERT_EQ(1, kernel_cost_stats.dev_stats_size());
+  ASSERT_EQ(1, kernel_cost_stats.dev_stats(0).node_stats_size());
+  EXPECT_EQ(1234, kernel_cost_stats.dev_stats(0).node_stats(0)
+                      .cost_estimate_cycles());
+}
+
 TEST_F(ReaderTest, MetricsNotUpdatedFailedRead) {
   MetaGraphDef meta_graph_def;
   const int read_count_v1 = metrics::SavedModelReadCount("1").value();
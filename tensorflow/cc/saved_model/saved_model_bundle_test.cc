@@ -26,8 +26,11 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -129,6 +132,171 @@ TEST_F(LoaderTest, ResourceLeakTest) {
   }
 }
 
+TEST_F(LoaderTest, LoadSavedModelLazily) {
+  SavedModelBundle bundle;
+  std::unique_ptr<SignatureRestorer> restorer;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModelLazily(
+      session_options, run_options, export_dir, {kSavedModelTagServe},
+      {"regress_x_to_y"}, &bundle, &restorer));
+  ASSERT_NE(restorer, nullptr);
+  CheckSavedModelBundle(export_dir, bundle);
+  EXPECT_TRUE(restorer->IsRestored("regress_x_to_y"));
+  EXPECT_FALSE(restorer->IsRestored("regress_x_to_y2"));
+
+  // The variable `c` of `regress_x_to_y2` is restored on demand.
+  const auto& signature_def = bundle.GetSignatures().at("regress_x_to_y2");
+  const string input_name = signature_def.inputs().at(kRegressInputs).name();
+  const string output_name =
+      signature_def.outputs().at(kRegressOutputs).name();
+  Tensor input = test::AsTensor<tstring>(
+      {MakeSerializedExample(0), MakeSerializedExample(1)}, TensorShape({2}));
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(
+      bundle.session->Run({{input_name, input}}, {output_name}, {}, &outputs)
+          .ok());
+  TF_ASSERT_OK(restorer->Restore(run_options, {"regress_x_to_y2"},
+                                 bundle.session.get()));
+  EXPECT_TRUE(restorer->IsRestored("regress_x_to_y2"));
+  TF_ASSERT_OK(
+      bundle.session->Run({{input_name, input}}, {output_name}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(
+      outputs[0], test::AsTensor<float>({3, 3.5}, TensorShape({2, 1})));
+
+  TF_ASSERT_OK(restorer->RestoreAll(run_options, bundle.session.get()));
+  EXPECT_TRUE(restorer->IsRestored("regress_x2_to_y3"));
+  EXPECT_EQ(restorer->Restore(run_options, {"missing"}, bundle.session.get())
+                .code(),
+            absl::StatusCode::kNotFound);
+}
+
+TEST_F(LoaderTest, LoadSavedModelLazilyRestoresConcurrently) {
+  SavedModelBundle bundle;
+  std::unique_ptr<SignatureRestorer> restorer;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModelLazily(
+      session_options, run_options, export_dir, {kSavedModelTagServe},
+      {"regress_x_to_y"}, &bundle, &restorer));
+  ASSERT_NE(restorer, nullptr);
+
+  // Concurrent restores of the same signature both return once its variables
+  // are restored, while IsRestored() can be polled.
+  std::vector<Status> statuses(2);
+  {
+    thread::ThreadPool pool(Env::Default(), "restore", 3);
+    for (int i = 0; i < 2; ++i) {
+      pool.Schedule([&, i]() {
+        statuses[i] = restorer->Restore(run_options, {"regress_x_to_y2"},
+                                        bundle.session.get());
+        EXPECT_TRUE(restorer->IsRestored("regress_x_to_y2"));
+      });
+    }
+    pool.Schedule([&]() {
+      TF_EXPECT_OK(restorer->RestoreAll(run_options, bundle.session.get()));
+    });
+    for (int i = 0; i < 100; ++i) {
+      restorer->IsRestored("regress_x2_to_y3");
+    }
+  }
+  for (const Status& status : statuses) {
+    TF_EXPECT_OK(status);
+  }
+  EXPECT_TRUE(restorer->IsRestored("regress_x2_to_y3"));
+}
+
+TEST_F(LoaderTest, LoadSavedModelLazilyFallsBackToRestoringAll) {
+  SavedModelBundle bundle;
+  std::unique_ptr<SignatureRestorer> restorer;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  // The variables of TF2 SavedModels are restored in a function.
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kVarsAndArithmeticObjectGraph);
+  TF_ASSERT_OK(LoadSavedModelLazily(session_options, run_options, export_dir,
+                                    {kSavedModelTagServe}, {}, &bundle,
+                                    &restorer));
+  EXPECT_EQ(restorer, nullptr);
+}
+
+TEST_F(LoaderTest, UpdateSavedModel) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string previous_export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options,
+                              previous_export_dir, {kSavedModelTagServe},
+                              &bundle));
+
+  // A new version of the model, with a new value of `b`.
+  Env* env = Env::Default();
+  const string export_dir = io::JoinPath(testing::TmpDir(), "updated_model");
+  TF_ASSERT_OK(env->RecursivelyCreateDir(
+      io::JoinPath(export_dir, kSavedModelAssetsDirectory)));
+  TF_ASSERT_OK(env->RecursivelyCreateDir(
+      io::JoinPath(export_dir, kSavedModelVariablesDirectory)));
+  for (const string& file :
+       {string(kSavedModelFilenamePb),
+        io::JoinPath(kSavedModelAssetsDirectory, "foo.txt")}) {
+    TF_ASSERT_OK(env->CopyFile(io::JoinPath(previous_export_dir, file),
+                               io::JoinPath(export_dir, file)));
+  }
+  BundleWriter writer(env, io::JoinPath(export_dir,
+                                        kSavedModelVariablesDirectory,
+                                        kSavedModelVariablesFilename));
+  TF_ASSERT_OK(writer.Add("a", test::AsScalar<float>(0.5)));
+  TF_ASSERT_OK(writer.Add("b", test::AsScalar<float>(3)));
+  TF_ASSERT_OK(writer.Add("c", test::AsScalar<float>(3)));
+  TF_ASSERT_OK(writer.Finish());
+
+  StatusOr<std::unique_ptr<SignatureRestorer>> restorer =
+      SignatureRestorer::Create(bundle.meta_graph_def, export_dir);
+  TF_ASSERT_OK(restorer.status());
+  int num_restored = 0;
+  TF_ASSERT_OK((*restorer)->RestoreChanged(run_options, previous_export_dir,
+                                           bundle.session.get(),
+                                           &num_restored));
+  EXPECT_EQ(num_restored, 1);
+
+  const auto& signature_def = bundle.GetSignatures().at("regress_x_to_y");
+  const string input_name = signature_def.inputs().at(kRegressInputs).name();
+  const string output_name =
+      signature_def.outputs().at(kRegressOutputs).name();
+  Tensor input = test::AsTensor<tstring>(
+      {MakeSerializedExample(0), MakeSerializedExample(1)}, TensorShape({2}));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(
+      bundle.session->Run({{input_name, input}}, {output_name}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(
+      outputs[0], test::AsTensor<float>({3, 3.5}, TensorShape({2, 1})));
+
+  // Back to the previous version.
+  TF_ASSERT_OK(UpdateSavedModel(run_options, export_dir, previous_export_dir,
+                                &bundle));
+  CheckSavedModelBundle(previous_export_dir, bundle);
+  TF_ASSERT_OK(UpdateSavedModel(run_options, previous_export_dir,
+                                previous_export_dir, &bundle));
+
+  const string other_export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataMainOp);
+  EXPECT_EQ(UpdateSavedModel(run_options, previous_export_dir,
+                             other_export_dir, &bundle)
+                .code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
 TEST_F(LoaderTest, TagMatch) {
   SavedModelBundle bundle;
   SessionOptions session_options;
@@ -21,8 +21,10 @@ limitations under the License.
 #include <utility>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/errors.h"
@@ -55,6 +57,16 @@ void RegisterExecutionForCluster(
             << " as megamorphic, compile_count=" << stats->compile_count
             << " execution_count=" << stats->execution_count;
     stats->is_megamorphic = true;
+
+    const std::string& profile_dir =
+        GetMarkForCompilationPassFlags()->tf_xla_clustering_profile_directory;
+    if (!profile_dir.empty()) {
+      Status status = RecordMegamorphicCluster(profile_dir, function.name());
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to record " << function.name()
+                     << " as megamorphic: " << status;
+      }
+    }
   }
 }
 
@@ -16,10 +16,20 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -28,6 +38,8 @@ limitations under the License.
 #include "xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -74,6 +86,19 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // If non-empty, the version of the compiler building the executables. The
+    // entries persisted by other versions are not loaded.
+    std::string compiler_version;
+
+    // If positive, the least recently used entries are removed from
+    // `persistent_cache_directory` once they take more than this many bytes.
+    int64_t persistent_cache_max_size_bytes = 0;
+
+    // If true, the entries in `persistent_cache_directory` are read in the
+    // background on construction, so that loading them later doesn't have to
+    // wait for the file system.
+    bool prefetch = false;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -109,6 +134,7 @@ class DeviceExecutablePersistor {
   const std::string& persistent_cache_directory() const {
     return persistent_cache_directory_;
   }
+  const std::string& compiler_version() const { return compiler_version_; }
 
  private:
   // Returns a cache key proto that identifies an entry in the compilation
@@ -142,6 +168,19 @@ class DeviceExecutablePersistor {
                                 const xla::HloModuleProto& hlo_module,
                                 const XlaSerializedCacheEntry& entry) const;
 
+  // Reads the entries of this device type and compiler version in the file
+  // directory, which haven't been loaded yet, into `prefetched_entries_`.
+  void PrefetchSerializedEntries();
+
+  // Records that the entry at `file_path` was loaded or saved.
+  void MarkUsed(const std::string& file_path) const;
+
+  // Removes the least recently used entries from the file directory, until
+  // they take at most `persistent_cache_max_size_bytes_`. The entries used by
+  // this persistor are more recent than the others, which are ordered by
+  // their modification time.
+  Status EvictSerializedEntries() const;
+
   std::string XlaSerializedCacheKeyToString(
       const XlaSerializedCacheKey& key) const;
   std::string GetFilePath(const XlaSerializedCacheKey& key) const;
@@ -157,6 +196,22 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const std::string compiler_version_;
+  const int64_t persistent_cache_max_size_bytes_;
+
+  mutable absl::Mutex mu_;
+  // The entries read ahead of their use, by file path.
+  mutable absl::flat_hash_map<std::string, XlaSerializedCacheEntry>
+      prefetched_entries_ ABSL_GUARDED_BY(mu_);
+  // The order in which the entries were last used, by file path.
+  mutable absl::flat_hash_map<std::string, int64_t> last_used_
+      ABSL_GUARDED_BY(mu_);
+  mutable int64_t use_count_ ABSL_GUARDED_BY(mu_) = 0;
+
+  // Reads the entries if `prefetch` is set. Joined on destruction, before the
+  // entries are destroyed.
+  std::unique_ptr<Thread> prefetch_thread_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -170,7 +225,15 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      compiler_version_(config.compiler_version),
+      persistent_cache_max_size_bytes_(config.persistent_cache_max_size_bytes) {
+  if (config.prefetch && !persistent_cache_directory_.empty()) {
+    prefetch_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "xla_persistent_cache_prefetch",
+        [this] { PrefetchSerializedEntries(); }));
+  }
+}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
@@ -183,7 +246,11 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.device_type(),
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
-          : "");
+          : "",
+      key.compiler_version().empty()
+          ? ""
+          : absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         Fingerprint64(key.compiler_version())));
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -205,6 +272,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_version(compiler_version());
   return key;
 }
 
@@ -231,6 +299,16 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
     const XlaSerializedCacheKey& key) const {
   Env* env = Env::Default();
   const std::string file_path = GetFilePath(key);
+  MarkUsed(file_path);
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = prefetched_entries_.find(file_path);
+        it != prefetched_entries_.end()) {
+      std::optional<XlaSerializedCacheEntry> entry = std::move(it->second);
+      prefetched_entries_.erase(it);
+      return entry;
+    }
+  }
   if (!env->FileExists(file_path).ok()) {
     return StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
   }
@@ -306,7 +384,116 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
         "Could not create a unique file inside ", persistent_cache_directory_));
   }
   TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
-  return env->RenameFile(temp_path, GetFilePath(entry.key()));
+  const std::string file_path = GetFilePath(entry.key());
+  TF_RETURN_IF_ERROR(env->RenameFile(temp_path, file_path));
+  MarkUsed(file_path);
+
+  if (persistent_cache_max_size_bytes_ > 0) {
+    // The entry is saved even if others can't be removed.
+    Status status = EvictSerializedEntries();
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to remove entries from XLA persistent cache at "
+                   << persistent_cache_directory_ << ": " << status;
+    }
+  }
+  return OkStatus();
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType,
+                               ClientType>::PrefetchSerializedEntries() {
+  XLA_SCOPED_LOGGING_TIMER(absl::StrCat("Prefetching serialized cache entries ",
+                                        "from ", persistent_cache_directory_));
+  Env* env = Env::Default();
+  std::vector<std::string> file_paths;
+  if (!env->GetMatchingPaths(
+              io::JoinPath(persistent_cache_directory_,
+                           absl::StrCat(persistence_prefix_, "*.pb")),
+              &file_paths)
+           .ok()) {
+    return;
+  }
+  for (const std::string& file_path : file_paths) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (last_used_.contains(file_path)) {
+        continue;
+      }
+    }
+    XlaSerializedCacheEntry entry;
+    if (!ReadTextOrBinaryProto(env, file_path, &entry).ok() ||
+        entry.key().device_type() != device_type_.type_string() ||
+        entry.key().compiler_version() != compiler_version_) {
+      continue;
+    }
+    absl::MutexLock lock(&mu_);
+    if (!last_used_.contains(file_path)) {
+      prefetched_entries_.emplace(file_path, std::move(entry));
+    }
+  }
+  VLOG(1) << "Prefetched " << file_paths.size()
+          << " files of XLA persistent cache at "
+          << persistent_cache_directory_;
+}
+
+template <typename ExecutableType, typename ClientType>
+void DeviceExecutablePersistor<ExecutableType, ClientType>::MarkUsed(
+    const std::string& file_path) const {
+  absl::MutexLock lock(&mu_);
+  last_used_[file_path] = ++use_count_;
+}
+
+template <typename ExecutableType, typename ClientType>
+Status
+DeviceExecutablePersistor<ExecutableType, ClientType>::EvictSerializedEntries()
+    const {
+  Env* env = Env::Default();
+  std::vector<std::string> file_paths;
+  TF_RETURN_IF_ERROR(env->GetMatchingPaths(
+      io::JoinPath(persistent_cache_directory_,
+                   absl::StrCat(persistence_prefix_, "*.pb")),
+      &file_paths));
+
+  // The entries ordered from the least to the most recently used.
+  struct Entry {
+    int64_t last_used;
+    int64_t mtime_nsec;
+    int64_t size;
+    std::string file_path;
+  };
+  std::vector<Entry> entries;
+  int64_t total_size = 0;
+  {
+    absl::MutexLock lock(&mu_);
+    for (std::string& file_path : file_paths) {
+      FileStatistics stat;
+      if (!env->Stat(file_path, &stat).ok()) {
+        continue;
+      }
+      auto it = last_used_.find(file_path);
+      entries.push_back({it == last_used_.end() ? 0 : it->second,
+                         stat.mtime_nsec, stat.length, std::move(file_path)});
+      total_size += stat.length;
+    }
+  }
+  absl::c_sort(entries, [](const Entry& a, const Entry& b) {
+    return std::tie(a.last_used, a.mtime_nsec) <
+           std::tie(b.last_used, b.mtime_nsec);
+  });
+
+  // Keep at least the most recently used entry.
+  for (int i = 0;
+       i + 1 < entries.size() && total_size > persistent_cache_max_size_bytes_;
+       ++i) {
+    VLOG(1) << "Removing entry from XLA persistent cache: "
+            << entries[i].file_path;
+    TF_RETURN_IF_ERROR(env->DeleteFile(entries[i].file_path));
+    total_size -= entries[i].size;
+    absl::MutexLock lock(&mu_);
+    last_used_.erase(entries[i].file_path);
+    prefetched_entries_.erase(entries[i].file_path);
+  }
+  return OkStatus();
 }
 
 template <typename ExecutableType, typename ClientType>
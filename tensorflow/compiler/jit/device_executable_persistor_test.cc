@@ -628,5 +628,103 @@ TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   EXPECT_EQ(entry.executable(), serialized_xla_executable_);
 }
 
+TEST_F(DeviceExecutionPersistorTest, LoadCompilerVersionMismatch) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "versioned"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  config.compiler_version = "v1";
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(persistor.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+
+  // The entry isn't loaded by another version of the compiler.
+  config.compiler_version = "v2";
+  XlaDeviceExecutablePersistor other_persistor(config,
+                                               DefaultXlaOptions().device_type);
+  EXPECT_FALSE(other_persistor
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+}
+
+TEST_F(DeviceExecutionPersistorTest, PersistEvictsLeastRecentlyUsedEntries) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "bounded"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  // Only the most recently used entry fits.
+  config.persistent_cache_max_size_bytes = 1;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillRepeatedly(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  for (uint64 signature_hash : {123, 456}) {
+    TF_EXPECT_OK(persistor.TryToPersistExecutable(
+        signature_hash, "signature_string", DefaultXlaOptions(),
+        compilation_result_add_, *executable, &mock_client));
+  }
+
+  auto key1 =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  auto key2 =
+      CreateCacheKey(/*signature_hash=*/456, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  const std::string& dir = persistor.persistent_cache_directory();
+  EXPECT_FALSE(ReadCacheEntryFromFile(key1, dir).ok());
+  TF_EXPECT_OK(ReadCacheEntryFromFile(key2, dir).status());
+}
+
+TEST_F(DeviceExecutionPersistorTest, LoadPrefetchedEntry) {
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/io::JoinPath(cache_dir_, "prefetched"),
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  {
+    XlaDeviceExecutablePersistor persistor(config,
+                                           DefaultXlaOptions().device_type);
+    TF_EXPECT_OK(persistor.TryToPersistExecutable(
+        /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+        compilation_result_add_, *executable, &mock_client));
+  }
+
+  // The entry is loaded whether or not it has been prefetched yet.
+  config.prefetch = true;
+  XlaDeviceExecutablePersistor persistor(config,
+                                         DefaultXlaOptions().device_type);
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(std::move(executable))));
+  auto loaded_executable = persistor.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -175,6 +175,29 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_persistent_cache_max_size_mb",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_max_size_mb,
+           "If positive, the least recently used entries of the persistent "
+           "cache are removed once the entries take more than this many "
+           "megabytes on disk. Unbounded by default."),
+      Flag("tf_xla_persistent_cache_prefetch",
+           &mark_for_compilation_flags->tf_xla_persistent_cache_prefetch,
+           "If true, the entries of the persistent cache are read in the "
+           "background when the device compiler is created, e.g. while a "
+           "model is loaded."),
+      Flag("tf_xla_clustering_profile_directory",
+           &mark_for_compilation_flags->tf_xla_clustering_profile_directory,
+           "If non-empty, the clusters which turn out to be megamorphic at "
+           "runtime are recorded in the specified file system directory path, "
+           "and auto clustering doesn't form them again. Requires "
+           "--tf_xla_deterministic_cluster_names. Empty by default."),
+      Flag("tf_xla_shape_bucket_boundaries",
+           &mark_for_compilation_flags->tf_xla_shape_bucket_boundaries,
+           "If non-empty, the inputs of the clusters made only of elementwise "
+           "ops are padded up to these dimension sizes (comma separated, or "
+           "\"powers_of_two\"), so that the clusters are compiled once per "
+           "bucket of sizes instead of once per input shape. Empty by "
+           "default."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -245,6 +268,10 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_persistent_cache_max_size_mb = 0;
+  mark_for_compilation_flags->tf_xla_persistent_cache_prefetch = false;
+  mark_for_compilation_flags->tf_xla_clustering_profile_directory = "";
+  mark_for_compilation_flags->tf_xla_shape_bucket_boundaries = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
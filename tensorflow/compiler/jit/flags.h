@@ -111,6 +111,25 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If positive, the least recently used entries of the persistent cache are
+  // removed once the entries take more than this many megabytes on disk.
+  int64_t tf_xla_persistent_cache_max_size_mb;
+
+  // If true, the entries of the persistent cache are read in the background
+  // when the device compiler is created, e.g. while a model is loaded.
+  bool tf_xla_persistent_cache_prefetch;
+
+  // If non-empty, the clusters which turn out to be megamorphic at runtime are
+  // recorded in the specified file system directory path, and auto clustering
+  // doesn't form them again. Requires deterministic cluster names.
+  std::string tf_xla_clustering_profile_directory;
+
+  // If non-empty, the inputs of the clusters made only of elementwise ops are
+  // padded up to these dimension sizes (comma separated, or "powers_of_two"),
+  // so that the clusters are compiled once per bucket of sizes instead of once
+  // per input shape.
+  std::string tf_xla_shape_bucket_boundaries;
 };
 
 // Flags associated with XLA Sparse Core.
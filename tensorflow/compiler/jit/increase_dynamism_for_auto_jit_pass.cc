@@ -14,11 +14,21 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/compiler/jit/increase_dynamism_for_auto_jit_pass.h"
+#include <algorithm>
 #include <iterator>
+#include <map>
+#include <set>
+#include <utility>
+#include <vector>
+
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/str_split.h"
 #include "absl/types/optional.h"
 #include "tensorflow/cc/framework/scope_internal.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -370,6 +380,280 @@ Status FindAndRewriteSlices(Graph* g, bool* changed) {
 
   return OkStatus();
 }
+
+// Shape bucketing
+// ---------------
+
+// Returns true for the elementwise ops, whose result on inputs padded along
+// their dimensions of size greater than one is the padding of their result on
+// the inputs, with numpy style broadcasting.
+bool IsShapeBucketingSafeOp(const Node& n) {
+  static const auto* safe_ops = new absl::flat_hash_set<string>{
+      // Unary
+      "Abs", "Cast", "Ceil", "Cos", "Elu", "Erf", "Exp", "Floor", "Identity",
+      "Log", "Log1p", "Neg", "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt",
+      "Selu", "Sigmoid", "Sign", "Sin", "Softplus", "Sqrt", "Square", "Tanh",
+      // Binary
+      "Add", "AddV2", "BiasAdd", "Div", "DivNoNan", "Maximum", "Minimum", "Mul",
+      "Pow", "RealDiv", "SquaredDifference", "Sub"};
+  if (n.type_string() == "BiasAdd") {
+    // The bias is only added along the last dimension with NHWC.
+    string data_format;
+    return GetNodeAttr(n.attrs(), "data_format", &data_format).ok() &&
+           data_format == "NHWC";
+  }
+  return safe_ops->contains(n.type_string());
+}
+
+// Returns true if padding the inputs of `cluster` and slicing its outputs back
+// to their unpadded shapes doesn't change what `cluster` computes.
+StatusOr<bool> IsShapeBucketingSafeCluster(absl::string_view cluster_name,
+                                           absl::Span<Node* const> cluster) {
+  for (Node* n : cluster) {
+    if (n->type_string() == "Const") {
+      // Scalar constants broadcast to any shape, unlike the others.
+      TF_ASSIGN_OR_RETURN(std::optional<Tensor> value,
+                          TryToGetTensorFromConstOp(n));
+      if (value->dims() != 0) {
+        return false;
+      }
+      continue;
+    }
+
+    if (!IsShapeBucketingSafeOp(*n)) {
+      return false;
+    }
+
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge() ||
+          GetXlaClusterForNode(*e->src()) == cluster_name) {
+        continue;
+      }
+      // The constants computing the padding of an input are placed in its
+      // frame with a control edge from its node, which can't be a Switch.
+      if (e->src()->IsSwitch() ||
+          IsRefType(e->src()->output_type(e->src_output()))) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+StatusOr<std::vector<int64_t>> ParseShapeBucketBoundaries(
+    absl::string_view flag) {
+  // Dimensions of size 0 and 1 are never padded, so that the padded inputs
+  // broadcast like the inputs.
+  std::vector<int64_t> boundaries = {0, 1};
+  if (flag == "powers_of_two") {
+    for (int64_t boundary = 2; boundary <= (int64_t{1} << 40); boundary *= 2) {
+      boundaries.push_back(boundary);
+    }
+    return boundaries;
+  }
+
+  for (absl::string_view boundary_str : absl::StrSplit(flag, ',')) {
+    int64_t boundary;
+    if (!absl::SimpleAtoi(boundary_str, &boundary) || boundary < 0) {
+      return errors::InvalidArgument(
+          "Invalid --tf_xla_shape_bucket_boundaries: ", flag);
+    }
+    boundaries.push_back(boundary);
+  }
+  absl::c_sort(boundaries);
+  boundaries.erase(std::unique(boundaries.begin(), boundaries.end()),
+                   boundaries.end());
+  return boundaries;
+}
+
+// Returns `input` padded with zeros up to the bucket of each of its dimensions
+// in `padded`, and its shape in `shape`, where
+//
+//   bucket(shape)[i] =
+//     max(boundaries[min(lower_bound(boundaries, shape[i]),
+//                        boundaries.size() - 1)],
+//         shape[i])
+Status PadToShapeBucket(const Scope& scope, const Output& input,
+                        const string& device,
+                        absl::Span<const int64_t> boundaries, Output* padded,
+                        Output* shape) {
+  string host_name;
+  TF_RETURN_IF_ERROR(
+      DeviceNameUtils::DeviceNameToCpuDeviceName(device, &host_name));
+  Scope device_scope = scope.WithAssignedDevice(device);
+  Scope host_scope = scope.WithAssignedDevice(host_name);
+
+  auto host_constant = [&](absl::string_view name,
+                           const Input::Initializer& value) {
+    Output constant = ops::Const(host_scope.WithOpName(name), value);
+    scope.graph()->AddControlEdge(input.node(), constant.node());
+    return constant;
+  };
+  Tensor boundaries_tensor(
+      DT_INT64, TensorShape({static_cast<int64_t>(boundaries.size())}));
+  absl::c_copy(boundaries, boundaries_tensor.flat<int64_t>().data());
+  Output boundaries_const = host_constant("boundaries", boundaries_tensor);
+  Output row_shape = host_constant("row_shape", {int64_t{1}, int64_t{-1}});
+  Output flat_shape = host_constant("flat_shape", {int64_t{-1}});
+  Output max_index = host_constant(
+      "max_index", static_cast<int64_t>(boundaries.size() - 1));
+  Output axis = host_constant("axis", int64_t{0});
+
+  // Shape produces its output in host memory on any device.
+  *shape = ops::Shape(device_scope.WithOpName("shape"), input,
+                      ops::Shape::OutType(DT_INT64));
+  Output index = ops::LowerBound(
+      host_scope.WithOpName("index"),
+      ops::Reshape(host_scope.WithOpName("boundaries_row"), boundaries_const,
+                   row_shape),
+      ops::Reshape(host_scope.WithOpName("shape_row"), *shape, row_shape),
+      ops::LowerBound::OutType(DT_INT64));
+  index = ops::Minimum(
+      host_scope.WithOpName("clamped_index"),
+      ops::Reshape(host_scope.WithOpName("flat_index"), index, flat_shape),
+      max_index);
+  Output bucket = ops::Maximum(
+      host_scope.WithOpName("bucket"),
+      ops::GatherV2(host_scope.WithOpName("boundary"), boundaries_const, index,
+                    axis),
+      *shape);
+  Output paddings = ops::Stack(
+      host_scope.WithOpName("paddings"),
+      {ops::ZerosLike(host_scope.WithOpName("low_padding"), *shape),
+       ops::Sub(host_scope.WithOpName("high_padding"), bucket, *shape)},
+      ops::Stack::Axis(1));
+  *padded = ops::Pad(device_scope.WithOpName("padded"), input, paddings);
+  return scope.status();
+}
+
+// Pads the inputs of `cluster`, which is in topological order, up to their
+// shape buckets and slices its outputs back to their unpadded shapes: the
+// broadcast of the shapes of the inputs they depend on.
+Status BucketClusterShapes(Graph* g, absl::string_view cluster_name,
+                           absl::Span<Node* const> cluster,
+                           absl::Span<const int64_t> boundaries) {
+  VLOG(3) << "Bucketing the input shapes of " << cluster_name;
+  Status status;
+  Scope root = NewInternalScope(g, &status, /*refiner=*/nullptr);
+  absl::flat_hash_set<Node*> cluster_nodes(cluster.begin(), cluster.end());
+
+  // The padded inputs and their shapes, and the inputs each node of `cluster`
+  // depends on.
+  absl::flat_hash_map<std::pair<Node*, int>, int> input_indices;
+  std::vector<Output> padded_inputs;
+  std::vector<Output> input_shapes;
+  absl::flat_hash_map<Node*, std::set<int>> node_inputs;
+
+  for (Node* n : cluster) {
+    std::set<int>& inputs = node_inputs[n];
+    std::vector<const Edge*> in_edges(n->in_edges().begin(),
+                                      n->in_edges().end());
+    for (const Edge* e : in_edges) {
+      if (e->IsControlEdge()) {
+        continue;
+      }
+      if (cluster_nodes.contains(e->src())) {
+        const std::set<int>& src_inputs = node_inputs[e->src()];
+        inputs.insert(src_inputs.begin(), src_inputs.end());
+        continue;
+      }
+
+      auto [it, inserted] = input_indices.insert(
+          {{e->src(), e->src_output()}, padded_inputs.size()});
+      if (inserted) {
+        Output padded, shape;
+        TF_RETURN_IF_ERROR(PadToShapeBucket(
+            root.NewSubScope(absl::StrCat(cluster_name, "/", e->src()->name(),
+                                          "_", e->src_output(), "/bucketed")),
+            Output(e->src(), e->src_output()), n->assigned_device_name(),
+            boundaries, &padded, &shape));
+        padded_inputs.push_back(padded);
+        input_shapes.push_back(shape);
+      }
+      inputs.insert(it->second);
+      TF_RETURN_IF_ERROR(g->UpdateEdge(padded_inputs[it->second].node(), 0, n,
+                                       e->dst_input()));
+    }
+  }
+
+  for (Node* n : cluster) {
+    // Scalar constants don't depend on any input and aren't padded.
+    const std::set<int>& inputs = node_inputs[n];
+    if (inputs.empty()) {
+      continue;
+    }
+
+    std::map<int, std::vector<const Edge*>> out_edges_by_output;
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge() && !cluster_nodes.contains(e->dst())) {
+        out_edges_by_output[e->src_output()].push_back(e);
+      }
+    }
+
+    for (const auto& [output, out_edges] : out_edges_by_output) {
+      string host_name;
+      TF_RETURN_IF_ERROR(DeviceNameUtils::DeviceNameToCpuDeviceName(
+          n->assigned_device_name(), &host_name));
+      Scope scope = root.NewSubScope(absl::StrCat(
+          cluster_name, "/", n->name(), "_", output, "/unbucketed"));
+      Scope host_scope = scope.WithAssignedDevice(host_name);
+
+      Output shape = input_shapes[*inputs.begin()];
+      for (auto it = std::next(inputs.begin()); it != inputs.end(); ++it) {
+        shape = ops::BroadcastArgs(host_scope.WithOpName("shape"), shape,
+                                   input_shapes[*it]);
+      }
+      Output sliced = ops::Slice(
+          scope.WithAssignedDevice(n->assigned_device_name())
+              .WithOpName("sliced"),
+          Output(n, output),
+          ops::ZerosLike(host_scope.WithOpName("begin"), shape), shape);
+      TF_RETURN_IF_ERROR(scope.status());
+      for (const Edge* e : out_edges) {
+        TF_RETURN_IF_ERROR(
+            g->UpdateEdge(sliced.node(), 0, e->dst(), e->dst_input()));
+      }
+    }
+  }
+  return status;
+}
+
+Status FindAndBucketClusterShapes(Graph* g, absl::string_view boundaries_flag,
+                                  bool* changed) {
+  *changed = false;
+  if (boundaries_flag.empty()) {
+    return OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<int64_t> boundaries,
+                      ParseShapeBucketBoundaries(boundaries_flag));
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*g, &order);
+  std::map<string, std::vector<Node*>> clusters;
+  for (Node* n : order) {
+    std::optional<absl::string_view> cluster = GetXlaClusterForNode(*n);
+    if (cluster.has_value()) {
+      clusters[string(*cluster)].push_back(n);
+    }
+  }
+
+  for (const auto& [cluster_name, cluster] : clusters) {
+    TF_ASSIGN_OR_RETURN(bool is_safe,
+                        IsShapeBucketingSafeCluster(cluster_name, cluster));
+    if (!is_safe) {
+      continue;
+    }
+    TF_RETURN_IF_ERROR(
+        BucketClusterShapes(g, cluster_name, cluster, boundaries));
+    *changed = true;
+  }
+
+  if (*changed) {
+    // We've added constants to the graph; hook them up to _SOURCE.
+    FixupSourceAndSinkEdges(g);
+  }
+  return OkStatus();
+}
 }  // namespace
 
 Status IncreaseDynamismForAutoJitPass::Run(
@@ -382,6 +666,11 @@ Status IncreaseDynamismForAutoJitPass::Run(
 
   bool changed;
   TF_RETURN_IF_ERROR(FindAndRewriteSlices(options.graph->get(), &changed));
+  bool bucketed_shapes;
+  TF_RETURN_IF_ERROR(FindAndBucketClusterShapes(
+      options.graph->get(), flags->tf_xla_shape_bucket_boundaries,
+      &bucketed_shapes));
+  changed |= bucketed_shapes;
   if (changed && flags->tf_xla_clustering_debug) {
     DumpGraphToFile("increase_dynamism_for_auto_jit_pass", **options.graph,
                     options.flib_def);
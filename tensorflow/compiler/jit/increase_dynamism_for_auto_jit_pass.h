@@ -43,6 +43,21 @@ namespace tensorflow {
 // only on the actual size of the XlaDynamicSlice.  This avoids recompilation
 // due to superficial changes that don't affect tensor shapes.
 //
+// Shape bucketing
+// ---------------
+//
+// With --tf_xla_shape_bucket_boundaries, the clusters made only of elementwise
+// ops (and scalar constants) are rewritten as
+//
+//   cluster(inputs...) =>
+//     Slice(cluster(Pad(inputs, bucket(Shape(inputs)))...),
+//           0, BroadcastArgs(Shape(inputs)...))
+//
+// where bucket() rounds each dimension of size greater than one up to the
+// next bucket boundary, out of the cluster.  Such clusters are then compiled
+// once per bucket of input shapes instead of once per input shape, at the cost
+// of computing the padding.
+//
 // Future Work TODO(b/111210515)
 // -----------------------------
 //
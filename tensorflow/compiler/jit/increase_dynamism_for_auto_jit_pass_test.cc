@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -454,5 +456,69 @@ TEST(SliceToDynamicSliceRewriteTest, DontRewriteSliceWithConstBegin) {
                                            Out(NodeWith(Op("Const"))))));
 }
 
+TEST(ShapeBucketingTest, PadsInputsAndSlicesOutputs) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  flags->tf_xla_shape_bucket_boundaries = "16,128";
+
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+
+  Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT);
+  Output y = ops::Placeholder(root.WithOpName("y"), DT_FLOAT);
+  Output add = ops::Add(cluster.WithOpName("add"), x, y);
+  Output neg = ops::Neg(cluster.WithOpName("neg"), add);
+  Output out = ops::Identity(root.WithOpName("out"), neg);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(IncreaseDynamismForAutoJit(root, &result));
+  flags->tf_xla_shape_bucket_boundaries = "";
+
+  auto m_padded = [](absl::string_view input) {
+    return Out(NodeWith(
+        Op("Pad"), AssignedDevice(kDeviceName),
+        Inputs(Out(NodeWith(Name(string(input)))),
+               Out(NodeWith(Op("Pack"), AssignedDevice(kHostName))))));
+  };
+  auto m_shape = [](absl::string_view input) {
+    return Out(
+        NodeWith(Op("Shape"), Inputs(Out(NodeWith(Name(string(input)))))));
+  };
+
+  Node* add_node = testing::FindNodeByName(result.get(), "add");
+  ASSERT_NE(add_node, nullptr);
+  EXPECT_THAT(add_node, NodeWith(Inputs(m_padded("x"), m_padded("y"))));
+
+  Node* out_node = testing::FindNodeByName(result.get(), "out");
+  ASSERT_NE(out_node, nullptr);
+  EXPECT_THAT(
+      out_node,
+      NodeWith(Inputs(Out(NodeWith(
+          Op("Slice"), AssignedDevice(kDeviceName),
+          Inputs(Out(NodeWith(Name("neg"))), _,
+                 Out(NodeWith(Op("BroadcastArgs"),
+                              Inputs(m_shape("x"), m_shape("y"))))))))));
+}
+
+TEST(ShapeBucketingTest, DontBucketClusterWithNonElementwiseOp) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  flags->tf_xla_shape_bucket_boundaries = "powers_of_two";
+
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+
+  Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT);
+  Output y = ops::Placeholder(root.WithOpName("y"), DT_FLOAT);
+  Output add = ops::Add(cluster.WithOpName("add"), x, y);
+  Output matmul = ops::MatMul(cluster.WithOpName("matmul"), add, y);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(IncreaseDynamismForAutoJit(root, &result));
+  flags->tf_xla_shape_bucket_boundaries = "";
+
+  EXPECT_THAT(result->nodes(), Not(Contains(NodeWith(Op("Pad")))));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
@@ -109,6 +110,11 @@ class MarkForCompilationPassImpl {
     // stable from run to rum.
     bool deterministic_cluster_names;
 
+    // If non-empty, do not form the clusters recorded as megamorphic at
+    // runtime in this clustering profile directory.  Only used along with
+    // deterministic cluster names, which are stable from run to run.
+    std::string clustering_profile_dir;
+
     int max_cluster_size;
     int min_cluster_size;
 
@@ -963,6 +969,12 @@ Status MarkForCompilationPassImpl::CreateClusters() {
   // Names for each cluster.
   std::unordered_map<int, string> cluster_names;
 
+  // The clusters not to form because they were recorded as megamorphic.
+  absl::flat_hash_set<int> megamorphic_clusters;
+  const bool use_clustering_profile =
+      debug_options_.deterministic_cluster_names &&
+      !debug_options_.clustering_profile_dir.empty();
+
   if (debug_options_.dump_graphs) {
     DumpGraphToFile("before_mark_for_compilation", *graph_, flib_def_);
   }
@@ -989,7 +1001,8 @@ Status MarkForCompilationPassImpl::CreateClusters() {
     if (cluster->effective_cluster_size() >= debug_options_.min_cluster_size ||
         cluster->has_functional_control_flow() ||
         cluster->is_xla_compile_attr_true()) {
-      string& name = cluster_names[cluster->cycles_graph_node_id()];
+      const int cluster_id = cluster->cycles_graph_node_id();
+      string& name = cluster_names[cluster_id];
 
       if (name.empty()) {
         if (!cluster_name_prefix_.empty()) {
@@ -1002,6 +1015,20 @@ Status MarkForCompilationPassImpl::CreateClusters() {
         }
         absl::StrAppend(&name,
                         GetNextClusterSequenceNumber(graph_fingerprint_));
+
+        // The sequence number is taken regardless so that the names of the
+        // other clusters don't change.
+        if (use_clustering_profile &&
+            IsMegamorphicClusterRecorded(debug_options_.clustering_profile_dir,
+                                         name)) {
+          VLOG(2) << "Not forming " << name
+                  << " because it was recorded as megamorphic";
+          megamorphic_clusters.insert(cluster_id);
+        }
+      }
+
+      if (megamorphic_clusters.contains(cluster_id)) {
+        continue;
       }
 
       n->AddAttr(kXlaClusterAttr, name);
@@ -1917,6 +1944,8 @@ Status MarkForCompilationPass::Run(
   debug_options.ignore_xla_compile_attr = false;
   debug_options.deterministic_cluster_names =
       flags->tf_xla_deterministic_cluster_names;
+  debug_options.clustering_profile_dir =
+      flags->tf_xla_clustering_profile_directory;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
@@ -1936,6 +1965,8 @@ Status MarkForCompilationPass::RunForTest(
       flags->tf_xla_disable_resource_variable_safety_checks_for_debugging;
   debug_options.ignore_xla_compile_attr = true;
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
+  debug_options.clustering_profile_dir =
+      flags->tf_xla_clustering_profile_directory;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
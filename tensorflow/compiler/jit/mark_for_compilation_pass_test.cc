@@ -39,9 +39,11 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/tf2xla/xla_op_kernel.h"
 #include "tensorflow/compiler/tf2xla/xla_op_registry.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
@@ -53,6 +55,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
+#include "tsl/platform/path.h"
 
 using ::tensorflow::testing::FindNodeByName;
 
@@ -1859,6 +1862,44 @@ TEST(XlaCompilationTest, DeterministicClusterNames) {
   // clusters0/2 should differ from clusters1/3
 }
 
+TEST(XlaCompilationTest, MegamorphicClustersAreNotFormedAgain) {
+  auto create_graph = []() -> std::unique_ptr<Graph> {
+    Scope root = Scope::NewRootScope().ExitOnError();
+    Output a = ops::Placeholder(root.WithOpName("A"), DT_FLOAT);
+    Output b = ops::Neg(root.WithOpName("B"), a);
+    Output c = ops::Add(root.WithOpName("C"), a, b);
+    ops::Identity(root.WithOpName("D"), c);
+    std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+    TF_CHECK_OK(root.ToGraph(graph.get()));
+    return graph;
+  };
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  const std::string profile_dir =
+      tsl::io::JoinPath(testing::TmpDir(), "megamorphic_clusters");
+  flags->tf_xla_clustering_profile_directory = profile_dir;
+  auto options = MarkForCompilationPassTestHelper::Options()
+                     .WithDeterministicClusterNames();
+
+  testing::ResetClusterSequenceNumber();
+  std::unique_ptr<Graph> graph = create_graph();
+  TF_ASSERT_OK(
+      MarkForCompilationPassTestHelper::MarkForCompilation(&graph, options));
+  auto cluster_names = GetClusterNames(*graph);
+  ASSERT_EQ(cluster_names.size(), 1);
+
+  // Once recorded as megamorphic, the cluster isn't formed from the same graph
+  // when it is loaded again.
+  TF_ASSERT_OK(RecordMegamorphicCluster(profile_dir, *cluster_names.begin()));
+  testing::ResetClusterSequenceNumber();
+  graph = create_graph();
+  TF_ASSERT_OK(
+      MarkForCompilationPassTestHelper::MarkForCompilation(&graph, options));
+  EXPECT_TRUE(GetClusterNames(*graph).empty());
+
+  flags->tf_xla_clustering_profile_directory = "";
+}
+
 TEST(XlaCompilationTest, ClusterSessionName) {
   Scope root = Scope::NewRootScope().ExitOnError();
   Output variable = ops::Variable(root.WithOpName("variable"),
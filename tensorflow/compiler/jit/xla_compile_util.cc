@@ -20,6 +20,8 @@ limitations under the License.
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -28,12 +30,22 @@ limitations under the License.
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/tfrt/common/global_state.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
 
 namespace tensorflow {
 namespace {
 constexpr const char* kPjRtDeviceCompilerResourceName = "pjrt_device_compiler";
 constexpr const char* kPjRtDeviceCompilationProfilerResourceName =
     "pjrt_device_compilation_profiler";
+constexpr const char* kMegamorphicClusterSuffix = ".megamorphic";
+
+std::string MegamorphicClusterPath(absl::string_view profile_dir,
+                                   absl::string_view cluster_name) {
+  return tsl::io::JoinPath(
+      profile_dir, absl::StrCat(cluster_name, kMegamorphicClusterSuffix));
+}
 }  // namespace
 
 StatusOr<std::unique_ptr<Graph>> CreateSingleOpGraph(
@@ -115,4 +127,21 @@ StatusOr<ResourceMgr*> GetResourceMgrForDeviceCompiler(
   return rm;
 }
 
+Status RecordMegamorphicCluster(absl::string_view profile_dir,
+                                absl::string_view cluster_name) {
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(std::string(profile_dir)));
+  // The record is the existence of the file, so it needn't be written
+  // atomically.
+  return tsl::WriteStringToFile(
+      env, MegamorphicClusterPath(profile_dir, cluster_name), "");
+}
+
+bool IsMegamorphicClusterRecorded(absl::string_view profile_dir,
+                                  absl::string_view cluster_name) {
+  return tsl::Env::Default()
+      ->FileExists(MegamorphicClusterPath(profile_dir, cluster_name))
+      .ok();
+}
+
 }  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 
+#include "absl/strings/string_view.h"
 #include "tensorflow/compiler/tf2xla/xla_argument.h"
 #include "tensorflow/core/graph/graph.h"
 
@@ -62,6 +63,17 @@ std::string GetPjRtDeviceCompilationProfilerResourceName(
 StatusOr<ResourceMgr*> GetResourceMgrForDeviceCompiler(
     const OpKernelContext& ctx, const DeviceType& device_type);
 
+// Records in the clustering profile directory `profile_dir` that the cluster
+// named `cluster_name` turned out to be megamorphic, so that auto clustering
+// doesn't form it again when the model is loaded next.
+Status RecordMegamorphicCluster(absl::string_view profile_dir,
+                                absl::string_view cluster_name);
+
+// Checks if the cluster named `cluster_name` was recorded as megamorphic in
+// the clustering profile directory `profile_dir`.
+bool IsMegamorphicClusterRecorded(absl::string_view profile_dir,
+                                  absl::string_view cluster_name);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_COMPILER_JIT_XLA_COMPILE_UTIL_H_
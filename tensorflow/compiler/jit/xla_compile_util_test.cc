@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -22,7 +23,9 @@ limitations under the License.
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/tpu/tpu_defs.h"
+#include "tsl/platform/path.h"
 
 namespace tensorflow {
 namespace {
@@ -145,5 +148,15 @@ TEST(XlaCompileUtilTest, PjRtDeviceCompilationProfilerResourceName) {
       "pjrt_device_compilation_profiler_GPU");
 }
 
+TEST(XlaCompileUtilTest, RecordMegamorphicCluster) {
+  const std::string profile_dir =
+      tsl::io::JoinPath(testing::TmpDir(), "clustering_profile");
+  EXPECT_FALSE(IsMegamorphicClusterRecorded(profile_dir, "cluster_0"));
+
+  TF_EXPECT_OK(RecordMegamorphicCluster(profile_dir, "cluster_0"));
+  EXPECT_TRUE(IsMegamorphicClusterRecorded(profile_dir, "cluster_0"));
+  EXPECT_FALSE(IsMegamorphicClusterRecorded(profile_dir, "cluster_1"));
+}
+
 }  // namespace
 }  // namespace tensorflow
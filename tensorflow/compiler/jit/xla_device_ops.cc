@@ -67,6 +67,9 @@ void XlaAssignVariableOp::Compute(OpKernelContext* context) {
           DataTypeString(dtype_)));
   variable->is_initialized = true;
   *variable->tensor() = value;
+  if (DirtyRows* dirty_rows = variable->dirty_rows()) {
+    dirty_rows->RecordAll();
+  }
 }
 
 }  // namespace tensorflow
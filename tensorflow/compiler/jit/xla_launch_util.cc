@@ -503,6 +503,10 @@ Status XlaComputationLaunchContext::PopulateOutputs(
                                    use_multiple_streams_, definition_event));
     var->is_initialized |= write.modified;
     *var->tensor() = output_tensor;
+    DirtyRows* dirty_rows = var->dirty_rows();
+    if (write.modified && dirty_rows != nullptr) {
+      dirty_rows->RecordAll();
+    }
     ++output_num;
   }
   return OkStatus();
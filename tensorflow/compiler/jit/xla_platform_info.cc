@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
 #include "tensorflow/core/tfrt/common/global_state.h"
 #include "tensorflow/core/tfrt/common/pjrt_util.h"
@@ -56,6 +57,19 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Sets the options of the persistent cache which don't depend on the device.
+template <typename PersistorConfig>
+void SetPersistentCacheOptions(PersistorConfig* config) {
+  // The executables of other versions of TensorFlow (and thus XLA) are never
+  // loaded.
+  config->compiler_version = TF_VERSION_STRING;
+  config->persistent_cache_max_size_bytes =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_max_size_mb
+      << 20;
+  config->prefetch =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefetch;
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
     const XlaDeviceExecutablePersistor::Config& persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
@@ -75,6 +89,7 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  SetPersistentCacheOptions(&persistor_config);
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -199,6 +214,7 @@ Status BuildXlaDeviceCompiler(DeviceBase* device, FunctionLibraryRuntime* flr,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  SetPersistentCacheOptions(&persistor_config);
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
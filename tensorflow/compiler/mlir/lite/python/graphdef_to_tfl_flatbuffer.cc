@@ -49,8 +49,7 @@ namespace tensorflow {
 Status ConvertGraphDefToTFLiteFlatBuffer(const toco::ModelFlags& model_flags,
                                          const toco::TocoFlags& toco_flags,
                                          const GraphDebugInfo& debug_info,
-                                         const GraphDef& input,
-                                         string* result) {
+                                         GraphDef input, string* result) {
   using ::tflite::optimize::ReducedPrecisionSupport;
   mlir::MLIRContext context;
   GraphImportConfig specs;
@@ -94,8 +93,9 @@ Status ConvertGraphDefToTFLiteFlatBuffer(const toco::ModelFlags& model_flags,
   // Register all custom ops, including user-specified custom ops.
   TF_RETURN_IF_ERROR(internal::RegisterAllCustomOps(toco_flags));
 
-  TF_ASSIGN_OR_RETURN(
-      auto module, ConvertGraphdefToMlir(input, debug_info, specs, &context));
+  TF_ASSIGN_OR_RETURN(auto module,
+                      ConvertGraphdefToMlir(std::move(input), debug_info,
+                                            specs, &context));
 
   mlir::TFL::PassConfig pass_config(quant_specs);
   bool emit_builtin_tflite_ops = !toco_flags.force_select_tf_ops();
@@ -25,11 +25,13 @@ namespace tensorflow {
 
 // Converts the given GraphDef to a TF Lite FlatBuffer string according to the
 // given model flags, toco flags and debug information. Returns error status if
-// it fails to convert the input.
+// it fails to convert the input. The GraphDef is released once it has been
+// imported, so callers should move it in to avoid keeping a copy of its
+// constants alive during the conversion.
 Status ConvertGraphDefToTFLiteFlatBuffer(const toco::ModelFlags& model_flags,
                                          const toco::TocoFlags& toco_flags,
                                          const GraphDebugInfo& debug_info,
-                                         const GraphDef& input, string* result);
+                                         GraphDef input, string* result);
 
 }  // namespace tensorflow
 
@@ -4269,21 +4269,28 @@ StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ConvertGraphdefToMlir(
     const GraphDef& graphdef, const GraphDebugInfo& debug_info,
     const GraphImportConfig& specs, mlir::MLIRContext* context,
     bool add_default_attributes) {
+  return ConvertGraphdefToMlir(GraphDef(graphdef), debug_info, specs, context,
+                               add_default_attributes);
+}
+
+StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ConvertGraphdefToMlir(
+    GraphDef&& graphdef, const GraphDebugInfo& debug_info,
+    const GraphImportConfig& specs, mlir::MLIRContext* context,
+    bool add_default_attributes) {
   GraphConstructorOptions options;
   options.allow_internal_ops = true;
   options.add_default_attributes = add_default_attributes;
   Graph graph(OpRegistry::Global());
 
-  GraphDef preprocessed_graphdef(graphdef);
   if (add_default_attributes) {
-    TF_RETURN_IF_ERROR(PreprocessGraphDef(&specs, &preprocessed_graphdef));
+    TF_RETURN_IF_ERROR(PreprocessGraphDef(&specs, &graphdef));
   }
   if (specs.upgrade_legacy) {
     TF_RETURN_IF_ERROR(GenerateResourceSharedNameIfEmpty(
-        preprocessed_graphdef, graph.flib_def().default_registry()));
+        graphdef, graph.flib_def().default_registry()));
   }
-  TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
-      options, std::move(preprocessed_graphdef), &graph));
+  TF_RETURN_IF_ERROR(
+      ConvertGraphDefToGraph(options, std::move(graphdef), &graph));
   return ConvertGraphToMlir(graph, debug_info, graph.flib_def(), specs,
                             context);
 }
@@ -44,6 +44,13 @@ tsl::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ConvertGraphdefToMlir(
     const GraphImportConfig& specs, mlir::MLIRContext* context,
     bool add_default_attributes = true);
 
+// Same as above, but consumes the GraphDef instead of copying it, so that its
+// constants are not held twice while the graph is imported.
+tsl::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ConvertGraphdefToMlir(
+    GraphDef&& graphdef, const GraphDebugInfo& debug_info,
+    const GraphImportConfig& specs, mlir::MLIRContext* context,
+    bool add_default_attributes = true);
+
 // Given a Graph, returns a MLIR module containing the graph, expressed with
 // tf_executor dialect.
 tsl::StatusOr<mlir::OwningOpRef<mlir::ModuleOp>> ConvertGraphToMlir(
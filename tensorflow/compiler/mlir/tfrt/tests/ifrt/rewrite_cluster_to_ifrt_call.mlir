@@ -4,11 +4,11 @@
 
 // CHECK-LABEL: func.func @serving_default(%arg0: tensor<3x1xf32>, %arg1: tensor<1x3xf32>) -> tensor<1x1xf32> {
 // CHECK-NEXT:  %0 = "tf.IfrtCall"(%arg1, %arg0) 
-// CHECK-SAME:       {program_id = [[PROGRAM_ID:.*]] : i64, variable_names = []} 
+// CHECK-SAME:       {program_id = [[PROGRAM_ID:.*]] : i64, variable_arg_indices = [], variable_names = []} 
 // CHECK-SAME:       (tensor<1x3xf32>, tensor<3x1xf32>) -> tensor<1x1xf32>
 // CHECK-NEXT:    %1 = "tf.Identity"(%arg1) {device = ""} : (tensor<1x3xf32>) -> tensor<1x3xf32>
 // CHECK-NEXT:    %2 = "tf.IfrtCall"(%1, %arg0) 
-// CHECK-SAME:       {program_id = [[PROGRAM_ID]] : i64, variable_names = []} 
+// CHECK-SAME:       {program_id = [[PROGRAM_ID]] : i64, variable_arg_indices = [], variable_names = []} 
 // CHECK-SAME:       (tensor<1x3xf32>, tensor<3x1xf32>) -> tensor<1x1xf32>
 // CHECK-NEXT:    %3 = "tf.add"(%0, %2) : (tensor<1x1xf32>, tensor<1x1xf32>) -> tensor<1x1xf32>
 // CHECK:    return
@@ -31,4 +31,20 @@ func.func @serving_default(%arg0: tensor<3x1xf32>,  %arg1: tensor<1x3xf32>) -> (
 func.func private @_func(%arg0: tensor<1x3xf32>, %arg1: tensor<3x1xf32>) -> (tensor<1x1xf32>) {
   %outputs_0 =  "tf.MatMul"(%arg0, %arg1) {transpose_a = false, transpose_b = false} : (tensor<1x3xf32>, tensor<3x1xf32>) -> tensor<1x1xf32>
   return %outputs_0 : tensor<1x1xf32>
-}
\ No newline at end of file
+}
+// -----
+
+// CHECK-LABEL: func.func @variable_args
+// CHECK:       "tf.IfrtCall"(%arg0, %0)
+// CHECK-SAME:       variable_arg_indices = [1]
+
+func.func @variable_args(%arg0: tensor<1x3xf32>, %arg1: tensor<!tf_type.resource<tensor<3x1xf32>>>) -> (tensor<1x1xf32>) {
+  %0 = "tf.ReadVariableOp"(%arg1) : (tensor<!tf_type.resource<tensor<3x1xf32>>>) -> tensor<3x1xf32>
+  %1 = "tf_device.cluster_func"(%arg0, %0) {_producer_name = "UNKNOWN", func = @_variable_func} : (tensor<1x3xf32>, tensor<3x1xf32>) -> tensor<1x1xf32>
+  return %1 : tensor<1x1xf32>
+}
+
+func.func private @_variable_func(%arg0: tensor<1x3xf32>, %arg1: tensor<3x1xf32>) -> (tensor<1x1xf32>) {
+  %0 = "tf.MatMul"(%arg0, %arg1) {transpose_a = false, transpose_b = false} : (tensor<1x3xf32>, tensor<3x1xf32>) -> tensor<1x1xf32>
+  return %0 : tensor<1x1xf32>
+}
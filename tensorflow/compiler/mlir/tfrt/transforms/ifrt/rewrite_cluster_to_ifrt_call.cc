@@ -23,6 +23,7 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/Attributes.h"  // from @llvm-project
@@ -108,6 +109,19 @@ class RewriteClusterToIfrtCallPass
     }
   }
 
+  // Returns the indices of the operands of `cluster_func` read from variables.
+  static mlir::ArrayAttr GetVariableArgIndices(
+      mlir::OpBuilder &builder, mlir::tf_device::ClusterFuncOp cluster_func) {
+    llvm::SmallVector<int64_t> variable_arg_indices;
+    for (const auto &[i, operand] :
+         llvm::enumerate(cluster_func->getOperands())) {
+      if (operand.getDefiningOp<mlir::TF::ReadVariableOp>()) {
+        variable_arg_indices.push_back(i);
+      }
+    }
+    return builder.getI64ArrayAttr(variable_arg_indices);
+  }
+
   void Rewrite(mlir::SymbolTable &symbol_table,
                llvm::DenseMap<mlir::func::FuncOp, mlir::func::FuncOp>
                    &cluster_to_ifrt_program,
@@ -139,6 +153,8 @@ class RewriteClusterToIfrtCallPass
       // TODO(b/304839793): populate variable names after adding a variable
       // hoisting pass.
       ifrt_call_op.setVariableNamesAttr(builder.getArrayAttr({}));
+      ifrt_call_op.setVariableArgIndicesAttr(
+          GetVariableArgIndices(builder, cluster_func));
       ifrt_call_op.setProgramId(program_id);
 
       cluster_func->replaceAllUsesWith(ifrt_call_op.getResults());
@@ -171,6 +187,8 @@ class RewriteClusterToIfrtCallPass
     // TODO(b/304839793): populate variable names after adding a variable
     // hoisting pass.
     ifrt_call_op.setVariableNamesAttr(builder.getArrayAttr({}));
+    ifrt_call_op.setVariableArgIndicesAttr(
+        GetVariableArgIndices(builder, cluster_func));
     ifrt_call_op.setProgramId(program_id);
 
     cluster_func->replaceAllUsesWith(ifrt_call_op.getResults());
@@ -94,6 +94,52 @@ TEST(MlirToByteCodeTest, Basic) {
   EXPECT_TRUE(kernels[10].results().empty());
 }
 
+TEST(MlirToByteCodeTest, UnusedResultsFreeRegisters) {
+  constexpr char kUnusedResultsMlir[] =
+      "tensorflow/compiler/mlir/tfrt/translate/mlrt/testdata/"
+      "unused_results.mlir";
+
+  mlir::DialectRegistry registry;
+  registry.insert<mlir::func::FuncDialect>();
+  mlir::MLIRContext mlir_context(registry);
+  mlir_context.allowUnregisteredDialects();
+  auto mlir_module = mlir::parseSourceFile<mlir::ModuleOp>(
+      tsl::GetDataDependencyFilepath(kUnusedResultsMlir), &mlir_context);
+
+  AttributeEncoderRegistry attribute_encoder_registry;
+  bc::Buffer buffer =
+      EmitExecutable(attribute_encoder_registry, mlir_module.get()).value();
+
+  bc::Executable executable(buffer.data());
+
+  auto functions = executable.functions();
+  ASSERT_GE(functions.size(), 1);
+
+  auto function = functions[0];
+  EXPECT_EQ(function.name().str(), "unused_results");
+  // The register of the unused result of the first kernel is reused by the
+  // second one.
+  EXPECT_EQ(function.num_regs(), 3);
+
+  auto kernels = function.kernels();
+  ASSERT_EQ(kernels.size(), 4);
+
+  EXPECT_THAT(kernels[0].results(), ElementsAreArray({1, 2}));
+  EXPECT_THAT(kernels[0].arguments(), ElementsAreArray({0, 0}));
+  EXPECT_THAT(kernels[0].last_uses(), ElementsAreArray({0, 0}));
+
+  EXPECT_THAT(kernels[1].results(), ElementsAreArray({2}));
+  EXPECT_THAT(kernels[1].arguments(), ElementsAreArray({1, 0}));
+  EXPECT_THAT(kernels[1].last_uses(), ElementsAreArray({1, 0}));
+
+  EXPECT_THAT(kernels[2].results(), ElementsAreArray({1}));
+  EXPECT_THAT(kernels[2].arguments(), ElementsAreArray({2, 0}));
+  EXPECT_THAT(kernels[2].last_uses(), ElementsAreArray({1, 1}));
+
+  EXPECT_THAT(kernels[3].arguments(), ElementsAreArray({1}));
+  EXPECT_THAT(kernels[3].last_uses(), ElementsAreArray({1}));
+}
+
 template <typename T>
 absl::StatusOr<T> DecodeAttribute(absl::string_view data) {
   if (data.size() < sizeof(T))
@@ -17,7 +17,9 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
+#include "tensorflow/compiler/tf2tensorrt/common/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
@@ -41,6 +43,14 @@ namespace tensorflow {
 namespace tensorrt {
 using ::nvinfer1::IRuntime;
 
+namespace {
+// Returns the version of the TensorRT library building and deserializing the
+// engines.
+string GetTensorRTVersionString() {
+  return absl::StrJoin(GetLoadedTensorRTVersion(), ".");
+}
+}  // namespace
+
 class CreateTRTResourceHandle : public OpKernel {
  public:
   explicit CreateTRTResourceHandle(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -134,6 +144,16 @@ class InitializeTRTResource : public OpKernel {
 
       TRTEngineInstance engine_instance;
       engine_instance.ParseFromString(record);
+      // Engines saved before the version was recorded are assumed to match.
+      if (!engine_instance.tensorrt_version().empty() &&
+          engine_instance.tensorrt_version() != GetTensorRTVersionString()) {
+        LOG(WARNING) << "Not loading a TRT engine for op " << handle.name()
+                     << " built by TensorRT "
+                     << engine_instance.tensorrt_version()
+                     << ", the engine will be rebuilt by TensorRT "
+                     << GetTensorRTVersionString();
+        continue;
+      }
       std::vector<TensorShape> engine_input_shapes;
       const auto& input_shapes = engine_instance.input_shapes();
       engine_input_shapes.reserve(input_shapes.size());
@@ -148,6 +168,11 @@ class InitializeTRTResource : public OpKernel {
           infer->deserializeCudaEngine(
               engine_instance.serialized_engine().c_str(),
               engine_instance.serialized_engine().size(), nullptr));
+      if (engine == nullptr) {
+        LOG(WARNING) << "Failed to deserialize a TRT engine for op "
+                     << handle.name() << ", the engine will be rebuilt";
+        continue;
+      }
       auto raw_engine = engine.get();
       std::vector<ExecutionContext> ctx_vec;
       if (num_loaded_engine == 0) {
@@ -250,6 +275,7 @@ class SerializeTRTResource : public OpKernel {
             engine->GetCudaEngine()->serialize());
         engine_instance.set_serialized_engine(engine_data->data(),
                                               engine_data->size());
+        engine_instance.set_tensorrt_version(GetTensorRTVersionString());
 
         if (export_trt_engines_env) {
           const std::string engine_filename =
@@ -335,6 +335,8 @@ TEST_P(TRTEngineResourceOpsTest, Basic) {
   for (int i = 0; i < param_.dims.nbDims; i++) {
     EXPECT_EQ(param_.dims.d[i], engine_instance.input_shapes(0).dim(i).size());
   }
+  EXPECT_EQ(absl::StrJoin(GetLoadedTensorRTVersion(), "."),
+            engine_instance.tensorrt_version());
   EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRecord(&offset, &record)));
 
   // Recreate the resource and use the file with the serialized engine to
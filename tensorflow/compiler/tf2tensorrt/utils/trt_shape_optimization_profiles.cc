@@ -487,17 +487,28 @@ int TrtShapeOptimizationProfile::GetProfileNumber(
       "TrtShapeOptimizationProfile::GetProfileNumber",
       tensorflow::profiler::TraceMeLevel::kInfo);
   if (!need_profiles_) return 0;
-  // TODO(tfeher): Return the best profile not just the first compatible.
+  // Return the compatible profile with the closest optimum dimensions, the
+  // first one if there are several.
+  int best_profile = -1;
+  int64_t best_distance = 0;
   for (int i = 0; i < profiles_.size(); i++) {
-    if (profiles_[i].IncludesShapes(shapes, HasShapeTensor(),
-                                    actual_shape_values_, is_pruned_input_,
-                                    is_shape_tensor_)) {
-      return i;
+    if (!profiles_[i].IncludesShapes(shapes, HasShapeTensor(),
+                                     actual_shape_values_, is_pruned_input_,
+                                     is_shape_tensor_)) {
+      continue;
+    }
+    const int64_t distance =
+        profiles_[i].DistanceToOpt(shapes, is_pruned_input_);
+    if (best_profile < 0 || distance < best_distance) {
+      best_profile = i;
+      best_distance = distance;
     }
   }
-  VLOG(1) << "Profile not found for input shapes " << DebugString(shapes);
-  VLOG(2) << "  and shape values " << DebugString(actual_shape_values_);
-  return -1;
+  if (best_profile < 0) {
+    VLOG(1) << "Profile not found for input shapes " << DebugString(shapes);
+    VLOG(2) << "  and shape values " << DebugString(actual_shape_values_);
+  }
+  return best_profile;
 }
 
 Status TrtShapeOptimizationProfile::CreateExecutionContexts(
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_SHAPE_OPTIMIZATION_PROFILES_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_SHAPE_OPTIMIZATION_PROFILES_H_
 
+#include <cstdlib>
 #include <list>
 #include <string>
 #include <unordered_set>
@@ -190,6 +191,24 @@ struct OptimizationProfileConfig {
     }
     return true;
   }
+
+  // Returns the distance of the given shapes to the optimum dimensions of the
+  // profile, the sum of the differences of their dimensions. TRT selects the
+  // kernels for the optimum dimensions, so that among the profiles including
+  // the shapes, the closest one is expected to run them the fastest.
+  int64_t DistanceToOpt(const std::vector<TensorShape>& shapes,
+                        const std::vector<bool>& is_pruned_input) const {
+    int64_t distance = 0;
+    for (int i = 0; i < shapes.size(); i++) {
+      if (is_pruned_input[i]) {
+        continue;
+      }
+      for (int dim = 0; dim < shapes[i].dims(); dim++) {
+        distance += std::abs(shapes[i].dim_size(dim) - opt[i].d[dim]);
+      }
+    }
+    return distance;
+  }
 };
 
 // Manages Optimization profiles during TRT Engine construction.
@@ -250,6 +250,22 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST(OptimizationProfileConfigTest, DistanceToOpt) {
+  OptimizationProfileConfig config;
+  config.min = {nvinfer1::Dims2(1, 10), nvinfer1::Dims2(1, 10), {0, {}},
+                {0, {}}};
+  config.opt = {nvinfer1::Dims2(4, 10), nvinfer1::Dims2(4, 10), {0, {}},
+                {0, {}}};
+  config.max = {nvinfer1::Dims2(8, 10), nvinfer1::Dims2(8, 10), {0, {}},
+                {0, {}}};
+  std::vector<TensorShape> shapes = {TensorShape({4, 10}),
+                                     TensorShape({7, 10})};
+
+  EXPECT_EQ(3, config.DistanceToOpt(shapes, {false, false}));
+  // Pruned inputs aren't taken into account.
+  EXPECT_EQ(0, config.DistanceToOpt(shapes, {false, true}));
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
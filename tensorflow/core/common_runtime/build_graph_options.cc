@@ -32,6 +32,12 @@ string BuildGraphOptions::DebugString() const {
   for (auto& s : callable_options.target()) {
     strings::StrAppend(&rv, s, ", ");
   }
+  if (!feed_shapes.empty()) {
+    strings::StrAppend(&rv, "\nFeed shapes: ");
+    for (auto& it : feed_shapes) {
+      strings::StrAppend(&rv, it.first, ": ", it.second.DebugString(), ", ");
+    }
+  }
   if (collective_graph_key != kNoCollectiveGraphKey) {
     strings::StrAppend(&rv, "\ncollective_graph_key: ", collective_graph_key);
   }
@@ -16,8 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BUILD_GRAPH_OPTIONS_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BUILD_GRAPH_OPTIONS_H_
 
+#include <map>
 #include <vector>
 
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/graph/collective_order.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -40,6 +42,12 @@ struct BuildGraphOptions {
   // edges, if `kAttrs` encode as attribute on collective op.
   GraphCollectiveOrder collective_order = GraphCollectiveOrder::kNone;
 
+  // The concrete shapes of some of the feeds, by feed name. If not empty, the
+  // graph is optimized for these shapes, e.g. shape computations on the fed
+  // placeholders are folded, so it must only be run with feeds of these
+  // shapes.
+  std::map<string, TensorShape> feed_shapes;
+
   string DebugString() const;
 };
 
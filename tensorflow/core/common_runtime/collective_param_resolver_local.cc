@@ -68,7 +68,17 @@ const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
       return nccl ? "NcclBroadcast" : "HierarchicalTreeBroadcast";
 
     case REDUCTION_COLLECTIVE:
-      return nccl ? "NcclReduce" : "RingReduce";
+      if (nccl) return "NcclReduce";
+      if (cp->instance.impl_details.communication_hint == "hierarchical") {
+        return "HierarchicalReduce";
+      }
+      if (cp->instance.impl_details.communication_hint == "int8" &&
+          cp->group.device_type == DEVICE_CPU &&
+          (cp->instance.data_type == DT_FLOAT ||
+           cp->instance.data_type == DT_DOUBLE)) {
+        return "QuantizedRingReduce";
+      }
+      return "RingReduce";
 
     case GATHER_COLLECTIVE:
       return nccl ? "NcclGather" : "RingGather";
@@ -692,6 +702,12 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
   //
   // After enough testing, we may simplify this logic to use NCCL whenever
   // available.
+  //
+  // Otherwise, all-reduce uses the hierarchical implementation, or the ring
+  // implementation with 8-bit quantized transfers, if indicated in
+  // `communication_hint`, and the ring implementation by default.  The latter
+  // only supports float and double tensors on CPU, and falls back to the ring
+  // implementation otherwise.
   CollectiveImplementationInterface* col_impl;
   bool use_nccl =
       (nccl_ || cp->instance.impl_details.communication_hint == "nccl") &&
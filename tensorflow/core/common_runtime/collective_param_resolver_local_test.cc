@@ -208,6 +208,51 @@ TEST_F(CollectiveParamResolverLocalTest, CompleteParamsReduction1Task) {
   }
 }
 
+TEST_F(CollectiveParamResolverLocalTest,
+       CompleteParamsHierarchicalReduction1Task) {
+  CollectiveParams* cps[NUM_DEVS];
+  Status statuses[NUM_DEVS];
+  Notification note[NUM_DEVS];
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    cps[i] = new CollectiveParams();
+    CollectiveParams* cp = cps[i];
+    cp->group.group_key = 1;
+    cp->group.group_size = 3;
+    cp->group.device_type = DeviceType("CPU");
+    cp->group.num_tasks = 1;
+    cp->instance.instance_key = 7;
+    cp->instance.type = REDUCTION_COLLECTIVE;
+    cp->instance.data_type = DataType(DT_FLOAT);
+    cp->instance.shape = TensorShape({5});
+    cp->instance.impl_details.subdiv_offsets.push_back(0);
+    cp->instance.impl_details.communication_hint = "hierarchical";
+    cp->is_source = false;
+    Env::Default()->SchedClosure([this, i, cp, &note, &statuses]() {
+      string device =
+          strings::StrCat("/job:localhost/replica:0/task:0/device:CPU:", i);
+      prl_->CompleteParamsAsync(GetDeviceAttributes(device), cp,
+                                nullptr /*CancellationManager*/,
+                                [&statuses, &note, i](const Status& s) {
+                                  statuses[i] = s;
+                                  note[i].Notify();
+                                });
+    });
+  }
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    note[i].WaitForNotification();
+  }
+  for (int i = 0; i < NUM_DEVS; ++i) {
+    TF_ASSERT_OK(statuses[i]);
+    EXPECT_EQ(cps[i]->instance.impl_details.collective_name,
+              "HierarchicalReduce");
+    ASSERT_EQ(cps[i]->instance.impl_details.subdiv_permutations.size(), 1);
+    EXPECT_EQ(cps[i]->instance.impl_details.subdiv_permutations[0],
+              std::vector<int>({0, 1, 2}));
+    EXPECT_EQ(cps[i]->subdiv_rank, std::vector<int>({i}));
+    cps[i]->Unref();
+  }
+}
+
 void InitializeCollectiveParamsForBroadcast(int instance_key, int device_idx,
                                             bool is_source,
                                             CollectiveParams* cp) {
@@ -37,6 +37,21 @@ inline constexpr char kTpuNoSmearCostName[] = "tpu_no_smear";
 inline constexpr char kGcuWithSmearCostName[] = "gcu_with_smear";
 inline constexpr char kGcuNoSmearCostName[] = "gcu_no_smear";
 
+// Stages of the per-request latency breakdown.
+//
+// Waiting in a batching queue until the batch starts being processed.
+inline constexpr char kQueueLatencyName[] = "queue";
+// Concatenating the inputs of a batch.
+inline constexpr char kBatchFormationLatencyName[] = "batch_formation";
+// Running the computation, e.g. the batch function.
+inline constexpr char kComputeLatencyName[] = "compute";
+// Splitting the outputs of a batch into those of its requests.
+inline constexpr char kOutputSplitLatencyName[] = "output_split";
+// Waiting for remote calls.
+inline constexpr char kRpcLatencyName[] = "rpc";
+// Waiting for the elements of tf.data iterators.
+inline constexpr char kInputPipelineLatencyName[] = "input_pipeline";
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_CONSTANTS_H_
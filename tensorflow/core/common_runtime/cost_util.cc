@@ -20,9 +20,13 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor_registry.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/str_util.h"
 
 namespace tensorflow {
@@ -68,4 +72,30 @@ std::unique_ptr<RequestCostAccessor> CreateRequestCostAccessor() {
              : nullptr;
 }
 
+void RecordRequestLatency(RequestCost* request_cost, absl::string_view stage,
+                          absl::Duration latency) {
+  if (request_cost == nullptr) return;
+  request_cost->RecordLatency(stage, latency);
+
+  static auto* cell = monitoring::Sampler<1>::New(
+      {"/tensorflow/core/request_latency_breakdown",
+       "Tracks the latencies (in microseconds) of the stages of processing rpc "
+       "requests.",
+       "stage"},
+      // It's 27 buckets with the last bucket being 2^26 to DBL_MAX;
+      // so the limits are [1, 2, 4, 8, ..., 64 * 1024 * 1024 (~64s), DBL_MAX].
+      monitoring::Buckets::Exponential(1, 2, 27));
+  cell->GetCell(std::string(stage))
+      ->Add(absl::ToDoubleMicroseconds(latency));
+}
+
+void RecordRequestLatency(absl::string_view stage, absl::Duration latency) {
+  if (GetRequestCostAccessorType() == nullptr) return;
+  std::unique_ptr<RequestCostAccessor> request_cost_accessor =
+      CreateRequestCostAccessor();
+  if (request_cost_accessor == nullptr) return;
+  RecordRequestLatency(request_cost_accessor->GetRequestCost(), stage,
+                       latency);
+}
+
 }  // namespace tensorflow
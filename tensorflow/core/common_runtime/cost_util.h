@@ -19,7 +19,10 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor.h"
 
 namespace tensorflow {
@@ -34,6 +37,17 @@ std::vector<std::unique_ptr<CostMeasurement>> CreateCostMeasurements(
 // CostMeasurement is unregistered..
 std::unique_ptr<RequestCostAccessor> CreateRequestCostAccessor();
 
+// Records the `latency` of `stage` (see cost_constants.h) in `request_cost`,
+// and exports it to the /tensorflow/core/request_latency_breakdown metric. Does
+// nothing if `request_cost` is null.
+void RecordRequestLatency(RequestCost* request_cost, absl::string_view stage,
+                          absl::Duration latency);
+
+// Same as above, for the RequestCost of the current rpc request. Does nothing
+// if no RequestCostAccessor is specified in env, so it's cheap to call on hot
+// paths.
+void RecordRequestLatency(absl::string_view stage, absl::Duration latency);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_UTIL_H_
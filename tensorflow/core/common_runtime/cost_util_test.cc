@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/cost_util.h"
 
+#include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor_registry.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
@@ -71,5 +73,23 @@ TEST(CreateRequestCostAccessorTest, Basic) {
   EXPECT_EQ(test_req_cost_accessor->GetRequestCost(), nullptr);
 }
 
+TEST(RecordRequestLatencyTest, RecordsInRequestCost) {
+  RequestCost request_cost;
+  RecordRequestLatency(&request_cost, kQueueLatencyName,
+                       absl::Milliseconds(1));
+  RecordRequestLatency(&request_cost, kQueueLatencyName,
+                       absl::Milliseconds(2));
+  RecordRequestLatency(&request_cost, kComputeLatencyName,
+                       absl::Milliseconds(5));
+  // Null request costs are ignored.
+  RecordRequestLatency(/*request_cost=*/nullptr, kComputeLatencyName,
+                       absl::Milliseconds(5));
+
+  const auto latencies = request_cost.GetLatencies();
+  EXPECT_EQ(latencies.size(), 2);
+  EXPECT_EQ(latencies.at(kQueueLatencyName), absl::Milliseconds(3));
+  EXPECT_EQ(latencies.at(kComputeLatencyName), absl::Milliseconds(5));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -109,8 +113,8 @@ EventMgr::~EventMgr() {
   StopPollingLoop();
 
   for (auto& [stream, stream_callbacks] : callbacks_) {
-    for (auto& [event, callback] : stream_callbacks) {
-      threadpool_.Schedule(std::move(callback));
+    for (PendingCallback& pending : stream_callbacks) {
+      threadpool_.Schedule(std::move(pending.callback));
     }
   }
   // The threadpool's destructor will block waiting for all outstanding
@@ -181,7 +185,8 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   stream->ThenRecordEvent(e.get());
 
   bool was_empty = callbacks_.empty();
-  callbacks_[stream].push_back({std::move(e), std::move(func)});
+  callbacks_[stream].push_back(
+      {std::move(e), std::move(func), Env::Default()->NowMicros()});
 
   // Wake up the polling thread if it was sleeping.
   if (was_empty) {
@@ -196,10 +201,17 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
 // spikes of up to several hundred outstanding.  (If GPUKernelTracker
 // is used to cap pending kernels there should never be more than
 // that many.)
+//
+// The callbacks of the events found complete are run in order by a single
+// closure of the threadpool, rather than one closure each.
 void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
   VLOG(2) << "PollEvents with one or more callbacks pending on "
           << callbacks_.size() << " streams and " << free_events_.size()
           << " unused event objects.";
+  const uint64 now_usecs = Env::Default()->NowMicros();
+  std::vector<std::function<void()>> completed_callbacks;
+  // The time after which the first completed event completed.
+  uint64 first_completed_after_usecs = 0;
 
   // Polls the events for one stream.
   //
@@ -208,10 +220,11 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
   auto poll_events_for_stream_it =
       [&](auto& stream_it) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         auto& stream_callbacks = stream_it->second;
+        uint64& last_pending_usecs = last_pending_usecs_[stream_it->first];
 
         auto it = stream_callbacks.begin();
         while (it != stream_callbacks.end()) {
-          auto& [event, callback] = *it;
+          auto& [event, callback, enqueue_usecs] = *it;
 
           se::Event::Status s = event->PollForStatus();
           bool keep_looping = true;
@@ -225,11 +238,16 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
             case se::Event::Status::kPending:
               // If this event is still pending, then all events after it are
               // guaranteed to be pending as well, so we can stop looping.
+              last_pending_usecs = now_usecs;
               keep_looping = false;
               break;
             case se::Event::Status::kComplete:
+              if (completed_callbacks.empty()) {
+                first_completed_after_usecs =
+                    std::max(enqueue_usecs, last_pending_usecs);
+              }
               free_events_.push_back(std::move(event));
-              threadpool_.Schedule(std::move(callback));
+              completed_callbacks.push_back(std::move(callback));
               // std::deque::erase() does invalidate iterators, so we can't
               // erase `it` here.  Instead, we'll wait until the end of the loop
               // over stream_callbacks and erase all of the completed events at
@@ -249,6 +267,7 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
         if (stream_callbacks.empty()) {
           // absl::flat_hash_map::erase doesn't invalidate iterators, so this is
           // safe.
+          last_pending_usecs_.erase(stream_it->first);
           callbacks_.erase(stream_it++);
         } else {
           stream_it++;
@@ -267,6 +286,19 @@ void EventMgr::PollEvents(se::Stream* stream /*=nullptr*/) {
       poll_events_for_stream_it(stream_it);
     }
   }
+
+  if (!completed_callbacks.empty()) {
+    threadpool_.Schedule([callbacks = std::move(completed_callbacks),
+                          first_completed_after_usecs]() {
+      // An upper bound of the time between the completion of the first event
+      // and its callback.
+      metrics::UpdateEventMgrCallbackDelay(Env::Default()->NowMicros() -
+                                           first_completed_after_usecs);
+      for (const std::function<void()>& callback : callbacks) {
+        callback();
+      }
+    });
+  }
 }
 
 EventMgrFactory* EventMgrFactory::Singleton() {
@@ -109,11 +109,22 @@ class EventMgr {
   // A stack of unused events
   std::vector<std::unique_ptr<se::Event>> free_events_ TF_GUARDED_BY(mu_);
 
+  struct PendingCallback {
+    std::unique_ptr<se::Event> event;
+    std::function<void()> callback;
+    // When the callback was enqueued, in microseconds.
+    uint64 enqueue_usecs;
+  };
+
   // Callbacks waiting on their events to complete.
-  absl::flat_hash_map<
-      se::Stream*,
-      std::deque<std::pair<std::unique_ptr<se::Event>, std::function<void()>>>>
-      callbacks_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<se::Stream*, std::deque<PendingCallback>> callbacks_
+      TF_GUARDED_BY(mu_);
+
+  // The last time an event of each stream of callbacks_ was polled and found
+  // pending, in microseconds.  The events still queued after it completed
+  // later.
+  absl::flat_hash_map<se::Stream*, uint64> last_pending_usecs_
+      TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
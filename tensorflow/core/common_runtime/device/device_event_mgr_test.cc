@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
 #include <atomic>
+#include <numeric>
+#include <vector>
 
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/stream_executor.h"
@@ -136,6 +139,37 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that the callbacks completed by one poll run in their order.
+TEST(EventMgr, CompletedCallbacksRunInOrder) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+
+  constexpr int kNumCallbacks = 10;
+  mutex mu;
+  std::vector<int> order;
+  BlockingCounter counter(kNumCallbacks);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [i, &mu, &order, &counter]() {
+      {
+        mutex_lock l(mu);
+        order.push_back(i);
+      }
+      counter.DecrementCount();
+    });
+  }
+  th.PollEvents();
+  counter.Wait();
+
+  EXPECT_EQ(0, th.queue_size());
+  std::vector<int> expected_order(kNumCallbacks);
+  std::iota(expected_order.begin(), expected_order.end(), 0);
+  EXPECT_EQ(expected_order, order);
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
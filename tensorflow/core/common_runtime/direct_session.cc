@@ -17,9 +17,11 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <map>
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -41,14 +43,17 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/tensor_arena.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/logging.h"
+#include "tensorflow/core/framework/memory_types.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/run_handler.h"
+#include "tensorflow/core/framework/shared_tensor_store.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
@@ -63,6 +68,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -71,8 +77,10 @@ limitations under the License.
 #include "tensorflow/core/nccl/collective_communicator.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
@@ -90,6 +98,25 @@ auto* direct_session_runs = monitoring::Counter<0>::New(
     "/tensorflow/core/direct_session_runs",
     "The number of times DirectSession::Run() has been called.");
 
+// The maximum number of distinct sets of input shapes for which the tensor
+// arena of a callable keeps a memory plan.
+constexpr int kMaxTensorArenaPlans = 16;
+
+// Returns a key that identifies the types and shapes of the arguments in
+// `call_frame`, which determine the allocation pattern of a step.
+uint64 TensorArenaKey(CallFrameInterface* call_frame) {
+  uint64 key = call_frame->num_args();
+  for (int i = 0; i < call_frame->num_args(); ++i) {
+    const Tensor* arg;
+    if (!call_frame->GetArg(i, &arg).ok()) continue;
+    key = Hash64Combine(key, arg->dtype());
+    for (int64_t dim : arg->shape().dim_sizes()) {
+      key = Hash64Combine(key, dim);
+    }
+  }
+  return key;
+}
+
 Status NewThreadPoolFromThreadPoolOptions(
     const SessionOptions& options,
     const ThreadPoolOptionProto& thread_pool_options, int pool_number,
@@ -160,6 +187,77 @@ string GetRendezvousKey(const string& tensor_name,
                          frame_iter.frame_id, ":", frame_iter.iter_id);
 }
 
+// Merges the statistics of a kernel that appears in several executors (e.g.
+// executors for different fetches of the same graph) into `to`. The combined
+// cost estimate is the one that is based on more observations.
+void MergeNodeCostStats(const NodeCostStats& from, NodeCostStats* to) {
+  auto count = [](const NodeCostStats& stats) {
+    int64_t count = 0;
+    for (uint64 bucket : stats.bucket()) count += bucket;
+    return count;
+  };
+  if (count(from) > count(*to)) {
+    to->set_cost_estimate_cycles(from.cost_estimate_cycles());
+  }
+  if (from.bucket_size() == to->bucket_size() &&
+      std::equal(from.bucket_limit().begin(), from.bucket_limit().end(),
+                 to->bucket_limit().begin(), to->bucket_limit().end())) {
+    for (int i = 0; i < from.bucket_size(); ++i) {
+      to->set_bucket(i, to->bucket(i) + from.bucket(i));
+    }
+  }
+}
+
+// Appends the rendezvous keys of the root-frame Send/Recv pairs that the graph
+// partitioner inserted in `graph` to `keys`.
+Status AppendRendezvousKeys(const Graph& graph, std::vector<string>* keys) {
+  for (const Node* n : graph.op_nodes()) {
+    if (!IsSend(n) && !IsRecv(n)) continue;
+    bool client_terminated = false;
+    TF_RETURN_IF_ERROR(
+        GetNodeAttr(n->attrs(), "client_terminated", &client_terminated));
+    if (client_terminated) continue;
+    string send_device;
+    string recv_device;
+    string tensor_name;
+    int64_t send_device_incarnation;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "send_device", &send_device));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "recv_device", &recv_device));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "tensor_name", &tensor_name));
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "send_device_incarnation",
+                                   &send_device_incarnation));
+    keys->push_back(Rendezvous::CreateKey(
+        send_device, static_cast<uint64>(send_device_incarnation), recv_device,
+        tensor_name, FrameAndIter(0, 0)));
+  }
+  return OkStatus();
+}
+
+// Returns true if the steps of the single partition `graph` on a device of
+// type `device_type` can be recorded into a step graph: a replay must compute
+// the same thing as a step would, from its args alone, and must only touch
+// device memory.
+bool CanCaptureStepGraph(const Graph& graph, const DeviceType& device_type) {
+  if (device_type != DeviceType(DEVICE_GPU)) return false;
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsArg() || n->IsRetval()) continue;
+    if (n->IsControlFlow() || n->IsFunctionCall() || n->IsSend() ||
+        n->IsRecv() || n->op_def().is_stateful()) {
+      return false;
+    }
+    MemoryTypeVector input_memory_types;
+    MemoryTypeVector output_memory_types;
+    if (!MemoryTypesForNode(graph.op_registry(), device_type, n->def(),
+                            &input_memory_types, &output_memory_types)
+             .ok() ||
+        absl::c_linear_search(input_memory_types, HOST_MEMORY) ||
+        absl::c_linear_search(output_memory_types, HOST_MEMORY)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 class DirectSessionFactory : public SessionFactory {
@@ -294,11 +392,19 @@ static RunHandlerPool* GetOrCreateRunHandlerPool(
     }
   }
 
+  // Partition the pool by NUMA node, so that the inter- and intra-op work of
+  // a request stays on one node.
+  const int num_numa_nodes = options.config.experimental().use_numa_affinity()
+                                 ? port::NUMANumNodes()
+                                 : 1;
+
   static RunHandlerPool* pool = [&]() {
     LOG(INFO) << "Creating run-handler pool with "
-                 "[num_inter_threads, num_intra_threads] as ["
-              << num_inter_threads << "," << num_intra_threads << "]";
-    return new RunHandlerPool(num_inter_threads, num_intra_threads);
+                 "[num_inter_threads, num_intra_threads, num_numa_nodes] as ["
+              << num_inter_threads << "," << num_intra_threads << ","
+              << num_numa_nodes << "]";
+    return new RunHandlerPool(num_inter_threads, num_intra_threads,
+                              num_numa_nodes);
   }();
   return pool;
 }
@@ -403,6 +509,7 @@ DirectSession::~DirectSession() {
     it.second.reset();
   }
   callables_.clear();
+  specialized_executors_.clear();
   for (auto d : device_mgr_->ListDevices()) {
     d->op_segment()->RemoveHold(session_handle_);
   }
@@ -414,6 +521,10 @@ DirectSession::~DirectSession() {
 
   execution_state_.reset(nullptr);
   flib_def_.reset(nullptr);
+  if (SharedTensorStore::Enabled()) {
+    // Drop the constants and restored weights no other session uses.
+    SharedTensorStore::Global()->ReleaseUnused();
+  }
 }
 
 Status DirectSession::Create(const GraphDef& graph) {
@@ -443,6 +554,49 @@ Status DirectSession::Extend(GraphDef&& graph) {
   return ExtendLocked(std::move(graph));
 }
 
+void DirectSession::MaybeCreateOptimizedGraphCache() {
+  const ConfigProto::Experimental& experimental =
+      options_.config.experimental();
+  const string& cache_file = experimental.optimized_graph_cache_file();
+  OptimizedGraphCacheDef cache_def;
+  if (!cache_file.empty()) {
+    Status s = ReadBinaryProto(options_.env, cache_file, &cache_def);
+    if (!s.ok()) {
+      LOG(WARNING) << "Not loading the optimized graphs from " << cache_file
+                   << ": " << s;
+      cache_def.Clear();
+    }
+  }
+  // Without an explicit size, make room for the graphs of the file.
+  int cache_size = experimental.optimized_graph_cache_size();
+  if (cache_size == 0) cache_size = cache_def.entry_size();
+  if (cache_size <= 0) return;
+
+  optimized_graph_cache_ = std::make_shared<OptimizedGraphCache>(cache_size);
+  if (cache_def.entry_size() > 0) {
+    Status s = optimized_graph_cache_->AddFromProto(cache_def);
+    if (s.ok()) {
+      VLOG(1) << "Loaded " << cache_def.entry_size()
+              << " optimized graphs from " << cache_file;
+    } else {
+      LOG(WARNING) << "Not reusing the optimized graphs of " << cache_file
+                   << ": " << s;
+    }
+  }
+}
+
+Status DirectSession::ExportOptimizedGraphCache(OptimizedGraphCacheDef* def) {
+  mutex_lock l(graph_state_lock_);
+  if (optimized_graph_cache_ == nullptr) {
+    return errors::FailedPrecondition(
+        "The session does not cache its optimized graphs. Set "
+        "ConfigProto.Experimental.optimized_graph_cache_size to enable the "
+        "cache.");
+  }
+  optimized_graph_cache_->ToProto(def);
+  return OkStatus();
+}
+
 Status DirectSession::ExtendLocked(GraphDef&& graph) {
   if (finalized_) {
     return errors::FailedPrecondition("Session has been finalized.");
@@ -454,6 +608,9 @@ Status DirectSession::ExtendLocked(GraphDef&& graph) {
     options.device_set = &device_set_;
     options.session_options = &options_;
     options.session_handle = session_handle_;
+    MaybeCreateOptimizedGraphCache();
+    options.optimized_graph_cache = optimized_graph_cache_;
+    options.graph_construction_thread_pool = thread_pools_[0].first;
     TF_RETURN_IF_ERROR(GraphExecutionState::MakeForBaseGraph(
         std::move(graph), options, &execution_state_));
     // NOTE(mrry): The function library created here will be used for
@@ -517,7 +674,7 @@ Status DirectSession::RunInternal(
     int64_t step_id, const RunOptions& run_options,
     CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
     RunMetadata* run_metadata,
-    const thread::ThreadPoolOptions& threadpool_options) {
+    const thread::ThreadPoolOptions& threadpool_options, StepGraph* capture) {
   const uint64 start_time_usecs = options_.env->NowMicros();
   const int64_t executor_step_count =
       executors_and_keys->step_count.fetch_add(1);
@@ -717,6 +874,27 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // The kernels of a recorded step enqueue to the stream of the step graph,
+  // and allocate buffers that the step graph keeps for its launches.
+  Allocator* capture_allocator = nullptr;
+  if (capture != nullptr) {
+    args.device_context = capture->device_context();
+    args.sync_on_finish = false;
+    capture_allocator = capture->allocator();
+  }
+
+  // Start a step in the tensor arena of each partition, if enabled.
+  std::vector<TensorArenaStepAllocator*> step_allocators(num_executors,
+                                                         nullptr);
+  if (executors_and_keys->items[0].tensor_arena != nullptr &&
+      capture == nullptr) {
+    const uint64 arena_key = TensorArenaKey(call_frame);
+    for (size_t i = 0; i < num_executors; ++i) {
+      step_allocators[i] =
+          executors_and_keys->items[i].tensor_arena->StartStep(arena_key);
+    }
+  }
+
   auto set_threadpool_args_for_item =
       [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
                                   Executor::Args* args) {
@@ -747,10 +925,13 @@ Status DirectSession::RunInternal(
 
     const auto& item = executors_and_keys->items[0];
     set_threadpool_args_for_item(item, &args);
+    args.step_allocator =
+        capture_allocator != nullptr ? capture_allocator : step_allocators[0];
     run_status = item.executor->Run(args);
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
-        new RefCountedIntraProcessRendezvous(device_mgr_.get()));
+        new RefCountedIntraProcessRendezvous(
+            device_mgr_.get(), executors_and_keys->rendezvous_slot_map));
     args.rendezvous = rendezvous.get();
 
     // `barrier` will delete itself after the final executor finishes.
@@ -765,8 +946,11 @@ Status DirectSession::RunInternal(
                               executors_done.Notify();
                             });
 
-    for (const auto& item : executors_and_keys->items) {
+    for (size_t i = 0; i < num_executors; ++i) {
+      const auto& item = executors_and_keys->items[i];
       set_threadpool_args_for_item(item, &args);
+      args.step_allocator = capture_allocator != nullptr ? capture_allocator
+                                                         : step_allocators[i];
       item.executor->RunAsync(args, barrier->Get());
     }
 
@@ -778,6 +962,11 @@ Status DirectSession::RunInternal(
     }
   }
 
+  // All executors are done, so no more kernels of this step can allocate.
+  for (TensorArenaStepAllocator* step_allocator : step_allocators) {
+    if (step_allocator != nullptr) step_allocator->FinishStep(run_status);
+  }
+
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
   }
@@ -882,6 +1071,15 @@ Status DirectSession::Run(const RunOptions& run_options,
   RunStateArgs run_state_args(run_options.debug_options());
   run_state_args.collective_graph_key =
       run_options.experimental().collective_graph_key();
+  if (options_.config.experimental().shape_specialized_graph_cache_size() >
+      0) {
+    for (const auto& it : inputs) {
+      // Resource handles are fed by their string handles, whose shapes say
+      // nothing about the resource.
+      if (it.second.dtype() == DT_RESOURCE) continue;
+      run_state_args.feed_shapes.emplace(it.first, it.second.shape());
+    }
+  }
 
   TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
                                           target_nodes, &executors_and_keys,
@@ -1326,6 +1524,7 @@ Status DirectSession::CreateExecutors(
   BuildGraphOptions options;
   options.callable_options = callable_options;
   options.use_function_convention = !run_state_args->is_partial_run;
+  options.feed_shapes = run_state_args->feed_shapes;
   options.collective_graph_key =
       callable_options.run_options().experimental().collective_graph_key();
   if (options_.config.experimental()
@@ -1383,6 +1582,11 @@ Status DirectSession::CreateExecutors(
         return OkStatus();
       }}));
 
+  const bool use_rendezvous_slots =
+      options_.config.experimental().enable_lock_free_rendezvous() &&
+      !run_state_args->is_partial_run && graphs.size() > 1;
+  std::vector<string> rendezvous_keys;
+
   GraphOptimizer optimizer(optimizer_opts);
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
@@ -1443,16 +1647,42 @@ Status DirectSession::CreateExecutors(
                                          device->name(),
                                          partition_graph.get()));
 
+    if (use_rendezvous_slots) {
+      TF_RETURN_IF_ERROR(
+          AppendRendezvousKeys(*partition_graph, &rendezvous_keys));
+    }
+
     item->executor = nullptr;
     item->device = device;
+    if (options_.config.experimental().enable_tensor_arena() &&
+        !run_state_args->is_partial_run) {
+      item->tensor_arena = std::make_unique<TensorArenaPlanner>(
+          device->GetAllocator(AllocatorAttributes()), kMaxTensorArenaPlans);
+    }
     auto executor_type = options_.config.experimental().executor_type();
     TF_RETURN_IF_ERROR(
         NewExecutor(executor_type, params, *partition_graph, &item->executor));
+    for (const DeviceCostStats& dev_stats :
+         options_.config.experimental().kernel_cost_stats().dev_stats()) {
+      if (dev_stats.device() == device->name()) {
+        item->executor->ImportKernelCostStats(dev_stats);
+      }
+    }
+    if (options_.config.experimental().enable_step_graph_capture() &&
+        !run_state_args->is_partial_run && graphs.size() == 1 &&
+        CanCaptureStepGraph(*partition_graph,
+                            DeviceType(device->device_type()))) {
+      ek->step_graph = std::make_unique<StepGraphState>();
+    }
     if (!options_.config.experimental().disable_output_partition_graphs() ||
         options_.config.graph_options().build_cost_model() > 0) {
       item->graph = std::move(partition_graph);
     }
   }
+  if (use_rendezvous_slots) {
+    ek->rendezvous_slot_map =
+        std::make_shared<const RendezvousSlotMap>(rendezvous_keys);
+  }
 
   // Cache the mapping from input/output names to graph elements to
   // avoid recomputing it every time.
@@ -1507,8 +1737,33 @@ Status DirectSession::GetOrCreateExecutors(
         run_state_args->debug_options.debug_tensor_watch_opts());
   }
 
+  // Executors specialized to the feed shapes can only be built while the
+  // graph can still be optimized. Otherwise the generic executors are used.
+  if (!run_state_args->feed_shapes.empty()) {
+    mutex_lock l(graph_state_lock_);
+    if (finalized_) run_state_args->feed_shapes.clear();
+  }
+  const bool specialize = !run_state_args->feed_shapes.empty();
+  auto feed_shapes_summary = [run_state_args](gtl::ArraySlice<string> feeds) {
+    string summary;
+    for (const string& feed : feeds) {
+      auto it = run_state_args->feed_shapes.find(feed);
+      strings::StrAppend(&summary, it == run_state_args->feed_shapes.end()
+                                       ? "?"
+                                       : it->second.DebugString());
+    }
+    return summary;
+  };
+  auto use_specialized_executors =
+      [executors_and_keys, run_state_args](const Callable& callable) {
+        *executors_and_keys = callable.executors_and_keys.get();
+        run_state_args->specialized_function_info = callable.function_info;
+        run_state_args->specialized_executors_and_keys =
+            callable.executors_and_keys;
+      };
+
   // Fast lookup path, no sorting.
-  const string key = strings::StrCat(
+  string key = strings::StrCat(
       absl::StrJoin(inputs, ","), "->", absl::StrJoin(outputs, ","), "/",
       absl::StrJoin(target_nodes, ","), "/", run_state_args->is_partial_run,
       "/", debug_tensor_watches_summary);
@@ -1517,14 +1772,23 @@ Status DirectSession::GetOrCreateExecutors(
     run_state_args->handle =
         strings::StrCat(key, ";", handle_name_counter_value);
   }
+  if (specialize) strings::StrAppend(&key, "/", feed_shapes_summary(inputs));
 
   // See if we already have the executors for this run.
   {
     mutex_lock l(executor_lock_);  // could use reader lock
-    auto it = executors_.find(key);
-    if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
-      return OkStatus();
+    if (specialize) {
+      SpecializedExecutors* specialized = FindSpecializedExecutors(key);
+      if (specialized != nullptr) {
+        use_specialized_executors(specialized->callable);
+        return OkStatus();
+      }
+    } else {
+      auto it = executors_.find(key);
+      if (it != executors_.end()) {
+        *executors_and_keys = it->second.get();
+        return OkStatus();
+      }
     }
   }
 
@@ -1541,7 +1805,7 @@ Status DirectSession::GetOrCreateExecutors(
   std::vector<string> tn_sorted(target_nodes.begin(), target_nodes.end());
   std::sort(tn_sorted.begin(), tn_sorted.end());
 
-  const string sorted_key = strings::StrCat(
+  string sorted_key = strings::StrCat(
       absl::StrJoin(inputs_sorted, ","), "->",
       absl::StrJoin(outputs_sorted, ","), "/", absl::StrJoin(tn_sorted, ","),
       "/", run_state_args->is_partial_run, "/", debug_tensor_watches_summary);
@@ -1550,14 +1814,29 @@ Status DirectSession::GetOrCreateExecutors(
     run_state_args->handle =
         strings::StrCat(sorted_key, ";", handle_name_counter_value);
   }
+  if (specialize) {
+    strings::StrAppend(&sorted_key, "/", feed_shapes_summary(inputs_sorted));
+  }
 
   // See if we already have the executors for this run.
   {
     mutex_lock l(executor_lock_);
-    auto it = executors_.find(sorted_key);
-    if (it != executors_.end()) {
-      *executors_and_keys = it->second.get();
-      return OkStatus();
+    if (specialize) {
+      SpecializedExecutors* specialized = FindSpecializedExecutors(sorted_key);
+      if (specialized != nullptr) {
+        // Also find the executors with the unsorted key next time.
+        if (!absl::c_linear_search(specialized->keys, key)) {
+          specialized->keys.push_back(key);
+        }
+        use_specialized_executors(specialized->callable);
+        return OkStatus();
+      }
+    } else {
+      auto it = executors_.find(sorted_key);
+      if (it != executors_.end()) {
+        *executors_and_keys = it->second.get();
+        return OkStatus();
+      }
     }
   }
 
@@ -1590,6 +1869,32 @@ Status DirectSession::GetOrCreateExecutors(
   // Reacquire the lock, try to insert into the map.
   mutex_lock l(executor_lock_);
 
+  if (specialize) {
+    SpecializedExecutors* specialized = FindSpecializedExecutors(sorted_key);
+    if (specialized == nullptr) {
+      specialized_executors_.emplace_front();
+      specialized = &specialized_executors_.front();
+      specialized->keys.push_back(sorted_key);
+      specialized->callable.executors_and_keys = std::move(ek);
+      specialized->callable.function_info = std::move(func_info);
+      const size_t cache_size =
+          options_.config.experimental().shape_specialized_graph_cache_size();
+      if (specialized_executors_.size() > cache_size) {
+        // Steps that still use the evicted executors keep them alive.
+        specialized_executors_.pop_back();
+      }
+    } else {
+      // Another thread created the executors before us. Delete ours before
+      // their function library.
+      ek.reset();
+    }
+    if (!absl::c_linear_search(specialized->keys, key)) {
+      specialized->keys.push_back(key);
+    }
+    use_specialized_executors(specialized->callable);
+    return OkStatus();
+  }
+
   // Another thread may have created the entry before us, in which case we will
   // reuse the already created one.
   auto insert_result = executors_.emplace(
@@ -1606,6 +1911,19 @@ Status DirectSession::GetOrCreateExecutors(
   return OkStatus();
 }
 
+DirectSession::SpecializedExecutors* DirectSession::FindSpecializedExecutors(
+    const string& key) {
+  for (auto it = specialized_executors_.begin();
+       it != specialized_executors_.end(); ++it) {
+    if (absl::c_linear_search(it->keys, key)) {
+      specialized_executors_.splice(specialized_executors_.begin(),
+                                    specialized_executors_, it);
+      return &specialized_executors_.front();
+    }
+  }
+  return nullptr;
+}
+
 Status DirectSession::CreateGraphs(
     const BuildGraphOptions& subgraph_options,
     std::unordered_map<string, std::unique_ptr<Graph>>* outputs,
@@ -1894,11 +2212,13 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   RunCallableCallFrame(DirectSession* session,
                        ExecutorsAndKeys* executors_and_keys,
                        const std::vector<Tensor>* feed_tensors,
-                       std::vector<Tensor>* fetch_tensors)
+                       std::vector<Tensor>* fetch_tensors,
+                       const std::vector<Tensor>* fetch_buffers = nullptr)
       : session_(session),
         executors_and_keys_(executors_and_keys),
         feed_tensors_(feed_tensors),
-        fetch_tensors_(fetch_tensors) {}
+        fetch_tensors_(fetch_tensors),
+        fetch_buffers_(fetch_buffers) {}
 
   size_t num_args() const override {
     return executors_and_keys_->input_types.size();
@@ -1924,13 +2244,93 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return OkStatus();
   }
 
+  const Tensor* GetRetvalBuffer(int index) const override {
+    if (fetch_buffers_ == nullptr || index >= fetch_buffers_->size() ||
+        !(*fetch_buffers_)[index].IsInitialized()) {
+      return nullptr;
+    }
+    return &(*fetch_buffers_)[index];
+  }
+
  private:
-  DirectSession* const session_;                   // Not owned.
-  ExecutorsAndKeys* const executors_and_keys_;     // Not owned.
-  const std::vector<Tensor>* const feed_tensors_;  // Not owned.
-  std::vector<Tensor>* const fetch_tensors_;       // Not owned.
+  DirectSession* const session_;                    // Not owned.
+  ExecutorsAndKeys* const executors_and_keys_;      // Not owned.
+  const std::vector<Tensor>* const feed_tensors_;   // Not owned.
+  std::vector<Tensor>* const fetch_tensors_;        // Not owned.
+  const std::vector<Tensor>* const fetch_buffers_;  // Not owned.
 };
 
+Status DirectSession::RunStepGraph(
+    int64_t step_id, const std::vector<Tensor>& feed_tensors,
+    std::vector<Tensor>* fetch_tensors, ExecutorsAndKeys* executors_and_keys,
+    const thread::ThreadPoolOptions& threadpool_options, bool* ran) {
+  *ran = false;
+  StepGraphState* state = executors_and_keys->step_graph.get();
+  auto has_feed_shapes = [&feed_tensors](
+                             const std::vector<TensorShape>& shapes) {
+    if (shapes.size() != feed_tensors.size()) return false;
+    for (size_t i = 0; i < shapes.size(); ++i) {
+      if (shapes[i] != feed_tensors[i].shape()) return false;
+    }
+    return true;
+  };
+
+  StepGraph* graph = nullptr;
+  {
+    mutex_lock l(state->mu);
+    if (state->disabled || state->capturing) return OkStatus();
+    if (state->graph != nullptr) {
+      if (!has_feed_shapes(state->shapes)) return OkStatus();
+      graph = state->graph.get();
+    } else if (!has_feed_shapes(state->shapes)) {
+      // Run the first step with these shapes as usual, so that its kernels
+      // autotune and the allocator grows outside of the recording.
+      state->shapes.clear();
+      for (const Tensor& t : feed_tensors) state->shapes.push_back(t.shape());
+      return OkStatus();
+    } else {
+      state->capturing = true;
+    }
+  }
+  Device* device = executors_and_keys->items[0].device;
+
+  if (graph == nullptr) {
+    std::unique_ptr<StepGraph> new_graph;
+    std::vector<Tensor> captured_args;
+    std::vector<Tensor> retvals(executors_and_keys->output_types.size());
+    Status s = device->CreateStepGraph(&new_graph);
+    if (s.ok()) s = new_graph->BeginCapture(feed_tensors, &captured_args);
+    if (s.ok()) {
+      RunCallableCallFrame call_frame(this, executors_and_keys,
+                                      &captured_args, &retvals);
+      const Status step_status = RunInternal(
+          step_id, executors_and_keys->callable_options.run_options(),
+          &call_frame, executors_and_keys, /*run_metadata=*/nullptr,
+          threadpool_options, new_graph.get());
+      s = new_graph->EndCapture(step_status, retvals, fetch_tensors);
+    }
+
+    mutex_lock l(state->mu);
+    state->capturing = false;
+    if (!s.ok()) {
+      // The step did not run: let the caller run it, and all the later ones,
+      // as usual.
+      LOG(WARNING) << "Failed to record a step graph on " << device->name()
+                   << ", the steps of this callable will run as usual: " << s;
+      state->disabled = true;
+      return OkStatus();
+    }
+    state->graph = std::move(new_graph);
+  } else {
+    TF_RETURN_IF_ERROR(graph->Launch(feed_tensors, fetch_tensors));
+  }
+  *ran = true;
+  if (sync_on_finish_) {
+    TF_RETURN_IF_ERROR(device->Sync());
+  }
+  return OkStatus();
+}
+
 ::tensorflow::Status DirectSession::RunCallable(
     CallableHandle handle, const std::vector<Tensor>& feed_tensors,
     std::vector<Tensor>* fetch_tensors, RunMetadata* run_metadata) {
@@ -2011,18 +2411,50 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     actual_feed_tensors = &feed_tensors;
   }
 
+  // Hold on to the caller's fetch buffers for the duration of the step, so
+  // that they are not released when the fetched values are set.
+  std::vector<Tensor> fetch_buffers;
+  if (executors_and_keys->callable_options.fetch_into_caller_buffers() &&
+      fetch_tensors != nullptr) {
+    absl::flat_hash_set<const void*> buffers;
+    for (const Tensor& t : *actual_feed_tensors) {
+      if (t.IsInitialized() && t.TotalBytes() > 0) buffers.insert(t.data());
+    }
+    for (const Tensor& t : *fetch_tensors) {
+      if (t.IsInitialized() && t.TotalBytes() > 0 &&
+          !buffers.insert(t.data()).second) {
+        return errors::InvalidArgument(
+            "Fetch buffers must be distinct, and must not back a fed tensor.");
+      }
+    }
+    fetch_buffers = *fetch_tensors;
+  }
+
   // A specialized CallFrame implementation that takes advantage of the
   // optimized RunCallable interface.
-  RunCallableCallFrame call_frame(this, executors_and_keys.get(),
-                                  actual_feed_tensors, fetch_tensors);
+  RunCallableCallFrame call_frame(
+      this, executors_and_keys.get(), actual_feed_tensors, fetch_tensors,
+      fetch_buffers.empty() ? nullptr : &fetch_buffers);
 
   if (LogMemory::IsEnabled()) {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(
-      step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+  bool ran_step_graph = false;
+  if (executors_and_keys->step_graph != nullptr && fetch_tensors != nullptr &&
+      fetch_buffers.empty() && run_metadata == nullptr &&
+      executors_and_keys->callable_options.run_options().trace_level() ==
+          RunOptions::NO_TRACE) {
+    TF_RETURN_IF_ERROR(RunStepGraph(step_id, *actual_feed_tensors,
+                                    fetch_tensors, executors_and_keys.get(),
+                                    threadpool_options, &ran_step_graph));
+  }
+  if (!ran_step_graph) {
+    TF_RETURN_IF_ERROR(RunInternal(
+        step_id, executors_and_keys->callable_options.run_options(),
+        &call_frame, executors_and_keys.get(), run_metadata,
+        threadpool_options));
+  }
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -2044,6 +2476,49 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
   return OkStatus();
 }
 
+void DirectSession::ExportKernelCostStats(KernelCostStats* stats) {
+  absl::flat_hash_set<const ExecutorsAndKeys*> visited;
+  std::vector<std::shared_ptr<ExecutorsAndKeys>> executors_and_keys;
+  {
+    mutex_lock l(executor_lock_);
+    for (const auto& it : executors_) {
+      if (visited.insert(it.second.get()).second) {
+        executors_and_keys.push_back(it.second);
+      }
+    }
+  }
+  {
+    mutex_lock l(callables_lock_);
+    for (const auto& it : callables_) {
+      if (visited.insert(it.second.executors_and_keys.get()).second) {
+        executors_and_keys.push_back(it.second.executors_and_keys);
+      }
+    }
+  }
+
+  std::map<string, std::map<string, NodeCostStats>> by_device;
+  for (const auto& ek : executors_and_keys) {
+    for (const PerPartitionExecutorsAndLib& item : ek->items) {
+      DeviceCostStats dev_stats;
+      item.executor->ExportKernelCostStats(&dev_stats);
+      std::map<string, NodeCostStats>& node_stats =
+          by_device[item.device->name()];
+      for (NodeCostStats& n : *dev_stats.mutable_node_stats()) {
+        auto inserted = node_stats.emplace(n.node_name(), n);
+        if (!inserted.second) MergeNodeCostStats(n, &inserted.first->second);
+      }
+    }
+  }
+  for (auto& device_and_stats : by_device) {
+    if (device_and_stats.second.empty()) continue;
+    DeviceCostStats* dev_stats = stats->add_dev_stats();
+    dev_stats->set_device(device_and_stats.first);
+    for (auto& it : device_and_stats.second) {
+      *dev_stats->add_node_stats() = std::move(it.second);
+    }
+  }
+}
+
 Status DirectSession::Finalize() {
   mutex_lock l(graph_state_lock_);
   if (finalized_) {
@@ -17,6 +17,8 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_DIRECT_SESSION_H_
 
 #include <atomic>
+#include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -32,6 +34,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/step_graph.h"
+#include "tensorflow/core/common_runtime/tensor_arena.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -118,6 +122,17 @@ class DirectSession : public Session {
     cost_model_manager_.ExportCostModels(cost_models);
   }
 
+  // Appends the kernel cost statistics collected by the executors of this
+  // session to `stats`, one `DeviceCostStats` per device. They can be passed to
+  // a new session in `ConfigProto.Experimental.kernel_cost_stats`.
+  void ExportKernelCostStats(KernelCostStats* stats);
+
+  // Writes the graphs that Grappler optimized for this session to `def`, so
+  // that a new session can load them from
+  // `ConfigProto.Experimental.optimized_graph_cache_file`. Returns an error if
+  // the session does not cache its optimized graphs.
+  ::tensorflow::Status ExportOptimizedGraphCache(OptimizedGraphCacheDef* def);
+
   ::tensorflow::Status MakeCallable(const CallableOptions& callable_options,
                                     CallableHandle* out_handle) override;
 
@@ -148,6 +163,26 @@ class DirectSession : public Session {
     Device* device = nullptr;                // not owned.
     FunctionLibraryRuntime* flib = nullptr;  // not owned.
     std::unique_ptr<Executor> executor;
+    // Recycles the temporary tensors of this partition across steps. Only
+    // set if `ConfigProto.Experimental.enable_tensor_arena` is true.
+    std::unique_ptr<TensorArenaPlanner> tensor_arena;
+  };
+
+  // The step graph of a callable, if
+  // `ConfigProto.Experimental.enable_step_graph_capture` is true and the
+  // callable is eligible. The first step with some feed shapes runs as usual,
+  // the next step with the same feed shapes is recorded, and the later steps
+  // with these feed shapes launch the recorded step.
+  struct StepGraphState {
+    mutex mu;
+    // The feed shapes of the recorded step if `graph` is set, else those of
+    // the last step.
+    std::vector<TensorShape> shapes TF_GUARDED_BY(mu);
+    // Never reset once set.
+    std::unique_ptr<StepGraph> graph TF_GUARDED_BY(mu);
+    bool capturing TF_GUARDED_BY(mu) = false;
+    // Set if recording a step failed. All the later steps run as usual.
+    bool disabled TF_GUARDED_BY(mu) = false;
   };
 
   // An ExecutorsAndKeys is created for a given set of feeds/fetches.
@@ -176,6 +211,13 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // The slots of the rendezvous keys exchanged between `items`, set if
+    // `ConfigProto.Experimental.enable_lock_free_rendezvous` is true.
+    std::shared_ptr<const RendezvousSlotMap> rendezvous_slot_map;
+
+    // Set if the steps of this callable may run through a step graph.
+    std::unique_ptr<StepGraphState> step_graph;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -236,6 +278,21 @@ class DirectSession : public Session {
     std::unique_ptr<Graph> graph;
     const DebugOptions& debug_options;
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // The slots of the rendezvous keys exchanged between `items`, set if
+    // `ConfigProto.Experimental.enable_lock_free_rendezvous` is true.
+    std::shared_ptr<const RendezvousSlotMap> rendezvous_slot_map;
+
+    // The shapes of the fed tensors, by feed name, if the executors may be
+    // specialized to them (see
+    // `ConfigProto.Experimental.shape_specialized_graph_cache_size`).
+    std::map<string, TensorShape> feed_shapes;
+
+    // Keep the shape-specialized executors of the step alive if they are
+    // evicted during the step. The executors are declared last so that they
+    // are deleted before their function library (see `Callable`).
+    std::shared_ptr<FunctionInfo> specialized_function_info;
+    std::shared_ptr<ExecutorsAndKeys> specialized_executors_and_keys;
   };
 
   // Retrieves an already existing set of executors to run 'inputs' and
@@ -263,17 +320,34 @@ class DirectSession : public Session {
       RunStateArgs* run_state_args, DataTypeVector* input_types,
       DataTypeVector* output_types, int64_t* collective_graph_key);
 
+  // If `capture` is not null, the kernels of the step are recorded into it
+  // rather than run.
   ::tensorflow::Status RunInternal(
       int64_t step_id, const RunOptions& run_options,
       CallFrameInterface* call_frame, ExecutorsAndKeys* executors_and_keys,
       RunMetadata* run_metadata,
-      const thread::ThreadPoolOptions& threadpool_options);
+      const thread::ThreadPoolOptions& threadpool_options,
+      StepGraph* capture = nullptr);
+
+  // Runs a step of a callable that has a step graph, by recording it or by
+  // launching the recorded step, depending on the shapes of `feed_tensors`
+  // (see `StepGraphState`). Sets `*ran` to false if the step must run as
+  // usual instead.
+  ::tensorflow::Status RunStepGraph(
+      int64_t step_id, const std::vector<Tensor>& feed_tensors,
+      std::vector<Tensor>* fetch_tensors, ExecutorsAndKeys* executors_and_keys,
+      const thread::ThreadPoolOptions& threadpool_options, bool* ran);
 
   // Returns whether inter-op execution uses a global pool or the input
   // `run_options` requests being run on inter_op_thread_pool = 0 in case
   // multiple pools are configured.
   bool ShouldUseRunHandlerPool(const RunOptions& run_options) const;
 
+  // Creates `optimized_graph_cache_` if the session options enable it, and
+  // loads the graphs of `optimized_graph_cache_file` into it.
+  void MaybeCreateOptimizedGraphCache()
+      TF_EXCLUSIVE_LOCKS_REQUIRED(graph_state_lock_);
+
   ::tensorflow::Status ExtendLocked(GraphDef&& graph)
       TF_EXCLUSIVE_LOCKS_REQUIRED(graph_state_lock_);
 
@@ -378,6 +452,20 @@ class DirectSession : public Session {
   std::unordered_map<int64_t, Callable> callables_
       TF_GUARDED_BY(callables_lock_);
 
+  // Executors specialized to the shapes of the fed tensors, with the keys
+  // they were looked up with, most recently used first.
+  struct SpecializedExecutors {
+    std::vector<string> keys;
+    Callable callable;
+  };
+  std::list<SpecializedExecutors> specialized_executors_
+      TF_GUARDED_BY(executor_lock_);
+
+  // Returns the entry of `specialized_executors_` for `key`, after marking it
+  // as the most recently used, or nullptr if there is none.
+  SpecializedExecutors* FindSpecializedExecutors(const string& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(executor_lock_);
+
   // Holds mappings from handle to partial run state.
   std::unordered_map<string, std::unique_ptr<PartialRunState>> partial_runs_
       TF_GUARDED_BY(executor_lock_);
@@ -400,6 +488,11 @@ class DirectSession : public Session {
   std::unique_ptr<GraphExecutionState> execution_state_
       TF_GUARDED_BY(graph_state_lock_);
 
+  // The cache of optimized graphs shared by the successive execution states,
+  // or null if it is disabled.
+  std::shared_ptr<OptimizedGraphCache> optimized_graph_cache_
+      TF_GUARDED_BY(graph_state_lock_);
+
   // The function library, before any rewrites or optimizations have been
   // performed. In particular, CreateGraphs() may need to modify the function
   // library; it copies and modifies the function library.
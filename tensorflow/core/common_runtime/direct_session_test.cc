@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <cmath>
 #include <map>
 #include <memory>
 #include <random>
@@ -43,7 +44,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/test.h"
@@ -153,6 +156,46 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunCallable_FetchIntoCallerBuffers) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  CallableOptions callable_options =
+      MakeCallableOptions({x_}, {y_ + ":0"}, {});
+  callable_options.set_fetch_into_caller_buffers(true);
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(callable_options, &handle));
+
+  Tensor x = test::AsTensor<float>({1, 1}, {2, 1});
+  Tensor buffer(DT_FLOAT, TensorShape({2, 1}));
+  for (int i = 0; i < 2; ++i) {
+    std::vector<Tensor> outputs = {buffer};
+    TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+    ASSERT_EQ(1, outputs.size());
+    // y = A * x is written directly into the buffer.
+    EXPECT_TRUE(outputs[0].SharesBufferWith(buffer));
+    test::ExpectTensorEqual<float>(test::AsTensor<float>({5, -1}, {2, 1}),
+                                   outputs[0]);
+  }
+
+  // A buffer of a different shape is not used.
+  Tensor other(DT_FLOAT, TensorShape({2}));
+  std::vector<Tensor> outputs = {other};
+  TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+  EXPECT_FALSE(outputs[0].SharesBufferWith(other));
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({5, -1}, {2, 1}),
+                                 outputs[0]);
+
+  // A buffer must not back a fed tensor.
+  outputs = {x};
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      session->RunCallable(handle, {x}, &outputs, nullptr)));
+
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -610,6 +653,126 @@ TEST_F(DirectSessionMinusAXTest, TestConcurrency_Callable) {
   delete tp;
 }
 
+TEST_F(DirectSessionMinusAXTest, TestConcurrency_TensorArena) {
+  Initialize({1, 2, 3, 4});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_enable_tensor_arena(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+
+  Session::CallableHandle handle;
+  TF_ASSERT_OK(session->MakeCallable(MakeCallableOptions({x_}, {z_ + ":0"}, {}),
+                                     &handle));
+
+  // Run the callable 1000 times in 4 different threads concurrently, with two
+  // different input shapes, so that both recorded and planned steps run
+  // concurrently.
+  auto fn = [&session, handle]() {
+    for (int i = 0; i < 1000; ++i) {
+      const int num_cols = 1 + i % 2;
+      Tensor x(DT_FLOAT, TensorShape({2, num_cols}));
+      x.flat<float>().setConstant(i);
+      std::vector<Tensor> outputs;
+      TF_ASSERT_OK(session->RunCallable(handle, {x}, &outputs, nullptr));
+      ASSERT_EQ(1, outputs.size());
+      auto mat = outputs[0].matrix<float>();
+      ASSERT_EQ(num_cols, mat.dimension(1));
+      // z = -(A * x)
+      EXPECT_FLOAT_EQ(-3.0 * i, mat(0, num_cols - 1));
+      EXPECT_FLOAT_EQ(-7.0 * i, mat(1, num_cols - 1));
+    }
+  };
+
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule(fn);
+  }
+
+  // Wait for the functions to finish.
+  delete tp;
+  TF_ASSERT_OK(session->ReleaseCallable(handle));
+}
+
+TEST_F(DirectSessionMinusAXTest, KernelCostStatsWarmStart) {
+  Initialize({1, 2, 3, 4});
+  auto find_stats = [](const KernelCostStats& stats, const string& node_name) {
+    const NodeCostStats* found = nullptr;
+    for (const DeviceCostStats& dev_stats : stats.dev_stats()) {
+      for (const NodeCostStats& node_stats : dev_stats.node_stats()) {
+        if (node_stats.node_name() == node_name) found = &node_stats;
+      }
+    }
+    return found;
+  };
+
+  KernelCostStats stats;
+  {
+    auto session = CreateSession();
+    ASSERT_TRUE(session != nullptr);
+    TF_ASSERT_OK(session->Create(def_));
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+    static_cast<DirectSession*>(session.get())->ExportKernelCostStats(&stats);
+  }
+  const NodeCostStats* y_stats = find_stats(stats, y_);
+  ASSERT_NE(nullptr, y_stats);
+  ASSERT_EQ(2, stats.dev_stats_size());
+  EXPECT_EQ("/job:localhost/replica:0/task:0/device:CPU:0",
+            stats.dev_stats(0).device());
+
+  // A session that starts from these statistics treats the kernel as cheap
+  // from its first step.
+  for (NodeCostStats& node_stats :
+       *stats.mutable_dev_stats(0)->mutable_node_stats()) {
+    if (node_stats.node_name() == y_) node_stats.set_cost_estimate_cycles(1000);
+  }
+  SessionOptions options(DefaultSessionOptions());
+  *options.config.mutable_experimental()->mutable_kernel_cost_stats() = stats;
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {z_ + ":0"}, {}, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  EXPECT_FLOAT_EQ(-3.0, outputs[0].matrix<float>()(0, 0));
+
+  KernelCostStats warm_stats;
+  static_cast<DirectSession*>(session.get())
+      ->ExportKernelCostStats(&warm_stats);
+  const NodeCostStats* warm_y_stats = find_stats(warm_stats, y_);
+  ASSERT_NE(nullptr, warm_y_stats);
+  EXPECT_LT(warm_y_stats->cost_estimate_cycles(), 10 * 1000 * 1000);
+}
+
+TEST_F(DirectSessionMinusAXTest, LockFreeRendezvous) {
+  Initialize({1, 2, 3, 4});
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_enable_lock_free_rendezvous(true);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // The partitions of the graph exchange `x` and `y` through the slots of a
+  // new rendezvous in every step, including concurrent ones.
+  thread::ThreadPool* tp = new thread::ThreadPool(Env::Default(), "test", 4);
+  for (int i = 0; i < 4; ++i) {
+    tp->Schedule([&session, this]() {
+      for (int step = 0; step < 100; ++step) {
+        std::vector<Tensor> outputs;
+        TF_ASSERT_OK(session->Run({}, {z_ + ":0", y_ + ":0"}, {}, &outputs));
+        ASSERT_EQ(2, outputs.size());
+        test::ExpectTensorEqual<float>(
+            outputs[0], test::AsTensor<float>({-3, -7}, TensorShape({2, 1})));
+        test::ExpectTensorEqual<float>(
+            outputs[1], test::AsTensor<float>({3, 7}, TensorShape({2, 1})));
+      }
+    });
+  }
+  delete tp;
+}
+
 TEST_F(DirectSessionMinusAXTest, TestPerSessionThreads) {
   Initialize({1, 2, 3, 4});
 
@@ -1067,6 +1230,95 @@ TEST(DirectSessionTest, FetchMultipleTimes) {
   }
 }
 
+TEST(DirectSessionTest, ShapeSpecializedGraphCache) {
+  // The shape of `x` is only known once it is fed.
+  Graph g(OpRegistry::Global());
+  Node* x;
+  TF_ASSERT_OK(NodeBuilder("x", "Placeholder")
+                   .Attr("dtype", DT_FLOAT)
+                   .Attr("shape", PartialTensorShape({-1, 2}))
+                   .Finalize(&g, &x));
+  Node* shape;
+  TF_ASSERT_OK(NodeBuilder("shape", "Shape")
+                   .Input(x)
+                   .Attr("T", DT_FLOAT)
+                   .Attr("out_type", DT_INT32)
+                   .Finalize(&g, &shape));
+  Node* y = test::graph::Identity(&g, shape);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()
+      ->set_shape_specialized_graph_cache_size(1);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+
+  RunOptions run_options;
+  run_options.set_output_partition_graphs(true);
+  // With a cache of one variant, running the second shape evicts the
+  // variant of the first one and running the first shape again rebuilds it.
+  for (int64_t batch_size : {3, 5, 3, 3}) {
+    std::vector<std::pair<string, Tensor>> inputs = {
+        {"x", Tensor(DT_FLOAT, TensorShape({batch_size, 2}))}};
+    std::vector<Tensor> outputs;
+    RunMetadata run_metadata;
+    TF_ASSERT_OK(session->Run(run_options, inputs, {y->name() + ":0"}, {},
+                              &outputs, &run_metadata));
+    ASSERT_EQ(outputs.size(), 1);
+    test::ExpectTensorEqual<int32>(
+        outputs[0], test::AsTensor<int32>({static_cast<int32>(batch_size), 2}));
+
+    // The shape computation is folded in the specialized graph.
+    for (const GraphDef& partition_graph : run_metadata.partition_graphs()) {
+      for (const NodeDef& node : partition_graph.node()) {
+        EXPECT_NE(node.op(), "Shape") << node.DebugString();
+      }
+    }
+  }
+}
+
+TEST(DirectSessionTest, OptimizedGraphCacheFile) {
+  Graph g(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 3.0;
+  Node* c = test::graph::Constant(&g, value);
+  Node* y = test::graph::Identity(&g, c);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options(DefaultSessionOptions());
+  options.config.mutable_experimental()->set_optimized_graph_cache_size(4);
+  auto session = absl::WrapUnique(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(session->Run({}, {y->name() + ":0"}, {}, &outputs));
+  OptimizedGraphCacheDef cache_def;
+  TF_ASSERT_OK(static_cast<DirectSession*>(session.get())
+                   ->ExportOptimizedGraphCache(&cache_def));
+  ASSERT_EQ(cache_def.entry_size(), 1);
+  const string cache_file =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache.pb");
+  TF_ASSERT_OK(WriteBinaryProto(Env::Default(), cache_file, cache_def));
+
+  // The new session is sized for and starts with the graphs of the file.
+  SessionOptions loading_options(DefaultSessionOptions());
+  loading_options.config.mutable_experimental()
+      ->set_optimized_graph_cache_file(cache_file);
+  auto loading_session = absl::WrapUnique(NewSession(loading_options));
+  ASSERT_TRUE(loading_session != nullptr);
+  TF_ASSERT_OK(loading_session->Create(def));
+  OptimizedGraphCacheDef loaded_cache_def;
+  TF_ASSERT_OK(static_cast<DirectSession*>(loading_session.get())
+                   ->ExportOptimizedGraphCache(&loaded_cache_def));
+  EXPECT_EQ(loaded_cache_def.entry_size(), 1);
+  TF_ASSERT_OK(loading_session->Run({}, {y->name() + ":0"}, {}, &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  EXPECT_EQ(outputs[0].scalar<float>()(), 3.0);
+}
+
 TEST(DirectSessionTest, MultipleFeedTestSomeSyncRun) {
   GraphDef def;
   Graph g(OpRegistry::Global());
@@ -2425,6 +2677,64 @@ TEST(DirectSessionTest, FeedAndFetchTensorsInDeviceMemory) {
   }
 }
 
+TEST(DirectSessionTest, RunCallableThroughStepGraph) {
+  SessionOptions options;
+  options.config.mutable_experimental()->set_enable_step_graph_capture(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  const string gpu_device_name = GPUDeviceName(session.get());
+  if (gpu_device_name.empty()) {
+    LOG(INFO) << "Skipping test since no GPU is available";
+    return;
+  }
+
+  TF_ASSERT_OK(session->Create(CreateGraphForYEqualsXSquared()));
+
+  // Each callable squares its feed. Only `on_gpu` feeds and fetches in device
+  // memory, which makes it eligible for a step graph.
+  CallableOptions opts;
+  opts.add_feed("x:0");
+  opts.add_fetch("y:0");
+  opts.set_fetch_skip_sync(true);
+  Session::CallableHandle to_gpu;
+  opts.mutable_fetch_devices()->insert({"y:0", gpu_device_name});
+  TF_ASSERT_OK(session->MakeCallable(opts, &to_gpu));
+  Session::CallableHandle on_gpu;
+  opts.mutable_feed_devices()->insert({"x:0", gpu_device_name});
+  TF_ASSERT_OK(session->MakeCallable(opts, &on_gpu));
+  Session::CallableHandle to_host;
+  opts.clear_fetch_devices();
+  TF_ASSERT_OK(session->MakeCallable(opts, &to_host));
+
+  // Returns x^8 for each element x of `input`.
+  auto run = [&](const Tensor& input) {
+    std::vector<Tensor> outputs;
+    TF_CHECK_OK(session->RunCallable(to_gpu, {input}, &outputs, nullptr));
+    const Tensor gpu_input = outputs[0];
+    TF_CHECK_OK(session->RunCallable(on_gpu, {gpu_input}, &outputs, nullptr));
+    CHECK(IsCUDATensor(outputs[0]));
+    const Tensor gpu_output = outputs[0];
+    TF_CHECK_OK(session->RunCallable(to_host, {gpu_output}, &outputs, nullptr));
+    return outputs[0];
+  };
+
+  // The first step runs as usual, the second one is recorded, and the later
+  // ones launch the recorded step on their own inputs.
+  for (float x : {1.0f, 2.0f, 3.0f, 1.5f}) {
+    Tensor input(DT_FLOAT, {});
+    input.scalar<float>()() = x;
+    EXPECT_EQ(std::pow(x, 8), run(input).scalar<float>()()) << x;
+  }
+
+  // A step with other input shapes runs as usual.
+  Tensor input = test::AsTensor<float>({2.0f, 3.0f}, {2});
+  test::ExpectTensorEqual<float>(test::AsTensor<float>({256.0f, 6561.0f}, {2}),
+                                 run(input));
+
+  TF_ASSERT_OK(session->ReleaseCallable(to_gpu));
+  TF_ASSERT_OK(session->ReleaseCallable(on_gpu));
+  TF_ASSERT_OK(session->ReleaseCallable(to_host));
+}
+
 GraphDef CreateIdentityGraphDef(DataType dtype) {
   GraphDef def;
 
@@ -455,6 +455,7 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     mutex_lock ml(cache_mu_);
     default_executor_.WaitForAllPendingNodes().IgnoreError();
     kernel_cache_.clear();
+    ++kernel_cache_generation_;
     for (auto& entry : registered_functions_) {
       entry.second->cached_kernel_keys->clear();
     }
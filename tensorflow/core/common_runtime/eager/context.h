@@ -275,6 +275,10 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   void AddKernelToCache(Fprint128 cache_key, KernelAndDevice* kernel);
   void AddDeviceToCache(Fprint128 device_cache_key, Device* device);
 
+  // Returns a counter that changes whenever the kernel cache is cleared.
+  // Kernels held outside of the cache are stale once it changes.
+  int64_t KernelCacheGeneration() const { return kernel_cache_generation_; }
+
   bool LogDevicePlacement() const { return log_device_placement_; }
   void SetLogDevicePlacement(bool enable) override {
     log_device_placement_ = enable;
@@ -758,6 +762,7 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
       TF_GUARDED_BY(cache_mu_);
   absl::flat_hash_map<Fprint128, Device*, Fprint128Hasher> device_cache_
       TF_GUARDED_BY(device_cache_mu_);
+  std::atomic<int64_t> kernel_cache_generation_{0};
   std::unordered_map<std::string, std::vector<std::function<void()>>>
       remove_function_notifiers_ TF_GUARDED_BY(remove_function_notifiers_mu_);
 
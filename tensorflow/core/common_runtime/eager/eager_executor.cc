@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <algorithm>
 #include <forward_list>
 #include <functional>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
@@ -32,6 +35,27 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+auto* hot_op_trace_counter = monitoring::Counter<0>::New(
+    "/tensorflow/core/eager_hot_op_traces",
+    "The number of times a repeated sequence of eager ops became hot.");
+
+std::unique_ptr<OpTraceRecorder> MaybeCreateOpTraceRecorder() {
+  int64_t trace_length, hot_threshold;
+  TF_CHECK_OK(
+      ReadInt64FromEnvVar("TF_EAGER_HOT_TRACE_LENGTH", 0, &trace_length));
+  TF_CHECK_OK(
+      ReadInt64FromEnvVar("TF_EAGER_HOT_TRACE_THRESHOLD", 100, &hot_threshold));
+  if (trace_length <= 0 || hot_threshold <= 0) return nullptr;
+  return std::make_unique<OpTraceRecorder>(trace_length, hot_threshold);
+}
+
+int MaxRemoteBatchSize() {
+  int64_t max_batch_size;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_MAX_REMOTE_BATCH_SIZE", 1,
+                                  &max_batch_size));
+  return std::max<int64_t>(max_batch_size, 1);
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
@@ -46,6 +70,8 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
       enable_async_wait_for_remote_function_(
           IsAsyncWaitForRemoteFunctionEnabled()),
       enable_streaming_enqueue_(enable_streaming_enqueue),
+      max_remote_batch_size_(MaxRemoteBatchSize()),
+      op_trace_recorder_(MaybeCreateOpTraceRecorder()),
       in_flight_nodes_limit_(in_flight_nodes_limit) {
   if (async && in_flight_nodes_limit_ > 0) {
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
@@ -160,7 +186,7 @@ Status EagerExecutor::AddOrExecute(std::unique_ptr<EagerNode> node) {
     } else {
       status = status_;
       if (status.ok()) {
-        node_queue_.push(std::move(item));
+        node_queue_.push_back(std::move(item));
         // If there were no previous nodes pending, wake the run thread to
         // start processing requests again.
         if (node_queue_.size() == 1) {
@@ -256,7 +282,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
     if (from_queue) {
       // Since this was from the async queue, pop it from the front of the queue
       DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-      node_queue_.pop();
+      node_queue_.pop_front();
     } else if (async) {
       // If it is an Async node then we will find the node in the unfinished
       // nodes list. However we only notify if we are at the front of the list
@@ -290,7 +316,7 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
       }
       while (!node_queue_.empty()) {
         items_to_destroy.push_front(std::move(node_queue_.front()));
-        node_queue_.pop();
+        node_queue_.pop_front();
       }
       for (auto& it : unfinished_nodes_) {
         items_to_destroy.push_front(std::move(it.second));
@@ -349,6 +375,7 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    std::vector<core::RefCountPtr<NodeItem>> batch;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -364,8 +391,24 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      AsyncRemoteExecuteNode* remote_node =
+          curr_item->node->AsAsyncRemoteExecuteNode();
+      if (remote_node != nullptr && max_remote_batch_size_ > 1) {
+        for (int i = 1, end = std::min<int>(node_queue_.size(),
+                                            max_remote_batch_size_);
+             i < end; ++i) {
+          AsyncRemoteExecuteNode* next =
+              node_queue_[i]->node->AsAsyncRemoteExecuteNode();
+          if (next == nullptr || !remote_node->CanBatchWith(*next)) break;
+          if (batch.empty()) batch.push_back(std::move(curr_item));
+          batch.emplace_back(node_queue_[i].get());
+          batch.back()->Ref();
+        }
+      }
     }
-    Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
+    Status status = batch.empty()
+                        ? RunItem(std::move(curr_item), /*from_queue=*/true)
+                        : RunBatch(std::move(batch));
     if (!status.ok()) {
       VLOG(1) << "Failed to run item: " << status;
     }
@@ -378,28 +421,11 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
            << item->node->DebugString();
   AsyncRemoteExecuteNode* async_remote_node =
       item->node->AsAsyncRemoteExecuteNode();
-  if (enable_async_wait_for_remote_function_) {
-    if (async_remote_node != nullptr) {
-      if (last_eager_client_ != nullptr &&
-          async_remote_node->eager_client() != nullptr &&
-          last_eager_client_ != async_remote_node->eager_client()) {
-        // Running a remote function, need to sync if the function is going to
-        // different device than last time we run remote distributed function.
-        DVLOG(3) << "Executing Sync Executor for node" << item->id;
-        tensorflow::Status status = async_remote_node->SyncExecutors();
-        if (!status.ok()) {
-          NodeDone(item, status, from_queue);
-          return status;
-        }
-        last_eager_client_ = nullptr;
-      }
-      if (async_remote_node->eager_client() != nullptr &&
-          async_remote_node->needs_remote_inputs() &&
-          async_remote_node->allow_multiple_pending_requests()) {
-        // We are running remote distributed function, update
-        // last_remote_device_name_.
-        last_eager_client_ = async_remote_node->eager_client();
-      }
+  if (async_remote_node != nullptr) {
+    tensorflow::Status status = MaybeSyncExecutors(async_remote_node);
+    if (!status.ok()) {
+      NodeDone(item, status, from_queue);
+      return status;
     }
   }
 
@@ -425,6 +451,69 @@ Status EagerExecutor::RunItem(core::RefCountPtr<NodeItem> item,
   return status();
 }
 
+Status EagerExecutor::RunBatch(std::vector<core::RefCountPtr<NodeItem>> items) {
+  AsyncRemoteExecuteNode* leader = items[0]->node->AsAsyncRemoteExecuteNode();
+  DVLOG(3) << "Running Nodes: [id " << items[0]->id << " to "
+           << items.back()->id << "] in one batch";
+  // The other nodes of the batch are for the same worker as the first one.
+  Status status = MaybeSyncExecutors(leader);
+  if (!status.ok()) {
+    NodeDone(items[0], status, /*from_queue=*/true);
+    return status;
+  }
+
+  std::vector<AsyncRemoteExecuteNode*> batch;
+  std::vector<StatusCallback> done;
+  batch.reserve(items.size() - 1);
+  done.reserve(items.size());
+  {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    if (!status_.ok()) {
+      return status_;
+    }
+    for (core::RefCountPtr<NodeItem>& item : items) {
+      DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
+      node_queue_.pop_front();
+      item->state = NodeState::kSCHEDULED;
+      if (item.get() != items[0].get()) {
+        batch.push_back(item->node->AsAsyncRemoteExecuteNode());
+      }
+      NodeItem* async_ref = item.get();
+      async_ref->Ref();
+      done.push_back([this, async_ref](const Status& status) {
+        core::RefCountPtr<NodeItem> async_item(async_ref);
+        NodeDone(async_item, status, false);
+      });
+      const uint64 id = item->id;
+      unfinished_nodes_.emplace_hint(unfinished_nodes_.end(), id,
+                                     std::move(item));
+    }
+  }
+  leader->RunBatchAsync(batch, std::move(done));
+
+  // Return the status of the executor in case we are in an error state.
+  return this->status();
+}
+
+Status EagerExecutor::MaybeSyncExecutors(AsyncRemoteExecuteNode* node) {
+  if (!enable_async_wait_for_remote_function_) return OkStatus();
+  if (last_eager_client_ != nullptr && node->eager_client() != nullptr &&
+      last_eager_client_ != node->eager_client()) {
+    // Running a remote function, need to sync if the function is going to
+    // different device than last time we run remote distributed function.
+    DVLOG(3) << "Executing Sync Executor for node " << node->DebugString();
+    TF_RETURN_IF_ERROR(node->SyncExecutors());
+    last_eager_client_ = nullptr;
+  }
+  if (node->eager_client() != nullptr && node->needs_remote_inputs() &&
+      node->allow_multiple_pending_requests()) {
+    // We are running remote distributed function, update
+    // last_remote_device_name_.
+    last_eager_client_ = node->eager_client();
+  }
+  return OkStatus();
+}
+
 Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                        bool from_queue) {
   tensorflow::mutex_lock l(node_queue_mutex_);
@@ -434,7 +523,7 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
 
   if (from_queue) {
     DCHECK(!node_queue_.empty() && item.get() == node_queue_.front().get());
-    node_queue_.pop();
+    node_queue_.pop_front();
   }
 
   DVLOG(3) << "Add Node: [id " << item->id << "] to unfinished map.";
@@ -444,6 +533,17 @@ Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
   return OkStatus();
 }
 
+void EagerExecutor::RecordOp(const Fprint128& op_key) {
+  if (op_trace_recorder_ == nullptr) return;
+  mutex_lock l(op_trace_mu_);
+  if (op_trace_recorder_->RecordOp(op_key)) {
+    hot_op_trace_counter->GetCell()->IncrementBy(1);
+    VLOG(1) << "Eager op trace " << op_trace_recorder_->LastTraceKey().low64
+            << ":" << op_trace_recorder_->LastTraceKey().high64
+            << " became hot.";
+  }
+}
+
 void EagerExecutor::AddCleanup(intptr_t key, std::function<void()> callback) {
   cleanups_[key].push_back(callback);
 }
@@ -18,16 +18,19 @@ limitations under the License.
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/eager/op_trace_recorder.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/framework/rendezvous.h"
@@ -35,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
@@ -46,6 +50,7 @@ class AsyncEagerNode;
 class AsyncRemoteExecuteNode;
 namespace eager {
 class EagerClient;
+class RemoteExecuteNode;
 }
 
 // A unit of execution for the EagerExecutor class below. Example subclasses
@@ -103,6 +108,26 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
   virtual bool needs_remote_inputs() const = 0;
   virtual bool allow_multiple_pending_requests() const = 0;
   virtual Status SyncExecutors() = 0;
+
+  virtual const eager::RemoteExecuteNode* AsRemoteExecuteNode() const {
+    return nullptr;
+  }
+
+  // Returns true if `next`, a node queued after this one, can be sent to the
+  // remote worker in the same request as this node.
+  virtual bool CanBatchWith(const AsyncRemoteExecuteNode& next) const {
+    return false;
+  }
+
+  // Runs this node together with `batch`, the nodes queued right after it,
+  // for each of which CanBatchWith returned true, in a single request.
+  // `done` has one callback per node, this node's first, and each of them is
+  // called once.
+  virtual void RunBatchAsync(absl::Span<AsyncRemoteExecuteNode* const> batch,
+                             std::vector<StatusCallback> done) {
+    DCHECK(batch.empty());
+    RunAsync(std::move(done[0]));
+  }
 };
 
 // A class for handling async execution (see TFE_ContextSetAsync).
@@ -112,6 +137,13 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): Implement support for control dependencies.
 // TODO(agarwal): Support out-of-order execution and dispatching multiple
 // EagerNode in parallel.
+//
+// In async mode, consecutive pending remote nodes that can be batched (see
+// AsyncRemoteExecuteNode::CanBatchWith) are sent to their worker in one
+// request, up to TF_EAGER_MAX_REMOTE_BATCH_SIZE nodes (default 1, i.e. no
+// batching). Nodes are only batched with nodes that are already pending, so
+// batching does not delay any node. If a node of a batch fails, all of them
+// fail with its error.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
@@ -160,6 +192,16 @@ class EagerExecutor {
 
   bool ok() const TF_NO_THREAD_SAFETY_ANALYSIS { return ok_; }
 
+  // Whether the ops run through this executor are recorded to detect hot op
+  // traces, which is enabled by setting TF_EAGER_HOT_TRACE_LENGTH to the
+  // number of ops in a trace. A trace is hot once it has been seen
+  // TF_EAGER_HOT_TRACE_THRESHOLD times (default 100).
+  bool RecordsOpTraces() const { return op_trace_recorder_ != nullptr; }
+
+  // Records an op run through this executor, whose name, attributes and
+  // device are fingerprinted as `op_key`, for hot op trace detection.
+  void RecordOp(const Fprint128& op_key);
+
   // On destruction, runs `callback`. Used by the EagerContext for clearing
   // thread-local executors.
   void AddCleanup(intptr_t key, std::function<void()> callback);
@@ -211,6 +253,11 @@ class EagerExecutor {
   void Run();
 
   Status RunItem(core::RefCountPtr<NodeItem> item, bool from_queue);
+  // Runs `items`, the front of `node_queue_`, as one batch of remote nodes.
+  Status RunBatch(std::vector<core::RefCountPtr<NodeItem>> items);
+  // Syncs the executors of the previous remote function with remote inputs
+  // before running `node` for a different worker.
+  Status MaybeSyncExecutors(AsyncRemoteExecuteNode* node);
   Status MoveToUnfinished(core::RefCountPtr<NodeItem> item, bool from_queue);
 
   // The impl of WaitForAllPendingNodes
@@ -230,7 +277,7 @@ class EagerExecutor {
   condition_variable nodes_done_ TF_GUARDED_BY(node_queue_mutex_);
 
   // Queue of pending NodeItems. Ordered by NodeItem::id.
-  std::queue<core::RefCountPtr<NodeItem>> node_queue_
+  std::deque<core::RefCountPtr<NodeItem>> node_queue_
       TF_GUARDED_BY(node_queue_mutex_);
 
   // Ordered by NodeItem::id.
@@ -270,9 +317,17 @@ class EagerExecutor {
   // Enable sending remote executions through streaming enqueue.
   const bool enable_streaming_enqueue_;
 
+  // The largest number of consecutive remote nodes sent in one request.
+  const int max_remote_batch_size_;
+
   // Callbacks to run on destruction.
   absl::flat_hash_map<intptr_t, std::vector<std::function<void()>>> cleanups_;
 
+  mutex op_trace_mu_;
+  // Set iff hot op trace detection is enabled.
+  const std::unique_ptr<OpTraceRecorder> op_trace_recorder_
+      TF_PT_GUARDED_BY(op_trace_mu_);
+
   // Limit the number of in-flight nodes. When the number of in-flight eager
   // async nodes reach this number, enqueuing to the eager async queue is
   // blocked.
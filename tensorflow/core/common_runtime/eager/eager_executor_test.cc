@@ -14,9 +14,13 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <cstdlib>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +106,60 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   Status run_return_status_;
 };
 
+// A node that blocks the executor until `notification` is notified.
+class BlockingEagerNode : public EagerNode {
+ public:
+  explicit BlockingEagerNode(Notification* notification)
+      : notification_(notification) {}
+
+  Status Run() override {
+    notification_->WaitForNotification();
+    return OkStatus();
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "blockingEagerNode"; }
+
+ private:
+  Notification* notification_;
+};
+
+// A remote node for `worker` that records the size of the batches it runs.
+class TestRemoteExecuteNode : public AsyncRemoteExecuteNode {
+ public:
+  TestRemoteExecuteNode(int worker, std::vector<int>* batch_sizes)
+      : worker_(worker), batch_sizes_(batch_sizes) {}
+
+  const eager::EagerClient* eager_client() const override { return nullptr; }
+  bool needs_remote_inputs() const override { return false; }
+  bool allow_multiple_pending_requests() const override { return true; }
+  Status SyncExecutors() override { return OkStatus(); }
+
+  bool CanBatchWith(const AsyncRemoteExecuteNode& next) const override {
+    return static_cast<const TestRemoteExecuteNode&>(next).worker_ == worker_;
+  }
+
+  void RunAsync(StatusCallback done) override {
+    batch_sizes_->push_back(1);
+    done(OkStatus());
+  }
+
+  void RunBatchAsync(absl::Span<AsyncRemoteExecuteNode* const> batch,
+                     std::vector<StatusCallback> done) override {
+    batch_sizes_->push_back(batch.size() + 1);
+    for (StatusCallback& node_done : done) {
+      node_done(OkStatus());
+    }
+  }
+
+  void Abort(Status status) override {}
+  string DebugString() const override { return "testRemoteExecuteNode"; }
+
+ private:
+  const int worker_;
+  std::vector<int>* batch_sizes_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -281,5 +339,28 @@ TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
       async_executor->AddOrExecute(std::move(node)),
       tensorflow::testing::StatusIs(tensorflow::error::FAILED_PRECONDITION));
 }
+
+TEST(EagerExecutorTest, TestAsyncExecutorBatchesRemoteNodes) {
+  setenv("TF_EAGER_MAX_REMOTE_BATCH_SIZE", "3", /*overwrite=*/1);
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true);
+  unsetenv("TF_EAGER_MAX_REMOTE_BATCH_SIZE");
+
+  // Queue all the remote nodes before any of them runs.
+  Notification notification;
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<BlockingEagerNode>(&notification)));
+  std::vector<int> batch_sizes;
+  for (int worker : {0, 0, 0, 0, 1, 0}) {
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestRemoteExecuteNode>(worker, &batch_sizes)));
+  }
+  notification.Notify();
+
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+  EXPECT_EQ(batch_sizes, std::vector<int>({3, 1, 1, 1}));
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
 }  // namespace
 }  // namespace tensorflow
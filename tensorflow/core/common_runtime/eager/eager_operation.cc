@@ -314,6 +314,59 @@ Status EagerOperation::SetInput(size_t index,
   return OkStatus();
 }
 
+Status EagerOperation::Prepare() {
+  if (is_function_) {
+    return errors::InvalidArgument(
+        "Only primitive operations can be prepared, but ", Name(),
+        " is a function.");
+  }
+  prepared_ = true;
+  return OkStatus();
+}
+
+core::RefCountPtr<KernelAndDevice> EagerOperation::PreparedKernel() {
+  if (prepared_kernel_ == nullptr ||
+      prepared_kernel_cache_generation_ != ctx_.KernelCacheGeneration() ||
+      prepared_allow_soft_placement_ != ctx_.AllowSoftPlacement() ||
+      prepared_run_eager_op_as_function_ != ctx_.RunEagerOpAsFunction() ||
+      prepared_inputs_.size() != inputs_.size()) {
+    return nullptr;
+  }
+  // The attributes' cache key is itself cached until they change, so this
+  // does not fingerprint them again.
+  if (!(attrs_.CacheKey(device_name_) == prepared_attrs_cache_key_)) {
+    return nullptr;
+  }
+  for (int i = 0, end = inputs_.size(); i < end; ++i) {
+    if (!TensorHandle::classof(inputs_[i])) return nullptr;
+    TensorHandle* input = down_cast<TensorHandle*>(inputs_[i]);
+    if (input->dtype != prepared_inputs_[i].first ||
+        input->DeviceOrHostCPU(ctx_) != prepared_inputs_[i].second) {
+      return nullptr;
+    }
+  }
+  return prepared_kernel_.GetNewRef();
+}
+
+void EagerOperation::SetPreparedKernel(
+    const core::RefCountPtr<KernelAndDevice>& kernel) {
+  prepared_kernel_.reset();
+  prepared_inputs_.clear();
+  for (ImmediateExecutionTensorHandle* handle : inputs_) {
+    if (!TensorHandle::classof(handle)) return;
+    TensorHandle* input = down_cast<TensorHandle*>(handle);
+    // Kernels for resource inputs also depend on the dtype and shape of the
+    // resource, which is not cheap to compare, so they are not kept.
+    if (input->dtype == DT_RESOURCE) return;
+    prepared_inputs_.emplace_back(input->dtype, input->DeviceOrHostCPU(ctx_));
+  }
+  prepared_kernel_ = kernel.GetNewRef();
+  prepared_attrs_cache_key_ = attrs_.CacheKey(device_name_);
+  prepared_kernel_cache_generation_ = ctx_.KernelCacheGeneration();
+  prepared_allow_soft_placement_ = ctx_.AllowSoftPlacement();
+  prepared_run_eager_op_as_function_ = ctx_.RunEagerOpAsFunction();
+}
+
 Status EagerOperation::Reset(
     const char* op, const char* device_name, bool remote,
     EagerExecutor* executor,
@@ -345,6 +398,9 @@ Status EagerOperation::Reset(
         "registered in the binary running in this process.");
   }
   attrs_.Reset(op);
+  prepared_ = false;
+  prepared_kernel_.reset();
+  prepared_inputs_.clear();
   stack_trace_.reset();
   is_function_ = is_function;
   cancellation_manager_ = nullptr;
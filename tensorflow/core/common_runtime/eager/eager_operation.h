@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -34,6 +35,8 @@ limitations under the License.
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 
@@ -151,6 +154,22 @@ class EagerOperation : public ImmediateExecutionOperation {
   bool is_function() const { return is_function_; }
   bool colocation_exempt() const { return colocation_exempt_; }
 
+  // Marks this primitive operation as prepared for repeated execution: the
+  // kernel picked by its next execution is kept with it, and later executions
+  // reuse that kernel without selecting a device or looking up the context's
+  // kernel cache, as long as the attributes, the device and the dtypes and
+  // devices of the inputs stay the same. Reset drops the kept kernel.
+  Status Prepare() override;
+  bool is_prepared() const { return prepared_; }
+
+  // Returns the kernel kept by a prepared operation if it can run the current
+  // inputs, or nullptr if there is none or it is stale.
+  core::RefCountPtr<KernelAndDevice> PreparedKernel();
+
+  // Keeps `kernel`, picked for the current inputs, for later executions of a
+  // prepared operation.
+  void SetPreparedKernel(const core::RefCountPtr<KernelAndDevice>& kernel);
+
   tensorflow::EagerContext& EagerContext() const { return ctx_; }
 
   AttrBuilder* MutableAttrs() { return &attrs_; }
@@ -291,6 +310,17 @@ class EagerOperation : public ImmediateExecutionOperation {
 
   std::optional<EagerFunctionParams> eager_func_params_;
 
+  // The kernel kept by a prepared operation, together with what it was picked
+  // for. See Prepare().
+  bool prepared_ = false;
+  core::RefCountPtr<KernelAndDevice> prepared_kernel_;
+  Fprint128 prepared_attrs_cache_key_;
+  int64_t prepared_kernel_cache_generation_ = 0;
+  bool prepared_allow_soft_placement_ = false;
+  bool prepared_run_eager_op_as_function_ = false;
+  absl::InlinedVector<std::pair<DataType, tensorflow::Device*>, 4>
+      prepared_inputs_;
+
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
   int inference_arg_idx_;  // arg definition index for the next input to be
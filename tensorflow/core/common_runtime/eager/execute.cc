@@ -1322,10 +1322,35 @@ Fprint128 GetDeviceCacheKey(EagerOperation* op, const EagerContext& ctx) {
   return device_cache_key;
 }
 
+Status SetNumRetvals(const KernelAndDevice& kernel, int* num_retvals) {
+  int num_outputs = kernel.num_outputs();
+  if (num_outputs > *num_retvals) {
+    return errors::InvalidArgument("Expecting ", num_outputs,
+                                   " outputs, but *num_retvals is ",
+                                   *num_retvals);
+  }
+  *num_retvals = num_outputs;
+  return OkStatus();
+}
+
 Status GetOrCreateKernelAndDevice(
     EagerOperation* op, TensorHandle** retvals, int* num_retvals,
     core::RefCountPtr<KernelAndDevice>* out_kernel) {
   EagerContext& ctx = op->EagerContext();
+
+  // A prepared operation that runs again with the same kind of inputs skips
+  // device selection and the kernel cache lookup below.
+  EagerOperation* prepared_op = nullptr;
+  if (op->is_prepared()) {
+    core::RefCountPtr<KernelAndDevice> kernel = op->PreparedKernel();
+    if (kernel != nullptr) {
+      TF_RETURN_IF_ERROR(SetNumRetvals(*kernel, num_retvals));
+      *out_kernel = std::move(kernel);
+      return OkStatus();
+    }
+    prepared_op = op;
+  }
+
   Device* device = std::get<Device*>(op->Device());
 
   // Update the EagerOperation with information about the boolean input tensors
@@ -1566,13 +1591,10 @@ Status GetOrCreateKernelAndDevice(
     }
   }
 
-  int num_outputs = kernel->num_outputs();
-  if (num_outputs > *num_retvals) {
-    return errors::InvalidArgument("Expecting ", num_outputs,
-                                   " outputs, but *num_retvals is ",
-                                   *num_retvals);
+  TF_RETURN_IF_ERROR(SetNumRetvals(*kernel, num_retvals));
+  if (prepared_op != nullptr) {
+    prepared_op->SetPreparedKernel(kernel);
   }
-  *num_retvals = num_outputs;
 
   kernel->Ref();  // Ownership of reference is passed to out_kernel.
   out_kernel->reset(kernel.get());
@@ -1740,6 +1762,10 @@ Status EagerLocalExecute(EagerOperation* op, TensorHandle** retvals,
   }
   if (!status.ok()) return status;
 
+  if (executor.RecordsOpTraces()) {
+    executor.RecordOp(op->MutableAttrs()->CacheKey(op->DeviceName()));
+  }
+
   int num_outputs = kernel->num_outputs();
   TF_RETURN_IF_ERROR(ValidateInputTypeAndPlacement(&ctx, op, kernel));
 
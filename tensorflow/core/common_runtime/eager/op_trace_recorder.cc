@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/op_trace_recorder.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+OpTraceRecorder::OpTraceRecorder(int trace_length, int hot_threshold)
+    : trace_length_(trace_length), hot_threshold_(hot_threshold) {
+  DCHECK_GT(trace_length_, 0);
+  DCHECK_GT(hot_threshold_, 0);
+}
+
+bool OpTraceRecorder::RecordOp(const Fprint128& op_key) {
+  window_.push_back(op_key);
+  const int window_size = window_.size();
+  if (window_size > trace_length_) {
+    window_.pop_front();
+  } else if (window_size < trace_length_) {
+    return false;
+  }
+
+  Fprint128 trace_key = window_.front();
+  for (auto it = window_.begin() + 1; it != window_.end(); ++it) {
+    trace_key = tsl::FingerprintCat128(trace_key, *it);
+  }
+  last_trace_key_ = trace_key;
+
+  if (trace_counts_.size() >= kMaxTraces &&
+      !trace_counts_.contains(trace_key)) {
+    trace_counts_.clear();
+  }
+  if (++trace_counts_[trace_key] != hot_threshold_) {
+    return false;
+  }
+  ++num_hot_traces_;
+  return true;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,64 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_OP_TRACE_RECORDER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_OP_TRACE_RECORDER_H_
+
+#include <cstdint>
+#include <deque>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+
+// Detects hot traces in a stream of eager ops: sequences of `trace_length`
+// consecutive ops with the same signatures that repeat, such as the ops of a
+// per-step optimizer update. A trace is hot once it has been seen
+// `hot_threshold` times.
+//
+// This class is not thread-safe.
+class OpTraceRecorder {
+ public:
+  OpTraceRecorder(int trace_length, int hot_threshold);
+
+  // Records an op whose signature (e.g. its name, attributes and device) is
+  // fingerprinted as `op_key`. Returns true if the trace of the last
+  // `trace_length` ops, ending with this one, has just become hot.
+  bool RecordOp(const Fprint128& op_key);
+
+  // Returns the fingerprint of the trace of the last `trace_length` ops, or
+  // the fingerprint of no op if fewer ops have been recorded.
+  Fprint128 LastTraceKey() const { return last_trace_key_; }
+
+  // The number of times a trace has become hot.
+  int64_t num_hot_traces() const { return num_hot_traces_; }
+
+ private:
+  // The most traces counted at once. Once it is reached, the counts restart
+  // so that the memory stays bounded when no trace repeats.
+  static constexpr int kMaxTraces = 1 << 16;
+
+  const int trace_length_;
+  const int hot_threshold_;
+  std::deque<Fprint128> window_;
+  Fprint128 last_trace_key_ = {0, 0};
+  // The number of times each trace has been seen.
+  absl::flat_hash_map<Fprint128, int, Fprint128Hasher> trace_counts_;
+  int64_t num_hot_traces_ = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_OP_TRACE_RECORDER_H_
@@ -0,0 +1,58 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/op_trace_recorder.h"
+
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Fprint128 OpKey(const char* op) { return Fingerprint128(op); }
+
+TEST(OpTraceRecorderTest, RepeatedTraceBecomesHot) {
+  OpTraceRecorder recorder(/*trace_length=*/3, /*hot_threshold=*/2);
+  // The first step has no full trace before its third op.
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Mul")));
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Sub")));
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Assign")));
+  const Fprint128 step_trace = recorder.LastTraceKey();
+  // The traces spanning two steps are seen for the first time.
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Mul")));
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Sub")));
+  // The trace of a whole step is seen for the second time.
+  EXPECT_TRUE(recorder.RecordOp(OpKey("Assign")));
+  EXPECT_EQ(recorder.LastTraceKey(), step_trace);
+  EXPECT_EQ(recorder.num_hot_traces(), 1);
+
+  // So are the traces spanning two steps. A hot trace is only reported once.
+  EXPECT_TRUE(recorder.RecordOp(OpKey("Mul")));
+  EXPECT_TRUE(recorder.RecordOp(OpKey("Sub")));
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Assign")));
+  EXPECT_EQ(recorder.num_hot_traces(), 3);
+}
+
+TEST(OpTraceRecorderTest, DifferentOrderIsADifferentTrace) {
+  OpTraceRecorder recorder(/*trace_length=*/2, /*hot_threshold=*/2);
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Mul")));
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Sub")));
+  EXPECT_FALSE(recorder.RecordOp(OpKey("Mul")));
+  EXPECT_EQ(recorder.num_hot_traces(), 0);
+  EXPECT_TRUE(recorder.RecordOp(OpKey("Sub")));
+  EXPECT_EQ(recorder.num_hot_traces(), 1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "absl/status/status.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/variant.h"
@@ -65,8 +67,74 @@ string SafeDeviceDebugString(Device* device) {
     return device->DebugString();
   }
 }
+
+// The most destroyed TensorHandles whose memory is kept for reuse by each
+// thread. Memory is not reused under sanitizers, so that they still catch uses
+// after free.
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) || defined(ABSL_HAVE_THREAD_SANITIZER)
+constexpr int kMaxFreeTensorHandles = 0;
+#else
+constexpr int kMaxFreeTensorHandles = 64;
+#endif
+
+// Set once the free list of the thread is destroyed on thread exit, after
+// which the handles still destroyed by the thread go back to the heap.
+thread_local bool tensor_handle_free_list_destroyed = false;
+
+// The memory of the TensorHandles destroyed by a thread, reused by the handles
+// it creates next. Being per thread, it needs no lock: a process-wide list
+// would serialize the eager threads on its mutex.
+struct TensorHandleFreeList {
+  ~TensorHandleFreeList() {
+    tensor_handle_free_list_destroyed = true;
+    for (int i = 0; i < size; ++i) {
+      ::operator delete(handles[i]);
+    }
+    size = 0;
+  }
+
+  void* handles[kMaxFreeTensorHandles > 0 ? kMaxFreeTensorHandles : 1];
+  int size = 0;
+};
+
+thread_local TensorHandleFreeList tensor_handle_free_list;
+
+// Cleared by `TensorHandle::SetFreeListEnabledForTest()`.
+std::atomic<bool> tensor_handle_free_list_enabled{true};
+
+TensorHandleFreeList* GetTensorHandleFreeList() {
+  if (kMaxFreeTensorHandles == 0 || tensor_handle_free_list_destroyed ||
+      !tensor_handle_free_list_enabled.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return &tensor_handle_free_list;
+}
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+  TensorHandleFreeList* free_list = GetTensorHandleFreeList();
+  if (free_list != nullptr && free_list->size > 0 &&
+      size == sizeof(TensorHandle)) {
+    return free_list->handles[--free_list->size];
+  }
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+  TensorHandleFreeList* free_list = GetTensorHandleFreeList();
+  if (free_list != nullptr && free_list->size < kMaxFreeTensorHandles &&
+      size == sizeof(TensorHandle)) {
+    free_list->handles[free_list->size++] = ptr;
+    return;
+  }
+  ::operator delete(ptr);
+}
+
+void TensorHandle::SetFreeListEnabledForTest(bool enabled) {
+  tensor_handle_free_list_enabled.store(enabled, std::memory_order_relaxed);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
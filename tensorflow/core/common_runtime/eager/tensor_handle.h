@@ -128,6 +128,16 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // defined.
   void Release();
 
+  // A handle is created and destroyed for every op output, so the memory of
+  // destroyed handles is kept in a bounded per-thread free list and reused by
+  // new handles instead of going back to the heap.
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
+  // Sends the memory of the handles created and destroyed from now on to and
+  // from the heap when `enabled` is false, to measure the free list against it.
+  static void SetFreeListEnabledForTest(bool enabled);
+
   tensorflow::DataType DataType() const override;
   Status Shape(tensorflow::PartialTensorShape* shape) const override;
   Status NumDims(int* num_dims) const override;
@@ -20,13 +20,17 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 namespace {
@@ -544,6 +548,60 @@ TEST_F(RemoteTensorHandleTest, PoisonRemoteMirror) {
   context->Unref();
 }
 
+TEST(TensorHandle_LocalTest, ReusesMemoryOfDestroyedHandle) {
+#if defined(ABSL_HAVE_ADDRESS_SANITIZER) || \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) || defined(ABSL_HAVE_THREAD_SANITIZER)
+  GTEST_SKIP() << "Memory of handles is not reused under sanitizers.";
+#endif
+  TensorHandle* h = TensorHandle::CreateLocalHandle(
+      test::AsTensor<float>({1.0f, 2.0f}, TensorShape({2})));
+  const void* ptr = h;
+  h->Unref();
+
+  h = TensorHandle::CreateLocalHandle(
+      test::AsTensor<int32>({1, 2, 3}, TensorShape({3})));
+  EXPECT_EQ(h, ptr);
+  EXPECT_EQ(h->DataType(), DT_INT32);
+  int64_t num_elements;
+  TF_ASSERT_OK(h->NumElements(&num_elements));
+  EXPECT_EQ(num_elements, 3);
+  h->Unref();
+}
+
+TEST(TensorHandle_LocalTest, FreesHandleCreatedByAnotherThread) {
+  TensorHandle* h = TensorHandle::CreateLocalHandle(
+      test::AsTensor<float>({1.0f, 2.0f}, TensorShape({2})));
+  std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+      ThreadOptions(), "unref_handle", [h] { h->Unref(); }));
+  // Joins the thread, which frees the handle's memory on exit.
+  thread.reset();
+
+  h = TensorHandle::CreateLocalHandle(
+      test::AsTensor<int32>({1, 2, 3}, TensorShape({3})));
+  EXPECT_EQ(h->DataType(), DT_INT32);
+  h->Unref();
+}
+
+// Arg 1 reuses the memory of the handles through the per-thread free list, arg
+// 0 takes it from the heap. Every thread of a run sets the same value before
+// the threads start timing, and the arg 1 runs come last.
+void BM_CreateAndDestroyLocalHandle(::testing::benchmark::State& state) {
+  const bool free_list = state.range(0);
+  const Tensor t = test::AsTensor<float>({1.0f, 2.0f}, TensorShape({2}));
+  TensorHandle::SetFreeListEnabledForTest(free_list);
+  for (auto s : state) {
+    TensorHandle::CreateLocalHandle(t)->Unref();
+  }
+}
+BENCHMARK(BM_CreateAndDestroyLocalHandle)
+    ->UseRealTime()
+    ->ArgName("free_list")
+    ->Arg(0)
+    ->Arg(1)
+    ->Threads(1)
+    ->Threads(8)
+    ->Threads(16);
+
 TEST(TensorHandle_LocalTest, TensorFromDeviceSameDevice) {
   std::vector<std::unique_ptr<Device>> devices;
   devices.emplace_back(
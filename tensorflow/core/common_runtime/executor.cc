@@ -17,12 +17,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/activity_watcher/activity.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -53,6 +57,7 @@ limitations under the License.
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -62,6 +67,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -145,9 +151,21 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// Name under which the work-stealing variant of the default executor is
+// registered with `ExecutorFactory`.
+static const string& kWorkStealingExecutor =
+    *new string("WORK_STEALING_EXECUTOR");
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `num_work_stealing_workers` is positive, each step keeps its ready
+  // nodes in per-worker deques (see `WorkStealingReadyQueue`) that are drained
+  // by at most that many closures on the inter-op thread pool, instead of
+  // handing every expensive node to `Args::runner` separately.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        int num_work_stealing_workers = 0)
+      : immutable_state_(p),
+        num_work_stealing_workers_(num_work_stealing_workers) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
@@ -155,6 +173,14 @@ class ExecutorImpl : public Executor {
     return OkStatus();
   }
 
+  void ExportKernelCostStats(DeviceCostStats* stats) const override {
+    kernel_stats_.Export(immutable_state_.graph_view(), stats);
+  }
+
+  void ImportKernelCostStats(const DeviceCostStats& stats) override {
+    kernel_stats_.Import(immutable_state_.graph_view(), stats);
+  }
+
  private:
   void RunAsyncInternal(const Args& args, DoneCallback done) override;
 
@@ -170,13 +196,19 @@ class ExecutorImpl : public Executor {
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      histogram_index_.assign(gview.num_nodes(), -1);
+      int32_t num_histograms = 0;
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
+          // Only kernels with the expensive marker are ever timed.
+          if (is_expensive_[i]) histogram_index_[i] = num_histograms++;
         }
       }
+      histograms_ = std::make_unique<std::atomic<uint32_t>[]>(
+          num_histograms * kNumCostBuckets);
     }
 
     // Returns true iff the given node is considered "expensive". The
@@ -208,9 +240,82 @@ class ExecutorImpl : public Executor {
           ((kCostDecay - 1) * prev_estimate + elapsed_cycles) / kCostDecay;
 
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
+
+      histograms_[histogram_index_[node.node_id] * kNumCostBuckets +
+                  CostBucket(elapsed_cycles)]
+          .fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Appends the cost estimates and histograms of all timed kernels to
+    // `stats`.
+    void Export(const GraphView& gview, DeviceCostStats* stats) const {
+      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+        if (histogram_index_[i] < 0) continue;
+        const std::atomic<uint32_t>* histogram =
+            &histograms_[histogram_index_[i] * kNumCostBuckets];
+        NodeCostStats node_stats;
+        uint64 count = 0;
+        for (int b = 0; b < kNumCostBuckets; ++b) {
+          const uint32_t bucket = histogram[b].load(std::memory_order_relaxed);
+          count += bucket;
+          node_stats.add_bucket_limit(BucketLimit(b));
+          node_stats.add_bucket(bucket);
+        }
+        if (count == 0) continue;
+        node_stats.set_node_name(gview.node(i)->kernel->name());
+        node_stats.set_cost_estimate_cycles(
+            cost_estimates_[i].load(std::memory_order_relaxed));
+        *stats->add_node_stats() = std::move(node_stats);
+      }
+    }
+
+    // Replaces the initial cost estimates of the kernels named in `stats`, and
+    // adds their histograms to ours if they use the same buckets.
+    void Import(const GraphView& gview, const DeviceCostStats& stats) {
+      absl::flat_hash_map<absl::string_view, const NodeCostStats*> by_name;
+      for (const NodeCostStats& node_stats : stats.node_stats()) {
+        by_name[node_stats.node_name()] = &node_stats;
+      }
+      for (int32_t i = 0; i < gview.num_nodes(); ++i) {
+        if (histogram_index_[i] < 0) continue;
+        auto it = by_name.find(gview.node(i)->kernel->name());
+        if (it == by_name.end()) continue;
+        const NodeCostStats& node_stats = *it->second;
+        cost_estimates_[i].store(node_stats.cost_estimate_cycles(),
+                                 std::memory_order_relaxed);
+        if (node_stats.bucket_size() != kNumCostBuckets ||
+            node_stats.bucket_limit_size() != kNumCostBuckets) {
+          continue;
+        }
+        std::atomic<uint32_t>* histogram =
+            &histograms_[histogram_index_[i] * kNumCostBuckets];
+        for (int b = 0; b < kNumCostBuckets; ++b) {
+          if (node_stats.bucket_limit(b) != BucketLimit(b)) break;
+          histogram[b].fetch_add(node_stats.bucket(b),
+                                 std::memory_order_relaxed);
+        }
+      }
     }
 
    private:
+    // Histogram buckets grow by powers of 4: bucket 0 holds executions of
+    // less than 256 cycles, bucket `b` those of [256 * 4^(b-1), 256 * 4^b)
+    // cycles, and the last bucket is unbounded.
+    static constexpr int kNumCostBuckets = 16;
+
+    static int CostBucket(uint64 cycles) {
+      if (cycles < 256) return 0;
+      return std::min<int>((Log2Floor64(cycles) - 8) / 2 + 1,
+                           kNumCostBuckets - 1);
+    }
+
+    static uint64 BucketLimit(int bucket) {
+      if (bucket == kNumCostBuckets - 1) {
+        return std::numeric_limits<uint64>::max();
+      }
+      return uint64{256} << (2 * bucket);
+    }
+
     // Initial time (in CPU cycles) we expect an operation to take.  Used to
     // determine whether an operation should be place in a threadpool.
     // Operations start out "expensive".
@@ -221,10 +326,16 @@ class ExecutorImpl : public Executor {
     std::vector<bool> is_expensive_;
     // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    // Index of each node's histogram in `histograms_`, or -1 if the node is
+    // never timed.
+    std::vector<int32_t> histogram_index_;
+    // `kNumCostBuckets` counters per timed node.
+    std::unique_ptr<std::atomic<uint32_t>[]> histograms_;
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  const int num_work_stealing_workers_;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +395,8 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                int num_work_stealing_workers = 0);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -295,6 +407,7 @@ class ExecutorState {
   typedef
       typename PropagatorStateType::TaggedNodeReadyQueue TaggedNodeReadyQueue;
   typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
+  typedef WorkStealingReadyQueue<TaggedNode> StealingQueue;
 
   struct AsyncState;
 
@@ -340,6 +453,26 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Adds `tagged_node` to the work-stealing deque of the current worker (or to
+  // an arbitrary deque if the current thread is not a worker of this step).
+  // The caller must call `MaybeStartStealingWorkers()` after pushing.
+  //
+  // REQUIRES: `stealing_queue_ != nullptr`.
+  void PushStealable(const TaggedNode& tagged_node);
+
+  // Claims up to `max_new_workers` idle worker slots of `stealing_queue_` and
+  // schedules a closure for each of them on `runner_`.
+  void MaybeStartStealingWorkers(size_t max_new_workers,
+                                 int64_t scheduled_nsec);
+
+  // Drains `queue`, starting with the deque of `worker`, and then releases
+  // the worker slot. The executor state may be deleted while this runs (when
+  // the last node completes), so `state` is only dereferenced to process a
+  // node that was popped from `queue`.
+  static void RunStealingWorker(ExecutorState* state,
+                                std::shared_ptr<StealingQueue> queue,
+                                int worker, int64_t scheduled_nsec);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -400,6 +533,10 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Per-worker ready queues, or null if work stealing is disabled. Shared with
+  // the worker closures, which may outlive this object.
+  std::shared_ptr<StealingQueue> stealing_queue_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -418,7 +555,7 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, int num_work_stealing_workers)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -447,11 +584,21 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
+      stealing_queue_(num_work_stealing_workers > 0 && !run_all_kernels_inline_
+                          ? std::make_shared<StealingQueue>(
+                                num_work_stealing_workers)
+                          : nullptr),
       num_outstanding_ops_(0) {
-  if (args.user_intra_op_threadpool != nullptr) {
+  if (args.user_intra_op_threadpool != nullptr ||
+      args.step_allocator != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
-        device->name(), device, false, false, args.user_intra_op_threadpool);
+        device->name(), device, false, false, args.user_intra_op_threadpool,
+        args.step_allocator);
+  }
+  if (args.device_context != nullptr) {
+    device_context_ = args.device_context;
+    device_context_->Ref();
   }
 }
 
@@ -491,14 +638,17 @@ template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
 
-  // Ask the device to fill in the device context map.
-  Device* device = immutable_state_.params().device;
-  const Status get_context_status =
-      device->TryGetDeviceContext(&device_context_);
-  if (!get_context_status.ok()) {
-    delete this;
-    done(get_context_status);
-    return;
+  // Ask the device to fill in the device context map, unless the caller
+  // provided one.
+  if (device_context_ == nullptr) {
+    Device* device = immutable_state_.params().device;
+    const Status get_context_status =
+        device->TryGetDeviceContext(&device_context_);
+    if (!get_context_status.ok()) {
+      delete this;
+      done(get_context_status);
+      return;
+    }
   }
 
   // Initialize the ready queue.
@@ -747,7 +897,8 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   auto params = std::make_unique<OpKernelContext::Params>();
 
   params->step_id = step_id_;
-  // Override device's threadpool if user provides an intra_op_threadpool
+  // Override device's threadpool if user provides an intra_op_threadpool, and
+  // its allocator if a step allocator is provided.
   Device* device = immutable_state_.params().device;
   if (user_device_) {
     params->device = user_device_.get();
@@ -914,6 +1065,8 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       params->output_attr_array = item.output_attrs();
       params->forward_from_array = item.forward_from();
       params->outputs_required_array = item.outputs_required.get();
+      params->output_retval_index_array = item.output_retval_index.get();
+      params->output_lifetime_array = item.output_lifetime.get();
       params->inputs = *inputs;
       params->input_alloc_attrs = input_alloc_attrs;
 
@@ -1297,7 +1450,39 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
+    if (stealing_queue_ != nullptr) {
+      // Keep inexpensive nodes on this thread as usual, but make all other
+      // ready nodes available for idle workers to steal, instead of
+      // dispatching a closure for each of them.
+      const TaggedNode* inline_expensive_node = nullptr;
+      size_t num_stealable = 0;
+      for (auto& tagged_node : *ready) {
+        const NodeItem& item = *tagged_node.node_item;
+        if (inline_ready != nullptr &&
+            (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item))) {
+          inline_ready->push_back(tagged_node);
+        } else if (inline_ready != nullptr &&
+                   inline_expensive_node == nullptr) {
+          inline_expensive_node = &tagged_node;
+        } else {
+          PushStealable(tagged_node);
+          ++num_stealable;
+        }
+      }
+      if (inline_expensive_node) {
+        // Like the default policy below, run one expensive node inline if
+        // there is nothing else to run on this thread.
+        if (inline_ready->empty()) {
+          inline_ready->push_back(*inline_expensive_node);
+        } else {
+          PushStealable(*inline_expensive_node);
+          ++num_stealable;
+        }
+      }
+      if (num_stealable > 0) {
+        MaybeStartStealingWorkers(num_stealable, scheduled_nsec);
+      }
+    } else if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
         RunTask([=]() { Process(tagged_node, scheduled_nsec); },
@@ -1371,6 +1556,44 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::PushStealable(
+    const TaggedNode& tagged_node) {
+  stealing_queue_->Push(stealing_queue_->CurrentWorker(), tagged_node);
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::MaybeStartStealingWorkers(
+    size_t max_new_workers, int64_t scheduled_nsec) {
+  for (size_t i = 0; i < max_new_workers; ++i) {
+    const int worker = stealing_queue_->TryClaimWorker();
+    if (worker < 0) break;
+    RunTask(
+        [this, queue = stealing_queue_, worker, scheduled_nsec]() mutable {
+          RunStealingWorker(this, std::move(queue), worker, scheduled_nsec);
+        },
+        /*sample_rate=*/max_new_workers);
+  }
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunStealingWorker(
+    ExecutorState* state, std::shared_ptr<StealingQueue> queue, int worker,
+    int64_t scheduled_nsec) {
+  profiler::TraceMe activity("ExecutorState::RunStealingWorker",
+                             profiler::TraceMeLevel::kVerbose);
+  typename StealingQueue::ScopedWorker scoped_worker(queue.get(), worker);
+  while (true) {
+    while (absl::optional<TaggedNode> tagged_node = queue->Pop(worker)) {
+      state->Process(*tagged_node, scheduled_nsec);
+    }
+    queue->ReleaseWorker(worker);
+    // A producer that pushed a node after our last `Pop()` may have found no
+    // idle worker slot, so we must check again after releasing ours.
+    if (!queue->HasWork() || !queue->TryClaimWorker(worker)) return;
+  }
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1513,11 +1736,13 @@ void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        num_work_stealing_workers_))
         ->RunAsync(std::move(done));
   } else {
     (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+                                              &kernel_stats_,
+                                              num_work_stealing_workers_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1556,6 +1781,7 @@ class DefaultExecutorRegistrar {
     Factory* factory = new Factory;
     ExecutorFactory::Register("", factory);
     ExecutorFactory::Register("DEFAULT", factory);
+    ExecutorFactory::Register(kWorkStealingExecutor, new WorkStealingFactory);
   }
 
  private:
@@ -1568,6 +1794,17 @@ class DefaultExecutorRegistrar {
       return OkStatus();
     }
   };
+
+  class WorkStealingFactory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl =
+          std::make_unique<ExecutorImpl>(params, port::MaxParallelism());
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return OkStatus();
+    }
+  };
 };
 static DefaultExecutorRegistrar registrar;
 
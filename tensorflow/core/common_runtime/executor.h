@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/session_state.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -108,6 +109,12 @@ class Executor {
     ScopedStepContainer* step_container = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
+    // If non-null, kernels allocate from this allocator instead of the
+    // device's allocator for the default `AllocatorAttributes`. Not owned.
+    Allocator* step_allocator = nullptr;
+    // If non-null, kernels run with this device context instead of the one
+    // returned by the device's `TryGetDeviceContext()`. Not owned.
+    DeviceContext* device_context = nullptr;
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
     int64_t start_time_usecs = 0;
     // The deadline for the kernel to complete by. Empty if unspecified.
@@ -146,6 +153,17 @@ class Executor {
     return ret;
   }
 
+  // Appends the cost statistics that this executor has collected for its
+  // kernels to `stats->node_stats()`. Executors that do not time their
+  // kernels append nothing.
+  virtual void ExportKernelCostStats(DeviceCostStats* stats) const {}
+
+  // Initializes the cost estimates of the kernels in this executor's graph from
+  // `stats`, matching nodes by name, e.g. with statistics exported by an
+  // executor for the same graph in another process. Must be called before the
+  // first step.
+  virtual void ImportKernelCostStats(const DeviceCostStats& stats) {}
+
  private:
   virtual void RunAsyncInternal(const Args& args, DoneCallback done) = 0;
 };
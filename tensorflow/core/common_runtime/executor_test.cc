@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
@@ -77,8 +78,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is non-empty, the executor is created through
+  // `ExecutorFactory`.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -93,7 +97,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> exec;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &exec));
+      exec_ = exec.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -266,6 +276,25 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, WorkStealingRandomTree) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  for (int iters = 0; iters < 4; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    Rendezvous::Args args;
+    TF_ASSERT_OK(
+        rendez->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+    TF_ASSERT_OK(Run(rendez));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(
+        rendez->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+    rendez->Unref();
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -322,6 +351,25 @@ TEST_F(ExecutorTest, SimpleSwitchLive) {
   EXPECT_FALSE(is_dead);
 }
 
+TEST_F(ExecutorTest, WorkStealingSimpleSwitchLive) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  auto in1 = test::graph::Constant(g.get(), VB(false));
+  auto tmp = test::graph::Switch(g.get(), in0, in1);
+  test::graph::Send(g.get(), tmp, "c", BOB, 1, ALICE);
+  Create(std::move(g), "WORK_STEALING_EXECUTOR");
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0),
+                             false));  // in0 = 1.0
+  TF_ASSERT_OK(Run(rendez_));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "c"), args, &out, &is_dead));
+  EXPECT_EQ(1.0, V(out));  // out = 1.0
+  EXPECT_FALSE(is_dead);
+}
+
 TEST_F(ExecutorTest, SimpleSwitchDead) {
   auto g = std::make_unique<Graph>(OpRegistry::Global());
   auto in0 = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
@@ -440,10 +488,59 @@ TEST_F(ExecutorTest, NoInputTensors) {
   TF_ASSERT_OK(Run(rendez_));
 }
 
+TEST_F(ExecutorTest, KernelCostStats) {
+  auto build_graph = [] {
+    auto g = std::make_unique<Graph>(OpRegistry::Global());
+    auto in0 = test::graph::Constant(g.get(), V(1.0));
+    auto in1 = test::graph::Constant(g.get(), V(2.0));
+    test::graph::Add(g.get(), in0, in1)->set_name("add");
+    return g;
+  };
+  Create(build_graph());
+  DeviceCostStats stats;
+  exec_->ExportKernelCostStats(&stats);
+  // Nothing has been timed yet.
+  EXPECT_EQ(0, stats.node_stats_size());
+
+  TF_ASSERT_OK(Run(rendez_));
+  exec_->ExportKernelCostStats(&stats);
+  const NodeCostStats* add_stats = nullptr;
+  for (const NodeCostStats& node_stats : stats.node_stats()) {
+    if (node_stats.node_name() == "add") add_stats = &node_stats;
+  }
+  ASSERT_NE(nullptr, add_stats);
+  ASSERT_EQ(add_stats->bucket_size(), add_stats->bucket_limit_size());
+  int64_t count = 0;
+  for (int i = 0; i < add_stats->bucket_size(); ++i) {
+    count += add_stats->bucket(i);
+    if (i > 0) {
+      EXPECT_LT(add_stats->bucket_limit(i - 1), add_stats->bucket_limit(i));
+    }
+  }
+  EXPECT_EQ(1, count);
+
+  // A new executor for the same graph starts from the imported estimates and
+  // keeps the imported histograms.
+  DeviceCostStats warm_start;
+  *warm_start.add_node_stats() = *add_stats;
+  warm_start.mutable_node_stats(0)->set_cost_estimate_cycles(1);
+  rendez_->Unref();
+  Create(build_graph());
+  exec_->ImportKernelCostStats(warm_start);
+  DeviceCostStats imported;
+  exec_->ExportKernelCostStats(&imported);
+  ASSERT_EQ(1, imported.node_stats_size());
+  EXPECT_EQ("add", imported.node_stats(0).node_name());
+  EXPECT_EQ(1, imported.node_stats(0).cost_estimate_cycles());
+  EXPECT_EQ(add_stats->bucket_size(), imported.node_stats(0).bucket_size());
+  TF_ASSERT_OK(Run(rendez_));
+}
+
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+static void BM_executor_helper(::testing::benchmark::State& state,
+                               const char* executor_type) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -477,12 +574,50 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  BM_executor_helper(state, "");
+}
+
+static void BM_work_stealing_executor(::testing::benchmark::State& state) {
+  BM_executor_helper(state, "WORK_STEALING_EXECUTOR");
+}
+
+// Graphs of no-ops forming a binary tree of control dependencies, which
+// measure the executor overhead per node across graph sizes.
+static void BM_executor_graph_size(::testing::benchmark::State& state) {
+  const int num_nodes = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> nodes;
+  nodes.reserve(num_nodes);
+  nodes.push_back(test::graph::NoOp(g, {}));
+  for (int i = 1; i < num_nodes; ++i) {
+    nodes.push_back(test::graph::NoOp(g, {nodes[(i - 1) / 2]}));
+  }
+
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, /*executor_type=*/"",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+
+  state.SetItemsProcessed(num_nodes * static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_executor_graph_size)
+    ->UseRealTime()
+    ->RangeMultiplier(10)
+    ->Range(10, 100000);
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
@@ -494,6 +629,11 @@ BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
 
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(8192, 32);
+BENCHMARK(BM_work_stealing_executor)->UseRealTime()->ArgPair(1024, 1024);
+
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
   const int outputs_per_const = state.range(1);
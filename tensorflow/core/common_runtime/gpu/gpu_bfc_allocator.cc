@@ -95,7 +95,44 @@ GPUBFCAllocator::GPUBFCAllocator(
           o.garbage_collection = GetGarbageCollectionValue();
         }
         o.fragmentation_fraction = opts.fragmentation_fraction;
+        o.lifetime_aware_placement = opts.lifetime_aware_placement;
         return o;
-      }()) {}
+      }()) {
+  // The thread would never release memory without decommit support, e.g.
+  // with the sub-allocators of device memory (the virtual memory one is
+  // disabled in gpu_process_state.cc).
+  if (opts.idle_decommit_secs > 0 && !SupportsDecommit()) {
+    LOG(WARNING) << "Ignoring idle_decommit_secs of " << name
+                 << ": its sub-allocator can't decommit memory.";
+  } else if (opts.idle_decommit_secs > 0) {
+    idle_decommit_thread_.reset(tsl::Env::Default()->StartThread(
+        tsl::ThreadOptions(), "gpu_bfc_idle_decommit",
+        [this, secs = opts.idle_decommit_secs] { IdleDecommitLoop(secs); }));
+  }
+}
+
+GPUBFCAllocator::~GPUBFCAllocator() {
+  {
+    tsl::mutex_lock l(idle_mu_);
+    shutting_down_ = true;
+  }
+  idle_cv_.notify_all();
+  // Joins the thread.
+  idle_decommit_thread_.reset();
+}
+
+void GPUBFCAllocator::IdleDecommitLoop(int64_t idle_decommit_secs) {
+  int64_t last_num_allocs = -1;
+  tsl::mutex_lock l(idle_mu_);
+  while (!shutting_down_) {
+    tsl::WaitForMilliseconds(&l, &idle_cv_, idle_decommit_secs * 1000);
+    if (shutting_down_) break;
+    const int64_t num_allocs = GetStats()->num_allocs;
+    if (num_allocs == last_num_allocs) {
+      DecommitFreeMemory();
+    }
+    last_num_allocs = num_allocs;
+  }
+}
 
 }  // namespace tensorflow
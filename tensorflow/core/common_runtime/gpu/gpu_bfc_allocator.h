@@ -22,6 +22,9 @@ limitations under the License.
 
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/bfc_allocator.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
 #include "tsl/platform/macros.h"
 
 namespace tensorflow {
@@ -46,16 +49,33 @@ class GPUBFCAllocator : public tsl::BFCAllocator {
 
     double fragmentation_fraction = 0;
     bool allow_retry_on_failure = true;
+    bool lifetime_aware_placement = false;
+
+    // If positive, the memory of the free chunks is decommitted (see
+    // BFCAllocator::DecommitFreeMemory()) once no allocation has been made for
+    // this many seconds. This is ignored, and no thread is started, unless the
+    // sub-allocator supports decommitting memory.
+    int64_t idle_decommit_secs = 0;
   };
 
   GPUBFCAllocator(std::unique_ptr<tsl::SubAllocator> sub_allocator,
                   size_t total_memory, const std::string& name,
                   const Options& opts);
 
-  ~GPUBFCAllocator() override {}
+  ~GPUBFCAllocator() override;
 
   GPUBFCAllocator(const GPUBFCAllocator&) = delete;
   void operator=(const GPUBFCAllocator&) = delete;
+
+ private:
+  // Decommits the free memory whenever no allocation was made in the last
+  // `idle_decommit_secs` seconds, until the allocator is destroyed.
+  void IdleDecommitLoop(int64_t idle_decommit_secs);
+
+  tsl::mutex idle_mu_;
+  tsl::condition_variable idle_cv_;
+  bool shutting_down_ TF_GUARDED_BY(idle_mu_) = false;
+  std::unique_ptr<tsl::Thread> idle_decommit_thread_;
 };
 
 }  // namespace tensorflow
@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_step_graph.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -550,13 +551,23 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   attr.set_gpu_compatible(true);
   Allocator* host_memory_allocator = GetAllocator(attr);
 
+  const auto& gpu_experimental = options.config.gpu_options().experimental();
+  if (gpu_experimental.use_pinned_staging_pool()) {
+    GpuStagingPool::Options staging_options;
+    staging_options.ring_buffer_bytes =
+        std::max<int64_t>(gpu_experimental.staging_ring_buffer_bytes(), 0);
+    staging_pool_ = std::make_unique<GpuStagingPool>(host_memory_allocator,
+                                                     staging_options);
+  }
+
   device_context_ =
       new GPUDeviceContext(0, stream_->compute,
 #if TENSORFLOW_USE_ROCM
                            stream_->nccl,
 #endif
                            stream_->host_to_device, stream_->device_to_host,
-                           stream_->device_to_device, host_memory_allocator);
+                           stream_->device_to_device, host_memory_allocator,
+                           staging_pool_.get());
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
@@ -1276,14 +1287,14 @@ Status SingleVirtualDeviceMemoryLimit(const GPUOptions& gpu_options,
 }  // namespace
 
 void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
-                                       PerOpGpuDevice* device, int stream_id,
+                                       PerOpGpuDevice* device,
+                                       se::Stream* stream,
                                        Allocator* allocator) {
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
   const gpuStream_t gpu_stream = reinterpret_cast<gpuStream_t>(
-      stream_->compute->platform_specific_handle().stream);
+      stream->platform_specific_handle().stream);
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
                                 scratch_);
 }
@@ -1303,13 +1314,24 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
     CHECK_EQ(stream_id, 0);
-    ReinitializeDevice(context, device, stream_id, allocator);
+    // The stream of `dc` is the compute stream, unless the step is recorded
+    // into a step graph.
+    ReinitializeDevice(context, device, gpu_dc->stream(), allocator);
   } else {
-    ReinitializeDevice(context, device, 0, allocator);
+    ReinitializeDevice(context, device, stream_->compute, allocator);
   }
   return OkStatus();
 }
 
+Status BaseGPUDevice::CreateStepGraph(std::unique_ptr<StepGraph>* graph) {
+  if (kernel_tracker_ != nullptr || sync_every_op_) {
+    return errors::Unimplemented(
+        "Step graphs are not supported with a GPU kernel tracker or with "
+        "sync_every_op.");
+  }
+  return CreateGpuStepGraph(*device_context_, gpu_allocator_, graph);
+}
+
 Allocator* BaseGPUDevice::GetScopedAllocator(AllocatorAttributes attr,
                                              int64_t step_id) {
   if (attr.scope_id > 0) {
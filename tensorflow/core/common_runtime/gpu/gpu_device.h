@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/node_file_writer.h"
@@ -139,6 +140,11 @@ class BaseGPUDevice : public LocalDevice {
                                DeviceContext* dc,
                                Allocator* allocator) override;
 
+  // Records the kernels of a step into a CUDA (or HIP) graph, see
+  // gpu_step_graph.h. Unsupported if the kernels of the device are tracked or
+  // synchronized one by one.
+  Status CreateStepGraph(std::unique_ptr<StepGraph>* graph) override;
+
   // Returns the platform GPU id of this device within the native driver system;
   // e.g., for CUDA and ROCm this is the ordinal of the GPU within the system.
   int gpu_id() const {
@@ -193,10 +199,21 @@ class BaseGPUDevice : public LocalDevice {
   class StreamGroupFactory;
 
   core::RefCountPtr<DeviceContext> pjrt_device_context_;
+  // All the kernels of this device run on the single compute stream of
+  // `stream_`, through `device_context_`: the executor gives the same device
+  // context to all the kernels of a device. This is what makes it safe for the
+  // GPU allocator to reuse the memory freed by a kernel right away, as the
+  // kernels using it next are ordered after it on the stream. The concurrent
+  // compute streams of a GPU are those of its virtual devices instead, see
+  // GPUOptions.Experimental.virtual_devices. Kernels that are recorded into a
+  // step graph are enqueued to a stream of the step graph instead, but only
+  // run when the graph is launched on the compute stream.
   StreamGroup* stream_;
   mutex scratch_init_mutex_;
   char* scratch_ = nullptr;
   GPUDeviceContext* device_context_;
+  // Stages copies of pageable host memory, if enabled in the GPUOptions.
+  std::unique_ptr<GpuStagingPool> staging_pool_;
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   tsl::TfDeviceId tf_device_id_;
@@ -212,7 +229,7 @@ class BaseGPUDevice : public LocalDevice {
   Status InitScratchBuffers();
 
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
-                          int stream_id, Allocator* allocator);
+                          se::Stream* stream, Allocator* allocator);
 
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
@@ -25,6 +25,8 @@ limitations under the License.
 #include "xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #include "xla/stream_executor/gpu/gpu_init.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/random.h"
@@ -608,6 +610,48 @@ TEST_F(GPUDeviceTest, CopyTensorInSameDevice) {
   }
 }
 
+TEST_F(GPUDeviceTest, CopyPageableTensorThroughStagingPool) {
+  SessionOptions opts = MakeSessionOptions("0");
+  opts.config.mutable_gpu_options()
+      ->mutable_experimental()
+      ->set_use_pinned_staging_pool(true);
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_ASSERT_OK(DeviceFactory::GetFactory("GPU")->CreateDevices(
+      opts, kDeviceNamePrefix, &devices));
+  Device* device = devices[0].get();
+  auto* device_info = device->tensorflow_accelerator_device_info();
+  CHECK(device_info);
+  DeviceContext* device_context = device_info->default_context;
+  Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+
+  // Two full chunks and a partial one.
+  constexpr int kNumElements =
+      (2 * GpuStagingPool::kChunkBytes + 1024) / sizeof(float);
+  constexpr int64_t kNumBytes = kNumElements * sizeof(float);
+  Tensor cpu_tensor(cpu_allocator(), DT_FLOAT, TensorShape({kNumElements}));
+  auto input = cpu_tensor.tensor<float, 1>();
+  for (int i = 0; i < kNumElements; ++i) {
+    input(i) = i;
+  }
+  Tensor gpu_tensor(allocator, DT_FLOAT, TensorShape({kNumElements}));
+
+  const int64_t copy_count = GPUUtil::GetHostToDeviceCopyCountTestOnly();
+  const int64_t copy_bytes = GPUUtil::GetHostToDeviceCopyBytesTestOnly();
+  CopyCPUToGPU(&cpu_tensor, &gpu_tensor, device, device_context);
+  // Each chunk is copied once, and the input is not copied directly as well.
+  EXPECT_EQ(GPUUtil::GetHostToDeviceCopyCountTestOnly() - copy_count, 3);
+  EXPECT_EQ(GPUUtil::GetHostToDeviceCopyBytesTestOnly() - copy_bytes,
+            kNumBytes);
+
+  Tensor output_cpu_tensor(cpu_allocator(), DT_FLOAT,
+                           TensorShape({kNumElements}));
+  CopyGPUToCPU(&gpu_tensor, &output_cpu_tensor, device, device_context);
+  auto output = output_cpu_tensor.tensor<float, 1>();
+  for (int i = 0; i < kNumElements; ++i) {
+    ASSERT_EQ(output(i), i) << " for index " << i;
+  }
+}
+
 TEST_F(GPUDeviceTest, DeviceDetails) {
   DeviceFactory* factory = DeviceFactory::GetFactory("GPU");
   std::vector<string> devices;
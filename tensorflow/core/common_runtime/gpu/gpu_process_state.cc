@@ -149,7 +149,7 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
     return GpuVirtualMemAllocator::Create(
                alloc_visitors, {}, *gpu_context, platform_device_id,
                /*virtual_address_space_size=*/total_bytes * 2,
-               platform_peer_gpu_ids_vec)
+               platform_peer_gpu_ids_vec, /*allow_decommit=*/true)
         .value()
         .release();
   }
@@ -207,6 +207,8 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+          o.lifetime_aware_placement =
+              options.experimental().lifetime_aware_allocation();
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
@@ -14,17 +14,28 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/gpu/gpu_serving_device_selector.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "absl/container/fixed_array.h"
 #include "absl/log/check.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "tensorflow/core/common_runtime/serving_device_selector.h"
 
 namespace tensorflow {
 namespace gpu {
+namespace {
+
+// The weight of the latest run in the recorded execution time of a program,
+// in sixteenths.
+constexpr int64_t kExecutionTimeUpdateWeight = 4;
+
+}  // namespace
 
 GpuServingDeviceSelector::GpuServingDeviceSelector(
     const int num_devices,
@@ -44,6 +55,7 @@ DeviceReservation GpuServingDeviceSelector::ReserveDevice(
   DeviceState::ProgramInfo program_info;
   program_info.fingerprint = program_fingerprint;
   program_info.req_id = ++req_id_counter_;
+  program_info.schedule_time_ns = absl::GetCurrentTimeNanos();
   device_states_[device_index].scheduled_programs.push_back(program_info);
 
   return DeviceReservation(device_index, this);
@@ -51,10 +63,25 @@ DeviceReservation GpuServingDeviceSelector::ReserveDevice(
 
 void GpuServingDeviceSelector::FreeDeviceReservation(
     const DeviceReservation& reservation) {
+  const int64_t now_ns = absl::GetCurrentTimeNanos();
   absl::MutexLock lock(&mu_);
-  auto& scheduled_programs =
-      device_states_.at(reservation.device_index()).scheduled_programs;
+  DeviceState& device_state = device_states_.at(reservation.device_index());
+  auto& scheduled_programs = device_state.scheduled_programs;
   DCHECK(!scheduled_programs.empty());
+
+  // The programs on a device run one after another, so the program started
+  // when it was scheduled or when the previous one finished.
+  const DeviceState::ProgramInfo& program_info = scheduled_programs.front();
+  const int64_t execution_time_ns =
+      now_ns - std::max(program_info.schedule_time_ns,
+                        device_state.last_completion_time_ns);
+  auto [it, inserted] = device_state.program_execution_time_ns.try_emplace(
+      std::string(program_info.fingerprint), execution_time_ns);
+  if (!inserted) {
+    it->second += (execution_time_ns - it->second) *
+                  kExecutionTimeUpdateWeight / 16;
+  }
+  device_state.last_completion_time_ns = now_ns;
   scheduled_programs.pop_front();
 }
 
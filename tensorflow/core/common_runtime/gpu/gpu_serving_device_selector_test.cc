@@ -18,6 +18,8 @@ limitations under the License.
 #include <string>
 
 #include <gtest/gtest.h>
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/serving_device_selector.h"
 #include "tensorflow/core/common_runtime/serving_device_selector_policies.h"
 
@@ -41,6 +43,50 @@ TEST(GpuServingDeviceSelector, Basic) {
   EXPECT_EQ(reservation.device_index(), 0);
 }
 
+TEST(GpuServingDeviceSelector, MinCompletionTime) {
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<MinCompletionTimePolicy>());
+
+  // Without recorded execution times, the programs are balanced.
+  const std::string program_fingerprint = "TensorFlow";
+  DeviceReservation reservation = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(reservation.device_index(), 0);
+  DeviceReservation other_reservation =
+      selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(other_reservation.device_index(), 1);
+
+  // Once the program ran on device 1, it is predicted to finish there first.
+  absl::SleepFor(absl::Milliseconds(1));
+  other_reservation.reset();
+  other_reservation = selector.ReserveDevice(program_fingerprint);
+  EXPECT_EQ(other_reservation.device_index(), 1);
+}
+
+TEST(MinCompletionTimePolicy, SelectDevice) {
+  MinCompletionTimePolicy policy;
+  ServingDeviceSelector::DeviceState device_states[2];
+  device_states[0].program_execution_time_ns["fast"] = 10;
+  device_states[0].program_execution_time_ns["slow"] = 1000;
+  device_states[1].program_execution_time_ns["fast"] = 10;
+  ServingDeviceSelector::DeviceStates states;
+  states.states = device_states;
+
+  // "slow" has its weights resident on device 0 only.
+  EXPECT_EQ(policy.SelectDevice("slow", states), 0);
+  EXPECT_EQ(policy.SelectDevice("fast", states), 0);
+  device_states[0].scheduled_programs.push_back({"fast"});
+  EXPECT_EQ(policy.SelectDevice("slow", states), 0);
+  EXPECT_EQ(policy.SelectDevice("fast", states), 1);
+  device_states[0].scheduled_programs.clear();
+
+  // Device 0 is busy with a slow program, so device 1 finishes first.
+  device_states[0].scheduled_programs.push_back({"slow"});
+  EXPECT_EQ(policy.SelectDevice("fast", states), 1);
+  EXPECT_EQ(policy.SelectDevice("slow", states), 0);
+  device_states[0].scheduled_programs.push_back({"slow"});
+  EXPECT_EQ(policy.SelectDevice("slow", states), 1);
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
@@ -0,0 +1,148 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Buffers smaller than this share its size class.
+constexpr int kMinSizeClass = 12;  // 4KiB
+
+// Ring buffer blocks are multiples of this, so that they stay aligned.
+constexpr size_t kRingAlignment = Allocator::kAllocatorAlignment;
+
+}  // namespace
+
+GpuStagingPool::GpuStagingPool(Allocator* pinned_allocator,
+                               const Options& options)
+    : pinned_allocator_(pinned_allocator),
+      options_(options),
+      free_lists_(64) {}
+
+GpuStagingPool::~GpuStagingPool() {
+  mutex_lock l(mu_);
+  for (auto& free_list : free_lists_) {
+    for (void* ptr : free_list) {
+      pinned_allocator_->DeallocateRaw(ptr);
+    }
+  }
+  if (ring_ != nullptr) {
+    DCHECK(ring_blocks_.empty()) << "Staging buffers are still in use";
+    pinned_allocator_->DeallocateRaw(ring_);
+  }
+}
+
+int GpuStagingPool::SizeClass(size_t num_bytes) {
+  return std::max(kMinSizeClass, Log2Ceiling64(std::max<uint64>(num_bytes, 1)));
+}
+
+void* GpuStagingPool::Allocate(size_t num_bytes) {
+  const int size_class = SizeClass(num_bytes);
+  {
+    mutex_lock l(mu_);
+    if (options_.ring_buffer_bytes > 0 &&
+        num_bytes <= options_.ring_buffer_bytes / 2) {
+      if (ring_ == nullptr && !ring_allocation_failed_) {
+        ring_ = static_cast<char*>(pinned_allocator_->AllocateRaw(
+            Allocator::kAllocatorAlignment, options_.ring_buffer_bytes));
+        if (ring_ == nullptr) {
+          LOG(WARNING) << "Could not allocate a staging ring buffer of "
+                       << options_.ring_buffer_bytes << " bytes";
+          ring_allocation_failed_ = true;
+        }
+      }
+      if (ring_ != nullptr) {
+        void* ptr = AllocateFromRing(num_bytes);
+        if (ptr != nullptr) return ptr;
+      }
+    }
+    std::vector<void*>& free_list = free_lists_[size_class];
+    if (!free_list.empty()) {
+      void* ptr = free_list.back();
+      free_list.pop_back();
+      cached_bytes_ -= ClassBytes(size_class);
+      return ptr;
+    }
+  }
+  return pinned_allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                        ClassBytes(size_class));
+}
+
+void GpuStagingPool::Deallocate(void* ptr, size_t num_bytes) {
+  if (ptr == nullptr) return;
+  const int size_class = SizeClass(num_bytes);
+  {
+    mutex_lock l(mu_);
+    if (DeallocateToRing(ptr)) return;
+    if (cached_bytes_ + ClassBytes(size_class) <= options_.max_cached_bytes) {
+      free_lists_[size_class].push_back(ptr);
+      cached_bytes_ += ClassBytes(size_class);
+      return;
+    }
+  }
+  pinned_allocator_->DeallocateRaw(ptr);
+}
+
+size_t GpuStagingPool::cached_bytes() const {
+  mutex_lock l(mu_);
+  return cached_bytes_;
+}
+
+void* GpuStagingPool::AllocateFromRing(size_t num_bytes) {
+  const uint64 size = options_.ring_buffer_bytes;
+  const uint64 rounded_bytes =
+      (std::max<uint64>(num_bytes, 1) + kRingAlignment - 1) /
+      kRingAlignment * kRingAlignment;
+  uint64 start = ring_end_;
+  if (start % size + rounded_bytes > size) {
+    // Skip to the beginning of the ring buffer.
+    start += size - start % size;
+  }
+  const uint64 end = start + rounded_bytes;
+  if (end - ring_begin_ > size) return nullptr;
+  void* data = ring_ + start % size;
+  ring_blocks_.push_back({data, end, /*freed=*/false});
+  ring_end_ = end;
+  return data;
+}
+
+bool GpuStagingPool::DeallocateToRing(void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (ring_ == nullptr || p < ring_ ||
+      p >= ring_ + options_.ring_buffer_bytes) {
+    return false;
+  }
+  // Buffers are usually released in allocation order, so search from the
+  // oldest one.
+  auto it = std::find_if(ring_blocks_.begin(), ring_blocks_.end(),
+                         [ptr](const RingBlock& block) {
+                           return !block.freed && block.data == ptr;
+                         });
+  CHECK(it != ring_blocks_.end()) << "Unknown staging buffer " << ptr;
+  it->freed = true;
+  while (!ring_blocks_.empty() && ring_blocks_.front().freed) {
+    ring_begin_ = ring_blocks_.front().end;
+    ring_blocks_.pop_front();
+  }
+  return true;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,113 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_POOL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_POOL_H_
+
+#include <deque>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A pool of pinned host buffers, used to stage copies between pageable host
+// memory and a GPU so that the copies can be asynchronous.
+//
+// Buffers are rounded up to a power-of-two size class, and freed buffers are
+// kept on per-class free lists (up to `Options::max_cached_bytes` in total),
+// so that steady-state copies do not allocate from the pinned host allocator.
+//
+// If `Options::ring_buffer_bytes` is positive, buffers of up to half of that
+// size are carved from a ring buffer of pinned memory first. This suits
+// streams of copies whose buffers are released in roughly the order they were
+// allocated, like the inputs of successive steps. When the ring buffer is
+// full, buffers come from the free lists instead.
+//
+// This class is thread-safe.
+class GpuStagingPool {
+ public:
+  struct Options {
+    size_t max_cached_bytes = 64 << 20;
+    size_t ring_buffer_bytes = 0;
+  };
+
+  // Copies are staged in chunks of at most this size, so that copying one
+  // chunk into pinned memory overlaps with the transfer of the previous one.
+  static constexpr size_t kChunkBytes = 4 << 20;
+
+  // `pinned_allocator` is not owned, and must outlive the pool.
+  GpuStagingPool(Allocator* pinned_allocator, const Options& options);
+  ~GpuStagingPool();
+
+  GpuStagingPool(const GpuStagingPool&) = delete;
+  void operator=(const GpuStagingPool&) = delete;
+
+  // Returns a buffer of at least `num_bytes` bytes, or nullptr if no pinned
+  // memory is available.
+  void* Allocate(size_t num_bytes);
+
+  // Returns `ptr`, which must have been returned by `Allocate(num_bytes)`, to
+  // the pool.
+  void Deallocate(void* ptr, size_t num_bytes);
+
+  // The number of bytes held by the free lists.
+  size_t cached_bytes() const;
+
+ private:
+  // Returns the size class of buffers of `num_bytes` bytes, such that
+  // `ClassBytes(SizeClass(num_bytes)) >= num_bytes`.
+  static int SizeClass(size_t num_bytes);
+  static size_t ClassBytes(int size_class) { return size_t{1} << size_class; }
+
+  // Returns nullptr if the ring buffer has no room for `num_bytes` bytes.
+  void* AllocateFromRing(size_t num_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns false if `ptr` is not in the ring buffer.
+  bool DeallocateToRing(void* ptr) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Allocator* const pinned_allocator_;  // Not owned.
+  const Options options_;
+
+  mutable mutex mu_;
+  std::vector<std::vector<void*>> free_lists_ TF_GUARDED_BY(mu_);
+  size_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+
+  // The ring buffer, allocated on first use.
+  char* ring_ TF_GUARDED_BY(mu_) = nullptr;
+  bool ring_allocation_failed_ TF_GUARDED_BY(mu_) = false;
+
+  // A buffer carved from the ring buffer. Positions increase monotonically,
+  // and map to offset `position % ring_buffer_bytes` in the ring buffer. A
+  // block that does not fit before the end of the ring buffer starts at the
+  // beginning, and the bytes it skips belong to it.
+  struct RingBlock {
+    void* data;
+    uint64 end;
+    bool freed;
+  };
+  // The live blocks, in allocation order.
+  std::deque<RingBlock> ring_blocks_ TF_GUARDED_BY(mu_);
+  // The start of the oldest live block, and the end of the newest one.
+  uint64 ring_begin_ TF_GUARDED_BY(mu_) = 0;
+  uint64 ring_end_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_POOL_H_
@@ -0,0 +1,143 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards to the CPU allocator, and counts the calls.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_allocations_ = 0;
+  int num_live_ = 0;
+};
+
+TEST(GpuStagingPoolTest, ReusesBuffersOfTheSameSizeClass) {
+  CountingAllocator pinned;
+  {
+    GpuStagingPool pool(&pinned, GpuStagingPool::Options());
+    void* a = pool.Allocate(5000);
+    ASSERT_NE(nullptr, a);
+    std::memset(a, 1, 5000);
+    pool.Deallocate(a, 5000);
+    EXPECT_EQ(8192, pool.cached_bytes());
+
+    // 6000 bytes round up to the same 8KiB class.
+    void* b = pool.Allocate(6000);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(0, pool.cached_bytes());
+    EXPECT_EQ(1, pinned.num_allocations());
+
+    // A different class allocates.
+    void* c = pool.Allocate(100);
+    EXPECT_NE(nullptr, c);
+    EXPECT_EQ(2, pinned.num_allocations());
+    pool.Deallocate(b, 6000);
+    pool.Deallocate(c, 100);
+  }
+  EXPECT_EQ(0, pinned.num_live());
+}
+
+TEST(GpuStagingPoolTest, LimitsCachedBytes) {
+  CountingAllocator pinned;
+  GpuStagingPool::Options options;
+  options.max_cached_bytes = 16 << 10;
+  GpuStagingPool pool(&pinned, options);
+  void* a = pool.Allocate(16 << 10);
+  void* b = pool.Allocate(16 << 10);
+  pool.Deallocate(a, 16 << 10);
+  pool.Deallocate(b, 16 << 10);
+  EXPECT_EQ(16 << 10, pool.cached_bytes());
+  EXPECT_EQ(1, pinned.num_live());
+}
+
+TEST(GpuStagingPoolTest, CarvesBuffersFromTheRing) {
+  CountingAllocator pinned;
+  GpuStagingPool::Options options;
+  options.ring_buffer_bytes = 1 << 20;
+  {
+    GpuStagingPool pool(&pinned, options);
+    for (int i = 0; i < 100; ++i) {
+      void* a = pool.Allocate(300 << 10);
+      void* b = pool.Allocate(300 << 10);
+      ASSERT_NE(nullptr, a);
+      ASSERT_NE(nullptr, b);
+      std::memset(a, 1, 300 << 10);
+      std::memset(b, 2, 300 << 10);
+      pool.Deallocate(a, 300 << 10);
+      pool.Deallocate(b, 300 << 10);
+    }
+    // Only the ring buffer was allocated.
+    EXPECT_EQ(1, pinned.num_allocations());
+    EXPECT_EQ(0, pool.cached_bytes());
+  }
+  EXPECT_EQ(0, pinned.num_live());
+}
+
+TEST(GpuStagingPoolTest, FallsBackToSizeClassesWhenTheRingIsFull) {
+  CountingAllocator pinned;
+  GpuStagingPool::Options options;
+  options.ring_buffer_bytes = 1 << 20;
+  {
+    GpuStagingPool pool(&pinned, options);
+    void* a = pool.Allocate(400 << 10);
+    void* b = pool.Allocate(400 << 10);
+    // Does not fit in the rest of the ring buffer.
+    void* c = pool.Allocate(400 << 10);
+    EXPECT_EQ(2, pinned.num_allocations());
+    // Larger than half of the ring buffer.
+    void* d = pool.Allocate(600 << 10);
+    EXPECT_EQ(3, pinned.num_allocations());
+
+    // Freeing out of order does not release space until the oldest buffer is
+    // freed.
+    pool.Deallocate(b, 400 << 10);
+    void* e = pool.Allocate(400 << 10);
+    EXPECT_EQ(4, pinned.num_allocations());
+    pool.Deallocate(a, 400 << 10);
+    void* f = pool.Allocate(400 << 10);
+    EXPECT_EQ(4, pinned.num_allocations());
+
+    for (void* ptr : {c, e, f}) pool.Deallocate(ptr, 400 << 10);
+    pool.Deallocate(d, 600 << 10);
+  }
+  EXPECT_EQ(0, pinned.num_live());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,330 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_step_graph.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "xla/stream_executor/gpu/gpu_driver.h"
+#include "xla/stream_executor/gpu/gpu_stream.h"
+#include "xla/stream_executor/gpu/gpu_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#if GOOGLE_CUDA
+#include "xla/stream_executor/cuda/cuda_activation.h"
+#elif TENSORFLOW_USE_ROCM
+#include "tensorflow/core/platform/rocm.h"
+#endif
+
+namespace tensorflow {
+namespace {
+
+#if GOOGLE_CUDA
+using se::cuda::ScopedActivateExecutorContext;
+#elif TENSORFLOW_USE_ROCM
+using se::rocm::ScopedActivateExecutorContext;
+#endif
+
+using se::gpu::AsGpuStreamValue;
+using se::gpu::GpuDriver;
+
+se::DeviceMemoryBase AsDeviceMemory(const Tensor& t) {
+  return se::DeviceMemoryBase(const_cast<char*>(t.tensor_data().data()),
+                              t.TotalBytes());
+}
+
+// Serves the allocations of the recorded step from `base`, and keeps them
+// until the graph is destroyed: the recorded kernels use the same buffers on
+// every launch, so a buffer that the step frees can not be reused by another
+// tensor. Deletes itself once it is released and its last buffer is freed.
+class CaptureAllocator : public Allocator {
+ public:
+  explicit CaptureAllocator(Allocator* base) : base_(base) {}
+
+  std::string Name() override { return base_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& attr) override {
+    void* ptr = base_->AllocateRaw(alignment, num_bytes, attr);
+    if (ptr != nullptr) {
+      mutex_lock l(mu_);
+      ++num_live_;
+    }
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    bool done;
+    {
+      mutex_lock l(mu_);
+      if (!released_) {
+        freed_.push_back(ptr);
+        return;
+      }
+      done = --num_live_ == 0;
+    }
+    base_->DeallocateRaw(ptr);
+    if (done) delete this;
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Frees the buffers that were deallocated so far, and the others as soon as
+  // they are deallocated.
+  void Release() {
+    std::vector<void*> freed;
+    bool done;
+    {
+      mutex_lock l(mu_);
+      released_ = true;
+      freed.swap(freed_);
+      num_live_ -= freed.size();
+      done = num_live_ == 0;
+    }
+    // The buffers may still be in use by the last launch of the graph, but
+    // like all the kernels of the device it runs on the compute stream, which
+    // orders it before the kernels that reuse them.
+    for (void* ptr : freed) base_->DeallocateRaw(ptr);
+    if (done) delete this;
+  }
+
+ private:
+  Allocator* const base_;
+  mutex mu_;
+  int64_t num_live_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+  std::vector<void*> freed_ TF_GUARDED_BY(mu_);
+};
+
+class GpuStepGraph : public StepGraph {
+ public:
+  // Takes ownership of `capture_stream`, and of one reference on
+  // `capture_context`, which must enqueue its kernels to `capture_stream`.
+  GpuStepGraph(se::Stream* compute_stream,
+               std::unique_ptr<se::Stream> capture_stream,
+               GPUDeviceContext* capture_context, Allocator* allocator)
+      : compute_stream_(compute_stream),
+        capture_stream_(std::move(capture_stream)),
+        capture_context_(capture_context),
+        allocator_(allocator),
+        capture_allocator_(new CaptureAllocator(allocator)) {}
+
+  ~GpuStepGraph() override {
+    {
+      ScopedActivateExecutorContext scoped_activation{
+          compute_stream_->parent()};
+      if (exec_ != nullptr) {
+        // An executable graph that is still running is freed when it ends.
+        GpuDriver::DestroyGraphExec(exec_).IgnoreError();
+      }
+    }
+    args_.clear();
+    retvals_.clear();
+    capture_allocator_->Release();
+    capture_context_->Unref();
+  }
+
+  DeviceContext* device_context() override { return capture_context_; }
+  Allocator* allocator() override { return capture_allocator_; }
+
+  Status BeginCapture(const std::vector<Tensor>& args,
+                      std::vector<Tensor>* captured_args) override {
+    mutex_lock l(mu_);
+    args_.clear();
+    args_.reserve(args.size());
+    for (const Tensor& arg : args) {
+      if (!DataTypeCanUseMemcpy(arg.dtype())) {
+        return errors::Unimplemented("Can not record a step with a ",
+                                     DataTypeString(arg.dtype()), " arg.");
+      }
+      Tensor captured(capture_allocator_, arg.dtype(), arg.shape());
+      if (!captured.IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate the args of a step graph.");
+      }
+      args_.push_back(std::move(captured));
+    }
+    TF_RETURN_IF_ERROR(CopyArgs(args));
+    *captured_args = args_;
+
+    // Kernels that are launched from other threads while the step is
+    // recorded, or that allocate from the driver, must not invalidate the
+    // recording, hence the relaxed mode.
+    ScopedActivateExecutorContext scoped_activation{compute_stream_->parent()};
+    return GpuDriver::StreamBeginCapture(
+        AsGpuStreamValue(capture_stream_.get()),
+        GpuDriver::StreamCaptureMode::kRelaxed);
+  }
+
+  Status EndCapture(const Status& step_status,
+                    const std::vector<Tensor>& retvals,
+                    std::vector<Tensor>* outputs) override {
+    mutex_lock l(mu_);
+    se::gpu::GpuGraphHandle graph = nullptr;
+    {
+      ScopedActivateExecutorContext scoped_activation{
+          compute_stream_->parent()};
+      // The recording must end whatever the status of the step.
+      Status status = GpuDriver::StreamEndCapture(
+          AsGpuStreamValue(capture_stream_.get()), &graph);
+      if (status.ok() && step_status.ok() && capture_stream_->ok()) {
+        status = GpuDriver::GraphInstantiate(
+            &exec_, graph, GpuDriver::GraphInstantiateFlags());
+      }
+      if (graph != nullptr) GpuDriver::DestroyGraph(graph).IgnoreError();
+      TF_RETURN_IF_ERROR(step_status);
+      TF_RETURN_IF_ERROR(status);
+      if (!capture_stream_->ok()) {
+        return errors::Internal("Failed to record a step graph.");
+      }
+    }
+    for (const Tensor& retval : retvals) {
+      if (!retval.IsInitialized() || !DataTypeCanUseMemcpy(retval.dtype())) {
+        return errors::Unimplemented(
+            "Can not record a step with a return value that is not a "
+            "buffer.");
+      }
+    }
+    retvals_ = retvals;
+    return LaunchLocked(outputs);
+  }
+
+  Status Launch(const std::vector<Tensor>& args,
+                std::vector<Tensor>* outputs) override {
+    mutex_lock l(mu_);
+    if (exec_ == nullptr) {
+      return errors::FailedPrecondition("The step graph was not recorded.");
+    }
+    if (args.size() != args_.size()) {
+      return errors::InvalidArgument("Expected ", args_.size(),
+                                     " args for the step graph, but got ",
+                                     args.size());
+    }
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (args[i].dtype() != args_[i].dtype() ||
+          args[i].shape() != args_[i].shape()) {
+        return errors::InvalidArgument(
+            "Arg ", i, " of the step graph must be a ",
+            DataTypeString(args_[i].dtype()), " tensor of shape ",
+            args_[i].shape().DebugString(), ", but got a ",
+            DataTypeString(args[i].dtype()), " tensor of shape ",
+            args[i].shape().DebugString());
+      }
+    }
+    TF_RETURN_IF_ERROR(CopyArgs(args));
+    return LaunchLocked(outputs);
+  }
+
+ private:
+  // Enqueues copies of `args` into `args_` to the compute stream.
+  Status CopyArgs(const std::vector<Tensor>& args)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    for (size_t i = 0; i < args.size(); ++i) {
+      if (args[i].TotalBytes() == 0) continue;
+      se::DeviceMemoryBase dst = AsDeviceMemory(args_[i]);
+      compute_stream_->ThenMemcpy(&dst, AsDeviceMemory(args[i]),
+                                  args[i].TotalBytes());
+    }
+    return compute_stream_->ok()
+               ? OkStatus()
+               : errors::Internal("Failed to copy the args of a step graph.");
+  }
+
+  // Enqueues a launch of the graph to the compute stream, followed by copies
+  // of `retvals_` into new `*outputs`.
+  Status LaunchLocked(std::vector<Tensor>* outputs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    {
+      ScopedActivateExecutorContext scoped_activation{
+          compute_stream_->parent()};
+      TF_RETURN_IF_ERROR(
+          GpuDriver::GraphLaunch(exec_, AsGpuStreamValue(compute_stream_)));
+    }
+    outputs->resize(retvals_.size());
+    for (size_t i = 0; i < retvals_.size(); ++i) {
+      const Tensor& retval = retvals_[i];
+      Tensor output(allocator_, retval.dtype(), retval.shape());
+      if (!output.IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate the outputs of a step graph.");
+      }
+      if (retval.TotalBytes() > 0) {
+        se::DeviceMemoryBase dst = AsDeviceMemory(output);
+        compute_stream_->ThenMemcpy(&dst, AsDeviceMemory(retval),
+                                    retval.TotalBytes());
+      }
+      (*outputs)[i] = std::move(output);
+    }
+    return compute_stream_->ok()
+               ? OkStatus()
+               : errors::Internal("Failed to launch a step graph.");
+  }
+
+  se::Stream* const compute_stream_;
+  std::unique_ptr<se::Stream> capture_stream_;
+  GPUDeviceContext* const capture_context_;
+  Allocator* const allocator_;
+  CaptureAllocator* const capture_allocator_;  // Deletes itself.
+
+  mutex mu_;
+  // The buffers that the recorded step reads its args from, and those of its
+  // return values.
+  std::vector<Tensor> args_ TF_GUARDED_BY(mu_);
+  std::vector<Tensor> retvals_ TF_GUARDED_BY(mu_);
+  se::gpu::GpuGraphExecHandle exec_ TF_GUARDED_BY(mu_) = nullptr;
+};
+
+}  // namespace
+
+Status CreateGpuStepGraph(const GPUDeviceContext& device_context,
+                          Allocator* allocator,
+                          std::unique_ptr<StepGraph>* graph) {
+  se::Stream* compute_stream = device_context.stream();
+  auto capture_stream = std::make_unique<se::Stream>(compute_stream->parent());
+  capture_stream->Init();
+  if (!capture_stream->ok()) {
+    return errors::Internal("Failed to create the stream of a step graph.");
+  }
+  auto* capture_context = new GPUDeviceContext(
+      device_context.stream_id(), capture_stream.get(),
+#if TENSORFLOW_USE_ROCM
+      device_context.nccl_stream(),
+#endif
+      device_context.host_to_device_stream(),
+      device_context.device_to_host_stream(),
+      device_context.device_to_device_streams(),
+      device_context.host_memory_allocator(), device_context.staging_pool());
+  *graph = std::make_unique<GpuStepGraph>(
+      compute_stream, std::move(capture_stream), capture_context, allocator);
+  return OkStatus();
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,44 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STEP_GRAPH_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STEP_GRAPH_H_
+
+#include <memory>
+
+#include "tensorflow/core/common_runtime/gpu_device_context.h"
+#include "tensorflow/core/common_runtime/step_graph.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor.h"
+
+namespace tensorflow {
+
+// Sets `*graph` to a StepGraph that records the kernels of a step on a GPU
+// into a CUDA (or HIP) graph, and launches that graph on the compute stream of
+// `device_context`.
+//
+// The step is recorded on a stream of its own, so that the kernels that other
+// steps enqueue to the compute stream meanwhile are not recorded with it. Its
+// device context otherwise uses the copy streams of `device_context`. The
+// buffers of the graph, and the outputs of its launches, are allocated from
+// `allocator`. `device_context` and `allocator` must outlive the graph.
+Status CreateGpuStepGraph(const GPUDeviceContext& device_context,
+                          Allocator* allocator,
+                          std::unique_ptr<StepGraph>* graph);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STEP_GRAPH_H_
@@ -16,13 +16,16 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_pool.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -31,9 +34,11 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/tensor_coding.h"
@@ -270,6 +275,62 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+std::atomic<int64_t> host_to_device_copy_count{0};
+std::atomic<int64_t> host_to_device_copy_bytes{0};
+
+// Enqueues a copy of `num_bytes` bytes from `src` to `dst` on `stream`.
+void EnqueueHostToDeviceCopy(se::Stream* stream, const void* src, void* dst,
+                             int64_t num_bytes) {
+  DeviceMemoryBase gpu_dst_ptr(dst, num_bytes);
+  stream->ThenMemcpy(&gpu_dst_ptr, src, num_bytes);
+  host_to_device_copy_count.fetch_add(1, std::memory_order_relaxed);
+  host_to_device_copy_bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+// A pinned buffer from a GpuStagingPool.
+struct StagingChunk {
+  void* data;
+  size_t num_bytes;
+};
+
+// Enqueues copies of up to `total_bytes` bytes from `src` to `dst` on
+// `stream`, staged through chunks of `pool`, and returns the number of bytes
+// copied. Each chunk is filled right after the copy of the previous one has
+// been enqueued, so the host memcpy overlaps with the previous transfer.
+// Stops early if the pool runs out of memory.
+int64_t StageHostToDeviceCopy(GpuStagingPool* pool, se::Stream* stream,
+                              const char* src, char* dst, int64_t total_bytes,
+                              std::vector<StagingChunk>* chunks) {
+  int64_t offset = 0;
+  while (offset < total_bytes) {
+    const size_t num_bytes =
+        std::min<int64_t>(GpuStagingPool::kChunkBytes, total_bytes - offset);
+    void* chunk = pool->Allocate(num_bytes);
+    if (chunk == nullptr) break;
+    std::memcpy(chunk, src + offset, num_bytes);
+    EnqueueHostToDeviceCopy(stream, chunk, dst + offset, num_bytes);
+    chunks->push_back({chunk, num_bytes});
+    offset += num_bytes;
+  }
+  return offset;
+}
+
+void ReleaseStagingChunks(GpuStagingPool* pool,
+                          const std::vector<StagingChunk>& chunks) {
+  for (const StagingChunk& chunk : chunks) {
+    pool->Deallocate(chunk.data, chunk.num_bytes);
+  }
+}
+
+// Runs the copies out of pinned staging chunks into pageable memory. EventMgr
+// callbacks must not take long, and a large copy-out would delay the callbacks
+// of the other work on the device.
+thread::ThreadPool* StagingCopyOutThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "gpu_staging_copy_out", /*num_threads=*/2);
+  return thread_pool;
+}
+
 }  // namespace
 
 // static
@@ -297,23 +358,59 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   // Wait for the sender's main stream to make sure the data are available.
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
+  GpuStagingPool* staging_pool =
+      static_cast<const GPUDeviceContext*>(device_context)->staging_pool();
+  std::vector<StagingChunk> chunks;
+  char* dst_ptr = static_cast<char*>(GetBase(cpu_tensor));
   const int64_t total_bytes = gpu_tensor->TotalBytes();
   if (total_bytes > 0) {
-    void* src_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
-    void* dst_ptr = GetBase(cpu_tensor);
-    send_device_to_host_stream->ThenMemcpy(dst_ptr, gpu_src_ptr, total_bytes);
+    char* src_ptr = static_cast<char*>(GetBase(gpu_tensor));
+    int64_t offset = 0;
+    if (staging_pool != nullptr && NeedStaging(cpu_tensor)) {
+      // Copy into pinned chunks, which are copied to the destination once the
+      // transfers are done. If the pool runs out of memory, the rest is
+      // copied directly to the destination.
+      while (offset < total_bytes) {
+        const size_t num_bytes = std::min<int64_t>(GpuStagingPool::kChunkBytes,
+                                                   total_bytes - offset);
+        void* chunk = staging_pool->Allocate(num_bytes);
+        if (chunk == nullptr) break;
+        DeviceMemoryBase gpu_src_ptr(src_ptr + offset, num_bytes);
+        send_device_to_host_stream->ThenMemcpy(chunk, gpu_src_ptr, num_bytes);
+        chunks.push_back({chunk, num_bytes});
+        offset += num_bytes;
+      }
+    }
+    if (offset < total_bytes) {
+      DeviceMemoryBase gpu_src_ptr(src_ptr + offset, total_bytes - offset);
+      send_device_to_host_stream->ThenMemcpy(dst_ptr + offset, gpu_src_ptr,
+                                             total_bytes - offset);
+    }
   }
   // Use of the input may outlive stack scope, so keep a ref.
   TensorReference input_ref(*gpu_tensor);
   dev_info->event_mgr->ThenExecute(
       send_device_to_host_stream,
-      [send_device_to_host_stream, done, input_ref]() {
+      [send_device_to_host_stream, done, input_ref, staging_pool,
+       chunks = std::move(chunks), dst_ptr]() mutable {
         if (!send_device_to_host_stream->ok()) {
           LOG(FATAL) << "GPU->CPU Memcpy failed";
         }
         input_ref.Unref();
-        done(OkStatus());
+        if (chunks.empty()) {
+          done(OkStatus());
+          return;
+        }
+        StagingCopyOutThreadPool()->Schedule(
+            [done, staging_pool, chunks = std::move(chunks), dst_ptr]() {
+              size_t offset = 0;
+              for (const StagingChunk& chunk : chunks) {
+                std::memcpy(dst_ptr + offset, chunk.data, chunk.num_bytes);
+                offset += chunk.num_bytes;
+              }
+              ReleaseStagingChunks(staging_pool, chunks);
+              done(OkStatus());
+            });
       });
 }
 
@@ -349,6 +446,9 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   bool do_staging = false;
   void* staging_buffer = nullptr;
   Allocator* host_memory_allocator = device_context->host_memory_allocator();
+  GpuStagingPool* staging_pool =
+      static_cast<const GPUDeviceContext*>(device_context)->staging_pool();
+  std::vector<StagingChunk> chunks;
 
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
@@ -357,9 +457,12 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
   if (total_bytes > 0) {
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
 
-    if (NeedStaging(cpu_tensor)) {
+    // Pageable memory is staged through the pool if there is one, else
+    // through a single pinned buffer.
+    const bool use_staging_pool =
+        NeedStaging(cpu_tensor) && staging_pool != nullptr;
+    if (NeedStaging(cpu_tensor) && !use_staging_pool) {
       if (host_memory_allocator == nullptr) {
         LOG_FIRST_N(WARNING, 1)
             << "No host memory allocator is available to "
@@ -369,29 +472,43 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       }
     }
 
-    if (do_staging) {
+    if (use_staging_pool) {
+      const int64_t staged_bytes = StageHostToDeviceCopy(
+          staging_pool, recv_host_to_device_stream,
+          static_cast<const char*>(src_ptr), static_cast<char*>(dst_ptr),
+          total_bytes, &chunks);
+      if (staged_bytes < total_bytes) {
+        // Out of pinned memory; copy the rest directly, from the input.
+        EnqueueHostToDeviceCopy(
+            recv_host_to_device_stream,
+            static_cast<const char*>(src_ptr) + staged_bytes,
+            static_cast<char*>(dst_ptr) + staged_bytes,
+            total_bytes - staged_bytes);
+      }
+    } else if (do_staging) {
       staging_buffer = host_memory_allocator->AllocateRaw(
           tensorflow::Allocator::kAllocatorAlignment, total_bytes);
       std::memcpy(staging_buffer, src_ptr, total_bytes);
       input_ref.Unref();
 
-      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, staging_buffer,
-                                             total_bytes);
+      EnqueueHostToDeviceCopy(recv_host_to_device_stream, staging_buffer,
+                              dst_ptr, total_bytes);
     } else {
-      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
-                                             total_bytes);
+      EnqueueHostToDeviceCopy(recv_host_to_device_stream, src_ptr, dst_ptr,
+                              total_bytes);
     }
   }
 
   dev_info->event_mgr->ThenExecute(
       recv_host_to_device_stream,
       [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
-       host_memory_allocator]() {
+       host_memory_allocator, staging_pool, chunks = std::move(chunks)]() {
         if (do_staging) {
           host_memory_allocator->DeallocateRaw(staging_buffer);
         } else {
           input_ref.Unref();
         }
+        if (!chunks.empty()) ReleaseStagingChunks(staging_pool, chunks);
         if (!recv_host_to_device_stream->ok()) {
           LOG(FATAL) << "CPU->GPU Memcpy failed";
         }
@@ -399,6 +516,16 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       });
 }
 
+// static
+int64_t GPUUtil::GetHostToDeviceCopyCountTestOnly() {
+  return host_to_device_copy_count.load(std::memory_order_relaxed);
+}
+
+// static
+int64_t GPUUtil::GetHostToDeviceCopyBytesTestOnly() {
+  return host_to_device_copy_bytes.load(std::memory_order_relaxed);
+}
+
 Status GPUUtil::Sync(Device* gpu_device) {
   VLOG(1) << "GPUUtil::Sync";
   auto* dev_info = gpu_device->tensorflow_accelerator_device_info();
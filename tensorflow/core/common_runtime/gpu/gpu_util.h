@@ -90,6 +90,11 @@ class GPUUtil {
                                  Device* gpu_device, Tensor* gpu_tensor,
                                  StatusCallback done, bool sync_dst_compute);
 
+  // The number of host-to-device copies enqueued by CopyCPUTensorToGPU, and
+  // their total size, since the start of the process. For testing only.
+  static int64_t GetHostToDeviceCopyCountTestOnly();
+  static int64_t GetHostToDeviceCopyBytesTestOnly();
+
   static void DeviceToDeviceCopy(
       DeviceContext* send_dev_context, DeviceContext* recv_dev_context,
       Device* src, Device* dst, AllocatorAttributes src_alloc_attr,
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
 #include "absl/strings/str_format.h"
 #include "xla/stream_executor/stream_executor.h"
 #include "tsl/platform/numbers.h"
@@ -63,7 +68,8 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+    bool allow_decommit) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Create");
 
   std::vector<GpuDeviceHandle> access_gpu_handles;
@@ -107,7 +113,7 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity, allow_decommit));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -115,16 +121,18 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool allow_decommit)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      allow_decommit_(allow_decommit) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
+    if (!mapping.committed) continue;
     GpuDriver::UnmapMemory(&gpu_context_, mapping.va, mapping.physical.bytes);
     GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(mapping.physical));
   }
@@ -151,25 +159,31 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
-  }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
-    return nullptr;
+  // Create the physical memory backing the allocation, and map VAs for it.
+  // Pages that may be decommitted need their own physical memory.
+  const size_t mapping_bytes = allow_decommit_ ? granularity_ : padded_bytes;
+  std::vector<Mapping> new_mappings;
+  size_t mapped_bytes = 0;
+  while (mapped_bytes < padded_bytes) {
+    GpuDevicePtr va = next_va + mapped_bytes;
+    auto maybe_handle = CreateAndMap(va, mapping_bytes);
+    if (!maybe_handle.ok()) {
+      LOG(ERROR) << maybe_handle.status();
+      for (auto& mapping : new_mappings) {
+        GpuDriver::UnmapMemory(&gpu_context_, mapping.va,
+                               mapping.physical.bytes);
+        GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                       std::move(mapping.physical));
+      }
+      return nullptr;
+    }
+    mapped_bytes += maybe_handle->bytes;
+    new_mappings.push_back({va, std::move(maybe_handle).value()});
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  next_alloc_offset_ += mapped_bytes;
+  mappings_.insert(mappings_.end(),
+                   std::make_move_iterator(new_mappings.begin()),
+                   std::make_move_iterator(new_mappings.end()));
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
@@ -193,7 +207,7 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   }
 
   int num_mappings_to_free = 0;
-  int total_bytes = 0;
+  size_t total_bytes = 0;
   for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
        ++it) {
     ++num_mappings_to_free;
@@ -211,6 +225,7 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   VLOG(1) << "Freeing " << num_mappings_to_free << " mappings for a total of "
           << total_bytes << " bytes";
   for (auto it = mapping_it; it < mapping_it + num_mappings_to_free; ++it) {
+    if (!it->committed) continue;
     GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
     GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
   }
@@ -224,6 +239,105 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   VisitFree(ptr, gpu_id_.value(), num_bytes);
 }
 
+size_t GpuVirtualMemAllocator::Decommit(void* ptr, size_t num_bytes) {
+  tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Decommit");
+
+  if (!allow_decommit_) return 0;
+  const GpuDevicePtr begin =
+      AlignUp(reinterpret_cast<GpuDevicePtr>(ptr), granularity_);
+  const GpuDevicePtr end =
+      (reinterpret_cast<GpuDevicePtr>(ptr) + num_bytes) & ~(granularity_ - 1);
+  if (begin >= end) return 0;
+
+  bool synchronized = false;
+  size_t decommitted_bytes = 0;
+  for (auto it = FirstMappingEndingAfter(reinterpret_cast<void*>(begin));
+       it != mappings_.end() && it->va < end; ++it) {
+    if (!it->committed || it->va < begin ||
+        it->va + it->physical.bytes > end) {
+      continue;
+    }
+    if (!synchronized) {
+      if (!GpuDriver::SynchronizeContext(&gpu_context_)) {
+        LOG(ERROR) << "Could not synchronize GPU " << gpu_id_.value()
+                   << " before decommitting memory.";
+        break;
+      }
+      synchronized = true;
+    }
+    GpuDriver::UnmapMemory(&gpu_context_, it->va, it->physical.bytes);
+    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(it->physical));
+    it->committed = false;
+    decommitted_bytes += it->physical.bytes;
+  }
+  VLOG(1) << "Decommitted " << decommitted_bytes << " bytes at " << ptr;
+  return decommitted_bytes;
+}
+
+size_t GpuVirtualMemAllocator::DecommittedBytes(const void* ptr,
+                                                size_t num_bytes) const {
+  const GpuDevicePtr end = reinterpret_cast<GpuDevicePtr>(ptr) + num_bytes;
+  size_t decommitted_bytes = 0;
+  for (auto it = FirstMappingEndingAfter(ptr);
+       it != mappings_.end() && it->va < end; ++it) {
+    if (!it->committed) decommitted_bytes += it->physical.bytes;
+  }
+  return decommitted_bytes;
+}
+
+bool GpuVirtualMemAllocator::Commit(void* ptr, size_t num_bytes,
+                                    size_t* bytes_committed) {
+  tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Commit");
+
+  const GpuDevicePtr end = reinterpret_cast<GpuDevicePtr>(ptr) + num_bytes;
+  for (auto it = FirstMappingEndingAfter(ptr);
+       it != mappings_.end() && it->va < end; ++it) {
+    if (it->committed) continue;
+    auto maybe_handle = CreateAndMap(it->va, it->physical.bytes);
+    if (!maybe_handle.ok()) {
+      LOG(ERROR) << maybe_handle.status();
+      return false;
+    }
+    it->physical = std::move(maybe_handle).value();
+    it->committed = true;
+    *bytes_committed += it->physical.bytes;
+  }
+  return true;
+}
+
+StatusOr<GpuDriver::GenericMemoryHandle> GpuVirtualMemAllocator::CreateAndMap(
+    GpuDevicePtr va, size_t num_bytes) {
+  TF_ASSIGN_OR_RETURN(GpuDriver::GenericMemoryHandle handle,
+                      GpuDriver::CreateMemoryHandle(&gpu_context_, num_bytes));
+  Status status =
+      GpuDriver::MapMemory(&gpu_context_, va, handle, access_gpu_handles_);
+  if (!status.ok()) {
+    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+    return status;
+  }
+  return handle;
+}
+
+std::vector<GpuVirtualMemAllocator::Mapping>::iterator
+GpuVirtualMemAllocator::FirstMappingEndingAfter(const void* ptr) {
+  return std::lower_bound(
+      mappings_.begin(), mappings_.end(), ptr,
+      [](const Mapping& mapping, const void* ptr) {
+        return reinterpret_cast<const void*>(mapping.va +
+                                             mapping.physical.bytes) <= ptr;
+      });
+}
+
+std::vector<GpuVirtualMemAllocator::Mapping>::const_iterator
+GpuVirtualMemAllocator::FirstMappingEndingAfter(const void* ptr) const {
+  return std::lower_bound(
+      mappings_.begin(), mappings_.end(), ptr,
+      [](const Mapping& mapping, const void* ptr) {
+        return reinterpret_cast<const void*>(mapping.va +
+                                             mapping.physical.bytes) <= ptr;
+      });
+}
+
 }  // namespace tensorflow
 
 #endif
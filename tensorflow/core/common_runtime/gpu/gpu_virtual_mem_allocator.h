@@ -39,6 +39,14 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// If `allow_decommit` is true, every page of the minimum allocation
+// granularity is backed by its own physical allocation, so that the owning
+// BFCAllocator can unmap the pages under its free chunks and release them to
+// the driver (see BFCAllocator::DecommitFreeMemory()). Physical memory that is
+// stranded in fragmented free chunks can then back a new, contiguous region at
+// the end of the virtual address range, without copying any data. Decommitted
+// pages are mapped again when they are allocated.
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public tsl::SubAllocator {
  public:
@@ -47,7 +55,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       const std::vector<Visitor>& free_visitors,
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+      const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+      bool allow_decommit = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -71,6 +80,17 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
 
   bool SupportsCoalescing() const override { return true; }
 
+  bool SupportsDecommit() const override { return allow_decommit_; }
+
+  // Waits for all work on the GPU to complete, since it may still access the
+  // memory of chunks that were freed, and then unmaps and releases the pages
+  // that lie entirely within [ptr, ptr + num_bytes).
+  size_t Decommit(void* ptr, size_t num_bytes) override;
+
+  size_t DecommittedBytes(const void* ptr, size_t num_bytes) const override;
+
+  bool Commit(void* ptr, size_t num_bytes, size_t* bytes_committed) override;
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -78,7 +98,12 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool allow_decommit);
+
+  // Creates physical memory of `num_bytes` bytes and maps it at `va`.
+  tsl::StatusOr<stream_executor::gpu::GpuDriver::GenericMemoryHandle>
+  CreateAndMap(stream_executor::gpu::GpuDevicePtr va, size_t num_bytes);
 
   stream_executor::gpu::GpuContext& gpu_context_;
   tsl::PlatformDeviceId gpu_id_;
@@ -99,13 +124,23 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  const bool allow_decommit_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
+    // If `committed` is false, the physical memory of the mapping has been
+    // released by Decommit(), and only `physical.bytes` is valid.
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
+    bool committed = true;
   };
   // List of mappings, sorted by va.
   std::vector<Mapping> mappings_;
 
+  // Returns the first mapping that ends after `ptr`.
+  std::vector<Mapping>::iterator FirstMappingEndingAfter(const void* ptr);
+  std::vector<Mapping>::const_iterator FirstMappingEndingAfter(
+      const void* ptr) const;
+
   GpuVirtualMemAllocator(const GpuVirtualMemAllocator&) = delete;
   void operator=(const GpuVirtualMemAllocator&) = delete;
 };
@@ -34,7 +34,8 @@ using ::stream_executor::gpu::GpuDriver;
 constexpr size_t k2MiB{2 << 20};
 
 // Creates an allocator with 8 MiB of virtual address space.
-std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
+std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator(
+    bool allow_decommit = false) {
   tsl::PlatformDeviceId gpu_id(0);
   auto executor = se::DeviceIdUtil::ExecutorForPlatformDeviceId(
                       se::GPUMachineManager(), gpu_id)
@@ -43,7 +44,7 @@ std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
       executor->platform_specific_handle().context);
   return GpuVirtualMemAllocator::Create(
              {}, {}, *gpu_context, gpu_id,
-             /*virtual_address_space_size=*/4 * k2MiB, {})
+             /*virtual_address_space_size=*/4 * k2MiB, {}, allow_decommit)
       .value();
 }
 
@@ -179,6 +180,32 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, DecommitAndCommit) {
+  auto allocator = CreateAllocator(/*allow_decommit=*/true);
+  ASSERT_TRUE(allocator->SupportsDecommit());
+  size_t bytes_received;  // Ignored in this test.
+  char* alloc = static_cast<char*>(allocator->Alloc(
+      /*alignment=*/0, /*num_bytes=*/3 * k2MiB, &bytes_received));
+  ASSERT_NE(alloc, nullptr);
+
+  // Only the second page lies entirely within the range.
+  EXPECT_EQ(k2MiB, allocator->Decommit(alloc + 256, 2 * k2MiB));
+  EXPECT_EQ(k2MiB, allocator->DecommittedBytes(alloc, 3 * k2MiB));
+  EXPECT_EQ(0, allocator->DecommittedBytes(alloc, k2MiB));
+
+  size_t bytes_committed = 0;
+  ASSERT_TRUE(allocator->Commit(alloc + k2MiB + 256, 256, &bytes_committed));
+  EXPECT_EQ(k2MiB, bytes_committed);
+  EXPECT_EQ(0, allocator->DecommittedBytes(alloc, 3 * k2MiB));
+
+  // A range with decommitted pages can be freed.
+  EXPECT_EQ(k2MiB, allocator->Decommit(alloc + 2 * k2MiB, k2MiB));
+  allocator->Free(alloc, 3 * k2MiB);
+  void* re_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  EXPECT_EQ(re_alloc, alloc);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
@@ -53,6 +53,8 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -107,7 +109,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -161,6 +164,10 @@ class GraphConstructor {
     // value to the Node when they are missing from the NodeDef.
     bool add_default_attributes = true;
 
+    // If not null, the nodes are prepared in parallel on this thread pool.
+    // Only used when `importing` is false.
+    thread::ThreadPool* thread_pool = nullptr;
+
     string default_device;
   };
 
@@ -223,6 +230,17 @@ class GraphConstructor {
   Status BuildNodeIndex();
   Status InitFromEdges();
   Status Convert();
+  // A NodeDef consumed by PrepareNodes(): the properties of its node, or the
+  // NodeDef itself if preparing it failed, for Convert() to report the error
+  // after those about its inputs, as if the node wasn't prepared.
+  struct PreparedNode {
+    std::shared_ptr<NodeProperties> props;
+    NodeDef node_def;
+  };
+  // Runs the per-node work of Convert() that does not depend on other nodes
+  // (completing, validating and type-checking the NodeDefs) for all nodes in
+  // parallel on `opts_.thread_pool`, consuming their NodeDefs.
+  std::vector<PreparedNode> PrepareNodes();
   Status AddBackEdges();
   Status UpdateVersionDef();
   Status PopulateReturnTensors();
@@ -244,6 +262,7 @@ class GraphConstructor {
   Status IsNodeFullyMapped(const NodeDef& node_def, bool* is_node_mapped);
   Status ValidateColocationConstraints(const NodeDef& node_def);
   Status MakeNode(NodeDef&& node_def, Node** node);
+  Status MakeNode(std::shared_ptr<NodeProperties> props, Node** node);
   Status MakeEdge(Node* src, int output_index, Node* dst, int input_index);
   Status ValidateShape(Node* node);
   Status ModifyNodeDefForImport(NodeDef* node_def);
@@ -298,7 +317,7 @@ class GraphConstructor {
   virtual const NodeDef& get_node_def(int i) const = 0;
   // Destructively reads the i^th node in the graph, avoiding a copy if
   // possible. After calling this method, the result of get_node_def(i) is
-  // undefined.
+  // undefined. May be called concurrently for distinct nodes.
   virtual NodeDef consume_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
@@ -463,7 +482,7 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
       : GraphConstructor(opts, g, refiner, return_tensors, return_nodes,
                          missing_unused_input_map_keys),
         graph_def_(std::move(graph_def)),
-        is_consumed_(graph_def_.node_size(), false) {}
+        is_consumed_(new bool[graph_def_.node_size()]()) {}
 
  private:
   size_t node_def_count() const override { return graph_def_.node().size(); }
@@ -486,7 +505,8 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
 
   GraphDef graph_def_;
-  std::vector<bool> is_consumed_;
+  // Not a std::vector<bool>, whose elements can't be written concurrently.
+  std::unique_ptr<bool[]> is_consumed_;
 };
 
 bool ForwardCompatibilityWindowPassed(const VersionDef& versions) {
@@ -814,6 +834,16 @@ Status GraphConstructor::MakeNode(NodeDef&& node_def, Node** node) {
   return OkStatus();
 }
 
+Status GraphConstructor::MakeNode(std::shared_ptr<NodeProperties> props,
+                                  Node** node) {
+  TF_ASSIGN_OR_RETURN(*node, g_->AddNode(std::move(props)));
+  if (opts_.expect_device_spec ||
+      (opts_.propagate_device_spec && !(*node)->def().device().empty())) {
+    (*node)->set_assigned_device_name((*node)->def().device());
+  }
+  return OkStatus();
+}
+
 Status GraphConstructor::ValidateShape(Node* node) {
   if (!opts_.importing || !opts_.validate_shape) return OkStatus();
   TF_RETURN_IF_ERROR(refiner_->AddNode(node));
@@ -1185,6 +1215,13 @@ Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The nodes are prepared after importing the functions, which they may
+  // refer to.
+  std::vector<PreparedNode> prepared_nodes;
+  if (opts_.thread_pool != nullptr && !opts_.importing) {
+    prepared_nodes = PrepareNodes();
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1201,7 +1238,16 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    // A prepared node's NodeDef is only read below, and is not modified.
+    std::shared_ptr<NodeProperties> props;
+    NodeDef consumed_node_def;
+    if (!prepared_nodes.empty()) {
+      props = std::move(prepared_nodes[o].props);
+      consumed_node_def = std::move(prepared_nodes[o].node_def);
+    } else {
+      consumed_node_def = consume_node_def(o);
+    }
+    NodeDef& node_def = props != nullptr ? props->node_def : consumed_node_def;
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1297,7 +1343,7 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
+    } else if (props == nullptr) {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
           g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
@@ -1309,7 +1355,11 @@ Status GraphConstructor::Convert() {
       }
     }
 
-    TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    if (props != nullptr) {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(props), &node));
+    } else {
+      TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
+    }
 
     if (node != nullptr) {
       if (traces_.contains(node_name)) {
@@ -1352,7 +1402,13 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        // The NodeDefs of the prepared nodes are consumed.
+        const NodeDef& node_def =
+            prepared_nodes.empty() ? get_node_def(i)
+            : prepared_nodes[i].props != nullptr
+                ? prepared_nodes[i].props->node_def
+                : prepared_nodes[i].node_def;
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(node_def)
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
@@ -1480,6 +1536,36 @@ Status GraphConstructor::PopulateMissingUnusedInputMapKeys() {
   return OkStatus();
 }
 
+std::vector<GraphConstructor::PreparedNode> GraphConstructor::PrepareNodes() {
+  std::vector<PreparedNode> prepared(node_def_count());
+  auto prepare = [this](int i, PreparedNode* prepared) {
+    // Moved from the GraphDef when possible. The work below is redone by
+    // Convert() if it fails, so that the same error is returned.
+    prepared->node_def = consume_node_def(i);
+    NodeDef& node_def = prepared->node_def;
+    const OpDef* op_def;
+    if (!g_->op_registry()->LookUpOpDef(node_def.op(), &op_def).ok()) return;
+    if (opts_.add_default_attributes) {
+      AddDefaultsToNodeDef(*op_def, &node_def);
+    }
+    if (opts_.validate_nodes && !ValidateNodeDef(node_def, *op_def).ok()) {
+      return;
+    }
+    StatusOr<std::shared_ptr<NodeProperties>> props =
+        g_->MakeNodeProperties(std::move(node_def));
+    if (props.ok()) prepared->props = *std::move(props);
+  };
+  // A rough estimate of the cost of preparing one node, in cycles.
+  static constexpr int64_t kCostPerNode = 10000;
+  opts_.thread_pool->ParallelFor(
+      prepared.size(), kCostPerNode, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          prepare(i, &prepared[i]);
+        }
+      });
+  return prepared;
+}
+
 void GraphConstructor::Undo() {
   for (const auto& iter : gdef_nodes_) {
     if (iter.second.node != nullptr) {
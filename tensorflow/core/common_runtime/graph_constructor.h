@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 class ShapeRefiner;
@@ -52,6 +53,13 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If not null, the work on each NodeDef that does not depend on the other
+  // nodes (op lookup, adding default attrs, validation and type inference) is
+  // done in parallel on this thread pool before the nodes are added to the
+  // graph in topological order. The resulting graph, and the returned error if
+  // any, are the same as without a thread pool. Not owned.
+  thread::ThreadPool* thread_pool = nullptr;
 };
 extern Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                      const GraphDef& gdef, Graph* g);
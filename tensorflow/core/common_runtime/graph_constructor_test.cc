@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/version.h"
 
@@ -916,6 +917,85 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+TEST_F(GraphConstructorTest, ConvertWithThreadPool) {
+  GraphDef gdef;
+  for (int i = 0; i < 100; ++i) {
+    NodeDef* params = gdef.add_node();
+    params->set_name(strings::StrCat("W", i));
+    params->set_op("TestParams");
+    NodeDef* mul = gdef.add_node();
+    mul->set_name(strings::StrCat("t", i));
+    mul->set_op("TestMul");
+    mul->add_input(strings::StrCat("W", i));
+    mul->add_input(i == 0 ? "W0" : strings::StrCat("t", i - 1));
+    NodeDef* defaults = gdef.add_node();
+    defaults->set_name(strings::StrCat("d", i));
+    defaults->set_op("TestDefaultAttr");
+    defaults->add_input(strings::StrCat("^t", i));
+  }
+  GraphConstructorOptions opts;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, gdef, &graph_));
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  opts.thread_pool = &pool;
+  Graph parallel_graph(OpRegistry::Global());
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, gdef, &parallel_graph));
+  EXPECT_EQ(graph_.ToGraphDefDebug().DebugString(),
+            parallel_graph.ToGraphDefDebug().DebugString());
+  Node* d = nullptr;
+  for (Node* n : parallel_graph.nodes()) {
+    if (n->name() == "d7") d = n;
+  }
+  ASSERT_NE(d, nullptr);
+  int default_int;
+  TF_ASSERT_OK(GetNodeAttr(d->attrs(), "default_int", &default_int));
+  EXPECT_EQ(31415, default_int);
+}
+
+TEST_F(GraphConstructorTest, ConvertWithThreadPool_Error) {
+  GraphDef gdef;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 'bad' op: 'NoSuchOp' input: [ 'W1' ] }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ] }"
+      "node { name: 't2' op: 'TestMul' input: [ 'W1', 'input:1' ] }",
+      &gdef));
+  GraphConstructorOptions opts;
+  Status serial_status = ConvertGraphDefToGraph(opts, gdef, &graph_);
+  ASSERT_FALSE(serial_status.ok());
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  opts.thread_pool = &pool;
+  Graph parallel_graph(OpRegistry::Global());
+  Status parallel_status = ConvertGraphDefToGraph(opts, gdef, &parallel_graph);
+  EXPECT_EQ(serial_status, parallel_status);
+}
+
+// The errors of a node that fails to be prepared come after those about its
+// inputs, also when its NodeDef is moved from the GraphDef.
+TEST_F(GraphConstructorTest, ConvertWithThreadPool_InputErrorFirst) {
+  GraphDef gdef;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 'bad' op: 'NoSuchOp' input: [ 'input:5' ] }",
+      &gdef));
+  GraphConstructorOptions opts;
+  Status serial_status = ConvertGraphDefToGraph(opts, gdef, &graph_);
+  EXPECT_TRUE(absl::StrContains(serial_status.message(),
+                                "Connecting to invalid output 5"))
+      << serial_status;
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  opts.thread_pool = &pool;
+  Graph parallel_graph(OpRegistry::Global());
+  EXPECT_EQ(serial_status,
+            ConvertGraphDefToGraph(opts, gdef, &parallel_graph));
+  Graph moved_graph(OpRegistry::Global());
+  EXPECT_EQ(serial_status,
+            ConvertGraphDefToGraph(opts, std::move(gdef), &moved_graph));
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
 #include <string>
@@ -22,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
 #include "absl/strings/str_join.h"
@@ -49,9 +51,12 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/public/version.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/util.h"
 
@@ -69,6 +74,19 @@ bool IsCollectiveV2(const string& op) {
          op == "CollectiveBcastRecvV2" || op == "CollectiveBcastSendV2" ||
          op == "ColectiveReduceScatterV2" || op == "ColectiveAllToAllV2";
 }
+
+// Returns the options for converting `graph_def` to a graph, which prepare
+// the nodes in parallel on `thread_pool` if the graph is large enough.
+GraphConstructorOptions ConstructorOptions(const GraphDef& graph_def,
+                                           thread::ThreadPool* thread_pool) {
+  // Below this size, the parallel preparation is not worth scheduling.
+  static constexpr int kMinNodesForParallelConstruction = 1000;
+  GraphConstructorOptions opts;
+  if (graph_def.node_size() >= kMinNodesForParallelConstruction) {
+    opts.thread_pool = thread_pool;
+  }
+  return opts;
+}
 }  // namespace
 
 GraphExecutionState::GraphExecutionState(
@@ -82,7 +100,10 @@ GraphExecutionState::GraphExecutionState(
       session_handle_(options.session_handle),
       flib_def_(std::move(flib_def)),
       graph_(nullptr),
-      run_placer_(options.run_placer) {}
+      run_placer_(options.run_placer),
+      optimized_graph_cache_(options.optimized_graph_cache),
+      graph_construction_thread_pool_(options.graph_construction_thread_pool) {
+}
 
 GraphExecutionState::~GraphExecutionState() {
   node_name_to_cost_id_map_.clear();
@@ -113,8 +134,10 @@ GraphExecutionState::~GraphExecutionState() {
     // construct a Graph* in this case.
     if (!options.session_options->config.graph_options().place_pruned_graph()) {
       auto base_graph = std::make_unique<Graph>(OpRegistry::Global());
-      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph({}, *ret->original_graph_def_,
-                                                base_graph.get()));
+      TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+          ConstructorOptions(*ret->original_graph_def_,
+                             options.graph_construction_thread_pool),
+          *ret->original_graph_def_, base_graph.get()));
       TF_RETURN_IF_ERROR(ret->InitBaseGraph(std::move(base_graph)));
     }
     *out_state = std::move(ret);
@@ -122,8 +145,10 @@ GraphExecutionState::~GraphExecutionState() {
     auto ret = absl::WrapUnique(
         new GraphExecutionState(nullptr, std::move(flib_def), options));
     auto base_graph = std::make_unique<Graph>(OpRegistry::Global());
+    const GraphConstructorOptions opts = ConstructorOptions(
+        graph_def, options.graph_construction_thread_pool);
     TF_RETURN_IF_ERROR(
-        ConvertGraphDefToGraph({}, std::move(graph_def), base_graph.get()));
+        ConvertGraphDefToGraph(opts, std::move(graph_def), base_graph.get()));
     TF_RETURN_IF_ERROR(ret->InitBaseGraph(std::move(base_graph)));
     *out_state = std::move(ret);
   }
@@ -167,8 +192,10 @@ GraphExecutionState::~GraphExecutionState() {
       new GraphExecutionState(nullptr, std::move(flib_def), options));
 
   auto base_graph = std::make_unique<Graph>(OpRegistry::Global());
+  const GraphConstructorOptions opts =
+      ConstructorOptions(temp, options.graph_construction_thread_pool);
   TF_RETURN_IF_ERROR(
-      ConvertGraphDefToGraph({}, std::move(temp), base_graph.get()));
+      ConvertGraphDefToGraph(opts, std::move(temp), base_graph.get()));
 
   // Rewrite the graph before placement.
   ret->rewrite_metadata_.reset(new subgraph::RewriteGraphMetadata);
@@ -265,6 +292,9 @@ Status GraphExecutionState::Extend(
   combined_options.session_options = session_options_;
   combined_options.session_handle = session_handle_;
   combined_options.stateful_placements = stateful_placements_;
+  combined_options.optimized_graph_cache = optimized_graph_cache_;
+  combined_options.graph_construction_thread_pool =
+      graph_construction_thread_pool_;
 
   TF_RETURN_IF_ERROR(AddDefaultAttrsToGraphDef(&gdef, *flib_def_, 0));
   auto flib_def = std::make_unique<FunctionLibraryDefinition>(
@@ -276,7 +306,9 @@ Status GraphExecutionState::Extend(
   if (!session_options_->config.graph_options().place_pruned_graph()) {
     auto base_graph = std::make_unique<Graph>(OpRegistry::Global());
     TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
-        {}, *new_execution_state->original_graph_def_, base_graph.get()));
+        ConstructorOptions(*new_execution_state->original_graph_def_,
+                           graph_construction_thread_pool_),
+        *new_execution_state->original_graph_def_, base_graph.get()));
     TF_RETURN_IF_ERROR(
         new_execution_state->InitBaseGraph(std::move(base_graph)));
   }
@@ -468,6 +500,14 @@ Status ValidateFeedAndFetchDevices(
   return OkStatus();
 }
 
+// Returns true if `node` is a placeholder whose "shape" attribute only
+// describes the tensors fed to it.
+bool IsPlaceholderWithShape(const NodeDef& node) {
+  return (node.op() == "Placeholder" || node.op() == "PlaceholderV2" ||
+          node.op() == "PlaceholderWithDefault") &&
+         HasNodeAttr(node, "shape");
+}
+
 Status GetFeedShapeAndTypeFromAttribute(const NodeDef& node,
                                         PartialTensorShape* shape,
                                         DataType* type) {
@@ -646,9 +686,177 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
 
   SaveStatefulNodes(new_graph.get());
   graph_ = new_graph.release();
+  if (optimized_graph_cache_ != nullptr) {
+    flib_def_fingerprint_ = DeterministicProtoHash64(flib_def_->ToProto());
+  }
   return OkStatus();
 }
 
+bool OptimizedGraphCache::Lookup(
+    uint64 key, std::unique_ptr<Graph>* graph,
+    std::unique_ptr<FunctionLibraryDefinition>* flib_def) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  *graph = std::make_unique<Graph>(OpRegistry::Global());
+  CopyGraph(*it->second.graph, graph->get());
+  *flib_def = std::make_unique<FunctionLibraryDefinition>(*it->second.flib_def);
+  ++num_hits_;
+  return true;
+}
+
+void OptimizedGraphCache::Insert(uint64 key, const Graph& graph,
+                                 const FunctionLibraryDefinition& flib_def) {
+  Entry entry;
+  entry.graph = std::make_unique<Graph>(OpRegistry::Global());
+  CopyGraph(graph, entry.graph.get());
+  entry.flib_def = std::make_unique<FunctionLibraryDefinition>(flib_def);
+
+  mutex_lock l(mu_);
+  if (!entries_.emplace(key, std::move(entry)).second) return;
+  insertion_order_.push_back(key);
+  while (insertion_order_.size() > capacity_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+Status OptimizedGraphCache::AddFromProto(const OptimizedGraphCacheDef& def) {
+  if (def.tensorflow_version() != TF_VERSION_STRING) {
+    return errors::FailedPrecondition(
+        "The optimized graphs were written by TensorFlow ",
+        def.tensorflow_version(), ", not by TensorFlow ", TF_VERSION_STRING);
+  }
+  std::vector<std::pair<uint64, Entry>> entries;
+  entries.reserve(def.entry_size());
+  for (const OptimizedGraphCacheDef::Entry& entry_def : def.entry()) {
+    // Rebuild the graph as `OptimizeGraph()` builds it from the output of
+    // Grappler.
+    Entry entry;
+    entry.flib_def = std::make_unique<FunctionLibraryDefinition>(
+        OpRegistry::Global(), entry_def.graph().library());
+    entry.graph = std::make_unique<Graph>(OpRegistry::Global());
+    GraphConstructorOptions opts;
+    opts.allow_internal_ops = true;
+    TF_RETURN_IF_ERROR(
+        ConvertGraphDefToGraph(opts, entry_def.graph(), entry.graph.get()));
+    for (Node* node : entry.graph->nodes()) {
+      node->set_assigned_device_name(node->requested_device());
+    }
+    entries.emplace_back(entry_def.key(), std::move(entry));
+  }
+
+  mutex_lock l(mu_);
+  for (auto& entry : entries) {
+    if (!entries_.emplace(entry.first, std::move(entry.second)).second) {
+      continue;
+    }
+    insertion_order_.push_back(entry.first);
+  }
+  while (insertion_order_.size() > capacity_) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+  return OkStatus();
+}
+
+void OptimizedGraphCache::ToProto(OptimizedGraphCacheDef* def) const {
+  def->Clear();
+  def->set_tensorflow_version(TF_VERSION_STRING);
+  tf_shared_lock l(mu_);
+  for (uint64 key : insertion_order_) {
+    const Entry& entry = entries_.at(key);
+    OptimizedGraphCacheDef::Entry* entry_def = def->add_entry();
+    entry_def->set_key(key);
+    entry.graph->ToGraphDef(entry_def->mutable_graph());
+    *entry_def->mutable_graph()->mutable_library() = entry.flib_def->ToProto();
+  }
+}
+
+uint64 GraphExecutionState::OptimizedGraphKey(
+    const BuildGraphOptions& options) const {
+  // Grappler only keeps the fanin of the fetches and targets, which is then
+  // pruned by `BuildGraph()`, so the optimized graph only depends on the
+  // definitions and placement of these nodes, and on the optimization inputs
+  // that are not part of the graph.
+  absl::flat_hash_map<absl::string_view, const Node*> nodes_by_name;
+  nodes_by_name.reserve(graph_->num_nodes());
+  for (const Node* node : graph_->op_nodes()) {
+    nodes_by_name.emplace(node->name(), node);
+  }
+  std::vector<const Node*> roots;
+  auto add_root = [&](const string& tensor_name) {
+    auto it = nodes_by_name.find(ParseTensorName(tensor_name).node());
+    if (it != nodes_by_name.end()) roots.push_back(it->second);
+  };
+  for (const string& fetch : options.callable_options.fetch()) {
+    add_root(fetch);
+  }
+  for (const string& target : options.callable_options.target()) {
+    add_root(target);
+  }
+  for (const TensorConnection& tensor_connection :
+       options.callable_options.tensor_connection()) {
+    add_root(tensor_connection.from_tensor());
+  }
+
+  // The node hashes are combined in an order that does not depend on the
+  // node ids, which change when the graph is extended.
+  std::vector<uint64> node_hashes;
+  ReverseDFSFrom(*graph_, roots, /*enter=*/nullptr,
+                 [&node_hashes](const Node* node) {
+                   if (!node->IsOp()) return;
+                   node_hashes.push_back(
+                       Hash64Combine(DeterministicProtoHash64(node->def()),
+                                     Hash64(node->assigned_device_name())));
+                 });
+  std::sort(node_hashes.begin(), node_hashes.end());
+
+  // Only the parts of the callable options that `OptimizeGraph()` uses are
+  // part of the key, so that e.g. callables that only differ in their feed
+  // and fetch devices share the optimized graph.
+  CallableOptions optimized_callable_options;
+  *optimized_callable_options.mutable_feed() = options.callable_options.feed();
+  *optimized_callable_options.mutable_fetch() =
+      options.callable_options.fetch();
+  *optimized_callable_options.mutable_target() =
+      options.callable_options.target();
+  *optimized_callable_options.mutable_tensor_connection() =
+      options.callable_options.tensor_connection();
+  uint64 key = DeterministicProtoHash64(optimized_callable_options);
+  key = Hash64Combine(key, flib_def_fingerprint_);
+  key = Hash64Combine(key, graph_->versions().producer());
+  if (session_options_ != nullptr) {
+    // The graph options, which include the rewriter options, are constant for
+    // a session, but not for the processes that share a serialized cache.
+    key = Hash64Combine(key, DeterministicProtoHash64(
+                                 session_options_->config.graph_options()));
+  }
+  // Grappler optimizes for the type, memory and e.g. compute capability of
+  // the devices, which a serialized cache may have been built for on other
+  // hardware. The incarnation is left out, as it changes in every process.
+  for (const Device* device : device_set_->devices()) {
+    const DeviceAttributes& attributes = device->attributes();
+    key = Hash64Combine(key, Hash64(attributes.name()));
+    key = Hash64Combine(key, Hash64(attributes.device_type()));
+    key = Hash64Combine(key, attributes.memory_limit());
+    key = Hash64Combine(key, Hash64(attributes.physical_device_desc()));
+  }
+  // The remapper and layout rewrites depend on whether oneDNN is enabled,
+  // which is read from the environment rather than the session options.
+  key = Hash64Combine(key, IsMKLEnabled() ? 1 : 0);
+  for (uint64 node_hash : node_hashes) {
+    key = Hash64Combine(key, node_hash);
+  }
+  for (const auto& feed_shape : options.feed_shapes) {
+    TensorShapeProto shape;
+    feed_shape.second.AsProto(&shape);
+    key = Hash64Combine(key, Hash64(feed_shape.first));
+    key = Hash64Combine(key, DeterministicProtoHash64(shape));
+  }
+  return key;
+}
+
 Status GraphExecutionState::OptimizeGraph(
     const BuildGraphOptions& options, const Graph& graph,
     const FunctionLibraryDefinition* flib_def,
@@ -690,6 +898,10 @@ Status GraphExecutionState::OptimizeGraph(
 
     // Add feeds to the GrapplerItem if we know them.
     absl::flat_hash_set<absl::string_view> node_names;
+    // The fed placeholders whose shape attributes are set to the concrete
+    // shapes of `options.feed_shapes`, so that Grappler can fold the shape
+    // computations on them.
+    absl::flat_hash_map<string, TensorShape> specialized_placeholders;
     if (!(options.callable_options.feed().empty() &&
           options.callable_options.tensor_connection().empty())) {
       std::vector<SafeTensorId> feeds;
@@ -706,6 +918,15 @@ Status GraphExecutionState::OptimizeGraph(
       // the graph to infer feed data type and shape.
       absl::flat_hash_set<absl::string_view> feed_nodes;
 
+      // The concrete shapes the fed nodes are specialized to, if any.
+      absl::flat_hash_map<string, TensorShape> feed_node_shapes;
+      for (const auto& feed_shape : options.feed_shapes) {
+        SafeTensorId feed = ParseTensorName(feed_shape.first);
+        if (feed.index() == 0) {
+          feed_node_shapes.emplace(feed.node(), feed_shape.second);
+        }
+      }
+
       // For feeds with tensor index larger than 0, we can't infer data type or
       // shape from the graph. Currently we only support type and shape
       // inference from a small set of node types: Placeholder, Const, etc...
@@ -748,7 +969,13 @@ Status GraphExecutionState::OptimizeGraph(
         // choose 0 to minimize the memory impact. Note that this only matters
         // if an optimizer chooses to run the graph.
         TensorShape shape;
-        if (partial_shape.unknown_rank()) {
+        auto specialized_shape = feed_node_shapes.find(node->name());
+        if (specialized_shape != feed_node_shapes.end() &&
+            IsPlaceholderWithShape(node->def()) &&
+            partial_shape.IsCompatibleWith(specialized_shape->second)) {
+          shape = specialized_shape->second;
+          specialized_placeholders.emplace(node->name(), shape);
+        } else if (partial_shape.unknown_rank()) {
           shape = TensorShape({0});
         } else {
           for (int i = 0; i < partial_shape.dims(); ++i) {
@@ -795,6 +1022,13 @@ Status GraphExecutionState::OptimizeGraph(
 
     // Convert Graph to GraphDef and add it to the GrapplerItem.
     graph.ToGraphDef(&item.graph);
+    if (!specialized_placeholders.empty()) {
+      for (NodeDef& node : *item.graph.mutable_node()) {
+        auto it = specialized_placeholders.find(node.name());
+        if (it == specialized_placeholders.end()) continue;
+        it->second.AsProto((*node.mutable_attr())["shape"].mutable_shape());
+      }
+    }
     // TODO(b/114748242): Add a unit test to test this bug fix.
     if (flib_def) {
       *item.graph.mutable_library() = flib_def->ToProto();
@@ -872,15 +1106,28 @@ Status GraphExecutionState::BuildGraph(const BuildGraphOptions& options,
   std::unique_ptr<Graph> optimized_graph;
   std::unique_ptr<FunctionLibraryDefinition> optimized_flib;
 
-  Status s = OptimizeGraph(options, *graph_, flib_def_.get(), &optimized_graph,
-                           &optimized_flib);
-  if (!s.ok()) {
-    VLOG(2) << "Grappler optimization failed. Error: " << s.message();
-    // Simply copy the original graph and the function library if we couldn't
-    // optimize it.
-    optimized_graph.reset(new Graph(flib_def_.get()));
-    CopyGraph(*graph_, optimized_graph.get());
-    optimized_flib = std::make_unique<FunctionLibraryDefinition>(*flib_def_);
+  uint64 optimized_graph_key = 0;
+  if (optimized_graph_cache_ != nullptr) {
+    optimized_graph_key = OptimizedGraphKey(options);
+  }
+  if (optimized_graph_cache_ != nullptr &&
+      optimized_graph_cache_->Lookup(optimized_graph_key, &optimized_graph,
+                                     &optimized_flib)) {
+    VLOG(2) << "Reusing the optimized graph " << optimized_graph_key;
+  } else {
+    Status s = OptimizeGraph(options, *graph_, flib_def_.get(),
+                             &optimized_graph, &optimized_flib);
+    if (!s.ok()) {
+      VLOG(2) << "Grappler optimization failed. Error: " << s.message();
+      // Simply copy the original graph and the function library if we
+      // couldn't optimize it.
+      optimized_graph.reset(new Graph(flib_def_.get()));
+      CopyGraph(*graph_, optimized_graph.get());
+      optimized_flib = std::make_unique<FunctionLibraryDefinition>(*flib_def_);
+    } else if (optimized_graph_cache_ != nullptr) {
+      optimized_graph_cache_->Insert(optimized_graph_key, *optimized_graph,
+                                     *optimized_flib);
+    }
   }
 
   subgraph::RewriteGraphMetadata rewrite_metadata;
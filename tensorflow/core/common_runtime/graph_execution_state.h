@@ -16,11 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_EXECUTION_STATE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GRAPH_EXECUTION_STATE_H_
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/build_graph_options.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_set.h"
@@ -30,7 +32,11 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/optimized_graph_cache.pb.h"
 
 namespace tensorflow {
 struct SessionOptions;
@@ -39,6 +45,61 @@ namespace subgraph {
 struct RewriteGraphMetadata;
 }
 
+// Memoizes the graphs optimized by Grappler in
+// `GraphExecutionState::BuildGraph()`, keyed by a structural fingerprint of
+// the subgraph that is optimized (the fanin of the fetches and targets) and of
+// the optimization inputs.
+//
+// A cache may be shared by the successive `GraphExecutionState`s of a session,
+// so that building a client graph after `Extend()`, or for a new signature
+// whose subgraph was already optimized, does not run Grappler again. It may
+// also be serialized, to skip Grappler in other processes that build the same
+// graphs with the same devices and graph options.
+//
+// This class is thread-safe.
+class OptimizedGraphCache {
+ public:
+  // Keeps at most `capacity` graphs, and evicts the oldest first.
+  explicit OptimizedGraphCache(int capacity) : capacity_(capacity) {}
+
+  OptimizedGraphCache(const OptimizedGraphCache&) = delete;
+  void operator=(const OptimizedGraphCache&) = delete;
+
+  // If a graph was inserted with `key`, sets `*graph` and `*flib_def` to
+  // copies of it and of its function library, and returns true.
+  bool Lookup(uint64 key, std::unique_ptr<Graph>* graph,
+              std::unique_ptr<FunctionLibraryDefinition>* flib_def);
+
+  // Inserts copies of `graph` and `flib_def` with `key`.
+  void Insert(uint64 key, const Graph& graph,
+              const FunctionLibraryDefinition& flib_def);
+
+  // Adds the graphs of `def`, which was written by `ToProto()`. Returns an
+  // error, and adds no graph, if `def` was written by another version of
+  // TensorFlow or one of its graphs is invalid.
+  Status AddFromProto(const OptimizedGraphCacheDef& def);
+
+  // Writes the graphs of the cache to `def`, oldest first.
+  void ToProto(OptimizedGraphCacheDef* def) const;
+
+  int64_t num_hits() const {
+    tf_shared_lock l(mu_);
+    return num_hits_;
+  }
+
+ private:
+  struct Entry {
+    std::unique_ptr<Graph> graph;
+    std::unique_ptr<FunctionLibraryDefinition> flib_def;
+  };
+
+  const int capacity_;
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+};
+
 struct GraphExecutionStateOptions {
   const DeviceSet* device_set = nullptr;
   const SessionOptions* session_options = nullptr;
@@ -49,6 +110,12 @@ struct GraphExecutionStateOptions {
   std::unordered_map<string, string> stateful_placements;
   // Whether to run Placer on the graph.
   bool run_placer = true;
+  // If not null, the optimized graphs of `BuildGraph()` are memoized in this
+  // cache, which is also used by the states created by `Extend()`.
+  std::shared_ptr<OptimizedGraphCache> optimized_graph_cache;
+  // If not null, the nodes of large graphs are prepared in parallel on this
+  // thread pool when the graphs are converted from GraphDefs. Not owned.
+  thread::ThreadPool* graph_construction_thread_pool = nullptr;
 };
 
 // A ClientGraph is simply a sub-graph of the full graph as induced by
@@ -198,6 +265,10 @@ class GraphExecutionState {
   Status PruneGraph(const BuildGraphOptions& options, Graph* graph,
                     subgraph::RewriteGraphMetadata* out_rewrite_metadata);
 
+  // Returns the key of the graph that `OptimizeGraph(options, *graph_, ...)`
+  // returns in `optimized_graph_cache_`.
+  uint64 OptimizedGraphKey(const BuildGraphOptions& options) const;
+
   // The GraphExecutionState must store a copy of the original GraphDef if
   // either of the following conditions holds:
   //
@@ -228,6 +299,15 @@ class GraphExecutionState {
   // Whether to run Placer.
   bool run_placer_;
 
+  // May be null, and may be shared with other states.
+  std::shared_ptr<OptimizedGraphCache> optimized_graph_cache_;
+  // A fingerprint of `*flib_def_`, set by `InitBaseGraph()` if
+  // `optimized_graph_cache_` is not null.
+  uint64 flib_def_fingerprint_ = 0;
+
+  // May be null. Not owned.
+  thread::ThreadPool* const graph_construction_thread_pool_;
+
   GraphExecutionState(const GraphExecutionState&) = delete;
   void operator=(const GraphExecutionState&) = delete;
 };
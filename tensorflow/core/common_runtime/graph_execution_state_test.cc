@@ -0,0 +1,221 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/graph_execution_state.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/threadpool_device.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+using test::function::NDef;
+
+constexpr char kDevice[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+class GraphExecutionStateTest : public ::testing::Test {
+ protected:
+  GraphExecutionStateTest() {
+    device_ = DeviceFactory::NewDevice("CPU", {},
+                                       "/job:localhost/replica:0/task:0");
+    device_set_.AddDevice(device_.get());
+    // Required by `Extend()`.
+    session_options_.config.mutable_experimental()
+        ->set_disable_optimize_for_static_graph(true);
+  }
+
+  GraphExecutionStateOptions Options(
+      std::shared_ptr<OptimizedGraphCache> cache) {
+    GraphExecutionStateOptions options;
+    options.device_set = &device_set_;
+    options.session_options = &session_options_;
+    options.optimized_graph_cache = std::move(cache);
+    return options;
+  }
+
+  // Returns a graph where `b = Identity(a)` and `a` is a constant.
+  static GraphDef MakeGraph(float a) {
+    return test::function::GDef(
+        {NDef("a", "Const", {},
+              {{"dtype", DT_FLOAT}, {"value", test::AsScalar<float>(a)}},
+              kDevice),
+         NDef("b", "Identity", {"a"}, {{"T", DT_FLOAT}}, kDevice)},
+        {});
+  }
+
+  static BuildGraphOptions Fetch(const string& fetch) {
+    BuildGraphOptions options;
+    options.callable_options.add_fetch(fetch);
+    return options;
+  }
+
+  static bool HasNode(const ClientGraph& client_graph, const string& name) {
+    for (const Node* node : client_graph.graph.op_nodes()) {
+      if (node->name() == name) return true;
+    }
+    return false;
+  }
+
+  std::unique_ptr<Device> device_;
+  DeviceSet device_set_;
+  SessionOptions session_options_;
+};
+
+TEST_F(GraphExecutionStateTest, ReusesOptimizedGraphAfterExtend) {
+  auto cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/4);
+  std::unique_ptr<GraphExecutionState> state;
+  TF_ASSERT_OK(
+      GraphExecutionState::MakeForBaseGraph(MakeGraph(1), Options(cache),
+                                            &state));
+
+  std::unique_ptr<ClientGraph> client_graph;
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(0, cache->num_hits());
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(1, cache->num_hits());
+
+  // Adding a node outside of the fanin of `b` does not change its optimized
+  // graph.
+  std::unique_ptr<GraphExecutionState> extended_state;
+  TF_ASSERT_OK(state->Extend(
+      test::function::GDef(
+          {NDef("c", "Identity", {"a"}, {{"T", DT_FLOAT}}, kDevice)}, {}),
+      &extended_state));
+  TF_ASSERT_OK(extended_state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(2, cache->num_hits());
+  EXPECT_FALSE(HasNode(*client_graph, "c"));
+
+  // Other fetches are optimized separately.
+  TF_ASSERT_OK(extended_state->BuildGraph(Fetch("c:0"), &client_graph));
+  EXPECT_EQ(2, cache->num_hits());
+  EXPECT_FALSE(HasNode(*client_graph, "b"));
+}
+
+TEST_F(GraphExecutionStateTest, ChangedFaninIsOptimizedAgain) {
+  auto cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/4);
+  std::unique_ptr<GraphExecutionState> state;
+  TF_ASSERT_OK(
+      GraphExecutionState::MakeForBaseGraph(MakeGraph(1), Options(cache),
+                                            &state));
+  std::unique_ptr<ClientGraph> client_graph;
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+
+  std::unique_ptr<GraphExecutionState> other_state;
+  TF_ASSERT_OK(GraphExecutionState::MakeForBaseGraph(
+      MakeGraph(2), Options(cache), &other_state));
+  TF_ASSERT_OK(other_state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(0, cache->num_hits());
+}
+
+TEST_F(GraphExecutionStateTest, EvictsOldestGraph) {
+  auto cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/1);
+  std::unique_ptr<GraphExecutionState> state;
+  TF_ASSERT_OK(
+      GraphExecutionState::MakeForBaseGraph(MakeGraph(1), Options(cache),
+                                            &state));
+  std::unique_ptr<ClientGraph> client_graph;
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  TF_ASSERT_OK(state->BuildGraph(Fetch("a:0"), &client_graph));
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(0, cache->num_hits());
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(1, cache->num_hits());
+}
+
+TEST_F(GraphExecutionStateTest, ReusesSerializedOptimizedGraph) {
+  auto cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/4);
+  std::unique_ptr<GraphExecutionState> state;
+  TF_ASSERT_OK(
+      GraphExecutionState::MakeForBaseGraph(MakeGraph(1), Options(cache),
+                                            &state));
+  std::unique_ptr<ClientGraph> client_graph;
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  OptimizedGraphCacheDef cache_def;
+  cache->ToProto(&cache_def);
+  ASSERT_EQ(1, cache_def.entry_size());
+
+  // A new cache built from the serialized graphs, e.g. in another process,
+  // skips Grappler for the same graph.
+  auto loaded_cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/4);
+  TF_ASSERT_OK(loaded_cache->AddFromProto(cache_def));
+  std::unique_ptr<GraphExecutionState> loaded_state;
+  TF_ASSERT_OK(GraphExecutionState::MakeForBaseGraph(
+      MakeGraph(1), Options(loaded_cache), &loaded_state));
+  TF_ASSERT_OK(loaded_state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(1, loaded_cache->num_hits());
+  EXPECT_TRUE(HasNode(*client_graph, "b"));
+
+  // But not with other graph options.
+  session_options_.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  TF_ASSERT_OK(GraphExecutionState::MakeForBaseGraph(
+      MakeGraph(1), Options(loaded_cache), &loaded_state));
+  TF_ASSERT_OK(loaded_state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(1, loaded_cache->num_hits());
+}
+
+TEST_F(GraphExecutionStateTest, SerializedGraphNotReusedOnOtherDevices) {
+  auto cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/4);
+  std::unique_ptr<GraphExecutionState> state;
+  TF_ASSERT_OK(
+      GraphExecutionState::MakeForBaseGraph(MakeGraph(1), Options(cache),
+                                            &state));
+  std::unique_ptr<ClientGraph> client_graph;
+  TF_ASSERT_OK(state->BuildGraph(Fetch("b:0"), &client_graph));
+  OptimizedGraphCacheDef cache_def;
+  cache->ToProto(&cache_def);
+
+  // A device of the same name, but with another memory limit, may be
+  // optimized for differently.
+  ThreadPoolDevice other_device(SessionOptions(), kDevice, Bytes(512 << 20),
+                                DeviceLocality(), cpu_allocator());
+  ASSERT_NE(other_device.attributes().memory_limit(),
+            device_->attributes().memory_limit());
+  DeviceSet other_device_set;
+  other_device_set.AddDevice(&other_device);
+  auto loaded_cache = std::make_shared<OptimizedGraphCache>(/*capacity=*/4);
+  TF_ASSERT_OK(loaded_cache->AddFromProto(cache_def));
+  GraphExecutionStateOptions options = Options(loaded_cache);
+  options.device_set = &other_device_set;
+  std::unique_ptr<GraphExecutionState> loaded_state;
+  TF_ASSERT_OK(GraphExecutionState::MakeForBaseGraph(MakeGraph(1), options,
+                                                     &loaded_state));
+  TF_ASSERT_OK(loaded_state->BuildGraph(Fetch("b:0"), &client_graph));
+  EXPECT_EQ(0, loaded_cache->num_hits());
+}
+
+TEST_F(GraphExecutionStateTest, RejectsOptimizedGraphsOfOtherVersions) {
+  OptimizedGraphCacheDef cache_def;
+  cache_def.set_tensorflow_version("0.0.0");
+  cache_def.add_entry()->set_key(1);
+  OptimizedGraphCache cache(/*capacity=*/4);
+  EXPECT_EQ(absl::StatusCode::kFailedPrecondition,
+            cache.AddFromProto(cache_def).code());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -111,6 +111,15 @@ struct NodeItem {
   // is true if and only if the ith output is consumed by another node.
   std::unique_ptr<bool[]> outputs_required;
 
+  // If non-null, contains an array of num_outputs ints, where the ith int is
+  // the index of the `_Retval` node that returns the ith output, or -1 if the
+  // output is not returned directly.
+  std::unique_ptr<int[]> output_retval_index;
+
+  // If non-null, contains an array of num_outputs hints about how long each
+  // output stays live, passed to the allocator when the output is allocated.
+  std::unique_ptr<AllocationLifetime[]> output_lifetime;
+
   gtl::MutableArraySlice<EdgeInfo> mutable_output_edges() {
     return gtl::MutableArraySlice<EdgeInfo>(output_edge_base(),
                                             num_output_edges);
@@ -0,0 +1,394 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+// Set true for greater intelligibility of debug mode log messages.
+#define READABLE_KEYS false
+
+namespace tensorflow {
+
+namespace {
+// Key to be used for BufRendezvous by HierarchicalReducer.
+string ReduceBufKey(const string& exec_key, int phase, int subdiv, int src_rank,
+                    int dst_rank) {
+  if (READABLE_KEYS) {
+    return strings::StrCat("hierarchical_reduce(", exec_key, "):phase(", phase,
+                           "):subdiv(", subdiv, "):src(", src_rank, "):dst(",
+                           dst_rank, ")");
+  } else {
+    return strings::StrCat(exec_key, ":", phase, ":", subdiv, ":", src_rank,
+                           ":", dst_rank);
+  }
+}
+
+// Starts `num_ops` async actions with `dispatch`, and waits for all of them to
+// complete.  Returns the first error, if any.
+Status DispatchAndWait(
+    int num_ops,
+    const std::function<void(int, const StatusCallback&)>& dispatch) {
+  mutex mu;
+  Status status;
+  BlockingCounter pending(num_ops);
+  for (int i = 0; i < num_ops; ++i) {
+    dispatch(i, [&mu, &status, &pending](const Status& s) {
+      {
+        mutex_lock l(mu);
+        status.Update(s);
+      }
+      pending.DecrementCount();
+    });
+  }
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+}  // namespace
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr), col_params_(nullptr), done_(nullptr) {}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalReduce");
+  const string& device_name =
+      col_params->group.members[col_params->default_rank].device.name();
+  // Start by counting the devices in each task.
+  // Precondition: device_names must be sorted so that all devices in
+  // the same task are adjacent.
+  std::vector<int> dev_per_task;
+  const string* prior_task_name = &col_params->group.members[0].task;
+  int dev_count = 1;
+  for (int di = 1; di < col_params->group.group_size; ++di) {
+    if (col_params->group.members[di].task != *prior_task_name) {
+      dev_per_task.push_back(dev_count);
+      dev_count = 1;
+      prior_task_name = &col_params->group.members[di].task;
+    } else {
+      ++dev_count;
+    }
+  }
+  dev_per_task.push_back(dev_count);
+  if (col_params->group.num_tasks != dev_per_task.size()) {
+    return errors::Internal(
+        "HierarchicalReducer expects the devices of each task to be adjacent "
+        "in the group, found ",
+        dev_per_task.size(), " runs of devices for ",
+        col_params->group.num_tasks, " tasks");
+  }
+
+  // If there is just 1 task, then execute a binary tree reduce over all
+  // devices.  Otherwise, the first subdiv is the inter-task reduce, and then
+  // there are N more subdivs, where N is #task.
+  const int num_tasks = col_params->group.num_tasks;
+  const int num_subdivs = num_tasks + (num_tasks > 1 ? 1 : 0);
+  auto& impl = col_params->instance.impl_details;
+  impl.subdiv_permutations.resize(num_subdivs);
+  col_params->subdiv_rank.reserve(num_subdivs);
+
+  // Inter-task subdiv.  Pick the first device of each task.  If a device does
+  // not participate in the subdiv, set subdiv_rank to -1.
+  if (num_tasks > 1) {
+    std::vector<int>& perm = impl.subdiv_permutations[0];
+    int my_rank = -1;
+    int device_count = 0;
+    for (int ti = 0; ti < num_tasks; ++ti) {
+      perm.push_back(device_count);
+      if (col_params->group.members[device_count].device.name() ==
+          device_name) {
+        my_rank = ti;
+      }
+      device_count += dev_per_task[ti];
+    }
+    col_params->subdiv_rank.push_back(my_rank);
+  }
+
+  // Intra-task subdivs.  Pick all devices in task ti for subdiv sdi.
+  int abs_di = 0;
+  for (int ti = 0; ti < num_tasks; ++ti) {
+    const int sdi = ti + (num_tasks > 1 ? 1 : 0);
+    std::vector<int>& perm = impl.subdiv_permutations[sdi];
+    int my_rank = -1;
+    for (int di = 0; di < dev_per_task[ti]; ++di) {
+      perm.push_back(abs_di);
+      if (col_params->group.members[abs_di].device.name() == device_name) {
+        my_rank = di;
+      }
+      ++abs_di;
+    }
+    col_params->subdiv_rank.push_back(my_rank);
+  }
+
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return OkStatus();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalReducer` doesn't require non-overlapping collectives,
+  // unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  done_ = std::move(done);
+  Status s = RunReduce();
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << s;
+  done_(s);
+}
+
+/* static */
+void HierarchicalReducer::TreeChildren(int rank, int num_ranks,
+                                       std::vector<int>* children) {
+  children->clear();
+  for (int child = 2 * rank + 1; child <= 2 * rank + 2; ++child) {
+    if (child < num_ranks) children->push_back(child);
+  }
+}
+
+// Executes a hierarchical all-reduce.
+// If there is only one task, the devices reduce and then broadcast the value
+// in a binary tree over subdiv 0.  If there are n tasks, n>1, each device
+// first reduces in the tree of its own task, i.e. subdiv i+1 for task i, then
+// the first device of each task reduces and broadcasts in the tree of subdiv
+// 0, and then each device broadcasts in the tree of its own task again.
+Status HierarchicalReducer::RunReduce() {
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    Notification note;
+    Status status;
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+
+  const int num_subdivs = static_cast<int>(col_params_->subdiv_rank.size());
+  const bool multi_task = num_subdivs > 1;
+  int local_subdiv = 0;
+  if (multi_task) {
+    for (int si = 1; si < num_subdivs; ++si) {
+      if (col_params_->subdiv_rank[si] >= 0) local_subdiv = si;
+    }
+  }
+  const bool is_task_leader = multi_task && col_params_->subdiv_rank[0] >= 0;
+  VLOG(1) << "HierarchicalReducer::RunReduce device=" << col_ctx_->device_name
+          << " local_subdiv=" << local_subdiv
+          << " is_task_leader=" << is_task_leader;
+
+  TF_RETURN_IF_ERROR(ReduceToRoot(local_subdiv));
+  if (is_task_leader) TF_RETURN_IF_ERROR(ReduceToRoot(0));
+  if (col_params_->subdiv_rank[0] == 0) TF_RETURN_IF_ERROR(Finalize());
+  if (is_task_leader) TF_RETURN_IF_ERROR(BroadcastFromRoot(0));
+  return BroadcastFromRoot(local_subdiv);
+}
+
+Status HierarchicalReducer::ReduceToRoot(int subdiv) {
+  profiler::TraceMe activity(
+      [&] { return strings::StrCat("ReduceToRoot:", subdiv); },
+      profiler::TraceMeLevel::kInfo);
+  const int my_rank = col_params_->subdiv_rank[subdiv];
+  const int num_ranks = static_cast<int>(
+      col_params_->instance.impl_details.subdiv_permutations[subdiv].size());
+  std::vector<int> children;
+  TreeChildren(my_rank, num_ranks, &children);
+  Tensor* output = col_ctx_->output;
+
+  if (!children.empty()) {
+    Allocator* allocator = col_ctx_->device->GetAllocator(
+        col_ctx_->op_ctx->output_alloc_attr(0));
+    std::vector<Tensor> values;
+    values.reserve(children.size());
+    for (int i = 0; i < children.size(); ++i) {
+      values.emplace_back(allocator, output->dtype(), output->shape());
+    }
+    const DeviceBase::AcceleratorDeviceInfo* gpu_info =
+        col_ctx_->device->tensorflow_accelerator_device_info();
+    if (gpu_info) {
+      // Wait for all currently queued events on the compute stream to complete
+      // before receiving, same as `RingReducer`, since the buffers just
+      // allocated are not guaranteed to be valid (e.g. for RDMA write) until
+      // then.
+      Notification note;
+      Status s = gpu_info->default_context->ThenExecute(
+          col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+      if (!s.ok()) {
+        return errors::Internal(
+            "Failed to dispatch ThenExecute in HierarchicalReducer");
+      }
+      note.WaitForNotification();
+    }
+    TF_RETURN_IF_ERROR(DispatchAndWait(
+        children.size(), [&](int i, const StatusCallback& done) {
+          DispatchRecv(kReduce, subdiv, children[i], my_rank, &values[i],
+                       done);
+        }));
+    for (Tensor& value : values) {
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, output, &value));
+    }
+  }
+
+  if (my_rank > 0) {
+    return DispatchAndWait(1, [&](int, const StatusCallback& done) {
+      DispatchSend(kReduce, subdiv, (my_rank - 1) / 2, my_rank, output, done);
+    });
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::BroadcastFromRoot(int subdiv) {
+  profiler::TraceMe activity(
+      [&] { return strings::StrCat("BroadcastFromRoot:", subdiv); },
+      profiler::TraceMeLevel::kInfo);
+  const int my_rank = col_params_->subdiv_rank[subdiv];
+  const int num_ranks = static_cast<int>(
+      col_params_->instance.impl_details.subdiv_permutations[subdiv].size());
+  Tensor* output = col_ctx_->output;
+
+  if (my_rank > 0) {
+    TF_RETURN_IF_ERROR(
+        DispatchAndWait(1, [&](int, const StatusCallback& done) {
+          DispatchRecv(kBroadcast, subdiv, (my_rank - 1) / 2, my_rank, output,
+                       done);
+        }));
+  }
+
+  std::vector<int> children;
+  TreeChildren(my_rank, num_ranks, &children);
+  return DispatchAndWait(
+      children.size(), [&](int i, const StatusCallback& done) {
+        DispatchSend(kBroadcast, subdiv, children[i], my_rank, output, done);
+      });
+}
+
+Status HierarchicalReducer::Finalize() {
+  if (col_params_->final_op == nullptr) return OkStatus();
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      col_ctx_->output, 1,
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0))));
+  Tensor group_size_val = ca->Scalar(col_params_->group.group_size);
+  Tensor group_size_tensor = group_size_val;
+  if (col_params_->group.device_type != "CPU") {
+    group_size_tensor = ca->Scalar(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+        AllocationAttributes());
+    Notification note;
+    Status status;
+    col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+        &group_size_val, col_ctx_->device, &group_size_tensor,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    TF_RETURN_IF_ERROR(status);
+  }
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, col_ctx_->output, &group_size_tensor);
+}
+
+void HierarchicalReducer::DispatchSend(Phase phase, int subdiv, int dst_rank,
+                                       int src_rank, const Tensor* src_tensor,
+                                       const StatusCallback& done) {
+  string send_buf_key =
+      ReduceBufKey(col_ctx_->exec_key, phase, subdiv, src_rank, dst_rank);
+  int dst_idx =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv][dst_rank];
+  VLOG(3) << "DispatchSend " << send_buf_key << " from_device "
+          << col_ctx_->device_name << " to_device "
+          << col_params_->group.members[dst_idx].device.name()
+          << " subdiv=" << subdiv << " dst_rank=" << dst_rank
+          << " dst_idx=" << dst_idx;
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[dst_idx].device.name(),
+      col_params_->group.members[dst_idx].task, send_buf_key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
+      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
+void HierarchicalReducer::DispatchRecv(Phase phase, int subdiv, int src_rank,
+                                       int dst_rank, Tensor* dst_tensor,
+                                       const StatusCallback& done) {
+  string recv_buf_key =
+      ReduceBufKey(col_ctx_->exec_key, phase, subdiv, src_rank, dst_rank);
+  int src_idx =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv][src_rank];
+  VLOG(3) << "DispatchRecv " << recv_buf_key << " from_device "
+          << col_params_->group.members[src_idx].device.name() << " to_device "
+          << col_ctx_->device_name << " subdiv=" << subdiv
+          << " src_rank=" << src_rank << " src_idx=" << src_idx;
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_idx].device.name(),
+      col_params_->group.members[src_idx].task,
+      col_params_->group.members[src_idx].is_local, recv_buf_key,
+      col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->device_locality, 0 /*stream_index*/,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,100 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical tree-algorithm implementation of collective all-reduce.
+//
+// The devices of each task first reduce their values to the first device of
+// the task, the task leader.  The task leaders then reduce the per-task values
+// to the leader of the first task, which applies the final op and broadcasts
+// the result back to the other leaders, which in turn broadcast it to the
+// devices of their task.  Each of these steps is a binary tree, so an
+// all-reduce takes O(log(#tasks) + log(#devices per task)) sequential
+// transfers, rather than the O(#devices) transfers of a flat ring.  This makes
+// it a good fit for small and medium tensors across many tasks, while
+// `RingReducer` remains the better choice for large tensors.
+//
+// It is selected with the communication hint "hierarchical".
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  // Establishes the same subdivs as `HierarchicalTreeBroadcaster`: if all
+  // devices are on one task, a single subdiv comprising all devices.
+  // Otherwise n+1 subdivs for n tasks, where the first subdiv comprises the
+  // first device of each task and subdiv i+1 comprises the devices of task i.
+  // Same as `HierarchicalTreeBroadcaster`, devices must be sorted so that all
+  // devices of a task are adjacent, which the param resolvers guarantee.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins async execution of the hierarchical all-reduce.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+  // Populates `children` with the ranks from which the device at `rank`
+  // receives values to reduce, and to which it broadcasts the result, in a
+  // binary tree of `num_ranks` devices rooted at rank 0.
+  static void TreeChildren(int rank, int num_ranks, std::vector<int>* children);
+
+ private:
+  enum Phase { kReduce = 0, kBroadcast = 1 };
+
+  // Reduces the values of the devices of `subdiv` into the output of its rank
+  // 0 device.
+  Status ReduceToRoot(int subdiv);
+
+  // Broadcasts the output of the rank 0 device of `subdiv` to the outputs of
+  // the other devices of `subdiv`.
+  Status BroadcastFromRoot(int subdiv);
+
+  // Applies the final op, if any, to the output.
+  Status Finalize();
+
+  // Sends `src_tensor` asynchronously from this device to device at
+  // `dst_rank` in `subdiv`.  Calls `done` upon completion.
+  void DispatchSend(Phase phase, int subdiv, int dst_rank, int src_rank,
+                    const Tensor* src_tensor, const StatusCallback& done);
+
+  // Receives a tensor into the memory buffer owned by `dst_tensor` at this
+  // device from device at `src_rank` in `subdiv`.  Calls `done` upon
+  // completion.
+  void DispatchRecv(Phase phase, int subdiv, int src_rank, int dst_rank,
+                    Tensor* dst_tensor, const StatusCallback& done);
+
+  // Executes the hierarchical all-reduce defined by this op.
+  Status RunReduce();
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  StatusCallback done_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
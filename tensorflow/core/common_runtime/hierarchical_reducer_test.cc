@@ -0,0 +1,204 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinaryKernel(const string& op, DataType dtype,
+                                          const DeviceType& device_type,
+                                          DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("binary_node", op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, DataType dtype, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(dtype, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "HierarchicalReduce",
+                                 REDUCTION_COLLECTIVE, dtype, shape);
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_))
+          << "Couldn't find device " << dev_name
+          << " existing devices: " << test_env_->device_mgr->DebugString();
+      merge_op_ =
+          GetBinaryKernel("Add", dtype, test_env_->device_type, device_);
+      final_op_ =
+          GetBinaryKernel("Div", dtype, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  void RunTest(int num_workers, int num_devices, int tensor_len,
+               int fail_after) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    test_env_->remote_access->set_fail_after(fail_after);
+    const int group_size = num_workers * num_devices;
+    std::vector<float> expected(tensor_len);
+    for (int rank = 0; rank < group_size; ++rank) {
+      instances_.push_back(std::make_unique<DeviceInstance>(
+          rank, DT_FLOAT, TensorShape({tensor_len}), test_env_.get()));
+      auto flat = instances_.back()->tensor_.flat<float>();
+      for (int i = 0; i < tensor_len; ++i) {
+        flat(i) = rank * 10 + i;
+        expected[i] += flat(i);
+      }
+    }
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= group_size;
+    }
+
+    std::atomic<int> done(0);
+    for (auto& instance : instances_) {
+      SchedClosure([&instance, &done] {
+        instance->DoReduce();
+        ++done;
+      });
+    }
+    while (done < group_size) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+
+    for (auto& instance : instances_) {
+      if (fail_after > 0) {
+        EXPECT_NE(instance->status_.message().find("Deliberate failure"),
+                  string::npos)
+            << instance->status_;
+      } else {
+        TF_EXPECT_OK(instance->status_);
+        test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                       instance->tensor_);
+      }
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalReducerTest, OneWorker) { RunTest(1, 4, 1001, 0); }
+
+TEST_F(HierarchicalReducerTest, OneDevicePerWorker) { RunTest(4, 1, 16, 0); }
+
+TEST_F(HierarchicalReducerTest, MultipleWorkers) { RunTest(3, 4, 1001, 0); }
+
+TEST_F(HierarchicalReducerTest, UnevenTrees) { RunTest(5, 3, 4096, 0); }
+
+TEST_F(HierarchicalReducerTest, Abort) { RunTest(2, 4, 1001, 3); }
+
+TEST(HierarchicalReducerInitParamsTest, OneWorker) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/1,
+                                          /*num_devices_per_worker=*/3,
+                                          DEVICE_CPU);
+  auto cp = CreateCollectiveParams(*test_env, /*rank=*/1,
+                                   "HierarchicalReduce", REDUCTION_COLLECTIVE,
+                                   DT_FLOAT, TensorShape({5}));
+  cp->instance.impl_details.subdiv_permutations.clear();
+  cp->subdiv_rank.clear();
+  core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer());
+  TF_ASSERT_OK(reducer->InitializeCollectiveParams(cp.get()));
+  EXPECT_EQ(cp->instance.impl_details.subdiv_permutations,
+            std::vector<std::vector<int>>({{0, 1, 2}}));
+  EXPECT_EQ(cp->subdiv_rank, std::vector<int>({1}));
+}
+
+TEST(HierarchicalReducerInitParamsTest, MultipleWorkers) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/3,
+                                          /*num_devices_per_worker=*/2,
+                                          DEVICE_CPU);
+  for (int rank : {2, 5}) {
+    auto cp = CreateCollectiveParams(*test_env, rank, "HierarchicalReduce",
+                                     REDUCTION_COLLECTIVE, DT_FLOAT,
+                                     TensorShape({5}));
+    cp->instance.impl_details.subdiv_permutations.clear();
+    cp->subdiv_rank.clear();
+    core::RefCountPtr<HierarchicalReducer> reducer(new HierarchicalReducer());
+    TF_ASSERT_OK(reducer->InitializeCollectiveParams(cp.get()));
+    std::vector<std::vector<int>> expected_perms = {
+        {0, 2, 4}, {0, 1}, {2, 3}, {4, 5}};
+    EXPECT_EQ(cp->instance.impl_details.subdiv_permutations, expected_perms);
+    if (rank == 2) {
+      // The leader of the second task.
+      EXPECT_EQ(cp->subdiv_rank, std::vector<int>({1, -1, 0, -1}));
+    } else {
+      EXPECT_EQ(cp->subdiv_rank, std::vector<int>({-1, -1, -1, 1}));
+    }
+  }
+}
+
+TEST(HierarchicalReducerTreeTest, TreeChildren) {
+  std::vector<int> children;
+  HierarchicalReducer::TreeChildren(0, 5, &children);
+  EXPECT_EQ(children, std::vector<int>({1, 2}));
+  HierarchicalReducer::TreeChildren(1, 5, &children);
+  EXPECT_EQ(children, std::vector<int>({3, 4}));
+  HierarchicalReducer::TreeChildren(2, 5, &children);
+  EXPECT_TRUE(children.empty());
+  HierarchicalReducer::TreeChildren(0, 1, &children);
+  EXPECT_TRUE(children.empty());
+}
+
+}  // namespace
+}  // namespace tensorflow
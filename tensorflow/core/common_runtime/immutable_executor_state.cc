@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -31,6 +32,48 @@ namespace {
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
+
+// Outputs whose consumers are all within this many nodes of the producer, in
+// topological order, are considered short-lived.
+constexpr int kMaxShortLivedOutputDistance = 64;
+
+// Returns true if `dst` may keep the tensor it receives on `dst_input` alive
+// after the step, by storing it in the variable, queue or other resource that
+// its first input refers to (e.g. `AssignVariableOp` or `QueueEnqueueV2`).
+bool MayStoreInput(const Node* dst, int dst_input) {
+  if (dst_input == 0 || !dst->op_def().is_stateful()) return false;
+  const DataType resource_type = dst->input_type(0);
+  return resource_type == DT_RESOURCE || IsRefType(resource_type);
+}
+
+// Returns the lifetime of each output of `n`, given the position of each node
+// in a topological order of the graph. An output is long-lived if it is
+// consumed far from its producer (e.g. a forward activation that is consumed
+// by its gradient), or if it leaves the frame or the graph, since it may then
+// be kept alive by a later iteration or by the caller. It is persistent if it
+// is returned to the caller or may be stored in a resource.
+std::unique_ptr<AllocationLifetime[]> GetOutputLifetimes(
+    const Node* n, const std::vector<int>& topological_position) {
+  std::unique_ptr<AllocationLifetime[]> lifetimes(
+      new AllocationLifetime[n->num_outputs()]);
+  std::fill(&lifetimes[0], &lifetimes[n->num_outputs()],
+            AllocationLifetime::kShort);
+  const int position = topological_position[n->id()];
+  for (const Edge* e : n->out_edges()) {
+    if (e->IsControlEdge()) continue;
+    const Node* dst = e->dst();
+    if (dst->IsRetval() || MayStoreInput(dst, e->dst_input())) {
+      lifetimes[e->src_output()] = AllocationLifetime::kPersistent;
+    } else if (lifetimes[e->src_output()] == AllocationLifetime::kShort &&
+               (IsEnter(dst) || IsExit(dst) || IsNextIteration(dst) ||
+                IsTransferNode(dst) ||
+                topological_position[dst->id()] - position >
+                    kMaxShortLivedOutputDistance)) {
+      lifetimes[e->src_output()] = AllocationLifetime::kLong;
+    }
+  }
+  return lifetimes;
+}
 }  // namespace
 
 ImmutableExecutorState::~ImmutableExecutorState() {
@@ -96,6 +139,17 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
 
   pending_ids_.resize(gview_.num_nodes());
 
+  // The position of each node in a topological order of the graph, which is
+  // used to estimate how long the outputs of each node stay live.
+  std::vector<int> topological_position(graph.num_node_ids(), 0);
+  {
+    std::vector<Node*> order;
+    GetReversePostOrder(graph, &order);
+    for (int i = 0; i < order.size(); ++i) {
+      topological_position[order[i]->id()] = i;
+    }
+  }
+
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
@@ -240,6 +294,35 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
       }
       item->outputs_required = std::move(outputs_required);
     }
+
+    // Record which outputs are returned directly by a `_Retval` node, so that
+    // they can be written into buffers provided by the caller. Only nodes
+    // outside of loops are eligible, since they run at most once per step.
+    if (frame_info == root_frame_info_ && !n->IsArg()) {
+      std::unique_ptr<int[]> output_retval_index;
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() || !e->dst()->IsRetval() ||
+            IsRefType(n->output_type(e->src_output()))) {
+          continue;
+        }
+        int retval_index;
+        TF_RETURN_IF_ERROR(
+            GetNodeAttr(e->dst()->attrs(), "index", &retval_index));
+        if (!output_retval_index) {
+          output_retval_index.reset(new int[n->num_outputs()]);
+          std::fill(&output_retval_index[0],
+                    &output_retval_index[n->num_outputs()], -1);
+        }
+        if (output_retval_index[e->src_output()] < 0) {
+          output_retval_index[e->src_output()] = retval_index;
+        }
+      }
+      item->output_retval_index = std::move(output_retval_index);
+    }
+
+    if (n->num_outputs() > 0) {
+      item->output_lifetime = GetOutputLifetimes(n, topological_position);
+    }
   }
 
   // Rewrite each `EdgeInfo::input_slot` member to refer directly to the input
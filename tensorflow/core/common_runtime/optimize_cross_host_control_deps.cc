@@ -16,12 +16,21 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/optimize_cross_host_control_deps.h"
 
 #include <algorithm>
+#include <map>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/strcat.h"
 
@@ -65,6 +74,42 @@ Status BuildIdentityNNode(const Node& source, StringPiece name,
   return OkStatus();
 }
 
+Status BuildNodeOnDevice(NodeDefBuilder& builder, const string& device,
+                         Graph* graph, Node** node) {
+  if (!device.empty()) {
+    builder.Device(device);
+  }
+  NodeDef def;
+  TF_RETURN_IF_ERROR(builder.Finalize(&def));
+
+  TF_ASSIGN_OR_RETURN(*node, graph->AddNode(def));
+  if (!device.empty()) {
+    (*node)->set_assigned_device_name(device);
+  }
+  return OkStatus();
+}
+
+Status BuildConstNode(const Node& source, StringPiece name,
+                      const string& device, const Tensor& value, Graph* graph,
+                      Node** node) {
+  NodeDefBuilder builder(name, "Const", NodeDebugInfo(source));
+  builder.Attr("dtype", value.dtype()).Attr("value", value);
+  return BuildNodeOnDevice(builder, device, graph, node);
+}
+
+// Adds a `Reshape` of output `src_output` of `src` to `shape`.
+Status BuildReshapeNode(const Node& source, StringPiece name,
+                        const string& device, Node* src, int src_output,
+                        Node* shape, Graph* graph, Node** node) {
+  NodeDefBuilder builder(name, "Reshape", NodeDebugInfo(source));
+  builder.Input(src->name(), src_output, src->output_type(src_output))
+      .Input(shape->name(), 0, DT_INT32);
+  TF_RETURN_IF_ERROR(BuildNodeOnDevice(builder, device, graph, node));
+  graph->AddEdge(src, src_output, *node, 0);
+  graph->AddEdge(shape, 0, *node, 1);
+  return OkStatus();
+}
+
 const string& RequestedOrAssignedDevice(const Node* n) {
   if (!n->assigned_device_name().empty()) {
     return n->assigned_device_name();
@@ -325,4 +370,217 @@ Status OptimizeCrossHostControlInputEdges(Graph* graph,
   return OkStatus();
 }
 
+namespace {
+
+// A small tensor sent to another host, and the edges that consume it there.
+struct CrossHostTensor {
+  Node* src;
+  int src_output;
+  TensorShape shape;
+  std::vector<const Edge*> edges;
+};
+
+// Returns the nodes of `graph` that transitively depend only on nodes in their
+// own address space, and are neither control flow nor in a loop.
+absl::flat_hash_set<const Node*> FindHostLocalNodes(
+    const std::vector<Node*>& order, DeviceLookup& lookup) {
+  absl::flat_hash_set<const Node*> host_local;
+  for (Node* n : order) {
+    if (!n->IsOp() || n->IsControlFlow()) continue;
+    const int device_id = lookup.NodeToDeviceId(n);
+    bool is_host_local = true;
+    for (const Edge* edge : n->in_edges()) {
+      const Node* src = edge->src();
+      if (src->IsSource()) continue;
+      if (!host_local.contains(src) ||
+          !lookup.IsSameAddressSpace(lookup.NodeToDeviceId(src), device_id)) {
+        is_host_local = false;
+        break;
+      }
+    }
+    if (is_host_local) host_local.insert(n);
+  }
+  return host_local;
+}
+
+// Replaces the edges of `tensors`, sent from `src_device` to `dst_device`, by
+// one transfer of their concatenation.
+Status PackTensors(const std::vector<CrossHostTensor>& tensors,
+                   const string& src_device, const string& dst_device,
+                   Graph* graph) {
+  const Node& source = *tensors[0].src;
+  const DataType dtype = source.output_type(tensors[0].src_output);
+  const int num_tensors = tensors.size();
+  const string prefix = graph->NewName("cross_host_pack");
+
+  Tensor flat_shape_value(DT_INT32, TensorShape({1}));
+  flat_shape_value.vec<int32>()(0) = -1;
+  Node* flat_shape;
+  TF_RETURN_IF_ERROR(BuildConstNode(source, strings::StrCat(prefix, "/shape"),
+                                    src_device, flat_shape_value, graph,
+                                    &flat_shape));
+  Tensor axis_value(DT_INT32, TensorShape({}));
+  axis_value.scalar<int32>()() = 0;
+  Node* src_axis;
+  TF_RETURN_IF_ERROR(BuildConstNode(source, strings::StrCat(prefix, "/axis"),
+                                    src_device, axis_value, graph, &src_axis));
+
+  std::vector<Node*> flat_tensors(num_tensors);
+  std::vector<NodeDefBuilder::NodeOut> concat_inputs;
+  concat_inputs.reserve(num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    TF_RETURN_IF_ERROR(BuildReshapeNode(
+        source, strings::StrCat(prefix, "/flat_", i), src_device,
+        tensors[i].src, tensors[i].src_output, flat_shape, graph,
+        &flat_tensors[i]));
+    concat_inputs.emplace_back(flat_tensors[i]->name(), 0, dtype);
+  }
+  Node* packed;
+  {
+    NodeDefBuilder builder(strings::StrCat(prefix, "/packed"), "ConcatV2",
+                           NodeDebugInfo(source));
+    builder.Input(concat_inputs).Input(src_axis->name(), 0, DT_INT32);
+    TF_RETURN_IF_ERROR(BuildNodeOnDevice(builder, src_device, graph, &packed));
+    for (int i = 0; i < num_tensors; ++i) {
+      graph->AddEdge(flat_tensors[i], 0, packed, i);
+    }
+    graph->AddEdge(src_axis, 0, packed, num_tensors);
+  }
+
+  Tensor size_splits_value(DT_INT64, TensorShape({num_tensors}));
+  for (int i = 0; i < num_tensors; ++i) {
+    size_splits_value.vec<int64_t>()(i) = tensors[i].shape.num_elements();
+  }
+  Node* size_splits;
+  TF_RETURN_IF_ERROR(BuildConstNode(
+      source, strings::StrCat(prefix, "/size_splits"), dst_device,
+      size_splits_value, graph, &size_splits));
+  Node* dst_axis;
+  TF_RETURN_IF_ERROR(BuildConstNode(source,
+                                    strings::StrCat(prefix, "/split_axis"),
+                                    dst_device, axis_value, graph, &dst_axis));
+  Node* unpacked;
+  {
+    NodeDefBuilder builder(strings::StrCat(prefix, "/unpacked"), "SplitV",
+                           NodeDebugInfo(source));
+    builder.Input(packed->name(), 0, dtype)
+        .Input(size_splits->name(), 0, DT_INT64)
+        .Input(dst_axis->name(), 0, DT_INT32)
+        .Attr("num_split", num_tensors);
+    TF_RETURN_IF_ERROR(
+        BuildNodeOnDevice(builder, dst_device, graph, &unpacked));
+    graph->AddEdge(packed, 0, unpacked, 0);
+    graph->AddEdge(size_splits, 0, unpacked, 1);
+    graph->AddEdge(dst_axis, 0, unpacked, 2);
+  }
+
+  for (int i = 0; i < num_tensors; ++i) {
+    const TensorShape& shape = tensors[i].shape;
+    Tensor shape_value(DT_INT32, TensorShape({shape.dims()}));
+    for (int d = 0; d < shape.dims(); ++d) {
+      shape_value.vec<int32>()(d) = shape.dim_size(d);
+    }
+    Node* shape_node;
+    TF_RETURN_IF_ERROR(BuildConstNode(source,
+                                      strings::StrCat(prefix, "/shape_", i),
+                                      dst_device, shape_value, graph,
+                                      &shape_node));
+    Node* output;
+    TF_RETURN_IF_ERROR(BuildReshapeNode(
+        source, strings::StrCat(prefix, "/output_", i), dst_device, unpacked,
+        i, shape_node, graph, &output));
+    for (const Edge* edge : tensors[i].edges) {
+      graph->AddEdge(output, 0, edge->dst(), edge->dst_input());
+      graph->RemoveEdge(edge);
+    }
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+Status PackCrossHostDataEdges(Graph* graph, int cross_host_edges_threshold,
+                              int64_t small_tensor_bytes_threshold) {
+  TF_ASSIGN_OR_RETURN(DeviceLookup lookup, DeviceLookup::FromGraph(graph));
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  const absl::flat_hash_set<const Node*> host_local =
+      FindHostLocalNodes(order, lookup);
+  if (host_local.empty()) return OkStatus();
+
+  // Shapes are best effort: the outputs of the nodes whose shape can't be
+  // inferred are not packed.
+  ShapeRefiner refiner(graph->versions(), graph->op_registry());
+  for (Node* n : order) {
+    if (n->IsOp()) refiner.AddNode(n).IgnoreError();
+  }
+
+  // Keyed by source host, destination host and type. Ordered so that the
+  // rewrite does not depend on hashing.
+  std::map<std::tuple<int, int, DataType>, std::vector<CrossHostTensor>>
+      cross_host_tensors;
+  // Index in `cross_host_tensors` of the outputs of a node, keyed by output
+  // and destination host.
+  absl::flat_hash_map<std::pair<int, int>, int> outputs;
+  for (Node* n : order) {
+    if (!host_local.contains(n)) continue;
+    shape_inference::InferenceContext* ctx = refiner.GetContext(n);
+    if (ctx == nullptr) continue;
+    const int src_id = lookup.NodeToDeviceId(n);
+    outputs.clear();
+    for (const Edge* edge : n->out_edges()) {
+      Node* dst = edge->dst();
+      if (edge->IsControlEdge() || dst->IsSink()) continue;
+      const int dst_id = lookup.NodeToDeviceId(dst);
+      if (lookup.IsSameAddressSpace(src_id, dst_id)) continue;
+
+      const int src_output = edge->src_output();
+      const DataType dtype = n->output_type(src_output);
+      if (IsRefType(dtype) || !DataTypeCanUseMemcpy(dtype)) continue;
+      shape_inference::ShapeHandle shape = ctx->output(src_output);
+      if (!ctx->FullyDefined(shape)) continue;
+      TensorShape tensor_shape;
+      for (int d = 0; d < ctx->Rank(shape); ++d) {
+        tensor_shape.AddDim(ctx->Value(ctx->Dim(shape, d)));
+      }
+      if (tensor_shape.num_elements() * DataTypeSize(dtype) >
+          small_tensor_bytes_threshold) {
+        continue;
+      }
+
+      std::vector<CrossHostTensor>& tensors =
+          cross_host_tensors[{src_id, dst_id, dtype}];
+      auto iter = outputs.find({src_output, dst_id});
+      if (iter == outputs.end()) {
+        outputs[{src_output, dst_id}] = tensors.size();
+        tensors.push_back({n, src_output, tensor_shape, {edge}});
+      } else {
+        tensors[iter->second].edges.push_back(edge);
+      }
+    }
+  }
+
+  for (auto& [key, tensors] : cross_host_tensors) {
+    // Packing a single tensor only adds copies.
+    if (tensors.size() < std::max(cross_host_edges_threshold, 2)) {
+      continue;
+    }
+    std::sort(tensors.begin(), tensors.end(),
+              [](const CrossHostTensor& a, const CrossHostTensor& b) {
+                return std::make_pair(a.src->id(), a.src_output) <
+                       std::make_pair(b.src->id(), b.src_output);
+              });
+    const auto& [src_id, dst_id, dtype] = key;
+    VLOG(1) << "Pack cross host data edges, src host device: "
+            << lookup.DeviceIdToName(src_id)
+            << " dst host device: " << lookup.DeviceIdToName(dst_id)
+            << " dtype: " << DataTypeString(dtype)
+            << " tensors size: " << tensors.size();
+    TF_RETURN_IF_ERROR(PackTensors(tensors, lookup.DeviceIdToName(src_id),
+                                   lookup.DeviceIdToName(dst_id), graph));
+  }
+  return OkStatus();
+}
+
 }  // namespace tensorflow
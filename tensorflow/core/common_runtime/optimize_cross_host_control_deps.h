@@ -45,6 +45,19 @@ Status OptimizeCrossHostDataOutputEdges(Graph* graph,
 Status OptimizeCrossHostControlInputEdges(Graph* graph,
                                           int cross_host_edges_threshold);
 
+// Optimize the graph by packing small cross-host data edges.
+// Once we find not less than `cross_host_edges_threshold` small tensors of one
+// type sent from one host to another, we flatten and concatenate them in the
+// source host, and split and reshape them back in the destination host, so
+// that they are transferred as one tensor. A tensor is small if its shape is
+// statically known and it has at most `small_tensor_bytes_threshold` bytes,
+// i.e. if the latency of its own transfer would outweigh the cost of the
+// copies. Only the outputs of nodes that transitively depend on nothing but
+// nodes in their own host, outside of control flow, are packed, so the packing
+// cannot add a cycle or mix tensors from different frames.
+Status PackCrossHostDataEdges(Graph* graph, int cross_host_edges_threshold,
+                              int64_t small_tensor_bytes_threshold);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZE_CROSS_HOST_CONTROL_DEPS_H_
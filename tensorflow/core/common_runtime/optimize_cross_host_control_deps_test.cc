@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/graph_to_functiondef.h"
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -142,6 +143,95 @@ TEST(OptimizeCrossHostControlDepsTest, OptimizeCrossHostDataOutputEdges) {
   EXPECT_EQ(map["e"]->input(0), data_after2->name() + ":1");
 }
 
+TEST(OptimizeCrossHostControlDepsTest, PackCrossHostDataEdges) {
+  const string host0 = "/job:worker/task:0/CPU:0";
+  const string host1 = "/job:worker/task:1/CPU:0";
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  auto x = ops::Const(scope.WithOpName("x"), {{1.0f, 2.0f, 3.0f}});
+  x.node()->set_assigned_device_name(host0);
+  auto y = ops::Const(scope.WithOpName("y"), 4.0f);
+  y.node()->set_assigned_device_name(host0);
+  // Too large to be packed.
+  auto large = ops::Const(scope.WithOpName("large"), 0.0f, {100});
+  large.node()->set_assigned_device_name(host0);
+  // The only int32 tensor sent to host1.
+  auto z = ops::Const(scope.WithOpName("z"), {1, 2});
+  z.node()->set_assigned_device_name(host0);
+  // Depends on host1, so it can't be packed without risking a cycle.
+  auto w0 = ops::Const(scope.WithOpName("w0"), 5.0f);
+  w0.node()->set_assigned_device_name(host1);
+  auto w = ops::Identity(scope.WithOpName("w"), w0);
+  w.node()->set_assigned_device_name(host0);
+
+  auto b = ops::Identity(scope.WithOpName("b"), x);
+  b.node()->set_assigned_device_name(host1);
+  auto c = ops::Identity(scope.WithOpName("c"), y);
+  c.node()->set_assigned_device_name(host1);
+  auto d = ops::Identity(scope.WithOpName("d"), y);
+  d.node()->set_assigned_device_name("/job:worker/task:1/CPU:1");
+  auto e = ops::Identity(scope.WithOpName("e"), large);
+  e.node()->set_assigned_device_name(host1);
+  auto f = ops::Identity(scope.WithOpName("f"), z);
+  f.node()->set_assigned_device_name(host1);
+  auto g = ops::Identity(scope.WithOpName("g"), w);
+  g.node()->set_assigned_device_name(host1);
+
+  Graph graph(OpRegistry::Global());
+  TF_ASSERT_OK(scope.ToGraph(&graph));
+  const int num_op_nodes = graph.num_op_nodes();
+
+  // No optimizations if the cross_host_edges_threshold is set too high.
+  TF_ASSERT_OK(PackCrossHostDataEdges(&graph,
+                                      /*cross_host_edges_threshold=*/3,
+                                      /*small_tensor_bytes_threshold=*/64));
+  ASSERT_EQ(graph.num_op_nodes(), num_op_nodes);
+
+  TF_ASSERT_OK(PackCrossHostDataEdges(&graph,
+                                      /*cross_host_edges_threshold=*/2,
+                                      /*small_tensor_bytes_threshold=*/64));
+  // Two consts, two reshapes and the concat on host0, and four consts, the
+  // split and two reshapes on host1.
+  ASSERT_EQ(graph.num_op_nodes(), num_op_nodes + 12);
+
+  Node* packed = GetNodeByName("cross_host_pack/_0/packed", &graph);
+  ASSERT_NE(packed, nullptr);
+  EXPECT_EQ(packed->op_def().name(), "ConcatV2");
+  EXPECT_EQ(packed->assigned_device_name(), "/job:worker/task:0/device:CPU:0");
+  Node* unpacked = GetNodeByName("cross_host_pack/_0/unpacked", &graph);
+  ASSERT_NE(unpacked, nullptr);
+  EXPECT_EQ(unpacked->op_def().name(), "SplitV");
+  EXPECT_EQ(unpacked->assigned_device_name(),
+            "/job:worker/task:1/device:CPU:0");
+
+  GraphDef graph_def;
+  graph.ToGraphDef(&graph_def);
+  std::unordered_map<string, const NodeDef*> map;
+  for (auto& node : graph_def.node()) {
+    map[node.name()] = &node;
+  }
+  EXPECT_EQ(map["cross_host_pack/_0/flat_0"]->input(0), "x");
+  EXPECT_EQ(map["cross_host_pack/_0/flat_1"]->input(0), "y");
+  EXPECT_EQ(map["cross_host_pack/_0/output_1"]->input(0),
+            "cross_host_pack/_0/unpacked:1");
+  EXPECT_EQ(map["b"]->input(0), "cross_host_pack/_0/output_0");
+  EXPECT_EQ(map["c"]->input(0), "cross_host_pack/_0/output_1");
+  EXPECT_EQ(map["d"]->input(0), "cross_host_pack/_0/output_1");
+  EXPECT_EQ(map["e"]->input(0), "large");
+  EXPECT_EQ(map["f"]->input(0), "z");
+  EXPECT_EQ(map["g"]->input(0), "w");
+
+  Tensor shape;
+  ASSERT_TRUE(
+      shape.FromProto(map["cross_host_pack/_0/shape_0"]->attr().at("value")
+                          .tensor()));
+  test::ExpectTensorEqual<int32>(shape, test::AsTensor<int32>({1, 3}));
+  Tensor size_splits;
+  ASSERT_TRUE(size_splits.FromProto(
+      map["cross_host_pack/_0/size_splits"]->attr().at("value").tensor()));
+  test::ExpectTensorEqual<int64_t>(size_splits,
+                                   test::AsTensor<int64_t>({3, 1}));
+}
+
 TEST(OptimizeCrossHostControlDepsTest, OptimizeCrossHostControlInputEdges) {
   tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
   auto a = ops::Const(scope.WithOpName("a"), 1.0f);
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdlib>
+#include <deque>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -24,8 +25,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
@@ -36,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_utils.h"
 #include "tensorflow/core/common_runtime/local_device.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/common_runtime/optimize_cross_host_control_deps.h"
 #include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
 #include "tensorflow/core/common_runtime/partitioning_utils.h"
 #include "tensorflow/core/common_runtime/placer.h"
@@ -47,9 +51,13 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/debug_data_dumper.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/host_info.h"
@@ -59,6 +67,22 @@ limitations under the License.
 
 namespace tensorflow {
 namespace {
+// The minimum number of small tensors sent from one host to another for them
+// to be packed into one transfer.
+constexpr int kPackCrossHostDataEdgesThreshold = 2;
+
+// Returns the size in bytes at or under which tensors sent to another host are
+// packed with the others sent there, or 0 if they are not packed.
+int64_t PackCrossHostDataEdgesBytesThreshold() {
+  static const int64_t threshold = [] {
+    int64_t threshold;
+    TF_CHECK_OK(ReadInt64FromEnvVar(
+        "TF_PACK_CROSS_HOST_DATA_EDGES_BYTES_THRESHOLD", 0, &threshold));
+    return threshold;
+  }();
+  return threshold;
+}
+
 Status ValidateNoListArguments(
     const protobuf::RepeatedPtrField<OpDef::ArgDef>& args, const char* arg_type,
     const string& function_name) {
@@ -296,6 +320,102 @@ Status GetGraphAndArgRets(const string& function_name, AttrSlice attrs,
   }
   return OkStatus();
 }
+
+// Returns the maximum number of optimized function graphs kept in the process
+// wide in-memory cache, or 0 if the cache is disabled.
+int64_t GraphMemoryCacheSize() {
+  static const int64_t size = [] {
+    int64_t size;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar(kGraphMemoryCacheSizeEnvVariableName, 0, &size));
+    return std::max<int64_t>(size, 0);
+  }();
+  return size;
+}
+
+// A bounded cache of optimized function graphs, shared by all the function
+// library runtimes of the process. The graphs are kept as protos, so that each
+// hit gets its own copy to partition and rewrite. The oldest entry is evicted
+// once the cache is full.
+class OptimizedFunctionGraphMemoryCache {
+ public:
+  static OptimizedFunctionGraphMemoryCache* Global() {
+    static OptimizedFunctionGraphMemoryCache* cache =
+        new OptimizedFunctionGraphMemoryCache;
+    return cache;
+  }
+
+  std::shared_ptr<const OptimizedFunctionGraph> Lookup(const string& key) {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    return it == entries_.end() ? nullptr : it->second;
+  }
+
+  void Insert(const string& key, OptimizedFunctionGraph graph,
+              int64_t capacity) {
+    auto entry =
+        std::make_shared<const OptimizedFunctionGraph>(std::move(graph));
+    mutex_lock l(mu_);
+    if (!entries_.emplace(key, std::move(entry)).second) return;
+    insertion_order_.push_back(key);
+    while (static_cast<int64_t>(insertion_order_.size()) > capacity) {
+      entries_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
+    }
+  }
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<string, std::shared_ptr<const OptimizedFunctionGraph>>
+      entries_ TF_GUARDED_BY(mu_);
+  std::deque<string> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the key of the optimized graph of `function_name` in the in-memory
+// cache. Besides the attributes and options that identify the instantiation,
+// it covers the definitions the function reaches, so that redefining a
+// function never hits a stale entry, and the devices the graph is placed on.
+string GetMemoryCacheKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition& lib_def,
+    const FunctionDef& fdef, Device* cpu_device, Device* default_device) {
+  // The library and the state are identified by content and left out of the
+  // canonical name, which would otherwise tie the entry to a single runtime.
+  FunctionLibraryRuntime::InstantiateOptions canonical_options = options;
+  canonical_options.lib_def = nullptr;
+  canonical_options.state_handle.clear();
+  string key = Canonicalize(function_name, attrs, canonical_options);
+
+  FunctionDefLibrary library = lib_def.ReachableDefinitions(fdef).ToProto();
+  *library.add_function() = fdef;
+  string serialized_library;
+  SerializeToStringDeterministic(library, &serialized_library);
+  const Fprint128 library_fingerprint = Fingerprint128(serialized_library);
+  absl::StrAppend(&key, "|lib=", library_fingerprint.high64, ":",
+                  library_fingerprint.low64);
+
+  absl::StrAppend(&key, "|xla=", options.xla_compile_device_type,
+                  "|soft=", options.allow_soft_placement,
+                  "|int_on_dev=", options.int_args_and_retvals_on_device,
+                  "|to_target=", options.default_device_to_target,
+                  "|shape_inference=",
+                  options.shape_inference_on_tfe_dialect_import);
+  if (options.ret_indices.has_value()) {
+    absl::StrAppend(&key, "|ret=", absl::StrJoin(*options.ret_indices, ","));
+  }
+
+  std::vector<string> devices;
+  devices.reserve(dev_set.devices().size());
+  for (const Device* device : dev_set.devices()) {
+    devices.push_back(absl::StrCat(device->name(), "=", device->device_type()));
+  }
+  std::sort(devices.begin(), devices.end());
+  absl::StrAppend(&key, "|devices=", absl::StrJoin(devices, ","),
+                  "|cpu=", cpu_device ? cpu_device->name() : "",
+                  "|default=", default_device ? default_device->name() : "");
+  return key;
+}
 }  // namespace
 
 Status PinArgsAndRets(const std::vector<string>& input_devices,
@@ -765,6 +885,66 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
   return optimized_function_graph_info;
 }
 
+StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env) {
+  const int64_t cache_size = GraphMemoryCacheSize();
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? input_lib_def : options.lib_def;
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  // Functions whose optimization depends on state outside of the key (a
+  // caller provided optimization function, a graph collector or the composite
+  // devices of the runtime) are not cached.
+  if (cache_size == 0 || fdef == nullptr || options.is_component_function ||
+      options.optimize_graph_fn || options.graph_collector != nullptr ||
+      !composite_devices.empty()) {
+    return OptimizeFunctionGraphOrReadFromFileCache(
+        function_name, attrs, options, dev_set, input_lib_def,
+        composite_devices, cpu_device, default_device, env);
+  }
+
+  const string key =
+      GetMemoryCacheKey(function_name, attrs, options, dev_set, *lib_def,
+                        *fdef, cpu_device, default_device);
+  OptimizedFunctionGraphMemoryCache* cache =
+      OptimizedFunctionGraphMemoryCache::Global();
+  if (std::shared_ptr<const OptimizedFunctionGraph> cached =
+          cache->Lookup(key)) {
+    StatusOr<OptimizedFunctionGraphInfo> optimized_function_graph_info =
+        OptimizedFunctionGraphInfo::FromProto(*cached);
+    if (optimized_function_graph_info.ok()) {
+      metrics::UpdateFunctionGraphOptimizationSavingTime(
+          optimized_function_graph_info->optimization_duration_usecs,
+          metrics::GraphOptimizationSource::kJit);
+      metrics::IncrementFunctionGraphOptimizationCacheHitCount(
+          1, metrics::GraphOptimizationSource::kJit);
+      VLOG(3) << "Restored the optimized graph of function " << function_name
+              << " from the in-memory cache.";
+      return optimized_function_graph_info;
+    }
+    metrics::IncrementFunctionGraphOptimizationCacheFailureCount(
+        1, metrics::GraphOptimizationSource::kJit);
+    LOG(ERROR) << "Restoring the optimized graph of function " << function_name
+               << " from the in-memory cache failed; running the graph "
+                  "optimization passes instead. Error: "
+               << optimized_function_graph_info.status();
+  }
+
+  TF_ASSIGN_OR_RETURN(
+      OptimizedFunctionGraphInfo optimized_function_graph_info,
+      OptimizeFunctionGraphOrReadFromFileCache(
+          function_name, attrs, options, dev_set, input_lib_def,
+          composite_devices, cpu_device, default_device, env));
+  cache->Insert(key,
+                OptimizedFunctionGraphInfo::ToProto(
+                    optimized_function_graph_info),
+                cache_size);
+  return optimized_function_graph_info;
+}
+
 StatusOr<std::unique_ptr<std::unordered_map<string, std::unique_ptr<Graph>>>>
 PreprocessAndPartitionGraph(
     const std::string& function_name,
@@ -783,6 +963,14 @@ PreprocessAndPartitionGraph(
   TF_RETURN_IF_ERROR(ReplicatePerReplicaNodesInFunctionGraph(
       options.composite_devices, graph.get()));
 
+  // Pack the small tensors sent between hosts, so that each pair of hosts
+  // exchanges fewer, larger tensors.
+  if (PackCrossHostDataEdgesBytesThreshold() > 0) {
+    TF_RETURN_IF_ERROR(PackCrossHostDataEdges(
+        graph.get(), kPackCrossHostDataEdgesThreshold,
+        PackCrossHostDataEdgesBytesThreshold()));
+  }
+
   const FunctionLibraryDefinition* lib_def =
       options.lib_def == nullptr ? input_lib_def : options.lib_def;
   if (options.graph_collector != nullptr) {
@@ -38,6 +38,11 @@ static const char kGraphCachingEnvVariableName[] = "TF_GRAPH_CACHING";
 // The threshold of the graph optimization duration to be cached.
 // Note: setting this threshold to 0 means to cache for every function.
 constexpr absl::Duration kCachingThresholdDuration = absl::Seconds(3);
+// The name of the env variable for the number of optimized function graphs
+// kept in memory and shared by all the function library runtimes of the
+// process. Note: the in-memory cache is disabled if it is unset or 0.
+static const char kGraphMemoryCacheSizeEnvVariableName[] =
+    "TF_GRAPH_MEMORY_CACHE_SIZE";
 
 // TODO(iga): Reword
 // Pins each arg that emits a `DT_RESOURCE` tensor to the device on which the
@@ -75,6 +80,18 @@ StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromFileCache(
     Device* default_device, Env* env,
     absl::Duration caching_threshold_duration = kCachingThresholdDuration);
 
+// Same as OptimizeFunctionGraphOrReadFromFileCache, but first looks up the
+// optimization results in a process wide in-memory cache, keyed by the
+// canonical instantiation of the function, the definitions it reaches and the
+// device set, and adds them to it on a miss. Each call returns its own copy of
+// the results.
+StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const DeviceSet& dev_set, const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env);
+
 // Pre-processes, partitions and post-optimizes the input graph; returns
 // subgraph result (maps from device name to the subgraph); returns error if any
 // optimization or partitioning step fails.
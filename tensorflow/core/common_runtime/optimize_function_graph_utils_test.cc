@@ -245,5 +245,72 @@ TEST(OptimizeFunctionGraphTest, OptimizeFunctionGraphAndWriteToCache) {
   ASSERT_TRUE(empty_file_list.empty());
 }
 
+TEST(OptimizeFunctionGraphTest, ReadFromMemoryCacheAcrossLibraries) {
+  unsetenv(kGraphCachingEnvVariableName);
+  setenv(kGraphMemoryCacheSizeEnvVariableName, "8", 1);
+
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  std::vector<std::unique_ptr<Device>> devices;
+  CreateCpuDeviceList(kDevicePrefix, 2, devices);
+  DeviceSet device_set;
+  for (const auto& device : devices) {
+    device_set.AddDevice(device.get());
+  }
+
+  // Two libraries with the same definitions, as owned by two runtimes.
+  FunctionDefLibrary proto;
+  *(proto.add_function()) = test::function::FindDevice();
+  auto first_lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+  auto second_lib_def =
+      std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(), proto);
+
+  const int64_t hit_count = metrics::GetFunctionGraphOptimizationCacheHitCount(
+      metrics::GraphOptimizationSource::kJit);
+  StatusOr<OptimizedFunctionGraphInfo> first_info =
+      OptimizeFunctionGraphOrReadFromCache(
+          "FindDevice", {}, opts, device_set, first_lib_def.get(),
+          /*composite_devices=*/{}, devices[0].get(), devices[1].get(),
+          Env::Default());
+  TF_ASSERT_OK(first_info.status());
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hit_count);
+
+  StatusOr<OptimizedFunctionGraphInfo> second_info =
+      OptimizeFunctionGraphOrReadFromCache(
+          "FindDevice", {}, opts, device_set, second_lib_def.get(),
+          /*composite_devices=*/{}, devices[0].get(), devices[1].get(),
+          Env::Default());
+  TF_ASSERT_OK(second_info.status());
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hit_count + 1);
+  EXPECT_EQ(second_info->name, "FindDevice");
+  EXPECT_EQ(second_info->num_return_nodes, 1);
+  EXPECT_THAT(second_info->ret_types, ElementsAre(DT_STRING));
+  EXPECT_EQ(second_info->function_graph->num_nodes(),
+            first_info->function_graph->num_nodes());
+  EXPECT_NE(second_info->function_graph.get(),
+            first_info->function_graph.get());
+
+  // A different definition under the same name must not hit the cache.
+  FunctionDef redefined = test::function::FindDevice();
+  (*redefined.mutable_attr())["_noinline"].set_b(true);
+  FunctionDefLibrary redefined_proto;
+  *(redefined_proto.add_function()) = redefined;
+  auto redefined_lib_def = std::make_unique<FunctionLibraryDefinition>(
+      OpRegistry::Global(), redefined_proto);
+  TF_ASSERT_OK(OptimizeFunctionGraphOrReadFromCache(
+                   "FindDevice", {}, opts, device_set, redefined_lib_def.get(),
+                   /*composite_devices=*/{}, devices[0].get(),
+                   devices[1].get(), Env::Default())
+                   .status());
+  EXPECT_EQ(metrics::GetFunctionGraphOptimizationCacheHitCount(
+                metrics::GraphOptimizationSource::kJit),
+            hit_count + 1);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -99,6 +99,13 @@ class PendingCounts {
 
   ~PendingCounts() { delete[] bytes_; }
 
+  // Resets the counts to those of "other", which must have the same layout.
+  // REQUIRES: No concurrent accesses to the counts.
+  void CopyFrom(const PendingCounts& other) {
+    DCHECK_EQ(num_bytes_, other.num_bytes_);
+    memcpy(bytes_, other.bytes_, other.num_bytes_);
+  }
+
   void set_initial_count(Handle h, size_t pending_count) {
     if (h.is_large_) {
       std::atomic<LargeCounts>* c_ptr = Large(h);
@@ -550,7 +550,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
 
   StatusOr<OptimizedFunctionGraphInfo> optimized_graph_info =
       optimized_graph_proto == nullptr
-          ? OptimizeFunctionGraphOrReadFromFileCache(
+          ? OptimizeFunctionGraphOrReadFromCache(
                 function_name, attrs, options, *dev_set, lib_def_,
                 composite_devices, cpu_device, default_device, env_)
           : OptimizedFunctionGraphInfo::FromProto(*optimized_graph_proto);
@@ -1555,6 +1555,138 @@ Status ProcessFunctionLibraryRuntime::RunSync(
   return s;
 }
 
+Status ProcessFunctionLibraryRuntime::RunMany(
+    const FunctionLibraryRuntime::Options& opts,
+    FunctionLibraryRuntime::Handle handle,
+    absl::Span<const std::vector<Tensor>> args,
+    std::vector<std::vector<Tensor>>* rets) const {
+  rets->clear();
+  rets->resize(args.size());
+  const MultiDeviceFunctionData* data = IsMultiDevice(handle);
+  bool all_components_local = data != nullptr && !data->has_remote_outputs;
+  if (all_components_local) {
+    for (const auto& pair : data->glue_) {
+      if (GetFLR(pair.first) == nullptr) {
+        all_components_local = false;
+        break;
+      }
+    }
+  }
+  if (!all_components_local) {
+    for (size_t i = 0; i < args.size(); ++i) {
+      TF_RETURN_IF_ERROR(RunSync(opts, handle, args[i], &(*rets)[i]));
+    }
+    return OkStatus();
+  }
+  TF_RETURN_IF_ERROR(PrepareRunMultiDevice(opts, handle, &data));
+  if (args.empty()) return OkStatus();
+
+  FunctionLibraryRuntime::Options new_opts = opts;
+  tsl::core::RefCountPtr<Rendezvous> created_rendezvous = nullptr;
+  if (!new_opts.rendezvous) {
+    TF_RETURN_IF_ERROR(CreateRendezvous(new_opts, &created_rendezvous));
+  }
+  CancellationManager local_cm;
+  if (new_opts.cancellation_manager == nullptr) {
+    new_opts.cancellation_manager = &local_cm;
+  }
+
+  // Resolve the component functions once for all steps.
+  struct Component {
+    explicit Component(const FunctionLibraryRuntime::Options& opts)
+        : opts(opts) {}
+    FunctionLibraryRuntime::Options opts;
+    const ComponentFunctionData* data = nullptr;
+    FunctionLibraryRuntime* flr = nullptr;
+  };
+  std::vector<std::unique_ptr<Component>> components;
+  components.reserve(data->glue_.size());
+  for (const auto& pair : data->glue_) {
+    auto component = std::make_unique<Component>(new_opts);
+    component->data = &pair.second;
+    component->flr = GetFLR(pair.first);
+    component->opts.args_alloc_attrs = pair.second.arg_alloc_attrs;
+    component->opts.rets_alloc_attrs = pair.second.ret_alloc_attrs;
+    component->opts.remote_execution = false;
+    // When target device has private thread pool, use the target device
+    // runner
+    thread::ThreadPool* pool =
+        component->flr->device()->tensorflow_device_thread_pool();
+    component->opts.runner =
+        (pool == nullptr) ? new_opts.runner : component->flr->runner();
+    components.push_back(std::move(component));
+  }
+  for (std::vector<Tensor>& step_rets : *rets) {
+    step_rets.resize(data->num_outputs_);
+  }
+
+  mutex mu;
+  Status status;
+  auto step_failed = [&](const Status& s) {
+    {
+      mutex_lock l(mu);
+      if (!status.ok()) return;
+      status = errors::CreateWithUpdatedMessage(
+          s, strings::StrCat(
+                 errors::FormatFunctionForError(data->function_name_), " ",
+                 s.message()));
+    }
+    // Unblock the component functions that wait for values from this step.
+    new_opts.cancellation_manager->StartCancel();
+    new_opts.rendezvous->StartAbort(s);
+  };
+
+  // Runs the steps of `component` from `step` on, in order. Steps that
+  // complete synchronously are chained in this loop, and otherwise the done
+  // callback of the step continues the chain.
+  BlockingCounter num_running(components.size());
+  std::function<void(Component*, int)> run_steps;
+  run_steps = [&](Component* component, int step) {
+    for (; step < args.size(); ++step) {
+      {
+        mutex_lock l(mu);
+        if (!status.ok()) break;
+      }
+      InternalArgs comp_args;
+      Status s = GetComponentArgs(args[step], *component->data, &comp_args);
+      if (!s.ok()) {
+        step_failed(s);
+        break;
+      }
+      auto* comp_rets = new std::vector<Tensor>;
+      // Set to 1 by whichever of the done callback and this loop finishes
+      // first, and to 2 by the other one, which then continues the chain.
+      auto* finished = new std::atomic<int>(0);
+      component->flr->Run(
+          component->opts, component->data->handle,
+          GetLocalArgs(comp_args.args), comp_rets,
+          [&, component, step, comp_rets, finished](const Status& s) {
+            if (s.ok()) {
+              for (int i = 0; i < comp_rets->size(); ++i) {
+                (*rets)[step][component->data->ret_indices[i]] =
+                    std::move((*comp_rets)[i]);
+              }
+            } else {
+              step_failed(s);
+            }
+            delete comp_rets;
+            if (finished->fetch_add(1) == 1) {
+              delete finished;
+              run_steps(component, step + 1);
+            }
+          });
+      if (finished->fetch_add(1) == 0) return;
+      delete finished;
+    }
+    num_running.DecrementCount();
+  };
+  for (const auto& component : components) {
+    run_steps(component.get(), 0);
+  }
+  num_running.Wait();
+  return status;
+}
+
 void ProcessFunctionLibraryRuntime::Run(
     const FunctionLibraryRuntime::Options& opts,
     FunctionLibraryRuntime::Handle handle, const FunctionArgsInterface& args,
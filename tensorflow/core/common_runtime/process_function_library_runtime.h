@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/device_set.h"
@@ -200,6 +201,22 @@ class ProcessFunctionLibraryRuntime {
                  FunctionLibraryRuntime::Handle handle,
                  CallFrameInterface* frame) const;
 
+  // Runs the function with `handle` once for each element of `args`, and
+  // stores the return values of the i-th step in `(*rets)[i]`, as if by
+  // calling `RunSync()` once per step.
+  //
+  // For multi-device functions whose components are all local, the component
+  // functions are resolved once, all steps share one rendezvous and
+  // cancellation manager, and each component function starts its next step as
+  // soon as it has finished the previous one, so that a step is launched while
+  // the other components of the previous step are still running. The steps
+  // must therefore be independent of each other. If a step fails, the
+  // remaining steps are cancelled and the first error is returned.
+  Status RunMany(const FunctionLibraryRuntime::Options& opts,
+                 FunctionLibraryRuntime::Handle handle,
+                 absl::Span<const std::vector<Tensor>> args,
+                 std::vector<std::vector<Tensor>>* rets) const;
+
   const DeviceMgr* device_mgr() { return device_mgr_; }
 
   const std::shared_ptr<DeviceSet> device_set() const {
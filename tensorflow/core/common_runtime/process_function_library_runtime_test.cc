@@ -872,6 +872,72 @@ TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_EmptyBodySwap) {
   test::ExpectTensorEqual<float>(y2, test::AsTensor<float>({1, 2}));
 }
 
+// Returns a function which computes y0 = x * x on CPU:0, and y1 = y0 + x on
+// CPU:1.
+FunctionDef SquarePlusAcrossDevices() {
+  return FunctionDefHelper::Create(
+      // Name
+      "SquarePlusAcrossDevices",
+      // Args
+      {"x: float"},
+      // Return values
+      {"y0: float", "y1: float"},
+      // Attr def
+      {},
+      // Nodes
+      {
+          {{"square"},
+           "Mul",
+           {"x", "x"},
+           {{"T", DT_FLOAT}},
+           {},
+           "/device:CPU:0"},
+          {{"plus"},
+           "Add",
+           {"square:z:0", "x"},
+           {{"T", DT_FLOAT}},
+           {},
+           "/device:CPU:1"},
+      },
+      {{"y0", "square:z:0"}, {"y1", "plus:z:0"}});
+}
+
+TEST_F(ProcessFunctionLibraryRuntimeTest, MultiDevice_RunMany) {
+  Init({SquarePlusAcrossDevices()});
+  FunctionLibraryRuntime::Handle handle;
+  TF_ASSERT_OK(Instantiate("SquarePlusAcrossDevices", {},
+                           MakeOptions("CPU:0", {"CPU:0"}, {"CPU:0", "CPU:1"}),
+                           &handle));
+
+  std::function<void(std::function<void()>)> runner =
+      [](std::function<void()> fn) {
+        test::function::FunctionTestSchedClosure(fn);
+      };
+  FunctionLibraryRuntime::Options opts;
+  opts.runner = &runner;
+  constexpr int kNumSteps = 8;
+  std::vector<std::vector<Tensor>> args;
+  for (int i = 0; i < kNumSteps; ++i) {
+    args.push_back({test::AsTensor<float>({1.0f * i, 2.0f * i})});
+  }
+  std::vector<std::vector<Tensor>> rets;
+  TF_ASSERT_OK(proc_flr_->RunMany(opts, handle, args, &rets));
+
+  ASSERT_EQ(kNumSteps, rets.size());
+  for (int i = 0; i < kNumSteps; ++i) {
+    ASSERT_EQ(2, rets[i].size());
+    test::ExpectTensorEqual<float>(
+        rets[i][0], test::AsTensor<float>({1.0f * i * i, 4.0f * i * i}));
+    test::ExpectTensorEqual<float>(
+        rets[i][1],
+        test::AsTensor<float>({1.0f * i * i + i, 4.0f * i * i + 2 * i}));
+  }
+
+  // A step with the wrong number of arguments fails the whole batch.
+  args[kNumSteps / 2].clear();
+  EXPECT_FALSE(proc_flr_->RunMany(opts, handle, args, &rets).ok());
+}
+
 Tensor GetResourceHandle(const string& var_name, const string& container,
                          const string& device_name) {
   ResourceHandle handle;
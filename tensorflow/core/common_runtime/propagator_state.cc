@@ -753,8 +753,7 @@ PropagatorState::FrameState::IncrementIteration(TaggedNodeSeq* ready) {
   iteration_count++;
 
   // Initialize the next iteration.
-  IterationState* next_iter =
-      new IterationState(iteration_count, pending_counts, total_input_tensors);
+  IterationState* next_iter = NewIteration(iteration_count);
   SetIteration(iteration_count, next_iter);
   num_outstanding_iterations++;
   {
@@ -775,7 +774,7 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
                                                     TaggedNodeSeq* ready) {
   int64_t curr_iter = iter_state->iter_num;
   while (curr_iter <= iteration_count && IsIterationDone(iter_state)) {
-    delete iter_state;
+    ReleaseIteration(iter_state);
     SetIteration(curr_iter, nullptr);
     --num_outstanding_iterations;
     ++curr_iter;
@@ -798,6 +797,26 @@ bool PropagatorState::FrameState::CleanupIterations(IterationState* iter_state,
   return IsFrameDone();
 }
 
+PropagatorState::IterationState* PropagatorState::FrameState::NewIteration(
+    int64_t iter) {
+  if (free_iterations.empty()) {
+    return new IterationState(iter, pending_counts, total_input_tensors);
+  }
+  IterationState* iter_state = free_iterations.back();
+  free_iterations.pop_back();
+  iter_state->Reset(iter, pending_counts);
+  return iter_state;
+}
+
+void PropagatorState::FrameState::ReleaseIteration(IterationState* iter_state) {
+  if (free_iterations.size() >= static_cast<size_t>(max_parallel_iterations)) {
+    delete iter_state;
+    return;
+  }
+  iter_state->ClearInputs(total_input_tensors);
+  free_iterations.push_back(iter_state);
+}
+
 void PropagatorState::FrameState::InitializeFrameInfo(
     const ImmutableExecutorState::FrameInfo& finfo) {
   pending_counts = finfo.pending_counts.get();
@@ -135,8 +135,25 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64_t
-        iter_num;  // The index of this iteration in the enclosing loop.
+    // Releases the input entries left over by the completed iteration, so
+    // that a recycled state does not hold on to their tensors.
+    void ClearInputs(int total_input_tensors) {
+      for (int i = 0; i < total_input_tensors; ++i) {
+        input_tensors[i].ClearVal();
+      }
+    }
+
+    // Resets the state for the iteration 'iter_num', to recycle the state of
+    // a completed iteration of the same frame. Its inputs must already have
+    // been cleared.
+    void Reset(int64_t iter_num, const PendingCounts* pending_counts) {
+      this->iter_num = iter_num;
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyFrom(*pending_counts);
+    }
+
+    int64_t iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -287,6 +304,12 @@ class PropagatorState {
     IterationState** const iterations_raw TF_GUARDED_BY(mu);
     IterationState* iterations_first TF_GUARDED_BY(mu);
 
+    // The states of the completed iterations of this frame, recycled for its
+    // next iterations instead of allocating new states and pending counts.
+    // No more than max_parallel_iterations are kept, the most that can be
+    // outstanding at once.
+    std::vector<IterationState*> free_iterations TF_GUARDED_BY(mu);
+
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
     // outstanding iterations reaches the limit, we will defer the start of
@@ -404,6 +427,15 @@ class PropagatorState {
     bool CleanupIterations(IterationState* iter_state, TaggedNodeSeq* ready)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
 
+    // Returns the state of the new iteration 'iter', recycled from a completed
+    // iteration if possible.
+    IterationState* NewIteration(int64_t iter) TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
+    // Releases the state of a completed iteration, to be recycled once its
+    // leftover inputs are cleared.
+    void ReleaseIteration(IterationState* iter_state)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu);
+
     void DumpIterationState(PropagatorState* parent) {
       mutex_lock l(mu);
       for (IterationState* iteration : iterations) {
@@ -419,6 +451,9 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      for (IterationState* iter_state : free_iterations) {
+        delete iter_state;
+      }
     }
 
    private:
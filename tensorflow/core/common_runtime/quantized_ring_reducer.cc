@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/quantized_ring_reducer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+namespace {
+// The largest magnitude of a quantized value.
+constexpr float kMaxQuantized = 127.0f;
+
+template <typename T>
+void QuantizeValues(const Tensor& values, Tensor* encoded) {
+  auto flat = values.flat<T>();
+  float max_abs = 0.0f;
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    max_abs = std::max(max_abs, std::abs(static_cast<float>(flat(i))));
+  }
+  const float scale = max_abs / kMaxQuantized;
+  const float inv_scale = scale > 0.0f ? 1.0f / scale : 0.0f;
+  int8* data = encoded->flat<int8>().data();
+  std::memcpy(data, &scale, sizeof(scale));
+  int8* quantized = data + sizeof(scale);
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    const float q = std::round(static_cast<float>(flat(i)) * inv_scale);
+    quantized[i] =
+        static_cast<int8>(std::min(kMaxQuantized, std::max(-kMaxQuantized, q)));
+  }
+}
+
+template <typename T>
+void DequantizeValues(const Tensor& encoded, Tensor* values) {
+  const int8* data = encoded.flat<int8>().data();
+  float scale;
+  std::memcpy(&scale, data, sizeof(scale));
+  const int8* quantized = data + sizeof(scale);
+  auto flat = values->flat<T>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = static_cast<T>(quantized[i] * scale);
+  }
+}
+}  // namespace
+
+Status QuantizedRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "QuantizedRingReduce");
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "QuantizedRingReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  const DataType dtype = col_params->instance.data_type;
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) {
+    return errors::InvalidArgument(
+        "QuantizedRingReduce only supports float and double tensors, got ",
+        DataTypeString(dtype));
+  }
+  return RingAlg::InitializeCollectiveParams(col_params);
+}
+
+/* static */
+int64_t QuantizedRingReducer::EncodedBytes(int64_t num_elements) {
+  return sizeof(float) + num_elements;
+}
+
+/* static */
+void QuantizedRingReducer::Quantize(const Tensor& values, Tensor* encoded) {
+  DCHECK_EQ(encoded->dtype(), DT_INT8);
+  DCHECK_EQ(encoded->NumElements(), EncodedBytes(values.NumElements()));
+  if (values.dtype() == DT_DOUBLE) {
+    QuantizeValues<double>(values, encoded);
+  } else {
+    QuantizeValues<float>(values, encoded);
+  }
+}
+
+/* static */
+void QuantizedRingReducer::Dequantize(const Tensor& encoded, Tensor* values) {
+  DCHECK_EQ(encoded.dtype(), DT_INT8);
+  DCHECK_EQ(encoded.NumElements(), EncodedBytes(values->NumElements()));
+  if (values->dtype() == DT_DOUBLE) {
+    DequantizeValues<double>(encoded, values);
+  } else {
+    DequantizeValues<float>(encoded, values);
+  }
+}
+
+Tensor* QuantizedRingReducer::EncodedBuffer(std::vector<Tensor>* buffers,
+                                            RingField* rf) {
+  if (buffers->size() != rfv_.size()) {
+    buffers->clear();
+    buffers->resize(rfv_.size());
+  }
+  Tensor* buffer = &(*buffers)[rf - rfv_.data()];
+  const int64_t num_bytes = EncodedBytes(rf->chunk.NumElements());
+  if (!buffer->IsInitialized() || buffer->NumElements() != num_bytes) {
+    *buffer = Tensor(
+        col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0)),
+        DT_INT8, TensorShape({num_bytes}));
+  }
+  return buffer;
+}
+
+void QuantizedRingReducer::DispatchSend(RingField* rf,
+                                        const StatusCallback& done) {
+  if (rf->second_pass && rf->do_recv) {
+    // Forward the quantized value as received, rather than quantizing it
+    // again, so that its rounding is the same on all devices.
+    DispatchSendTensor(rf, EncodedBuffer(&recv_buffers_, rf), done);
+    return;
+  }
+  Tensor* encoded = EncodedBuffer(&send_buffers_, rf);
+  Quantize(rf->chunk, encoded);
+  if (rf->second_pass) {
+    // This device computed the final value of the field.  Keep the value the
+    // other devices will receive.
+    Dequantize(*encoded, &rf->chunk);
+  }
+  DispatchSendTensor(rf, encoded, done);
+}
+
+void QuantizedRingReducer::DispatchRecv(RingField* rf,
+                                        const StatusCallback& done) {
+  Tensor* encoded = EncodedBuffer(&recv_buffers_, rf);
+  Tensor* dst_tensor = RecvDestination(rf);
+  DispatchRecvTensor(rf, encoded,
+                     [encoded, dst_tensor, done](const Status& s) {
+                       if (s.ok()) Dequantize(*encoded, dst_tensor);
+                       done(s);
+                     });
+}
+
+namespace {
+REGISTER_COLLECTIVE(QuantizedRingReduce, QuantizedRingReducer);
+}  // namespace
+
+}  // namespace tensorflow
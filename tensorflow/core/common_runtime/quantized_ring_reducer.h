@@ -0,0 +1,68 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_QUANTIZED_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_QUANTIZED_RING_REDUCER_H_
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/ring_reducer.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/tensor.h"
+
+namespace tensorflow {
+
+// Ring-algorithm implementation of collective all-reduce that sends field
+// values quantized to 8 bits, with one float scale per field, which cuts the
+// bytes on the wire by 4x for float tensors at the cost of precision.  The
+// values are reduced in their original type; only their transfers are
+// quantized.  In the second pass, each device keeps the quantized value it
+// forwards, so that all devices end up with the same result.
+//
+// It is selected with the communication hint "int8", for float and double
+// tensors on CPU devices.
+class QuantizedRingReducer : public RingReducer {
+ public:
+  QuantizedRingReducer() : RingReducer("QuantizedReduce") {}
+  ~QuantizedRingReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // The number of bytes of a field of `num_elements` values once quantized.
+  static int64_t EncodedBytes(int64_t num_elements);
+
+  // Quantizes `values` into `encoded`, a DT_INT8 tensor of
+  // `EncodedBytes(values.NumElements())` elements.
+  static void Quantize(const Tensor& values, Tensor* encoded);
+
+  // Dequantizes `encoded` into `values`, which must be allocated.
+  static void Dequantize(const Tensor& encoded, Tensor* values);
+
+ protected:
+  void DispatchSend(RingField* rf, const StatusCallback& done) override;
+  void DispatchRecv(RingField* rf, const StatusCallback& done) override;
+
+ private:
+  // Returns the buffer of `buffers` for the quantized value of `rf`,
+  // allocating it on first use.
+  Tensor* EncodedBuffer(std::vector<Tensor>* buffers, RingField* rf);
+
+  // Indexed by field.  A field sends and receives at most one value at a
+  // time, so its buffers can be reused across passes.
+  std::vector<Tensor> send_buffers_;
+  std::vector<Tensor> recv_buffers_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_QUANTIZED_RING_REDUCER_H_
@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/quantized_ring_reducer.h"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetBinaryKernel(const string& op, DataType dtype,
+                                          const DeviceType& device_type,
+                                          DeviceBase* device) {
+  NodeDef node_def;
+  NodeDefBuilder builder("binary_node", op);
+  TF_CHECK_OK(builder.Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      device_type, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+TEST(QuantizedRingReducerCodingTest, RoundTrip) {
+  Tensor values = test::AsTensor<float>({0.0f, 1.0f, -2.0f, 0.5f, 127.0f});
+  Tensor encoded(DT_INT8,
+                 TensorShape({QuantizedRingReducer::EncodedBytes(5)}));
+  QuantizedRingReducer::Quantize(values, &encoded);
+  Tensor decoded(DT_FLOAT, TensorShape({5}));
+  QuantizedRingReducer::Dequantize(encoded, &decoded);
+  test::ExpectTensorNear<float>(values, decoded, 0.5f);
+}
+
+TEST(QuantizedRingReducerCodingTest, Zeros) {
+  Tensor values = test::AsTensor<double>({0.0, 0.0, 0.0});
+  Tensor encoded(DT_INT8,
+                 TensorShape({QuantizedRingReducer::EncodedBytes(3)}));
+  QuantizedRingReducer::Quantize(values, &encoded);
+  Tensor decoded(DT_DOUBLE, TensorShape({3}));
+  QuantizedRingReducer::Dequantize(encoded, &decoded);
+  test::ExpectTensorEqual<double>(values, decoded);
+}
+
+TEST(QuantizedRingReducerCodingTest, RequantizingIsLossless) {
+  Tensor values = test::AsTensor<float>({0.3f, -1.7f, 2.9f, 0.01f});
+  Tensor encoded(DT_INT8,
+                 TensorShape({QuantizedRingReducer::EncodedBytes(4)}));
+  QuantizedRingReducer::Quantize(values, &encoded);
+  QuantizedRingReducer::Dequantize(encoded, &values);
+  Tensor decoded(DT_FLOAT, TensorShape({4}));
+  QuantizedRingReducer::Quantize(values, &encoded);
+  QuantizedRingReducer::Dequantize(encoded, &decoded);
+  test::ExpectTensorNear<float>(values, decoded, 1e-6);
+}
+
+class QuantizedRingReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, int num_subdivs, const TensorShape& shape,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(DT_FLOAT, shape) {
+      col_params_ =
+          CreateCollectiveParams(*test_env_, rank, "QuantizedRingReduce",
+                                 REDUCTION_COLLECTIVE, DT_FLOAT, shape);
+      col_params_->instance.impl_details.subdiv_offsets =
+          GenerateEvenSubdivOffsets(test_env->num_devices_per_worker,
+                                    num_subdivs);
+      string dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_));
+      merge_op_ =
+          GetBinaryKernel("Add", DT_FLOAT, test_env_->device_type, device_);
+      final_op_ =
+          GetBinaryKernel("Div", DT_FLOAT, test_env_->device_type, device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    Status status_;
+  };
+
+  void RunTest(int num_workers, int num_devices, int num_subdivs,
+               int tensor_len) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<float> expected(tensor_len);
+    for (int rank = 0; rank < group_size; ++rank) {
+      instances_.push_back(std::make_unique<DeviceInstance>(
+          rank, num_subdivs, TensorShape({tensor_len}), test_env_.get()));
+      auto flat = instances_.back()->tensor_.flat<float>();
+      for (int i = 0; i < tensor_len; ++i) {
+        flat(i) = std::sin(rank + 0.1f * i);
+        expected[i] += flat(i) / group_size;
+      }
+    }
+
+    std::atomic<int> done(0);
+    for (auto& instance : instances_) {
+      SchedClosure([&instance, &done] {
+        instance->DoReduce();
+        ++done;
+      });
+    }
+    while (done < group_size) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+
+    for (auto& instance : instances_) {
+      TF_EXPECT_OK(instance->status_);
+      // The values are in [-1, 1], so each of the group_size - 1 quantized
+      // transfers of a partial sum errs by at most group_size / 254, and the
+      // transfer of the mean by at most 1 / 254.  Allow twice the resulting
+      // bound on the error of the mean for rounding.
+      const float tolerance = group_size / 127.0f;
+      test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                    instance->tensor_, tolerance);
+      // All devices must agree on the result exactly.
+      test::ExpectTensorEqual<float>(instances_[0]->tensor_,
+                                     instance->tensor_);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(QuantizedRingReducerTest, OneWorker) { RunTest(1, 4, 1, 1001); }
+
+TEST_F(QuantizedRingReducerTest, MultipleWorkers) { RunTest(2, 4, 1, 4096); }
+
+TEST_F(QuantizedRingReducerTest, MultipleSubdivs) { RunTest(2, 4, 2, 4095); }
+
+TEST_F(QuantizedRingReducerTest, TinyTensor) { RunTest(2, 4, 1, 3); }
+
+}  // namespace
+}  // namespace tensorflow
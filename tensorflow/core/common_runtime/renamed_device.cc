@@ -27,7 +27,7 @@ namespace tensorflow {
 std::unique_ptr<Device> RenamedDevice::NewRenamedDevice(
     const string& new_base, Device* underlying, bool owns_underlying,
     bool isolate_session_state,
-    thread::ThreadPoolInterface* underlying_threadpool) {
+    thread::ThreadPoolInterface* underlying_threadpool, Allocator* allocator) {
   DeviceNameUtils::ParsedName parsed_name;
   CHECK(DeviceNameUtils::ParseFullName(new_base, &parsed_name));
   DeviceNameUtils::ParsedName underlying_parsed_name =
@@ -44,18 +44,21 @@ std::unique_ptr<Device> RenamedDevice::NewRenamedDevice(
   // Call absl::WrapUnique to access private constructor.
   return absl::WrapUnique(
       new RenamedDevice(underlying, attributes, owns_underlying,
-                        isolate_session_state, underlying_threadpool));
+                        isolate_session_state, underlying_threadpool,
+                        allocator));
 }
 
 RenamedDevice::RenamedDevice(Device* underlying,
                              const DeviceAttributes& attributes,
                              bool owns_underlying_device,
                              bool isolate_session_state,
-                             thread::ThreadPoolInterface* underlying_threadpool)
+                             thread::ThreadPoolInterface* underlying_threadpool,
+                             Allocator* allocator)
     : Device(underlying->env(), attributes),
       underlying_device_(underlying),
       owns_underlying_device_(owns_underlying_device),
-      isolate_session_state_(isolate_session_state) {
+      isolate_session_state_(isolate_session_state),
+      allocator_(allocator) {
   if (underlying_threadpool != nullptr) {
     underlying_threadpool_.reset(new thread::ThreadPool(underlying_threadpool));
     eigen_worker_threads_.workers = underlying_threadpool_.get();
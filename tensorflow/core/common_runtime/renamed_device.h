@@ -27,12 +27,16 @@ namespace tensorflow {
 // This class is used to wrap local devices when using clusterspec propagation
 // where the name of a particular device may change in the context of a given
 // session.
+//
+// If `allocator` is non-null, it is returned by `GetAllocator()` instead of the
+// underlying device's allocator for the default allocator attributes.
 class RenamedDevice : public Device {
  public:
   static std::unique_ptr<Device> NewRenamedDevice(
       const string& new_base, Device* underlying, bool owns_underlying,
       bool isolate_session_state,
-      thread::ThreadPoolInterface* underlying_threadpool = nullptr);
+      thread::ThreadPoolInterface* underlying_threadpool = nullptr,
+      Allocator* allocator = nullptr);
 
   ~RenamedDevice() override;
 
@@ -56,6 +60,9 @@ class RenamedDevice : public Device {
   }
 
   Allocator* GetAllocator(AllocatorAttributes attr) override {
+    if (allocator_ != nullptr && attr.value == 0) {
+      return allocator_;
+    }
     return underlying_device_->GetAllocator(attr);
   }
 
@@ -139,6 +146,10 @@ class RenamedDevice : public Device {
     return underlying_device_->TryGetDeviceContext(out_context);
   }
 
+  Status CreateStepGraph(std::unique_ptr<StepGraph>* graph) override {
+    return underlying_device_->CreateStepGraph(graph);
+  }
+
   // Returns the resource manager associated w/ this device.
   ResourceMgr* resource_manager() override {
     if (isolate_session_state_) {
@@ -157,10 +168,12 @@ class RenamedDevice : public Device {
  private:
   RenamedDevice(Device* underlying, const DeviceAttributes& attributes,
                 bool owns_underlying, bool isolate_session_state,
-                thread::ThreadPoolInterface* underlying_threadpool);
+                thread::ThreadPoolInterface* underlying_threadpool,
+                Allocator* allocator);
   Device* const underlying_device_;
   const bool owns_underlying_device_;
   const bool isolate_session_state_;
+  Allocator* const allocator_;  // Not owned.
 
   std::unique_ptr<thread::ThreadPool> underlying_threadpool_;
   // eigen_worker_threads_ is stored here so that we can pass the pointer
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 
 #include <unordered_set>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device.h"
@@ -167,9 +168,11 @@ void IntraProcessRecvAsyncImpl(const DeviceMgr* device_mgr,
 }  // namespace
 
 RefCountedIntraProcessRendezvous::RefCountedIntraProcessRendezvous(
-    const DeviceMgr* device_mgr)
+    const DeviceMgr* device_mgr,
+    std::shared_ptr<const RendezvousSlotMap> slot_map)
     : device_mgr_(device_mgr),
-      local_(this, /* num_shards= */ device_mgr->NumDevices()) {}
+      local_(this, /* num_shards= */ device_mgr->NumDevices(),
+             std::move(slot_map)) {}
 
 RefCountedIntraProcessRendezvous::~RefCountedIntraProcessRendezvous() {
   VLOG(5) << "Destructor of IntraProcessRendezvous: " << this;
@@ -200,9 +203,11 @@ Status RefCountedIntraProcessRendezvous::GetLocalRendezvousStatus() {
 }
 
 PrivateIntraProcessRendezvous::PrivateIntraProcessRendezvous(
-    const DeviceMgr* device_mgr)
+    const DeviceMgr* device_mgr,
+    std::shared_ptr<const RendezvousSlotMap> slot_map)
     : device_mgr_(device_mgr),
-      local_(nullptr, /* num_shards= */ device_mgr->NumDevices()) {}
+      local_(nullptr, /* num_shards= */ device_mgr->NumDevices(),
+             std::move(slot_map)) {}
 
 PrivateIntraProcessRendezvous::~PrivateIntraProcessRendezvous() {}
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_RENDEZVOUS_MGR_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -42,7 +43,11 @@ namespace tensorflow {
 // Reference-counted implementation that may be shared between multiple threads.
 class RefCountedIntraProcessRendezvous : public Rendezvous {
  public:
-  explicit RefCountedIntraProcessRendezvous(const DeviceMgr* device_mgr);
+  // If `slot_map` is not null, its keys are exchanged through lock-free slots.
+  // See `RendezvousSlotMap`.
+  explicit RefCountedIntraProcessRendezvous(
+      const DeviceMgr* device_mgr,
+      std::shared_ptr<const RendezvousSlotMap> slot_map = nullptr);
 
   // Implementation of RendezvousInterface methods.
   // NOTE: The methods may clear the Item list and destroy 'this' if there are
@@ -83,7 +88,9 @@ using IntraProcessRendezvous = RefCountedIntraProcessRendezvous;
 // Prefer to use PrivateIntraProcessRendezvous in new code.
 class PrivateIntraProcessRendezvous : public RendezvousInterface {
  public:
-  explicit PrivateIntraProcessRendezvous(const DeviceMgr* device_mgr);
+  explicit PrivateIntraProcessRendezvous(
+      const DeviceMgr* device_mgr,
+      std::shared_ptr<const RendezvousSlotMap> slot_map = nullptr);
   ~PrivateIntraProcessRendezvous() override;
 
   // Implementation of RendezvousInterface methods.
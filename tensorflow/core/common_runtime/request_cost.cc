@@ -49,4 +49,16 @@ std::vector<RequestCost::BatchMetrics> RequestCost::GetBatchMetrics() const {
   return batch_metrics_;
 }
 
+void RequestCost::RecordLatency(absl::string_view stage,
+                                absl::Duration latency) {
+  absl::MutexLock lock(&mutex_);
+  latency_map_[stage] += latency;
+}
+
+absl::flat_hash_map<std::string, absl::Duration> RequestCost::GetLatencies()
+    const {
+  absl::MutexLock lock(&mutex_);
+  return latency_map_;
+}
+
 }  // namespace tensorflow
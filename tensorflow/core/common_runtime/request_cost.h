@@ -64,6 +64,16 @@ class RequestCost {
   // rpc request, when all batch processing has completed.
   std::vector<BatchMetrics> GetBatchMetrics() const;
 
+  // Records the latency of a stage of processing an rpc request, e.g. the
+  // stages in cost_constants.h. Latencies of the same stage are accumulated.
+  // It's thread-safe, and can be called from different threads.
+  void RecordLatency(absl::string_view stage, absl::Duration latency);
+
+  // Gets the latency breakdown of processing an rpc request, from stage to
+  // latency. It's thread-safe. It's expected to be called at the end of
+  // processing an rpc request.
+  absl::flat_hash_map<std::string, absl::Duration> GetLatencies() const;
+
  private:
   mutable absl::Mutex mutex_;
 
@@ -73,6 +83,10 @@ class RequestCost {
 
   // Metrics of batches that process this rpc request.
   std::vector<BatchMetrics> batch_metrics_ ABSL_GUARDED_BY(mutex_);
+
+  // Latency breakdown. Map from stage to latency.
+  absl::flat_hash_map<std::string, absl::Duration> latency_map_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace tensorflow
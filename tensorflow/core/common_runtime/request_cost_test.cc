@@ -77,5 +77,16 @@ TEST(RequestCostTest, RecordBatchMetrics) {
                                    Pair("tpu", absl::Milliseconds(80))))));
 }
 
+TEST(RequestCostTest, RecordLatency) {
+  RequestCost request_cost;
+
+  request_cost.RecordLatency("queue", absl::Milliseconds(1));
+  request_cost.RecordLatency("compute", absl::Milliseconds(2));
+  request_cost.RecordLatency("queue", absl::Milliseconds(3));
+  EXPECT_THAT(request_cost.GetLatencies(),
+              UnorderedElementsAre(Pair("queue", absl::Milliseconds(4)),
+                                   Pair("compute", absl::Milliseconds(2))));
+}
+
 }  // namespace
 }  // namespace tensorflow
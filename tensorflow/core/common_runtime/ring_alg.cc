@@ -19,6 +19,7 @@ limitations under the License.
 #include <atomic>
 #include <functional>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/collective_util.h"
@@ -53,6 +54,11 @@ constexpr size_t kMaxChunkSizeBytes = (4 * 1024 * 1024);
 // through the collectives API. A reasonable value would be a small
 // multiple of the number of NICs adjacent to each device.
 constexpr int kMaxSubdivsPerDeviceDefault = 2;
+// When the devices span several tasks, tensors whose chunks would be at least
+// kMinBidirectionalChunkBytes with 2 subdivisions are split into 2 rings that
+// run in opposite directions, so that both directions of the links between
+// tasks carry data. Smaller chunks are dominated by per-message latency.
+constexpr size_t kMinBidirectionalChunkBytes = (256 * 1024);
 
 namespace tensorflow {
 namespace {
@@ -147,7 +153,10 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
     chunk_size = tensor_size / num_chunks;
     VLOG(2) << "num_subdivs " << num_subdivs << " num_chunks " << num_chunks
             << " chunk_size " << chunk_size;
-  } while (chunk_size > kMaxChunkSizeBytes && num_subdivs < kMaxNumSubdivs);
+  } while ((chunk_size > kMaxChunkSizeBytes ||
+            (num_subdivs == 1 && col_params->group.num_tasks > 1 &&
+             chunk_size >= 2 * kMinBidirectionalChunkBytes)) &&
+           num_subdivs < kMaxNumSubdivs);
   if (num_subdivs <= 0) {
     return errors::Internal("Unexpected num_subdivs ", num_subdivs, " in ",
                             col_params->instance.impl_details.collective_name);
@@ -204,9 +213,21 @@ Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
   dev_per_task.push_back(dev_count);
   DCHECK_EQ(col_params->group.num_tasks, dev_per_task.size());
 
+  // Dynamically generated subdivisions with negative offsets also visit the
+  // tasks in reverse order, so that their rings run opposite to the others
+  // and alternate subdivisions use both directions of the links between
+  // tasks. Explicit offsets keep their documented meaning.
+  const bool reverse_tasks =
+      col_params->instance.impl_details.subdiv_offsets.empty() &&
+      col_params->group.num_tasks > 1;
   if (col_params->instance.impl_details.subdiv_offsets.empty()) {
     TF_RETURN_IF_ERROR(GenerateSubdivsInCollectiveParams(col_params));
   }
+  // The global index of the first device of each task.
+  std::vector<int> task_start(dev_per_task.size(), 0);
+  for (int ti = 1; ti < dev_per_task.size(); ++ti) {
+    task_start[ti] = task_start[ti - 1] + dev_per_task[ti - 1];
+  }
 
   // Generate a ring permutation for requested offset.
   VLOG(2) << "Setting up perms for col_params " << col_params
@@ -230,14 +251,16 @@ Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
       offset = abs(offset);
       reverse = true;
     }
-    int prior_dev_count = 0;  // sum over prior worker device counts
-    for (int ti = 0; ti < col_params->group.num_tasks; ++ti) {
+    for (int i = 0; i < col_params->group.num_tasks; ++i) {
+      const int ti = (reverse && reverse_tasks)
+                         ? col_params->group.num_tasks - 1 - i
+                         : i;
       for (int di = 0; di < dev_per_task[ti]; ++di) {
         int di_offset = (di + offset) % dev_per_task[ti];
         int offset_di =
             reverse ? (dev_per_task[ti] - (di_offset + 1)) : di_offset;
         // Device index in global subdivision permutation.
-        int permuted_di = prior_dev_count + offset_di;
+        int permuted_di = task_start[ti] + offset_di;
         int rank = static_cast<int>(perm.size());
         perm.push_back(permuted_di);
         if (col_params->group.members[permuted_di].device.name() ==
@@ -246,7 +269,6 @@ Status RingAlg::InitializeCollectiveParams(CollectiveParams* col_params) {
           col_params->subdiv_rank[sdi] = rank;
         }
       }
-      prior_dev_count += dev_per_task[ti];
     }
     DCHECK_EQ(col_params->group.group_size, perm.size());
   }
@@ -395,6 +417,11 @@ string RingAlg::RingField::DebugString() const {
 }
 
 void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
+  DispatchSendTensor(rf, &rf->chunk, done);
+}
+
+void RingAlg::DispatchSendTensor(RingField* rf, const Tensor* src_tensor,
+                                 const StatusCallback& done) {
   DCHECK(rf->do_send);
   string send_buf_key = RingAlgBufKey(name_, col_ctx_->exec_key,
                                       rf->second_pass, rf->sc_idx, rf->rank);
@@ -408,12 +435,23 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
 
+Tensor* RingAlg::RecvDestination(RingField* rf) {
+  return (!rf->second_pass && (col_params_->merge_op != nullptr))
+             ? &rf->tmp_chunk
+             : &rf->chunk;
+}
+
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
+  DispatchRecvTensor(rf, RecvDestination(rf), done);
+}
+
+void RingAlg::DispatchRecvTensor(RingField* rf, Tensor* dst_tensor,
+                                 const StatusCallback& done) {
   DCHECK(rf->do_recv);
   string recv_buf_key =
       RingAlgBufKey(name_, col_ctx_->exec_key, rf->second_pass, rf->sc_idx,
@@ -421,9 +459,6 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   VLOG(3) << "DispatchRecv rank=" << col_params_->default_rank << " recv key "
           << recv_buf_key << " chunk " << ca_->TBounds(rf->chunk) << " into "
           << ((col_params_->merge_op != nullptr) ? "tmp_chunk" : "chunk");
-  Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
-                           ? &rf->tmp_chunk
-                           : &rf->chunk;
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -81,8 +81,19 @@ class RingAlg : public CollectiveImplementationInterface {
   virtual void InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                              int field_idx);
   void AdvanceToSecondPass(RingField* rf);
-  void DispatchSend(RingField* rf, const StatusCallback& done);
-  void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Send `rf->chunk` to, and receive the field value from, the neighbouring
+  // devices of the ring.  Subclasses may override them to change how values
+  // are represented on the wire.
+  virtual void DispatchSend(RingField* rf, const StatusCallback& done);
+  virtual void DispatchRecv(RingField* rf, const StatusCallback& done);
+  // Send `src_tensor` and receive `dst_tensor` in place of the field value of
+  // `rf`.
+  void DispatchSendTensor(RingField* rf, const Tensor* src_tensor,
+                          const StatusCallback& done);
+  void DispatchRecvTensor(RingField* rf, Tensor* dst_tensor,
+                          const StatusCallback& done);
+  // The tensor into which the field value of `rf` is received.
+  Tensor* RecvDestination(RingField* rf);
 
   // For constructing log messages for debugging.
   string FieldState();
@@ -42,6 +42,10 @@ class RingReducer : public RingAlg {
   Status InitializeCollectiveParams(CollectiveParams* col_params) override;
 
  protected:
+  // For subclasses, which use `name` in their buffer keys and log messages.
+  explicit RingReducer(const string& name)
+      : RingAlg(REDUCTION_COLLECTIVE, name) {}
+
   void InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                      int field_idx) override;
 
@@ -277,7 +277,8 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivs) {
                      {0});
 
   // Set shape so that with 2 subdivs chunk_size is 3 MiB.  This should cause 2
-  // offsets, {0, -4}, to be generated.
+  // offsets, {0, -4}, to be generated. The second subdivision visits the
+  // workers in reverse order.
   {
     int num_subdivs = 2;
     int num_chunks = kNumDevs * num_subdivs;
@@ -290,9 +291,9 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivs) {
   RunSubdivPermsTest(cp.get(),
                      {{0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  10, 11,
                        12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23},
-                      {3,  2,  1,  0,  7,  6,  5,  4,  11, 10, 9,  8,
-                       15, 14, 13, 12, 19, 18, 17, 16, 23, 22, 21, 20}},
-                     {0, 3});
+                      {19, 18, 17, 16, 23, 22, 21, 20, 11, 10, 9, 8,
+                       15, 14, 13, 12, 3,  2,  1,  0,  7,  6,  5, 4}},
+                     {0, 19});
 }
 
 TEST_F(RingReducerInitParamsTest, AutomaticSubdivUpperBound) {
@@ -308,7 +309,50 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivUpperBound) {
   cp->instance.impl_details.subdiv_offsets.clear();
   cp->instance.impl_details.max_subdivs_per_device = 0;
   cp->instance.shape = TensorShape({104857600 / DataTypeSize(DT_FLOAT)});
-  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {0, 1, 2, 3}}, {0, 0});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {3, 2, 1, 0}}, {0, 3});
+}
+
+TEST_F(RingReducerInitParamsTest, AutomaticSubdivsUseBothDirections) {
+  const int kNumDevsPerWorker = 1;
+  const int kNumWorkers = 4;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+
+  // With 1 subdivision the chunks would be 1 MiB, which is below
+  // kMaxChunkSizeBytes but large enough to split into 2 opposite rings.
+  cp->default_rank = 1;
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.impl_details.max_subdivs_per_device = 0;
+  cp->instance.shape =
+      TensorShape({kNumWorkers * 1048576 / DataTypeSize(DT_FLOAT)});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {3, 2, 1, 0}}, {1, 2});
+
+  // Small chunks stay in a single ring.
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.shape = TensorShape({kNumWorkers * 1024});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {1});
+}
+
+TEST_F(RingReducerInitParamsTest, AutomaticSubdivsWithinOneWorker) {
+  const int kNumDevsPerWorker = 4;
+  const int kNumWorkers = 1;
+  auto test_env =
+      CreateCollectiveTestEnv(kNumWorkers, kNumDevsPerWorker, DEVICE_CPU);
+  auto cp =
+      CreateCollectiveParams(*test_env, /*rank*/ 0, "RingReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({1}));
+
+  // Devices of a single worker keep a single ring for chunks below
+  // kMaxChunkSizeBytes.
+  cp->default_rank = 0;
+  cp->instance.impl_details.subdiv_offsets.clear();
+  cp->instance.impl_details.max_subdivs_per_device = 0;
+  cp->instance.shape =
+      TensorShape({kNumDevsPerWorker * 1048576 / DataTypeSize(DT_FLOAT)});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}}, {0});
 }
 
 TEST_F(RingReducerInitParamsTest, AutomaticSubdivIgnoresMaxNumSubdivs) {
@@ -334,8 +378,8 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivIgnoresMaxNumSubdivs) {
   cp->instance.impl_details.max_subdivs_per_device = 4;
   cp->instance.shape = TensorShape({104857600 / DataTypeSize(DT_FLOAT)});
   RunSubdivPermsTest(cp.get(),
-                     {{0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}},
-                     {0, 0, 0, 0});
+                     {{0, 1, 2, 3}, {3, 2, 1, 0}, {0, 1, 2, 3}, {3, 2, 1, 0}},
+                     {0, 3, 0, 3});
 }
 
 TEST_F(RingReducerInitParamsTest, AutomaticSubdivUsesDefault) {
@@ -353,7 +397,7 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivUsesDefault) {
   cp->instance.impl_details.subdiv_offsets.clear();
   cp->instance.impl_details.max_subdivs_per_device = 0;
   cp->instance.shape = TensorShape({104857600 / DataTypeSize(DT_FLOAT)});
-  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {0, 1, 2, 3}}, {0, 0});
+  RunSubdivPermsTest(cp.get(), {{0, 1, 2, 3}, {3, 2, 1, 0}}, {0, 3});
 }
 
 TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
@@ -15,10 +15,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SERVING_DEVICE_SELECTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_SERVING_DEVICE_SELECTOR_H_
 
+#include <cstdint>
 #include <deque>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 
@@ -58,8 +61,17 @@ class ServingDeviceSelector {
     struct ProgramInfo {
       absl::string_view fingerprint;
       int64_t req_id = -1;
+      // When the program was scheduled, in nanoseconds since the Unix epoch.
+      int64_t schedule_time_ns = 0;
     };
     std::deque<ProgramInfo> scheduled_programs;
+    // The recorded execution time of each program that ran on the device, in
+    // nanoseconds, averaged over its recent runs. A program that ran on the
+    // device also has its weights resident there.
+    absl::flat_hash_map<std::string, int64_t> program_execution_time_ns;
+    // When the last program on the device finished, in nanoseconds since the
+    // Unix epoch.
+    int64_t last_completion_time_ns = 0;
   };
 
   // Struct of all tracked device states, which will be passed to Policy.
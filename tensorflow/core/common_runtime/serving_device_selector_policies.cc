@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/serving_device_selector_policies.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <limits>
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/serving_device_selector.h"
@@ -28,4 +31,73 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+namespace {
+
+// How much longer a program is predicted to take on a device where it never
+// ran, and its weights are not resident.
+constexpr int64_t kNonResidentExecutionTimeFactor = 2;
+
+// Returns the predicted execution time of the program on the device with the
+// given state.
+int64_t PredictExecutionTime(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceState& device_state,
+    const ServingDeviceSelector::DeviceStates& device_states,
+    int64_t default_execution_time_ns) {
+  auto it = device_state.program_execution_time_ns.find(program_fingerprint);
+  if (it != device_state.program_execution_time_ns.end()) return it->second;
+  int64_t execution_time_ns = -1;
+  for (const auto& state : device_states.states) {
+    auto other = state.program_execution_time_ns.find(program_fingerprint);
+    if (other != state.program_execution_time_ns.end()) {
+      execution_time_ns = std::max(execution_time_ns, other->second);
+    }
+  }
+  return execution_time_ns >= 0
+             ? execution_time_ns * kNonResidentExecutionTimeFactor
+             : default_execution_time_ns;
+}
+
+}  // namespace
+
+int MinCompletionTimePolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  // Programs that never ran are predicted to take the average recorded time,
+  // so that without any records the policy balances the number of programs.
+  int64_t total_execution_time_ns = 0;
+  int64_t num_execution_times = 0;
+  for (const auto& state : device_states.states) {
+    for (const auto& [fingerprint, execution_time_ns] :
+         state.program_execution_time_ns) {
+      total_execution_time_ns += execution_time_ns;
+      ++num_execution_times;
+    }
+  }
+  const int64_t default_execution_time_ns =
+      num_execution_times > 0
+          ? std::max<int64_t>(total_execution_time_ns / num_execution_times, 1)
+          : 1;
+
+  const int num_devices = device_states.states.size();
+  int best_device = 0;
+  int64_t best_completion_time_ns = std::numeric_limits<int64_t>::max();
+  for (int i = 0; i < num_devices; ++i) {
+    const ServingDeviceSelector::DeviceState& state = device_states.states[i];
+    int64_t completion_time_ns =
+        PredictExecutionTime(program_fingerprint, state, device_states,
+                             default_execution_time_ns);
+    for (const auto& program : state.scheduled_programs) {
+      completion_time_ns +=
+          PredictExecutionTime(program.fingerprint, state, device_states,
+                               default_execution_time_ns);
+    }
+    if (completion_time_ns < best_completion_time_ns) {
+      best_device = i;
+      best_completion_time_ns = completion_time_ns;
+    }
+  }
+  return best_device;
+}
+
 }  // namespace tensorflow
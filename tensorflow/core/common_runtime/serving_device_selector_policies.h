@@ -23,6 +23,7 @@ namespace tensorflow {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kMinCompletionTime,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +38,18 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device that is predicted to finish the program first, from the
+// recorded execution times of the programs scheduled on each device. A program
+// that never ran on a device is predicted to take twice as long there as on
+// the device where it was slowest, since it must first load its weights, which
+// keeps programs on the devices where their weights are resident.
+class MinCompletionTimePolicy : public ServingDeviceSelector::Policy {
+ public:
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SERVING_DEVICE_SELECTOR_POLICIES_H_
@@ -295,13 +295,15 @@ class SingleThreadedExecutorImpl : public Executor {
     TensorValueVec node_inputs;
     AllocatorAttributeVec input_alloc_attrs;
 
-    // Override intra op thread pool if requested.
+    // Override intra op thread pool and allocator if requested.
     Device* device = params_.device;
     std::unique_ptr<Device> user_device;
-    if (args.user_intra_op_threadpool != nullptr) {
+    if (args.user_intra_op_threadpool != nullptr ||
+        args.step_allocator != nullptr) {
       user_device = RenamedDevice::NewRenamedDevice(
           device->name(), device, /*owns_underlying=*/false,
-          /*isolate_session_state=*/false, args.user_intra_op_threadpool);
+          /*isolate_session_state=*/false, args.user_intra_op_threadpool,
+          args.step_allocator);
       device = user_device.get();
     }
 
@@ -333,7 +335,12 @@ class SingleThreadedExecutorImpl : public Executor {
     params.frame_iter = FrameAndIter(0, 0);
     params.is_input_dead = false;
 
-    device->TryGetDeviceContext(&params.op_device_context).IgnoreError();
+    if (args.device_context != nullptr) {
+      params.op_device_context = args.device_context;
+      params.op_device_context->Ref();
+    } else {
+      device->TryGetDeviceContext(&params.op_device_context).IgnoreError();
+    }
     auto context_cleanup = gtl::MakeCleanup([&params] {
       if (params.op_device_context != nullptr) {
         params.op_device_context->Unref();
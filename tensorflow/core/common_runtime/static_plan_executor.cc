@@ -0,0 +1,481 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_plan_executor.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/entry.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/common_runtime/graph_view.h"
+#include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/tensor_slice_reader_cache.h"
+
+namespace tensorflow {
+namespace {
+
+typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
+typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
+
+static const string& kStaticPlanExecutor = *new string("STATIC_PLAN_EXECUTOR");
+
+class StaticPlanExecutorImpl : public Executor {
+ public:
+  explicit StaticPlanExecutorImpl(const LocalExecutorParams& params)
+      : immutable_state_(params) {}
+
+  Status Initialize(const Graph& graph) {
+    TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
+    if (immutable_state_.requires_control_flow_support()) {
+      return errors::InvalidArgument(
+          "The static plan executor does not support graphs that require "
+          "control flow support, i.e. graphs that contain control flow nodes "
+          "or that receive tensors from another device.");
+    }
+
+    // Topologically sort `graph` to get the order in which the kernels run.
+    std::vector<Node*> ordered_nodes;
+    ordered_nodes.reserve(graph.num_nodes());
+    GetReversePostOrder(graph, &ordered_nodes);
+    if (ordered_nodes.size() != graph.num_nodes()) {
+      return errors::InvalidArgument("Graph had ", graph.num_nodes(),
+                                     " but reverse post-order had ",
+                                     ordered_nodes.size());
+    }
+
+    const GraphView& gview = immutable_state_.graph_view();
+    plan_.reserve(ordered_nodes.size());
+    for (const Node* n : ordered_nodes) {
+      // The sink node has no kernel.
+      if (n->IsSink()) continue;
+      const NodeItem& item = gview.node_ref(n->id());
+      if (item.is_any_input_ref_typed) {
+        return errors::Unimplemented(
+            "The static plan executor does not support reference-typed "
+            "inputs, but node ",
+            n->name(), " has one.");
+      }
+      for (int i = 0; i < item.num_outputs; ++i) {
+        if (IsRefType(item.output_type(i))) {
+          return errors::Unimplemented(
+              "The static plan executor does not support reference-typed "
+              "outputs, but node ",
+              n->name(), " has one.");
+        }
+      }
+      plan_.push_back(&item);
+    }
+    return OkStatus();
+  }
+
+ private:
+  class StepState;
+
+  void RunAsyncInternal(const Args& args, DoneCallback done) override;
+
+  ImmutableExecutorState immutable_state_;
+
+  // The nodes of the graph, except for the sink node, in topological order.
+  // Read-only after `Initialize()`.
+  std::vector<const NodeItem*> plan_;
+};
+
+// The state of a single step. Deletes itself when the step ends.
+class StaticPlanExecutorImpl::StepState {
+ public:
+  StepState(const StaticPlanExecutorImpl* executor, const Args& args,
+            DoneCallback done)
+      : executor_(executor),
+        device_(executor->immutable_state_.params().device),
+        rendezvous_(args.rendezvous),
+        cancellation_manager_(args.cancellation_manager),
+        stats_collector_(args.stats_collector),
+        sync_on_finish_(args.sync_on_finish),
+        runner_(args.runner),
+        done_(std::move(done)),
+        inputs_(executor->immutable_state_.get_root_frame_info().total_inputs) {
+    Device* device = device_;
+    if (args.user_intra_op_threadpool != nullptr ||
+        args.step_allocator != nullptr) {
+      user_device_ = RenamedDevice::NewRenamedDevice(
+          device->name(), device, /*owns_underlying=*/false,
+          /*isolate_session_state=*/false, args.user_intra_op_threadpool,
+          args.step_allocator);
+      device = user_device_.get();
+    }
+
+    // Prepare the parameters that are the same for all kernels.
+    params_.step_id = args.step_id;
+    params_.start_time_usecs = args.start_time_usecs;
+    params_.deadline = args.deadline;
+    params_.device = device;
+    params_.log_memory = false;
+    params_.rendezvous = args.rendezvous;
+    params_.collective_executor = args.collective_executor;
+    params_.session_state = args.session_state;
+    params_.session_handle = args.session_handle;
+    params_.session_metadata =
+        executor->immutable_state_.params().session_metadata;
+    params_.tensor_store = args.tensor_store;
+    params_.cancellation_manager = args.cancellation_manager;
+    params_.coordination_service_agent = args.coordination_service_agent;
+    params_.stack_trace = args.stack_trace;
+    params_.call_frame = args.call_frame;
+    params_.function_library =
+        executor->immutable_state_.params().function_library;
+    params_.resource_manager = device->resource_manager();
+    params_.step_container = args.step_container;
+    params_.slice_reader_cache = &slice_reader_cache_;
+    params_.runner = &runner_;
+    params_.run_all_kernels_inline = args.run_all_kernels_inline;
+    params_.stats_collector = args.stats_collector;
+    params_.executor_type = &kStaticPlanExecutor;
+
+    // The graph contains no control flow, so all nodes run in the root frame
+    // and no input is ever dead.
+    params_.frame_iter = FrameAndIter(0, 0);
+    params_.is_input_dead = false;
+
+    if (args.device_context != nullptr) {
+      params_.op_device_context = args.device_context;
+      params_.op_device_context->Ref();
+    } else {
+      device_->TryGetDeviceContext(&params_.op_device_context).IgnoreError();
+    }
+  }
+
+  ~StepState() {
+    if (params_.op_device_context != nullptr) {
+      params_.op_device_context->Unref();
+    }
+  }
+
+  // Runs the plan, starting at `plan_[start]`, until the step ends or an
+  // asynchronous kernel is launched that does not complete inline.
+  void RunFrom(size_t start);
+
+ private:
+  // Fills in the per-kernel members of `params_` for running `item`.
+  Status PrepareInputs(const NodeItem& item);
+
+  // Clears the inputs of `item`, and forwards its outputs from `ctx` to the
+  // inputs of its consumers.
+  Status ProcessOutputs(const NodeItem& item, OpKernelContext* ctx);
+
+  // Forwards the constant output of `item` to the inputs of its consumers.
+  void PropagateConstTensor(const NodeItem& item);
+
+  void StartNodeStats(const NodeItem& item);
+  void EndNodeStats();
+
+  // Reports the status of the step to `done_` and deletes `this`.
+  void Finish(Status s);
+
+  const StaticPlanExecutorImpl* const executor_;
+  Device* const device_;
+  RendezvousInterface* const rendezvous_;
+  CancellationManager* const cancellation_manager_;
+  StepStatsCollectorInterface* const stats_collector_;
+  const bool sync_on_finish_;
+  Args::Runner runner_;
+  DoneCallback done_;
+  std::unique_ptr<Device> user_device_;
+  checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
+
+  OpKernelContext::Params params_;
+
+  // The inputs of all nodes in the graph, laid out contiguously as described
+  // by `NodeItem::input_start`.
+  std::vector<Entry> inputs_;
+
+  // Scratch space for the inputs and outputs of the current kernel.
+  TensorValueVec node_inputs_;
+  AllocatorAttributeVec input_alloc_attrs_;
+  EntryVector outputs_;
+
+  // Non-null iff the stats of the current kernel are being collected.
+  NodeExecStatsInterface* stats_ = nullptr;
+
+  // State of the asynchronous kernel that is currently running, if any.
+  std::unique_ptr<OpKernelContext> async_ctx_;
+  Status async_status_;
+  // Set to true before launching an asynchronous kernel. Whichever of the
+  // launching thread and the kernel's done callback resets it first leaves
+  // the other one responsible for continuing the step.
+  std::atomic<bool> launching_async_{false};
+};
+
+void StaticPlanExecutorImpl::StepState::RunFrom(size_t start) {
+  const std::vector<const NodeItem*>& plan = executor_->plan_;
+  for (size_t i = start; i < plan.size(); ++i) {
+    if (TF_PREDICT_FALSE(cancellation_manager_ != nullptr &&
+                         cancellation_manager_->IsCancelled())) {
+      Finish(errors::Cancelled("Step was cancelled"));
+      return;
+    }
+
+    const NodeItem& item = *plan[i];
+    if (item.is_noop) {
+      // The graph contains no dead tensors, so a NoOp has no effect on the
+      // step other than ordering, which the plan already respects.
+      continue;
+    }
+    StartNodeStats(item);
+    if (item.const_tensor != nullptr && !params_.track_allocations) {
+      PropagateConstTensor(item);
+      EndNodeStats();
+      continue;
+    }
+
+    Status s = PrepareInputs(item);
+    if (!s.ok()) {
+      Finish(s);
+      return;
+    }
+
+    if (item.kernel_is_async) {
+      async_ctx_ =
+          std::make_unique<OpKernelContext>(&params_, item.num_outputs);
+      launching_async_.store(true);
+      device_->ComputeAsync(
+          item.kernel->AsAsync(), async_ctx_.get(), [this, i, item = &item]() {
+            async_status_ = ProcessOutputs(*item, async_ctx_.get());
+            async_ctx_.reset();
+            EndNodeStats();
+            if (launching_async_.exchange(false)) {
+              // The kernel completed before `ComputeAsync()` returned, and
+              // the launching thread will continue the step.
+              return;
+            }
+            if (!async_status_.ok()) {
+              Finish(async_status_);
+            } else {
+              RunFrom(i + 1);
+            }
+          });
+      if (launching_async_.exchange(false)) {
+        // The done callback will continue the step.
+        return;
+      }
+      s = async_status_;
+    } else {
+      OpKernelContext ctx(&params_, item.num_outputs);
+      device_->Compute(item.kernel, &ctx);
+      s = ProcessOutputs(item, &ctx);
+      EndNodeStats();
+    }
+    if (!s.ok()) {
+      Finish(s);
+      return;
+    }
+  }
+  Finish(OkStatus());
+}
+
+Status StaticPlanExecutorImpl::StepState::PrepareInputs(const NodeItem& item) {
+  Entry* first_input = inputs_.data() + item.input_start;
+  node_inputs_.resize(item.num_inputs);
+  input_alloc_attrs_.resize(item.num_inputs);
+  for (int i = 0; i < item.num_inputs; ++i) {
+    Entry* entry = first_input + i;
+    TensorValue* inp = &node_inputs_[i];
+    inp->mutex_if_ref = nullptr;
+    switch (entry->state) {
+      case Entry::State::HAS_VALUE:
+        inp->tensor = entry->val.get();
+        break;
+      case Entry::State::HAS_CONST_TENSOR:
+        // NOTE(mrry): This `const_cast` is necessary because `TensorValue`
+        // stores a non-const `Tensor*`, and relies on the `OpKernelContext`
+        // accessors making dynamic checks that prevent using an immutable
+        // tensor as a mutable tensor.
+        inp->tensor = const_cast<Tensor*>(entry->const_tensor);
+        break;
+      default:
+        return errors::Internal("Input ", i, " of node ",
+                                FormatNodeDefForError(item.kernel->def()),
+                                " has no value.");
+    }
+    input_alloc_attrs_[i] = entry->alloc_attr;
+  }
+
+  params_.op_kernel = item.kernel;
+  params_.inputs = node_inputs_;
+  params_.input_alloc_attrs = input_alloc_attrs_;
+  params_.output_attr_array = item.output_attrs();
+  params_.forward_from_array = item.forward_from();
+  params_.outputs_required_array = item.outputs_required.get();
+  params_.output_retval_index_array = item.output_retval_index.get();
+  params_.output_lifetime_array = item.output_lifetime.get();
+  return OkStatus();
+}
+
+Status StaticPlanExecutorImpl::StepState::ProcessOutputs(const NodeItem& item,
+                                                         OpKernelContext* ctx) {
+  // Free the inputs of the kernel. Each input slot is written by exactly one
+  // producer per step, so it can be reused as soon as the kernel is done.
+  Entry* first_input = inputs_.data() + item.input_start;
+  for (int i = 0; i < item.num_inputs; ++i) {
+    (first_input + i)->ClearVal();
+  }
+
+  Status s = ctx->status();
+  if (!s.ok()) {
+    return AttachDef(s, item.kernel->def());
+  }
+
+  if (outputs_.size() < item.num_outputs) outputs_.resize(item.num_outputs);
+  for (int i = 0; i < item.num_outputs; ++i) {
+    const TensorValue val = ctx->release_output(i);
+    Entry* out = &outputs_[i];
+    if (val.tensor == nullptr) {
+      if (!(item.is_recv_or_switch ||
+            (item.outputs_required && !item.outputs_required[i]))) {
+        s.Update(errors::Internal("Missing ", i, "-th output from ",
+                                  FormatNodeDefForError(item.kernel->def())));
+      }
+    } else if (val.dtype_safe() != item.output_type(i)) {
+      s.Update(errors::Internal(
+          "Output ", i, " of type ", DataTypeString(val.dtype_safe()),
+          " does not match declared output type ",
+          DataTypeString(item.output_type(i)), " for node ",
+          FormatNodeDefForError(item.kernel->def())));
+    } else {
+      out->state = Entry::State::HAS_VALUE;
+      out->val.Init(std::move(*val.tensor));
+      out->alloc_attr = ctx->output_alloc_attr(i);
+    }
+    delete val.tensor;
+  }
+
+  if (s.ok()) {
+    for (const EdgeInfo& e : item.output_edges()) {
+      if (e.is_last) {
+        inputs_[e.input_slot] = std::move(outputs_[e.output_slot]);
+      } else {
+        inputs_[e.input_slot] = outputs_[e.output_slot];
+      }
+    }
+  }
+  for (int i = 0; i < item.num_outputs; ++i) {
+    outputs_[i].ClearVal();
+  }
+  return s;
+}
+
+void StaticPlanExecutorImpl::StepState::PropagateConstTensor(
+    const NodeItem& item) {
+  for (const EdgeInfo& e : item.output_edges()) {
+    Entry& input = inputs_[e.input_slot];
+    input.state = Entry::State::HAS_CONST_TENSOR;
+    input.const_tensor = item.const_tensor;
+    input.alloc_attr = item.output_attrs()[0];
+  }
+}
+
+void StaticPlanExecutorImpl::StepState::StartNodeStats(const NodeItem& item) {
+  params_.track_allocations = false;
+  if (stats_collector_ == nullptr) return;
+  stats_ = stats_collector_->CreateNodeExecStats(&item.kernel->def());
+  if (stats_ == nullptr) return;
+  params_.track_allocations = stats_->TrackAllocations();
+  stats_->RecordExecutorStarted();
+  stats_->RecordComputeStarted();
+}
+
+void StaticPlanExecutorImpl::StepState::EndNodeStats() {
+  if (stats_ == nullptr) return;
+  stats_->RecordComputeEnded();
+  stats_->RecordExecutorEnded();
+  stats_->Done(device_->name());
+  stats_ = nullptr;
+}
+
+void StaticPlanExecutorImpl::StepState::Finish(Status s) {
+  if (!s.ok()) {
+    // Abort the other partitions of the step, which may be waiting for tensors
+    // from this one.
+    if (rendezvous_ != nullptr) {
+      rendezvous_->StartAbort(s);
+    }
+    if (cancellation_manager_ != nullptr) {
+      cancellation_manager_->StartCancelWithStatus(s);
+    }
+  }
+  Device* device = device_;
+  const bool sync =
+      s.ok() && sync_on_finish_ && device->AllowsSyncOnCompletion();
+  DoneCallback done = std::move(done_);
+  delete this;
+  if (sync) {
+    // Block until the device has finished all queued operations, as the
+    // default executor does.
+    device->Sync(std::move(done));
+  } else {
+    done(s);
+  }
+}
+
+void StaticPlanExecutorImpl::RunAsyncInternal(const Args& args,
+                                              DoneCallback done) {
+  StepState* state = new StepState(this, args, std::move(done));
+  args.runner([state]() {
+    profiler::TraceMe activity("StaticPlanExecutor::Run",
+                               profiler::TraceMeLevel::kVerbose);
+    state->RunFrom(0);
+  });
+}
+
+class StaticPlanExecutorRegistrar {
+ public:
+  StaticPlanExecutorRegistrar() {
+    ExecutorFactory::Register(kStaticPlanExecutor, new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(NewStaticPlanExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return OkStatus();
+    }
+  };
+};
+static StaticPlanExecutorRegistrar registrar;
+
+}  // namespace
+
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph, Executor** executor) {
+  auto impl = std::make_unique<StaticPlanExecutorImpl>(params);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,53 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
+
+#include "tensorflow/core/common_runtime/executor.h"
+
+namespace tensorflow {
+
+// Creates a new `Executor` that runs `graph` from a precompiled, flat
+// execution plan. The executor is also registered with `ExecutorFactory` as
+// "STATIC_PLAN_EXECUTOR".
+//
+// The executor shares its graph representation with the default executor
+// (`ImmutableExecutorState`), but instead of tracking pending counts and
+// frames at run time, it topologically sorts the nodes once, in this
+// function, and runs the resulting array of kernels in order. Inputs and
+// outputs are routed directly to the precomputed slots of a flat per-step
+// input array. Asynchronous kernels are supported: the step resumes from the
+// next plan entry when the kernel completes, without blocking a thread.
+//
+// This avoids most of the per-node bookkeeping of the default executor, which
+// dominates the step time of small graphs, at the cost of inter-op
+// parallelism. Intra-op parallelism is unaffected.
+//
+// The current implementation has the following limitations:
+//
+// 1. Graphs that require control flow support (see
+//    `ImmutableExecutorState::requires_control_flow_support()`) are rejected.
+//    This includes graphs that receive tensors from other devices, since those
+//    may be dead.
+// 2. Reference-typed tensors are not supported.
+// 3. Kernels that defer work with `inc_num_deferred_ops_function()` are not
+//    supported.
+Status NewStaticPlanExecutor(const LocalExecutorParams& params,
+                             const Graph& graph, Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_PLAN_EXECUTOR_H_
@@ -0,0 +1,72 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_GRAPH_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_GRAPH_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// The device work of one step of a single-device graph, recorded once and
+// replayed as a unit, e.g. a CUDA graph. Created by
+// `Device::CreateStepGraph()`.
+//
+// To record the step, the caller calls `BeginCapture()`, runs the step with
+// the returned args, `device_context()` and `allocator()`, and passes its
+// return values to `EndCapture()`. The kernels of the step are only recorded
+// while it runs: the step is actually computed by `EndCapture()`, and by each
+// `Launch()` after that.
+//
+// The recorded kernels read and write fixed addresses. The args are copied
+// into buffers owned by the graph before each launch, the return values are
+// copied out of buffers owned by the graph after it, and all the buffers that
+// the step allocates are kept until the graph is destroyed. A graph can thus
+// only be launched on args with the shapes and types it was recorded with.
+class StepGraph {
+ public:
+  virtual ~StepGraph() {}
+
+  // The device context and allocator the recorded step must run with.
+  virtual DeviceContext* device_context() = 0;
+  virtual Allocator* allocator() = 0;
+
+  // Starts recording a step on `args`. Sets `*captured_args` to the buffers
+  // owned by the graph that hold the args, which the step must read instead.
+  virtual Status BeginCapture(const std::vector<Tensor>& args,
+                              std::vector<Tensor>* captured_args) = 0;
+
+  // Stops recording. `step_status` is the status of the recorded step, and
+  // `retvals` its return values. On success, runs the recorded step once on
+  // the args of `BeginCapture()`, and sets `*outputs` to copies of `retvals`.
+  // On error, the graph can not be launched.
+  virtual Status EndCapture(const Status& step_status,
+                            const std::vector<Tensor>& retvals,
+                            std::vector<Tensor>* outputs) = 0;
+
+  // Runs the recorded step on `args`, and sets `*outputs` to copies of its
+  // return values. Thread-safe.
+  virtual Status Launch(const std::vector<Tensor>& args,
+                        std::vector<Tensor>* outputs) = 0;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_GRAPH_H_
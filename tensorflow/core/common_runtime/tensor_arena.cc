@@ -0,0 +1,393 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/tensor_arena.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Planning is quadratic in the number of allocations, so only the first
+// `kMaxPlannedAllocations` allocations of a step are planned.
+constexpr int kMaxPlannedAllocations = 4096;
+
+size_t RoundUpToAlignment(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) /
+         Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+}
+
+bool LifetimesOverlap(const TensorArenaPlan::Allocation& a,
+                      const TensorArenaPlan::Allocation& b) {
+  return a.alloc_time < b.free_time && b.alloc_time < a.free_time;
+}
+
+}  // namespace
+
+uint64 TensorArenaPlan::CurrentSite() {
+  const profiler::MemoryDebugAnnotation& annotation =
+      profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  uint64 site = 0;
+  if (annotation.pending_op_name != nullptr) {
+    site = Hash64(annotation.pending_op_name);
+  }
+  if (annotation.pending_region_type != nullptr) {
+    site = Hash64Combine(site, Hash64(annotation.pending_region_type));
+  }
+  return site;
+}
+
+TensorArenaPlan::TensorArenaPlan(const std::vector<Allocation>& allocations) {
+  // Choose the allocations to plan: those that were freed during the step.
+  std::vector<int> order;
+  for (int i = 0; i < allocations.size(); ++i) {
+    const Allocation& a = allocations[i];
+    if (a.num_bytes > 0 && a.free_time != kNotFreed) {
+      order.push_back(i);
+      if (order.size() == kMaxPlannedAllocations) break;
+    }
+  }
+
+  // Place the largest allocations first, each at the lowest offset that does
+  // not overlap with an already placed allocation whose lifetime overlaps.
+  std::stable_sort(order.begin(), order.end(), [&allocations](int a, int b) {
+    return allocations[a].num_bytes > allocations[b].num_bytes;
+  });
+  std::vector<int64_t> offsets(allocations.size(), -1);
+  // Placed allocations, sorted by offset.
+  std::vector<int> placed;
+  placed.reserve(order.size());
+  for (int i : order) {
+    const size_t size = RoundUpToAlignment(allocations[i].num_bytes);
+    size_t offset = 0;
+    for (int j : placed) {
+      if (!LifetimesOverlap(allocations[i], allocations[j])) continue;
+      if (offset + size <= offsets[j]) break;
+      offset = std::max<size_t>(
+          offset, offsets[j] + RoundUpToAlignment(allocations[j].num_bytes));
+    }
+    offsets[i] = offset;
+    placed.insert(std::upper_bound(placed.begin(), placed.end(), i,
+                                   [&offsets](int a, int b) {
+                                     return offsets[a] < offsets[b];
+                                   }),
+                  i);
+    arena_size_ = std::max(arena_size_, offset + size);
+  }
+
+  // Index the offsets by allocation site and size and, within a class, by
+  // allocation order.
+  for (int i = 0; i < allocations.size(); ++i) {
+    auto it = classes_.emplace(
+        std::make_pair(allocations[i].site, allocations[i].num_bytes),
+        offsets_.size());
+    if (it.second) offsets_.emplace_back();
+    offsets_[it.first->second].push_back(offsets[i]);
+  }
+}
+
+int TensorArenaPlan::Class(uint64 site, size_t num_bytes) const {
+  auto it = classes_.find(std::make_pair(site, num_bytes));
+  return it == classes_.end() ? -1 : it->second;
+}
+
+int64_t TensorArenaPlan::Offset(int allocation_class, int ordinal) const {
+  const std::vector<int64_t>& offsets = offsets_[allocation_class];
+  return ordinal < offsets.size() ? offsets[ordinal] : -1;
+}
+
+// Records the allocations of a step, and reports them to the planner when the
+// step finishes.
+class RecordingStepAllocator : public TensorArenaStepAllocator {
+ public:
+  RecordingStepAllocator(TensorArenaPlanner* planner, uint64 key)
+      : planner_(planner), key_(key), allocator_(planner->allocator_) {}
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    if (ptr == nullptr) return nullptr;
+    // Persistent allocations are never served from the slab, so they are not
+    // planned.
+    const bool record =
+        allocation_attr.lifetime != AllocationLifetime::kPersistent;
+    const uint64 site = record ? TensorArenaPlan::CurrentSite() : 0;
+    mutex_lock l(mu_);
+    DCHECK(!finished_);
+    if (!recording_done_ && record) {
+      live_.emplace(ptr, allocations_.size());
+      allocations_.push_back(
+          {num_bytes, clock_++, TensorArenaPlan::kNotFreed, site});
+    }
+    ++num_live_;
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    bool delete_self;
+    {
+      mutex_lock l(mu_);
+      if (!recording_done_) {
+        auto it = live_.find(ptr);
+        if (it != live_.end()) {
+          allocations_[it->second].free_time = clock_++;
+          live_.erase(it);
+        }
+      }
+      --num_live_;
+      delete_self = finished_ && num_live_ == 0;
+    }
+    allocator_->DeallocateRaw(ptr);
+    if (delete_self) delete this;
+  }
+
+  bool AllocatesOpaqueHandle() const override {
+    return allocator_->AllocatesOpaqueHandle();
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+  void FinishStep(const Status& status) override {
+    std::vector<TensorArenaPlan::Allocation> allocations;
+    {
+      mutex_lock l(mu_);
+      recording_done_ = true;
+      allocations = std::move(allocations_);
+      live_.clear();
+    }
+    planner_->SetPlan(
+        key_, status.ok() ? std::make_shared<const TensorArenaPlan>(allocations)
+                          : nullptr);
+
+    bool delete_self;
+    {
+      mutex_lock l(mu_);
+      finished_ = true;
+      delete_self = num_live_ == 0;
+    }
+    if (delete_self) delete this;
+  }
+
+ private:
+  TensorArenaPlanner* const planner_;
+  const uint64 key_;
+  Allocator* const allocator_;
+
+  mutex mu_;
+  bool recording_done_ TF_GUARDED_BY(mu_) = false;
+  bool finished_ TF_GUARDED_BY(mu_) = false;
+  int64_t clock_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_live_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<TensorArenaPlan::Allocation> allocations_ TF_GUARDED_BY(mu_);
+  // Maps each live allocation to its index in `allocations_`.
+  absl::flat_hash_map<void*, int> live_ TF_GUARDED_BY(mu_);
+};
+
+// Serves the allocations of a step from a slab, according to a plan.
+class PlannedStepAllocator : public TensorArenaStepAllocator {
+ public:
+  PlannedStepAllocator(Allocator* allocator,
+                       std::shared_ptr<const TensorArenaPlan> plan)
+      : allocator_(allocator),
+        plan_(std::move(plan)),
+        next_ordinal_(plan_->num_classes(), 0) {}
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    const int allocation_class =
+        allocation_attr.lifetime == AllocationLifetime::kPersistent
+            ? -1
+            : plan_->Class(TensorArenaPlan::CurrentSite(), num_bytes);
+    {
+      mutex_lock l(mu_);
+      DCHECK(!finished_);
+      ++num_live_;
+      if (allocation_class >= 0) {
+        const int64_t offset = plan_->Offset(
+            allocation_class, next_ordinal_[allocation_class]++);
+        if (offset >= 0 && MaybeAllocateSlab() &&
+            IsFree(offset, num_bytes) &&
+            reinterpret_cast<uintptr_t>(slab_ + offset) % alignment == 0) {
+          live_.emplace(offset, offset + num_bytes);
+          return slab_ + offset;
+        }
+      }
+    }
+    void* ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    if (ptr == nullptr) {
+      mutex_lock l(mu_);
+      --num_live_;
+    }
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    bool in_slab;
+    char* slab_to_free = nullptr;
+    bool delete_self;
+    {
+      mutex_lock l(mu_);
+      char* p = static_cast<char*>(ptr);
+      in_slab = slab_ != nullptr && p >= slab_ && p < slab_ + slab_size_;
+      if (in_slab) {
+        live_.erase(p - slab_);
+        if (finished_ && live_.empty()) slab_to_free = ReleaseSlab();
+      }
+      --num_live_;
+      delete_self = finished_ && num_live_ == 0;
+    }
+    if (!in_slab) allocator_->DeallocateRaw(ptr);
+    if (slab_to_free != nullptr) allocator_->DeallocateRaw(slab_to_free);
+    if (delete_self) delete this;
+  }
+
+  bool AllocatesOpaqueHandle() const override {
+    return allocator_->AllocatesOpaqueHandle();
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+  void FinishStep(const Status& status) override {
+    char* slab_to_free = nullptr;
+    bool delete_self;
+    {
+      mutex_lock l(mu_);
+      finished_ = true;
+      if (live_.empty()) slab_to_free = ReleaseSlab();
+      delete_self = num_live_ == 0;
+    }
+    if (slab_to_free != nullptr) allocator_->DeallocateRaw(slab_to_free);
+    if (delete_self) delete this;
+  }
+
+ private:
+  // Allocates the slab on the first planned allocation of the step. Returns
+  // false if the slab could not be allocated.
+  bool MaybeAllocateSlab() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (slab_ == nullptr && !slab_failed_) {
+      AllocationAttributes attr;
+      attr.retry_on_failure = false;
+      slab_ = static_cast<char*>(allocator_->AllocateRaw(
+          Allocator::kAllocatorAlignment, plan_->arena_size(), attr));
+      slab_size_ = plan_->arena_size();
+      slab_failed_ = slab_ == nullptr;
+      if (slab_failed_) {
+        VLOG(1) << "Could not allocate a tensor arena of "
+                << plan_->arena_size() << " bytes from " << allocator_->Name();
+      }
+    }
+    return slab_ != nullptr;
+  }
+
+  char* ReleaseSlab() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    char* slab = slab_;
+    slab_ = nullptr;
+    slab_size_ = 0;
+    return slab;
+  }
+
+  // Returns true if no live allocation overlaps with
+  // [offset, offset + num_bytes).
+  bool IsFree(int64_t offset, size_t num_bytes) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t end = offset + num_bytes;
+    auto it = live_.lower_bound(offset);
+    if (it != live_.end() && it->first < end) return false;
+    if (it != live_.begin() && std::prev(it)->second > offset) return false;
+    return true;
+  }
+
+  Allocator* const allocator_;
+  const std::shared_ptr<const TensorArenaPlan> plan_;
+
+  mutex mu_;
+  bool finished_ TF_GUARDED_BY(mu_) = false;
+  int64_t num_live_ TF_GUARDED_BY(mu_) = 0;
+  char* slab_ TF_GUARDED_BY(mu_) = nullptr;
+  size_t slab_size_ TF_GUARDED_BY(mu_) = 0;
+  bool slab_failed_ TF_GUARDED_BY(mu_) = false;
+  // The number of allocations of each class made so far in this step.
+  std::vector<int> next_ordinal_ TF_GUARDED_BY(mu_);
+  // Maps the offsets of live allocations in the slab to their end offsets.
+  std::map<int64_t, int64_t> live_ TF_GUARDED_BY(mu_);
+};
+
+TensorArenaPlanner::TensorArenaPlanner(Allocator* allocator, int max_plans)
+    : allocator_(allocator), max_plans_(max_plans) {}
+
+TensorArenaPlanner::~TensorArenaPlanner() {
+  mutex_lock l(mu_);
+  for (const auto& it : plans_) {
+    DCHECK(!it.second.recording) << "A recorded step is still running.";
+  }
+}
+
+TensorArenaStepAllocator* TensorArenaPlanner::StartStep(uint64 key) {
+  mutex_lock l(mu_);
+  auto it = plans_.find(key);
+  if (it == plans_.end()) {
+    if (plans_.size() >= max_plans_) return nullptr;
+    it = plans_.emplace(key, PlanState()).first;
+  }
+  PlanState& state = it->second;
+  if (state.plan != nullptr) {
+    if (state.plan->arena_size() == 0) return nullptr;
+    return new PlannedStepAllocator(allocator_, state.plan);
+  }
+  if (state.recording) {
+    // Another step with the same key is being recorded.
+    return nullptr;
+  }
+  state.recording = true;
+  return new RecordingStepAllocator(this, key);
+}
+
+void TensorArenaPlanner::SetPlan(uint64 key,
+                                 std::shared_ptr<const TensorArenaPlan> plan) {
+  mutex_lock l(mu_);
+  PlanState& state = plans_[key];
+  state.recording = false;
+  state.plan = std::move(plan);
+  if (state.plan != nullptr) {
+    VLOG(1) << "Planned a tensor arena of " << state.plan->arena_size()
+            << " bytes for key " << key;
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_TENSOR_ARENA_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_TENSOR_ARENA_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A memory plan for the temporary tensors of one step, computed from the
+// allocations that were recorded while running an earlier step with the same
+// inputs.
+//
+// Every allocation that was deallocated before the end of the recorded step is
+// assigned an offset in a single arena, such that allocations whose lifetimes
+// overlapped do not overlap in memory ("greedy by size", as in TensorFlow
+// Lite's `ArenaPlanner`). Allocations that outlived the step (e.g. fetched
+// tensors or tensors stored in variables) are not planned.
+//
+// Each allocation is identified by its site, which names the op and the kind
+// of allocation (output or temporary) that made it, and by its size. Later
+// steps are not guaranteed to allocate in the same order, so the k-th
+// allocation of N bytes at a site is mapped to the offset of the k-th
+// allocation of N bytes at the same site in the recorded step. Since the
+// site identifies the tensor rather than its position in the step, a tensor
+// that outlived the recorded step is not handed the offset of a temporary in
+// a later step. The plan is still only a hint, and the step allocator checks
+// that the range is free before using it.
+class TensorArenaPlan {
+ public:
+  // Sentinel value of `Allocation::free_time` for allocations that were not
+  // deallocated before the end of the recorded step.
+  static constexpr int64_t kNotFreed = -1;
+
+  struct Allocation {
+    size_t num_bytes;
+    // Logical timestamps of the allocation and deallocation events.
+    int64_t alloc_time;
+    int64_t free_time = kNotFreed;
+    // The site of the allocation, as returned by `CurrentSite()`.
+    uint64 site = 0;
+  };
+
+  // Returns the site of an allocation made by the calling thread, from the
+  // op name and region type of its current `ScopedMemoryDebugAnnotation`.
+  static uint64 CurrentSite();
+
+  // Builds a plan for `allocations`, which must be in allocation order.
+  explicit TensorArenaPlan(const std::vector<Allocation>& allocations);
+
+  TensorArenaPlan(const TensorArenaPlan&) = delete;
+  void operator=(const TensorArenaPlan&) = delete;
+
+  // The number of bytes needed to hold all planned allocations.
+  size_t arena_size() const { return arena_size_; }
+
+  // The number of distinct (site, size) pairs in the recorded step.
+  int num_classes() const { return offsets_.size(); }
+
+  // Returns the class of allocations of `num_bytes` bytes at `site`, or -1 if
+  // no such allocation was recorded.
+  int Class(uint64 site, size_t num_bytes) const;
+
+  // Returns the offset in the arena of the `ordinal`-th allocation of the
+  // given class, or -1 if that allocation was not planned.
+  int64_t Offset(int allocation_class, int ordinal) const;
+
+ private:
+  size_t arena_size_ = 0;
+  absl::flat_hash_map<std::pair<uint64, size_t>, int> classes_;
+  std::vector<std::vector<int64_t>> offsets_;
+};
+
+// An allocator that serves the allocations of a single step, returned by
+// `TensorArenaPlanner::StartStep()`.
+//
+// `FinishStep()` must be called once no more kernels of the step can run. The
+// allocator deletes itself once the step is finished and all of its
+// allocations have been deallocated, so tensors may safely outlive the step.
+class TensorArenaStepAllocator : public Allocator {
+ public:
+  // Marks the end of the step. `status` is the status of the step.
+  virtual void FinishStep(const Status& status) = 0;
+};
+
+// Recycles the memory of temporary tensors across steps of one callable.
+//
+// The first step for a given `key` (typically the shapes of the step's inputs)
+// runs with an allocator that records its allocation pattern and forwards to
+// the underlying allocator. Its pattern is turned into a `TensorArenaPlan`,
+// and later steps with the same key are served from one slab of
+// `arena_size()` bytes, allocated from the underlying allocator at the start
+// of the step. Allocations that do not match the plan are forwarded to the
+// underlying allocator, and so are allocations whose lifetime is
+// `AllocationLifetime::kPersistent`, which would pin the slab after the step.
+//
+// Compared to using the underlying allocator directly, this replaces one
+// allocation per tensor from a (potentially contended, shared) device
+// allocator by one allocation per step, and avoids fragmenting it with
+// short-lived tensors.
+//
+// This class is thread-safe, and concurrent steps use separate slabs.
+class TensorArenaPlanner {
+ public:
+  // Keeps plans for at most `max_plans` distinct keys; steps with other keys
+  // use the underlying allocator directly. `allocator` is not owned, and must
+  // outlive all of the step allocators returned by this planner.
+  TensorArenaPlanner(Allocator* allocator, int max_plans);
+  ~TensorArenaPlanner();
+
+  TensorArenaPlanner(const TensorArenaPlanner&) = delete;
+  void operator=(const TensorArenaPlanner&) = delete;
+
+  // Returns the allocator to use for a step identified by `key`, or nullptr if
+  // the step should use the underlying allocator.
+  TensorArenaStepAllocator* StartStep(uint64 key);
+
+ private:
+  friend class RecordingStepAllocator;
+
+  // Called by the recording step allocator for `key` when its step finishes.
+  // `plan` is null if the recorded step failed.
+  void SetPlan(uint64 key, std::shared_ptr<const TensorArenaPlan> plan);
+
+  struct PlanState {
+    // True while a step with this key is being recorded.
+    bool recording = false;
+    std::shared_ptr<const TensorArenaPlan> plan;
+  };
+
+  Allocator* const allocator_;
+  const int max_plans_;
+
+  mutex mu_;
+  absl::flat_hash_map<uint64, PlanState> plans_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_TENSOR_ARENA_H_
@@ -0,0 +1,276 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/tensor_arena.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards to the CPU allocator, and counts the calls.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    void* ptr = cpu_allocator()->AllocateRaw(alignment, num_bytes);
+    live_.emplace(ptr, num_bytes);
+    live_bytes_ += num_bytes;
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    auto it = live_.find(ptr);
+    live_bytes_ -= it->second;
+    live_.erase(it);
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+  int num_live() const { return live_.size(); }
+  size_t live_bytes() const { return live_bytes_; }
+
+ private:
+  int num_allocations_ = 0;
+  absl::flat_hash_map<void*, size_t> live_;
+  size_t live_bytes_ = 0;
+};
+
+TEST(TensorArenaPlanTest, ReusesMemoryOfDisjointLifetimes) {
+  TensorArenaPlan plan({{100, 0, 1}, {100, 2, 3}});
+  EXPECT_EQ(128, plan.arena_size());
+  ASSERT_EQ(1, plan.num_classes());
+  const int allocation_class = plan.Class(/*site=*/0, 100);
+  EXPECT_EQ(0, plan.Offset(allocation_class, 0));
+  EXPECT_EQ(0, plan.Offset(allocation_class, 1));
+  EXPECT_EQ(-1, plan.Offset(allocation_class, 2));
+  EXPECT_EQ(-1, plan.Class(/*site=*/0, 200));
+  EXPECT_EQ(-1, plan.Class(/*site=*/1, 100));
+}
+
+TEST(TensorArenaPlanTest, SeparatesOverlappingLifetimes) {
+  TensorArenaPlan plan({{64, 0, 3}, {200, 1, 2}, {64, 4, 5}});
+  EXPECT_EQ(256 + 64, plan.arena_size());
+  const int64_t large = plan.Offset(plan.Class(0, 200), 0);
+  const int64_t first_small = plan.Offset(plan.Class(0, 64), 0);
+  const int64_t second_small = plan.Offset(plan.Class(0, 64), 1);
+  // The largest allocation is placed first.
+  EXPECT_EQ(0, large);
+  EXPECT_EQ(256, first_small);
+  // The last allocation does not overlap in time with any other.
+  EXPECT_EQ(0, second_small);
+}
+
+TEST(TensorArenaPlanTest, DoesNotPlanAllocationsThatOutliveTheStep) {
+  TensorArenaPlan plan(
+      {{64, 0, TensorArenaPlan::kNotFreed}, {64, 1, 2}, {128, 3, 4}});
+  EXPECT_EQ(128, plan.arena_size());
+  EXPECT_EQ(-1, plan.Offset(plan.Class(0, 64), 0));
+  EXPECT_EQ(0, plan.Offset(plan.Class(0, 64), 1));
+  EXPECT_EQ(0, plan.Offset(plan.Class(0, 128), 0));
+}
+
+TEST(TensorArenaPlanTest, IndexesAllocationsBySite) {
+  TensorArenaPlan plan({{64, 0, 1, /*site=*/1}, {64, 2, 3, /*site=*/2}});
+  EXPECT_EQ(2, plan.num_classes());
+  EXPECT_EQ(0, plan.Offset(plan.Class(1, 64), 0));
+  EXPECT_EQ(0, plan.Offset(plan.Class(2, 64), 0));
+  EXPECT_EQ(-1, plan.Offset(plan.Class(2, 64), 1));
+}
+
+// Allocates and frees a chain of temporaries, like a sequence of unary ops,
+// and returns the final tensor.
+Tensor RunStep(Allocator* allocator, int num_ops) {
+  Tensor t(allocator, DT_FLOAT, TensorShape({16}));
+  for (int i = 0; i < num_ops; ++i) {
+    Tensor next(allocator, DT_FLOAT, TensorShape({16}));
+    next.flat<float>().setConstant(i);
+    t = next;
+  }
+  return t;
+}
+
+TEST(TensorArenaPlannerTest, ServesLaterStepsFromOneSlab) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/1);
+
+  // The first step is recorded, and allocates from the underlying allocator.
+  TensorArenaStepAllocator* step = planner.StartStep(/*key=*/1);
+  ASSERT_NE(nullptr, step);
+  RunStep(step, 10);
+  step->FinishStep(OkStatus());
+  EXPECT_EQ(11, underlying.num_allocations());
+  EXPECT_EQ(0, underlying.num_live());
+
+  // Later steps allocate a single slab.
+  for (int i = 0; i < 3; ++i) {
+    step = planner.StartStep(/*key=*/1);
+    ASSERT_NE(nullptr, step);
+    Tensor result = RunStep(step, 10);
+    step->FinishStep(OkStatus());
+    EXPECT_EQ(9.0f, result.flat<float>()(0));
+  }
+  EXPECT_EQ(11 + 3, underlying.num_allocations());
+  EXPECT_EQ(0, underlying.num_live());
+}
+
+TEST(TensorArenaPlannerTest, TensorsMayOutliveTheStep) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/1);
+  TensorArenaStepAllocator* step = planner.StartStep(/*key=*/1);
+  RunStep(step, 4);
+  step->FinishStep(OkStatus());
+
+  step = planner.StartStep(/*key=*/1);
+  Tensor result = RunStep(step, 4);
+  step->FinishStep(OkStatus());
+  // `result` keeps the slab alive.
+  EXPECT_EQ(1, underlying.num_live());
+  EXPECT_EQ(3.0f, result.flat<float>()(0));
+  result = Tensor();
+  EXPECT_EQ(0, underlying.num_live());
+}
+
+// Runs a step with two overlapping temporaries and a fetched result of the
+// same size, allocated by different ops. If `fetch_first`, the result is
+// allocated before the temporaries.
+Tensor RunStepWithFetch(Allocator* allocator, bool fetch_first) {
+  auto fetch = [allocator]() {
+    profiler::ScopedMemoryDebugAnnotation annotation("fetch");
+    Tensor result(allocator, DT_FLOAT, TensorShape({16}));
+    result.flat<float>().setConstant(1.0f);
+    return result;
+  };
+  Tensor result;
+  if (fetch_first) result = fetch();
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("temp");
+    Tensor a(allocator, DT_FLOAT, TensorShape({16}));
+    Tensor b(allocator, DT_FLOAT, TensorShape({16}));
+  }
+  if (!fetch_first) result = fetch();
+  return result;
+}
+
+TEST(TensorArenaPlannerTest, FetchedTensorsDoNotPinTheSlab) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/1);
+  TensorArenaStepAllocator* step = planner.StartStep(/*key=*/1);
+  RunStepWithFetch(step, /*fetch_first=*/false);
+  step->FinishStep(OkStatus());
+
+  // Later steps allocate the fetched tensor first, which used to hand it the
+  // offset of the first temporary. The fetched tensors survive several steps,
+  // and only their own memory stays allocated.
+  const size_t tensor_bytes = 16 * sizeof(float);
+  std::vector<Tensor> results;
+  for (int i = 0; i < 4; ++i) {
+    step = planner.StartStep(/*key=*/1);
+    ASSERT_NE(nullptr, step);
+    results.push_back(RunStepWithFetch(step, /*fetch_first=*/true));
+    step->FinishStep(OkStatus());
+    EXPECT_EQ(results.size(), underlying.num_live());
+    EXPECT_EQ(results.size() * tensor_bytes, underlying.live_bytes());
+  }
+  for (const Tensor& result : results) {
+    EXPECT_EQ(1.0f, result.flat<float>()(0));
+  }
+  results.clear();
+  EXPECT_EQ(0, underlying.num_live());
+}
+
+TEST(TensorArenaPlannerTest, DoesNotServePersistentAllocationsFromTheSlab) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/1);
+  TensorArenaStepAllocator* step = planner.StartStep(/*key=*/1);
+  RunStep(step, 4);
+  step->FinishStep(OkStatus());
+
+  step = planner.StartStep(/*key=*/1);
+  AllocationAttributes persistent;
+  persistent.lifetime = AllocationLifetime::kPersistent;
+  void* ptr = step->AllocateRaw(Allocator::kAllocatorAlignment, 64, persistent);
+  step->FinishStep(OkStatus());
+  // Only `ptr` is allocated: the slab was never needed.
+  EXPECT_EQ(1, underlying.num_live());
+  EXPECT_EQ(64, underlying.live_bytes());
+  step->DeallocateRaw(ptr);
+  EXPECT_EQ(0, underlying.num_live());
+}
+
+TEST(TensorArenaPlannerTest, ForwardsAllocationsThatDoNotMatchThePlan) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/1);
+  TensorArenaStepAllocator* step = planner.StartStep(/*key=*/1);
+  RunStep(step, 2);
+  step->FinishStep(OkStatus());
+  const int num_recorded = underlying.num_allocations();
+
+  step = planner.StartStep(/*key=*/1);
+  {
+    // More allocations than recorded, and of a different size.
+    Tensor a = RunStep(step, 4);
+    Tensor b(step, DT_FLOAT, TensorShape({1024}));
+    EXPECT_EQ(3.0f, a.flat<float>()(0));
+  }
+  step->FinishStep(OkStatus());
+  // One slab, the two unplanned allocations of the chain, and `b`.
+  EXPECT_EQ(num_recorded + 4, underlying.num_allocations());
+  EXPECT_EQ(0, underlying.num_live());
+}
+
+TEST(TensorArenaPlannerTest, RecordsOneStepPerKeyAtATime) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/2);
+  TensorArenaStepAllocator* first = planner.StartStep(/*key=*/1);
+  ASSERT_NE(nullptr, first);
+  EXPECT_EQ(nullptr, planner.StartStep(/*key=*/1));
+  TensorArenaStepAllocator* other = planner.StartStep(/*key=*/2);
+  ASSERT_NE(nullptr, other);
+  // No more keys are tracked.
+  EXPECT_EQ(nullptr, planner.StartStep(/*key=*/3));
+  first->FinishStep(OkStatus());
+  other->FinishStep(OkStatus());
+}
+
+TEST(TensorArenaPlannerTest, FailedStepIsRecordedAgain) {
+  CountingAllocator underlying;
+  TensorArenaPlanner planner(&underlying, /*max_plans=*/1);
+  TensorArenaStepAllocator* step = planner.StartStep(/*key=*/1);
+  RunStep(step, 2);
+  step->FinishStep(errors::Internal("failed"));
+  const int num_recorded = underlying.num_allocations();
+
+  // The next step is recorded again, so it does not allocate a slab.
+  step = planner.StartStep(/*key=*/1);
+  RunStep(step, 2);
+  step->FinishStep(OkStatus());
+  EXPECT_EQ(2 * num_recorded, underlying.num_allocations());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,191 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <utility>
+
+#include "absl/types/optional.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+namespace internal {
+
+// Identifies the work-stealing worker (if any) that is running on the current
+// thread.
+struct WorkStealingWorkerTls {
+  const void* queue = nullptr;
+  int worker = -1;
+};
+
+inline WorkStealingWorkerTls& CurrentWorkStealingWorker() {
+  static thread_local WorkStealingWorkerTls tls;
+  return tls;
+}
+
+}  // namespace internal
+
+// A set of per-worker double-ended queues of ready items, used by the executor
+// to keep newly-ready nodes on the thread that made them ready.
+//
+// Each worker owns one deque. The owner pushes and pops at the back (LIFO),
+// which favors nodes whose inputs are still hot in the owner's cache, while
+// idle workers steal from the front (FIFO) of other workers' deques.
+//
+// A worker "slot" is claimed by a closure running on some thread via
+// `TryClaimWorker()`, and released by `ReleaseWorker()`. At most
+// `num_workers()` workers are active at a time, which bounds the number of
+// closures that are handed to the inter-op thread pool per step.
+//
+// To avoid losing wakeups, a producer must call `Push()` *before* trying to
+// claim an idle worker, and a worker must call `HasWork()` *after* releasing
+// its slot; if work remains, it should try to re-claim its slot and continue.
+//
+// This class is thread-safe.
+template <typename T>
+class WorkStealingReadyQueue {
+ public:
+  explicit WorkStealingReadyQueue(int num_workers)
+      : num_workers_(num_workers),
+        workers_(std::make_unique<WorkerQueue[]>(num_workers)) {
+    DCHECK_GT(num_workers, 0);
+  }
+
+  WorkStealingReadyQueue(const WorkStealingReadyQueue&) = delete;
+  void operator=(const WorkStealingReadyQueue&) = delete;
+
+  int num_workers() const { return num_workers_; }
+
+  // Returns the index of the worker of this queue that is running on the
+  // current thread, or -1 if the current thread is not one of its workers.
+  int CurrentWorker() const {
+    const internal::WorkStealingWorkerTls& tls =
+        internal::CurrentWorkStealingWorker();
+    return tls.queue == this ? tls.worker : -1;
+  }
+
+  // Claims an idle worker slot and returns its index, or returns -1 if all
+  // `num_workers()` slots are already claimed.
+  int TryClaimWorker() {
+    const unsigned start = static_cast<unsigned>(
+        next_claim_.fetch_add(1, std::memory_order_relaxed));
+    for (int i = 0; i < num_workers_; ++i) {
+      const int worker = (start + i) % num_workers_;
+      if (TryClaimWorker(worker)) return worker;
+    }
+    return -1;
+  }
+
+  // Claims the given worker slot. Returns false if it is already claimed.
+  bool TryClaimWorker(int worker) {
+    bool expected = false;
+    return workers_[worker].claimed.compare_exchange_strong(expected, true);
+  }
+
+  void ReleaseWorker(int worker) {
+    DCHECK(workers_[worker].claimed.load());
+    workers_[worker].claimed.store(false);
+  }
+
+  // Adds `item` to the back of the deque owned by `worker`. If `worker` is
+  // negative, the item is assigned to a deque in round-robin order.
+  void Push(int worker, const T& item) {
+    if (worker < 0) {
+      worker = static_cast<unsigned>(next_push_.fetch_add(
+                   1, std::memory_order_relaxed)) %
+               num_workers_;
+    }
+    WorkerQueue& q = workers_[worker];
+    {
+      mutex_lock l(q.mu);
+      q.items.push_back(item);
+    }
+    num_queued_.fetch_add(1);
+  }
+
+  // Removes an item from the back of the deque owned by `worker`, or steals
+  // one from the front of another worker's deque if it is empty. Returns
+  // `absl::nullopt` if no item was found.
+  absl::optional<T> Pop(int worker) {
+    if (num_queued_.load() == 0) return absl::nullopt;
+    {
+      WorkerQueue& q = workers_[worker];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        absl::optional<T> item(std::move(q.items.back()));
+        q.items.pop_back();
+        num_queued_.fetch_sub(1);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_workers_; ++i) {
+      WorkerQueue& victim = workers_[(worker + i) % num_workers_];
+      mutex_lock l(victim.mu);
+      if (!victim.items.empty()) {
+        absl::optional<T> item(std::move(victim.items.front()));
+        victim.items.pop_front();
+        num_queued_.fetch_sub(1);
+        return item;
+      }
+    }
+    return absl::nullopt;
+  }
+
+  // Returns true if any deque may contain an item.
+  bool HasWork() const { return num_queued_.load() > 0; }
+
+  // Registers the current thread as `worker` of `queue` for the lifetime of
+  // this object, so that `CurrentWorker()` returns `worker`. Nested scopes
+  // (e.g. a function executed synchronously by a kernel) are supported.
+  class ScopedWorker {
+   public:
+    ScopedWorker(const WorkStealingReadyQueue* queue, int worker)
+        : saved_(internal::CurrentWorkStealingWorker()) {
+      internal::CurrentWorkStealingWorker() = {queue, worker};
+    }
+    ~ScopedWorker() { internal::CurrentWorkStealingWorker() = saved_; }
+
+    ScopedWorker(const ScopedWorker&) = delete;
+    void operator=(const ScopedWorker&) = delete;
+
+   private:
+    const internal::WorkStealingWorkerTls saved_;
+  };
+
+ private:
+  // Aligned to avoid false sharing between the deques of different workers,
+  // assuming the cacheline size is 64 bytes or smaller.
+  struct alignas(64) WorkerQueue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+    std::atomic<bool> claimed{false};
+  };
+
+  const int num_workers_;
+  std::unique_ptr<WorkerQueue[]> workers_;
+  std::atomic<int64_t> num_queued_{0};
+  std::atomic<int> next_claim_{0};
+  std::atomic<int> next_push_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
+
+#include <atomic>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingReadyQueueTest, OwnerPopsLifo) {
+  WorkStealingReadyQueue<int> queue(2);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  queue.Push(0, 3);
+  EXPECT_TRUE(queue.HasWork());
+  EXPECT_EQ(3, *queue.Pop(0));
+  EXPECT_EQ(2, *queue.Pop(0));
+  EXPECT_EQ(1, *queue.Pop(0));
+  EXPECT_FALSE(queue.Pop(0).has_value());
+  EXPECT_FALSE(queue.HasWork());
+}
+
+TEST(WorkStealingReadyQueueTest, ThiefStealsFifo) {
+  WorkStealingReadyQueue<int> queue(2);
+  queue.Push(0, 1);
+  queue.Push(0, 2);
+  EXPECT_EQ(1, *queue.Pop(1));
+  EXPECT_EQ(2, *queue.Pop(1));
+  EXPECT_FALSE(queue.Pop(1).has_value());
+}
+
+TEST(WorkStealingReadyQueueTest, ClaimAndRelease) {
+  WorkStealingReadyQueue<int> queue(2);
+  const int w0 = queue.TryClaimWorker();
+  const int w1 = queue.TryClaimWorker();
+  EXPECT_GE(w0, 0);
+  EXPECT_GE(w1, 0);
+  EXPECT_NE(w0, w1);
+  EXPECT_EQ(-1, queue.TryClaimWorker());
+  EXPECT_FALSE(queue.TryClaimWorker(w0));
+  queue.ReleaseWorker(w0);
+  EXPECT_TRUE(queue.TryClaimWorker(w0));
+  queue.ReleaseWorker(w0);
+  queue.ReleaseWorker(w1);
+}
+
+TEST(WorkStealingReadyQueueTest, ScopedWorker) {
+  WorkStealingReadyQueue<int> queue(4);
+  WorkStealingReadyQueue<int> other(4);
+  EXPECT_EQ(-1, queue.CurrentWorker());
+  {
+    WorkStealingReadyQueue<int>::ScopedWorker outer(&queue, 2);
+    EXPECT_EQ(2, queue.CurrentWorker());
+    EXPECT_EQ(-1, other.CurrentWorker());
+    {
+      WorkStealingReadyQueue<int>::ScopedWorker inner(&other, 1);
+      EXPECT_EQ(-1, queue.CurrentWorker());
+      EXPECT_EQ(1, other.CurrentWorker());
+    }
+    EXPECT_EQ(2, queue.CurrentWorker());
+  }
+  EXPECT_EQ(-1, queue.CurrentWorker());
+}
+
+TEST(WorkStealingReadyQueueTest, ConcurrentPushAndSteal) {
+  constexpr int kNumWorkers = 8;
+  constexpr int kItemsPerWorker = 10000;
+  WorkStealingReadyQueue<int> queue(kNumWorkers);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+  {
+    thread::ThreadPool pool(Env::Default(), "test", kNumWorkers);
+    for (int w = 0; w < kNumWorkers; ++w) {
+      pool.Schedule([&queue, &sum, &popped, w]() {
+        // Each worker produces its items, interleaving pops so that other
+        // workers can steal from its deque.
+        for (int i = 1; i <= kItemsPerWorker; ++i) {
+          queue.Push(w, i);
+          if (i % 3 == 0) {
+            if (absl::optional<int> item = queue.Pop(w)) {
+              sum += *item;
+              ++popped;
+            }
+          }
+        }
+        while (popped.load() < kNumWorkers * kItemsPerWorker) {
+          if (absl::optional<int> item = queue.Pop(w)) {
+            sum += *item;
+            ++popped;
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(kNumWorkers * kItemsPerWorker, popped.load());
+  EXPECT_EQ(static_cast<int64_t>(kNumWorkers) * kItemsPerWorker *
+                (kItemsPerWorker + 1) / 2,
+            sum.load());
+  EXPECT_FALSE(queue.HasWork());
+}
+
+}  // namespace
+}  // namespace tensorflow
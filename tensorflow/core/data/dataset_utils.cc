@@ -91,6 +91,8 @@ constexpr char kShuffleAndRepeatFusionOpt[] = "shuffle_and_repeat_fusion";
 constexpr char kFilterFusionOpt[] = "filter_fusion";
 constexpr char kMapAndFilterFusionOpt[] = "map_and_filter_fusion";
 constexpr char kMapFusionOpt[] = "map_fusion";
+constexpr char kMapBatchingOpt[] = "map_batching";
+constexpr char kMapBatchSizeOpt[] = "batch_size";
 constexpr char kParallelBatchOpt[] = "parallel_batch";
 constexpr char kAutotuneBufferSizesOpt[] = "autotune_buffer_sizes";
 constexpr char kDisablePrefetchLegacyAutotuneOpt[] =
@@ -224,6 +226,9 @@ void DefaultOptimizationGraphRewrites(
       optimization_disabled->insert(kInjectPrefetchOpt);
     }
   }
+  if (optimization_options.map_batch_size() > 1) {
+    optimization_enabled->insert(kMapBatchingOpt);
+  }
 }
 
 // Returns whether an op has been allowlisted as stateless. Uses a heuristic to
@@ -779,7 +784,7 @@ Status ProcessBatch(int64_t batch_size, int64_t num_elements,
 }
 
 Status CopyBatch(CopyBatchParams params,
-                 const std::vector<std::vector<Tensor>>& batch_elements,
+                 std::vector<std::vector<Tensor>>&& batch_elements,
                  bool parallel_copy,
                  std::function<Status()> allocation_callback,
                  std::vector<Tensor>* out_tensors) {
@@ -904,6 +909,11 @@ absl::flat_hash_set<tstring> CreateGraphRewriteConfigs(const Options& options) {
     configs.insert(
         absl::StrCat(kSlackOpt, ":", kSlackPeriodOpt, ":", num_devices));
   }
+  if (options.optimization_options().map_batch_size() > 1) {
+    configs.insert(absl::StrCat(
+        kMapBatchingOpt, ":", kMapBatchSizeOpt, ":",
+        options.optimization_options().map_batch_size()));
+  }
   return configs;
 }
 
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/framework/variant_tensor_data.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/test.h"
@@ -672,13 +673,15 @@ GetOptimizationsTestCase GetOptimizationTestCase4() {
   options.mutable_optimization_options()->set_parallel_batch(true);
   options.mutable_optimization_options()->set_shuffle_and_repeat_fusion(true);
   options.mutable_optimization_options()->set_inject_prefetch(true);
+  options.mutable_optimization_options()->set_map_batch_size(16);
   options.set_slack(true);
   return {options,
           /*expected_enabled=*/
           {"filter_fusion", "filter_parallelization", "make_sloppy",
-           "map_and_batch_fusion", "map_and_filter_fusion", "map_fusion",
-           "map_parallelization", "noop_elimination", "parallel_batch",
-           "shuffle_and_repeat_fusion", "slack", "inject_prefetch"},
+           "map_and_batch_fusion", "map_and_filter_fusion", "map_batching",
+           "map_fusion", "map_parallelization", "noop_elimination",
+           "parallel_batch", "shuffle_and_repeat_fusion", "slack",
+           "inject_prefetch"},
           /*expected_disabled=*/{},
           /*expected_default=*/{}};
 }
@@ -723,6 +726,16 @@ TEST(DeterministicOpsTest, GetOptimizations) {
 #endif
 }
 
+TEST(DatasetUtilsTest, CreateGraphRewriteConfigsMapBatchSize) {
+  Options options;
+  EXPECT_THAT(CreateGraphRewriteConfigs(options),
+              ::testing::Not(::testing::Contains(
+                  ::testing::StartsWith("map_batching:"))));
+  options.mutable_optimization_options()->set_map_batch_size(16);
+  EXPECT_THAT(CreateGraphRewriteConfigs(options),
+              ::testing::Contains("map_batching:batch_size:16"));
+}
+
 REGISTER_DATASET_EXPERIMENT("test_only_experiment",
                             RandomJobSamplePercentage<42>, AllTasks);
 
@@ -747,6 +760,54 @@ TEST(DatasetUtilsTest, CountBytes) {
   EXPECT_EQ(GetTotalBytes(compressed), compressed_element.ByteSizeLong());
 }
 
+// A variant value that counts the times it is copied.
+struct CopyCountingValue {
+  CopyCountingValue() = default;
+  explicit CopyCountingValue(int* num_copies) : num_copies(num_copies) {}
+  CopyCountingValue(const CopyCountingValue& other)
+      : num_copies(other.num_copies) {
+    if (num_copies != nullptr) ++*num_copies;
+  }
+  CopyCountingValue& operator=(const CopyCountingValue& other) {
+    num_copies = other.num_copies;
+    if (num_copies != nullptr) ++*num_copies;
+    return *this;
+  }
+  CopyCountingValue(CopyCountingValue&&) = default;
+  CopyCountingValue& operator=(CopyCountingValue&&) = default;
+
+  string TypeName() const { return "CopyCountingValue"; }
+  void Encode(VariantTensorData* data) const {}
+  bool Decode(const VariantTensorData& data) { return true; }
+
+  int* num_copies = nullptr;
+};
+
+TEST(DatasetUtilsTest, CopyBatchMovesUnsharedVariants) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<TestContext> test_ctx,
+                          TestContext::Create());
+  IteratorContext::Params params(test_ctx->op_ctx());
+  IteratorContext iter_ctx(params);
+
+  int num_copies = 0;
+  Tensor shared(DT_VARIANT, TensorShape({}));
+  shared.scalar<Variant>()() = CopyCountingValue(&num_copies);
+  std::vector<std::vector<Tensor>> batch_elements(2);
+  batch_elements[0].push_back(shared);
+  batch_elements[1].emplace_back(DT_VARIANT, TensorShape({}));
+  batch_elements[1][0].scalar<Variant>()() = CopyCountingValue(&num_copies);
+
+  std::vector<Tensor> batch;
+  TF_ASSERT_OK(CopyBatch(CopyBatchParams(&iter_ctx), std::move(batch_elements),
+                         /*parallel_copy=*/false,
+                         /*allocation_callback=*/nullptr, &batch));
+  ASSERT_EQ(batch.size(), 1);
+  EXPECT_EQ(batch[0].shape(), TensorShape({2}));
+  // Only the value that is still referenced by `shared` is copied.
+  EXPECT_EQ(num_copies, 1);
+  EXPECT_NE(shared.scalar<Variant>()().get<CopyCountingValue>(), nullptr);
+}
+
 TEST_F(DatasetOpsTestBase, TestVariantEqualityChecking) {
   Tensor scalar_0{DT_VARIANT, TensorShape({})};
   scalar_0.scalar<Variant>()() = TestVariant({CreateTensor<int64_t>({}, {0})});
@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/file_cache_store.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/stringprintf.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Holds the time in microseconds at which the entry was last used. The time is
+// written in the file rather than taken from its modification time, which not
+// all file systems report.
+constexpr char kLastUsedFile[] = "LAST_USED";
+constexpr char kLockFileSuffix[] = ".lockfile";
+
+struct Entry {
+  std::string dir;
+  int64_t bytes = 0;
+  int64_t last_used_micros = 0;
+  bool locked = false;
+};
+
+Status ReadEntry(Env* env, const std::string& dir, Entry* entry) {
+  entry->dir = dir;
+  std::vector<std::string> children;
+  TF_RETURN_IF_ERROR(env->GetChildren(dir, &children));
+  for (const std::string& child : children) {
+    const std::string path = io::JoinPath(dir, child);
+    if (absl::EndsWith(child, kLockFileSuffix)) entry->locked = true;
+    if (child == kLastUsedFile) {
+      std::string contents;
+      if (ReadFileToString(env, path, &contents).ok()) {
+        absl::SimpleAtoi(contents, &entry->last_used_micros);
+      }
+    }
+    uint64 size;
+    if (env->GetFileSize(path, &size).ok()) entry->bytes += size;
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+FileCacheStore::FileCacheStore(Env* env, std::string cache_dir,
+                               int64_t max_bytes)
+    : env_(env), cache_dir_(std::move(cache_dir)), max_bytes_(max_bytes) {}
+
+StatusOr<std::string> FileCacheStore::GetEntry(uint64 fingerprint) const {
+  const std::string entry_dir = io::JoinPath(
+      cache_dir_,
+      strings::Printf("%016llx", static_cast<unsigned long long>(fingerprint)));
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(entry_dir));
+  TF_RETURN_IF_ERROR(Touch(entry_dir));
+  return entry_dir;
+}
+
+Status FileCacheStore::Touch(const std::string& entry_dir) const {
+  return WriteStringToFile(env_, io::JoinPath(entry_dir, kLastUsedFile),
+                           absl::StrCat(env_->NowMicros()));
+}
+
+Status FileCacheStore::EvictLeastRecentlyUsed(
+    const std::string& keep_entry_dir) const {
+  if (max_bytes_ <= 0) return OkStatus();
+  std::vector<std::string> children;
+  TF_RETURN_IF_ERROR(env_->GetChildren(cache_dir_, &children));
+  std::vector<Entry> entries;
+  int64_t total_bytes = 0;
+  for (const std::string& child : children) {
+    const std::string dir = io::JoinPath(cache_dir_, child);
+    if (!env_->IsDirectory(dir).ok()) continue;
+    Entry entry;
+    // Another job may have evicted the entry in the meantime.
+    if (!ReadEntry(env_, dir, &entry).ok()) continue;
+    total_bytes += entry.bytes;
+    if (entry.locked || dir == keep_entry_dir) continue;
+    entries.push_back(std::move(entry));
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              return a.last_used_micros < b.last_used_micros;
+            });
+  for (const Entry& entry : entries) {
+    if (total_bytes <= max_bytes_) break;
+    int64_t undeleted_files, undeleted_dirs;
+    Status s = env_->DeleteRecursively(entry.dir, &undeleted_files,
+                                       &undeleted_dirs);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to evict the cache entry " << entry.dir << ": "
+                   << s;
+      continue;
+    }
+    VLOG(1) << "Evicted the cache entry " << entry.dir << " of "
+            << entry.bytes << " bytes";
+    total_bytes -= entry.bytes;
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,65 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_FILE_CACHE_STORE_H_
+#define TENSORFLOW_CORE_DATA_FILE_CACHE_STORE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// An on-disk store of `CacheDataset` file caches keyed by the fingerprint of
+// the input pipeline, which jobs running the same pipeline can share.
+//
+// Each entry is a subdirectory of `cache_dir` named after the fingerprint,
+// holding the cache files and a file recording when the entry was last used.
+// When the entries take more than `max_bytes`, the least recently used ones
+// are deleted, except for entries that are still being written (i.e. that
+// have cache lock files).
+//
+// Jobs may use the same store concurrently: an object of this class holds no
+// state besides its options.
+class FileCacheStore {
+ public:
+  // If `max_bytes` is 0, entries are never evicted.
+  FileCacheStore(Env* env, std::string cache_dir, int64_t max_bytes);
+
+  // Creates the directory of the entry for `fingerprint` if needed, marks the
+  // entry as used, and returns the directory.
+  StatusOr<std::string> GetEntry(uint64 fingerprint) const;
+
+  // Marks the entry in `entry_dir` as used now.
+  Status Touch(const std::string& entry_dir) const;
+
+  // Deletes the least recently used entries other than `keep_entry_dir` until
+  // the store takes at most `max_bytes`.
+  Status EvictLeastRecentlyUsed(const std::string& keep_entry_dir) const;
+
+ private:
+  Env* const env_;
+  const std::string cache_dir_;
+  const int64_t max_bytes_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_FILE_CACHE_STORE_H_
@@ -0,0 +1,95 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/file_cache_store.h"
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr int64_t kEntryBytes = 1000;
+
+std::string CacheDir(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+// Writes `kEntryBytes` of cache data to the entry with the given fingerprint.
+std::string WriteEntry(const FileCacheStore& store, uint64 fingerprint) {
+  auto entry_dir = store.GetEntry(fingerprint);
+  TF_CHECK_OK(entry_dir.status());
+  TF_CHECK_OK(WriteStringToFile(Env::Default(),
+                                io::JoinPath(*entry_dir, "cache.data"),
+                                std::string(kEntryBytes, 'x')));
+  // Gives the entries distinct last use times.
+  Env::Default()->SleepForMicroseconds(1000);
+  return *entry_dir;
+}
+
+TEST(FileCacheStoreTest, EntriesAreKeyedByFingerprint) {
+  FileCacheStore store(Env::Default(), CacheDir("keyed"), /*max_bytes=*/0);
+  TF_ASSERT_OK_AND_ASSIGN(std::string entry, store.GetEntry(42));
+  TF_ASSERT_OK_AND_ASSIGN(std::string same_entry, store.GetEntry(42));
+  TF_ASSERT_OK_AND_ASSIGN(std::string other_entry, store.GetEntry(43));
+  EXPECT_EQ(entry, same_entry);
+  EXPECT_NE(entry, other_entry);
+  TF_EXPECT_OK(Env::Default()->IsDirectory(entry));
+}
+
+TEST(FileCacheStoreTest, EvictsLeastRecentlyUsedEntries) {
+  FileCacheStore store(Env::Default(), CacheDir("lru"),
+                       /*max_bytes=*/2 * kEntryBytes + 100);
+  const std::string first = WriteEntry(store, 1);
+  const std::string second = WriteEntry(store, 2);
+  const std::string third = WriteEntry(store, 3);
+  // Using the first entry again makes the second the least recently used.
+  TF_ASSERT_OK(store.Touch(first));
+
+  TF_ASSERT_OK(store.EvictLeastRecentlyUsed(/*keep_entry_dir=*/third));
+  TF_EXPECT_OK(Env::Default()->IsDirectory(first));
+  EXPECT_FALSE(Env::Default()->IsDirectory(second).ok());
+  TF_EXPECT_OK(Env::Default()->IsDirectory(third));
+}
+
+TEST(FileCacheStoreTest, KeepsEntriesBeingWritten) {
+  FileCacheStore store(Env::Default(), CacheDir("locked"),
+                       /*max_bytes=*/kEntryBytes);
+  const std::string first = WriteEntry(store, 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(),
+                                 io::JoinPath(first, "cache_0.lockfile"), ""));
+  const std::string second = WriteEntry(store, 2);
+
+  TF_ASSERT_OK(store.EvictLeastRecentlyUsed(/*keep_entry_dir=*/second));
+  TF_EXPECT_OK(Env::Default()->IsDirectory(first));
+  TF_EXPECT_OK(Env::Default()->IsDirectory(second));
+}
+
+TEST(FileCacheStoreTest, NoLimit) {
+  FileCacheStore store(Env::Default(), CacheDir("unlimited"),
+                       /*max_bytes=*/0);
+  const std::string first = WriteEntry(store, 1);
+  const std::string second = WriteEntry(store, 2);
+  TF_ASSERT_OK(store.EvictLeastRecentlyUsed(/*keep_entry_dir=*/second));
+  TF_EXPECT_OK(Env::Default()->IsDirectory(first));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -50,6 +50,7 @@ constexpr char kIntraOpParallelism[] = "intra_op_parallelism";
 constexpr char kMemBandwidth[] = "mem_bw_used_megabytes_per_sec";
 constexpr char kPrivateThreadpoolSize[] = "threadpool_size";
 constexpr char kRamBudget[] = "ram_budget_megabytes";
+constexpr char kTargetThroughput[] = "target_throughput";
 constexpr char kRamUsage[] = "ram_usage_megabytes";
 constexpr char kMaxBufferBytes[] = "max_buffered_megabytes";
 constexpr char kWarmStart[] = "warm_start";
@@ -90,6 +91,8 @@ void SetRootDatasetParams(const Options& options, RootDataset::Params* params) {
   }
   params->autotune_ram_budget_from_options =
       options.autotune_options().ram_budget();
+  params->autotune_target_throughput =
+      options.autotune_options().target_throughput();
   double ram_budget_share;
   if (experiments.contains("autotune_buffer_optimization")) {
     // When running this experiment, increase the ram_budget since it already
@@ -116,6 +119,11 @@ void AddTraceMetadata(const RootDataset::Params& params, const Options& options,
     trace_metadata->push_back(std::make_pair(
         kRamBudget,
         strings::Printf("%lld", static_cast<long long>(ram_budget / 1.0e6))));
+    if (params.autotune_target_throughput > 0) {
+      trace_metadata->push_back(std::make_pair(
+          kTargetThroughput,
+          strings::Printf("%.2f", params.autotune_target_throughput)));
+    }
   }
   if (params.max_intra_op_parallelism >= 0) {
     trace_metadata->push_back(std::make_pair(
@@ -202,6 +210,8 @@ class RootDataset::Iterator : public DatasetIterator<RootDataset> {
       if (experiments.contains("autotune_buffer_optimization")) {
         model_->AddExperiment("autotune_buffer_optimization");
       }
+      model_->SetTargetThroughput(
+          dataset()->params_.autotune_target_throughput);
     }
     IteratorContext iter_ctx(CreateParams(ctx));
     TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(&iter_ctx, this,
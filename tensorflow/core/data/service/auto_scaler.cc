@@ -96,12 +96,27 @@ void ReplaceOutliers(const absl::flat_hash_map<T, double>& rates,
   }
 }
 
-std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
-    TF_LOCKS_EXCLUDED(mu_) {
-  tsl::mutex_lock l(mu_);
+namespace {
+
+// Limits the estimate to wait for target processing times to converge to a
+// feasible value. First, start increasing exponentially by 4x. Once increases
+// are greater than 500, scale linearly. The estimate is limited to at most 100k
+// workers.
+int64_t BoundNumberOfWorkers(int64_t number_of_workers,
+                             int64_t current_number_of_workers) {
+  if (number_of_workers > current_number_of_workers * 4 ||
+      number_of_workers > current_number_of_workers + 500) {
+    number_of_workers = std::min(current_number_of_workers * 4,
+                                 current_number_of_workers + 500);
+  }
+  return std::min(number_of_workers, int64_t{100000});
+}
 
-  if (worker_throughputs_.empty() || consumption_rates_.empty())
-    return std::nullopt;
+}  // namespace
+
+std::optional<double> AutoScaler::GetConsumptionRate() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (consumption_rates_.empty()) return std::nullopt;
 
   std::vector<double> consumption_rates_without_outliers;
   // TODO(armandouv): Discard outlier replacement when we ensure reported time
@@ -110,9 +125,13 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
   // low).
   ReplaceOutliers(consumption_rates_, consumption_rates_without_outliers,
                   kAutoScalerOutlierSigmas);
-  double consumption_rates_sum_ =
-      std::accumulate(consumption_rates_without_outliers.begin(),
-                      consumption_rates_without_outliers.end(), 0.0);
+  return std::accumulate(consumption_rates_without_outliers.begin(),
+                         consumption_rates_without_outliers.end(), 0.0);
+}
+
+std::optional<double> AutoScaler::GetAverageWorkerThroughput() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (worker_throughputs_.empty()) return std::nullopt;
 
   std::vector<double> worker_throughputs_without_outliers;
   ReplaceOutliers(worker_throughputs_, worker_throughputs_without_outliers,
@@ -121,15 +140,81 @@ std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
       std::accumulate(worker_throughputs_without_outliers.begin(),
                       worker_throughputs_without_outliers.end(), 0.0);
 
-  double average_worker_throughput =
-      worker_throughputs_sum_ / static_cast<double>(worker_throughputs_.size());
+  return worker_throughputs_sum_ /
+         static_cast<double>(worker_throughputs_.size());
+}
+
+std::optional<int64_t> AutoScaler::GetOptimalNumberOfWorkers() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+
+  std::optional<double> consumption_rate = GetConsumptionRate();
+  std::optional<double> average_worker_throughput =
+      GetAverageWorkerThroughput();
+  if (!consumption_rate || !average_worker_throughput) return std::nullopt;
 
   int64_t optimal_number_of_workers =
-      ceil(consumption_rates_sum_ / average_worker_throughput);
+      ceil(*consumption_rate / *average_worker_throughput);
 
   return std::max(int64_t{1}, optimal_number_of_workers);
 }
 
+void AutoScaler::RecordWorkload(absl::Time time) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  std::optional<double> consumption_rate = GetConsumptionRate();
+  if (!consumption_rate) return;
+
+  workload_history_.emplace_back(time, *consumption_rate);
+  while (workload_history_.front().first < time - kWorkloadHistoryWindow) {
+    workload_history_.pop_front();
+  }
+}
+
+std::optional<int64_t> AutoScaler::GetPredictedNumberOfWorkers(
+    absl::Time time) const TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+
+  std::optional<double> consumption_rate = GetConsumptionRate();
+  std::optional<double> average_worker_throughput =
+      GetAverageWorkerThroughput();
+  if (!consumption_rate || !average_worker_throughput) return std::nullopt;
+
+  double predicted_consumption_rate = *consumption_rate;
+  if (workload_history_.size() >= 2) {
+    // Fits the recorded consumption rates by least squares, with times in
+    // seconds relative to the oldest sample.
+    const absl::Time origin = workload_history_.front().first;
+    double mean_time = 0.0;
+    double mean_rate = 0.0;
+    for (const auto& [sample_time, rate] : workload_history_) {
+      mean_time += absl::ToDoubleSeconds(sample_time - origin);
+      mean_rate += rate;
+    }
+    mean_time /= workload_history_.size();
+    mean_rate /= workload_history_.size();
+    double covariance = 0.0;
+    double variance = 0.0;
+    for (const auto& [sample_time, rate] : workload_history_) {
+      double t = absl::ToDoubleSeconds(sample_time - origin) - mean_time;
+      covariance += t * (rate - mean_rate);
+      variance += t * t;
+    }
+    if (variance > 0.0) {
+      double slope = covariance / variance;
+      // Extrapolates from the current consumption rate, which may already
+      // include reports newer than the latest sample.
+      predicted_consumption_rate +=
+          slope *
+          absl::ToDoubleSeconds(time - workload_history_.back().first);
+    }
+  }
+
+  int64_t predicted_number_of_workers = ceil(
+      std::max(predicted_consumption_rate, 0.0) / *average_worker_throughput);
+
+  return std::max(int64_t{1}, predicted_number_of_workers);
+}
+
 tsl::Status AutoScaler::ReportProcessingTime(const std::string& worker_address,
                                              absl::Duration processing_time)
     TF_LOCKS_EXCLUDED(mu_) {
@@ -221,18 +306,8 @@ tsl::Status MultipleIterationsAutoScaler::UpdateOptimalNumberOfWorkersMetric(
   VLOG(3) << "Estimated optimal number of workers: "
           << optimal_number_of_workers.value();
 
-  // Limit the estimate to wait for target processing times to converge to a
-  // feasible value. First, start increasing exponentially by 4x. Once
-  // increases are greater than 500, scale linearly.
-  int64_t bound_optimal_number_of_workers = optimal_number_of_workers.value();
-  if (bound_optimal_number_of_workers > current_number_of_workers * 4 ||
-      bound_optimal_number_of_workers > current_number_of_workers + 500) {
-    bound_optimal_number_of_workers = std::min(current_number_of_workers * 4,
-                                               current_number_of_workers + 500);
-  }
-  // Limit the estimate to at most 100k workers.
-  bound_optimal_number_of_workers =
-      std::min(bound_optimal_number_of_workers, int64_t{100000});
+  int64_t bound_optimal_number_of_workers = BoundNumberOfWorkers(
+      optimal_number_of_workers.value(), current_number_of_workers);
   VLOG(3) << "Bound optimal number of workers: "
           << bound_optimal_number_of_workers;
 
@@ -310,5 +385,37 @@ tsl::Status MultipleIterationsAutoScaler::RemoveConsumer(int64_t iteration_id,
   return status;
 }
 
+void MultipleIterationsAutoScaler::RecordWorkload(absl::Time time)
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::tf_shared_lock l(mu_);
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    auto_scaler->RecordWorkload(time);
+  }
+}
+
+absl::flat_hash_map<int64_t, MultipleIterationsAutoScaler::WorkerTarget>
+MultipleIterationsAutoScaler::GetWorkerTargets(
+    absl::Time time, int64_t current_number_of_workers) const
+    TF_LOCKS_EXCLUDED(mu_) {
+  // Lets the targets grow from at least one worker.
+  current_number_of_workers = std::max(current_number_of_workers, int64_t{1});
+  absl::flat_hash_map<int64_t, WorkerTarget> targets;
+  tsl::tf_shared_lock l(mu_);
+  for (const auto& [iteration_id, auto_scaler] : auto_scalers_) {
+    std::optional<int64_t> optimal_number_of_workers =
+        auto_scaler->GetOptimalNumberOfWorkers();
+    std::optional<int64_t> predicted_number_of_workers =
+        auto_scaler->GetPredictedNumberOfWorkers(time);
+    if (!optimal_number_of_workers || !predicted_number_of_workers) continue;
+
+    WorkerTarget& target = targets[iteration_id];
+    target.optimal_number_of_workers = BoundNumberOfWorkers(
+        *optimal_number_of_workers, current_number_of_workers);
+    target.predicted_number_of_workers = BoundNumberOfWorkers(
+        *predicted_number_of_workers, current_number_of_workers);
+  }
+  return targets;
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -17,9 +17,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_AUTO_SCALER_H_
 
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
@@ -63,10 +65,17 @@ namespace data {
 // follows:
 //  N = (Sum of CRs reported by all consumers) /
 //      (Average of WTs reported by all workers)
+// 3. When `RecordWorkload` is called periodically, it also keeps the sum of CRs
+// over the last `kWorkloadHistoryWindow`, and predicts the number of workers
+// needed at a later time by extrapolating the linear trend of that sum. This
+// allows scaling workers ahead of demand, e.g. while trainers scale up.
 //
 // AutoScaler is thread-safe.
 class AutoScaler {
  public:
+  // The consumption rate samples older than this are not used for predictions.
+  static constexpr absl::Duration kWorkloadHistoryWindow = absl::Minutes(10);
+
   AutoScaler() = default;
   // Returns the estimated optimal number of workers according to the current
   // observed workload. If there are no previously reported processing and
@@ -94,14 +103,37 @@ class AutoScaler {
   // target processing time from consideration of the current workload
   // estimation. Returns an error if the specified consumer does not exist.
   tsl::Status RemoveConsumer(int64_t consumer_id) TF_LOCKS_EXCLUDED(mu_);
+  // Records the sum of the current consumption rates as observed at `time`.
+  // Does nothing if there are no reported target processing times.
+  void RecordWorkload(absl::Time time) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the number of workers predicted to be needed at `time`, which is
+  // usually in the future, from the trend of the workload recorded within
+  // `kWorkloadHistoryWindow` of the latest sample. With fewer than two samples,
+  // this is the same as `GetOptimalNumberOfWorkers()`. If there are no
+  // previously reported processing and target processing times, returns
+  // nullopt.
+  std::optional<int64_t> GetPredictedNumberOfWorkers(absl::Time time) const
+      TF_LOCKS_EXCLUDED(mu_);
 
  private:
+  // Returns the sum of the consumption rates, with outliers replaced, or
+  // nullopt if there are none.
+  std::optional<double> GetConsumptionRate() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Returns the average worker throughput, with outliers replaced, or nullopt
+  // if there are none.
+  std::optional<double> GetAverageWorkerThroughput() const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   mutable tsl::mutex mu_;
   // Map from worker address to worker throughput.
   absl::flat_hash_map<std::string, double> worker_throughputs_
       TF_GUARDED_BY(mu_);
   // Map from consumer id to consumption rate.
   absl::flat_hash_map<int64_t, double> consumption_rates_ TF_GUARDED_BY(mu_);
+  // Sums of the consumption rates recorded by `RecordWorkload`, oldest first.
+  std::deque<std::pair<absl::Time, double>> workload_history_
+      TF_GUARDED_BY(mu_);
 };
 
 // Exports a metric (/tensorflow/data/service/optimal_number_of_workers) with
@@ -114,6 +146,14 @@ class AutoScaler {
 // MultipleIterationsAutoScaler is thread-safe.
 class MultipleIterationsAutoScaler {
  public:
+  // The number of workers that an iteration needs.
+  struct WorkerTarget {
+    // The estimated optimal number of workers for the current workload.
+    int64_t optimal_number_of_workers = 0;
+    // The predicted number of workers at the time passed to `GetWorkerTargets`.
+    int64_t predicted_number_of_workers = 0;
+  };
+
   MultipleIterationsAutoScaler() = default;
   // Unregisters iteration with `iteration_id`, removing its reported
   // times from consideration of the current workload estimation.
@@ -160,6 +200,16 @@ class MultipleIterationsAutoScaler {
   // `iteration_id` and the specified consumer.
   tsl::Status RemoveConsumer(int64_t iteration_id, int64_t consumer_id)
       TF_LOCKS_EXCLUDED(mu_);
+  // Records the workload of every iteration as observed at `time`. It should be
+  // called periodically for predictions to follow the workload.
+  void RecordWorkload(absl::Time time) TF_LOCKS_EXCLUDED(mu_);
+  // Returns the targets of the iterations with previously reported processing
+  // and target processing times, keyed by iteration id. The predictions are for
+  // `time`, and the targets are limited like in
+  // `UpdateOptimalNumberOfWorkersMetric`.
+  absl::flat_hash_map<int64_t, WorkerTarget> GetWorkerTargets(
+      absl::Time time, int64_t current_number_of_workers) const
+      TF_LOCKS_EXCLUDED(mu_);
 
  private:
   // Registers iteration with `iteration_id` if it does not exist already,
@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/auto_scaler.h"
 
+#include <cstdint>
 #include <optional>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
@@ -308,6 +310,83 @@ TEST(AutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0));
 }
 
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersInitialState) {
+  AutoScaler auto_scaler;
+  auto_scaler.RecordWorkload(absl::UnixEpoch());
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::UnixEpoch()),
+            std::nullopt);
+}
+
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersWithoutHistory) {
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+  auto_scaler.RecordWorkload(absl::UnixEpoch());
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(absl::UnixEpoch() +
+                                                    absl::Minutes(5)),
+            8);
+}
+
+// Worker 0:
+//   - Processing time = 0.2 [s] -> Throughput = 5 [elements/s]
+// Consumer 0:
+//   - At 0 [s]: Consumption rate = 40 [elements/s]
+//   - At 64 [s]: Consumption rate = 80 [elements/s]
+//
+// Predicted consumption rate at 128 [s] = 120 [elements/s]
+// Predicted number of workers = 120 / 5 = 24
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersIncreasingWorkload) {
+  const absl::Time start = absl::UnixEpoch();
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+  auto_scaler.RecordWorkload(start);
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.0125)));
+  auto_scaler.RecordWorkload(start + absl::Seconds(64));
+
+  EXPECT_EQ(auto_scaler.GetOptimalNumberOfWorkers(), 16);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(start + absl::Seconds(64)),
+            16);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(start + absl::Seconds(128)),
+            24);
+}
+
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersDecreasingWorkload) {
+  const absl::Time start = absl::UnixEpoch();
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.0125)));
+  auto_scaler.RecordWorkload(start);
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+  auto_scaler.RecordWorkload(start + absl::Seconds(64));
+
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(start + absl::Seconds(96)),
+            4);
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(start + absl::Minutes(10)),
+            1);
+}
+
+TEST(AutoScalerTest, GetPredictedNumberOfWorkersDiscardsOldWorkload) {
+  const absl::Time start = absl::UnixEpoch();
+  AutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime("/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.025)));
+  auto_scaler.RecordWorkload(start);
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, absl::Seconds(0.0125)));
+  auto_scaler.RecordWorkload(start + AutoScaler::kWorkloadHistoryWindow +
+                             absl::Seconds(1));
+
+  EXPECT_EQ(auto_scaler.GetPredictedNumberOfWorkers(start + absl::Hours(1)),
+            16);
+}
+
 TEST(MultipleIterationsAutoScalerTest, UnregisterExistingIteration) {
   MultipleIterationsAutoScaler auto_scaler;
   TF_ASSERT_OK(
@@ -743,6 +822,55 @@ TEST(MultipleIterationsAutoScalerTest, RemoveConsumerAfterNewTPTReported) {
   TF_ASSERT_OK(auto_scaler.RemoveConsumer(0, 0));
 }
 
+TEST(MultipleIterationsAutoScalerTest, GetWorkerTargetsInitialState) {
+  MultipleIterationsAutoScaler auto_scaler;
+  EXPECT_TRUE(auto_scaler.GetWorkerTargets(absl::UnixEpoch(), 1).empty());
+}
+
+TEST(MultipleIterationsAutoScalerTest, GetWorkerTargets) {
+  const absl::Time start = absl::UnixEpoch();
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.025)));
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(1, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(1, 0, absl::Seconds(0.05)));
+  auto_scaler.RecordWorkload(start);
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.0125)));
+  auto_scaler.RecordWorkload(start + absl::Seconds(64));
+  // Iteration 2 has no reported processing times.
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(2, 0, absl::Seconds(0.05)));
+
+  absl::flat_hash_map<int64_t, MultipleIterationsAutoScaler::WorkerTarget>
+      targets = auto_scaler.GetWorkerTargets(start + absl::Seconds(128),
+                                             /*current_number_of_workers=*/20);
+  ASSERT_EQ(targets.size(), 2);
+  EXPECT_EQ(targets[0].optimal_number_of_workers, 16);
+  EXPECT_EQ(targets[0].predicted_number_of_workers, 24);
+  EXPECT_EQ(targets[1].optimal_number_of_workers, 4);
+  EXPECT_EQ(targets[1].predicted_number_of_workers, 4);
+}
+
+TEST(MultipleIterationsAutoScalerTest, GetWorkerTargetsAreBounded) {
+  MultipleIterationsAutoScaler auto_scaler;
+  TF_ASSERT_OK(auto_scaler.ReportProcessingTime(0, "/worker/task/0:20000",
+                                                absl::Seconds(0.2)));
+  TF_ASSERT_OK(
+      auto_scaler.ReportTargetProcessingTime(0, 0, absl::Seconds(0.025)));
+
+  absl::flat_hash_map<int64_t, MultipleIterationsAutoScaler::WorkerTarget>
+      targets = auto_scaler.GetWorkerTargets(absl::UnixEpoch(),
+                                             /*current_number_of_workers=*/1);
+  ASSERT_EQ(targets.size(), 1);
+  EXPECT_EQ(targets[0].optimal_number_of_workers, 4);
+  EXPECT_EQ(targets[0].predicted_number_of_workers, 4);
+}
+
 }  // namespace
 
 }  // namespace data
@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tsl/platform/host_info.h"
 #include "tsl/protobuf/error_codes.pb.h"
 
@@ -59,6 +60,20 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+// By default, elements are requested one at a time.
+constexpr int64_t kDefaultMaxElementsPerRequest = 1;
+constexpr int64_t kDefaultElementBatchTimeoutUs = 1000;
+
+int64_t Int64FromEnv(const char* name, int64_t default_value) {
+  int64_t value;
+  Status s = ReadInt64FromEnvVar(name, default_value, &value);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to read " << name << ": " << s;
+    return default_value;
+  }
+  return value;
+}
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -81,6 +96,14 @@ StatusOr<DataTransferServerInfo> GetTransferServer(const std::string& protocol,
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
+      client_tags_(GetClientTopologyTags()),
+      max_elements_per_request_(std::max<int64_t>(
+          Int64FromEnv("TF_DATA_SERVICE_MAX_ELEMENTS_PER_REQUEST",
+                       kDefaultMaxElementsPerRequest),
+          1)),
+      element_batch_timeout_us_(
+          Int64FromEnv("TF_DATA_SERVICE_ELEMENT_BATCH_TIMEOUT_US",
+                       kDefaultElementBatchTimeoutUs)),
       max_outstanding_requests_(params.max_outstanding_requests) {}
 
 DataServiceClient::~DataServiceClient() {
@@ -431,6 +454,7 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
 void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   ClientHeartbeatRequest req;
   req.set_iteration_client_id(iteration_client_id_);
+  *req.mutable_client_tags() = {client_tags_.begin(), client_tags_.end()};
   if (IsCoordinatedRead()) {
     mutex_lock l(mu_);
     req.set_current_round(current_round_);
@@ -502,6 +526,17 @@ void DataServiceClient::UpdateTasks(const ClientHeartbeatResponse& resp)
       }
     }
   }
+  preferred_distance_ = std::nullopt;
+  if (PrefersCloseWorkers()) {
+    // Removed tasks are not in the response, so this falls back to farther
+    // workers when the closest ones go away.
+    preferred_distance_ = TopologyDistance::kRemote;
+    for (const TaskInfo& task : resp.task_info()) {
+      if (ShouldReadFromTask(task)) {
+        preferred_distance_ = std::min(*preferred_distance_, GetDistance(task));
+      }
+    }
+  }
   for (auto& task : resp.task_info()) {
     auto it = task_id_to_task.find(task.task_id());
     if (it == task_id_to_task.end()) {
@@ -539,9 +574,29 @@ bool DataServiceClient::ShouldReadFromTask(const TaskInfo& task) const
   if (params_.target_workers == TARGET_WORKERS_AUTO && is_cross_tf_host_read) {
     return false;
   }
+  if (preferred_distance_.has_value() &&
+      GetDistance(task) > *preferred_distance_) {
+    return false;
+  }
   return true;
 }
 
+bool DataServiceClient::PrefersCloseWorkers() const {
+  // Without sharding, every worker produces the whole dataset, so reading
+  // from a subset of them does not skip any data. Coordinated reads need to
+  // read from every worker.
+  return params_.target_workers == TARGET_WORKERS_AUTO &&
+         IsNoShard(params_.processing_mode) && !IsCoordinatedRead();
+}
+
+TopologyDistance DataServiceClient::GetDistance(const TaskInfo& task) const {
+  if (LocalWorkers::Get(task.worker_address()) != nullptr) {
+    return TopologyDistance::kSameHost;
+  }
+  return GetTopologyDistance(
+      client_tags_, {task.worker_tags().begin(), task.worker_tags().end()});
+}
+
 void DataServiceClient::RecordTFMetrics(const ClientHeartbeatResponse& resp)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   for (const auto& task : resp.task_info()) {
@@ -718,8 +773,21 @@ void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   }
 }
 
-Status DataServiceClient::TryGetElement(const Task& task,
-                                        GetElementResult& result) {
+int64_t DataServiceClient::NumElementsToRequest() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (IsCoordinatedRead() || max_elements_per_request_ <= 1) {
+    return 1;
+  }
+  // The calling request is already counted in `outstanding_requests_`.
+  const int64_t room = max_outstanding_requests_ -
+                       static_cast<int64_t>(results_.size()) -
+                       outstanding_requests_ + 1;
+  return std::clamp<int64_t>(room, 1, max_elements_per_request_);
+}
+
+Status DataServiceClient::TryGetElements(
+    const Task& task, int64_t num_elements,
+    std::vector<GetElementResult>& results) {
   GetElementRequest req;
   req.set_task_id(task.info.task_id());
   req.set_skipped_previous_round(task.skipped_previous_round);
@@ -731,30 +799,46 @@ Status DataServiceClient::TryGetElement(const Task& task,
   if (params_.cross_trainer_cache_options) {
     req.set_trainer_id(params_.cross_trainer_cache_options->trainer_id());
   }
-  return task.worker->GetElement(req, result);
+  if (num_elements > 1) {
+    req.set_max_elements(num_elements);
+    req.set_batch_timeout_us(element_batch_timeout_us_);
+    return task.worker->GetElements(req, results);
+  }
+  results.clear();
+  results.emplace_back();
+  return task.worker->GetElement(req, results.back());
 }
 
 void DataServiceClient::ProcessGetElementResponse(
-    bool enqueue_result, GetElementResult& get_element_result,
+    bool enqueue_result, std::vector<GetElementResult>& get_element_results,
     std::shared_ptr<Result> result, Task& task) TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
-  result->ready = true;
-  result->end_of_sequence = get_element_result.end_of_sequence;
-  result->skip = get_element_result.skip;
-  if (!get_element_result.end_of_sequence && !get_element_result.skip) {
-    task.skipped_previous_round = false;
-    result->element = std::move(get_element_result.components);
-    result->element_index = get_element_result.element_index;
-    result->task_id = task.info.task_id();
-  } else if (get_element_result.skip) {
-    task.skipped_previous_round = true;
-  } else {
-    task.end_of_sequence = true;
-    finished_tasks_++;
-  }
-  if (enqueue_result && !result->end_of_sequence) {
-    ctx_->RecordBufferEnqueue(result->element);
-    results_.push(std::move(result));
+  for (int i = 0; i < get_element_results.size(); ++i) {
+    GetElementResult& get_element_result = get_element_results[i];
+    if (i > 0) {
+      // Only uncoordinated reads, which enqueue their results, get more than
+      // one element per request.
+      DCHECK(enqueue_result);
+      result = std::make_shared<Result>();
+    }
+    result->ready = true;
+    result->end_of_sequence = get_element_result.end_of_sequence;
+    result->skip = get_element_result.skip;
+    if (!get_element_result.end_of_sequence && !get_element_result.skip) {
+      task.skipped_previous_round = false;
+      result->element = std::move(get_element_result.components);
+      result->element_index = get_element_result.element_index;
+      result->task_id = task.info.task_id();
+    } else if (get_element_result.skip) {
+      task.skipped_previous_round = true;
+    } else {
+      task.end_of_sequence = true;
+      finished_tasks_++;
+    }
+    if (enqueue_result && !result->end_of_sequence) {
+      ctx_->RecordBufferEnqueue(result->element);
+      results_.push(std::move(result));
+    }
   }
   get_next_cv_.notify_all();
 }
@@ -818,9 +902,14 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
                                      bool enqueue_result,
                                      std::shared_ptr<Result> result)
     TF_LOCKS_EXCLUDED(mu_) {
-  GetElementResult get_element_result;
+  int64_t num_elements;
+  {
+    mutex_lock l(mu_);
+    num_elements = NumElementsToRequest();
+  }
+  std::vector<GetElementResult> get_element_results;
   while (true) {
-    Status s = TryGetElement(*task, get_element_result);
+    Status s = TryGetElements(*task, num_elements, get_element_results);
     if (s.ok()) {
       task->num_retries = 0;
       break;
@@ -876,7 +965,8 @@ Status DataServiceClient::GetElement(Task* task, int64_t deadline_micros,
       return OkStatus();
     }
   }
-  ProcessGetElementResponse(enqueue_result, get_element_result, result, *task);
+  ProcessGetElementResponse(enqueue_result, get_element_results, result,
+                            *task);
   return OkStatus();
 }
 
@@ -163,6 +163,9 @@ class DataServiceClient {
   void Heartbeat();
   void UpdateTasks(const ClientHeartbeatResponse& resp);
   bool ShouldReadFromTask(const TaskInfo& task) const;
+  // Whether to read only from the closest workers according to topology tags.
+  bool PrefersCloseWorkers() const;
+  TopologyDistance GetDistance(const TaskInfo& task) const;
   void RecordTFMetrics(const ClientHeartbeatResponse& resp);
   void UpdateBufferSize();
   void UpdateWorkerThreads();
@@ -174,10 +177,16 @@ class DataServiceClient {
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
   void AdvanceTaskIndex();
-  Status TryGetElement(const Task& task, GetElementResult& result);
-  void ProcessGetElementResponse(bool enqueue_result,
-                                 GetElementResult& get_element_result,
-                                 std::shared_ptr<Result> result, Task& task);
+  // Returns how many elements to request from a worker at a time, given the
+  // room left under `max_outstanding_requests_`.
+  int64_t NumElementsToRequest() const;
+  Status TryGetElements(const Task& task, int64_t num_elements,
+                        std::vector<GetElementResult>& results);
+  // Stores the first of `get_element_results` in `result`, and enqueues the
+  // rest as new results.
+  void ProcessGetElementResponse(
+      bool enqueue_result, std::vector<GetElementResult>& get_element_results,
+      std::shared_ptr<Result> result, Task& task);
   Status GetElementTraced(Task* task, int64_t deadline_micros,
                           bool enqueue_result, std::shared_ptr<Result> result);
   Status MaybeRemoveTask(Task& task, int64_t deadline_micros, Result& result);
@@ -189,6 +198,15 @@ class DataServiceClient {
   std::string DebugString() const;
 
   const DataServiceParams params_;
+  // The topology tags of this client, e.g. "rack:r12".
+  const std::vector<std::string> client_tags_;
+  // The maximum number of elements to request from a worker at a time, and
+  // how long the worker may wait for elements after the first one. Set by the
+  // TF_DATA_SERVICE_MAX_ELEMENTS_PER_REQUEST and
+  // TF_DATA_SERVICE_ELEMENT_BATCH_TIMEOUT_US environment variables. Elements
+  // are only batched for uncoordinated reads.
+  const int64_t max_elements_per_request_;
+  const int64_t element_batch_timeout_us_;
 
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
@@ -249,6 +267,9 @@ class DataServiceClient {
 
   bool iteration_finished_ TF_GUARDED_BY(mu_) = false;
   bool should_finish_iteration_ TF_GUARDED_BY(mu_) = true;
+  // If `PrefersCloseWorkers()`, the distance of the closest workers that have
+  // tasks for the iteration. Tasks of farther workers are not read.
+  std::optional<TopologyDistance> preferred_distance_ TF_GUARDED_BY(mu_);
 
   // The set of worker UIDs that we have already recorded metrics for.
   absl::flat_hash_set<int64_t> worker_uids_ TF_GUARDED_BY(mu_);
@@ -14,12 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <cstdlib>
+#include <optional>
 #include <string>
+#include <vector>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/protobuf/data_service.pb.h"
@@ -131,6 +138,67 @@ StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s) {
                                  "COLOCATED, REMOTE, and HYBRID.");
 }
 
+namespace {
+
+// Returns the value of the first tag in `tags` with `prefix`, if any.
+std::optional<absl::string_view> GetTopologyTag(
+    const std::vector<std::string>& tags, absl::string_view prefix) {
+  for (absl::string_view tag : tags) {
+    if (absl::ConsumePrefix(&tag, prefix) && !tag.empty()) {
+      return tag;
+    }
+  }
+  return std::nullopt;
+}
+
+// Returns true if both `a` and `b` have a tag with `prefix`, with the same
+// value.
+bool SameTopologyTag(const std::vector<std::string>& a,
+                     const std::vector<std::string>& b,
+                     absl::string_view prefix) {
+  std::optional<absl::string_view> a_tag = GetTopologyTag(a, prefix);
+  std::optional<absl::string_view> b_tag = GetTopologyTag(b, prefix);
+  return a_tag.has_value() && a_tag == b_tag;
+}
+
+}  // namespace
+
+TopologyDistance GetTopologyDistance(
+    const std::vector<std::string>& client_tags,
+    const std::vector<std::string>& worker_tags) {
+  if (SameTopologyTag(client_tags, worker_tags, kHostTagPrefix)) {
+    return TopologyDistance::kSameHost;
+  }
+  // Rack names may be reused across zones.
+  std::optional<absl::string_view> client_zone =
+      GetTopologyTag(client_tags, kZoneTagPrefix);
+  std::optional<absl::string_view> worker_zone =
+      GetTopologyTag(worker_tags, kZoneTagPrefix);
+  if (client_zone.has_value() && worker_zone.has_value() &&
+      client_zone != worker_zone) {
+    return TopologyDistance::kRemote;
+  }
+  if (SameTopologyTag(client_tags, worker_tags, kRackTagPrefix)) {
+    return TopologyDistance::kSameRack;
+  }
+  if (client_zone.has_value() && client_zone == worker_zone) {
+    return TopologyDistance::kSameZone;
+  }
+  return TopologyDistance::kRemote;
+}
+
+std::vector<std::string> GetClientTopologyTags() {
+  std::vector<std::string> tags;
+  const char* env_tags = std::getenv("TF_DATA_SERVICE_CLIENT_TAGS");
+  if (env_tags != nullptr) {
+    tags = absl::StrSplit(env_tags, ',', absl::SkipWhitespace());
+  }
+  if (!GetTopologyTag(tags, kHostTagPrefix).has_value()) {
+    tags.push_back(absl::StrCat(kHostTagPrefix, port::Hostname()));
+  }
+  return tags;
+}
+
 bool IsPreemptedError(const Status& status) {
   return errors::IsAborted(status) || errors::IsCancelled(status) ||
          errors::IsUnavailable(status);
@@ -39,6 +39,22 @@ constexpr int kDataServiceVersion = 9;
 // workers on other TF hosts when the host runs a local tf.data service worker.
 constexpr absl::string_view kColocatedWorkerTag = "COLOCATED";
 
+// Worker and client tags with these prefixes describe where they run, e.g.
+// "rack:r12". Clients prefer to read from the workers closest to them, and
+// fall back to farther workers when there are no closer ones.
+constexpr absl::string_view kHostTagPrefix = "host:";
+constexpr absl::string_view kRackTagPrefix = "rack:";
+constexpr absl::string_view kZoneTagPrefix = "zone:";
+
+// The distance between a client and a worker according to their topology
+// tags, from the most to the least preferred.
+enum class TopologyDistance {
+  kSameHost = 0,
+  kSameRack = 1,
+  kSameZone = 2,
+  kRemote = 3,
+};
+
 // Container to hold the result of a `GetNext` call.
 struct GetNextResult final {
   explicit GetNextResult() = default;
@@ -85,6 +101,17 @@ std::string TargetWorkersToString(TargetWorkers target_workers);
 // Returns InvalidArgument if the string is not recognized.
 StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s);
 
+// Returns the distance between a client and a worker with the given tags. Tags
+// that are missing on either side do not match.
+TopologyDistance GetTopologyDistance(
+    const std::vector<std::string>& client_tags,
+    const std::vector<std::string>& worker_tags);
+
+// Returns the topology tags of this client: the comma-separated tags in the
+// TF_DATA_SERVICE_CLIENT_TAGS environment variable, plus a host tag with this
+// host's name unless they include one.
+std::vector<std::string> GetClientTopologyTags();
+
 // Returns true if `status` is a retriable error that indicates preemption.
 bool IsPreemptedError(const Status& status);
 
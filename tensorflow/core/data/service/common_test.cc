@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/dataset_options.pb.h"
@@ -186,6 +187,32 @@ TEST(CommonTest, IsPermanentError) {
   EXPECT_FALSE(IsPreemptedError(errors::OutOfRange("Out of range")));
   EXPECT_FALSE(IsPreemptedError(errors::Unknown("Unknown")));
 }
+
+TEST(CommonTest, GetTopologyDistance) {
+  const std::vector<std::string> client = {"host:h1", "rack:r1", "zone:z1"};
+  EXPECT_EQ(GetTopologyDistance(client, {"host:h1", "rack:r1", "zone:z1"}),
+            TopologyDistance::kSameHost);
+  EXPECT_EQ(GetTopologyDistance(client, {"host:h2", "rack:r1", "zone:z1"}),
+            TopologyDistance::kSameRack);
+  EXPECT_EQ(GetTopologyDistance(client, {"host:h2", "rack:r2", "zone:z1"}),
+            TopologyDistance::kSameZone);
+  EXPECT_EQ(GetTopologyDistance(client, {"host:h2", "rack:r1", "zone:z2"}),
+            TopologyDistance::kRemote);
+  EXPECT_EQ(GetTopologyDistance(client, {"rack:r1"}),
+            TopologyDistance::kSameRack);
+  EXPECT_EQ(GetTopologyDistance(client, {"COLOCATED"}),
+            TopologyDistance::kRemote);
+  EXPECT_EQ(GetTopologyDistance({}, {"host:h1", "rack:r1", "zone:z1"}),
+            TopologyDistance::kRemote);
+  EXPECT_EQ(GetTopologyDistance({"host:"}, {"host:"}),
+            TopologyDistance::kRemote);
+}
+
+TEST(CommonTest, GetClientTopologyTags) {
+  std::vector<std::string> tags = GetClientTopologyTags();
+  ASSERT_FALSE(tags.empty());
+  EXPECT_THAT(tags.back(), ::testing::StartsWith(kHostTagPrefix));
+}
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
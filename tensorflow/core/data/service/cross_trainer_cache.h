@@ -20,8 +20,10 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/logging_utils.h"
@@ -91,6 +93,28 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// Optional second tier of a `CrossTrainerCache`, e.g. on a local SSD. Elements
+// freed from memory are written to it, so that trainers lagging behind the
+// in-memory window can still read them instead of skipping them.
+//
+// Implementations must be thread-safe. `Read` may be called concurrently with
+// `Write` and `Delete` of other indices, and with `Delete` of the same index,
+// in which case it should return a NotFound error.
+template <class ElementType>
+class CacheOverflowStorage {
+ public:
+  virtual ~CacheOverflowStorage() = default;
+
+  // Writes the element with absolute index `index` within the dataset.
+  virtual Status Write(size_t index, const ElementType& element) = 0;
+
+  // Reads the element written at `index`.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Deletes the element written at `index`.
+  virtual Status Delete(size_t index) = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -101,6 +125,14 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+
+  // Creates a `CrossTrainerCache` which moves the elements freed from memory to
+  // `overflow_storage`, keeping up to `max_overflow_size_bytes` there.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CacheOverflowStorage<ElementType>> overflow_storage,
+      size_t max_overflow_size_bytes);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -134,6 +166,15 @@ class CrossTrainerCache {
   // data is not ready, one of the trainers need to extend the cache.
   bool IsElementReady(const std::string& trainer_id);
 
+  // Returns true if the next element for `trainer_id` has been moved to the
+  // overflow storage.
+  bool IsElementInOverflow(const std::string& trainer_id);
+
+  // Reads the element at `element_index` from the overflow storage. Returns
+  // nullopt if it has been deleted concurrently.
+  StatusOr<std::optional<std::shared_ptr<const ElementType>>>
+  ReadFromOverflow(size_t element_index);
+
   // Returns the absolute element index relative to the dataset (not relative to
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
@@ -147,7 +188,22 @@ class CrossTrainerCache {
 
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
-  void FreeSpace(size_t new_element_size_bytes);
+  // The first `num_spilled_elements` freed elements have been written to the
+  // overflow storage. Returns the indices to delete from the overflow storage.
+  std::vector<size_t> FreeSpace(size_t new_element_size_bytes,
+                                size_t num_spilled_elements);
+
+  // Returns the number of elements `FreeSpace` will free from memory to insert
+  // a new element of `new_element_size_bytes`.
+  size_t NumElementsToFree(size_t new_element_size_bytes);
+
+  // Writes the oldest elements that will be freed to insert a new element of
+  // `new_element_size_bytes` to the overflow storage. Returns the number of
+  // elements written.
+  size_t SpillElements(size_t new_element_size_bytes);
+
+  // Deletes `indices` from the overflow storage.
+  void DeleteFromOverflow(const std::vector<size_t>& indices);
 
   // Records the cache hit rate and cache size.
   void RecordMetrics(const CacheQueryResult& result);
@@ -158,6 +214,10 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // The optional storage for elements freed from memory, and its size limit.
+  std::unique_ptr<CacheOverflowStorage<ElementType>> overflow_storage_;
+  const size_t max_overflow_size_bytes_ = 0;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,12 +230,19 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // The overflow storage holds the elements from `overflow_start_index_` to
+  // `cache_start_index_`. `overflow_sizes_` stores their sizes in bytes.
+  std::deque<size_t> overflow_sizes_ TF_GUARDED_BY(mu_);
+  size_t overflow_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t overflow_start_index_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
   // Maps trainer IDs to element indices. The indices are absolute indices
   // within the dataset. The actual index to use with `cache_` would be
-  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`.
+  // `trainer_to_element_index_map_[trainer_id] - cache_start_index_`. Indices
+  // below `cache_start_index_` refer to the overflow storage.
   absl::flat_hash_map<std::string, size_t> trainer_to_element_index_map_
       TF_GUARDED_BY(mu_);
 };
@@ -192,6 +259,23 @@ CrossTrainerCache<ElementType>::CrossTrainerCache(
           << FormatBytes(max_cache_size_bytes) << " of memory.";
 }
 
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CacheOverflowStorage<ElementType>> overflow_storage,
+    size_t max_overflow_size_bytes)
+    : max_cache_size_bytes_(max_cache_size_bytes),
+      cachable_sequence_(std::move(cachable_sequence)),
+      overflow_storage_(std::move(overflow_storage)),
+      max_overflow_size_bytes_(max_overflow_size_bytes) {
+  DCHECK_GT(max_cache_size_bytes, 0)
+      << "CrossTrainerCache size must be greater than 0.";
+  VLOG(2) << "Initialized tf.data service cross-trainer cache with "
+          << FormatBytes(max_cache_size_bytes) << " of memory and "
+          << FormatBytes(max_overflow_size_bytes) << " of overflow storage.";
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
@@ -212,20 +296,23 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> overflow_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
-      if (IsElementReady(trainer_id)) {
+      if (IsElementInOverflow(trainer_id)) {
+        // Reads the element from the overflow storage without holding the lock.
+        overflow_index = GetElementIndex(trainer_id);
+        trainer_to_element_index_map_[trainer_id] = *overflow_index + 1;
+      } else if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
                             GetElement(trainer_id));
         return CacheQueryResult{element,
                                 /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +321,16 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (overflow_index.has_value()) {
+      TF_ASSIGN_OR_RETURN(
+          std::optional<std::shared_ptr<const ElementType>> element,
+          ReadFromOverflow(*overflow_index));
+      if (element.has_value()) {
+        return CacheQueryResult{*element, /*is_cache_hit=*/true};
+      }
+      continue;
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -250,6 +347,24 @@ bool CrossTrainerCache<ElementType>::IsElementReady(
   return GetElementIndex(trainer_id) < cache_start_index_ + cache_.size();
 }
 
+template <class ElementType>
+bool CrossTrainerCache<ElementType>::IsElementInOverflow(
+    const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  return GetElementIndex(trainer_id) < cache_start_index_;
+}
+
+template <class ElementType>
+StatusOr<std::optional<std::shared_ptr<const ElementType>>>
+CrossTrainerCache<ElementType>::ReadFromOverflow(size_t element_index)
+    TF_LOCKS_EXCLUDED(mu_) {
+  StatusOr<ElementType> element = overflow_storage_->Read(element_index);
+  if (errors::IsNotFound(element.status())) {
+    return std::nullopt;
+  }
+  TF_RETURN_IF_ERROR(element.status());
+  return std::make_shared<const ElementType>(std::move(*element));
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
@@ -271,8 +386,8 @@ template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  if (element_index < overflow_start_index_) {
+    element_index = overflow_start_index_;
   }
   return element_index;
 }
@@ -289,17 +404,69 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
-  mutex_lock l(mu_);
-  TF_RETURN_IF_ERROR(status_);
-  FreeSpace(new_element_size_bytes);
-  cache_.push_back(std::make_shared<ElementType>(std::move(element)));
-  cache_size_bytes_ += new_element_size_bytes;
+  const size_t num_spilled_elements = SpillElements(new_element_size_bytes);
+  std::vector<size_t> indices_to_delete;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    indices_to_delete =
+        FreeSpace(new_element_size_bytes, num_spilled_elements);
+    cache_.push_back(std::make_shared<ElementType>(std::move(element)));
+    cache_size_bytes_ += new_element_size_bytes;
+  }
+  DeleteFromOverflow(indices_to_delete);
   return OkStatus();
 }
 
 template <class ElementType>
-void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
+size_t CrossTrainerCache<ElementType>::NumElementsToFree(
+    size_t new_element_size_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t num_elements = 0;
+  size_t cache_size_bytes = cache_size_bytes_;
+  while (num_elements < cache_.size() &&
+         cache_size_bytes + new_element_size_bytes > max_cache_size_bytes_) {
+    cache_size_bytes -=
+        cachable_sequence_->GetElementSizeBytes(*cache_[num_elements]);
+    ++num_elements;
+  }
+  return num_elements;
+}
+
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::SpillElements(
+    size_t new_element_size_bytes) TF_LOCKS_EXCLUDED(mu_) {
+  if (overflow_storage_ == nullptr) {
+    return 0;
+  }
+
+  // Only the thread extending the cache frees elements, so the elements to
+  // free do not change while they are written without holding the lock.
+  std::vector<std::shared_ptr<const ElementType>> elements_to_spill;
+  size_t first_index = 0;
+  {
+    mutex_lock l(mu_);
+    const size_t num_elements = NumElementsToFree(new_element_size_bytes);
+    elements_to_spill.assign(cache_.begin(), cache_.begin() + num_elements);
+    first_index = cache_start_index_;
+  }
+
+  for (size_t i = 0; i < elements_to_spill.size(); ++i) {
+    Status s = overflow_storage_->Write(first_index + i, *elements_to_spill[i]);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to write tf.data service cross-trainer cache "
+                   << "element " << first_index + i
+                   << " to the overflow storage: " << s;
+      return i;
+    }
+  }
+  return elements_to_spill.size();
+}
+
+template <class ElementType>
+std::vector<size_t> CrossTrainerCache<ElementType>::FreeSpace(
+    size_t new_element_size_bytes, size_t num_spilled_elements)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<size_t> indices_to_delete;
   size_t num_elements_discarded = 0;
   while (!cache_.empty() &&
          cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
@@ -307,13 +474,49 @@ void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
+    if (num_elements_discarded < num_spilled_elements) {
+      overflow_sizes_.push_back(free_bytes);
+      overflow_size_bytes_ += free_bytes;
+    } else {
+      // The overflow storage must hold consecutive elements. If the element
+      // could not be written, drops the overflow storage up to this element.
+      for (size_t i = 0; i < overflow_sizes_.size(); ++i) {
+        indices_to_delete.push_back(overflow_start_index_ + i);
+      }
+      overflow_sizes_.clear();
+      overflow_size_bytes_ = 0;
+      overflow_start_index_ = cache_start_index_ + 1;
+    }
     ++cache_start_index_;
     ++num_elements_discarded;
   }
 
+  while (!overflow_sizes_.empty() &&
+         overflow_size_bytes_ > max_overflow_size_bytes_) {
+    indices_to_delete.push_back(overflow_start_index_);
+    overflow_size_bytes_ -= overflow_sizes_.front();
+    overflow_sizes_.pop_front();
+    ++overflow_start_index_;
+  }
+
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
           << "tf.data service cross-trainer cache. Memory usage: "
-          << FormatBytes(cache_size_bytes_) << ".";
+          << FormatBytes(cache_size_bytes_) << ". Overflow storage usage: "
+          << FormatBytes(overflow_size_bytes_) << ".";
+  return indices_to_delete;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::DeleteFromOverflow(
+    const std::vector<size_t>& indices) TF_LOCKS_EXCLUDED(mu_) {
+  for (size_t index : indices) {
+    Status s = overflow_storage_->Delete(index);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete tf.data service cross-trainer cache "
+                   << "element " << index << " from the overflow storage: "
+                   << s;
+    }
+  }
 }
 
 template <class ElementType>
@@ -121,6 +121,43 @@ size_t ElementOrErrorDataset<Tensor>::GetElementSizeBytes(
   return element.TotalBytes();
 }
 
+// Overflow storage that keeps the elements in a map. If `fail_writes` is true,
+// all writes fail.
+class MapOverflowStorage : public CacheOverflowStorage<int64_t> {
+ public:
+  explicit MapOverflowStorage(bool fail_writes = false)
+      : fail_writes_(fail_writes) {}
+
+  Status Write(size_t index, const int64_t& element) override {
+    if (fail_writes_) {
+      return errors::ResourceExhausted("No space left on device.");
+    }
+    mutex_lock l(mu_);
+    elements_[index] = element;
+    return OkStatus();
+  }
+
+  StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index, " not found.");
+    }
+    return it->second;
+  }
+
+  Status Delete(size_t index) override {
+    mutex_lock l(mu_);
+    elements_.erase(index);
+    return OkStatus();
+  }
+
+ private:
+  const bool fail_writes_;
+  mutex mu_;
+  absl::flat_hash_map<size_t, int64_t> elements_ TF_GUARDED_BY(mu_);
+};
+
 std::vector<int64_t> GetRange(const size_t range) {
   std::vector<int64_t> result;
   for (int64_t i = 0; i < range; ++i) {
@@ -205,6 +242,55 @@ TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   }
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadFromOverflow) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowStorage>(),
+      /*max_overflow_size_bytes=*/10 * sizeof(int64_t));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // Element 9 is in memory and the earlier elements are in the overflow.
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  for (int i = 10; i < 15; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+}
+
+TEST(CrossTrainerCacheTest, OverflowSizeLimit) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowStorage>(),
+      /*max_overflow_size_bytes=*/2 * sizeof(int64_t));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // The overflow only keeps elements 7 and 8.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(7)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(8)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(9)));
+}
+
+TEST(CrossTrainerCacheTest, OverflowWriteErrors) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapOverflowStorage>(/*fail_writes=*/true),
+      /*max_overflow_size_bytes=*/10 * sizeof(int64_t));
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // Elements that could not be written to the overflow are skipped.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(9)));
+}
+
 TEST(CrossTrainerCacheTest, AlternateTrainerExtendsCache) {
   // The cache size is smaller than one int64_t.
   CrossTrainerCache<int64_t> cache(
@@ -78,6 +78,16 @@ class DataTransferClient {
   virtual Status GetElement(const GetElementRequest& req,
                             GetElementResult& result) = 0;
 
+  // Fetches up to `req.max_elements()` elements, as documented in
+  // worker.proto. Only the last result may be the end of sequence or a skip.
+  // By default, fetches a single element.
+  virtual Status GetElements(const GetElementRequest& req,
+                             std::vector<GetElementResult>& results) {
+    results.clear();
+    results.emplace_back();
+    return GetElement(req, results.back());
+  }
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   virtual void TryCancel() = 0;
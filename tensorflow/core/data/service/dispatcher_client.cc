@@ -27,6 +27,7 @@ limitations under the License.
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
@@ -151,6 +152,39 @@ Status DataServiceDispatcherClient::GetSplit(int64_t iteration_id,
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetSplits(
+    int64_t iteration_id, int64_t repetition, int64_t split_provider_index,
+    int64_t max_splits, std::vector<Tensor>& splits, bool& end_of_splits) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  GetSplitRequest req;
+  req.set_iteration_id(iteration_id);
+  req.set_repetition(repetition);
+  req.set_split_provider_index(split_provider_index);
+  req.set_max_splits(max_splits);
+  GetSplitResponse resp;
+  grpc::ClientContext client_ctx;
+  grpc::Status status = stub_->GetSplit(&client_ctx, req, &resp);
+  if (!status.ok()) {
+    return grpc_util::WrapError("Failed to get splits", status);
+  }
+  splits.clear();
+  end_of_splits = resp.end_of_splits();
+  if (resp.has_split()) {
+    // The dispatcher predates `max_splits`.
+    splits.emplace_back();
+    if (!splits.back().FromProto(resp.split())) {
+      return errors::Internal("Failed to parse split tensor proto");
+    }
+  }
+  for (const TensorProto& split_proto : resp.splits()) {
+    splits.emplace_back();
+    if (!splits.back().FromProto(split_proto)) {
+      return errors::Internal("Failed to parse split tensor proto");
+    }
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::Snapshot(
     const DatasetDef& dataset, const std::string& path,
     const experimental::DistributedSnapshotMetadata& metadata) {
@@ -379,6 +413,19 @@ Status DataServiceDispatcherClient::DisableCompressionAtRuntime(
   return OkStatus();
 }
 
+Status DataServiceDispatcherClient::GetWorkerTargets(
+    absl::Duration lookahead, GetWorkerTargetsResponse& response) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  grpc::ClientContext ctx;
+  GetWorkerTargetsRequest request;
+  request.set_lookahead_ms(absl::ToInt64Milliseconds(lookahead));
+  grpc::Status s = stub_->GetWorkerTargets(&ctx, request, &response);
+  if (!s.ok()) {
+    return grpc_util::WrapError("Failed to get worker targets", s);
+  }
+  return OkStatus();
+}
+
 Status DataServiceDispatcherClient::EnsureInitialized() {
   return grpc_util::Retry([this] { return Initialize(); },
                           "Initialize dispatcher client",
@@ -21,6 +21,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher.grpc.pb.h"
@@ -67,6 +68,13 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
                   int64_t split_provider_index, Tensor& split,
                   bool& end_of_splits);
 
+  // Gets up to `max_splits` next splits for the specified iteration id,
+  // repetition, and split provider index in one request. `end_of_splits` is
+  // set if the split provider reached its end after the returned splits.
+  Status GetSplits(int64_t iteration_id, int64_t repetition,
+                   int64_t split_provider_index, int64_t max_splits,
+                   std::vector<Tensor>& splits, bool& end_of_splits);
+
   // Gets the next split for the specified source of a stream of the snapshot in
   // `base_path`. If `end_of_splits` returns true, then there are no more splits
   // to be processed for the specified stream source.
@@ -137,6 +145,11 @@ class DataServiceDispatcherClient : public DataServiceClientBase {
       const std::string& dataset_id, bool disable_compression_at_runtime,
       DisableCompressionAtRuntimeResponse& response);
 
+  // Returns the number of workers that the jobs need now, and are predicted to
+  // need `lookahead` from now.
+  Status GetWorkerTargets(absl::Duration lookahead,
+                          GetWorkerTargetsResponse& response);
+
  protected:
   Status EnsureInitialized() override;
 
@@ -21,9 +21,11 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/dataset_store.h"
+#include "tensorflow/core/data/service/dispatcher.pb.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
@@ -149,6 +151,25 @@ TEST_F(DispatcherClientTest, GetDataServiceConfig) {
   EXPECT_EQ(config.deployment_mode(), DEPLOYMENT_MODE_COLOCATED);
 }
 
+TEST_F(DispatcherClientTest, GetWorkerTargetsWithoutReportedTimes) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/2));
+  GetWorkerTargetsResponse response;
+  TF_ASSERT_OK(
+      dispatcher_client_->GetWorkerTargets(absl::Minutes(5), response));
+  EXPECT_EQ(response.current_number_of_workers(), 2);
+  EXPECT_EQ(response.optimal_number_of_workers(), 0);
+  EXPECT_EQ(response.predicted_number_of_workers(), 0);
+  EXPECT_TRUE(response.jobs().empty());
+}
+
+TEST_F(DispatcherClientTest, GetWorkerTargetsNegativeLookahead) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  GetWorkerTargetsResponse response;
+  EXPECT_THAT(
+      dispatcher_client_->GetWorkerTargets(absl::Minutes(-1), response),
+      StatusIs(error::INVALID_ARGUMENT));
+}
+
 TEST_F(DispatcherClientTest, SnapshotSkeletonWritten) {
   TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
   TF_ASSERT_OK_AND_ASSIGN(absl::flat_hash_set<std::string> paths,
@@ -74,6 +74,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/profiler/lib/mutex_contention.h"
 
 namespace tensorflow {
 namespace data {
@@ -97,6 +98,7 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr int64_t kDefaultJournalCompactionThreshold = 100000;
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -176,6 +178,10 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.journal_compaction_threshold() == 0) {
+    new_config.set_journal_compaction_threshold(
+        kDefaultJournalCompactionThreshold);
+  }
   return new_config;
 }
 }  // namespace
@@ -192,6 +198,9 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     dataset_store_ = std::make_unique<FileSystemDatasetStore>(
         DatasetsDir(config_.work_dir()));
   }
+  // `mu_` guards the dispatcher state, so its contention is that of the
+  // dispatcher state.
+  tsl::profiler::SetMutexName(&mu_, "DispatcherState");
 }
 
 DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
@@ -201,6 +210,7 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
     maintenance_thread_cv_.notify_all();
   }
   maintenance_thread_.reset();
+  tsl::profiler::ClearMutexName(&mu_);
 }
 
 Status DataServiceDispatcherImpl::Start() {
@@ -240,6 +250,7 @@ Status DataServiceDispatcherImpl::Start() {
     int64_t start = env_->NowMicros();
     while (!end_of_journal) {
       TF_RETURN_IF_ERROR(ApplyWithoutJournaling(update));
+      ++num_updates_since_compaction_;
       TF_RETURN_IF_ERROR(reader.Read(update, end_of_journal));
     }
     absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
@@ -358,7 +369,7 @@ Status DataServiceDispatcherImpl::FindNewTasks(
 
 void DataServiceDispatcherImpl::ReportProcessingTimesFromActiveTasks(
     const std::vector<ActiveTask>& active_tasks,
-    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const std::string& worker_address) TF_SHARED_LOCKS_REQUIRED(mu_) {
   for (const ActiveTask& active_task : active_tasks) {
     const int64_t task_id = active_task.task_id();
     const double processing_time_nsec = active_task.processing_time_nsec();
@@ -387,16 +398,60 @@ void DataServiceDispatcherImpl::ReportProcessingTimesFromActiveTasks(
   }
 }
 
+StatusOr<bool> DataServiceDispatcherImpl::ReadOnlyWorkerHeartbeat(
+    const WorkerHeartbeatRequest& request, WorkerHeartbeatResponse& response)
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> assigned_tasks;
+  Status s = state_.TasksForWorker(request.worker_address(), assigned_tasks);
+  if (errors::IsNotFound(s)) {
+    return false;
+  }
+  TF_RETURN_IF_ERROR(s);
+  absl::flat_hash_set<int64_t> current_tasks;
+  current_tasks.insert(request.current_tasks().cbegin(),
+                       request.current_tasks().cend());
+  absl::flat_hash_set<int64_t> assigned_iteration_ids;
+  for (const auto& task : assigned_tasks) {
+    if (!current_tasks.contains(task->task_id)) {
+      return false;
+    }
+    assigned_iteration_ids.insert(task->iteration->iteration_id);
+  }
+  // See `FindNewTasks`.
+  for (const auto& iteration : state_.ListIterations()) {
+    if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
+        iteration->IsRoundRobin() && !iteration->finished) {
+      return false;
+    }
+  }
+  const std::vector<ActiveTask> active_tasks(request.active_tasks().begin(),
+                                             request.active_tasks().end());
+  ReportProcessingTimesFromActiveTasks(active_tasks, request.worker_address());
+  TF_RETURN_IF_ERROR(
+      FindTasksToDelete(current_tasks, assigned_tasks, &response));
+  return true;
+}
+
 Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const WorkerHeartbeatRequest* request, WorkerHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
   VLOG(3) << "Received worker heartbeat request from worker "
           << request->worker_address();
+  const std::string& worker_address = request->worker_address();
   {
-    mutex_lock l(mu_);
-    const std::string& worker_address = request->worker_address();
+    mutex_lock l(worker_heartbeats_mu_);
     latest_worker_heartbeats_time_[worker_address] =
         absl::FromUnixMicros(env_->NowMicros());
+  }
+  bool handled = false;
+  {
+    // Heartbeats that don't update the state only hold `mu_` shared, so that
+    // heartbeats from different workers don't serialize.
+    tf_shared_lock l(mu_);
+    TF_ASSIGN_OR_RETURN(handled, ReadOnlyWorkerHeartbeat(*request, *response));
+  }
+  if (!handled) {
+    mutex_lock l(mu_);
     // Assigned tasks from the perspective of the dispatcher.
     std::vector<std::shared_ptr<const Task>> assigned_tasks;
     Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -518,19 +573,24 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   SplitProvider* split_provider =
       split_providers_[iteration_id][provider_index].get();
   DCHECK(split_provider != nullptr);
-  Tensor split;
+  const bool batched = request->max_splits() > 1;
+  const int64_t max_splits = batched ? request->max_splits() : 1;
   bool end_of_splits = false;
-  TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
-  TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
-                                         request->split_provider_index(),
-                                         end_of_splits));
-  response->set_end_of_splits(end_of_splits);
-  if (end_of_splits) {
-    // Reset the split provider to prepare for the next iteration.
-    TF_RETURN_IF_ERROR(split_providers_[iteration_id][provider_index]->Reset());
-  } else {
-    split.AsProtoTensorContent(response->mutable_split());
+  for (int64_t i = 0; i < max_splits && !end_of_splits; ++i) {
+    Tensor split;
+    TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+    TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
+                                           request->split_provider_index(),
+                                           end_of_splits));
+    if (end_of_splits) {
+      // Reset the split provider to prepare for the next iteration.
+      TF_RETURN_IF_ERROR(split_provider->Reset());
+    } else {
+      split.AsProtoTensorContent(batched ? response->add_splits()
+                                         : response->mutable_split());
+    }
   }
+  response->set_end_of_splits(end_of_splits);
   VLOG(3) << "Returning from GetSplit, end_of_splits=" << end_of_splits;
   return OkStatus();
 }
@@ -1101,6 +1161,18 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
 
   std::vector<std::shared_ptr<const Task>> tasks;
   TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration->iteration_id, tasks));
+  // Lists the tasks of the closest workers first. Round-robin reads visit the
+  // tasks in the same order on every consumer, so their order is kept.
+  if (!iteration->IsRoundRobin() && request->client_tags_size() > 0) {
+    const std::vector<std::string> client_tags(request->client_tags().begin(),
+                                               request->client_tags().end());
+    std::stable_sort(tasks.begin(), tasks.end(),
+                     [&client_tags](const std::shared_ptr<const Task>& a,
+                                    const std::shared_ptr<const Task>& b) {
+                       return GetTopologyDistance(client_tags, a->worker_tags) <
+                              GetTopologyDistance(client_tags, b->worker_tags);
+                     });
+  }
   for (const auto& task : tasks) {
     TaskInfo* task_info = response->mutable_task_info()->Add();
     task_info->set_worker_address(task->worker_address);
@@ -1136,6 +1208,57 @@ Status DataServiceDispatcherImpl::GetWorkers(const GetWorkersRequest* request,
   return OkStatus();
 }
 
+Status DataServiceDispatcherImpl::GetWorkerTargets(
+    const GetWorkerTargetsRequest* request,
+    GetWorkerTargetsResponse* response) {
+  TF_RETURN_IF_ERROR(CheckStarted());
+  if (request->lookahead_ms() < 0) {
+    return errors::InvalidArgument("lookahead_ms must be non-negative, got ",
+                                   request->lookahead_ms());
+  }
+  mutex_lock l(mu_);
+  const int64_t current_number_of_workers =
+      state_.GetNumberOfRegisteredWorkers();
+  const absl::Time time = absl::FromUnixMicros(env_->NowMicros()) +
+                          absl::Milliseconds(request->lookahead_ms());
+  // Iterations of the same job are repetitions, so a job needs as many workers
+  // as its most demanding iteration.
+  absl::flat_hash_map<int64_t, JobWorkerTarget> job_targets;
+  for (const auto& [iteration_id, target] :
+       auto_scaler_.GetWorkerTargets(time, current_number_of_workers)) {
+    std::shared_ptr<const Iteration> iteration;
+    if (!state_.IterationFromId(iteration_id, iteration).ok()) {
+      continue;
+    }
+    JobWorkerTarget& job_target = job_targets[iteration->job->id];
+    job_target.set_job_id(iteration->job->id);
+    job_target.set_job_name(iteration->job->job_name);
+    job_target.set_optimal_number_of_workers(
+        std::max(job_target.optimal_number_of_workers(),
+                 target.optimal_number_of_workers));
+    job_target.set_predicted_number_of_workers(
+        std::max(job_target.predicted_number_of_workers(),
+                 target.predicted_number_of_workers));
+  }
+  response->set_current_number_of_workers(current_number_of_workers);
+  for (auto& [job_id, job_target] : job_targets) {
+    response->set_optimal_number_of_workers(
+        std::max(response->optimal_number_of_workers(),
+                 job_target.optimal_number_of_workers()));
+    response->set_predicted_number_of_workers(
+        std::max(response->predicted_number_of_workers(),
+                 job_target.predicted_number_of_workers()));
+    *response->add_jobs() = std::move(job_target);
+  }
+  std::sort(response->mutable_jobs()->begin(), response->mutable_jobs()->end(),
+            [](const JobWorkerTarget& a, const JobWorkerTarget& b) {
+              return a.job_id() < b.job_id();
+            });
+  VLOG(3) << "Returning worker targets for " << response->jobs_size()
+          << " jobs: " << response->ShortDebugString();
+  return OkStatus();
+}
+
 Status DataServiceDispatcherImpl::Snapshot(const SnapshotRequest* request,
                                            SnapshotResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
@@ -1290,8 +1413,38 @@ Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
     TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    ++num_updates_since_compaction_;
   }
-  return state_.Apply(update);
+  TF_RETURN_IF_ERROR(state_.Apply(update));
+  MaybeCompactJournal();
+  return OkStatus();
+}
+
+void DataServiceDispatcherImpl::MaybeCompactJournal()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (!journal_writer_.has_value() ||
+      config_.journal_compaction_threshold() < 0 ||
+      num_updates_since_compaction_ < config_.journal_compaction_threshold()) {
+    return;
+  }
+  // On failure, the journal is left uncompacted until another
+  // `journal_compaction_threshold` updates have been written.
+  num_updates_since_compaction_ = 0;
+  int64_t start = env_->NowMicros();
+  StatusOr<std::vector<Update>> updates = state_.CompactedUpdates();
+  if (!updates.ok()) {
+    VLOG(1) << "Postponing dispatcher journal compaction: "
+            << updates.status();
+    return;
+  }
+  Status s = journal_writer_.value()->Compact(*updates);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to compact the dispatcher journal: " << s;
+    return;
+  }
+  absl::Duration duration = absl::Microseconds(env_->NowMicros() - start);
+  LOG(INFO) << "Compacted the dispatcher journal into " << updates->size()
+            << " updates in " << duration << ".";
 }
 
 void DataServiceDispatcherImpl::MaintenanceThread() {
@@ -1312,6 +1465,7 @@ void DataServiceDispatcherImpl::MaintenanceThread() {
         LOG(WARNING) << "Error releasing missing clients: " << s;
       }
     }
+    auto_scaler_.RecordWorkload(absl::FromUnixMicros(env_->NowMicros()));
     {
       Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
           state_.GetNumberOfRegisteredWorkers());
@@ -1399,6 +1553,7 @@ void DataServiceDispatcherImpl::RemoveWorkerFromAutoScaler(
 // TODO(b/250921378): Once snapshots have leases, inform snapshot managers.
 void DataServiceDispatcherImpl::DetectMissingWorkers()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  mutex_lock l(worker_heartbeats_mu_);
   int64_t now = env_->NowMicros();
   for (auto it = latest_worker_heartbeats_time_.begin();
        it != latest_worker_heartbeats_time_.end();) {
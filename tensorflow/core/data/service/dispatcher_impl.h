@@ -184,6 +184,8 @@ class DataServiceDispatcherImpl {
   Status DisableCompressionAtRuntime(
       const DisableCompressionAtRuntimeRequest* request,
       DisableCompressionAtRuntimeResponse* response);
+  Status GetWorkerTargets(const GetWorkerTargetsRequest* request,
+                          GetWorkerTargetsResponse* response);
 
   // Exports the dispatcher state for debugging.
   DispatcherStateExport ExportState() const;
@@ -253,7 +255,14 @@ class DataServiceDispatcherImpl {
   // Reports the processing time of each active task to `auto_scaler_`.
   void ReportProcessingTimesFromActiveTasks(
       const std::vector<ActiveTask>& active_tasks,
-      const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+      const std::string& worker_address) TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Handles a heartbeat from a registered worker that knows all of its tasks
+  // and needs no new pending tasks, which is the common case, without updating
+  // the dispatcher state. Returns false, leaving `response` unchanged, if the
+  // heartbeat needs to update the state.
+  StatusOr<bool> ReadOnlyWorkerHeartbeat(const WorkerHeartbeatRequest& request,
+                                         WorkerHeartbeatResponse& response)
+      TF_SHARED_LOCKS_REQUIRED(mu_);
   // Acquires an iteration client id to read from the given iteration and sets
   // `iteration_client_id`.
   Status AcquireIterationClientId(
@@ -314,6 +323,9 @@ class DataServiceDispatcherImpl {
   // used when recovering state when the dispatcher starts.
   Status ApplyWithoutJournaling(const Update& update)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Compacts the journal if `journal_compaction_threshold` updates have been
+  // written to it since it was last compacted.
+  void MaybeCompactJournal() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Removes the client with `client_id` from `auto_scaler_`
   void RemoveClientFromAutoScaler(int64_t client_id)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -367,9 +379,12 @@ class DataServiceDispatcherImpl {
   // Map from client id to the time of the client's last heartbeat.
   absl::flat_hash_map<int64_t, absl::Time> latest_client_heartbeats_time_
       TF_GUARDED_BY(mu_);
+  // Guards the worker heartbeat times separately from `mu_`, since they are
+  // updated by every worker heartbeat.
+  mutex worker_heartbeats_mu_ TF_ACQUIRED_AFTER(mu_);
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(worker_heartbeats_mu_);
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
@@ -382,6 +397,8 @@ class DataServiceDispatcherImpl {
 
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // The number of updates in the journal since it was last compacted.
+  int64_t num_updates_since_compaction_ TF_GUARDED_BY(mu_) = 0;
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the gc thread.
   condition_variable maintenance_thread_cv_;
@@ -18,6 +18,7 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -88,6 +89,12 @@ Status DispatcherState::Apply(const Update& update) {
     case Update::kCompressionDisabledAtRuntime:
       CompressionDisabledAtRuntime(update.compression_disabled_at_runtime());
       break;
+    case Update::kRestoreIteration:
+      RestoreIteration(update.restore_iteration());
+      break;
+    case Update::kRestoreNextAvailableIds:
+      RestoreNextAvailableIds(update.restore_next_available_ids());
+      break;
     case Update::UPDATE_TYPE_NOT_SET:
       return errors::Internal("Update type not set.");
   }
@@ -289,6 +296,7 @@ void DispatcherState::CreateTask(const CreateTaskUpdate& create_task) {
   auto& iteration = iterations_[create_task.iteration_id()];
   DCHECK_NE(iteration, nullptr);
   task = std::make_shared<Task>(create_task, iteration);
+  task->starting_round = create_task.starting_round();
   tasks_by_iteration_[create_task.iteration_id()].push_back(task);
   tasks_by_worker_[create_task.worker_address()][task->task_id] = task;
   next_available_task_id_ = std::max(next_available_task_id_, task_id + 1);
@@ -484,6 +492,212 @@ void DispatcherState::CompressionDisabledAtRuntime(
   });
 }
 
+void DispatcherState::RestoreIteration(
+    const RestoreIterationUpdate& restore_iteration) {
+  std::shared_ptr<Iteration>& iteration =
+      iterations_[restore_iteration.iteration_id()];
+  DCHECK(iteration);
+  if (iteration->distributed_epoch_state.has_value()) {
+    DistributedEpochState& state = iteration->distributed_epoch_state.value();
+    DCHECK_EQ(restore_iteration.split_provider_repetitions_size(),
+              state.repetitions.size());
+    DCHECK_EQ(restore_iteration.split_provider_indices_size(),
+              state.indices.size());
+    state.repetitions.assign(
+        restore_iteration.split_provider_repetitions().begin(),
+        restore_iteration.split_provider_repetitions().end());
+    state.indices.assign(restore_iteration.split_provider_indices().begin(),
+                         restore_iteration.split_provider_indices().end());
+  }
+  iteration->last_client_released_micros =
+      restore_iteration.last_client_released_micros();
+  iteration->finished = restore_iteration.finished();
+}
+
+void DispatcherState::RestoreNextAvailableIds(
+    const RestoreNextAvailableIdsUpdate& restore_next_available_ids) {
+  next_available_job_id_ =
+      std::max(next_available_job_id_, restore_next_available_ids.job_id());
+  next_available_iteration_id_ = std::max(
+      next_available_iteration_id_, restore_next_available_ids.iteration_id());
+  next_available_iteration_client_id_ =
+      std::max(next_available_iteration_client_id_,
+               restore_next_available_ids.iteration_client_id());
+  next_available_task_id_ =
+      std::max(next_available_task_id_, restore_next_available_ids.task_id());
+}
+
+StatusOr<std::vector<Update>> DispatcherState::CompactedUpdates() const {
+  // Updates are emitted in the order of ids and addresses, so that compacting
+  // the same state always produces the same journal.
+  std::vector<Update> updates;
+
+  std::vector<std::string> dataset_ids;
+  dataset_ids.reserve(datasets_by_id_.size());
+  for (const auto& [dataset_id, dataset] : datasets_by_id_) {
+    dataset_ids.push_back(dataset_id);
+  }
+  std::sort(dataset_ids.begin(), dataset_ids.end());
+  for (const std::string& dataset_id : dataset_ids) {
+    RegisterDatasetUpdate* register_dataset =
+        updates.emplace_back().mutable_register_dataset();
+    register_dataset->set_dataset_id(dataset_id);
+    *register_dataset->mutable_metadata() =
+        datasets_by_id_.at(dataset_id)->metadata;
+  }
+  std::vector<std::pair<std::string, bool>> compression_disabled(
+      compression_disabled_at_runtime_.begin(),
+      compression_disabled_at_runtime_.end());
+  std::sort(compression_disabled.begin(), compression_disabled.end());
+  for (const auto& [dataset_id, disabled] : compression_disabled) {
+    CompressionDisabledAtRuntimeUpdate* compression_disabled_at_runtime =
+        updates.emplace_back().mutable_compression_disabled_at_runtime();
+    compression_disabled_at_runtime->set_dataset_id(dataset_id);
+    compression_disabled_at_runtime->set_compression_disabled(disabled);
+  }
+
+  std::vector<std::string> worker_addresses;
+  worker_addresses.reserve(workers_.size());
+  for (const auto& [address, worker] : workers_) {
+    worker_addresses.push_back(address);
+  }
+  std::sort(worker_addresses.begin(), worker_addresses.end());
+  for (const std::string& address : worker_addresses) {
+    const Worker& worker = *workers_.at(address);
+    RegisterWorkerUpdate* register_worker =
+        updates.emplace_back().mutable_register_worker();
+    register_worker->set_worker_address(worker.address);
+    *register_worker->mutable_transfer_servers() = {
+        worker.transfer_servers.begin(), worker.transfer_servers.end()};
+    *register_worker->mutable_worker_tags() = {worker.tags.begin(),
+                                               worker.tags.end()};
+    register_worker->set_worker_uid(worker.uid);
+  }
+
+  std::vector<std::string> snapshot_paths(snapshot_paths_.begin(),
+                                          snapshot_paths_.end());
+  std::sort(snapshot_paths.begin(), snapshot_paths.end());
+  for (const std::string& path : snapshot_paths) {
+    updates.emplace_back().mutable_snapshot()->set_path(path);
+  }
+
+  std::vector<int64_t> job_ids;
+  job_ids.reserve(jobs_by_id_.size());
+  for (const auto& [job_id, job] : jobs_by_id_) {
+    job_ids.push_back(job_id);
+  }
+  std::sort(job_ids.begin(), job_ids.end());
+  for (int64_t job_id : job_ids) {
+    const Job& job = *jobs_by_id_.at(job_id);
+    CreateJobUpdate* create_job = updates.emplace_back().mutable_create_job();
+    create_job->set_job_id(job.id);
+    create_job->set_job_name(job.job_name);
+    create_job->set_dataset_id(job.dataset_id);
+    *create_job->mutable_processing_mode_def() = job.processing_mode;
+    if (job.num_consumers.has_value()) {
+      create_job->set_num_consumers(job.num_consumers.value());
+    }
+    create_job->set_target_workers(job.target_workers);
+    create_job->set_use_cross_trainer_cache(job.use_cross_trainer_cache);
+  }
+
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> client_ids_by_iteration;
+  for (const auto& [client_id, iteration] : iterations_for_client_ids_) {
+    // `IterationForIterationClientId` may leave null entries behind.
+    if (iteration) {
+      client_ids_by_iteration[iteration->iteration_id].push_back(client_id);
+    }
+  }
+  std::vector<int64_t> iteration_ids;
+  iteration_ids.reserve(iterations_.size());
+  for (const auto& [iteration_id, iteration] : iterations_) {
+    iteration_ids.push_back(iteration_id);
+  }
+  // Iterations are created in increasing id order, so a garbage collected
+  // iteration is replayed before any later iteration with the same key.
+  std::sort(iteration_ids.begin(), iteration_ids.end());
+  for (int64_t iteration_id : iteration_ids) {
+    const Iteration& iteration = *iterations_.at(iteration_id);
+    if (!iteration.pending_tasks.empty()) {
+      return errors::FailedPrecondition(
+          "Cannot compact the dispatcher state while iteration ",
+          iteration.DebugString(), " has pending tasks.");
+    }
+    CreateIterationUpdate* create_iteration =
+        updates.emplace_back().mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration_id);
+    create_iteration->set_job_id(iteration.job->id);
+    create_iteration->set_repetition(iteration.iteration_key.repetition);
+    if (iteration.distributed_epoch_state.has_value()) {
+      create_iteration->set_num_split_providers(
+          iteration.distributed_epoch_state->repetitions.size());
+    }
+
+    for (const auto& task : tasks_by_iteration_.at(iteration_id)) {
+      CreateTaskUpdate* create_task =
+          updates.emplace_back().mutable_create_task();
+      create_task->set_task_id(task->task_id);
+      create_task->set_iteration_id(iteration_id);
+      create_task->set_worker_address(task->worker_address);
+      *create_task->mutable_transfer_servers() = {
+          task->transfer_servers.begin(), task->transfer_servers.end()};
+      *create_task->mutable_worker_tags() = {task->worker_tags.begin(),
+                                             task->worker_tags.end()};
+      create_task->set_worker_uid(task->worker_uid);
+      create_task->set_starting_round(task->starting_round);
+    }
+    if (!iteration.garbage_collected) {
+      for (const auto& task : tasks_by_iteration_.at(iteration_id)) {
+        if (task->finished) {
+          updates.emplace_back().mutable_finish_task()->set_task_id(
+              task->task_id);
+        }
+      }
+    }
+
+    if (auto it = client_ids_by_iteration.find(iteration_id);
+        it != client_ids_by_iteration.end()) {
+      std::sort(it->second.begin(), it->second.end());
+      for (int64_t client_id : it->second) {
+        AcquireIterationClientUpdate* acquire_iteration_client =
+            updates.emplace_back().mutable_acquire_iteration_client();
+        acquire_iteration_client->set_iteration_id(iteration_id);
+        acquire_iteration_client->set_iteration_client_id(client_id);
+      }
+    }
+
+    RestoreIterationUpdate* restore_iteration =
+        updates.emplace_back().mutable_restore_iteration();
+    restore_iteration->set_iteration_id(iteration_id);
+    if (iteration.distributed_epoch_state.has_value()) {
+      const DistributedEpochState& state =
+          iteration.distributed_epoch_state.value();
+      *restore_iteration->mutable_split_provider_repetitions() = {
+          state.repetitions.begin(), state.repetitions.end()};
+      *restore_iteration->mutable_split_provider_indices() = {
+          state.indices.begin(), state.indices.end()};
+    }
+    restore_iteration->set_last_client_released_micros(
+        iteration.last_client_released_micros);
+    restore_iteration->set_finished(iteration.finished);
+
+    if (iteration.garbage_collected) {
+      updates.emplace_back()
+          .mutable_garbage_collect_iteration()
+          ->set_iteration_id(iteration_id);
+    }
+  }
+
+  RestoreNextAvailableIdsUpdate* restore_next_available_ids =
+      updates.emplace_back().mutable_restore_next_available_ids();
+  restore_next_available_ids->set_job_id(next_available_job_id_);
+  restore_next_available_ids->set_iteration_id(next_available_iteration_id_);
+  restore_next_available_ids->set_iteration_client_id(
+      next_available_iteration_client_id_);
+  restore_next_available_ids->set_task_id(next_available_task_id_);
+  return updates;
+}
+
 std::optional<bool> DispatcherState::CompressionDisabledAtRuntime(
     const std::string& dataset_id) const {
   if (auto it = compression_disabled_at_runtime_.find(dataset_id);
@@ -73,6 +73,15 @@ class DispatcherState {
   // Applies the given update to the dispatcher's state.
   Status Apply(const Update& update);
 
+  // Returns updates that recreate the current state when applied to a new
+  // `DispatcherState` with the same config. Their number depends on the number
+  // of datasets, workers, jobs, iterations, tasks, and clients, not on the
+  // number of updates applied so far, so they can replace a long journal.
+  //
+  // Returns FAILED_PRECONDITION while a round-robin iteration has pending
+  // tasks, since the pending tasks' progress is not captured by the updates.
+  StatusOr<std::vector<Update>> CompactedUpdates() const;
+
   // A dataset registered with the dispatcher.
   struct Dataset {
     explicit Dataset(const std::string& dataset_id,
@@ -324,6 +333,9 @@ class DispatcherState {
   void Snapshot(const SnapshotUpdate& snapshot);
   void CompressionDisabledAtRuntime(const CompressionDisabledAtRuntimeUpdate&
                                         compression_disabled_at_runtime);
+  void RestoreIteration(const RestoreIterationUpdate& restore_iteration);
+  void RestoreNextAvailableIds(
+      const RestoreNextAvailableIdsUpdate& restore_next_available_ids);
 
   // Updates the next available dataset ID.
   void UpdateNextAvailableDatasetId();
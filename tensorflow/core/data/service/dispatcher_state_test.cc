@@ -40,6 +40,7 @@ using IterationKey = DispatcherState::IterationKey;
 using Job = DispatcherState::Job;
 using Iteration = DispatcherState::Iteration;
 using Task = DispatcherState::Task;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::SizeIs;
@@ -652,5 +653,186 @@ TEST(DispatcherState, GetNumberOfRegisteredWorkers) {
   EXPECT_EQ(state.GetNumberOfRegisteredWorkers(), 2);
 }
 
+TEST(DispatcherState, CompactedUpdatesRecreateState) {
+  int64_t iteration_id = 3;
+  int64_t gc_iteration_id = 4;
+  int64_t task_id = 8;
+  int64_t finished_task_id = 9;
+  int64_t gc_task_id = 10;
+  int64_t removed_task_id = 11;
+  int64_t client_id = 20;
+  int64_t released_client_id = 21;
+  std::string dataset_id = "dataset_id";
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  TF_ASSERT_OK(RegisterDataset(dataset_id, state));
+  TF_ASSERT_OK(RegisterWorker(worker_address, state));
+  TF_ASSERT_OK(Snapshot("snapshot_path", state));
+  TF_ASSERT_OK(CreateIteration(iteration_id, dataset_id, state));
+  TF_ASSERT_OK(CreateTask(task_id, iteration_id, worker_address, state));
+  TF_ASSERT_OK(
+      CreateTask(finished_task_id, iteration_id, worker_address, state));
+  TF_ASSERT_OK(FinishTask(finished_task_id, state));
+  TF_ASSERT_OK(
+      CreateTask(removed_task_id, iteration_id, worker_address, state));
+  {
+    Update update;
+    update.mutable_remove_task()->set_task_id(removed_task_id);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  TF_ASSERT_OK(AcquireIterationClientId(iteration_id, client_id, state));
+  TF_ASSERT_OK(
+      AcquireIterationClientId(iteration_id, released_client_id, state));
+  TF_ASSERT_OK(ReleaseIterationClientId(released_client_id,
+                                        /*release_time=*/100, state));
+  TF_ASSERT_OK(CreateIteration(gc_iteration_id, dataset_id, state));
+  TF_ASSERT_OK(CreateTask(gc_task_id, gc_iteration_id, worker_address, state));
+  {
+    Update update;
+    update.mutable_garbage_collect_iteration()->set_iteration_id(
+        gc_iteration_id);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Update> updates,
+                          state.CompactedUpdates());
+  DispatcherState restored;
+  for (const Update& update : updates) {
+    TF_ASSERT_OK(restored.Apply(update));
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Update> restored_updates,
+                          restored.CompactedUpdates());
+  ASSERT_EQ(restored_updates.size(), updates.size());
+  for (int i = 0; i < updates.size(); ++i) {
+    EXPECT_EQ(restored_updates[i].SerializeAsString(),
+              updates[i].SerializeAsString());
+  }
+  EXPECT_EQ(restored.NextAvailableDatasetId(), state.NextAvailableDatasetId());
+  EXPECT_EQ(restored.NextAvailableJobId(), state.NextAvailableJobId());
+  EXPECT_EQ(restored.NextAvailableIterationId(),
+            state.NextAvailableIterationId());
+  EXPECT_EQ(restored.NextAvailableIterationClientId(),
+            state.NextAvailableIterationClientId());
+  EXPECT_EQ(restored.NextAvailableTaskId(), removed_task_id + 1);
+  EXPECT_THAT(restored.ListSnapshotPaths(),
+              UnorderedElementsAre("snapshot_path"));
+  EXPECT_THAT(restored.ListActiveClientIds(), UnorderedElementsAre(client_id));
+
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored.IterationFromId(iteration_id, iteration));
+  EXPECT_EQ(iteration->num_clients, 1);
+  EXPECT_EQ(iteration->last_client_released_micros, 100);
+  EXPECT_FALSE(iteration->finished);
+  std::vector<std::shared_ptr<const Task>> tasks;
+  TF_ASSERT_OK(restored.TasksForIteration(iteration_id, tasks));
+  ASSERT_THAT(tasks, SizeIs(2));
+  EXPECT_EQ(tasks[0]->task_id, task_id);
+  EXPECT_FALSE(tasks[0]->finished);
+  EXPECT_EQ(tasks[1]->task_id, finished_task_id);
+  EXPECT_TRUE(tasks[1]->finished);
+  std::shared_ptr<const Task> task;
+  EXPECT_THAT(restored.TaskFromId(removed_task_id, task),
+              StatusIs(error::NOT_FOUND));
+
+  TF_ASSERT_OK(restored.IterationFromId(gc_iteration_id, iteration));
+  EXPECT_TRUE(iteration->finished);
+  EXPECT_TRUE(iteration->garbage_collected);
+  TF_ASSERT_OK(restored.TasksForWorker(worker_address, tasks));
+  ASSERT_THAT(tasks, SizeIs(1));
+  EXPECT_EQ(tasks[0]->task_id, task_id);
+}
+
+TEST(DispatcherState, CompactedUpdatesRestoreSplitProviders) {
+  int64_t job_id = 1;
+  int64_t iteration_id = 3;
+  DispatcherState state;
+  TF_ASSERT_OK(RegisterDataset("dataset_id", state));
+  {
+    Update update;
+    CreateJobUpdate* create_job = update.mutable_create_job();
+    create_job->set_job_id(job_id);
+    create_job->set_dataset_id("dataset_id");
+    create_job->set_job_name("job_name");
+    create_job->mutable_processing_mode_def()->set_sharding_policy(
+        ProcessingModeDef::DYNAMIC);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  {
+    Update update;
+    CreateIterationUpdate* create_iteration =
+        update.mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration_id);
+    create_iteration->set_job_id(job_id);
+    create_iteration->set_num_split_providers(2);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  int64_t repetition = 0;
+  for (bool finished : {false, false, true, false}) {
+    Update update;
+    ProduceSplitUpdate* produce_split = update.mutable_produce_split();
+    produce_split->set_iteration_id(iteration_id);
+    produce_split->set_repetition(repetition);
+    produce_split->set_split_provider_index(1);
+    produce_split->set_finished(finished);
+    TF_ASSERT_OK(state.Apply(update));
+    if (finished) {
+      ++repetition;
+    }
+  }
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<Update> updates,
+                          state.CompactedUpdates());
+  DispatcherState restored;
+  for (const Update& update : updates) {
+    TF_ASSERT_OK(restored.Apply(update));
+  }
+  std::shared_ptr<const Iteration> iteration;
+  TF_ASSERT_OK(restored.IterationFromId(iteration_id, iteration));
+  ASSERT_TRUE(iteration->distributed_epoch_state.has_value());
+  EXPECT_THAT(iteration->distributed_epoch_state->repetitions,
+              ElementsAre(0, 1));
+  EXPECT_THAT(iteration->distributed_epoch_state->indices, ElementsAre(0, 1));
+}
+
+TEST(DispatcherState, CompactedUpdatesWithPendingTasks) {
+  int64_t job_id = 1;
+  int64_t iteration_id = 3;
+  std::string worker_address = "test_worker_address";
+  DispatcherState state;
+  TF_ASSERT_OK(RegisterDataset("dataset_id", state));
+  TF_ASSERT_OK(RegisterWorker(worker_address, state));
+  {
+    Update update;
+    CreateJobUpdate* create_job = update.mutable_create_job();
+    create_job->set_job_id(job_id);
+    create_job->set_dataset_id("dataset_id");
+    create_job->set_job_name("job_name");
+    create_job->set_num_consumers(2);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  {
+    Update update;
+    CreateIterationUpdate* create_iteration =
+        update.mutable_create_iteration();
+    create_iteration->set_iteration_id(iteration_id);
+    create_iteration->set_job_id(job_id);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  {
+    Update update;
+    CreatePendingTaskUpdate* create_pending_task =
+        update.mutable_create_pending_task();
+    create_pending_task->set_task_id(8);
+    create_pending_task->set_iteration_id(iteration_id);
+    create_pending_task->set_worker_address(worker_address);
+    create_pending_task->set_starting_round(5);
+    TF_ASSERT_OK(state.Apply(update));
+  }
+  EXPECT_THAT(state.CompactedUpdates(),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("has pending tasks")));
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -67,6 +67,7 @@ HANDLER(Snapshot);
 HANDLER(GetSnapshotSplit);
 HANDLER(GetSnapshotStreams);
 HANDLER(DisableCompressionAtRuntime);
+HANDLER(GetWorkerTargets);
 #undef HANDLER
 
 }  // namespace data
@@ -62,6 +62,7 @@ class GrpcDispatcherImpl : public DispatcherService::Service {
   HANDLER(GetSnapshotSplit);
   HANDLER(GetSnapshotStreams);
   HANDLER(DisableCompressionAtRuntime);
+  HANDLER(GetWorkerTargets);
 #undef HANDLER
 
  private:
@@ -0,0 +1,517 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/grpc_element_coding.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/proto_buffer_reader.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_reference.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Tensor contents larger than this are shared with the encoded buffer instead
+// of copied into it.
+constexpr size_t kLargeTensorBytes = 1024;
+
+enum WireType {
+  WIRETYPE_VARINT = 0,
+  WIRETYPE_LENGTH_DELIMITED = 2,
+};
+
+int GetTagFieldNumber(uint32 tag) { return tag >> 3; }
+WireType GetTagWireType(uint32 tag) { return static_cast<WireType>(tag & 0x7); }
+
+// Appends the tag and length of a length-delimited field to `out`.
+void AppendLengthDelimitedHeader(int field_number, uint64 length,
+                                 std::string* out) {
+  core::PutVarint32(out, (field_number << 3) | WIRETYPE_LENGTH_DELIMITED);
+  core::PutVarint64(out, length);
+}
+
+uint64 LengthDelimitedSize(int field_number, uint64 length) {
+  return core::VarintLength((field_number << 3) | WIRETYPE_LENGTH_DELIMITED) +
+         core::VarintLength(length) + length;
+}
+
+// The encoding of an uncompressed component: `prefix` is the encoding of its
+// `TensorProto` up to the contents, which `tensor` holds if it is set.
+struct EncodedComponent {
+  std::string prefix;
+  const Tensor* tensor = nullptr;
+
+  uint64 size() const {
+    return prefix.size() + (tensor ? tensor->tensor_data().size() : 0);
+  }
+};
+
+EncodedComponent EncodeComponent(const Tensor& tensor) {
+  EncodedComponent result;
+  TensorProto proto;
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+    tensor.AsProtoTensorContent(&proto);
+    proto.AppendToString(&result.prefix);
+    return result;
+  }
+  proto.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(proto.mutable_tensor_shape());
+  proto.AppendToString(&result.prefix);
+  const size_t num_bytes = tensor.tensor_data().size();
+  if (num_bytes > 0) {
+    AppendLengthDelimitedHeader(TensorProto::kTensorContentFieldNumber,
+                                num_bytes, &result.prefix);
+    result.tensor = &tensor;
+  }
+  return result;
+}
+
+// Builds a `ByteBuffer` from bytes that are copied and tensor contents that
+// are shared when they are large.
+class SliceBuilder {
+ public:
+  std::string* pending() { return &pending_; }
+
+  void AppendTensorData(const Tensor& tensor) {
+    StringPiece data = tensor.tensor_data();
+    if (data.size() <= kLargeTensorBytes) {
+      pending_.append(data.data(), data.size());
+      return;
+    }
+    Flush();
+    auto* ref = new TensorReference(tensor);
+    slices_.emplace_back(
+        const_cast<char*>(data.data()), data.size(),
+        [](void* backing) {
+          auto* ref = static_cast<TensorReference*>(backing);
+          ref->Unref();
+          delete ref;
+        },
+        ref);
+  }
+
+  void Build(::grpc::ByteBuffer* buffer) {
+    Flush();
+    ::grpc::ByteBuffer tmp(slices_.data(), slices_.size());
+    buffer->Swap(&tmp);
+  }
+
+ private:
+  void Flush() {
+    if (pending_.empty()) return;
+    slices_.emplace_back(pending_.data(), pending_.size());
+    pending_.clear();
+  }
+
+  std::string pending_;
+  std::vector<::grpc::Slice> slices_;
+};
+
+bool ReadVarintSizeAsInt(protobuf::io::CodedInputStream* input, int* result) {
+  protobuf_uint64 v;
+  if (input->ReadVarint64(&v) && v <= static_cast<uint64>(INT_MAX)) {
+    *result = static_cast<int>(v);
+    return true;
+  }
+  return false;
+}
+
+bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
+                       protobuf::MessageLite* value) {
+  int length;
+  if (!ReadVarintSizeAsInt(input, &length)) return false;
+  std::pair<protobuf::io::CodedInputStream::Limit, int> p =
+      input->IncrementRecursionDepthAndPushLimit(length);
+  if (p.second < 0 || !value->MergePartialFromCodedStream(input)) return false;
+  return input->DecrementRecursionDepthAndPopLimit(p.first);
+}
+
+// Parses a memcpy-able `TensorProto` whose dtype and shape come before its
+// contents, reading the contents directly into `tensor`. Returns false if the
+// tensor needs to be parsed as a `TensorProto`.
+bool ParseTensorFast(protobuf::io::CodedInputStream* input, Tensor* tensor) {
+  TensorProto meta;
+  bool seen_tensor_content = false;
+  while (true) {
+    auto p = input->ReadTagWithCutoff(127);
+    int tag = GetTagFieldNumber(p.first);
+    WireType wt = GetTagWireType(p.first);
+    if (!p.second) {
+      if (tag != 0) return false;
+      if (!seen_tensor_content) {
+        // The tensor is empty, or has zero-valued contents that are omitted.
+        if (!DataTypeCanUseMemcpy(meta.dtype()) ||
+            !TensorShape::IsValid(meta.tensor_shape())) {
+          return false;
+        }
+        Tensor t(meta.dtype(), TensorShape(meta.tensor_shape()));
+        if (t.TotalBytes() > 0) return false;
+        *tensor = std::move(t);
+      }
+      return true;
+    }
+    if (seen_tensor_content) return false;
+    switch (tag) {
+      case TensorProto::kDtypeFieldNumber: {
+        uint32 v;
+        if (wt != WIRETYPE_VARINT || !input->ReadVarint32(&v)) return false;
+        meta.set_dtype(static_cast<DataType>(static_cast<int>(v)));
+        if (!DataTypeCanUseMemcpy(meta.dtype())) return false;
+        break;
+      }
+      case TensorProto::kTensorShapeFieldNumber: {
+        if (wt != WIRETYPE_LENGTH_DELIMITED ||
+            !ReadNestedMessage(input, meta.mutable_tensor_shape())) {
+          return false;
+        }
+        break;
+      }
+      case TensorProto::kTensorContentFieldNumber: {
+        if (wt != WIRETYPE_LENGTH_DELIMITED ||
+            !DataTypeCanUseMemcpy(meta.dtype()) || !meta.has_tensor_shape() ||
+            !TensorShape::IsValid(meta.tensor_shape())) {
+          return false;
+        }
+        int num_bytes;
+        if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
+        TensorShape shape(meta.tensor_shape());
+        if (shape.num_elements() * DataTypeSize(meta.dtype()) != num_bytes) {
+          return false;
+        }
+        Tensor t(meta.dtype(), shape);
+        StringPiece buf = t.tensor_data();
+        if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes)) {
+          return false;
+        }
+        *tensor = std::move(t);
+        seen_tensor_content = true;
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+}
+
+bool ParseUncompressedFast(protobuf::io::CodedInputStream* input,
+                           std::vector<Tensor>* components) {
+  while (true) {
+    auto p = input->ReadTagWithCutoff(127);
+    int tag = GetTagFieldNumber(p.first);
+    if (!p.second) return tag == 0;
+    if (tag != UncompressedElement::kComponentsFieldNumber ||
+        GetTagWireType(p.first) != WIRETYPE_LENGTH_DELIMITED) {
+      return false;
+    }
+    int length;
+    if (!ReadVarintSizeAsInt(input, &length)) return false;
+    std::pair<protobuf::io::CodedInputStream::Limit, int> limit =
+        input->IncrementRecursionDepthAndPushLimit(length);
+    components->emplace_back();
+    if (limit.second < 0 || !ParseTensorFast(input, &components->back()) ||
+        !input->DecrementRecursionDepthAndPopLimit(limit.first)) {
+      return false;
+    }
+  }
+}
+
+// Decodes `GetElementResponse` fields into `result` without parsing their
+// tensors into `TensorProto`s first. Returns false if the response has
+// fields that this cannot handle, in which case `result` is unspecified.
+bool ParseFast(protobuf::io::CodedInputStream& input,
+               GetElementResult& result) {
+  while (true) {
+    auto p = input.ReadTagWithCutoff(127);
+    int tag = GetTagFieldNumber(p.first);
+    WireType wt = GetTagWireType(p.first);
+    if (!p.second) return tag == 0;
+    switch (tag) {
+      case GetElementResponse::kEndOfSequenceFieldNumber: {
+        uint32 v;
+        if (wt != WIRETYPE_VARINT || !input.ReadVarint32(&v)) return false;
+        result.end_of_sequence = v != 0;
+        break;
+      }
+      case GetElementResponse::kSkipTaskFieldNumber: {
+        uint32 v;
+        if (wt != WIRETYPE_VARINT || !input.ReadVarint32(&v)) return false;
+        result.skip = v != 0;
+        break;
+      }
+      case GetElementResponse::kElementIndexFieldNumber: {
+        protobuf_uint64 v;
+        if (wt != WIRETYPE_VARINT || !input.ReadVarint64(&v)) return false;
+        result.element_index = static_cast<int64_t>(v);
+        break;
+      }
+      case GetElementResponse::kCompressedFieldNumber: {
+        CompressedElement compressed;
+        if (wt != WIRETYPE_LENGTH_DELIMITED || !result.components.empty() ||
+            !ReadNestedMessage(&input, &compressed)) {
+          return false;
+        }
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(compressed);
+        result.components.push_back(std::move(tensor));
+        break;
+      }
+      case GetElementResponse::kUncompressedFieldNumber: {
+        int length;
+        if (wt != WIRETYPE_LENGTH_DELIMITED || !result.components.empty() ||
+            !ReadVarintSizeAsInt(&input, &length)) {
+          return false;
+        }
+        std::pair<protobuf::io::CodedInputStream::Limit, int> limit =
+            input.IncrementRecursionDepthAndPushLimit(length);
+        if (limit.second < 0 ||
+            !ParseUncompressedFast(&input, &result.components) ||
+            !input.DecrementRecursionDepthAndPopLimit(limit.first)) {
+          return false;
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+}
+
+Status FromResponse(GetElementResponse& resp, GetElementResult& result) {
+  result.end_of_sequence = resp.end_of_sequence();
+  result.skip = resp.skip_task();
+  result.element_index = resp.element_index();
+  switch (resp.element_case()) {
+    case GetElementResponse::kCompressed: {
+      Tensor tensor(DT_VARIANT, TensorShape{});
+      tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
+      result.components.push_back(std::move(tensor));
+      break;
+    }
+    case GetElementResponse::kUncompressed:
+      for (const auto& component : resp.uncompressed().components()) {
+        result.components.emplace_back();
+        if (!result.components.back().FromProto(component)) {
+          return errors::Internal("Failed to parse tensor.");
+        }
+      }
+      break;
+    case GetElementResponse::ELEMENT_NOT_SET:
+      break;
+  }
+  return OkStatus();
+}
+
+// Decodes the `elements` of a `GetElementsResponse` like `ParseFast`.
+bool ParseElementsFast(protobuf::io::CodedInputStream& input,
+                       std::vector<GetElementResult>& results) {
+  while (true) {
+    auto p = input.ReadTagWithCutoff(127);
+    int tag = GetTagFieldNumber(p.first);
+    if (!p.second) return tag == 0;
+    int length;
+    if (tag != GetElementsResponse::kElementsFieldNumber ||
+        GetTagWireType(p.first) != WIRETYPE_LENGTH_DELIMITED ||
+        !ReadVarintSizeAsInt(&input, &length)) {
+      return false;
+    }
+    std::pair<protobuf::io::CodedInputStream::Limit, int> limit =
+        input.IncrementRecursionDepthAndPushLimit(length);
+    results.emplace_back();
+    if (limit.second < 0 || !ParseFast(input, results.back()) ||
+        !input.DecrementRecursionDepthAndPopLimit(limit.first)) {
+      return false;
+    }
+  }
+}
+
+// The encoding of a `GetElementResponse`, which shares the tensors of the
+// `GetElementResult` it is prepared from.
+struct EncodedResult {
+  // The encoding of all fields except `uncompressed`.
+  std::string header;
+  bool has_uncompressed = false;
+  // The size of the `uncompressed` field's contents.
+  uint64 uncompressed_size = 0;
+  std::vector<EncodedComponent> components;
+
+  uint64 size() const {
+    return header.size() +
+           (has_uncompressed
+                ? LengthDelimitedSize(
+                      GetElementResponse::kUncompressedFieldNumber,
+                      uncompressed_size)
+                : 0);
+  }
+};
+
+Status PrepareResult(const GetElementResult& result, EncodedResult& encoded) {
+  GetElementResponse header;
+  header.set_element_index(result.element_index);
+  header.set_end_of_sequence(result.end_of_sequence);
+  header.set_skip_task(result.skip);
+  const std::vector<Tensor>& element = result.components;
+  const bool has_element = !result.end_of_sequence && !result.skip;
+  const bool compressed = element.size() == 1 &&
+                          element[0].dtype() == DT_VARIANT &&
+                          TensorShapeUtils::IsScalar(element[0].shape());
+  if (has_element && compressed) {
+    const Variant& variant = element[0].scalar<Variant>()();
+    const CompressedElement* compressed_element =
+        variant.get<CompressedElement>();
+    if (compressed_element == nullptr) {
+      return errors::FailedPrecondition(
+          "Expected dataset to produce a CompressedElement variant tensor, but "
+          "it produced ",
+          variant.TypeName());
+    }
+    *header.mutable_compressed() = *compressed_element;
+  }
+  header.AppendToString(&encoded.header);
+  if (!has_element || compressed) return OkStatus();
+
+  encoded.has_uncompressed = true;
+  encoded.components.reserve(element.size());
+  for (const Tensor& component : element) {
+    encoded.components.push_back(EncodeComponent(component));
+    encoded.uncompressed_size +=
+        LengthDelimitedSize(UncompressedElement::kComponentsFieldNumber,
+                            encoded.components.back().size());
+  }
+  return OkStatus();
+}
+
+void WriteResult(const EncodedResult& encoded, SliceBuilder& builder) {
+  builder.pending()->append(encoded.header);
+  if (!encoded.has_uncompressed) return;
+  AppendLengthDelimitedHeader(GetElementResponse::kUncompressedFieldNumber,
+                              encoded.uncompressed_size, builder.pending());
+  for (const EncodedComponent& component : encoded.components) {
+    AppendLengthDelimitedHeader(UncompressedElement::kComponentsFieldNumber,
+                                component.size(), builder.pending());
+    builder.pending()->append(component.prefix);
+    if (component.tensor != nullptr) {
+      builder.AppendTensorData(*component.tensor);
+    }
+  }
+}
+
+}  // namespace
+
+Status EncodeGetElementResult(const GetElementResult& result,
+                              ::grpc::ByteBuffer* buffer) {
+  // Let R be the `GetElementResponse` for `result`. It is encoded as
+  //
+  // A: <the encoding of all fields of R except R.uncompressed()>
+  // B: <the tag and length of R.uncompressed()>
+  // For each component C of R.uncompressed():
+  //   C1: <the tag and length of C>
+  //   C2: <the encoding of C except C.tensor_content()>
+  //   C3: <the tag and length of C.tensor_content()>
+  //   C4: <the contents of the tensor, shared if they are large>
+  EncodedResult encoded;
+  TF_RETURN_IF_ERROR(PrepareResult(result, encoded));
+  if (encoded.size() > std::numeric_limits<int32>::max()) {
+    return errors::InvalidArgument(
+        "The element of ", encoded.size(),
+        " bytes is too large to send in a single GetElement response.");
+  }
+  SliceBuilder builder;
+  WriteResult(encoded, builder);
+  builder.Build(buffer);
+  return OkStatus();
+}
+
+Status EncodeGetElementResults(const std::vector<GetElementResult>& results,
+                               ::grpc::ByteBuffer* buffer) {
+  std::vector<EncodedResult> encoded(results.size());
+  uint64 total_size = 0;
+  for (int i = 0; i < results.size(); ++i) {
+    TF_RETURN_IF_ERROR(PrepareResult(results[i], encoded[i]));
+    total_size += LengthDelimitedSize(GetElementsResponse::kElementsFieldNumber,
+                                      encoded[i].size());
+  }
+  if (total_size > std::numeric_limits<int32>::max()) {
+    return errors::InvalidArgument(
+        "The ", results.size(), " elements of ", total_size,
+        " bytes are too large to send in a single GetElements response.");
+  }
+  SliceBuilder builder;
+  for (const EncodedResult& result : encoded) {
+    AppendLengthDelimitedHeader(GetElementsResponse::kElementsFieldNumber,
+                                result.size(), builder.pending());
+    WriteResult(result, builder);
+  }
+  builder.Build(buffer);
+  return OkStatus();
+}
+
+Status DecodeGetElementResult(::grpc::ByteBuffer* buffer,
+                              GetElementResult& result) {
+  {
+    ::grpc::ProtoBufferReader reader(buffer);
+    protobuf::io::CodedInputStream input(&reader);
+    if (ParseFast(input, result)) return OkStatus();
+  }
+  result = GetElementResult();
+  ::grpc::ProtoBufferReader reader(buffer);
+  GetElementResponse resp;
+  if (!resp.ParseFromZeroCopyStream(&reader)) {
+    return errors::Internal("Failed to parse GetElement response.");
+  }
+  return FromResponse(resp, result);
+}
+
+Status DecodeGetElementResults(::grpc::ByteBuffer* buffer,
+                               std::vector<GetElementResult>& results) {
+  results.clear();
+  {
+    ::grpc::ProtoBufferReader reader(buffer);
+    protobuf::io::CodedInputStream input(&reader);
+    if (ParseElementsFast(input, results)) return OkStatus();
+  }
+  results.clear();
+  ::grpc::ProtoBufferReader reader(buffer);
+  GetElementsResponse resp;
+  if (!resp.ParseFromZeroCopyStream(&reader)) {
+    return errors::Internal("Failed to parse GetElements response.");
+  }
+  results.resize(resp.elements_size());
+  for (int i = 0; i < resp.elements_size(); ++i) {
+    TF_RETURN_IF_ERROR(FromResponse(*resp.mutable_elements(i), results[i]));
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_GRPC_ELEMENT_CODING_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_GRPC_ELEMENT_CODING_H_
+
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// The full name of the raw variant of `WorkerService.GetElement`. It takes a
+// `GetElementRequest` and returns a serialized `GetElementResponse` that is
+// encoded by `EncodeGetElementResult`, so that the tensors of an element are
+// sent from their own buffers rather than copied into a proto first.
+constexpr char kGetElementRawMethod[] =
+    "/tensorflow.data.WorkerService/GetElementRaw";
+
+// The full name of the batched variant of `kGetElementRawMethod`. It takes a
+// `GetElementRequest` and returns a serialized `GetElementsResponse` that is
+// encoded by `EncodeGetElementResults`, with up to
+// `GetElementRequest.max_elements` elements.
+constexpr char kGetElementsRawMethod[] =
+    "/tensorflow.data.WorkerService/GetElementsRaw";
+
+// Encodes `result` into `buffer` as a serialized `GetElementResponse`.
+//
+// A single scalar `CompressedElement` variant component is encoded as the
+// `compressed` field, like `DataServiceWorkerImpl::GetElement` does. Otherwise
+// the components are encoded as the `uncompressed` field, and the contents of
+// large memcpy-able tensors are shared with `buffer` instead of copied.
+Status EncodeGetElementResult(const GetElementResult& result,
+                              ::grpc::ByteBuffer* buffer);
+
+// Decodes a serialized `GetElementResponse` in `buffer` into `result`. The
+// contents of memcpy-able tensors are read directly into the tensors.
+Status DecodeGetElementResult(::grpc::ByteBuffer* buffer,
+                              GetElementResult& result);
+
+// Encodes `results` into `buffer` as a serialized `GetElementsResponse`, each
+// like `EncodeGetElementResult` does.
+Status EncodeGetElementResults(const std::vector<GetElementResult>& results,
+                               ::grpc::ByteBuffer* buffer);
+
+// Decodes a serialized `GetElementsResponse` in `buffer` into `results`.
+Status DecodeGetElementResults(::grpc::ByteBuffer* buffer,
+                               std::vector<GetElementResult>& results);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_GRPC_ELEMENT_CODING_H_
@@ -0,0 +1,235 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/grpc_element_coding.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/slice.h"
+#include "tensorflow/core/data/compression_utils.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string ToString(const ::grpc::ByteBuffer& buffer) {
+  std::vector<::grpc::Slice> slices;
+  EXPECT_TRUE(buffer.Dump(&slices).ok());
+  std::string result;
+  for (const ::grpc::Slice& slice : slices) {
+    result.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+  }
+  return result;
+}
+
+::grpc::ByteBuffer FromString(const std::string& bytes) {
+  ::grpc::Slice slice(bytes.data(), bytes.size());
+  return ::grpc::ByteBuffer(&slice, 1);
+}
+
+GetElementResult RoundTrip(const GetElementResult& result) {
+  ::grpc::ByteBuffer buffer;
+  TF_EXPECT_OK(EncodeGetElementResult(result, &buffer));
+  GetElementResult decoded;
+  TF_EXPECT_OK(DecodeGetElementResult(&buffer, decoded));
+  return decoded;
+}
+
+GetElementResult MakeResult(std::vector<Tensor> components) {
+  GetElementResult result;
+  result.components = std::move(components);
+  result.element_index = 7;
+  return result;
+}
+
+void ExpectEqualResults(const GetElementResult& actual,
+                        const GetElementResult& expected) {
+  EXPECT_EQ(actual.element_index, expected.element_index);
+  EXPECT_EQ(actual.end_of_sequence, expected.end_of_sequence);
+  EXPECT_EQ(actual.skip, expected.skip);
+  ASSERT_EQ(actual.components.size(), expected.components.size());
+  for (int i = 0; i < actual.components.size(); ++i) {
+    test::ExpectEqual(actual.components[i], expected.components[i]);
+  }
+}
+
+TEST(GrpcElementCodingTest, MemcpyableTensors) {
+  GetElementResult result = MakeResult(
+      {test::AsTensor<float>(std::vector<float>(1000, 1.5), {10, 100}),
+       test::AsScalar<int64_t>(3), test::AsTensor<int32>({}, {0, 2})});
+  ExpectEqualResults(RoundTrip(result), result);
+}
+
+TEST(GrpcElementCodingTest, StringTensors) {
+  GetElementResult result =
+      MakeResult({test::AsTensor<tstring>({"a", "b", "c"}, {3}),
+                  test::AsTensor<float>(std::vector<float>(1000, 2.0))});
+  ExpectEqualResults(RoundTrip(result), result);
+}
+
+TEST(GrpcElementCodingTest, CompressedElement) {
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(
+      {test::AsTensor<int64_t>(std::vector<int64_t>(500, 4))}, &compressed));
+  Tensor tensor(DT_VARIANT, TensorShape{});
+  tensor.scalar<Variant>()() = compressed;
+  GetElementResult result = MakeResult({tensor});
+
+  GetElementResult decoded = RoundTrip(result);
+  ASSERT_EQ(decoded.components.size(), 1);
+  const CompressedElement* decoded_compressed =
+      decoded.components[0].scalar<Variant>()().get<CompressedElement>();
+  ASSERT_NE(decoded_compressed, nullptr);
+  EXPECT_EQ(decoded_compressed->SerializeAsString(),
+            compressed.SerializeAsString());
+}
+
+TEST(GrpcElementCodingTest, EndOfSequence) {
+  GetElementResult result;
+  result.end_of_sequence = true;
+  ExpectEqualResults(RoundTrip(result), result);
+}
+
+TEST(GrpcElementCodingTest, SkippedRound) {
+  GetElementResult result;
+  result.skip = true;
+  ExpectEqualResults(RoundTrip(result), result);
+}
+
+TEST(GrpcElementCodingTest, EncodesGetElementResponse) {
+  Tensor large = test::AsTensor<double>(std::vector<double>(1000, 0.5));
+  Tensor small = test::AsTensor<int32>({1, 2, 3});
+  Tensor strings = test::AsTensor<tstring>({"x", "y"});
+  GetElementResult result = MakeResult({large, small, strings});
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeGetElementResult(result, &buffer));
+
+  GetElementResponse response;
+  ASSERT_TRUE(response.ParseFromString(ToString(buffer)));
+  EXPECT_EQ(response.element_index(), 7);
+  ASSERT_EQ(response.uncompressed().components_size(), 3);
+  Tensor parsed;
+  ASSERT_TRUE(parsed.FromProto(response.uncompressed().components(0)));
+  test::ExpectEqual(parsed, large);
+  ASSERT_TRUE(parsed.FromProto(response.uncompressed().components(1)));
+  test::ExpectEqual(parsed, small);
+  ASSERT_TRUE(parsed.FromProto(response.uncompressed().components(2)));
+  test::ExpectEqual(parsed, strings);
+}
+
+TEST(GrpcElementCodingTest, DecodesGetElementResponse) {
+  Tensor tensor = test::AsTensor<float>({1.0, 2.0, 3.0}, {3});
+  GetElementResponse response;
+  response.set_element_index(5);
+  response.set_skip_task(true);
+  tensor.AsProtoField(response.mutable_uncompressed()->add_components());
+  ::grpc::ByteBuffer buffer = FromString(response.SerializeAsString());
+
+  GetElementResult result;
+  TF_ASSERT_OK(DecodeGetElementResult(&buffer, result));
+  EXPECT_EQ(result.element_index, 5);
+  EXPECT_TRUE(result.skip);
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectEqual(result.components[0], tensor);
+}
+
+TEST(GrpcElementCodingTest, DecodeInvalidResponse) {
+  ::grpc::ByteBuffer buffer = FromString("not a GetElementResponse");
+  GetElementResult result;
+  EXPECT_FALSE(DecodeGetElementResult(&buffer, result).ok());
+}
+
+TEST(GrpcElementCodingTest, UnexpectedVariant) {
+  Tensor tensor(DT_VARIANT, TensorShape{});
+  tensor.scalar<Variant>()() = 10;
+  ::grpc::ByteBuffer buffer;
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      EncodeGetElementResult(MakeResult({tensor}), &buffer)));
+}
+
+TEST(GrpcElementCodingTest, MultipleResults) {
+  std::vector<GetElementResult> results;
+  results.push_back(MakeResult(
+      {test::AsTensor<float>(std::vector<float>(1000, 1.5), {10, 100})}));
+  results.push_back(MakeResult({test::AsTensor<tstring>({"a", "b"}, {2}),
+                                test::AsScalar<int64_t>(8)}));
+  results.emplace_back();
+  results.back().end_of_sequence = true;
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeGetElementResults(results, &buffer));
+
+  std::vector<GetElementResult> decoded;
+  TF_ASSERT_OK(DecodeGetElementResults(&buffer, decoded));
+  ASSERT_EQ(decoded.size(), results.size());
+  for (int i = 0; i < results.size(); ++i) {
+    ExpectEqualResults(decoded[i], results[i]);
+  }
+}
+
+TEST(GrpcElementCodingTest, EncodesGetElementsResponse) {
+  Tensor tensor = test::AsTensor<double>(std::vector<double>(1000, 0.5));
+  std::vector<GetElementResult> results;
+  results.push_back(MakeResult({tensor}));
+  results.push_back(MakeResult({tensor}));
+  ::grpc::ByteBuffer buffer;
+  TF_ASSERT_OK(EncodeGetElementResults(results, &buffer));
+
+  GetElementsResponse response;
+  ASSERT_TRUE(response.ParseFromString(ToString(buffer)));
+  ASSERT_EQ(response.elements_size(), 2);
+  for (const GetElementResponse& element : response.elements()) {
+    EXPECT_EQ(element.element_index(), 7);
+    ASSERT_EQ(element.uncompressed().components_size(), 1);
+    Tensor parsed;
+    ASSERT_TRUE(parsed.FromProto(element.uncompressed().components(0)));
+    test::ExpectEqual(parsed, tensor);
+  }
+}
+
+TEST(GrpcElementCodingTest, DecodesGetElementsResponse) {
+  Tensor tensor = test::AsTensor<float>({1.0, 2.0, 3.0}, {3});
+  GetElementsResponse response;
+  GetElementResponse* element = response.add_elements();
+  element->set_element_index(5);
+  tensor.AsProtoField(element->mutable_uncompressed()->add_components());
+  response.add_elements()->set_skip_task(true);
+  ::grpc::ByteBuffer buffer = FromString(response.SerializeAsString());
+
+  std::vector<GetElementResult> results;
+  TF_ASSERT_OK(DecodeGetElementResults(&buffer, results));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].element_index, 5);
+  ASSERT_EQ(results[0].components.size(), 1);
+  test::ExpectEqual(results[0].components[0], tensor);
+  EXPECT_TRUE(results[1].skip);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
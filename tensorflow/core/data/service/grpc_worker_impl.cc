@@ -15,13 +15,19 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/grpc_worker_impl.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "grpcpp/impl/codegen/method_handler.h"
+#include "grpcpp/impl/codegen/rpc_service_method.h"
 #include "grpcpp/server_builder.h"
 #include "grpcpp/server_context.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/export.pb.h"
+#include "tensorflow/core/data/service/grpc_element_coding.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/platform/errors.h"
@@ -37,6 +43,16 @@ using ::grpc::ServerContext;
 GrpcWorkerImpl::GrpcWorkerImpl(const experimental::WorkerConfig& config,
                                ServerBuilder& server_builder)
     : impl_(std::make_shared<DataServiceWorkerImpl>(config)) {
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      kGetElementRawMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+      new ::grpc::internal::RpcMethodHandler<GrpcWorkerImpl, GetElementRequest,
+                                             ::grpc::ByteBuffer>(
+          std::mem_fn(&GrpcWorkerImpl::GetElementRaw), this)));
+  AddMethod(new ::grpc::internal::RpcServiceMethod(
+      kGetElementsRawMethod, ::grpc::internal::RpcMethod::NORMAL_RPC,
+      new ::grpc::internal::RpcMethodHandler<GrpcWorkerImpl, GetElementRequest,
+                                             ::grpc::ByteBuffer>(
+          std::mem_fn(&GrpcWorkerImpl::GetElementsRaw), this)));
   server_builder.RegisterService(this);
   VLOG(1) << "Registered data service worker";
 }
@@ -71,5 +87,27 @@ HANDLER(GetWorkerTasks);
 HANDLER(GetSnapshotTaskProgresses);
 #undef HANDLER
 
+::grpc::Status GrpcWorkerImpl::GetElementRaw(ServerContext* context,
+                                             const GetElementRequest* request,
+                                             ::grpc::ByteBuffer* response) {
+  GetElementResult result;
+  Status s = impl_->GetElementResult(request, &result);
+  if (!s.ok()) {
+    return ToGrpcStatus(s);
+  }
+  return ToGrpcStatus(EncodeGetElementResult(result, response));
+}
+
+::grpc::Status GrpcWorkerImpl::GetElementsRaw(ServerContext* context,
+                                              const GetElementRequest* request,
+                                              ::grpc::ByteBuffer* response) {
+  std::vector<GetElementResult> results;
+  Status s = impl_->GetElementResults(request, &results);
+  if (!s.ok()) {
+    return ToGrpcStatus(s);
+  }
+  return ToGrpcStatus(EncodeGetElementResults(results, response));
+}
+
 }  // namespace data
 }  // namespace tensorflow
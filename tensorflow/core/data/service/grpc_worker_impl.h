@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "grpcpp/server_builder.h"
+#include "grpcpp/support/byte_buffer.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -64,6 +65,18 @@ class GrpcWorkerImpl : public WorkerService::Service {
   HANDLER(GetSnapshotTaskProgresses);
 #undef HANDLER
 
+  // Serves `kGetElementRawMethod`, which returns the same response as
+  // `GetElement` without copying the element's tensors into a proto.
+  ::grpc::Status GetElementRaw(::grpc::ServerContext* context,
+                               const GetElementRequest* request,
+                               ::grpc::ByteBuffer* response);
+
+  // Serves `kGetElementsRawMethod`, which returns up to
+  // `request->max_elements()` elements encoded like `GetElementRaw` does.
+  ::grpc::Status GetElementsRaw(::grpc::ServerContext* context,
+                                const GetElementRequest* request,
+                                ::grpc::ByteBuffer* response);
+
  private:
   std::string worker_address_;
   // A std::shared_ptr allows clients to access local servers and directly call
@@ -22,6 +22,8 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/record_writer.h"
@@ -35,6 +37,8 @@ namespace data {
 
 namespace {
 constexpr StringPiece kJournal = "journal";
+constexpr StringPiece kCheckpoint = "checkpoint";
+constexpr StringPiece kTempFileSuffix = ".tmp";
 
 Status ParseSequenceNumber(const std::string& journal_file,
                            int64_t* sequence_number) {
@@ -44,6 +48,21 @@ Status ParseSequenceNumber(const std::string& journal_file,
   }
   return OkStatus();
 }
+
+// Returns the sequence number of the latest checkpoint in `journal_files`, or
+// -1 if there is none.
+int64_t LatestCheckpoint(const std::vector<std::string>& journal_files) {
+  int64_t latest_checkpoint = -1;
+  for (const auto& file : journal_files) {
+    int64_t sequence_number;
+    if (absl::StartsWith(file, kCheckpoint) &&
+        !absl::EndsWith(file, kTempFileSuffix) &&
+        ParseSequenceNumber(file, &sequence_number).ok()) {
+      latest_checkpoint = std::max(latest_checkpoint, sequence_number);
+    }
+  }
+  return latest_checkpoint;
+}
 }  // namespace
 
 std::string DataServiceJournalFile(const std::string& journal_dir,
@@ -52,6 +71,12 @@ std::string DataServiceJournalFile(const std::string& journal_dir,
                       absl::StrCat(kJournal, "_", sequence_number));
 }
 
+std::string DataServiceJournalCheckpointFile(const std::string& journal_dir,
+                                             int64_t sequence_number) {
+  return io::JoinPath(journal_dir,
+                      absl::StrCat(kCheckpoint, "_", sequence_number));
+}
+
 FileJournalWriter::FileJournalWriter(Env* env, const std::string& journal_dir)
     : env_(env), journal_dir_(journal_dir) {}
 
@@ -64,18 +89,96 @@ Status FileJournalWriter::EnsureInitialized() {
   TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
   int64_t latest_sequence_number = -1;
   for (const auto& file : journal_files) {
+    if (absl::EndsWith(file, kTempFileSuffix)) {
+      // Left behind by a failed compaction.
+      continue;
+    }
     int64_t sequence_number;
     TF_RETURN_IF_ERROR(ParseSequenceNumber(file, &sequence_number));
+    if (absl::StartsWith(file, kCheckpoint)) {
+      // The checkpoint precedes the journal file with the same number.
+      sequence_number--;
+    }
     latest_sequence_number = std::max(latest_sequence_number, sequence_number);
   }
+  return OpenJournalFile(latest_sequence_number + 1);
+}
+
+Status FileJournalWriter::OpenJournalFile(int64_t sequence_number) {
   std::string journal_file =
-      DataServiceJournalFile(journal_dir_, latest_sequence_number + 1);
+      DataServiceJournalFile(journal_dir_, sequence_number);
   TF_RETURN_IF_ERROR(env_->NewAppendableFile(journal_file, &file_));
   writer_ = std::make_unique<io::RecordWriter>(file_.get());
+  sequence_number_ = sequence_number;
   VLOG(1) << "Created journal writer to write to " << journal_file;
   return OkStatus();
 }
 
+Status FileJournalWriter::Compact(const std::vector<Update>& updates) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  // Every update in the current journal file has been synced, so it can be
+  // closed before the checkpoint is written. If compaction fails, the next
+  // write reinitializes the writer and continues the uncompacted journal.
+  const int64_t checkpoint_sequence_number = sequence_number_ + 1;
+  TF_RETURN_IF_ERROR(writer_->Close());
+  writer_.reset();
+  TF_RETURN_IF_ERROR(file_->Close());
+  file_.reset();
+
+  std::string checkpoint_file = DataServiceJournalCheckpointFile(
+      journal_dir_, checkpoint_sequence_number);
+  std::string temp_file = absl::StrCat(checkpoint_file, kTempFileSuffix);
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(temp_file, &file));
+    io::RecordWriter writer(file.get());
+    for (const Update& update : updates) {
+      std::string s = update.SerializeAsString();
+      if (s.empty()) {
+        return errors::Internal("Failed to serialize update ",
+                                update.DebugString(), " to string");
+      }
+      TF_RETURN_IF_ERROR(writer.WriteRecord(s));
+    }
+    TF_RETURN_IF_ERROR(writer.Close());
+    TF_RETURN_IF_ERROR(file->Sync());
+    TF_RETURN_IF_ERROR(file->Close());
+  }
+  TF_RETURN_IF_ERROR(env_->RenameFile(temp_file, checkpoint_file));
+  VLOG(1) << "Compacted journal into " << updates.size() << " updates in "
+          << checkpoint_file;
+
+  TF_RETURN_IF_ERROR(OpenJournalFile(checkpoint_sequence_number));
+  DeleteFilesBefore(checkpoint_sequence_number);
+  return OkStatus();
+}
+
+void FileJournalWriter::DeleteFilesBefore(int64_t sequence_number) {
+  std::vector<std::string> journal_files;
+  Status s = env_->GetChildren(journal_dir_, &journal_files);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to list journal directory " << journal_dir_
+                 << " to delete compacted journal files: " << s;
+    return;
+  }
+  for (const auto& file : journal_files) {
+    int64_t file_sequence_number;
+    if (absl::EndsWith(file, kTempFileSuffix) ||
+        !ParseSequenceNumber(file, &file_sequence_number).ok() ||
+        file_sequence_number >= sequence_number) {
+      continue;
+    }
+    // Readers start from the latest checkpoint, so files that fail to be
+    // deleted are ignored, and deleted by the next compaction.
+    std::string path = io::JoinPath(journal_dir_, file);
+    s = env_->DeleteFile(path);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete compacted journal file " << path
+                   << ": " << s;
+    }
+  }
+}
+
 Status FileJournalWriter::Write(const Update& update) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
   std::string s = update.SerializeAsString();
@@ -99,7 +202,16 @@ Status FileJournalReader::EnsureInitialized() {
   if (reader_) {
     return OkStatus();
   }
-  return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  std::vector<std::string> journal_files;
+  TF_RETURN_IF_ERROR(env_->GetChildren(journal_dir_, &journal_files));
+  int64_t latest_checkpoint = LatestCheckpoint(journal_files);
+  if (latest_checkpoint < 0) {
+    return UpdateFile(DataServiceJournalFile(journal_dir_, 0));
+  }
+  sequence_number_ = latest_checkpoint;
+  reading_checkpoint_ = true;
+  return UpdateFile(
+      DataServiceJournalCheckpointFile(journal_dir_, latest_checkpoint));
 }
 
 Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
@@ -108,7 +220,12 @@ Status FileJournalReader::Read(Update& update, bool& end_of_journal) {
     tstring record;
     Status s = reader_->ReadRecord(&record);
     if (absl::IsOutOfRange(s)) {
-      sequence_number_++;
+      // A checkpoint is followed by the journal file with the same number.
+      if (reading_checkpoint_) {
+        reading_checkpoint_ = false;
+      } else {
+        sequence_number_++;
+      }
       std::string next_journal_file =
           DataServiceJournalFile(journal_dir_, sequence_number_);
       if (absl::IsNotFound(env_->FileExists(next_journal_file))) {
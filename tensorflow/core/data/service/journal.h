@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -31,6 +32,11 @@ namespace data {
 std::string DataServiceJournalFile(const std::string& journal_dir,
                                    int64_t sequence_number);
 
+// Returns the location of the checkpoint that precedes the journal file with
+// `sequence_number` within the journal directory.
+std::string DataServiceJournalCheckpointFile(const std::string& journal_dir,
+                                             int64_t sequence_number);
+
 // Interface for writing to a journal.
 class JournalWriter {
  public:
@@ -39,6 +45,9 @@ class JournalWriter {
   virtual Status Write(const Update& update) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
+  // Replaces the journal written so far with `updates`, which must recreate
+  // the state recorded by the journal. Later writes are appended after them.
+  virtual Status Compact(const std::vector<Update>& updates) = 0;
 };
 
 // FileJournalWriter is not thread-safe, requiring external synchronization when
@@ -57,6 +66,11 @@ class JournalWriter {
 // "journal_0", "journal_1", and "journal_2", the writer will write to
 // "journal_3". The writer will flush updates as they are written, so that they
 // can be stored durably in case of machine failure.
+//
+// Compacting the journal writes the given updates to a checkpoint file, e.g.
+// "checkpoint_4", continues the journal in "journal_4", and deletes the older
+// journal and checkpoint files. The checkpoint is renamed into place once it is
+// complete, so the journal stays readable if the writer fails at any point.
 class FileJournalWriter : public JournalWriter {
  public:
   // Creates a journal writer to write to the given journal directory.
@@ -68,10 +82,19 @@ class FileJournalWriter : public JournalWriter {
 
   Status Write(const Update& update) override;
   Status EnsureInitialized() override;
+  Status Compact(const std::vector<Update>& updates) override;
 
  private:
+  // Starts writing to the journal file with `sequence_number`.
+  Status OpenJournalFile(int64_t sequence_number);
+  // Deletes the journal and checkpoint files that precede the checkpoint with
+  // `sequence_number`.
+  void DeleteFilesBefore(int64_t sequence_number);
+
   Env* env_;
   const std::string journal_dir_;
+  // Sequence number of current journal file.
+  int64_t sequence_number_ = -1;
   std::unique_ptr<WritableFile> file_;
   std::unique_ptr<io::RecordWriter> writer_;
 };
@@ -89,7 +112,9 @@ class JournalReader {
 // used by multiple threads.
 //
 // The journal reader reads through all journal files in the configured journal
-// directory, in order of their sequence numbers. See FileJournalWriter above.
+// directory, in order of their sequence numbers. If the journal was compacted,
+// it starts from the latest checkpoint and the journal files that follow it.
+// See FileJournalWriter above.
 class FileJournalReader : public JournalReader {
  public:
   explicit FileJournalReader(Env* env, StringPiece journal_dir);
@@ -108,6 +133,9 @@ class FileJournalReader : public JournalReader {
   const std::string journal_dir_;
   // Sequence number of current journal file.
   int64_t sequence_number_ = 0;
+  // Whether the reader is reading the checkpoint that precedes journal file
+  // `sequence_number_`.
+  bool reading_checkpoint_ = false;
   std::unique_ptr<RandomAccessFile> file_;
   std::unique_ptr<io::SequentialRecordReader> reader_;
 };
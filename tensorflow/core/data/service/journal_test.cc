@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -33,6 +34,7 @@ namespace data {
 
 namespace {
 using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
 
 bool NewJournalDir(std::string& journal_dir) {
   std::string filename = testing::TmpDir();
@@ -165,5 +167,78 @@ TEST(Journal, InvalidRecordData) {
   EXPECT_THAT(s.message(), HasSubstr("Failed to parse journal record"));
   EXPECT_EQ(s.code(), error::DATA_LOSS);
 }
+
+TEST(Journal, Compact) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+  TF_ASSERT_OK(writer.Compact({MakeRegisterDatasetUpdate()}));
+  TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate()}));
+  std::vector<std::string> journal_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(journal_dir, &journal_files));
+  EXPECT_THAT(journal_files,
+              UnorderedElementsAre("checkpoint_1", "journal_1"));
+}
+
+TEST(Journal, CompactRepeatedly) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  FileJournalWriter writer(Env::Default(), journal_dir);
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+    TF_ASSERT_OK(
+        writer.Compact({MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate()}));
+  }
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeFinishTaskUpdate()}));
+  std::vector<std::string> journal_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(journal_dir, &journal_files));
+  EXPECT_THAT(journal_files,
+              UnorderedElementsAre("checkpoint_3", "journal_3"));
+}
+
+TEST(Journal, AppendCompactedJournal) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+    TF_ASSERT_OK(writer.Compact({MakeRegisterDatasetUpdate()}));
+  }
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  }
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeRegisterDatasetUpdate(), MakeCreateIterationUpdate()}));
+}
+
+TEST(Journal, IgnoreIncompleteCheckpoint) {
+  std::string journal_dir;
+  EXPECT_TRUE(NewJournalDir(journal_dir));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_ASSERT_OK(writer.Write(MakeFinishTaskUpdate()));
+  }
+  // A checkpoint that was not renamed into place before the writer failed.
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(),
+      absl::StrCat(DataServiceJournalCheckpointFile(journal_dir, 1), ".tmp"),
+      "incomplete checkpoint"));
+  {
+    FileJournalWriter writer(Env::Default(), journal_dir);
+    TF_ASSERT_OK(writer.Write(MakeCreateIterationUpdate()));
+  }
+
+  TF_EXPECT_OK(CheckJournalContent(
+      journal_dir, {MakeFinishTaskUpdate(), MakeCreateIterationUpdate()}));
+}
 }  // namespace data
 }  // namespace tensorflow
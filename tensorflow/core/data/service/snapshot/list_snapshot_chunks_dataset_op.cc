@@ -0,0 +1,210 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/tstring.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr const char* const kSnapshotPath = "snapshot_path";
+constexpr const char* const kOutputTypes = "output_types";
+constexpr const char* const kOutputShapes = "output_shapes";
+constexpr const char* const kListSnapshotChunksDataset =
+    "ListSnapshotChunksDataset";
+constexpr const char* const kNumChunksRead = "num_chunks_read";
+constexpr const char* const kChunkRead = "chunk_read";
+
+// Produces the paths of the committed chunks of a distributed snapshot. If the
+// snapshot is still being written, the iterator waits for new chunks until the
+// snapshot is finished, so that reading can overlap with writing.
+class ListSnapshotChunksDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ListSnapshotChunksDatasetOp(OpKernelConstruction* ctx);
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override;
+
+ private:
+  class Dataset;
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+class ListSnapshotChunksDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const tstring& snapshot_path,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        snapshot_path_(snapshot_path),
+        output_types_(output_types),
+        output_shapes_(output_shapes) {}
+
+  const DataTypeVector& output_dtypes() const override {
+    return output_types_;
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  std::string DebugString() const override {
+    return name_utils::DatasetDebugString(kListSnapshotChunksDataset);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return kUnknownCardinality;
+  }
+
+  absl::Status InputDatasets(
+      std::vector<const DatasetBase*>* inputs) const override {
+    return absl::OkStatus();
+  }
+
+  absl::Status CheckExternalState() const override { return absl::OkStatus(); }
+
+ protected:
+  absl::Status AsGraphDefInternal(SerializationContext* ctx,
+                                  DatasetGraphDefBuilder* b,
+                                  Node** output) const override {
+    Node* snapshot_path = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(snapshot_path_, &snapshot_path));
+    return b->AddDataset(this, /*inputs=*/{snapshot_path}, output);
+  }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const std::string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kListSnapshotChunksDataset, prefix)});
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params) {}
+
+    ~Iterator() override {
+      if (deregister_fn_) {
+        deregister_fn_();
+      }
+    }
+
+    absl::Status Initialize(IteratorContext* ctx) override {
+      chunk_provider_ = std::make_unique<SnapshotChunkProvider>(
+          dataset()->snapshot_path_, ctx->env());
+      return RegisterCancellationCallback(
+          ctx->cancellation_manager(), [this]() { chunk_provider_->Cancel(); },
+          &deregister_fn_);
+    }
+
+   protected:
+    absl::Status GetNextInternal(IteratorContext* ctx,
+                                 std::vector<Tensor>* out_tensors,
+                                 bool* end_of_sequence) override {
+      TF_ASSIGN_OR_RETURN(std::optional<std::string> chunk,
+                          chunk_provider_->GetNext());
+      *end_of_sequence = !chunk.has_value();
+      if (chunk.has_value()) {
+        out_tensors->push_back(Tensor(tstring(*chunk)));
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status SaveInternal(SerializationContext* ctx,
+                              IteratorStateWriter* writer) override {
+      std::vector<std::string> chunks_read = chunk_provider_->ChunksRead();
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          full_name(kNumChunksRead), static_cast<int64_t>(chunks_read.size())));
+      for (int64_t i = 0; i < chunks_read.size(); ++i) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            full_name(absl::StrCat(kChunkRead, "_", i)), chunks_read[i]));
+      }
+      return absl::OkStatus();
+    }
+
+    absl::Status RestoreInternal(IteratorContext* ctx,
+                                 IteratorStateReader* reader) override {
+      int64_t num_chunks_read = 0;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(full_name(kNumChunksRead), &num_chunks_read));
+      std::vector<std::string> chunks_read;
+      chunks_read.reserve(num_chunks_read);
+      for (int64_t i = 0; i < num_chunks_read; ++i) {
+        tstring chunk;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            full_name(absl::StrCat(kChunkRead, "_", i)), &chunk));
+        chunks_read.push_back(std::string(chunk));
+      }
+      chunk_provider_->RestoreChunksRead(chunks_read);
+      return absl::OkStatus();
+    }
+
+   private:
+    std::unique_ptr<SnapshotChunkProvider> chunk_provider_;
+    std::function<void()> deregister_fn_;
+  };
+
+  const tstring snapshot_path_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+};
+
+ListSnapshotChunksDatasetOp::ListSnapshotChunksDatasetOp(
+    OpKernelConstruction* ctx)
+    : DatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void ListSnapshotChunksDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                              DatasetBase** output) {
+  tstring snapshot_path;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kSnapshotPath, &snapshot_path));
+  OP_REQUIRES(ctx, !snapshot_path.empty(),
+              absl::InvalidArgumentError(
+                  "snapshot_path is required to list snapshot chunks."));
+  *output = new ListSnapshotChunksDatasetOp::Dataset(
+      ctx, snapshot_path, output_types_, output_shapes_);
+}
+
+REGISTER_KERNEL_BUILDER(Name(kListSnapshotChunksDataset).Device(DEVICE_CPU),
+                        ListSnapshotChunksDatasetOp);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,127 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+
+SnapshotChunkProvider::SnapshotChunkProvider(absl::string_view snapshot_path,
+                                             tsl::Env* env,
+                                             absl::Duration poll_interval)
+    : snapshot_path_(snapshot_path), env_(env), poll_interval_(poll_interval) {}
+
+absl::StatusOr<std::optional<std::string>> SnapshotChunkProvider::GetNext()
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  while (true) {
+    TF_RETURN_IF_ERROR(status_);
+    if (!chunks_unread_.empty()) {
+      std::string next_chunk = *chunks_unread_.begin();
+      chunks_read_.insert(next_chunk);
+      chunks_unread_.erase(chunks_unread_.begin());
+      return tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path_),
+                               next_chunk);
+    }
+    if (snapshot_done_) {
+      return std::nullopt;
+    }
+    TF_RETURN_IF_ERROR(UpdateSnapshot());
+    if (chunks_unread_.empty() && !snapshot_done_ && status_.ok()) {
+      cancelled_cv_.wait_for(l, absl::ToChronoMicroseconds(poll_interval_));
+    }
+  }
+}
+
+absl::Status SnapshotChunkProvider::UpdateSnapshot()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  // Checks the DONE file before listing the chunks, so that no chunk is
+  // committed after the listing of a finished snapshot.
+  const bool snapshot_done =
+      env_->FileExists(SnapshotDoneFilePath(snapshot_path_)).ok();
+  absl::Status error = GetSnapshotError();
+  if (!error.ok()) {
+    status_ = error;
+    return status_;
+  }
+
+  const std::string chunks_directory = CommittedChunksDirectory(snapshot_path_);
+  absl::StatusOr<std::vector<std::string>> chunks =
+      GetChildren(chunks_directory, env_);
+  if (absl::IsNotFound(chunks.status())) {
+    // No chunk has been committed yet.
+    chunks = std::vector<std::string>();
+  }
+  TF_RETURN_IF_ERROR(chunks.status());
+  for (std::string& chunk : *chunks) {
+    if (!chunks_read_.contains(chunk)) {
+      chunks_unread_.insert(std::move(chunk));
+    }
+  }
+  snapshot_done_ = snapshot_done;
+  return absl::OkStatus();
+}
+
+absl::Status SnapshotChunkProvider::GetSnapshotError() const {
+  const std::string error_file_path = SnapshotErrorFilePath(snapshot_path_);
+  if (!env_->FileExists(error_file_path).ok()) {
+    return absl::OkStatus();
+  }
+  std::string error;
+  TF_RETURN_IF_ERROR(tsl::ReadFileToString(env_, error_file_path, &error));
+  return absl::FailedPreconditionError(
+      absl::StrCat("Failed to read tf.data snapshot at ", snapshot_path_,
+                   ": The save job failed to write it. Status: ", error));
+}
+
+std::vector<std::string> SnapshotChunkProvider::ChunksRead() const
+    TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  return std::vector<std::string>(chunks_read_.begin(), chunks_read_.end());
+}
+
+void SnapshotChunkProvider::RestoreChunksRead(
+    const std::vector<std::string>& chunks_read) TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  chunks_read_ = absl::btree_set<std::string>(chunks_read.begin(),
+                                              chunks_read.end());
+  chunks_unread_.clear();
+  snapshot_done_ = false;
+}
+
+void SnapshotChunkProvider::Cancel() TF_LOCKS_EXCLUDED(mu_) {
+  tsl::mutex_lock l(mu_);
+  status_ = absl::CancelledError(absl::StrCat(
+      "Reading tf.data snapshot at ", snapshot_path_, " has been cancelled."));
+  cancelled_cv_.notify_all();
+}
+
+}  // namespace data
+}  // namespace tensorflow
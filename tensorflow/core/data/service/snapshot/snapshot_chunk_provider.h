@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_SNAPSHOT_CHUNK_PROVIDER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_SNAPSHOT_CHUNK_PROVIDER_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+constexpr absl::Duration kDefaultChunkPollInterval = absl::Seconds(5);
+
+// Provides the committed chunks of a distributed snapshot, so that a reader can
+// start reading the snapshot while it is still being written. `GetNext` returns
+// each committed chunk once. When it has returned every committed chunk of an
+// unfinished snapshot, it waits for the writers to commit more chunks.
+//
+// This class is thread-safe.
+class SnapshotChunkProvider {
+ public:
+  SnapshotChunkProvider(
+      absl::string_view snapshot_path, tsl::Env* env,
+      absl::Duration poll_interval = kDefaultChunkPollInterval);
+  SnapshotChunkProvider(const SnapshotChunkProvider&) = delete;
+  SnapshotChunkProvider& operator=(const SnapshotChunkProvider&) = delete;
+
+  // Returns the absolute path of the next chunk. Returns nullopt once the
+  // snapshot is finished and all its chunks have been returned. Returns an
+  // error if the snapshot has failed or the provider has been cancelled.
+  absl::StatusOr<std::optional<std::string>> GetNext();
+
+  // Returns the file names of the chunks returned by `GetNext`, so that a
+  // reader can checkpoint its progress.
+  std::vector<std::string> ChunksRead() const;
+
+  // Restores the chunks returned by `GetNext` from `ChunksRead`. The restored
+  // chunks will not be returned again.
+  void RestoreChunksRead(const std::vector<std::string>& chunks_read);
+
+  // Cancels the provider. A blocked `GetNext` returns a Cancelled error.
+  void Cancel();
+
+ private:
+  // Lists the committed chunks and checks if the snapshot is finished.
+  absl::Status UpdateSnapshot() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Reads the ERROR file of the snapshot, if any.
+  absl::Status GetSnapshotError() const;
+
+  const std::string snapshot_path_;
+  tsl::Env* const env_;
+  const absl::Duration poll_interval_;
+
+  mutable tsl::mutex mu_;
+  tsl::condition_variable cancelled_cv_;
+
+  // The chunks that have been returned, or are yet to be returned.
+  absl::btree_set<std::string> chunks_read_ TF_GUARDED_BY(mu_);
+  absl::btree_set<std::string> chunks_unread_ TF_GUARDED_BY(mu_);
+
+  // True once the snapshot is finished and all of its chunks are listed.
+  bool snapshot_done_ TF_GUARDED_BY(mu_) = false;
+
+  // The error of a failed snapshot, or Cancelled if the provider is cancelled.
+  absl::Status status_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SNAPSHOT_SNAPSHOT_CHUNK_PROVIDER_H_
@@ -0,0 +1,163 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/snapshot/snapshot_chunk_provider.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
+#include "tensorflow/core/data/service/snapshot/path_utils.h"
+#include "tensorflow/core/data/service/test_util.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/status_matchers.h"
+#include "tsl/platform/test.h"
+#include "tsl/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+using testing::LocalTempFilename;
+using ::tsl::testing::IsOkAndHolds;
+using ::tsl::testing::StatusIs;
+
+constexpr absl::Duration kPollInterval = absl::Milliseconds(1);
+
+absl::Status CommitChunk(const std::string& snapshot_path,
+                         const std::string& chunk) {
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(
+      CommittedChunksDirectory(snapshot_path)));
+  return AtomicallyWriteStringToFile(
+      tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path), chunk),
+      chunk, tsl::Env::Default());
+}
+
+absl::Status FinishSnapshot(const std::string& snapshot_path) {
+  TF_RETURN_IF_ERROR(tsl::Env::Default()->RecursivelyCreateDir(snapshot_path));
+  return AtomicallyWriteStringToFile(SnapshotDoneFilePath(snapshot_path), "",
+                                     tsl::Env::Default());
+}
+
+std::string ChunkPath(const std::string& snapshot_path,
+                      const std::string& chunk) {
+  return tsl::io::JoinPath(CommittedChunksDirectory(snapshot_path), chunk);
+}
+
+TEST(SnapshotChunkProviderTest, FinishedSnapshot) {
+  std::string snapshot_path = LocalTempFilename();
+  TF_ASSERT_OK(CommitChunk(snapshot_path, "chunk_0_0_1"));
+  TF_ASSERT_OK(CommitChunk(snapshot_path, "chunk_1_0_1"));
+  TF_ASSERT_OK(FinishSnapshot(snapshot_path));
+
+  SnapshotChunkProvider provider(snapshot_path, tsl::Env::Default(),
+                                 kPollInterval);
+  EXPECT_THAT(provider.GetNext(),
+              IsOkAndHolds(Optional(ChunkPath(snapshot_path, "chunk_0_0_1"))));
+  EXPECT_THAT(provider.GetNext(),
+              IsOkAndHolds(Optional(ChunkPath(snapshot_path, "chunk_1_0_1"))));
+  EXPECT_THAT(provider.GetNext(), IsOkAndHolds(std::nullopt));
+  EXPECT_THAT(provider.GetNext(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(SnapshotChunkProviderTest, EmptySnapshot) {
+  std::string snapshot_path = LocalTempFilename();
+  TF_ASSERT_OK(FinishSnapshot(snapshot_path));
+  SnapshotChunkProvider provider(snapshot_path, tsl::Env::Default(),
+                                 kPollInterval);
+  EXPECT_THAT(provider.GetNext(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(SnapshotChunkProviderTest, SnapshotInProgress) {
+  std::string snapshot_path = LocalTempFilename();
+  TF_ASSERT_OK(CommitChunk(snapshot_path, "chunk_0_0_1"));
+
+  SnapshotChunkProvider provider(snapshot_path, tsl::Env::Default(),
+                                 kPollInterval);
+  EXPECT_THAT(provider.GetNext(),
+              IsOkAndHolds(Optional(ChunkPath(snapshot_path, "chunk_0_0_1"))));
+
+  // Commits the next chunk while the provider waits for it.
+  std::unique_ptr<tsl::Thread> writer(tsl::Env::Default()->StartThread(
+      /*thread_options=*/{}, /*name=*/"writer", [&snapshot_path]() {
+        tsl::Env::Default()->SleepForMicroseconds(10000);
+        TF_CHECK_OK(CommitChunk(snapshot_path, "chunk_0_1_1"));
+        TF_CHECK_OK(FinishSnapshot(snapshot_path));
+      }));
+  EXPECT_THAT(provider.GetNext(),
+              IsOkAndHolds(Optional(ChunkPath(snapshot_path, "chunk_0_1_1"))));
+  EXPECT_THAT(provider.GetNext(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(SnapshotChunkProviderTest, RestoreChunksRead) {
+  std::string snapshot_path = LocalTempFilename();
+  TF_ASSERT_OK(CommitChunk(snapshot_path, "chunk_0_0_1"));
+  TF_ASSERT_OK(CommitChunk(snapshot_path, "chunk_0_1_1"));
+  TF_ASSERT_OK(FinishSnapshot(snapshot_path));
+
+  SnapshotChunkProvider provider(snapshot_path, tsl::Env::Default(),
+                                 kPollInterval);
+  EXPECT_THAT(provider.GetNext(),
+              IsOkAndHolds(Optional(ChunkPath(snapshot_path, "chunk_0_0_1"))));
+  EXPECT_THAT(provider.ChunksRead(), ElementsAre("chunk_0_0_1"));
+
+  SnapshotChunkProvider restored_provider(snapshot_path, tsl::Env::Default(),
+                                          kPollInterval);
+  restored_provider.RestoreChunksRead(provider.ChunksRead());
+  EXPECT_THAT(restored_provider.GetNext(),
+              IsOkAndHolds(Optional(ChunkPath(snapshot_path, "chunk_0_1_1"))));
+  EXPECT_THAT(restored_provider.GetNext(), IsOkAndHolds(std::nullopt));
+}
+
+TEST(SnapshotChunkProviderTest, SnapshotError) {
+  std::string snapshot_path = LocalTempFilename();
+  TF_ASSERT_OK(CommitChunk(snapshot_path, "chunk_0_0_1"));
+  TF_ASSERT_OK(AtomicallyWriteStringToFile(SnapshotErrorFilePath(snapshot_path),
+                                           "Test error", tsl::Env::Default()));
+
+  SnapshotChunkProvider provider(snapshot_path, tsl::Env::Default(),
+                                 kPollInterval);
+  EXPECT_THAT(provider.GetNext(),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("Test error")));
+}
+
+TEST(SnapshotChunkProviderTest, Cancel) {
+  std::string snapshot_path = LocalTempFilename();
+  SnapshotChunkProvider provider(snapshot_path, tsl::Env::Default(),
+                                 /*poll_interval=*/absl::Hours(1));
+  std::unique_ptr<tsl::Thread> reader(tsl::Env::Default()->StartThread(
+      /*thread_options=*/{}, /*name=*/"reader", [&provider]() {
+        EXPECT_THAT(provider.GetNext(),
+                    StatusIs(absl::StatusCode::kCancelled));
+      }));
+  tsl::Env::Default()->SleepForMicroseconds(10000);
+  provider.Cancel();
+  reader.reset();
+  EXPECT_THAT(provider.GetNext(), StatusIs(absl::StatusCode::kCancelled));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -73,11 +73,26 @@ SnapshotStreamWriter::SnapshotStreamWriter(
     : params_(params), iterator_(std::move(iterator)) {
   DCHECK_NE(iterator_.get(), nullptr);
   last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
+  if (params_.max_pending_commits > 0) {
+    commit_thread_ = absl::WrapUnique(params_.env->StartThread(
+        /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_commit",
+        [this]() { CommitLoop(); }));
+  }
   snapshot_thread_ = absl::WrapUnique(params_.env->StartThread(
       /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_thread",
       [this]() { WriteSnapshotAndLog(); }));
 }
 
+SnapshotStreamWriter::~SnapshotStreamWriter() {
+  snapshot_thread_.reset();
+  {
+    mutex_lock l(mu_);
+    stop_committing_ = true;
+    commit_cv_.notify_all();
+  }
+  commit_thread_.reset();
+}
+
 void SnapshotStreamWriter::WriteSnapshotAndLog() TF_LOCKS_EXCLUDED(mu_) {
   if (StreamAlreadyCompleted()) {
     LOG(INFO) << "Distributed tf.data snapshot stream has already been "
@@ -94,6 +109,8 @@ void SnapshotStreamWriter::WriteSnapshotAndLog() TF_LOCKS_EXCLUDED(mu_) {
     LOG(INFO) << "tf.data service snapshot writer is cancelled: " << status;
     return;
   }
+  // The DONE file must not be written before all chunks are committed.
+  status.Update(WaitForPendingCommits());
   status = FinalizeStream(status);
   mutex_lock l(mu_);
   if (!status.ok()) {
@@ -181,37 +198,83 @@ absl::Status SnapshotStreamWriter::Commit() {
   // Writes the checkpoint before committing the chunks. If the worker fails in
   // between, the restarted worker will commit the uncommitted chunks.
   TF_RETURN_IF_ERROR(Save());
-  TF_ASSIGN_OR_RETURN(
-      std::vector<std::string> uncommitted_chunks,
-      GetChildren(params_.UncommittedChunksDirectory(), params_.env));
-  if (uncommitted_chunks.size() != chunk_file_to_num_elements_.size()) {
-    return absl::InternalError(absl::StrCat(
-        "Failed to write tf.data snapshot: Expected ",
-        chunk_file_to_num_elements_.size(), " uncommitted chunks, but got ",
-        uncommitted_chunks.size(), "."));
-  }
-  // Commits all chunks since the last commit.
-  for (int64_t i = 0; i < uncommitted_chunks.size(); ++i) {
-    const std::string& uncommitted_chunk = uncommitted_chunks[i];
+  CommitBatch batch;
+  batch.reserve(chunk_file_to_num_elements_.size());
+  for (const auto& [uncommitted_chunk, num_elements] :
+       chunk_file_to_num_elements_) {
     TF_ASSIGN_OR_RETURN(int64_t chunk_index,
                         GetUncommittedChunkIndex(uncommitted_chunk));
-    if (chunk_index <= chunk_index_) {
-      std::string uncommitted_chunk_path = tsl::io::JoinPath(
-          params_.UncommittedChunksDirectory(), uncommitted_chunk);
-      std::string committed_chunk_path = tsl::io::JoinPath(
-          params_.CommittedChunksDirectory(),
-          absl::StrCat("chunk_", params_.stream_index, "_", chunk_index, "_",
-                       chunk_file_to_num_elements_[uncommitted_chunk]));
-      TF_RETURN_IF_ERROR(params_.env->RenameFile(uncommitted_chunk_path,
-                                                 committed_chunk_path));
-    }
+    batch.push_back(
+        {tsl::io::JoinPath(params_.UncommittedChunksDirectory(),
+                           uncommitted_chunk),
+         tsl::io::JoinPath(params_.CommittedChunksDirectory(),
+                           absl::StrCat("chunk_", params_.stream_index, "_",
+                                        chunk_index, "_", num_elements))});
   }
   last_committed_chunk_ = chunk_index_;
   last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   chunk_file_to_num_elements_.clear();
+  if (params_.max_pending_commits <= 0) {
+    return RenameChunks(batch);
+  }
+
+  mutex_lock l(mu_);
+  while (commit_status_.ok() &&
+         static_cast<int64_t>(pending_commits_.size()) >=
+             params_.max_pending_commits) {
+    commit_cv_.wait(l);
+  }
+  TF_RETURN_IF_ERROR(commit_status_);
+  pending_commits_.push_back(std::move(batch));
+  commit_cv_.notify_all();
   return absl::OkStatus();
 }
 
+absl::Status SnapshotStreamWriter::RenameChunks(
+    const CommitBatch& batch) const {
+  tsl::profiler::TraceMe activity("SnapshotCommit",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  for (const auto& [uncommitted_chunk_path, committed_chunk_path] : batch) {
+    TF_RETURN_IF_ERROR(
+        params_.env->RenameFile(uncommitted_chunk_path, committed_chunk_path));
+  }
+  return absl::OkStatus();
+}
+
+void SnapshotStreamWriter::CommitLoop() TF_LOCKS_EXCLUDED(mu_) {
+  while (true) {
+    CommitBatch batch;
+    {
+      mutex_lock l(mu_);
+      while (pending_commits_.empty() && !stop_committing_) {
+        commit_cv_.wait(l);
+      }
+      if (pending_commits_.empty()) {
+        return;
+      }
+      batch = pending_commits_.front();
+    }
+    absl::Status status = RenameChunks(batch);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to commit distributed tf.data snapshot chunks for "
+                 << params_.DebugString() << ": " << status;
+    }
+    mutex_lock l(mu_);
+    pending_commits_.pop_front();
+    commit_status_.Update(status);
+    commit_cv_.notify_all();
+  }
+}
+
+absl::Status SnapshotStreamWriter::WaitForPendingCommits()
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  while (!pending_commits_.empty()) {
+    commit_cv_.wait(l);
+  }
+  return commit_status_;
+}
+
 bool SnapshotStreamWriter::ShouldWriteRecord() const TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   return chunk_size_bytes_ < params_.max_chunk_size_bytes &&
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -43,6 +44,7 @@ namespace data {
 
 constexpr int64_t kDefaultMaxChunkSizeBytes = 2 * (size_t{1} << 30);  // 2GB
 constexpr absl::Duration kDefaultCheckpointInterval = absl::Minutes(20);
+constexpr int64_t kDefaultMaxPendingCommits = 1;
 
 struct SnapshotWriterParams {
   // The directory path of the snapshot. See the comment on SnapshotStreamWriter
@@ -69,6 +71,12 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // The maximum number of commits that may run in the background while the
+  // writer produces the next chunks. A commit renames the chunk files into the
+  // committed chunks directory, which copies them on most object stores. If 0,
+  // the writer commits chunks synchronously.
+  int64_t max_pending_commits = kDefaultMaxPendingCommits;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -120,7 +128,7 @@ class SnapshotStreamWriter {
   // snapshot stream. Users can call `Wait` to wait for it to finish.
   explicit SnapshotStreamWriter(const SnapshotWriterParams& params,
                                 std::unique_ptr<TaskIterator> iterator);
-  virtual ~SnapshotStreamWriter() = default;
+  virtual ~SnapshotStreamWriter();
   SnapshotStreamWriter(const SnapshotStreamWriter&) = delete;
   SnapshotStreamWriter& operator=(const SnapshotStreamWriter&) = delete;
 
@@ -164,9 +172,25 @@ class SnapshotStreamWriter {
   // commit every ~20 minutes.
   bool ShouldCommit() const;
 
-  // Commits the chunks since the last commit.
+  // Commits the chunks since the last commit. Unless
+  // `params_.max_pending_commits` is 0, the chunk files are renamed by
+  // `commit_thread_` and this only waits for it if too many commits are
+  // pending.
   absl::Status Commit();
 
+  // The (uncommitted, committed) paths of the chunk files of one commit.
+  using CommitBatch = std::vector<std::pair<std::string, std::string>>;
+
+  // Renames the chunk files of `batch` to their committed paths.
+  absl::Status RenameChunks(const CommitBatch& batch) const;
+
+  // Runs on `commit_thread_`. Commits the batches in `pending_commits_` until
+  // the writer is destroyed.
+  void CommitLoop();
+
+  // Waits for the pending commits to finish. Returns the first commit error.
+  absl::Status WaitForPendingCommits();
+
   // Returns the path of the current chunk.
   std::string GetChunkFilePath() const;
   std::string GetCommittedChunkFilePath() const;
@@ -243,6 +267,17 @@ class SnapshotStreamWriter {
   // - If the snapshot has not finished, this is false.
   absl::StatusOr<bool> completed_ TF_GUARDED_BY(mu_) = false;
 
+  // Commits handed to `commit_thread_`, oldest first. A batch is popped after
+  // its chunk files are renamed.
+  std::deque<CommitBatch> pending_commits_ TF_GUARDED_BY(mu_);
+  // The first error from `commit_thread_`.
+  absl::Status commit_status_ TF_GUARDED_BY(mu_);
+  // Set when the writer is destroyed, after which `commit_thread_` finishes the
+  // pending commits and exits.
+  bool stop_committing_ TF_GUARDED_BY(mu_) = false;
+  condition_variable commit_cv_;
+
+  std::unique_ptr<Thread> commit_thread_;
   std::unique_ptr<Thread> snapshot_thread_;
 };
 
@@ -25,7 +25,9 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/data/service/common.pb.h"
+#include "tensorflow/core/data/service/snapshot/file_utils.h"
 #include "tensorflow/core/data/service/snapshot/path_utils.h"
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/test_util.h"
@@ -318,6 +320,41 @@ TEST(SnapshotStreamWriterTest, EmptyDataset) {
               IsOkAndHolds(IsEmpty()));
 }
 
+TEST(SnapshotStreamWriterTest, PendingCommits) {
+  for (int64_t max_pending_commits : {0, 1, 4}) {
+    int64_t range = 10;
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                            TestIterator(testing::RangeDataset(range)));
+
+    TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path,
+                            CreateSnapshotDirectory());
+    // Commits every chunk, so that the commits overlap with writing chunks.
+    SnapshotWriterParams writer_params;
+    writer_params.snapshot_path = snapshot_path;
+    writer_params.compression = tsl::io::compression::kSnappy;
+    writer_params.env = Env::Default();
+    writer_params.max_chunk_size_bytes = 1;
+    writer_params.checkpoint_interval = absl::ZeroDuration();
+    writer_params.max_pending_commits = max_pending_commits;
+    SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+    EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+    for (int i = 0; i < range; ++i) {
+      EXPECT_THAT(
+          ReadSnapshot<int64_t>(
+              tsl::io::JoinPath(writer_params.CommittedChunksDirectory(),
+                                absl::StrCat("chunk_0_", i, "_1")),
+              tsl::io::compression::kSnappy, /*num_elements=*/1),
+          IsOkAndHolds(ElementsAre(i)));
+    }
+    TF_ASSERT_OK_AND_ASSIGN(
+        std::vector<std::string> uncommitted_chunks,
+        GetChildren(writer_params.UncommittedChunksDirectory(),
+                    Env::Default()));
+    EXPECT_THAT(uncommitted_chunks, IsEmpty());
+  }
+}
+
 TEST(SnapshotStreamWriterTest, Cancel) {
   const int64_t range = 10000;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
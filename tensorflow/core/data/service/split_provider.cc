@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/data/service/split_provider.h"
 
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -41,6 +43,9 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
     dispatcher_ =
         std::make_unique<DataServiceDispatcherClient>(address_, protocol_);
   }
+  if (max_splits_per_request_ > 1) {
+    return GetNextBatched(split, end_of_splits);
+  }
   TF_RETURN_IF_ERROR(grpc_util::Retry(
       [this, split, end_of_splits]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         return dispatcher_->GetSplit(iteration_id_, repetition_,
@@ -50,20 +55,63 @@ Status DataServiceSplitProvider::GetNext(Tensor* split, bool* end_of_splits)
       "get next split",
       /*deadline_micros=*/Env::Default()->NowMicros() +
           (timeout_ms_ * EnvTime::kMillisToMicros)));
-  if (*end_of_splits) {
+  LogSplit(*split, *end_of_splits);
+  return OkStatus();
+}
+
+Status DataServiceSplitProvider::GetNextBatched(Tensor* split,
+                                                bool* end_of_splits)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (splits_.empty() && !end_of_splits_) {
+    std::vector<Tensor> splits;
+    bool end = false;
+    TF_RETURN_IF_ERROR(grpc_util::Retry(
+        [this, &splits, &end]() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          return dispatcher_->GetSplits(iteration_id_, repetition_,
+                                        split_provider_index_,
+                                        max_splits_per_request_, splits, end);
+        },
+        "get next splits",
+        /*deadline_micros=*/Env::Default()->NowMicros() +
+            (timeout_ms_ * EnvTime::kMillisToMicros)));
+    VLOG(2) << "Received " << splits.size() << " splits for iteration_id="
+            << iteration_id_ << ", repetition=" << repetition_;
+    splits_.insert(splits_.end(), std::make_move_iterator(splits.begin()),
+                   std::make_move_iterator(splits.end()));
+    end_of_splits_ = end;
+  }
+  if (splits_.empty()) {
+    *end_of_splits = true;
+    end_of_splits_ = false;
+  } else {
+    *end_of_splits = false;
+    *split = std::move(splits_.front());
+    splits_.pop_front();
+  }
+  LogSplit(*split, *end_of_splits);
+  return OkStatus();
+}
+
+void DataServiceSplitProvider::LogSplit(const Tensor& split,
+                                        bool end_of_splits) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (end_of_splits) {
     VLOG(1) << "Reached end of splits for iteration_id=" << iteration_id_
             << ", repetition=" << repetition_;
   } else {
-    VLOG(1) << "Requested split: " << split->DebugString()
+    VLOG(1) << "Requested split: " << split.DebugString()
             << "; with iteration_id=" << iteration_id_
             << ", repetition=" << repetition_;
   }
-  return OkStatus();
 }
 
 Status DataServiceSplitProvider::Reset() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   repetition_++;
+  // Buffered splits belong to the previous repetition, which the dispatcher
+  // ends as well when it sees the new one.
+  splits_.clear();
+  end_of_splits_ = false;
   return OkStatus();
 }
 
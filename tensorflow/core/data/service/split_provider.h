@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
 #include <functional>
+#include <deque>
 #include <memory>
 #include <string>
 #include <vector>
@@ -33,16 +34,21 @@ namespace tensorflow {
 namespace data {
 
 // SplitProvider which reads splits from a tf.data service dispatcher over RPC.
+//
+// If `max_splits_per_request` is greater than 1, it requests that many splits
+// at a time, and returns them from a local buffer.
 class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t timeout_ms,
+                           int64_t max_splits_per_request = 1)
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
-        timeout_ms_(timeout_ms) {}
+        timeout_ms_(timeout_ms),
+        max_splits_per_request_(max_splits_per_request) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
   Status Reset() override;
@@ -52,14 +58,26 @@ class DataServiceSplitProvider : public SplitProvider {
                  IteratorStateReader* reader) override;
 
  private:
+  // Returns the next split from `splits_`, requesting more splits from the
+  // dispatcher when it is empty.
+  Status GetNextBatched(Tensor* split, bool* end_of_splits)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void LogSplit(const Tensor& split, bool end_of_splits) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+
   const std::string address_;
   const std::string protocol_;
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
   const int64_t timeout_ms_;
+  const int64_t max_splits_per_request_;
 
   mutex mu_;
   int64_t repetition_ TF_GUARDED_BY(mu_) = 0;
+  // Splits received from the dispatcher but not returned yet.
+  std::deque<Tensor> splits_ TF_GUARDED_BY(mu_);
+  // Whether the dispatcher reached the end of splits after `splits_`.
+  bool end_of_splits_ TF_GUARDED_BY(mu_) = false;
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
 };
 
@@ -17,6 +17,7 @@ limitations under the License.
 #include <algorithm>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/dataset.pb.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -35,7 +37,9 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
@@ -47,6 +51,8 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheOverflowSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
 
 }  // namespace
 
@@ -99,8 +105,20 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    if (worker_config.cross_trainer_cache_overflow_directory().empty()) {
+      out = std::make_unique<CachingTaskRunner>(std::move(iterator),
+                                                max_cache_size_bytes);
+    } else {
+      const size_t max_overflow_size_bytes =
+          worker_config.cross_trainer_cache_overflow_size_bytes() > 0
+              ? worker_config.cross_trainer_cache_overflow_size_bytes()
+              : kDefaultCrossTrainerCacheOverflowSizeBytes;
+      out = std::make_unique<CachingTaskRunner>(
+          std::move(iterator), max_cache_size_bytes,
+          io::JoinPath(worker_config.cross_trainer_cache_overflow_directory(),
+                       strings::StrCat("task_", task_def.task_id())),
+          max_overflow_size_bytes);
+    }
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -183,6 +201,21 @@ CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
             << FormatBytes(max_cache_size_bytes) << " of memory.";
 }
 
+CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
+                                     size_t max_cache_size_bytes,
+                                     const std::string& overflow_directory,
+                                     size_t max_overflow_size_bytes)
+    : fcfs_task_runner_(std::move(iterator)),
+      cache_(max_cache_size_bytes,
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::make_unique<GetElementResultFileStorage>(overflow_directory),
+             max_overflow_size_bytes) {
+  LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
+            << FormatBytes(max_cache_size_bytes) << " of memory and "
+            << FormatBytes(max_overflow_size_bytes)
+            << " of overflow storage in " << overflow_directory << ".";
+}
+
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
 
 Status CachingTaskRunner::GetNext(const GetElementRequest& req,
@@ -214,6 +247,73 @@ size_t CachingTaskRunner::GetElementResultSequence::GetElementSizeBytes(
   return element.EstimatedMemoryUsageBytes();
 }
 
+CachingTaskRunner::GetElementResultFileStorage::GetElementResultFileStorage(
+    const std::string& directory)
+    : directory_(directory) {
+  // Deletes the elements left behind by a previous worker with the same task.
+  int64_t undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(directory_, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  Status s = Env::Default()->RecursivelyCreateDir(directory_);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to create the tf.data service cross-trainer cache "
+                 << "overflow directory " << directory_ << ": " << s;
+  }
+}
+
+CachingTaskRunner::GetElementResultFileStorage::~GetElementResultFileStorage() {
+  int64_t undeleted_files, undeleted_dirs;
+  Status s = Env::Default()->DeleteRecursively(directory_, &undeleted_files,
+                                               &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete the tf.data service cross-trainer cache "
+                 << "overflow directory " << directory_ << ": " << s;
+  }
+}
+
+Status CachingTaskRunner::GetElementResultFileStorage::Write(
+    size_t index, const GetElementResult& element) {
+  GetElementResponse response;
+  for (const Tensor& component : element.components) {
+    component.AsProtoTensorContent(
+        response.mutable_uncompressed()->add_components());
+  }
+  response.set_element_index(element.element_index);
+  response.set_end_of_sequence(element.end_of_sequence);
+  response.set_skip_task(element.skip);
+  return WriteBinaryProto(Env::Default(), ElementPath(index), response);
+}
+
+StatusOr<GetElementResult> CachingTaskRunner::GetElementResultFileStorage::Read(
+    size_t index) {
+  GetElementResponse response;
+  TF_RETURN_IF_ERROR(
+      ReadBinaryProto(Env::Default(), ElementPath(index), &response));
+  GetElementResult result;
+  for (const TensorProto& component : response.uncompressed().components()) {
+    Tensor tensor;
+    if (!tensor.FromProto(component)) {
+      return errors::DataLoss("Failed to parse tf.data service cross-trainer ",
+                              "cache element ", ElementPath(index));
+    }
+    result.components.push_back(std::move(tensor));
+  }
+  result.element_index = response.element_index();
+  result.end_of_sequence = response.end_of_sequence();
+  result.skip = response.skip_task();
+  return result;
+}
+
+Status CachingTaskRunner::GetElementResultFileStorage::Delete(size_t index) {
+  return Env::Default()->DeleteFile(ElementPath(index));
+}
+
+std::string CachingTaskRunner::GetElementResultFileStorage::ElementPath(
+    size_t index) const {
+  return io::JoinPath(directory_, strings::StrCat("element_", index));
+}
+
 void CachingTaskRunner::Cancel() {
   VLOG(2) << "Cancelling tf.data service cross-trainer cache task.";
   if (!cache_.IsCancelled()) {
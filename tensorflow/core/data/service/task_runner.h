@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -156,11 +157,17 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
 // the cache. Trainers read from a sliding window of the dataset and may not
-// read the full dataset.
+// read the full dataset. If an overflow directory is given, elements freed from
+// memory are written there, so that the window seen by lagging trainers is
+// larger than the memory budget.
 class CachingTaskRunner : public TaskRunner {
  public:
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
                              size_t max_cache_size_bytes);
+  CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
+                    size_t max_cache_size_bytes,
+                    const std::string& overflow_directory,
+                    size_t max_overflow_size_bytes);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -190,6 +197,24 @@ class CachingTaskRunner : public TaskRunner {
     FirstComeFirstServedTaskRunner& fcfs_task_runner_;
   };
 
+  // Stores the elements freed from the `CrossTrainerCache` memory as files in
+  // a local directory. The directory is deleted with the storage.
+  class GetElementResultFileStorage
+      : public CacheOverflowStorage<GetElementResult> {
+   public:
+    explicit GetElementResultFileStorage(const std::string& directory);
+    ~GetElementResultFileStorage() override;
+
+    Status Write(size_t index, const GetElementResult& element) override;
+    StatusOr<GetElementResult> Read(size_t index) override;
+    Status Delete(size_t index) override;
+
+   private:
+    std::string ElementPath(size_t index) const;
+
+    const std::string directory_;
+  };
+
   FirstComeFirstServedTaskRunner fcfs_task_runner_;
   CrossTrainerCache<GetElementResult> cache_;
 
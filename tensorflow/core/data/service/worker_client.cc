@@ -23,7 +23,10 @@ limitations under the License.
 
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
+#include "grpcpp/impl/codegen/client_unary_call.h"
+#include "grpcpp/impl/codegen/rpc_method.h"
 #include "grpcpp/security/credentials.h"
+#include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_set.h"
@@ -32,6 +35,7 @@ limitations under the License.
 #include "absl/strings/substitute.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/grpc_element_coding.h"
 #include "tensorflow/core/data/service/grpc_util.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -74,6 +78,12 @@ Status DataServiceWorkerClient::GetElement(const GetElementRequest& req,
   return client_->GetElement(req, result);
 }
 
+Status DataServiceWorkerClient::GetElements(
+    const GetElementRequest& req, std::vector<GetElementResult>& results) {
+  TF_RETURN_IF_ERROR(EnsureInitialized());
+  return client_->GetElements(req, results);
+}
+
 Status DataServiceWorkerClient::EnsureInitialized() {
   mutex_lock l(mu_);
   if (client_) {
@@ -96,34 +106,144 @@ void DataServiceWorkerClient::TryCancel() { client_->TryCancel(); }
 class GrpcDataTransferClient : public DataTransferClient {
  public:
   GrpcDataTransferClient(std::shared_ptr<grpc::ChannelCredentials> credentials,
-                         std::string address) {
+                         std::string address)
+      : channel_(CreateChannel(credentials, address)),
+        stub_(WorkerService::NewStub(channel_)),
+        get_element_raw_method_(kGetElementRawMethod,
+                                ::grpc::internal::RpcMethod::NORMAL_RPC,
+                                channel_),
+        get_elements_raw_method_(kGetElementsRawMethod,
+                                 ::grpc::internal::RpcMethod::NORMAL_RPC,
+                                 channel_) {
     VLOG(2) << "Create GrpcDataTransferClient for worker " << address << ".";
-    grpc::ChannelArguments args;
-    args.SetMaxReceiveMessageSize(-1);
-    auto channel = grpc::CreateCustomChannel(address, credentials, args);
-    stub_ = WorkerService::NewStub(channel);
   }
 
   Status GetElement(const GetElementRequest& req,
                     GetElementResult& result) override {
     VLOG(3) << "GetElement for task " << req.task_id() << " from gRPC worker "
             << "server.";
+    bool use_raw_method;
     {
       mutex_lock l(mu_);
       if (cancelled_) {
         return errors::Cancelled("Client was cancelled.");
       }
+      use_raw_method = use_raw_method_;
     }
-    grpc::ClientContext ctx;
-    gtl::Cleanup<std::function<void()>> cleanup;
+    if (use_raw_method) {
+      Status s = GetElementRaw(req, result);
+      if (!errors::IsUnimplemented(s)) {
+        return s;
+      }
+      // The worker predates `kGetElementRawMethod`.
+      VLOG(1) << "Worker does not support " << kGetElementRawMethod
+              << "; falling back to GetElement: " << s;
+      mutex_lock l(mu_);
+      use_raw_method_ = false;
+    }
+    return GetElementProto(req, result);
+  }
+
+  Status GetElements(const GetElementRequest& req,
+                     std::vector<GetElementResult>& results) override {
+    bool use_batch_method;
     {
       mutex_lock l(mu_);
-      active_contexts_.insert(&ctx);
-      cleanup = gtl::MakeCleanup([this, &ctx] {
-        mutex_lock l(mu_);
-        active_contexts_.erase(&ctx);
-      });
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      use_batch_method = use_batch_method_;
+    }
+    if (use_batch_method && req.max_elements() > 1) {
+      VLOG(3) << "GetElements for task " << req.task_id()
+              << " from gRPC worker server.";
+      Status s = GetElementsRaw(req, results);
+      if (!errors::IsUnimplemented(s)) {
+        return s;
+      }
+      // The worker predates `kGetElementsRawMethod`.
+      VLOG(1) << "Worker does not support " << kGetElementsRawMethod
+              << "; falling back to GetElement: " << s;
+      mutex_lock l(mu_);
+      use_batch_method_ = false;
+    }
+    return DataTransferClient::GetElements(req, results);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  static std::shared_ptr<grpc::Channel> CreateChannel(
+      std::shared_ptr<grpc::ChannelCredentials> credentials,
+      const std::string& address) {
+    grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    return grpc::CreateCustomChannel(address, credentials, args);
+  }
+
+  // Registers `ctx` as active until the returned cleanup is destroyed, so that
+  // `TryCancel` cancels its call.
+  gtl::Cleanup<std::function<void()>> RegisterContext(grpc::ClientContext* ctx)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    active_contexts_.insert(ctx);
+    return gtl::MakeCleanup([this, ctx] {
+      mutex_lock l(mu_);
+      active_contexts_.erase(ctx);
+    });
+  }
+
+  // Gets the element with `kGetElementRawMethod`, which decodes the tensors
+  // of the element directly from the received bytes.
+  Status GetElementRaw(const GetElementRequest& req, GetElementResult& result) {
+    grpc::ClientContext ctx;
+    auto cleanup = RegisterContext(&ctx);
+    ::grpc::ByteBuffer buffer;
+    int64_t start_time_us = env_->NowMicros();
+    grpc::Status s = ::grpc::internal::BlockingUnaryCall(
+        channel_.get(), get_element_raw_method_, &ctx, req, &buffer);
+    int64_t end_time_us = env_->NowMicros();
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
+                                                   end_time_us - start_time_us);
+    return DecodeGetElementResult(&buffer, result);
+  }
+
+  Status GetElementsRaw(const GetElementRequest& req,
+                        std::vector<GetElementResult>& results) {
+    grpc::ClientContext ctx;
+    auto cleanup = RegisterContext(&ctx);
+    ::grpc::ByteBuffer buffer;
+    int64_t start_time_us = env_->NowMicros();
+    grpc::Status s = ::grpc::internal::BlockingUnaryCall(
+        channel_.get(), get_elements_raw_method_, &ctx, req, &buffer);
+    int64_t end_time_us = env_->NowMicros();
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get elements", s);
+    }
+    metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
+                                                   end_time_us - start_time_us);
+    TF_RETURN_IF_ERROR(DecodeGetElementResults(&buffer, results));
+    if (results.empty()) {
+      return errors::Internal("Worker returned no elements for task ",
+                              req.task_id());
     }
+    return OkStatus();
+  }
+
+  Status GetElementProto(const GetElementRequest& req,
+                         GetElementResult& result) {
+    grpc::ClientContext ctx;
+    auto cleanup = RegisterContext(&ctx);
     GetElementResponse resp;
     int64_t start_time_us = env_->NowMicros();
     grpc::Status s = stub_->GetElement(&ctx, req, &resp);
@@ -156,18 +276,12 @@ class GrpcDataTransferClient : public DataTransferClient {
     return OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
+  const std::shared_ptr<grpc::Channel> channel_;
+  const std::unique_ptr<WorkerService::Stub> stub_;
+  const ::grpc::internal::RpcMethod get_element_raw_method_;
+  const ::grpc::internal::RpcMethod get_elements_raw_method_;
 
- private:
   mutex mu_;
-  std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
   // cancellation.
   absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
@@ -175,6 +289,12 @@ class GrpcDataTransferClient : public DataTransferClient {
   // Indicates that the client has been cancelled, so no further requests should
   // be accepted.
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Whether to get elements with `kGetElementRawMethod`. Cleared if the worker
+  // does not support it.
+  bool use_raw_method_ TF_GUARDED_BY(mu_) = true;
+  // Whether to get batches of elements with `kGetElementsRawMethod`. Cleared
+  // if the worker does not support it.
+  bool use_batch_method_ TF_GUARDED_BY(mu_) = true;
 };
 
 class GrpcTransferClientRegistrar {
@@ -217,6 +337,21 @@ class LocalDataTransferClient : public DataTransferClient {
     return s;
   }
 
+  Status GetElements(const GetElementRequest& req,
+                     std::vector<GetElementResult>& results) override {
+    VLOG(3) << "GetElements for task " << req.task_id()
+            << " from local worker.";
+    TF_RETURN_IF_ERROR(VerifyClientIsNotCancelled());
+    TF_ASSIGN_OR_RETURN(std::shared_ptr<DataServiceWorkerImpl> worker,
+                        GetWorker(req));
+    int64_t start_time_us = env_->NowMicros();
+    TF_RETURN_IF_ERROR(worker->GetElementResults(&req, &results));
+    int64_t end_time_us = env_->NowMicros();
+    metrics::RecordTFDataServiceGetElementDuration(kLocalTransferProtocol,
+                                                   end_time_us - start_time_us);
+    return OkStatus();
+  }
+
   void TryCancel() override {
     VLOG(2) << "Cancel LocalDataTransferClient for worker " << worker_address_
             << ".";
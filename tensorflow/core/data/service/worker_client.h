@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -45,6 +46,10 @@ class DataServiceWorkerClient : public DataServiceClientBase {
   // Fetches an element from the worker.
   Status GetElement(const GetElementRequest& req, GetElementResult& result);
 
+  // Fetches up to `req.max_elements()` elements from the worker.
+  Status GetElements(const GetElementRequest& req,
+                     std::vector<GetElementResult>& results);
+
   // Makes a best effort to cancel all outstanding calls in progress for the
   // client, and causes further calls to return Cancelled status.
   void TryCancel();
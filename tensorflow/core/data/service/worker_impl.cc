@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -115,6 +116,9 @@ WorkerConfig ApplyWorkerDefaults(const WorkerConfig& config) {
   if (new_config.snapshot_max_chunk_size_bytes() == 0) {
     new_config.set_snapshot_max_chunk_size_bytes(kDefaultMaxChunkSizeBytes);
   }
+  if (new_config.max_splits_per_request() <= 0) {
+    new_config.set_max_splits_per_request(1);
+  }
   return new_config;
 }
 
@@ -306,6 +310,34 @@ Status DataServiceWorkerImpl::GetElementResult(
   return OkStatus();
 }
 
+Status DataServiceWorkerImpl::GetElementResults(
+    const GetElementRequest* request,
+    std::vector<struct GetElementResult>* results) {
+  results->clear();
+  results->emplace_back();
+  TF_RETURN_IF_ERROR(GetElementResult(request, &results->back()));
+  // Round-robin reads need one element per round.
+  if (request->has_round_index()) return OkStatus();
+  const int64_t deadline_micros =
+      Env::Default()->NowMicros() +
+      std::max<int64_t>(request->batch_timeout_us(), 0);
+  while (results->size() < request->max_elements() &&
+         !results->back().end_of_sequence && !results->back().skip &&
+         Env::Default()->NowMicros() < deadline_micros) {
+    struct GetElementResult result;
+    Status s = GetElementResult(request, &result);
+    if (!s.ok()) {
+      // Return the elements produced so far. The client sees the error on
+      // its next request.
+      VLOG(2) << "Stopped batching elements of task " << request->task_id()
+              << ": " << s;
+      break;
+    }
+    results->push_back(std::move(result));
+  }
+  return OkStatus();
+}
+
 Status DataServiceWorkerImpl::ProcessTask(const ProcessTaskRequest* request,
                                           ProcessTaskResponse* response) {
   mutex_lock l(mu_);
@@ -447,7 +479,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, config_.dispatcher_timeout_ms(),
+          config_.max_splits_per_request()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -66,6 +66,13 @@ class DataServiceWorkerImpl {
   Status GetElementResult(const GetElementRequest* request,
                           GetElementResult* result);
 
+  // Serves a batched GetElement request, storing up to
+  // `request->max_elements()` results in `*results`. It waits for the first
+  // result like `GetElementResult`, and then adds results while they are
+  // produced within `request->batch_timeout_us()` of the first one.
+  Status GetElementResults(const GetElementRequest* request,
+                           std::vector<struct GetElementResult>* results);
+
   // Deletes the local task and iterator. Only called by local clients to delete
   // unused task iterators assuming the task is not read by remote clients. This
   // method is not visible to gRPC clients.
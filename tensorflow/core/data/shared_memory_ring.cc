@@ -0,0 +1,422 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_memory_ring.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr uint64 kMagic = 0x7466646174617368;  // "tfdatash"
+// Elements and tensors within them are aligned to this.
+constexpr int64_t kAlignment = 64;
+constexpr int64_t kPageBytes = 4096;
+constexpr int64_t kMaxSleepMicros = 1000;
+constexpr size_t kMaxErrorBytes = 1024;
+
+enum State : int32_t { kOpen = 0, kClosed = 1, kFailed = 2 };
+
+int64_t RoundUp(int64_t n, int64_t alignment) {
+  return (n + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+// Lives at the start of the file. Only the atomic fields change once the ring
+// is created; they are updated by atomic operations, which work across
+// processes for the lock-free types used.
+struct SharedMemoryRing::Header {
+  uint64 magic;
+  int64_t num_slots;
+  // A multiple of `kAlignment`.
+  int64_t slot_bytes;
+  int64_t num_consumers;
+  std::atomic<int64_t> num_attached;
+  std::atomic<int64_t> num_written;
+  // One of `State`. `error` is set before the state becomes kFailed.
+  std::atomic<int32_t> state;
+  char error[kMaxErrorBytes];
+  // The number of elements each consumer has released.
+  std::atomic<int64_t> num_released[kMaxConsumers];
+
+  static int64_t Bytes() { return RoundUp(sizeof(Header), kPageBytes); }
+  int64_t FileBytes() const { return Bytes() + num_slots * slot_bytes; }
+};
+
+static_assert(std::atomic<int64_t>::is_always_lock_free,
+              "Shared memory rings require lock-free 64-bit atomics");
+static_assert(std::atomic<int32_t>::is_always_lock_free,
+              "Shared memory rings require lock-free 32-bit atomics");
+
+class SharedMemoryRing::Mapping {
+ public:
+  // `consumer_id` is -1 for the producer, which removes `path` when done.
+  Mapping(char* base, size_t size, std::string path, int64_t consumer_id)
+      : base_(base),
+        size_(size),
+        path_(std::move(path)),
+        consumer_id_(consumer_id) {}
+
+  ~Mapping() {
+#if !defined(PLATFORM_WINDOWS)
+    if (consumer_id_ < 0) unlink(path_.c_str());
+    munmap(base_, size_);
+#endif
+  }
+
+  Header* header() const { return reinterpret_cast<Header*>(base_); }
+  char* slot(int64_t index) const {
+    return base_ + Header::Bytes() +
+           (index % header()->num_slots) * header()->slot_bytes;
+  }
+  int64_t consumer_id() const { return consumer_id_; }
+
+  // Called once all the tensors of element `index` are destroyed. Consumers
+  // may release elements out of order, but the producer may only reuse the
+  // slots of a prefix of the sequence.
+  void Release(int64_t index) {
+    mutex_lock l(mu_);
+    released_.insert(index);
+    while (released_.erase(num_released_)) ++num_released_;
+    header()->num_released[consumer_id_].store(num_released_,
+                                                std::memory_order_release);
+  }
+
+ private:
+  char* const base_;
+  const size_t size_;
+  const std::string path_;
+  const int64_t consumer_id_;
+
+  mutex mu_;
+  int64_t num_released_ TF_GUARDED_BY(mu_) = 0;
+  // The released elements from `num_released_` on.
+  absl::flat_hash_set<int64_t> released_ TF_GUARDED_BY(mu_);
+};
+
+// Shared by the tensors of an element read by a consumer.
+class SharedMemoryRing::Lease {
+ public:
+  Lease(std::shared_ptr<Mapping> mapping, int64_t index)
+      : mapping_(std::move(mapping)), index_(index) {}
+  ~Lease() { mapping_->Release(index_); }
+
+ private:
+  const std::shared_ptr<Mapping> mapping_;
+  const int64_t index_;
+};
+
+namespace {
+
+// A TensorBuffer that points into a slot of the ring, and holds a lease on
+// it.
+class SlotTensorBuffer : public TensorBuffer {
+ public:
+  SlotTensorBuffer(std::shared_ptr<void> lease, void* data, size_t size)
+      : TensorBuffer(data), lease_(std::move(lease)), size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("shared_memory_ring");
+  }
+  // The memory is shared with the other consumers.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<void> lease_;
+  const size_t size_;
+};
+
+// An element is laid out in a slot as int64 words holding the number of
+// components and, for each component, its dtype, the offset of its data in
+// the slot, its size in bytes, its rank and its dimensions. The data follows,
+// each component aligned to `kAlignment`.
+int64_t LayoutBytes(const std::vector<Tensor>& element) {
+  int64_t words = 1;
+  for (const Tensor& t : element) words += 4 + t.dims();
+  int64_t bytes = RoundUp(words * sizeof(int64_t), kAlignment);
+  for (const Tensor& t : element) {
+    bytes = RoundUp(bytes + t.TotalBytes(), kAlignment);
+  }
+  return bytes;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<SharedMemoryRing>> SharedMemoryRing::Create(
+    const std::string& path, const Options& options) {
+  if (options.num_slots < 1 || options.slot_bytes < 1 ||
+      options.num_consumers < 1 || options.num_consumers > kMaxConsumers) {
+    return errors::InvalidArgument(
+        "Invalid shared memory ring options: num_slots=", options.num_slots,
+        ", slot_bytes=", options.slot_bytes,
+        ", num_consumers=", options.num_consumers);
+  }
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented("Shared memory rings are not supported.");
+#else
+  const int64_t slot_bytes = RoundUp(options.slot_bytes, kAlignment);
+  const int64_t size = Header::Bytes() + options.num_slots * slot_bytes;
+  // Initializes the ring under a temporary name, so that consumers never see
+  // it half-initialized.
+  const std::string tmp_path = strings::StrCat(path, ".tmp", random::New64());
+  const int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return errors::Internal("Failed to create ", tmp_path, ": ",
+                            strerror(errno));
+  }
+  void* base = MAP_FAILED;
+  if (ftruncate(fd, size) == 0) {
+    base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  const int error = errno;
+  close(fd);
+  if (base == MAP_FAILED) {
+    unlink(tmp_path.c_str());
+    return errors::ResourceExhausted("Failed to map ", size, " bytes at ",
+                                     tmp_path, ": ", strerror(error));
+  }
+
+  Header* header = new (base) Header();
+  header->magic = kMagic;
+  header->num_slots = options.num_slots;
+  header->slot_bytes = slot_bytes;
+  header->num_consumers = options.num_consumers;
+  if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+    const int error = errno;
+    munmap(base, size);
+    unlink(tmp_path.c_str());
+    return errors::Internal("Failed to rename ", tmp_path, " to ", path, ": ",
+                            strerror(error));
+  }
+  return absl::WrapUnique(new SharedMemoryRing(std::make_shared<Mapping>(
+      static_cast<char*>(base), size, path, /*consumer_id=*/-1)));
+#endif
+}
+
+StatusOr<std::unique_ptr<SharedMemoryRing>> SharedMemoryRing::Attach(
+    const std::string& path) {
+#if defined(PLATFORM_WINDOWS)
+  return errors::Unimplemented("Shared memory rings are not supported.");
+#else
+  const int fd = open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    if (errno == ENOENT) {
+      return errors::NotFound("No shared memory ring at ", path);
+    }
+    return errors::Internal("Failed to open ", path, ": ", strerror(errno));
+  }
+  struct stat st;
+  void* base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && st.st_size >= Header::Bytes()) {
+    base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (base == MAP_FAILED) {
+    return errors::DataLoss("Failed to map the shared memory ring at ", path);
+  }
+  Header* header = reinterpret_cast<Header*>(base);
+  if (header->magic != kMagic || header->FileBytes() != st.st_size) {
+    munmap(base, st.st_size);
+    return errors::DataLoss(path, " is not a shared memory ring");
+  }
+  int64_t consumer_id = header->num_attached.load();
+  do {
+    if (consumer_id >= header->num_consumers) {
+      munmap(base, st.st_size);
+      return errors::ResourceExhausted("All ", header->num_consumers,
+                                       " consumers of the shared memory ring ",
+                                       "at ", path, " are attached already");
+    }
+  } while (!header->num_attached.compare_exchange_weak(consumer_id,
+                                                       consumer_id + 1));
+  return absl::WrapUnique(new SharedMemoryRing(std::make_shared<Mapping>(
+      static_cast<char*>(base), st.st_size, path, consumer_id)));
+#endif
+}
+
+SharedMemoryRing::SharedMemoryRing(std::shared_ptr<Mapping> mapping)
+    : mapping_(std::move(mapping)), header_(mapping_->header()) {}
+
+SharedMemoryRing::~SharedMemoryRing() = default;
+
+template <typename Predicate>
+Status SharedMemoryRing::Wait(Predicate done) {
+  int64_t sleep_micros = 1;
+  while (!done()) {
+    if (cancelled_.load(std::memory_order_relaxed)) {
+      return errors::Cancelled("Shared memory ring was cancelled");
+    }
+    Env::Default()->SleepForMicroseconds(sleep_micros);
+    sleep_micros = std::min(sleep_micros * 2, kMaxSleepMicros);
+  }
+  return OkStatus();
+}
+
+Status SharedMemoryRing::Write(const std::vector<Tensor>& element) {
+  if (mapping_->consumer_id() >= 0) {
+    return errors::FailedPrecondition("Consumers cannot write to the ring");
+  }
+  for (const Tensor& t : element) {
+    if (!DataTypeCanUseMemcpy(t.dtype())) {
+      return errors::InvalidArgument(
+          "Shared memory rings do not support tensors of type ",
+          DataTypeString(t.dtype()));
+    }
+  }
+  const int64_t bytes = LayoutBytes(element);
+  if (bytes > header_->slot_bytes) {
+    return errors::InvalidArgument("Element of ", bytes,
+                                   " bytes does not fit in slots of ",
+                                   header_->slot_bytes, " bytes");
+  }
+
+  mutex_lock l(mu_);
+  const int64_t index = next_index_;
+  TF_RETURN_IF_ERROR(Wait([this, index]() {
+    for (int64_t i = 0; i < header_->num_consumers; ++i) {
+      if (index - header_->num_released[i].load(std::memory_order_acquire) >=
+          header_->num_slots) {
+        return false;
+      }
+    }
+    return true;
+  }));
+
+  char* slot = mapping_->slot(index);
+  int64_t* words = reinterpret_cast<int64_t*>(slot);
+  *words++ = element.size();
+  int64_t offset = 1;
+  for (const Tensor& t : element) offset += 4 + t.dims();
+  offset = RoundUp(offset * sizeof(int64_t), kAlignment);
+  for (const Tensor& t : element) {
+    const StringPiece data = t.tensor_data();
+    *words++ = t.dtype();
+    *words++ = offset;
+    *words++ = data.size();
+    *words++ = t.dims();
+    for (int64_t dim : t.shape().dim_sizes()) *words++ = dim;
+    std::memcpy(slot + offset, data.data(), data.size());
+    offset = RoundUp(offset + data.size(), kAlignment);
+  }
+  header_->num_written.store(index + 1, std::memory_order_release);
+  ++next_index_;
+  return OkStatus();
+}
+
+void SharedMemoryRing::Close(const Status& status) {
+  DCHECK_LT(mapping_->consumer_id(), 0);
+  mutex_lock l(mu_);
+  if (!status.ok()) {
+    const std::string message = status.ToString();
+    const size_t size = std::min(message.size(), kMaxErrorBytes - 1);
+    std::memcpy(header_->error, message.data(), size);
+    header_->error[size] = '\0';
+  }
+  header_->state.store(status.ok() ? kClosed : kFailed,
+                       std::memory_order_release);
+}
+
+Status SharedMemoryRing::WaitForConsumers() {
+  if (mapping_->consumer_id() >= 0) {
+    return errors::FailedPrecondition("Only the producer waits for consumers");
+  }
+  return Wait([this]() {
+    return header_->num_attached.load(std::memory_order_acquire) >=
+           header_->num_consumers;
+  });
+}
+
+Status SharedMemoryRing::Read(std::vector<Tensor>* element,
+                              bool* end_of_sequence) {
+  if (mapping_->consumer_id() < 0) {
+    return errors::FailedPrecondition("The producer cannot read the ring");
+  }
+  mutex_lock l(mu_);
+  const int64_t index = next_index_;
+  int32_t state = kOpen;
+  TF_RETURN_IF_ERROR(Wait([this, index, &state]() {
+    if (header_->num_written.load(std::memory_order_acquire) > index) {
+      return true;
+    }
+    state = header_->state.load(std::memory_order_acquire);
+    return state != kOpen;
+  }));
+  // The producer closes the ring after writing its last element, so the
+  // number of elements written is final once it is closed.
+  if (header_->num_written.load(std::memory_order_acquire) <= index) {
+    if (state == kFailed) {
+      return errors::Aborted("The producer of the shared memory ring failed: ",
+                             header_->error);
+    }
+    *end_of_sequence = true;
+    return OkStatus();
+  }
+
+  const char* slot = mapping_->slot(index);
+  const int64_t* words = reinterpret_cast<const int64_t*>(slot);
+  const int64_t num_components = *words++;
+  auto lease = std::make_shared<Lease>(mapping_, index);
+  element->clear();
+  element->reserve(num_components);
+  for (int64_t i = 0; i < num_components; ++i) {
+    const DataType dtype = static_cast<DataType>(*words++);
+    const int64_t offset = *words++;
+    const int64_t bytes = *words++;
+    const int64_t rank = *words++;
+    TensorShape shape;
+    for (int64_t d = 0; d < rank; ++d) {
+      TF_RETURN_IF_ERROR(shape.AddDimWithStatus(*words++));
+    }
+    if (offset + bytes > header_->slot_bytes ||
+        bytes != shape.num_elements() * DataTypeSize(dtype)) {
+      return errors::DataLoss("Corrupted element ", index,
+                              " in shared memory ring");
+    }
+    auto* buffer =
+        new SlotTensorBuffer(lease, const_cast<char*>(slot) + offset, bytes);
+    element->push_back(Tensor(dtype, shape, buffer));
+    buffer->Unref();
+  }
+  *end_of_sequence = false;
+  ++next_index_;
+  return OkStatus();
+}
+
+void SharedMemoryRing::Cancel() { cancelled_.store(true); }
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SHARED_MEMORY_RING_H_
+#define TENSORFLOW_CORE_DATA_SHARED_MEMORY_RING_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// A ring buffer of dataset elements in a memory-mapped file, through which one
+// producer process publishes elements to a fixed number of consumer processes
+// on the same host, e.g. a file under /dev/shm.
+//
+// Like `CrossTrainerCache`, every consumer reads every element, so a pipeline
+// shared by trainers that all need the same data runs once per host instead of
+// once per trainer. Unlike it, elements are neither serialized nor copied on
+// the read path: the tensors returned by `Read` point into the shared memory,
+// and their slot is only reused after every consumer has released all the
+// tensors it read from it. A consumer that holds on to its elements therefore
+// stalls the producer once the ring is full.
+//
+// Only tensors of types that can be copied with memcpy are supported.
+//
+// Waits poll the shared memory with an exponential backoff, and can be
+// interrupted by `Cancel()`. Each `SharedMemoryRing` object is thread-safe.
+//
+// Example usage:
+//
+//   // Producer process.
+//   TF_ASSIGN_OR_RETURN(auto ring,
+//                       SharedMemoryRing::Create("/dev/shm/input", options));
+//   while (...) TF_RETURN_IF_ERROR(ring->Write(element));
+//   ring->Close(OkStatus());
+//   TF_RETURN_IF_ERROR(ring->WaitForConsumers());
+//
+//   // Each of the `options.num_consumers` consumer processes.
+//   TF_ASSIGN_OR_RETURN(auto ring, SharedMemoryRing::Attach("/dev/shm/input"));
+//   TF_RETURN_IF_ERROR(ring->Read(&element, &end_of_sequence));
+class SharedMemoryRing {
+ public:
+  struct Options {
+    // The number of elements the ring holds.
+    int64_t num_slots = 16;
+    // The maximum size of an element, including a small header.
+    int64_t slot_bytes = 16 << 20;
+    // The number of consumers, each of which must read the whole sequence.
+    int64_t num_consumers = 1;
+  };
+
+  // The maximum value of `Options::num_consumers`.
+  static constexpr int64_t kMaxConsumers = 64;
+
+  // Creates a ring at `path`, replacing any existing file. The ring becomes
+  // visible to `Attach()` once it is initialized, and the file is removed
+  // when the returned producer is destroyed.
+  static StatusOr<std::unique_ptr<SharedMemoryRing>> Create(
+      const std::string& path, const Options& options);
+
+  // Attaches to the ring at `path` as its next consumer. Returns NotFound if
+  // the ring has not been created yet, and ResourceExhausted if all its
+  // consumers have attached already.
+  static StatusOr<std::unique_ptr<SharedMemoryRing>> Attach(
+      const std::string& path);
+
+  ~SharedMemoryRing();
+
+  SharedMemoryRing(const SharedMemoryRing&) = delete;
+  SharedMemoryRing& operator=(const SharedMemoryRing&) = delete;
+
+  // Producer only. Copies `element` into the next slot, waiting for every
+  // consumer to release the element it held before.
+  Status Write(const std::vector<Tensor>& element);
+
+  // Producer only. Ends the sequence. If `status` is not OK, consumers fail
+  // after reading the elements written so far.
+  void Close(const Status& status);
+
+  // Producer only. Waits until all the consumers have attached. Consumers
+  // keep reading the ring after that even if the producer is destroyed.
+  Status WaitForConsumers();
+
+  // Consumer only. Returns the next element, or sets `end_of_sequence` once
+  // the producer has closed the ring and all elements have been read. The
+  // tensors do not own their memory, so they are never modified in place.
+  Status Read(std::vector<Tensor>* element, bool* end_of_sequence);
+
+  // Makes pending and future calls to `Write` and `Read` return Cancelled.
+  void Cancel();
+
+ private:
+  struct Header;
+  // Owns the memory mapping, which outlives the ring as long as tensors read
+  // from it are alive.
+  class Mapping;
+  class Lease;
+
+  explicit SharedMemoryRing(std::shared_ptr<Mapping> mapping);
+
+  // Waits until `done()` returns true, or the ring is cancelled.
+  template <typename Predicate>
+  Status Wait(Predicate done);
+
+  const std::shared_ptr<Mapping> mapping_;
+  Header* const header_;
+  std::atomic<bool> cancelled_{false};
+
+  mutex mu_;
+  // The next element to read or write.
+  int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SHARED_MEMORY_RING_H_
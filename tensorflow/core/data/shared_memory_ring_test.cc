@@ -0,0 +1,179 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/shared_memory_ring.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::string RingPath(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+std::vector<Tensor> MakeElement(int64_t i) {
+  return {test::AsScalar<int64_t>(i),
+          test::AsTensor<float>({1, 2, 3, 4, 5, 6.0f * i}, {2, 3})};
+}
+
+TEST(SharedMemoryRingTest, EveryConsumerReadsEveryElement) {
+  SharedMemoryRing::Options options;
+  options.num_slots = 3;
+  options.slot_bytes = 1024;
+  options.num_consumers = 2;
+  TF_ASSERT_OK_AND_ASSIGN(auto producer,
+                          SharedMemoryRing::Create(RingPath("ring"), options));
+  std::vector<std::unique_ptr<SharedMemoryRing>> consumers(2);
+  for (auto& consumer : consumers) {
+    TF_ASSERT_OK_AND_ASSIGN(consumer,
+                            SharedMemoryRing::Attach(RingPath("ring")));
+  }
+
+  constexpr int kNumElements = 10;
+  std::unique_ptr<Thread> writer(Env::Default()->StartThread(
+      {}, "writer", [&producer]() {
+        for (int64_t i = 0; i < kNumElements; ++i) {
+          TF_ASSERT_OK(producer->Write(MakeElement(i)));
+        }
+        producer->Close(OkStatus());
+      }));
+  std::vector<std::unique_ptr<Thread>> readers;
+  for (auto& consumer : consumers) {
+    readers.emplace_back(Env::Default()->StartThread(
+        {}, "reader", [consumer = consumer.get()]() {
+          std::vector<Tensor> element;
+          bool end_of_sequence = false;
+          for (int64_t i = 0; i < kNumElements; ++i) {
+            TF_ASSERT_OK(consumer->Read(&element, &end_of_sequence));
+            ASSERT_FALSE(end_of_sequence);
+            ASSERT_EQ(element.size(), 2);
+            test::ExpectTensorEqual<int64_t>(element[0], MakeElement(i)[0]);
+            test::ExpectTensorEqual<float>(element[1], MakeElement(i)[1]);
+            // The tensors point into the ring.
+            EXPECT_FALSE(element[1].RefCountIsOne());
+          }
+          element.clear();
+          TF_ASSERT_OK(consumer->Read(&element, &end_of_sequence));
+          EXPECT_TRUE(end_of_sequence);
+        }));
+  }
+}
+
+TEST(SharedMemoryRingTest, ConsumersOutliveProducer) {
+  SharedMemoryRing::Options options;
+  options.slot_bytes = 1024;
+  TF_ASSERT_OK_AND_ASSIGN(auto producer,
+                          SharedMemoryRing::Create(RingPath("short"), options));
+  TF_ASSERT_OK(producer->Write(MakeElement(0)));
+  producer->Close(OkStatus());
+  std::unique_ptr<SharedMemoryRing> consumer;
+  std::unique_ptr<Thread> attacher(
+      Env::Default()->StartThread({}, "attacher", [&consumer]() {
+        Env::Default()->SleepForMicroseconds(10000);
+        TF_ASSERT_OK_AND_ASSIGN(consumer,
+                                SharedMemoryRing::Attach(RingPath("short")));
+      }));
+  TF_ASSERT_OK(producer->WaitForConsumers());
+  producer.reset();
+  attacher.reset();
+
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(consumer->Read(&element, &end_of_sequence));
+  test::ExpectTensorEqual<int64_t>(element[0], MakeElement(0)[0]);
+  TF_ASSERT_OK(consumer->Read(&element, &end_of_sequence));
+  EXPECT_TRUE(end_of_sequence);
+}
+
+TEST(SharedMemoryRingTest, AttachFailures) {
+  EXPECT_TRUE(errors::IsNotFound(
+      SharedMemoryRing::Attach(RingPath("missing")).status()));
+
+  SharedMemoryRing::Options options;
+  options.num_consumers = 1;
+  options.slot_bytes = 1024;
+  TF_ASSERT_OK_AND_ASSIGN(auto producer,
+                          SharedMemoryRing::Create(RingPath("one"), options));
+  TF_ASSERT_OK(SharedMemoryRing::Attach(RingPath("one")).status());
+  EXPECT_TRUE(errors::IsResourceExhausted(
+      SharedMemoryRing::Attach(RingPath("one")).status()));
+}
+
+TEST(SharedMemoryRingTest, ProducerFailure) {
+  SharedMemoryRing::Options options;
+  options.slot_bytes = 1024;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto producer, SharedMemoryRing::Create(RingPath("failure"), options));
+  TF_ASSERT_OK_AND_ASSIGN(auto consumer,
+                          SharedMemoryRing::Attach(RingPath("failure")));
+  TF_ASSERT_OK(producer->Write(MakeElement(0)));
+  producer->Close(errors::Internal("pipeline failed"));
+
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(consumer->Read(&element, &end_of_sequence));
+  EXPECT_FALSE(end_of_sequence);
+  Status status = consumer->Read(&element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsAborted(status));
+  EXPECT_TRUE(absl::StrContains(status.message(), "pipeline failed"));
+}
+
+TEST(SharedMemoryRingTest, UnsupportedElements) {
+  SharedMemoryRing::Options options;
+  options.slot_bytes = 64;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto producer,
+      SharedMemoryRing::Create(RingPath("unsupported"), options));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      producer->Write({test::AsScalar<tstring>("string")})));
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      producer->Write({test::AsTensor<float>(std::vector<float>(64))})));
+}
+
+TEST(SharedMemoryRingTest, HeldElementsBlockProducerUntilCancelled) {
+  SharedMemoryRing::Options options;
+  options.num_slots = 1;
+  options.slot_bytes = 1024;
+  TF_ASSERT_OK_AND_ASSIGN(auto producer,
+                          SharedMemoryRing::Create(RingPath("held"), options));
+  TF_ASSERT_OK_AND_ASSIGN(auto consumer,
+                          SharedMemoryRing::Attach(RingPath("held")));
+  TF_ASSERT_OK(producer->Write(MakeElement(0)));
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(consumer->Read(&element, &end_of_sequence));
+
+  std::unique_ptr<Thread> canceller(
+      Env::Default()->StartThread({}, "canceller", [&producer]() {
+        Env::Default()->SleepForMicroseconds(10000);
+        producer->Cancel();
+      }));
+  EXPECT_TRUE(errors::IsCancelled(producer->Write(MakeElement(1))));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/platform/env.h"
 
@@ -121,6 +122,25 @@ int64_t TfDatazMetricsCollector::GetIteratorTotalMemoryUsage() {
   return iterator_->TotalBufferedBytes();
 }
 
+std::vector<std::pair<std::string, double>>
+TfDatazMetricsCollector::GetTunedParameters() {
+  std::vector<std::pair<std::string, double>> tuned_parameters;
+  for (const auto& [node_name, parameter] : iterator_->TunableParameters()) {
+    double value = parameter->value;
+    if (parameter->state != nullptr) {
+      mutex_lock l(*parameter->state->mu);
+      value = parameter->state->value;
+    }
+    tuned_parameters.emplace_back(
+        absl::StrCat(node_name, "/", parameter->name), value);
+  }
+  return tuned_parameters;
+}
+
+model::BottleneckAnalysis TfDatazMetricsCollector::GetBottleneckAnalysis() {
+  return iterator_->AnalyzeBottlenecks();
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
@@ -26,6 +26,7 @@ limitations under the License.
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -115,6 +116,16 @@ class TfDatazMetricsCollector {
   // buffered in all nodes in the subtree.
   int64_t GetIteratorTotalMemoryUsage();
 
+  // Returns the values chosen by autotuning for the tunable parameters of the
+  // iterator (e.g. `parallelism` and `buffer_size`), as pairs of
+  // "<node name>/<parameter name>" and value.
+  std::vector<std::pair<std::string, double>> GetTunedParameters();
+
+  // Returns which stage of the iterator limits its throughput, and how long
+  // each of its nodes is blocked on its input and on its output, according to
+  // the current state of its model.
+  model::BottleneckAnalysis GetBottleneckAnalysis();
+
  private:
   IteratorBase* iterator_;  // not owned
   ApproximateLatencyEstimator latency_estimator_;
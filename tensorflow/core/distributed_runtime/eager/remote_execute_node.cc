@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/eager/remote_execute_node.h"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
@@ -24,12 +25,83 @@ limitations under the License.
 namespace tensorflow {
 namespace eager {
 
+namespace {
+// What is needed to complete a node once the response to its request arrives,
+// by which time the node itself may have been destroyed.
+struct PendingNode {
+  gtl::InlinedVector<TensorHandle*, 4> inputs;
+  gtl::InlinedVector<TensorHandle*, 2> retvals;
+  Device* device;
+  uint64 context_view_id;
+  StatusCallback done;
+};
+
+// Completes `node` with `status` and, if it is OK, with `queue_response`.
+void CompleteNode(const Status& status, const QueueResponse* queue_response,
+                  PendingNode& node) {
+  for (auto handle : node.inputs) {
+    handle->Unref();
+  }
+  for (size_t i = 0; i < node.retvals.size(); ++i) {
+    if (status.ok()) {
+      const string output_device = queue_response->device().empty()
+                                       ? ""
+                                       : queue_response->device(i);
+      Status s = node.retvals[i]->SetRemoteShapeAndDevice(
+          queue_response->shape(i), node.device, node.context_view_id,
+          output_device);
+
+      if (!s.ok()) {
+        LOG(ERROR) << "Ignoring an error encountered when setting "
+                      "remote shape of tensor handle: "
+                   << node.retvals[i]
+                   << " with execute status: " << status.ToString()
+                   << " and SetRemoteShape status: " << s.ToString()
+                   << "\nThis should never happen. "
+                      "Please file an issue with the TensorFlow Team.";
+      }
+    } else {
+      node.retvals[i]->PoisonRemote(status, node.device, node.context_view_id);
+    }
+    node.retvals[i]->Unref();
+  }
+  node.done(status);
+}
+}  // namespace
+
+bool RemoteExecuteNode::CanBatchWith(const AsyncRemoteExecuteNode& next) const {
+  const RemoteExecuteNode* other = next.AsRemoteExecuteNode();
+  return other != nullptr && other->eager_context_ == eager_context_ &&
+         other->eager_client_ == eager_client_ &&
+         other->context_view_id_ == context_view_id_ &&
+         other->cancellation_manager_ == cancellation_manager_ &&
+         !needs_remote_inputs_ && !other->needs_remote_inputs_ &&
+         request_->queue_size() == 1 && other->request_->queue_size() == 1;
+}
+
 void RemoteExecuteNode::RunAsync(StatusCallback done) {
-  auto response = std::make_shared<EnqueueResponse>();
+  std::vector<StatusCallback> node_done;
+  node_done.push_back(std::move(done));
+  RunBatchAsync({}, std::move(node_done));
+}
 
-  const gtl::InlinedVector<TensorHandle*, 4>& inputs = inputs_;
-  const gtl::InlinedVector<TensorHandle*, 2>& retvals = retvals_;
-  Device* device = device_;
+void RemoteExecuteNode::RunBatchAsync(
+    absl::Span<AsyncRemoteExecuteNode* const> batch,
+    std::vector<StatusCallback> done) {
+  DCHECK_EQ(batch.size() + 1, done.size());
+  auto response = std::make_shared<EnqueueResponse>();
+  auto pending = std::make_shared<std::vector<PendingNode>>();
+  pending->reserve(done.size());
+  for (int i = 0, end = done.size(); i < end; ++i) {
+    const RemoteExecuteNode* node =
+        i == 0 ? this : batch[i - 1]->AsRemoteExecuteNode();
+    if (i > 0) {
+      DCHECK(node != nullptr);
+      *request_->add_queue() = node->request_->queue(0);
+    }
+    pending->push_back({node->inputs_, node->retvals_, node->device_,
+                        node->context_view_id_, std::move(done[i])});
+  }
 
   // Filled and used only when VLOG(3) is on.
   string rpc_description;
@@ -58,67 +130,47 @@ void RemoteExecuteNode::RunAsync(StatusCallback done) {
   if (cm != nullptr) {
     token = cm->get_cancellation_token();
     const bool already_cancelled = !cm->RegisterCallback(
-        token, [call_opts, response, done]() { call_opts->StartCancel(); });
+        token, [call_opts, response]() { call_opts->StartCancel(); });
     if (already_cancelled) {
       Status s = errors::Cancelled("RemoteExecuteNode::RunAsync");
-      for (size_t i = 0; i < retvals.size(); ++i) {
-        retvals[i]->PoisonRemote(s, device, context_view_id_);
+      for (PendingNode& node : *pending) {
+        for (auto handle : node.retvals) {
+          handle->PoisonRemote(s, node.device, node.context_view_id);
+        }
+        node.done(s);
       }
-      done(s);
       return;
     }
   }
 
-  for (auto handle : inputs_) {
-    handle->Ref();
-  }
-  for (auto handle : retvals) {
-    handle->Ref();
+  for (PendingNode& node : *pending) {
+    for (auto handle : node.inputs) {
+      handle->Ref();
+    }
+    for (auto handle : node.retvals) {
+      handle->Ref();
+    }
   }
 
   eager_client_->StreamingEnqueueAsync(
       eager_context_->Executor().StreamingEnqueue(), call_opts.get(),
       request_.get(), response.get(),
-      [inputs, retvals, call_opts, response, device,
-       context_view_id = context_view_id_, rpc_description, cm, token,
-       done](const Status& status) {
+      [pending, call_opts, response, rpc_description, cm,
+       token](const Status& status) {
         if (cm != nullptr) {
           cm->TryDeregisterCallback(token);
         }
-        for (auto handle : inputs) {
-          handle->Unref();
-        }
         if (status.ok()) {
           VLOG(3) << "Completed successfully: " << rpc_description;
         } else {
           VLOG(3) << "Failed: " << rpc_description << " with status "
                   << status.ToString();
         }
-        for (size_t i = 0; i < retvals.size(); ++i) {
-          if (status.ok()) {
-            const string output_device =
-                response->queue_response(0).device().empty()
-                    ? ""
-                    : response->queue_response(0).device(i);
-            Status s = retvals[i]->SetRemoteShapeAndDevice(
-                response->queue_response(0).shape(i), device, context_view_id,
-                output_device);
-
-            if (!s.ok()) {
-              LOG(ERROR) << "Ignoring an error encountered when setting "
-                            "remote shape of tensor handle: "
-                         << retvals[i]
-                         << " with execute status: " << status.ToString()
-                         << " and SetRemoteShape status: " << s.ToString()
-                         << "\nThis should never happen. "
-                            "Please file an issue with the TensorFlow Team.";
-            }
-          } else {
-            retvals[i]->PoisonRemote(status, device, context_view_id);
-          }
-          retvals[i]->Unref();
+        for (int i = 0, end = pending->size(); i < end; ++i) {
+          CompleteNode(status,
+                       status.ok() ? &response->queue_response(i) : nullptr,
+                       (*pending)[i]);
         }
-        done(status);
       });
 }
 
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstddef>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
@@ -115,6 +116,17 @@ class RemoteExecuteNode : public AsyncRemoteExecuteNode {
     return eager_client_->allow_multiple_pending_requests();
   }
 
+  const RemoteExecuteNode* AsRemoteExecuteNode() const override {
+    return this;
+  }
+
+  // Nodes for the same worker, context view and cancellation manager are
+  // batched, unless they run multi-device functions with remote inputs.
+  bool CanBatchWith(const AsyncRemoteExecuteNode& next) const override;
+
+  void RunBatchAsync(absl::Span<AsyncRemoteExecuteNode* const> batch,
+                     std::vector<StatusCallback> done) override;
+
   string DebugString() const override {
     string out = "[RemoteExecuteNode]";
     strings::StrAppend(&out, " request: ", request_->DebugString());
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_remote_worker.h"
 
+#include <memory>
 #include <utility>
 
 #include "grpcpp/generic/generic_stub.h"
@@ -45,9 +46,14 @@ class GrpcRemoteWorker : public WorkerInterface {
   explicit GrpcRemoteWorker(SharedGrpcChannelPtr channel,
                             ::grpc::CompletionQueue* completion_queue,
                             thread::ThreadPool* callback_threadpool,
-                            WorkerCacheLogger* logger, const string& target)
+                            WorkerCacheLogger* logger, const string& target,
+                            SharedGrpcChannelPtr bulk_data_channel = nullptr)
       : channel_(std::move(channel)),
         stub_(channel_),
+        bulk_data_channel_(std::move(bulk_data_channel)),
+        bulk_data_stub_(bulk_data_channel_ == nullptr
+                            ? nullptr
+                            : new ::grpc::GenericStub(bulk_data_channel_)),
         cq_(completion_queue),
         callback_threadpool_(callback_threadpool),
         getstatus_(Method(GrpcWorkerMethod::kGetStatus)),
@@ -172,7 +178,8 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
-    IssueRequest(request, response, recvbuf_, callback, call_opts);
+    IssueRequest(request, response, recvbuf_, callback, call_opts,
+                 /*fail_fast=*/true, BulkDataStub());
   }
 
   void CompleteGroupAsync(CallOptions* call_opts,
@@ -255,7 +262,8 @@ class GrpcRemoteWorker : public WorkerInterface {
       done(s);
     };
 
-    IssueRequest(request, response, recvtensor_, callback, call_opts);
+    IssueRequest(request, response, recvtensor_, callback, call_opts,
+                 BulkDataStub());
   }
 
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
@@ -270,21 +278,26 @@ class GrpcRemoteWorker : public WorkerInterface {
 
  private:
   // Utility method for issuing a generic asynchronous request. The
-  // given callback, `done`, will be called when the RPC completes.
+  // given callback, `done`, will be called when the RPC completes. The
+  // request is sent on `stub`, or on `stub_` if it is nullptr.
   void IssueRequest(const protobuf::Message* request,
                     protobuf::Message* response, const ::grpc::string& method,
                     StatusCallback done, CallOptions* call_opts = nullptr,
-                    bool fail_fast = true) {
+                    bool fail_fast = true,
+                    ::grpc::GenericStub* stub = nullptr) {
     new RPCState<protobuf::Message>(
-        &stub_, cq_, method, *request, response, std::move(done), call_opts,
-        callback_threadpool_, MaxRetries(), fail_fast, &target_);
+        stub == nullptr ? &stub_ : stub, cq_, method, *request, response,
+        std::move(done), call_opts, callback_threadpool_, MaxRetries(),
+        fail_fast, &target_);
   }
 
   void IssueRequest(const protobuf::Message* request, TensorResponse* response,
                     const ::grpc::string& method, StatusCallback done,
-                    CallOptions* call_opts = nullptr) {
+                    CallOptions* call_opts = nullptr,
+                    ::grpc::GenericStub* stub = nullptr) {
     new RPCState<TensorResponse>(
-        &stub_, cq_, method, *request, response, std::move(done), call_opts,
+        stub == nullptr ? &stub_ : stub, cq_, method, *request, response,
+        std::move(done), call_opts,
         callback_threadpool_, MaxRetries(),
         /*fail_fast=*/true, &target_,
         // Use optimized proto parse function that avoids a copy.
@@ -312,8 +325,17 @@ class GrpcRemoteWorker : public WorkerInterface {
     return max_retries;
   }
 
+  // The stub for the RPCs that carry tensors.
+  ::grpc::GenericStub* BulkDataStub() {
+    return bulk_data_stub_ == nullptr ? &stub_ : bulk_data_stub_.get();
+  }
+
   SharedGrpcChannelPtr channel_;
   ::grpc::GenericStub stub_;
+  // Optional channel for the RPCs that carry tensors, so that they do not
+  // delay the other RPCs.
+  SharedGrpcChannelPtr bulk_data_channel_;
+  std::unique_ptr<::grpc::GenericStub> bulk_data_stub_;
   ::grpc::CompletionQueue* cq_;
   thread::ThreadPool* callback_threadpool_;
 
@@ -346,9 +368,11 @@ WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
                                      ::grpc::CompletionQueue* completion_queue,
                                      thread::ThreadPool* callback_threadpool,
                                      WorkerCacheLogger* logger,
-                                     const string& target) {
+                                     const string& target,
+                                     SharedGrpcChannelPtr bulk_data_channel) {
   return new GrpcRemoteWorker(std::move(channel), completion_queue,
-                              callback_threadpool, logger, target);
+                              callback_threadpool, logger, target,
+                              std::move(bulk_data_channel));
 }
 
 }  // namespace tensorflow
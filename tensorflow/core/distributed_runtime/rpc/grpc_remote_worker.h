@@ -26,11 +26,12 @@ namespace tensorflow {
 class WorkerCacheLogger;
 class WorkerInterface;
 
-WorkerInterface* NewGrpcRemoteWorker(SharedGrpcChannelPtr channel,
-                                     ::grpc::CompletionQueue* completion_queue,
-                                     thread::ThreadPool* callback_threadpool,
-                                     WorkerCacheLogger* logger,
-                                     const string& target);
+// If `bulk_data_channel` is not nullptr, the RPCs that carry tensors
+// (RecvTensor and RecvBuf) are sent on it rather than on `channel`.
+WorkerInterface* NewGrpcRemoteWorker(
+    SharedGrpcChannelPtr channel, ::grpc::CompletionQueue* completion_queue,
+    thread::ThreadPool* callback_threadpool, WorkerCacheLogger* logger,
+    const string& target, SharedGrpcChannelPtr bulk_data_channel = nullptr);
 
 }  // namespace tensorflow
 
@@ -64,6 +64,17 @@ typedef std::function<std::unique_ptr<GrpcWorker>(WorkerEnv*,
                                                   const ConfigProto& config)>
     WorkerCreationFunction;
 
+// Options to customize a `GrpcServer`.
+//
+// These are the extension points for alternative tensor transports, such as
+// RDMA. A transport plugin registers a `ServerFactory` that accepts its own
+// protocol (conventionally "grpc+<transport>"), and creates a `GrpcServer`
+// subclass that calls `Init()` with a `rendezvous_mgr_func` and
+// `collective_mgr_func` of its own. Those move tensors over the transport,
+// while gRPC keeps carrying the control messages. A transport that needs
+// tensor memory registered up front can visit the regions of the host and
+// device allocators with `ProcessState::AddCPUAllocVisitor()` and
+// `GPUProcessState::AddGPUAllocVisitor()` before the first allocation.
 struct GrpcServerOptions {
   ServiceInitFunction service_func = nullptr;
   RendezvousMgrCreationFunction rendezvous_mgr_func = nullptr;
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <string>
+#include <vector>
+
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -24,12 +27,17 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
+#include "tensorflow/core/platform/coding.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
 namespace tensorflow {
 namespace grpc {
 
+// Tensor contents larger than this are shared with the encoded buffer instead
+// of copied into it.
+static constexpr int kLargeTensorBytes = 1024;
+
 void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
                                           ::grpc::ByteBuffer* result) {
   ::grpc::Slice slice(proto.ByteSizeLong());
@@ -134,9 +142,98 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
+// Appends the tag and varint length of a length-delimited field to "*out".
+static void AppendVarlengthBeginning(uint32 tag, uint64 bytes, string* out) {
+  core::PutVarint32(out, (tag << 3) | 2);  // WIRETYPE_LENGTH_DELIMITED
+  core::PutVarint64(out, bytes);
+}
+
+// Encodes the DT_STRING tensor "val" like the memcpy-able tensors below, but
+// with one TensorProto::string_val field per element instead of "D1" through
+// "E":
+//
+// F1:  <tag encoding for TensorProto::string_val>
+// F2:  <varint32 length of the element>
+// F3:  <the bytes of the element>
+//
+// The F1 and F2 headers serve as the offset table of the elements. Elements
+// of up to "kLargeTensorBytes" are copied next to their headers, and larger
+// elements are shared with the backing store of "val" in grpc::Slices of
+// their own. This matches the protocol buffer encoding of
+// "val.AsProtoField()", without building the TensorProto first.
+static void EncodeStringTensorToByteBuffer(const string& header,
+                                           const Tensor& val,
+                                           ::grpc::ByteBuffer* result) {
+  gtl::InlinedVector<char, 128> skeleton(SkeletonEncodingSizeUpperBound(val));
+  io::ProtoEncodeHelper e_skeleton(skeleton.data(), skeleton.size());
+  EncodeSkeleton(val, &e_skeleton);
+
+  const auto strings = val.flat<tstring>();
+  uint64 overall_tensor_proto_bytesize = e_skeleton.size();
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    overall_tensor_proto_bytesize += VarLengthEncodingSize(
+        TensorProto::kStringValFieldNumber, strings(i).size());
+  }
+  const uint64 expected_size =
+      header.size() +
+      core::VarintLength(RecvTensorResponse::kTensorFieldNumber << 3) +
+      core::VarintLength(overall_tensor_proto_bytesize) +
+      overall_tensor_proto_bytesize;
+  if (expected_size > static_cast<uint64>(kint32max)) {
+    LOG(FATAL) << "Cannot encode a string Tensor that exceeds the 2GB "
+                  "protobuf limit. Encoded bytes: "
+               << expected_size
+               << ", tensor shape: " << val.shape().AsProto().DebugString();
+  }
+
+  const TensorBuffer* buf = DMAHelper::buffer(&val);
+  std::vector<::grpc::Slice> slices;
+  string pending;  // Bytes to copy into the next grpc::Slice.
+  auto flush = [&slices, &pending]() {
+    if (pending.empty()) return;
+    slices.emplace_back(pending.data(), pending.size());
+    pending.clear();
+  };
+  // (A)
+  pending.append(header);
+  // (B1) & (B2)
+  AppendVarlengthBeginning(RecvTensorResponse::kTensorFieldNumber,
+                           overall_tensor_proto_bytesize, &pending);
+  // (C)
+  pending.append(e_skeleton.data(), e_skeleton.size());
+  for (int64_t i = 0; i < strings.size(); ++i) {
+    const tstring& element = strings(i);
+    // (F1) & (F2)
+    AppendVarlengthBeginning(TensorProto::kStringValFieldNumber,
+                             element.size(), &pending);
+    // (F3)
+    if (element.size() <= kLargeTensorBytes) {
+      pending.append(element.data(), element.size());
+      continue;
+    }
+    // The bytes of the element are owned by the elements in "buf", which
+    // stay alive as long as "buf" is referenced.
+    flush();
+    buf->Ref();
+    slices.emplace_back(
+        const_cast<char*>(element.data()), element.size(),
+        [](void* backing) { static_cast<TensorBuffer*>(backing)->Unref(); },
+        const_cast<TensorBuffer*>(buf));
+  }
+  flush();
+
+  size_t total_bytes = 0;
+  for (const ::grpc::Slice& slice : slices) {
+    total_bytes += slice.size();
+  }
+  CHECK_EQ(total_bytes, expected_size);
+
+  ::grpc::ByteBuffer tmp(slices.data(), slices.size());
+  result->Swap(&tmp);
+}
+
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result) {
-  const int kLargeTensorBytes = 1024;
   const int64_t kProtoBufLimitBytes = 1LL << 31;
 
   if (val.TotalBytes() > kProtoBufLimitBytes) {
@@ -153,7 +250,11 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
   response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
-  if (!DataTypeCanUseMemcpy(val.dtype())) {
+  if (val.dtype() == DT_STRING) {
+    string header;  // All of RecvTensorResponse except the tensor() field
+    response.AppendToString(&header);
+    EncodeStringTensorToByteBuffer(header, val, result);
+  } else if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
     // TODO(jeff,sanjay): If this becomes an issue, we could
     // go directly from val -> ByteBuffer, with some effort.
@@ -100,4 +100,27 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(GrpcTensorCodingTest, LargeStrings) {
+  Tensor a(DT_STRING, TensorShape({2, 2}));
+  test::FillValues<tstring>(
+      &a, {string(5000, 'a'), "b", string(70000, 'c'), string(2000, 'd')});
+  Validate(a, false);
+
+  // The large elements are shared with the tensor rather than copied.
+  ::grpc::ByteBuffer buf;
+  grpc::EncodeTensorToByteBuffer(false, a, false, &buf);
+  std::vector<::grpc::Slice> slices;
+  ASSERT_TRUE(buf.Dump(&slices).ok());
+  int num_shared_slices = 0;
+  const auto strings = a.flat<tstring>();
+  for (const auto& s : slices) {
+    for (int i = 0; i < strings.size(); ++i) {
+      if (reinterpret_cast<const char*>(s.begin()) == strings(i).data()) {
+        ++num_shared_slices;
+      }
+    }
+  }
+  EXPECT_EQ(num_shared_slices, 3);
+}
+
 }  // namespace tensorflow
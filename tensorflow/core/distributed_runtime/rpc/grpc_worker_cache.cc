@@ -62,7 +62,8 @@ class GrpcWorkerCache : public WorkerCachePartial {
       size_t index = AssignWorkerToThread(target);
       return NewGrpcRemoteWorker(
           channel, worker_env_->GetCompletionQueue(index),
-          worker_env_->GetThreadPool(), &logger_, target);
+          worker_env_->GetThreadPool(), &logger_, target,
+          channel_cache_->FindBulkDataChannel(target));
     }
   }
 
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <memory>
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -23,10 +26,12 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/distributed_runtime/worker_session.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
@@ -38,8 +43,10 @@ namespace {
 
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      std::shared_ptr<StaleRecvTensorCache> stale_recv_cache)
+      : BaseRemoteRendezvous(env, step_id),
+        stale_recv_cache_(std::move(stale_recv_cache)) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +56,8 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  const std::shared_ptr<StaleRecvTensorCache> stale_recv_cache_;
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -236,6 +245,19 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
   CHECK(is_initialized());
   Status s;
 
+  // Serve receivers that tolerate staleness from the values received in
+  // previous steps, if they are recent enough.
+  string stale_recv_key;
+  if (recv_args.max_staleness_steps > 0) {
+    stale_recv_key = strings::StrCat(session()->session_name(), ";",
+                                     parsed.FullKey());
+    Tensor val;
+    if (stale_recv_cache_->Lookup(stale_recv_key, &val)) {
+      done(OkStatus(), Args(), recv_args, val, /*is_dead=*/false);
+      return;
+    }
+  }
+
   // Prepare a RecvTensor call that can handle being aborted.
   RpcRecvTensorCall* call = get_call_freelist()->New();
 
@@ -289,12 +311,17 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  call->Start([this, call, recv_args, worker_cache,
+               stale_recv_key = std::move(stale_recv_key)]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
     // current status should be bad.
     Status s = call->status();
+    if (s.ok() && !stale_recv_key.empty() && !call->is_dead()) {
+      stale_recv_cache_->Insert(stale_recv_key, call->tensor(),
+                                recv_args.max_staleness_steps);
+    }
     // NOTE: `*session()` can potentially be deleted before we return from
     // `call->done()(...)`, so we must release the worker before calling the
     // callback.
@@ -307,13 +334,44 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
 }  // namespace
 
+bool StaleRecvTensorCache::Lookup(const string& key, Tensor* val) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  *val = it->second.val;
+  if (--it->second.remaining_steps <= 0) entries_.erase(it);
+  return true;
+}
+
+void StaleRecvTensorCache::Insert(const string& key, const Tensor& val,
+                                  int64_t max_staleness_steps) {
+  mutex_lock l(mu_);
+  if (entries_.size() >= kMaxEntries && !entries_.contains(key)) {
+    VLOG(1) << "Dropping " << entries_.size()
+            << " values cached for receivers that tolerate staleness";
+    entries_.clear();
+  }
+  entries_[key] = Entry{val, max_staleness_steps};
+}
+
+void StaleRecvTensorCache::Clear() {
+  mutex_lock l(mu_);
+  entries_.clear();
+}
+
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env),
+      stale_recv_cache_(std::make_shared<StaleRecvTensorCache>()) {}
+
+void RpcRendezvousMgr::CleanupAll() {
+  BaseRendezvousMgr::CleanupAll();
+  stale_recv_cache_->Clear();
+}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, stale_recv_cache_));
 }
 
 }  // end namespace tensorflow
@@ -16,14 +16,62 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
 class DeviceMgr;
 
+// Caches the values received from remote workers for keys whose receivers
+// tolerate bounded staleness, i.e. whose `Rendezvous::Args` have a positive
+// `max_staleness_steps`.  A value received in one step is given to the
+// receivers of the same key in up to `max_staleness_steps` following steps,
+// which then do not issue a RecvTensor RPC.
+//
+// Keys should be qualified by the worker session, so that values are never
+// given to the receivers of another session.  The values of sessions that
+// are gone are dropped once the cache holds `kMaxEntries` values.
+//
+// This class is thread-safe.
+class StaleRecvTensorCache {
+ public:
+  static constexpr size_t kMaxEntries = 1 << 16;
+
+  StaleRecvTensorCache() = default;
+
+  // Returns true and sets `*val` if a value received for `key` may still be
+  // given to one more step.
+  bool Lookup(const string& key, Tensor* val);
+
+  // Caches `val`, just received for `key`, for the next `max_staleness_steps`
+  // steps.
+  void Insert(const string& key, const Tensor& val,
+              int64_t max_staleness_steps);
+
+  void Clear();
+
+ private:
+  struct Entry {
+    Tensor val;
+    int64_t remaining_steps;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<string, Entry> entries_ TF_GUARDED_BY(mu_);
+
+  StaleRecvTensorCache(const StaleRecvTensorCache&) = delete;
+  void operator=(const StaleRecvTensorCache&) = delete;
+};
+
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
 // until the tensor is received.  Each global unique "step_id"
@@ -46,11 +94,16 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
 
+  // Also drops the values cached for receivers that tolerate staleness.
+  void CleanupAll() override;
+
  protected:
   tsl::core::RefCountPtr<BaseRemoteRendezvous> Create(
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  const std::shared_ptr<StaleRecvTensorCache> stale_recv_cache_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -57,6 +59,7 @@ class DummyWorker : public TestWorkerInterface {
  public:
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override {
+    ++num_recv_tensor_calls;
     SchedClosure([done = std::move(done)]() {
       // Simulate a random delay for RPC. This is needed to fill the entire
       // object buffer in `RpcRecvTensorFreeList` and trigger the destruction of
@@ -66,6 +69,8 @@ class DummyWorker : public TestWorkerInterface {
       done(OkStatus());
     });
   }
+
+  std::atomic<int> num_recv_tensor_calls{0};
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -95,6 +100,13 @@ class DummyWorkerCache : public WorkerCacheInterface {
   void GetDeviceLocalityAsync(const string& device, DeviceLocality* locality,
                               StatusCallback done) override {}
 
+ public:
+  int num_recv_tensor_calls() const {
+    return dummy_remote_worker_ == nullptr
+               ? 0
+               : dummy_remote_worker_->num_recv_tensor_calls.load();
+  }
+
  private:
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
@@ -342,4 +354,62 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvWithStaleness) {
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  Rendezvous::Args args;
+  args.max_staleness_steps = 2;
+  // The value received in the first step is reused by the next two steps.
+  const int expected_calls[] = {1, 1, 1, 2};
+  for (int64_t step_id = 0; step_id < 4; ++step_id) {
+    {
+      tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr_.Find(step_id);
+      TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+      Tensor val(DT_STRING);
+      bool val_dead = false;
+      TF_ASSERT_OK(rendez->Recv(key, args, &val, &val_dead));
+      EXPECT_FALSE(val_dead);
+    }
+    rmgr_.Cleanup(step_id);
+    EXPECT_EQ(expected_calls[step_id], cache_->num_recv_tensor_calls());
+  }
+}
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvWithoutStaleness) {
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  for (int64_t step_id = 0; step_id < 3; ++step_id) {
+    {
+      tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr_.Find(step_id);
+      TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+      Rendezvous::Args args;
+      Tensor val(DT_STRING);
+      bool val_dead = false;
+      TF_ASSERT_OK(rendez->Recv(key, args, &val, &val_dead));
+    }
+    rmgr_.Cleanup(step_id);
+  }
+  EXPECT_EQ(3, cache_->num_recv_tensor_calls());
+}
+
+TEST(StaleRecvTensorCacheTest, ExpiresAfterMaxStalenessSteps) {
+  StaleRecvTensorCache cache;
+  Tensor val;
+  EXPECT_FALSE(cache.Lookup("a", &val));
+  cache.Insert("a", V("x"), 2);
+  ASSERT_TRUE(cache.Lookup("a", &val));
+  EXPECT_EQ("x", V(val));
+  ASSERT_TRUE(cache.Lookup("a", &val));
+  EXPECT_EQ("x", V(val));
+  EXPECT_FALSE(cache.Lookup("a", &val));
+
+  cache.Insert("a", V("y"), 1);
+  cache.Insert("b", V("z"), 1);
+  cache.Clear();
+  EXPECT_FALSE(cache.Lookup("a", &val));
+  EXPECT_FALSE(cache.Lookup("b", &val));
+}
+
 }  // namespace tensorflow
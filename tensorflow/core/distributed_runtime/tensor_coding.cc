@@ -146,12 +146,19 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 bool TensorResponse::ParseTensorSubmessage(
     protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
+  // The number of TensorProto::string_val elements read into tensor_.
+  int64_t num_strings = 0;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
     int tag = GetTagFieldNumber(p.first);
     WireType wt = GetTagWireType(p.first);
     if (!p.second) {
       bool ok = (tag == 0);
+      if (ok && seen_tensor_content && tensor_meta->dtype() == DT_STRING &&
+          num_strings != tensor_.NumElements()) {
+        // Let the slow path fill in the missing elements.
+        return false;
+      }
       if (ok && !seen_tensor_content) {
         // No tensor content: could be because it's a zero-length tensor
         TensorShape shape(tensor_meta->tensor_shape());
@@ -166,7 +173,10 @@ bool TensorResponse::ParseTensorSubmessage(
         if ((wt != WIRETYPE_VARINT) || !input->ReadVarint32(&v)) return false;
         if (seen_tensor_content) return false;
         tensor_meta->set_dtype(static_cast<DataType>(static_cast<int>(v)));
-        if (!DataTypeCanUseMemcpy(tensor_meta->dtype())) return false;
+        if (!DataTypeCanUseMemcpy(tensor_meta->dtype()) &&
+            tensor_meta->dtype() != DT_STRING) {
+          return false;
+        }
         break;
       }
       case TensorProto::kTensorShapeFieldNumber: {
@@ -188,7 +198,8 @@ bool TensorResponse::ParseTensorSubmessage(
         // deal with this in the fast path.
         if (seen_tensor_content) return false;
         if (wt != WIRETYPE_LENGTH_DELIMITED ||
-            !tensor_meta->has_tensor_shape()) {
+            !tensor_meta->has_tensor_shape() ||
+            !DataTypeCanUseMemcpy(tensor_meta->dtype())) {
           return false;
         }
         int num_bytes;
@@ -206,6 +217,29 @@ bool TensorResponse::ParseTensorSubmessage(
         tensor_ = std::move(t);
         break;
       }
+      case TensorProto::kStringValFieldNumber: {
+        // Read each element directly into its place in tensor_, which is
+        // allocated when the first element arrives.
+        if (wt != WIRETYPE_LENGTH_DELIMITED ||
+            tensor_meta->dtype() != DT_STRING ||
+            !tensor_meta->has_tensor_shape()) {
+          return false;
+        }
+        if (!seen_tensor_content) {
+          if (!TensorShape::IsValid(tensor_meta->tensor_shape())) return false;
+          seen_tensor_content = true;
+          TensorShape shape(tensor_meta->tensor_shape());
+          Tensor t(allocator_, DT_STRING, shape);
+          tensor_ = std::move(t);
+        }
+        int num_bytes;
+        if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
+        if (num_strings >= tensor_.NumElements()) return false;
+        tstring& element = tensor_.flat<tstring>()(num_strings++);
+        element.resize_uninitialized(num_bytes);
+        if (!input->ReadRaw(element.mdata(), num_bytes)) return false;
+        break;
+      }
       default: {
         // Some other tag our fast path code is not prepared to handle.
         // return false.
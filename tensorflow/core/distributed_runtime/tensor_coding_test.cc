@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -156,6 +157,33 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, LargeStrings) {
+  Tensor a(DT_STRING, TensorShape({3}));
+  test::FillValues<tstring>(&a, {string(5000, 'a'), "", string(70000, 'b')});
+  Validate(a, false, true);
+}
+
+TEST_F(TensorResponseTest, FewerStringValsThanElements) {
+  // A TensorProto may hold fewer values than elements, in which case the last
+  // value is repeated.
+  RecvTensorResponse proto;
+  TensorProto* tensor = proto.mutable_tensor();
+  tensor->set_dtype(DT_STRING);
+  TensorShape({3}).AsProto(tensor->mutable_tensor_shape());
+  tensor->add_string_val("a");
+  tensor->add_string_val("b");
+  string encoded;
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+
+  TensorResponse response;
+  DummyDevice cpu_device(Env::Default());
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<tstring>(response.tensor(),
+                                   test::AsTensor<tstring>({"a", "b", "b"}));
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -35,6 +35,7 @@ namespace tensorflow {
 
 // NOLINTBEGIN(misc-unused-using-decls)
 using tsl::AllocationAttributes;
+using tsl::AllocationLifetime;
 using tsl::Allocator;
 using tsl::AllocatorAttributes;
 using tsl::AllocatorMemoryType;
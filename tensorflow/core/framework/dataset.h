@@ -1045,6 +1045,20 @@ class IteratorBase : public Checkpointable {
     return 0;
   }
 
+  // Returns the tunable parameters of all nodes in the subtree for which
+  // autotuning is enabled.
+  model::Node::ModelParameters TunableParameters() const {
+    if (node_) return node_->CollectTunableParameters();
+    return {};
+  }
+
+  // Returns the analysis of the bottlenecks of a snapshot of the subtree, see
+  // `model::AnalyzeBottlenecks()`.
+  model::BottleneckAnalysis AnalyzeBottlenecks() const {
+    if (node_) return model::AnalyzeBottlenecks(node_->Snapshot());
+    return {};
+  }
+
  protected:
   // Returns a node that models this iterator.
   virtual std::shared_ptr<model::Node> CreateNode(
@@ -51,6 +51,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class StepGraph;
+
 class Device : public DeviceBase {
  public:
   // Callback type that takes a Status and returns void.
@@ -156,6 +158,15 @@ class Device : public DeviceBase {
     return OkStatus();
   }
 
+  // Sets `*graph` to a new StepGraph that records the work of one step of a
+  // graph on this device, to replay it as a unit (see
+  // common_runtime/step_graph.h). Returns Unimplemented if the device does not
+  // support recording its work.
+  virtual Status CreateStepGraph(std::unique_ptr<StepGraph>* graph) {
+    return errors::Unimplemented(
+        "CreateStepGraph is not supported on this device.");
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
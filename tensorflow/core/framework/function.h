@@ -313,6 +313,13 @@ class CallFrameInterface {
   virtual bool CanConsumeArg(int index) const { return false; }
 
   virtual Status SetRetval(int index, const Tensor& val) = 0;
+
+  // Returns a caller-owned tensor that the kernel producing return value
+  // `index` may use as its output instead of allocating a new tensor, or
+  // nullptr if there is none. The buffer is in host memory, so the kernel only
+  // uses it if it runs on a CPU device, and if the type and shape match those
+  // of the output.
+  virtual const Tensor* GetRetvalBuffer(int index) const { return nullptr; }
 };
 
 // Represents a function call frame. I.e., the data structure used to
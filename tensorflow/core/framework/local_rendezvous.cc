@@ -29,12 +29,14 @@ limitations under the License.
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/types.h"
 #include "tsl/platform/logging.h"
 #include "tsl/platform/refcount.h"
+#include "tsl/profiler/lib/mutex_contention.h"
 
 namespace tensorflow {
 
@@ -118,6 +120,42 @@ void LocalRendezvous::ItemQueue::push_back(Item* item) {
   }
 }
 
+RendezvousSlotMap::RendezvousSlotMap(const std::vector<string>& keys) {
+  for (const string& key : keys) {
+    slots_.insert({KeyHash(key), slots_.size()});
+  }
+}
+
+uint64 RendezvousSlotMap::KeyHash(StringPiece full_key) {
+  return Hash64(full_key.data(), full_key.size());
+}
+
+LocalRendezvous::LocalRendezvous(
+    Rendezvous* owner, int num_shards,
+    std::shared_ptr<const RendezvousSlotMap> slot_map)
+    : num_buckets_(num_shards > 0 ? num_shards : 1),
+      rc_owner_(owner),
+      table_buckets_(std::make_unique<TableBucket[]>(num_buckets_)),
+      slot_map_(std::move(slot_map)),
+      slots_(slot_map_ == nullptr
+                 ? nullptr
+                 : std::make_unique<std::atomic<Item*>[]>(
+                       slot_map_->num_slots())) {
+  if (slots_ != nullptr) {
+    for (int i = 0; i < slot_map_->num_slots(); ++i) {
+      slots_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  // A rendezvous usually lives for a single step, so its buckets are only
+  // named while the contention is profiled.
+  if (tsl::profiler::MutexContentionProfilingEnabled()) {
+    for (int i = 0; i < num_buckets_; ++i) {
+      tsl::profiler::SetMutexName(&table_buckets_[i].mu, "LocalRendezvous");
+    }
+    buckets_named_ = true;
+  }
+}
+
 LocalRendezvous::~LocalRendezvous() {
   // Before destroying this rendezvous instance, make sure all the done-callback
   // calls have finished and the tensors have been released from the queue.
@@ -135,15 +173,208 @@ LocalRendezvous::~LocalRendezvous() {
       table_not_empty = true;
     }
   }
+  if (slots_ != nullptr) {
+    while (pending_slot_callbacks_.load(std::memory_order_acquire) != 0) {
+      Env::Default()->SleepForMicroseconds(100);
+    }
+    for (int i = 0; i < slot_map_->num_slots(); ++i) {
+      Item* item = slots_[i].load(std::memory_order_acquire);
+      if (item != nullptr && item != ConsumedSlot()) {
+        table_not_empty = true;
+      }
+    }
+  }
   if (table_not_empty) {
     DoAbort(absl::CancelledError("LocalRendezvous deleted"));
   }
+  if (buckets_named_) {
+    for (int i = 0; i < num_buckets_; ++i) {
+      tsl::profiler::ClearMutexName(&table_buckets_[i].mu);
+    }
+  }
 }
 
 namespace {
-uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
+uint64 KeyHash(const StringPiece& k) { return RendezvousSlotMap::KeyHash(k); }
 }  // namespace
 
+bool LocalRendezvous::TrySend(int slot, const Rendezvous::ParsedKey& key,
+                              const Rendezvous::Args& send_args,
+                              const Tensor& val, bool is_dead) {
+  std::atomic<Item*>& s = slots_[slot];
+  Item* current = s.load(std::memory_order_acquire);
+  if (current == nullptr) {
+    // There is no waiter yet. Publish the message in the slot, where the
+    // waiter will pick it up when it arrives.
+    activity_watcher::ActivityScope activity_scope(
+        [&]() {
+          return std::make_unique<activity_watcher::Activity>(
+              "LocalRendezvous::Send",
+              activity_watcher::ActivityCategory::kRendezvous,
+              activity_watcher::Activity::Attributes{
+                  {"Rendezvous", absl::StrFormat("%p", this)},
+                  {"key", std::string(key.FullKey())},
+              });
+        },
+        /*level=*/1);
+    Item* item = new Item(tsl::core::GetNewRef(rc_owner_), send_args, val,
+                          is_dead, std::move(activity_scope));
+    if (s.compare_exchange_strong(current, item, std::memory_order_acq_rel,
+                                  std::memory_order_acquire)) {
+      // The cancellation callback may have run between its registration and
+      // the publication of `item`, and found the slot empty. Cancellation is
+      // in progress or done in that case, so take the waiter back out unless
+      // the callback or a Send already did.
+      if (cm != nullptr && (cm->IsCancelling() || cm->IsCancelled())) {
+        Item* expected = item;
+        if (s.compare_exchange_strong(expected, ConsumedSlot(),
+                                      std::memory_order_acq_rel)) {
+          (*item->recv_state.waiter)(
+              StatusGroup::MakeDerived(
+                  errors::Cancelled("RecvAsync is cancelled.")),
+              Rendezvous::Args(), item->args, Tensor(), /*is_dead=*/false);
+          delete item;
+        }
+      }
+      return true;
+    }
+    // The waiter arrived in the meantime.
+    delete item;
+  }
+  if (current == ConsumedSlot() || current->type == Item::kSend) {
+    return false;
+  }
+
+  // There is a waiter for this message. Take it out of the slot, unless it
+  // has been cancelled concurrently.
+  pending_slot_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  if (!s.compare_exchange_strong(current, ConsumedSlot(),
+                                 std::memory_order_acq_rel)) {
+    pending_slot_callbacks_.fetch_sub(1, std::memory_order_release);
+    return false;
+  }
+  DCHECK_EQ(current->type, Item::kRecv);
+  (*current->recv_state.waiter)(OkStatus(), send_args, current->args, val,
+                                is_dead);
+  pending_slot_callbacks_.fetch_sub(1, std::memory_order_release);
+  // Delete the item at last since it may unref and destruct the rendezvous.
+  delete current;
+  return true;
+}
+
+bool LocalRendezvous::TryRecv(int slot, const Rendezvous::ParsedKey& key,
+                              const Rendezvous::Args& recv_args,
+                              Rendezvous::DoneCallback* done) {
+  std::atomic<Item*>& s = slots_[slot];
+  Item* current = s.load(std::memory_order_acquire);
+  if (current == ConsumedSlot()) {
+    return false;
+  }
+
+  if (current == nullptr) {
+    // There is no message to pick up. Publish a waiter in the slot.
+    CancellationManager* cm = recv_args.cancellation_manager;
+    CancellationToken token = CancellationManager::kInvalidToken;
+    Rendezvous::DoneCallback waiter = std::move(*done);
+    if (cm != nullptr) {
+      token = cm->get_cancellation_token();
+      // NOTE: As in `RecvAsync()`, the cancellation callback must be
+      // deregistered before `done` is called.
+      waiter = [cm, token, done = std::move(waiter)](
+                   const Status& s, const Rendezvous::Args& send_args,
+                   const Rendezvous::Args& recv_args, const Tensor& v,
+                   bool dead) {
+        cm->TryDeregisterCallback(token);
+        done(s, send_args, recv_args, v, dead);
+      };
+    }
+    activity_watcher::ActivityScope activity_scope(
+        [&]() {
+          return std::make_unique<activity_watcher::Activity>(
+              "LocalRendezvous::RecvAsync",
+              activity_watcher::ActivityCategory::kRendezvous,
+              activity_watcher::Activity::Attributes{
+                  {"Rendezvous", absl::StrFormat("%p", this)},
+                  {"key", std::string(key.FullKey())},
+              });
+        },
+        /*level=*/1);
+    Item* item = new Item(tsl::core::GetNewRef(rc_owner_), recv_args,
+                          std::move(waiter), token, std::move(activity_scope));
+    const bool already_cancelled =
+        cm != nullptr && !cm->RegisterCallback(token, [this, item, &s] {
+          Item* expected = item;
+          if (s.compare_exchange_strong(expected, ConsumedSlot(),
+                                        std::memory_order_acq_rel)) {
+            (*item->recv_state.waiter)(
+                StatusGroup::MakeDerived(
+                    errors::Cancelled("RecvAsync is cancelled.")),
+                Rendezvous::Args(), item->args, Tensor(), /*is_dead=*/false);
+            delete item;
+          }
+        });
+    if (already_cancelled) {
+      (*item->recv_state.waiter)(
+          StatusGroup::MakeDerived(
+              errors::Cancelled("RecvAsync is cancelled.")),
+          Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+      delete item;
+      return true;
+    }
+    if (s.compare_exchange_strong(current, item, std::memory_order_acq_rel,
+                                  std::memory_order_acquire)) {
+      // The cancellation callback may have run between its registration and
+      // the publication of `item`, and found the slot empty. Cancellation is
+      // in progress or done in that case, so take the waiter back out unless
+      // the callback or a Send already did.
+      if (cm != nullptr && (cm->IsCancelling() || cm->IsCancelled())) {
+        Item* expected = item;
+        if (s.compare_exchange_strong(expected, ConsumedSlot(),
+                                      std::memory_order_acq_rel)) {
+          (*item->recv_state.waiter)(
+              StatusGroup::MakeDerived(
+                  errors::Cancelled("RecvAsync is cancelled.")),
+              Rendezvous::Args(), item->args, Tensor(), /*is_dead=*/false);
+          delete item;
+        }
+      }
+      return true;
+    }
+    // The message arrived in the meantime. Consume it below with the waiter
+    // in `item`.
+    *done = [item](const Status& s, const Rendezvous::Args& send_args,
+                   const Rendezvous::Args& recv_args, const Tensor& v,
+                   bool dead) {
+      (*item->recv_state.waiter)(s, send_args, recv_args, v, dead);
+      delete item;
+    };
+    if (current == ConsumedSlot() || current->type == Item::kRecv ||
+        !s.compare_exchange_strong(current, ConsumedSlot(),
+                                   std::memory_order_acq_rel)) {
+      // Only possible if the key was received twice in this step.
+      (*done)(errors::Internal("Rendezvous key ", key.FullKey(),
+                               " was received more than once in a step."),
+              Rendezvous::Args(), recv_args, Tensor(), /*is_dead=*/false);
+      return true;
+    }
+  } else if (current->type == Item::kRecv ||
+             !s.compare_exchange_strong(current, ConsumedSlot(),
+                                        std::memory_order_acq_rel)) {
+    return false;
+  }
+
+  // A message has already arrived in the slot. Consume it and invoke the done
+  // closure.
+  DCHECK_EQ(current->type, Item::kSend);
+  pending_slot_callbacks_.fetch_add(1, std::memory_order_relaxed);
+  (*done)(OkStatus(), current->args, recv_args, *current->send_state.value,
+          current->send_state.is_dead);
+  pending_slot_callbacks_.fetch_sub(1, std::memory_order_release);
+  // Delete the item at last since it may unref and destruct the rendezvous.
+  delete current;
+  return true;
+}
+
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
@@ -162,6 +393,13 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 
   TF_RETURN_IF_ERROR(status());
 
+  if (slots_ != nullptr) {
+    const int slot = slot_map_->Slot(key_hash);
+    if (slot >= 0 && TrySend(slot, key, send_args, val, is_dead)) {
+      return OkStatus();
+    }
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -237,6 +475,13 @@ void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
     return;
   }
 
+  if (slots_ != nullptr) {
+    const int slot = slot_map_->Slot(key_hash);
+    if (slot >= 0 && TryRecv(slot, key, recv_args, &done)) {
+      return;
+    }
+  }
+
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
   bucket.mu.lock();
@@ -405,6 +650,18 @@ void LocalRendezvous::DoAbort(const Status& status) {
 
   // Keeps one Item to make sure the current rendezvous won't be destructed.
   std::unique_ptr<Item> to_delete;
+  if (slots_ != nullptr) {
+    for (int i = 0; i < slot_map_->num_slots(); ++i) {
+      Item* item =
+          slots_[i].exchange(ConsumedSlot(), std::memory_order_acq_rel);
+      if (item == nullptr || item == ConsumedSlot()) continue;
+      if (item->type == Item::kRecv) {
+        (*item->recv_state.waiter)(status, Rendezvous::Args(),
+                                   Rendezvous::Args(), Tensor(), false);
+      }
+      to_delete.reset(item);
+    }
+  }
   for (int i = 0; i < num_buckets_; ++i) {
     auto& bucket = table_buckets_[i];
     Table table;
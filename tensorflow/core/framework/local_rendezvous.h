@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -30,6 +32,38 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Assigns a slot to each key of a fixed set of rendezvous keys that are known
+// before the step runs, e.g. the keys of the Send/Recv pairs that the graph
+// partitioner inserted in the root frame of a graph.
+//
+// Each key in the map must be sent at most once and received at most once per
+// step. A `LocalRendezvous` created with a slot map exchanges the values of
+// these keys through a preallocated slot array, with an atomic handoff between
+// the sender and the receiver, instead of the mutex-guarded table. Other keys
+// use the table as usual.
+//
+// A slot map is immutable, and may be shared by any number of rendezvous.
+class RendezvousSlotMap {
+ public:
+  // `keys` are full keys, as returned by `Rendezvous::CreateKey()`.
+  explicit RendezvousSlotMap(const std::vector<string>& keys);
+
+  int num_slots() const { return slots_.size(); }
+
+  // Returns the slot of the key with the given hash, or -1 if the key does not
+  // have a slot.
+  int Slot(uint64 key_hash) const {
+    auto it = slots_.find(key_hash);
+    return it == slots_.end() ? -1 : it->second;
+  }
+
+  // The hash of `full_key` used to index the table and the slot map.
+  static uint64 KeyHash(StringPiece full_key);
+
+ private:
+  absl::flat_hash_map<uint64, int> slots_;
+};
+
 // Implements the basic logic of matching Send and Recv operations. See
 // RendezvousInterface for more details.
 //
@@ -43,10 +77,12 @@ class LocalRendezvous {
   // Rendezvous), pass in its pointer in constructor so the LocalRendezvous
   // can make sure it outlives the async recv requests.
   // Pass in nullptr if the wrapping class is not refcounted.
-  explicit LocalRendezvous(Rendezvous* owner, int num_shards)
-      : num_buckets_(num_shards > 0 ? num_shards : 1),
-        rc_owner_(owner),
-        table_buckets_(std::make_unique<TableBucket[]>(num_buckets_)) {}
+  //
+  // If `slot_map` is not null, the keys in `slot_map` are exchanged through
+  // lock-free slots. See `RendezvousSlotMap`.
+  explicit LocalRendezvous(
+      Rendezvous* owner, int num_shards,
+      std::shared_ptr<const RendezvousSlotMap> slot_map = nullptr);
   ~LocalRendezvous();
 
   Status Send(const Rendezvous::ParsedKey& key,
@@ -71,6 +107,20 @@ class LocalRendezvous {
 
   struct Item;
 
+  // The value of a slot whose send and recv have been matched, or that can no
+  // longer be used in this step.
+  static Item* ConsumedSlot() { return reinterpret_cast<Item*>(uintptr_t{1}); }
+
+  // Exchanges the value of `key` through `slot`. Returns false if the slot
+  // cannot be used, in which case the caller must use the table. `TryRecv()`
+  // only consumes `*done` if it returns true.
+  bool TrySend(int slot, const Rendezvous::ParsedKey& key,
+               const Rendezvous::Args& send_args, const Tensor& val,
+               bool is_dead);
+  bool TryRecv(int slot, const Rendezvous::ParsedKey& key,
+               const Rendezvous::Args& recv_args,
+               Rendezvous::DoneCallback* done);
+
   // By invariant, the item queue under each key is of the form
   //   [item.type == kSend]* meaning each item is a sent message.
   // or
@@ -100,6 +150,15 @@ class LocalRendezvous {
 
   // Immutable set of buckets. This uses less memory than std::vector.
   const std::unique_ptr<TableBucket[]> table_buckets_;
+  // Whether the bucket mutexes are named in the contention profile.
+  bool buckets_named_ = false;
+
+  // The lock-free slots, if `slot_map_` is not null. Each slot is null, the
+  // first pending Send or Recv item of its key, or `ConsumedSlot()`.
+  const std::shared_ptr<const RendezvousSlotMap> slot_map_;
+  const std::unique_ptr<std::atomic<Item*>[]> slots_;
+  // The number of done callbacks invoked from a slot that have not returned.
+  std::atomic<int> pending_slot_callbacks_{0};
   mutex mu_;
   Status status_ TF_GUARDED_BY(mu_);
 
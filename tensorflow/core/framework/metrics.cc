@@ -52,6 +52,13 @@ auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* event_mgr_callback_delay_usecs = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/event_mgr_callback_delay_usecs",
+     "The time between the completion of device events and the start of "
+     "their EventMgr callbacks in microseconds."},
+    // Power of 2 with bucket count 20 (> 0.5 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 20)});
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -724,6 +731,12 @@ void UpdateGraphPendingQueueLength(uint64 len) {
   graph_pending_queue_length_cell->Add(len);
 }
 
+void UpdateEventMgrCallbackDelay(uint64 delay_usecs) {
+  static auto* event_mgr_callback_delay_usecs_cell =
+      event_mgr_callback_delay_usecs->GetCell();
+  event_mgr_callback_delay_usecs_cell->Add(delay_usecs);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
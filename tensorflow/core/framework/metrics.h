@@ -240,6 +240,10 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the time between the completion of the device events of EventMgr
+// and the start of their callbacks, in microseconds.
+void UpdateEventMgrCallbackDelay(uint64 delay_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
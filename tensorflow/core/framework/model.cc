@@ -22,6 +22,7 @@ limitations under the License.
 #include <optional>
 #include <queue>
 
+#include "absl/strings/str_join.h"
 #include "absl/time/clock.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -237,6 +238,11 @@ bool AreAllParametersMax(const Model::ModelParameters& parameters) {
   return true;
 }
 
+// Returns true if there is a target output time and `output_time` meets it.
+bool TargetOutputTimeReached(double target_output_time, double output_time) {
+  return target_output_time > 0 && output_time <= target_output_time;
+}
+
 // Records the ram usage of hill climbing algorithm.
 void RecordAutotuneRamUsage(int64 ram_budget, double max_buffered_bytes) {
   if (ram_budget == 0) {
@@ -2323,6 +2329,7 @@ void Model::Optimize(AutotuneAlgorithm algorithm,
   optimization_params.set_cpu_budget(cpu_budget_func());
   optimization_params.set_ram_budget(model_ram_budget);
   optimization_params.set_model_input_time(model_input_time);
+  optimization_params.set_target_output_time(target_output_time_nsec_);
   switch (algorithm) {
     case AutotuneAlgorithm::DEFAULT:
     case AutotuneAlgorithm::MAX_PARALLELISM:
@@ -3060,6 +3067,8 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
         output_time < processing_time / optimization_params.cpu_budget();
     const bool ram_budget_exceeded =
         buffered_bytes > optimization_params.ram_budget();
+    const bool target_reached = TargetOutputTimeReached(
+        optimization_params.target_output_time(), output_time);
     if (all_max) {
       metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
     }
@@ -3069,7 +3078,11 @@ void Model::OptimizeHillClimb(std::shared_ptr<Node> snapshot,
     if (ram_budget_exceeded) {
       metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
     }
-    return all_max || output_time_budget_exceeded || ram_budget_exceeded;
+    if (target_reached) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("target_output_time");
+    }
+    return all_max || output_time_budget_exceeded || ram_budget_exceeded ||
+           target_reached;
   };
   OptimizeHillClimbHelper(snapshot, optimization_params, cancellation_manager,
                           optimization_params.ram_budget(), ram_budget_manager,
@@ -3088,13 +3101,18 @@ void Model::OptimizeMaxParallelism(
     const bool all_max = AreAllParametersMax(parameters);
     const bool ram_budget_exceeded =
         buffered_bytes > optimization_params.ram_budget();
+    const bool target_reached = TargetOutputTimeReached(
+        optimization_params.target_output_time(), output_time);
     if (all_max) {
       metrics::RecordTFDataAutotuneStoppingCriteria("all_max");
     }
     if (ram_budget_exceeded) {
       metrics::RecordTFDataAutotuneStoppingCriteria("max_buffered_bytes");
     }
-    return all_max || ram_budget_exceeded;
+    if (target_reached) {
+      metrics::RecordTFDataAutotuneStoppingCriteria("target_output_time");
+    }
+    return all_max || ram_budget_exceeded || target_reached;
   };
   OptimizeHillClimbHelper(snapshot, optimization_params, cancellation_manager,
                           optimization_params.ram_budget(), ram_budget_manager,
@@ -3445,6 +3463,130 @@ std::vector<std::shared_ptr<Node>> ModelTiming::GetStageNodes(
   return CollectNodes(stage_root, TraversalOrder::BFS, IsSyncNode);
 }
 
+std::string BottleneckAnalysis::DebugString() const {
+  std::string result = strings::StrCat("Bottleneck: ", bottleneck, " (",
+                                       bottleneck_time_nsec, " ns)\n");
+  strings::StrAppend(&result, "Critical path: ",
+                     absl::StrJoin(critical_path, " -> "), "\n");
+  for (const NodeStall& node : nodes) {
+    strings::StrAppend(&result, node.name, ": self ", node.self_time_nsec,
+                       " ns, total ", node.total_time_nsec,
+                       " ns, blocked on input ", node.input_blocked_time_nsec,
+                       " ns, blocked on output ",
+                       node.output_blocked_time_nsec, " ns\n");
+  }
+  return result;
+}
+
+BottleneckAnalysis AnalyzeBottlenecks(std::shared_ptr<Node> root) {
+  BottleneckAnalysis analysis;
+  if (root == nullptr) {
+    return analysis;
+  }
+  ModelTiming model_timing(root);
+  // Returns the time it takes `node` and its subtree in the same stage to
+  // produce the elements needed to produce one element of the root.
+  auto total_time = [&model_timing](const Node* node) {
+    const ModelTiming::NodeTiming* timing = model_timing.GetTiming(node);
+    if (timing == nullptr) {
+      return 0.0;
+    }
+    return timing->total_time_nsec * timing->pipeline_ratio;
+  };
+
+  // Like the stage-based optimization, takes the stage with the largest total
+  // time as the one limiting the throughput of the pipeline.
+  std::shared_ptr<Node> bottleneck;
+  absl::flat_hash_map<const Node*, const Node*> stage_roots;
+  for (const auto& stage_root : model_timing.GetStageRoots()) {
+    for (const auto& node : model_timing.GetStageNodes(stage_root)) {
+      stage_roots[node.get()] = stage_root.get();
+    }
+    if (bottleneck == nullptr ||
+        total_time(stage_root.get()) > total_time(bottleneck.get())) {
+      bottleneck = stage_root;
+    }
+  }
+  const double bottleneck_time = total_time(bottleneck.get());
+  if (bottleneck_time <= 0.0) {
+    return analysis;
+  }
+  analysis.bottleneck = bottleneck->long_name();
+  analysis.bottleneck_time_nsec = bottleneck_time;
+  auto stage_time = [&](const Node* node) {
+    auto it = stage_roots.find(node);
+    return it == stage_roots.end() ? bottleneck_time : total_time(it->second);
+  };
+
+  Node::NodeVector nodes = root->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.insert(nodes.begin(), root);
+  absl::flat_hash_map<const Node*, BottleneckAnalysis::NodeStall*> stalls;
+  analysis.nodes.resize(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const ModelTiming::NodeTiming* timing =
+        model_timing.GetTiming(nodes[i].get());
+    BottleneckAnalysis::NodeStall& stall = analysis.nodes[i];
+    stall.name = nodes[i]->long_name();
+    if (timing != nullptr) {
+      stall.self_time_nsec = timing->self_time_nsec * timing->pipeline_ratio;
+      stall.total_time_nsec = timing->total_time_nsec * timing->pipeline_ratio;
+      // A synchronous input runs in the thread of its output, which waits for
+      // it.
+      stall.input_blocked_time_nsec =
+          std::max(0.0, stall.total_time_nsec - stall.self_time_nsec);
+    }
+    stalls[nodes[i].get()] = &stall;
+  }
+
+  // The consumers of the asynchronous nodes between the bottleneck and the
+  // root wait for the elements of the bottleneck, while they would keep up
+  // with a faster stage.
+  std::vector<const Node*> path_to_bottleneck = {bottleneck.get()};
+  absl::flat_hash_set<const Node*> downstream_of_bottleneck;
+  for (const Node* node = bottleneck.get();
+       node != root.get() && node->output() != nullptr;
+       node = node->output()) {
+    const Node* output = node->output();
+    downstream_of_bottleneck.insert(output);
+    path_to_bottleneck.push_back(output);
+    if (node->IsAsync() && stalls.contains(output)) {
+      stalls[output]->input_blocked_time_nsec +=
+          std::max(0.0, bottleneck_time - stage_time(output));
+    }
+  }
+  // All the other stages produce elements faster than they are consumed, so
+  // they end up waiting for room in their buffers.
+  for (const auto& node : nodes) {
+    if (node->IsAsync() && node != bottleneck &&
+        !downstream_of_bottleneck.contains(node.get())) {
+      stalls[node.get()]->output_blocked_time_nsec =
+          std::max(0.0, bottleneck_time - total_time(node.get()));
+    }
+  }
+
+  for (auto it = path_to_bottleneck.rbegin(); it != path_to_bottleneck.rend();
+       ++it) {
+    analysis.critical_path.push_back((*it)->long_name());
+  }
+  for (std::shared_ptr<Node> node = bottleneck; node != nullptr;) {
+    std::shared_ptr<Node> slowest_input;
+    for (const auto& input : node->inputs()) {
+      if (!input->IsAsync() &&
+          (slowest_input == nullptr ||
+           total_time(input.get()) > total_time(slowest_input.get()))) {
+        slowest_input = input;
+      }
+    }
+    if (slowest_input != nullptr && total_time(slowest_input.get()) > 0.0) {
+      analysis.critical_path.push_back(slowest_input->long_name());
+    } else {
+      slowest_input = nullptr;
+    }
+    node = slowest_input;
+  }
+  return analysis;
+}
+
 }  // namespace model
 }  // namespace data
 }  // namespace tensorflow
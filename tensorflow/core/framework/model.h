@@ -922,6 +922,14 @@ class Model {
     experiments_.insert(experiment);
   }
 
+  // Sets the throughput, in elements per second, at which the autotuning
+  // optimization stops increasing tunable parameters. If 0, the optimization
+  // aims for the highest throughput the CPU and RAM budgets allow.
+  void SetTargetThroughput(double target_throughput) {
+    target_output_time_nsec_ =
+        target_throughput > 0 ? 1.0e9 / target_throughput : 0.0;
+  }
+
   // Adds a node with the given name and given parent.
   void AddNode(Node::Factory factory, const string& name,
                std::shared_ptr<Node> parent, std::shared_ptr<Node>* out_node)
@@ -1075,9 +1083,10 @@ class Model {
   // This optimization algorithm starts by setting all tunable parallelism
   // parameters to the minimum value. It then repeatedly identifies the
   // parameter whose increase in parallelism decreases the output time the most.
-  // This process is repeated until all parameters reach their maximum values or
+  // This process is repeated until all parameters reach their maximum values,
   // the projected output time is less than or equal to the processing time
-  // needed to produce an element divided by CPU budget.
+  // needed to produce an element divided by CPU budget, or the projected output
+  // time meets the target output time.
   void OptimizeHillClimb(std::shared_ptr<Node> snapshot,
                          const OptimizationParams& optimization_params,
                          CancellationManager* cancellation_manager,
@@ -1085,7 +1094,8 @@ class Model {
 
   // This optimization behaves similarly to the hill climb optimization but uses
   // a relaxed stoping condition, allowing the optimization to oversubscribe
-  // CPU.
+  // CPU. It still stops once the projected output time meets the target output
+  // time.
   void OptimizeMaxParallelism(std::shared_ptr<Node> snapshot,
                               const OptimizationParams& optimization_params,
                               CancellationManager* cancellation_manager,
@@ -1182,6 +1192,9 @@ class Model {
   std::deque<uint64_t> gap_times_usec_ TF_GUARDED_BY(gap_mu_);
   // The experiment that this job is part of.
   absl::flat_hash_set<std::string> experiments_;
+  // The output time in nanoseconds that is good enough for the consumer of the
+  // pipeline, or 0 if there is no target.
+  double target_output_time_nsec_ = 0.0;
   // Stores the optimization snapshot of the Model.
   std::shared_ptr<Node> snapshot_ TF_GUARDED_BY(mu_);
   // Stores the optimization parameters used by autotune.
@@ -1257,6 +1270,51 @@ class ModelTiming {
   absl::flat_hash_map<const Node*, NodeTiming> timing_nodes_;
 };
 
+// Attributes the time an input pipeline spends blocked to its nodes, based on
+// the `ModelTiming` of a model snapshot.
+//
+// The stages of a pipeline, delimited by its asynchronous nodes (see
+// `ModelTiming::GetStageRoots()`), run concurrently. At steady state, they all
+// produce elements at the pace of the slowest stage, the bottleneck: the
+// stages downstream of the bottleneck are blocked on their input, and the other
+// stages are blocked on their output once their buffers are full.
+struct BottleneckAnalysis {
+  struct NodeStall {
+    // The long name of the node.
+    std::string name;
+    // The self and total time it takes the node to produce the elements needed
+    // to produce one element of the root of the pipeline.
+    double self_time_nsec = 0.0;
+    double total_time_nsec = 0.0;
+    // The time the node is blocked waiting for its inputs to produce the
+    // elements needed to produce one element of the root of the pipeline.
+    double input_blocked_time_nsec = 0.0;
+    // The time the node is blocked waiting for its buffer to be consumed, per
+    // element of the root of the pipeline.
+    double output_blocked_time_nsec = 0.0;
+  };
+
+  // The nodes of the pipeline, in BFS order.
+  std::vector<NodeStall> nodes;
+  // The long name of the root of the stage which limits the throughput of the
+  // pipeline, or empty if the pipeline has no timing yet.
+  std::string bottleneck;
+  // The time the bottleneck stage takes to produce the elements needed to
+  // produce one element of the root of the pipeline.
+  double bottleneck_time_nsec = 0.0;
+  // The long names of the nodes from the root of the pipeline to the
+  // bottleneck, followed by the slowest inputs of the nodes of the bottleneck
+  // stage.
+  std::vector<std::string> critical_path;
+
+  // Returns a human-readable summary of the analysis.
+  std::string DebugString() const;
+};
+
+// Analyzes the bottlenecks of the pipeline rooted at `root`, which should be a
+// snapshot (see `Node::Snapshot()`) if the pipeline is running.
+BottleneckAnalysis AnalyzeBottlenecks(std::shared_ptr<Node> root);
+
 }  // namespace model
 }  // namespace data
 }  // namespace tensorflow
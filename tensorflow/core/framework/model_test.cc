@@ -1360,6 +1360,56 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+class OptimizeTargetThroughputTest
+    : public ::testing::TestWithParam<model::AutotuneAlgorithm> {};
+
+TEST_P(OptimizeTargetThroughputTest, Model) {
+  const model::AutotuneAlgorithm algorithm = GetParam();
+  constexpr int64_t kMaxParallelism = 16;
+
+  auto optimize = [algorithm](double target_throughput) {
+    std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+    std::shared_ptr<condition_variable> cv1 =
+        std::make_shared<condition_variable>();
+    std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+        {1, "1", nullptr}, 1,
+        {model::MakeParameter("parallelism",
+                              std::make_shared<SharedState>(
+                                  /*value=*/model::kAutotune, mutex1, cv1),
+                              /*min=*/1, /*max=*/kMaxParallelism)});
+    node1->record_buffer_event(1, 1);
+    node1->add_processing_time(1000);
+    node1->record_element();
+
+    model::Model model;
+    model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                  nullptr, &node1);
+    model.SetTargetThroughput(target_throughput);
+
+    CancellationManager cancellation_manager;
+    RamBudgetManager ram_budget_manager(1 << 30);
+    model.Optimize(algorithm, CpuBudgetFunc(kMaxParallelism),
+                   /*ram_budget_share=*/1.0,
+                   /*fixed_ram_budget=*/1 << 30,
+                   /*model_input_time=*/0, ram_budget_manager,
+                   &cancellation_manager);
+    return node1->parameter_value("parallelism");
+  };
+
+  // Without a target, autotuning uses as much parallelism as it finds useful.
+  const double untargeted_parallelism = optimize(/*target_throughput=*/0);
+  // An element takes 1us to produce, so 2M elements per second need at least
+  // two threads, but far fewer than are available.
+  const double targeted_parallelism = optimize(/*target_throughput=*/2.0e6);
+  EXPECT_GE(targeted_parallelism, 2);
+  EXPECT_LT(targeted_parallelism, untargeted_parallelism);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Test, OptimizeTargetThroughputTest,
+    ::testing::Values(model::AutotuneAlgorithm::HILL_CLIMB,
+                      model::AutotuneAlgorithm::MAX_PARALLELISM));
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -3548,6 +3598,162 @@ TEST(RamBudgetManagerTest, RequestAllocationsWithBudgetAdjustment) {
   EXPECT_TRUE(rbm.RequestLegacyPrefetchBytes(4));
 }
 
+TEST_F(ModelTimingTest, AnalyzeBottlenecks) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 10000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 100000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+        parameters: {
+          name: "parallelism"
+          value: 4
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 40000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 4
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 4
+      value: {
+        id: 4
+        name: "TensorSlice"
+        autotune: true
+        num_elements: 100
+        processing_time: 10000
+        node_class: KNOWN_RATIO
+        ratio: 1
+      }
+    }
+    output: 1
+  )pb");
+
+  // The stage times are 100ns for {1}, 250ns for {2} and 400 + 100ns for
+  // {3, 4}.
+  BottleneckAnalysis analysis = AnalyzeBottlenecks(model_->output());
+  EXPECT_EQ(analysis.bottleneck, GetNode(/*node_id=*/3)->long_name());
+  EXPECT_DOUBLE_EQ(analysis.bottleneck_time_nsec, 500.0);
+  EXPECT_THAT(analysis.critical_path,
+              ::testing::ElementsAre(GetNode(/*node_id=*/1)->long_name(),
+                                     GetNode(/*node_id=*/2)->long_name(),
+                                     GetNode(/*node_id=*/3)->long_name(),
+                                     GetNode(/*node_id=*/4)->long_name()));
+
+  ASSERT_EQ(analysis.nodes.size(), 4);
+  EXPECT_EQ(analysis.nodes[0].name, GetNode(/*node_id=*/1)->long_name());
+  EXPECT_DOUBLE_EQ(analysis.nodes[0].total_time_nsec, 100.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[0].input_blocked_time_nsec, 400.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[0].output_blocked_time_nsec, 0.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[1].input_blocked_time_nsec, 250.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[1].output_blocked_time_nsec, 0.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[2].self_time_nsec, 400.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[2].total_time_nsec, 500.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[2].input_blocked_time_nsec, 100.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[2].output_blocked_time_nsec, 0.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[3].input_blocked_time_nsec, 0.0);
+}
+
+TEST_F(ModelTimingTest, AnalyzeBottlenecksOfUpstreamStages) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 100000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "ParallelMapV2"
+        autotune: true
+        num_elements: 100
+        processing_time: 30000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        parameters: {
+          name: "parallelism"
+          value: 1
+          min: 1
+          max: 16
+          tunable: true
+        }
+      }
+    }
+    output: 1
+  )pb");
+
+  BottleneckAnalysis analysis = AnalyzeBottlenecks(model_->output());
+  EXPECT_EQ(analysis.bottleneck, GetNode(/*node_id=*/1)->long_name());
+  EXPECT_THAT(analysis.critical_path,
+              ::testing::ElementsAre(GetNode(/*node_id=*/1)->long_name()));
+  ASSERT_EQ(analysis.nodes.size(), 2);
+  EXPECT_DOUBLE_EQ(analysis.nodes[0].input_blocked_time_nsec, 0.0);
+  EXPECT_DOUBLE_EQ(analysis.nodes[1].output_blocked_time_nsec, 700.0);
+}
+
+TEST(AnalyzeBottlenecksTest, NoTiming) {
+  EXPECT_TRUE(AnalyzeBottlenecks(nullptr).bottleneck.empty());
+  std::shared_ptr<Node> node = MakeUnknownNode({0, "unknown", nullptr});
+  BottleneckAnalysis analysis = AnalyzeBottlenecks(node);
+  EXPECT_TRUE(analysis.bottleneck.empty());
+  EXPECT_TRUE(analysis.critical_path.empty());
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
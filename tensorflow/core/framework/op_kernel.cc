@@ -15,15 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>  // NOLINT
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/match.h"
 #include "tensorflow/core/framework/allocation_description.pb.h"
@@ -31,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_factory.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/kernel_def.pb.h"
 #include "tensorflow/core/framework/kernel_def_util.h"
@@ -41,11 +45,13 @@ limitations under the License.
 #include "tensorflow/core/framework/node_properties.h"
 #include "tensorflow/core/framework/op_def_util.h"
 #include "tensorflow/core/framework/tensor_reference.h"
+#include "tensorflow/core/framework/temp_arena_allocator.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -760,12 +766,18 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
-  Tensor new_tensor(
-      a, type, shape,
-      AllocationAttributes(
-          /*retry_on_failure=*/allocation_attr.retry_on_failure,
-          /*allocation_will_be_logged=*/true, allocation_attr.freed_by_func));
+  return allocate_tensor(get_allocator(attr), type, shape, out_tensor,
+                         allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
+  AllocationAttributes logged_allocation_attr(
+      /*retry_on_failure=*/allocation_attr.retry_on_failure,
+      /*allocation_will_be_logged=*/true, allocation_attr.freed_by_func);
+  logged_allocation_attr.lifetime = allocation_attr.lifetime;
+  Tensor new_tensor(a, type, shape, logged_allocation_attr);
 
   if (!new_tensor.IsInitialized()) {
     return errors::ResourceExhausted(
@@ -815,11 +827,32 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
           " more than once.  Try turning off the ScopedAllocator optimizer.");
     }
   }
+  if (params_->output_retval_index_array != nullptr &&
+      params_->output_retval_index_array[index] >= 0 &&
+      params_->call_frame != nullptr && attr.scope_id == 0 &&
+      params_->device->device_type() == DEVICE_CPU) {
+    // Write the output directly into the caller's buffer for the return value.
+    // The buffer is in host memory, which only the kernels of CPU devices
+    // write their outputs to in general.
+    const Tensor* buffer = params_->call_frame->GetRetvalBuffer(
+        params_->output_retval_index_array[index]);
+    if (buffer != nullptr && buffer->dtype() == type &&
+        buffer->shape() == shape && buffer->IsAligned()) {
+      outputs_[index] = TensorValue(new Tensor(*buffer));
+      *output = outputs_[index].tensor;
+      return OkStatus();
+    }
+  }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "output", type,
       [&shape]() { return shape.DebugString(); });
   auto output_tensor = std::make_unique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  AllocationAttributes allocation_attr;
+  if (params_->output_lifetime_array != nullptr) {
+    allocation_attr.lifetime = params_->output_lifetime_array[index];
+  }
+  Status s = allocate_tensor(type, shape, output_tensor.get(), attr,
+                             allocation_attr);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -849,8 +882,13 @@ Status OpKernelContext::allocate_temp(
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel().name_view().data(), step_id(), "temp", type,
       [&shape]() { return shape.DebugString(); });
-  Status s =
-      allocate_tensor(type, shape, out_temp, allocator_attr, allocation_attr);
+  Allocator* a = get_allocator(allocator_attr);
+  if (allocator_attr.scratch() && !track_allocations() &&
+      a->GetMemoryType() == AllocatorMemoryType::kHostPageable) {
+    TempArenaAllocator* arena = TempArenaAllocator::ForCurrentThread(a);
+    if (arena != nullptr) a = arena;
+  }
+  Status s = allocate_tensor(a, type, shape, out_temp, allocation_attr);
   if (track_allocations() && s.ok() && out_temp->TotalBytes() > 0) {
     Allocator* a = get_allocator(allocator_attr);
     if (a->TracksAllocationSizes()) {
@@ -1147,6 +1185,16 @@ struct KernelRegistration {
   std::unique_ptr<kernel_factory::OpKernelFactory> factory;
 };
 
+// The result of a successful kernel lookup, for the lookup cache.
+struct KernelLookupResult {
+  const KernelRegistration* reg;
+  bool was_attr_mismatch;
+};
+
+// The key of the lookup cache: the registry key of the kernels, and a hash of
+// the values of the attrs that their constraints depend on.
+using KernelLookupKey = std::pair<string, uint64>;
+
 // This maps from 'op_type' + DeviceType to the set of KernelDefs and
 // factory functions for instantiating the OpKernel that matches the
 // KernelDef.
@@ -1154,8 +1202,40 @@ struct KernelRegistry {
   mutex mu;
   std::unordered_multimap<string, KernelRegistration> registry
       TF_GUARDED_BY(mu);
+  // The names of the attrs constrained by the kernels of each key of
+  // `registry`. A lookup only depends on the values of these attrs.
+  std::unordered_map<string, std::vector<string>> constraint_attrs
+      TF_GUARDED_BY(mu);
+
+  // Memoizes the lookups by key and constrained attr values. Cleared whenever
+  // `registry` changes, which requires `mu` to be held exclusively.
+  mutex lookup_cache_mu;
+  absl::flat_hash_map<KernelLookupKey, KernelLookupResult> lookup_cache
+      TF_GUARDED_BY(lookup_cache_mu);
 };
 
+// Bounds the memory held by the lookup cache of the kernel registry.
+constexpr size_t kMaxKernelLookupCacheSize = 1 << 16;
+
+// Records the attrs constrained by `def`, registered under `key`.
+static void AddConstraintAttrs(const string& key, const KernelDef& def,
+                               KernelRegistry* registry)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(registry->mu) {
+  std::vector<string>& names = registry->constraint_attrs[key];
+  for (const auto& constraint : def.constraint()) {
+    if (std::find(names.begin(), names.end(), constraint.name()) ==
+        names.end()) {
+      names.push_back(constraint.name());
+    }
+  }
+}
+
+static void ClearLookupCache(KernelRegistry* registry)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(registry->mu) {
+  mutex_lock l(registry->lookup_cache_mu);
+  registry->lookup_cache.clear();
+}
+
 #if defined(_WIN32)
 static const char kKernelLibPattern[] = "libtfkernel*.dll";
 #elif defined(__APPLE__)
@@ -1295,6 +1375,12 @@ void SetupOrDisableJit(KernelRegistry* registry) {
   for (auto& jit_kernel : jit_kernels) {
     all_kernels.insert(std::move(jit_kernel));
   }
+
+  registry->constraint_attrs.clear();
+  for (const auto& p : all_kernels) {
+    AddConstraintAttrs(p.first, p.second.def, registry);
+  }
+  ClearLookupCache(registry);
 }
 
 namespace register_kernel {
@@ -1344,6 +1430,8 @@ void OpKernelRegistrar::InitInternal(const KernelDef* kernel_def,
   auto global_registry =
       reinterpret_cast<KernelRegistry*>(GlobalKernelRegistry());
   mutex_lock l(global_registry->mu);
+  AddConstraintAttrs(key, *kernel_def, global_registry);
+  ClearLookupCache(global_registry);
   global_registry->registry.emplace(
       key,
       KernelRegistration(*kernel_def, kernel_class_name, std::move(factory)));
@@ -1375,6 +1463,46 @@ const string& GetKernelLabelAttr(const AttrSlice& node_attrs) {
     return attr_value->s();
 }
 
+// Hashes the value of a constrained attr, or its absence if null. Nearly all
+// constraints are on types or lists of types, which are hashed from their
+// enum values rather than serialized.
+uint64 ConstraintAttrHash(const AttrValue* attr_value) {
+  if (attr_value == nullptr) return 0;
+  if (attr_value->value_case() == AttrValue::kType) {
+    return Hash64Combine(1, attr_value->type());
+  }
+  if (attr_value->value_case() == AttrValue::kList) {
+    const AttrValue::ListValue& list = attr_value->list();
+    if (list.s_size() == 0 && list.i_size() == 0 && list.f_size() == 0 &&
+        list.b_size() == 0 && list.shape_size() == 0 &&
+        list.tensor_size() == 0 && list.func_size() == 0) {
+      uint64 hash = Hash64Combine(2, list.type_size());
+      for (int type : list.type()) hash = Hash64Combine(hash, type);
+      return hash;
+    }
+  }
+  return FastAttrValueHash(*attr_value);
+}
+
+// Returns the key of the lookup cache for the kernels registered under `key`,
+// and `default_key` if not empty: `key` and a hash of the values of the attrs
+// that their constraints depend on.
+KernelLookupKey LookupCacheKey(const KernelRegistry& registry,
+                               const string& key, const string& default_key,
+                               AttrSlice node_attrs)
+    TF_SHARED_LOCKS_REQUIRED(registry.mu) {
+  uint64 hash = 0;
+  for (const string* registry_key : {&key, &default_key}) {
+    if (registry_key->empty()) continue;
+    auto it = registry.constraint_attrs.find(*registry_key);
+    if (it == registry.constraint_attrs.end()) continue;
+    for (const string& name : it->second) {
+      hash = Hash64Combine(hash, ConstraintAttrHash(node_attrs.Find(name)));
+    }
+  }
+  return {key, hash};
+}
+
 // TODO(irving): Replace with const Node& version below.
 Status FindKernelRegistration(
     const DeviceType& device_type, StringPiece node_name,
@@ -1388,8 +1516,30 @@ Status FindKernelRegistration(
   const string& label = GetKernelLabelAttr(node_attrs);
 
   const string key = Key(node_op, device_type, label);
+  const string default_key =
+      IsSymbolicExecutionDevice(device_type.type_string())
+          ? string()
+          : Key(node_op, DEVICE_DEFAULT, label);
   auto typed_registry = GlobalKernelRegistryTyped();
   tf_shared_lock lock(typed_registry->mu);
+  const KernelLookupKey cache_key =
+      LookupCacheKey(*typed_registry, key, default_key, node_attrs);
+  std::optional<KernelLookupResult> cached;
+  {
+    tf_shared_lock l(typed_registry->lookup_cache_mu);
+    auto it = typed_registry->lookup_cache.find(cache_key);
+    if (it != typed_registry->lookup_cache.end()) cached = it->second;
+  }
+  if (cached.has_value()) {
+    // The key only holds a hash of the attr values, so check that the cached
+    // kernel accepts them, and fall back to a full lookup if it does not.
+    bool match = false;
+    if (KernelAttrsMatch(cached->reg->def, node_attrs, &match).ok() && match) {
+      *reg = cached->reg;
+      *was_attr_mismatch = cached->was_attr_mismatch;
+      return OkStatus();
+    }
+  }
   auto regs = typed_registry->registry.equal_range(key);
   for (auto iter = regs.first; iter != regs.second; ++iter) {
     // If there is a kernel registered for the op and device_type,
@@ -1418,9 +1568,7 @@ Status FindKernelRegistration(
   }
   // Check if no device specific registrations found. If not, try finding a
   // default kernel.
-  if (*reg == nullptr &&
-      !IsSymbolicExecutionDevice(device_type.type_string())) {
-    const string default_key = Key(node_op, DEVICE_DEFAULT, label);
+  if (*reg == nullptr && !default_key.empty()) {
     auto regs = typed_registry->registry.equal_range(default_key);
     for (auto iter = regs.first; iter != regs.second; ++iter) {
       // If there is a kernel registered for the op and device_type,
@@ -1452,6 +1600,14 @@ Status FindKernelRegistration(
     }
   }
 
+  // Misses are not cached: callers report them as errors, off the fast path.
+  if (*reg == nullptr) return OkStatus();
+  mutex_lock l(typed_registry->lookup_cache_mu);
+  if (typed_registry->lookup_cache.size() >= kMaxKernelLookupCacheSize) {
+    typed_registry->lookup_cache.clear();
+  }
+  typed_registry->lookup_cache.insert_or_assign(
+      cache_key, KernelLookupResult{*reg, *was_attr_mismatch});
   return OkStatus();
 }
 
@@ -693,6 +693,17 @@ class OpKernelContext {
     // outputs are required.
     bool* outputs_required_array = nullptr;
 
+    // Array indexed by output number for this node. If non-null, a
+    // non-negative entry is the index of the return value of `call_frame` that
+    // the output is passed to, and `allocate_output()` uses the buffer returned
+    // by `CallFrameInterface::GetRetvalBuffer()` for it if possible.
+    const int* output_retval_index_array = nullptr;
+
+    // Array indexed by output number for this node. If non-null, contains the
+    // expected lifetime of each output, which `allocate_output()` passes to
+    // the allocator in `AllocationAttributes::lifetime`.
+    const AllocationLifetime* output_lifetime_array = nullptr;
+
     // For access to distributed coordination service.
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
   };
@@ -1275,6 +1286,10 @@ class OpKernelContext {
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
                          const AllocationAttributes& allocation_attr);
 
+  Status allocate_tensor(Allocator* a, DataType type, const TensorShape& shape,
+                         Tensor* out_tensor,
+                         const AllocationAttributes& allocation_attr);
+
   // Helpers for `set_output()`.
 
   // Returns `true` if the tensor was copied into an allocated output.
@@ -711,6 +711,55 @@ TEST_F(OpKernelBuilderTest, BuilderTypeListAttr) {
                 error::INVALID_ARGUMENT);
 }
 
+REGISTER_OP("BuildLate").Attr("T: type");
+
+TEST_F(OpKernelBuilderTest, RegistrationAfterLookup) {
+  ExpectFailure("BuildLate", DEVICE_CPU, {"T|type|DT_FLOAT"},
+                error::NOT_FOUND);
+  // The failed lookup above must not be reused once a kernel is registered.
+  kernel_factory::OpKernelRegistrar registrar(
+      register_kernel::Name("BuildLate")
+          .Device(DEVICE_CPU)
+          .TypeConstraint<float>("T")
+          .Build(),
+      "DummyKernel", [](OpKernelConstruction* context) -> OpKernel* {
+        return new DummyKernel(context);
+      });
+  ExpectSuccess("BuildLate", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectFailure("BuildLate", DEVICE_CPU, {"T|type|DT_BOOL"},
+                error::NOT_FOUND);
+  ExpectSuccess("BuildLate", DEVICE_CPU, {"T|type|DT_FLOAT"});
+}
+
+REGISTER_OP("BuildLateForT").Attr("T: type");
+REGISTER_KERNEL_BUILDER(
+    Name("BuildLateForT").Device(DEVICE_CPU).TypeConstraint<float>("T"),
+    DummyKernel);
+
+TEST_F(OpKernelBuilderTest, RegistrationAfterAttrMismatch) {
+  // Cache a hit for the float kernel, and miss on the attr of the int32 one.
+  ExpectSuccess("BuildLateForT", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectFailure("BuildLateForT", DEVICE_CPU, {"T|type|DT_INT32"},
+                error::NOT_FOUND);
+  EXPECT_FALSE(KernelDefAvailable(
+      DEVICE_CPU, CreateNodeDef("BuildLateForT", {"T|type|DT_INT32"})));
+
+  kernel_factory::OpKernelRegistrar registrar(
+      register_kernel::Name("BuildLateForT")
+          .Device(DEVICE_CPU)
+          .TypeConstraint<int32>("T")
+          .Build(),
+      "DummyKernel", [](OpKernelConstruction* context) -> OpKernel* {
+        return new DummyKernel(context);
+      });
+  EXPECT_TRUE(KernelDefAvailable(
+      DEVICE_CPU, CreateNodeDef("BuildLateForT", {"T|type|DT_INT32"})));
+  ExpectSuccess("BuildLateForT", DEVICE_CPU, {"T|type|DT_INT32"});
+  ExpectSuccess("BuildLateForT", DEVICE_CPU, {"T|type|DT_FLOAT"});
+  ExpectFailure("BuildLateForT", DEVICE_CPU, {"T|type|DT_BOOL"},
+                error::NOT_FOUND);
+}
+
 REGISTER_OP("DuplicateKernel");
 REGISTER_KERNEL_BUILDER(Name("DuplicateKernel").Device(DEVICE_CPU),
                         DummyKernel);
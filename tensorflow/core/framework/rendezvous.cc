@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <deque>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -152,7 +153,9 @@ Status RendezvousInterface::Recv(const ParsedKey& key, const Args& args,
 namespace {
 class LocalRendezvousWrapper : public Rendezvous {
  public:
-  LocalRendezvousWrapper(int num_shards) : impl_(this, num_shards) {}
+  LocalRendezvousWrapper(int num_shards,
+                         std::shared_ptr<const RendezvousSlotMap> slot_map)
+      : impl_(this, num_shards, std::move(slot_map)) {}
 
   Status Send(const ParsedKey& key, const Args& send_args, const Tensor& val,
               const bool is_dead) override {
@@ -175,7 +178,12 @@ class LocalRendezvousWrapper : public Rendezvous {
 }  // namespace
 
 Rendezvous* NewLocalRendezvous(int num_shards) {
-  return new LocalRendezvousWrapper(num_shards);
+  return new LocalRendezvousWrapper(num_shards, nullptr);
+}
+
+Rendezvous* NewLocalRendezvous(
+    int num_shards, std::shared_ptr<const RendezvousSlotMap> slot_map) {
+  return new LocalRendezvousWrapper(num_shards, std::move(slot_map));
 }
 
 }  // end namespace tensorflow
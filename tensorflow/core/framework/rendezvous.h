@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RENDEZVOUS_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -30,6 +31,7 @@ limitations under the License.
 namespace tensorflow {
 
 class DeviceMgr;
+class RendezvousSlotMap;
 
 // A Rendezvous is an abstraction for passing tensors from producers
 // to consumers. A rendezvous is a table of channels. Each channel is
@@ -53,6 +55,11 @@ class RendezvousInterface {
     DeviceContext* device_context = nullptr;
     AllocatorAttributes alloc_attrs;
     CancellationManager* cancellation_manager = nullptr;  // not owned.
+    // If positive, a remote rendezvous may give a receiver the value received
+    // for the same key in one of the previous `max_staleness_steps` steps,
+    // instead of fetching the value sent in this step.  This suits values
+    // that change slowly, like parameter server variables.
+    int64_t max_staleness_steps = 0;
   };
 
   // Parses the key constructed by CreateKey and parse src/dst device
@@ -171,6 +178,11 @@ class Rendezvous : public RendezvousInterface, public core::WeakRefCounted {
 // ownership of one Ref() on the returned object.
 Rendezvous* NewLocalRendezvous(int num_shards = 1);
 
+// As above, but the keys in `slot_map` are exchanged through lock-free slots.
+// See `RendezvousSlotMap`.
+Rendezvous* NewLocalRendezvous(
+    int num_shards, std::shared_ptr<const RendezvousSlotMap> slot_map);
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_FRAMEWORK_RENDEZVOUS_H_
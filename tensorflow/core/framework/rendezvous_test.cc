@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/framework/rendezvous.h"
 
+#include <memory>
+#include <vector>
+
 #include "absl/status/status.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -434,6 +438,154 @@ TEST_F(LocalRendezvousTest, TransferDummyDeviceContext) {
   args1.device_context->Unref();
 }
 
+// Returns a slot map with a slot for "foo", but not for "bar".
+std::shared_ptr<const RendezvousSlotMap> FooSlotMap() {
+  return std::make_shared<const RendezvousSlotMap>(
+      std::vector<string>{string(KeyFoo().FullKey())});
+}
+
+class LocalRendezvousSlotTest : public ::testing::Test {
+ public:
+  LocalRendezvousSlotTest() : threads_(Env::Default(), "test", 4) {
+    rendez_ = NewLocalRendezvous(/*num_shards=*/1, FooSlotMap());
+  }
+
+  ~LocalRendezvousSlotTest() override { rendez_->Unref(); }
+
+  void SchedClosure(std::function<void()> fn) {
+    threads_.Schedule(std::move(fn));
+  }
+
+  Rendezvous* rendez_;
+
+ private:
+  thread::ThreadPool threads_;
+};
+
+TEST(RendezvousSlotMapTest, Slot) {
+  RendezvousSlotMap slot_map(
+      {string(KeyFoo().FullKey()), string(KeyBar().FullKey()),
+       string(KeyFoo().FullKey())});
+  EXPECT_EQ(2, slot_map.num_slots());
+  EXPECT_EQ(0, slot_map.Slot(RendezvousSlotMap::KeyHash(KeyFoo().FullKey())));
+  EXPECT_EQ(1, slot_map.Slot(RendezvousSlotMap::KeyHash(KeyBar().FullKey())));
+  EXPECT_EQ(-1, slot_map.Slot(RendezvousSlotMap::KeyHash("baz")));
+}
+
+TEST_F(LocalRendezvousSlotTest, SendRecv) {
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V("hello"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousSlotTest, RecvSend) {
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    Rendezvous::Args args;
+    TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V("hello"), false));
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Recv(KeyFoo(), args, &val, &is_dead));
+  EXPECT_EQ("hello", V(val));
+}
+
+TEST_F(LocalRendezvousSlotTest, KeyWithoutSlot) {
+  Rendezvous::Args args;
+  TF_ASSERT_OK(rendez_->Send(KeyBar(), args, V("bar0"), false));
+  TF_ASSERT_OK(rendez_->Send(KeyBar(), args, V("bar1"), false));
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  TF_ASSERT_OK(rendez_->Recv(KeyBar(), args, &val, &is_dead));
+  EXPECT_EQ("bar0", V(val));
+  TF_ASSERT_OK(rendez_->Recv(KeyBar(), args, &val, &is_dead));
+  EXPECT_EQ("bar1", V(val));
+}
+
+TEST_F(LocalRendezvousSlotTest, RepeatedSendsAreMatchedInOrder) {
+  // Only the first send of a key is exchanged through its slot, and the later
+  // ones use the table.
+  Rendezvous::Args args;
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(rendez_->Send(KeyFoo(), args, V(strings::StrCat(i)), false));
+  }
+  for (int i = 0; i < 3; ++i) {
+    Tensor val(DT_STRING);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(KeyFoo(), args, &val, &is_dead));
+    EXPECT_EQ(strings::StrCat(i), V(val));
+  }
+}
+
+TEST_F(LocalRendezvousSlotTest, CancelAfterRecv) {
+  auto* cm = new CancellationManager();
+  Notification n;
+  SchedClosure([cm, &n]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    cm->StartCancel();
+    n.Notify();
+  });
+  Tensor val(DT_STRING);
+  bool is_dead = false;
+  Rendezvous::Args args;
+  args.cancellation_manager = cm;
+  auto s = rendez_->Recv(KeyFoo(), args, &val, &is_dead);
+  EXPECT_TRUE(absl::IsCancelled(s));
+  EXPECT_EQ("RecvAsync is cancelled.", s.message());
+  n.WaitForNotification();
+  delete cm;
+}
+
+// Races the cancellation with the publication of the waiter in the slot, which
+// must not lose the cancellation.
+TEST(LocalRendezvousSlotCancelTest, CancelDuringRecv) {
+  auto slot_map = FooSlotMap();
+  thread::ThreadPool threads(Env::Default(), "test", 1);
+  for (int i = 0; i < 1000; ++i) {
+    Rendezvous* rendez = NewLocalRendezvous(/*num_shards=*/1, slot_map);
+    CancellationManager cm;
+    Notification cancelled;
+    threads.Schedule([&cm, &cancelled]() {
+      cm.StartCancel();
+      cancelled.Notify();
+    });
+    Notification done;
+    Status status;
+    Rendezvous::Args args;
+    args.cancellation_manager = &cm;
+    rendez->RecvAsync(KeyFoo(), args,
+                      [&done, &status](const Status& s,
+                                       const Rendezvous::Args& /*send_args*/,
+                                       const Rendezvous::Args& /*recv_args*/,
+                                       const Tensor& /*v*/, bool /*dead*/) {
+                        status = s;
+                        done.Notify();
+                      });
+    done.WaitForNotification();
+    EXPECT_TRUE(absl::IsCancelled(status));
+    cancelled.WaitForNotification();
+    rendez->Unref();
+  }
+}
+
+TEST_F(LocalRendezvousSlotTest, RecvAbort) {
+  rendez_->Ref();
+  SchedClosure([this]() {
+    Env::Default()->SleepForMicroseconds(10000);
+    rendez_->StartAbort(errors::Aborted(""));  // abort
+    rendez_->Unref();
+  });
+  Tensor val(DT_STRING);
+  bool val_dead = false;
+  Rendezvous::Args args;
+  Status status = rendez_->Recv(KeyFoo(), args, &val, &val_dead);
+  EXPECT_TRUE(absl::IsAborted(status));
+}
+
 void BM_SendRecv(::testing::benchmark::State& state) {
   Rendezvous* rendez = NewLocalRendezvous();
   Tensor orig = V("val");
@@ -451,6 +603,24 @@ void BM_SendRecv(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_SendRecv);
 
+void BM_SendRecvSlot(::testing::benchmark::State& state) {
+  auto slot_map = FooSlotMap();
+  Tensor orig = V("val");
+  Tensor val(DT_STRING, TensorShape({}));
+  bool is_dead = false;
+  Rendezvous::Args args;
+
+  for (auto s : state) {
+    // Each slot is used once per rendezvous, as in a step.
+    Rendezvous* rendez = NewLocalRendezvous(/*num_shards=*/1, slot_map);
+    TF_CHECK_OK(rendez->Send(KeyFoo(), args, orig, is_dead));
+    TF_CHECK_OK(rendez->Recv(KeyFoo(), args, &val, &is_dead));
+    rendez->Unref();
+  }
+  CHECK_EQ(V(val), V(orig));
+}
+BENCHMARK(BM_SendRecvSlot);
+
 void BM_RecvSend(::testing::benchmark::State& state) {
   Rendezvous* rendez = NewLocalRendezvous();
   Tensor orig = V("val");
@@ -27,9 +27,20 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/demangle.h"
 #include "tensorflow/core/platform/stacktrace.h"
+#include "tsl/profiler/lib/mutex_contention.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Returns a generation that no resource manager had before.
+uint64 NewResourceMgrGeneration() {
+  static std::atomic<uint64> next_generation{1};
+  return next_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 ResourceHandle MakeResourceHandle(
     const string& container, const string& name, const DeviceBase& device,
     const TypeIndex& type_index,
@@ -128,12 +139,18 @@ ResourceMgr::ResourceAndName& ResourceMgr::ResourceAndName::operator=(
   return *this;
 }
 
-ResourceMgr::ResourceMgr() : default_container_("localhost") {}
+ResourceMgr::ResourceMgr() : ResourceMgr("localhost") {}
 
 ResourceMgr::ResourceMgr(const string& default_container)
-    : default_container_(default_container) {}
+    : default_container_(default_container),
+      generation_(NewResourceMgrGeneration()) {
+  tsl::profiler::SetMutexName(&mu_, "ResourceMgr");
+}
 
-ResourceMgr::~ResourceMgr() { Clear(); }
+ResourceMgr::~ResourceMgr() {
+  Clear();
+  tsl::profiler::ClearMutexName(&mu_);
+}
 
 void ResourceMgr::Clear() {
   // We do the deallocation outside of the lock to avoid a potential deadlock
@@ -143,6 +160,7 @@ void ResourceMgr::Clear() {
     mutex_lock l(mu_);
     tmp_containers = std::move(containers_);
     containers_.clear();  // reinitialize after move.
+    generation_.store(NewResourceMgrGeneration(), std::memory_order_release);
   }
   for (const auto& p : tmp_containers) {
     delete p.second;
@@ -275,6 +293,7 @@ Status ResourceMgr::PopResourceAndName(const string& container,
     return errors::NotFound("Resource ", container, "/", resource_name, "/",
                             type_name, " does not exist.");
   }
+  generation_.store(NewResourceMgrGeneration(), std::memory_order_release);
   std::swap(resource_and_name, iter->second);
   b->erase(iter);
   return OkStatus();
@@ -325,6 +344,9 @@ Status ResourceMgr::Cleanup(const string& container) {
       return OkStatus();
     }
     b = iter->second;
+    if (!b->empty()) {
+      generation_.store(NewResourceMgrGeneration(), std::memory_order_release);
+    }
     containers_.erase(iter);
   }
   CHECK(b != nullptr);
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -237,6 +238,14 @@ class ResourceMgr {
   // Returns a text description for all resources.
   std::string DebugString() const;
 
+  // Returns a value that changes whenever a resource is removed from *this,
+  // and that no other resource manager has. A resource found by a lookup is
+  // found by later lookups for as long as the generation is unchanged; see
+  // ResourceLookupCache.
+  uint64 generation() const {
+    return generation_.load(std::memory_order_acquire);
+  }
+
  private:
   typedef std::pair<uint64, StringPiece> Key;
   struct KeyHash {
@@ -323,6 +332,8 @@ class ResourceMgr {
   // Map from type hash_code to type name.
   std::unordered_map<uint64, string> debug_type_names_ TF_GUARDED_BY(mu_);
 
+  std::atomic<uint64> generation_;
+
   ResourceMgr(const ResourceMgr&) = delete;
   void operator=(const ResourceMgr&) = delete;
 };
@@ -874,6 +885,73 @@ Status LookupOrCreateResource(OpKernelContext* ctx, const ResourceHandle& p,
   return OkStatus();
 }
 
+// Caches the resource found by the last lookup through it, for kernels that
+// look up the same handle at every step, such as variable reads and
+// assignments, so that they skip hashing its container and name under the lock
+// of the resource manager. The resource is cached through a weak reference,
+// so that it is not kept alive after it is deleted, and is only returned while
+// the generation of the resource manager is unchanged.
+template <typename T>
+class ResourceLookupCache {
+ public:
+  // Same as LookupResource(ctx, p, value).
+  Status Lookup(OpKernelContext* ctx, const ResourceHandle& p,
+                core::RefCountPtr<T>* value) {
+    TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
+    if (p.IsRefCounting()) return LookupResource(ctx, p, value);
+    ResourceMgr* rm = ctx->resource_manager();
+    if (GetCached(rm, p, value)) return OkStatus();
+    const uint64 generation = rm->generation();
+    TF_RETURN_IF_ERROR(LookupResource(ctx, p, value));
+    SetCached(rm, generation, p, value->get());
+    return OkStatus();
+  }
+
+  // Same as LookupOrCreateResource(ctx, p, value, creator).
+  Status LookupOrCreate(OpKernelContext* ctx, const ResourceHandle& p,
+                        core::RefCountPtr<T>* value,
+                        std::function<Status(T**)> creator) {
+    TF_RETURN_IF_ERROR(internal::ValidateDeviceAndType<T>(ctx, p));
+    ResourceMgr* rm = ctx->resource_manager();
+    if (GetCached(rm, p, value)) return OkStatus();
+    const uint64 generation = rm->generation();
+    TF_RETURN_IF_ERROR(
+        LookupOrCreateResource<T>(ctx, p, value, std::move(creator)));
+    SetCached(rm, generation, p, value->get());
+    return OkStatus();
+  }
+
+ private:
+  bool GetCached(const ResourceMgr* rm, const ResourceHandle& p,
+                 core::RefCountPtr<T>* value) TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    if (rm != resource_manager_ || rm->generation() != generation_ ||
+        p.name() != name_ || p.container() != container_) {
+      return false;
+    }
+    *value = resource_.GetNewRef();
+    return *value != nullptr;
+  }
+
+  void SetCached(const ResourceMgr* rm, uint64 generation,
+                 const ResourceHandle& p, T* resource) TF_LOCKS_EXCLUDED(mu_) {
+    core::WeakPtr<T> weak_resource(resource);
+    mutex_lock l(mu_);
+    resource_manager_ = rm;
+    generation_ = generation;
+    container_ = p.container();
+    name_ = p.name();
+    resource_ = std::move(weak_resource);
+  }
+
+  mutex mu_;
+  const ResourceMgr* resource_manager_ TF_GUARDED_BY(mu_) = nullptr;
+  uint64 generation_ TF_GUARDED_BY(mu_) = 0;
+  std::string container_ TF_GUARDED_BY(mu_);
+  std::string name_ TF_GUARDED_BY(mu_);
+  core::WeakPtr<T> resource_ TF_GUARDED_BY(mu_);
+};
+
 // Deletes the resource pointed by "p", using the resource manager in "ctx".
 template <typename T>
 Status DeleteResource(OpKernelContext* ctx, const ResourceHandle& p) {
@@ -527,4 +527,62 @@ TEST(ResourceHandleTest, DeleteUsingResourceHandle) {
   EXPECT_NE(LookupResource<StubResource>(&ctx, p, &lookup_r).ok(), true);
 }
 
+TEST(ResourceHandleTest, LookupCache) {
+  ResourceMgr resource_mgr("");
+  OpKernelContext::Params params;
+  params.resource_manager = &resource_mgr;
+  StubDevice device("device_name");
+  params.device = &device;
+  OpKernelContext ctx(&params, 0);
+
+  ResourceHandle p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "name");
+  ResourceHandle other_p =
+      MakeResourceHandle<StubResource>(&ctx, "container", "other_name");
+  ResourceLookupCache<StubResource> cache;
+
+  core::RefCountPtr<StubResource> r;
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &r).ok());
+  StubResource* created = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, created));
+  TF_ASSERT_OK(CreateResource(&ctx, other_p, new StubResource));
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+    EXPECT_EQ(r.get(), created);
+  }
+  TF_ASSERT_OK(cache.Lookup(&ctx, other_p, &r));
+  EXPECT_NE(r.get(), created);
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+  EXPECT_EQ(r.get(), created);
+
+  // Deleting the resource while it is still referenced is noticed.
+  TF_EXPECT_OK(DeleteResource(&ctx, p));
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &r).ok());
+  r.reset();
+  StubResource* recreated = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, recreated));
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+  EXPECT_EQ(r.get(), recreated);
+
+  // So is deleting the resource when the resource manager holds the last
+  // reference to it.
+  r.reset();
+  TF_EXPECT_OK(DeleteResource(&ctx, p));
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &r).ok());
+  recreated = new StubResource;
+  TF_ASSERT_OK(CreateResource(&ctx, p, recreated));
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+  EXPECT_EQ(r.get(), recreated);
+
+  // And cleaning up its container, whether or not it is still referenced.
+  TF_ASSERT_OK(resource_mgr.Cleanup("container"));
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &r).ok());
+  r.reset();
+  TF_ASSERT_OK(CreateResource(&ctx, p, new StubResource));
+  TF_ASSERT_OK(cache.Lookup(&ctx, p, &r));
+  r.reset();
+  TF_ASSERT_OK(resource_mgr.Cleanup("container"));
+  EXPECT_FALSE(cache.Lookup(&ctx, p, &r).ok());
+}
+
 }  // end namespace tensorflow
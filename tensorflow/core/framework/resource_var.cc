@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/resource_var.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/framework/resource_handle.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
 
@@ -40,6 +42,43 @@ Status Var::AsGraphDef(GraphDefBuilder* builder, Node** out) const {
   return OkStatus();
 }
 
+std::optional<DirtyRows::RowRanges> DirtyRows::Take() {
+  std::vector<int64_t> rows;
+  {
+    mutex_lock l(mu_);
+    if (all_) {
+      all_ = false;
+      return std::nullopt;
+    }
+    rows.assign(rows_.begin(), rows_.end());
+    rows_.clear();
+  }
+  std::sort(rows.begin(), rows.end());
+  RowRanges ranges;
+  for (int64_t row : rows) {
+    if (!ranges.empty() && ranges.back().second == row) {
+      ++ranges.back().second;
+    } else {
+      ranges.emplace_back(row, row + 1);
+    }
+  }
+  return ranges;
+}
+
+DirtyRows* Var::EnableDirtyRowTracking() {
+  DirtyRows* dirty_rows = dirty_rows_.load(std::memory_order_acquire);
+  if (dirty_rows != nullptr) {
+    return dirty_rows;
+  }
+  auto* new_dirty_rows = new DirtyRows();
+  if (dirty_rows_.compare_exchange_strong(dirty_rows, new_dirty_rows,
+                                          std::memory_order_acq_rel)) {
+    return new_dirty_rows;
+  }
+  delete new_dirty_rows;
+  return dirty_rows;
+}
+
 std::string Var::MakeRefCountingHandleName(int64_t resource_id) const {
   // Use the resource id to ensure uniqueness.
   std::string handle_name = absl::StrFormat("%s%d", debug_name_, resource_id);
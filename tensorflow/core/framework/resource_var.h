@@ -16,11 +16,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/resource_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 // Forward declarations to avoid introducing a dependency on headers in
 // "tensorflow/core/graph/...".
@@ -28,6 +36,48 @@ class GraphDefBuilder;
 
 namespace tensorflow {
 
+// The rows (indices in the first dimension) of a variable updated since they
+// were last taken, e.g. to only write those to a delta checkpoint (see
+// tensor_bundle/delta_checkpoint.h). Thread-safe.
+class DirtyRows {
+ public:
+  // Sorted, disjoint and non-adjacent [begin, end) ranges of rows.
+  using RowRanges = std::vector<std::pair<int64_t, int64_t>>;
+
+  // Records that the rows `rows[0, n)` were updated.
+  template <typename Index>
+  void Record(const Index* rows, int64_t n) {
+    mutex_lock l(mu_);
+    if (all_) return;
+    rows_.insert(rows, rows + n);
+  }
+
+  // Records that the whole variable may have been updated, e.g. by a dense
+  // write.
+  void RecordAll() {
+    mutex_lock l(mu_);
+    all_ = true;
+    rows_.clear();
+  }
+
+  // Returns the number of rows recorded since the last Take(), or -1 if the
+  // whole variable may have been updated.
+  int64_t size() const {
+    tf_shared_lock l(mu_);
+    return all_ ? -1 : rows_.size();
+  }
+
+  // Returns the ranges of the rows updated since the last call, or nullopt if
+  // the whole variable may have been updated, and clears them.
+  std::optional<RowRanges> Take();
+
+ private:
+  mutable mutex mu_;
+  // Initially, the rows updated before the tracking started are unknown.
+  bool all_ TF_GUARDED_BY(mu_) = true;
+  absl::flat_hash_set<int64_t> rows_ TF_GUARDED_BY(mu_);
+};
+
 // Resource stored by variables in the resource manager (new, resource-style
 // version).
 //
@@ -95,6 +145,18 @@ class Var : public ResourceBase {
 
   std::string MakeRefCountingHandleName(int64_t resource_id) const override;
 
+  // Starts tracking the rows updated by the kernels writing to the variable,
+  // if not started yet, and returns them. Until the first DirtyRows::Take(),
+  // the whole variable is considered updated.
+  DirtyRows* EnableDirtyRowTracking();
+
+  // Returns the rows updated by the kernels writing to the variable, or null
+  // unless EnableDirtyRowTracking() was called. Writing kernels must record the
+  // rows they update, or call DirtyRows::RecordAll().
+  DirtyRows* dirty_rows() const {
+    return dirty_rows_.load(std::memory_order_acquire);
+  }
+
   // Only used in the resource variable path. In resource variables,
   // tensor.IsInitialized() can be true (i.e. have memory allocated to it) while
   // there is not a good value there due to a race condition, and it's possible
@@ -114,8 +176,9 @@ class Var : public ResourceBase {
   mutex mu_;
   Tensor tensor_;
   std::string debug_name_;
+  std::atomic<DirtyRows*> dirty_rows_{nullptr};  // Owned.
 
-  ~Var() override {}
+  ~Var() override { delete dirty_rows_.load(); }
   Var(const Var&) = delete;
   void operator=(const Var&) = delete;
 };
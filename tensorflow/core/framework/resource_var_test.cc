@@ -34,5 +34,33 @@ TEST(ResourceVarTest, Uninitialize) {
   EXPECT_FALSE(var->is_initialized);
   EXPECT_TRUE(var->tensor()->data() == nullptr);
 }
+
+TEST(ResourceVarTest, DirtyRows) {
+  RefCountPtr<Var> var{new Var(DT_FLOAT)};
+  EXPECT_EQ(var->dirty_rows(), nullptr);
+  DirtyRows* dirty_rows = var->EnableDirtyRowTracking();
+  ASSERT_NE(dirty_rows, nullptr);
+  EXPECT_EQ(var->EnableDirtyRowTracking(), dirty_rows);
+  EXPECT_EQ(var->dirty_rows(), dirty_rows);
+
+  // The rows updated before the tracking started are unknown.
+  EXPECT_EQ(dirty_rows->size(), -1);
+  EXPECT_FALSE(dirty_rows->Take().has_value());
+
+  const int64_t rows[] = {7, 2, 3, 9, 2, 8};
+  dirty_rows->Record(rows, 6);
+  EXPECT_EQ(dirty_rows->size(), 5);
+  std::optional<DirtyRows::RowRanges> ranges = dirty_rows->Take();
+  ASSERT_TRUE(ranges.has_value());
+  EXPECT_EQ(*ranges, DirtyRows::RowRanges({{2, 4}, {7, 10}}));
+  EXPECT_EQ(dirty_rows->size(), 0);
+
+  dirty_rows->Record(rows, 1);
+  dirty_rows->RecordAll();
+  EXPECT_FALSE(dirty_rows->Take().has_value());
+  ranges = dirty_rows->Take();
+  ASSERT_TRUE(ranges.has_value());
+  EXPECT_TRUE(ranges->empty());
+}
 }  // namespace core
 }  // namespace tensorflow
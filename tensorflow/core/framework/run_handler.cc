@@ -739,11 +739,18 @@ class RunHandler::Impl {
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
+  // Prepares the handler for a new request with the given `step_id`, whose
+  // closures run on `run_handler_thread_pool`, the threads of `numa_node`
+  // (or `port::kNUMANoAffinity`).
   void Reset(int64_t step_id,
-             const RunOptions::Experimental::RunHandlerPoolOptions& options);
+             const RunOptions::Experimental::RunHandlerPoolOptions& options,
+             int numa_node,
+             internal::RunHandlerThreadPool* run_handler_thread_pool);
 
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
+  int numa_node() const { return numa_node_; }
+
   internal::ThreadWorkSource* tws() { return &tws_; }
 
   int64_t priority() { return options_.priority(); }
@@ -763,6 +770,8 @@ class RunHandler::Impl {
   };
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
+  internal::RunHandlerThreadPool* run_handler_thread_pool_;  // NOT OWNED.
+  int numa_node_;
   uint64 start_time_us_;
   int64_t step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
@@ -775,19 +784,13 @@ class RunHandler::Impl {
 // This class is thread safe.
 class RunHandlerPool::Impl {
  public:
-  explicit Impl(int num_inter_op_threads, int num_intra_op_threads)
+  explicit Impl(int num_inter_op_threads, int num_intra_op_threads,
+                int num_numa_nodes)
       : max_handlers_(static_cast<int32>(ParamFromEnvWithDefault(
             "TF_RUN_HANDLER_MAX_CONCURRENT_HANDLERS", kMaxConcurrentHandlers))),
-        waiters_mu_(
-            ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2)),
-        queue_waiters_(
-            ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2)),
-        run_handler_thread_pool_(new internal::RunHandlerThreadPool(
-            num_inter_op_threads, num_intra_op_threads, Env::Default(),
-            ThreadOptions(), "tf_run_handler_pool", &waiters_mu_,
-            &queue_waiters_)),
         iterations_(0),
         version_(0),
+        next_numa_pool_(0),
         sub_thread_pool_end_request_percentage_(ParamFromEnvWithDefault(
             "TF_RUN_HANDLER_SUB_THREAD_POOL_END_REQUEST_PERCENTAGE",
             std::vector<double>({1}))) {
@@ -798,15 +801,19 @@ class RunHandlerPool::Impl {
       handlers_.emplace_back(new RunHandler::Impl(this));
       free_handlers_.push_back(handlers_.back().get());
     }
-    queue_waiters_.resize(
-        ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2));
-    waiters_mu_.resize(
-        ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2));
-    for (auto& queue_waiter : queue_waiters_) {
-      queue_waiter.next = &queue_waiter;
-      queue_waiter.prev = &queue_waiter;
+    // Every NUMA node needs at least one inter-op thread.
+    const int num_pools =
+        std::max(1, std::min(num_numa_nodes, num_inter_op_threads));
+    numa_pools_.reserve(num_pools);
+    for (int i = 0; i < num_pools; ++i) {
+      // Split the threads evenly across NUMA nodes.
+      const int num_inter = num_inter_op_threads / num_pools +
+                            (i < num_inter_op_threads % num_pools ? 1 : 0);
+      const int num_intra = num_intra_op_threads / num_pools +
+                            (i < num_intra_op_threads % num_pools ? 1 : 0);
+      numa_pools_.emplace_back(new NumaPool(
+          num_pools > 1 ? i : port::kNUMANoAffinity, num_inter, num_intra));
     }
-    run_handler_thread_pool_->Start();
   }
 
   ~Impl() {
@@ -814,16 +821,16 @@ class RunHandlerPool::Impl {
     // destruction.
     DCHECK_EQ(handlers_.size(), max_handlers_);
     DCHECK_EQ(free_handlers_.size(), handlers_.size());
-    DCHECK_EQ(sorted_active_handlers_.size(), 0);
-    // Stop the threads in run_handler_thread_pool_ before freeing other
-    // pointers. Otherwise a thread may try to access a pointer after the
-    // pointer has been freed.
-    run_handler_thread_pool_.reset();
+    // Stop the threads in the thread pools before freeing other pointers.
+    // Otherwise a thread may try to access a pointer after the pointer has
+    // been freed.
+    for (auto& numa_pool : numa_pools_) {
+      DCHECK_EQ(numa_pool->sorted_active_handlers.size(), 0);
+      numa_pool->run_handler_thread_pool.reset();
+    }
   }
 
-  internal::RunHandlerThreadPool* run_handler_thread_pool() {
-    return run_handler_thread_pool_.get();
-  }
+  int num_numa_pools() const { return numa_pools_.size(); }
 
   bool has_free_handler() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
     return !free_handlers_.empty();
@@ -844,6 +851,7 @@ class RunHandlerPool::Impl {
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    NumaPool* numa_pool;
     {
       mutex_lock l(mu_);
       if (!has_free_handler()) {
@@ -866,20 +874,24 @@ class RunHandlerPool::Impl {
         }
       }
       // Remove the last entry from free_handlers_ and add to the end of
-      // sorted_active_handlers_.
+      // sorted_active_handlers of the least loaded NUMA node.
+      numa_pool = ChooseNumaPool();
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      handler_impl->Reset(step_id, options, numa_pool->numa_node,
+                          numa_pool->run_handler_thread_pool.get());
       free_handlers_.pop_back();
 
-      num_active_requests = sorted_active_handlers_.size() + 1;
+      std::list<RunHandler::Impl*>& sorted_active_handlers =
+          numa_pool->sorted_active_handlers;
+      num_active_requests = sorted_active_handlers.size() + 1;
       thread_work_sources->resize(num_active_requests);
       int priority = options.priority();
-      auto it = sorted_active_handlers_.cbegin();
+      auto it = sorted_active_handlers.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
-        if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
+        if (!new_handler_inserted && (it == sorted_active_handlers.cend() ||
                                       priority > (*it)->priority())) {
-          sorted_active_handlers_.insert(it, handler_impl);
+          sorted_active_handlers.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
           --it;
@@ -889,13 +901,16 @@ class RunHandlerPool::Impl {
       }
       version = ++version_;
     }
-    RecomputePoolStats(num_active_requests, version, *thread_work_sources);
+    RecomputePoolStats(numa_pool, num_active_requests, version,
+                       *thread_work_sources);
     return std::unique_ptr<RunHandler>(new RunHandler(handler_impl));
   }
 
   void ReleaseHandler(RunHandler::Impl* handler) TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
-    DCHECK_GT(sorted_active_handlers_.size(), 0);
+    std::list<RunHandler::Impl*>& sorted_active_handlers =
+        numa_pools_[std::max(0, handler->numa_node())]->sorted_active_handlers;
+    DCHECK_GT(sorted_active_handlers.size(), 0);
 
     CHECK_EQ(handler->tws()->TaskQueueSize(true), 0);   // Crash OK.
     CHECK_EQ(handler->tws()->TaskQueueSize(false), 0);  // Crash OK.
@@ -904,17 +919,17 @@ class RunHandlerPool::Impl {
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
 
-    // Erase from and update sorted_active_handlers_. Add it to the end of
+    // Erase from and update sorted_active_handlers. Add it to the end of
     // free_handlers_.
-    auto iter = std::find(sorted_active_handlers_.begin(),
-                          sorted_active_handlers_.end(), handler);
-    DCHECK(iter != sorted_active_handlers_.end())
+    auto iter = std::find(sorted_active_handlers.begin(),
+                          sorted_active_handlers.end(), handler);
+    DCHECK(iter != sorted_active_handlers.end())
         << "Unexpected handler: " << handler
         << " is being requested for release";
 
     // Remove this handler from this list and add it to the list of free
     // handlers.
-    sorted_active_handlers_.erase(iter);
+    sorted_active_handlers.erase(iter);
     free_handlers_.push_back(handler);
     DCHECK_LE(free_handlers_.size(), max_handlers_);
     LogInfo();
@@ -928,15 +943,76 @@ class RunHandlerPool::Impl {
       TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
     std::vector<int64_t> ret;
-    for (const auto& handler_impl : sorted_active_handlers_) {
-      ret.push_back(handler_impl->priority());
+    for (const auto& numa_pool : numa_pools_) {
+      for (const auto& handler_impl : numa_pool->sorted_active_handlers) {
+        ret.push_back(handler_impl->priority());
+      }
     }
     return ret;
   }
 
  private:
+  // The threads of the pool that run on one NUMA node, and the handlers that
+  // are currently assigned to them. A pool without NUMA affinity has a single
+  // NumaPool whose `numa_node` is `port::kNUMANoAffinity`.
+  struct NumaPool {
+    NumaPool(int numa_node, int num_inter_op_threads, int num_intra_op_threads)
+        : numa_node(numa_node),
+          waiters_mu(
+              ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2)),
+          queue_waiters(ParamFromEnvWithDefault(
+              "TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2)) {
+      queue_waiters.resize(
+          ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2));
+      waiters_mu.resize(
+          ParamFromEnvWithDefault("TF_RUN_HANDLER_NUM_SUB_THREAD_POOL", 2));
+      for (auto& queue_waiter : queue_waiters) {
+        queue_waiter.next = &queue_waiter;
+        queue_waiter.prev = &queue_waiter;
+      }
+      ThreadOptions thread_options;
+      string name = "tf_run_handler_pool";
+      if (numa_node != port::kNUMANoAffinity) {
+        // Only pin the threads if the node exists, so that the partitioning
+        // can be tested on machines with fewer nodes.
+        if (port::NUMAEnabled() && numa_node < port::NUMANumNodes()) {
+          thread_options.numa_node = numa_node;
+        }
+        strings::StrAppend(&name, "_numa", numa_node);
+      }
+      run_handler_thread_pool.reset(new internal::RunHandlerThreadPool(
+          num_inter_op_threads, num_intra_op_threads, Env::Default(),
+          thread_options, name, &waiters_mu, &queue_waiters));
+      run_handler_thread_pool->Start();
+    }
+
+    const int numa_node;
+    Eigen::MaxSizeVector<mutex> waiters_mu;
+    Eigen::MaxSizeVector<internal::Waiter> queue_waiters;
+    std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool;
+    // Handlers assigned to this node, sorted by priority and start time.
+    // Guarded by RunHandlerPool::Impl::mu_.
+    std::list<RunHandler::Impl*> sorted_active_handlers;
+  };
+
+  // Returns the NumaPool with the fewest active handlers, breaking ties in
+  // round-robin order.
+  NumaPool* ChooseNumaPool() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int num_pools = numa_pools_.size();
+    const int start = next_numa_pool_++ % num_pools;
+    NumaPool* best = numa_pools_[start].get();
+    for (int i = 1; i < num_pools; ++i) {
+      NumaPool* numa_pool = numa_pools_[(start + i) % num_pools].get();
+      if (numa_pool->sorted_active_handlers.size() <
+          best->sorted_active_handlers.size()) {
+        best = numa_pool;
+      }
+    }
+    return best;
+  }
+
   void RecomputePoolStats(
-      int num_active_requests, uint64 version,
+      NumaPool* numa_pool, int num_active_requests, uint64 version,
       const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
           thread_work_sources);
 
@@ -948,17 +1024,13 @@ class RunHandlerPool::Impl {
   // inference).
   const int max_handlers_;
 
-  Eigen::MaxSizeVector<mutex> waiters_mu_;
-  Eigen::MaxSizeVector<internal::Waiter> queue_waiters_;
-
-  std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
+  // One per NUMA node, or a single one if the pool does not use NUMA affinity.
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
   // TODO(azaks): sort by the remaining latency budget.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
-  std::list<RunHandler::Impl*> sorted_active_handlers_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<NumaPool>> numa_pools_;
   std::vector<RunHandler::Impl*> free_handlers_ TF_GUARDED_BY(mu_);
   std::vector<std::unique_ptr<RunHandler::Impl>> handlers_ TF_GUARDED_BY(mu_);
 
@@ -968,11 +1040,12 @@ class RunHandlerPool::Impl {
   int64_t iterations_ TF_GUARDED_BY(mu_);
   mutex mu_;
   int64_t version_ TF_GUARDED_BY(mu_);
+  int next_numa_pool_ TF_GUARDED_BY(mu_);
   const std::vector<double> sub_thread_pool_end_request_percentage_;
 };
 
 void RunHandlerPool::Impl::RecomputePoolStats(
-    int num_active_requests, uint64 version,
+    NumaPool* numa_pool, int num_active_requests, uint64 version,
     const Eigen::MaxSizeVector<internal::ThreadWorkSource*>&
         thread_work_sources) {
   if (num_active_requests == 0) return;
@@ -986,13 +1059,15 @@ void RunHandlerPool::Impl::RecomputePoolStats(
                  sub_thread_pool_end_request_percentage_[sub_thread_pool_id]) {
       sub_thread_pool_id++;
     }
-    thread_work_sources[i]->SetWaiter(version,
-                                      &queue_waiters_[sub_thread_pool_id],
-                                      &waiters_mu_[sub_thread_pool_id]);
+    thread_work_sources[i]->SetWaiter(
+        version, &numa_pool->queue_waiters[sub_thread_pool_id],
+        &numa_pool->waiters_mu[sub_thread_pool_id]);
   }
 
-  int num_threads = run_handler_thread_pool()->NumThreads();
-  int num_blocking_threads = run_handler_thread_pool()->NumBlockingThreads();
+  internal::RunHandlerThreadPool* run_handler_thread_pool =
+      numa_pool->run_handler_thread_pool.get();
+  int num_threads = run_handler_thread_pool->NumThreads();
+  int num_blocking_threads = run_handler_thread_pool->NumBlockingThreads();
   int num_non_blocking_threads = num_threads - num_blocking_threads;
 
   std::vector<int> request_idx_list = ChooseRequestsWithExponentialDistribution(
@@ -1000,7 +1075,7 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   for (int i = 0; i < num_blocking_threads; ++i) {
     VLOG(2) << "Set work for tid=" << i
             << " with start_request_idx=" << request_idx_list[i];
-    run_handler_thread_pool()->SetThreadWorkSources(
+    run_handler_thread_pool->SetThreadWorkSources(
         i, request_idx_list[i], version, thread_work_sources);
   }
 
@@ -1009,7 +1084,7 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   for (int i = 0; i < num_non_blocking_threads; ++i) {
     VLOG(2) << "Set work for tid=" << (i + num_blocking_threads)
             << " with start_request_idx=" << request_idx_list[i];
-    run_handler_thread_pool()->SetThreadWorkSources(
+    run_handler_thread_pool->SetThreadWorkSources(
         i + num_blocking_threads, request_idx_list[i], version,
         thread_work_sources);
   }
@@ -1017,38 +1092,44 @@ void RunHandlerPool::Impl::RecomputePoolStats(
 
 void RunHandlerPool::Impl::LogInfo() {
   if (iterations_++ % 50000 == 10 && VLOG_IS_ON(1)) {
-    int num_active_requests = sorted_active_handlers_.size();
     VLOG(1) << "Printing time histogram: " << time_hist_.ToString();
-    VLOG(1) << "Active session runs: " << num_active_requests;
     uint64 now = tensorflow::Env::Default()->NowMicros();
-    string times_str = "";
-    string ids_str = "";
-    auto it = sorted_active_handlers_.cbegin();
-    for (int i = 0; i < num_active_requests; ++i) {
-      if (i > 0) {
-        times_str += " ";
-        ids_str += " ";
+    for (const auto& numa_pool : numa_pools_) {
+      const std::list<RunHandler::Impl*>& sorted_active_handlers =
+          numa_pool->sorted_active_handlers;
+      int num_active_requests = sorted_active_handlers.size();
+      if (numa_pools_.size() > 1) {
+        VLOG(1) << "NUMA node: " << numa_pool->numa_node;
       }
+      VLOG(1) << "Active session runs: " << num_active_requests;
+      string times_str = "";
+      string ids_str = "";
+      auto it = sorted_active_handlers.cbegin();
+      for (int i = 0; i < num_active_requests; ++i) {
+        if (i > 0) {
+          times_str += " ";
+          ids_str += " ";
+        }
 
-      times_str +=
-          strings::StrCat((now - (*it)->start_time_us()) / 1000.0, " ms.");
-      ids_str += strings::StrCat((*it)->tws()->GetTracemeId());
-      ++it;
+        times_str +=
+            strings::StrCat((now - (*it)->start_time_us()) / 1000.0, " ms.");
+        ids_str += strings::StrCat((*it)->tws()->GetTracemeId());
+        ++it;
+      }
+      VLOG(1) << "Elapsed times are: " << times_str;
+      VLOG(1) << "Step ids are: " << ids_str;
     }
-    VLOG(1) << "Elapsed times are: " << times_str;
-    VLOG(1) << "Step ids are: " << ids_str;
   }
 }
 
 // It is important to return a value such as:
 // CurrentThreadId() in [0, NumThreads)
 int RunHandler::Impl::ThreadPoolInterfaceWrapper::NumThreads() const {
-  return run_handler_impl_->pool_impl_->run_handler_thread_pool()->NumThreads();
+  return run_handler_impl_->run_handler_thread_pool_->NumThreads();
 }
 
 int RunHandler::Impl::ThreadPoolInterfaceWrapper::CurrentThreadId() const {
-  return run_handler_impl_->pool_impl_->run_handler_thread_pool()
-      ->CurrentThreadId();
+  return run_handler_impl_->run_handler_thread_pool_->CurrentThreadId();
 }
 
 void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
@@ -1059,36 +1140,44 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_.reset(new ThreadPoolInterfaceWrapper(this));
-  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
+  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions(),
+        port::kNUMANoAffinity, nullptr);
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
   VLOG(3) << "Scheduling inter work for  " << tws()->GetTracemeId();
-  pool_impl_->run_handler_thread_pool()->AddWorkToQueue(tws(), true,
-                                                        std::move(fn));
+  run_handler_thread_pool_->AddWorkToQueue(tws(), true, std::move(fn));
 }
 
 void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
   VLOG(3) << "Scheduling intra work for " << tws()->GetTracemeId();
-  pool_impl_->run_handler_thread_pool()->AddWorkToQueue(tws(), false,
-                                                        std::move(fn));
+  run_handler_thread_pool_->AddWorkToQueue(tws(), false, std::move(fn));
 }
 
 void RunHandler::Impl::Reset(
     int64_t step_id,
-    const RunOptions::Experimental::RunHandlerPoolOptions& options) {
+    const RunOptions::Experimental::RunHandlerPoolOptions& options,
+    int numa_node, internal::RunHandlerThreadPool* run_handler_thread_pool) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
   options_ = options;
+  numa_node_ = numa_node;
+  run_handler_thread_pool_ = run_handler_thread_pool;
   tws_.SetTracemeId(step_id);
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
-    : impl_(new Impl(num_inter_op_threads, 0)) {}
+    : impl_(new Impl(num_inter_op_threads, 0, /*num_numa_nodes=*/1)) {}
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads,
                                int num_intra_op_threads)
-    : impl_(new Impl(num_inter_op_threads, num_intra_op_threads)) {}
+    : impl_(new Impl(num_inter_op_threads, num_intra_op_threads,
+                     /*num_numa_nodes=*/1)) {}
+
+RunHandlerPool::RunHandlerPool(int num_inter_op_threads,
+                               int num_intra_op_threads, int num_numa_nodes)
+    : impl_(new Impl(num_inter_op_threads, num_intra_op_threads,
+                     num_numa_nodes)) {}
 
 RunHandlerPool::~RunHandlerPool() {}
 
@@ -1103,6 +1192,8 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+int RunHandlerPool::NumNumaNodes() const { return impl_->num_numa_pools(); }
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -1113,6 +1204,8 @@ thread::ThreadPoolInterface* RunHandler::AsIntraThreadPoolInterface() {
   return impl_->thread_pool_interface();
 }
 
+int RunHandler::NumaNode() const { return impl_->numa_node(); }
+
 RunHandler::~RunHandler() { impl_->pool_impl()->ReleaseHandler(impl_); }
 
 }  // namespace tensorflow
@@ -53,6 +53,17 @@ class RunHandlerPool {
   explicit RunHandlerPool(int num_inter_op_threads);
 
   RunHandlerPool(int num_inter_op_threads, int num_intra_op_threads);
+
+  // Partitions the threads evenly into one sub-pool per NUMA node, for
+  // `num_numa_nodes` nodes (but at most one node per inter-op thread). The
+  // threads of each sub-pool are pinned to their node, and each RunHandler
+  // returned by Get() runs all of its inter- and intra-op closures on the
+  // sub-pool of a single node, chosen as the node with the fewest active
+  // handlers. This keeps the memory traffic of a request on one socket.
+  //
+  // If `num_numa_nodes` is 1, this is the same as the constructor above.
+  RunHandlerPool(int num_inter_op_threads, int num_intra_op_threads,
+                 int num_numa_nodes);
   ~RunHandlerPool();
 
   // Returns an inactive RunHandler from the pool.
@@ -72,6 +83,9 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Returns the number of NUMA nodes that the threads are partitioned into.
+  int NumNumaNodes() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -96,6 +110,10 @@ class RunHandler {
   void ScheduleInterOpClosure(std::function<void()> fn);
   thread::ThreadPoolInterface* AsIntraThreadPoolInterface();
 
+  // Returns the NUMA node whose threads run the closures of this handler, or
+  // `port::kNUMANoAffinity` if the pool is not partitioned by NUMA node.
+  int NumaNode() const;
+
   ~RunHandler();
 
  private:
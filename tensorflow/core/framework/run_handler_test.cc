@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
@@ -113,6 +114,48 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, NumaPartitionedScheduling) {
+  const int num_threads = 4;
+  const int num_numa_nodes = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads, num_numa_nodes));
+  EXPECT_EQ(num_numa_nodes, pool->NumNumaNodes());
+
+  // Handlers are spread across the NUMA nodes.
+  auto handler1 = pool->Get(/*step_id=*/1);
+  auto handler2 = pool->Get(/*step_id=*/2);
+  EXPECT_NE(handler1->NumaNode(), handler2->NumaNode());
+  EXPECT_GE(handler1->NumaNode(), 0);
+  EXPECT_GE(handler2->NumaNode(), 0);
+
+  // Each handler only sees the threads of its own node: half of the inter-op
+  // and half of the intra-op threads.
+  for (RunHandler* handler : {handler1.get(), handler2.get()}) {
+    EXPECT_EQ(2 * num_threads / num_numa_nodes,
+              handler->AsIntraThreadPoolInterface()->NumThreads());
+  }
+
+  BlockingCounter counter(4 * num_threads);
+  for (RunHandler* handler : {handler1.get(), handler2.get()}) {
+    auto intra_thread_pool = handler->AsIntraThreadPoolInterface();
+    for (int j = 0; j < num_threads; ++j) {
+      handler->ScheduleInterOpClosure(
+          [&counter]() { counter.DecrementCount(); });
+      intra_thread_pool->Schedule([&counter]() { counter.DecrementCount(); });
+    }
+  }
+  counter.Wait();
+}
+
+TEST(RunHandlerUtilTest, NumaNodesAreLimitedByInterOpThreads) {
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(/*num_inter_op_threads=*/1,
+                         /*num_intra_op_threads=*/1, /*num_numa_nodes=*/4));
+  EXPECT_EQ(1, pool->NumNumaNodes());
+  auto handler = pool->Get(/*step_id=*/1);
+  EXPECT_EQ(port::kNUMANoAffinity, handler->NumaNode());
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/shared_tensor_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+SharedTensorStore* SharedTensorStore::Global() {
+  static SharedTensorStore* store = new SharedTensorStore;
+  return store;
+}
+
+bool SharedTensorStore::Enabled() {
+  static const bool enabled = [] {
+    bool enabled;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_SHARE_CONSTANT_TENSORS",
+                                   /*default_val=*/false, &enabled));
+    return enabled;
+  }();
+  return enabled;
+}
+
+Tensor SharedTensorStore::Intern(const Tensor& tensor) {
+  if (!tensor.IsInitialized() || !DataTypeCanUseMemcpy(tensor.dtype()) ||
+      tensor.TotalBytes() < kMinBytes || !tensor.IsAligned()) {
+    return tensor;
+  }
+  const StringPiece data = tensor.tensor_data();
+  const uint64 fingerprint =
+      FingerprintCat64(Fingerprint64(data), tensor.dtype());
+
+  mutex_lock l(mu_);
+  std::vector<Tensor>& candidates = tensors_[fingerprint];
+  for (const Tensor& candidate : candidates) {
+    const StringPiece candidate_data = candidate.tensor_data();
+    if (candidate.dtype() == tensor.dtype() &&
+        candidate_data.size() == data.size() &&
+        (candidate_data.data() == data.data() ||
+         std::memcmp(candidate_data.data(), data.data(), data.size()) == 0)) {
+      Tensor shared;
+      CHECK(shared.CopyFrom(candidate, tensor.shape()));
+      return shared;
+    }
+  }
+  candidates.push_back(tensor);
+  ++num_tensors_;
+  num_bytes_ += data.size();
+  if (num_tensors_ >= release_threshold_) {
+    ReleaseUnusedLocked();
+    release_threshold_ = std::max<size_t>(64, 2 * num_tensors_);
+  }
+  return tensor;
+}
+
+void SharedTensorStore::ReleaseUnused() {
+  mutex_lock l(mu_);
+  ReleaseUnusedLocked();
+}
+
+void SharedTensorStore::ReleaseUnusedLocked() {
+  for (auto it = tensors_.begin(); it != tensors_.end();) {
+    std::vector<Tensor>& candidates = it->second;
+    for (size_t i = 0; i < candidates.size();) {
+      if (candidates[i].RefCountIsOne()) {
+        --num_tensors_;
+        num_bytes_ -= candidates[i].TotalBytes();
+        candidates[i] = std::move(candidates.back());
+        candidates.pop_back();
+      } else {
+        ++i;
+      }
+    }
+    if (candidates.empty()) {
+      tensors_.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+size_t SharedTensorStore::num_tensors() const {
+  mutex_lock l(mu_);
+  return num_tensors_;
+}
+
+size_t SharedTensorStore::num_bytes() const {
+  mutex_lock l(mu_);
+  return num_bytes_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_SHARED_TENSOR_STORE_H_
+#define TENSORFLOW_CORE_FRAMEWORK_SHARED_TENSOR_STORE_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A process-wide store of read-only host tensors, keyed by their contents, so
+// that sessions that load the same weights, e.g. several copies of one
+// SavedModel, keep a single copy of them in memory.
+//
+// Intern() returns a tensor that shares its buffer with an equal tensor that
+// was interned before, if there is one. The store keeps a reference to every
+// buffer it hands out, so a shared buffer is never forwarded to the output of
+// a kernel and written in place: resource variables copy their tensor before
+// updating it when its buffer is shared, and ref variables copy assigned
+// values into their own buffer. Buffers that only the store references are
+// dropped by ReleaseUnused(), which also runs once the store has doubled in
+// size since it last ran.
+//
+// The Const kernel and the restore kernels on CPU intern their tensors when
+// the environment variable TF_SHARE_CONSTANT_TENSORS is true.
+//
+// This class is thread-safe.
+class SharedTensorStore {
+ public:
+  // Smaller tensors are not worth hashing.
+  static constexpr size_t kMinBytes = 1024;
+
+  SharedTensorStore() = default;
+
+  SharedTensorStore(const SharedTensorStore&) = delete;
+  void operator=(const SharedTensorStore&) = delete;
+
+  // Returns the process-wide store.
+  static SharedTensorStore* Global();
+
+  // Whether kernels should intern the tensors they load.
+  static bool Enabled();
+
+  // Returns a tensor equal to `tensor`, which must be in host memory, and
+  // which shares its buffer with an equal tensor interned before if there is
+  // one. Otherwise, or if `tensor` cannot be shared, returns `tensor`.
+  Tensor Intern(const Tensor& tensor);
+
+  // Drops the buffers that only the store references.
+  void ReleaseUnused();
+
+  // The number and total size of the buffers held by the store.
+  size_t num_tensors() const;
+  size_t num_bytes() const;
+
+ private:
+  void ReleaseUnusedLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  // The interned tensors, by fingerprint of their dtype and contents.
+  absl::flat_hash_map<uint64, std::vector<Tensor>> tensors_ TF_GUARDED_BY(mu_);
+  size_t num_tensors_ TF_GUARDED_BY(mu_) = 0;
+  size_t num_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // ReleaseUnused() runs when num_tensors_ reaches this.
+  size_t release_threshold_ TF_GUARDED_BY(mu_) = 64;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_SHARED_TENSOR_STORE_H_
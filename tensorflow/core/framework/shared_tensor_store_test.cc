@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/shared_tensor_store.h"
+
+#include <cstring>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor MakeTensor(float value, const TensorShape& shape = {16, 16}) {
+  Tensor t(DT_FLOAT, shape);
+  t.flat<float>().setConstant(value);
+  return t;
+}
+
+TEST(SharedTensorStoreTest, SharesEqualTensors) {
+  SharedTensorStore store;
+  Tensor a = store.Intern(MakeTensor(1.0f));
+  Tensor b = store.Intern(MakeTensor(1.0f));
+  EXPECT_TRUE(a.SharesBufferWith(b));
+  test::ExpectTensorEqual<float>(a, MakeTensor(1.0f));
+  EXPECT_EQ(store.num_tensors(), 1);
+  EXPECT_EQ(store.num_bytes(), a.TotalBytes());
+}
+
+TEST(SharedTensorStoreTest, KeepsDifferentTensorsApart) {
+  SharedTensorStore store;
+  Tensor a = store.Intern(MakeTensor(1.0f));
+  Tensor b = store.Intern(MakeTensor(2.0f));
+  EXPECT_FALSE(a.SharesBufferWith(b));
+  Tensor c = MakeTensor(1.0f);
+  Tensor d(DT_INT32, c.shape());
+  std::memcpy(d.data(), c.data(), c.TotalBytes());
+  d = store.Intern(d);
+  EXPECT_FALSE(a.SharesBufferWith(d));
+  EXPECT_EQ(store.num_tensors(), 3);
+}
+
+TEST(SharedTensorStoreTest, SharesAcrossShapes) {
+  SharedTensorStore store;
+  Tensor a = store.Intern(MakeTensor(1.0f, {16, 16}));
+  Tensor b = store.Intern(MakeTensor(1.0f, {256}));
+  EXPECT_TRUE(a.SharesBufferWith(b));
+  EXPECT_EQ(b.shape(), TensorShape({256}));
+}
+
+TEST(SharedTensorStoreTest, SkipsSmallTensors) {
+  SharedTensorStore store;
+  Tensor a = store.Intern(MakeTensor(1.0f, {2}));
+  Tensor b = store.Intern(MakeTensor(1.0f, {2}));
+  EXPECT_FALSE(a.SharesBufferWith(b));
+  EXPECT_EQ(store.num_tensors(), 0);
+}
+
+TEST(SharedTensorStoreTest, SharedBufferIsNotForwardable) {
+  SharedTensorStore store;
+  Tensor a = store.Intern(MakeTensor(1.0f));
+  // The store's reference keeps kernels from updating `a` in place.
+  EXPECT_FALSE(a.RefCountIsOne());
+}
+
+TEST(SharedTensorStoreTest, ReleasesUnusedTensors) {
+  SharedTensorStore store;
+  Tensor a = store.Intern(MakeTensor(1.0f));
+  { Tensor b = store.Intern(MakeTensor(2.0f)); }
+  store.ReleaseUnused();
+  EXPECT_EQ(store.num_tensors(), 1);
+  EXPECT_EQ(store.num_bytes(), a.TotalBytes());
+  a = Tensor();
+  store.ReleaseUnused();
+  EXPECT_EQ(store.num_tensors(), 0);
+  EXPECT_EQ(store.num_bytes(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
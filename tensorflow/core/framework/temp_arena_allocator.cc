@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/temp_arena_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// The total size of the blocks of all the thread arenas. Threads that would
+// exceed it allocate their scratch temporaries from the base allocator, so
+// idle threads cannot hold an unbounded amount of memory between them.
+constexpr size_t kMaxTotalBlockBytes = 64 << 20;
+std::atomic<size_t> total_block_bytes{0};
+
+// Returns true if `base` is never destroyed. Thread arenas are keyed by their
+// base allocator and free their block into it when their thread exits, which
+// is only safe if the base allocator outlives every thread, and if its address
+// is never reused by another allocator.
+bool IsProcessLifetimeAllocator(Allocator* base) {
+  return base == cpu_allocator() || base == cpu_allocator_base();
+}
+
+// The arenas of a thread, one per base allocator.
+class ThreadArenas {
+ public:
+  ~ThreadArenas() {
+    for (auto& arena : arenas_) {
+      if (arena.second->in_use()) {
+        // A temporary outlived its thread; its buffer still points into the
+        // block, so leak the arena rather than freeing it under the buffer.
+        VLOG(1) << "Leaking " << arena.second->Name() << " at thread exit";
+        arena.second.release();
+      } else {
+        total_block_bytes.fetch_sub(TempArenaAllocator::kDefaultBlockBytes,
+                                    std::memory_order_relaxed);
+      }
+    }
+  }
+
+  TempArenaAllocator* Get(Allocator* base) {
+    for (auto& arena : arenas_) {
+      if (arena.first == base) return arena.second.get();
+    }
+    if (!IsProcessLifetimeAllocator(base)) return nullptr;
+    const size_t block_bytes = TempArenaAllocator::kDefaultBlockBytes;
+    if (total_block_bytes.fetch_add(block_bytes, std::memory_order_relaxed) >=
+        kMaxTotalBlockBytes) {
+      total_block_bytes.fetch_sub(block_bytes, std::memory_order_relaxed);
+      return nullptr;
+    }
+    arenas_.emplace_back(
+        base, std::make_unique<TempArenaAllocator>(base, block_bytes));
+    return arenas_.back().second.get();
+  }
+
+ private:
+  std::vector<std::pair<Allocator*, std::unique_ptr<TempArenaAllocator>>>
+      arenas_;
+};
+
+}  // namespace
+
+TempArenaAllocator::TempArenaAllocator(Allocator* base, size_t block_bytes)
+    : base_(base),
+      block_bytes_(block_bytes),
+      block_(static_cast<char*>(
+          base->AllocateRaw(kAllocatorAlignment, block_bytes))) {
+  if (block_ == nullptr) {
+    LOG(WARNING) << "Could not allocate a temp arena of " << block_bytes
+                 << " bytes from " << base->Name();
+  }
+}
+
+TempArenaAllocator::~TempArenaAllocator() {
+  DCHECK(!in_use()) << "Temporaries are still in use";
+  if (block_ != nullptr) base_->DeallocateRaw(block_);
+}
+
+TempArenaAllocator* TempArenaAllocator::ForCurrentThread(Allocator* base) {
+  static thread_local ThreadArenas arenas;
+  return arenas.Get(base);
+}
+
+void* TempArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  if (block_ == nullptr || num_bytes > block_bytes_ / 4 ||
+      alignment > kAllocatorAlignment) {
+    return base_->AllocateRaw(alignment, num_bytes);
+  }
+  // Every buffer has been freed, so start over.
+  if (!in_use()) offset_ = 0;
+  const size_t rounded_bytes =
+      (std::max<size_t>(num_bytes, 1) + kAllocatorAlignment - 1) /
+      kAllocatorAlignment * kAllocatorAlignment;
+  if (offset_ + rounded_bytes > block_bytes_) {
+    return base_->AllocateRaw(alignment, num_bytes);
+  }
+  void* ptr = block_ + offset_;
+  offset_ += rounded_bytes;
+  num_live_.fetch_add(1, std::memory_order_relaxed);
+  return ptr;
+}
+
+void TempArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  if (InBlock(ptr)) {
+    num_live_.fetch_sub(1, std::memory_order_release);
+  } else {
+    base_->DeallocateRaw(ptr);
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,86 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_TEMP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_FRAMEWORK_TEMP_ARENA_ALLOCATOR_H_
+
+#include <atomic>
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An allocator that carves buffers out of a block of host memory by bumping
+// an offset, for the temporaries that kernels allocate and free within one
+// call to Compute(). OpKernelContext::allocate_temp() uses the arena of the
+// calling thread for allocations with AllocatorAttributes::scratch() set.
+//
+// The block is reused from its start as soon as every buffer carved from it
+// has been freed, which for temporaries is when the kernel that allocated
+// them finishes. Buffers that are larger than `block_bytes / 4`, or that do
+// not fit in the rest of the block, come from the base allocator instead,
+// so a temporary that outlives its kernel only costs the arena its space.
+//
+// AllocateRaw() must only be called by one thread at a time, which
+// ForCurrentThread() guarantees. DeallocateRaw() may be called on any thread.
+class TempArenaAllocator : public Allocator {
+ public:
+  static constexpr size_t kDefaultBlockBytes = 1 << 20;
+
+  // `base` is not owned, must allocate host memory, and must outlive the
+  // arena.
+  explicit TempArenaAllocator(Allocator* base,
+                              size_t block_bytes = kDefaultBlockBytes);
+  ~TempArenaAllocator() override;
+
+  // Returns the arena of the calling thread over `base`, or nullptr if
+  // `base` should be used directly: arenas are only kept for the process-wide
+  // CPU allocators, which are never destroyed, and the blocks of all the
+  // thread arenas are capped at 64MiB in total.
+  static TempArenaAllocator* ForCurrentThread(Allocator* base);
+
+  std::string Name() override { return base_->Name() + "_temp_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Whether any buffer carved from the block has not been freed yet.
+  bool in_use() const {
+    return num_live_.load(std::memory_order_acquire) > 0;
+  }
+
+ private:
+  bool InBlock(const void* ptr) const {
+    const char* p = static_cast<const char*>(ptr);
+    return block_ != nullptr && p >= block_ && p < block_ + block_bytes_;
+  }
+
+  Allocator* const base_;  // Not owned.
+  const size_t block_bytes_;
+  // Null if the base allocator could not allocate it.
+  char* const block_;
+  // Only AllocateRaw() accesses this.
+  size_t offset_ = 0;
+  // The number of buffers carved from the block that have not been freed.
+  std::atomic<int64_t> num_live_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_TEMP_ARENA_ALLOCATOR_H_
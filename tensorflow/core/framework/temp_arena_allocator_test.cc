@@ -0,0 +1,155 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/temp_arena_allocator.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kBlockBytes = 64 << 10;
+
+bool InBlock(void* ptr, void* first, size_t block_bytes = kBlockBytes) {
+  char* p = static_cast<char*>(ptr);
+  char* block = static_cast<char*>(first);
+  return p >= block && p < block + block_bytes;
+}
+
+TEST(TempArenaAllocatorTest, ReusesBlockOnceEverythingIsFreed) {
+  TempArenaAllocator arena(cpu_allocator(), kBlockBytes);
+  void* a = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  ASSERT_NE(a, nullptr);
+  EXPECT_EQ(static_cast<char*>(b) - static_cast<char*>(a),
+            Allocator::kAllocatorAlignment * 2);
+  EXPECT_TRUE(arena.in_use());
+  arena.DeallocateRaw(a);
+  // `b` is still live, so the block is not reused yet.
+  void* c = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_GT(c, b);
+  arena.DeallocateRaw(b);
+  arena.DeallocateRaw(c);
+  EXPECT_FALSE(arena.in_use());
+  void* d = arena.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_EQ(d, a);
+  arena.DeallocateRaw(d);
+}
+
+TEST(TempArenaAllocatorTest, FallsBackToBaseAllocator) {
+  TempArenaAllocator arena(cpu_allocator(), kBlockBytes);
+  void* first = arena.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  // Too large for the arena.
+  void* large = arena.AllocateRaw(Allocator::kAllocatorAlignment,
+                                  kBlockBytes / 2);
+  EXPECT_FALSE(InBlock(large, first));
+  // Does not fit in the rest of the block.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(arena.AllocateRaw(Allocator::kAllocatorAlignment,
+                                     kBlockBytes / 4));
+  }
+  EXPECT_TRUE(InBlock(ptrs[0], first));
+  EXPECT_FALSE(InBlock(ptrs.back(), first));
+  for (void* ptr : ptrs) arena.DeallocateRaw(ptr);
+  arena.DeallocateRaw(large);
+  arena.DeallocateRaw(first);
+  EXPECT_FALSE(arena.in_use());
+}
+
+TEST(TempArenaAllocatorTest, TensorsOutliveKernel) {
+  TempArenaAllocator arena(cpu_allocator(), kBlockBytes);
+  Tensor escaped(&arena, DT_FLOAT, TensorShape({16}));
+  escaped.flat<float>().setConstant(1.0f);
+  {
+    Tensor temp(&arena, DT_FLOAT, TensorShape({16}));
+    temp.flat<float>().setConstant(2.0f);
+  }
+  // The block is not reused while `escaped` is live.
+  Tensor next(&arena, DT_FLOAT, TensorShape({16}));
+  next.flat<float>().setConstant(3.0f);
+  EXPECT_EQ(escaped.flat<float>()(0), 1.0f);
+  EXPECT_FALSE(next.SharesBufferWith(escaped));
+}
+
+TEST(TempArenaAllocatorTest, FreesOnOtherThreads) {
+  TempArenaAllocator arena(cpu_allocator(), kBlockBytes);
+  void* a = arena.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  {
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "free", [&arena, a] { arena.DeallocateRaw(a); }));
+  }
+  EXPECT_FALSE(arena.in_use());
+}
+
+TEST(TempArenaAllocatorTest, ForCurrentThread) {
+  TempArenaAllocator* arena = TempArenaAllocator::ForCurrentThread(
+      cpu_allocator());
+  EXPECT_EQ(arena, TempArenaAllocator::ForCurrentThread(cpu_allocator()));
+  TempArenaAllocator* other = nullptr;
+  {
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "other", [&other] {
+          other = TempArenaAllocator::ForCurrentThread(cpu_allocator());
+        }));
+  }
+  EXPECT_NE(arena, other);
+}
+
+TEST(TempArenaAllocatorTest, NoThreadArenaOverShortLivedAllocators) {
+  // The thread arenas would outlive `base`, so it is used directly.
+  TempArenaAllocator base(cpu_allocator(), kBlockBytes);
+  EXPECT_EQ(nullptr, TempArenaAllocator::ForCurrentThread(&base));
+}
+
+TEST(TempArenaAllocatorTest, CapsTotalThreadArenaBytes) {
+  // Far more threads than the blocks that fit under the cap.
+  constexpr int kNumThreads = 128;
+  std::vector<TempArenaAllocator*> arenas(kNumThreads);
+  {
+    mutex mu;
+    condition_variable cv;
+    int num_done = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+    for (int i = 0; i < kNumThreads; ++i) {
+      threads.emplace_back(Env::Default()->StartThread(
+          ThreadOptions(), "arena", [&, i] {
+            arenas[i] = TempArenaAllocator::ForCurrentThread(cpu_allocator());
+            // Keep every thread, and its arena, alive until all have asked
+            // for one.
+            mutex_lock l(mu);
+            ++num_done;
+            cv.notify_all();
+            while (num_done < kNumThreads) cv.wait(l);
+          }));
+    }
+  }
+  int num_arenas = 0;
+  for (TempArenaAllocator* arena : arenas) {
+    if (arena != nullptr) ++num_arenas;
+  }
+  EXPECT_GT(num_arenas, 0);
+  EXPECT_LE(num_arenas * TempArenaAllocator::kDefaultBlockBytes,
+            size_t{64} << 20);
+}
+
+}  // namespace
+}  // namespace tensorflow
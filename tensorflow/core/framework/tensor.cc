@@ -584,6 +584,56 @@ Buffer<T>::~Buffer() {
   }
 }
 
+// The largest size of the values stored in an InlineBuffer.
+constexpr size_t kMaxInlineBufferBytes = 16;
+
+// A buffer of up to kMaxInlineBufferBytes of simple type values, e.g. a scalar
+// or the small shape tensors of shape arithmetic, stored inline with the
+// buffer object so that creating it takes a single heap allocation instead of
+// a call to the allocator.
+class InlineBuffer : public TensorBuffer {
+ public:
+  explicit InlineBuffer(size_t size) : TensorBuffer(data_), size_(size) {
+    DCHECK_LE(size, kMaxInlineBufferBytes);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  ~InlineBuffer() override = default;
+
+  const size_t size_;
+  alignas(EIGEN_MAX_ALIGN_BYTES) char data_[kMaxInlineBufferBytes];
+};
+
+// Returns a buffer for "n" values of type T allocated from "a". The values are
+// stored inline if they are small simple type values, and "a" is the plain CPU
+// allocator, whose allocations have no other observable effect than returning
+// host memory.
+template <typename T>
+TensorBuffer* NewBuffer(Allocator* a, int64_t n,
+                        const AllocationAttributes& allocation_attr) {
+  if (is_simple_type<T>::value && sizeof(T) * n <= kMaxInlineBufferBytes &&
+      allocation_attr.freed_by_func == nullptr && a == cpu_allocator_base() &&
+      !CPUAllocatorFullStatsEnabled() && !MemoryLoggingEnabled()) {
+    return new InlineBuffer(sizeof(T) * n);
+  }
+  return new Buffer<T>(a, n, allocation_attr);
+}
+
 // Allocates a T[n] buffer. Fills in the buffer with repeated values
 // in "in".  If "in" has less values than "n", fills the rest of T[n]
 // with the last value. If "in" has no values, fills T[n] with the
@@ -969,7 +1019,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
+    CASES(type, buf_ = NewBuffer<T>(a, shape.num_elements(),
+                                     AllocationAttributes()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
     LogMemory::RecordTensorAllocation("Unknown", LogMemory::UNKNOWN_STEP_ID,
@@ -983,7 +1034,8 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
   set_dtype(type);
   CHECK_NOTNULL(a);
   if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
-    CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
+    CASES(type,
+          buf_ = NewBuffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
       buf_ != nullptr && buf_->data() != nullptr) {
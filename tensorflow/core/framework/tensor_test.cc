@@ -19,6 +19,8 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
@@ -1165,6 +1167,31 @@ TEST(Tensor_Float, SimpleBuildTensor) {
   ASSERT_EQ(t.AllocatedBytes(), 800);  // 10 * 20 * 4
 }
 
+TEST(Tensor_Float, SmallWithCPUAllocator) {
+  Tensor t(cpu_allocator_base(), DT_FLOAT, TensorShape({2, 2}));
+  EXPECT_TRUE(t.IsAligned());
+  for (int i = 0; i < 4; ++i) {
+    t.flat<float>()(i) = 1.5f * i;
+  }
+  TestCopies<float>(t);
+  Tensor scalar(cpu_allocator_base(), DT_INT64, TensorShape({}),
+                AllocationAttributes());
+  EXPECT_TRUE(scalar.IsAligned());
+  scalar.scalar<int64_t>()() = 42;
+  EXPECT_EQ(42, scalar.scalar<int64_t>()());
+
+  // Tensors of up to 16 bytes from the plain CPU allocator are stored inline
+  // with their buffer.
+  TensorDescription p;
+  t.FillDescription(&p);
+  if (!CPUAllocatorFullStatsEnabled() && !LogMemory::IsEnabled()) {
+    EXPECT_EQ("InlineBuffer", p.allocation_description().allocator_name());
+  }
+  Tensor large(cpu_allocator_base(), DT_FLOAT, TensorShape({5}));
+  large.FillDescription(&p);
+  EXPECT_NE("InlineBuffer", p.allocation_description().allocator_name());
+}
+
 TEST(Tensor_Float, SimpleWithAllocator) {
   EnableCPUAllocatorFullStats();
   auto* a = cpu_allocator();
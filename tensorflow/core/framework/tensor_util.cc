@@ -16,8 +16,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_util.h"
 
 #include <cmath>
+#include <memory>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/type_traits.h"
@@ -442,5 +445,184 @@ Status MakeShape(const Tensor& shape, TensorShape* out) {
   }
 }
 
+namespace {
+
+// The protocol buffer wire types of the fields of a TensorProto.
+enum WireType {
+  WIRETYPE_VARINT = 0,
+  WIRETYPE_FIXED64 = 1,
+  WIRETYPE_LENGTH_DELIMITED = 2,
+  WIRETYPE_FIXED32 = 5,
+};
+
+// A TensorBuffer that points into a serialized TensorProto, and keeps its
+// owner alive.
+class AliasedTensorBuffer : public TensorBuffer {
+ public:
+  AliasedTensorBuffer(std::shared_ptr<const void> owner, const void* data,
+                      size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        owner_(std::move(owner)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("aliased_tensor_proto");
+  }
+  // The memory belongs to the owner of the serialized proto.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<const void> owner_;
+  const size_t size_;
+};
+
+// Parses "serialized" as a TensorProto, except for its tensor_content field,
+// whose location in "serialized" is returned in "*content" instead. Returns
+// false if "serialized" is malformed.
+bool ParseTensorProtoSkeleton(StringPiece serialized, TensorProto* skeleton,
+                              StringPiece* content) {
+  protobuf::io::CodedInputStream input(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  string skeleton_bytes;
+  while (true) {
+    const int field_begin = input.CurrentPosition();
+    const uint32 tag = input.ReadTag();
+    if (tag == 0) break;
+    bool ok = false;
+    switch (static_cast<WireType>(tag & 0x7)) {
+      case WIRETYPE_VARINT: {
+        protobuf_uint64 unused;
+        ok = input.ReadVarint64(&unused);
+        break;
+      }
+      case WIRETYPE_FIXED64:
+        ok = input.Skip(sizeof(uint64));
+        break;
+      case WIRETYPE_FIXED32:
+        ok = input.Skip(sizeof(uint32));
+        break;
+      case WIRETYPE_LENGTH_DELIMITED: {
+        uint32 length;
+        if (!input.ReadVarint32(&length)) return false;
+        const int value_begin = input.CurrentPosition();
+        ok = input.Skip(length);
+        if (ok && (tag >> 3) == TensorProto::kTensorContentFieldNumber) {
+          // As for any singular field, the last occurrence wins.
+          *content = serialized.substr(value_begin, length);
+          continue;
+        }
+        break;
+      }
+      default:
+        // Groups are not used by TensorProto.
+        return false;
+    }
+    if (!ok) return false;
+    skeleton_bytes.append(serialized.data() + field_begin,
+                          input.CurrentPosition() - field_begin);
+  }
+  return input.ConsumedEntireMessage() &&
+         skeleton->ParseFromString(skeleton_bytes);
+}
+
+}  // namespace
+
+Status SerializeTensorProtoToZeroCopyStream(
+    const Tensor& tensor, protobuf::io::ZeroCopyOutputStream* output) {
+  protobuf::io::CodedOutputStream coded(output);
+  if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+    // Strings and variants are encoded element by element anyway.
+    TensorProto proto;
+    tensor.AsProtoTensorContent(&proto);
+    if (!proto.SerializeToCodedStream(&coded)) {
+      return errors::InvalidArgument("Cannot serialize tensor of shape ",
+                                     tensor.shape().DebugString(), " and type ",
+                                     DataTypeString(tensor.dtype()));
+    }
+    return OkStatus();
+  }
+
+  // The skeleton holds every field but tensor_content, which has the highest
+  // field number, so writing the content after it matches the serialization
+  // of the whole proto.
+  TensorProto skeleton;
+  skeleton.set_dtype(tensor.dtype());
+  tensor.shape().AsProto(skeleton.mutable_tensor_shape());
+  const StringPiece content = tensor.tensor_data();
+  size_t total_bytes = skeleton.ByteSizeLong();
+  if (!content.empty()) {
+    total_bytes += protobuf::io::CodedOutputStream::VarintSize32(
+                       TensorProto::kTensorContentFieldNumber << 3) +
+                   protobuf::io::CodedOutputStream::VarintSize64(
+                       content.size()) +
+                   content.size();
+  }
+  if (total_bytes > static_cast<size_t>(kint32max)) {
+    return errors::InvalidArgument(
+        "Cannot serialize a tensor that exceeds the 2GB protobuf limit. "
+        "Encoded bytes: ",
+        total_bytes, ", tensor shape: ", tensor.shape().DebugString());
+  }
+
+  coded.EnableAliasing(true);
+  skeleton.SerializeWithCachedSizes(&coded);
+  if (!content.empty()) {
+    coded.WriteTag((TensorProto::kTensorContentFieldNumber << 3) |
+                   WIRETYPE_LENGTH_DELIMITED);
+    coded.WriteVarint64(content.size());
+    coded.WriteRawMaybeAliased(content.data(), content.size());
+  }
+  if (coded.HadError()) {
+    return errors::Internal("Failed to write the serialized tensor of shape ",
+                            tensor.shape().DebugString(), " to the stream");
+  }
+  return OkStatus();
+}
+
+Status ParseTensorProtoAliasing(StringPiece serialized,
+                                std::shared_ptr<const void> owner,
+                                Tensor* tensor) {
+  TensorProto skeleton;
+  StringPiece content;
+  if (!ParseTensorProtoSkeleton(serialized, &skeleton, &content)) {
+    return errors::InvalidArgument("Cannot parse serialized TensorProto");
+  }
+  if (!content.empty() && DataTypeCanUseMemcpy(skeleton.dtype()) &&
+      reinterpret_cast<intptr_t>(content.data()) % EIGEN_MAX_ALIGN_BYTES ==
+          0) {
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(
+        TensorShape::BuildTensorShape(skeleton.tensor_shape(), &shape));
+    const size_t expected_size =
+        shape.num_elements() * DataTypeSize(skeleton.dtype());
+    if (content.size() != expected_size) {
+      return errors::InvalidArgument(
+          "Serialized TensorProto has ", content.size(),
+          " bytes of tensor content, expected ", expected_size, " for shape ",
+          shape.DebugString());
+    }
+    core::RefCountPtr<TensorBuffer> buffer(new AliasedTensorBuffer(
+        std::move(owner), content.data(), content.size()));
+    *tensor = Tensor(skeleton.dtype(), shape, std::move(buffer));
+    return OkStatus();
+  }
+
+  // Copy the content like Tensor::FromProto(), reusing the parsed skeleton.
+  if (!content.empty()) {
+    skeleton.set_tensor_content(content.data(), content.size());
+  }
+  Tensor parsed;
+  if (!parsed.FromProto(skeleton)) {
+    return errors::InvalidArgument("Cannot parse tensor of type ",
+                                   DataTypeString(skeleton.dtype()),
+                                   " from serialized TensorProto");
+  }
+  *tensor = std::move(parsed);
+  return OkStatus();
+}
+
 }  // namespace tensor
 }  // namespace tensorflow
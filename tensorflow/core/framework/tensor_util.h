@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_FRAMEWORK_TENSOR_UTIL_H_
 
 #include <algorithm>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -353,6 +354,28 @@ inline bool CompressTensorProtoInPlace(TensorProto* tensor) {
 // 1-dimensional tensor of type int32 or int64.
 Status MakeShape(const Tensor& shape_t, TensorShape* out);
 
+// Serializes the TensorProto that `tensor.AsProtoTensorContent()` would fill
+// in to "output", byte for byte, without building the TensorProto first. The
+// tensor content is written straight from the buffer of "tensor" instead of
+// being copied into the proto and then again into "output". If "output"
+// allows aliasing, the content is not copied at all and "output" refers to the
+// buffer of "tensor", which must then outlive the use of the written data.
+//
+// REQUIRES: 'tensor' must point to data stored in CPU memory.
+Status SerializeTensorProtoToZeroCopyStream(
+    const Tensor& tensor, protobuf::io::ZeroCopyOutputStream* output);
+
+// Parses the serialized TensorProto "serialized" into "*tensor". If the proto
+// holds the content of a memcpy-able tensor in its tensor_content field, and
+// that content is suitably aligned within "serialized", "*tensor" aliases it
+// instead of copying it, and keeps "owner" alive for as long as it does.
+// Otherwise the content is copied, as by `Tensor::FromProto()`.
+//
+// "owner" must keep the bytes of "serialized" alive and unchanged.
+Status ParseTensorProtoAliasing(StringPiece serialized,
+                                std::shared_ptr<const void> owner,
+                                Tensor* tensor);
+
 }  // namespace tensor
 }  // namespace tensorflow
 
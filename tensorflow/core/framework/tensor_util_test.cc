@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor_util.h"
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
@@ -736,5 +737,117 @@ TEST(TensorProtoUtil, CompressTensorProtoNegatizeZero) {
   }
 }
 
+string SerializeToZeroCopyStream(const Tensor& tensor) {
+  string serialized;
+  {
+    protobuf::io::StringOutputStream output(&serialized);
+    TF_CHECK_OK(tensor::SerializeTensorProtoToZeroCopyStream(tensor, &output));
+  }
+  return serialized;
+}
+
+string SerializeAsProtoTensorContent(const Tensor& tensor) {
+  TensorProto proto;
+  tensor.AsProtoTensorContent(&proto);
+  return proto.SerializeAsString();
+}
+
+TEST(TensorProtoUtil, SerializeTensorProtoToZeroCopyStream) {
+  Tensor scalar(1.5f);
+  EXPECT_EQ(SerializeToZeroCopyStream(scalar),
+            SerializeAsProtoTensorContent(scalar));
+
+  Tensor empty(DT_INT32, TensorShape({0, 3}));
+  EXPECT_EQ(SerializeToZeroCopyStream(empty),
+            SerializeAsProtoTensorContent(empty));
+
+  Tensor matrix = test::AsTensor<double>({1, 2, 3, 4, 5, 6}, {3, 2});
+  EXPECT_EQ(SerializeToZeroCopyStream(matrix),
+            SerializeAsProtoTensorContent(matrix));
+
+  Tensor slice = matrix.Slice(1, 3);
+  EXPECT_EQ(SerializeToZeroCopyStream(slice),
+            SerializeAsProtoTensorContent(slice));
+
+  Tensor strings = test::AsTensor<tstring>({"a", "bc", ""}, {3});
+  EXPECT_EQ(SerializeToZeroCopyStream(strings),
+            SerializeAsProtoTensorContent(strings));
+}
+
+// Returns a buffer holding "serialized" at an offset that places its last
+// "content_bytes" bytes "misalignment" bytes past an aligned address.
+std::shared_ptr<string> CopyToBuffer(const string& serialized,
+                                     size_t content_bytes, int misalignment,
+                                     StringPiece* copy) {
+  auto buffer = std::make_shared<string>(
+      serialized.size() + 2 * EIGEN_MAX_ALIGN_BYTES, '\0');
+  const intptr_t content_address = reinterpret_cast<intptr_t>(
+      buffer->data() + serialized.size() - content_bytes);
+  const size_t offset =
+      (EIGEN_MAX_ALIGN_BYTES - content_address % EIGEN_MAX_ALIGN_BYTES) %
+          EIGEN_MAX_ALIGN_BYTES +
+      misalignment;
+  buffer->replace(offset, serialized.size(), serialized);
+  *copy = StringPiece(buffer->data() + offset, serialized.size());
+  return buffer;
+}
+
+TEST(TensorProtoUtil, ParseTensorProtoAliasingAlignedContent) {
+  Tensor expected =
+      test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}, {3, 4});
+  StringPiece serialized;
+  std::shared_ptr<string> buffer =
+      CopyToBuffer(SerializeAsProtoTensorContent(expected),
+                   expected.TotalBytes(), /*misalignment=*/0, &serialized);
+
+  Tensor parsed;
+  TF_ASSERT_OK(tensor::ParseTensorProtoAliasing(serialized, buffer, &parsed));
+  test::ExpectTensorEqual<float>(expected, parsed);
+  // The content is aliased, and keeps the buffer alive.
+  EXPECT_EQ(parsed.tensor_data().data(),
+            serialized.data() + serialized.size() - expected.TotalBytes());
+  EXPECT_EQ(buffer.use_count(), 2);
+  buffer.reset();
+  test::ExpectTensorEqual<float>(expected, parsed);
+}
+
+TEST(TensorProtoUtil, ParseTensorProtoAliasingCopiesMisalignedContent) {
+  Tensor expected = test::AsTensor<int64_t>({1, 2, 3, 4}, {2, 2});
+  StringPiece serialized;
+  std::shared_ptr<string> buffer =
+      CopyToBuffer(SerializeAsProtoTensorContent(expected),
+                   expected.TotalBytes(), /*misalignment=*/1, &serialized);
+
+  Tensor parsed;
+  TF_ASSERT_OK(tensor::ParseTensorProtoAliasing(serialized, buffer, &parsed));
+  test::ExpectTensorEqual<int64_t>(expected, parsed);
+  EXPECT_EQ(buffer.use_count(), 1);
+}
+
+TEST(TensorProtoUtil, ParseTensorProtoAliasingNonContentFields) {
+  Tensor expected = test::AsTensor<tstring>({"a", "bc"}, {2});
+  const string serialized = SerializeAsProtoTensorContent(expected);
+  Tensor parsed;
+  TF_ASSERT_OK(
+      tensor::ParseTensorProtoAliasing(serialized, /*owner=*/nullptr, &parsed));
+  test::ExpectTensorEqual<tstring>(expected, parsed);
+}
+
+TEST(TensorProtoUtil, ParseTensorProtoAliasingRejectsWrongContentSize) {
+  TensorProto proto;
+  proto.set_dtype(DT_FLOAT);
+  proto.mutable_tensor_shape()->add_dim()->set_size(2);
+  proto.set_tensor_content(string(3 * sizeof(float), '\0'));
+  StringPiece serialized;
+  std::shared_ptr<string> buffer =
+      CopyToBuffer(proto.SerializeAsString(), proto.tensor_content().size(),
+                   /*misalignment=*/0, &serialized);
+  Tensor parsed;
+  EXPECT_FALSE(
+      tensor::ParseTensorProtoAliasing(serialized, buffer, &parsed).ok());
+  EXPECT_FALSE(tensor::ParseTensorProtoAliasing("garbage", nullptr, &parsed)
+                   .ok());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -547,44 +547,67 @@ Node* Graph::AddNode(NodeDef node_def, Status* status) {
   status->Update(ops_.LookUp(node_def.op(), &op_reg_data));
   if (!status->ok()) return nullptr;
 
-  DataTypeVector inputs;
-  DataTypeVector outputs;
-  status->Update(
-      InOutTypesForNode(node_def, op_reg_data->op_def, &inputs, &outputs));
-  if (!status->ok()) {
-    *status = AttachDef(*status, node_def);
-    return nullptr;
-  }
-
   Node::NodeClass node_class = op_reg_data->is_function_op
                                    ? Node::NC_FUNCTION_OP
                                    : Node::GetNodeClassForOp(node_def.op());
+  StatusOr<std::shared_ptr<NodeProperties>> props =
+      NewNodeProperties(*op_reg_data, std::move(node_def));
+  if (!props.ok()) {
+    *status = props.status();
+    return nullptr;
+  }
+  return AllocateNode(*std::move(props), nullptr, node_class);
+}
+
+StatusOr<std::shared_ptr<NodeProperties>> Graph::MakeNodeProperties(
+    NodeDef&& node_def) const {
+  const OpRegistrationData* op_reg_data;
+  TF_RETURN_IF_ERROR(ops_.LookUp(node_def.op(), &op_reg_data));
+  return NewNodeProperties(*op_reg_data, std::move(node_def));
+}
+
+StatusOr<Node*> Graph::AddNode(std::shared_ptr<NodeProperties> props) {
+  const OpRegistrationData* op_reg_data;
+  TF_RETURN_IF_ERROR(ops_.LookUp(props->node_def.op(), &op_reg_data));
+  Node::NodeClass node_class =
+      op_reg_data->is_function_op
+          ? Node::NC_FUNCTION_OP
+          : Node::GetNodeClassForOp(props->node_def.op());
+  return AllocateNode(std::move(props), nullptr, node_class);
+}
+
+/*static*/ StatusOr<std::shared_ptr<NodeProperties>> Graph::NewNodeProperties(
+    const OpRegistrationData& op_reg_data, NodeDef&& node_def) {
+  DataTypeVector inputs;
+  DataTypeVector outputs;
+  Status status =
+      InOutTypesForNode(node_def, op_reg_data.op_def, &inputs, &outputs);
+  if (!status.ok()) return AttachDef(status, node_def);
 
   if (node_def.has_experimental_type()) {
     VLOG(3) << "AddNode: node has type set, skipping type constructor "
             << node_def.name();
   } else {
-    if (op_reg_data->type_ctor != nullptr) {
+    if (op_reg_data.type_ctor != nullptr) {
       VLOG(3) << "AddNode: found type constructor for " << node_def.name();
-      Status s =
-          full_type::SpecializeType(AttrSlice(node_def), op_reg_data->op_def,
-                                    *(node_def.mutable_experimental_type()));
+      // The type is only set on success, so that `node_def` is unchanged on
+      // error.
+      FullTypeDef type;
+      Status s = full_type::SpecializeType(AttrSlice(node_def),
+                                           op_reg_data.op_def, type);
       if (!s.ok()) {
-        *status = errors::InvalidArgument("type error: ", s.ToString());
         VLOG(3) << "AddNode: type inference failed for " << node_def.name()
                 << ": " << s;
-        return nullptr;
+        return errors::InvalidArgument("type error: ", s.ToString());
       }
+      *node_def.mutable_experimental_type() = std::move(type);
     } else {
       VLOG(3) << "AddNode: no type constructor for " << node_def.name();
     }
   }
 
-  Node* node = AllocateNode(
-      std::make_shared<NodeProperties>(&op_reg_data->op_def,
-                                       std::move(node_def), inputs, outputs),
-      nullptr, node_class);
-  return node;
+  return std::make_shared<NodeProperties>(&op_reg_data.op_def,
+                                          std::move(node_def), inputs, outputs);
 }
 
 Node* Graph::CopyNode(const Node* node) {
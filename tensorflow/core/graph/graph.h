@@ -565,6 +565,18 @@ class Graph {
   // Same as above, but using StatusOr. This method is always preferred.
   StatusOr<Node*> AddNode(NodeDef node_def);
 
+  // Returns the properties of the node that `AddNode(node_def)` would add,
+  // without adding it. This method does not modify the graph, and may be called
+  // concurrently with itself, so that the (op lookup and type inference) work
+  // for the nodes of a large graph can be done in parallel.
+  // `node_def` is only moved from on success.
+  StatusOr<std::shared_ptr<NodeProperties>> MakeNodeProperties(
+      NodeDef&& node_def) const;
+
+  // Adds a new node with properties returned by `MakeNodeProperties()`, and
+  // returns it. *this owns the returned instance.
+  StatusOr<Node*> AddNode(std::shared_ptr<NodeProperties> props);
+
   // Copies *node, which may belong to another graph, to a new node,
   // which is returned.  Does not copy any edges.  *this owns the
   // returned instance.
@@ -849,6 +861,10 @@ class Graph {
   // Ownership of the returned Node is not transferred to caller.
   Node* AllocateNode(std::shared_ptr<NodeProperties> props,
                      const Node* cost_node, Node::NodeClass node_class);
+  // Computes the input and output types, and the full type, of a node for the
+  // op in `op_reg_data`. `node_def` is only moved from on success.
+  static StatusOr<std::shared_ptr<NodeProperties>> NewNodeProperties(
+      const OpRegistrationData& op_reg_data, NodeDef&& node_def);
   void ReleaseNode(Node* node);
   // Insert edge in free_edges_ for possible reuse.
   void RecycleEdge(const Edge* edge);
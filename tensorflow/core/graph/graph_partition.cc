@@ -290,6 +290,14 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   SetSendRecvAttrs(opts, edge, tensor_name_attr, &recv_builder);
   recv_builder.Device(dst->assigned_device_name())
       .Attr("tensor_type", cast_dtype);
+  // Let the receiver reuse recently received values of sources that tolerate
+  // bounded staleness, e.g. parameter server variable reads.
+  int64_t max_staleness_steps;
+  if (!edge->IsControlEdge() &&
+      TryGetNodeAttr(src->attrs(), "_max_staleness_steps",
+                     &max_staleness_steps)) {
+    recv_builder.Attr("_max_staleness_steps", max_staleness_steps);
+  }
   NodeDef* recv = gdef->add_node();
   *status = recv_builder.Finalize(recv, /*consume=*/true);
   if (!status->ok()) return nullptr;
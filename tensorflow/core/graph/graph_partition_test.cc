@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/graph.h"
@@ -291,6 +292,33 @@ TEST_F(GraphPartitionTest, CrossDeviceData) {
   ExpectMatchB();
 }
 
+TEST_F(GraphPartitionTest, CrossDeviceDataMaxStaleness) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  Combine(in_.WithOpName("B2"), a1, b1);
+  GraphDef graph_def = ToGraphDef();
+  for (NodeDef& ndef : *graph_def.mutable_node()) {
+    if (ndef.name() == "A1") {
+      AddNodeAttr("_max_staleness_steps", int64_t{3}, &ndef);
+    }
+  }
+
+  Partition(graph_def, &partitions_);
+  EXPECT_EQ(2, partitions_.size());
+
+  const GraphDef& b = partitions_["/job:a/replica:0/task:0/cpu:1"];
+  int num_recvs = 0;
+  for (const NodeDef& ndef : b.node()) {
+    if (ndef.op() != "_Recv") continue;
+    ++num_recvs;
+    int64_t max_staleness_steps;
+    TF_EXPECT_OK(
+        GetNodeAttr(ndef, "_max_staleness_steps", &max_staleness_steps));
+    EXPECT_EQ(max_staleness_steps, 3);
+  }
+  EXPECT_EQ(num_recvs, 1);
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceControl) {
   auto a1 = FloatInput(in_.WithOpName("A1"));
   auto b1 = FloatInput(in_.WithOpName("B1"));
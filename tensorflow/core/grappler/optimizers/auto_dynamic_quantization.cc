@@ -0,0 +1,520 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_dynamic_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/auto_dynamic_quantization_lists.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/quantization/uniform_quant_ops_attr.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kQuantizedDot[] = "UniformQuantizedDotHybrid";
+constexpr char kQuantizedConvolution[] = "UniformQuantizedConvolutionHybrid";
+
+// The weights are quantized symmetrically to [-127, 127], like the weights of
+// the hybrid kernels of TFLite, so that their zero points are all 0.
+constexpr int kQuantizedMin = -127;
+constexpr int kQuantizedMax = 127;
+
+// Quantizing the activations of ops with fewer weights costs more than
+// their int8 products save.
+constexpr int64_t kMinNumWeights = 1024;
+
+// A node to rewrite, with its constant weights and the shape of its input.
+struct Candidate {
+  NodeDef* node = nullptr;
+  Tensor weights;
+  PartialTensorShape input_shape;
+};
+
+class AutoDynamicQuantizationImpl {
+ public:
+  AutoDynamicQuantizationImpl(Cluster* cluster, const GrapplerItem& item,
+                              GraphDef* graph)
+      : item_(item), graph_(graph), node_map_(graph) {
+    if (cluster != nullptr) {
+      virtual_placer_ = std::make_unique<VirtualPlacer>(cluster->GetDevices());
+    }
+    AutoDynamicQuantizationLists lists;
+    allow_list_ = lists.AllowList();
+    deny_list_ = lists.DenyList();
+    clear_list_ = lists.ClearList();
+  }
+
+  Status Optimize();
+
+ private:
+  bool IsOnCpu(const NodeDef& node) const;
+
+  // Returns true if the outputs of `node` reach a denylist op, directly or
+  // through clearlist ops.
+  bool ReachesDenyListOp(const NodeDef& node) const;
+
+  // Returns the constant float weights of `node` at input `port` in `weights`,
+  // or false if they are not constant.
+  bool GetConstantWeights(const NodeDef& node, int port,
+                          Tensor* weights) const;
+
+  // Returns true if `node` can be rewritten, and the candidate to rewrite it
+  // in `candidate`.
+  bool GetDotCandidate(NodeDef* node, const GraphProperties& properties,
+                       Candidate* candidate) const;
+  bool GetConvolutionCandidate(NodeDef* node,
+                               const GraphProperties& properties,
+                               Candidate* candidate) const;
+
+  // Adds the constant nodes of the weights of `node` quantized per channel of
+  // their last dimension, and returns their names in `quantized_weights`,
+  // `scales` and `zero_points`.
+  void AddQuantizedWeights(const NodeDef& node, const Tensor& weights,
+                           string* quantized_weights, string* scales,
+                           string* zero_points);
+
+  NodeDef* AddConstNode(const string& name, const string& device,
+                        const Tensor& value);
+
+  Status RewriteDot(const Candidate& candidate);
+  Status RewriteConvolution(const Candidate& candidate);
+
+  const GrapplerItem& item_;
+  GraphDef* graph_;
+  NodeMap node_map_;
+  std::unique_ptr<VirtualPlacer> virtual_placer_;
+  gtl::FlatSet<string> allow_list_;
+  gtl::FlatSet<string> deny_list_;
+  gtl::FlatSet<string> clear_list_;
+};
+
+bool AutoDynamicQuantizationImpl::IsOnCpu(const NodeDef& node) const {
+  string device_name = node.device();
+  if (device_name.empty() && virtual_placer_ != nullptr) {
+    device_name = virtual_placer_->get_canonical_device_name(node);
+  }
+  if (device_name.empty()) return true;
+  string device;
+  string not_used;
+  return DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
+         absl::AsciiStrToLower(device) == "cpu";
+}
+
+bool AutoDynamicQuantizationImpl::ReachesDenyListOp(
+    const NodeDef& node) const {
+  std::vector<const NodeDef*> queue = {&node};
+  absl::flat_hash_set<const NodeDef*> visited = {&node};
+  while (!queue.empty()) {
+    const NodeDef* current = queue.back();
+    queue.pop_back();
+    for (const NodeDef* fanout : node_map_.GetOutputs(current->name())) {
+      if (!visited.insert(fanout).second) continue;
+      if (deny_list_.count(fanout->op())) return true;
+      if (clear_list_.count(fanout->op())) queue.push_back(fanout);
+    }
+  }
+  return false;
+}
+
+bool AutoDynamicQuantizationImpl::GetConstantWeights(const NodeDef& node,
+                                                     int port,
+                                                     Tensor* weights) const {
+  if (node.input_size() <= port) return false;
+  int weights_port;
+  const string weights_name = ParseNodeName(node.input(port), &weights_port);
+  const NodeDef* weights_node = node_map_.GetNode(weights_name);
+  if (weights_node == nullptr || !IsConstant(*weights_node) ||
+      weights_port != 0) {
+    return false;
+  }
+  const TensorProto* proto = nullptr;
+  if (!TryGetNodeAttr(*weights_node, "value", &proto) ||
+      proto->dtype() != DT_FLOAT || !weights->FromProto(*proto)) {
+    return false;
+  }
+  return weights->NumElements() >= kMinNumWeights;
+}
+
+bool AutoDynamicQuantizationImpl::GetDotCandidate(
+    NodeDef* node, const GraphProperties& properties,
+    Candidate* candidate) const {
+  // The hybrid kernel multiplies a [batch, depth] matrix with [depth,
+  // channels] weights. The weights are transposed when they are quantized,
+  // but the input is not.
+  const bool is_matmul = IsMatMul(*node);
+  bool transpose_input = false;
+  bool transpose_weights = false;
+  TryGetNodeAttr(*node, is_matmul ? "transpose_a" : "adj_x", &transpose_input);
+  TryGetNodeAttr(*node, is_matmul ? "transpose_b" : "adj_y",
+                 &transpose_weights);
+  if (transpose_input) return false;
+  Tensor weights;
+  if (!GetConstantWeights(*node, 1, &weights) || weights.dims() != 2) {
+    return false;
+  }
+  const auto& input_properties = properties.GetInputProperties(node->name());
+  if (input_properties.empty()) return false;
+  PartialTensorShape input_shape(input_properties[0].shape());
+  // The leading dimensions of a batched input are flattened into the batch,
+  // so they must be known but the first one.
+  if (input_shape.unknown_rank() || input_shape.dims() < 2) return false;
+  for (int i = 1; i < input_shape.dims() - 1; ++i) {
+    if (input_shape.dim_size(i) < 0) return false;
+  }
+
+  if (transpose_weights) {
+    Tensor transposed(DT_FLOAT,
+                      TensorShape({weights.dim_size(1), weights.dim_size(0)}));
+    auto src = weights.matrix<float>();
+    auto dst = transposed.matrix<float>();
+    for (int64_t i = 0; i < weights.dim_size(0); ++i) {
+      for (int64_t j = 0; j < weights.dim_size(1); ++j) {
+        dst(j, i) = src(i, j);
+      }
+    }
+    weights = transposed;
+  }
+  const int64_t depth = input_shape.dim_size(input_shape.dims() - 1);
+  if (depth >= 0 && depth != weights.dim_size(0)) return false;
+
+  candidate->node = node;
+  candidate->weights = weights;
+  candidate->input_shape = input_shape;
+  return true;
+}
+
+bool AutoDynamicQuantizationImpl::GetConvolutionCandidate(
+    NodeDef* node, const GraphProperties& properties,
+    Candidate* candidate) const {
+  string data_format = "NHWC";
+  std::vector<int> strides;
+  std::vector<int> dilations;
+  TryGetNodeAttr(*node, "data_format", &data_format);
+  if (data_format != "NHWC" || !TryGetNodeAttr(*node, "strides", &strides) ||
+      strides.size() != 4 || strides[0] != 1 || strides[3] != 1) {
+    return false;
+  }
+  if (TryGetNodeAttr(*node, "dilations", &dilations) &&
+      (dilations.size() != 4 || dilations[0] != 1 || dilations[3] != 1)) {
+    return false;
+  }
+  Tensor weights;
+  if (!GetConstantWeights(*node, 1, &weights) || weights.dims() != 4) {
+    return false;
+  }
+  const auto& input_properties = properties.GetInputProperties(node->name());
+  if (input_properties.empty()) return false;
+  PartialTensorShape input_shape(input_properties[0].shape());
+  // Grouped convolutions are not rewritten.
+  if (input_shape.unknown_rank() || input_shape.dims() != 4 ||
+      input_shape.dim_size(3) != weights.dim_size(2)) {
+    return false;
+  }
+
+  candidate->node = node;
+  candidate->weights = weights;
+  candidate->input_shape = input_shape;
+  return true;
+}
+
+NodeDef* AutoDynamicQuantizationImpl::AddConstNode(const string& name,
+                                                   const string& device,
+                                                   const Tensor& value) {
+  NodeDef* node = graph_->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  AddNodeAttr("dtype", value.dtype(), node);
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+void AutoDynamicQuantizationImpl::AddQuantizedWeights(
+    const NodeDef& node, const Tensor& weights, string* quantized_weights,
+    string* scales, string* zero_points) {
+  const int64_t num_channels = weights.dim_size(weights.dims() - 1);
+  const int64_t num_rows = weights.NumElements() / num_channels;
+  auto values = weights.shaped<float, 2>({num_rows, num_channels});
+
+  Tensor scales_tensor(DT_FLOAT, TensorShape({num_channels}));
+  auto scales_flat = scales_tensor.flat<float>();
+  for (int64_t c = 0; c < num_channels; ++c) {
+    float max_abs = 0.0f;
+    for (int64_t r = 0; r < num_rows; ++r) {
+      max_abs = std::max(max_abs, std::abs(values(r, c)));
+    }
+    // The kernels require positive scales, even for all-zero channels.
+    scales_flat(c) = max_abs > 0.0f ? max_abs / kQuantizedMax : 1.0f;
+  }
+
+  Tensor quantized_tensor(DT_QINT8, weights.shape());
+  auto quantized =
+      quantized_tensor.shaped<qint8, 2>({num_rows, num_channels});
+  for (int64_t r = 0; r < num_rows; ++r) {
+    for (int64_t c = 0; c < num_channels; ++c) {
+      const float q = std::round(values(r, c) / scales_flat(c));
+      quantized(r, c) = static_cast<int8>(std::min<float>(
+          kQuantizedMax, std::max<float>(kQuantizedMin, q)));
+    }
+  }
+
+  Tensor zero_points_tensor(DT_INT32, TensorShape({num_channels}));
+  zero_points_tensor.flat<int32>().setZero();
+
+  *quantized_weights = AddPrefixToNodeName("quantized_weights", node.name());
+  *scales = AddPrefixToNodeName("weight_scales", node.name());
+  *zero_points = AddPrefixToNodeName("weight_zero_points", node.name());
+  AddConstNode(*quantized_weights, node.device(), quantized_tensor);
+  AddConstNode(*scales, node.device(), scales_tensor);
+  AddConstNode(*zero_points, node.device(), zero_points_tensor);
+}
+
+// Replaces the regular inputs of `node` with `inputs`, and keeps its control
+// inputs.
+void SetRegularInputs(const std::vector<string>& inputs, NodeDef* node) {
+  std::vector<string> control_inputs;
+  for (const string& input : node->input()) {
+    if (IsControlInput(input)) control_inputs.push_back(input);
+  }
+  node->clear_input();
+  for (const string& input : inputs) node->add_input(input);
+  for (const string& input : control_inputs) node->add_input(input);
+}
+
+void SetQuantizationAttrs(int axis, NodeDef* node) {
+  AddNodeAttr("Tlhs", DT_FLOAT, node);
+  AddNodeAttr("Trhs", DT_QINT8, node);
+  AddNodeAttr("Tout", DT_FLOAT, node);
+  AddNodeAttr("rhs_quantization_axis", axis, node);
+  AddNodeAttr("rhs_quantization_min_val", kQuantizedMin, node);
+  AddNodeAttr("rhs_quantization_max_val", kQuantizedMax, node);
+}
+
+Status AutoDynamicQuantizationImpl::RewriteDot(const Candidate& candidate) {
+  NodeDef* node = candidate.node;
+  string quantized_weights, scales, zero_points;
+  AddQuantizedWeights(*node, candidate.weights, &quantized_weights, &scales,
+                      &zero_points);
+  const string input = node->input(0);
+  const int rank = candidate.input_shape.dims();
+  const int64_t depth = candidate.weights.dim_size(0);
+  const int64_t num_channels = candidate.weights.dim_size(1);
+
+  if (rank == 2) {
+    node->set_op(kQuantizedDot);
+    node->clear_attr();
+    SetQuantizationAttrs(/*axis=*/1, node);
+    SetRegularInputs({input, quantized_weights, scales, zero_points}, node);
+    return OkStatus();
+  }
+
+  // Flatten the batch dimensions of the input, and restore them in the
+  // output. The node keeps its name and control inputs, so that its fanouts
+  // are unchanged.
+  Tensor flat_shape(DT_INT32, TensorShape({2}));
+  flat_shape.flat<int32>()(0) = -1;
+  flat_shape.flat<int32>()(1) = depth;
+  Tensor output_shape(DT_INT32, TensorShape({rank}));
+  auto output_shape_flat = output_shape.flat<int32>();
+  output_shape_flat(0) = -1;
+  for (int i = 1; i < rank - 1; ++i) {
+    output_shape_flat(i) = candidate.input_shape.dim_size(i);
+  }
+  output_shape_flat(rank - 1) = num_channels;
+
+  const string flat_shape_name =
+      AddPrefixToNodeName("flat_shape", node->name());
+  const string output_shape_name =
+      AddPrefixToNodeName("output_shape", node->name());
+  AddConstNode(flat_shape_name, node->device(), flat_shape);
+  AddConstNode(output_shape_name, node->device(), output_shape);
+
+  NodeDef* flatten = graph_->add_node();
+  flatten->set_name(AddPrefixToNodeName("flat_input", node->name()));
+  flatten->set_op("Reshape");
+  flatten->set_device(node->device());
+  flatten->add_input(input);
+  flatten->add_input(flat_shape_name);
+  AddNodeAttr("T", DT_FLOAT, flatten);
+  AddNodeAttr("Tshape", DT_INT32, flatten);
+
+  NodeDef* dot = graph_->add_node();
+  dot->set_name(AddPrefixToNodeName("quantized_dot", node->name()));
+  dot->set_op(kQuantizedDot);
+  dot->set_device(node->device());
+  dot->add_input(flatten->name());
+  dot->add_input(quantized_weights);
+  dot->add_input(scales);
+  dot->add_input(zero_points);
+  SetQuantizationAttrs(/*axis=*/1, dot);
+
+  node->set_op("Reshape");
+  node->clear_attr();
+  AddNodeAttr("T", DT_FLOAT, node);
+  AddNodeAttr("Tshape", DT_INT32, node);
+  SetRegularInputs({dot->name(), output_shape_name}, node);
+  return OkStatus();
+}
+
+Status AutoDynamicQuantizationImpl::RewriteConvolution(
+    const Candidate& candidate) {
+  NodeDef* node = candidate.node;
+  std::vector<int> strides;
+  std::vector<int> dilations = {1, 1, 1, 1};
+  std::vector<int> explicit_paddings;
+  string padding;
+  TF_RETURN_IF_ERROR(GetNodeAttr(*node, "strides", &strides));
+  TF_RETURN_IF_ERROR(GetNodeAttr(*node, "padding", &padding));
+  TryGetNodeAttr(*node, "dilations", &dilations);
+  TryGetNodeAttr(*node, "explicit_paddings", &explicit_paddings);
+
+  string quantized_weights, scales, zero_points;
+  AddQuantizedWeights(*node, candidate.weights, &quantized_weights, &scales,
+                      &zero_points);
+
+  // Conv2D in NHWC with HWIO filters.
+  UniformQuantizedConvolutionDimensionNumbersAttr dimension_numbers;
+  dimension_numbers.set_input_batch_dimension(0);
+  dimension_numbers.set_input_feature_dimension(3);
+  dimension_numbers.add_input_spatial_dimensions(1);
+  dimension_numbers.add_input_spatial_dimensions(2);
+  dimension_numbers.set_kernel_input_feature_dimension(2);
+  dimension_numbers.set_kernel_output_feature_dimension(3);
+  dimension_numbers.add_kernel_spatial_dimensions(0);
+  dimension_numbers.add_kernel_spatial_dimensions(1);
+  dimension_numbers.set_output_batch_dimension(0);
+  dimension_numbers.set_output_feature_dimension(3);
+  dimension_numbers.add_output_spatial_dimensions(1);
+  dimension_numbers.add_output_spatial_dimensions(2);
+
+  // The explicit paddings of Conv2D cover all the dimensions, those of the
+  // hybrid kernel only the spatial ones.
+  std::vector<int> spatial_paddings;
+  if (padding == "EXPLICIT") {
+    if (explicit_paddings.size() != 8) {
+      return errors::InvalidArgument("Invalid explicit_paddings of ",
+                                     node->name());
+    }
+    spatial_paddings.assign(explicit_paddings.begin() + 2,
+                            explicit_paddings.begin() + 6);
+  }
+
+  const string input = node->input(0);
+  node->set_op(kQuantizedConvolution);
+  node->clear_attr();
+  SetQuantizationAttrs(/*axis=*/3, node);
+  AddNodeAttr("window_strides", std::vector<int>{strides[1], strides[2]},
+              node);
+  AddNodeAttr("padding", padding, node);
+  AddNodeAttr("explicit_padding", spatial_paddings, node);
+  AddNodeAttr("lhs_dilation", std::vector<int>{1, 1}, node);
+  AddNodeAttr("rhs_dilation", std::vector<int>{dilations[1], dilations[2]},
+              node);
+  AddNodeAttr("batch_group_count", 1, node);
+  AddNodeAttr("feature_group_count", 1, node);
+  AddNodeAttr("dimension_numbers", dimension_numbers.SerializeAsString(),
+              node);
+  SetRegularInputs({input, quantized_weights, scales, zero_points}, node);
+  return OkStatus();
+}
+
+Status AutoDynamicQuantizationImpl::Optimize() {
+  GraphProperties properties(item_);
+  TF_RETURN_IF_ERROR(properties.InferStatically(
+      /*assume_valid_feeds=*/false, /*aggressive_shape_inference=*/false,
+      /*include_tensor_values=*/false));
+
+  absl::flat_hash_set<string> feed_nodes;
+  for (const auto& feed : item_.feed) {
+    feed_nodes.insert(NodeName(feed.first));
+  }
+
+  // Find all the candidates before changing the graph, which invalidates
+  // `node_map_`.
+  std::vector<Candidate> candidates;
+  for (NodeDef& node : *graph_->mutable_node()) {
+    if (!allow_list_.count(node.op())) continue;
+    DataType dtype;
+    if (!TryGetNodeAttr(node, "T", &dtype) || dtype != DT_FLOAT ||
+        feed_nodes.contains(node.name()) || !IsOnCpu(node)) {
+      continue;
+    }
+    Candidate candidate;
+    bool is_candidate = false;
+    if (IsMatMul(node) || node.op() == "BatchMatMulV2") {
+      is_candidate = GetDotCandidate(&node, properties, &candidate);
+    } else if (IsConv2D(node)) {
+      is_candidate = GetConvolutionCandidate(&node, properties, &candidate);
+    }
+    if (!is_candidate) continue;
+    if (ReachesDenyListOp(node)) {
+      VLOG(2) << "Not quantizing " << node.name()
+              << ", whose outputs reach a denylist op";
+      continue;
+    }
+    candidates.push_back(std::move(candidate));
+  }
+
+  for (const Candidate& candidate : candidates) {
+    VLOG(2) << "Quantizing " << candidate.node->op() << " "
+            << candidate.node->name();
+    if (IsConv2D(*candidate.node)) {
+      TF_RETURN_IF_ERROR(RewriteConvolution(candidate));
+    } else {
+      TF_RETURN_IF_ERROR(RewriteDot(candidate));
+    }
+  }
+  VLOG(1) << "Quantized " << candidates.size() << " ops";
+  return OkStatus();
+}
+
+}  // namespace
+
+Status AutoDynamicQuantization::Optimize(Cluster* cluster,
+                                         const GrapplerItem& item,
+                                         GraphDef* output) {
+  *output = item.graph;
+  AutoDynamicQuantizationImpl optimizer(cluster, item, output);
+  Status status = optimizer.Optimize();
+  if (!status.ok()) {
+    // Restore the original graph.
+    *output = item.graph;
+    LOG(WARNING) << name() << " graph optimizer FAILED: " << status.ToString();
+  }
+  return status;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,48 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_DYNAMIC_QUANTIZATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_DYNAMIC_QUANTIZATION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Rewrites MatMul, BatchMatMulV2 and Conv2D ops on CPU whose weights are
+// constant to the int8 hybrid kernels UniformQuantizedDotHybrid and
+// UniformQuantizedConvolutionHybrid. The weights are quantized per output
+// channel when the graph is optimized, and the kernels quantize their float
+// activations per batch when they run. This can change the numerical results
+// of the graph, so it is meant for inference.
+class AutoDynamicQuantization : public GraphOptimizer {
+ public:
+  AutoDynamicQuantization() {}
+
+  ~AutoDynamicQuantization() override {}
+
+  string name() const override { return "auto_dynamic_quantization"; }
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* output) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_DYNAMIC_QUANTIZATION_H_
@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_DYNAMIC_QUANTIZATION_LISTS_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_DYNAMIC_QUANTIZATION_LISTS_H_
+
+#include <string>
+
+#include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Represents the three lists of ops: the allow list, deny list, and clear
+// list. These lists determine which ops are rewritten to int8 kernels with
+// quantized weights and which ops stay in fp32.
+class AutoDynamicQuantizationLists {
+ public:
+  // Returns the set of ops that are rewritten to int8 kernels if their weights
+  // are constant. Only MatMul, BatchMatMulV2 and Conv2D have int8 kernels;
+  // other ops on this list are ignored.
+  gtl::FlatSet<string> AllowList() {
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMulV2",
+        "Conv2D",
+        "MatMul",
+    };
+    UpdateList("ALLOWLIST", &list);
+    return list;
+  }
+
+  // Returns the set of ops that are numerically sensitive to the error of
+  // their inputs, e.g. because they amplify it. Allowlist ops whose outputs
+  // reach one of these ops, directly or through clearlist ops, stay in fp32.
+  gtl::FlatSet<string> DenyList() {
+    auto list = gtl::FlatSet<string>{
+        "Exp",
+        "Log",
+        "LogSoftmax",
+        "Pow",
+        "SoftmaxCrossEntropyWithLogits",
+        "SparseSoftmaxCrossEntropyWithLogits",
+    };
+    UpdateList("DENYLIST", &list);
+    return list;
+  }
+
+  // Returns the set of ops that pass the error of their inputs through to
+  // their outputs unchanged.
+  gtl::FlatSet<string> ClearList() {
+    auto list = gtl::FlatSet<string>{
+        "BiasAdd",
+        "ExpandDims",
+        "Identity",
+        "IdentityN",
+        "MaxPool",
+        "Relu",
+        "Relu6",
+        "Reshape",
+        "Snapshot",
+        "Squeeze",
+        "StopGradient",
+        "Transpose",
+    };
+    UpdateList("CLEARLIST", &list);
+    return list;
+  }
+
+ private:
+  // Adds or removes ops from list if certain environmental variables are set.
+  static void UpdateList(const string& list_name, gtl::FlatSet<string>* list) {
+    CHECK(list_name == "ALLOWLIST" || list_name == "DENYLIST" ||  // Crash OK.
+          list_name == "CLEARLIST");
+    string add_env_var =
+        "TF_AUTO_DYNAMIC_QUANTIZATION_GRAPH_REWRITE_" + list_name + "_ADD";
+    string remove_env_var =
+        "TF_AUTO_DYNAMIC_QUANTIZATION_GRAPH_REWRITE_" + list_name + "_REMOVE";
+    string to_add, to_remove;
+    TF_CHECK_OK(ReadStringFromEnvVar(add_env_var, "", &to_add));
+    TF_CHECK_OK(ReadStringFromEnvVar(remove_env_var, "", &to_remove));
+    for (const auto& x : str_util::Split(to_add, ",")) {
+      list->insert(x);
+    }
+    for (const auto& x : str_util::Split(to_remove, ",")) {
+      list->erase(x);
+    }
+  }
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_AUTO_DYNAMIC_QUANTIZATION_LISTS_H_
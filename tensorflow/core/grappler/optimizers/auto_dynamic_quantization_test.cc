@@ -0,0 +1,286 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/auto_dynamic_quantization.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class AutoDynamicQuantizationTest : public GrapplerTest {
+ protected:
+  void SetUp() override {
+    DeviceProperties cpu_device;
+    cpu_device.set_type("CPU");
+    cluster_ = std::make_unique<VirtualCluster>(
+        std::unordered_map<string, DeviceProperties>{
+            {"/job:localhost/replica:0/task:0/device:CPU:0", cpu_device}});
+    TF_ASSERT_OK(cluster_->Provision());
+  }
+
+  void TearDown() override { TF_ASSERT_OK(cluster_->Shutdown()); }
+
+  // Optimizes `item`, and checks that the optimized graph computes its fetches
+  // with the error of int8 weights and activations.
+  void OptimizeAndCompare(
+      const GrapplerItem& item,
+      const std::vector<std::pair<string, Tensor>>& inputs,
+      GraphDef* output) {
+    AutoDynamicQuantization optimizer;
+    TF_ASSERT_OK(optimizer.Optimize(cluster_.get(), item, output));
+    auto expected = EvaluateNodes(item.graph, item.fetch, inputs);
+    auto tensors = EvaluateNodes(*output, item.fetch, inputs);
+    ASSERT_EQ(expected.size(), tensors.size());
+    for (int i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(expected[i].shape(), tensors[i].shape());
+      auto expected_flat = expected[i].flat<float>();
+      auto flat = tensors[i].flat<float>();
+      float max_abs = 0.0f;
+      for (int j = 0; j < expected_flat.size(); ++j) {
+        max_abs = std::max(max_abs, std::abs(expected_flat(j)));
+      }
+      for (int j = 0; j < expected_flat.size(); ++j) {
+        EXPECT_NEAR(expected_flat(j), flat(j), 0.03f * max_abs);
+      }
+    }
+  }
+
+  const NodeDef* GetNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  std::unique_ptr<Cluster> cluster_;
+};
+
+TEST_F(AutoDynamicQuantizationTest, MatMul) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 64}));
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({64, 32}));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  GraphDef output;
+  OptimizeAndCompare(
+      item, {{"x", GenerateTensorWithSetRandom<DT_FLOAT>({8, 64})}}, &output);
+
+  const NodeDef* node = GetNode(output, "matmul");
+  ASSERT_NE(node, nullptr);
+  EXPECT_EQ(node->op(), "UniformQuantizedDotHybrid");
+  ASSERT_EQ(node->input_size(), 4);
+  EXPECT_EQ(node->input(0), "x");
+  EXPECT_EQ(node->input(1), "matmul/quantized_weights");
+  EXPECT_EQ(node->attr().at("rhs_quantization_axis").i(), 1);
+  const NodeDef* scales = GetNode(output, "matmul/weight_scales");
+  ASSERT_NE(scales, nullptr);
+  EXPECT_EQ(scales->attr().at("value").tensor().tensor_shape().dim(0).size(),
+            32);
+}
+
+TEST_F(AutoDynamicQuantizationTest, MatMulTransposedWeights) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 64}));
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({32, 64}));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w,
+                              ops::MatMul::TransposeB(true));
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  GraphDef output;
+  OptimizeAndCompare(
+      item, {{"x", GenerateTensorWithSetRandom<DT_FLOAT>({8, 64})}}, &output);
+  EXPECT_EQ(GetNode(output, "matmul")->op(), "UniformQuantizedDotHybrid");
+}
+
+TEST_F(AutoDynamicQuantizationTest, BatchMatMulV2) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 5, 64}));
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({64, 32}));
+  Output matmul = ops::BatchMatMulV2(s.WithOpName("matmul"), x, w);
+  Output fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  GraphDef output;
+  OptimizeAndCompare(
+      item, {{"x", GenerateTensorWithSetRandom<DT_FLOAT>({3, 5, 64})}},
+      &output);
+
+  // The batch dimensions are flattened around the quantized product.
+  EXPECT_EQ(GetNode(output, "matmul")->op(), "Reshape");
+  const NodeDef* dot = GetNode(output, "matmul/quantized_dot");
+  ASSERT_NE(dot, nullptr);
+  EXPECT_EQ(dot->op(), "UniformQuantizedDotHybrid");
+  EXPECT_EQ(dot->input(0), "matmul/flat_input");
+}
+
+TEST_F(AutoDynamicQuantizationTest, Conv2D) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 9, 9, 16}));
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({3, 3, 16, 8}));
+  Output conv = ops::Conv2D(s.WithOpName("conv"), x, w, {1, 2, 2, 1}, "SAME");
+  Output fetch = ops::Identity(s.WithOpName("fetch"), conv);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  GraphDef output;
+  OptimizeAndCompare(
+      item, {{"x", GenerateTensorWithSetRandom<DT_FLOAT>({2, 9, 9, 16})}},
+      &output);
+
+  const NodeDef* node = GetNode(output, "conv");
+  ASSERT_NE(node, nullptr);
+  EXPECT_EQ(node->op(), "UniformQuantizedConvolutionHybrid");
+  EXPECT_EQ(node->attr().at("rhs_quantization_axis").i(), 3);
+  EXPECT_EQ(node->attr().at("padding").s(), "SAME");
+}
+
+// Checks that the rewritten graph gets the same results from the AVX512-VNNI
+// code path of the quantized kernels, on CPUs that support it, as from their
+// reference code path.
+TEST_F(AutoDynamicQuantizationTest, VnniMatchesReference) {
+  if (!vnni::IsSupportedAndEnabled()) {
+    GTEST_SKIP() << "AVX512-VNNI is not supported by this CPU.";
+  }
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 64}));
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({64, 37}));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+  Output image = ops::Placeholder(s.WithOpName("image"), DT_FLOAT,
+                                  ops::Placeholder::Shape({-1, 9, 9, 16}));
+  Output filter = ops::Const(
+      s.WithOpName("filter"),
+      GenerateTensorWithSetRandom<DT_FLOAT>({3, 3, 16, 8}));
+  Output conv =
+      ops::Conv2D(s.WithOpName("conv"), image, filter, {1, 2, 2, 1}, "SAME");
+  Output matmul_fetch = ops::Identity(s.WithOpName("matmul_fetch"), matmul);
+  Output conv_fetch = ops::Identity(s.WithOpName("conv_fetch"), conv);
+
+  GrapplerItem item;
+  item.fetch = {"matmul_fetch", "conv_fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  AutoDynamicQuantization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(cluster_.get(), item, &output));
+  EXPECT_EQ(GetNode(output, "matmul")->op(), "UniformQuantizedDotHybrid");
+  EXPECT_EQ(GetNode(output, "conv")->op(),
+            "UniformQuantizedConvolutionHybrid");
+
+  const std::vector<std::pair<string, Tensor>> inputs = {
+      {"x", GenerateTensorWithSetRandom<DT_FLOAT>({5, 64})},
+      {"image", GenerateTensorWithSetRandom<DT_FLOAT>({2, 9, 9, 16})}};
+  vnni::SetEnabled(false);
+  auto expected = EvaluateNodes(output, item.fetch, inputs);
+  vnni::SetEnabled(true);
+  auto tensors = EvaluateNodes(output, item.fetch, inputs);
+  ASSERT_EQ(expected.size(), tensors.size());
+  for (int i = 0; i < expected.size(); ++i) {
+    test::ExpectTensorEqual<float>(expected[i], tensors[i]);
+  }
+}
+
+TEST_F(AutoDynamicQuantizationTest, NotQuantized) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 64}));
+  // Too few weights.
+  Output small_w = ops::Const(s.WithOpName("small_w"),
+                              GenerateTensorWithSetRandom<DT_FLOAT>({64, 8}));
+  Output small = ops::MatMul(s.WithOpName("small"), x, small_w);
+  // Weights that are not constant.
+  Output y = ops::Placeholder(s.WithOpName("y"), DT_FLOAT,
+                              ops::Placeholder::Shape({64, 32}));
+  Output variable = ops::MatMul(s.WithOpName("variable"), x, y);
+  // Output that reaches a denylist op through a clearlist op.
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({64, 32}));
+  Output denied = ops::MatMul(s.WithOpName("denied"), x, w);
+  Output relu = ops::Relu(s.WithOpName("relu"), denied);
+  Output exp = ops::Exp(s.WithOpName("exp"), relu);
+  // On a GPU.
+  Output gpu = ops::MatMul(s.WithOpName("gpu").WithDevice("/device:GPU:0"), x,
+                           w);
+
+  GrapplerItem item;
+  item.fetch = {"small", "variable", "exp", "gpu"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  AutoDynamicQuantization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(cluster_.get(), item, &output));
+  for (const string& name : {"small", "variable", "denied", "gpu"}) {
+    const NodeDef* node = GetNode(output, name);
+    ASSERT_NE(node, nullptr);
+    EXPECT_EQ(node->op(), "MatMul") << name;
+  }
+}
+
+TEST_F(AutoDynamicQuantizationTest, RemoveFromAllowList) {
+  setenv("TF_AUTO_DYNAMIC_QUANTIZATION_GRAPH_REWRITE_ALLOWLIST_REMOVE",
+         "MatMul", /*overwrite=*/1);
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(s.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 64}));
+  Output w = ops::Const(s.WithOpName("w"),
+                        GenerateTensorWithSetRandom<DT_FLOAT>({64, 32}));
+  Output matmul = ops::MatMul(s.WithOpName("matmul"), x, w);
+
+  GrapplerItem item;
+  item.fetch = {"matmul"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  AutoDynamicQuantization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(cluster_.get(), item, &output));
+  unsetenv("TF_AUTO_DYNAMIC_QUANTIZATION_GRAPH_REWRITE_ALLOWLIST_REMOVE");
+  EXPECT_EQ(GetNode(output, "matmul")->op(), "MatMul");
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
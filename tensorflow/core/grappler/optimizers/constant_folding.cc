@@ -17,7 +17,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -45,6 +48,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -65,6 +69,10 @@ using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
 // We only fold/materialize constants smaller than 100kB.
 const int64_t kMaxConstantSize = 100 * 1024;
+// Nor constants encoded in more than 16kB and 16 times the size of the inputs
+// they're computed from, e.g. by Tile.
+const int64_t kMaxConstantExpansion = 16;
+const int64_t kMaxExpandedConstantSize = 16 * 1024;
 
 namespace {
 template <typename T>
@@ -1414,6 +1422,25 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
         *result_too_large = true;
         return s;
       }
+      // Nor constants much larger than the inputs, which would bloat the graph
+      // with little saved computation. The encoded size is checked, so that
+      // uniform outputs, e.g. of Fill, ZerosLike or BroadcastTo, are folded.
+      const int64_t encoded_size =
+          outputs->at(i).attr().at("value").tensor().ByteSizeLong();
+      int64_t max_expanded_size =
+          MultiplyWithoutOverflow(total_inputs_size, kMaxConstantExpansion);
+      if (max_expanded_size < 0) {  // Overflown
+        max_expanded_size = INT64_MAX;
+      }
+      if (encoded_size > kMaxExpandedConstantSize &&
+          encoded_size > max_expanded_size) {
+        *result_too_large = true;
+        return absl::InvalidArgumentError(absl::StrCat(
+            "Can't fold ", node_name, ", its size would be more than ",
+            kMaxConstantExpansion, " times the size of its inputs (",
+            encoded_size, " > ", kMaxConstantExpansion, " * ",
+            total_inputs_size, " bytes)"));
+      }
     } else {
       // Create an empty NodeDef to identify dead outputs (e.g. the output of a
       // switch that's not selected by the switch predicate).
@@ -1525,11 +1552,58 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
   std::vector<NodeDef> const_nodes;
   TF_RETURN_IF_ERROR(
       EvaluateOneFoldable(*node, &const_nodes, result_too_large));
+  return ReplaceWithConstants(node, &const_nodes, output_graph);
+}
+
+namespace {
+
+// The thread pool evaluating the independent foldable nodes concurrently, see
+// FoldGraph(). It is shared by all the ConstantFolding instances of the
+// process, which may run concurrently for different graphs or functions.
+thread::ThreadPool* GetFoldThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "constant_folding", port::MaxParallelism());
+  return pool;
+}
+
+}  // namespace
+
+std::vector<ConstantFolding::EvaluatedFoldable>
+ConstantFolding::EvaluateFoldables(const std::vector<NodeDef*>& nodes) {
+  std::vector<EvaluatedFoldable> results(nodes.size());
+  auto evaluate = [&](int64_t begin, int64_t end) {
+    // The rounding and denormal modes are per thread, see Optimize().
+    port::ScopedFlushDenormal flush;
+    port::ScopedSetRound round(FE_TONEAREST);
+    for (int64_t i = begin; i < end; ++i) {
+      if (IsMerge(*nodes[i])) continue;
+      EvaluatedFoldable& result = results[i];
+      result.status = EvaluateOneFoldable(*nodes[i], &result.const_nodes,
+                                          &result.result_too_large);
+    }
+  };
+  // The kernels may run on the thread pool of cpu_device_, so this is a
+  // separate one.
+  const int num_threads =
+      std::min<int64_t>(port::MaxParallelism(), nodes.size());
+  if (num_threads <= 1) {
+    evaluate(0, nodes.size());
+    return results;
+  }
+  // Evaluating a node costs far more than scheduling it.
+  GetFoldThreadPool()->ParallelFor(nodes.size(), /*cost_per_unit=*/1 << 20,
+                                   evaluate);
+  return results;
+}
+
+Status ConstantFolding::ReplaceWithConstants(NodeDef* node,
+                                             std::vector<NodeDef>* const_nodes,
+                                             GraphDef* output_graph) {
   VLOG(2) << "Folded node: " << SummarizeNodeDef(*node);
 
   NodeDef* constant_output = nullptr;
-  for (int i = 0, end = const_nodes.size(); i < end; i++) {
-    NodeDef* const_node = &const_nodes[i];
+  for (int i = 0, end = const_nodes->size(); i < end; i++) {
+    NodeDef* const_node = &(*const_nodes)[i];
     VLOG(3) << "Generated constant node: " << SummarizeNodeDef(*const_node);
     if (const_node->name().empty()) {
       // Dead output: we can't create a constant to encode its value, so we'll
@@ -1567,7 +1641,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
 
     // We rewrite the existing node if it only has a single output, and
     // create new nodes otherwise.
-    if (const_nodes.size() == 1) {
+    if (const_nodes->size() == 1) {
       node->set_op("Const");
       // Note we need to clear the inputs in NodeMap before we clear the inputs
       // in the node, otherwise NodeMap would see empty inputs and effectively
@@ -1600,7 +1674,7 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
     }
   }
 
-  if (const_nodes.size() > 1) {
+  if (const_nodes->size() > 1) {
     // We make a copy because we mutate the nodes.
     auto outputs = node_map_->GetOutputs(node->name());
     for (NodeDef* output : outputs) {
@@ -1616,12 +1690,12 @@ Status ConstantFolding::FoldNode(NodeDef* node, GraphDef* output_graph,
                                      constant_output->name());
               *output->mutable_input(i) = AsControlDependency(*constant_output);
             }
-          } else if (port < static_cast<int>(const_nodes.size()) &&
-                     !const_nodes[port].name().empty()) {
+          } else if (port < static_cast<int>(const_nodes->size()) &&
+                     !(*const_nodes)[port].name().empty()) {
             // Replace alive outputs with the corresponding constant.
             node_map_->UpdateInput(output->name(), NodeName(output->input(i)),
-                                   const_nodes[port].name());
-            *output->mutable_input(i) = const_nodes[port].name();
+                                   (*const_nodes)[port].name());
+            *output->mutable_input(i) = (*const_nodes)[port].name();
           } else {
             // Leave this edge alone.
             VLOG(3) << "Preserving edge from " << node->name() << ":" << port
@@ -1646,42 +1720,67 @@ Status ConstantFolding::FoldGraph(
     absl::flat_hash_set<string>* nodes_to_not_simplify) {
   // We build a new optimized_graph by inserting the folded nodes into it, then
   // copy other nodes that might be needed at the end of this function.
+  //
+  // The nodes are folded in waves: the foldable nodes of the graph, then their
+  // fanouts which became foldable, and so on. The nodes of a wave only have
+  // constant inputs, which folding the other nodes of the wave doesn't change,
+  // so they're evaluated concurrently, and then replaced by their constants in
+  // order.
   absl::flat_hash_set<string> processed_nodes;
-  std::deque<NodeDef*> queue;
+  std::vector<NodeDef*> wave;
   for (int i = 0; i < graph_->node_size(); i++) {
     const NodeDef& node = graph_->node(i);
     if (IsFoldable(node, &properties) &&
         !nodes_to_not_simplify->count(node.name())) {
-      queue.push_back(graph_->mutable_node(i));
+      wave.push_back(graph_->mutable_node(i));
     }
   }
-  while (!queue.empty()) {
-    NodeDef* node = queue.front();
-    queue.pop_front();
-    if (processed_nodes.count(node->name())) {
-      continue;
+  while (!wave.empty()) {
+    // Nodes can be queued several times, by each of their fanins.
+    absl::flat_hash_set<string> wave_nodes;
+    std::vector<NodeDef*> nodes_to_fold;
+    for (NodeDef* node : wave) {
+      if (!processed_nodes.count(node->name()) &&
+          wave_nodes.insert(node->name()).second) {
+        nodes_to_fold.push_back(node);
+      }
     }
-    // We need to record a copy of output nodes before FoldNode() modifies it.
-    // We also need to ensure that the fanout is sorted deterministically.
-    std::vector<NodeDef*> fanout =
-        node_map_->GetOutputsOrderedByNodeName(node->name());
-    bool result_too_large = false;
-    Status s = FoldNode(node, optimized_graph, &result_too_large);
-    processed_nodes.insert(node->name());
-    if (!s.ok()) {
-      VLOG(1) << "Failed to fold node " << node->DebugString()
-              << "\nError message: " << s;
-      if (result_too_large) {
-        nodes_to_not_simplify->emplace(node->name());
+    std::vector<EvaluatedFoldable> evaluated = EvaluateFoldables(nodes_to_fold);
+
+    std::vector<NodeDef*> next_wave;
+    for (size_t i = 0; i < nodes_to_fold.size(); ++i) {
+      NodeDef* node = nodes_to_fold[i];
+      // We need to record a copy of output nodes before folding modifies it.
+      // We also need to ensure that the fanout is sorted deterministically.
+      std::vector<NodeDef*> fanout =
+          node_map_->GetOutputsOrderedByNodeName(node->name());
+      Status s;
+      if (IsMerge(*node)) {
+        s = FoldMergeNode(node, optimized_graph);
+      } else {
+        s = evaluated[i].status;
+        if (s.ok()) {
+          s = ReplaceWithConstants(node, &evaluated[i].const_nodes,
+                                   optimized_graph);
+        }
       }
-    } else {
-      for (auto& fanout_node : fanout) {
-        if (IsFoldable(*fanout_node, &properties) &&
-            !nodes_to_not_simplify->count(fanout_node->name())) {
-          queue.push_back(fanout_node);
+      processed_nodes.insert(node->name());
+      if (!s.ok()) {
+        VLOG(1) << "Failed to fold node " << node->DebugString()
+                << "\nError message: " << s;
+        if (evaluated[i].result_too_large) {
+          nodes_to_not_simplify->emplace(node->name());
+        }
+      } else {
+        for (auto& fanout_node : fanout) {
+          if (IsFoldable(*fanout_node, &properties) &&
+              !nodes_to_not_simplify->count(fanout_node->name())) {
+            next_wave.push_back(fanout_node);
+          }
         }
       }
     }
+    wave = std::move(next_wave);
   }
 
   // Delete the newly created nodes that don't feed anything.
@@ -34,6 +34,8 @@ namespace grappler {
 const char kConstantFoldingConst[] = "ConstantFolding";
 const char kConstantFoldingCtrl[] = "ConstantFoldingCtrl";
 extern const int64_t kMaxConstantSize;
+extern const int64_t kMaxConstantExpansion;
+extern const int64_t kMaxExpandedConstantSize;
 
 // Constant folding optimization for a graph.
 class ConstantFolding : public GraphOptimizer {
@@ -95,9 +97,23 @@ class ConstantFolding : public GraphOptimizer {
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
+  // The results of EvaluateOneFoldable().
+  struct EvaluatedFoldable {
+    Status status;
+    std::vector<NodeDef> const_nodes;
+    bool result_too_large = false;
+  };
+  // Evaluates the non-Merge nodes of `nodes` concurrently. The nodes must not
+  // depend on each other.
+  std::vector<EvaluatedFoldable> EvaluateFoldables(
+      const std::vector<NodeDef*>& nodes);
+
   Status FoldMergeNode(NodeDef* node, GraphDef* output_graph);
   Status FoldNode(NodeDef* node, GraphDef* output_graph,
                   bool* result_too_large);
+  // Replaces `node` with the constants `const_nodes` it evaluated to.
+  Status ReplaceWithConstants(NodeDef* node, std::vector<NodeDef>* const_nodes,
+                              GraphDef* output_graph);
 
   bool IsOnes(const NodeDef& node) const;
   bool IsZeros(const NodeDef& node) const;
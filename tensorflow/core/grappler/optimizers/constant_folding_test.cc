@@ -2417,6 +2417,112 @@ TEST_F(ConstantFoldingTest, TileWithMultipliesBeingOne) {
   CompareGraphs(want, got);
 }
 
+TEST_F(ConstantFoldingTest, DoNotFoldLargeExpansion) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+
+  Tensor value_t(DT_FLOAT, TensorShape({64}));
+  test::FillIota<float>(&value_t, 0.0f);
+  Output value = ops::Const(scope.WithOpName("value"), value_t);
+  // The 32kB output is less than kMaxConstantSize, but 128 times larger than
+  // the inputs.
+  Output large_multiples = ops::Const(scope.WithOpName("large_multiples"),
+                                      {128}, {1});
+  Output small_multiples = ops::Const(scope.WithOpName("small_multiples"),
+                                      {2}, {1});
+  ops::Tile large_tile(scope.WithOpName("large_tile"), value, large_multiples);
+  ops::Tile small_tile(scope.WithOpName("small_tile"), value, small_multiples);
+  ops::Identity large_out(scope.WithOpName("large_out"), large_tile);
+  ops::Identity small_out(scope.WithOpName("small_out"), small_tile);
+
+  GrapplerItem item;
+  item.fetch = {"large_out", "small_out"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "large_tile") {
+      EXPECT_EQ(node.op(), "Tile");
+      ++found;
+    } else if (node.name() == "small_tile") {
+      EXPECT_EQ(node.op(), "Const");
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
+TEST_F(ConstantFoldingTest, FoldLargeUniformExpansion) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+
+  // The 32kB outputs are much larger than the inputs, but encoded compactly.
+  Output dims = ops::Const(scope.WithOpName("dims"), {8192}, {1});
+  Output value = ops::Const(scope.WithOpName("value"), 1.0f);
+  ops::Fill fill(scope.WithOpName("fill"), dims, value);
+  ops::BroadcastTo broadcast(scope.WithOpName("broadcast"), value, dims);
+  ops::Identity fill_out(scope.WithOpName("fill_out"), fill);
+  ops::Identity broadcast_out(scope.WithOpName("broadcast_out"), broadcast);
+
+  GrapplerItem item;
+  item.fetch = {"fill_out", "broadcast_out"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "fill" || node.name() == "broadcast") {
+      EXPECT_EQ(node.op(), "Const") << node.name();
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 2);
+}
+
+TEST_F(ConstantFoldingTest, FoldIndependentNodesInWaves) {
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+
+  // Chains of foldable nodes: each wave folds one node of every chain.
+  constexpr int kNumChains = 16;
+  constexpr int kChainLength = 3;
+  GrapplerItem item;
+  std::vector<Output> ends;
+  for (int i = 0; i < kNumChains; ++i) {
+    Output node = ops::Const(scope.WithOpName(strings::StrCat("c", i)),
+                             static_cast<float>(i), {2});
+    for (int j = 0; j < kChainLength; ++j) {
+      node = ops::Add(scope.WithOpName(strings::StrCat("add", i, "_", j)), node,
+                      node);
+    }
+    const string out = strings::StrCat("out", i);
+    ops::Identity(scope.WithOpName(out), node);
+    item.fetch.push_back(out);
+  }
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    if (!absl::StartsWith(node.name(), "out")) {
+      EXPECT_EQ(node.op(), "Const") << node.name();
+    }
+  }
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), kNumChains);
+  for (int i = 0; i < kNumChains; ++i) {
+    const float expected = static_cast<float>(i) * (1 << kChainLength);
+    test::ExpectTensorEqual<float>(tensors[i],
+                                   test::AsTensor<float>({expected, expected}));
+  }
+}
+
 TEST_F(ConstantFoldingTest, MergeConcat) {
   tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
 
@@ -0,0 +1,224 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_batching.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDatasetV2";
+constexpr char kMapDefun[] = "MapDefun";
+constexpr char kParallelMapDataset[] = "ParallelMapDatasetV2";
+constexpr char kUnbatchDataset[] = "UnbatchDataset";
+
+bool IsFullyDefined(const AttrValue& shapes) {
+  for (const auto& shape : shapes.list().shape()) {
+    if (!PartialTensorShape(shape).IsFullyDefined()) return false;
+  }
+  return true;
+}
+
+// Returns `shapes` with an unknown batch dimension prepended to each shape.
+AttrValue BatchedShapes(const AttrValue& shapes) {
+  AttrValue batched;
+  for (const auto& shape : shapes.list().shape()) {
+    TensorShapeProto* batched_shape = batched.mutable_list()->add_shape();
+    batched_shape->add_dim()->set_size(-1);
+    for (const auto& dim : shape.dim()) {
+      batched_shape->add_dim()->set_size(dim.size());
+    }
+  }
+  return batched;
+}
+
+bool HasConcreteTypes(const OpDef& signature) {
+  for (const auto& args : {signature.input_arg(), signature.output_arg()}) {
+    for (const auto& arg : args) {
+      if (arg.type() == DT_INVALID || !arg.number_attr().empty() ||
+          !arg.type_list_attr().empty() || arg.is_ref()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns whether the map `map_node` of elements produced by `input_node` can
+// be applied to batches of elements without changing its results.
+bool CanBatch(const NodeDef& map_node, const NodeDef& input_node,
+              const FunctionLibraryDefinition& function_library) {
+  const FunctionDef* function =
+      function_library.Find(map_node.attr().at("f").func().name());
+  if (function == nullptr || !HasConcreteTypes(function->signature())) {
+    return false;
+  }
+  if (function_utils::IsFunctionStateful(function_library, *function)) {
+    return false;
+  }
+  // Without `preserve_cardinality`, an OutOfRange error ends the map, which
+  // would drop the other elements of the batch.
+  const AttrValue* preserve_cardinality =
+      gtl::FindOrNull(map_node.attr(), "preserve_cardinality");
+  if (preserve_cardinality == nullptr || !preserve_cardinality->b()) {
+    return false;
+  }
+  const int num_captured = map_node.attr().at("Targuments").list().type_size();
+  const int num_components =
+      function->signature().input_arg_size() - num_captured;
+  const AttrValue* input_shapes =
+      gtl::FindOrNull(input_node.attr(), "output_shapes");
+  if (num_components < 1 || input_shapes == nullptr ||
+      input_shapes->list().shape_size() != num_components) {
+    return false;
+  }
+  // Batching elements requires them to have the same shapes, and MapDefun
+  // requires the results to have the same shapes.
+  return IsFullyDefined(*input_shapes) &&
+         IsFullyDefined(map_node.attr().at("output_shapes"));
+}
+
+// Returns a function with the signature of the map function of `map_node`
+// that runs it on each slice of its non-captured arguments.
+FunctionDef MakeBatchedFunction(const NodeDef& map_node,
+                                const FunctionDef& function,
+                                const FunctionDefLibrary& library) {
+  FunctionDef batched_function;
+  OpDef* signature = batched_function.mutable_signature();
+  *signature = function.signature();
+  graph_utils::SetUniqueGraphFunctionName(
+      strings::StrCat("batched_", function.signature().name()), &library,
+      &batched_function);
+  signature->set_is_stateful(false);
+  signature->clear_control_output();
+
+  const int num_captured = map_node.attr().at("Targuments").list().type_size();
+  const int num_components = signature->input_arg_size() - num_captured;
+  NodeDef* map_defun = function_utils::AddNode("map_defun", kMapDefun, {}, {},
+                                               &batched_function);
+  DataTypeVector component_types, captured_types;
+  for (int i = 0; i < signature->input_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = signature->input_arg(i);
+    map_defun->add_input(arg.name());
+    (i < num_components ? component_types : captured_types)
+        .push_back(arg.type());
+  }
+  AddNodeAttr("Targuments", component_types, map_defun);
+  AddNodeAttr("Tcaptured", captured_types, map_defun);
+  graph_utils::CopyAttribute("output_types", map_node, map_defun);
+  graph_utils::CopyAttribute("output_shapes", map_node, map_defun);
+  (*map_defun->mutable_attr())["f"] = map_node.attr().at("f");
+
+  for (int i = 0; i < signature->output_arg_size(); ++i) {
+    (*batched_function.mutable_ret())[signature->output_arg(i).name()] =
+        strings::StrCat(map_defun->name(), ":output:", i);
+  }
+  return batched_function;
+}
+
+}  // namespace
+
+Status MapBatching::OptimizeAndCollectStats(Cluster* cluster,
+                                            const GrapplerItem& item,
+                                            GraphDef* output,
+                                            OptimizationStats* stats) {
+  *output = item.graph;
+  if (batch_size_ <= 1) return OkStatus();
+  MutableGraphView graph(output);
+
+  // Like map_parallelization, only rewrites the main dataset pipeline.
+  if (graph_utils::IsItemDerivedFromFunctionDef(item, graph)) return OkStatus();
+
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& map_node : item.graph.node()) {
+    if (map_node.op() != kParallelMapDataset) continue;
+    const NodeDef* input_node = graph_utils::GetInputNode(map_node, graph);
+    if (input_node == nullptr ||
+        !CanBatch(map_node, *input_node, function_library)) {
+      continue;
+    }
+
+    NodeDef batch_node;
+    batch_node.set_op(kBatchDataset);
+    graph_utils::SetUniqueGraphNodeName(kBatchDataset, graph.graph(),
+                                        &batch_node);
+    batch_node.add_input(map_node.input(0));
+    batch_node.add_input(
+        graph_utils::AddScalarConstNode<int64_t>(batch_size_, &graph)->name());
+    batch_node.add_input(
+        graph_utils::AddScalarConstNode<bool>(false, &graph)->name());
+    AddNodeAttr("parallel_copy", false, &batch_node);
+    DataTypeVector input_types;
+    TF_RETURN_IF_ERROR(
+        graph_utils::GetDatasetOutputTypesAttr(*input_node, &input_types));
+    AddNodeAttr("output_types", input_types, &batch_node);
+    (*batch_node.mutable_attr())["output_shapes"] =
+        BatchedShapes(input_node->attr().at("output_shapes"));
+    const string batch_name = graph.AddNode(std::move(batch_node))->name();
+
+    const FunctionDef* function =
+        function_library.Find(map_node.attr().at("f").func().name());
+    FunctionDef batched_function =
+        MakeBatchedFunction(map_node, *function, output->library());
+    NodeDef batched_map_node = map_node;
+    graph_utils::SetUniqueGraphNodeName(kParallelMapDataset, graph.graph(),
+                                        &batched_map_node);
+    *batched_map_node.mutable_input(0) = batch_name;
+    (*batched_map_node.mutable_attr())["f"].mutable_func()->Clear();
+    (*batched_map_node.mutable_attr())["f"].mutable_func()->set_name(
+        batched_function.signature().name());
+    (*batched_map_node.mutable_attr())["output_shapes"] =
+        BatchedShapes(map_node.attr().at("output_shapes"));
+    *output->mutable_library()->add_function() = std::move(batched_function);
+    const string batched_map_name =
+        graph.AddNode(std::move(batched_map_node))->name();
+
+    NodeDef unbatch_node;
+    unbatch_node.set_op(kUnbatchDataset);
+    graph_utils::SetUniqueGraphNodeName(kUnbatchDataset, graph.graph(),
+                                        &unbatch_node);
+    unbatch_node.add_input(batched_map_name);
+    graph_utils::CopyShapesAndTypesAttrs(map_node, &unbatch_node);
+    NodeDef* unbatch = graph.AddNode(std::move(unbatch_node));
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(map_node.name(), unbatch->name()));
+
+    nodes_to_delete.insert(map_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapBatching, "map_batching");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_BATCHING_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_BATCHING_H_
+
+#include "absl/strings/numbers.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/grappler/optimizers/data/optimizer_base.h"
+
+namespace tensorflow {
+namespace grappler {
+
+constexpr char kMapBatchSize[] = "batch_size";
+
+// This optimization applies the function of a ParallelMapDatasetV2 to batches
+// of `batch_size` input elements at a time, by rewriting
+//
+//   input.map(f)
+//
+// into
+//
+//   input.batch(batch_size).map(g).unbatch()
+//
+// where `g` runs `f` on each slice of its inputs through a MapDefun op. Each
+// function call then processes `batch_size` elements, which amortizes the
+// per-call overhead of the map over the batch. This pays off for cheap
+// functions of small elements, at the cost of copying each element into and
+// out of a batch.
+//
+// The rewrite only applies to stateless functions of elements of fully
+// defined shapes, whose results have fully defined shapes, so that the
+// batched pipeline produces the same elements. An error in any element of a
+// batch fails the whole batch.
+class MapBatching : public TFDataOptimizerBase {
+ public:
+  MapBatching() = default;
+  ~MapBatching() override = default;
+
+  string name() const override { return "map_batching"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Init(
+      const tensorflow::RewriterConfig_CustomGraphOptimizer* config) override {
+    if (!config) return OkStatus();
+
+    auto it = config->parameter_map().find(kMapBatchSize);
+    if (it == config->parameter_map().end()) return OkStatus();
+    if (!absl::SimpleAtoi(it->second.s(), &batch_size_)) {
+      return errors::InvalidArgument("Invalid `", kMapBatchSize,
+                                     "` parameter: ", it->second.s());
+    }
+    return OkStatus();
+  }
+
+  Status OptimizeAndCollectStats(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* output,
+                                 OptimizationStats* stats) override;
+
+ private:
+  // The rewrite does nothing unless this is greater than 1.
+  int64_t batch_size_ = 0;
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_DATA_MAP_BATCHING_H_
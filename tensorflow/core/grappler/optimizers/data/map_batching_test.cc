@@ -0,0 +1,151 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_batching.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+Status OptimizeWithMapBatching(const GrapplerItem& item, GraphDef* output,
+                               int64_t batch_size) {
+  MapBatching optimizer;
+  RewriterConfig_CustomGraphOptimizer config;
+  (*config.mutable_parameter_map())[kMapBatchSize].set_s(
+      strings::StrCat(batch_size));
+  TF_RETURN_IF_ERROR(optimizer.Init(&config));
+  return optimizer.Optimize(nullptr, item, output);
+}
+
+// Returns a pipeline mapping XTimesTwoInt32 over elements of shape
+// `element_shape`.
+GrapplerItem MakeMapItem(const PartialTensorShape& element_shape,
+                         bool preserve_cardinality = true) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   element_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT32}}}),
+       NDef("num_parallel_calls", "Const", {},
+            {{"value", 2}, {"dtype", DT_INT64}}),
+       NDef("map", "ParallelMapDatasetV2", {"range", "num_parallel_calls"},
+            {{"f", FunctionDefHelper::FunctionRef("XTimesTwoInt32")},
+             {"Targuments", gtl::ArraySlice<DataType>{}},
+             {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                   element_shape}},
+             {"output_types", gtl::ArraySlice<DataType>{DT_INT32}},
+             {"deterministic", "true"},
+             {"preserve_cardinality", preserve_cardinality}}),
+       NDef("Sink", "Identity", {"map"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwoInt32(),
+      });
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(MapBatchingTest, BatchesMap) {
+  GrapplerItem item = MakeMapItem(PartialTensorShape({2}));
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapBatching(item, &output, /*batch_size=*/16));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+
+  const NodeDef& unbatch = output.node(
+      graph_utils::FindGraphNodeWithOp("UnbatchDataset", output));
+  const NodeDef& map = output.node(
+      graph_utils::FindGraphNodeWithOp("ParallelMapDatasetV2", output));
+  const NodeDef& batch = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  EXPECT_EQ(output.node(graph_utils::FindGraphNodeWithName("Sink", output))
+                .input(0),
+            unbatch.name());
+  EXPECT_EQ(unbatch.input(0), map.name());
+  EXPECT_EQ(map.input(0), batch.name());
+  EXPECT_EQ(map.input(1), "num_parallel_calls");
+  EXPECT_EQ(batch.input(0), "range");
+  int64_t batch_size;
+  TF_ASSERT_OK(graph_utils::GetScalarConstNodeValue(
+      output.node(graph_utils::FindGraphNodeWithName(batch.input(1), output)),
+      &batch_size));
+  EXPECT_EQ(batch_size, 16);
+
+  EXPECT_EQ(PartialTensorShape(batch.attr().at("output_shapes").list().shape(0))
+                .DebugString(),
+            "[?,2]");
+  EXPECT_EQ(PartialTensorShape(map.attr().at("output_shapes").list().shape(0))
+                .DebugString(),
+            "[?,2]");
+  EXPECT_EQ(
+      PartialTensorShape(unbatch.attr().at("output_shapes").list().shape(0))
+          .DebugString(),
+      "[2]");
+
+  const int function_index = graph_utils::FindGraphFunctionWithName(
+      map.attr().at("f").func().name(), output.library());
+  ASSERT_NE(function_index, -1);
+  const FunctionDef& function = output.library().function(function_index);
+  const NodeDef& map_defun = function.node_def(
+      function_utils::FindFunctionNodeWithOp("MapDefun", function));
+  EXPECT_EQ(map_defun.attr().at("f").func().name(), "XTimesTwoInt32");
+  EXPECT_EQ(map_defun.input(0), "x");
+  EXPECT_EQ(function.ret().at("y"), "map_defun:output:0");
+}
+
+TEST(MapBatchingTest, DisabledByDefault) {
+  GrapplerItem item = MakeMapItem(PartialTensorShape({2}));
+  MapBatching optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Init(nullptr));
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("UnbatchDataset", output));
+}
+
+TEST(MapBatchingTest, SkipsElementsOfUnknownShape) {
+  GrapplerItem item = MakeMapItem(PartialTensorShape({-1}));
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapBatching(item, &output, /*batch_size=*/16));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp("UnbatchDataset", output));
+}
+
+TEST(MapBatchingTest, SkipsMapWithoutPreserveCardinality) {
+  GrapplerItem item = MakeMapItem(PartialTensorShape({2}),
+                                  /*preserve_cardinality=*/false);
+  GraphDef output;
+  TF_ASSERT_OK(OptimizeWithMapBatching(item, &output, /*batch_size=*/16));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -38,7 +38,7 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 21> kTFDataOptimizations = {
+constexpr std::array<const char*, 22> kTFDataOptimizations = {
     "noop_elimination",
     "disable_intra_op_parallelism",
     "use_private_thread_pool",
@@ -48,6 +48,7 @@ constexpr std::array<const char*, 21> kTFDataOptimizations = {
     "filter_fusion",
     "map_and_filter_fusion",
     "map_and_batch_fusion",
+    "map_batching",
     "batch_parallelization",
     "filter_parallelization",
     "make_sloppy",
@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/tensor_float_32_utils.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -385,6 +386,70 @@ TEST_F(GenericLayoutOptimizerTest, CPUDevice) {
 #endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 }
 
+TEST_F(GenericLayoutOptimizerTest, NhwcToNchwOnCpu) {
+#if (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  GTEST_SKIP() << "The CPU layout conversion only applies without GPUs.";
+#endif  // (GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+  using test::function::NDef;
+
+  GenericLayoutOptimizer optimizer(RewriterConfig::AGGRESSIVE,
+                                   RewriterConfig::NHWC_TO_NCHW);
+
+  const Tensor kFilter = GenerateRandomTensor<DT_FLOAT>({3, 3, 8, 16});
+  const Tensor kBias = GenerateRandomTensor<DT_FLOAT>({16});
+  GrapplerItem item;
+  item.graph = test::function::GDef({
+      NDef("x", "Placeholder", {},
+           {{"dtype", DT_FLOAT}, {"shape", TensorShape({2, 8, 8, 8})}},
+           "/CPU:0"),
+      NDef("filter", "Const", {}, {{"dtype", DT_FLOAT}, {"value", kFilter}},
+           "/CPU:0"),
+      NDef("bias", "Const", {}, {{"dtype", DT_FLOAT}, {"value", kBias}},
+           "/CPU:0"),
+      NDef("conv", "Conv2D", {"x", "filter"},
+           {{"T", DT_FLOAT},
+            {"data_format", "NHWC"},
+            {"padding", "SAME"},
+            {"strides", std::vector<int>{1, 1, 1, 1}}},
+           "/CPU:0"),
+      NDef("bias_add", "BiasAdd", {"conv", "bias"},
+           {{"T", DT_FLOAT}, {"data_format", "NHWC"}}, "/CPU:0"),
+      NDef("relu", "Relu", {"bias_add"}, {{"T", DT_FLOAT}}, "/CPU:0"),
+      NDef("max_pool", "MaxPool", {"relu"},
+           {{"T", DT_FLOAT},
+            {"data_format", "NHWC"},
+            {"padding", "VALID"},
+            {"ksize", std::vector<int>{1, 2, 2, 1}},
+            {"strides", std::vector<int>{1, 2, 2, 1}}},
+           "/CPU:0"),
+      NDef("fetch", "Identity", {"max_pool"}, {{"T", DT_FLOAT}}, "/CPU:0"),
+  });
+  item.fetch = {"fetch"};
+
+  GraphDef output;
+  Status status = optimizer.Optimize(virtual_cluster_.get(), item, &output);
+  if (!IsMKLEnabled()) {
+    EXPECT_TRUE(errors::IsAborted(status)) << status;
+    return;
+  }
+  TF_ASSERT_OK(status);
+
+  utils::GraphView graph_view(&output, &status);
+  TF_ASSERT_OK(status);
+  for (const char* name : {"conv", "bias_add", "max_pool"}) {
+    auto* node = graph_view.GetNode(name);
+    ASSERT_NE(node, nullptr);
+    VerifyDataFormatAttributeMatch(node, "NCHW");
+  }
+  // The chain is converted once: one transpose into the convolution and one
+  // out of the pooling, with none in between.
+  int num_transposes = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.op() == "Transpose") ++num_transposes;
+  }
+  EXPECT_EQ(num_transposes, 2);
+}
+
 TEST_F(GenericLayoutOptimizerTest, NoOptimizeIntegerConvolution) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   auto conv = SimpleConv2D<int32>(&s, 4, 2, "VALID", "");
@@ -107,6 +107,20 @@ bool IsNonFloatingConv3D(const utils::MutableNodeView& node) {
   return false;
 }
 
+// Returns true if the CPU kernel of the layout sensitive `node` supports the
+// channels-first format. Convolutions, pooling and batch normalization only
+// do with oneDNN, which the conversion to NCHW on CPU requires.
+bool IsNchwSupportedOnCpu(const NodeDef& node) {
+  static absl::flat_hash_set<string>* nchw_cpu_ops =
+      new absl::flat_hash_set<std::string>(
+          {"AvgPool", "AvgPoolGrad", "BiasAdd", "BiasAddGrad", "Conv2D",
+           "Conv2DBackpropFilter", "Conv2DBackpropInput",
+           "DepthwiseConv2dNative", "FusedBatchNorm", "FusedBatchNormGrad",
+           "FusedBatchNormGradV2", "FusedBatchNormGradV3", "FusedBatchNormV2",
+           "FusedBatchNormV3", "MaxPool", "MaxPoolGrad"});
+  return nchw_cpu_ops->contains(node.op());
+}
+
 // Utils for layout agnostic transposer.
 
 bool IsComparisonOp(const NodeDef& node) {
@@ -289,12 +303,19 @@ bool Transposer::ShouldProcess(const TransposeContext& context,
   const bool data_format_match = !IsLayoutSensitiveOp(*node_def) ||
                                  AttrDataFormatMatch(node, context.src_format);
 
+  // Only the 4D layout sensitive ops with a channels-first kernel are converted
+  // to NCHW on CPU.
+  const bool has_dst_format_kernel =
+      !IsLayoutSensitiveOp(*node_def) || context.target_device != kCPU ||
+      (context.dst_format != "NCHW" && context.dst_format != "NCDHW") ||
+      (context.dst_format == "NCHW" && IsNchwSupportedOnCpu(*node_def));
+
   // Only transposes floating point nodes.
   const bool is_integer_conv2d = IsNonFloatingConv2D(node);
   const bool is_integer_conv3d = IsNonFloatingConv3D(node);
 
-  return is_on_target_device && data_format_match && !is_integer_conv2d &&
-         !is_integer_conv3d &&
+  return is_on_target_device && data_format_match && has_dst_format_kernel &&
+         !is_integer_conv2d && !is_integer_conv3d &&
          !context.nodes_to_preserve.contains(node_def->name()) &&
          !(node.NumRegularFanouts() == 0 && node.NumControlledFanouts() == 0);
 }
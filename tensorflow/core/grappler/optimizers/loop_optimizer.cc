@@ -22,13 +22,18 @@ limitations under the License.
 #include <unordered_set>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -715,6 +720,245 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return OkStatus();
 }
 
+// A tensor of a function body: either its input argument 'arg_index', or an
+// output of 'node'.
+struct FunctionTensor {
+  int arg_index = -1;
+  const NodeDef* node = nullptr;
+};
+
+// Resolves the tensors of the body of the cond or body function of a loop.
+class LoopFunction {
+ public:
+  explicit LoopFunction(const FunctionDef& fdef) : fdef_(fdef) {
+    for (int i = 0; i < fdef.signature().input_arg_size(); ++i) {
+      args_[fdef.signature().input_arg(i).name()] = i;
+    }
+    for (const NodeDef& node : fdef.node_def()) {
+      nodes_[node.name()] = &node;
+    }
+  }
+
+  // Returns the tensor returned as the output 'index' of the function.
+  FunctionTensor Output(int index) const {
+    if (index >= fdef_.signature().output_arg_size()) {
+      return FunctionTensor();
+    }
+    auto it = fdef_.ret().find(fdef_.signature().output_arg(index).name());
+    if (it == fdef_.ret().end()) {
+      return FunctionTensor();
+    }
+    return Resolve(it->second);
+  }
+
+  // Resolves 'tensor', either "arg" or "node:output:index", looking through
+  // Identity nodes.
+  FunctionTensor Resolve(absl::string_view tensor) const {
+    while (true) {
+      const std::vector<absl::string_view> parts = absl::StrSplit(tensor, ':');
+      if (parts.size() == 1) {
+        auto it = args_.find(parts[0]);
+        if (it == args_.end()) {
+          return FunctionTensor();
+        }
+        return FunctionTensor{it->second, nullptr};
+      }
+      auto it = nodes_.find(parts[0]);
+      if (it == nodes_.end()) {
+        return FunctionTensor();
+      }
+      const NodeDef* node = it->second;
+      if (!IsIdentity(*node) || node->input_size() == 0 ||
+          IsControlInput(node->input(0))) {
+        return FunctionTensor{-1, node};
+      }
+      tensor = node->input(0);
+    }
+  }
+
+ private:
+  const FunctionDef& fdef_;
+  absl::flat_hash_map<absl::string_view, int> args_;
+  absl::flat_hash_map<absl::string_view, const NodeDef*> nodes_;
+};
+
+bool GetScalarIntConstant(const NodeDef& node, int64_t* value) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) {
+    return false;
+  }
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      tensor.NumElements() != 1) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) {
+    *value = tensor.flat<int32>()(0);
+  } else if (tensor.dtype() == DT_INT64) {
+    *value = tensor.flat<int64_t>()(0);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the number of iterations of the functional While 'node', or -1 if it
+// isn't known statically. It is known for the loops of the form
+// 'for (i = start; i < limit; i += step)' where 'start', 'step' and 'limit'
+// are constants, 'step' is positive, and 'limit' is either a constant of the
+// cond function or a loop invariant variable.
+int64_t GetWhileTripCount(const NodeDef& node, const NodeMap& node_map,
+                          const absl::flat_hash_set<string>& feed_nodes,
+                          const FunctionLibraryDefinition& flib) {
+  const AttrValue* cond_attr = AttrSlice(node).Find("cond");
+  const AttrValue* body_attr = AttrSlice(node).Find("body");
+  if (cond_attr == nullptr || body_attr == nullptr) {
+    return -1;
+  }
+  const FunctionDef* cond_fdef = flib.Find(cond_attr->func().name());
+  const FunctionDef* body_fdef = flib.Find(body_attr->func().name());
+  if (cond_fdef == nullptr || body_fdef == nullptr) {
+    return -1;
+  }
+  const LoopFunction cond(*cond_fdef);
+  const LoopFunction body(*body_fdef);
+
+  // The constant initial value of the loop variable 'index'.
+  const int num_inputs = NumNonControlInputs(node);
+  auto get_initial_value = [&](int index, int64_t* value) {
+    if (index >= num_inputs) {
+      return false;
+    }
+    const NodeDef* input = node_map.GetNode(node.input(index));
+    return input != nullptr && IsReallyConstant(*input, feed_nodes) &&
+           GetScalarIntConstant(*input, value);
+  };
+
+  const FunctionTensor predicate = cond.Output(0);
+  if (predicate.node == nullptr || !IsLess(*predicate.node) ||
+      predicate.node->input_size() < 2) {
+    return -1;
+  }
+  const FunctionTensor counter = cond.Resolve(predicate.node->input(0));
+  const FunctionTensor limit_tensor = cond.Resolve(predicate.node->input(1));
+  if (counter.arg_index < 0) {
+    return -1;
+  }
+  int64_t limit;
+  if (limit_tensor.node != nullptr) {
+    if (!GetScalarIntConstant(*limit_tensor.node, &limit)) {
+      return -1;
+    }
+  } else if (limit_tensor.arg_index < 0 ||
+             body.Output(limit_tensor.arg_index).arg_index !=
+                 limit_tensor.arg_index ||
+             !get_initial_value(limit_tensor.arg_index, &limit)) {
+    return -1;
+  }
+  int64_t start;
+  if (!get_initial_value(counter.arg_index, &start)) {
+    return -1;
+  }
+
+  const FunctionTensor next = body.Output(counter.arg_index);
+  if (next.node == nullptr || !IsAdd(*next.node) ||
+      next.node->input_size() < 2) {
+    return -1;
+  }
+  const NodeDef* step_node = nullptr;
+  for (int i = 0; i < 2; ++i) {
+    const FunctionTensor operand = body.Resolve(next.node->input(i));
+    const FunctionTensor other = body.Resolve(next.node->input(1 - i));
+    if (operand.arg_index == counter.arg_index && other.node != nullptr) {
+      step_node = other.node;
+    }
+  }
+  int64_t step;
+  if (step_node == nullptr || !GetScalarIntConstant(*step_node, &step) ||
+      step <= 0) {
+    return -1;
+  }
+
+  if (start >= limit) {
+    return 0;
+  }
+  const uint64_t distance =
+      static_cast<uint64_t>(limit) - static_cast<uint64_t>(start);
+  const uint64_t trip_count = (distance - 1) / step + 1;
+  constexpr uint64_t kMaxTripCount = std::numeric_limits<int64_t>::max();
+  if (trip_count > kMaxTripCount) {
+    return -1;
+  }
+  return trip_count;
+}
+
+// Replaces the functional While loops of at most 'max_trip_count' iterations
+// by as many calls of their body function, one after the other, which the
+// function optimizer then inlines. The last call takes the name of the loop,
+// so that its fanouts are unchanged. This saves the frame and the Enter,
+// Merge, Switch, NextIteration and Exit nodes of each iteration of the
+// lowered loop.
+Status UnrollWhileLoops(int max_trip_count,
+                        const absl::flat_hash_set<string>& feed_nodes,
+                        GraphDef* optimized_graph) {
+  FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                 optimized_graph->library());
+  NodeMap node_map(optimized_graph);
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* node = optimized_graph->mutable_node(i);
+    if (!IsWhile(*node)) {
+      continue;
+    }
+    const int64_t trip_count =
+        GetWhileTripCount(*node, node_map, feed_nodes, flib);
+    if (trip_count < 1 || trip_count > max_trip_count) {
+      continue;
+    }
+    auto call_name = [&](int64_t iteration) {
+      return iteration + 1 == trip_count
+                 ? node->name()
+                 : strings::StrCat(node->name(), "/unrolled_", iteration);
+    };
+    bool has_name_conflict = false;
+    for (int64_t iteration = 0; iteration + 1 < trip_count; ++iteration) {
+      has_name_conflict |= node_map.NodeExists(call_name(iteration));
+    }
+    if (has_name_conflict) {
+      continue;
+    }
+    VLOG(2) << "Unrolling the " << trip_count
+            << " iterations of loop: " << node->name();
+
+    const AttrValue types = node->attr().at("T");
+    const NameAttrList body = node->attr().at("body").func();
+    const string call_op =
+        node->op() == "StatelessWhile" ? "PartitionedCall"
+                                       : "StatefulPartitionedCall";
+    std::vector<string> inputs(node->input().begin(), node->input().end());
+    for (int64_t iteration = 0; iteration < trip_count; ++iteration) {
+      const bool is_last = iteration + 1 == trip_count;
+      NodeDef* call = is_last ? node : optimized_graph->add_node();
+      call->set_name(call_name(iteration));
+      call->set_op(call_op);
+      call->set_device(node->device());
+      call->clear_input();
+      for (const string& input : inputs) {
+        call->add_input(input);
+      }
+      call->clear_attr();
+      (*call->mutable_attr())["Tin"] = types;
+      (*call->mutable_attr())["Tout"] = types;
+      *(*call->mutable_attr())["f"].mutable_func() = body;
+
+      inputs.clear();
+      for (int j = 0; j < types.list().type_size(); ++j) {
+        inputs.push_back(strings::StrCat(call->name(), ":", j));
+      }
+    }
+  }
+  return OkStatus();
+}
+
 }  // namespace
 
 LoopOptimizer::LoopOptimizer()
@@ -723,10 +967,12 @@ LoopOptimizer::LoopOptimizer()
       options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {}
 
 LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
-                             DeviceBase* cpu_device)
+                             DeviceBase* cpu_device,
+                             int max_unrolled_trip_count)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
       options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+  options_.max_unrolled_trip_count = max_unrolled_trip_count;
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -734,10 +980,19 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      options_.max_unrolled_trip_count <= 0) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
+  absl::flat_hash_set<string> feed_nodes;
+  for (const auto& feed : item.feed) {
+    feed_nodes.insert(NodeName(feed.first));
+  }
+  if (options_.max_unrolled_trip_count > 0) {
+    TF_RETURN_IF_ERROR(UnrollWhileLoops(options_.max_unrolled_trip_count,
+                                        feed_nodes, optimized_graph));
+  }
   // Set up helper data structures.
   if (options_.enable_loop_invariant_node_motion) {
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
@@ -748,10 +1003,6 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   if (options_.enable_dead_branch_removal) {
     NodeMap node_map(optimized_graph);
-    absl::flat_hash_set<string> feed_nodes;
-    for (const auto& feed : item.feed) {
-      feed_nodes.insert(NodeName(feed.first));
-    }
     TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
                                           feed_nodes, optimized_graph));
   }
@@ -33,14 +33,20 @@ class LoopOptimizer : public GraphOptimizer {
  public:
   LoopOptimizer();
 
+  // 'max_unrolled_trip_count': the functional While loops with a statically
+  //                            known number of iterations up to this are
+  //                            unrolled; 0 disables unrolling.
   explicit LoopOptimizer(RewriterConfig::Toggle opt_level,
-                         DeviceBase* cpu_device);
+                         DeviceBase* cpu_device,
+                         int max_unrolled_trip_count = 0);
 
   ~LoopOptimizer() override {}
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.max_unrolled_trip_count > 0;
+  }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -53,6 +59,7 @@ class LoopOptimizer : public GraphOptimizer {
     bool enable_loop_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
+    int max_unrolled_trip_count = 0;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
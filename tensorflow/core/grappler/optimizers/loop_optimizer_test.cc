@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -71,6 +72,50 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyWhileLoopUnrolling(LoopOptimizer* optimizer,
+                                    int max_unrolled_trip_count) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_dead_branch_removal = false;
+    optimizer->options_.max_unrolled_trip_count = max_unrolled_trip_count;
+  }
+
+  // Returns a graph squaring "x" in a functional While loop over "i", from
+  // "start" to "limit" (excluded).
+  GraphDef WhileLoopGraph(int start, int limit) const {
+    using test::function::NDef;
+    using FDH = FunctionDefHelper;
+    FunctionDef cond = FDH::Create(
+        "Cond", {"i: int32", "x: float"}, {"z: bool"}, {},
+        {{{"limit"},
+          "Const",
+          {},
+          {{"value", test::AsScalar<int32>(limit)}, {"dtype", DT_INT32}}},
+         {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+        {{"z", "less:z:0"}});
+    FunctionDef body = FDH::Create(
+        "Body", {"i: int32", "x: float"}, {"next_i: int32", "next_x: float"},
+        {},
+        {{{"one"},
+          "Const",
+          {},
+          {{"value", test::AsScalar<int32>(1)}, {"dtype", DT_INT32}}},
+         {{"add"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+         {{"mul"}, "Mul", {"x", "x"}, {{"T", DT_FLOAT}}}},
+        {{"next_i", "add:z:0"}, {"next_x", "mul:z:0"}});
+    return test::function::GDef(
+        {NDef("start", "Const", {},
+              {{"value", test::AsScalar<int32>(start)}, {"dtype", DT_INT32}}),
+         NDef("x", "Const", {},
+              {{"value", test::AsScalar<float>(2.0f)}, {"dtype", DT_FLOAT}}),
+         NDef("while", "StatelessWhile", {"start", "x"},
+              {{"T", DataTypeSlice{DT_INT32, DT_FLOAT}},
+               {"cond", FDH::FunctionRef("Cond")},
+               {"body", FDH::FunctionRef("Body")},
+               {"parallel_iterations", 10}}),
+         NDef("out", "Identity", {"while:1"}, {{"T", DT_FLOAT}})},
+        {cond, body});
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
@@ -1802,5 +1847,51 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, UnrollWhileLoop) {
+  GrapplerItem item;
+  item.graph = WhileLoopGraph(/*start=*/1, /*limit=*/4);
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyWhileLoopUnrolling(&optimizer, /*max_unrolled_trip_count=*/3);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* first = node_map.GetNode("while/unrolled_0");
+  const NodeDef* second = node_map.GetNode("while/unrolled_1");
+  const NodeDef* last = node_map.GetNode("while");
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  ASSERT_NE(last, nullptr);
+  EXPECT_EQ(output.node_size(), 6);
+  for (const NodeDef* call : {first, second, last}) {
+    EXPECT_EQ(call->op(), "PartitionedCall");
+    EXPECT_EQ(call->attr().at("f").func().name(), "Body");
+  }
+  ASSERT_EQ(first->input_size(), 2);
+  EXPECT_EQ(first->input(0), "start");
+  EXPECT_EQ(first->input(1), "x");
+  ASSERT_EQ(last->input_size(), 2);
+  EXPECT_EQ(last->input(0), "while/unrolled_1:0");
+  EXPECT_EQ(last->input(1), "while/unrolled_1:1");
+
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorEqual<float>(tensors[0], test::AsScalar<float>(256.0f));
+}
+
+TEST_F(LoopOptimizerTest, DoNotUnrollLongWhileLoop) {
+  GrapplerItem item;
+  item.graph = WhileLoopGraph(/*start=*/0, /*limit=*/4);
+  item.fetch = {"out"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyWhileLoopUnrolling(&optimizer, /*max_unrolled_trip_count=*/3);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  CompareGraphs(item.graph, output);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <limits>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -977,13 +978,12 @@ struct MemInfo {
   bool operator<(const MemInfo& other) const { return fitness < other.fitness; }
 };
 
-static bool IdentifySwappingCandidates(
-    Cluster* cluster, GrapplerItem* item,
-    std::unique_ptr<GraphMemory>* memory_ptr,
-    std::unordered_set<string>* skip_list,
-    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+// Infers the memory usage of `item` into `*memory_ptr`, unless it is already
+// known.
+static bool InferMemoryUsage(Cluster* cluster, const GrapplerItem& item,
+                             std::unique_ptr<GraphMemory>* memory_ptr) {
   if ((*memory_ptr) == nullptr) {
-    memory_ptr->reset(new GraphMemory(*item));
+    memory_ptr->reset(new GraphMemory(item));
     Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
     if (!s.ok()) {
       memory_ptr->reset();
@@ -991,6 +991,17 @@ static bool IdentifySwappingCandidates(
       return false;
     }
   }
+  return true;
+}
+
+static bool IdentifySwappingCandidates(
+    Cluster* cluster, GrapplerItem* item,
+    std::unique_ptr<GraphMemory>* memory_ptr,
+    std::unordered_set<string>* skip_list,
+    std::unordered_map<NodeDef*, SwapInfo>* nodes_to_swap) {
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
   const GraphMemory& memory = **memory_ptr;
 
   bool updated_graph = false;
@@ -1270,6 +1281,380 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// How the memory of a tensor that is live at the peak memory usage of a device
+// is used after the peak.
+enum class RematerializationChoice : uint8 {
+  // The tensor stays in device memory until its last use.
+  kKeep,
+  // The tensor is copied to the host and back before its uses after the peak.
+  kSwap,
+  // The node that produced the tensor is executed again for the uses of the
+  // tensor after the peak.
+  kRecompute,
+};
+
+struct RematerializationCandidate {
+  MutableGraphView::OutputPort port;
+  // The uses of the tensor that execute after the peak.
+  std::vector<MutableGraphView::InputPort> uses_after_peak;
+  // The node after which the tensor is recomputed.
+  const NodeDef* recompute_trigger = nullptr;
+  // The bytes saved at the peak and the time added to the step by swapping and
+  // by recomputing the tensor. A saving of 0 means that the choice is not
+  // possible.
+  int64_t swap_saving = 0;
+  Costs::NanoSeconds swap_cost;
+  int64_t recompute_saving = 0;
+  Costs::NanoSeconds recompute_cost;
+};
+
+// Chooses how to handle each candidate so as to save at least
+// `required_savings` bytes at the peak while adding as little time as possible
+// to the step, or to save as many bytes as possible if the candidates cannot
+// save `required_savings`. This is a multiple-choice knapsack problem, which is
+// solved exactly by dynamic programming over the savings rounded down to a
+// multiple of `required_savings / kNumBuckets`.
+std::vector<RematerializationChoice> ChooseRematerializations(
+    const std::vector<RematerializationCandidate>& candidates,
+    int64_t required_savings) {
+  constexpr int kNumBuckets = 1024;
+  const int64_t bucket_size =
+      (required_savings + kNumBuckets - 1) / kNumBuckets;
+  const auto num_buckets = [bucket_size](int64_t saving) -> int {
+    return std::min<int64_t>(saving / bucket_size, kNumBuckets);
+  };
+
+  // min_cost[j] is the least time added by the candidates processed so far to
+  // save at least j buckets, and choices[i][j] the choice for candidate i
+  // that achieves it.
+  constexpr double kInfinity = std::numeric_limits<double>::infinity();
+  std::vector<double> min_cost(kNumBuckets + 1, kInfinity);
+  min_cost[0] = 0;
+  std::vector<std::vector<RematerializationChoice>> choices(
+      candidates.size(), std::vector<RematerializationChoice>(
+                             kNumBuckets + 1, RematerializationChoice::kKeep));
+  for (int i = 0; i < candidates.size(); ++i) {
+    const RematerializationCandidate& candidate = candidates[i];
+    std::vector<double> new_min_cost = min_cost;
+    const auto relax = [&](RematerializationChoice choice, int64_t saving,
+                           Costs::NanoSeconds cost) {
+      const int buckets = num_buckets(saving);
+      if (buckets == 0) return;
+      for (int j = 1; j <= kNumBuckets; ++j) {
+        const double cost_with_choice =
+            min_cost[std::max(0, j - buckets)] + cost.count();
+        if (cost_with_choice < new_min_cost[j]) {
+          new_min_cost[j] = cost_with_choice;
+          choices[i][j] = choice;
+        }
+      }
+    };
+    relax(RematerializationChoice::kSwap, candidate.swap_saving,
+          candidate.swap_cost);
+    relax(RematerializationChoice::kRecompute, candidate.recompute_saving,
+          candidate.recompute_cost);
+    min_cost.swap(new_min_cost);
+  }
+
+  int j = kNumBuckets;
+  while (j > 0 && min_cost[j] == kInfinity) --j;
+  std::vector<RematerializationChoice> result(candidates.size(),
+                                              RematerializationChoice::kKeep);
+  for (int i = candidates.size() - 1; i >= 0 && j > 0; --i) {
+    result[i] = choices[i][j];
+    if (result[i] == RematerializationChoice::kSwap) {
+      j = std::max(0, j - num_buckets(candidates[i].swap_saving));
+    } else if (result[i] == RematerializationChoice::kRecompute) {
+      j = std::max(0, j - num_buckets(candidates[i].recompute_saving));
+    }
+  }
+  return result;
+}
+
+// Simulates the execution of `item` on the devices of `cluster` with the
+// analytical cost model, and records for each node the times at which it
+// starts and completes, and the sizes of its outputs.
+static bool SimulateExecution(
+    Cluster* cluster, const GrapplerItem& item,
+    std::unordered_map<string, Costs::NanoSeconds>* start_times,
+    std::unordered_map<string, Costs::NanoSeconds>* completion_times,
+    std::unordered_map<string, int64_t>* output_bytes) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  RunMetadata metadata;
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, &metadata);
+  if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+    return false;
+  }
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      start_times->emplace(node_stats.node_name(),
+                           Costs::MicroSeconds(node_stats.all_start_micros()));
+      completion_times->emplace(
+          node_stats.node_name(),
+          Costs::NanoSeconds(1) +
+              Costs::MicroSeconds(node_stats.all_start_micros() +
+                                  node_stats.op_end_rel_micros()));
+      for (int i = 0; i < node_stats.output_size(); ++i) {
+        output_bytes->emplace(strings::StrCat(node_stats.node_name(), ":", i),
+                              node_stats.output(i)
+                                  .tensor_description()
+                                  .allocation_description()
+                                  .allocated_bytes());
+      }
+    }
+  }
+  return true;
+}
+
+// Returns true if executing `node` a second time yields the same outputs.
+static bool IsRecomputable(const NodeDef& node,
+                           const std::unordered_set<string>& feeds) {
+  if (IsPersistent(node) || feeds.count(node.name()) > 0 ||
+      ModifiesFrameInfo(node) || IsSwitch(node) || IsMerge(node)) {
+    return false;
+  }
+  const OpDef* op_def;
+  if (!OpRegistry::Global()->LookUpOpDef(node.op(), &op_def).ok()) {
+    return false;
+  }
+  return !op_def->is_stateful();
+}
+
+// Lowers the peak memory usage of the GPUs to `memory_budget` bytes, or to
+// their memory size if `memory_budget` is 0, by choosing for each tensor that
+// is live at the peak whether to keep it, to swap it to the host or to
+// recompute it for its uses after the peak. The swapped inputs are annotated
+// with `_swap_to_host`, for the SwappingPass to rewrite.
+bool RematerializationPass(Cluster* cluster, int64_t memory_budget,
+                           std::unique_ptr<GraphMemory>* memory_ptr,
+                           GrapplerItem* item,
+                           std::unordered_set<string>* skip_list) {
+  if (!InferMemoryUsage(cluster, *item, memory_ptr)) {
+    return false;
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  // Do not recompute nodes which are fed, since the recomputed node would not
+  // take on the fed value.
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> start_times;
+  std::unordered_map<string, Costs::NanoSeconds> completion_times;
+  std::unordered_map<string, int64_t> output_bytes;
+  bool simulated = false;
+
+  MutableGraphView graph(&item->graph);
+  bool updated_graph = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU") {
+      continue;
+    }
+    const int64_t budget =
+        memory_budget > 0 ? memory_budget : prop.memory_size();
+    if (budget <= 0) {
+      VLOG(1) << "Memory budget unknown for device " << device.first;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory <= budget) {
+      continue;
+    }
+    if (!simulated) {
+      if (!SimulateExecution(cluster, *item, &start_times, &completion_times,
+                             &output_bytes)) {
+        return false;
+      }
+      simulated = true;
+    }
+
+    Costs::Duration peak_time = -1;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      peak_time = std::max(peak_time, live_tensor.allocation_time);
+    }
+
+    std::vector<RematerializationCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      if (live_tensor.memory_used <= 1024) {
+        // Don't bother with small tensors.
+        continue;
+      }
+      if (skip_list->find(live_tensor.node) != skip_list->end()) {
+        continue;
+      }
+      RematerializationCandidate candidate;
+      candidate.port =
+          graph.GetOutputPort(live_tensor.node, live_tensor.output_id);
+      if (candidate.port.node == nullptr) {
+        continue;
+      }
+
+      // Only the uses that start after the peak can be fed a swapped or
+      // recomputed value. The tensor can't be freed at the peak if one of its
+      // uses is running.
+      bool valid = true;
+      const NodeDef* first_use = nullptr;
+      Costs::NanoSeconds first_use_time(Costs::NanoSeconds::infinity());
+      for (MutableGraphView::InputPort input :
+           graph.GetFanout(candidate.port)) {
+        auto start = start_times.find(input.node->name());
+        auto completion = completion_times.find(input.node->name());
+        if (start == start_times.end() ||
+            completion == completion_times.end() ||
+            (start->second <= peak_time && completion->second > peak_time)) {
+          valid = false;
+          break;
+        }
+        if (completion->second <= peak_time) {
+          continue;
+        }
+        if (skip_list->find(input.node->name()) != skip_list->end() ||
+            skip_list->find(strings::StrCat(input.node->name(), ":",
+                                            input.port_id)) !=
+                skip_list->end() ||
+            !IsSwappable(input)) {
+          valid = false;
+          break;
+        }
+        candidate.uses_after_peak.push_back(input);
+        if (start->second < first_use_time) {
+          first_use_time = start->second;
+          first_use = input.node;
+        }
+      }
+      if (!valid || candidate.uses_after_peak.empty()) {
+        continue;
+      }
+
+      // The tensor is copied to the host once computed, and copied back to be
+      // used after the peak. The first use waits for the part of the round
+      // trip over PCIe (at 16 GBps) that the computation in between does not
+      // hide.
+      const Costs::Duration window =
+          first_use_time - live_tensor.allocation_time;
+      if (IsSwappable(graph, candidate.port) &&
+          window > Costs::Duration(1e6)) {
+        const Costs::NanoSeconds round_trip(2 * live_tensor.memory_used / 16);
+        candidate.swap_saving = live_tensor.memory_used;
+        candidate.swap_cost =
+            std::max<Costs::NanoSeconds>(Costs::NanoSeconds(1),
+                                         round_trip - window);
+      }
+
+      // The recomputation keeps the inputs of the node alive until the first
+      // use after the peak. Their memory is charged to the recomputation even
+      // if they are live at the peak, since they might be swapped or
+      // recomputed themselves.
+      const NodeDef& node = *candidate.port.node;
+      const string recomputed_name =
+          AddPrefixToNodeName(node.name(), kRecomputedNodePrefix);
+      if (IsRecomputable(node, feeds) &&
+          graph.GetNode(recomputed_name) == nullptr) {
+        int64_t saving = live_tensor.memory_used;
+        for (const string& input : node.input()) {
+          if (IsControlInput(input)) continue;
+          const NodeDef* fanin = graph.GetNode(NodeName(input));
+          if (fanin == nullptr) {
+            saving = 0;
+            break;
+          }
+          if (IsPersistent(*fanin)) continue;
+          const TensorId tensor = ParseTensorName(input);
+          auto it = output_bytes.find(
+              strings::StrCat(tensor.node(), ":", tensor.index()));
+          if (it == output_bytes.end()) {
+            saving = 0;
+            break;
+          }
+          saving -= it->second;
+        }
+
+        // Recompute the tensor after the fanin of its first use after the
+        // peak that completes last, if it completes after the peak. This
+        // fanin can't depend on the recomputed node: it completes before any
+        // of the uses starts.
+        Costs::NanoSeconds trigger_time = peak_time;
+        for (const string& input : first_use->input()) {
+          const NodeDef* fanin = graph.GetNode(NodeName(input));
+          if (fanin == nullptr || fanin == &node) continue;
+          auto it = completion_times.find(fanin->name());
+          if (it != completion_times.end() && it->second > trigger_time) {
+            trigger_time = it->second;
+            candidate.recompute_trigger = fanin;
+          }
+        }
+        if (saving > 0 && candidate.recompute_trigger != nullptr) {
+          candidate.recompute_saving = saving;
+          candidate.recompute_cost = completion_times[node.name()] -
+                                     start_times[node.name()];
+        }
+      }
+
+      if (candidate.swap_saving > 0 || candidate.recompute_saving > 0) {
+        candidates.push_back(std::move(candidate));
+      }
+    }
+
+    const int64_t required_savings = mem_usage.used_memory - budget;
+    const std::vector<RematerializationChoice> choices =
+        ChooseRematerializations(candidates, required_savings);
+    for (int i = 0; i < candidates.size(); ++i) {
+      const RematerializationCandidate& candidate = candidates[i];
+      const NodeDef& node = *candidate.port.node;
+      if (choices[i] == RematerializationChoice::kSwap) {
+        for (const MutableGraphView::InputPort& use :
+             candidate.uses_after_peak) {
+          VLOG(1) << "Will swap fanout " << use.node->name() << ":"
+                  << use.port_id << " of tensor " << node.name() << ":"
+                  << candidate.port.port_id;
+          AttrValue& val = (*use.node->mutable_attr())["_swap_to_host"];
+          if (val.value_case() == AttrValue::kI) {
+            const int64_t input_id = val.i();
+            val.mutable_list()->add_i(input_id);
+          }
+          val.mutable_list()->add_i(use.port_id);
+        }
+        updated_graph = true;
+      } else if (choices[i] == RematerializationChoice::kRecompute) {
+        const string recomputed_name =
+            AddPrefixToNodeName(node.name(), kRecomputedNodePrefix);
+        if (graph.GetNode(recomputed_name) != nullptr) {
+          // Another output of the node is recomputed after another trigger.
+          continue;
+        }
+        VLOG(1) << "Will recompute tensor " << node.name() << ":"
+                << candidate.port.port_id << " after "
+                << candidate.recompute_trigger->name();
+        NodeDef recomputed = node;
+        recomputed.set_name(recomputed_name);
+        *recomputed.add_input() =
+            AsControlDependency(candidate.recompute_trigger->name());
+        graph.AddNode(std::move(recomputed));
+        for (const MutableGraphView::InputPort& use :
+             candidate.uses_after_peak) {
+          TF_CHECK_OK(graph.UpdateRegularFaninByPort(
+              use.node->name(), use.port_id,
+              {recomputed_name, candidate.port.port_id}));
+        }
+        // Don't recompute the recomputed node in subsequent passes.
+        skip_list->insert(recomputed_name);
+        updated_graph = true;
+      }
+    }
+  }
+  return updated_graph;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1423,10 +1808,24 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       }
 
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (optimization_level_ == RewriterConfig::REMATERIALIZATION &&
+          cluster != nullptr) {
+        if (RematerializationPass(cluster, memory_budget_bytes_, &memory,
+                                  &optimized_item, &skip_list)) {
+          // Reset the inferred memory usage since the graph changed.
+          memory.reset();
+          updated_graph = true;
+        }
+      }
+
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      // The swaps chosen by the RematerializationPass are rewritten like the
+      // manual ones.
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::REMATERIALIZATION) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
@@ -393,6 +393,67 @@ TEST_F(MemoryOptimizerTest, UnswappableInputs) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, Rematerialization) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  // a is live from its computation to e.
+  Output a = ops::Square(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Sqrt(s.WithOpName("b").WithDevice("/gpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/gpu:0"), b);
+  Output d = ops::Log(s.WithOpName("d").WithDevice("/gpu:0"), c);
+  Output e = ops::AddN(s.WithOpName("e").WithDevice("/gpu:0"), {a, d});
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+  item.init_ops = {init.name()};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  // The graph fits a large budget.
+  MemoryOptimizer large_budget_optimizer(RewriterConfig::REMATERIALIZATION,
+                                         "gradients/", int64_t{1} << 30);
+  GraphDef output;
+  TF_EXPECT_OK(large_budget_optimizer.Optimize(cluster.get(), item, &output));
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  // Under a budget of a single tensor, the use of a by e must be fed a
+  // swapped or a recomputed value.
+  MemoryOptimizer optimizer(RewriterConfig::REMATERIALIZATION, "gradients/",
+                            128 * 128 * 8 * sizeof(float));
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  int found = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "e") {
+      ++found;
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_TRUE(node.input(0) == "swap_in_e_0" ||
+                  node.input(0) == "Recomputed/a")
+          << node.input(0);
+      EXPECT_EQ("d", node.input(1));
+    } else if (node.name() == "Recomputed/a") {
+      ++found;
+      EXPECT_EQ("Square", node.op());
+      ASSERT_EQ(2, node.input_size());
+      EXPECT_EQ("v", node.input(0));
+      EXPECT_TRUE(IsControlInput(node.input(1)));
+    }
+  }
+  EXPECT_GE(found, 1);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
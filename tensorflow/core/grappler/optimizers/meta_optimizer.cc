@@ -17,10 +17,13 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
+#include <map>
 #include <string>
 #include <type_traits>
 #include <utility>
 
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -37,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/grappler/optimizers/arithmetic_optimizer.h"
+#include "tensorflow/core/grappler/optimizers/auto_dynamic_quantization.h"
 #include "tensorflow/core/grappler/optimizers/auto_mixed_precision.h"
 #include "tensorflow/core/grappler/optimizers/auto_parallel.h"
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
@@ -61,7 +65,12 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/tpu.h"
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
@@ -107,6 +116,7 @@ int NumIterations(const RewriterConfig& cfg) {
 bool IsRunOnceOptimizer(const string& name) {
   return name == "layout" || name == "memory_optimizer" ||
          name == "loop_optimizer" ||
+         name == "auto_dynamic_quantization" ||
          absl::StartsWith(name, "auto_mixed_precision");
 }
 
@@ -240,6 +250,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
 #endif
   MK_OPT("auto_mixed_precision_cpu", "auto_mixed_precision_cpu",
          new AutoMixedPrecision(AutoMixedPrecisionMode::CPU));
+  MK_OPT("auto_dynamic_quantization", "auto_dynamic_quantization",
+         new AutoDynamicQuantization());
   MK_OPT("memory", "memory_optimization",
          new MemoryOptimizer(RewriterConfig::MANUAL));
   MK_OPT("common_subgraph_elimination", "common_subgraph_elimination",
@@ -249,7 +261,8 @@ std::unique_ptr<GraphOptimizer> MetaOptimizer::MakeNewOptimizer(
   MK_OPT("autoparallel", "auto_parallel",
          new AutoParallel(cfg_.auto_parallel().num_replicas()));
   MK_OPT("loop", "loop_optimization",
-         new LoopOptimizer(cfg_.loop_optimization(), cpu_device_));
+         new LoopOptimizer(cfg_.loop_optimization(), cpu_device_,
+                           cfg_.loop_optimizer_max_unrolled_trip_count()));
   MK_OPT("dependency", "dependency_optimization",
          new DependencyOptimizer(cfg_.dependency_optimization()));
   MK_OPT("debug_stripper", "debug_stripper", new DebugStripper());
@@ -403,6 +416,10 @@ Status MetaOptimizer::InitializeOptimizers(
     optimizers->push_back(
         std::make_unique<AutoMixedPrecision>(AutoMixedPrecisionMode::CPU));
   }
+  if (USER_IS_ON(auto_dynamic_quantization) &&
+      PLUGIN_NOT_OFF(auto_dynamic_quantization)) {
+    optimizers->push_back(std::make_unique<AutoDynamicQuantization>());
+  }
   if (BOTH_ARE_ON(pin_to_host_optimization))
     optimizers->push_back(std::make_unique<PinToHostOptimizer>());
   else if (BOTH_ARE_EXPERIMENTAL_MLIR(pin_to_host_optimization) ||
@@ -453,7 +470,8 @@ Status MetaOptimizer::InitializeOptimizers(
       VLOG(2) << "loop_optimization is not implemented in TFG yet";
     } else {
       optimizers->push_back(std::make_unique<LoopOptimizer>(
-          cfg_.loop_optimization(), cpu_device_));
+          cfg_.loop_optimization(), cpu_device_,
+          cfg_.loop_optimizer_max_unrolled_trip_count()));
     }
   }
   if (BOTH_NOT_OFF(dependency_optimization)) {
@@ -471,11 +489,14 @@ Status MetaOptimizer::InitializeOptimizers(
     if (cfg_.memory_optimizer_target_node_name_scope().empty()) {
       optimizers->push_back(
           // Use the default target node name prefix "gradients/"
-          std::make_unique<MemoryOptimizer>(cfg_.memory_optimization()));
+          std::make_unique<MemoryOptimizer>(
+              cfg_.memory_optimization(), "gradients/",
+              cfg_.memory_optimizer_budget_bytes()));
     } else {
       optimizers->push_back(std::make_unique<MemoryOptimizer>(
           cfg_.memory_optimization(),
-          cfg_.memory_optimizer_target_node_name_scope()));
+          cfg_.memory_optimizer_target_node_name_scope(),
+          cfg_.memory_optimizer_budget_bytes()));
     }
   }
   if (cfg_.auto_parallel().enable() && PLUGIN_IS_ON(auto_parallel)) {
@@ -636,6 +657,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
     PRINT_CFG(loop_optimization)
     PRINT_CFG(dependency_optimization)
     PRINT_CFG(scoped_allocator_optimization)
+    PRINT_CFG(auto_dynamic_quantization)
 #undef PRINT_CFG
     user_cfg.toggle_config["auto_mixed_precision"] =
         AutoMixedPrecisionEnabled(cfg_.auto_mixed_precision())
@@ -683,6 +705,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
                 "auto_mixed_precision_onednn_bfloat16")
       PRINT_CFG("auto_mixed_precision_mkl", "auto_mixed_precision_mkl")
       PRINT_CFG("auto_mixed_precision_cpu", "auto_mixed_precision_cpu")
+      PRINT_CFG("auto_dynamic_quantization", "auto_dynamic_quantization")
       PRINT_CFG("pin_to_host", "pin_to_host_optimization")
       PRINT_CFG("layout", "layout_optimizer")
       PRINT_CFG("remap", "remapping")
@@ -724,6 +747,7 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
         pair.first == "auto_mixed_precision_onednn_bfloat16" ||
         pair.first == "auto_mixed_precision_mkl" ||
         pair.first == "auto_mixed_precision_cpu" ||
+        pair.first == "auto_dynamic_quantization" ||
         pair.first == "pin_to_host_optimization" ||
         pair.first == "scoped_allocator_optimization") {
       // These optimizers are turned off by default.
@@ -751,7 +775,8 @@ void MetaOptimizer::PrintUserAndPluginConfigs(
 
 Status MetaOptimizer::OptimizeGraph(
     const std::vector<std::unique_ptr<GraphOptimizer>>& optimizers,
-    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph) {
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* optimization_results) {
   int min_graph_nodes = cfg_.min_graph_nodes() == 0 ? kDefaultMinGraphNodes
                                                     : cfg_.min_graph_nodes();
   if (item.graph.node_size() < min_graph_nodes) {
@@ -883,7 +908,7 @@ Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  optimization_results->push_back(optimization_result);
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -895,8 +920,9 @@ Status MetaOptimizer::OptimizeGraph(
   return OkStatus();
 }
 
-Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                                    GraphDef* optimized_graph) {
+Status MetaOptimizer::OptimizeGraph(
+    Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+    std::vector<GraphOptimizationResult>* optimization_results) {
   std::vector<std::unique_ptr<GraphOptimizer>> optimizers;
   std::set<std::string> device_types;
   TF_RETURN_IF_ERROR(GetGraphDevice(item.graph, &device_types));
@@ -908,7 +934,7 @@ Status MetaOptimizer::OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
   PrintUserAndPluginConfigs(device_types);
 
   return OptimizeGraph(std::move(optimizers), cluster, std::move(item),
-                       optimized_graph);
+                       optimized_graph, optimization_results);
 }
 
 Status MetaOptimizer::RunOptimizer(
@@ -1043,6 +1069,38 @@ void PropagateTFDataAttrs(const FunctionLibraryDefinition& flib,
   }
 }
 
+uint64 MetaOptimizer::FunctionOptimizationKey(
+    const FunctionDef& func, const FunctionLibraryDefinition& flib,
+    const GrapplerFunctionItem& func_item, Cluster* cluster) const {
+  // The optimized body depends on the bodies of the functions the function
+  // calls, e.g. through function inlining, on the options of its item and on
+  // the config, and on the devices of the cluster for the cost-based
+  // optimizers.
+  uint64 key = FunctionDefHash(func);
+  const FunctionLibraryDefinition reachable = flib.ReachableDefinitions(func);
+  std::vector<string> reachable_names = reachable.ListFunctionNames();
+  std::sort(reachable_names.begin(), reachable_names.end());
+  for (const string& name : reachable_names) {
+    key = Hash64Combine(key, FunctionDefHash(*reachable.Find(name)));
+  }
+  key = Hash64Combine(key, DeterministicProtoHash64(config_proto_));
+  key = Hash64Combine(key, xla_auto_clustering_on_);
+  key = Hash64Combine(key, func_item.graph.versions().producer());
+  key = Hash64Combine(
+      key, func_item.optimization_options().allow_non_differentiable_rewrites);
+  if (cluster != nullptr) {
+    std::map<string, uint64> device_hashes;
+    for (const auto& device : cluster->GetDevices()) {
+      device_hashes[device.first] = DeterministicProtoHash64(device.second);
+    }
+    for (const auto& device : device_hashes) {
+      key = Hash64Combine(key, Hash64(device.first));
+      key = Hash64Combine(key, device.second);
+    }
+  }
+  return key;
+}
+
 Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
                                           GraphDef* optimized_graph) {
   tensorflow::metrics::ScopedCounter<2> timings(
@@ -1080,8 +1138,8 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   const auto producer = item.graph.versions().producer();
 
   // 1. Optimize main graph
-  TF_RETURN_IF_ERROR(
-      OptimizeGraph(cluster, GrapplerItem(item), optimized_graph));
+  TF_RETURN_IF_ERROR(OptimizeGraph(cluster, GrapplerItem(item),
+                                   optimized_graph, &optimization_results_));
   VLOG(1) << "Optimized main graph.";
   GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
 
@@ -1159,11 +1217,150 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  const int num_threads = cfg_.function_optimization_threads();
+  const int cache_size = cfg_.function_optimization_cache_size();
+
+  // Optimizes the body of `func` against `flib`, which must not change until
+  // this returns. May be called concurrently for different functions.
+  const auto optimize_function =
+      [&](const FunctionDef& func, bool use_cache,
+          FunctionOptimizationCache::Entry* optimized,
+          std::vector<GraphOptimizationResult>* results) -> Status {
+    const string& func_name = func.signature().name();
+
+    // Make a GrapplerItem from a FunctionDef.
+    GrapplerFunctionItem func_item;
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, flib, producer, &func_item));
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    func_item.optimization_options().allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item.devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    uint64 cache_key = 0;
+    if (use_cache && cache_size > 0 && !is_tpu_graph) {
+      cache_key = FunctionOptimizationKey(func, flib, func_item, cluster);
+      if (FunctionOptimizationCache::Global()->Lookup(cache_key, optimized)) {
+        VLOG(3) << "Found optimized function in cache: function=" << func_name;
+        return OkStatus();
+      }
+    }
+
+    // Optimize function body graph.
+    GraphDef optimized_func_graph;
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      TF_RETURN_IF_ERROR(implementation_selector.Optimize(
+          cluster, func_item, &optimized_func_graph));
+    } else {
+      GrapplerFunctionItem func_item_copy = func_item;
+      TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                       &optimized_func_graph, results));
+    }
+
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context.
+    FunctionDefLibrary new_functions;
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        *new_functions.add_function() = func_def;
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef. The new functions are
+    // looked up before the ones of `flib`, which is left untouched.
+    func_item.SwapFunctionBody(std::move(optimized_func_graph));
+    const FunctionLibraryDefinition func_flib(&flib, new_functions);
+    TF_RETURN_IF_ERROR(
+        MakeFunctionDef(func_item, func_flib, &optimized->optimized_func));
+    optimized->new_functions.assign(new_functions.function().begin(),
+                                    new_functions.function().end());
+
+    if (cache_key != 0) {
+      FunctionOptimizationCache::Global()->Insert(cache_key, *optimized,
+                                                  cache_size);
+    }
+    return OkStatus();
+  };
+
+  // Adds the functions created by the optimization of `func` to `flib`, and
+  // replaces `func` with its optimized body.
+  const auto apply_optimized_function =
+      [&](const FunctionDef& func, FunctionOptimizationCache::Entry* optimized,
+          std::vector<GraphOptimizationResult>* results) -> Status {
+    for (const FunctionDef& func_def : optimized->new_functions) {
+      const FunctionDef* existing = flib.Find(func_def.signature().name());
+      if (existing != nullptr && !FunctionDefsEqual(*existing, func_def)) {
+        // A function optimized earlier in the same pass created a different
+        // function with the same name. Optimize `func` again against the
+        // current library, which picks unique names for its new functions.
+        VLOG(3) << "Re-optimize function: function="
+                << func.signature().name();
+        *optimized = FunctionOptimizationCache::Entry();
+        TF_RETURN_IF_ERROR(
+            optimize_function(func, /*use_cache=*/false, optimized, results));
+        break;
+      }
+    }
+    for (const FunctionDef& func_def : optimized->new_functions) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+    return flib.ReplaceFunction(func.signature().name(),
+                                optimized->optimized_func);
+  };
+
+  std::unique_ptr<thread::ThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "meta_optimizer_functions", num_threads);
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    // Functions to optimize in this pass, in library order. The library of
+    // `optimized_graph` is only updated at the end of the pass.
+    std::vector<const FunctionDef*> funcs;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1195,79 +1392,43 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
       // have to reset the flag and do at least one more pass over the library.
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
+      funcs.push_back(&func);
+    }
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    if (thread_pool == nullptr || funcs.size() < 2) {
+      // Each function is optimized against the library with the optimized
+      // bodies of the functions before it.
+      for (const FunctionDef* func : funcs) {
+        GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+        FunctionOptimizationCache::Entry optimized;
+        TF_RETURN_IF_ERROR(optimize_function(*func, /*use_cache=*/true,
+                                             &optimized,
+                                             &optimization_results_));
+        TF_RETURN_IF_ERROR(apply_optimized_function(*func, &optimized,
+                                                    &optimization_results_));
       }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
-      } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+    } else {
+      // All the functions are optimized against the library as of the start
+      // of the pass, and the results are applied in library order, so that
+      // the optimized library does not depend on the thread scheduling.
+      std::vector<FunctionOptimizationCache::Entry> optimized(funcs.size());
+      std::vector<std::vector<GraphOptimizationResult>> results(funcs.size());
+      std::vector<Status> statuses(funcs.size());
+      BlockingCounter counter(funcs.size());
+      for (int i = 0; i < funcs.size(); ++i) {
+        thread_pool->Schedule([&, i]() {
+          statuses[i] = optimize_function(*funcs[i], /*use_cache=*/true,
+                                          &optimized[i], &results[i]);
+          counter.DecrementCount();
+        });
       }
-
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
-        }
+      counter.Wait();
+      for (int i = 0; i < funcs.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        absl::c_move(results[i], std::back_inserter(optimization_results_));
+        TF_RETURN_IF_ERROR(apply_optimized_function(*funcs[i], &optimized[i],
+                                                    &optimization_results_));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1297,7 +1458,7 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
     // Invoke the optimizers.
     *optimized_graph = GraphDef();
     TF_RETURN_IF_ERROR(OptimizeGraph(optimizers, cluster, std::move(tfg_item),
-                                     optimized_graph));
+                                     optimized_graph, &optimization_results_));
   }
 #endif
 
@@ -1314,6 +1475,40 @@ Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster, GrapplerItem&& item,
   return OkStatus();
 }
 
+/* static */
+FunctionOptimizationCache* FunctionOptimizationCache::Global() {
+  static FunctionOptimizationCache* cache = new FunctionOptimizationCache();
+  return cache;
+}
+
+bool FunctionOptimizationCache::Lookup(uint64 key, Entry* entry) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  *entry = it->second;
+  ++num_hits_;
+  return true;
+}
+
+void FunctionOptimizationCache::Insert(uint64 key, const Entry& entry,
+                                       int capacity) {
+  mutex_lock l(mu_);
+  if (entries_.emplace(key, entry).second) {
+    insertion_order_.push_back(key);
+  }
+  while (insertion_order_.size() > capacity) {
+    entries_.erase(insertion_order_.front());
+    insertion_order_.pop_front();
+  }
+}
+
+void FunctionOptimizationCache::Clear() {
+  mutex_lock l(mu_);
+  entries_.clear();
+  insertion_order_.clear();
+  num_hits_ = 0;
+}
+
 string MetaOptimizer::GetResultString() const {
   std::string result_string;
   for (const GraphOptimizationResult& graph_result : optimization_results_) {
@@ -1357,6 +1552,7 @@ bool MetaOptimizerEnabled(const ConfigProto& cfg) {
              rewrite_cfg.auto_mixed_precision_onednn_bfloat16()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_mkl()) ||
          AutoMixedPrecisionEnabled(rewrite_cfg.auto_mixed_precision_cpu()) ||
+         rewrite_cfg.auto_dynamic_quantization() == RewriterConfig::ON ||
          !rewrite_cfg.optimizers().empty() ||
          !rewrite_cfg.custom_optimizers().empty();
 }
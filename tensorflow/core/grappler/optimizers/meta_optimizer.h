@@ -16,14 +16,21 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 #define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_H_
 
+#include <deque>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/device_set.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -89,19 +96,6 @@ class MetaOptimizer : public GraphOptimizer {
 
   void PrintUserAndPluginConfigs(const std::set<string>& device_types) const;
 
-  // Run optimization pass over a single GrapplerItem. Meta optimizer might run
-  // multiple such passes: 1) for the main graph 2) for the function library
-  Status OptimizeGraph(
-      const std::vector<std::unique_ptr<GraphOptimizer>>& optimizers,
-      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph);
-  Status OptimizeGraph(Cluster* cluster, GrapplerItem&& item,
-                       GraphDef* optimized_graph);
-
-  DeviceBase* const cpu_device_;  // may be NULL
-  ConfigProto config_proto_;
-  RewriterConfig& cfg_;
-  bool xla_auto_clustering_on_;
-
   struct OptimizerResult {
     string optimizer_name;
     string message;
@@ -114,6 +108,29 @@ class MetaOptimizer : public GraphOptimizer {
     std::vector<OptimizerResult> results;
   };
 
+  // Run optimization pass over a single GrapplerItem. Meta optimizer might run
+  // multiple such passes: 1) for the main graph 2) for the function library.
+  // The result of the pass is appended to `optimization_results`.
+  Status OptimizeGraph(
+      const std::vector<std::unique_ptr<GraphOptimizer>>& optimizers,
+      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+      std::vector<GraphOptimizationResult>* optimization_results);
+  Status OptimizeGraph(
+      Cluster* cluster, GrapplerItem&& item, GraphDef* optimized_graph,
+      std::vector<GraphOptimizationResult>* optimization_results);
+
+  // Returns the key of the optimized body of `func` in the
+  // FunctionOptimizationCache.
+  uint64 FunctionOptimizationKey(const FunctionDef& func,
+                                 const FunctionLibraryDefinition& flib,
+                                 const GrapplerFunctionItem& func_item,
+                                 Cluster* cluster) const;
+
+  DeviceBase* const cpu_device_;  // may be NULL
+  ConfigProto config_proto_;
+  RewriterConfig& cfg_;
+  bool xla_auto_clustering_on_;
+
   Status RunOptimizer(GraphOptimizer* optimizer, Cluster* cluster,
                       GrapplerItem* optimized_item, GraphDef* optimized_graph,
                       GraphOptimizationResult* optimization_result);
@@ -121,6 +138,52 @@ class MetaOptimizer : public GraphOptimizer {
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
+// Memoizes the optimized bodies of library functions across MetaOptimizer
+// runs, so that re-optimizing a graph whose function library is mostly the
+// same, e.g. after retracing a single tf.function, skips the functions that
+// did not change. The entries are keyed by a fingerprint of the function, of
+// the functions reachable from it and of the optimization inputs.
+//
+// This class is thread-safe.
+class FunctionOptimizationCache {
+ public:
+  struct Entry {
+    FunctionDef optimized_func;
+    // Functions created by the optimization of the function body, e.g.
+    // specializations of the functions it calls.
+    std::vector<FunctionDef> new_functions;
+  };
+
+  FunctionOptimizationCache() = default;
+
+  FunctionOptimizationCache(const FunctionOptimizationCache&) = delete;
+  void operator=(const FunctionOptimizationCache&) = delete;
+
+  // The cache shared by the MetaOptimizers of the process.
+  static FunctionOptimizationCache* Global();
+
+  // If an entry was inserted with `key`, sets `*entry` to a copy of it and
+  // returns true.
+  bool Lookup(uint64 key, Entry* entry);
+
+  // Inserts a copy of `entry` with `key`, then evicts the oldest entries until
+  // at most `capacity` remain.
+  void Insert(uint64 key, const Entry& entry, int capacity);
+
+  void Clear();
+
+  int64_t num_hits() const {
+    tf_shared_lock l(mu_);
+    return num_hits_;
+  }
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<uint64, Entry> entries_ TF_GUARDED_BY(mu_);
+  std::deque<uint64> insertion_order_ TF_GUARDED_BY(mu_);
+  int64_t num_hits_ TF_GUARDED_BY(mu_) = 0;
+};
+
 bool MetaOptimizerEnabled(const ConfigProto& cfg);
 
 // Run the meta optimizer.
@@ -420,6 +420,133 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+// Returns a graph that calls two noinline functions, one of which calls the
+// other twice, so that optimizing its body specializes the callee again.
+GrapplerItem NestedFunctionCallsItem() {
+  using test::function::NDef;
+
+  FunctionDef mul_func = FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}});
+
+  FunctionDef square_func = FunctionDefHelper::Create(
+      "MySquare", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "my_mul:z:0"}});
+  (*square_func.mutable_attr())["_noinline"].set_b(true);
+
+  FunctionDef quadratic_func = FunctionDefHelper::Create(
+      "MyQuadratic", {"x:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"square"}, "MySquare", {"x"}, {{"T", "$T"}}},
+       {{"quadratic"}, "MySquare", {"square:z"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "quadratic:z:0"}});
+  (*quadratic_func.mutable_attr())["_noinline"].set_b(true);
+
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("b", "Placeholder", {}, {{"dtype", DT_INT32}}, kDevice),
+       NDef("square", "MySquare", {"a"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("quadratic", "MyQuadratic", {"b"}, {{"T", DT_INT32}}, kDevice),
+       NDef("out_s", "Identity", {"square:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_q", "Identity", {"quadratic:0"}, {{"T", DT_INT32}}, kDevice)},
+      /*funcs=*/
+      {mul_func, square_func, quadratic_func});
+  item.fetch = {"out_s", "out_q"};
+  item.feed.emplace_back("a", test::AsScalar<float>(2.0f));
+  item.feed.emplace_back("b", test::AsScalar<int>(4));
+  return item;
+}
+
+ConfigProto FunctionOptimizationConfig() {
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.set_min_graph_nodes(-1);
+  return config_proto;
+}
+
+void ExpectSameFunctionLibrary(const GraphDef& expected,
+                               const GraphDef& actual) {
+  FunctionLibraryDefinition expected_flib(OpRegistry::Global(),
+                                          expected.library());
+  FunctionLibraryDefinition actual_flib(OpRegistry::Global(),
+                                        actual.library());
+  ASSERT_EQ(expected_flib.num_functions(), actual_flib.num_functions());
+  for (const string& name : expected_flib.ListFunctionNames()) {
+    const FunctionDef* actual_func = actual_flib.Find(name);
+    ASSERT_NE(actual_func, nullptr) << name;
+    EXPECT_TRUE(FunctionDefsEqual(*expected_flib.Find(name), *actual_func))
+        << name;
+  }
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  const GrapplerItem item = NestedFunctionCallsItem();
+
+  MetaOptimizer sequential_optimizer(nullptr, FunctionOptimizationConfig());
+  GraphDef expected;
+  TF_EXPECT_OK(sequential_optimizer.Optimize(nullptr, item, &expected));
+
+  ConfigProto config_proto = FunctionOptimizationConfig();
+  config_proto.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_function_optimization_threads(4);
+  MetaOptimizer parallel_optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(parallel_optimizer.Optimize(nullptr, item, &output));
+
+  ExpectSameFunctionLibrary(expected, output);
+  EXPECT_EQ(3, output.library().function_size());
+}
+
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithCache) {
+  FunctionOptimizationCache* cache = FunctionOptimizationCache::Global();
+  cache->Clear();
+  const GrapplerItem item = NestedFunctionCallsItem();
+
+  ConfigProto config_proto = FunctionOptimizationConfig();
+  config_proto.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_function_optimization_cache_size(16);
+
+  MetaOptimizer optimizer(nullptr, config_proto);
+  GraphDef expected;
+  TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &expected));
+  EXPECT_EQ(0, cache->num_hits());
+
+  // The second run finds the optimized bodies of the two specializations of
+  // MySquare and of the specialization of MyQuadratic in the cache.
+  MetaOptimizer cached_optimizer(nullptr, config_proto);
+  GraphDef output;
+  TF_EXPECT_OK(cached_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(3, cache->num_hits());
+  ExpectSameFunctionLibrary(expected, output);
+
+  // A different config does not share the cached bodies.
+  config_proto.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_meta_optimizer_iterations(RewriterConfig::ONE);
+  MetaOptimizer other_optimizer(nullptr, config_proto);
+  TF_EXPECT_OK(other_optimizer.Optimize(nullptr, item, &output));
+  EXPECT_EQ(3, cache->num_hits());
+
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors_expected = EvaluateFetchNodes(item);
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
+  cache->Clear();
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
@@ -25,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -74,6 +75,9 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// Chain of element-wise ops -> _FusedElementwise  // This fusion only works on
+//                                                 // CPU without oneDNN.
+//
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -92,6 +96,8 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kUnaryOpsComposition[] = "_UnaryOpsComposition";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -167,6 +173,23 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Chain of element-wise ops that can be replaced with a _FusedElementwise.
+// Each op consumes the output of the previous one, which is the only
+// consumer of that output.
+struct ElementwiseChain {
+  ElementwiseChain() = default;
+
+  // Node indices of the ops, from the first to the root of the pattern.
+  std::vector<int> ops;
+  // Op names of the fused op, a _UnaryOpsComposition contributes all of its
+  // ops.
+  std::vector<string> op_names;
+  // Input of the first op.
+  string input;
+  // Inputs of the binary ops that do not come from the chain, in order.
+  std::vector<string> args;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2670,6 +2693,186 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+// Returns true if the unary op `op` of type `dtype` is supported by the
+// _FusedElementwise kernel.
+// WARN: This should be consistent with unary_ops_composition.cc.
+bool IsFusibleUnaryElementwiseOp(const string& op, DataType dtype) {
+  static const auto* const kAllTypesOps = new absl::flat_hash_set<string>(
+      {"Abs", "Ceil", "Cos", "Expm1", "Exp", "Floor", "Inv", "Log", "Log1p",
+       "Neg", "Reciprocal", "Round", "Rsqrt", "Sigmoid", "Sin", "Sqrt",
+       "Square", "Tanh", "Elu", "Relu", "Relu6", "Selu"});
+  static const auto* const kNoHalfOps = new absl::flat_hash_set<string>(
+      {"Acos", "Acosh", "Asin", "Asinh", "Atan", "Atanh", "Cosh", "Rint",
+       "Sinh", "Tan"});
+  if (kAllTypesOps->contains(op)) return true;
+  return dtype != DT_HALF && kNoHalfOps->contains(op);
+}
+
+bool IsFusibleBinaryElementwiseOp(const NodeDef& node) {
+  return IsAdd(node) || IsSub(node) || IsMul(node) || IsRealDiv(node) ||
+         IsMaximum(node) || IsMinimum(node) || IsSquaredDifference(node);
+}
+
+// Returns true if `node` can be an op of an ElementwiseChain of type `dtype`,
+// without checking the shapes of its inputs.
+bool IsFusibleElementwise(const NodeDef& node, DataType dtype) {
+  if (!NodeIsOnCpu(&node) || !HasDataType(&node, dtype)) return false;
+  return node.op() == kUnaryOpsComposition ||
+         IsFusibleUnaryElementwiseOp(node.op(), dtype) ||
+         IsFusibleBinaryElementwiseOp(node);
+}
+
+// Returns true if the root of an ElementwiseChain may be `node`, i.e. `node`
+// and one of its inputs are fusible element-wise ops, one of which is binary.
+bool IsElementwiseChainCandidate(const utils::MutableNodeView& node_view) {
+  if (IsMKLEnabled()) return false;
+  const NodeDef* node = node_view.node();
+  const DataType dtype = GetDataTypeFromAttr(*node, "T");
+  if (dtype != DT_FLOAT && dtype != DT_HALF && dtype != DT_DOUBLE) {
+    return false;
+  }
+  if (!IsFusibleElementwise(*node, dtype)) return false;
+  for (int i = 0; i < node_view.NumRegularFanins(); ++i) {
+    const NodeDef* fanin = node_view.GetRegularFanin(i).node_view()->node();
+    if (IsFusibleElementwise(*fanin, dtype) &&
+        (IsFusibleBinaryElementwiseOp(*node) ||
+         IsFusibleBinaryElementwiseOp(*fanin))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Returns true if the `arg` operand of a binary op can be broadcast to the
+// shape `value` of its other operand by the _FusedElementwise kernel.
+bool IsFusibleElementwiseArg(const TensorShapeProto& arg,
+                             const TensorShapeProto& value) {
+  if (arg.unknown_rank() || value.unknown_rank()) return false;
+  if (ShapesSymbolicallyEqual(arg, value)) return true;
+  const int arg_rank = Rank(arg);
+  const int value_rank = Rank(value);
+  if (arg_rank > value_rank) return false;
+  if (NumCoefficients(arg) == 1) return true;
+  // The arg is a row of the last dimension of the value.
+  if (arg_rank == 0) return false;
+  for (int i = 0; i < arg_rank - 1; ++i) {
+    if (arg.dim(i).size() != 1) return false;
+  }
+  const int64_t row_size = arg.dim(arg_rank - 1).size();
+  return row_size > 0 && row_size == value.dim(value_rank - 1).size();
+}
+
+// Returns the regular input port of an op of an ElementwiseChain that takes
+// the running value of the chain, or -1 if `node_view` can not be an op of a
+// chain of type `dtype`.
+int ElementwiseChainValuePort(const RemapperContext& ctx,
+                              const utils::MutableNodeView& node_view,
+                              DataType dtype) {
+  const NodeDef* node = node_view.node();
+  if (!IsFusibleElementwise(*node, dtype) ||
+      HasControlFaninOrFanout(node_view)) {
+    return -1;
+  }
+  if (!IsFusibleBinaryElementwiseOp(*node)) {
+    return node_view.NumRegularFanins() == 1 ? 0 : -1;
+  }
+  if (node_view.NumRegularFanins() != 2) return -1;
+
+  const auto& input_props = ctx.graph_properties.GetInputProperties(
+      node->name());
+  const auto& output_props = ctx.graph_properties.GetOutputProperties(
+      node->name());
+  if (input_props.size() != 2 || output_props.empty()) return -1;
+  const auto is_value_port = [&](int port) -> bool {
+    const TensorShapeProto& value = input_props[port].shape();
+    return !value.unknown_rank() &&
+           ShapesSymbolicallyEqual(value, output_props[0].shape()) &&
+           IsFusibleElementwiseArg(input_props[1 - port].shape(), value);
+  };
+  // Prefer to continue the chain through an input that can be fused too.
+  const auto* fanin_1 = node_view.GetRegularFanin(1).node_view();
+  const int preferred_port =
+      IsFusibleElementwise(*fanin_1->node(), dtype) &&
+              HasAtMostOneFanoutAtPort0(*fanin_1)
+          ? 1
+          : 0;
+  if (is_value_port(preferred_port)) return preferred_port;
+  if (is_value_port(1 - preferred_port)) return 1 - preferred_port;
+  return -1;
+}
+
+// Finds the longest chain of element-wise ops, at least one of them binary,
+// that ends at the node `node_index`.  The chain only grows through values
+// with a single consumer, so that fusing it does not compute any op twice.
+bool FindElementwiseChain(const RemapperContext& ctx, int node_index,
+                          ElementwiseChain* matched) {
+  // The TF->XLA bridge does not support `_FusedElementwise`, and XLA fuses
+  // element-wise ops on its own.
+  if (ctx.xla_auto_clustering_on) return false;
+
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  if (!IsElementwiseChainCandidate(*root_view)) return false;
+  const NodeDef* root = root_view->node();
+  const DataType dtype = GetDataTypeFromAttr(*root, "T");
+
+  // Nodes and the ports of their running values, from the root up.
+  std::vector<std::pair<const utils::MutableNodeView*, int>> chain;
+  const utils::MutableNodeView* node_view = root_view;
+  int value_port = ElementwiseChainValuePort(ctx, *node_view, dtype);
+  while (value_port >= 0) {
+    chain.emplace_back(node_view, value_port);
+
+    const auto& fanin = node_view->GetRegularFanin(value_port);
+    const auto* fanin_view = fanin.node_view();
+    const NodeDef* fanin_node = fanin_view->node();
+    if (fanin.index() != 0 || fanin_node->device() != root->device() ||
+        !HasAtMostOneFanoutAtPort0(*fanin_view) ||
+        IsInPreserveSet(ctx, fanin_node)) {
+      break;
+    }
+    value_port = ElementwiseChainValuePort(ctx, *fanin_view, dtype);
+    if (value_port < 0) break;
+    // Leave activations and adds of contractions and batch norms to the
+    // fusions into those ops.
+    const NodeDef* value_node =
+        fanin_view->GetRegularFanin(value_port).node_view()->node();
+    if (IsConvOrMatMul(*value_node) || IsBiasAdd(*value_node) ||
+        IsFusedBatchNorm(*value_node)) {
+      break;
+    }
+    node_view = fanin_view;
+  }
+  if (chain.size() < 2) return false;
+
+  ElementwiseChain pattern;
+  bool has_binary_op = false;
+  for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+    const NodeDef* node = it->first->node();
+    const int port = it->second;
+    pattern.ops.push_back(it->first->node_index());
+    if (IsFusibleBinaryElementwiseOp(*node)) {
+      has_binary_op = true;
+      pattern.op_names.push_back(
+          port == 0 ? node->op() : absl::StrCat("Reverse", node->op()));
+      pattern.args.push_back(node->input(1 - port));
+    } else if (node->op() == kUnaryOpsComposition) {
+      std::vector<string> op_names;
+      if (!TryGetNodeAttr(*node, "op_names", &op_names)) return false;
+      pattern.op_names.insert(pattern.op_names.end(), op_names.begin(),
+                              op_names.end());
+    } else {
+      pattern.op_names.push_back(node->op());
+    }
+  }
+  // Chains of unary ops are fused into _UnaryOpsComposition by the arithmetic
+  // optimizer.
+  if (!has_binary_op) return false;
+  pattern.input = chain.back().first->node()->input(chain.back().second);
+
+  *matched = std::move(pattern);
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices,
@@ -4109,6 +4312,43 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const ElementwiseChain& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.ops.back());
+  VLOG(2) << "Fuse element-wise ops: root=" << root.name() << " op_names=["
+          << absl::StrJoin(matched.op_names, ", ") << "]";
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  fused_op.add_input(matched.input);  // 0: input
+  for (const string& arg : matched.args) {
+    fused_op.add_input(arg);
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  SetAttrValue(matched.op_names, &(*attr)["op_names"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.ops.back()] = true;
+  for (int i = 0; i + 1 < matched.ops.size(); ++i) {
+    (*nodes_to_delete)[matched.ops[i]] = true;
+  }
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -4442,6 +4682,7 @@ Status ReplaceSoftplusTanhAndMulWithMish(
 //   (3) Fusing Conv2D biasadd and relu on GPU
 //   (4) INTEL_MKL specific: Conv2D -> Add or Conv2D -> BiasAdd -> Add.
 //   (5) Fusing side output and/or activation into FusedBatchNormGrad.
+//   (6) Fusing a chain of element-wise ops.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
                             const Cluster* cluster) {
   // Candidate for a FusedBatchNorm splitting.
@@ -4579,6 +4820,12 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for an element-wise op chain fusion.
+  const auto is_elementwise_chain_candidate = [&]() -> bool {
+    return !ctx.xla_auto_clustering_on &&
+           IsElementwiseChainCandidate(*node_view);
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
@@ -4589,7 +4836,7 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() || is_elementwise_chain_candidate();
 }
 }  // namespace
 
@@ -4923,6 +5170,15 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap a chain of element-wise ops into the _FusedElementwise.
+    ElementwiseChain elementwise_chain;
+    if (allow_non_differentiable_rewrites &&
+        FindElementwiseChain(ctx, i, &elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
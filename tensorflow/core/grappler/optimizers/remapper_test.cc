@@ -1607,6 +1607,96 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+class RemapperFuseElementwiseChainTest : public RemapperTest {
+ public:
+  // Builds relu(x * scale + bias) subtracted from `other`.  If
+  // `fetch_relu` is true, the value of the relu is fetched too.
+  void RunTest(bool fetch_relu) {
+    using ::tensorflow::ops::Placeholder;
+
+    if (IsMKLEnabled()) GTEST_SKIP() << "Not supported with oneDNN.";
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto shape = ops::Placeholder::Shape({8, 16});
+    auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+    auto other = Placeholder(s.WithOpName("other"), DT_FLOAT, shape);
+    auto scale = ops::Const(s.WithOpName("scale"), 0.5f, {});
+    auto bias = ops::Const(s.WithOpName("bias"),
+                           GenerateRandomTensor<DT_FLOAT>({16}));
+
+    auto mul = ops::Mul(s.WithOpName("mul"), x, scale);
+    auto add = ops::AddV2(s.WithOpName("add"), mul, bias);
+    auto relu = ops::Relu(s.WithOpName("relu"), add);
+    auto sub = ops::Sub(s.WithOpName("sub"), other, relu);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), sub);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    if (fetch_relu) {
+      ops::Identity(s.WithOpName("fetch_relu"), relu);
+      item.fetch.push_back("fetch_relu");
+    }
+    item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({8, 16})},
+                 {"other", GenerateRandomTensor<DT_FLOAT>({8, 16})}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "mul");
+      EXPECT_NE(node.name(), "add");
+      if (node.name() == "sub" && !fetch_relu) {
+        EXPECT_EQ(node.op(), "_FusedElementwise");
+        ASSERT_EQ(node.input_size(), 4);
+        EXPECT_EQ(node.input(0), "x");
+        EXPECT_EQ(node.input(1), "scale");
+        EXPECT_EQ(node.input(2), "bias");
+        EXPECT_EQ(node.input(3), "other");
+        EXPECT_EQ(node.attr().at("num_args").i(), 3);
+        const auto op_names = node.attr().at("op_names").list().s();
+        ASSERT_EQ(op_names.size(), 4);
+        EXPECT_EQ(op_names[0], "Mul");
+        EXPECT_EQ(op_names[1], "AddV2");
+        EXPECT_EQ(op_names[2], "Relu");
+        EXPECT_EQ(op_names[3], "ReverseSub");
+        found++;
+      } else if (node.name() == "sub") {
+        // The relu has two consumers, so the sub is not fused with it.
+        EXPECT_EQ(node.op(), "Sub");
+        found++;
+      } else if (node.name() == "relu") {
+        EXPECT_TRUE(fetch_relu);
+        EXPECT_EQ(node.op(), "_FusedElementwise");
+        const auto op_names = node.attr().at("op_names").list().s();
+        ASSERT_EQ(op_names.size(), 3);
+        EXPECT_EQ(op_names[2], "Relu");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, fetch_relu ? 2 : 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), tensors_expected.size());
+    for (int i = 0; i < tensors.size(); ++i) {
+      test::ExpectClose(tensors[i], tensors_expected[i], 1e-6);
+    }
+  }
+};
+
+TEST_F(RemapperFuseElementwiseChainTest, SingleConsumers) { RunTest(false); }
+
+TEST_F(RemapperFuseElementwiseChainTest, SharedValue) { RunTest(true); }
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -889,12 +889,250 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
   }
 };
 
+// Rewrites a ConcatV2 or Pack along the first dimension so that the producers
+// of its inputs allocate their outputs from adjacent fields of one
+// ScopedAllocator backing tensor, which then already is the concatenation:
+/*
+      x1   x2   ...  xn                _ScopedAllocator
+        \   |        /                 /   |        \
+          ConcatV2          =>        x1   x2   ...  xn
+             |                          \   |        /
+                                    _ScopedAllocatorConcat
+                                              |
+                                      ConcatV2 (Identity)
+                                              |
+*/
+// The consumer keeps its name, as an Identity of the _ScopedAllocatorConcat,
+// so that its fanout and fetches are unchanged.  Consumers that do not meet
+// the requirements, e.g. whose inputs are not a multiple of
+// Allocator::kAllocatorAlignment bytes and so would be padded, are left
+// alone.
+class FanInRewriter : public UnaryElementwiseRewriter {
+ public:
+  ~FanInRewriter() override {}
+
+  bool RewritesFanIn() const override { return true; }
+
+  Status Rewrite(ScopedAllocatorOptimizer* sa_opti, int64_t invocation_count,
+                 GraphDef* graph, const string& op_name,
+                 const std::vector<NodeDef*>& ops, bool* applied) override {
+    *applied = false;
+    for (NodeDef* node : ops) {
+      DataType dtype;
+      std::vector<TensorShape> input_shapes;
+      std::vector<InputDesc> inputs;
+      TensorShape output_shape;
+      Status s = AnalyzeFanIn(sa_opti->node_map(), node, &dtype, &input_shapes,
+                              &inputs, &output_shape);
+      if (!s.ok()) {
+        VLOG(1) << "Not rewriting " << node->name() << ": " << s;
+        continue;
+      }
+      TF_RETURN_IF_ERROR(RewriteFanIn(sa_opti, invocation_count, graph, node,
+                                      dtype, input_shapes, inputs,
+                                      output_shape));
+      *applied = true;
+    }
+    return OkStatus();
+  }
+
+ private:
+  // Returns the value of the scalar Const `input`.
+  static Status GetConstAxis(NodeMap* node_map, const string& input,
+                             int64_t* axis) {
+    const NodeDef* axis_node = node_map->GetNode(input);
+    if (axis_node == nullptr || !IsConstant(*axis_node)) {
+      return errors::Aborted("Axis ", input, " is not a Const");
+    }
+    Tensor axis_tensor;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*axis_node, "value", &axis_tensor));
+    if (axis_tensor.NumElements() != 1) {
+      return errors::Aborted("Axis ", input, " is not a scalar");
+    }
+    *axis = axis_tensor.dtype() == DT_INT64
+                ? axis_tensor.flat<int64_t>()(0)
+                : static_cast<int64_t>(axis_tensor.flat<int32>()(0));
+    return OkStatus();
+  }
+
+  // Returns non-OK if `node` cannot be rewritten.  Otherwise populates the
+  // type, the concatenated inputs with their shapes, and the output shape.
+  Status AnalyzeFanIn(NodeMap* node_map, const NodeDef* node, DataType* dtype,
+                      std::vector<TensorShape>* input_shapes,
+                      std::vector<InputDesc>* inputs,
+                      TensorShape* output_shape) {
+    CHECK(graph_properties_);
+    TF_RETURN_IF_ERROR(GetNodeAttr(*node, "T", dtype));
+    // int32 tensors live in host memory on devices other than the CPU.
+    if (!DataTypeCanUseMemcpy(*dtype) || *dtype == DT_INT32 ||
+        Allocator::kAllocatorAlignment % DataTypeSize(*dtype) != 0) {
+      return errors::Aborted("Unsupported type ", DataTypeString(*dtype));
+    }
+    int num_fields;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*node, "N", &num_fields));
+    if (num_fields < 2 || node->input_size() < num_fields) {
+      return errors::Aborted("Fewer than two inputs");
+    }
+    int64_t axis;
+    if (IsPack(*node)) {
+      TF_RETURN_IF_ERROR(GetNodeAttr(*node, "axis", &axis));
+    } else {
+      TF_RETURN_IF_ERROR(
+          GetConstAxis(node_map, node->input(num_fields), &axis));
+    }
+
+    if (!graph_properties_->HasOutputProperties(node->name()) ||
+        !graph_properties_->HasInputProperties(node->name())) {
+      return errors::Aborted("No shapes");
+    }
+    const auto& output_props = graph_properties_->GetOutputProperties(
+        node->name());
+    if (output_props.size() != 1 ||
+        !PartialTensorShape(output_props[0].shape()).IsFullyDefined()) {
+      return errors::Aborted("Output shape not fully known");
+    }
+    *output_shape = TensorShape(output_props[0].shape());
+    if (axis < 0) axis += output_shape->dims();
+    if (axis != 0) {
+      return errors::Aborted("Not a concatenation along the first dimension");
+    }
+    const auto& input_props = graph_properties_->GetInputProperties(
+        node->name());
+    if (input_props.size() < num_fields) {
+      return errors::Aborted("Missing input shapes");
+    }
+
+    absl::flat_hash_set<string> producers;
+    for (int i = 0; i < num_fields; ++i) {
+      const PartialTensorShape shape(input_props[i].shape());
+      if (!shape.IsFullyDefined()) {
+        return errors::Aborted("Shape of input ", i, " not fully known");
+      }
+      input_shapes->emplace_back(input_props[i].shape());
+      if (input_shapes->back().num_elements() * DataTypeSize(*dtype) %
+              Allocator::kAllocatorAlignment !=
+          0) {
+        return errors::Aborted("Input ", i, " would be padded");
+      }
+
+      int output_slot;
+      const string producer_name = ParseNodeName(node->input(i), &output_slot);
+      NodeDef* producer = node_map->GetNode(producer_name);
+      if (producer == nullptr || output_slot < 0) {
+        return errors::Aborted("Bad input ", node->input(i));
+      }
+      if (producer->device() != node->device()) {
+        return errors::Aborted("Input ", producer_name, " on another device");
+      }
+      if (IsConstant(*producer) || IsArg(*producer) || IsVariable(*producer) ||
+          IsControlFlow(*producer)) {
+        return errors::Aborted("Input ", producer_name, " is a ",
+                               producer->op());
+      }
+      if (HasNodeAttr(*producer, kScopedAllocatorAttrName)) {
+        return errors::Aborted("Input ", producer_name,
+                               " already uses a ScopedAllocator");
+      }
+      // Each producer can only be assigned one field.
+      if (!producers.insert(producer_name).second) {
+        return errors::Aborted("Input ", producer_name, " appears twice");
+      }
+      inputs->emplace_back(producer, output_slot, const_cast<NodeDef*>(node));
+    }
+
+    std::vector<ScopedAllocator::Field> fields;
+    const int64_t num_bytes = ScopedAllocatorMgr::PopulateFields(
+        0 /*scope_id*/, *input_shapes, *dtype, &fields);
+    if (num_bytes != output_shape->num_elements() * DataTypeSize(*dtype)) {
+      return errors::Aborted("Inputs do not add up to the output");
+    }
+    return OkStatus();
+  }
+
+  Status RewriteFanIn(ScopedAllocatorOptimizer* sa_opti,
+                      int64_t invocation_count, GraphDef* graph, NodeDef* node,
+                      DataType dtype,
+                      const std::vector<TensorShape>& input_shapes,
+                      const std::vector<InputDesc>& inputs,
+                      const TensorShape& output_shape) {
+    VLOG(1) << "FanInRewriter::Rewrite " << node->name();
+    NodeMap* node_map = sa_opti->node_map();
+    const string device_name = node->device();
+    const int num_fields = inputs.size();
+    const int sa_id = sa_opti->NewScopedAllocatorId(num_fields);
+    const string sa_name =
+        strings::StrCat("scoped_allocator_", sa_id, "_", invocation_count);
+    // The ScopedAllocator expects one allocation per field.
+    const std::vector<NodeDef*> field_ops(num_fields, node);
+    TF_RETURN_IF_ERROR(ConstructScopedAllocatorNode(
+        sa_opti, graph, node_map, field_ops, device_name, dtype, sa_id, sa_name,
+        input_shapes, inputs, TensorShape({output_shape.num_elements()})));
+
+    const string sac_name = strings::StrCat("scoped_allocator_concat_", sa_id,
+                                            "_", invocation_count);
+    std::vector<NodeDefBuilder::NodeOut> sac_inputs;
+    for (const InputDesc& input : inputs) {
+      sac_inputs.emplace_back(input.from_node_def->name(), input.output_slot,
+                              dtype);
+    }
+    NodeDefBuilder sac_builder(sac_name, "_ScopedAllocatorConcat");
+    sac_builder.Device(device_name);
+    sac_builder.Attr("sa_name", sa_name);
+    sac_builder.Attr("id", sa_id);
+    sac_builder.Attr("T", dtype);
+    sac_builder.Attr("shape", output_shape);
+    sac_builder.Attr("reshape", true);
+    sac_builder.Attr("N", num_fields);
+    sac_builder.Input(NodeDefBuilder::NodeOut(sa_name, 0, dtype));
+    sac_builder.Input(sac_inputs);
+    NodeDef* sac_node = graph->add_node();
+    LOG_WARNING_AND_RETURN_IF_ERROR(sac_builder.Finalize(sac_node));
+    node_map->AddNode(sac_name, sac_node);
+    node_map->AddOutput(sa_name, sac_name);
+    for (const InputDesc& input : inputs) {
+      node_map->AddOutput(input.from_node_def->name(), sac_name);
+    }
+
+    // Turn the consumer into an Identity of the concatenation, keeping its
+    // control inputs and internal attributes.
+    std::vector<string> control_inputs;
+    for (const string& input : node->input()) {
+      if (IsControlInput(input)) control_inputs.push_back(input);
+    }
+    node_map->RemoveInputs(node->name());
+    node->clear_input();
+    node->add_input(sac_name);
+    node_map->AddOutput(sac_name, node->name());
+    for (const string& input : control_inputs) {
+      node->add_input(input);
+      node_map->AddOutput(NodeName(input), node->name());
+    }
+    std::vector<string> attrs_to_remove;
+    for (const auto& attr : node->attr()) {
+      if (!absl::StartsWith(attr.first, "_")) {
+        attrs_to_remove.push_back(attr.first);
+      }
+    }
+    for (const string& attr : attrs_to_remove) {
+      node->mutable_attr()->erase(attr);
+    }
+    node->set_op("Identity");
+    AddNodeAttr("T", dtype, node);
+    return OkStatus();
+  }
+};
+
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
     : opt_level_(opt_level) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
+  Rewriter* fan_in = new FanInRewriter();
+  to_delete_.push_back(fan_in);
+  const auto rewriter_for = [r, fan_in](const string& op_name) {
+    return op_name == "ConcatV2" || op_name == "Pack" ? fan_in : r;
+  };
   if (opts.enable_op_size() == 0) {
     // Opts handled by default:
     for (const auto& op_name : {"CollectiveReduce"}) {
@@ -904,7 +1142,7 @@ ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
   } else {
     for (const auto& op_name : opts.enable_op()) {
       op_name_set_.insert(op_name);
-      rewriters_[op_name] = r;
+      rewriters_[op_name] = rewriter_for(op_name);
     }
   }
 }
@@ -1110,6 +1348,15 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
           continue;
         }
         rewriter->SetGraphProperties(graph_properties);
+        if (rewriter->RewritesFanIn()) {
+          bool applied = false;
+          status = rewriter->Rewrite(this, invocation_count, graph, op_name,
+                                     it.second, &applied);
+          if (!status.ok()) {
+            break;
+          }
+          continue;
+        }
         std::unique_ptr<Tree> root(ComputeScopeTree(it.first, it.second));
         // Record outputs that are inputs to multiple Tree nodes.
         absl::flat_hash_set<string> seen_outputs;
@@ -93,6 +93,10 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
                            const std::vector<NodeDef*>& nodes,
                            bool* applied) = 0;
 
+    // Whether Rewrite() applies to every node on its own, by rewriting the
+    // producers of its inputs, rather than to a group of parallel nodes.
+    virtual bool RewritesFanIn() const { return false; }
+
     void SetGraphProperties(const GraphProperties& graph_properties) {
       graph_properties_ = &graph_properties;
       CHECK(graph_properties_);
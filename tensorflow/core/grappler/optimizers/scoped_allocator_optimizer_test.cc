@@ -267,6 +267,39 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(s.ToGraphDef(graph_def));
   }
 
+  // Constructs the following graph, where a, b, and c are 4x4 Consts, and
+  // s1 and s2 are Add ops.  `concat` is a ConcatV2 along `axis`, or a Pack
+  // if `pack` is true.
+  /*
+        a    b    c
+         \  / \  /
+          s1   s2
+            \  /
+           concat
+  */
+  void BuildConcatGraph(GraphDef* graph_def, int axis, bool pack) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    std::vector<float> a_values, b_values, c_values;
+    for (int i = 0; i < 16; ++i) {
+      a_values.push_back(i);
+      b_values.push_back(-2 * i);
+      c_values.push_back(1);
+    }
+    Output a = ops::Const<float>(s.WithOpName("a"), a_values, {4, 4});
+    Output b = ops::Const<float>(s.WithOpName("b"), b_values, {4, 4});
+    Output c = ops::Const<float>(s.WithOpName("c"), c_values, {4, 4});
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), b, c);
+    if (pack) {
+      ops::Stack(s.WithOpName("concat"), {s1, s2}, ops::Stack::Axis(axis));
+    } else {
+      ops::Concat(s.WithOpName("concat"), {s1, s2}, axis);
+    }
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -283,7 +316,8 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
   // returns the outputs specified by `output_names` in `outputs`.
   void ExecuteGraph(const GraphDef& graph_def,
                     const std::vector<string>& output_names,
-                    std::vector<Tensor>* outputs) {
+                    std::vector<Tensor>* outputs,
+                    const std::vector<string>& enable_ops = {"Abs"}) {
     // Turn off all optimization except the ScopedAllocatorOptimizer
     // to avoid anything that would alter the expected graph input/output,
     // e.g. by constant folding away all calculations.
@@ -297,7 +331,9 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     RewriterConfig* rwcfg = gopt->mutable_rewrite_options();
     rwcfg->clear_optimizers();
     (*rwcfg->add_optimizers()) = "scoped_allocator";
-    rwcfg->mutable_scoped_allocator_opts()->add_enable_op("Abs");
+    for (const string& op : enable_ops) {
+      rwcfg->mutable_scoped_allocator_opts()->add_enable_op(op);
+    }
     std::unique_ptr<Session> session(CreateSession(graph_def, config));
 
     std::vector<std::pair<string, Tensor>> inputs;
@@ -596,6 +632,87 @@ TEST_F(ScopedAllocatorOptimizerTest, ConstInput) {
   }
   EXPECT_EQ(num_identity_ops, 2);
 }
+TEST_F(ScopedAllocatorOptimizerTest, ConcatRewriteOnly) {
+  // Tests that the inputs of a ConcatV2 along the first dimension are
+  // allocated from adjacent fields of one backing tensor.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*axis=*/0, /*pack=*/false);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  NodeDef* concat = nullptr;
+  GetNode(&node_map, "concat", &concat);
+  EXPECT_EQ(concat->op(), "Identity");
+  ASSERT_EQ(concat->input_size(), 1);
+  NodeDef* sa_concat = nullptr;
+  GetNode(&node_map, concat->input(0), &sa_concat);
+  EXPECT_EQ(sa_concat->op(), "_ScopedAllocatorConcat");
+  ASSERT_EQ(sa_concat->input_size(), 3);
+  NodeDef* sa = nullptr;
+  GetNode(&node_map, sa_concat->input(0), &sa);
+  EXPECT_EQ(sa->op(), "_ScopedAllocator");
+  EXPECT_EQ(sa_concat->input(1), "s1");
+  EXPECT_EQ(sa_concat->input(2), "s2");
+  for (const string& name : {"s1", "s2"}) {
+    EXPECT_EQ(ValidateSAControlInput(&optimized_graph, &node_map, name), sa);
+    NodeDef* producer = nullptr;
+    GetNode(&node_map, name, &producer);
+    EXPECT_TRUE(HasNodeAttr(*producer, "_scoped_allocator"));
+  }
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatNotAlongFirstDimension) {
+  // The inputs of a concatenation along another dimension are not adjacent
+  // in the output, so the graph is left alone.
+  GrapplerItem item;
+  BuildConcatGraph(&item.graph, /*axis=*/1, /*pack=*/false);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("ConcatV2");
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  NodeDef* concat = nullptr;
+  GetNode(&node_map, "concat", &concat);
+  EXPECT_EQ(concat->op(), "ConcatV2");
+  EXPECT_EQ(optimized_graph.node_size(), item.graph.node_size());
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, ConcatExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*axis=*/0, /*pack=*/false);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"concat:0"}, &outputs,
+               /*enable_ops=*/{"ConcatV2"});
+  std::vector<float> expected;
+  for (int i = 0; i < 16; ++i) expected.push_back(-i);
+  for (int i = 0; i < 16; ++i) expected.push_back(1 - 2 * i);
+  ValidateValues(outputs, {expected});
+  EXPECT_EQ(outputs[0].shape(), TensorShape({8, 4}));
+}
+
+TEST_F(ScopedAllocatorOptimizerTest, PackExecute) {
+  GraphDef graph_def;
+  BuildConcatGraph(&graph_def, /*axis=*/0, /*pack=*/true);
+  std::vector<Tensor> outputs;
+  ExecuteGraph(graph_def, /*output_names=*/{"concat:0"}, &outputs,
+               /*enable_ops=*/{"Pack"});
+  std::vector<float> expected;
+  for (int i = 0; i < 16; ++i) expected.push_back(-i);
+  for (int i = 0; i < 16; ++i) expected.push_back(1 - 2 * i);
+  ValidateValues(outputs, {expected});
+  EXPECT_EQ(outputs[0].shape(), TensorShape({2, 4, 4}));
+}
+
 #endif  // ENABLE_MKL
 
 }  // namespace
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_resource_base.h"
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
 #include "tensorflow/core/kernels/batching_util/bounded_executor.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
 #include "tensorflow/core/kernels/batching_util/periodic_function.h"
@@ -60,6 +61,7 @@ constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
 constexpr char kFullBatchSchedulingBoostMicros[] =
     "_full_batch_scheduling_boost_micros";
+constexpr char kBatchLatencySloMicrosAttr[] = "_batch_latency_slo_micros";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -307,6 +309,11 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = false;
   }
 
+  if (c->HasAttr(kBatchLatencySloMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kBatchLatencySloMicrosAttr,
+                                 &batch_latency_slo_micros_));
+  }
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -430,6 +437,23 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      if (batch_latency_slo_micros_ > 0) {
+        // Let the controller pick batch timeouts up to the whole latency
+        // objective, and batch sizes up to the configured one.
+        serving::BatchTimeoutController::Options controller_options;
+        controller_options.latency_slo_micros = batch_latency_slo_micros_;
+        controller_options.max_batch_timeout_micros = batch_latency_slo_micros_;
+        controller_options.initial_batch_timeout_micros = batch_timeout_micros_;
+        controller_options.max_batch_size = allowed_batch_sizes_.empty()
+                                                ? max_batch_size_
+                                                : allowed_batch_sizes_.back();
+        controller_options.allowed_batch_sizes = allowed_batch_sizes_;
+        controller_options.num_batch_threads = num_batch_threads_;
+        std::unique_ptr<serving::BatchTimeoutController> controller;
+        TF_RETURN_IF_ERROR(serving::BatchTimeoutController::Create(
+            controller_options, &controller));
+        new_resource->set_batch_timeout_controller(std::move(controller));
+      }
       *r = new_resource.release();
       return OkStatus();
     };
@@ -114,6 +114,9 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool enable_adaptive_batch_threads_ = false;
+  // If positive, the batch timeout and batch size adapt to the load to keep
+  // the 99th percentile latency of the batched function below this value.
+  int64_t batch_latency_slo_micros_ = 0;
 
   mutex mu_;
 
@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
@@ -251,6 +252,29 @@ void RecordBatchCosts(const std::string& model_name,
       ->Add(absl::ToDoubleMicroseconds(total_cost));
 }
 
+// Records the `latency_ns` of `stage` in the RequestCost of each task of
+// `batch`.
+template <typename BatchT>
+void RecordTaskLatencies(const BatchT& batch, absl::string_view stage,
+                         uint64 latency_ns) {
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    RecordRequestLatency(batch.task(i).request_cost, stage,
+                         absl::Nanoseconds(latency_ns));
+  }
+}
+
+// Records the time each task of `batch` waited in the queue until
+// `processing_start_time`.
+template <typename BatchT>
+void RecordTaskQueueLatencies(const BatchT& batch,
+                              uint64 processing_start_time) {
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    RecordRequestLatency(
+        batch.task(i).request_cost, kQueueLatencyName,
+        absl::Nanoseconds(processing_start_time - batch.task(i).start_time));
+  }
+}
+
 const string& GetModelName(OpKernelContext* ctx) {
   static string* kModelNameUnset = new string("model_name_unset");
   if (!ctx->session_metadata()) return *kModelNameUnset;
@@ -277,6 +301,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->is_partial = true;
   task->start_time = this->start_time;
   task->request_cost = this->request_cost;
+  task->criticality_val = this->criticality_val;
 
   return task;
 }
@@ -331,7 +356,7 @@ Status BatchResourceBase::RegisterInput(
   batch_components->propagated_context = Context(ContextKind::kThread);
 
   if (batcher_queue_options_.enable_priority_queue) {
-    batch_components->criticality = tsl::criticality::GetCriticality();
+    batch_components->criticality_val = tsl::criticality::GetCriticality();
   }
 
   OpInputList tensors;
@@ -357,7 +382,18 @@ Status BatchResourceBase::RegisterInput(
                        context->op_kernel().name());
   RecordInputBatchSizeV2(tensors[0].shape().dim_size(0), GetModelName(context),
                          context->op_kernel().name());
-  if (batcher_) {
+  if (batcher_ && batch_timeout_controller_) {
+    // Export the decisions of the controller rather than the initial options.
+    RecordBatchParamBatchTimeoutMicros(
+        batch_timeout_controller_->batch_timeout_micros(),
+        GetModelName(context), context->op_kernel().name());
+    RecordBatchParamMaxBatchSize(batch_timeout_controller_->max_batch_size(),
+                                 GetModelName(context),
+                                 context->op_kernel().name());
+    RecordBatchParamMaxEnqueuedBatches(
+        batcher_queue_options_.max_enqueued_batches, GetModelName(context),
+        context->op_kernel().name());
+  } else if (batcher_) {
     RecordBatchParamBatchTimeoutMicros(
         batcher_queue_options_.batch_timeout_micros, GetModelName(context),
         context->op_kernel().name());
@@ -422,6 +458,10 @@ Status BatchResourceBase::RegisterInput(
   TF_RETURN_IF_ERROR(
       LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
 
+  if (batch_timeout_controller_ && forced_warmup_batch_size == 0) {
+    batch_timeout_controller_->RecordTaskArrival(batch_components->size());
+  }
+
   if (!session_metadata().name().empty()) {
     absl::MutexLock lock(&outstanding_batch_mu_);
     WarmupStateRegistry::Key key(session_metadata().name(),
@@ -613,6 +653,10 @@ Status BatchResourceBase::ConcatInputTensors(
   const int num_inputs = batch.task(0).inputs.size();
   concatenated_tensors->reserve(num_inputs);
 
+  if (ForwardSingleTaskInputs(batch, padding_amount, concatenated_tensors)) {
+    return OkStatus();
+  }
+
   // Process each input one at a time (the typical case has just one). When
   // `just_for_warmup` is true, the real data is not added. Otherwise, the real
   // data is added to the front of each `concatenated_tensor`.
@@ -796,8 +840,12 @@ Status BatchResourceBase::SplitOutputTensors(
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    Status split_status = OkStatus();
+    if (!SliceAlignedTensor(output_tensor, task_sizes_plus_optional_padding,
+                            &split_tensor)) {
+      split_status = tensor::Split(
+          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    }
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
@@ -826,6 +874,24 @@ Status BatchResourceBase::SplitOutputTensors(
   return OkStatus();
 }
 
+void BatchResourceBase::set_batch_timeout_controller(
+    std::shared_ptr<BatchTimeoutController> controller) {
+  batch_timeout_controller_ = std::move(controller);
+  if (batch_timeout_controller_ == nullptr) {
+    batcher_queue_options_.batch_timeout_micros_func = nullptr;
+    batcher_queue_options_.schedulable_batch_size_func = nullptr;
+    return;
+  }
+  batcher_queue_options_.batch_timeout_micros_func =
+      [controller = batch_timeout_controller_.get()]() -> int64_t {
+    return controller->batch_timeout_micros();
+  };
+  batcher_queue_options_.schedulable_batch_size_func =
+      [controller = batch_timeout_controller_.get()]() -> size_t {
+    return controller->max_batch_size();
+  };
+}
+
 void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
     return;
@@ -876,6 +942,9 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   auto finally =
       gtl::MakeCleanup([&cleanup_fn, &status] { cleanup_fn(status); });
 
+  const uint64 processing_start_time = EnvTime::NowNanos();
+  RecordTaskQueueLatencies(*batch, processing_start_time);
+
   status = ValidateBatch(*batch);
   if (!status.ok()) {
     return;
@@ -896,6 +965,8 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
 
   uint64 current_time = EnvTime::NowNanos();
+  RecordTaskLatencies(*batch, kBatchFormationLatencyName,
+                      current_time - processing_start_time);
   for (int i = 0; i < batch->num_tasks(); ++i) {
     RecordBatchDelayUs((current_time - batch->task(i).start_time) * 1e-3,
                        model_name, last_task_context->op_kernel().name(),
@@ -920,11 +991,29 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
           cleanup_fn(final_status);
         });
         final_status = run_status;
+        const uint64 compute_end_time = EnvTime::NowNanos();
+        RecordTaskLatencies(*batch, kComputeLatencyName,
+                            compute_end_time - current_time);
+        if (batch_timeout_controller_ &&
+            last_task.forced_warmup_batch_size == 0) {
+          const uint64 end_time = EnvTime::NowNanos();
+          std::vector<int64_t> task_latencies_micros;
+          task_latencies_micros.reserve(batch->num_tasks());
+          for (int i = 0; i < batch->num_tasks(); ++i) {
+            task_latencies_micros.push_back(
+                (end_time - batch->task(i).start_time) / 1000);
+          }
+          batch_timeout_controller_->RecordBatchProcessed(
+              processed_size, (end_time - current_time) / 1000,
+              task_latencies_micros);
+        }
         if (!final_status.ok()) {
           return;
         }
         if (last_task.forced_warmup_batch_size == 0) {
           final_status = SplitOutputTensors(combined_outputs, batch.get());
+          RecordTaskLatencies(*batch, kOutputSplitLatencyName,
+                              EnvTime::NowNanos() - compute_end_time);
         }
       });
 }
@@ -959,6 +1048,9 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
                                     processed_size, *batch);
   });
 
+  const uint64 processing_start_time = EnvTime::NowNanos();
+  RecordTaskQueueLatencies(*batch, processing_start_time);
+
   OP_REQUIRES_OK_ASYNC(last_task_context, ValidateBatch(*batch),
                        last_task_callback);
 
@@ -968,6 +1060,8 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   const Status concat_status =
       ConcatInputTensors(*batch, last_task_context, &concatenated_tensors);
   processed_size = RoundToLowestAllowedBatchSize(batch->size());
+  RecordTaskLatencies(*batch, kBatchFormationLatencyName,
+                      EnvTime::NowNanos() - processing_start_time);
   OP_REQUIRES_OK_ASYNC(last_task_context, concat_status, last_task_callback);
 
   // Process each input edge one at a time (the typical case has just one).
@@ -1146,5 +1240,35 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
   }
 }
 
+bool BatchResourceBase::SliceAlignedTensor(const Tensor& tensor,
+                                           absl::Span<const int64_t> sizes,
+                                           std::vector<Tensor>* slices) {
+  slices->clear();
+  slices->reserve(sizes.size());
+  int64_t position = 0;
+  for (const int64_t size : sizes) {
+    Tensor slice = tensor.Slice(position, position + size);
+    if (!slice.IsAligned()) {
+      slices->clear();
+      return false;
+    }
+    slices->push_back(std::move(slice));
+    position += size;
+  }
+  return true;
+}
+
+bool BatchResourceBase::ForwardSingleTaskInputs(const BatchT& batch,
+                                                int padding_amount,
+                                                std::vector<Tensor>* tensors) {
+  if (batch.num_tasks() != 1 || padding_amount != 0 ||
+      batch.task(0).forced_warmup_batch_size > 0) {
+    return false;
+  }
+  const std::vector<Tensor>& inputs = batch.task(0).inputs;
+  tensors->insert(tensors->end(), inputs.begin(), inputs.end());
+  return true;
+}
+
 }  // namespace serving
 }  // namespace tensorflow
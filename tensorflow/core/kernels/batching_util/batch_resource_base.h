@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
 #include "tensorflow/core/platform/context.h"
@@ -113,7 +114,12 @@ class BatchResourceBase : public ResourceBase {
     // this task's processing costs.
     RequestCost* request_cost = nullptr;
 
-    tsl::criticality::Criticality criticality;
+    tsl::criticality::Criticality criticality_val =
+        tsl::criticality::Criticality::kCritical;
+
+    tsl::criticality::Criticality criticality() const override {
+      return criticality_val;
+    }
 
     // If nonzero, make a batch of this size entirely out of padding. This
     // batch is processed, but is not propagated to the kernel outputs.
@@ -160,6 +166,14 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Makes `controller` adapt the batch timeout and the batch size of the
+  // batcher queues to the load, and feeds it the arrivals, processing times
+  // and latencies of this resource's tasks. Only takes effect with
+  // `SharedBatchScheduler`, and must be called before the first input is
+  // registered.
+  void set_batch_timeout_controller(
+      std::shared_ptr<BatchTimeoutController> controller);
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -244,6 +258,22 @@ class BatchResourceBase : public ResourceBase {
           batch_cost_measurements,
       int64_t processed_size, BatchT& batch);
 
+  // Splits `tensor` along the 0th dimension into views of its buffer of
+  // `sizes` rows each. Returns false, leaving `slices` empty, if any of the
+  // views would be misaligned; Eigen kernels downstream require aligned
+  // tensors.
+  //
+  // Note that the views keep the whole buffer of `tensor` alive.
+  static bool SliceAlignedTensor(const Tensor& tensor,
+                                 absl::Span<const int64_t> sizes,
+                                 std::vector<Tensor>* slices);
+
+  // If `batch` is made of a single task, not for warm-up, and gets no padding,
+  // appends the task's inputs to `tensors` and returns true. These inputs are
+  // the batch itself and need no copy.
+  static bool ForwardSingleTaskInputs(const BatchT& batch, int padding_amount,
+                                      std::vector<Tensor>* tensors);
+
  private:
   // Implementation of calling the process batch function.
   virtual void ProcessFuncBatchImpl(
@@ -301,6 +331,9 @@ class BatchResourceBase : public ResourceBase {
   std::shared_ptr<AdaptiveBatcherT> adaptive_batcher_;
   AdaptiveBatcherT::QueueOptions adaptive_batcher_queue_options_;
 
+  // If set, adapts the batch timeout and size of the queues of `batcher_`.
+  std::shared_ptr<BatchTimeoutController> batch_timeout_controller_;
+
   // A collection of batcher queues, keyed on queue name.
   // TODO(olston): Garbage-collect unused queues (perhaps simply remove empty
   // ones (with a time delay?); it's okay if they get recreated later).
@@ -241,6 +241,86 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
 }
 
+TEST(SliceAlignedTensorTest, ReturnsViewsOfAlignedSlices) {
+  // 16 bytes per row.
+  Tensor tensor(DT_FLOAT, TensorShape({32, 4}));
+  std::vector<Tensor> slices;
+  ASSERT_TRUE(
+      BatchResourceBase::SliceAlignedTensor(tensor, {16, 8, 8}, &slices));
+  ASSERT_EQ(slices.size(), 3);
+  const char* data = tensor.tensor_data().data();
+  EXPECT_EQ(slices[0].shape(), TensorShape({16, 4}));
+  EXPECT_EQ(slices[0].tensor_data().data(), data);
+  EXPECT_EQ(slices[1].shape(), TensorShape({8, 4}));
+  EXPECT_EQ(slices[1].tensor_data().data(), data + 16 * 16);
+  EXPECT_EQ(slices[2].shape(), TensorShape({8, 4}));
+  EXPECT_EQ(slices[2].tensor_data().data(), data + 24 * 16);
+  for (const Tensor& slice : slices) {
+    EXPECT_TRUE(slice.SharesBufferWith(tensor));
+  }
+}
+
+TEST(SliceAlignedTensorTest, FailsOnMisalignedSlices) {
+#if EIGEN_MAX_ALIGN_BYTES == 0
+  GTEST_SKIP() << "Tensors need no alignment in this build.";
+#endif
+  // 4 bytes per row, so the second slice starts misaligned.
+  Tensor tensor(DT_FLOAT, TensorShape({3, 1}));
+  std::vector<Tensor> slices = {Tensor(DT_FLOAT, TensorShape({1}))};
+  EXPECT_FALSE(BatchResourceBase::SliceAlignedTensor(tensor, {1, 2}, &slices));
+  // The caller falls back to copying the slices.
+  EXPECT_TRUE(slices.empty());
+}
+
+TEST(ForwardSingleTaskInputsTest, ForwardsSingleTaskWithoutPadding) {
+  BatchResourceBase::BatchT batch;
+  batch.AddTask(MakeBatchTask(/*task_size=*/4, nullptr));
+  batch.Close();
+
+  std::vector<Tensor> tensors;
+  ASSERT_TRUE(BatchResourceBase::ForwardSingleTaskInputs(
+      batch, /*padding_amount=*/0, &tensors));
+  ASSERT_EQ(tensors.size(), 1);
+  EXPECT_TRUE(tensors[0].SharesBufferWith(batch.task(0).inputs[0]));
+}
+
+TEST(ForwardSingleTaskInputsTest, DoesNotForwardPaddedTask) {
+  BatchResourceBase::BatchT batch;
+  batch.AddTask(MakeBatchTask(/*task_size=*/3, nullptr));
+  batch.Close();
+
+  std::vector<Tensor> tensors;
+  EXPECT_FALSE(BatchResourceBase::ForwardSingleTaskInputs(
+      batch, /*padding_amount=*/1, &tensors));
+  EXPECT_TRUE(tensors.empty());
+}
+
+TEST(ForwardSingleTaskInputsTest, DoesNotForwardMultipleTasks) {
+  BatchResourceBase::BatchT batch;
+  batch.AddTask(MakeBatchTask(/*task_size=*/2, nullptr));
+  batch.AddTask(MakeBatchTask(/*task_size=*/2, nullptr));
+  batch.Close();
+
+  std::vector<Tensor> tensors;
+  EXPECT_FALSE(BatchResourceBase::ForwardSingleTaskInputs(
+      batch, /*padding_amount=*/0, &tensors));
+  EXPECT_TRUE(tensors.empty());
+}
+
+TEST(ForwardSingleTaskInputsTest, DoesNotForwardWarmupTask) {
+  BatchResourceBase::BatchT batch;
+  std::unique_ptr<BatchResourceBase::BatchTask> task =
+      MakeBatchTask(/*task_size=*/4, nullptr);
+  task->forced_warmup_batch_size = 4;
+  batch.AddTask(std::move(task));
+  batch.Close();
+
+  std::vector<Tensor> tensors;
+  EXPECT_FALSE(BatchResourceBase::ForwardSingleTaskInputs(
+      batch, /*padding_amount=*/0, &tensors));
+  EXPECT_TRUE(tensors.empty());
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -42,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tsl/platform/criticality.h"
 
 namespace tensorflow {
 namespace serving {
@@ -64,6 +66,20 @@ class BatchTask {
   // Returns the size of the task, in terms of how much it contributes to the
   // size of a batch. (A batch's size is the sum of its task sizes.)
   virtual size_t size() const = 0;
+
+  // Returns the criticality of the task. Schedulers that keep low priority
+  // tasks apart put the sheddable ones there.
+  virtual tsl::criticality::Criticality criticality() const {
+    return tsl::criticality::Criticality::kCritical;
+  }
+
+  // Returns the time, in microseconds in the time base of the scheduler's
+  // Env::NowMicros(), after which the result of the task is of no use.
+  // Schedulers may process the tasks with the earliest deadlines first, and
+  // drop the tasks whose deadline has passed. Defaults to no deadline.
+  virtual uint64 deadline_micros() const {
+    return std::numeric_limits<uint64>::max();
+  }
 };
 
 // A thread-safe collection of BatchTasks, to be executed together in some
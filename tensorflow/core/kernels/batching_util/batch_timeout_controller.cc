@@ -0,0 +1,239 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// The largest fraction of the batch threads' time that batches of the picked
+// size may take at the observed arrival rate.
+constexpr double kMaxUtilization = 0.8;
+
+// The bounds of the correction applied to the latency budget after one
+// interval. Decreases are faster than increases so that SLO violations are
+// short-lived.
+constexpr double kMinBudgetStep = 0.5;
+constexpr double kMaxBudgetStep = 1.1;
+
+// The bounds of the ratio of the latency budget to the SLO.
+constexpr double kMinBudgetFactor = 0.1;
+constexpr double kMaxBudgetFactor = 2.0;
+
+}  // namespace
+
+/*static*/ Status BatchTimeoutController::Create(
+    const Options& options,
+    std::unique_ptr<BatchTimeoutController>* controller) {
+  if (options.latency_slo_micros <= 0) {
+    return errors::InvalidArgument("latency_slo_micros must be positive; was ",
+                                   options.latency_slo_micros);
+  }
+  if (options.latency_percentile <= 0 || options.latency_percentile > 100) {
+    return errors::InvalidArgument(
+        "latency_percentile must be in (0, 100]; was ",
+        options.latency_percentile);
+  }
+  if (options.min_batch_timeout_micros < 0 ||
+      options.max_batch_timeout_micros < options.min_batch_timeout_micros) {
+    return errors::InvalidArgument(
+        "Batch timeout bounds must satisfy 0 <= min_batch_timeout_micros <= "
+        "max_batch_timeout_micros; were ",
+        options.min_batch_timeout_micros, " and ",
+        options.max_batch_timeout_micros);
+  }
+  if (options.max_batch_size <= 0) {
+    return errors::InvalidArgument("max_batch_size must be positive; was ",
+                                   options.max_batch_size);
+  }
+  int32 last_size = 0;
+  for (int32 size : options.allowed_batch_sizes) {
+    if (size <= last_size || size > options.max_batch_size) {
+      return errors::InvalidArgument(
+          "allowed_batch_sizes must increase monotonically and be at most "
+          "max_batch_size");
+    }
+    last_size = size;
+  }
+  if (options.num_batch_threads <= 0) {
+    return errors::InvalidArgument("num_batch_threads must be positive; was ",
+                                   options.num_batch_threads);
+  }
+  if (options.adjustment_interval_batches <= 0) {
+    return errors::InvalidArgument(
+        "adjustment_interval_batches must be positive; was ",
+        options.adjustment_interval_batches);
+  }
+  if (options.smoothing_factor <= 0 || options.smoothing_factor > 1) {
+    return errors::InvalidArgument("smoothing_factor must be in (0, 1]; was ",
+                                   options.smoothing_factor);
+  }
+  controller->reset(new BatchTimeoutController(options));
+  return OkStatus();
+}
+
+BatchTimeoutController::BatchTimeoutController(const Options& options)
+    : options_(options),
+      batch_timeout_micros_(std::clamp(options.initial_batch_timeout_micros,
+                                       options.min_batch_timeout_micros,
+                                       options.max_batch_timeout_micros)),
+      max_batch_size_(options.max_batch_size),
+      interval_start_micros_(options.env->NowMicros()) {
+  if (options.allowed_batch_sizes.empty()) {
+    for (int size = 1; size < options.max_batch_size; size *= 2) {
+      batch_sizes_.push_back(size);
+    }
+    batch_sizes_.push_back(options.max_batch_size);
+  } else {
+    batch_sizes_.assign(options.allowed_batch_sizes.begin(),
+                        options.allowed_batch_sizes.end());
+  }
+}
+
+void BatchTimeoutController::RecordTaskArrival(int64_t task_size) {
+  interval_arrived_items_.fetch_add(task_size, std::memory_order_relaxed);
+}
+
+void BatchTimeoutController::RecordBatchProcessed(
+    int batch_size, int64_t processing_micros,
+    absl::Span<const int64_t> task_latencies_micros) {
+  mutex_lock l(mu_);
+  auto it = std::lower_bound(batch_sizes_.begin(), batch_sizes_.end(),
+                             batch_size);
+  const int key = it == batch_sizes_.end() ? batch_sizes_.back() : *it;
+  auto [average, inserted] = processing_micros_.emplace(key, processing_micros);
+  if (!inserted) {
+    average->second = options_.smoothing_factor * processing_micros +
+                      (1 - options_.smoothing_factor) * average->second;
+  }
+  interval_latencies_micros_.insert(interval_latencies_micros_.end(),
+                                    task_latencies_micros.begin(),
+                                    task_latencies_micros.end());
+  if (++interval_batches_ >= options_.adjustment_interval_batches) {
+    Adjust();
+  }
+}
+
+double BatchTimeoutController::EstimateProcessingMicros(int batch_size) const {
+  if (processing_micros_.empty()) {
+    return -1;
+  }
+  auto upper = processing_micros_.lower_bound(batch_size);
+  if (upper != processing_micros_.end() && upper->first == batch_size) {
+    return upper->second;
+  }
+  if (upper == processing_micros_.begin()) {
+    // Smaller than all processed batches; batches don't get cheaper.
+    return upper->second;
+  }
+  auto lower = std::prev(upper);
+  if (upper == processing_micros_.end()) {
+    // Larger than all processed batches. Scaling proportionally overestimates
+    // processing times that have a fixed part, which errs on the safe side.
+    return lower->second * batch_size / lower->first;
+  }
+  // Interpolate between the neighbouring processed batch sizes.
+  const double weight =
+      static_cast<double>(batch_size - lower->first) /
+      (upper->first - lower->first);
+  return lower->second + weight * (upper->second - lower->second);
+}
+
+void BatchTimeoutController::Adjust() {
+  const uint64 now_micros = options_.env->NowMicros();
+  const int64_t arrived_items =
+      interval_arrived_items_.exchange(0, std::memory_order_relaxed);
+  if (now_micros > interval_start_micros_) {
+    const double rate = static_cast<double>(arrived_items) /
+                        (now_micros - interval_start_micros_);
+    arrival_rate_ = arrival_rate_ < 0
+                        ? rate
+                        : options_.smoothing_factor * rate +
+                              (1 - options_.smoothing_factor) * arrival_rate_;
+  }
+  if (!interval_latencies_micros_.empty()) {
+    const size_t index =
+        std::min(interval_latencies_micros_.size() - 1,
+                 static_cast<size_t>(options_.latency_percentile / 100 *
+                                     interval_latencies_micros_.size()));
+    std::nth_element(interval_latencies_micros_.begin(),
+                     interval_latencies_micros_.begin() + index,
+                     interval_latencies_micros_.end());
+    const int64_t observed_latency_micros = interval_latencies_micros_[index];
+    if (observed_latency_micros > 0) {
+      const double step = std::clamp(
+          static_cast<double>(options_.latency_slo_micros) /
+              observed_latency_micros,
+          kMinBudgetStep, kMaxBudgetStep);
+      budget_factor_ =
+          std::clamp(budget_factor_ * step, kMinBudgetFactor, kMaxBudgetFactor);
+    }
+  }
+  interval_start_micros_ = now_micros;
+  interval_batches_ = 0;
+  interval_latencies_micros_.clear();
+
+  if (arrival_rate_ <= 0) {
+    return;
+  }
+  const double budget_micros = options_.latency_slo_micros * budget_factor_;
+  int picked_size = -1;
+  int smallest_sustainable_size = -1;
+  for (int size : batch_sizes_) {
+    const double processing_micros = EstimateProcessingMicros(size);
+    if (processing_micros < 0) {
+      return;
+    }
+    if (smallest_sustainable_size < 0 &&
+        arrival_rate_ * processing_micros <=
+            kMaxUtilization * size * options_.num_batch_threads) {
+      smallest_sustainable_size = size;
+    }
+    if (size / arrival_rate_ + processing_micros <= budget_micros) {
+      picked_size = size;
+    }
+  }
+  if (smallest_sustainable_size < 0) {
+    // The batch threads can't keep up with any batch size; the largest one
+    // comes closest.
+    picked_size = batch_sizes_.back();
+  } else {
+    picked_size = std::max(picked_size, smallest_sustainable_size);
+  }
+
+  const double timeout_micros =
+      budget_micros - EstimateProcessingMicros(picked_size);
+  batch_timeout_micros_.store(
+      std::clamp(static_cast<int64_t>(timeout_micros),
+                 options_.min_batch_timeout_micros,
+                 options_.max_batch_timeout_micros),
+      std::memory_order_relaxed);
+  max_batch_size_.store(picked_size, std::memory_order_relaxed);
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,162 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_CONTROLLER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_CONTROLLER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Adapts the batch timeout and the batch size of a batch queue to the load, so
+// that a percentile of the task latencies meets a latency objective (SLO).
+//
+// A static batch timeout is either too long at low load, where tasks wait for
+// batches that don't fill up, or too short at peak load, where batches could
+// grow at no latency cost. The controller instead models the latency of the
+// first task of a batch of size `b` as the time to fill the batch at the
+// observed arrival rate, plus the measured processing time of such batches:
+//
+//   latency(b) = b / arrival_rate + processing_time(b)
+//
+// Every `adjustment_interval_batches` batches, it picks the largest batch size
+// whose modeled latency fits in the latency budget, and a timeout that lets
+// batches of that size fill up, but no longer than the budget allows. Batch
+// sizes are never picked so small that the batch threads can't keep up with
+// the arrival rate.
+//
+// The latency budget starts at the SLO, and is corrected after every interval
+// by the ratio of the SLO to the observed latency percentile. This closes the
+// loop over what the model doesn't capture, e.g. the time batches wait for a
+// batch thread.
+//
+// This class is thread-safe.
+class BatchTimeoutController {
+ public:
+  struct Options {
+    // The latency objective, in microseconds. Must be positive.
+    int64_t latency_slo_micros = 0;
+
+    // The percentile of task latencies that should meet the objective.
+    double latency_percentile = 99.0;
+
+    // The bounds of the batch timeout.
+    int64_t min_batch_timeout_micros = 0;
+    int64_t max_batch_timeout_micros = 0;
+
+    // The batch timeout to use until the first adjustment.
+    int64_t initial_batch_timeout_micros = 0;
+
+    // The largest batch size to pick. Must be positive.
+    int max_batch_size = 0;
+
+    // The batch sizes to pick from, in increasing order. If empty, the powers
+    // of two below `max_batch_size` and `max_batch_size` itself are used.
+    std::vector<int32> allowed_batch_sizes;
+
+    // The number of threads that process the batches of the queue.
+    int num_batch_threads = 1;
+
+    // The number of processed batches between adjustments.
+    int64_t adjustment_interval_batches = 100;
+
+    // The weight of the latest interval in the moving averages of the arrival
+    // rate and of the processing times.
+    double smoothing_factor = 0.3;
+
+    // The environment to use (typically only overridden by test code).
+    Env* env = Env::Default();
+  };
+
+  static Status Create(const Options& options,
+                       std::unique_ptr<BatchTimeoutController>* controller);
+
+  // The current batch timeout.
+  int64_t batch_timeout_micros() const {
+    return batch_timeout_micros_.load(std::memory_order_relaxed);
+  }
+
+  // The current batch size at which batches are closed.
+  int max_batch_size() const {
+    return max_batch_size_.load(std::memory_order_relaxed);
+  }
+
+  // Records the arrival of a task of `task_size` items.
+  void RecordTaskArrival(int64_t task_size);
+
+  // Records that a batch of `batch_size` items (including padding) was
+  // processed in `processing_micros`, and the latencies of its tasks. May
+  // adjust the batch timeout and size.
+  void RecordBatchProcessed(int batch_size, int64_t processing_micros,
+                            absl::Span<const int64_t> task_latencies_micros);
+
+ private:
+  explicit BatchTimeoutController(const Options& options);
+
+  // Returns the estimated processing time of a batch of `batch_size`, or a
+  // negative value if no batch has been processed yet.
+  double EstimateProcessingMicros(int batch_size) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Recomputes the batch timeout and size from the last interval.
+  void Adjust() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const Options options_;
+
+  // The candidate batch sizes, in increasing order.
+  std::vector<int> batch_sizes_;
+
+  std::atomic<int64_t> batch_timeout_micros_;
+  std::atomic<int> max_batch_size_;
+
+  mutable mutex mu_;
+
+  // Moving averages of the processing time of batches, keyed by the smallest
+  // candidate batch size that is at least the processed batch size.
+  std::map<int, double> processing_micros_ TF_GUARDED_BY(mu_);
+
+  // Moving average of the number of arriving items per microsecond; negative
+  // until the first adjustment.
+  double arrival_rate_ TF_GUARDED_BY(mu_) = -1;
+
+  // The ratio of the latency budget to the SLO.
+  double budget_factor_ TF_GUARDED_BY(mu_) = 1.0;
+
+  // State of the current interval.
+  uint64 interval_start_micros_ TF_GUARDED_BY(mu_);
+  std::atomic<int64_t> interval_arrived_items_{0};
+  int64_t interval_batches_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<int64_t> interval_latencies_micros_ TF_GUARDED_BY(mu_);
+
+  BatchTimeoutController(const BatchTimeoutController&) = delete;
+  void operator=(const BatchTimeoutController&) = delete;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_TIMEOUT_CONTROLLER_H_
@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_timeout_controller.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+class BatchTimeoutControllerTest : public ::testing::Test {
+ protected:
+  BatchTimeoutControllerTest() : env_(Env::Default()) {
+    options_.latency_slo_micros = 10000;
+    options_.max_batch_timeout_micros = 20000;
+    options_.initial_batch_timeout_micros = 5000;
+    options_.max_batch_size = 64;
+    options_.adjustment_interval_batches = 7;
+    options_.env = &env_;
+  }
+
+  // Advances the clock by `elapsed_micros`, during which `arrived_items`
+  // arrive, and one batch of each candidate size is processed with a fixed
+  // cost of 1000us and 10us per item. All tasks take `latency_micros`.
+  void RunInterval(BatchTimeoutController* controller, int64_t elapsed_micros,
+                   int64_t arrived_items, int64_t latency_micros) {
+    env_.AdvanceByMicroseconds(elapsed_micros);
+    controller->RecordTaskArrival(arrived_items);
+    for (int size : {1, 2, 4, 8, 16, 32, 64}) {
+      controller->RecordBatchProcessed(size, 1000 + 10 * size,
+                                       {latency_micros});
+    }
+  }
+
+  test_util::FakeClockEnv env_;
+  BatchTimeoutController::Options options_;
+};
+
+TEST_F(BatchTimeoutControllerTest, InvalidOptions) {
+  std::unique_ptr<BatchTimeoutController> controller;
+  BatchTimeoutController::Options options = options_;
+  options.latency_slo_micros = 0;
+  EXPECT_THAT(BatchTimeoutController::Create(options, &controller),
+              testing::StatusIs(error::INVALID_ARGUMENT));
+
+  options = options_;
+  options.min_batch_timeout_micros = options.max_batch_timeout_micros + 1;
+  EXPECT_THAT(BatchTimeoutController::Create(options, &controller),
+              testing::StatusIs(error::INVALID_ARGUMENT));
+
+  options = options_;
+  options.allowed_batch_sizes = {8, 4};
+  EXPECT_THAT(BatchTimeoutController::Create(options, &controller),
+              testing::StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST_F(BatchTimeoutControllerTest, InitialParameters) {
+  std::unique_ptr<BatchTimeoutController> controller;
+  TF_ASSERT_OK(BatchTimeoutController::Create(options_, &controller));
+  EXPECT_EQ(controller->batch_timeout_micros(), 5000);
+  EXPECT_EQ(controller->max_batch_size(), 64);
+
+  // Without arrivals, there is nothing to adapt to.
+  RunInterval(controller.get(), 1000, 0, 2000);
+  EXPECT_EQ(controller->batch_timeout_micros(), 5000);
+  EXPECT_EQ(controller->max_batch_size(), 64);
+}
+
+TEST_F(BatchTimeoutControllerTest, LowLoad) {
+  std::unique_ptr<BatchTimeoutController> controller;
+  TF_ASSERT_OK(BatchTimeoutController::Create(options_, &controller));
+
+  // One item per millisecond. The latency is well below the SLO, so the budget
+  // grows by 10% to 11000us; a batch of 8 takes 8000us to fill and 1080us to
+  // process.
+  RunInterval(controller.get(), 100000, 100, 2000);
+  EXPECT_EQ(controller->max_batch_size(), 8);
+  EXPECT_EQ(controller->batch_timeout_micros(), 11000 - 1080);
+}
+
+TEST_F(BatchTimeoutControllerTest, HighLoad) {
+  std::unique_ptr<BatchTimeoutController> controller;
+  TF_ASSERT_OK(BatchTimeoutController::Create(options_, &controller));
+
+  // One item per 10us: the largest batch fills up in 640us.
+  RunInterval(controller.get(), 1000, 100, 2000);
+  EXPECT_EQ(controller->max_batch_size(), 64);
+  EXPECT_EQ(controller->batch_timeout_micros(), 11000 - 1640);
+}
+
+TEST_F(BatchTimeoutControllerTest, LatencyAboveSlo) {
+  std::unique_ptr<BatchTimeoutController> controller;
+  TF_ASSERT_OK(BatchTimeoutController::Create(options_, &controller));
+
+  // Twice the SLO halves the budget to 5000us.
+  RunInterval(controller.get(), 100000, 100, 20000);
+  EXPECT_EQ(controller->max_batch_size(), 2);
+  EXPECT_EQ(controller->batch_timeout_micros(), 5000 - 1020);
+
+  // Meeting the SLO keeps the budget.
+  RunInterval(controller.get(), 100000, 100, 10000);
+  EXPECT_EQ(controller->max_batch_size(), 2);
+  EXPECT_EQ(controller->batch_timeout_micros(), 5000 - 1020);
+}
+
+TEST_F(BatchTimeoutControllerTest, BatchesLargeEnoughToKeepUp) {
+  options_.latency_slo_micros = 2000;
+  options_.num_batch_threads = 4;
+  std::unique_ptr<BatchTimeoutController> controller;
+  TF_ASSERT_OK(BatchTimeoutController::Create(options_, &controller));
+
+  // Batches of 32 would meet the latency budget, but four threads only keep up
+  // with one item per 10us with batches of 64.
+  RunInterval(controller.get(), 1000, 100, 2000);
+  EXPECT_EQ(controller->max_batch_size(), 64);
+  EXPECT_EQ(controller->batch_timeout_micros(), 2000 - 1640);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,321 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace serving {
+
+// EXPERIMENTAL: API MAY BE SUBJECTED TO SUDDEN CHANGES.
+//
+// A batch scheduler for iterative workloads such as autoregressive decoding,
+// where each task (a "sequence") takes a data-dependent number of iterations.
+//
+// The other schedulers form a batch and process it to completion, so a batch
+// takes as long as its longest sequence, and the rows of finished sequences are
+// wasted until then. ContinuousBatchScheduler instead forms the batch anew
+// before every iteration: sequences that finished in the previous iteration
+// are retired, and waiting sequences are admitted in their place.
+//
+// Each active sequence occupies one of `max_num_sequences` slots, and keeps
+// its slot from admission to retirement. This lets the iteration processor
+// keep per-sequence state (e.g. KV caches or decoder states) in persistent
+// tensors of `max_num_sequences` rows, indexed by slot:
+//
+//   Tensor state(DT_FLOAT, {max_num_sequences, state_size});
+//   auto process_iteration = [&state](Iteration* iteration) {
+//     for (int i = 0; i < iteration->num_sequences(); ++i) {
+//       if (iteration->is_new(i)) { /* Initialize row iteration->slot(i). */ }
+//     }
+//     // Run one step on state.Slice(0, iteration->num_slots_in_use()).
+//     // Call iteration->Finish(i) for sequences that are done.
+//   };
+//
+// Sequences are admitted into the lowest free slot, which keeps the slots in
+// use at the front of the state tensors.
+//
+// Iterations run one at a time on a dedicated thread. The destructor blocks
+// until all scheduled sequences are finished.
+//
+// Type parameter SequenceType must be a subclass of BatchTask. Sequences
+// occupy one slot each; their size() is not interpreted.
+template <typename SequenceType>
+class ContinuousBatchScheduler : public BatchScheduler<SequenceType> {
+ public:
+  struct Options {
+    // The maximum number of sequences that are processed together, i.e. the
+    // number of slots.
+    int max_num_sequences = 32;
+
+    // The maximum number of scheduled sequences waiting for a free slot.
+    int max_enqueued_sequences = 1000;
+
+    // The name to use for the iteration thread.
+    string thread_name = {"continuous_batch_thread"};
+
+    // The environment to use (typically only overridden by test code).
+    Env* env = Env::Default();
+  };
+
+  // The active sequences of one iteration.
+  class Iteration {
+   public:
+    // The number of active sequences.
+    int num_sequences() const { return sequences_.size(); }
+
+    // One more than the largest slot in use; the active sequences are in
+    // slots [0, num_slots_in_use()).
+    int num_slots_in_use() const { return num_slots_in_use_; }
+
+    // The ith active sequence, and its slot.
+    SequenceType& sequence(int i) { return *sequences_[i].sequence; }
+    int slot(int i) const { return sequences_[i].slot; }
+
+    // Whether the ith active sequence was admitted for this iteration, i.e.
+    // the state of its slot must be (re)initialized.
+    bool is_new(int i) const { return sequences_[i].is_new; }
+
+    // Retires the ith active sequence after this iteration.
+    void Finish(int i) { sequences_[i].finished = true; }
+
+   private:
+    friend class ContinuousBatchScheduler;
+
+    struct ActiveSequence {
+      SequenceType* sequence;
+      int slot;
+      bool is_new;
+      bool finished;
+    };
+
+    std::vector<ActiveSequence> sequences_;
+    int num_slots_in_use_ = 0;
+  };
+
+  // Runs one iteration for all active sequences.
+  using IterationProcessor = std::function<void(Iteration* iteration)>;
+
+  // Receives sequences once they are retired.
+  using SequenceDoneCallback =
+      std::function<void(std::unique_ptr<SequenceType> sequence)>;
+
+  static Status Create(const Options& options,
+                       IterationProcessor process_iteration_callback,
+                       SequenceDoneCallback sequence_done_callback,
+                       std::unique_ptr<ContinuousBatchScheduler>* scheduler);
+
+  ~ContinuousBatchScheduler() override;
+
+  Status Schedule(std::unique_ptr<SequenceType>* sequence) override;
+
+  // Returns the number of sequences waiting for a slot.
+  size_t NumEnqueuedTasks() const override;
+
+  size_t SchedulingCapacity() const override;
+
+  size_t max_task_size() const override { return 1; }
+
+ private:
+  ContinuousBatchScheduler(const Options& options,
+                           IterationProcessor process_iteration_callback,
+                           SequenceDoneCallback sequence_done_callback);
+
+  // Runs iterations until the scheduler is destroyed and all sequences are
+  // finished.
+  void ProcessIterations();
+
+  // Moves waiting sequences into free slots. Returns false if there are no
+  // sequences left after the scheduler started shutting down.
+  bool AdmitSequences();
+
+  const Options options_;
+  const IterationProcessor process_iteration_callback_;
+  const SequenceDoneCallback sequence_done_callback_;
+
+  mutable mutex mu_;
+  condition_variable waiting_sequences_cv_;
+
+  // Sequences waiting for a free slot, in scheduling order.
+  std::deque<std::unique_ptr<SequenceType>> waiting_sequences_
+      TF_GUARDED_BY(mu_);
+
+  // Set by the destructor.
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+
+  // The slots, indexed by slot number; null for free slots. Only accessed by
+  // the iteration thread.
+  std::vector<std::unique_ptr<SequenceType>> slots_;
+  int num_active_sequences_ = 0;
+
+  // Slots admitted since the last iteration. Only accessed by the iteration
+  // thread.
+  std::vector<bool> newly_admitted_;
+
+  std::unique_ptr<Thread> iteration_thread_;
+
+  ContinuousBatchScheduler(const ContinuousBatchScheduler&) = delete;
+  void operator=(const ContinuousBatchScheduler&) = delete;
+};
+
+//////////
+// Implementation details follow. API users need not read.
+
+template <typename SequenceType>
+Status ContinuousBatchScheduler<SequenceType>::Create(
+    const Options& options, IterationProcessor process_iteration_callback,
+    SequenceDoneCallback sequence_done_callback,
+    std::unique_ptr<ContinuousBatchScheduler>* scheduler) {
+  if (options.max_num_sequences <= 0) {
+    return errors::InvalidArgument("max_num_sequences must be positive; was ",
+                                   options.max_num_sequences);
+  }
+  if (options.max_enqueued_sequences < 0) {
+    return errors::InvalidArgument(
+        "max_enqueued_sequences must be non-negative; was ",
+        options.max_enqueued_sequences);
+  }
+  if (options.env == nullptr) {
+    return errors::InvalidArgument("env must not be null");
+  }
+  if (process_iteration_callback == nullptr) {
+    return errors::InvalidArgument("process_iteration_callback must be set");
+  }
+  scheduler->reset(new ContinuousBatchScheduler<SequenceType>(
+      options, std::move(process_iteration_callback),
+      std::move(sequence_done_callback)));
+  return OkStatus();
+}
+
+template <typename SequenceType>
+ContinuousBatchScheduler<SequenceType>::ContinuousBatchScheduler(
+    const Options& options, IterationProcessor process_iteration_callback,
+    SequenceDoneCallback sequence_done_callback)
+    : options_(options),
+      process_iteration_callback_(std::move(process_iteration_callback)),
+      sequence_done_callback_(std::move(sequence_done_callback)),
+      slots_(options.max_num_sequences),
+      newly_admitted_(options.max_num_sequences, false) {
+  iteration_thread_.reset(options_.env->StartThread(
+      {}, options_.thread_name, [this] { ProcessIterations(); }));
+}
+
+template <typename SequenceType>
+ContinuousBatchScheduler<SequenceType>::~ContinuousBatchScheduler() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+  }
+  waiting_sequences_cv_.notify_all();
+  // Joins the iteration thread.
+  iteration_thread_.reset();
+}
+
+template <typename SequenceType>
+Status ContinuousBatchScheduler<SequenceType>::Schedule(
+    std::unique_ptr<SequenceType>* sequence) {
+  {
+    mutex_lock l(mu_);
+    if (waiting_sequences_.size() >=
+        static_cast<size_t>(options_.max_enqueued_sequences)) {
+      return errors::Unavailable(
+          "The continuous batch scheduling queue is full");
+    }
+    waiting_sequences_.push_back(std::move(*sequence));
+  }
+  waiting_sequences_cv_.notify_one();
+  return OkStatus();
+}
+
+template <typename SequenceType>
+size_t ContinuousBatchScheduler<SequenceType>::NumEnqueuedTasks() const {
+  mutex_lock l(mu_);
+  return waiting_sequences_.size();
+}
+
+template <typename SequenceType>
+size_t ContinuousBatchScheduler<SequenceType>::SchedulingCapacity() const {
+  mutex_lock l(mu_);
+  return options_.max_enqueued_sequences - waiting_sequences_.size();
+}
+
+template <typename SequenceType>
+bool ContinuousBatchScheduler<SequenceType>::AdmitSequences() {
+  mutex_lock l(mu_);
+  // Without active sequences there is nothing to iterate on; wait for new
+  // ones.
+  while (num_active_sequences_ == 0 && waiting_sequences_.empty() &&
+         !stopping_) {
+    waiting_sequences_cv_.wait(l);
+  }
+  for (int slot = 0; slot < options_.max_num_sequences &&
+                      !waiting_sequences_.empty();
+       ++slot) {
+    if (slots_[slot] == nullptr) {
+      slots_[slot] = std::move(waiting_sequences_.front());
+      waiting_sequences_.pop_front();
+      newly_admitted_[slot] = true;
+      ++num_active_sequences_;
+    }
+  }
+  return num_active_sequences_ > 0;
+}
+
+template <typename SequenceType>
+void ContinuousBatchScheduler<SequenceType>::ProcessIterations() {
+  while (AdmitSequences()) {
+    Iteration iteration;
+    iteration.sequences_.reserve(num_active_sequences_);
+    for (int slot = 0; slot < options_.max_num_sequences; ++slot) {
+      if (slots_[slot] != nullptr) {
+        iteration.sequences_.push_back(
+            {slots_[slot].get(), slot, newly_admitted_[slot], false});
+        newly_admitted_[slot] = false;
+        iteration.num_slots_in_use_ = slot + 1;
+      }
+    }
+
+    process_iteration_callback_(&iteration);
+
+    for (const auto& active_sequence : iteration.sequences_) {
+      if (!active_sequence.finished) continue;
+      std::unique_ptr<SequenceType> sequence =
+          std::move(slots_[active_sequence.slot]);
+      --num_active_sequences_;
+      if (sequence_done_callback_ != nullptr) {
+        sequence_done_callback_(std::move(sequence));
+      }
+    }
+  }
+}
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTINUOUS_BATCH_SCHEDULER_H_
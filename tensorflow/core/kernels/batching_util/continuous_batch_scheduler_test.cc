@@ -0,0 +1,162 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/continuous_batch_scheduler.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// A sequence that finishes after `num_iterations` iterations.
+class FakeSequence : public BatchTask {
+ public:
+  FakeSequence(int id, int num_iterations)
+      : id_(id), remaining_iterations_(num_iterations) {}
+
+  size_t size() const override { return 1; }
+
+  int id() const { return id_; }
+
+  // Runs one iteration; returns true if the sequence is done.
+  bool Step() { return --remaining_iterations_ <= 0; }
+
+ private:
+  const int id_;
+  int remaining_iterations_;
+};
+
+using Scheduler = ContinuousBatchScheduler<FakeSequence>;
+
+Status ScheduleSequence(int id, int num_iterations, Scheduler* scheduler) {
+  auto sequence = std::make_unique<FakeSequence>(id, num_iterations);
+  Status status = scheduler->Schedule(&sequence);
+  // Schedule() should have consumed 'sequence' iff it returned Status::OK.
+  CHECK_EQ(status.ok(), sequence == nullptr);
+  return status;
+}
+
+TEST(ContinuousBatchSchedulerTest, BadOptions) {
+  std::unique_ptr<Scheduler> scheduler;
+  auto process_iteration = [](Scheduler::Iteration* iteration) {};
+  Scheduler::Options options;
+  options.max_num_sequences = 0;
+  EXPECT_FALSE(
+      Scheduler::Create(options, process_iteration, nullptr, &scheduler).ok());
+  options = Scheduler::Options();
+  options.max_enqueued_sequences = -1;
+  EXPECT_FALSE(
+      Scheduler::Create(options, process_iteration, nullptr, &scheduler).ok());
+  EXPECT_FALSE(
+      Scheduler::Create(Scheduler::Options(), nullptr, nullptr, &scheduler)
+          .ok());
+}
+
+TEST(ContinuousBatchSchedulerTest, AdmitsAndRetiresBetweenIterations) {
+  mutex mu;
+  // The slot of each sequence, and the number of iterations it took part in.
+  std::map<int, int> slots;
+  std::map<int, int> iterations;
+  std::vector<int> done_ids;
+  int max_active_sequences = 0;
+  bool stable_slots = true;
+  auto process_iteration = [&](Scheduler::Iteration* iteration) {
+    mutex_lock l(mu);
+    max_active_sequences =
+        std::max(max_active_sequences, iteration->num_sequences());
+    for (int i = 0; i < iteration->num_sequences(); ++i) {
+      const int id = iteration->sequence(i).id();
+      if (iteration->is_new(i)) {
+        slots[id] = iteration->slot(i);
+      } else if (slots[id] != iteration->slot(i)) {
+        stable_slots = false;
+      }
+      ++iterations[id];
+      // Sequence 1 runs until sequence 2 is done.
+      const bool done = id == 1 ? iterations[2] == 3
+                                : iteration->sequence(i).Step();
+      if (done) {
+        iteration->Finish(i);
+      }
+    }
+  };
+  auto sequence_done = [&](std::unique_ptr<FakeSequence> sequence) {
+    mutex_lock l(mu);
+    done_ids.push_back(sequence->id());
+  };
+  {
+    Scheduler::Options options;
+    options.max_num_sequences = 2;
+    std::unique_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(options, process_iteration, sequence_done,
+                                   &scheduler));
+    // Sequence 2 waits for sequence 0 to finish, and takes its slot while
+    // sequence 1 is still running.
+    TF_ASSERT_OK(ScheduleSequence(0, 1, scheduler.get()));
+    TF_ASSERT_OK(ScheduleSequence(1, 0, scheduler.get()));
+    TF_ASSERT_OK(ScheduleSequence(2, 3, scheduler.get()));
+    // Destroying the scheduler waits for all sequences to finish.
+  }
+  EXPECT_EQ(max_active_sequences, 2);
+  EXPECT_TRUE(stable_slots);
+  EXPECT_EQ(iterations[0], 1);
+  EXPECT_EQ(iterations[2], 3);
+  EXPECT_GE(iterations[1], 3);
+  ASSERT_EQ(done_ids.size(), 3);
+  EXPECT_EQ(done_ids.back(), 1);
+  EXPECT_NE(slots[1], slots[2]);
+}
+
+TEST(ContinuousBatchSchedulerTest, QueueCapacity) {
+  Notification proceed;
+  auto process_iteration = [&proceed](Scheduler::Iteration* iteration) {
+    proceed.WaitForNotification();
+    for (int i = 0; i < iteration->num_sequences(); ++i) {
+      iteration->Finish(i);
+    }
+  };
+  Scheduler::Options options;
+  options.max_num_sequences = 1;
+  options.max_enqueued_sequences = 2;
+  std::unique_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(
+      Scheduler::Create(options, process_iteration, nullptr, &scheduler));
+  TF_ASSERT_OK(ScheduleSequence(0, 1, scheduler.get()));
+  // Wait for the first sequence to take the only slot.
+  while (scheduler->NumEnqueuedTasks() > 0) {
+    Env::Default()->SleepForMicroseconds(100);
+  }
+  EXPECT_EQ(scheduler->SchedulingCapacity(), 2);
+  TF_ASSERT_OK(ScheduleSequence(1, 1, scheduler.get()));
+  TF_ASSERT_OK(ScheduleSequence(2, 1, scheduler.get()));
+  EXPECT_EQ(scheduler->NumEnqueuedTasks(), 2);
+  EXPECT_EQ(scheduler->SchedulingCapacity(), 0);
+  EXPECT_TRUE(
+      errors::IsUnavailable(ScheduleSequence(3, 1, scheduler.get())));
+  proceed.Notify();
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
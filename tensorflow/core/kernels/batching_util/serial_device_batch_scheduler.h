@@ -18,10 +18,14 @@ limitations under the License.
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <random>
+#include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/serving_device_selector.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -61,7 +65,11 @@ class SDBSQueue;
 // processing thread becomes available. SDBS prioritizes batches primarily by
 // age (i.e. the batch's oldest request) along with a configurable preference
 // for scheduling larger batches first.
-
+//
+// SDBS can also coordinate batches of many models sharing the devices: batches
+// of all queues are processed concurrently up to the in-flight limit, as long
+// as their estimated memory fits in a device memory budget, and each batch can
+// be routed to one of several devices by a ServingDeviceSelector.
 
 template <typename TaskType>
 class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
@@ -95,6 +103,16 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     // in_flight_batches_limit.  Larger numbers will reduce noise, but will be
     // less responsive to sudden changes in workload.
     int64_t batches_to_average_over = 1000;
+    // If positive, batches are only released for processing while the sum of
+    // the estimated memory of the batches being processed stays within this
+    // budget (see QueueOptions::batch_memory_bytes). A batch is always
+    // released if no other batch is being processed. When batches are routed
+    // to several devices, this is the budget of all of them together.
+    int64_t device_memory_budget_bytes = 0;
+    // If set, each batch reserves a device from this selector for the duration
+    // of its processing, and the device is passed to the DeviceBatchProcessor.
+    // Not owned; must outlive the scheduler.
+    ServingDeviceSelector* device_selector = nullptr;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -108,14 +126,27 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     int max_batch_size = 1000;
     // Maximum number of enqueued (i.e. non-scheduled) batches.
     int max_enqueued_batches = 10;
+    // Returns the estimated device memory needed to process a batch of the
+    // given size. Only used if Options::device_memory_budget_bytes is set.
+    std::function<int64_t(int64_t batch_size)> batch_memory_bytes;
+    // Identifies the model of this queue to Options::device_selector.
+    string program_fingerprint;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
 
+  // Same as BatchProcessor, but also receives the index of the device reserved
+  // for the batch, or -1 if Options::device_selector isn't set.
+  using DeviceBatchProcessor =
+      std::function<void(std::unique_ptr<Batch<TaskType>>, int device_index)>;
+
   // Adds queue (and its callback) to be managed by this scheduler.
   Status AddQueue(const QueueOptions& options,
                   BatchProcessor process_batch_callback,
                   std::unique_ptr<BatchScheduler<TaskType>>* queue);
+  Status AddQueue(const QueueOptions& options,
+                  DeviceBatchProcessor process_batch_callback,
+                  std::unique_ptr<BatchScheduler<TaskType>>* queue);
 
   double in_flight_batches_limit() {
     mutex_lock l(mu_);
@@ -127,6 +158,11 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     return recent_low_traffic_ratio_;
   }
 
+  int64_t in_flight_memory_bytes() {
+    mutex_lock l(mu_);
+    return in_flight_memory_bytes_;
+  }
+
  private:
   // access to AddBatch(), RemoveQueue(), env().
   friend class internal::SDBSQueue<TaskType>;
@@ -144,6 +180,9 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
 
   Env* env() const { return options_.env; }
 
+  // Returns the estimated memory needed to process `batch`.
+  int64_t BatchMemoryBytes(const internal::SDBSBatch<TaskType>& batch) const;
+
   const Options options_;
 
   // Collection of batches added by AddBatch. Owned by scheduler until they are
@@ -151,7 +190,8 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   std::vector<const internal::SDBSBatch<TaskType>*> batches_ TF_GUARDED_BY(mu_);
 
   // Unowned queues and callbacks added by AddQueue.
-  std::unordered_map<const internal::SDBSQueue<TaskType>*, BatchProcessor>
+  std::unordered_map<const internal::SDBSQueue<TaskType>*,
+                     DeviceBatchProcessor>
       queues_and_callbacks_ TF_GUARDED_BY(mu_);
 
   // Responsible for running the batch processing callbacks.
@@ -186,6 +226,9 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   // useful feedback for an adjustment.
   double recent_low_traffic_ratio_ = 0;
 
+  // Sum of the estimated memory of the batches being processed.
+  int64_t in_flight_memory_bytes_ TF_GUARDED_BY(mu_) = 0;
+
   mutex mu_;
 
   SerialDeviceBatchScheduler(const SerialDeviceBatchScheduler&) = delete;
@@ -226,6 +269,8 @@ class SDBSQueue : public BatchScheduler<TaskType> {
 
   size_t max_task_size() const override { return options_.max_batch_size; }
 
+  const QueueOptions& options() const { return options_; }
+
  private:
   std::shared_ptr<SerialDeviceBatchScheduler<TaskType>> scheduler_;
   const QueueOptions options_;
@@ -302,6 +347,11 @@ Status SerialDeviceBatchScheduler<TaskType>::Create(
         "get_pending_on_serial_device must be "
         "specified");
   }
+  if (options.device_memory_budget_bytes < 0) {
+    return errors::InvalidArgument(
+        "device_memory_budget_bytes can't be negative; was ",
+        options.device_memory_budget_bytes);
+  }
   scheduler->reset(new SerialDeviceBatchScheduler<TaskType>(options));
   return OkStatus();
 }
@@ -335,6 +385,19 @@ template <typename TaskType>
 Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
     const QueueOptions& options, BatchProcessor process_batch_callback,
     std::unique_ptr<BatchScheduler<TaskType>>* queue) {
+  return AddQueue(
+      options,
+      [process_batch_callback](std::unique_ptr<Batch<TaskType>> batch,
+                               int device_index) {
+        process_batch_callback(std::move(batch));
+      },
+      queue);
+}
+
+template <typename TaskType>
+Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
+    const QueueOptions& options, DeviceBatchProcessor process_batch_callback,
+    std::unique_ptr<BatchScheduler<TaskType>>* queue) {
   if (options.max_batch_size <= 0) {
     return errors::InvalidArgument("max_batch_size must be positive; was ",
                                    options.max_batch_size);
@@ -344,6 +407,11 @@ Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options_.device_memory_budget_bytes > 0 && !options.batch_memory_bytes) {
+    return errors::InvalidArgument(
+        "batch_memory_bytes must be specified when the scheduler has a "
+        "device_memory_budget_bytes");
+  }
   internal::SDBSQueue<TaskType>* SDBS_queue_raw;
   queue->reset(SDBS_queue_raw = new internal::SDBSQueue<TaskType>(
                    this->shared_from_this(), options));
@@ -366,6 +434,13 @@ void SerialDeviceBatchScheduler<TaskType>::RemoveQueue(
   queues_and_callbacks_.erase(queue);
 }
 
+template <typename TaskType>
+int64_t SerialDeviceBatchScheduler<TaskType>::BatchMemoryBytes(
+    const internal::SDBSBatch<TaskType>& batch) const {
+  if (options_.device_memory_budget_bytes <= 0) return 0;
+  return batch.queue()->options().batch_memory_bytes(batch.size());
+}
+
 template <typename TaskType>
 void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
   const int64_t kIdleThreadSleepTimeMicros = 1000;
@@ -387,32 +462,61 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
       env()->SleepForMicroseconds(sleep_time);
       continue;
     }
-    auto best_it = batches_.begin();
-    double best_score =
-        (*best_it)->creation_time_micros() -
-        options_.full_batch_scheduling_boost_micros * (*best_it)->size() /
-            static_cast<double>((*best_it)->queue()->max_task_size());
-    for (auto it = batches_.begin() + 1; it != batches_.end(); it++) {
+    // Only consider batches that fit in the remaining memory budget.
+    auto best_it = batches_.end();
+    double best_score = 0;
+    for (auto it = batches_.begin(); it != batches_.end(); it++) {
+      if (options_.device_memory_budget_bytes > 0 &&
+          in_flight_memory_bytes_ > 0 &&
+          in_flight_memory_bytes_ + BatchMemoryBytes(**it) >
+              options_.device_memory_budget_bytes) {
+        continue;
+      }
       const double score =
           (*it)->creation_time_micros() -
           options_.full_batch_scheduling_boost_micros * (*it)->size() /
               static_cast<double>((*it)->queue()->max_task_size());
-      if (score < best_score) {
+      if (best_it == batches_.end() || score < best_score) {
         best_score = score;
         best_it = it;
       }
     }
+    if (best_it == batches_.end()) {
+      // Wait for in-flight batches to free up memory.
+      mu_.unlock();
+      env()->SleepForMicroseconds(kIdleThreadSleepTimeMicros);
+      continue;
+    }
     const internal::SDBSBatch<TaskType>* batch = *best_it;
     batches_.erase(best_it);
-    // Queue may destroy itself after ReleaseBatch is called.
+    // Queue may destroy itself after ReleaseBatch is called, so read its
+    // options first. The batch may grow until ReleaseBatch closes it.
+    const QueueOptions& queue_options = batch->queue()->options();
+    const string program_fingerprint = queue_options.program_fingerprint;
+    const auto batch_memory_bytes = queue_options.batch_memory_bytes;
     batch->queue()->ReleaseBatch(batch);
+    const int64_t memory_bytes = options_.device_memory_budget_bytes > 0
+                                     ? batch_memory_bytes(batch->size())
+                                     : 0;
+    in_flight_memory_bytes_ += memory_bytes;
     auto callback = queues_and_callbacks_[batch->queue()];
     mu_.unlock();
     int64_t start_time = env()->NowMicros();
-    callback(std::unique_ptr<Batch<TaskType>>(
-        const_cast<internal::SDBSBatch<TaskType>*>(batch)));
+    {
+      int device_index = -1;
+      std::optional<DeviceReservation> reservation;
+      if (options_.device_selector != nullptr) {
+        reservation.emplace(
+            options_.device_selector->ReserveDevice(program_fingerprint));
+        device_index = reservation->device_index();
+      }
+      callback(std::unique_ptr<Batch<TaskType>>(
+                   const_cast<internal::SDBSBatch<TaskType>*>(batch)),
+               device_index);
+    }
     int64_t end_time = env()->NowMicros();
     mu_.lock();
+    in_flight_memory_bytes_ -= memory_bytes;
     batch_count_++;
     batch_latency_sum_ += end_time - start_time;
     pending_sum_ += options_.get_pending_on_serial_device();
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/serial_device_batch_scheduler.h"
 
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/common_runtime/serving_device_selector.h"
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -88,6 +93,18 @@ TEST(SerialDeviceBatchSchedulerTest, BadOptions) {
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
   options = Scheduler::Options();
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = default_options;
+  options.device_memory_budget_bytes = -1;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = default_options;
+  options.device_memory_budget_bytes = 1000;
+  TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  // Queues must estimate their batches' memory if there is a budget.
+  EXPECT_FALSE(
+      scheduler
+          ->AddQueue({}, [](std::unique_ptr<Batch<FakeTask>> batch) {}, &queue)
+          .ok());
 }
 
 TEST(SerialDeviceBatchSchedulerTest, InFlightBatchesLimit) {
@@ -390,6 +407,120 @@ TEST(SerialDeviceBatchSchedulerTest, QueueCapacityInfo) {
   EXPECT_EQ(queue2->SchedulingCapacity(), 8 * 1000 + 300);
   finish_processing.Notify();
 }
+
+TEST(SerialDeviceBatchSchedulerTest, DeviceMemoryBudget) {
+  SerialDeviceBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 3;
+  options.initial_in_flight_batches_limit = 3;
+  options.batches_to_average_over = 1000;
+  options.get_pending_on_serial_device = []() { return 0; };
+  options.device_memory_budget_bytes = 100;
+  mutex mu;
+  int processed_batches = 0;
+  Notification finish_processing;
+  auto queue_callback = [&mu, &processed_batches, &finish_processing](
+                            std::unique_ptr<Batch<FakeTask>> batch) {
+    mu.lock();
+    int batch_num = ++processed_batches;
+    mu.unlock();
+    if (batch_num == 2) {
+      // Give third batch a chance to process if it's going to.
+      Env::Default()->SleepForMicroseconds(1000);
+      finish_processing.Notify();
+    }
+    if (batch_num == 3) {
+      ASSERT_TRUE(finish_processing.HasBeenNotified());
+    }
+    finish_processing.WaitForNotification();
+  };
+  std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(
+      SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SerialDeviceBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.batch_memory_bytes = [](int64_t batch_size) {
+    return batch_size;
+  };
+  std::unique_ptr<BatchScheduler<FakeTask>> queue1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue2;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue3;
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue1));
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue2));
+  TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue3));
+  // Any two of the batches fit in the budget, but not all three.
+  TF_ASSERT_OK(ScheduleTask(60, queue1.get()));
+  TF_ASSERT_OK(ScheduleTask(30, queue2.get()));
+  TF_ASSERT_OK(ScheduleTask(30, queue3.get()));
+}
+
+// Hands out the devices round-robin, and records the fingerprints.
+class FakeDeviceSelector : public ServingDeviceSelector {
+ public:
+  explicit FakeDeviceSelector(int num_devices) : num_devices_(num_devices) {}
+
+  DeviceReservation ReserveDevice(
+      absl::string_view program_fingerprint) override {
+    mutex_lock l(mu_);
+    fingerprints_.emplace_back(program_fingerprint);
+    ++num_reserved_;
+    return DeviceReservation(next_device_++ % num_devices_, this);
+  }
+
+  std::vector<string> fingerprints() {
+    mutex_lock l(mu_);
+    return fingerprints_;
+  }
+
+  int num_reserved() {
+    mutex_lock l(mu_);
+    return num_reserved_;
+  }
+
+ private:
+  void FreeDeviceReservation(const DeviceReservation& reservation) override {
+    mutex_lock l(mu_);
+    --num_reserved_;
+  }
+
+  const int num_devices_;
+  mutex mu_;
+  int next_device_ TF_GUARDED_BY(mu_) = 0;
+  int num_reserved_ TF_GUARDED_BY(mu_) = 0;
+  std::vector<string> fingerprints_ TF_GUARDED_BY(mu_);
+};
+
+TEST(SerialDeviceBatchSchedulerTest, DeviceSelector) {
+  FakeDeviceSelector device_selector(2);
+  SerialDeviceBatchScheduler<FakeTask>::Options options;
+  options.initial_in_flight_batches_limit = 1;
+  options.get_pending_on_serial_device = []() { return 0; };
+  options.device_selector = &device_selector;
+  mutex mu;
+  std::vector<int> device_indices;
+  auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                            int device_index) {
+    EXPECT_EQ(device_selector.num_reserved(), 1);
+    mutex_lock l(mu);
+    device_indices.push_back(device_index);
+  };
+  {
+    std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SerialDeviceBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.program_fingerprint = "model";
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, queue_callback, &queue));
+    // Three full batches.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+  }
+  EXPECT_EQ(device_indices, std::vector<int>({0, 1, 0}));
+  EXPECT_EQ(device_selector.fingerprints(),
+            std::vector<string>({"model", "model", "model"}));
+  EXPECT_EQ(device_selector.num_reserved(), 0);
+}
 }  // namespace anonymous
 }  // namespace serving
 }  // namespace tensorflow
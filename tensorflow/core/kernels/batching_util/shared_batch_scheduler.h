@@ -18,8 +18,11 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <memory>
 #include <utility>
@@ -80,6 +83,15 @@ namespace serving {
 // from a queue and then moving to the next queue. Each queue behaves like a
 // BasicBatchScheduler instance, in the sense that it has maximum batch size and
 // timeout parameters, which govern when a batch is eligible to be processed.
+// With `Options::enable_earliest_deadline_first`, the batch threads instead
+// take the most urgent schedulable batch of all queues: high priority batches
+// first, and then the batch with the earliest task deadline.
+//
+// Within a queue with `QueueOptions::enable_priority_queue`, sheddable tasks
+// are batched apart from the others, and their batches are only processed
+// when the queue has no other schedulable batch. Tasks whose deadline has
+// passed are rejected by Schedule(), and, if the queue has an
+// `expired_task_callback`, removed from their batch before it is processed.
 //
 // Each queue is independently configured with a maximum size (in terms of the
 // maximum number of batches worth of enqueued tasks). For online serving, it is
@@ -125,6 +137,14 @@ class SharedBatchScheduler
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
+
+    // If true, the batch threads take the next batch from the queue whose
+    // schedulable batch is the most urgent, instead of round-robin through the
+    // queues: batches of high priority tasks go before batches of low priority
+    // ones, and then the batch with the earliest task deadline (see
+    // `BatchTask::deadline_micros()`) goes first. Queues whose batches are
+    // equally urgent are still taken in round-robin order.
+    bool enable_earliest_deadline_first = false;
   };
   // Ownership is shared between the caller of Create() and any queues created
   // via AddQueue().
@@ -221,7 +241,13 @@ class SharedBatchScheduler
     bool disable_padding = false;
 
     // If true, queue implementation would split high priority and low priority
-    // inputs into two sub queues.
+    // inputs into two sub queues. Tasks whose criticality is sheddable are low
+    // priority. A batch of low priority tasks is only scheduled when the queue
+    // has no schedulable batch of high priority tasks, so that high priority
+    // tasks are not held up by the formation of low priority batches.
+    //
+    // Must be false if `enable_lazy_split` is true; elsewise errors will be
+    // returned at queue creation time.
     bool enable_priority_queue = false;
 
     // A separate set of queue options for different priority inputs.
@@ -240,6 +266,26 @@ class SharedBatchScheduler
     PriorityQueueOptions high_priority_queue_options;
     // A subset of queue options for low priority input.
     PriorityQueueOptions low_priority_queue_options;
+
+    // If set, the tasks whose deadline (see `BatchTask::deadline_micros()`)
+    // has passed by the time their batch is processed are handed to this
+    // callback, e.g. to fail them, instead of being processed. A batch whose
+    // tasks have all expired is not processed at all.
+    //
+    // Tasks whose deadline has already passed when they are submitted are
+    // always rejected, with a DEADLINE_EXCEEDED error.
+    std::function<void(std::unique_ptr<TaskType> task)> expired_task_callback;
+
+    // If set, these return the batch timeout, and the batch size at which the
+    // open batch becomes schedulable, to use instead of `batch_timeout_micros`
+    // and `max_execution_batch_size`, e.g. to adapt them to the load. The
+    // returned batch size is capped at `max_execution_batch_size`.
+    //
+    // They're called with the queue lock held whenever the queue checks if its
+    // open batch is schedulable, so they must be cheap. With
+    // `enable_priority_queue`, they only apply to high priority batches.
+    std::function<int64_t()> batch_timeout_micros_func;
+    std::function<size_t()> schedulable_batch_size_func;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -253,6 +299,13 @@ class SharedBatchScheduler
                               BatchUniquePtr* batch_to_process_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // A variant of `GetNextWorkItem_Locked` used with
+  // `Options::enable_earliest_deadline_first`, which takes the batch from the
+  // queue with the most urgent schedulable batch.
+  void GetMostUrgentWorkItem_Locked(
+      internal::Queue<TaskType>** queue_for_batch_out,
+      BatchUniquePtr* batch_to_process_out) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
   // queue declines to provide a batch to process, moves onto the next queue. If
@@ -320,12 +373,17 @@ namespace internal {
 // closed. If the front-most batch is open (i.e. the queue contains only one
 // batch) and has reached the timeout, it is immediately closed and returned;
 // otherwise no batch is returned for the request.
+//
+// With `enable_priority_queue`, low priority tasks go to a second deque of
+// batches with the same invariants, which is only pulled from when the deque
+// of high priority batches yields no batch.
 template <typename TaskType>
 class Queue {
  public:
   using ProcessBatchCallback =
       std::function<void(std::unique_ptr<Batch<TaskType>>)>;
-  using SchedulableBatchCallback = std::function<void()>;
+  // Receives the number of batches that have become schedulable.
+  using SchedulableBatchCallback = std::function<void(int num_batches)>;
   using SplitInputTaskIntoSubtasksCallback = std::function<Status(
       std::unique_ptr<TaskType>* input_task, int open_batch_remaining_slot,
       int max_execution_batch_size,
@@ -377,7 +435,13 @@ class Queue {
   // Batches are guaranteed to form at task enqueue time.
   std::unique_ptr<Batch<TaskType>> ScheduleBatchWithEagerSplit();
 
-  // Processes a batch that has been returned earlier by ScheduleBatch().
+  // Returns whether ScheduleBatch() would return a batch now. If so, sets
+  // `*low_priority` to whether it would be a batch of low priority tasks and
+  // `*deadline_micros` to the earliest deadline of its tasks.
+  bool PeekSchedulableBatch(bool* low_priority, uint64* deadline_micros) const;
+
+  // Processes a batch that has been returned earlier by ScheduleBatch(),
+  // without its expired tasks if `expired_task_callback` is set.
   void ProcessBatch(std::unique_ptr<Batch<TaskType>> batch);
 
   // Determines whether the queue is empty, i.e. has no tasks waiting or being
@@ -406,51 +470,111 @@ class Queue {
     }
   }
 
+  // The limits of the batches of a deque of batches.
+  struct BatchLimits {
+    size_t input_batch_size_limit;
+    size_t max_execution_batch_size;
+    int64_t batch_timeout_micros;
+    size_t max_enqueued_batches;
+  };
+
+  // Computes the limits of the high or low priority batches based on queue
+  // options. Without `enable_priority_queue`, all batches are high priority
+  // and are limited by the queue options themselves.
+  static BatchLimits GetBatchLimits(
+      const typename SharedBatchScheduler<TaskType>::QueueOptions& options,
+      bool low_priority) {
+    if (!options.enable_priority_queue) {
+      return {options.input_batch_size_limit,
+              GetMaxExecutionBatchSize(options), options.batch_timeout_micros,
+              options.max_enqueued_batches};
+    }
+    const auto& priority_options = low_priority
+                                       ? options.low_priority_queue_options
+                                       : options.high_priority_queue_options;
+    return {priority_options.input_batch_size_limit,
+            options.enable_large_batch_splitting
+                ? priority_options.max_execution_batch_size
+                : priority_options.input_batch_size_limit,
+            priority_options.batch_timeout_micros,
+            priority_options.max_enqueued_batches};
+  }
+
+  // Returns whether `task` goes to the low priority batches.
+  bool IsLowPriorityTask(const TaskType& task) const {
+    return options_.enable_priority_queue &&
+           task.criticality() !=
+               tsl::criticality::Criticality::kCriticalPlus &&
+           task.criticality() != tsl::criticality::Criticality::kCritical;
+  }
+
+  const BatchLimits& GetBatchLimits(bool low_priority) const {
+    return low_priority ? low_priority_limits_ : high_priority_limits_;
+  }
+
+  // Returns the batch timeout and the batch size at which the open batch
+  // becomes schedulable, which `batch_timeout_micros_func` and
+  // `schedulable_batch_size_func` may override.
+  void GetOpenBatchSchedulingParams(bool low_priority,
+                                    int64_t* batch_timeout_micros,
+                                    size_t* schedulable_batch_size) const;
+
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Closes the open batch residing at the back of std::deque, and inserts a
   // fresh open batch behind it.
-  void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void StartNewBatch(bool low_priority) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   Status SplitInputBatchIntoSubtasks(
-      std::unique_ptr<TaskType>* input_task,
+      std::unique_ptr<TaskType>* input_task, bool low_priority,
       std::vector<std::unique_ptr<TaskType>>* output_tasks)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Determines whether the open batch residing at the back of
-  // 'high_priority_batches_' is currently schedulable.
-  bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // 'high_priority_batches_' (or 'low_priority_batches_') is currently
+  // schedulable.
+  bool IsOpenBatchSchedulable(bool low_priority) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // A variant of `IsOpenBatchSchedulable`; used when batches are formed at
-  // task enqueue time, and open batch is `high_priority_batches_.back()`.
-  bool IsOpenBatchSchedulableAfterEagerSplit() const
+  // task enqueue time, and open batch is `GetBatches(low_priority).back()`.
+  bool IsOpenBatchSchedulableAfterEagerSplit(bool low_priority) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Same as SchedulingCapacity(), but assumes the caller already holds a
   // lock on 'mu_'.
-  size_t SchedulingCapacityInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  size_t SchedulingCapacityInternal(bool low_priority) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Returns an error if queue doesn't have capacity for this task.
   //
   // `task` must outlive this method.
-  Status ValidateBatchTaskQueueCapacity(TaskType* task) const
+  Status ValidateBatchTaskQueueCapacity(TaskType* task,
+                                        bool low_priority) const
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // The task size of the last batch in the queue.
-  size_t tail_batch_task_size() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  size_t tail_batch_task_size(bool low_priority) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Returns the number of enqueued batches.
-  int64 num_enqueued_batches() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  int64 num_enqueued_batches(bool low_priority) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Gets the appropriate batches.
-  std::deque<std::unique_ptr<Batch<TaskType>>>& GetBatches()
+  std::deque<std::unique_ptr<Batch<TaskType>>>& GetBatches(bool low_priority)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // Gets the appropriate batches (const version).
-  const std::deque<std::unique_ptr<Batch<TaskType>>>& GetBatches() const
-      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  const std::deque<std::unique_ptr<Batch<TaskType>>>& GetBatches(
+      bool low_priority) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns `batch` without its expired tasks, which are handed to
+  // `expired_task_callback`.
+  std::unique_ptr<Batch<TaskType>> RemoveExpiredTasks(
+      std::unique_ptr<Batch<TaskType>> batch);
 
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
@@ -462,11 +586,15 @@ class Queue {
   // `GetMaxExecutionBatchSize` for more details on what it means.
   const size_t max_execution_batch_size_;
 
+  // The limits of the high and low priority batches.
+  const BatchLimits high_priority_limits_;
+  const BatchLimits low_priority_limits_;
+
   // A callback invoked to processes a batch of work units. Always invoked
   // from a batch thread.
   ProcessBatchCallback process_batch_callback_;
 
-  // A callback invoked to notify the scheduler that a new batch has become
+  // A callback invoked to notify the scheduler that new batches have become
   // schedulable.
   SchedulableBatchCallback schedulable_batch_callback_;
 
@@ -490,7 +618,8 @@ class Queue {
   // Each element corresponds to a task to be dequeued and processed by
   // `Queue<TaskType>::ProcessBatch`.
   //
-  // Used iff `QueueOptions.enable_lazy_split` is false.
+  // Used iff `QueueOptions.enable_lazy_split` is false, and only holds tasks
+  // iff `QueueOptions.enable_priority_queue` is true.
   std::deque<std::unique_ptr<Batch<TaskType>>> low_priority_batches_
       TF_GUARDED_BY(mu_);
 
@@ -510,6 +639,9 @@ class Queue {
   // task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The same for the open batch in 'low_priority_batches_'.
+  uint64 low_priority_open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -646,6 +778,43 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "enable_large_batch_splitting is enabled.");
   }
 
+  if (options.enable_priority_queue) {
+    if (options.enable_lazy_split) {
+      return errors::InvalidArgument(
+          "enable_priority_queue can't be enabled with enable_lazy_split.");
+    }
+    for (const auto* priority_options : {&options.high_priority_queue_options,
+                                         &options.low_priority_queue_options}) {
+      if (priority_options->input_batch_size_limit == 0) {
+        return errors::InvalidArgument(
+            "input_batch_size_limit of priority queues must be positive; was ",
+            priority_options->input_batch_size_limit);
+      }
+      if (priority_options->batch_timeout_micros < 0) {
+        return errors::InvalidArgument(
+            "batch_timeout_micros of priority queues must be non-negative; "
+            "was ",
+            priority_options->batch_timeout_micros);
+      }
+      if (priority_options->max_enqueued_batches == 0) {
+        return errors::InvalidArgument(
+            "max_enqueued_batches of priority queues must be positive; was ",
+            priority_options->max_enqueued_batches);
+      }
+      if (options.enable_large_batch_splitting &&
+          (priority_options->max_execution_batch_size == 0 ||
+           priority_options->input_batch_size_limit <
+               priority_options->max_execution_batch_size)) {
+        return errors::InvalidArgument(
+            "When enable_large_batch_splitting is true, "
+            "max_execution_batch_size of priority queues must be positive and "
+            "at most their input_batch_size_limit; was ",
+            priority_options->max_execution_batch_size, " and ",
+            priority_options->input_batch_size_limit);
+      }
+    }
+  }
+
   if (options.enable_large_batch_splitting &&
       (options.input_batch_size_limit < options.max_execution_batch_size)) {
     return errors::InvalidArgument(
@@ -656,9 +825,15 @@ Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         options.max_execution_batch_size);
   }
 
-  auto schedulable_batch_callback = [this] {
+  auto schedulable_batch_callback = [this](int num_batches) {
     mutex_lock l(mu_);
-    schedulable_batch_cv_.notify_one();
+    // Wake up a batch thread for each batch (e.g. the pieces of a split large
+    // task), so that they are processed in parallel right away.
+    if (num_batches > 1) {
+      schedulable_batch_cv_.notify_all();
+    } else {
+      schedulable_batch_cv_.notify_one();
+    }
   };
   auto internal_queue =
       std::unique_ptr<internal::Queue<TaskType>>(new internal::Queue<TaskType>(
@@ -745,6 +920,66 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
   *batch_to_process_out = std::move(batch_to_process);
 }
 
+template <typename TaskType>
+void SharedBatchScheduler<TaskType>::GetMostUrgentWorkItem_Locked(
+    internal::Queue<TaskType>** queue_for_batch_out,
+    BatchUniquePtr* batch_to_process_out) {
+  typename QueueList::iterator most_urgent_queue = queues_.end();
+  bool most_urgent_low_priority = true;
+  uint64 most_urgent_deadline_micros = std::numeric_limits<uint64>::max();
+  const int num_queues = queues_.size();
+  for (int num_queues_tried = 0; num_queues_tried < num_queues;
+       ++num_queues_tried) {
+    DCHECK(next_queue_to_schedule_ != queues_.end());
+
+    // As in GetNextWorkItem_Locked(), snapshot the closedness state before
+    // asking the queue for a batch.
+    const bool queue_closed = (*next_queue_to_schedule_)->closed();
+    bool low_priority;
+    uint64 deadline_micros;
+    const bool schedulable = (*next_queue_to_schedule_)->PeekSchedulableBatch(
+        &low_priority, &deadline_micros);
+
+    if (schedulable) {
+      // Queues that come first in round-robin order win ties.
+      if (most_urgent_queue == queues_.end() ||
+          std::make_pair(low_priority, deadline_micros) <
+              std::make_pair(most_urgent_low_priority,
+                             most_urgent_deadline_micros)) {
+        most_urgent_queue = next_queue_to_schedule_;
+        most_urgent_low_priority = low_priority;
+        most_urgent_deadline_micros = deadline_micros;
+      }
+      ++next_queue_to_schedule_;
+    } else if (queue_closed && (*next_queue_to_schedule_)->IsEmpty()) {
+      // We've encountered a closed queue with no work to do. Drop it.
+      next_queue_to_schedule_ = queues_.erase(next_queue_to_schedule_);
+    } else {
+      ++next_queue_to_schedule_;
+    }
+    if (next_queue_to_schedule_ == queues_.end() && !queues_.empty()) {
+      // We've hit the end. Wrap to the first queue.
+      next_queue_to_schedule_ = queues_.begin();
+    }
+  }
+
+  BatchUniquePtr batch_to_process;
+  internal::Queue<TaskType>* queue_for_batch = nullptr;
+  if (most_urgent_queue != queues_.end()) {
+    batch_to_process = (*most_urgent_queue)->ScheduleBatch();
+    if (BatchExists(batch_to_process)) {
+      queue_for_batch = most_urgent_queue->get();
+    }
+    // Continue the round-robin after the queue that was served.
+    next_queue_to_schedule_ = std::next(most_urgent_queue);
+    if (next_queue_to_schedule_ == queues_.end()) {
+      next_queue_to_schedule_ = queues_.begin();
+    }
+  }
+  *queue_for_batch_out = queue_for_batch;
+  *batch_to_process_out = std::move(batch_to_process);
+}
+
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::ThreadLogic() {
   // A batch to process next (or nullptr if no work to do).
@@ -754,7 +989,11 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   {
     mutex_lock l(mu_);
     while (true) {
-      GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process);
+      if (options_.enable_earliest_deadline_first) {
+        GetMostUrgentWorkItem_Locked(&queue_for_batch, &batch_to_process);
+      } else {
+        GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process);
+      }
       if (BatchExists(batch_to_process)) break;
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
@@ -803,6 +1042,8 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       max_execution_batch_size_(GetMaxExecutionBatchSize(options_)),
+      high_priority_limits_(GetBatchLimits(options_, /*low_priority=*/false)),
+      low_priority_limits_(GetBatchLimits(options_, /*low_priority=*/true)),
       process_batch_callback_(process_batch_callback),
       schedulable_batch_callback_(schedulable_batch_callback) {
   // Set the higher 32 bits of traceme_context_id_counter_ to be the creation
@@ -815,7 +1056,8 @@ Queue<TaskType>::Queue(
     task_handle_batches_.emplace_back(
         new Batch<BatchInputTaskHandle<TaskType>>);
   } else {
-    GetBatches().emplace_back(new Batch<TaskType>);
+    GetBatches(/*low_priority=*/false).emplace_back(new Batch<TaskType>);
+    GetBatches(/*low_priority=*/true).emplace_back(new Batch<TaskType>);
   }
 }
 
@@ -828,16 +1070,25 @@ Queue<TaskType>::~Queue() {
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
   } else {
-    GetBatches().back()->Close();
+    GetBatches(/*low_priority=*/false).back()->Close();
+    GetBatches(/*low_priority=*/true).back()->Close();
   }
 }
 
 template <typename TaskType>
 Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
-  if ((*task)->size() > options_.input_batch_size_limit) {
+  const size_t input_batch_size_limit =
+      GetBatchLimits(IsLowPriorityTask(**task)).input_batch_size_limit;
+  if ((*task)->size() > input_batch_size_limit) {
     return errors::InvalidArgument("Task size ", (*task)->size(),
                                    " is larger than maximum input batch size ",
-                                   options_.input_batch_size_limit);
+                                   input_batch_size_limit);
+  }
+  const uint64 deadline_micros = (*task)->deadline_micros();
+  if (deadline_micros != std::numeric_limits<uint64>::max() &&
+      deadline_micros <= env_->NowMicros()) {
+    return errors::DeadlineExceeded(
+        "The deadline of the task has passed before it was scheduled");
   }
   if (options_.enable_lazy_split) {
     return ScheduleWithLazySplit(std::move(task));
@@ -855,16 +1106,18 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
   // The max size to be enqueued.
   const int max_execution_batch_size = options_.max_execution_batch_size;
 
-  bool notify_of_schedulable_batch = false;
+  int num_batches_to_notify = 0;
   {
     mutex_lock l(mu_);
 
     DCHECK(!closed_);
 
-    TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity(
+        (*task).get(), /*low_priority=*/false));
 
     const int64 open_batch_capacity =
-        max_execution_batch_size - this->tail_batch_task_size();
+        max_execution_batch_size -
+        this->tail_batch_task_size(/*low_priority=*/false);
 
     auto input_batch = std::make_shared<BatchInputTask<TaskType>>(
         std::move(*task), open_batch_capacity, max_execution_batch_size,
@@ -873,10 +1126,12 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
 
     input_batch->ToTaskHandles(&task_handles);
 
+    int num_closed_batches = 0;
     for (int i = 0; i < task_handles.size(); ++i) {
       if (task_handle_batches_.back()->size() + task_handles[i]->size() >
           options_.max_execution_batch_size) {
-        StartNewBatch();
+        StartNewBatch(/*low_priority=*/false);
+        ++num_closed_batches;
       }
       if (task_handle_batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
@@ -893,17 +1148,22 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
     }
 
     if (!schedulable_batch_) {
-      if (GetBatches().size() > 1 || IsOpenBatchSchedulable()) {
+      if (GetBatches(/*low_priority=*/false).size() > 1 ||
+          IsOpenBatchSchedulable(/*low_priority=*/false)) {
         schedulable_batch_ = true;
-        notify_of_schedulable_batch = true;
+        num_batches_to_notify = 1;
       }
     }
+    // A split task may close several batches at once.
+    if (num_closed_batches > 1) {
+      num_batches_to_notify = num_closed_batches;
+    }
   }
   // TODO(b/194294263):
   // Add unit tests to verify that `schedulable_batch_callback_` could be
   // triggered when batches are scheduled.
-  if (notify_of_schedulable_batch) {
-    schedulable_batch_callback_();
+  if (num_batches_to_notify > 0) {
+    schedulable_batch_callback_(num_batches_to_notify);
   }
 
   return OkStatus();
@@ -923,7 +1183,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
         {{"batching_input_task_size", (*task)->size()}});
   });
 
-  bool notify_of_schedulable_batch = false;
+  int num_batches_to_notify = 0;
   {
     mutex_lock l(mu_);
 
@@ -932,12 +1192,17 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
     // TODO(b/161857471):
     // Add test coverage when when concurrent incoming batches arrives and
     // use up all queue capacity.
-    TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
+    const bool low_priority = IsLowPriorityTask(**task);
+    TF_RETURN_IF_ERROR(
+        ValidateBatchTaskQueueCapacity((*task).get(), low_priority));
 
-    std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+    std::deque<std::unique_ptr<Batch<TaskType>>>& batches =
+        GetBatches(low_priority);
+    const size_t max_execution_batch_size =
+        GetBatchLimits(low_priority).max_execution_batch_size;
 
     const int64_t open_batch_remaining_slot =
-        max_execution_batch_size() - batches.back()->size();
+        max_execution_batch_size - batches.back()->size();
 
     const int64_t input_task_size = (*task)->size();
 
@@ -948,16 +1213,20 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
       // This is the fast path when input doesn't need to be split.
       output_tasks.push_back(std::move(*task));
     } else {
-      TF_RETURN_IF_ERROR(SplitInputBatchIntoSubtasks(task, &output_tasks));
+      TF_RETURN_IF_ERROR(
+          SplitInputBatchIntoSubtasks(task, low_priority, &output_tasks));
     }
 
+    int num_closed_batches = 0;
     for (int i = 0; i < output_tasks.size(); ++i) {
       if (batches.back()->size() + output_tasks[i]->size() >
-          max_execution_batch_size()) {
-        StartNewBatch();
+          max_execution_batch_size) {
+        StartNewBatch(low_priority);
+        ++num_closed_batches;
       }
       if (batches.back()->empty()) {
-        open_batch_start_time_micros_ = env_->NowMicros();
+        (low_priority ? low_priority_open_batch_start_time_micros_
+                      : open_batch_start_time_micros_) = env_->NowMicros();
       }
       profiler::TraceMeProducer trace_me(
           [&output_tasks, i] {
@@ -970,15 +1239,19 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
     }
 
     if (!schedulable_batch_) {
-      if (batches.size() > 1 || IsOpenBatchSchedulable()) {
+      if (batches.size() > 1 || IsOpenBatchSchedulable(low_priority)) {
         schedulable_batch_ = true;
-        notify_of_schedulable_batch = true;
+        num_batches_to_notify = 1;
       }
     }
+    // The pieces of a split task may close several batches at once.
+    if (num_closed_batches > 1) {
+      num_batches_to_notify = num_closed_batches;
+    }
   }
 
-  if (notify_of_schedulable_batch) {
-    schedulable_batch_callback_();
+  if (num_batches_to_notify > 0) {
+    schedulable_batch_callback_(num_batches_to_notify);
   }
 
   return OkStatus();
@@ -995,8 +1268,10 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
     return num_enqueued_tasks;
   }
 
-  for (const auto& batch : GetBatches()) {
-    num_enqueued_tasks += batch->num_tasks();
+  for (const bool low_priority : {false, true}) {
+    for (const auto& batch : GetBatches(low_priority)) {
+      num_enqueued_tasks += batch->num_tasks();
+    }
   }
   return num_enqueued_tasks;
 }
@@ -1004,17 +1279,18 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
 template <typename TaskType>
 size_t Queue<TaskType>::SchedulingCapacity() const {
   mutex_lock l(mu_);
-  return SchedulingCapacityInternal();
+  return SchedulingCapacityInternal(/*low_priority=*/false);
 }
 
 template <typename TaskType>
-size_t Queue<TaskType>::SchedulingCapacityInternal() const {
+size_t Queue<TaskType>::SchedulingCapacityInternal(bool low_priority) const {
+  const BatchLimits& limits = GetBatchLimits(low_priority);
   const int64 num_new_batches_schedulable =
-      static_cast<int64_t>(options_.max_enqueued_batches) -
-      this->num_enqueued_batches();
-  const int64 execution_batch_size_limit = max_execution_batch_size();
+      static_cast<int64_t>(limits.max_enqueued_batches) -
+      this->num_enqueued_batches(low_priority);
+  const int64 execution_batch_size_limit = limits.max_execution_batch_size;
   const int64 open_batch_capacity =
-      execution_batch_size_limit - this->tail_batch_task_size();
+      execution_batch_size_limit - this->tail_batch_task_size(low_priority);
   // Note the returned value is guaranteed to be not negative, since
   // enqueue operation could only happen if queue has enough capacity.
   return (num_new_batches_schedulable * execution_batch_size_limit) +
@@ -1022,21 +1298,24 @@ size_t Queue<TaskType>::SchedulingCapacityInternal() const {
 }
 
 template <typename TaskType>
-Status Queue<TaskType>::ValidateBatchTaskQueueCapacity(TaskType* task) const {
+Status Queue<TaskType>::ValidateBatchTaskQueueCapacity(
+    TaskType* task, bool low_priority) const {
+  const BatchLimits& limits = GetBatchLimits(low_priority);
   // Queue creation requires that `enable_large_batch_splitting` is true
   // when `enable_lazy_split` is true, so this covers both eager split and
   // lazy split.
   if (options_.enable_large_batch_splitting) {
-    if (task->size() > SchedulingCapacityInternal()) {
+    if (task->size() > SchedulingCapacityInternal(low_priority)) {
       return errors::Unavailable(
           "The batch scheduling queue to which this task was submitted is "
           "full; task size is ",
           task->size(), " but scheduling capacity is only ",
-          SchedulingCapacityInternal(),
-          " (num_enqueued_batches=", num_enqueued_batches(),
-          ", max_enqueued_batches=", options_.max_enqueued_batches,
-          ", open_batch_size=", tail_batch_task_size(),
-          ", max_execution_batch_size=", max_execution_batch_size(), ")");
+          SchedulingCapacityInternal(low_priority),
+          " (num_enqueued_batches=", num_enqueued_batches(low_priority),
+          ", max_enqueued_batches=", limits.max_enqueued_batches,
+          ", open_batch_size=", tail_batch_task_size(low_priority),
+          ", max_execution_batch_size=", limits.max_execution_batch_size,
+          ")");
     }
     return OkStatus();
   }
@@ -1049,14 +1328,15 @@ Status Queue<TaskType>::ValidateBatchTaskQueueCapacity(TaskType* task) const {
   // allows such models to continue to work.
   //
   // We need to revisit/remove this check after we fix model configs.
-  const std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
-  if (batches.back()->size() + task->size() > options_.input_batch_size_limit) {
-    if (batches.size() >= options_.max_enqueued_batches) {
+  const std::deque<std::unique_ptr<Batch<TaskType>>>& batches =
+      GetBatches(low_priority);
+  if (batches.back()->size() + task->size() > limits.input_batch_size_limit) {
+    if (batches.size() >= limits.max_enqueued_batches) {
       return errors::Unavailable(
           "The batch scheduling queue to which this task was submitted is "
           "full; currently ",
           batches.size(), " batches enqueued and max_enqueued_batches is ",
-          options_.max_enqueued_batches);
+          limits.max_enqueued_batches);
     }
   }
   return OkStatus();
@@ -1072,18 +1352,26 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
   {
     mutex_lock l(mu_);
 
-    std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
-    // Consider closing the open batch at this time, to schedule it.
-    if (batches.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
-    }
+    // Low priority batches are only considered if there is no high priority
+    // batch to schedule.
+    for (const bool low_priority : {false, true}) {
+      if (low_priority && !options_.enable_priority_queue) break;
+      std::deque<std::unique_ptr<Batch<TaskType>>>& batches =
+          GetBatches(low_priority);
+      // Consider closing the open batch at this time, to schedule it.
+      if (batches.size() == 1 && IsOpenBatchSchedulable(low_priority)) {
+        StartNewBatch(low_priority);
+      }
 
-    if (batches.size() >= 2) {
-      // There is at least one closed batch that is ready to be scheduled.
-      ++num_batches_being_processed_;
-      batch_to_schedule = std::move(batches.front());
-      batches.pop_front();
-    } else {
+      if (batches.size() >= 2) {
+        // There is at least one closed batch that is ready to be scheduled.
+        ++num_batches_being_processed_;
+        batch_to_schedule = std::move(batches.front());
+        batches.pop_front();
+        break;
+      }
+    }
+    if (batch_to_schedule == nullptr) {
       schedulable_batch_ = false;
     }
   }
@@ -1091,6 +1379,38 @@ Queue<TaskType>::ScheduleBatchWithEagerSplit() {
   return batch_to_schedule;
 }
 
+template <typename TaskType>
+bool Queue<TaskType>::PeekSchedulableBatch(bool* low_priority,
+                                           uint64* deadline_micros) const {
+  mutex_lock l(mu_);
+  *low_priority = false;
+  *deadline_micros = std::numeric_limits<uint64>::max();
+  if (options_.enable_lazy_split) {
+    // Tasks are only split after dequeue, so their deadlines aren't looked at.
+    return task_handle_batches_.size() >= 2 ||
+           IsOpenBatchSchedulable(/*low_priority=*/false);
+  }
+  // Mirrors the choice of batch made by ScheduleBatchWithEagerSplit().
+  for (const bool is_low_priority : {false, true}) {
+    const std::deque<std::unique_ptr<Batch<TaskType>>>& batches =
+        GetBatches(is_low_priority);
+    const Batch<TaskType>* batch = nullptr;
+    if (batches.size() >= 2) {
+      batch = batches.front().get();
+    } else if (IsOpenBatchSchedulable(is_low_priority)) {
+      batch = batches.back().get();
+    }
+    if (batch == nullptr) continue;
+    *low_priority = is_low_priority;
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      *deadline_micros =
+          std::min(*deadline_micros, batch->task(i).deadline_micros());
+    }
+    return true;
+  }
+  return false;
+}
+
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchUniquePtr
 Queue<TaskType>::ScheduleBatch() {
@@ -1106,8 +1426,9 @@ Queue<TaskType>::ScheduleBatch() {
     mutex_lock l(mu_);
 
     // Consider closing the open batch at this time, to schedule it.
-    if (task_handle_batches_.size() == 1 && IsOpenBatchSchedulable()) {
-      StartNewBatch();
+    if (task_handle_batches_.size() == 1 &&
+        IsOpenBatchSchedulable(/*low_priority=*/false)) {
+      StartNewBatch(/*low_priority=*/false);
     }
 
     if (task_handle_batches_.size() >= 2) {
@@ -1125,15 +1446,20 @@ Queue<TaskType>::ScheduleBatch() {
 
 template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
-  profiler::TraceMeConsumer trace_me(
-      [&] {
-        return profiler::TraceMeEncode(
-            "ProcessBatch", {{"batch_size_before_padding", batch->size()},
-                             {"_r", 2} /*root_event*/});
-      },
-      profiler::ContextType::kSharedBatchScheduler,
-      batch->traceme_context_id());
-  process_batch_callback_(std::move(batch));
+  if (options_.expired_task_callback) {
+    batch = RemoveExpiredTasks(std::move(batch));
+  }
+  if (!batch->empty()) {
+    profiler::TraceMeConsumer trace_me(
+        [&] {
+          return profiler::TraceMeEncode(
+              "ProcessBatch", {{"batch_size_before_padding", batch->size()},
+                               {"_r", 2} /*root_event*/});
+        },
+        profiler::ContextType::kSharedBatchScheduler,
+        batch->traceme_context_id());
+    process_batch_callback_(std::move(batch));
+  }
 
   {
     mutex_lock l(mu_);
@@ -1144,6 +1470,34 @@ void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   }
 }
 
+template <typename TaskType>
+std::unique_ptr<Batch<TaskType>> Queue<TaskType>::RemoveExpiredTasks(
+    std::unique_ptr<Batch<TaskType>> batch) {
+  const uint64 now_micros = env_->NowMicros();
+  bool has_expired_task = false;
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    if (batch->task(i).deadline_micros() <= now_micros) {
+      has_expired_task = true;
+      break;
+    }
+  }
+  if (!has_expired_task) {
+    return batch;
+  }
+
+  auto unexpired_batch =
+      std::make_unique<Batch<TaskType>>(batch->traceme_context_id());
+  for (std::unique_ptr<TaskType>& task : batch->RemoveAllTasks()) {
+    if (task->deadline_micros() <= now_micros) {
+      options_.expired_task_callback(std::move(task));
+    } else {
+      unexpired_batch->AddTask(std::move(task));
+    }
+  }
+  unexpired_batch->Close();
+  return unexpired_batch;
+}
+
 template <typename TaskType>
 bool Queue<TaskType>::IsEmpty() const {
   mutex_lock l(mu_);
@@ -1173,87 +1527,130 @@ bool Queue<TaskType>::IsEmptyInternal() const {
            task_handle_batches_.size() == 1 &&
            task_handle_batches_.back()->empty();
   }
-  const std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
-  return num_batches_being_processed_ == 0 && batches.size() == 1 &&
-         batches.back()->empty();
+  if (num_batches_being_processed_ != 0) {
+    return false;
+  }
+  for (const bool low_priority : {false, true}) {
+    const std::deque<std::unique_ptr<Batch<TaskType>>>& batches =
+        GetBatches(low_priority);
+    if (batches.size() != 1 || !batches.back()->empty()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 template <typename TaskType>
-void Queue<TaskType>::StartNewBatch() {
+void Queue<TaskType>::StartNewBatch(bool low_priority) {
   if (options_.enable_lazy_split) {
     task_handle_batches_.back()->Close();
     task_handle_batches_.emplace_back(new Batch<BatchInputTaskHandle<TaskType>>(
         ++traceme_context_id_counter_));
     return;
   }
-  std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+  std::deque<std::unique_ptr<Batch<TaskType>>>& batches =
+      GetBatches(low_priority);
   batches.back()->Close();
   batches.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
 }
 
 template <typename TaskType>
 Status Queue<TaskType>::SplitInputBatchIntoSubtasks(
-    std::unique_ptr<TaskType>* input_task,
+    std::unique_ptr<TaskType>* input_task, bool low_priority,
     std::vector<std::unique_ptr<TaskType>>* output_tasks) {
+  const int max_execution_batch_size =
+      GetBatchLimits(low_priority).max_execution_batch_size;
   const int open_batch_remaining_slot =
-      max_execution_batch_size() - this->tail_batch_task_size();
+      max_execution_batch_size - this->tail_batch_task_size(low_priority);
   return options_.split_input_task_func(
       std::move(input_task), open_batch_remaining_slot,
-      max_execution_batch_size(), std::move(output_tasks));
+      max_execution_batch_size, std::move(output_tasks));
 }
 
 template <typename TaskType>
-bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
-  Batch<TaskType>* open_batch = GetBatches().back().get();
+bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit(
+    bool low_priority) const {
+  Batch<TaskType>* open_batch = GetBatches(low_priority).back().get();
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  int64_t batch_timeout_micros;
+  size_t schedulable_batch_size;
+  GetOpenBatchSchedulingParams(low_priority, &batch_timeout_micros,
+                               &schedulable_batch_size);
+  const uint64 open_batch_start_time_micros =
+      low_priority ? low_priority_open_batch_start_time_micros_
+                   : open_batch_start_time_micros_;
+  return closed_ || open_batch->size() >= schedulable_batch_size ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros + batch_timeout_micros;
 }
 
 template <typename TaskType>
-bool Queue<TaskType>::IsOpenBatchSchedulable() const {
+bool Queue<TaskType>::IsOpenBatchSchedulable(bool low_priority) const {
   if (!options_.enable_lazy_split) {
-    return IsOpenBatchSchedulableAfterEagerSplit();
+    return IsOpenBatchSchedulableAfterEagerSplit(low_priority);
   }
   Batch<BatchInputTaskHandle<TaskType>>* open_batch =
       task_handle_batches_.back().get();
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  int64_t batch_timeout_micros;
+  size_t schedulable_batch_size;
+  GetOpenBatchSchedulingParams(/*low_priority=*/false, &batch_timeout_micros,
+                               &schedulable_batch_size);
+  return closed_ || open_batch->size() >= schedulable_batch_size ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros;
+}
+
+template <typename TaskType>
+void Queue<TaskType>::GetOpenBatchSchedulingParams(
+    bool low_priority, int64_t* batch_timeout_micros,
+    size_t* schedulable_batch_size) const {
+  const BatchLimits& limits = GetBatchLimits(low_priority);
+  *batch_timeout_micros = limits.batch_timeout_micros;
+  *schedulable_batch_size = limits.max_execution_batch_size;
+  if (low_priority) {
+    return;
+  }
+  if (options_.batch_timeout_micros_func) {
+    *batch_timeout_micros = options_.batch_timeout_micros_func();
+  }
+  if (options_.schedulable_batch_size_func) {
+    *schedulable_batch_size = std::min(*schedulable_batch_size,
+                                       options_.schedulable_batch_size_func());
+  }
 }
 
 template <typename TaskType>
-size_t Queue<TaskType>::tail_batch_task_size() const {
+size_t Queue<TaskType>::tail_batch_task_size(bool low_priority) const {
   if (options_.enable_lazy_split) {
     return task_handle_batches_.back()->size();
   }
 
-  return GetBatches().back()->size();
+  return GetBatches(low_priority).back()->size();
 }
 
 template <typename TaskType>
-int64 Queue<TaskType>::num_enqueued_batches() const {
+int64 Queue<TaskType>::num_enqueued_batches(bool low_priority) const {
   if (options_.enable_lazy_split) {
     return task_handle_batches_.size();
   }
-  return GetBatches().size();
+  return GetBatches(low_priority).size();
 }
 
 template <typename TaskType>
-std::deque<std::unique_ptr<Batch<TaskType>>>& Queue<TaskType>::GetBatches() {
-  return high_priority_batches_;
+std::deque<std::unique_ptr<Batch<TaskType>>>& Queue<TaskType>::GetBatches(
+    bool low_priority) {
+  return low_priority ? low_priority_batches_ : high_priority_batches_;
 }
 
 template <typename TaskType>
 const std::deque<std::unique_ptr<Batch<TaskType>>>&
-Queue<TaskType>::GetBatches() const {
-  return high_priority_batches_;
+Queue<TaskType>::GetBatches(bool low_priority) const {
+  return low_priority ? low_priority_batches_ : high_priority_batches_;
 }
 
 template <typename TaskType>
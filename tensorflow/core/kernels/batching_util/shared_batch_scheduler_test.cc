@@ -15,11 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
+#include <limits>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "absl/container/fixed_array.h"
@@ -27,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
@@ -35,23 +40,39 @@ limitations under the License.
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
+#include "tsl/platform/criticality.h"
 
 namespace tensorflow {
 namespace serving {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 class FakeTask : public BatchTask {
  public:
-  explicit FakeTask(size_t size) : size_(size) {}
+  explicit FakeTask(size_t size,
+                    tsl::criticality::Criticality criticality =
+                        tsl::criticality::Criticality::kCritical,
+                    uint64 deadline_micros = std::numeric_limits<uint64>::max())
+      : size_(size),
+        criticality_(criticality),
+        deadline_micros_(deadline_micros) {}
 
   ~FakeTask() override = default;
 
   size_t size() const override { return size_; }
 
+  tsl::criticality::Criticality criticality() const override {
+    return criticality_;
+  }
+
+  uint64 deadline_micros() const override { return deadline_micros_; }
+
  private:
   const size_t size_;
+  const tsl::criticality::Criticality criticality_;
+  const uint64 deadline_micros_;
 
   FakeTask(const FakeTask&) = delete;
   void operator=(const FakeTask&) = delete;
@@ -805,6 +826,361 @@ INSTANTIATE_TEST_SUITE_P(
                       std::make_tuple(/*enable_input_batch_split=*/false,
                                       /*enable_lazy_split=*/false)));
 
+// Returns the options of a queue with a low priority lane and the same limits
+// for both lanes.
+QueueOptions CreatePriorityQueueOptions(size_t input_batch_size_limit,
+                                        int64_t batch_timeout_micros,
+                                        size_t max_enqueued_batches) {
+  QueueOptions queue_options;
+  queue_options.input_batch_size_limit = input_batch_size_limit;
+  queue_options.batch_timeout_micros = batch_timeout_micros;
+  queue_options.max_enqueued_batches = max_enqueued_batches;
+  queue_options.enable_priority_queue = true;
+  for (auto* priority_options : {&queue_options.high_priority_queue_options,
+                                 &queue_options.low_priority_queue_options}) {
+    priority_options->input_batch_size_limit = input_batch_size_limit;
+    priority_options->batch_timeout_micros = batch_timeout_micros;
+    priority_options->max_enqueued_batches = max_enqueued_batches;
+  }
+  return queue_options;
+}
+
+TEST(SharedBatchSchedulerPriorityTest, InvalidPriorityQueueOptions) {
+  auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+    // do nothing.
+  };
+  auto scheduler = CreateSharedBatchScheduler(1);
+  std::unique_ptr<Queue> queue;
+
+  QueueOptions queue_options = CreatePriorityQueueOptions(
+      /*input_batch_size_limit=*/10, /*batch_timeout_micros=*/0,
+      /*max_enqueued_batches=*/2);
+  queue_options.low_priority_queue_options.max_enqueued_batches = 0;
+  EXPECT_THAT(
+      scheduler->AddQueue(queue_options, callback, &queue),
+      testing::StatusIs(
+          error::INVALID_ARGUMENT,
+          "max_enqueued_batches of priority queues must be positive; was 0"));
+
+  queue_options = CreatePriorityQueueOptions(
+      /*input_batch_size_limit=*/10, /*batch_timeout_micros=*/0,
+      /*max_enqueued_batches=*/2);
+  queue_options.enable_large_batch_splitting = true;
+  queue_options.enable_lazy_split = true;
+  queue_options.split_input_task_func =
+      [](std::unique_ptr<FakeTask>* input_task, int first_output_task_size,
+         int input_batch_size_limit,
+         std::vector<std::unique_ptr<FakeTask>>* output_tasks) -> Status {
+    return OkStatus();
+  };
+  EXPECT_THAT(
+      scheduler->AddQueue(queue_options, callback, &queue),
+      testing::StatusIs(
+          error::INVALID_ARGUMENT,
+          "enable_priority_queue can't be enabled with enable_lazy_split."));
+}
+
+TEST(SharedBatchSchedulerPriorityTest, HighPriorityBatchesGoFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> processed_batch_sizes;
+    Notification first_batch_scheduled, first_batch_proceed,
+        all_batches_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (!first_batch_scheduled.HasBeenNotified()) {
+        first_batch_scheduled.Notify();
+        first_batch_proceed.WaitForNotification();
+      }
+      mutex_lock l(mu);
+      processed_batch_sizes.push_back(batch->size());
+      if (processed_batch_sizes.size() == 3) {
+        all_batches_processed.Notify();
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    auto queue = CreateQueue(scheduler,
+                             CreatePriorityQueueOptions(
+                                 /*input_batch_size_limit=*/10,
+                                 /*batch_timeout_micros=*/1,
+                                 /*max_enqueued_batches=*/10),
+                             callback);
+
+    // Occupy the batch thread with a full batch.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+    first_batch_scheduled.WaitForNotification();
+
+    // Enqueue a low priority task before a high priority one, and let both of
+    // their batches time out.
+    auto low_priority_task = std::make_unique<FakeTask>(
+        2, tsl::criticality::Criticality::kSheddable);
+    TF_ASSERT_OK(queue->Schedule(&low_priority_task));
+    auto high_priority_task = std::make_unique<FakeTask>(
+        3, tsl::criticality::Criticality::kCritical);
+    TF_ASSERT_OK(queue->Schedule(&high_priority_task));
+    EXPECT_EQ(queue->NumEnqueuedTasks(), 2);
+    env.AdvanceByMicroseconds(1);
+
+    first_batch_proceed.Notify();
+    all_batches_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(processed_batch_sizes, ElementsAre(10, 3, 2));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerDeadlineTest, RejectsExpiredTasks) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    auto callback = [](std::unique_ptr<Batch<FakeTask>> batch) {
+      // do nothing.
+    };
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions queue_options;
+    queue_options.batch_timeout_micros = 0;
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+
+    env.AdvanceByMicroseconds(100);
+    auto expired_task = std::make_unique<FakeTask>(
+        1, tsl::criticality::Criticality::kCritical, /*deadline_micros=*/100);
+    EXPECT_THAT(queue->Schedule(&expired_task),
+                testing::StatusIs(error::DEADLINE_EXCEEDED));
+    EXPECT_NE(expired_task, nullptr);
+
+    auto task = std::make_unique<FakeTask>(
+        1, tsl::criticality::Criticality::kCritical, /*deadline_micros=*/101);
+    TF_EXPECT_OK(queue->Schedule(&task));
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerDeadlineTest, ExpiredTaskCallback) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> processed_batch_sizes;
+    std::vector<size_t> expired_task_sizes;
+    Notification first_batch_scheduled, first_batch_proceed,
+        second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (!first_batch_scheduled.HasBeenNotified()) {
+        first_batch_scheduled.Notify();
+        first_batch_proceed.WaitForNotification();
+      }
+      mutex_lock l(mu);
+      processed_batch_sizes.push_back(batch->size());
+      if (processed_batch_sizes.size() == 2) {
+        second_batch_processed.Notify();
+      }
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 10;
+    queue_options.batch_timeout_micros = 1;
+    queue_options.expired_task_callback = [&](std::unique_ptr<FakeTask> task) {
+      mutex_lock l(mu);
+      expired_task_sizes.push_back(task->size());
+    };
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+
+    // Occupy the batch thread with a full batch.
+    TF_ASSERT_OK(ScheduleTask(10, queue.get()));
+    first_batch_scheduled.WaitForNotification();
+
+    // Enqueue a task that expires while it waits for the batch thread, and
+    // one that doesn't.
+    auto expiring_task = std::make_unique<FakeTask>(
+        1, tsl::criticality::Criticality::kCritical, /*deadline_micros=*/5);
+    TF_ASSERT_OK(queue->Schedule(&expiring_task));
+    auto task = std::make_unique<FakeTask>(
+        2, tsl::criticality::Criticality::kCritical, /*deadline_micros=*/1000);
+    TF_ASSERT_OK(queue->Schedule(&task));
+    env.AdvanceByMicroseconds(5);
+
+    first_batch_proceed.Notify();
+    second_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(processed_batch_sizes, ElementsAre(10, 2));
+      EXPECT_THAT(expired_task_sizes, ElementsAre(1));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerDeadlineTest, EarliestDeadlineFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<int> processed_queues;
+    Notification first_batch_scheduled, first_batch_proceed,
+        all_batches_processed;
+    auto make_callback = [&](int queue_index) {
+      return [&, queue_index](std::unique_ptr<Batch<FakeTask>> batch) {
+        if (!first_batch_scheduled.HasBeenNotified()) {
+          first_batch_scheduled.Notify();
+          first_batch_proceed.WaitForNotification();
+        }
+        mutex_lock l(mu);
+        processed_queues.push_back(queue_index);
+        if (processed_queues.size() == 3) {
+          all_batches_processed.Notify();
+        }
+      };
+    };
+
+    Scheduler::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    options.enable_earliest_deadline_first = true;
+    std::shared_ptr<Scheduler> scheduler;
+    TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+    QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 10;
+    queue_options.batch_timeout_micros = 1;
+    auto queue_0 = CreateQueue(scheduler, queue_options, make_callback(0));
+    auto queue_1 = CreateQueue(scheduler, queue_options, make_callback(1));
+
+    // Occupy the batch thread with a full batch of queue 0, after which
+    // round-robin would serve queue 1 first.
+    TF_ASSERT_OK(ScheduleTask(10, queue_0.get()));
+    first_batch_scheduled.WaitForNotification();
+
+    auto late_task = std::make_unique<FakeTask>(
+        1, tsl::criticality::Criticality::kCritical, /*deadline_micros=*/500);
+    TF_ASSERT_OK(queue_1->Schedule(&late_task));
+    auto early_task = std::make_unique<FakeTask>(
+        1, tsl::criticality::Criticality::kCritical, /*deadline_micros=*/200);
+    TF_ASSERT_OK(queue_0->Schedule(&early_task));
+    env.AdvanceByMicroseconds(1);
+
+    first_batch_proceed.Notify();
+    all_batches_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(processed_queues, ElementsAre(0, 0, 1));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, SchedulingParamsFuncs) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    mutex mu;
+    std::vector<size_t> processed_batch_sizes;
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      mutex_lock l(mu);
+      processed_batch_sizes.push_back(batch->size());
+      if (processed_batch_sizes.size() == 1) {
+        first_batch_processed.Notify();
+      } else if (processed_batch_sizes.size() == 2) {
+        second_batch_processed.Notify();
+      }
+    };
+
+    std::atomic<int64_t> batch_timeout_micros{1000 * 1000};
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions queue_options;
+    queue_options.input_batch_size_limit = 10;
+    queue_options.batch_timeout_micros = 1000 * 1000;
+    queue_options.batch_timeout_micros_func = [&] {
+      return batch_timeout_micros.load();
+    };
+    queue_options.schedulable_batch_size_func = [] { return 2; };
+    auto queue = CreateQueue(scheduler, queue_options, callback);
+
+    // The batch is schedulable once it reaches the returned batch size.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    first_batch_processed.WaitForNotification();
+
+    // And once the returned timeout has passed.
+    batch_timeout_micros = 5;
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(5);
+    second_batch_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      EXPECT_THAT(processed_batch_sizes, ElementsAre(2, 1));
+    }
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, SplitTaskBatchesRunInParallel) {
+  for (const bool enable_lazy_split : {false, true}) {
+    // All pieces of the task must be processed at once to get out of the
+    // callback.
+    BlockingCounter pieces_started(4);
+    auto callback = [&pieces_started](std::unique_ptr<Batch<FakeTask>> batch) {
+      EXPECT_EQ(batch->size(), 10);
+      pieces_started.DecrementCount();
+      EXPECT_TRUE(pieces_started.WaitFor(std::chrono::seconds(10)));
+    };
+    std::shared_ptr<Scheduler> scheduler =
+        CreateSharedBatchScheduler(/*num_batch_threads=*/4);
+    SplitFunc split_func =
+        [](std::unique_ptr<FakeTask>* input_task, int open_batch_remaining_slot,
+           int max_batch_size,
+           std::vector<std::unique_ptr<FakeTask>>* output_tasks) -> Status {
+      const internal::InputSplitMetadata input_split_metadata(
+          (*input_task)->size(), open_batch_remaining_slot, max_batch_size);
+      for (const int task_size : input_split_metadata.task_sizes()) {
+        output_tasks->push_back(std::make_unique<FakeTask>(task_size));
+      }
+      input_task->reset();
+      return OkStatus();
+    };
+    std::unique_ptr<Queue> queue = CreateQueue(
+        scheduler,
+        CreateQueueOptions(/*max_execution_batch_size=*/10,
+                           /*input_batch_size_limit=*/40,
+                           /*batch_timeout_micros=*/absl::ToInt64Microseconds(
+                               absl::Seconds(10)),
+                           /*max_enqueued_batches=*/4,
+                           /*enable_large_batch_splitting=*/true,
+                           enable_lazy_split, split_func),
+        callback);
+    TF_ASSERT_OK(ScheduleTask(40, queue.get()));
+  }
+}
+
 #ifdef PLATFORM_GOOGLE
 // This benchmark relies on https://github.com/google/benchmark features,
 // (in particular, `Benchmark::ThreadRange`) not available in open-sourced TF
@@ -14,15 +14,26 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/batching_util/warmup.h"
 
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
 
 namespace tensorflow {
 namespace serving {
@@ -78,5 +89,65 @@ bool ShouldWarmupAllBatchSizes(const OpKernelContext* c) {
   return per_model_data && per_model_data->warmup_all_batch_sizes;
 }
 
+absl::StatusOr<std::vector<Tensor>> CreateWarmupInputs(
+    absl::Span<const WarmupInputSpec> input_specs, int64_t batch_size) {
+  std::vector<Tensor> inputs;
+  inputs.reserve(input_specs.size());
+  for (const WarmupInputSpec& spec : input_specs) {
+    if (spec.shape.unknown_rank() || spec.shape.dims() == 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "Warm-up inputs need a batch dimension; got shape ",
+          spec.shape.DebugString()));
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(shape.AddDimWithStatus(batch_size));
+    for (int i = 1; i < spec.shape.dims(); ++i) {
+      const int64_t dim_size = spec.shape.dim_size(i);
+      TF_RETURN_IF_ERROR(shape.AddDimWithStatus(dim_size < 0 ? 1 : dim_size));
+    }
+    Tensor input(spec.dtype, shape);
+    if (DataTypeCanUseMemcpy(spec.dtype)) {
+      // Tensors of these types are not initialized on construction.
+      std::memset(const_cast<char*>(input.tensor_data().data()), 0,
+                  input.tensor_data().size());
+    } else if (spec.dtype != DT_STRING) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported warm-up input type: ",
+                       DataTypeString(spec.dtype)));
+    }
+    inputs.push_back(std::move(input));
+  }
+  return inputs;
+}
+
+absl::Status WarmupBatchSizes(
+    const WarmupStateRegistry::Key& model_key,
+    absl::Span<const int32_t> batch_sizes,
+    absl::Span<const WarmupInputSpec> input_specs,
+    const std::function<absl::Status(const std::vector<Tensor>& inputs)>&
+        run_inputs) {
+  // Every batch size is run explicitly, so batch ops need not pad warm-up
+  // batches to all their allowed batch sizes.
+  auto per_model_data = std::make_unique<WarmupStateRegistry::PerModelData>();
+  per_model_data->warmup_all_batch_sizes = false;
+  TF_ASSIGN_OR_RETURN(WarmupStateRegistry::Handle handle,
+                      GetGlobalWarmupStateRegistry().Register(
+                          model_key, std::move(per_model_data)));
+  for (const int32_t batch_size : batch_sizes) {
+    VLOG(1) << "Warming up model " << model_key.name << ":"
+            << model_key.version << " for batch size " << batch_size;
+    TF_ASSIGN_OR_RETURN(std::vector<Tensor> inputs,
+                        CreateWarmupInputs(input_specs, batch_size));
+    absl::Status status = run_inputs(inputs);
+    if (!status.ok()) {
+      return absl::Status(
+          status.code(),
+          absl::StrCat("Warm-up of batch size ", batch_size,
+                       " failed: ", status.message()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace serving
 }  // namespace tensorflow
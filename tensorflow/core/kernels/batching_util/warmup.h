@@ -16,16 +16,23 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_WARMUP_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_WARMUP_H_
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/hash/hash.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tsl/platform/logging.h"
 
@@ -126,6 +133,37 @@ WarmupStateRegistry& GetGlobalWarmupStateRegistry();
 // based on the state of WarmupStateRegistry.
 bool ShouldWarmupAllBatchSizes(const OpKernelContext* c);
 
+// Describes an input of a model, for synthesizing warm-up inputs.
+struct WarmupInputSpec {
+  DataType dtype = DT_INVALID;
+  // The 0th dimension is the batch dimension, and is replaced by the batch
+  // size. Other unknown dimensions are set to 1.
+  PartialTensorShape shape;
+};
+
+// Returns zero-valued (or empty string) inputs of `batch_size` rows matching
+// `input_specs`.
+absl::StatusOr<std::vector<Tensor>> CreateWarmupInputs(
+    absl::Span<const WarmupInputSpec> input_specs, int64_t batch_size);
+
+// Warms up a model for every batch size in `batch_sizes` (typically the
+// `allowed_batch_sizes` of its batch ops), without the need for recorded
+// warm-up requests. For each batch size, calls `run_inputs` with synthetic
+// inputs created by CreateWarmupInputs(), while the model is registered as
+// warming up. This triggers the compilation (e.g. XLA or TF-TRT) and graph
+// specialization of each padded batch size before the model serves traffic;
+// with a persistent compilation cache (e.g. XLA's
+// --tf_xla_persistent_cache_directory), later loads reuse the results.
+//
+// Blocks until all batch sizes are warmed up, so that the caller can delay
+// model readiness until then. Returns the first error encountered.
+absl::Status WarmupBatchSizes(
+    const WarmupStateRegistry::Key& model_key,
+    absl::Span<const int32_t> batch_sizes,
+    absl::Span<const WarmupInputSpec> input_specs,
+    const std::function<absl::Status(const std::vector<Tensor>& inputs)>&
+        run_inputs);
+
 }  // namespace serving
 }  // namespace tensorflow
 
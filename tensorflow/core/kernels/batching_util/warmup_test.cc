@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/warmup.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::testing::ElementsAre;
+using ::tsl::testing::StatusIs;
+
+TEST(CreateWarmupInputsTest, Basic) {
+  std::vector<WarmupInputSpec> specs(2);
+  specs[0].dtype = DT_FLOAT;
+  specs[0].shape = PartialTensorShape({-1, -1, 3});
+  specs[1].dtype = DT_STRING;
+  specs[1].shape = PartialTensorShape({-1});
+  auto inputs = CreateWarmupInputs(specs, 4);
+  TF_ASSERT_OK(inputs.status());
+  ASSERT_EQ(inputs->size(), 2);
+  test::ExpectTensorEqual<float>(
+      (*inputs)[0], test::AsTensor<float>(std::vector<float>(12, 0.0f),
+                                          TensorShape({4, 1, 3})));
+  test::ExpectTensorEqual<tstring>(
+      (*inputs)[1],
+      test::AsTensor<tstring>({"", "", "", ""}, TensorShape({4})));
+}
+
+TEST(CreateWarmupInputsTest, InvalidSpecs) {
+  std::vector<WarmupInputSpec> specs(1);
+  specs[0].dtype = DT_FLOAT;
+  specs[0].shape = PartialTensorShape({});
+  EXPECT_THAT(CreateWarmupInputs(specs, 4).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+
+  specs[0].dtype = DT_VARIANT;
+  specs[0].shape = PartialTensorShape({-1});
+  EXPECT_THAT(CreateWarmupInputs(specs, 4).status(),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(WarmupBatchSizesTest, RunsAllBatchSizesInWarmupState) {
+  const WarmupStateRegistry::Key key("model", 1);
+  std::vector<WarmupInputSpec> specs(1);
+  specs[0].dtype = DT_INT32;
+  specs[0].shape = PartialTensorShape({-1, 2});
+  std::vector<int64_t> batch_sizes;
+  TF_ASSERT_OK(WarmupBatchSizes(
+      key, {2, 4, 8}, specs, [&](const std::vector<Tensor>& inputs) {
+        EXPECT_NE(GetGlobalWarmupStateRegistry().Lookup(key), nullptr);
+        batch_sizes.push_back(inputs[0].dim_size(0));
+        return absl::OkStatus();
+      }));
+  EXPECT_THAT(batch_sizes, ElementsAre(2, 4, 8));
+  // The model leaves the warm-up state afterwards.
+  EXPECT_EQ(GetGlobalWarmupStateRegistry().Lookup(key), nullptr);
+}
+
+TEST(WarmupBatchSizesTest, StopsAtFirstError) {
+  const WarmupStateRegistry::Key key("model", 2);
+  std::vector<WarmupInputSpec> specs(1);
+  specs[0].dtype = DT_INT32;
+  specs[0].shape = PartialTensorShape({-1});
+  int num_runs = 0;
+  EXPECT_THAT(
+      WarmupBatchSizes(key, {2, 4, 8}, specs,
+                       [&](const std::vector<Tensor>& inputs) {
+                         ++num_runs;
+                         return absl::InternalError("compilation failed");
+                       }),
+      StatusIs(absl::StatusCode::kInternal));
+  EXPECT_EQ(num_runs, 1);
+  EXPECT_EQ(GetGlobalWarmupStateRegistry().Lookup(key), nullptr);
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shared_tensor_store.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -86,6 +87,9 @@ ConstantOp::ConstantOp(OpKernelConstruction* ctx)
       errors::InvalidArgument("Type mismatch between value (",
                               DataTypeString(tensor_.dtype()), ") and dtype (",
                               DataTypeString(ctx->output_type(0)), ")"));
+  if (SharedTensorStore::Enabled() && ctx->device_type() == DEVICE_CPU) {
+    tensor_ = SharedTensorStore::Global()->Intern(tensor_);
+  }
 }
 
 void ConstantOp::Compute(OpKernelContext* ctx) {
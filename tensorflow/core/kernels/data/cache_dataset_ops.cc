@@ -22,6 +22,8 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/core/data/file_cache_store.h"
+#include "tensorflow/core/data/hash_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -35,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -50,6 +53,8 @@ namespace data {
 /* static */ constexpr const char* const CacheDatasetOp::kFileName;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputTypes;
 /* static */ constexpr const char* const CacheDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const CacheDatasetOp::kContentAddressed;
+/* static */ constexpr const char* const CacheDatasetOp::kMaxCacheBytes;
 
 namespace {
 
@@ -68,6 +73,8 @@ constexpr char kCacheCompleted[] = "cache_completed";
 constexpr char kIndex[] = "index";
 constexpr char kImpl[] = "Impl";
 constexpr char kCacheDataset[] = "CacheDataset";
+// The prefix of the cache files in an entry of a `FileCacheStore`.
+constexpr char kCacheFilePrefix[] = "cache";
 constexpr char kIncompleteCacheErrorMessage[] =
     "The calling iterator did not fully read the dataset being cached. In "
     "order to avoid unexpected truncation of the dataset, the partially cached "
@@ -137,11 +144,16 @@ class PartialCache {
 
 class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  public:
+  // If `store` is set, `filename` is a prefix in its entry `entry_dir`.
   FileDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
-                  string filename, Env* env)
+                  string filename, Env* env,
+                  std::unique_ptr<FileCacheStore> store = nullptr,
+                  string entry_dir = "")
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         filename_(std::move(filename)),
+        store_(std::move(store)),
+        entry_dir_(std::move(entry_dir)),
         env_(env),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
@@ -193,6 +205,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
  protected:
   const DatasetBase* const input_;
   const tstring filename_;
+  const std::unique_ptr<FileCacheStore> store_;
+  const string entry_dir_;
 
  private:
   static size_t StringPaddingSize(size_t num_tensors) {
@@ -215,6 +229,13 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       } else {
         mode_ = Mode::write;
       }
+      if (params.dataset->store_ != nullptr) {
+        Status s = params.dataset->store_->Touch(params.dataset->entry_dir_);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to mark the cache entry "
+                       << params.dataset->entry_dir_ << " as used: " << s;
+        }
+      }
     }
 
     Status Initialize(IteratorContext* ctx) override {
@@ -298,7 +319,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
             iteration_completed_(false) {}
 
       ~FileWriterIterator() override {
-        if (!dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
+        if (!pass_through_ &&
+            !dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
           LOG(WARNING) << kIncompleteCacheErrorMessage;
           std::vector<string> cache_files;
           Status s = dataset()->env_->GetMatchingPaths(
@@ -331,6 +353,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         if (*end_of_sequence) {
           return OkStatus();
         }
+        if (pass_through_) {
+          return input_impl_->GetNext(ctx, out_tensors, end_of_sequence);
+        }
         TF_RETURN_IF_ERROR(writer_->status());
         if (cur_index_ >= kMaxItems) {
           // As a courtesy, close the [truncated] cache file.
@@ -455,13 +480,25 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           *end_of_sequence = true;
           return OkStatus();
         }
-        if (lockfile_created_) {
+        if (lockfile_created_ || pass_through_) {
           return OkStatus();
         }
 
         // Perform rudimentary locking to help catch concurrent writes to the
         // same cache files.
 
+        // In a store shared by several jobs, another job may be writing the
+        // same entry. Let it, and pass the elements through in the meantime.
+        if (dataset()->store_ != nullptr &&
+            (dataset()->env_->FileExists(MetaFilename(filename_)).ok() ||
+             dataset()->env_->FileExists(lockfile_).ok())) {
+          LOG(INFO) << "Another iterator is writing the cache entry "
+                    << dataset()->entry_dir_
+                    << ". Passing the elements through without caching them.";
+          pass_through_ = true;
+          return OkStatus();
+        }
+
         // 1. Check that a checkpoint for the shard has not already been
         // written.
         if (dataset()->env_->FileExists(MetaFilename(filename_)).ok()) {
@@ -537,6 +574,14 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           TF_RETURN_IF_ERROR(dataset()->env_->DeleteFile(
               strings::StrCat(dataset()->filename_, "_", i, kLockFileSuffix)));
         }
+        if (dataset()->store_ != nullptr) {
+          // Make room for the new entry in the store.
+          Status s =
+              dataset()->store_->EvictLeastRecentlyUsed(dataset()->entry_dir_);
+          if (!s.ok()) {
+            LOG(WARNING) << "Failed to evict cache entries: " << s;
+          }
+        }
         return OkStatus();
       }
 
@@ -553,6 +598,9 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       string lockfile_ TF_GUARDED_BY(mu_);
       bool lockfile_created_ TF_GUARDED_BY(mu_);
       bool iteration_completed_ TF_GUARDED_BY(mu_);
+      // Whether another iterator is writing the cache entry, in which case
+      // this one forwards the input elements without caching them.
+      bool pass_through_ TF_GUARDED_BY(mu_) = false;
     };  // FileWriterIterator
 
     class FileReaderIterator : public DatasetIterator<FileDatasetBase> {
@@ -706,7 +754,20 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
                          string filename, Env* env,
                          const Tensor& resource_handle)
       : FileDatasetBase(ctx, input, filename, env),
-        resource_handle_(resource_handle) {}
+        resource_handle_(resource_handle),
+        cache_dir_(filename),
+        max_cache_bytes_(0) {}
+
+  // Caches the input in `store`, which is rooted in `cache_dir`.
+  FileDatasetV2(OpKernelContext* ctx, const DatasetBase* input,
+                string filename, Env* env, const Tensor& resource_handle,
+                std::unique_ptr<FileCacheStore> store, string entry_dir,
+                string cache_dir, int64_t max_cache_bytes)
+      : FileDatasetBase(ctx, input, std::move(filename), env, std::move(store),
+                        std::move(entry_dir)),
+        resource_handle_(resource_handle),
+        cache_dir_(std::move(cache_dir)),
+        max_cache_bytes_(max_cache_bytes) {}
 
  protected:
   Status AsGraphDefInternal(SerializationContext* ctx,
@@ -715,16 +776,26 @@ class CacheDatasetOp::FileDatasetV2 : public CacheDatasetOp::FileDatasetBase {
     Node* input_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_node));
     Node* filename_node = nullptr;
-    TF_RETURN_IF_ERROR(b->AddScalar(filename_, &filename_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(tstring(cache_dir_), &filename_node));
     Node* resource_handle_node = nullptr;
     TF_RETURN_IF_ERROR(b->AddTensor(resource_handle_, &resource_handle_node));
+    AttrValue content_addressed;
+    b->BuildAttrValue(store_ != nullptr, &content_addressed);
+    AttrValue max_cache_bytes;
+    b->BuildAttrValue(max_cache_bytes_, &max_cache_bytes);
     TF_RETURN_IF_ERROR(b->AddDataset(
-        this, {input_node, filename_node, resource_handle_node}, output));
+        this, {input_node, filename_node, resource_handle_node},
+        {{kContentAddressed, content_addressed},
+         {kMaxCacheBytes, max_cache_bytes}},
+        output));
     return OkStatus();
   }
 
  private:
   const Tensor resource_handle_;
+  // The `filename` input of the op.
+  const string cache_dir_;
+  const int64_t max_cache_bytes_;
 };
 
 class CacheDatasetOp::MemoryDatasetBase : public DatasetBase {
@@ -1114,7 +1185,12 @@ class CacheDatasetOp::MemoryDatasetV2
 
 CacheDatasetOp::CacheDatasetOp(OpKernelConstruction* ctx)
     : UnaryDatasetOpKernel(ctx),
-      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {}
+      op_version_(ctx->def().op() == kCacheDataset ? 1 : 2) {
+  if (op_version_ == 2) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kContentAddressed, &content_addressed_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMaxCacheBytes, &max_cache_bytes_));
+  }
+}
 
 void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                                  DatasetBase** output) {
@@ -1162,7 +1238,26 @@ void CacheDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
       *output = new MemoryDataset(ctx, input, manager, std::move(handle));
     }
   } else {
-    if (op_version_ == 2) {
+    if (op_version_ == 2 && content_addressed_) {
+      // Key the cache by the fingerprint of the input pipeline.
+      GraphDef graph_def;
+      SerializationContext::Params params(ctx);
+      std::vector<std::pair<string, Tensor>> input_list;
+      params.input_list = &input_list;
+      params.external_state_policy = ExternalStatePolicy::POLICY_IGNORE;
+      OP_REQUIRES_OK(
+          ctx, AsGraphDef(input, SerializationContext(params), &graph_def));
+      uint64 hash;
+      OP_REQUIRES_OK(ctx, HashGraph(graph_def, &hash));
+      auto store = std::make_unique<FileCacheStore>(ctx->env(), filename,
+                                                    max_cache_bytes_);
+      StatusOr<string> entry_dir = store->GetEntry(hash);
+      OP_REQUIRES_OK(ctx, entry_dir.status());
+      string prefix = io::JoinPath(*entry_dir, kCacheFilePrefix);
+      *output = new FileDatasetV2(ctx, input, std::move(prefix), ctx->env(),
+                                  ctx->input(2), std::move(store), *entry_dir,
+                                  filename, max_cache_bytes_);
+    } else if (op_version_ == 2) {
       *output =
           new FileDatasetV2(ctx, input, filename, ctx->env(), ctx->input(2));
     } else {
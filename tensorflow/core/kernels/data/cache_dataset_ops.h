@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_CACHE_DATASET_OPS_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_CACHE_DATASET_OPS_H_
 
+#include <cstdint>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -30,6 +32,8 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kFileName = "filename";
   static constexpr const char* const kOutputTypes = "output_types";
   static constexpr const char* const kOutputShapes = "output_shapes";
+  static constexpr const char* const kContentAddressed = "content_addressed";
+  static constexpr const char* const kMaxCacheBytes = "max_cache_bytes";
 
   explicit CacheDatasetOp(OpKernelConstruction* ctx);
 
@@ -44,6 +48,9 @@ class CacheDatasetOp : public UnaryDatasetOpKernel {
   class MemoryDatasetV2;
 
   const int op_version_;
+  // Only set for `CacheDatasetV2`.
+  bool content_addressed_ = false;
+  int64_t max_cache_bytes_ = 0;
 };
 
 }  // namespace data
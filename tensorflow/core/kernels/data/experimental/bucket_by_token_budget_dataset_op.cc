@@ -0,0 +1,582 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_token_budget_dataset_op.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/batch_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
+// description of the following op.
+
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kDatasetType;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kInputDataset;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kBucketBoundaries;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kMaxTokens;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kLookahead;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kPaddingValues;
+/* static */ constexpr const char* const BucketByTokenBudgetDatasetOp::kRagged;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kToutputTypes;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const
+    BucketByTokenBudgetDatasetOp::kOutputShapes;
+
+namespace {
+
+constexpr char kExhausted[] = "exhausted";
+constexpr char kBucketSize[] = "bucket_size";
+constexpr char kElementSize[] = "element_size";
+constexpr char kElement[] = "element";
+
+}  // namespace
+
+class BucketByTokenBudgetDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input,
+          std::vector<int64_t> bucket_boundaries, int64_t max_tokens,
+          int64_t lookahead, std::vector<Tensor> padding_values, bool ragged,
+          const DataTypeVector& output_types,
+          const std::vector<PartialTensorShape>& output_shapes)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        max_tokens_(max_tokens),
+        lookahead_(lookahead),
+        padding_values_(std::move(padding_values)),
+        ragged_(ragged),
+        output_types_(output_types),
+        output_shapes_(output_shapes),
+        traceme_metadata_(
+            {{"max_tokens",
+              strings::Printf("%lld", static_cast<long long>(max_tokens))},
+             {"lookahead",
+              strings::Printf("%lld", static_cast<long long>(lookahead))},
+             {"num_buckets",
+              strings::Printf("%lld", static_cast<long long>(
+                                          bucket_boundaries_.size() + 1))},
+             {"ragged", ragged ? "true" : "false"}}) {
+    input_->Ref();
+  }
+
+  ~Dataset() override { input_->Unref(); }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(Iterator::Params{
+        this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+  }
+
+  const DataTypeVector& output_dtypes() const override { return output_types_; }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return output_shapes_;
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(max_tokens_, lookahead_);
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    int64_t n = input_->Cardinality(options);
+    if (n == kInfiniteCardinality) {
+      return n;
+    }
+    return kUnknownCardinality;
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* bucket_boundaries = nullptr;
+    TF_RETURN_IF_ERROR(b->AddVector(bucket_boundaries_, &bucket_boundaries));
+    Node* max_tokens = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(max_tokens_, &max_tokens));
+    Node* lookahead = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(lookahead_, &lookahead));
+    std::vector<Node*> padding_values;
+    padding_values.reserve(padding_values_.size());
+    for (const Tensor& t : padding_values_) {
+      Node* node;
+      TF_RETURN_IF_ERROR(b->AddTensor(t, &node));
+      padding_values.emplace_back(node);
+    }
+    AttrValue ragged;
+    b->BuildAttrValue(ragged_, &ragged);
+    AttrValue toutput_types;
+    b->BuildAttrValue(input_->output_dtypes(), &toutput_types);
+    TF_RETURN_IF_ERROR(b->AddDataset(
+        this,
+        {{0, input_graph_node},
+         {1, bucket_boundaries},
+         {2, max_tokens},
+         {3, lookahead}},
+        {{4, padding_values}},
+        {{kRagged, ragged}, {kToutputTypes, toutput_types}}, output));
+    return OkStatus();
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    explicit Iterator(const Params& params)
+        : DatasetIterator<Dataset>(params),
+          buckets_(params.dataset->bucket_boundaries_.size() + 1) {}
+
+    Status Initialize(IteratorContext* ctx) override {
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      std::vector<std::vector<Tensor>> batch;
+      {
+        mutex_lock l(mu_);
+        while (batch.empty()) {
+          if (!input_impl_) {
+            // Flush the remaining buckets, in order.
+            for (int i = 0; i < buckets_.size() && batch.empty(); ++i) {
+              if (!buckets_[i].elements.empty()) {
+                batch = TakeBucket(i);
+              }
+            }
+            if (batch.empty()) {
+              *end_of_sequence = true;
+              return OkStatus();
+            }
+            break;
+          }
+          std::vector<Tensor> element;
+          bool end_of_input = false;
+          TF_RETURN_IF_ERROR(
+              input_impl_->GetNext(ctx, &element, &end_of_input));
+          if (end_of_input) {
+            input_impl_.reset();
+            continue;
+          }
+          TF_RETURN_IF_ERROR(AddElement(std::move(element), &batch));
+        }
+        int64_t max_length = 0;
+        for (const auto& element : batch) {
+          max_length = std::max(max_length, Length(element));
+          num_tokens_ += Length(element);
+        }
+        num_padded_tokens_ += batch.size() * max_length;
+      }
+      *end_of_sequence = false;
+      if (dataset()->ragged_) {
+        return CopyRaggedBatch(ctx, batch, out_tensors);
+      }
+      return CopyPaddedBatch(ctx, batch, out_tensors);
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeUnknownRatioNode(std::move(args));
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kExhausted, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      for (int i = 0; i < buckets_.size(); ++i) {
+        const auto& elements = buckets_[i].elements;
+        const std::string bucket_prefix =
+            strings::StrCat(prefix(), "[", i, "]");
+        TF_RETURN_IF_ERROR(writer->WriteScalar(bucket_prefix, kBucketSize,
+                                               elements.size()));
+        for (int j = 0; j < elements.size(); ++j) {
+          const std::string element_prefix =
+              strings::StrCat(bucket_prefix, "[", j, "]");
+          TF_RETURN_IF_ERROR(writer->WriteScalar(element_prefix, kElementSize,
+                                                 elements[j].size()));
+          for (int k = 0; k < elements[j].size(); ++k) {
+            TF_RETURN_IF_ERROR(writer->WriteTensor(
+                element_prefix, strings::StrCat(kElement, "[", k, "]"),
+                elements[j][k]));
+          }
+        }
+      }
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t input_exhausted;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kExhausted, &input_exhausted));
+      if (static_cast<bool>(input_exhausted)) {
+        input_impl_.reset();
+      } else {
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      }
+      num_buffered_ = 0;
+      for (int i = 0; i < buckets_.size(); ++i) {
+        Bucket& bucket = buckets_[i];
+        const std::string bucket_prefix =
+            strings::StrCat(prefix(), "[", i, "]");
+        int64_t bucket_size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(bucket_prefix, kBucketSize, &bucket_size));
+        bucket.elements.clear();
+        bucket.elements.resize(bucket_size);
+        bucket.max_length = 0;
+        for (int j = 0; j < bucket_size; ++j) {
+          const std::string element_prefix =
+              strings::StrCat(bucket_prefix, "[", j, "]");
+          int64_t element_size;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(element_prefix, kElementSize, &element_size));
+          std::vector<Tensor>& element = bucket.elements[j];
+          element.resize(element_size);
+          for (int k = 0; k < element_size; ++k) {
+            TF_RETURN_IF_ERROR(reader->ReadTensor(
+                ctx->flr(), element_prefix,
+                strings::StrCat(kElement, "[", k, "]"), &element[k]));
+          }
+          bucket.max_length = std::max(bucket.max_length, Length(element));
+        }
+        num_buffered_ += bucket_size;
+      }
+      return OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      double padding_fraction = -1;
+      // NOTE: We only report the padding if the lock can be acquired right
+      // away to avoid introducing tracing overhead.
+      if (mu_.try_lock()) {
+        if (num_padded_tokens_ > 0) {
+          padding_fraction =
+              1.0 - static_cast<double>(num_tokens_) / num_padded_tokens_;
+        }
+        mu_.unlock();
+      }
+      auto result = dataset()->traceme_metadata_;
+      result.push_back(std::make_pair(
+          "padding_fraction", padding_fraction == -1
+                                  ? kTraceInfoUnavailable
+                                  : strings::Printf("%.3f", padding_fraction)));
+      return result;
+    }
+
+   private:
+    // The elements buffered for a range of lengths.
+    struct Bucket {
+      std::vector<std::vector<Tensor>> elements;
+      // The length of the longest element in `elements`.
+      int64_t max_length = 0;
+    };
+
+    static int64_t Length(const std::vector<Tensor>& element) {
+      return element[0].dim_size(0);
+    }
+
+    int BucketIndex(int64_t length) const {
+      const auto& boundaries = dataset()->bucket_boundaries_;
+      return std::upper_bound(boundaries.begin(), boundaries.end(), length) -
+             boundaries.begin();
+    }
+
+    // Adds `element` to its bucket. If that takes a bucket over the token
+    // budget or the lookahead window, returns the batch to emit in `batch`.
+    Status AddElement(std::vector<Tensor> element,
+                      std::vector<std::vector<Tensor>>* batch)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int i = 0; i < element.size(); ++i) {
+        if ((i == 0 || dataset()->ragged_) && element[i].dims() == 0) {
+          return errors::InvalidArgument(
+              "Component ", i,
+              " of the input elements must have at least one dimension, but "
+              "got a scalar.");
+        }
+      }
+      const int64_t length = Length(element);
+      const int index = BucketIndex(length);
+      Bucket& bucket = buckets_[index];
+      if (!bucket.elements.empty() &&
+          (bucket.elements.size() + 1) * std::max(bucket.max_length, length) >
+              dataset()->max_tokens_) {
+        *batch = TakeBucket(index);
+      }
+      bucket.elements.push_back(std::move(element));
+      bucket.max_length = std::max(bucket.max_length, length);
+      ++num_buffered_;
+      if (batch->empty() && num_buffered_ > dataset()->lookahead_) {
+        *batch = TakeBucket(FullestBucket());
+      }
+      return OkStatus();
+    }
+
+    // Returns the index of the bucket holding the most tokens.
+    int FullestBucket() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int fullest = 0;
+      int64_t max_num_tokens = -1;
+      for (int i = 0; i < buckets_.size(); ++i) {
+        const int64_t num_tokens =
+            buckets_[i].elements.size() * buckets_[i].max_length;
+        if (num_tokens > max_num_tokens) {
+          fullest = i;
+          max_num_tokens = num_tokens;
+        }
+      }
+      return fullest;
+    }
+
+    std::vector<std::vector<Tensor>> TakeBucket(int index)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      Bucket& bucket = buckets_[index];
+      std::vector<std::vector<Tensor>> batch = std::move(bucket.elements);
+      bucket.elements.clear();
+      bucket.max_length = 0;
+      num_buffered_ -= batch.size();
+      return batch;
+    }
+
+    // Pads each component of the batch elements to the largest element in
+    // every dimension, and stacks them into one output tensor per component.
+    Status CopyPaddedBatch(IteratorContext* ctx,
+                           const std::vector<std::vector<Tensor>>& batch,
+                           std::vector<Tensor>* out_tensors) {
+      const int64_t num_batch_elements = batch.size();
+      for (int component_index = 0; component_index < batch[0].size();
+           ++component_index) {
+        const int rank = batch[0][component_index].dims();
+        TensorShape batch_component_shape({num_batch_elements});
+        for (int dim = 0; dim < rank; ++dim) {
+          TF_RETURN_IF_ERROR(batch_component_shape.AddDimWithStatus(0));
+        }
+        for (const auto& element : batch) {
+          const TensorShape& element_shape = element[component_index].shape();
+          if (element_shape.dims() != rank) {
+            return errors::InvalidArgument(
+                "All elements in a batch must have the same rank for "
+                "component ",
+                component_index, ": expected rank ", rank,
+                " but got element with rank ", element_shape.dims());
+          }
+          for (int dim = 0; dim < rank; ++dim) {
+            batch_component_shape.set_dim(
+                dim + 1, std::max(batch_component_shape.dim_size(dim + 1),
+                                  element_shape.dim_size(dim)));
+          }
+        }
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  batch[0][component_index].dtype(),
+                                  batch_component_shape);
+        Tensor& batch_component = out_tensors->back();
+        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
+            &batch_component, dataset()->padding_values_[component_index]));
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
+              batch[i][component_index], &batch_component, i));
+        }
+      }
+      return OkStatus();
+    }
+
+    // Concatenates each component of the batch elements along their first
+    // dimension, and emits it along with the row splits of the elements.
+    Status CopyRaggedBatch(IteratorContext* ctx,
+                           const std::vector<std::vector<Tensor>>& batch,
+                           std::vector<Tensor>* out_tensors) {
+      const int64_t num_batch_elements = batch.size();
+      for (int component_index = 0; component_index < batch[0].size();
+           ++component_index) {
+        const TensorShape& first_shape = batch[0][component_index].shape();
+        Tensor row_splits(DT_INT64, TensorShape({num_batch_elements + 1}));
+        auto row_splits_t = row_splits.vec<int64_t>();
+        row_splits_t(0) = 0;
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          const TensorShape& element_shape = batch[i][component_index].shape();
+          bool same_inner_shape = element_shape.dims() == first_shape.dims();
+          for (int dim = 1; same_inner_shape && dim < first_shape.dims();
+               ++dim) {
+            same_inner_shape =
+                element_shape.dim_size(dim) == first_shape.dim_size(dim);
+          }
+          if (!same_inner_shape) {
+            return errors::InvalidArgument(
+                "All elements in a ragged batch must have the same shape "
+                "beyond the first dimension for component ",
+                component_index, ": expected ", first_shape.DebugString(),
+                " but got ", element_shape.DebugString());
+          }
+          row_splits_t(i + 1) = row_splits_t(i) + element_shape.dim_size(0);
+        }
+        TensorShape values_shape = first_shape;
+        values_shape.set_dim(0, row_splits_t(num_batch_elements));
+        out_tensors->emplace_back(ctx->allocator({}),
+                                  batch[0][component_index].dtype(),
+                                  values_shape);
+        Tensor& values = out_tensors->back();
+        for (int64_t i = 0; i < num_batch_elements; ++i) {
+          const Tensor& element = batch[i][component_index];
+          if (element.dim_size(0) > 0) {
+            TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+                element, /*src_offset=*/0, /*dst_offset=*/row_splits_t(i),
+                element.dim_size(0), &values));
+          }
+        }
+        out_tensors->push_back(std::move(row_splits));
+      }
+      return OkStatus();
+    }
+
+    mutable mutex mu_;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    std::vector<Bucket> buckets_ TF_GUARDED_BY(mu_);
+    // The number of elements in `buckets_`.
+    int64_t num_buffered_ TF_GUARDED_BY(mu_) = 0;
+    // The number of tokens emitted, without and with padding.
+    int64_t num_tokens_ TF_GUARDED_BY(mu_) = 0;
+    int64_t num_padded_tokens_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* const input_;
+  const std::vector<int64_t> bucket_boundaries_;
+  const int64_t max_tokens_;
+  const int64_t lookahead_;
+  const std::vector<Tensor> padding_values_;
+  const bool ragged_;
+  const DataTypeVector output_types_;
+  const std::vector<PartialTensorShape> output_shapes_;
+  const TraceMeMetadata traceme_metadata_;
+};
+
+BucketByTokenBudgetDatasetOp::BucketByTokenBudgetDatasetOp(
+    OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kRagged, &ragged_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+}
+
+void BucketByTokenBudgetDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                               DatasetBase* input,
+                                               DatasetBase** output) {
+  const Tensor* bucket_boundaries_tensor;
+  OP_REQUIRES_OK(ctx, ctx->input(kBucketBoundaries, &bucket_boundaries_tensor));
+  OP_REQUIRES(
+      ctx, TensorShapeUtils::IsVector(bucket_boundaries_tensor->shape()),
+      errors::InvalidArgument("`bucket_boundaries` must be a vector."));
+  std::vector<int64_t> bucket_boundaries;
+  bucket_boundaries.reserve(bucket_boundaries_tensor->NumElements());
+  for (int64_t i = 0; i < bucket_boundaries_tensor->NumElements(); ++i) {
+    const int64_t boundary = bucket_boundaries_tensor->vec<int64_t>()(i);
+    OP_REQUIRES(ctx, i == 0 || boundary > bucket_boundaries.back(),
+                errors::InvalidArgument(
+                    "`bucket_boundaries` must be strictly increasing."));
+    bucket_boundaries.push_back(boundary);
+  }
+
+  int64_t max_tokens;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kMaxTokens, &max_tokens));
+  OP_REQUIRES(ctx, max_tokens > 0,
+              errors::InvalidArgument("`max_tokens` must be positive."));
+
+  int64_t lookahead;
+  OP_REQUIRES_OK(ctx,
+                 ParseScalarArgument<int64_t>(ctx, kLookahead, &lookahead));
+  OP_REQUIRES(ctx, lookahead > 0,
+              errors::InvalidArgument("`lookahead` must be positive."));
+
+  const int64_t num_components = input->output_dtypes().size();
+  OpInputList padding_values_list;
+  OP_REQUIRES_OK(ctx, ctx->input_list(kPaddingValues, &padding_values_list));
+  OP_REQUIRES(ctx, padding_values_list.size() == num_components,
+              errors::InvalidArgument(
+                  "Number of padding values (", padding_values_list.size(),
+                  ") must match the number of components in the input "
+                  "dataset's elements (",
+                  num_components, ")"));
+  std::vector<Tensor> padding_values;
+  for (int i = 0; i < padding_values_list.size(); ++i) {
+    const Tensor& padding_value_t = padding_values_list[i];
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(padding_value_t.shape()),
+                errors::InvalidArgument("All padding values must be scalars"));
+    OP_REQUIRES(ctx, padding_value_t.dtype() == input->output_dtypes()[i],
+                errors::InvalidArgument(
+                    "Mismatched type between padding value ", i,
+                    " and input dataset's component ", i, ": ",
+                    DataTypeString(padding_value_t.dtype()), " vs. ",
+                    DataTypeString(input->output_dtypes()[i])));
+    padding_values.push_back(tensor::DeepCopy(padding_value_t));
+  }
+
+  const int64_t num_outputs = ragged_ ? 2 * num_components : num_components;
+  OP_REQUIRES(ctx, output_types_.size() == num_outputs,
+              errors::InvalidArgument(
+                  "Expected ", num_outputs, " output types for ",
+                  num_components, " input components, but got ",
+                  output_types_.size()));
+
+  *output = new Dataset(ctx, input, std::move(bucket_boundaries), max_tokens,
+                        lookahead, std::move(padding_values), ragged_,
+                        output_types_, output_shapes_);
+}
+
+namespace {
+
+REGISTER_KERNEL_BUILDER(Name("BucketByTokenBudgetDataset").Device(DEVICE_CPU),
+                        BucketByTokenBudgetDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
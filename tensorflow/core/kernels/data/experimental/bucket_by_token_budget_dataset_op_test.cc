@@ -0,0 +1,321 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/bucket_by_token_budget_dataset_op.h"
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "bucket_by_token_budget_dataset";
+
+class BucketByTokenBudgetDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  BucketByTokenBudgetDatasetParams(
+      T input_dataset_params, std::vector<int64_t> bucket_boundaries,
+      int64_t max_tokens, int64_t lookahead,
+      std::vector<Tensor> padding_values, bool ragged,
+      DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        bucket_boundaries_(std::move(bucket_boundaries)),
+        max_tokens_(max_tokens),
+        lookahead_(lookahead),
+        padding_values_(std::move(padding_values)),
+        ragged_(ragged) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors = {
+        CreateTensor<int64_t>(
+            TensorShape({static_cast<int64_t>(bucket_boundaries_.size())}),
+            bucket_boundaries_),
+        CreateTensor<int64_t>(TensorShape({}), {max_tokens_}),
+        CreateTensor<int64_t>(TensorShape({}), {lookahead_})};
+    for (const Tensor& padding_value : padding_values_) {
+      input_tensors.push_back(padding_value);
+    }
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {BucketByTokenBudgetDatasetOp::kInputDataset,
+                    BucketByTokenBudgetDatasetOp::kBucketBoundaries,
+                    BucketByTokenBudgetDatasetOp::kMaxTokens,
+                    BucketByTokenBudgetDatasetOp::kLookahead};
+    for (int i = 0; i < padding_values_.size(); ++i) {
+      input_names->emplace_back(strings::StrCat(
+          BucketByTokenBudgetDatasetOp::kPaddingValues, "_", i));
+    }
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    DataTypeVector toutput_types;
+    for (const Tensor& padding_value : padding_values_) {
+      toutput_types.push_back(padding_value.dtype());
+    }
+    *attr_vector = {{"ragged", ragged_},
+                    {"Toutput_types", toutput_types},
+                    {"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return BucketByTokenBudgetDatasetOp::kDatasetType;
+  }
+
+ private:
+  std::vector<int64_t> bucket_boundaries_;
+  int64_t max_tokens_;
+  int64_t lookahead_;
+  std::vector<Tensor> padding_values_;
+  bool ragged_;
+};
+
+class BucketByTokenBudgetDatasetOpTest : public DatasetOpsTestBase {};
+
+// Returns elements of lengths 3, 3, 1, 1, 3, 1.
+ConcatenateDatasetParams VariableLengthInput() {
+  auto concatenate_dataset_params_0 = ConcatenateDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/CreateTensors<int64_t>(TensorShape{2, 3},
+                                                {{1, 2, 3, 4, 5, 6}}),
+          /*node_name=*/"tensor_slice_0"),
+      TensorSliceDatasetParams(
+          /*components=*/CreateTensors<int64_t>(TensorShape{2, 1}, {{7, 8}}),
+          /*node_name=*/"tensor_slice_1"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/"concatenate_0");
+  auto concatenate_dataset_params_1 = ConcatenateDatasetParams(
+      TensorSliceDatasetParams(
+          /*components=*/CreateTensors<int64_t>(TensorShape{1, 3},
+                                                {{9, 10, 11}}),
+          /*node_name=*/"tensor_slice_2"),
+      TensorSliceDatasetParams(
+          /*components=*/CreateTensors<int64_t>(TensorShape{1, 1}, {{12}}),
+          /*node_name=*/"tensor_slice_3"),
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/"concatenate_1");
+  return ConcatenateDatasetParams(std::move(concatenate_dataset_params_0),
+                                  std::move(concatenate_dataset_params_1),
+                                  /*output_dtypes=*/{DT_INT64},
+                                  /*output_shapes=*/{PartialTensorShape({-1})},
+                                  /*node_name=*/"concatenate");
+}
+
+// Batches are emitted when they reach the token budget, or at the end of the
+// input.
+BucketByTokenBudgetDatasetParams DenseParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens=*/6,
+      /*lookahead=*/10,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketByTokenBudgetDatasetParams RaggedParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens=*/6,
+      /*lookahead=*/10,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*ragged=*/true,
+      /*output_dtypes=*/{DT_INT64, DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1}), PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+}
+
+// The lookahead window forces the fullest bucket out before it reaches the
+// token budget.
+BucketByTokenBudgetDatasetParams SmallLookaheadParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens=*/6,
+      /*lookahead=*/2,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+// A single bucket pads elements of different lengths together.
+BucketByTokenBudgetDatasetParams SingleBucketParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{},
+      /*max_tokens=*/9,
+      /*lookahead=*/10,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {-1})},
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketByTokenBudgetDatasetParams InvalidMaxTokensParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens=*/0,
+      /*lookahead=*/10,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketByTokenBudgetDatasetParams InvalidLookaheadParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{2},
+      /*max_tokens=*/6,
+      /*lookahead=*/0,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+BucketByTokenBudgetDatasetParams InvalidBucketBoundariesParams() {
+  return BucketByTokenBudgetDatasetParams(
+      VariableLengthInput(),
+      /*bucket_boundaries=*/{3, 2},
+      /*max_tokens=*/6,
+      /*lookahead=*/10,
+      /*padding_values=*/{CreateTensor<int64_t>(TensorShape{}, {0})},
+      /*ragged=*/false,
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1, -1})},
+      /*node_name=*/kNodeName);
+}
+
+std::vector<GetNextTestCase<BucketByTokenBudgetDatasetParams>>
+GetNextTestCases() {
+  return {{/*dataset_params=*/DenseParams(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 3}, {1, 2, 3, 4, 5, 6}),
+            CreateTensor<int64_t>(TensorShape{3, 1}, {7, 8, 12}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {9, 10, 11})}},
+          {/*dataset_params=*/RaggedParams(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{6}, {1, 2, 3, 4, 5, 6}),
+            CreateTensor<int64_t>(TensorShape{3}, {0, 3, 6}),
+            CreateTensor<int64_t>(TensorShape{3}, {7, 8, 12}),
+            CreateTensor<int64_t>(TensorShape{4}, {0, 1, 2, 3}),
+            CreateTensor<int64_t>(TensorShape{3}, {9, 10, 11}),
+            CreateTensor<int64_t>(TensorShape{2}, {0, 3})}},
+          {/*dataset_params=*/SmallLookaheadParams(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 3}, {1, 2, 3, 4, 5, 6}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {9, 10, 11}),
+            CreateTensor<int64_t>(TensorShape{3, 1}, {7, 8, 12})}},
+          {/*dataset_params=*/SingleBucketParams(),
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{3, 3},
+                                  {1, 2, 3, 4, 5, 6, 7, -1, -1}),
+            CreateTensor<int64_t>(TensorShape{3, 3},
+                                  {8, -1, -1, 9, 10, 11, 12, -1, -1})}}};
+}
+
+ITERATOR_GET_NEXT_TEST_P(BucketByTokenBudgetDatasetOpTest,
+                         BucketByTokenBudgetDatasetParams, GetNextTestCases())
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, DatasetNodeName) {
+  auto dataset_params = DenseParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetNodeName(dataset_params.node_name()));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, DatasetTypeString) {
+  auto dataset_params = DenseParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetTypeString(
+      name_utils::OpName(BucketByTokenBudgetDatasetOp::kDatasetType)));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, Cardinality) {
+  auto dataset_params = DenseParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckDatasetCardinality(kUnknownCardinality));
+}
+
+TEST_F(BucketByTokenBudgetDatasetOpTest, IteratorPrefix) {
+  auto dataset_params = DenseParams();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorPrefix(
+      name_utils::IteratorPrefix(BucketByTokenBudgetDatasetOp::kDatasetType,
+                                 dataset_params.iterator_prefix())));
+}
+
+std::vector<IteratorSaveAndRestoreTestCase<BucketByTokenBudgetDatasetParams>>
+IteratorSaveAndRestoreTestCases() {
+  return {{/*dataset_params=*/DenseParams(),
+           /*breakpoints=*/{0, 1, 3},
+           /*expected_outputs=*/
+           {CreateTensor<int64_t>(TensorShape{2, 3}, {1, 2, 3, 4, 5, 6}),
+            CreateTensor<int64_t>(TensorShape{3, 1}, {7, 8, 12}),
+            CreateTensor<int64_t>(TensorShape{1, 3}, {9, 10, 11})}}};
+}
+
+ITERATOR_SAVE_AND_RESTORE_TEST_P(BucketByTokenBudgetDatasetOpTest,
+                                 BucketByTokenBudgetDatasetParams,
+                                 IteratorSaveAndRestoreTestCases())
+
+class ParameterizedInvalidArgumentTest
+    : public BucketByTokenBudgetDatasetOpTest,
+      public ::testing::WithParamInterface<BucketByTokenBudgetDatasetParams> {
+};
+
+TEST_P(ParameterizedInvalidArgumentTest, InvalidArgument) {
+  auto dataset_params = GetParam();
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    BucketByTokenBudgetDatasetOpTest, ParameterizedInvalidArgumentTest,
+    ::testing::ValuesIn({InvalidMaxTokensParams(), InvalidLookaheadParams(),
+                         InvalidBucketBoundariesParams()}));
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -12,6 +12,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <cstring>
+
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
@@ -26,6 +28,46 @@ namespace data {
 namespace experimental {
 namespace {
 
+// Returns a word with every byte set to `c`.
+inline uint64 BroadcastByte(char c) {
+  return 0x0101010101010101ULL * static_cast<uint8>(c);
+}
+
+// Returns a nonzero value if any byte of `word` is zero.
+inline uint64 HasZeroByte(uint64 word) {
+  return (word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL;
+}
+
+// Returns the first byte in [begin, end) that is `delim`, '\n', '\r' or, if
+// `use_quote_delim`, '"', or `end` if there is none. These are the only bytes
+// that end or invalidate an unquoted field, so the bytes in between are
+// skipped eight at a time instead of being examined one by one.
+const char* FindUnquotedFieldEnd(const char* begin, const char* end,
+                                 char delim, bool use_quote_delim) {
+  const uint64 delims = BroadcastByte(delim);
+  const uint64 newlines = BroadcastByte('\n');
+  const uint64 returns = BroadcastByte('\r');
+  // Without quote delimiting, search for `delim` twice instead of for '"'.
+  const uint64 quotes = use_quote_delim ? BroadcastByte('"') : delims;
+  const char* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    memcpy(&word, p, sizeof(word));
+    if (HasZeroByte(word ^ delims) | HasZeroByte(word ^ newlines) |
+        HasZeroByte(word ^ returns) | HasZeroByte(word ^ quotes)) {
+      break;
+    }
+  }
+  for (; p < end; ++p) {
+    const char ch = *p;
+    if (ch == delim || ch == '\n' || ch == '\r' ||
+        (use_quote_delim && ch == '"')) {
+      return p;
+    }
+  }
+  return end;
+}
+
 class CSVDatasetOp : public DatasetOpKernel {
  public:
   explicit CSVDatasetOp(OpKernelConstruction* ctx)
@@ -508,7 +550,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter scans ahead, filling buffer if necessary
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -562,7 +604,12 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
 
           } else {
-            pos_++;
+            // Only a quote can end a quoted field, so skip to the next one.
+            const void* quote =
+                memchr(&buffer_[pos_], '"', buffer_.size() - pos_);
+            pos_ = quote == nullptr
+                       ? buffer_.size()
+                       : static_cast<const char*>(quote) - buffer_.data();
           }
         }
       }
@@ -641,7 +688,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter scans ahead, filling buffer if necessary
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -657,6 +704,13 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          pos_ = FindUnquotedFieldEnd(buffer_.data() + pos_,
+                                      buffer_.data() + buffer_.size(),
+                                      dataset()->delim_,
+                                      dataset()->use_quote_delim_) -
+                 buffer_.data();
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -0,0 +1,1037 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet/parquet_reader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/snappy.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kMagic[] = "PAR1";
+constexpr size_t kMagicSize = 4;
+
+// Column chunks separated by at most this many bytes are read at once.
+constexpr int64_t kMaxCoalescedGapBytes = 1 << 20;
+
+// Bounds the nesting of Thrift structs, which are decoded recursively.
+constexpr int kMaxThriftDepth = 64;
+
+// The Thrift compact protocol types.
+enum ThriftType {
+  kStop = 0,
+  kBoolTrue = 1,
+  kBoolFalse = 2,
+  kByte = 3,
+  kI16 = 4,
+  kI32 = 5,
+  kI64 = 6,
+  kDouble = 7,
+  kBinary = 8,
+  kList = 9,
+  kSet = 10,
+  kMap = 11,
+  kStruct = 12,
+};
+
+// The Parquet page types, encodings and compression codecs that are read.
+constexpr int32_t kDataPage = 0;
+constexpr int32_t kDictionaryPage = 2;
+constexpr int32_t kDataPageV2 = 3;
+constexpr int32_t kPlain = 0;
+constexpr int32_t kPlainDictionary = 2;
+constexpr int32_t kRleDictionary = 8;
+constexpr int32_t kUncompressed = 0;
+constexpr int32_t kSnappy = 1;
+constexpr int32_t kRepeated = 2;
+
+bool ReadUleb128(absl::string_view data, size_t* pos, uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64 && *pos < data.size(); shift += 7) {
+    const uint8_t byte = data[(*pos)++];
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Decodes the subset of the Thrift compact protocol that Parquet metadata
+// uses.
+class ThriftReader {
+ public:
+  explicit ThriftReader(absl::string_view data) : data_(data) {}
+
+  // The number of bytes decoded so far.
+  size_t position() const { return pos_; }
+
+  Status ReadI32(int32_t* value) {
+    int64_t result;
+    TF_RETURN_IF_ERROR(ReadI64(&result));
+    *value = static_cast<int32_t>(result);
+    return OkStatus();
+  }
+
+  Status ReadI64(int64_t* value) {
+    uint64_t zigzag;
+    if (!ReadUleb128(data_, &pos_, &zigzag)) {
+      return errors::DataLoss("Invalid varint in Parquet metadata");
+    }
+    *value = static_cast<int64_t>((zigzag >> 1) ^ (~(zigzag & 1) + 1));
+    return OkStatus();
+  }
+
+  Status ReadBinary(absl::string_view* value) {
+    uint64_t size;
+    if (!ReadUleb128(data_, &pos_, &size) || size > data_.size() - pos_) {
+      return errors::DataLoss("Invalid string in Parquet metadata");
+    }
+    *value = data_.substr(pos_, size);
+    pos_ += size;
+    return OkStatus();
+  }
+
+  // Calls `fn(field_id, type)` for each field of the struct that starts at
+  // the current position. `fn` must decode the value of the field, e.g. by
+  // skipping it. The values of boolean fields are their types.
+  Status ReadStruct(const std::function<Status(int16_t, int)>& fn) {
+    if (++depth_ > kMaxThriftDepth) {
+      return errors::DataLoss("Parquet metadata is nested too deeply");
+    }
+    int16_t field_id = 0;
+    while (true) {
+      uint8_t byte;
+      TF_RETURN_IF_ERROR(ReadByte(&byte));
+      if (byte == kStop) break;
+      const int type = byte & 0x0f;
+      if (byte >> 4 != 0) {
+        field_id += byte >> 4;
+      } else {
+        int32_t id;
+        TF_RETURN_IF_ERROR(ReadI32(&id));
+        field_id = id;
+      }
+      TF_RETURN_IF_ERROR(fn(field_id, type));
+    }
+    --depth_;
+    return OkStatus();
+  }
+
+  // Calls `fn(element_type)` for each element of the list, of type `type`,
+  // that starts at the current position. `fn` must decode the element.
+  Status ReadList(int type, const std::function<Status(int)>& fn) {
+    if (type != kList && type != kSet) {
+      return errors::DataLoss("Expected a list in Parquet metadata");
+    }
+    uint8_t byte;
+    TF_RETURN_IF_ERROR(ReadByte(&byte));
+    const int element_type = byte & 0x0f;
+    uint64_t size = byte >> 4;
+    if (size == 15 && !ReadUleb128(data_, &pos_, &size)) {
+      return errors::DataLoss("Invalid list in Parquet metadata");
+    }
+    // Every element takes at least a byte.
+    if (size > data_.size() - pos_) {
+      return errors::DataLoss("Invalid list in Parquet metadata");
+    }
+    for (uint64_t i = 0; i < size; ++i) {
+      TF_RETURN_IF_ERROR(fn(element_type));
+    }
+    return OkStatus();
+  }
+
+  // Skips a value of type `type`.
+  Status Skip(int type) { return Skip(type, /*in_container=*/false); }
+
+ private:
+  Status ReadByte(uint8_t* byte) {
+    if (pos_ >= data_.size()) {
+      return errors::DataLoss("Truncated Parquet metadata");
+    }
+    *byte = data_[pos_++];
+    return OkStatus();
+  }
+
+  Status SkipBytes(size_t n) {
+    if (n > data_.size() - pos_) {
+      return errors::DataLoss("Truncated Parquet metadata");
+    }
+    pos_ += n;
+    return OkStatus();
+  }
+
+  // Booleans in lists and maps take a byte, unlike boolean fields.
+  Status Skip(int type, bool in_container) {
+    switch (type) {
+      case kBoolTrue:
+      case kBoolFalse:
+        return in_container ? SkipBytes(1) : OkStatus();
+      case kByte:
+        return SkipBytes(1);
+      case kI16:
+      case kI32:
+      case kI64: {
+        int64_t unused;
+        return ReadI64(&unused);
+      }
+      case kDouble:
+        return SkipBytes(8);
+      case kBinary: {
+        absl::string_view unused;
+        return ReadBinary(&unused);
+      }
+      case kList:
+      case kSet:
+        return ReadList(type, [this](int element_type) {
+          return Skip(element_type, /*in_container=*/true);
+        });
+      case kMap: {
+        uint64_t size;
+        if (!ReadUleb128(data_, &pos_, &size)) {
+          return errors::DataLoss("Invalid map in Parquet metadata");
+        }
+        if (size == 0) return OkStatus();
+        uint8_t types;
+        TF_RETURN_IF_ERROR(ReadByte(&types));
+        if (size > data_.size() - pos_) {
+          return errors::DataLoss("Invalid map in Parquet metadata");
+        }
+        for (uint64_t i = 0; i < size; ++i) {
+          TF_RETURN_IF_ERROR(Skip(types >> 4, /*in_container=*/true));
+          TF_RETURN_IF_ERROR(Skip(types & 0x0f, /*in_container=*/true));
+        }
+        return OkStatus();
+      }
+      case kStruct:
+        return ReadStruct([this](int16_t, int field_type) {
+          return Skip(field_type, /*in_container=*/false);
+        });
+      default:
+        return errors::DataLoss("Invalid type ", type,
+                                " in Parquet metadata");
+    }
+  }
+
+  const absl::string_view data_;
+  size_t pos_ = 0;
+  int depth_ = 0;
+};
+
+Status ExpectType(int type, int expected) {
+  if (type != expected) {
+    return errors::DataLoss("Unexpected type ", type, " in Parquet metadata");
+  }
+  return OkStatus();
+}
+
+Status ReadI32Field(ThriftReader* reader, int type, int32_t* value) {
+  TF_RETURN_IF_ERROR(ExpectType(type, kI32));
+  return reader->ReadI32(value);
+}
+
+Status ReadI64Field(ThriftReader* reader, int type, int64_t* value) {
+  TF_RETURN_IF_ERROR(ExpectType(type, kI64));
+  return reader->ReadI64(value);
+}
+
+Status ReadBinaryField(ThriftReader* reader, int type, std::string* value) {
+  TF_RETURN_IF_ERROR(ExpectType(type, kBinary));
+  absl::string_view result;
+  TF_RETURN_IF_ERROR(reader->ReadBinary(&result));
+  value->assign(result.data(), result.size());
+  return OkStatus();
+}
+
+struct SchemaElement {
+  int32_t type = -1;
+  int32_t type_length = 0;
+  int32_t repetition_type = 0;
+  std::string name;
+  int32_t num_children = 0;
+};
+
+Status ParseSchemaElement(ThriftReader* reader, SchemaElement* element) {
+  return reader->ReadStruct([&](int16_t id, int type) {
+    switch (id) {
+      case 1:
+        return ReadI32Field(reader, type, &element->type);
+      case 2:
+        return ReadI32Field(reader, type, &element->type_length);
+      case 3:
+        return ReadI32Field(reader, type, &element->repetition_type);
+      case 4:
+        return ReadBinaryField(reader, type, &element->name);
+      case 5:
+        return ReadI32Field(reader, type, &element->num_children);
+      default:
+        return reader->Skip(type);
+    }
+  });
+}
+
+struct PageHeader {
+  int32_t type = -1;
+  int32_t uncompressed_size = 0;
+  int32_t compressed_size = 0;
+  int32_t num_values = 0;
+  int32_t encoding = kPlain;
+  // Only set for DATA_PAGE_V2 pages, whose levels are not compressed.
+  int32_t definition_levels_size = 0;
+  int32_t repetition_levels_size = 0;
+  bool is_compressed = true;
+};
+
+Status ParsePageHeader(absl::string_view data, PageHeader* header,
+                       size_t* header_size) {
+  ThriftReader reader(data);
+  // The data page, dictionary page and data page v2 headers.
+  auto parse_page_type_header = [&](int type) {
+    TF_RETURN_IF_ERROR(ExpectType(type, kStruct));
+    const bool v2 = header->type == kDataPageV2;
+    return reader.ReadStruct([&](int16_t id, int type) {
+      if (id == 1) return ReadI32Field(&reader, type, &header->num_values);
+      if (id == (v2 ? 4 : 2)) {
+        return ReadI32Field(&reader, type, &header->encoding);
+      }
+      if (v2 && id == 5) {
+        return ReadI32Field(&reader, type, &header->definition_levels_size);
+      }
+      if (v2 && id == 6) {
+        return ReadI32Field(&reader, type, &header->repetition_levels_size);
+      }
+      if (v2 && id == 7) {
+        header->is_compressed = type == kBoolTrue;
+        return OkStatus();
+      }
+      return reader.Skip(type);
+    });
+  };
+  TF_RETURN_IF_ERROR(reader.ReadStruct([&](int16_t id, int type) {
+    switch (id) {
+      case 1:
+        return ReadI32Field(&reader, type, &header->type);
+      case 2:
+        return ReadI32Field(&reader, type, &header->uncompressed_size);
+      case 3:
+        return ReadI32Field(&reader, type, &header->compressed_size);
+      case 5:
+      case 7:
+      case 8:
+        return parse_page_type_header(type);
+      default:
+        return reader.Skip(type);
+    }
+  }));
+  if (header->uncompressed_size < 0 || header->compressed_size < 0 ||
+      header->num_values < 0 || header->definition_levels_size < 0 ||
+      header->repetition_levels_size < 0) {
+    return errors::DataLoss("Invalid Parquet page header");
+  }
+  *header_size = reader.position();
+  return OkStatus();
+}
+
+// Sets `output` to the decompression of `input`, in `buffer` if needed.
+Status Decompress(int32_t codec, absl::string_view input,
+                  int64_t uncompressed_size, std::string* buffer,
+                  absl::string_view* output) {
+  switch (codec) {
+    case kUncompressed:
+      *output = input;
+      return OkStatus();
+    case kSnappy: {
+      size_t size;
+      if (!port::Snappy_GetUncompressedLength(input.data(), input.size(),
+                                              &size) ||
+          size != uncompressed_size) {
+        return errors::DataLoss("Invalid Snappy-compressed Parquet page");
+      }
+      buffer->resize(size);
+      if (!port::Snappy_Uncompress(input.data(), input.size(), &(*buffer)[0])) {
+        return errors::DataLoss("Invalid Snappy-compressed Parquet page");
+      }
+      *output = *buffer;
+      return OkStatus();
+    }
+    default:
+      return errors::Unimplemented("Unsupported Parquet compression codec ",
+                                   codec);
+  }
+}
+
+// Decodes the RLE/bit-packing hybrid encoding of definition levels and
+// dictionary indices.
+class RleDecoder {
+ public:
+  RleDecoder(absl::string_view data, int bit_width)
+      : data_(data), bit_width_(bit_width) {}
+
+  Status Decode(int64_t n, std::vector<uint32_t>* values) {
+    if (bit_width_ < 0 || bit_width_ > 32) {
+      return errors::DataLoss("Invalid bit width ", bit_width_,
+                              " in Parquet page");
+    }
+    values->resize(n);
+    int64_t i = 0;
+    while (i < n) {
+      if (repeat_count_ == 0 && literal_count_ == 0) {
+        TF_RETURN_IF_ERROR(NextRun());
+      }
+      if (repeat_count_ > 0) {
+        const int64_t count = std::min<int64_t>(repeat_count_, n - i);
+        std::fill_n(values->begin() + i, count, repeat_value_);
+        repeat_count_ -= count;
+        i += count;
+      } else {
+        (*values)[i++] = NextLiteral();
+        --literal_count_;
+      }
+    }
+    return OkStatus();
+  }
+
+ private:
+  Status NextRun() {
+    uint64_t header;
+    if (!ReadUleb128(data_, &pos_, &header) || header >> 1 == 0) {
+      return errors::DataLoss("Invalid run in Parquet page");
+    }
+    if (header & 1) {
+      // Groups of 8 bit-packed values.
+      const uint64_t size = (header >> 1) * bit_width_;
+      if (size > data_.size() - pos_) {
+        return errors::DataLoss("Truncated run in Parquet page");
+      }
+      literals_ = data_.substr(pos_, size);
+      literal_bit_ = 0;
+      literal_count_ = (header >> 1) * 8;
+      pos_ += size;
+    } else {
+      const size_t size = (bit_width_ + 7) / 8;
+      if (size > data_.size() - pos_) {
+        return errors::DataLoss("Truncated run in Parquet page");
+      }
+      repeat_value_ = 0;
+      for (size_t i = 0; i < size; ++i) {
+        repeat_value_ |= static_cast<uint32_t>(
+                             static_cast<uint8_t>(data_[pos_ + i]))
+                         << (8 * i);
+      }
+      repeat_count_ = header >> 1;
+      pos_ += size;
+    }
+    return OkStatus();
+  }
+
+  uint32_t NextLiteral() {
+    uint32_t value = 0;
+    for (int i = 0; i < bit_width_; ++i, ++literal_bit_) {
+      const uint8_t byte = literals_[literal_bit_ / 8];
+      value |= static_cast<uint32_t>((byte >> (literal_bit_ % 8)) & 1) << i;
+    }
+    return value;
+  }
+
+  const absl::string_view data_;
+  const int bit_width_;
+  size_t pos_ = 0;
+  uint64_t repeat_count_ = 0;
+  uint32_t repeat_value_ = 0;
+  uint64_t literal_count_ = 0;
+  absl::string_view literals_;
+  uint64_t literal_bit_ = 0;
+};
+
+// Calls `fn(T())`, where `T` is the C++ type of `dtype`.
+template <typename Fn>
+Status VisitType(DataType dtype, Fn fn) {
+  switch (dtype) {
+    case DT_BOOL:
+      return fn(bool());
+    case DT_INT32:
+      return fn(int32_t());
+    case DT_INT64:
+      return fn(int64_t());
+    case DT_FLOAT:
+      return fn(float());
+    case DT_DOUBLE:
+      return fn(double());
+    case DT_STRING:
+      return fn(tstring());
+    default:
+      return errors::Unimplemented("Unsupported type ", DataTypeString(dtype));
+  }
+}
+
+// Converts a plain-encoded value of a numeric or boolean column.
+bool PlainToDouble(int32_t physical_type, absl::string_view bytes,
+                   double* value) {
+  auto load = [&](auto t) {
+    using T = decltype(t);
+    if (bytes.size() != sizeof(T)) return false;
+    T result;
+    std::memcpy(&result, bytes.data(), sizeof(T));
+    *value = static_cast<double>(result);
+    return true;
+  };
+  switch (physical_type) {
+    case 0:
+      return load(uint8_t());
+    case 1:
+      return load(int32_t());
+    case 2:
+      return load(int64_t());
+    case 4:
+      return load(float());
+    case 5:
+      return load(double());
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+Status ParquetReader::Open(Env* env, const std::string& filename,
+                           std::unique_ptr<ParquetReader>* reader) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Parquet files can only be read on little-endian hosts");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  if (file_size < 2 * kMagicSize + sizeof(uint32)) {
+    return errors::DataLoss(filename, " is too small to be a Parquet file");
+  }
+  char tail[sizeof(uint32) + kMagicSize];
+  StringPiece result;
+  TF_RETURN_IF_ERROR(
+      file->Read(file_size - sizeof(tail), sizeof(tail), &result, tail));
+  if (result.size() != sizeof(tail) ||
+      result.substr(sizeof(uint32)) != kMagic) {
+    return errors::DataLoss(filename, " is not a Parquet file");
+  }
+  const uint32 footer_size = core::DecodeFixed32(result.data());
+  if (footer_size > file_size - sizeof(tail) - kMagicSize) {
+    return errors::DataLoss("Invalid footer size in Parquet file ", filename);
+  }
+  std::string footer(footer_size, '\0');
+  TF_RETURN_IF_ERROR(file->Read(file_size - sizeof(tail) - footer_size,
+                                footer_size, &result, &footer[0]));
+  if (result.size() != footer_size) {
+    return errors::DataLoss("Truncated Parquet file ", filename);
+  }
+  reader->reset(new ParquetReader(std::move(file), filename));
+  TF_RETURN_WITH_CONTEXT_IF_ERROR((*reader)->ParseFooter(result),
+                                  "in Parquet file ", filename);
+  return OkStatus();
+}
+
+Status ParquetReader::ParseFooter(absl::string_view footer) {
+  ThriftReader reader(footer);
+  std::vector<SchemaElement> schema;
+  auto parse_statistics = [&](ColumnChunk* chunk) {
+    std::string min, max, min_value, max_value;
+    bool has_min = false, has_max = false;
+    bool has_min_value = false, has_max_value = false;
+    TF_RETURN_IF_ERROR(reader.ReadStruct([&](int16_t id, int type) {
+      switch (id) {
+        case 1:
+          has_max = true;
+          return ReadBinaryField(&reader, type, &max);
+        case 2:
+          has_min = true;
+          return ReadBinaryField(&reader, type, &min);
+        case 5:
+          has_max_value = true;
+          return ReadBinaryField(&reader, type, &max_value);
+        case 6:
+          has_min_value = true;
+          return ReadBinaryField(&reader, type, &min_value);
+        default:
+          return reader.Skip(type);
+      }
+    }));
+    // `min` and `max` are deprecated, but still describe signed values.
+    if (has_min_value && has_max_value) {
+      chunk->has_bounds = true;
+      chunk->min = std::move(min_value);
+      chunk->max = std::move(max_value);
+    } else if (has_min && has_max) {
+      chunk->has_bounds = true;
+      chunk->min = std::move(min);
+      chunk->max = std::move(max);
+    }
+    return OkStatus();
+  };
+  auto parse_column_metadata = [&](ColumnChunk* chunk) {
+    int64_t data_page_offset = -1;
+    int64_t dictionary_page_offset = -1;
+    TF_RETURN_IF_ERROR(reader.ReadStruct([&](int16_t id, int type) {
+      switch (id) {
+        case 4:
+          return ReadI32Field(&reader, type, &chunk->codec);
+        case 7:
+          return ReadI64Field(&reader, type, &chunk->size);
+        case 9:
+          return ReadI64Field(&reader, type, &data_page_offset);
+        case 11:
+          return ReadI64Field(&reader, type, &dictionary_page_offset);
+        case 12:
+          TF_RETURN_IF_ERROR(ExpectType(type, kStruct));
+          return parse_statistics(chunk);
+        default:
+          return reader.Skip(type);
+      }
+    }));
+    if (data_page_offset < 0 || chunk->size < 0) {
+      return errors::DataLoss("Invalid column chunk");
+    }
+    // Some writers set the dictionary page offset to 0 when there is none.
+    chunk->offset = dictionary_page_offset > 0 &&
+                            dictionary_page_offset < data_page_offset
+                        ? dictionary_page_offset
+                        : data_page_offset;
+    return OkStatus();
+  };
+  auto parse_column_chunk = [&](ColumnChunk* chunk) {
+    bool has_metadata = false;
+    TF_RETURN_IF_ERROR(reader.ReadStruct([&](int16_t id, int type) {
+      switch (id) {
+        case 1:
+          return errors::Unimplemented(
+              "Column chunks in other files are not supported");
+        case 3:
+          has_metadata = true;
+          TF_RETURN_IF_ERROR(ExpectType(type, kStruct));
+          return parse_column_metadata(chunk);
+        default:
+          return reader.Skip(type);
+      }
+    }));
+    if (!has_metadata) {
+      return errors::DataLoss("Column chunk without metadata");
+    }
+    return OkStatus();
+  };
+  auto parse_row_group = [&](RowGroup* row_group) {
+    return reader.ReadStruct([&](int16_t id, int type) {
+      switch (id) {
+        case 1:
+          return reader.ReadList(type, [&](int element_type) {
+            TF_RETURN_IF_ERROR(ExpectType(element_type, kStruct));
+            row_group->chunks.emplace_back();
+            return parse_column_chunk(&row_group->chunks.back());
+          });
+        case 3:
+          return ReadI64Field(&reader, type, &row_group->num_rows);
+        default:
+          return reader.Skip(type);
+      }
+    });
+  };
+  TF_RETURN_IF_ERROR(reader.ReadStruct([&](int16_t id, int type) {
+    switch (id) {
+      case 2:
+        return reader.ReadList(type, [&](int element_type) {
+          TF_RETURN_IF_ERROR(ExpectType(element_type, kStruct));
+          schema.emplace_back();
+          return ParseSchemaElement(&reader, &schema.back());
+        });
+      case 4:
+        return reader.ReadList(type, [&](int element_type) {
+          TF_RETURN_IF_ERROR(ExpectType(element_type, kStruct));
+          row_groups_.emplace_back();
+          return parse_row_group(&row_groups_.back());
+        });
+      default:
+        return reader.Skip(type);
+    }
+  }));
+
+  if (schema.empty()) {
+    return errors::DataLoss("Missing schema");
+  }
+  // The first element is the root of the schema.
+  for (size_t i = 1; i < schema.size(); ++i) {
+    const SchemaElement& element = schema[i];
+    if (element.num_children > 0 || element.type < 0) {
+      return errors::Unimplemented("Nested column ", element.name,
+                                   " is not supported");
+    }
+    if (element.repetition_type == kRepeated) {
+      return errors::Unimplemented("Repeated column ", element.name,
+                                   " is not supported");
+    }
+    Leaf leaf;
+    leaf.type = static_cast<PhysicalType>(element.type);
+    leaf.type_length = element.type_length;
+    leaf.optional = element.repetition_type != 0;
+    DataType dtype;
+    switch (leaf.type) {
+      case PhysicalType::kBoolean:
+        dtype = DT_BOOL;
+        break;
+      case PhysicalType::kInt32:
+        dtype = DT_INT32;
+        break;
+      case PhysicalType::kInt64:
+        dtype = DT_INT64;
+        break;
+      case PhysicalType::kFloat:
+        dtype = DT_FLOAT;
+        break;
+      case PhysicalType::kDouble:
+        dtype = DT_DOUBLE;
+        break;
+      case PhysicalType::kByteArray:
+      case PhysicalType::kFixedLenByteArray:
+        dtype = DT_STRING;
+        break;
+      default:
+        // Only fails if the column is read.
+        dtype = DT_INVALID;
+    }
+    leaves_.push_back(leaf);
+    columns_.push_back({element.name, dtype});
+  }
+  for (const RowGroup& row_group : row_groups_) {
+    if (row_group.chunks.size() != leaves_.size() || row_group.num_rows < 0) {
+      return errors::DataLoss("Invalid row group");
+    }
+  }
+  return OkStatus();
+}
+
+int ParquetReader::FindColumn(absl::string_view name) const {
+  for (int i = 0; i < columns_.size(); ++i) {
+    if (columns_[i].name == name) return i;
+  }
+  return -1;
+}
+
+bool ParquetReader::RowGroupMayContain(int row_group, int column,
+                                       double lower, double upper) const {
+  const ColumnChunk& chunk = row_groups_[row_group].chunks[column];
+  double min, max;
+  if (!chunk.has_bounds ||
+      !PlainToDouble(static_cast<int32_t>(leaves_[column].type), chunk.min,
+                     &min) ||
+      !PlainToDouble(static_cast<int32_t>(leaves_[column].type), chunk.max,
+                     &max)) {
+    return true;
+  }
+  return max >= lower && min <= upper;
+}
+
+Status ParquetReader::ReadRowGroup(int row_group,
+                                   const std::vector<int>& columns,
+                                   std::vector<Tensor>* values) const {
+  if (row_group < 0 || row_group >= row_groups_.size()) {
+    return errors::InvalidArgument("Invalid row group ", row_group, " of ",
+                                   filename_);
+  }
+  const RowGroup& group = row_groups_[row_group];
+  for (int column : columns) {
+    if (column < 0 || column >= columns_.size()) {
+      return errors::InvalidArgument("Invalid column ", column, " of ",
+                                     filename_);
+    }
+  }
+
+  // Reads the column chunks in order of their offsets, coalescing chunks that
+  // are close to each other into a single read.
+  std::vector<int> order(columns.size());
+  for (int i = 0; i < order.size(); ++i) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](int a, int b) {
+    return group.chunks[columns[a]].offset < group.chunks[columns[b]].offset;
+  });
+  std::vector<absl::string_view> chunk_data(columns.size());
+  std::vector<std::string> buffers;
+  buffers.reserve(columns.size());
+  for (size_t begin = 0; begin < order.size();) {
+    const int64_t offset = group.chunks[columns[order[begin]]].offset;
+    int64_t end_offset = offset;
+    size_t end = begin;
+    for (; end < order.size(); ++end) {
+      const ColumnChunk& chunk = group.chunks[columns[order[end]]];
+      if (end > begin && chunk.offset - end_offset > kMaxCoalescedGapBytes) {
+        break;
+      }
+      end_offset = std::max(end_offset, chunk.offset + chunk.size);
+    }
+    const int64_t size = end_offset - offset;
+    buffers.emplace_back(size, '\0');
+    StringPiece result;
+    TF_RETURN_IF_ERROR(file_->Read(offset, size, &result, &buffers.back()[0]));
+    if (result.size() != size) {
+      return errors::DataLoss("Truncated Parquet file ", filename_);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      const ColumnChunk& chunk = group.chunks[columns[order[i]]];
+      chunk_data[order[i]] = absl::string_view(
+          result.data() + (chunk.offset - offset), chunk.size);
+    }
+    begin = end;
+  }
+
+  values->resize(columns.size());
+  for (int i = 0; i < columns.size(); ++i) {
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(
+        DecodeColumnChunk(columns[i], group.chunks[columns[i]], chunk_data[i],
+                          group.num_rows, &(*values)[i]),
+        "in column ", columns_[columns[i]].name, " of row group ", row_group,
+        " of Parquet file ", filename_);
+  }
+  return OkStatus();
+}
+
+namespace {
+
+// Decodes `n` PLAIN-encoded values into `values`, from index `offset` on.
+Status DecodePlain(int32_t physical_type, int32_t type_length,
+                   absl::string_view data, int64_t n, Tensor* values,
+                   int64_t offset) {
+  auto copy = [&](auto t) {
+    using T = decltype(t);
+    if (data.size() < n * sizeof(T)) {
+      return errors::DataLoss("Truncated Parquet page");
+    }
+    std::memcpy(values->flat<T>().data() + offset, data.data(), n * sizeof(T));
+    return OkStatus();
+  };
+  switch (physical_type) {
+    case 0: {
+      if (data.size() < (n + 7) / 8) {
+        return errors::DataLoss("Truncated Parquet page");
+      }
+      auto flat = values->flat<bool>();
+      for (int64_t i = 0; i < n; ++i) {
+        flat(offset + i) = (static_cast<uint8_t>(data[i / 8]) >> (i % 8)) & 1;
+      }
+      return OkStatus();
+    }
+    case 1:
+      return copy(int32_t());
+    case 2:
+      return copy(int64_t());
+    case 4:
+      return copy(float());
+    case 5:
+      return copy(double());
+    case 6: {
+      auto flat = values->flat<tstring>();
+      for (int64_t i = 0; i < n; ++i) {
+        if (data.size() < sizeof(uint32)) {
+          return errors::DataLoss("Truncated Parquet page");
+        }
+        const uint32 size = core::DecodeFixed32(data.data());
+        data.remove_prefix(sizeof(uint32));
+        if (data.size() < size) {
+          return errors::DataLoss("Truncated Parquet page");
+        }
+        flat(offset + i).assign(data.data(), size);
+        data.remove_prefix(size);
+      }
+      return OkStatus();
+    }
+    case 7: {
+      if (type_length < 0 || data.size() < n * type_length) {
+        return errors::DataLoss("Truncated Parquet page");
+      }
+      auto flat = values->flat<tstring>();
+      for (int64_t i = 0; i < n; ++i) {
+        flat(offset + i).assign(data.data() + i * type_length, type_length);
+      }
+      return OkStatus();
+    }
+    default:
+      return errors::Unimplemented("Unsupported physical type ",
+                                   physical_type);
+  }
+}
+
+// Decodes `n` dictionary-encoded values into `values`, from index `offset`
+// on.
+Status DecodeDictionary(const Tensor& dictionary, absl::string_view data,
+                        int64_t n, Tensor* values, int64_t offset) {
+  if (data.empty()) {
+    return errors::DataLoss("Truncated Parquet page");
+  }
+  const int bit_width = static_cast<uint8_t>(data[0]);
+  std::vector<uint32_t> indices;
+  TF_RETURN_IF_ERROR(RleDecoder(data.substr(1), bit_width).Decode(n, &indices));
+  return VisitType(dictionary.dtype(), [&](auto t) {
+    using T = decltype(t);
+    auto entries = dictionary.flat<T>();
+    auto flat = values->flat<T>();
+    for (int64_t i = 0; i < n; ++i) {
+      if (indices[i] >= entries.size()) {
+        return errors::DataLoss("Invalid dictionary index in Parquet page");
+      }
+      flat(offset + i) = entries(indices[i]);
+    }
+    return OkStatus();
+  });
+}
+
+}  // namespace
+
+Status ParquetReader::DecodeColumnChunk(int column, const ColumnChunk& chunk,
+                                        absl::string_view data,
+                                        int64_t num_rows,
+                                        Tensor* values) const {
+  const Leaf& leaf = leaves_[column];
+  const int32_t physical_type = static_cast<int32_t>(leaf.type);
+  const DataType dtype = columns_[column].dtype;
+  if (dtype == DT_INVALID) {
+    return errors::Unimplemented("Unsupported physical type ", physical_type);
+  }
+  *values = Tensor(dtype, TensorShape({num_rows}));
+  if (DataTypeCanUseMemcpy(dtype)) {
+    // Nulls are read as zeros.
+    std::memset(values->data(), 0, values->TotalBytes());
+  }
+
+  Tensor dictionary;
+  bool has_dictionary = false;
+  std::string page_buffer;
+  std::vector<uint32_t> definition_levels;
+  int64_t row = 0;
+  while (row < num_rows) {
+    PageHeader header;
+    size_t header_size;
+    TF_RETURN_IF_ERROR(ParsePageHeader(data, &header, &header_size));
+    data.remove_prefix(header_size);
+    if (header.compressed_size > data.size()) {
+      return errors::DataLoss("Truncated Parquet page");
+    }
+    absl::string_view page = data.substr(0, header.compressed_size);
+    data.remove_prefix(header.compressed_size);
+
+    if (header.type == kDictionaryPage) {
+      TF_RETURN_IF_ERROR(Decompress(chunk.codec, page, header.uncompressed_size,
+                                    &page_buffer, &page));
+      dictionary = Tensor(dtype, TensorShape({header.num_values}));
+      TF_RETURN_IF_ERROR(DecodePlain(physical_type, leaf.type_length, page,
+                                     header.num_values, &dictionary, 0));
+      has_dictionary = true;
+      continue;
+    }
+    if (header.type != kDataPage && header.type != kDataPageV2) {
+      // E.g. an index page.
+      continue;
+    }
+    const int64_t n = header.num_values;
+    if (n > num_rows - row) {
+      return errors::DataLoss("Parquet page has too many values");
+    }
+    absl::string_view levels;
+    if (header.type == kDataPage) {
+      TF_RETURN_IF_ERROR(Decompress(chunk.codec, page, header.uncompressed_size,
+                                    &page_buffer, &page));
+      if (leaf.optional) {
+        if (page.size() < sizeof(uint32)) {
+          return errors::DataLoss("Truncated Parquet page");
+        }
+        const uint32 size = core::DecodeFixed32(page.data());
+        if (size > page.size() - sizeof(uint32)) {
+          return errors::DataLoss("Truncated Parquet page");
+        }
+        levels = page.substr(sizeof(uint32), size);
+        page.remove_prefix(sizeof(uint32) + size);
+      }
+    } else {
+      const int64_t levels_size =
+          header.repetition_levels_size + header.definition_levels_size;
+      if (levels_size > page.size() ||
+          levels_size > header.uncompressed_size) {
+        return errors::DataLoss("Truncated Parquet page");
+      }
+      levels = page.substr(header.repetition_levels_size,
+                           header.definition_levels_size);
+      page.remove_prefix(levels_size);
+      if (header.is_compressed) {
+        TF_RETURN_IF_ERROR(Decompress(chunk.codec, page,
+                                      header.uncompressed_size - levels_size,
+                                      &page_buffer, &page));
+      }
+    }
+
+    int64_t num_present = n;
+    if (leaf.optional) {
+      TF_RETURN_IF_ERROR(
+          RleDecoder(levels, /*bit_width=*/1).Decode(n, &definition_levels));
+      num_present =
+          std::count(definition_levels.begin(), definition_levels.end(), 1);
+    }
+    // Values are decoded in place, unless there are nulls to skip.
+    Tensor present_values;
+    Tensor* target = values;
+    int64_t offset = row;
+    if (num_present < n) {
+      present_values = Tensor(dtype, TensorShape({num_present}));
+      target = &present_values;
+      offset = 0;
+    }
+    switch (header.encoding) {
+      case kPlain:
+        TF_RETURN_IF_ERROR(DecodePlain(physical_type, leaf.type_length, page,
+                                       num_present, target, offset));
+        break;
+      case kPlainDictionary:
+      case kRleDictionary:
+        if (!has_dictionary) {
+          return errors::DataLoss("Missing dictionary page");
+        }
+        TF_RETURN_IF_ERROR(
+            DecodeDictionary(dictionary, page, num_present, target, offset));
+        break;
+      default:
+        return errors::Unimplemented("Unsupported Parquet encoding ",
+                                     header.encoding);
+    }
+    if (num_present < n) {
+      TF_RETURN_IF_ERROR(VisitType(dtype, [&](auto t) {
+        using T = decltype(t);
+        auto from = present_values.flat<T>();
+        auto to = values->flat<T>();
+        for (int64_t i = 0, j = 0; i < n; ++i) {
+          if (definition_levels[i] == 1) to(row + i) = from(j++);
+        }
+        return OkStatus();
+      }));
+    }
+    row += n;
+  }
+  return OkStatus();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
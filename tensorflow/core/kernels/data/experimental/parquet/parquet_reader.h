@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_PARQUET_READER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_PARQUET_READER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Reads Parquet files column by column, decoding each column chunk of a row
+// group directly into a tensor, without materializing rows.
+//
+// Files must have a flat schema of required or optional columns of the
+// BOOLEAN, INT32, INT64, FLOAT, DOUBLE, BYTE_ARRAY or FIXED_LEN_BYTE_ARRAY
+// physical types, which are read as DT_BOOL, DT_INT32, DT_INT64, DT_FLOAT,
+// DT_DOUBLE and DT_STRING tensors, respectively. Pages must be PLAIN or
+// dictionary encoded, and either uncompressed or compressed with Snappy.
+// Nulls are read as zeros and empty strings.
+//
+// This class is thread-compatible.
+class ParquetReader {
+ public:
+  struct Column {
+    std::string name;
+    DataType dtype;
+  };
+
+  // Reads the footer of the Parquet file `filename`.
+  static Status Open(Env* env, const std::string& filename,
+                     std::unique_ptr<ParquetReader>* reader);
+
+  const std::vector<Column>& columns() const { return columns_; }
+
+  // Returns the index of the column called `name`, or -1 if there is none.
+  int FindColumn(absl::string_view name) const;
+
+  int num_row_groups() const { return row_groups_.size(); }
+  int64_t row_group_num_rows(int row_group) const {
+    return row_groups_[row_group].num_rows;
+  }
+
+  // Returns false if the statistics of `column` in `row_group` show that none
+  // of its values are in [`lower`, `upper`], and true otherwise. `column` must
+  // be numeric or boolean.
+  bool RowGroupMayContain(int row_group, int column, double lower,
+                          double upper) const;
+
+  // Reads `columns` of `row_group` into `values`: a tensor of shape
+  // [row_group_num_rows(row_group)] per column. The column chunks are read
+  // with as few reads of the file as possible.
+  Status ReadRowGroup(int row_group, const std::vector<int>& columns,
+                      std::vector<Tensor>* values) const;
+
+ private:
+  // The Parquet physical types.
+  enum class PhysicalType {
+    kBoolean = 0,
+    kInt32 = 1,
+    kInt64 = 2,
+    kInt96 = 3,
+    kFloat = 4,
+    kDouble = 5,
+    kByteArray = 6,
+    kFixedLenByteArray = 7,
+  };
+
+  struct Leaf {
+    PhysicalType type;
+    // The length of FIXED_LEN_BYTE_ARRAY values.
+    int32_t type_length = 0;
+    bool optional = false;
+  };
+
+  struct ColumnChunk {
+    int32_t codec = 0;
+    int64_t offset = 0;
+    int64_t size = 0;
+    // The plain-encoded bounds of the values of the chunk, if known.
+    bool has_bounds = false;
+    std::string min;
+    std::string max;
+  };
+
+  struct RowGroup {
+    int64_t num_rows = 0;
+    std::vector<ColumnChunk> chunks;
+  };
+
+  ParquetReader(std::unique_ptr<RandomAccessFile> file, std::string filename)
+      : file_(std::move(file)), filename_(std::move(filename)) {}
+
+  Status ParseFooter(absl::string_view footer);
+
+  // Decodes the pages of a column chunk into a tensor of `num_rows` values.
+  Status DecodeColumnChunk(int column, const ColumnChunk& chunk,
+                           absl::string_view data, int64_t num_rows,
+                           Tensor* values) const;
+
+  std::unique_ptr<RandomAccessFile> file_;
+  const std::string filename_;
+  std::vector<Column> columns_;
+  std::vector<Leaf> leaves_;
+  std::vector<RowGroup> row_groups_;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_PARQUET_PARQUET_READER_H_
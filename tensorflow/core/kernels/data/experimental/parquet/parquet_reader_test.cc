@@ -0,0 +1,433 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/parquet/parquet_reader.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr int32_t kBoolean = 0;
+constexpr int32_t kInt32 = 1;
+constexpr int32_t kInt64 = 2;
+constexpr int32_t kDouble = 5;
+constexpr int32_t kByteArray = 6;
+
+constexpr int32_t kPlain = 0;
+constexpr int32_t kRleDictionary = 8;
+
+// Encodes structs in the Thrift compact protocol.
+class ThriftWriter {
+ public:
+  void I32(int16_t id, int32_t value) {
+    FieldHeader(id, 5);
+    Varint(ZigZag(value));
+  }
+  void I64(int16_t id, int64_t value) {
+    FieldHeader(id, 6);
+    Varint(ZigZag(value));
+  }
+  void Binary(int16_t id, const std::string& value) {
+    FieldHeader(id, 8);
+    Varint(value.size());
+    data_.append(value);
+  }
+  void BeginStruct(int16_t id) {
+    FieldHeader(id, 12);
+    field_ids_.push_back(0);
+  }
+  // Starts a list of `size` elements of type `element_type`, which are then
+  // written with the methods below.
+  void BeginList(int16_t id, int size, int element_type) {
+    FieldHeader(id, 9);
+    if (size < 15) {
+      data_.push_back(static_cast<char>(size << 4 | element_type));
+    } else {
+      data_.push_back(static_cast<char>(0xf0 | element_type));
+      Varint(size);
+    }
+  }
+  void I32Element(int32_t value) { Varint(ZigZag(value)); }
+  void BinaryElement(const std::string& value) {
+    Varint(value.size());
+    data_.append(value);
+  }
+  void BeginStructElement() { field_ids_.push_back(0); }
+  void EndStruct() {
+    data_.push_back(0);
+    field_ids_.pop_back();
+  }
+
+  // Ends the top-level struct.
+  std::string Finish() {
+    data_.push_back(0);
+    return data_;
+  }
+
+ private:
+  static uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ (value >> 63);
+  }
+  void Varint(uint64_t value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+  void FieldHeader(int16_t id, int type) {
+    const int delta = id - field_ids_.back();
+    if (delta > 0 && delta <= 15) {
+      data_.push_back(static_cast<char>(delta << 4 | type));
+    } else {
+      data_.push_back(static_cast<char>(type));
+      Varint(ZigZag(id));
+    }
+    field_ids_.back() = id;
+  }
+
+  std::string data_;
+  std::vector<int16_t> field_ids_ = {0};
+};
+
+template <typename T>
+std::string Plain(const std::vector<T>& values) {
+  return std::string(reinterpret_cast<const char*>(values.data()),
+                     values.size() * sizeof(T));
+}
+
+std::string PlainStrings(const std::vector<std::string>& values) {
+  std::string result;
+  for (const std::string& value : values) {
+    core::PutFixed32(&result, value.size());
+    result.append(value);
+  }
+  return result;
+}
+
+// Returns length-prefixed definition levels, as a single bit-packed run.
+std::string DefinitionLevels(const std::vector<bool>& defined) {
+  const int num_groups = (defined.size() + 7) / 8;
+  std::string levels(1, static_cast<char>(num_groups << 1 | 1));
+  levels.append(num_groups, '\0');
+  for (int i = 0; i < defined.size(); ++i) {
+    if (defined[i]) levels[1 + i / 8] |= 1 << (i % 8);
+  }
+  std::string result;
+  core::PutFixed32(&result, levels.size());
+  return result + levels;
+}
+
+// Returns dictionary indices of width 8, as one repeated run per index.
+std::string DictionaryIndices(const std::vector<uint8_t>& indices) {
+  std::string result(1, 8);
+  for (uint8_t index : indices) {
+    result.push_back(1 << 1);
+    result.push_back(static_cast<char>(index));
+  }
+  return result;
+}
+
+std::string Page(int32_t type, int num_values, int32_t encoding,
+                 const std::string& body,
+                 const std::string& compressed_body = "") {
+  const std::string& data = compressed_body.empty() ? body : compressed_body;
+  ThriftWriter writer;
+  writer.I32(1, type);
+  writer.I32(2, body.size());
+  writer.I32(3, data.size());
+  writer.BeginStruct(type == 2 ? 7 : 5);
+  writer.I32(1, num_values);
+  writer.I32(2, encoding);
+  writer.EndStruct();
+  return writer.Finish() + data;
+}
+
+std::string DataPage(int num_values, const std::string& body,
+                     int32_t encoding = kPlain) {
+  return Page(/*type=*/0, num_values, encoding, body);
+}
+
+std::string DictionaryPage(int num_values, const std::string& body) {
+  return Page(/*type=*/2, num_values, kPlain, body);
+}
+
+// Builds Parquet files with a flat schema, one row group at a time.
+class ParquetFileBuilder {
+ public:
+  void AddColumn(const std::string& name, int32_t type,
+                 bool optional = false) {
+    columns_.push_back({name, type, optional});
+  }
+
+  void AddRowGroup(int64_t num_rows) { row_groups_.push_back({num_rows, {}}); }
+
+  // Adds the pages of the next column of the last row group.
+  void AddChunk(const std::string& pages, int32_t codec = 0,
+                const std::string& min = "", const std::string& max = "") {
+    row_groups_.back().chunks.push_back(
+        {static_cast<int64_t>(data_.size()),
+         static_cast<int64_t>(pages.size()), codec, min, max});
+    data_.append(pages);
+  }
+
+  Status Write(const std::string& filename) {
+    ThriftWriter writer;
+    writer.I32(1, 1);
+    writer.BeginList(2, columns_.size() + 1, 12);
+    writer.BeginStructElement();
+    writer.Binary(4, "schema");
+    writer.I32(5, columns_.size());
+    writer.EndStruct();
+    for (const TestColumn& column : columns_) {
+      writer.BeginStructElement();
+      writer.I32(1, column.type);
+      writer.I32(3, column.optional ? 1 : 0);
+      writer.Binary(4, column.name);
+      writer.EndStruct();
+    }
+    int64_t num_rows = 0;
+    for (const TestRowGroup& row_group : row_groups_) {
+      num_rows += row_group.num_rows;
+    }
+    writer.I64(3, num_rows);
+    writer.BeginList(4, row_groups_.size(), 12);
+    for (const TestRowGroup& row_group : row_groups_) {
+      writer.BeginStructElement();
+      writer.BeginList(1, row_group.chunks.size(), 12);
+      for (int i = 0; i < row_group.chunks.size(); ++i) {
+        const TestChunk& chunk = row_group.chunks[i];
+        writer.BeginStructElement();
+        writer.I64(2, chunk.offset);
+        writer.BeginStruct(3);
+        writer.I32(1, columns_[i].type);
+        writer.BeginList(2, 2, 5);
+        writer.I32Element(kPlain);
+        writer.I32Element(kRleDictionary);
+        writer.BeginList(3, 1, 8);
+        writer.BinaryElement(columns_[i].name);
+        writer.I32(4, chunk.codec);
+        writer.I64(5, row_group.num_rows);
+        writer.I64(6, chunk.size);
+        writer.I64(7, chunk.size);
+        writer.I64(9, chunk.offset);
+        if (!chunk.min.empty()) {
+          writer.BeginStruct(12);
+          writer.Binary(5, chunk.max);
+          writer.Binary(6, chunk.min);
+          writer.EndStruct();
+        }
+        writer.EndStruct();
+        writer.EndStruct();
+      }
+      writer.I64(2, 0);
+      writer.I64(3, row_group.num_rows);
+      writer.EndStruct();
+    }
+    const std::string footer = writer.Finish();
+    std::string contents = data_ + footer;
+    core::PutFixed32(&contents, footer.size());
+    contents.append("PAR1");
+    return WriteStringToFile(Env::Default(), filename, contents);
+  }
+
+ private:
+  struct TestColumn {
+    std::string name;
+    int32_t type;
+    bool optional;
+  };
+  struct TestChunk {
+    int64_t offset;
+    int64_t size;
+    int32_t codec;
+    std::string min;
+    std::string max;
+  };
+  struct TestRowGroup {
+    int64_t num_rows;
+    std::vector<TestChunk> chunks;
+  };
+
+  std::vector<TestColumn> columns_;
+  std::vector<TestRowGroup> row_groups_;
+  // The file starts with the magic number too.
+  std::string data_ = "PAR1";
+};
+
+std::string TestFilename(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(ParquetReaderTest, ReadsRequiredColumns) {
+  ParquetFileBuilder builder;
+  builder.AddColumn("id", kInt64);
+  builder.AddColumn("x", kDouble);
+  builder.AddColumn("name", kByteArray);
+  builder.AddColumn("flag", kBoolean);
+  builder.AddRowGroup(3);
+  builder.AddChunk(DataPage(3, Plain<int64_t>({1, 2, 3})));
+  builder.AddChunk(DataPage(3, Plain<double>({0.5, 1.5, 2.5})));
+  builder.AddChunk(DataPage(3, PlainStrings({"a", "", "ccc"})));
+  builder.AddChunk(DataPage(3, std::string(1, 0b101)));
+  builder.AddRowGroup(2);
+  // A column chunk of several pages.
+  builder.AddChunk(DataPage(1, Plain<int64_t>({4})) +
+                   DataPage(1, Plain<int64_t>({5})));
+  builder.AddChunk(DataPage(2, Plain<double>({3.5, 4.5})));
+  builder.AddChunk(DataPage(2, PlainStrings({"dd", "e"})));
+  builder.AddChunk(DataPage(2, std::string(1, 0b10)));
+  const std::string filename = TestFilename("required.parquet");
+  TF_ASSERT_OK(builder.Write(filename));
+
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  ASSERT_EQ(reader->columns().size(), 4);
+  EXPECT_EQ(reader->columns()[2].name, "name");
+  EXPECT_EQ(reader->columns()[2].dtype, DT_STRING);
+  EXPECT_EQ(reader->FindColumn("x"), 1);
+  EXPECT_EQ(reader->FindColumn("y"), -1);
+  ASSERT_EQ(reader->num_row_groups(), 2);
+  EXPECT_EQ(reader->row_group_num_rows(0), 3);
+
+  std::vector<Tensor> values;
+  TF_ASSERT_OK(reader->ReadRowGroup(0, {3, 0, 2, 1}, &values));
+  ASSERT_EQ(values.size(), 4);
+  test::ExpectEqual(values[0], test::AsTensor<bool>({true, false, true}));
+  test::ExpectEqual(values[1], test::AsTensor<int64_t>({1, 2, 3}));
+  test::ExpectEqual(values[2], test::AsTensor<tstring>({"a", "", "ccc"}));
+  test::ExpectEqual(values[3], test::AsTensor<double>({0.5, 1.5, 2.5}));
+
+  TF_ASSERT_OK(reader->ReadRowGroup(1, {0, 3}, &values));
+  ASSERT_EQ(values.size(), 2);
+  test::ExpectEqual(values[0], test::AsTensor<int64_t>({4, 5}));
+  test::ExpectEqual(values[1], test::AsTensor<bool>({false, true}));
+}
+
+TEST(ParquetReaderTest, ReadsNullsAsZeros) {
+  ParquetFileBuilder builder;
+  builder.AddColumn("x", kInt32, /*optional=*/true);
+  builder.AddColumn("s", kByteArray, /*optional=*/true);
+  builder.AddRowGroup(4);
+  builder.AddChunk(DataPage(4, DefinitionLevels({true, false, false, true}) +
+                                   Plain<int32_t>({7, 8})));
+  builder.AddChunk(DataPage(4, DefinitionLevels({false, true, true, false}) +
+                                   PlainStrings({"a", "b"})));
+  const std::string filename = TestFilename("optional.parquet");
+  TF_ASSERT_OK(builder.Write(filename));
+
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  std::vector<Tensor> values;
+  TF_ASSERT_OK(reader->ReadRowGroup(0, {0, 1}, &values));
+  test::ExpectEqual(values[0], test::AsTensor<int32_t>({7, 0, 0, 8}));
+  test::ExpectEqual(values[1], test::AsTensor<tstring>({"", "a", "b", ""}));
+}
+
+TEST(ParquetReaderTest, ReadsDictionaryEncodedColumns) {
+  ParquetFileBuilder builder;
+  builder.AddColumn("s", kByteArray);
+  builder.AddRowGroup(5);
+  builder.AddChunk(
+      DictionaryPage(2, PlainStrings({"cat", "dog"})) +
+      DataPage(5, DictionaryIndices({1, 1, 0, 1, 0}), kRleDictionary));
+  const std::string filename = TestFilename("dictionary.parquet");
+  TF_ASSERT_OK(builder.Write(filename));
+
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  std::vector<Tensor> values;
+  TF_ASSERT_OK(reader->ReadRowGroup(0, {0}, &values));
+  test::ExpectEqual(
+      values[0], test::AsTensor<tstring>({"dog", "dog", "cat", "dog", "cat"}));
+}
+
+TEST(ParquetReaderTest, ReadsSnappyCompressedPages) {
+  const std::string body = Plain<int64_t>({10, 20, 30});
+  std::string compressed;
+  if (!port::Snappy_Compress(body.data(), body.size(), &compressed)) {
+    GTEST_SKIP() << "Snappy is not available";
+  }
+  ParquetFileBuilder builder;
+  builder.AddColumn("x", kInt64);
+  builder.AddRowGroup(3);
+  builder.AddChunk(Page(/*type=*/0, 3, kPlain, body, compressed),
+                   /*codec=*/1);
+  const std::string filename = TestFilename("snappy.parquet");
+  TF_ASSERT_OK(builder.Write(filename));
+
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  std::vector<Tensor> values;
+  TF_ASSERT_OK(reader->ReadRowGroup(0, {0}, &values));
+  test::ExpectEqual(values[0], test::AsTensor<int64_t>({10, 20, 30}));
+}
+
+TEST(ParquetReaderTest, RowGroupMayContain) {
+  ParquetFileBuilder builder;
+  builder.AddColumn("x", kInt64);
+  builder.AddColumn("y", kInt64);
+  builder.AddRowGroup(2);
+  builder.AddChunk(DataPage(2, Plain<int64_t>({10, 20})), /*codec=*/0,
+                   Plain<int64_t>({10}), Plain<int64_t>({20}));
+  // No statistics.
+  builder.AddChunk(DataPage(2, Plain<int64_t>({1, 2})));
+  const std::string filename = TestFilename("statistics.parquet");
+  TF_ASSERT_OK(builder.Write(filename));
+
+  std::unique_ptr<ParquetReader> reader;
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  EXPECT_TRUE(reader->RowGroupMayContain(0, 0, 15, 100));
+  EXPECT_TRUE(reader->RowGroupMayContain(0, 0, 0, 10));
+  EXPECT_FALSE(reader->RowGroupMayContain(0, 0, 21, 100));
+  EXPECT_FALSE(reader->RowGroupMayContain(0, 0, 0, 9));
+  EXPECT_TRUE(reader->RowGroupMayContain(0, 1, 100, 200));
+}
+
+TEST(ParquetReaderTest, RejectsInvalidFiles) {
+  const std::string filename = TestFilename("invalid.parquet");
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 "PAR1 this is not a parquet file"));
+  std::unique_ptr<ParquetReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(
+      ParquetReader::Open(Env::Default(), filename, &reader)));
+
+  ParquetFileBuilder builder;
+  builder.AddColumn("x", kInt64);
+  builder.AddRowGroup(3);
+  // Too few values for the row group.
+  builder.AddChunk(DataPage(2, Plain<int64_t>({1, 2})));
+  TF_ASSERT_OK(builder.Write(filename));
+  TF_ASSERT_OK(ParquetReader::Open(Env::Default(), filename, &reader));
+  std::vector<Tensor> values;
+  EXPECT_TRUE(errors::IsDataLoss(reader->ReadRowGroup(0, {0}, &values)));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
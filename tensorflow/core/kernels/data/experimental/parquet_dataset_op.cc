@@ -0,0 +1,429 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/data/experimental/parquet/parquet_reader.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kDatasetType[] = "Parquet";
+constexpr char kFilenames[] = "filenames";
+constexpr char kBatchSize[] = "batch_size";
+constexpr char kFilterLower[] = "filter_lower";
+constexpr char kFilterUpper[] = "filter_upper";
+constexpr char kColumnNames[] = "column_names";
+constexpr char kFilterColumn[] = "filter_column";
+constexpr char kOutputTypes[] = "output_types";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kFileIndex[] = "file_index";
+constexpr char kRowGroup[] = "row_group";
+constexpr char kRowOffset[] = "row_offset";
+
+// Returns the indices of the rows of `values` in [`lower`, `upper`].
+Status RowsInRange(const Tensor& values, double lower, double upper,
+                   std::vector<int64_t>* rows) {
+  rows->clear();
+  switch (values.dtype()) {
+#define HANDLE_TYPE(T)                                          \
+  case DataTypeToEnum<T>::value: {                              \
+    auto flat = values.flat<T>();                               \
+    for (int64_t i = 0; i < flat.size(); ++i) {                 \
+      const double value = static_cast<double>(flat(i));        \
+      if (value >= lower && value <= upper) rows->push_back(i); \
+    }                                                           \
+    return OkStatus();                                          \
+  }
+    HANDLE_TYPE(bool);
+    HANDLE_TYPE(int32_t);
+    HANDLE_TYPE(int64_t);
+    HANDLE_TYPE(float);
+    HANDLE_TYPE(double);
+#undef HANDLE_TYPE
+    default:
+      return errors::InvalidArgument("Cannot filter on a column of type ",
+                                     DataTypeString(values.dtype()));
+  }
+}
+
+// Returns the `rows` of `values`.
+Status GatherRows(const Tensor& values, const std::vector<int64_t>& rows,
+                  Tensor* output) {
+  *output = Tensor(values.dtype(),
+                   TensorShape({static_cast<int64_t>(rows.size())}));
+  switch (values.dtype()) {
+#define HANDLE_TYPE(T)                                              \
+  case DataTypeToEnum<T>::value: {                                  \
+    auto from = values.flat<T>();                                   \
+    auto to = output->flat<T>();                                    \
+    for (size_t i = 0; i < rows.size(); ++i) to(i) = from(rows[i]); \
+    return OkStatus();                                              \
+  }
+    HANDLE_TYPE(bool);
+    HANDLE_TYPE(int32_t);
+    HANDLE_TYPE(int64_t);
+    HANDLE_TYPE(float);
+    HANDLE_TYPE(double);
+    HANDLE_TYPE(tstring);
+#undef HANDLE_TYPE
+    default:
+      return errors::Unimplemented("Unsupported type ",
+                                   DataTypeString(values.dtype()));
+  }
+}
+
+// Reads batches of rows of the `column_names` columns of Parquet files, one
+// vector per column. Only the projected columns are read, a row group at a
+// time, and each column chunk is decoded directly into the tensor the batches
+// are sliced from. If `filter_column` is set, only the rows whose value in
+// that column is in [`filter_lower`, `filter_upper`] are produced, and row
+// groups whose statistics rule out any such row are not read at all.
+class ParquetDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ParquetDatasetOp(OpKernelConstruction* ctx) : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kColumnNames, &column_names_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kFilterColumn, &filter_column_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+    OP_REQUIRES(ctx, output_types_.size() == column_names_.size(),
+                errors::InvalidArgument(
+                    "`output_types` must have an element per column, but got ",
+                    output_types_.size(), " types for ", column_names_.size(),
+                    " columns."));
+    for (const PartialTensorShape& shape : output_shapes_) {
+      OP_REQUIRES(ctx, shape.dims() == 1,
+                  errors::InvalidArgument(
+                      "Each element of `output_shapes` must be a vector."));
+    }
+  }
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input(kFilenames, &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<std::string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    }
+
+    int64_t batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64_t>(ctx, kBatchSize, &batch_size));
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument("`batch_size` must be positive."));
+    double filter_lower, filter_upper;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<double>(ctx, kFilterLower, &filter_lower));
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<double>(ctx, kFilterUpper, &filter_upper));
+
+    *output = new Dataset(ctx, std::move(filenames), batch_size, filter_lower,
+                          filter_upper, column_names_, filter_column_,
+                          output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<std::string> filenames,
+            int64_t batch_size, double filter_lower, double filter_upper,
+            const std::vector<std::string>& column_names,
+            const std::string& filter_column,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          batch_size_(batch_size),
+          filter_lower_(filter_lower),
+          filter_upper_(filter_upper),
+          column_names_(column_names),
+          filter_column_(filter_column),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::make_unique<Iterator>(Iterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return name_utils::DatasetDebugString(kDatasetType);
+    }
+
+    int64_t CardinalityInternal(CardinalityOptions options) const override {
+      return kUnknownCardinality;
+    }
+
+    Status InputDatasets(
+        std::vector<const DatasetBase*>* inputs) const override {
+      return OkStatus();
+    }
+
+    Status CheckExternalState() const override { return OkStatus(); }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* batch_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+      Node* filter_lower = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_lower_, &filter_lower));
+      Node* filter_upper = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(filter_upper_, &filter_upper));
+      AttrValue column_names;
+      b->BuildAttrValue(column_names_, &column_names);
+      AttrValue filter_column;
+      b->BuildAttrValue(filter_column_, &filter_column);
+      return b->AddDataset(
+          this, {filenames, batch_size, filter_lower, filter_upper},
+          {{kColumnNames, column_names}, {kFilterColumn, filter_column}},
+          output);
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        const int num_columns = dataset()->column_names_.size();
+        std::vector<std::vector<Tensor>> slices(num_columns);
+        int64_t num_rows = 0;
+        while (num_rows < dataset()->batch_size_) {
+          if (values_.empty()) {
+            bool end_of_files = false;
+            TF_RETURN_IF_ERROR(ReadRowGroup(ctx, &end_of_files));
+            if (end_of_files) break;
+          }
+          const int64_t available = values_[0].dim_size(0) - row_offset_;
+          if (available <= 0) {
+            values_.clear();
+            ++row_group_;
+            row_offset_ = 0;
+            continue;
+          }
+          const int64_t n =
+              std::min(available, dataset()->batch_size_ - num_rows);
+          for (int i = 0; i < num_columns; ++i) {
+            slices[i].push_back(values_[i].Slice(row_offset_, row_offset_ + n));
+          }
+          row_offset_ += n;
+          num_rows += n;
+        }
+        if (num_rows == 0) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        *end_of_sequence = false;
+        out_tensors->reserve(num_columns);
+        for (int i = 0; i < num_columns; ++i) {
+          if (slices[i].size() > 1) {
+            out_tensors->emplace_back();
+            TF_RETURN_IF_ERROR(tensor::Concat(slices[i], &out_tensors->back()));
+          } else if (slices[i][0].IsAligned()) {
+            // Shares the buffer the column chunk was decoded into.
+            out_tensors->push_back(std::move(slices[i][0]));
+          } else {
+            out_tensors->push_back(tensor::DeepCopy(slices[i][0]));
+          }
+        }
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kFileIndex, file_index_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kRowGroup, row_group_));
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(prefix(), kRowOffset, row_offset_));
+        return OkStatus();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kFileIndex, &file_index_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kRowGroup, &row_group_));
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(prefix(), kRowOffset, &row_offset_));
+        // The row group is read again on the next call to GetNext.
+        parquet_reader_.reset();
+        values_.clear();
+        return OkStatus();
+      }
+
+     private:
+      // Reads the next row group that may have rows passing the filter into
+      // `values_`, opening the next file as needed.
+      Status ReadRowGroup(IteratorContext* ctx, bool* end_of_files)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (true) {
+          if (parquet_reader_ == nullptr) {
+            if (file_index_ >= dataset()->filenames_.size()) {
+              *end_of_files = true;
+              return OkStatus();
+            }
+            TF_RETURN_IF_ERROR(OpenFile(ctx));
+          }
+          if (row_group_ >= parquet_reader_->num_row_groups()) {
+            parquet_reader_.reset();
+            ++file_index_;
+            row_group_ = 0;
+            row_offset_ = 0;
+            continue;
+          }
+          if (filter_column_ >= 0 &&
+              !parquet_reader_->RowGroupMayContain(row_group_, filter_column_,
+                                                   dataset()->filter_lower_,
+                                                   dataset()->filter_upper_)) {
+            ++row_group_;
+            row_offset_ = 0;
+            continue;
+          }
+          break;
+        }
+
+        std::vector<int> columns = columns_;
+        if (filter_column_ >= 0) columns.push_back(filter_column_);
+        TF_RETURN_IF_ERROR(
+            parquet_reader_->ReadRowGroup(row_group_, columns, &values_));
+        if (filter_column_ < 0) return OkStatus();
+        std::vector<int64_t> rows;
+        TF_RETURN_IF_ERROR(RowsInRange(values_.back(), dataset()->filter_lower_,
+                                       dataset()->filter_upper_, &rows));
+        values_.pop_back();
+        if (rows.size() == values_[0].dim_size(0)) return OkStatus();
+        for (Tensor& values : values_) {
+          Tensor filtered;
+          TF_RETURN_IF_ERROR(GatherRows(values, rows, &filtered));
+          values = std::move(filtered);
+        }
+        return OkStatus();
+      }
+
+      Status OpenFile(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const std::string& filename = dataset()->filenames_[file_index_];
+        TF_RETURN_IF_ERROR(
+            ParquetReader::Open(ctx->env(), filename, &parquet_reader_));
+        columns_.clear();
+        for (int i = 0; i < dataset()->column_names_.size(); ++i) {
+          const std::string& name = dataset()->column_names_[i];
+          const int column = parquet_reader_->FindColumn(name);
+          if (column < 0) {
+            return errors::InvalidArgument("Column ", name,
+                                           " not found in Parquet file ",
+                                           filename);
+          }
+          const DataType dtype = parquet_reader_->columns()[column].dtype;
+          if (dtype != dataset()->output_types_[i]) {
+            return errors::InvalidArgument(
+                "Column ", name, " of Parquet file ", filename, " has type ",
+                DataTypeString(dtype), ", but ",
+                DataTypeString(dataset()->output_types_[i]),
+                " was expected.");
+          }
+          columns_.push_back(column);
+        }
+        filter_column_ = -1;
+        if (!dataset()->filter_column_.empty()) {
+          filter_column_ =
+              parquet_reader_->FindColumn(dataset()->filter_column_);
+          if (filter_column_ < 0) {
+            return errors::InvalidArgument("Column ", dataset()->filter_column_,
+                                           " not found in Parquet file ",
+                                           filename);
+          }
+        }
+        return OkStatus();
+      }
+
+      mutex mu_;
+      int64_t file_index_ TF_GUARDED_BY(mu_) = 0;
+      int64_t row_group_ TF_GUARDED_BY(mu_) = 0;
+      // The number of rows of `values_` already produced.
+      int64_t row_offset_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<ParquetReader> parquet_reader_ TF_GUARDED_BY(mu_);
+      // The indices of the projected and filter columns in the current file.
+      std::vector<int> columns_ TF_GUARDED_BY(mu_);
+      int filter_column_ TF_GUARDED_BY(mu_) = -1;
+      // The rows of the current row group that pass the filter, a tensor per
+      // projected column. Empty if the row group has not been read yet.
+      std::vector<Tensor> values_ TF_GUARDED_BY(mu_);
+    };
+
+    const std::vector<std::string> filenames_;
+    const int64_t batch_size_;
+    const double filter_lower_;
+    const double filter_upper_;
+    const std::vector<std::string> column_names_;
+    const std::string filter_column_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  std::vector<std::string> column_names_;
+  std::string filter_column_;
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ParquetDataset").Device(DEVICE_CPU),
+                        ParquetDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,445 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/profiler/lib/traceme_encode.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kDatasetType[] = "PrefetchToDevice";
+constexpr char kBufferSize[] = "buffer_size";
+constexpr char kMaxDeviceBytes[] = "max_device_bytes";
+constexpr char kOutputTypes[] = "output_types";
+constexpr char kOutputShapes[] = "output_shapes";
+
+// Prefetches the elements of its input into the memory of the device it is
+// placed on, so that the host-to-device copy of an element overlaps with the
+// consumption of the previous ones instead of sitting on the critical path of
+// the step.
+//
+// A background thread reads host elements from the input and enqueues their
+// copies on the device context of the op, whose host-to-device stream stages
+// pageable memory through pinned buffers. The thread does not wait for a copy
+// to finish before reading the next element, so up to `buffer_size` elements
+// are being copied or waiting in device memory at any time. Producing stops
+// while the buffered elements use `max_device_bytes` or more, or when the
+// device allocator is out of memory, until the consumer catches up.
+class PrefetchToDeviceDatasetOp : public UnaryDatasetOpKernel {
+ public:
+  explicit PrefetchToDeviceDatasetOp(OpKernelConstruction* ctx)
+      : UnaryDatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  }
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
+                   DatasetBase** output) override {
+    int64_t buffer_size;
+    OP_REQUIRES_OK(
+        ctx, ParseScalarArgument<int64_t>(ctx, kBufferSize, &buffer_size));
+    OP_REQUIRES(ctx, buffer_size > 0,
+                errors::InvalidArgument("`buffer_size` must be positive, got ",
+                                        buffer_size));
+    int64_t max_device_bytes;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kMaxDeviceBytes,
+                                                     &max_device_bytes));
+    OP_REQUIRES(ctx, max_device_bytes >= 0,
+                errors::InvalidArgument(
+                    "`max_device_bytes` must be non-negative, got ",
+                    max_device_bytes));
+    OP_REQUIRES(ctx, ctx->op_device_context() != nullptr,
+                errors::FailedPrecondition(
+                    "PrefetchToDeviceDataset must be placed on the device to "
+                    "copy its elements to, but ",
+                    ctx->device()->name(), " has no device context."));
+    *output = new Dataset(ctx, input, buffer_size, max_device_bytes,
+                          output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const DatasetBase* input,
+            int64_t buffer_size, int64_t max_device_bytes,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          input_(input),
+          buffer_size_(buffer_size),
+          max_device_bytes_(max_device_bytes),
+          device_(static_cast<Device*>(ctx->device())),
+          device_context_(ctx->op_device_context()),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {
+      input_->Ref();
+      device_context_->Ref();
+    }
+
+    ~Dataset() override {
+      input_->Unref();
+      device_context_->Unref();
+    }
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::make_unique<Iterator>(Iterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return name_utils::DatasetDebugString(kDatasetType);
+    }
+
+    int64_t CardinalityInternal(CardinalityOptions options) const override {
+      return input_->Cardinality(options);
+    }
+
+    Status InputDatasets(
+        std::vector<const DatasetBase*>* inputs) const override {
+      inputs->push_back(input_);
+      return OkStatus();
+    }
+
+    Status CheckExternalState() const override {
+      return input_->CheckExternalState();
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* input_graph_node = nullptr;
+      TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+      Node* buffer_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size));
+      Node* max_device_bytes = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(max_device_bytes_, &max_device_bytes));
+      return b->AddDataset(this,
+                           {input_graph_node, buffer_size, max_device_bytes},
+                           output);
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        CancelThreads();
+        if (deregister_fn_) deregister_fn_();
+        std::unique_ptr<Thread> prefetch_thread;
+        {
+          mutex_lock l(mu_);
+          prefetch_thread = std::move(prefetch_thread_);
+        }
+        // Joins the thread, so that no more copies are enqueued.
+        prefetch_thread.reset();
+        // The copy callbacks refer to the iterator.
+        mutex_lock l(mu_);
+        while (num_pending_copies_ > 0) {
+          cond_var_.wait(l);
+        }
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        cancellation_manager_ = std::make_unique<CancellationManager>();
+        TF_RETURN_IF_ERROR(RegisterCancellationCallback(
+            ctx->cancellation_manager(), [this]() { CancelThreads(); },
+            &deregister_fn_));
+        IteratorContext::Params params(ctx);
+        params.cancellation_manager = cancellation_manager_.get();
+        IteratorContext iter_ctx(params);
+        TF_RETURN_IF_ERROR(dataset()->input_->MakeIterator(
+            &iter_ctx, this, prefix(), &input_impl_));
+        ctx->MergeCheckpoint(iter_ctx.checkpoint());
+        return OkStatus();
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        EnsureThreadStarted(ctx);
+        while (!cancelled_ && (buffer_.empty() || buffer_.front()->copying) &&
+               !(buffer_.empty() && prefetch_thread_finished_)) {
+          RecordStop(ctx);
+          cond_var_.wait(l);
+          RecordStart(ctx);
+        }
+        if (cancelled_) {
+          return errors::Cancelled("Iterator was cancelled");
+        }
+        if (buffer_.empty()) {
+          *end_of_sequence = true;
+          return OkStatus();
+        }
+        std::shared_ptr<Element> element = std::move(buffer_.front());
+        buffer_.pop_front();
+        device_bytes_ -= element->device_bytes;
+        cond_var_.notify_all();
+        *end_of_sequence = false;
+        if (!element->status.ok()) return element->status;
+        *out_tensors = std::move(element->value);
+        return OkStatus();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        // The buffer is in device memory, so it is not recorded against the
+        // RAM budget of the model.
+        return model::MakeAsyncKnownRatioNode(std::move(args),
+                                              /*ratio=*/1,
+                                              /*parameters=*/{});
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            dataset()->DebugString(), " does not support checkpointing.");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            dataset()->DebugString(), " does not support checkpointing.");
+      }
+
+     private:
+      struct Element {
+        Status status;
+        // The device tensors, and the host tensors whose types live in host
+        // memory on the device.
+        std::vector<Tensor> value;
+        // The sources of the copies in flight, kept alive until they finish.
+        std::vector<Tensor> host_value;
+        int64_t device_bytes = 0;
+        int64_t num_pending_copies = 0;
+        // Whether copies of the element are still in flight.
+        bool copying = false;
+      };
+
+      void CancelThreads() TF_LOCKS_EXCLUDED(mu_) {
+        if (cancellation_manager_) cancellation_manager_->StartCancel();
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+
+      void EnsureThreadStarted(IteratorContext* ctx)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (!prefetch_thread_) {
+          std::shared_ptr<IteratorContext> new_ctx =
+              std::make_shared<IteratorContext>(*ctx);
+          prefetch_thread_ = ctx->StartThread(
+              "tf_data_prefetch_to_device",
+              [this, new_ctx]() { PrefetchThread(new_ctx); });
+        }
+      }
+
+      bool BufferFull() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        if (buffer_.size() >= dataset()->buffer_size_) return true;
+        return dataset()->max_device_bytes_ > 0 && !buffer_.empty() &&
+               device_bytes_ >= dataset()->max_device_bytes_;
+      }
+
+      void PrefetchThread(const std::shared_ptr<IteratorContext>& ctx) {
+        RecordStart(ctx.get());
+        auto cleanup = gtl::MakeCleanup([this, ctx] {
+          RecordStop(ctx.get());
+          mutex_lock l(mu_);
+          prefetch_thread_finished_ = true;
+          cond_var_.notify_all();
+        });
+        while (true) {
+          {
+            mutex_lock l(mu_);
+            while (!cancelled_ && BufferFull()) {
+              RecordStop(ctx.get());
+              cond_var_.wait(l);
+              RecordStart(ctx.get());
+            }
+            if (cancelled_) return;
+          }
+          auto element = std::make_shared<Element>();
+          std::vector<Tensor> host_value;
+          bool end_of_sequence = false;
+          element->status =
+              input_impl_->GetNext(ctx.get(), &host_value, &end_of_sequence);
+          if (element->status.ok() && end_of_sequence) return;
+          if (element->status.ok()) {
+            element->status = CopyToDevice(std::move(host_value), element);
+          }
+          mutex_lock l(mu_);
+          buffer_.push_back(std::move(element));
+          cond_var_.notify_all();
+        }
+      }
+
+      // Enqueues the copies of `host_value` to the device, and marks `element`
+      // as copying until they finish.
+      Status CopyToDevice(std::vector<Tensor> host_value,
+                          const std::shared_ptr<Element>& element) {
+        profiler::TraceMe traceme(
+            [&] {
+              return profiler::TraceMeEncode(
+                  "PrefetchToDeviceCopy",
+                  {{"num_components", host_value.size()}});
+            },
+            profiler::kInfo);
+        std::vector<int> to_copy;
+        // The element is charged to `device_bytes_` only once all its
+        // tensors are allocated, so that a failed element, which is still
+        // buffered to report its error, is never uncharged for memory it
+        // does not hold.
+        int64_t device_bytes = 0;
+        element->value.resize(host_value.size());
+        for (int i = 0; i < host_value.size(); ++i) {
+          const Tensor& host_tensor = host_value[i];
+          if (MTypeFromDType(host_tensor.dtype()) == HOST_MEMORY ||
+              host_tensor.NumElements() == 0) {
+            element->value[i] = host_tensor;
+            continue;
+          }
+          Status s = AllocateDeviceTensor(host_tensor, &element->value[i]);
+          if (!s.ok()) {
+            element->value.clear();
+            return s;
+          }
+          device_bytes += element->value[i].TotalBytes();
+          to_copy.push_back(i);
+        }
+        if (to_copy.empty()) return OkStatus();
+        {
+          mutex_lock l(mu_);
+          element->copying = true;
+          element->num_pending_copies = to_copy.size();
+          element->device_bytes = device_bytes;
+          num_pending_copies_ += to_copy.size();
+          device_bytes_ += device_bytes;
+        }
+        // Set up all the copies before the first one can finish.
+        element->host_value = std::move(host_value);
+        for (int i : to_copy) {
+          dataset()->device_context_->CopyCPUTensorToDevice(
+              &element->host_value[i], dataset()->device_,
+              &element->value[i], [this, element](const Status& status) {
+                mutex_lock l(mu_);
+                element->status.Update(status);
+                --num_pending_copies_;
+                if (--element->num_pending_copies == 0) {
+                  element->copying = false;
+                  element->host_value.clear();
+                }
+                cond_var_.notify_all();
+              });
+        }
+        return OkStatus();
+      }
+
+      // Allocates a device tensor like `host_tensor`. If the device is out of
+      // memory, waits for the consumer to take the buffered elements first.
+      Status AllocateDeviceTensor(const Tensor& host_tensor, Tensor* out) {
+        Allocator* allocator = dataset()->device_->GetAllocator({});
+        AllocationAttributes attr;
+        attr.retry_on_failure = false;
+        *out =
+            Tensor(allocator, host_tensor.dtype(), host_tensor.shape(), attr);
+        if (out->IsInitialized()) return OkStatus();
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && !buffer_.empty()) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_) return errors::Cancelled("Iterator was cancelled");
+        }
+        *out = Tensor(allocator, host_tensor.dtype(), host_tensor.shape());
+        if (out->IsInitialized()) return OkStatus();
+        return errors::ResourceExhausted(
+            "Failed to allocate ", host_tensor.TotalBytes(), " bytes on ",
+            dataset()->device_->name(), " to prefetch an element.");
+      }
+
+      mutex mu_;
+      condition_variable cond_var_;
+      std::unique_ptr<CancellationManager> cancellation_manager_;
+      std::unique_ptr<IteratorBase> input_impl_;
+      std::deque<std::shared_ptr<Element>> buffer_ TF_GUARDED_BY(mu_);
+      // The device memory used by the buffered elements.
+      int64_t device_bytes_ TF_GUARDED_BY(mu_) = 0;
+      int64_t num_pending_copies_ TF_GUARDED_BY(mu_) = 0;
+      bool cancelled_ TF_GUARDED_BY(mu_) = false;
+      bool prefetch_thread_finished_ TF_GUARDED_BY(mu_) = false;
+      std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(mu_);
+      std::function<void()> deregister_fn_;
+    };
+
+    const DatasetBase* const input_;
+    const int64_t buffer_size_;
+    const int64_t max_device_bytes_;
+    Device* const device_;                 // Not owned.
+    DeviceContext* const device_context_;  // Ref-counted.
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("PrefetchToDeviceDataset")
+                            .Device(DEVICE_GPU)
+                            .HostMemory("input_dataset")
+                            .HostMemory("buffer_size")
+                            .HostMemory("max_device_bytes")
+                            .HostMemory("handle"),
+                        PrefetchToDeviceDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
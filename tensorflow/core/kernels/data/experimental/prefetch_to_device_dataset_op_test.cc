@@ -0,0 +1,205 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+constexpr char kNodeName[] = "prefetch_to_device_dataset";
+
+// The op only has a GPU kernel, while the inputs of the test are made by CPU
+// kernels. So the input dataset is made on the CPU device of the test base,
+// and the op is then run on a GPU device replacing it.
+class PrefetchToDeviceDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Makes a PrefetchToDeviceDataset of the slices of `components` on the GPU,
+  // and an iterator over it.
+  Status Initialize(std::vector<Tensor> components, int64_t buffer_size,
+                    int64_t max_device_bytes) {
+    DataTypeVector output_dtypes;
+    std::vector<PartialTensorShape> output_shapes;
+    for (const Tensor& component : components) {
+      output_dtypes.push_back(component.dtype());
+      TensorShape shape = component.shape();
+      shape.RemoveDim(0);
+      output_shapes.push_back(PartialTensorShape(shape.dim_sizes()));
+    }
+    TensorSliceDatasetParams input_params(std::move(components),
+                                          "tensor_slice_dataset");
+    TF_RETURN_IF_ERROR(InitializeRuntime(input_params));
+    TF_RETURN_IF_ERROR(MakeDataset(input_params, &input_dataset_));
+    input_dataset_tensor_ = Tensor(DT_VARIANT, TensorShape({}));
+    // The variant tensor takes a reference of its own.
+    input_dataset_->dataset()->Ref();
+    TF_RETURN_IF_ERROR(StoreDatasetInVariantTensor(input_dataset_->dataset(),
+                                                   &input_dataset_tensor_));
+
+    cpu_device_ = std::exchange(
+        device_,
+        DeviceFactory::NewDevice("GPU", {}, "/job:a/replica:0/task:0"));
+    if (device_ == nullptr) {
+      return errors::Unavailable("No GPU device is available.");
+    }
+    device_type_ = DeviceType(DEVICE_GPU);
+    allocator_ = device_->GetAllocator(AllocatorAttributes());
+
+    NodeDef node_def = test::function::NDef(
+        kNodeName, "PrefetchToDeviceDataset",
+        {"input_dataset", "buffer_size", "max_device_bytes"},
+        {{"output_types", output_dtypes}, {"output_shapes", output_shapes}});
+    TF_RETURN_IF_ERROR(CreateOpKernel(node_def, &kernel_));
+    buffer_size_ = CreateTensor<int64_t>(TensorShape({}), {buffer_size});
+    max_device_bytes_ =
+        CreateTensor<int64_t>(TensorShape({}), {max_device_bytes});
+    gtl::InlinedVector<TensorValue, 4> inputs = {
+        TensorValue(&input_dataset_tensor_), TensorValue(&buffer_size_),
+        TensorValue(&max_device_bytes_)};
+    TF_RETURN_IF_ERROR(
+        CreateDatasetContext(kernel_.get(), &inputs, &ctx_params_, &ctx_));
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(CreateDataset(kernel_.get(), ctx_.get(), &dataset));
+    dataset_ref_ = core::RefCountPtr<DatasetBase>(dataset);
+    TF_RETURN_IF_ERROR(CreateIteratorContext(ctx_.get(), &iterator_ctx_));
+    return dataset->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                 "Iterator::PrefetchToDevice", &iterator_);
+  }
+
+  // Reads all the elements of the iterator, copied back to host memory.
+  Status GetAllElements(std::vector<Tensor>* out) {
+    DeviceContext* device_context =
+        device_->tensorflow_accelerator_device_info()->default_context;
+    bool end_of_sequence = false;
+    while (true) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      if (end_of_sequence) return OkStatus();
+      for (const Tensor& t : next) {
+        if (MTypeFromDType(t.dtype()) == HOST_MEMORY) {
+          out->push_back(t);
+          continue;
+        }
+        Tensor host(cpu_allocator(), t.dtype(), t.shape());
+        TF_RETURN_IF_ERROR(device_context->CopyDeviceTensorToCPUSync(
+            &t, "", device_.get(), &host));
+        out->push_back(std::move(host));
+      }
+    }
+  }
+
+  // Declared first so that it outlives the input dataset made on it.
+  std::unique_ptr<Device> cpu_device_;
+  std::unique_ptr<TestDataset> input_dataset_;
+  Tensor input_dataset_tensor_;
+  Tensor buffer_size_;
+  Tensor max_device_bytes_;
+  std::unique_ptr<OpKernel> kernel_;
+  std::unique_ptr<OpKernelContext::Params> ctx_params_;
+  std::unique_ptr<OpKernelContext> ctx_;
+  core::RefCountPtr<DatasetBase> dataset_ref_;
+  std::unique_ptr<IteratorContext> iterator_ctx_;
+  std::unique_ptr<IteratorBase> iterator_;
+};
+
+TEST_F(PrefetchToDeviceDatasetOpTest, CopiesElements) {
+  TF_ASSERT_OK(Initialize(
+      {CreateTensor<float>(TensorShape({4, 2}), {0, 1, 2, 3, 4, 5, 6, 7}),
+       CreateTensor<int64_t>(TensorShape({4}), {10, 11, 12, 13})},
+      /*buffer_size=*/2, /*max_device_bytes=*/0));
+  std::vector<Tensor> elements;
+  TF_ASSERT_OK(GetAllElements(&elements));
+  std::vector<Tensor> expected;
+  for (int i = 0; i < 4; ++i) {
+    expected.push_back(CreateTensor<float>(TensorShape({2}),
+                                           {2.0f * i, 2.0f * i + 1}));
+    expected.push_back(CreateTensor<int64_t>(TensorShape({}), {10 + i}));
+  }
+  TF_EXPECT_OK(ExpectEqual(elements, expected, /*compare_order=*/true));
+}
+
+TEST_F(PrefetchToDeviceDatasetOpTest, PassesHostMemoryComponentsThrough) {
+  TF_ASSERT_OK(Initialize(
+      {CreateTensor<int32>(TensorShape({3}), {1, 2, 3}),
+       CreateTensor<tstring>(TensorShape({3}), {"a", "b", "c"})},
+      /*buffer_size=*/1, /*max_device_bytes=*/0));
+  std::vector<Tensor> elements;
+  TF_ASSERT_OK(GetAllElements(&elements));
+  TF_EXPECT_OK(ExpectEqual(
+      elements,
+      {CreateTensor<int32>(TensorShape({}), {1}),
+       CreateTensor<tstring>(TensorShape({}), {"a"}),
+       CreateTensor<int32>(TensorShape({}), {2}),
+       CreateTensor<tstring>(TensorShape({}), {"b"}),
+       CreateTensor<int32>(TensorShape({}), {3}),
+       CreateTensor<tstring>(TensorShape({}), {"c"})},
+      /*compare_order=*/true));
+}
+
+// With a device memory budget smaller than one element, elements are still
+// produced one at a time.
+TEST_F(PrefetchToDeviceDatasetOpTest, MaxDeviceBytesSmallerThanElement) {
+  TF_ASSERT_OK(Initialize(
+      {CreateTensor<int64_t>(TensorShape({5, 3}),
+                             {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                              14})},
+      /*buffer_size=*/4, /*max_device_bytes=*/1));
+  std::vector<Tensor> elements;
+  TF_ASSERT_OK(GetAllElements(&elements));
+  std::vector<Tensor> expected;
+  for (int i = 0; i < 5; ++i) {
+    expected.push_back(CreateTensor<int64_t>(TensorShape({3}),
+                                             {3 * i, 3 * i + 1, 3 * i + 2}));
+  }
+  TF_EXPECT_OK(ExpectEqual(elements, expected, /*compare_order=*/true));
+}
+
+TEST_F(PrefetchToDeviceDatasetOpTest, EmptyInput) {
+  TF_ASSERT_OK(Initialize({CreateTensor<float>(TensorShape({0, 2}), {})},
+                          /*buffer_size=*/2, /*max_device_bytes=*/0));
+  std::vector<Tensor> elements;
+  TF_ASSERT_OK(GetAllElements(&elements));
+  EXPECT_TRUE(elements.empty());
+}
+
+TEST_F(PrefetchToDeviceDatasetOpTest, InvalidBufferSize) {
+  EXPECT_EQ(Initialize({CreateTensor<float>(TensorShape({2}), {0, 1})},
+                       /*buffer_size=*/0, /*max_device_bytes=*/0)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+TEST_F(PrefetchToDeviceDatasetOpTest, InvalidMaxDeviceBytes) {
+  EXPECT_EQ(Initialize({CreateTensor<float>(TensorShape({2}), {0, 1})},
+                       /*buffer_size=*/1, /*max_device_bytes=*/-1)
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+}
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,311 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/root_dataset.h"
+#include "tensorflow/core/data/shared_memory_ring.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/function_handle_cache.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/resource.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kDatasetType[] = "SharedMemory";
+constexpr char kPath[] = "path";
+constexpr char kOutputTypes[] = "output_types";
+constexpr char kOutputShapes[] = "output_shapes";
+// How often consumers check whether the producer has created the ring.
+constexpr int64_t kAttachRetryMicros = 10 * 1000;
+
+// Reads the elements a `DatasetToSharedMemory` op publishes on the same host,
+// without copying them. See `SharedMemoryRing`.
+class SharedMemoryDatasetOp : public DatasetOpKernel {
+ public:
+  explicit SharedMemoryDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputTypes, &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
+  }
+
+ protected:
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    tstring path;
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<tstring>(ctx, kPath, &path));
+    *output = new Dataset(ctx, path, output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, const std::string& path,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          path_(path),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return std::make_unique<Iterator>(Iterator::Params{
+          this, name_utils::IteratorPrefix(kDatasetType, prefix)});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return name_utils::DatasetDebugString(kDatasetType);
+    }
+
+    int64_t CardinalityInternal(CardinalityOptions options) const override {
+      return kUnknownCardinality;
+    }
+
+    Status InputDatasets(
+        std::vector<const DatasetBase*>* inputs) const override {
+      return OkStatus();
+    }
+
+    // The elements come from another process.
+    Status CheckExternalState() const override {
+      return errors::FailedPrecondition(
+          DebugString(), " depends on the process producing its elements.");
+    }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* path = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(path_, &path));
+      return b->AddDataset(this, {path}, output);
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      ~Iterator() override {
+        if (deregister_fn_) deregister_fn_();
+      }
+
+      Status Initialize(IteratorContext* ctx) override {
+        return RegisterCancellationCallback(
+            ctx->cancellation_manager(),
+            [this]() {
+              cancelled_ = true;
+              mutex_lock l(mu_);
+              if (ring_ != nullptr) ring_->Cancel();
+            },
+            &deregister_fn_);
+      }
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        std::shared_ptr<SharedMemoryRing> ring;
+        {
+          mutex_lock l(mu_);
+          if (ring_ == nullptr) TF_RETURN_IF_ERROR(AttachRing(ctx));
+          ring = ring_;
+        }
+        RecordStop(ctx);
+        Status status = ring->Read(out_tensors, end_of_sequence);
+        RecordStart(ctx);
+        TF_RETURN_IF_ERROR(status);
+        if (*end_of_sequence) return OkStatus();
+        TF_RETURN_IF_ERROR(
+            VerifyTypesMatch(dataset()->output_types_, *out_tensors));
+        return VerifyShapesCompatible(dataset()->output_shapes_, *out_tensors);
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        return errors::Unimplemented(
+            dataset()->DebugString(), " does not support checkpointing.");
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        return errors::Unimplemented(
+            dataset()->DebugString(), " does not support checkpointing.");
+      }
+
+     private:
+      // Waits for the producer to create the ring.
+      Status AttachRing(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        while (true) {
+          StatusOr<std::unique_ptr<SharedMemoryRing>> ring =
+              SharedMemoryRing::Attach(dataset()->path_);
+          if (ring.ok()) {
+            ring_ = std::move(*ring);
+            return OkStatus();
+          }
+          if (!errors::IsNotFound(ring.status())) return ring.status();
+          if (cancelled_) {
+            return errors::Cancelled("Iterator was cancelled");
+          }
+          VLOG(2) << "Waiting for the shared memory ring at "
+                  << dataset()->path_;
+          ctx->env()->SleepForMicroseconds(kAttachRetryMicros);
+        }
+      }
+
+      std::atomic<bool> cancelled_{false};
+      mutex mu_;
+      std::shared_ptr<SharedMemoryRing> ring_ TF_GUARDED_BY(mu_);
+      std::function<void()> deregister_fn_;
+    };
+
+    const tstring path_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+// Runs a dataset and publishes its elements to the consumers of a
+// `SharedMemoryRing` at `path`, which read them with `SharedMemoryDataset`.
+// Returns once all the elements are written, or producing them failed, and all
+// the consumers have attached.
+class DatasetToSharedMemoryOp : public AsyncOpKernel {
+ public:
+  explicit DatasetToSharedMemoryOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx),
+        background_worker_(ctx->env(), "tf_data_to_shared_memory") {}
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    // The call to `iterator->GetNext()` may block and depend on an inter-op
+    // thread pool thread, so we issue the call using a background thread.
+    background_worker_.Schedule([this, ctx, done = std::move(done)]() {
+      OP_REQUIRES_OK_ASYNC(ctx, DoCompute(ctx), done);
+      done();
+    });
+  }
+
+ private:
+  Status DoCompute(OpKernelContext* ctx) {
+    tensorflow::ResourceTagger tag(kTFDataResourceTag,
+                                   ctx->op_kernel().type_string());
+    tstring path;
+    TF_RETURN_IF_ERROR(ParseScalarArgument<tstring>(ctx, kPath, &path));
+    SharedMemoryRing::Options options;
+    TF_RETURN_IF_ERROR(ParseScalarArgument<int64_t>(ctx, "num_consumers",
+                                                    &options.num_consumers));
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<int64_t>(ctx, "num_slots", &options.num_slots));
+    TF_RETURN_IF_ERROR(
+        ParseScalarArgument<int64_t>(ctx, "slot_bytes", &options.slot_bytes));
+
+    DatasetBase* dataset;
+    TF_RETURN_IF_ERROR(GetDatasetFromVariantTensor(ctx->input(0), &dataset));
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<SharedMemoryRing> ring,
+                        SharedMemoryRing::Create(path, options));
+    std::function<void()> deregister_fn;
+    TF_RETURN_IF_ERROR(RegisterCancellationCallback(
+        ctx->cancellation_manager(), [&ring]() { ring->Cancel(); },
+        &deregister_fn));
+    auto cleanup = gtl::MakeCleanup([&deregister_fn]() { deregister_fn(); });
+
+    const Status status = Publish(ctx, dataset, ring.get());
+    ring->Close(status);
+    // The file of the ring is removed when it is destroyed, so it is kept
+    // until all the consumers have attached, even on failure. Otherwise those
+    // still waiting for it to be created would never see the error.
+    const Status wait_status = ring->WaitForConsumers();
+    TF_RETURN_IF_ERROR(status);
+    return wait_status;
+  }
+
+  Status Publish(OpKernelContext* ctx, DatasetBase* dataset,
+                 SharedMemoryRing* ring) {
+    for (DataType dtype : dataset->output_dtypes()) {
+      if (!DataTypeCanUseMemcpy(dtype)) {
+        return errors::InvalidArgument(
+            "DatasetToSharedMemory does not support elements of type ",
+            DataTypeString(dtype));
+      }
+    }
+    IteratorContext::Params params(ctx);
+    FunctionHandleCache function_handle_cache(params.flr);
+    params.function_handle_cache = &function_handle_cache;
+    ResourceMgr resource_mgr;
+    params.resource_mgr = &resource_mgr;
+    CancellationManager cancellation_manager(ctx->cancellation_manager());
+    params.cancellation_manager = &cancellation_manager;
+
+    IteratorContext iter_ctx(std::move(params));
+    DatasetBase* finalized_dataset;
+    TF_RETURN_IF_ERROR(FinalizeDataset(ctx, dataset, &finalized_dataset));
+    core::ScopedUnref unref(finalized_dataset);
+
+    std::unique_ptr<IteratorBase> iterator;
+    TF_RETURN_IF_ERROR(finalized_dataset->MakeIterator(
+        &iter_ctx, /*parent=*/nullptr, "DatasetToSharedMemoryOpIterator",
+        &iterator));
+    std::vector<Tensor> components;
+    bool end_of_sequence = false;
+    while (true) {
+      components.clear();
+      TF_RETURN_IF_ERROR(
+          iterator->GetNext(&iter_ctx, &components, &end_of_sequence));
+      if (end_of_sequence) return OkStatus();
+      TF_RETURN_IF_ERROR(ring->Write(components));
+    }
+  }
+
+  BackgroundWorker background_worker_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("SharedMemoryDataset").Device(DEVICE_CPU),
+                        SharedMemoryDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("DatasetToSharedMemory").Device(DEVICE_CPU),
+                        DatasetToSharedMemoryOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,257 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+    http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/data/dataset_test_base.h"
+#include "tensorflow/core/data/shared_memory_ring.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/notification.h"
+#include "tensorflow/core/platform/path.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "shared_memory_dataset";
+
+class SharedMemoryDatasetParams : public DatasetParams {
+ public:
+  SharedMemoryDatasetParams(const std::string& path,
+                            DataTypeVector output_dtypes,
+                            std::vector<PartialTensorShape> output_shapes)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      kNodeName),
+        path_(path) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<tstring>(TensorShape({}), {path_})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {"path"};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attributes) const override {
+    *attributes = {{"output_types", output_dtypes_},
+                   {"output_shapes", output_shapes_},
+                   {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override { return "SharedMemory"; }
+
+ private:
+  const tstring path_;
+};
+
+std::string RingPath(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+class SharedMemoryDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Makes a DatasetToSharedMemory kernel publishing the elements of
+  // `input_params` at `path`. Must be called after the runtime is initialized
+  // and before the consumers are made, as making datasets replaces the
+  // cancellation manager of the test base.
+  Status MakeProducer(const DatasetParams& input_params,
+                      const std::string& path, int64_t num_consumers) {
+    std::unique_ptr<TestDataset> input;
+    TF_RETURN_IF_ERROR(MakeDataset(input_params, &input));
+    producer_inputs_.emplace_back(DT_VARIANT, TensorShape({}));
+    // The variant tensor takes a reference of its own.
+    input->dataset()->Ref();
+    TF_RETURN_IF_ERROR(
+        StoreDatasetInVariantTensor(input->dataset(), &producer_inputs_[0]));
+    producer_inputs_.push_back(
+        CreateTensor<tstring>(TensorShape({}), {path}));
+    producer_inputs_.push_back(
+        CreateTensor<int64_t>(TensorShape({}), {num_consumers}));
+    producer_inputs_.push_back(CreateTensor<int64_t>(TensorShape({}), {2}));
+    producer_inputs_.push_back(CreateTensor<int64_t>(TensorShape({}), {1024}));
+    return CreateOpKernel(
+        test::function::NDef(
+            "dataset_to_shared_memory", "DatasetToSharedMemory",
+            {"input_dataset", "path", "num_consumers", "num_slots",
+             "slot_bytes"},
+            {}),
+        &producer_);
+  }
+
+  // Runs the producer made by MakeProducer() until it returns.
+  Status RunProducer() {
+    gtl::InlinedVector<TensorValue, 4> inputs;
+    for (Tensor& t : producer_inputs_) inputs.emplace_back(&t);
+    OpKernelContext::Params params;
+    params.device = device_.get();
+    params.op_kernel = producer_.get();
+    params.inputs = inputs;
+    params.function_library = flr_;
+    params.resource_manager = resource_mgr_.get();
+    params.runner = &runner_;
+    params.cancellation_manager = &producer_cancellation_manager_;
+    OpKernelContext ctx(&params);
+    return RunOpKernel(producer_.get(), &ctx);
+  }
+
+  // Reads the elements of a SharedMemoryDataset at `path` until the end of
+  // the sequence or an error.
+  Status Consume(const SharedMemoryDatasetParams& params,
+                 std::vector<Tensor>* elements) {
+    std::unique_ptr<TestDataset> dataset;
+    TF_RETURN_IF_ERROR(MakeDataset(params, &dataset));
+    std::unique_ptr<TestIterator> iterator;
+    TF_RETURN_IF_ERROR(MakeIterator(params, *dataset, &iterator));
+    bool end_of_sequence = false;
+    while (true) {
+      std::vector<Tensor> next;
+      TF_RETURN_IF_ERROR(iterator->GetNext(&next, &end_of_sequence));
+      if (end_of_sequence) return OkStatus();
+      for (const Tensor& t : next) elements->push_back(tensor::DeepCopy(t));
+    }
+  }
+
+  std::vector<Tensor> producer_inputs_;
+  std::unique_ptr<OpKernel> producer_;
+  CancellationManager producer_cancellation_manager_;
+};
+
+TEST_F(SharedMemoryDatasetOpTest, ReadsElementsOfRing) {
+  const std::string path = RingPath("read");
+  SharedMemoryRing::Options options;
+  options.num_slots = 4;
+  options.slot_bytes = 1024;
+  TF_ASSERT_OK_AND_ASSIGN(auto ring, SharedMemoryRing::Create(path, options));
+  for (int64_t i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(
+        ring->Write({CreateTensor<int64_t>(TensorShape({2}), {i, 10 * i})}));
+  }
+  ring->Close(OkStatus());
+
+  SharedMemoryDatasetParams params(path, {DT_INT64},
+                                   {PartialTensorShape({2})});
+  TF_ASSERT_OK(Initialize(params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      {CreateTensor<int64_t>(TensorShape({2}), {0, 0}),
+       CreateTensor<int64_t>(TensorShape({2}), {1, 10}),
+       CreateTensor<int64_t>(TensorShape({2}), {2, 20})},
+      /*compare_order=*/true));
+}
+
+TEST_F(SharedMemoryDatasetOpTest, WaitsForRingToBeCreated) {
+  const std::string path = RingPath("wait");
+  SharedMemoryDatasetParams params(path, {DT_INT64}, {PartialTensorShape({})});
+  TF_ASSERT_OK(Initialize(params));
+
+  Notification read;
+  std::unique_ptr<Thread> producer(
+      Env::Default()->StartThread({}, "producer", [&path, &read]() {
+        Env::Default()->SleepForMicroseconds(50 * 1000);
+        SharedMemoryRing::Options options;
+        options.slot_bytes = 1024;
+        TF_ASSERT_OK_AND_ASSIGN(auto ring,
+                                SharedMemoryRing::Create(path, options));
+        TF_ASSERT_OK(
+            ring->Write({CreateTensor<int64_t>(TensorShape({}), {7})}));
+        ring->Close(OkStatus());
+        TF_ASSERT_OK(ring->WaitForConsumers());
+        read.WaitForNotification();
+      }));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      {CreateTensor<int64_t>(TensorShape({}), {7})}, /*compare_order=*/true));
+  read.Notify();
+}
+
+TEST_F(SharedMemoryDatasetOpTest, ReportsProducerError) {
+  const std::string path = RingPath("error");
+  SharedMemoryRing::Options options;
+  options.slot_bytes = 1024;
+  TF_ASSERT_OK_AND_ASSIGN(auto ring, SharedMemoryRing::Create(path, options));
+  TF_ASSERT_OK(ring->Write({CreateTensor<int64_t>(TensorShape({}), {1})}));
+  ring->Close(errors::Internal("Producer failed"));
+
+  SharedMemoryDatasetParams params(path, {DT_INT64}, {PartialTensorShape({})});
+  TF_ASSERT_OK(Initialize(params));
+  std::vector<Tensor> element;
+  bool end_of_sequence = false;
+  TF_ASSERT_OK(
+      iterator_->GetNext(iterator_ctx_.get(), &element, &end_of_sequence));
+  ASSERT_FALSE(end_of_sequence);
+  const Status status =
+      iterator_->GetNext(iterator_ctx_.get(), &element, &end_of_sequence);
+  EXPECT_TRUE(errors::IsAborted(status)) << status;
+  EXPECT_TRUE(absl::StrContains(status.message(), "Producer failed"))
+      << status;
+}
+
+TEST_F(SharedMemoryDatasetOpTest, DatasetToSharedMemoryPublishesElements) {
+  const std::string path = RingPath("publish");
+  SharedMemoryDatasetParams params(path, {DT_INT64}, {PartialTensorShape({})});
+  TF_ASSERT_OK(InitializeRuntime(params));
+  TF_ASSERT_OK(MakeProducer(RangeDatasetParams(0, 5, 1), path,
+                            /*num_consumers=*/1));
+  Status producer_status;
+  std::unique_ptr<Thread> producer(Env::Default()->StartThread(
+      {}, "producer",
+      [this, &producer_status]() { producer_status = RunProducer(); }));
+
+  std::vector<Tensor> elements;
+  TF_ASSERT_OK(Consume(params, &elements));
+  producer.reset();
+  TF_EXPECT_OK(producer_status);
+  std::vector<Tensor> expected;
+  for (int64_t i = 0; i < 5; ++i) {
+    expected.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  TF_EXPECT_OK(ExpectEqual(elements, expected, /*compare_order=*/true));
+}
+
+// A producer failing before its consumers attach keeps the ring until they do,
+// so that they fail too instead of waiting for the ring forever.
+TEST_F(SharedMemoryDatasetOpTest, DatasetToSharedMemoryErrorReachesConsumers) {
+  const std::string path = RingPath("publish_error");
+  SharedMemoryDatasetParams params(path, {DT_STRING},
+                                   {PartialTensorShape({})});
+  TF_ASSERT_OK(InitializeRuntime(params));
+  TF_ASSERT_OK(MakeProducer(
+      TensorSliceDatasetParams(
+          {CreateTensor<tstring>(TensorShape({2}), {"a", "b"})},
+          "tensor_slice_dataset"),
+      path, /*num_consumers=*/1));
+  Status producer_status;
+  std::unique_ptr<Thread> producer(Env::Default()->StartThread(
+      {}, "producer",
+      [this, &producer_status]() { producer_status = RunProducer(); }));
+
+  std::vector<Tensor> elements;
+  const Status consumer_status = Consume(params, &elements);
+  producer.reset();
+  EXPECT_TRUE(errors::IsInvalidArgument(producer_status)) << producer_status;
+  EXPECT_TRUE(errors::IsAborted(consumer_status)) << consumer_status;
+  EXPECT_TRUE(elements.empty());
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
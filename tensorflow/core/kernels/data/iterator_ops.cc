@@ -24,6 +24,8 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/core/activity_watcher/activity.h"
 #include "tensorflow/core/activity_watcher/activity_utils.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
+#include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/common_runtime/graph_runner.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -889,7 +891,10 @@ Status IteratorGetNextOp::DoCompute(OpKernelContext* ctx) {
   std::vector<Tensor> components;
   bool end_of_sequence = false;
 
+  const absl::Time get_next_start_time = absl::Now();
   TF_RETURN_IF_ERROR(iterator->GetNext(ctx, &components, &end_of_sequence));
+  RecordRequestLatency(kInputPipelineLatencyName,
+                       absl::Now() - get_next_start_time);
   if (end_of_sequence) {
     return errors::OutOfRange("End of sequence");
   }
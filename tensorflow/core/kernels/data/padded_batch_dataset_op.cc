@@ -233,7 +233,8 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
         return OkStatus();
       }
 
-      TF_RETURN_IF_ERROR(CopyBatch(ctx, batch_elements, out_tensors));
+      TF_RETURN_IF_ERROR(
+          CopyBatch(ctx, std::move(batch_elements), out_tensors));
       *end_of_sequence = false;
       return OkStatus();
     }
@@ -284,7 +285,7 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
     // locations. This would require a different GetNext() overload that
     // supports zero-copy, and might make sense in an optimization pass.
     Status CopyBatch(IteratorContext* ctx,
-                     const std::vector<std::vector<Tensor>>& batch_elements,
+                     std::vector<std::vector<Tensor>>&& batch_elements,
                      std::vector<Tensor>* out_tensors) {
       const size_t num_tuple_components = batch_elements[0].size();
       const int64_t num_batch_elements = batch_elements.size();
@@ -358,8 +359,8 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
           if (batch_elements[index][component_index].shape() ==
               component_shape) {
             TF_RETURN_IF_ERROR(batch_util::CopyElementToSlice(
-                batch_elements[index][component_index], &batch_component,
-                index));
+                std::move(batch_elements[index][component_index]),
+                &batch_component, index));
           } else {
             TF_RETURN_IF_ERROR(batch_util::CopyElementToLargerSlice(
                 batch_elements[index][component_index], &batch_component,
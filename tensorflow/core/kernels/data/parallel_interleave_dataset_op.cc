@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
@@ -120,6 +121,14 @@ constexpr int kDefaultCyclePrefetchFactor = 2;
 // match the behavior of the original implementation.
 constexpr double kDefaultPerIteratorPrefetchFactor = 2.0L;
 
+// In deterministic mode, the consumer waits on whichever cycle element is next
+// in order. To keep a slow element from stalling the others, each current cycle
+// element may buffer up to `kDeterministicLookaheadFactor` times its regular
+// share of results while the consumer waits. The results buffered beyond the
+// regular share by all current cycle elements together are bounded by
+// `cycle_length * buffer_output_elements`.
+constexpr int kDeterministicLookaheadFactor = 4;
+
 // Period between reporting dataset statistics.
 constexpr int kStatsReportingPeriodMillis = 1000;
 
@@ -173,8 +182,14 @@ int64_t ComputePrefetchInputElements(int64_t configured_prefetch_input_elements,
 
 int64_t ComputeMaxBufferedElements(int64_t prefetch_input_elements,
                                    int64_t buffer_output_elements,
-                                   int64_t cycle_length) {
-  return (prefetch_input_elements + cycle_length) * buffer_output_elements;
+                                   int64_t cycle_length, bool deterministic) {
+  int64_t max_buffered_elements =
+      (prefetch_input_elements + cycle_length) * buffer_output_elements;
+  if (deterministic) {
+    // The lookahead budget of the current cycle elements.
+    max_buffered_elements += cycle_length * buffer_output_elements;
+  }
+  return max_buffered_elements;
 }
 
 int64_t OpVersionFromOpName(absl::string_view op_name) {
@@ -423,9 +438,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         while (!cancelled_ && !Consume(ctx, &result)) {
           RecordStop(ctx);
           if (deterministic_) {
-            VLOG(3) << "Blocked waiting for element "
-                    << current_elements_[cycle_index_]->id;
-            current_elements_[cycle_index_]->cond_var.wait(l);
+            std::shared_ptr<Element> element = current_elements_[cycle_index_];
+            VLOG(3) << "Blocked waiting for element " << element->id;
+            const int64_t wait_start_us = EnvTime::NowMicros();
+            element->cond_var.wait(l);
+            RecordStall(*element, EnvTime::NowMicros() - wait_start_us);
           } else {
             any_element_available_cond_var_.wait(l);
           }
@@ -481,7 +498,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
                kMaxBufferedElements,
                ComputeMaxBufferedElements(dataset()->prefetch_input_elements_,
                                           dataset()->buffer_output_elements_,
-                                          dataset()->cycle_length_))});
+                                          dataset()->cycle_length_,
+                                          deterministic_))});
     }
 
     Status SaveInternal(SerializationContext* ctx,
@@ -577,10 +595,14 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       int64_t parallelism = -1;
       int64_t results_ready = -1;
       int64_t active_elements = -1;
+      int64_t stall_time_us = -1;
+      int64_t max_input_stall_time_us = -1;
       // NOTE: We only set the parallelism value if the lock can be acquired
       // right away to avoid introducing tracing overhead.
       if (mu_->try_lock()) {
         parallelism = num_parallel_calls_->value;
+        stall_time_us = stall_time_us_;
+        max_input_stall_time_us = max_input_stall_time_us_;
         results_ready = 0;
         active_elements = 0;
         for (int i = 0; i < current_elements_.size(); ++i) {
@@ -609,6 +631,20 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           results_ready == -1 ? kTraceInfoUnavailable
                               : strings::Printf("%lld", static_cast<long long>(
                                                             active_elements))));
+      if (deterministic_) {
+        result.push_back(std::make_pair(
+            "stall_time_us",
+            stall_time_us == -1
+                ? kTraceInfoUnavailable
+                : strings::Printf("%lld",
+                                  static_cast<long long>(stall_time_us))));
+        result.push_back(std::make_pair(
+            "max_input_stall_time_us",
+            max_input_stall_time_us == -1
+                ? kTraceInfoUnavailable
+                : strings::Printf("%lld", static_cast<long long>(
+                                              max_input_stall_time_us))));
+      }
       result.push_back(std::make_pair(
           "interleave_depth",
           strings::Printf("%lld", static_cast<long long>(interleave_depth_))));
@@ -659,6 +695,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       // Whether we tried to initialize the element, but the input iterator
       // was exhausted so we could produce no inputs.
       bool no_input TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) = false;
+      // The time GetNext spent waiting for results of this element, in
+      // microseconds. Only tracked in deterministic mode.
+      int64_t stall_time_us TF_GUARDED_BY(&ParallelInterleaveIterator::mu_) =
+          0;
       // Condition variable for communicating between current worker threads
       // and GetNext.
       condition_variable cond_var;
@@ -796,6 +836,13 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             elements_to_process_.push_back(cycle_index_);
             current_workers_cond_var_.notify_one();
           }
+          if (deterministic_ &&
+              element->results.size() >= dataset()->buffer_output_elements_ &&
+              NumLookaheadResults() + 1 == LookaheadBudget()) {
+            // We freed up room in a full lookahead budget, so elements that
+            // stopped at the budget may produce further results.
+            ScheduleLookahead();
+          }
           AdvancePosition();
           return true;
         }
@@ -806,6 +853,11 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         // We've consumed all results from the element. Get a new element from
         // future_elements, or create a new element if no future elements are
         // available.
+        if (element->stall_time_us > 0) {
+          VLOG(2) << "Input element " << element->id
+                  << " stalled the consumer for " << element->stall_time_us
+                  << "us";
+        }
         if (!future_elements_.empty()) {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
@@ -1100,7 +1152,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         mutex_lock l(*mu_);
         element->results.push_back(std::move(result));
         NotifyElementUpdate(*element);
-        if (element->results.size() == dataset()->buffer_output_elements_) {
+        if (element->results.size() >= ResultsBufferLimit(*element)) {
           break;
         }
       }
@@ -1194,7 +1246,60 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         return true;
       }
       return element->iterator &&
-             element->results.size() < dataset()->buffer_output_elements_;
+             element->results.size() < ResultsBufferLimit(*element);
+    }
+
+    // Returns the number of results `element` may buffer.
+    int64_t ResultsBufferLimit(const Element& element)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64_t buffer_output_elements = dataset()->buffer_output_elements_;
+      // Only current cycle elements look ahead. Future elements only need
+      // their first results ready by the time they join the cycle.
+      if (!deterministic_ || element.cycle_index == -1 ||
+          element.results.size() < buffer_output_elements ||
+          NumLookaheadResults() >= LookaheadBudget()) {
+        return buffer_output_elements;
+      }
+      return kDeterministicLookaheadFactor * buffer_output_elements;
+    }
+
+    // The number of results buffered by current cycle elements beyond their
+    // regular share of `buffer_output_elements`.
+    int64_t NumLookaheadResults() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      int64_t num_lookahead_results = 0;
+      for (const auto& element : current_elements_) {
+        if (element) {
+          num_lookahead_results += std::max<int64_t>(
+              0, element->results.size() - dataset()->buffer_output_elements_);
+        }
+      }
+      return num_lookahead_results;
+    }
+
+    int64_t LookaheadBudget() const {
+      return dataset()->cycle_length_ * dataset()->buffer_output_elements_;
+    }
+
+    // Hands the current cycle elements that may look further ahead to the
+    // current workers.
+    void ScheduleLookahead() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int i = 0; i <= last_valid_current_element_; ++i) {
+        const auto& element = current_elements_[i];
+        if (element && !element->active && NeedsProcessing(element)) {
+          elements_to_process_.push_back(i);
+          current_workers_cond_var_.notify_one();
+        }
+      }
+    }
+
+    // Accounts for GetNext having waited `stall_time_us` microseconds for
+    // results of `element`.
+    void RecordStall(Element& element, int64_t stall_time_us)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      element.stall_time_us += stall_time_us;
+      stall_time_us_ += stall_time_us;
+      max_input_stall_time_us_ =
+          std::max(max_input_stall_time_us_, element.stall_time_us);
     }
 
     inline void IncrementCurrentWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1663,6 +1768,12 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // Determines whether outputs can be produced in deterministic order.
     const bool deterministic_;
 
+    // The total time GetNext spent waiting for results in deterministic mode,
+    // and the most time it spent waiting for the results of a single input
+    // element, in microseconds.
+    int64_t stall_time_us_ TF_GUARDED_BY(mu_) = 0;
+    int64_t max_input_stall_time_us_ TF_GUARDED_BY(mu_) = 0;
+
     // Controls cancellation of `input_impl_`. Must be ordered before
     // `input_impl_` so that `input_impl_` is destroyed first.
     std::unique_ptr<CancellationManager> cancellation_manager_;
@@ -429,6 +429,33 @@ ParallelInterleaveDatasetParams LongCycleDeterministicParams() {
       /*node_name=*/kNodeName);
 }
 
+// Each input element buffers a single result, so that the elements look ahead
+// while the consumer waits on another one.
+ParallelInterleaveDatasetParams DeterministicLookaheadParams() {
+  auto tensor_slice_dataset_params = TensorSliceDatasetParams(
+      /*components=*/{CreateTensor<int64_t>(
+          TensorShape{3, 4, 1}, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11})},
+      /*node_name=*/"tensor_slice");
+  return ParallelInterleaveDatasetParams(
+      tensor_slice_dataset_params,
+      /*other_arguments=*/{},
+      /*cycle_length=*/3,
+      /*block_length=*/1,
+      /*buffer_output_elements=*/1,
+      /*prefetch_input_elements=*/0,
+      /*num_parallel_calls=*/3,
+      /*func=*/
+      MakeTensorSliceDatasetFunc(
+          DataTypeVector({DT_INT64}),
+          std::vector<PartialTensorShape>({PartialTensorShape({1})})),
+      /*func_lib=*/{test::function::MakeTensorSliceDataset()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({1})},
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*node_name=*/kNodeName);
+}
+
 ParallelInterleaveDatasetParams
 ParallelInterleaveDatasetParamsWithInvalidCycleLength() {
   auto tensor_slice_dataset_params = TensorSliceDatasetParams(
@@ -628,6 +655,12 @@ GetNextTestCases() {
            CreateTensors<tstring>(
                TensorShape{1},
                {{"a"}, {"d"}, {"g"}, {"b"}, {"e"}, {"h"}, {"c"}, {"f"}, {"i"}}),
+           /*compare_order=*/true},
+          {/*dataset_params=*/DeterministicLookaheadParams(),
+           /*expected_outputs=*/
+           CreateTensors<int64_t>(TensorShape{1}, {{0}, {4}, {8}, {1}, {5}, {9},
+                                                   {2}, {6}, {10}, {3}, {7},
+                                                   {11}}),
            /*compare_order=*/true}};
 }
 
@@ -14,10 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <array>
 #include <cstdint>
 #include <deque>
 #include <memory>
-#include <numeric>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -26,16 +26,22 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/data/snapshot_utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -54,6 +60,8 @@ namespace data {
     ShuffleDatasetOpBase::kReshuffleEachIteration;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const ShuffleDatasetOp::kMaxBufferBytes;
+/* static */ constexpr const char* const ShuffleDatasetOp::kSpillDir;
 
 /* static */ constexpr const char* const
     ShuffleAndRepeatDatasetOp::kDatasetType;
@@ -73,6 +81,16 @@ constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kSlicesReachedEndOfSequence[] = "slices_reached_end_of_sequence";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kDraining[] = "draining";
+constexpr char kNumRuns[] = "num_runs";
+constexpr char kRunNumElements[] = "run_num_elements";
+constexpr char kRun[] = "run";
+// The snapshot file format of the shuffle buffer run files, which stores the
+// tensors of simple types as raw bytes.
+constexpr int kRunFileVersion = 1;
+// The number of rounds of random::index_shuffle() permuting the indices of
+// random accesses.
+constexpr int32_t kRandomAccessShuffleRounds = 8;
 constexpr char kShuffleDatasetV1[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2[] = "ShuffleDatasetV2";
 constexpr char kShuffleDatasetV3[] = "ShuffleDatasetV3";
@@ -88,12 +106,15 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count, int64_t max_buffer_bytes = 0,
+                     const std::string& spill_dir = "")
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        max_buffer_bytes_(max_buffer_bytes),
+        spill_dir_(spill_dir),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -134,19 +155,17 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   Status Get(OpKernelContext* ctx, int64 index,
              std::vector<Tensor>* out_tensors) const override {
     TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
-    {
-      mutex_lock l(mu_);
-      if (shuffled_indices_.empty()) {
-        InitializeRandomAccessIndices();
-      }
-    }
-    int64 shuffled_index;
-    {
-      tf_shared_lock l(mu_);
-      shuffled_index = shuffled_indices_[index];
-    }
-    TF_RETURN_IF_ERROR(input_->Get(ctx, shuffled_index, out_tensors));
-    return OkStatus();
+    // Maps the index in constant time and memory, instead of materializing
+    // a shuffled copy of every index.
+    const uint64 seed = seed_generator_->seed();
+    const uint64 seed2 = seed_generator_->seed2();
+    const std::array<uint32_t, 3> key = {static_cast<uint32_t>(seed),
+                                         static_cast<uint32_t>(seed2),
+                                         static_cast<uint32_t>(seed >> 32) ^
+                                             static_cast<uint32_t>(seed2 >> 32)};
+    const uint64 shuffled_index = random::index_shuffle(
+        index, key, Cardinality() - 1, kRandomAccessShuffleRounds);
+    return input_->Get(ctx, shuffled_index, out_tensors);
   }
 
   string DebugString() const override {
@@ -158,29 +177,18 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
       const string& prefix) const override {
+    if (max_buffer_bytes_ > 0) {
+      DCHECK_EQ(count_, 1);
+      return std::make_unique<SpillingIterator>(
+          SpillingIterator::Params{
+              this, name_utils::IteratorPrefix(op_type(), prefix)},
+          seed_generator_.get());
+    }
     return std::make_unique<Iterator>(
         Iterator::Params{this, name_utils::IteratorPrefix(op_type(), prefix)},
         seed_generator_.get());
   }
 
-  void InitializeRandomAccessIndices() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    const int64 cardinality = Cardinality();
-    shuffled_indices_ = std::vector<std::int64_t>(cardinality);
-    std::iota(shuffled_indices_.begin(), shuffled_indices_.end(), 0);
-    int64_t shuffled_index = 0;
-    random::PhiloxRandom parent_generator =
-        random::PhiloxRandom(seed_generator_->seed(), seed_generator_->seed2());
-    random::SingleSampleAdapter<random::PhiloxRandom> generator =
-        random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator);
-
-    while (shuffled_index < cardinality) {
-      int64_t offset = generator() % (cardinality - shuffled_index);
-      std::swap(shuffled_indices_[shuffled_index + offset],
-                shuffled_indices_[shuffled_index]);
-      shuffled_index += 1;
-    }
-  }
-
  protected:
   class Iterator : public DatasetIterator<ShuffleDatasetBase> {
    public:
@@ -547,6 +555,377 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     bool data_produced_ TF_GUARDED_BY(mu_) = false;
   };
 
+  // Shuffles the input while holding at most `max_buffer_bytes_` of the
+  // shuffle buffer in memory.
+  //
+  // The input is read in windows of `buffer_size_` elements (or in a single
+  // window if `buffer_size_` is `kUnknownCardinality`). While a window is
+  // read, its elements are buffered in memory, and whenever they would exceed
+  // the budget, the buffer is shuffled and written to a run file in
+  // `spill_dir_`. Once the window is read, each element is produced by
+  // choosing one of the remaining elements of the window uniformly at random:
+  // the next element of one of the runs, or an element of the buffer. Every
+  // ordering of a window is equally likely, like in `Iterator`, but windows do
+  // not overlap: the next window is read once the current one is exhausted.
+  //
+  // Checkpoints copy the elements of the runs not produced yet, which are
+  // spilled to new run files again when restoring, so that run files are
+  // deleted once produced and do not outlive the iterator. Saving thus reads
+  // the rest of each run file.
+  class SpillingIterator : public DatasetIterator<ShuffleDatasetBase> {
+   public:
+    explicit SpillingIterator(const Params& params,
+                              SeedGenerator* seed_generator)
+        : DatasetIterator<ShuffleDatasetBase>(params),
+          seed_generator_(seed_generator),
+          parent_generator_(seed_generator->seed(), seed_generator->seed2()),
+          generator_(&parent_generator_),
+          run_prefix_(io::JoinPath(
+              params.dataset->spill_dir_,
+              strings::StrCat("shuffle_", strings::Hex(random::New64())))) {}
+
+    ~SpillingIterator() override {
+      mutex_lock l(mu_);
+      ClearRuns();
+    }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          ctx->env()->RecursivelyCreateDir(dataset()->spill_dir_));
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      ResetRngs();
+      return dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_);
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (!draining_) {
+        TF_RETURN_IF_ERROR(FillWindow(ctx));
+      }
+      if (num_elements_ == 0) {
+        DCHECK(input_impl_ == nullptr);
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      *end_of_sequence = false;
+      int64_t index = Random() % num_elements_;
+      for (Run& run : runs_) {
+        const int64_t remaining = run.num_elements - run.num_read;
+        if (index < remaining) {
+          TF_RETURN_IF_ERROR(ReadFromRun(ctx, &run, out_tensors));
+          index = -1;
+          break;
+        }
+        index -= remaining;
+      }
+      if (index >= 0) {
+        DCHECK_LT(index, static_cast<int64_t>(buffer_.size()));
+        std::swap(buffer_[index], buffer_.back());
+        *out_tensors = std::move(buffer_.back());
+        buffer_.pop_back();
+        buffer_bytes_ -= ElementBytes(*out_tensors);
+        RecordBufferDequeue(ctx, *out_tensors);
+      }
+      if (--num_elements_ == 0) {
+        // Start reading the next window.
+        ClearRuns();
+        draining_ = false;
+      }
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args),
+                                       /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kEpochNumRandomSamples,
+                              seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kNumRandomSamples,
+                                             num_random_samples_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed, seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kSeed2, seed2_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(
+          prefix(), kEndOfInputSequence, static_cast<int64_t>(!input_impl_)));
+      if (input_impl_) {
+        TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+      }
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(prefix(), kNumElements, num_elements_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kDraining,
+                                             static_cast<int64_t>(draining_)));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kNumRuns, runs_.size()));
+      for (size_t i = 0; i < runs_.size(); ++i) {
+        const Run& run = runs_[i];
+        std::vector<std::vector<Tensor>> elements;
+        TF_RETURN_IF_ERROR(ReadRestOfRun(run, &elements));
+        TF_RETURN_IF_ERROR(writer->WriteScalar(
+            prefix(), absl::StrJoin(std::make_tuple(kRunNumElements, i), "_"),
+            static_cast<int64_t>(elements.size())));
+        TF_RETURN_IF_ERROR(WriteElementsToCheckpoint(
+            writer, absl::StrCat(prefix(), kColon, kRun, "_", i), elements));
+      }
+      return WriteElementsToCheckpoint(
+          writer, absl::StrCat(prefix(), kColon, "buffer"), buffer_);
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kEpochNumRandomSamples,
+                                            &num_random_samples));
+      seed_generator_->set_num_random_samples(num_random_samples);
+      seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumRandomSamples,
+                                            &num_random_samples_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed, &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kSeed2, &seed2_));
+      ResetRngs();
+
+      int64_t input_empty;
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kEndOfInputSequence, &input_empty));
+      if (!static_cast<bool>(input_empty)) {
+        TF_RETURN_IF_ERROR(
+            dataset()->input_->MakeIterator(ctx, this, prefix(), &input_impl_));
+        TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
+      } else {
+        input_impl_.reset();
+      }
+
+      TF_RETURN_IF_ERROR(
+          reader->ReadScalar(prefix(), kNumElements, &num_elements_));
+      int64_t draining;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kDraining, &draining));
+      draining_ = static_cast<bool>(draining);
+      int64_t num_runs;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kNumRuns, &num_runs));
+      ClearRuns();
+      for (int64_t i = 0; i < num_runs; ++i) {
+        int64_t num_run_elements;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(
+            prefix(), absl::StrJoin(std::make_tuple(kRunNumElements, i), "_"),
+            &num_run_elements));
+        // Spills the run again, one run at a time to stay within the budget.
+        std::vector<std::vector<Tensor>> elements;
+        TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+            ctx, reader, absl::StrCat(prefix(), kColon, kRun, "_", i),
+            &elements));
+        if (static_cast<int64_t>(elements.size()) != num_run_elements) {
+          return errors::DataLoss("Expected ", num_run_elements,
+                                  " elements in shuffle buffer run ", i,
+                                  " of the checkpoint, but got ",
+                                  elements.size());
+        }
+        if (elements.empty()) continue;
+        Run run;
+        run.filename = strings::StrCat(run_prefix_, "_", next_run_id_++);
+        run.num_elements = num_run_elements;
+        Status s = WriteRun(ctx, run.filename, elements);
+        if (!s.ok()) {
+          ctx->env()->DeleteFile(run.filename).IgnoreError();
+          return s;
+        }
+        runs_.push_back(std::move(run));
+      }
+      buffer_.clear();
+      TF_RETURN_IF_ERROR(ReadElementsFromCheckpoint(
+          ctx, reader, absl::StrCat(prefix(), kColon, "buffer"), &buffer_));
+      buffer_bytes_ = 0;
+      for (const auto& element : buffer_) {
+        buffer_bytes_ += ElementBytes(element);
+        RecordBufferEnqueue(ctx, element);
+      }
+      return OkStatus();
+    }
+
+    TraceMeMetadata GetTraceMeMetadata() const override {
+      return dataset()->traceme_metadata_;
+    }
+
+   private:
+    // The shuffled elements written to a run file.
+    struct Run {
+      std::string filename;
+      int64_t num_elements = 0;
+      int64_t num_read = 0;
+      // Opened once the run is read from.
+      std::unique_ptr<snapshot_util::Reader> reader;
+    };
+
+    static int64_t ElementBytes(const std::vector<Tensor>& element) {
+      int64_t bytes = 0;
+      for (const Tensor& tensor : element) {
+        bytes += tensor.TotalBytes();
+      }
+      return bytes;
+    }
+
+    random::SingleSampleAdapter<random::PhiloxRandom>::ResultType Random()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      num_random_samples_++;
+      return generator_();
+    }
+
+    void ResetRngs() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      parent_generator_ = random::PhiloxRandom(seed_, seed2_);
+      generator_ =
+          random::SingleSampleAdapter<random::PhiloxRandom>(&parent_generator_);
+      generator_.Skip(num_random_samples_);
+    }
+
+    bool IsShuffleAll() const {
+      return dataset()->buffer_size_ == kUnknownCardinality;
+    }
+
+    // Reads the rest of the current window.
+    Status FillWindow(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      while (input_impl_ &&
+             (IsShuffleAll() || num_elements_ < dataset()->buffer_size_)) {
+        std::vector<Tensor> element;
+        bool end_of_input_sequence = false;
+        TF_RETURN_IF_ERROR(
+            input_impl_->GetNext(ctx, &element, &end_of_input_sequence));
+        if (end_of_input_sequence) {
+          input_impl_.reset();
+          break;
+        }
+        const int64_t bytes = ElementBytes(element);
+        if (!buffer_.empty() &&
+            buffer_bytes_ + bytes > dataset()->max_buffer_bytes_) {
+          TF_RETURN_IF_ERROR(SpillBuffer(ctx));
+        }
+        RecordBufferEnqueue(ctx, element);
+        buffer_.push_back(std::move(element));
+        buffer_bytes_ += bytes;
+        num_elements_++;
+      }
+      draining_ = true;
+      return OkStatus();
+    }
+
+    // Shuffles `buffer_` and writes it to a new run file.
+    Status SpillBuffer(IteratorContext* ctx) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (int64_t i = buffer_.size() - 1; i > 0; --i) {
+        std::swap(buffer_[i], buffer_[Random() % (i + 1)]);
+      }
+      Run run;
+      run.filename = strings::StrCat(run_prefix_, "_", next_run_id_++);
+      run.num_elements = buffer_.size();
+      VLOG(2) << "Spilling " << buffer_.size() << " elements ("
+              << buffer_bytes_ << " bytes) of the shuffle buffer to "
+              << run.filename;
+      Status s = WriteRun(ctx, run.filename, buffer_);
+      if (!s.ok()) {
+        ctx->env()->DeleteFile(run.filename).IgnoreError();
+        return s;
+      }
+      for (const auto& element : buffer_) {
+        RecordBufferDequeue(ctx, element);
+      }
+      buffer_.clear();
+      buffer_bytes_ = 0;
+      runs_.push_back(std::move(run));
+      return OkStatus();
+    }
+
+    Status WriteRun(IteratorContext* ctx, const std::string& filename,
+                    const std::vector<std::vector<Tensor>>& elements) {
+      std::unique_ptr<snapshot_util::Writer> writer;
+      TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+          ctx->env(), filename, io::compression::kNone, kRunFileVersion,
+          dataset()->output_dtypes(), &writer));
+      for (const auto& element : elements) {
+        TF_RETURN_IF_ERROR(writer->WriteTensors(element));
+      }
+      return writer->Close();
+    }
+
+    Status ReadFromRun(IteratorContext* ctx, Run* run,
+                       std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (run->reader == nullptr) {
+        TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+            ctx->env(), run->filename, io::compression::kNone,
+            kRunFileVersion, dataset()->output_dtypes(), &run->reader));
+        // Skips the elements read before the iterator was restored.
+        TF_RETURN_IF_ERROR(run->reader->SkipRecords(run->num_read));
+      }
+      TF_RETURN_IF_ERROR(run->reader->ReadTensors(out_tensors));
+      if (++run->num_read == run->num_elements) {
+        run->reader.reset();
+        DeleteRunFile(run);
+      }
+      return OkStatus();
+    }
+
+    // Reads the elements of `run` not produced yet, leaving its reader as is.
+    Status ReadRestOfRun(const Run& run,
+                         std::vector<std::vector<Tensor>>* elements)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (run.num_read == run.num_elements) return OkStatus();
+      std::unique_ptr<snapshot_util::Reader> reader;
+      TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(
+          Env::Default(), run.filename, io::compression::kNone,
+          kRunFileVersion, dataset()->output_dtypes(), &reader));
+      TF_RETURN_IF_ERROR(reader->SkipRecords(run.num_read));
+      elements->resize(run.num_elements - run.num_read);
+      for (auto& element : *elements) {
+        TF_RETURN_IF_ERROR(reader->ReadTensors(&element));
+      }
+      return OkStatus();
+    }
+
+    void DeleteRunFile(Run* run) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (run->filename.empty()) return;
+      Status s = Env::Default()->DeleteFile(run->filename);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete shuffle buffer run file "
+                     << run->filename << ": " << s;
+      }
+      run->filename.clear();
+    }
+
+    void ClearRuns() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      for (Run& run : runs_) {
+        run.reader.reset();
+        DeleteRunFile(&run);
+      }
+      runs_.clear();
+    }
+
+    mutex mu_;
+    SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    random::PhiloxRandom parent_generator_ TF_GUARDED_BY(mu_);
+    random::SingleSampleAdapter<random::PhiloxRandom> generator_
+        TF_GUARDED_BY(mu_);
+    int64_t num_random_samples_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
+    // Run files are named `run_prefix_` followed by a run id.
+    const std::string run_prefix_;
+    int64_t next_run_id_ TF_GUARDED_BY(mu_) = 0;
+    // The elements of the current window not produced yet.
+    int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
+    // Whether the current window has been read.
+    bool draining_ TF_GUARDED_BY(mu_) = false;
+    std::vector<Run> runs_ TF_GUARDED_BY(mu_);
+    // The elements of the current window not spilled to a run file.
+    std::vector<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+    int64_t buffer_bytes_ TF_GUARDED_BY(mu_) = 0;
+  };
+
   const DatasetBase* const input_;
   const int64_t buffer_size_;
   const std::shared_ptr<SeedGenerator> seed_generator_;
@@ -554,9 +933,10 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  // If positive, the iterators use `SpillingIterator`.
+  const int64_t max_buffer_bytes_;
+  const std::string spill_dir_;
   const TraceMeMetadata traceme_metadata_;
-  mutable mutex mu_;
-  mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
 };  // ShuffleDatasetBase
 
 // This version of memory dataset has an exclusive ownership of the seed
@@ -679,8 +1059,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            int64_t max_buffer_bytes, const std::string& spill_dir)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           max_buffer_bytes, spill_dir),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -719,12 +1101,18 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue max_buffer_bytes;
+    b->BuildAttrValue(max_buffer_bytes_, &max_buffer_bytes);
+    AttrValue spill_dir;
+    b->BuildAttrValue(spill_dir_, &spill_dir);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kMaxBufferBytes, max_buffer_bytes),
+                       std::make_pair(kSpillDir, spill_dir)},  // Attrs
                       output));
     return OkStatus();
   }
@@ -751,6 +1139,13 @@ ShuffleDatasetOp::ShuffleDatasetOp(OpKernelConstruction* ctx)
     OP_REQUIRES_OK(
         ctx, ctx->GetAttr(kReshuffleEachIteration, &reshuffle_each_iteration_));
   }
+  if (ctx->HasAttr(kMaxBufferBytes)) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kMaxBufferBytes, &max_buffer_bytes_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kSpillDir, &spill_dir_));
+    OP_REQUIRES(ctx, max_buffer_bytes_ <= 0 || !spill_dir_.empty(),
+                errors::InvalidArgument(
+                    "spill_dir must be set if max_buffer_bytes is positive"));
+  }
 }
 
 void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -802,9 +1197,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, max_buffer_bytes_, spill_dir_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
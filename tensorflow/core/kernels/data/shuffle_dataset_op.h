@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_DATASET_OP_H_
 #define TENSORFLOW_CORE_KERNELS_DATA_SHUFFLE_DATASET_OP_H_
 
+#include <string>
+
 #include "tensorflow/core/framework/dataset.h"
 
 namespace tensorflow {
@@ -40,6 +42,8 @@ class ShuffleDatasetOpBase : public UnaryDatasetOpKernel {
 class ShuffleDatasetOp : public ShuffleDatasetOpBase {
  public:
   static constexpr const char* const kDatasetType = "Shuffle";
+  static constexpr const char* const kMaxBufferBytes = "max_buffer_bytes";
+  static constexpr const char* const kSpillDir = "spill_dir";
 
   explicit ShuffleDatasetOp(OpKernelConstruction* ctx);
 
@@ -53,6 +57,8 @@ class ShuffleDatasetOp : public ShuffleDatasetOpBase {
   class DatasetV3;
   int op_version_ = 0;
   bool reshuffle_each_iteration_ = true;
+  int64_t max_buffer_bytes_ = 0;
+  std::string spill_dir_;
 };
 
 class ShuffleAndRepeatDatasetOp : public ShuffleDatasetOpBase {
@@ -11,12 +11,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/resource_handle.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 
 namespace tensorflow {
 namespace data {
@@ -98,8 +103,89 @@ class ShuffleDatasetParams : public DatasetParams {
   bool reshuffle_each_iteration_;
 };
 
+// Parameters of a `ShuffleDatasetV3` that spills its buffer to disk.
+class SpillingShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  SpillingShuffleDatasetParams(T input_dataset_params, int64_t buffer_size,
+                               int64_t max_buffer_bytes, string spill_dir,
+                               DataTypeVector output_dtypes,
+                               std::vector<PartialTensorShape> output_shapes,
+                               string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        buffer_size_(buffer_size),
+        max_buffer_bytes_(max_buffer_bytes),
+        spill_dir_(std::move(spill_dir)) {
+    op_version_ = 3;
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    // The op creates its own seed generator for a handle it cannot find.
+    Tensor seed_generator(DT_RESOURCE, TensorShape({}));
+    seed_generator.scalar<ResourceHandle>()() = ResourceHandle();
+    return {CreateTensor<int64_t>(TensorShape({}), {buffer_size_}),
+            CreateTensor<int64_t>(TensorShape({}), {1}),
+            CreateTensor<int64_t>(TensorShape({}), {2}), seed_generator};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {ShuffleDatasetOpBase::kInputDataset,
+                    ShuffleDatasetOpBase::kBufferSize,
+                    ShuffleDatasetOpBase::kSeed, ShuffleDatasetOpBase::kSeed2,
+                    "seed_generator"};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{"output_types", output_dtypes_},
+                    {"output_shapes", output_shapes_},
+                    {"reshuffle_each_iteration", false},
+                    {"metadata", ""},
+                    {ShuffleDatasetOp::kMaxBufferBytes, max_buffer_bytes_},
+                    {ShuffleDatasetOp::kSpillDir, spill_dir_}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return ShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t buffer_size_;
+  int64_t max_buffer_bytes_;
+  string spill_dir_;
+};
+
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
 
+Status GetAllOutputs(IteratorBase* iterator, IteratorContext* ctx,
+                     std::vector<Tensor>* out_tensors) {
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_RETURN_IF_ERROR(iterator->GetNext(ctx, &next, &end_of_sequence));
+    out_tensors->insert(out_tensors->end(), next.begin(), next.end());
+  }
+  return OkStatus();
+}
+
+// Shuffles range(30), holding at most 8 elements in memory.
+SpillingShuffleDatasetParams SpillingShuffleParams(int64_t buffer_size,
+                                                   const string& spill_dir) {
+  return {RangeDatasetParams(0, 30, 1),
+          buffer_size,
+          /*max_buffer_bytes=*/8 * sizeof(int64_t),
+          spill_dir,
+          /*output_dtypes=*/{DT_INT64},
+          /*output_shapes=*/{PartialTensorShape({})},
+          /*node_name=*/kShuffleNodeName};
+}
+
 // Test case 1: test shuffle_dataset with reshuffle_each_iteration = false.
 ShuffleDatasetParams ShuffleDatasetParams1() {
   return ShuffleDatasetParams(RangeDatasetParams(0, 10, 1),
@@ -583,6 +669,134 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, SpillingShufflesEachWindow) {
+  // Three windows of 10 elements, each spilled to a run file of 8 elements
+  // and an in-memory buffer of 2.
+  TF_ASSERT_OK(Initialize(SpillingShuffleParams(
+      /*buffer_size=*/10, io::JoinPath(testing::TmpDir(), "windows"))));
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(
+      GetAllOutputs(iterator_.get(), iterator_ctx_.get(), &out_tensors));
+  ASSERT_EQ(out_tensors.size(), 30);
+  std::vector<Tensor> expected_outputs;
+  for (int64_t window = 0; window < 3; ++window) {
+    std::vector<Tensor> window_outputs(out_tensors.begin() + window * 10,
+                                       out_tensors.begin() + window * 10 + 10);
+    expected_outputs.clear();
+    for (int64_t i = window * 10; i < window * 10 + 10; ++i) {
+      expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+    }
+    TF_EXPECT_OK(ExpectEqual(window_outputs, expected_outputs,
+                             /*compare_order=*/false));
+  }
+}
+
+TEST_F(ShuffleDatasetOpTest, SpillingShuffleAllDeletesRunFiles) {
+  const string spill_dir = io::JoinPath(testing::TmpDir(), "shuffle_all");
+  auto dataset_params =
+      SpillingShuffleParams(/*buffer_size=*/kUnknownCardinality, spill_dir);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  TF_ASSERT_OK(
+      GetAllOutputs(iterator_.get(), iterator_ctx_.get(), &out_tensors));
+  std::vector<Tensor> expected_outputs;
+  for (int64_t i = 0; i < 30; ++i) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true)
+                   .ok());
+  std::vector<string> run_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_dir, &run_files));
+  EXPECT_TRUE(run_files.empty());
+}
+
+TEST_F(ShuffleDatasetOpTest, SpillingSaveAndRestore) {
+  auto dataset_params = SpillingShuffleParams(
+      /*buffer_size=*/20, io::JoinPath(testing::TmpDir(), "save_and_restore"));
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs;
+  TF_ASSERT_OK(
+      GetAllOutputs(iterator_.get(), iterator_ctx_.get(), &expected_outputs));
+
+  TF_ASSERT_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                      dataset_params.iterator_prefix(),
+                                      &iterator_));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  int cur_iteration = 0;
+  // Checkpoints while reading a window, while producing it from run files,
+  // and in the last window.
+  for (int breakpoint : {0, 5, 14, 25, 40}) {
+    VariantTensorDataWriter writer;
+    TF_EXPECT_OK(iterator_->Save(serialization_ctx.get(), &writer));
+    std::vector<const VariantTensorData*> data;
+    writer.GetData(&data);
+    VariantTensorDataReader reader(data);
+    TF_EXPECT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                                 dataset_params.iterator_prefix(), *dataset_,
+                                 &iterator_));
+    while (cur_iteration <= breakpoint && !end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_EXPECT_OK(
+          iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+      cur_iteration++;
+    }
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/true));
+}
+
+// Checkpoints copy the runs not produced yet, so the run files are deleted
+// once produced even when the iterator was saved while they were read.
+TEST_F(ShuffleDatasetOpTest, SpillingSaveDoesNotKeepRunFiles) {
+  const string spill_dir = io::JoinPath(testing::TmpDir(), "save_run_files");
+  auto dataset_params = SpillingShuffleParams(/*buffer_size=*/20, spill_dir);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::unique_ptr<SerializationContext> serialization_ctx;
+  TF_ASSERT_OK(CreateSerializationContext(&serialization_ctx));
+  std::vector<std::unique_ptr<VariantTensorDataWriter>> checkpoints;
+  bool end_of_sequence = false;
+  std::vector<Tensor> out_tensors;
+  while (!end_of_sequence) {
+    checkpoints.push_back(std::make_unique<VariantTensorDataWriter>());
+    TF_ASSERT_OK(
+        iterator_->Save(serialization_ctx.get(), checkpoints.back().get()));
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+  EXPECT_EQ(out_tensors.size(), 30);
+  std::vector<string> run_files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_dir, &run_files));
+  EXPECT_TRUE(run_files.empty());
+
+  // Restoring from a checkpoint taken while producing the first window from
+  // run files spills its rest to new run files, deleted once produced.
+  std::vector<const VariantTensorData*> data;
+  checkpoints[15]->GetData(&data);
+  VariantTensorDataReader reader(data);
+  TF_ASSERT_OK(RestoreIterator(iterator_ctx_.get(), &reader,
+                               dataset_params.iterator_prefix(), *dataset_,
+                               &iterator_));
+  std::vector<Tensor> restored_outputs;
+  TF_ASSERT_OK(
+      GetAllOutputs(iterator_.get(), iterator_ctx_.get(), &restored_outputs));
+  TF_EXPECT_OK(ExpectEqual(
+      restored_outputs,
+      std::vector<Tensor>(out_tensors.begin() + 15, out_tensors.end()),
+      /*compare_order=*/true));
+  run_files.clear();
+  TF_ASSERT_OK(Env::Default()->GetChildren(spill_dir, &run_files));
+  EXPECT_TRUE(run_files.empty());
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
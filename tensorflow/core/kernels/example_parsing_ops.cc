@@ -303,6 +303,20 @@ class ParseSingleExampleOp : public OpKernel {
     OP_REQUIRES_OK(ctx, attrs_.Init(ctx));
     metrics::RecordParseDenseFeature(attrs_.dense_keys.size());
     metrics::RecordParseSparseFeature(attrs_.sparse_keys.size());
+    // The keys are attributes, so the features are indexed once rather than
+    // for every example. The index does not depend on the dense defaults.
+    example::FastParseExampleConfig config;
+    for (int d = 0; d < attrs_.dense_keys.size(); ++d) {
+      config.dense.push_back({attrs_.dense_keys[d], attrs_.dense_types[d],
+                              attrs_.dense_shapes[d], Tensor(),
+                              attrs_.variable_length[d],
+                              attrs_.elements_per_stride[d]});
+    }
+    for (int d = 0; d < attrs_.sparse_keys.size(); ++d) {
+      config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
+    }
+    OP_REQUIRES_OK(ctx, example::FastParseExampleConfigIndex::Create(
+                            config, &config_index_));
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -367,8 +381,8 @@ class ParseSingleExampleOp : public OpKernel {
 
     const tstring& serialized_proto = serialized->scalar<tstring>()();
 
-    OP_REQUIRES_OK(ctx,
-                   FastParseSingleExample(config, serialized_proto, &result));
+    OP_REQUIRES_OK(ctx, FastParseSingleExample(config, *config_index_,
+                                               serialized_proto, &result));
 
     OpOutputList dense_values;
     OpOutputList sparse_indices;
@@ -390,6 +404,7 @@ class ParseSingleExampleOp : public OpKernel {
 
  protected:
   ParseSingleExampleAttrs attrs_;
+  std::unique_ptr<const example::FastParseExampleConfigIndex> config_index_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseSingleExample").Device(DEVICE_CPU),
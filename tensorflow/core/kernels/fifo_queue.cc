@@ -19,6 +19,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <iterator>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -50,6 +52,30 @@ void FIFOQueue::DequeueLocked(OpKernelContext* ctx, Tuple* tuple) {
 
 void FIFOQueue::TryEnqueue(const Tuple& tuple, OpKernelContext* ctx,
                            DoneCallback callback) {
+  // Fast path: if no earlier enqueue is waiting and there is room, enqueue
+  // under a single acquisition of mu_, without registering a cancellation
+  // callback or queuing an attempt.
+  if (!ctx->cancellation_manager()->IsCancelled()) {
+    bool enqueued = false;
+    bool dequeue_waiting = false;
+    {
+      mutex_lock l(mu_);
+      if (enqueue_attempts_.empty() && !closed_ &&
+          queues_[0].size() < static_cast<size_t>(capacity_)) {
+        for (int i = 0; i < num_components(); ++i) {
+          queues_[i].push_back(tuple[i]);
+        }
+        enqueued = true;
+        dequeue_waiting = !dequeue_attempts_.empty();
+      }
+    }
+    if (enqueued) {
+      if (dequeue_waiting) FlushUnlocked();
+      callback();
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -107,6 +133,36 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // Fast path: if no earlier enqueue is waiting and the whole batch fits,
+  // enqueue it under a single acquisition of mu_.
+  if (!ctx->cancellation_manager()->IsCancelled()) {
+    bool enqueued = false;
+    bool dequeue_waiting = false;
+    {
+      mutex_lock l(mu_);
+      if (enqueue_attempts_.empty() && !closed_ &&
+          queues_[0].size() + batch_size <= static_cast<size_t>(capacity_)) {
+        for (int64_t index = 0; index < batch_size && ctx->status().ok();
+             ++index) {
+          for (int i = 0; i < num_components(); ++i) {
+            Tensor element;
+            ctx->SetStatus(
+                GetElementComponentFromBatch(tuple, index, i, ctx, &element));
+            if (!ctx->status().ok()) break;
+            queues_[i].push_back(std::move(element));
+          }
+        }
+        enqueued = true;
+        dequeue_waiting = !dequeue_attempts_.empty();
+      }
+    }
+    if (enqueued) {
+      if (dequeue_waiting) FlushUnlocked();
+      callback();
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -153,6 +209,25 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
 }
 
 void FIFOQueue::TryDequeue(OpKernelContext* ctx, CallbackWithTuple callback) {
+  // Fast path: if no earlier dequeue is waiting and the queue is not empty,
+  // dequeue under a single acquisition of mu_.
+  if (!ctx->cancellation_manager()->IsCancelled()) {
+    Tuple tuple;
+    bool enqueue_waiting = false;
+    {
+      mutex_lock l(mu_);
+      if (dequeue_attempts_.empty() && !queues_[0].empty()) {
+        DequeueLocked(ctx, &tuple);
+        enqueue_waiting = !enqueue_attempts_.empty();
+      }
+    }
+    if (!tuple.empty()) {
+      if (enqueue_waiting) FlushUnlocked();
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -244,6 +319,67 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     return;
   }
 
+  // Fast path: if no earlier dequeue is waiting and the queue holds enough
+  // elements, take them without queuing an attempt, and assemble the batch
+  // after releasing mu_. The batch is allocated once the elements are known to
+  // be available, but before taking them, so that a failed allocation leaves
+  // the queue untouched. If another dequeue takes them in the meantime, this
+  // one goes through the slow path.
+  bool fast_path = false;
+  if (!ctx->cancellation_manager()->IsCancelled()) {
+    mutex_lock l(mu_);
+    fast_path = dequeue_attempts_.empty() &&
+                queues_[0].size() >= static_cast<size_t>(num_elements);
+  }
+  if (fast_path) {
+    Tuple tuple;
+    tuple.reserve(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Tensor batch;
+      Status status = ctx->allocate_temp(
+          component_dtypes_[i], ManyOutShape(i, num_elements), &batch);
+      if (!status.ok()) {
+        ctx->SetStatus(status);
+        callback(Tuple());
+        return;
+      }
+      tuple.emplace_back(std::move(batch));
+    }
+    std::vector<std::vector<Tensor>> elements;
+    bool enqueue_waiting = false;
+    {
+      mutex_lock l(mu_);
+      if (dequeue_attempts_.empty() &&
+          queues_[0].size() >= static_cast<size_t>(num_elements)) {
+        elements.resize(num_components());
+        for (int i = 0; i < num_components(); ++i) {
+          std::deque<Tensor>& queue = queues_[i];
+          elements[i].assign(
+              std::make_move_iterator(queue.begin()),
+              std::make_move_iterator(queue.begin() + num_elements));
+          queue.erase(queue.begin(), queue.begin() + num_elements);
+        }
+        enqueue_waiting = !enqueue_attempts_.empty();
+      }
+    }
+    if (!elements.empty()) {
+      if (enqueue_waiting) FlushUnlocked();
+      for (int i = 0; i < num_components(); ++i) {
+        for (int64_t index = 0; index < num_elements; ++index) {
+          Status status = batch_util::CopyElementToSlice(
+              std::move(elements[i][index]), &tuple[i], index);
+          if (!status.ok()) {
+            ctx->SetStatus(status);
+            callback(Tuple());
+            return;
+          }
+        }
+      }
+      callback(tuple);
+      return;
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -16,14 +16,20 @@ limitations under the License.
 #include "tensorflow/core/kernels/function_ops.h"
 
 #include <deque>
+#include <memory>
 #include <vector>
 
+#include "absl/time/time.h"
+#include "tensorflow/core/common_runtime/cost_constants.h"
+#include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/executor.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/gradients.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/memory_types.h"
+#include "tensorflow/core/common_runtime/request_cost.h"
+#include "tensorflow/core/common_runtime/request_cost_accessor.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/full_type.pb.h"
 #include "tensorflow/core/framework/full_type_util.h"
@@ -406,10 +412,21 @@ void RemoteCallOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
             {{"func_name", func_name}, {"device", target_device}});
       },
       profiler::TraceMeLevel::kInfo);
+  // The callback may run on another thread, so look up the cost of the current
+  // rpc request here.
+  std::unique_ptr<RequestCostAccessor> request_cost_accessor =
+      CreateRequestCostAccessor();
+  RequestCost* request_cost = request_cost_accessor
+                                  ? request_cost_accessor->GetRequestCost()
+                                  : nullptr;
+  const absl::Time run_start_time = absl::Now();
   lib->Run(
       opts, handle, args, rets,
-      [rets, done = std::move(done), func_name, ctx, cancel_mgr,
+      [rets, done = std::move(done), func_name, ctx, cancel_mgr, request_cost,
+       run_start_time,
        target_device = std::move(function_target.first)](const Status& status) {
+        RecordRequestLatency(request_cost, kRpcLatencyName,
+                             absl::Now() - run_start_time);
         profiler::TraceMe activity(
             [&] {
               return profiler::TraceMeEncode(
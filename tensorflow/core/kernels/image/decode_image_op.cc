@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #define EIGEN_USE_THREADS
 
@@ -40,8 +41,11 @@ limitations under the License.
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/image_resizer_state.h"
+#include "tensorflow/core/util/work_sharder.h"
 #include "tsl/util/byte_swap_array.h"
 
 namespace tensorflow {
@@ -687,6 +691,203 @@ REGISTER_KERNEL_BUILDER(Name("DecodeImage").Device(DEVICE_CPU),
                         DecodeImageV2Op);
 REGISTER_KERNEL_BUILDER(Name("DecodeBmp").Device(DEVICE_CPU), DecodeImageV2Op);
 
+// Decodes a batch of JPEG images and resizes them bilinearly to one size, in
+// parallel across the images. Unless `dct_scaling` is false, every image is
+// decoded at the smallest libjpeg scale that is still at least as large as the
+// output, and it is resized from there directly into the output.
+class BatchDecodeAndResizeJpegOp : public OpKernel {
+ public:
+  explicit BatchDecodeAndResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("channels must be 1 or 3, got ",
+                                        channels_));
+    flags_.components = channels_;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    // As in DecodeJpeg, the default is IFAST.
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_scaling", &dct_scaling_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("contents must be 1-D, got shape ",
+                                        contents.shape().DebugString()));
+    const Tensor& size = context->input(1);
+    OP_REQUIRES(context, size.dims() == 1 && size.NumElements() == 2,
+                errors::InvalidArgument(
+                    "size must be 1-D with 2 elements, got shape ",
+                    size.shape().DebugString()));
+    const int64_t out_height = size.vec<int32>()(0);
+    const int64_t out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("output dimensions must be positive, "
+                                        "got ",
+                                        out_height, "x", out_width));
+
+    const int64_t batch_size = contents.dim_size(0);
+    TensorShape output_shape;
+    OP_REQUIRES_OK(context, TensorShape::BuildTensorShape(
+                                {batch_size, out_height, out_width, channels_},
+                                &output_shape));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+
+    const auto contents_vec = contents.vec<tstring>();
+    float* output_data = output->flat<float>().data();
+    const int64_t image_size = out_height * out_width * channels_;
+    mutex mu;
+    Status status;
+    auto decode_and_resize = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        Status image_status =
+            DecodeAndResize(contents_vec(i), i, out_height, out_width,
+                            output_data + i * image_size);
+        if (!image_status.ok()) {
+          mutex_lock l(mu);
+          status.Update(image_status);
+          return;
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          kCostPerImage, decode_and_resize);
+    OP_REQUIRES_OK(context, status);
+  }
+
+ private:
+  // Decoding an image costs orders of magnitude more than scheduling it, so
+  // every image may go to its own shard.
+  static constexpr int64_t kCostPerImage = 1000000;
+
+  // Decodes the JPEG image `input`, the `index`th of the batch, and resizes it
+  // into `output`.
+  Status DecodeAndResize(StringPiece input, int64_t index, int64_t out_height,
+                         int64_t out_width, float* output) const {
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("JPEG image ", index,
+                                     " is too large: ", input.size());
+    }
+    int width;
+    int height;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            nullptr /* components */)) {
+      return errors::InvalidArgument("Invalid JPEG data for image ", index);
+    }
+
+    jpeg::UncompressFlags flags = flags_;
+    if (dct_scaling_) {
+      // libjpeg rounds the scaled dimensions up.
+      for (int ratio = 8; ratio > 1; ratio /= 2) {
+        if ((height + ratio - 1) / ratio >= out_height &&
+            (width + ratio - 1) / ratio >= out_width) {
+          flags.ratio = ratio;
+          break;
+        }
+      }
+    }
+
+    std::unique_ptr<uint8[]> decoded;
+    int decoded_height = 0;
+    int decoded_width = 0;
+    const uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int width, int height, int channels) -> uint8* {
+          decoded_height = height;
+          decoded_width = width;
+          decoded.reset(
+              new uint8[static_cast<int64_t>(height) * width * channels]);
+          return decoded.get();
+        });
+    if (buffer == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data for image ", index);
+    }
+    ResizeBilinear(buffer, decoded_height, decoded_width, out_height,
+                   out_width, output);
+    return OkStatus();
+  }
+
+  // The source rows or columns of an output row or column, and the weight of
+  // the upper one.
+  struct Interpolation {
+    int64_t lower;
+    int64_t upper;
+    float lerp;
+  };
+
+  // Computes the interpolation of every output row or column, with half-pixel
+  // centers as in ResizeBilinear.
+  static std::vector<Interpolation> ComputeInterpolation(int64_t in_size,
+                                                         int64_t out_size) {
+    const float scale =
+        CalculateResizeScale(in_size, out_size, false /* align_corners */);
+    const HalfPixelScaler scaler;
+    std::vector<Interpolation> interpolation(out_size);
+    for (int64_t i = 0; i < out_size; ++i) {
+      const float in = scaler(i, scale);
+      const float in_f = std::floor(in);
+      interpolation[i].lower = std::max(static_cast<int64_t>(in_f), int64_t{0});
+      interpolation[i].upper =
+          std::min(static_cast<int64_t>(std::ceil(in)), in_size - 1);
+      interpolation[i].lerp = in - in_f;
+    }
+    return interpolation;
+  }
+
+  // Resizes the decoded `in_height` x `in_width` image `input` bilinearly into
+  // the `out_height` x `out_width` image `output`.
+  void ResizeBilinear(const uint8* input, int64_t in_height, int64_t in_width,
+                      int64_t out_height, int64_t out_width,
+                      float* output) const {
+    const std::vector<Interpolation> ys =
+        ComputeInterpolation(in_height, out_height);
+    const std::vector<Interpolation> xs =
+        ComputeInterpolation(in_width, out_width);
+    const int64_t in_row_size = in_width * channels_;
+    for (int64_t y = 0; y < out_height; ++y) {
+      const uint8* top = input + ys[y].lower * in_row_size;
+      const uint8* bottom = input + ys[y].upper * in_row_size;
+      const float y_lerp = ys[y].lerp;
+      for (int64_t x = 0; x < out_width; ++x) {
+        const int64_t left = xs[x].lower * channels_;
+        const int64_t right = xs[x].upper * channels_;
+        const float x_lerp = xs[x].lerp;
+        for (int c = 0; c < channels_; ++c) {
+          const float top_left = top[left + c];
+          const float top_right = top[right + c];
+          const float bottom_left = bottom[left + c];
+          const float bottom_right = bottom[right + c];
+          const float top_value = top_left + (top_right - top_left) * x_lerp;
+          const float bottom_value =
+              bottom_left + (bottom_right - bottom_left) * x_lerp;
+          *output++ = top_value + (bottom_value - top_value) * y_lerp;
+        }
+      }
+    }
+  }
+
+  int channels_;
+  bool dct_scaling_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BatchDecodeAndResizeJpeg").Device(DEVICE_CPU),
+                        BatchDecodeAndResizeJpegOp);
+
 void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
                                 uint8* const output, const int width,
                                 const int height, const int output_channels,
@@ -16,9 +16,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <cstring>
+#include <set>
 #include <string>
+#include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -26,7 +31,12 @@ limitations under the License.
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace lookup {
@@ -408,6 +418,501 @@ class MutableHashTableOfTensors final : public LookupInterface {
   std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
 };
 
+// Lookup table for embedding tables that don't fit in host memory. The most
+// frequently used rows are kept in memory, and the other rows in a file on
+// local storage (typically an SSD). Each value must be a vector of a
+// fixed-size type.
+//
+// At most `cache_capacity` rows are kept in memory. When a row is looked up or
+// inserted while the cache is full, the least frequently used cached row is
+// evicted to storage; ties go to the least recently used one. Access counts
+// are halved periodically, so that rows that were hot in the past eventually
+// make room for rows that are hot now.
+//
+// Storage is a log of fixed-size records, each holding a key and its value.
+// Evicted rows are appended to the log, and rows that are read back or removed
+// leave garbage behind, which is compacted away once it outgrows the live
+// records. The records a lookup misses in memory are read back in file order,
+// in parallel over the CPU worker threads, and moved into the cache.
+//
+// The storage file is private to the table and deleted with it; the contents
+// of the table are checkpointed through ExportValues like those of the other
+// mutable tables.
+template <class K, class V>
+class TieredHashTableOfTensors final : public LookupInterface {
+ public:
+  TieredHashTableOfTensors(OpKernelContext* ctx, OpKernel* kernel)
+      : env_(ctx->env()) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(
+        ctx, TensorShapeUtils::IsVector(value_shape_),
+        errors::InvalidArgument("Default value must be a vector, got shape ",
+                                value_shape_.DebugString()));
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "cache_capacity", &cache_capacity_));
+    OP_REQUIRES(ctx, cache_capacity_ > 0,
+                errors::InvalidArgument("cache_capacity must be positive, got ",
+                                        cache_capacity_));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "storage_directory",
+                                    &storage_directory_));
+    value_dim_ = value_shape_.dim_size(0);
+    record_bytes_ = sizeof(K) + value_dim_ * sizeof(V);
+    if (storage_directory_.empty()) {
+      OP_REQUIRES(ctx, env_->LocalTempFilename(&storage_filename_),
+                  errors::Internal("Failed to create a local temp filename "
+                                   "for the table storage"));
+    } else {
+      OP_REQUIRES_OK(ctx, env_->RecursivelyCreateDir(storage_directory_));
+      storage_filename_ = io::JoinPath(
+          storage_directory_,
+          strings::StrCat("tiered_hash_table_", random::New64()));
+    }
+    mutex_lock l(mu_);
+    OP_REQUIRES_OK(ctx, ResetStorage());
+  }
+
+  ~TieredHashTableOfTensors() override {
+    storage_reader_.reset();
+    if (storage_writer_ != nullptr) {
+      storage_writer_->Close().IgnoreError();
+    }
+    env_->DeleteFile(storage_filename_).IgnoreError();
+  }
+
+  size_t size() const override {
+    tf_shared_lock l(mu_);
+    return cached_slots_.size() + stored_records_.size();
+  }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const auto default_flat = default_value.flat_inner_dims<V, 2>();
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat_inner_dims<V, 2>();
+    const bool is_full_size_default =
+        (value_values.size() == default_flat.size());
+
+    mutex_lock l(mu_);
+    // The (record, key index) pairs of the keys that are in storage.
+    std::vector<std::pair<int64_t, int64_t>> stored_keys;
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      if (const int64_t* slot = gtl::FindOrNull(cached_slots_, k)) {
+        std::copy_n(&cached_values_[*slot * value_dim_], value_dim_,
+                    &value_values(i, 0));
+        Touch(*slot);
+      } else if (const int64_t* record = gtl::FindOrNull(stored_records_, k)) {
+        stored_keys.emplace_back(*record, i);
+      } else {
+        for (int64_t j = 0; j < value_dim_; j++) {
+          value_values(i, j) =
+              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
+        }
+      }
+    }
+    if (stored_keys.empty()) {
+      return OkStatus();
+    }
+
+    std::sort(stored_keys.begin(), stored_keys.end());
+    TF_RETURN_IF_ERROR(ReadRecords(ctx, key_values, stored_keys, value));
+    // Move the rows that were read into the cache. Reading them all first
+    // keeps the records from being overwritten by compaction meanwhile.
+    for (const auto& [record, i] : stored_keys) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      if (const int64_t* slot = gtl::FindOrNull(cached_slots_, k)) {
+        // A duplicate of a key that was moved into the cache already.
+        Touch(*slot);
+        continue;
+      }
+      stored_records_.erase(k);
+      int64_t slot;
+      TF_RETURN_IF_ERROR(AllocateSlot(k, &slot));
+      std::copy_n(&value_values(i, 0), value_dim_,
+                  &cached_values_[slot * value_dim_]);
+      Touch(slot);
+    }
+    return FinishUpdate();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    mutex_lock l(mu_);
+    return DoInsert(keys, values);
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+
+    mutex_lock l(mu_);
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      auto it = cached_slots_.find(k);
+      if (it != cached_slots_.end()) {
+        FreeSlot(it->second);
+        cached_slots_.erase(it);
+      } else {
+        stored_records_.erase(k);
+      }
+    }
+    return FinishUpdate();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    mutex_lock l(mu_);
+    cached_slots_.clear();
+    cached_values_.clear();
+    cached_rows_.clear();
+    free_slots_.clear();
+    eviction_order_.clear();
+    stored_records_.clear();
+    TF_RETURN_IF_ERROR(ResetStorage());
+    return DoInsert(keys, values);
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    tf_shared_lock l(mu_);
+    const int64_t size = cached_slots_.size() + stored_records_.size();
+
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "values", TensorShape({size, value_dim_}), &values));
+    return ExportKeysAndValues(keys, values);
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64_t MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    return sizeof(TieredHashTableOfTensors) +
+           cached_values_.capacity() * sizeof(V) +
+           cached_rows_.capacity() * sizeof(CachedRow) +
+           cached_slots_.capacity() * (sizeof(K) + sizeof(int64_t)) +
+           stored_records_.capacity() * (sizeof(K) + sizeof(int64_t));
+  }
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
+    tf_shared_lock l(mu_);
+    const int64_t size = cached_slots_.size() + stored_records_.size();
+    Tensor keys(key_dtype(), TensorShape({size}));
+    Tensor values(value_dtype(), TensorShape({size, value_dim_}));
+    TF_RETURN_IF_ERROR(ExportKeysAndValues(&keys, &values));
+
+    // See MutableHashTableOfTensors::AsGraphDef for the unique node name.
+    Node* table =
+        ops::SourceOp("TieredHashTableOfTensors",
+                      builder->opts()
+                          .WithName(UniqueNodeName("TieredHashTableOfTensors"))
+                          .WithAttr("use_node_name_sharing", true)
+                          .WithAttr("key_dtype", key_dtype())
+                          .WithAttr("value_dtype", value_dtype())
+                          .WithAttr("value_shape", value_shape_)
+                          .WithAttr("cache_capacity", cache_capacity_)
+                          .WithAttr("storage_directory", storage_directory_));
+    Node* keys_node = ops::SourceOp(
+        "Const",
+        builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
+    Node* values_node =
+        ops::SourceOp("Const", builder->opts()
+                                   .WithAttr("dtype", value_dtype())
+                                   .WithAttr("value", values));
+    Node* import_table =
+        ops::TernaryOp("LookupTableImportV2", table, keys_node, values_node,
+                       builder->opts()
+                           .WithAttr("Tin", key_dtype())
+                           .WithAttr("Tout", value_dtype()));
+    *out = ops::UnaryOp("Identity", table,
+                        builder->opts().WithControlInput(import_table));
+    return OkStatus();
+  }
+
+ private:
+  struct CachedRow {
+    K key;
+    uint64 frequency;
+    uint64 last_access;
+  };
+
+  // Orders the cached rows by (frequency, last access, slot); the first one is
+  // evicted next.
+  using EvictionKey = std::tuple<uint64, uint64, int64_t>;
+
+  EvictionKey GetEvictionKey(int64_t slot) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    return {cached_rows_[slot].frequency, cached_rows_[slot].last_access, slot};
+  }
+
+  Status DoInsert(const Tensor& keys, const Tensor& values)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat_inner_dims<V, 2>();
+
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      const K k = SubtleMustCopyIfIntegral(key_values(i));
+      int64_t slot;
+      if (const int64_t* cached_slot = gtl::FindOrNull(cached_slots_, k)) {
+        slot = *cached_slot;
+      } else {
+        stored_records_.erase(k);
+        TF_RETURN_IF_ERROR(AllocateSlot(k, &slot));
+        Touch(slot);
+      }
+      std::copy_n(&value_values(i, 0), value_dim_,
+                  &cached_values_[slot * value_dim_]);
+    }
+    return FinishUpdate();
+  }
+
+  // Counts an access to the row in `slot`.
+  void Touch(int64_t slot) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    CachedRow& row = cached_rows_[slot];
+    if (row.frequency > 0) {
+      eviction_order_.erase(GetEvictionKey(slot));
+    }
+    ++row.frequency;
+    row.last_access = ++num_accesses_;
+    eviction_order_.insert(GetEvictionKey(slot));
+    if (num_accesses_ % static_cast<uint64>(kAgingPeriod * cache_capacity_) ==
+        0) {
+      eviction_order_.clear();
+      for (int64_t s = 0; s < cached_rows_.size(); ++s) {
+        if (cached_rows_[s].frequency > 0) {
+          cached_rows_[s].frequency = (cached_rows_[s].frequency + 1) / 2;
+          eviction_order_.insert(GetEvictionKey(s));
+        }
+      }
+    }
+  }
+
+  // Assigns a cache slot to `key`, evicting a row to storage if the cache is
+  // full. The slot must be touched once its value is set.
+  Status AllocateSlot(const K& key, int64_t* slot)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (free_slots_.empty() && cached_rows_.size() >= cache_capacity_) {
+      const int64_t victim = std::get<2>(*eviction_order_.begin());
+      const K victim_key = cached_rows_[victim].key;
+      TF_RETURN_IF_ERROR(
+          AppendRecord(victim_key, &cached_values_[victim * value_dim_]));
+      stored_records_[victim_key] = num_records_ - 1;
+      cached_slots_.erase(victim_key);
+      FreeSlot(victim);
+    }
+    if (free_slots_.empty()) {
+      *slot = cached_rows_.size();
+      cached_rows_.push_back({});
+      cached_values_.resize(cached_values_.size() + value_dim_);
+    } else {
+      *slot = free_slots_.back();
+      free_slots_.pop_back();
+    }
+    cached_rows_[*slot] = {key, 0, 0};
+    cached_slots_[key] = *slot;
+    return OkStatus();
+  }
+
+  void FreeSlot(int64_t slot) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    eviction_order_.erase(GetEvictionKey(slot));
+    cached_rows_[slot].frequency = 0;
+    free_slots_.push_back(slot);
+  }
+
+  // Starts a new, empty storage file.
+  Status ResetStorage() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    storage_reader_.reset();
+    if (storage_writer_ != nullptr) {
+      TF_RETURN_IF_ERROR(storage_writer_->Close());
+    }
+    TF_RETURN_IF_ERROR(
+        env_->NewWritableFile(storage_filename_, &storage_writer_));
+    TF_RETURN_IF_ERROR(
+        env_->NewRandomAccessFile(storage_filename_, &storage_reader_));
+    num_records_ = 0;
+    return OkStatus();
+  }
+
+  // Appends a record for `key` and `value` to `file`.
+  Status WriteRecord(const K& key, const V* value, WritableFile* file) const {
+    std::string record(record_bytes_, '\0');
+    std::memcpy(&record[0], &key, sizeof(K));
+    std::memcpy(&record[sizeof(K)], value, value_dim_ * sizeof(V));
+    return file->Append(record);
+  }
+
+  Status AppendRecord(const K& key, const V* value)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    TF_RETURN_IF_ERROR(WriteRecord(key, value, storage_writer_.get()));
+    ++num_records_;
+    return OkStatus();
+  }
+
+  // Reads `record` into `scratch`, which must hold `record_bytes_`, and checks
+  // that it holds `key`. Returns a pointer to the value.
+  Status ReadRecord(int64_t record, const K& key, char* scratch,
+                    const V** value) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    StringPiece result;
+    TF_RETURN_IF_ERROR(storage_reader_->Read(record * record_bytes_,
+                                             record_bytes_, &result, scratch));
+    K stored_key;
+    std::memcpy(&stored_key, result.data(), sizeof(K));
+    if (result.size() != record_bytes_ || stored_key != key) {
+      return errors::DataLoss("Corrupted record ", record, " in ",
+                              storage_filename_);
+    }
+    *value = reinterpret_cast<const V*>(result.data() + sizeof(K));
+    return OkStatus();
+  }
+
+  // Reads the records of `stored_keys`, which are (record, key index) pairs,
+  // into the rows of `value` at the key indices. The reads are spread over the
+  // CPU worker threads.
+  Status ReadRecords(
+      OpKernelContext* ctx, typename TTypes<K>::ConstFlat key_values,
+      const std::vector<std::pair<int64_t, int64_t>>& stored_keys,
+      Tensor* value) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+    auto value_values = value->flat_inner_dims<V, 2>();
+    mutex status_mu;
+    Status status;
+    auto read_range = [&](int64_t begin, int64_t end) {
+      std::string scratch(record_bytes_, '\0');
+      for (int64_t r = begin; r < end; ++r) {
+        const auto& [record, i] = stored_keys[r];
+        const V* stored_value;
+        Status read_status =
+            ReadRecord(record, SubtleMustCopyIfIntegral(key_values(i)),
+                       &scratch[0], &stored_value);
+        if (!read_status.ok()) {
+          mutex_lock status_lock(status_mu);
+          status.Update(read_status);
+          return;
+        }
+        std::memcpy(&value_values(i, 0), stored_value, value_dim_ * sizeof(V));
+      }
+    };
+    if (ctx == nullptr) {
+      read_range(0, stored_keys.size());
+      return status;
+    }
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          stored_keys.size(), kReadCost, read_range);
+    return status;
+  }
+
+  // Flushes the records appended by an update, and compacts the storage file
+  // once it holds more garbage than live records.
+  Status FinishUpdate() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t num_garbage_records = num_records_ - stored_records_.size();
+    if (num_garbage_records < kMinCompactionRecords ||
+        num_garbage_records <= stored_records_.size()) {
+      return storage_writer_->Flush();
+    }
+    // Copy the live records in file order to a new file, and replace the old
+    // file with it.
+    std::vector<std::pair<int64_t, K>> live_records;
+    live_records.reserve(stored_records_.size());
+    for (const auto& [key, record] : stored_records_) {
+      live_records.emplace_back(record, key);
+    }
+    std::sort(live_records.begin(), live_records.end());
+    TF_RETURN_IF_ERROR(storage_writer_->Flush());
+    const std::string compacted_filename =
+        strings::StrCat(storage_filename_, ".compacted");
+    std::unique_ptr<WritableFile> compacted_writer;
+    TF_RETURN_IF_ERROR(
+        env_->NewWritableFile(compacted_filename, &compacted_writer));
+    std::string scratch(record_bytes_, '\0');
+    for (const auto& [record, key] : live_records) {
+      const V* value;
+      TF_RETURN_IF_ERROR(ReadRecord(record, key, &scratch[0], &value));
+      TF_RETURN_IF_ERROR(WriteRecord(key, value, compacted_writer.get()));
+    }
+    TF_RETURN_IF_ERROR(compacted_writer->Close());
+    storage_reader_.reset();
+    TF_RETURN_IF_ERROR(storage_writer_->Close());
+    TF_RETURN_IF_ERROR(env_->RenameFile(compacted_filename, storage_filename_));
+    TF_RETURN_IF_ERROR(
+        env_->NewAppendableFile(storage_filename_, &storage_writer_));
+    TF_RETURN_IF_ERROR(
+        env_->NewRandomAccessFile(storage_filename_, &storage_reader_));
+    for (int64_t r = 0; r < live_records.size(); ++r) {
+      stored_records_[live_records[r].second] = r;
+    }
+    num_records_ = live_records.size();
+    return OkStatus();
+  }
+
+  // Writes all keys and values into `keys` and `values`, which must have
+  // `cached_slots_.size() + stored_records_.size()` rows.
+  Status ExportKeysAndValues(Tensor* keys, Tensor* values) const
+      TF_SHARED_LOCKS_REQUIRED(mu_) {
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->matrix<V>();
+    int64_t i = 0;
+    for (const auto& [key, slot] : cached_slots_) {
+      keys_data(i) = key;
+      std::copy_n(&cached_values_[slot * value_dim_], value_dim_,
+                  &values_data(i, 0));
+      ++i;
+    }
+    std::string scratch(record_bytes_, '\0');
+    for (const auto& [key, record] : stored_records_) {
+      const V* value;
+      TF_RETURN_IF_ERROR(ReadRecord(record, key, &scratch[0], &value));
+      keys_data(i) = key;
+      std::copy_n(value, value_dim_, &values_data(i, 0));
+      ++i;
+    }
+    return OkStatus();
+  }
+
+  // The number of accesses per cached row after which the access counts are
+  // halved.
+  static constexpr int64_t kAgingPeriod = 16;
+
+  // The storage file is not compacted while it holds fewer garbage records.
+  static constexpr int64_t kMinCompactionRecords = 1024;
+
+  // The cost of reading one record, in cycles.
+  static constexpr int64_t kReadCost = 10000;
+
+  Env* const env_;
+  TensorShape value_shape_;
+  int64_t value_dim_;
+  int64_t cache_capacity_;
+  std::string storage_directory_;
+  std::string storage_filename_;
+  // The size of a storage record: the key followed by its value.
+  int64_t record_bytes_;
+
+  mutable mutex mu_;
+
+  // The cache. Rows are stored in slots of `value_dim_` values in
+  // `cached_values_`; freed slots are reused.
+  absl::flat_hash_map<K, int64_t> cached_slots_ TF_GUARDED_BY(mu_);
+  std::vector<V> cached_values_ TF_GUARDED_BY(mu_);
+  std::vector<CachedRow> cached_rows_ TF_GUARDED_BY(mu_);
+  std::vector<int64_t> free_slots_ TF_GUARDED_BY(mu_);
+  std::set<EvictionKey> eviction_order_ TF_GUARDED_BY(mu_);
+  uint64 num_accesses_ TF_GUARDED_BY(mu_) = 0;
+
+  // The storage, and the record of each key in it.
+  absl::flat_hash_map<K, int64_t> stored_records_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<WritableFile> storage_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<RandomAccessFile> storage_reader_ TF_GUARDED_BY(mu_);
+  int64_t num_records_ TF_GUARDED_BY(mu_) = 0;
+};
+
 namespace {
 
 template <typename T>
@@ -520,44 +1025,92 @@ class MutableDenseHashTable final : public LookupInterface {
     const auto deleted_key_matrix =
         deleted_key_.template shaped<K, 2>({1, key_size});
     const int64_t bit_mask = num_buckets_ - 1;
-    // TODO(andreasst): parallelize using work_sharder
-    for (int64_t i = 0; i < num_elements; ++i) {
-      const uint64 key_hash = HashKey(key_matrix, i);
-      if (empty_key_hash_ == key_hash &&
-          IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the empty_key as a table key is not allowed");
-      }
-      if (deleted_key_hash_ == key_hash &&
-          IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
-        return errors::InvalidArgument(
-            "Using the deleted_key as a table key is not allowed");
+    // Looks up the keys in [begin, end). Lookups in large tables are dominated
+    // by cache misses on the first probed bucket, so the hashes of all keys are
+    // computed upfront, and the first bucket of each key is prefetched a few
+    // keys ahead.
+    auto find_range = [&](int64_t begin, int64_t end) -> Status {
+      gtl::InlinedVector<uint64, 16> key_hashes(end - begin);
+      for (int64_t i = begin; i < end; ++i) {
+        key_hashes[i - begin] = HashKey(key_matrix, i);
       }
-      int64_t bucket_index = key_hash & bit_mask;
-      int64_t num_probes = 0;
-      while (true) {
-        if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            // TODO(andreasst): check if we can get rid of SubtleMustCopy
-            // here and elsewhere in this file.
-            value_matrix(i, j) =
-                SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
-          }
-          break;
+      for (int64_t i = begin; i < end; ++i) {
+        if (i + kFindPrefetchDistance < end) {
+          port::prefetch<port::PREFETCH_HINT_T0>(&key_buckets_matrix(
+              key_hashes[i + kFindPrefetchDistance - begin] & bit_mask, 0));
         }
-        if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
-          for (int64_t j = 0; j < value_size; ++j) {
-            value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
-          }
-          break;
+        TF_RETURN_IF_ERROR(FindOne(key_matrix, i, key_hashes[i - begin],
+                                   key_buckets_matrix, value_buckets_matrix,
+                                   empty_key_matrix, deleted_key_matrix,
+                                   default_flat, bit_mask, value_matrix));
+      }
+      return OkStatus();
+    };
+    if (ctx == nullptr || num_elements < kMinParallelFindSize) {
+      return find_range(0, num_elements);
+    }
+    // Hash and compare each key, then copy its value.
+    const int64_t cost_per_key = 100 + 10 * (key_size + value_size);
+    mutex status_mu;
+    Status status;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_elements,
+          cost_per_key, [&](int64_t begin, int64_t end) {
+            Status range_status = find_range(begin, end);
+            if (!range_status.ok()) {
+              mutex_lock status_lock(status_mu);
+              status.Update(range_status);
+            }
+          });
+    return status;
+  }
+
+  // Looks up the ith key of `key_matrix`, whose hash is `key_hash`, and writes
+  // its value (or `default_flat`) to the ith row of `value_matrix`.
+  Status FindOne(typename TTypes<K>::ConstMatrix key_matrix, int64_t i,
+                 uint64 key_hash, typename TTypes<K>::Matrix key_buckets_matrix,
+                 typename TTypes<V>::Matrix value_buckets_matrix,
+                 typename TTypes<K>::Matrix empty_key_matrix,
+                 typename TTypes<K>::Matrix deleted_key_matrix,
+                 typename TTypes<V>::ConstFlat default_flat, int64_t bit_mask,
+                 typename TTypes<V>::Matrix value_matrix) const
+      TF_SHARED_LOCKS_REQUIRED(mu_) {
+    const int64_t value_size = value_shape_.num_elements();
+    if (empty_key_hash_ == key_hash &&
+        IsEqualKey(empty_key_matrix, 0, key_matrix, i)) {
+      return errors::InvalidArgument(
+          "Using the empty_key as a table key is not allowed");
+    }
+    if (deleted_key_hash_ == key_hash &&
+        IsEqualKey(deleted_key_matrix, 0, key_matrix, i)) {
+      return errors::InvalidArgument(
+          "Using the deleted_key as a table key is not allowed");
+    }
+    int64_t bucket_index = key_hash & bit_mask;
+    int64_t num_probes = 0;
+    while (true) {
+      if (IsEqualKey(key_buckets_matrix, bucket_index, key_matrix, i)) {
+        for (int64_t j = 0; j < value_size; ++j) {
+          // TODO(andreasst): check if we can get rid of SubtleMustCopy
+          // here and elsewhere in this file.
+          value_matrix(i, j) =
+              SubtleMustCopyIfIntegral(value_buckets_matrix(bucket_index, j));
         }
-        ++num_probes;
-        bucket_index =
-            (bucket_index + num_probes) & bit_mask;  // quadratic probing
-        if (num_probes >= num_buckets_) {
-          return errors::Internal(
-              "Internal error in MutableDenseHashTable lookup");
+        break;
+      }
+      if (IsEqualKey(key_buckets_matrix, bucket_index, empty_key_matrix, 0)) {
+        for (int64_t j = 0; j < value_size; ++j) {
+          value_matrix(i, j) = SubtleMustCopyIfIntegral(default_flat(j));
         }
+        break;
+      }
+      ++num_probes;
+      bucket_index =
+          (bucket_index + num_probes) & bit_mask;  // quadratic probing
+      if (num_probes >= num_buckets_) {
+        return errors::Internal(
+            "Internal error in MutableDenseHashTable lookup");
       }
     }
     return OkStatus();
@@ -673,6 +1226,12 @@ class MutableDenseHashTable final : public LookupInterface {
   }
 
  private:
+  // The number of keys that Find() prefetches the first bucket of ahead.
+  static constexpr int64_t kFindPrefetchDistance = 8;
+
+  // The smallest number of keys that Find() looks up in parallel.
+  static constexpr int64_t kMinParallelFindSize = 1024;
+
   Status DoInsert(OpKernelContext* ctx, const Tensor& key, const Tensor& value,
                   bool ignore_empty_and_deleted_key)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1201,6 +1760,26 @@ REGISTER_KERNEL(tstring, int64_t);
 
 #undef REGISTER_KERNEL
 
+// Register the TieredHashTableOfTensors op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                               \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("TieredHashTableOfTensors")                                        \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<key_dtype>("key_dtype")                             \
+          .TypeConstraint<value_dtype>("value_dtype"),                        \
+      LookupTableOp<lookup::TieredHashTableOfTensors<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int32);
+REGISTER_KERNEL(int64_t, int64_t);
+
+#undef REGISTER_KERNEL
+
 // Register the MutableDenseHashTable op.
 #define REGISTER_KERNEL(key_dtype, value_dtype)                             \
   REGISTER_KERNEL_BUILDER(                                                  \
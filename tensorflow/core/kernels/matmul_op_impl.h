@@ -190,6 +190,19 @@ YCombinatorImpl<std::decay_t<Func>> YCombinator(Func&& func) {
   return YCombinatorImpl<std::decay_t<Func>>{std::forward<Func>(func)};
 }
 
+// Calls func(std::integral_constant<int, I>()) for I in [0, Count), unrolled
+// at compile time.
+template <class Func, int... Is>
+EIGEN_ALWAYS_INLINE void UnrolledForImpl(Func&& func,
+                                         std::integer_sequence<int, Is...>) {
+  (func(std::integral_constant<int, Is>()), ...);
+}
+
+template <int Count, class Func>
+EIGEN_ALWAYS_INLINE void UnrolledFor(Func&& func) {
+  UnrolledForImpl(func, std::make_integer_sequence<int, Count>());
+}
+
 // Sequential batch matmul kernel that calls the regular Eigen matmul.
 // We prefer this over the tensor contraction because it performs
 // better on vector-matrix and matrix-vector products.
@@ -256,6 +269,158 @@ struct SequentialMatMulKernel {
   }
 };
 
+// Batch matmul kernel for many small real matrices, such as attention heads.
+// The general Eigen product has a setup cost per product that dominates for
+// tiny matrices. This kernel is instead specialized at compile time for inner
+// and output dimensions of 8, 16, 32 and 64: a tile of output rows is
+// accumulated in packet registers, with the loops over the tile unrolled.
+template <typename Scalar>
+struct SmallMatMulKernel {
+  static_assert(std::is_floating_point<Scalar>::value,
+                "SmallMatMulKernel only supports float and double");
+
+  // The largest number of rows of the output matrices.
+  static constexpr int64_t kMaxRows = 64;
+
+  static bool IsSupportedDim(int64_t dim) {
+    return dim == 8 || dim == 16 || dim == 32 || dim == 64;
+  }
+
+  // Returns true if the kernel supports products with `inner_dim` into `out`.
+  static bool CanRun(int64_t inner_dim, const Tensor& out) {
+    return out.dim_size(1) <= kMaxRows && IsSupportedDim(inner_dim) &&
+           IsSupportedDim(out.dim_size(2));
+  }
+
+  static void Run(const Tensor& in_x, const Tensor& in_y, bool trans_x,
+                  bool trans_y, const MatMulBCast& bcast, Tensor* out,
+                  int64_t start, int64_t limit) {
+    switch (trans_x ? in_x.dim_size(1) : in_x.dim_size(2)) {
+      case 8:
+        return RunForInnerDim<8>(in_x, in_y, trans_x, trans_y, bcast, out,
+                                 start, limit);
+      case 16:
+        return RunForInnerDim<16>(in_x, in_y, trans_x, trans_y, bcast, out,
+                                  start, limit);
+      case 32:
+        return RunForInnerDim<32>(in_x, in_y, trans_x, trans_y, bcast, out,
+                                  start, limit);
+      case 64:
+        return RunForInnerDim<64>(in_x, in_y, trans_x, trans_y, bcast, out,
+                                  start, limit);
+    }
+    LOG(FATAL) << "Unsupported inner dimension";  // Crash OK
+  }
+
+ private:
+  // The packet type for rows of N elements, and the number of packets per
+  // row.
+  template <int N>
+  using Packet = typename Eigen::internal::find_best_packet<Scalar, N>::type;
+  template <int N>
+  static constexpr int kPacketsPerRow =
+      N / Eigen::internal::unpacket_traits<Packet<N>>::size;
+
+  // The number of output rows accumulated together: enough to reuse each
+  // loaded row of y, but few enough for the accumulators to stay in
+  // registers.
+  template <int N>
+  static constexpr int kRowTile =
+      std::max(1, std::min(4, 8 / kPacketsPerRow<N>));
+
+  template <int K>
+  static void RunForInnerDim(const Tensor& in_x, const Tensor& in_y,
+                             bool trans_x, bool trans_y,
+                             const MatMulBCast& bcast, Tensor* out,
+                             int64_t start, int64_t limit) {
+    switch (out->dim_size(2)) {
+      case 8:
+        return RunFixed<K, 8>(in_x, in_y, trans_x, trans_y, bcast, out, start,
+                              limit);
+      case 16:
+        return RunFixed<K, 16>(in_x, in_y, trans_x, trans_y, bcast, out,
+                               start, limit);
+      case 32:
+        return RunFixed<K, 32>(in_x, in_y, trans_x, trans_y, bcast, out,
+                               start, limit);
+      case 64:
+        return RunFixed<K, 64>(in_x, in_y, trans_x, trans_y, bcast, out,
+                               start, limit);
+    }
+    LOG(FATAL) << "Unsupported output dimension";  // Crash OK
+  }
+
+  template <int K, int N>
+  static void RunFixed(const Tensor& in_x, const Tensor& in_y, bool trans_x,
+                       bool trans_y, const MatMulBCast& bcast, Tensor* out,
+                       int64_t start, int64_t limit) {
+    using Y = Eigen::Matrix<Scalar, K, N, Eigen::RowMajor>;
+    using YTransposed = Eigen::Matrix<Scalar, N, K, Eigen::RowMajor>;
+    constexpr int kTile = kRowTile<N>;
+    const int64_t m = out->dim_size(1);
+    // Element (i, k) of x is at x[i * x_row_stride + k * x_col_stride].
+    const int64_t x_row_stride = trans_x ? 1 : K;
+    const int64_t x_col_stride = trans_x ? m : 1;
+    const bool should_bcast = bcast.IsBroadcastingRequired();
+    const auto& x_batch_indices = bcast.x_batch_indices();
+    const auto& y_batch_indices = bcast.y_batch_indices();
+    Y y_transposed;
+    for (int64_t i = start; i < limit; ++i) {
+      const int64_t x_batch_index = should_bcast ? x_batch_indices[i] : i;
+      const int64_t y_batch_index = should_bcast ? y_batch_indices[i] : i;
+      const Scalar* x = in_x.flat<Scalar>().data() + x_batch_index * m * K;
+      const Scalar* y = in_y.flat<Scalar>().data() + y_batch_index * K * N;
+      if (trans_y) {
+        y_transposed = Eigen::Map<const YTransposed>(y).transpose();
+        y = y_transposed.data();
+      }
+      Scalar* z = out->flat<Scalar>().data() + i * m * N;
+      int64_t row = 0;
+      for (; row + kTile <= m; row += kTile) {
+        MultiplyRows<K, N, kTile>(x + row * x_row_stride, x_row_stride,
+                                  x_col_stride, y, z + row * N);
+      }
+      for (; row < m; ++row) {
+        MultiplyRows<K, N, 1>(x + row * x_row_stride, x_row_stride,
+                              x_col_stride, y, z + row * N);
+      }
+    }
+  }
+
+  // Computes R consecutive rows of z = x * y, where y is a row-major K x N
+  // matrix.
+  template <int K, int N, int R>
+  static EIGEN_ALWAYS_INLINE void MultiplyRows(const Scalar* x,
+                                               int64_t x_row_stride,
+                                               int64_t x_col_stride,
+                                               const Scalar* y, Scalar* z) {
+    using Eigen::internal::pmadd;
+    using Eigen::internal::ploadu;
+    using Eigen::internal::pset1;
+    using Eigen::internal::pstoreu;
+    using P = Packet<N>;
+    constexpr int kCols = kPacketsPerRow<N>;
+    constexpr int kPacketSize = N / kCols;
+    P acc[R][kCols];
+    UnrolledFor<R * kCols>(
+        [&](auto j) { acc[j / kCols][j % kCols] = pset1<P>(Scalar(0)); });
+    for (int k = 0; k < K; ++k) {
+      P y_row[kCols];
+      UnrolledFor<kCols>(
+          [&](auto c) { y_row[c] = ploadu<P>(y + k * N + c * kPacketSize); });
+      UnrolledFor<R>([&](auto r) {
+        const P x_rk = pset1<P>(x[r * x_row_stride + k * x_col_stride]);
+        UnrolledFor<kCols>(
+            [&](auto c) { acc[r][c] = pmadd(x_rk, y_row[c], acc[r][c]); });
+      });
+    }
+    UnrolledFor<R * kCols>([&](auto j) {
+      pstoreu(z + (j / kCols) * N + (j % kCols) * kPacketSize,
+              acc[j / kCols][j % kCols]);
+    });
+  }
+};
+
 // For single-batch multiplications, manually parallize by splitting the output
 // matrix.
 template <typename Scalar>
@@ -429,6 +594,25 @@ struct LaunchBatchMatMul<CPUDevice, Scalar> {
     // Jan 21, 2020.
     const int64_t kMaxCostOuterParallelism = 128 * 128;  // heuristic.
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    if constexpr (std::is_floating_point<Scalar>::value) {
+      // Many small products, e.g. attention heads: parallelize over the batch
+      // with the specialized small-matrix kernel.
+      const int64_t inner_dim =
+          (adj_x || trans_x) ? in_x.dim_size(1) : in_x.dim_size(2);
+      if (batch_size > 1 &&
+          SmallMatMulKernel<Scalar>::CanRun(inner_dim, *out)) {
+        // For real types, the adjoint is the transpose.
+        Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+              cost_per_unit,
+              [&in_x, &in_y, adj_x, adj_y, trans_x, trans_y, &bcast, out](
+                  int64_t start, int64_t limit) {
+                SmallMatMulKernel<Scalar>::Run(in_x, in_y, adj_x || trans_x,
+                                               adj_y || trans_y, bcast, out,
+                                               start, limit);
+              });
+        return;
+      }
+    }
     // TODO(rmlarsen): Reconsider the heuristics now that we have asynchronous
     // evaluation in Eigen Tensor.
     if (small_dim > 1 &&
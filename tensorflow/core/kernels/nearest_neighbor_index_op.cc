@@ -0,0 +1,628 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Kernels for approximate nearest-neighbor search over an in-memory
+// inverted-file index.
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+using ConstMatrixMap =
+    Eigen::Map<const Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic,
+                                   Eigen::RowMajor>>;
+using ConstVectorMap = Eigen::Map<const Eigen::VectorXf>;
+using VectorMap = Eigen::Map<Eigen::VectorXf>;
+
+// An inverted-file (IVF) index for approximate nearest-neighbor search over
+// float vectors of dimension `dim`.
+//
+// Train() clusters a sample of vectors into `num_lists` centroids with
+// k-means. Add() appends every vector to the inverted list of its nearest
+// centroid. Search() ranks the centroids for each query, and then scans the
+// vectors in the lists of the `num_probes` nearest centroids. Scanning all
+// lists gives exact results.
+//
+// Vectors are compared by squared L2 distance, or by inner product where a
+// larger product means a nearer vector. Internally both are expressed as a
+// score that is smaller for nearer vectors.
+class NearestNeighborIndex : public ResourceBase {
+ public:
+  enum class Metric { kL2, kInnerProduct };
+
+  static Status ParseMetric(const string& name, Metric* metric) {
+    if (name == "l2") {
+      *metric = Metric::kL2;
+    } else if (name == "inner_product") {
+      *metric = Metric::kInnerProduct;
+    } else {
+      return errors::InvalidArgument("Unknown metric: ", name);
+    }
+    return OkStatus();
+  }
+
+  NearestNeighborIndex(int64_t dim, int64_t num_lists, Metric metric)
+      : dim_(dim), num_lists_(num_lists), metric_(metric) {}
+
+  int64_t dim() const { return dim_; }
+  int64_t num_lists() const { return num_lists_; }
+  Metric metric() const { return metric_; }
+
+  string DebugString() const override {
+    return strings::StrCat("NearestNeighborIndex(dim=", dim_,
+                           ", num_lists=", num_lists_, ", metric=",
+                           metric_ == Metric::kL2 ? "l2" : "inner_product",
+                           ")");
+  }
+
+  int64_t MemoryUsed() const override {
+    tf_shared_lock l(mu_);
+    int64_t bytes = (centroids_.size() + centroid_sq_norms_.size()) *
+                    sizeof(float);
+    for (const InvertedList& list : lists_) {
+      bytes += list.ids.size() * sizeof(int64_t) +
+               (list.vectors.size() + list.sq_norms.size()) * sizeof(float);
+    }
+    return bytes;
+  }
+
+  int64_t size() const {
+    tf_shared_lock l(mu_);
+    return size_;
+  }
+
+  // Computes the centroids from `vectors`, a [n, dim] matrix with at least
+  // `num_lists` rows, with `num_iterations` rounds of Lloyd's algorithm. The
+  // initial centroids are chosen by k-means++ seeding with a fixed seed, so
+  // training is deterministic. The index must be empty.
+  Status Train(OpKernelContext* ctx, const Tensor& vectors,
+               int64_t num_iterations) TF_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(CheckVectors(vectors, "vectors"));
+    const int64_t n = vectors.dim_size(0);
+    if (n < num_lists_) {
+      return errors::InvalidArgument("Training needs at least num_lists = ",
+                                     num_lists_, " vectors, got ", n);
+    }
+    const ConstMatrixMap data(vectors.flat<float>().data(), n, dim_);
+
+    mutex_lock l(mu_);
+    if (size_ > 0) {
+      return errors::FailedPrecondition(
+          "Cannot train a NearestNeighborIndex that contains ", size_,
+          " vectors");
+    }
+    InitializeCentroids(ctx, data);
+
+    std::vector<int64_t> assignments(n);
+    Eigen::MatrixXf sums(dim_, num_lists_);
+    std::vector<int64_t> counts(num_lists_);
+    for (int64_t iteration = 0; iteration < num_iterations; ++iteration) {
+      // k-means always clusters by L2 distance; only the assignment of added
+      // vectors and the probing of lists use the index metric.
+      AssignToLists(ctx, data, Metric::kL2, &assignments);
+      sums.setZero();
+      std::fill(counts.begin(), counts.end(), 0);
+      for (int64_t i = 0; i < n; ++i) {
+        sums.col(assignments[i]) += data.row(i).transpose();
+        ++counts[assignments[i]];
+      }
+      for (int64_t c = 0; c < num_lists_; ++c) {
+        // Empty clusters keep their previous centroid.
+        if (counts[c] == 0) continue;
+        VectorMap(&centroids_[c * dim_], dim_) =
+            sums.col(c) / static_cast<float>(counts[c]);
+      }
+      UpdateCentroidNorms();
+    }
+    lists_.assign(num_lists_, InvertedList());
+    return OkStatus();
+  }
+
+  // Adds the rows of `vectors`, a [n, dim] matrix, under the matching `ids`.
+  // Ids are not required to be unique.
+  Status Add(OpKernelContext* ctx, const Tensor& ids, const Tensor& vectors)
+      TF_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(CheckVectors(vectors, "vectors"));
+    if (!TensorShapeUtils::IsVector(ids.shape()) ||
+        ids.dim_size(0) != vectors.dim_size(0)) {
+      return errors::InvalidArgument(
+          "ids must be a vector with one element per vector, got shape ",
+          ids.shape().DebugString(), " for ", vectors.dim_size(0),
+          " vectors");
+    }
+    mutex_lock l(mu_);
+    return AddLocked(ctx, ids, vectors);
+  }
+
+  // Returns the `k` nearest neighbors of each row of `queries` found in the
+  // lists of the `num_probes` nearest centroids, nearest first. Rows with
+  // fewer than `k` candidates are padded with id -1 and the distance of an
+  // infinitely far vector.
+  Status Search(OpKernelContext* ctx, const Tensor& queries, int64_t k,
+                int64_t num_probes, Tensor* distances, Tensor* ids) const
+      TF_LOCKS_EXCLUDED(mu_) {
+    const int64_t num_queries = queries.dim_size(0);
+    const ConstMatrixMap query_data(queries.flat<float>().data(), num_queries,
+                                    dim_);
+    auto distances_matrix = distances->matrix<float>();
+    auto ids_matrix = ids->matrix<int64_t>();
+    const float infinity = std::numeric_limits<float>::infinity();
+    const float padding_distance =
+        metric_ == Metric::kL2 ? infinity : -infinity;
+
+    tf_shared_lock l(mu_);
+    // An untrained index finds nothing.
+    num_probes = std::min(num_probes, static_cast<int64_t>(lists_.size()));
+
+    auto search = [&](int64_t begin, int64_t end) {
+      std::vector<float> centroid_scores;
+      std::vector<int64_t> probes(lists_.size());
+      std::vector<float> scores;
+      std::vector<std::pair<float, int64_t>> candidates;
+      for (int64_t q = begin; q < end; ++q) {
+        const ConstVectorMap query(query_data.data() + q * dim_, dim_);
+        ComputeScores(ConstMatrixMap(centroids_.data(), lists_.size(), dim_),
+                      centroid_sq_norms_, query, metric_, &centroid_scores);
+        std::iota(probes.begin(), probes.end(), 0);
+        std::partial_sort(probes.begin(), probes.begin() + num_probes,
+                          probes.end(), [&](int64_t a, int64_t b) {
+                            return centroid_scores[a] < centroid_scores[b] ||
+                                   (centroid_scores[a] == centroid_scores[b] &&
+                                    a < b);
+                          });
+
+        candidates.clear();
+        for (int64_t p = 0; p < num_probes; ++p) {
+          const InvertedList& list = lists_[probes[p]];
+          const int64_t list_size = list.ids.size();
+          if (list_size == 0) continue;
+          ComputeScores(ConstMatrixMap(list.vectors.data(), list_size, dim_),
+                        list.sq_norms, query, metric_, &scores);
+          for (int64_t i = 0; i < list_size; ++i) {
+            candidates.emplace_back(scores[i], list.ids[i]);
+          }
+        }
+
+        const int64_t num_found =
+            std::min(k, static_cast<int64_t>(candidates.size()));
+        std::partial_sort(candidates.begin(), candidates.begin() + num_found,
+                          candidates.end());
+        for (int64_t i = 0; i < num_found; ++i) {
+          distances_matrix(q, i) = metric_ == Metric::kL2
+                                       ? std::max(candidates[i].first, 0.0f)
+                                       : -candidates[i].first;
+          ids_matrix(q, i) = candidates[i].second;
+        }
+        for (int64_t i = num_found; i < k; ++i) {
+          distances_matrix(q, i) = padding_distance;
+          ids_matrix(q, i) = -1;
+        }
+      }
+    };
+    const int64_t scanned_per_query =
+        lists_.size() +
+        (lists_.empty() ? 0 : num_probes * size_ / lists_.size());
+    const int64_t cost_per_query = (scanned_per_query + 1) * dim_ * 2;
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_queries,
+          cost_per_query, search);
+    return OkStatus();
+  }
+
+  Status ExportValues(OpKernelContext* ctx) const TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    Tensor* centroids;
+    Tensor* ids;
+    Tensor* vectors;
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "centroids",
+        TensorShape({static_cast<int64_t>(lists_.size()), dim_}), &centroids));
+    TF_RETURN_IF_ERROR(ctx->allocate_output("ids", TensorShape({size_}), &ids));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("vectors", TensorShape({size_, dim_}), &vectors));
+
+    std::copy(centroids_.begin(), centroids_.end(),
+              centroids->flat<float>().data());
+    int64_t* ids_data = ids->flat<int64_t>().data();
+    float* vectors_data = vectors->flat<float>().data();
+    for (const InvertedList& list : lists_) {
+      ids_data = std::copy(list.ids.begin(), list.ids.end(), ids_data);
+      vectors_data =
+          std::copy(list.vectors.begin(), list.vectors.end(), vectors_data);
+    }
+    return OkStatus();
+  }
+
+  // Replaces the contents of the index by exported ones. `centroids` is
+  // either [num_lists, dim], or [0, dim] for an untrained empty index.
+  Status ImportValues(OpKernelContext* ctx, const Tensor& centroids,
+                      const Tensor& ids, const Tensor& vectors)
+      TF_LOCKS_EXCLUDED(mu_) {
+    TF_RETURN_IF_ERROR(CheckVectors(centroids, "centroids"));
+    TF_RETURN_IF_ERROR(CheckVectors(vectors, "vectors"));
+    const int64_t num_centroids = centroids.dim_size(0);
+    if (num_centroids != num_lists_ && num_centroids != 0) {
+      return errors::InvalidArgument("Expected ", num_lists_,
+                                     " centroids, got ", num_centroids);
+    }
+    if (!TensorShapeUtils::IsVector(ids.shape()) ||
+        ids.dim_size(0) != vectors.dim_size(0)) {
+      return errors::InvalidArgument(
+          "ids must be a vector with one element per vector, got shape ",
+          ids.shape().DebugString(), " for ", vectors.dim_size(0),
+          " vectors");
+    }
+    if (num_centroids == 0 && ids.NumElements() > 0) {
+      return errors::InvalidArgument(
+          "Cannot import vectors into an index without centroids");
+    }
+
+    mutex_lock l(mu_);
+    const auto centroids_flat = centroids.flat<float>();
+    centroids_.assign(centroids_flat.data(),
+                      centroids_flat.data() + centroids_flat.size());
+    UpdateCentroidNorms();
+    lists_.assign(num_centroids, InvertedList());
+    size_ = 0;
+    return AddLocked(ctx, ids, vectors);
+  }
+
+ private:
+  struct InvertedList {
+    std::vector<int64_t> ids;
+    // The vectors of the list as a row-major [ids.size(), dim] matrix, and
+    // their squared L2 norms.
+    std::vector<float> vectors;
+    std::vector<float> sq_norms;
+  };
+
+  Status CheckVectors(const Tensor& vectors, StringPiece name) const {
+    if (!TensorShapeUtils::IsMatrix(vectors.shape()) ||
+        vectors.dim_size(1) != dim_) {
+      return errors::InvalidArgument(name, " must be a matrix with ", dim_,
+                                     " columns, got shape ",
+                                     vectors.shape().DebugString());
+    }
+    return OkStatus();
+  }
+
+  // Sets `scores` to the scores of the rows of `vectors` for `query`, where
+  // `sq_norms` holds the squared L2 norms of the rows.
+  static void ComputeScores(const ConstMatrixMap& vectors,
+                            const std::vector<float>& sq_norms,
+                            const ConstVectorMap& query, Metric metric,
+                            std::vector<float>* scores) {
+    scores->resize(vectors.rows());
+    VectorMap scores_vector(scores->data(), vectors.rows());
+    scores_vector.noalias() = vectors * query;
+    if (metric == Metric::kL2) {
+      // ||x - q||^2 = ||x||^2 - 2 x.q + ||q||^2.
+      scores_vector = ((ConstVectorMap(sq_norms.data(), vectors.rows()) -
+                        2.0f * scores_vector)
+                           .array() +
+                       query.squaredNorm())
+                          .matrix();
+    } else {
+      scores_vector = -scores_vector;
+    }
+  }
+
+  // Picks `num_lists_` rows of `data` as the initial centroids: the first one
+  // uniformly at random, and each next one with probability proportional to
+  // its squared distance to the nearest centroid picked so far.
+  void InitializeCentroids(OpKernelContext* ctx, const ConstMatrixMap& data)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t n = data.rows();
+    random::PhiloxRandom philox(kCentroidSeed);
+    random::SimplePhilox rng(&philox);
+    centroids_.resize(num_lists_ * dim_);
+    std::vector<float> min_sq_distances(n, std::numeric_limits<float>::max());
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    int64_t row = rng.Uniform64(n);
+    for (int64_t c = 0; c < num_lists_; ++c) {
+      if (c > 0) {
+        const double total = std::accumulate(min_sq_distances.begin(),
+                                             min_sq_distances.end(), 0.0);
+        if (total > 0) {
+          double threshold = rng.RandDouble() * total;
+          row = 0;
+          while (row < n - 1 && threshold >= min_sq_distances[row]) {
+            threshold -= min_sq_distances[row];
+            ++row;
+          }
+        } else {
+          // All vectors coincide with a centroid.
+          row = c * n / num_lists_;
+        }
+      }
+      const ConstVectorMap centroid(data.data() + row * dim_, dim_);
+      VectorMap(&centroids_[c * dim_], dim_) = centroid;
+      auto update = [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          min_sq_distances[i] = std::min(
+              min_sq_distances[i], (data.row(i).transpose() - centroid)
+                                       .squaredNorm());
+        }
+      };
+      Shard(worker_threads->num_threads, worker_threads->workers, n, dim_ * 3,
+            update);
+    }
+    UpdateCentroidNorms();
+  }
+
+  void UpdateCentroidNorms() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t num_centroids = centroids_.size() / dim_;
+    centroid_sq_norms_.resize(num_centroids);
+    VectorMap(centroid_sq_norms_.data(), num_centroids) =
+        ConstMatrixMap(centroids_.data(), num_centroids, dim_)
+            .rowwise()
+            .squaredNorm();
+  }
+
+  // Sets `assignments` to the index of the nearest centroid of each row of
+  // `vectors`.
+  void AssignToLists(OpKernelContext* ctx, const ConstMatrixMap& vectors,
+                     Metric metric, std::vector<int64_t>* assignments) const
+      TF_SHARED_LOCKS_REQUIRED(mu_) {
+    const int64_t num_centroids = centroid_sq_norms_.size();
+    const ConstMatrixMap centroids(centroids_.data(), num_centroids, dim_);
+    auto assign = [&](int64_t begin, int64_t end) {
+      std::vector<float> scores;
+      for (int64_t i = begin; i < end; ++i) {
+        ComputeScores(centroids, centroid_sq_norms_,
+                      ConstVectorMap(vectors.data() + i * dim_, dim_), metric,
+                      &scores);
+        (*assignments)[i] =
+            std::min_element(scores.begin(), scores.end()) - scores.begin();
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, vectors.rows(),
+          num_centroids * dim_ * 2, assign);
+  }
+
+  Status AddLocked(OpKernelContext* ctx, const Tensor& ids,
+                   const Tensor& vectors) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const int64_t n = vectors.dim_size(0);
+    if (n == 0) return OkStatus();
+    if (lists_.empty()) {
+      return errors::FailedPrecondition(
+          "A NearestNeighborIndex must be trained before vectors are added");
+    }
+    const ConstMatrixMap data(vectors.flat<float>().data(), n, dim_);
+    const auto ids_flat = ids.flat<int64_t>();
+    std::vector<int64_t> assignments(n);
+    AssignToLists(ctx, data, metric_, &assignments);
+    for (int64_t i = 0; i < n; ++i) {
+      InvertedList& list = lists_[assignments[i]];
+      list.ids.push_back(ids_flat(i));
+      const float* vector = data.data() + i * dim_;
+      list.vectors.insert(list.vectors.end(), vector, vector + dim_);
+      list.sq_norms.push_back(data.row(i).squaredNorm());
+    }
+    size_ += n;
+    return OkStatus();
+  }
+
+  static constexpr uint64 kCentroidSeed = 0x5eed;
+
+  const int64_t dim_;
+  const int64_t num_lists_;
+  const Metric metric_;
+
+  mutable mutex mu_;
+  // The centroids as a row-major [lists_.size(), dim] matrix, and their
+  // squared L2 norms. Empty until the index is trained or imported.
+  std::vector<float> centroids_ TF_GUARDED_BY(mu_);
+  std::vector<float> centroid_sq_norms_ TF_GUARDED_BY(mu_);
+  std::vector<InvertedList> lists_ TF_GUARDED_BY(mu_);
+  int64_t size_ TF_GUARDED_BY(mu_) = 0;
+};
+
+Status GetNearestNeighborIndex(OpKernelContext* ctx,
+                               core::RefCountPtr<NearestNeighborIndex>* index) {
+  return LookupResource(ctx, HandleFromInput(ctx, 0), index);
+}
+
+class NearestNeighborIndexOp : public ResourceOpKernel<NearestNeighborIndex> {
+ public:
+  explicit NearestNeighborIndexOp(OpKernelConstruction* ctx)
+      : ResourceOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dim", &dim_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_lists", &num_lists_));
+    string metric;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("metric", &metric));
+    OP_REQUIRES_OK(ctx, NearestNeighborIndex::ParseMetric(metric, &metric_));
+  }
+
+ private:
+  Status CreateResource(NearestNeighborIndex** index) override
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *index = new NearestNeighborIndex(dim_, num_lists_, metric_);
+    return OkStatus();
+  }
+
+  Status VerifyResource(NearestNeighborIndex* index) override {
+    if (index->dim() != dim_ || index->num_lists() != num_lists_ ||
+        index->metric() != metric_) {
+      return errors::InvalidArgument(
+          "Shared ", index->DebugString(),
+          " does not match the requested dim=", dim_,
+          ", num_lists=", num_lists_);
+    }
+    return OkStatus();
+  }
+
+  int64_t dim_;
+  int64_t num_lists_;
+  NearestNeighborIndex::Metric metric_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndex").Device(DEVICE_CPU),
+                        NearestNeighborIndexOp);
+
+class NearestNeighborIndexTrainOp : public OpKernel {
+ public:
+  explicit NearestNeighborIndexTrainOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_iterations", &num_iterations_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<NearestNeighborIndex> index;
+    OP_REQUIRES_OK(ctx, GetNearestNeighborIndex(ctx, &index));
+    OP_REQUIRES_OK(ctx, index->Train(ctx, ctx->input(1), num_iterations_));
+  }
+
+ private:
+  int64_t num_iterations_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndexTrain").Device(DEVICE_CPU),
+                        NearestNeighborIndexTrainOp);
+
+class NearestNeighborIndexAddOp : public OpKernel {
+ public:
+  explicit NearestNeighborIndexAddOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<NearestNeighborIndex> index;
+    OP_REQUIRES_OK(ctx, GetNearestNeighborIndex(ctx, &index));
+    OP_REQUIRES_OK(ctx, index->Add(ctx, ctx->input(1), ctx->input(2)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndexAdd").Device(DEVICE_CPU),
+                        NearestNeighborIndexAddOp);
+
+class NearestNeighborIndexSearchOp : public OpKernel {
+ public:
+  explicit NearestNeighborIndexSearchOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<NearestNeighborIndex> index;
+    OP_REQUIRES_OK(ctx, GetNearestNeighborIndex(ctx, &index));
+
+    const Tensor& queries = ctx->input(1);
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsMatrix(queries.shape()) &&
+                    queries.dim_size(1) == index->dim(),
+                errors::InvalidArgument(
+                    "queries must be a matrix with ", index->dim(),
+                    " columns, got shape ", queries.shape().DebugString()));
+    const Tensor& k_in = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(k_in.shape()),
+                errors::InvalidArgument("k must be a scalar, got shape ",
+                                        k_in.shape().DebugString()));
+    const int64_t k = k_in.scalar<int32>()();
+    OP_REQUIRES(ctx, k >= 0,
+                errors::InvalidArgument("k must be non-negative, got ", k));
+    const Tensor& num_probes_in = ctx->input(3);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(num_probes_in.shape()),
+                errors::InvalidArgument(
+                    "num_probes must be a scalar, got shape ",
+                    num_probes_in.shape().DebugString()));
+    const int64_t num_probes = num_probes_in.scalar<int32>()();
+    OP_REQUIRES(ctx, num_probes >= 1,
+                errors::InvalidArgument("num_probes must be positive, got ",
+                                        num_probes));
+
+    const TensorShape output_shape({queries.dim_size(0), k});
+    Tensor* distances;
+    Tensor* ids;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, output_shape, &distances));
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, output_shape, &ids));
+    if (output_shape.num_elements() == 0) return;
+    OP_REQUIRES_OK(
+        ctx, index->Search(ctx, queries, k, num_probes, distances, ids));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndexSearch").Device(DEVICE_CPU),
+                        NearestNeighborIndexSearchOp);
+
+class NearestNeighborIndexSizeOp : public OpKernel {
+ public:
+  explicit NearestNeighborIndexSizeOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<NearestNeighborIndex> index;
+    OP_REQUIRES_OK(ctx, GetNearestNeighborIndex(ctx, &index));
+    Tensor* size;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &size));
+    size->scalar<int64_t>()() = index->size();
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndexSize").Device(DEVICE_CPU),
+                        NearestNeighborIndexSizeOp);
+
+class NearestNeighborIndexExportOp : public OpKernel {
+ public:
+  explicit NearestNeighborIndexExportOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<NearestNeighborIndex> index;
+    OP_REQUIRES_OK(ctx, GetNearestNeighborIndex(ctx, &index));
+    OP_REQUIRES_OK(ctx, index->ExportValues(ctx));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndexExport").Device(DEVICE_CPU),
+                        NearestNeighborIndexExportOp);
+
+class NearestNeighborIndexImportOp : public OpKernel {
+ public:
+  explicit NearestNeighborIndexImportOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    core::RefCountPtr<NearestNeighborIndex> index;
+    OP_REQUIRES_OK(ctx, GetNearestNeighborIndex(ctx, &index));
+    OP_REQUIRES_OK(ctx, index->ImportValues(ctx, ctx->input(1), ctx->input(2),
+                                            ctx->input(3)));
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("NearestNeighborIndexImport").Device(DEVICE_CPU),
+                        NearestNeighborIndexImportOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,284 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(TENSORFLOW_DISABLE_VNNI)
+#define TENSORFLOW_USE_VNNI (1)
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace vnni {
+
+namespace {
+
+bool g_enabled = true;
+
+#ifdef TENSORFLOW_USE_VNNI
+
+// Compiles the kernels for AVX512-VNNI regardless of the build flags; they are
+// only called once IsSupportedAndEnabled() has checked the CPU.
+#define TF_VNNI_TARGET __attribute__((target("avx512f,avx512bw,avx512vnni")))
+
+// vpdpbusd multiplies groups of 4 unsigned lhs bytes with 4 signed rhs bytes,
+// and adds each group to one of 16 int32 accumulators.
+constexpr int kDepthGroup = 4;
+constexpr int kBlockCols = 16;
+// The number of lhs rows that share each loaded block of the rhs operand.
+constexpr int kBlockRows = 4;
+
+// The rhs operand, with 128 subtracted from each value to make it signed, in
+// blocks of kBlockCols columns. Each block holds, for each group of
+// kDepthGroup rows, the kDepthGroup values of each of its columns.
+struct PackedRhs {
+  int depth_groups;
+  int col_blocks;
+  std::vector<int8> data;
+  // The terms of the result that depend on the column, see MultiplyRows().
+  std::vector<int32> row_sum_factors;
+  std::vector<int32> offset_a_factors;
+};
+
+// The operands are read as unsigned values. Signed operands are read with
+// their sign bit flipped, which adds 128 to them; the offsets make up for it.
+//
+// sum((a + offset_a) * (b + offset_b)) over the depth, with the rhs operand
+// packed as b - 128, is
+//   sum(a * (b - 128)) + sum(a) * (128 + offset_b)
+//   + offset_a * (sum(b) + k * offset_b)
+// so each result is the product of the packed operands, plus the sum of its
+// lhs row times a factor of its column, plus the offset of its lhs row times
+// another factor of its column.
+void PackRhs(bool transpose_b, const uint8* b, uint8 flip, int n, int k,
+             int ldb, const int32* offsets_b, PackedRhs* rhs) {
+  rhs->depth_groups = (k + kDepthGroup - 1) / kDepthGroup;
+  rhs->col_blocks = (n + kBlockCols - 1) / kBlockCols;
+  rhs->data.assign(static_cast<size_t>(rhs->col_blocks) * rhs->depth_groups *
+                       kBlockCols * kDepthGroup,
+                   0);
+  rhs->row_sum_factors.assign(static_cast<size_t>(rhs->col_blocks) * kBlockCols,
+                              0);
+  rhs->offset_a_factors.assign(
+      static_cast<size_t>(rhs->col_blocks) * kBlockCols, 0);
+  for (int j = 0; j < n; ++j) {
+    int8* block = rhs->data.data() + static_cast<size_t>(j / kBlockCols) *
+                                         rhs->depth_groups * kBlockCols *
+                                         kDepthGroup;
+    const int col = j % kBlockCols;
+    int32 sum = 0;
+    for (int l = 0; l < k; ++l) {
+      const uint8 value = (transpose_b ? b[static_cast<size_t>(j) * ldb + l]
+                                       : b[static_cast<size_t>(l) * ldb + j]) ^
+                          flip;
+      sum += value;
+      block[(l / kDepthGroup) * kBlockCols * kDepthGroup + col * kDepthGroup +
+            l % kDepthGroup] = static_cast<int8>(value ^ 0x80);
+    }
+    rhs->row_sum_factors[j] = 128 + offsets_b[j];
+    rhs->offset_a_factors[j] = sum + k * offsets_b[j];
+  }
+}
+
+// Packs rows [row_begin, row_end) of the lhs operand as one uint32 per group
+// of kDepthGroup values, padding the rows to a multiple of kBlockRows and the
+// depth to a multiple of kDepthGroup with zeros. Also returns the sum of the
+// values of each row.
+void PackLhs(bool transpose_a, const uint8* a, uint8 flip, int row_begin,
+             int row_end, int k, int lda, int depth_groups,
+             std::vector<uint32>* lhs, std::vector<int32>* row_sums) {
+  const int rows = row_end - row_begin;
+  const int padded_rows = (rows + kBlockRows - 1) / kBlockRows * kBlockRows;
+  lhs->assign(static_cast<size_t>(padded_rows) * depth_groups, 0);
+  row_sums->assign(padded_rows, 0);
+  uint8* bytes = reinterpret_cast<uint8*>(lhs->data());
+  for (int r = 0; r < rows; ++r) {
+    const int i = row_begin + r;
+    uint8* row = bytes + static_cast<size_t>(r) * depth_groups * kDepthGroup;
+    int32 sum = 0;
+    for (int l = 0; l < k; ++l) {
+      const uint8 value = (transpose_a ? a[static_cast<size_t>(l) * lda + i]
+                                       : a[static_cast<size_t>(i) * lda + l]) ^
+                          flip;
+      sum += value;
+      row[l] = value;
+    }
+    (*row_sums)[r] = sum;
+  }
+}
+
+// Multiplies kBlockRows packed lhs rows with the rhs column block "rhs_block",
+// and stores the first "rows" rows and "cols" columns of the result in "c",
+// after adding the terms that depend on the row sums and offsets.
+TF_VNNI_TARGET void MultiplyBlock(const uint32* lhs, const int8* rhs_block,
+                                  int depth_groups, const int32* row_sums,
+                                  const int32* offsets_a,
+                                  __m512i row_sum_factors,
+                                  __m512i offset_a_factors, int rows, int cols,
+                                  int32* c, int ldc) {
+  __m512i acc[kBlockRows];
+  for (int r = 0; r < kBlockRows; ++r) acc[r] = _mm512_setzero_si512();
+  for (int g = 0; g < depth_groups; ++g) {
+    const __m512i rhs =
+        _mm512_loadu_si512(rhs_block + g * kBlockCols * kDepthGroup);
+    for (int r = 0; r < kBlockRows; ++r) {
+      acc[r] = _mm512_dpbusd_epi32(
+          acc[r], _mm512_set1_epi32(lhs[r * depth_groups + g]), rhs);
+    }
+  }
+  const __mmask16 mask = static_cast<__mmask16>((1u << cols) - 1);
+  for (int r = 0; r < rows; ++r) {
+    const __m512i result = _mm512_add_epi32(
+        acc[r],
+        _mm512_add_epi32(
+            _mm512_mullo_epi32(_mm512_set1_epi32(row_sums[r]),
+                               row_sum_factors),
+            _mm512_mullo_epi32(_mm512_set1_epi32(offsets_a[r]),
+                               offset_a_factors)));
+    _mm512_mask_storeu_epi32(c + static_cast<size_t>(r) * ldc, mask, result);
+  }
+}
+
+// Computes rows [row_begin, row_end) of the result. The column blocks are the
+// outer loop so that each block of the rhs operand stays in cache while all
+// the rows are multiplied with it.
+TF_VNNI_TARGET void MultiplyRows(bool transpose_a, const uint8* a, uint8 flip,
+                                 const PackedRhs& rhs, int32* c, int row_begin,
+                                 int row_end, int n, int k,
+                                 const int32* offsets_a, int lda, int ldc) {
+  std::vector<uint32> lhs;
+  std::vector<int32> row_sums;
+  PackLhs(transpose_a, a, flip, row_begin, row_end, k, lda, rhs.depth_groups,
+          &lhs, &row_sums);
+  const size_t block_size =
+      static_cast<size_t>(rhs.depth_groups) * kBlockCols * kDepthGroup;
+  for (int cb = 0; cb < rhs.col_blocks; ++cb) {
+    const int cols = std::min(kBlockCols, n - cb * kBlockCols);
+    const __m512i row_sum_factors =
+        _mm512_loadu_si512(rhs.row_sum_factors.data() + cb * kBlockCols);
+    const __m512i offset_a_factors =
+        _mm512_loadu_si512(rhs.offset_a_factors.data() + cb * kBlockCols);
+    for (int r = 0; r < row_end - row_begin; r += kBlockRows) {
+      MultiplyBlock(lhs.data() + static_cast<size_t>(r) * rhs.depth_groups,
+                    rhs.data.data() + cb * block_size, rhs.depth_groups,
+                    row_sums.data() + r, offsets_a + row_begin + r,
+                    row_sum_factors, offset_a_factors,
+                    std::min(kBlockRows, row_end - row_begin - r), cols,
+                    c + static_cast<size_t>(row_begin + r) * ldc +
+                        cb * kBlockCols,
+                    ldc);
+    }
+  }
+}
+
+// Computes the product of the operands, read as unsigned after xoring them
+// with "flip", with an offset for each row of the lhs operand and each column
+// of the rhs operand.
+void Gemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+          const uint8* a, const uint8* b, uint8 flip, int32* c, int m, int n,
+          int k, const int32* offsets_a, const int32* offsets_b, int lda,
+          int ldb, int ldc) {
+  PackedRhs rhs;
+  PackRhs(transpose_b, b, flip, n, k, ldb, offsets_b, &rhs);
+
+  // MultiplyBlock() reads the offsets of kBlockRows rows at a time.
+  const int row_blocks = (m + kBlockRows - 1) / kBlockRows;
+  std::vector<int32> padded_offsets_a(offsets_a, offsets_a + m);
+  padded_offsets_a.resize(static_cast<size_t>(row_blocks) * kBlockRows, 0);
+
+  const int64_t cost_per_row_block =
+      static_cast<int64_t>(kBlockRows) * rhs.col_blocks * kBlockCols *
+      std::max(rhs.depth_groups, 1);
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, row_blocks,
+        cost_per_row_block, [&](int64_t begin, int64_t end) {
+          MultiplyRows(transpose_a, a, flip, rhs, c, begin * kBlockRows,
+                       std::min<int64_t>(end * kBlockRows, m), n, k,
+                       padded_offsets_a.data(), lda, ldc);
+        });
+}
+
+bool IsSupported() {
+  static const bool supported = port::TestCPUFeature(port::AVX512F) &&
+                                port::TestCPUFeature(port::AVX512BW) &&
+                                port::TestCPUFeature(port::AVX512_VNNI);
+  return supported;
+}
+
+#else
+
+bool IsSupported() { return false; }
+
+#endif  // TENSORFLOW_USE_VNNI
+
+}  // namespace
+
+void SetEnabled(bool enabled) { g_enabled = enabled; }
+
+bool IsSupportedAndEnabled() { return g_enabled && IsSupported(); }
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+#ifdef TENSORFLOW_USE_VNNI
+  CHECK(IsSupported()) << "AVX512-VNNI is not supported by this CPU.";
+  if (m == 0 || n == 0) return;
+  const std::vector<int32> offsets_a(m, offset_a);
+  const std::vector<int32> offsets_b(n, offset_b);
+  Gemm(context, transpose_a, transpose_b, &(a_data->value), &(b_data->value),
+       /*flip=*/0, &(c_data->value), m, n, k, offsets_a.data(),
+       offsets_b.data(), lda, ldb, ldc);
+#else
+  LOG(FATAL) << "QuantizedGemm: AVX512-VNNI codepath not supported.";
+#endif
+}
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const qint8* a_data, const qint8* b_data, qint32* c_data,
+                   int m, int n, int k, const int32* offsets_a,
+                   const int32* offsets_b, int lda, int ldb, int ldc) {
+#ifdef TENSORFLOW_USE_VNNI
+  CHECK(IsSupported()) << "AVX512-VNNI is not supported by this CPU.";
+  if (m == 0 || n == 0) return;
+  // Flipping the sign bit adds 128 to the values.
+  std::vector<int32> unsigned_offsets_a(offsets_a, offsets_a + m);
+  for (int32& offset : unsigned_offsets_a) offset -= 128;
+  std::vector<int32> unsigned_offsets_b(offsets_b, offsets_b + n);
+  for (int32& offset : unsigned_offsets_b) offset -= 128;
+  Gemm(context, transpose_a, transpose_b,
+       reinterpret_cast<const uint8*>(&(a_data->value)),
+       reinterpret_cast<const uint8*>(&(b_data->value)), /*flip=*/0x80,
+       &(c_data->value), m, n, k, unsigned_offsets_a.data(),
+       unsigned_offsets_b.data(), lda, ldb, ldc);
+#else
+  LOG(FATAL) << "QuantizedGemm: AVX512-VNNI codepath not supported.";
+#endif
+}
+
+}  // namespace vnni
+}  // namespace tensorflow
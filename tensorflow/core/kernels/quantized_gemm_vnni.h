@@ -0,0 +1,71 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_VNNI_H_
+#define TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_VNNI_H_
+
+#include "tensorflow/core/framework/numeric_types.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+namespace vnni {
+
+// An eight-bit quantized matrix multiplication for x86 CPUs with AVX512-VNNI
+// (Cascade Lake, Ice Lake, Sapphire Rapids and later), selected at runtime so
+// that stock builds use it without special compiler flags.
+
+// Toggles the codepath. Enabled by default (true) on supported CPUs.
+void SetEnabled(bool enabled);
+
+// Returns true if the CPU supports the codepath and it is enabled. Use this
+// call before calling QuantizedGemm(); if the codepath is not supported, and
+// QuantizedGemm() is called, it logs a FATAL error.
+bool IsSupportedAndEnabled();
+
+// Calculate the quantized matrix multiplication:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] + offset_a) * (b_data[l, j] + offset_b)) : l in [0, k)
+//
+// If transpose_a is false the lhs operand has row major layout, otherwise
+// column major. Similarly transpose_b describes the layout of the rhs operand.
+// lda, ldb, and ldc are the strides of the lhs operand, rhs operand and the
+// result arrays. The work is split across the worker threads of "context".
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc);
+
+// Same as above, for signed operands, with an offset for each row of the lhs
+// operand and each column of the rhs operand:
+//
+// for (i, j) in [0, m) x [0, n) do
+//   c_data[i, j] :=
+//     sum((a_data[i, l] + offsets_a[i]) * (b_data[l, j] + offsets_b[j])) :
+//       l in [0, k)
+//
+// offsets_a has m elements and offsets_b has n elements.
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const qint8* a_data, const qint8* b_data, qint32* c_data,
+                   int m, int n, int k, const int32* offsets_a,
+                   const int32* offsets_b, int lda, int ldb, int ldc);
+
+}  // namespace vnni
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_QUANTIZED_GEMM_VNNI_H_
@@ -30,13 +30,57 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
 
 class QuantizedMatMulTest : public OpsTestBase {
  protected:
+  // Multiplies a random [m, k] matrix with a random [k, n] matrix, with the
+  // AVX512-VNNI code path enabled or not, and returns the result.
+  Tensor RandomMatMul(int m, int n, int k, bool transpose_a, bool transpose_b,
+                      bool enable_vnni) {
+    inputs_.clear();
+    TF_CHECK_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                    .Input(FakeInput(DT_QUINT8))
+                    .Input(FakeInput(DT_QUINT8))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                    .Attr("transpose_a", transpose_a)
+                    .Attr("transpose_b", transpose_b)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+
+    random::PhiloxRandom philox(m * n * k + 1, 17);
+    random::SimplePhilox rnd(&philox);
+    Tensor a(DT_QUINT8,
+             transpose_a ? TensorShape({k, m}) : TensorShape({m, k}));
+    for (int i = 0; i < a.NumElements(); ++i) {
+      a.flat<quint8>()(i) = rnd.Uniform(256);
+    }
+    Tensor b(DT_QUINT8,
+             transpose_b ? TensorShape({n, k}) : TensorShape({k, n}));
+    for (int i = 0; i < b.NumElements(); ++i) {
+      b.flat<quint8>()(i) = rnd.Uniform(256);
+    }
+    AddInputFromArray<quint8>(a.shape(), a.flat<quint8>());
+    AddInputFromArray<quint8>(b.shape(), b.flat<quint8>());
+    AddInputFromArray<float>(TensorShape({}), {-1.0f});
+    AddInputFromArray<float>(TensorShape({}), {2.0f});
+    AddInputFromArray<float>(TensorShape({}), {-3.0f});
+    AddInputFromArray<float>(TensorShape({}), {1.0f});
+
+    vnni::SetEnabled(enable_vnni);
+    TF_CHECK_OK(RunOpKernel());
+    vnni::SetEnabled(true);
+    return *GetOutput(0);
+  }
 };
 
 // Runs two small matrices through the operator, and leaves all the parameters
@@ -393,4 +437,24 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+// Checks that the AVX512-VNNI code path, used on CPUs that support it, matches
+// gemmlowp on shapes that are not multiples of its blocks.
+TEST_F(QuantizedMatMulTest, Vnni_MatchesGemmlowp) {
+  for (bool transpose_a : {false, true}) {
+    for (bool transpose_b : {false, true}) {
+      for (const auto& mnk : std::vector<std::vector<int>>{
+               {1, 1, 1}, {7, 37, 19}, {33, 16, 64}, {5, 70, 3}}) {
+        const int m = mnk[0];
+        const int n = mnk[1];
+        const int k = mnk[2];
+        Tensor vnni_result =
+            RandomMatMul(m, n, k, transpose_a, transpose_b, true);
+        Tensor gemmlowp_result =
+            RandomMatMul(m, n, k, transpose_a, transpose_b, false);
+        test::ExpectTensorEqual<qint32>(gemmlowp_result, vnni_result);
+      }
+    }
+  }
+}
+
 }  // namespace tensorflow
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <utility>
 #include <vector>
 
@@ -32,7 +33,7 @@ namespace {
 Status RaggedComponentsFromVariant(
     const Tensor& encoded_variant, int input_ragged_rank,
     int output_ragged_rank, DataType value_dtype, DataType split_dtype,
-    std::vector<RaggedTensorVariant>* decoded_ragged) {
+    std::vector<const RaggedTensorVariant*>* decoded_ragged) {
   const auto& flat_variants = encoded_variant.flat<Variant>();
   decoded_ragged->reserve(flat_variants.size());
 
@@ -45,8 +46,8 @@ Status RaggedComponentsFromVariant(
           "Input Variant element at index ", i,
           " doesn't hold a RaggedTensorVariant: ", flat_variant.DebugString());
     }
-    decoded_ragged->push_back(*decoded);
-    decoded = &decoded_ragged->back();
+    // The components are only read, so point at them instead of copying them.
+    decoded_ragged->push_back(decoded);
     // Check ragged rank & types
     if (decoded->ragged_rank() != input_ragged_rank) {
       return errors::InvalidArgument(
@@ -92,14 +93,14 @@ Status RaggedComponentsFromVariant(
  */
 template <typename VALUE_TYPE>
 Status StackNonRaggedTensors(
-    const std::vector<RaggedTensorVariant>& ragged_components,
+    const std::vector<const RaggedTensorVariant*>& ragged_components,
     RaggedTensorVariant* output_ragged) {
   if (ragged_components.empty()) {
     output_ragged->set_values(Tensor(DataTypeToEnum<VALUE_TYPE>::value, {0}));
     return OkStatus();
   }
 
-  TensorShape component_values_shape = ragged_components[0].values().shape();
+  TensorShape component_values_shape = ragged_components[0]->values().shape();
   TensorShape result_shape = component_values_shape;
   result_shape.InsertDim(0, ragged_components.size());
 
@@ -108,7 +109,7 @@ Status StackNonRaggedTensors(
   auto output_values_flat = output_ragged->mutable_values()->flat<VALUE_TYPE>();
   int values_index = 0;
   for (int i = 0; i < ragged_components.size(); i++) {
-    auto& component_values = ragged_components[i].values();
+    auto& component_values = ragged_components[i]->values();
     if (component_values.shape() != component_values_shape) {
       return errors::InvalidArgument(
           "All flat_values must have compatible shapes.  Shape at index 0: ",
@@ -116,16 +117,16 @@ Status StackNonRaggedTensors(
           component_values.shape());
     }
     auto component_values_flat = component_values.flat<VALUE_TYPE>();
-    for (int j = 0; j < component_values_flat.size(); j++) {
-      output_values_flat(values_index++) = component_values_flat(j);
-    }
+    std::copy_n(component_values_flat.data(), component_values_flat.size(),
+                output_values_flat.data() + values_index);
+    values_index += component_values_flat.size();
   }
   return OkStatus();
 }
 
 template <typename VALUE_TYPE, typename SPLIT_TYPE>
 Status NestedStackRaggedTensors(
-    const std::vector<RaggedTensorVariant>& ragged_components,
+    const std::vector<const RaggedTensorVariant*>& ragged_components,
     const std::vector<int>& nested_dim_sizes, const int input_ragged_rank,
     const int output_ragged_rank, RaggedTensorVariant* output_ragged) {
   output_ragged->mutable_nested_splits()->reserve(output_ragged_rank);
@@ -161,9 +162,9 @@ Status NestedStackRaggedTensors(
       output_ragged->mutable_splits(dims - 1)->vec<SPLIT_TYPE>();
   dims_splits_vec(0) = 0;
   for (int i = 0; i < ragged_components.size(); i++) {
-    int split_val = ragged_components[i].values().shape().dim_size(0);
-    if (input_ragged_rank != 0 && ragged_components[i].ragged_rank() > 0) {
-      split_val = ragged_components[i].splits(0).NumElements() - 1;
+    int split_val = ragged_components[i]->values().shape().dim_size(0);
+    if (input_ragged_rank != 0 && ragged_components[i]->ragged_rank() > 0) {
+      split_val = ragged_components[i]->splits(0).NumElements() - 1;
     }
     dims_splits_vec(i + 1) = dims_splits_vec(i) + split_val;
   }
@@ -173,8 +174,8 @@ Status NestedStackRaggedTensors(
     int split_index = dims + i;
     int split_size = 1;
     for (int j = 0; j < ragged_components.size(); j++) {
-      if (!ragged_components[j].nested_splits().empty()) {
-        split_size += ragged_components[j].splits(i).NumElements() - 1;
+      if (!ragged_components[j]->nested_splits().empty()) {
+        split_size += ragged_components[j]->splits(i).NumElements() - 1;
       }
     }
     output_ragged->append_splits(
@@ -185,12 +186,12 @@ Status NestedStackRaggedTensors(
     SPLIT_TYPE last_split_value = 0;
     int index = 1;
     for (int j = 0; j < ragged_components.size(); j++) {
-      if (ragged_components[j].nested_splits().empty()) {
+      if (ragged_components[j]->nested_splits().empty()) {
         // Corner case: empty row. e.g [ [[x], [x]], [] ]
         continue;
       }
       auto component_splits_vec =
-          ragged_components[j].splits(i).vec<SPLIT_TYPE>();
+          ragged_components[j]->splits(i).vec<SPLIT_TYPE>();
       for (int k = 1; k < component_splits_vec.size(); k++, index++) {
         splits_vec(index) = component_splits_vec(k) + last_split_value;
       }
@@ -210,34 +211,34 @@ Status NestedStackRaggedTensors(
   if (ragged_components.empty()) {
     component_values_shape = TensorShape({0});
   } else {
-    component_values_shape = ragged_components[0].values().shape();
+    component_values_shape = ragged_components[0]->values().shape();
   }
 
   // Populate values.
   int values_size = component_values_shape.dim_size(0);
   for (int i = 1; i < ragged_components.size(); i++) {
-    if (ragged_components[i].values().dims() != component_values_shape.dims()) {
+    if (ragged_components[i]->values().dims() !=
+        component_values_shape.dims()) {
       return errors::InvalidArgument(
           "Rank of values must match for all "
           "components; values shape at index 0: ",
           component_values_shape.DebugString(), ", values shape at index ", i,
-          ": ", ragged_components[i].values().shape().DebugString());
+          ": ", ragged_components[i]->values().shape().DebugString());
     }
-    values_size += ragged_components[i].values().shape().dim_size(0);
+    values_size += ragged_components[i]->values().shape().dim_size(0);
   }
   component_values_shape.set_dim(0, values_size);
   output_ragged->set_values(
       Tensor(DataTypeToEnum<VALUE_TYPE>::value, component_values_shape));
-  auto output_values_flat =
-      output_ragged->mutable_values()->flat_outer_dims<VALUE_TYPE, 2>();
-  int values_index = 0;
+  auto output_values_flat = output_ragged->mutable_values()->flat<VALUE_TYPE>();
+  int64_t values_index = 0;
 
   TensorShape expected_value_shape = component_values_shape;
   expected_value_shape.RemoveDim(0);
 
   for (int i = 0; i < ragged_components.size(); i++) {
     // Check that the flat_values tensor shape is compatible.
-    TensorShape value_shape = ragged_components[i].values().shape();
+    TensorShape value_shape = ragged_components[i]->values().shape();
     value_shape.RemoveDim(0);
     if (value_shape != expected_value_shape) {
       return errors::InvalidArgument(
@@ -248,18 +249,13 @@ Status NestedStackRaggedTensors(
           "convert output tensors to RaggedTensors.");
     }
 
+    // The values of each component are contiguous in the output, so they are
+    // copied as one block.
     auto component_values_flat =
-        ragged_components[i].values().flat_outer_dims<VALUE_TYPE, 2>();
-    int num_inner_elements = ragged_components[i].values().NumElements();
-    if (ragged_components[i].values().dim_size(0) > 0) {
-      num_inner_elements /= ragged_components[i].values().dim_size(0);
-    }
-    for (int j = 0; j < ragged_components[i].values().dim_size(0);
-         j++, values_index++) {
-      for (int k = 0; k < num_inner_elements; k++) {
-        output_values_flat(values_index, k) = component_values_flat(j, k);
-      }
-    }
+        ragged_components[i]->values().flat<VALUE_TYPE>();
+    std::copy_n(component_values_flat.data(), component_values_flat.size(),
+                output_values_flat.data() + values_index);
+    values_index += component_values_flat.size();
   }
   return OkStatus();
 }
@@ -309,7 +305,7 @@ class RaggedTensorFromVariantOp : public OpKernel {
     // Decode all variants.
     const auto value_dtype = DataTypeToEnum<VALUE_TYPE>::v();
     const auto split_dtype = DataTypeToEnum<SPLIT_TYPE>::v();
-    std::vector<RaggedTensorVariant> decoded_components;
+    std::vector<const RaggedTensorVariant*> decoded_components;
     OP_REQUIRES_OK(context,
                    RaggedComponentsFromVariant(
                        encoded_variant, input_ragged_rank_, output_ragged_rank_,
@@ -317,7 +313,7 @@ class RaggedTensorFromVariantOp : public OpKernel {
 
     // Corner case: input is a scalar.
     if (encoded_variant.dims() == 0) {
-      ReturnRaggedTensor(context, decoded_components[0]);
+      ReturnRaggedTensor(context, *decoded_components[0]);
       return;
     }
 
@@ -12,6 +12,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
+#include <algorithm>
 #include <cstdint>
 #include <utility>
 #include <vector>
@@ -35,6 +36,28 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+// A component shares the buffer of the batched values only if it holds at
+// least this fraction of them. Otherwise a component outliving the others,
+// e.g. in a tf.data pipeline, would keep the whole batch alive.
+constexpr int64_t kMinAliasedFractionInverse = 4;
+
+// Returns rows [start, limit) of `values`. The result shares the buffer of
+// `values` instead of allocating and copying one, if the rows are aligned for
+// Eigen and make up a large part of `values`. Otherwise they are copied.
+template <typename VALUE_TYPE>
+Tensor SliceValues(const Tensor& values, int64_t start, int64_t limit) {
+  Tensor slice = values.Slice(start, limit);
+  if (slice.IsAligned() && slice.TotalBytes() * kMinAliasedFractionInverse >=
+                               values.TotalBytes()) {
+    return slice;
+  }
+  Tensor copy(DataTypeToEnum<VALUE_TYPE>::value, slice.shape());
+  auto slice_flat = slice.unaligned_flat<VALUE_TYPE>();
+  std::copy_n(slice_flat.data(), slice_flat.size(),
+              copy.flat<VALUE_TYPE>().data());
+  return copy;
+}
+
 template <typename VALUE_TYPE>
 Status UnbatchDenseZerothDim(
     const RaggedTensorVariant& batched_ragged,
@@ -46,18 +69,14 @@ Status UnbatchDenseZerothDim(
   }
   auto num_components = values_shape.dim_size(0);
   values_shape.RemoveDim(0);
-  auto num_values = values_shape.num_elements();
 
   ragged_components->resize(num_components);
-  const auto& batched_flat = batched_values.flat<VALUE_TYPE>();
 
   for (auto i = decltype(num_components){}; i < num_components; i++) {
-    (*ragged_components)[i].set_values(
-        Tensor(DataTypeToEnum<VALUE_TYPE>::value, values_shape));
-    auto ragged_component_values_flat =
-        (*ragged_components)[i].mutable_values()->flat<VALUE_TYPE>();
-    for (auto j = decltype(num_values){}; j < num_values; j++) {
-      ragged_component_values_flat(j) = batched_flat(j + i * num_values);
+    Tensor* component_values = (*ragged_components)[i].mutable_values();
+    if (!component_values->CopyFrom(
+            SliceValues<VALUE_TYPE>(batched_values, i, i + 1), values_shape)) {
+      return errors::Internal("Failed to reshape the values of component ", i);
     }
   }
 
@@ -86,29 +105,14 @@ Status UnbatchRaggedZerothDim(
   for (RaggedTensorVariant& ragged_component : *ragged_components) {
     ragged_component.mutable_nested_splits()->reserve(num_splits);
   }
-  const auto& batched_flat = batched_ragged.values().flat<VALUE_TYPE>();
-  auto num_inner_elems = batched_ragged.values().NumElements();
-  if (batched_ragged.values().dim_size(0) > 1) {
-    num_inner_elems /= batched_ragged.values().dim_size(0);
-  }
-  TensorShape values_shape = batched_ragged.values().shape();
+  const Tensor& batched_values = batched_ragged.values();
 
   // Corner case: ragged_rank == 1, e.g. [[1, 2, 3], [4, 5]]
   if (num_splits == 0) {
     for (auto i = decltype(num_components){}; i < num_components; i++) {
-      auto start = batched_splits_top_vec(i);
-      auto limit = batched_splits_top_vec(i + 1);
-      auto num_values = limit - start;
-      values_shape.set_dim(0, num_values);
-      (*ragged_components)[i].set_values(
-          Tensor(DataTypeToEnum<VALUE_TYPE>::value, values_shape));
-      auto ragged_component_values_flat =
-          (*ragged_components)[i].mutable_values()->template flat<VALUE_TYPE>();
-      for (auto j = decltype(num_values * num_inner_elems){};
-           j < num_values * num_inner_elems; j++) {
-        ragged_component_values_flat(j) =
-            batched_flat(j + start * num_inner_elems);
-      }
+      (*ragged_components)[i].set_values(SliceValues<VALUE_TYPE>(
+          batched_values, batched_splits_top_vec(i),
+          batched_splits_top_vec(i + 1)));
     }
     return OkStatus();
   }
@@ -153,17 +157,12 @@ Status UnbatchRaggedZerothDim(
   }
 
   // Unbatch values.
-  int64_t value_index = 0;
+  int64_t value_row = 0;
   for (auto i = decltype(num_components){}; i < num_components; i++) {
     SPLIT_TYPE num_values = ragged_component_values_size[i];
-    values_shape.set_dim(0, num_values);
-    (*ragged_components)[i].set_values(
-        Tensor(DataTypeToEnum<VALUE_TYPE>::value, values_shape));
-    auto ragged_component_values_flat =
-        (*ragged_components)[i].mutable_values()->template flat<VALUE_TYPE>();
-    for (int64_t j = 0; j < num_values * num_inner_elems; j++, value_index++) {
-      ragged_component_values_flat(j) = batched_flat(value_index);
-    }
+    (*ragged_components)[i].set_values(SliceValues<VALUE_TYPE>(
+        batched_values, value_row, value_row + num_values));
+    value_row += num_values;
   }
 
   return OkStatus();
@@ -236,7 +235,7 @@ class RaggedTensorToVariantOp : public OpKernel {
                                             &encoded_vector));
     auto encoded_vector_t = encoded_vector->vec<Variant>();
     for (auto i = decltype(output_size){}; i < output_size; i++) {
-      encoded_vector_t(i) = unbatched_ragged_input[i];
+      encoded_vector_t(i) = std::move(unbatched_ragged_input[i]);
     }
   }
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/ragged_tensor_to_variant_op_test.h"
 
+#include <numeric>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -117,6 +118,49 @@ TEST_F(RaggedTensorToVariantKernelTest, 2DBatchedValuesRankOneInput) {
       *encoded_list(2).get<RaggedTensorVariant>());
 }
 
+TEST_F(RaggedTensorToVariantKernelTest, AlignedRowsShareBatchedValues) {
+  // Rows of 16 ints are 64 bytes, so every row is aligned and the components
+  // can share the buffer of the batched values instead of copying them.
+  const std::vector<int64_t> batched_splits = {0, 1, 3};
+  std::vector<int> batched_values(3 * 16);
+  std::iota(batched_values.begin(), batched_values.end(), 0);
+
+  BuildEncodeRaggedTensorGraph<int, int64_t>(
+      {batched_splits}, TensorShape({3, 16}), batched_values, true);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const auto& encoded_list = GetOutput(0)->vec<Variant>();
+  ASSERT_EQ(encoded_list.size(), 2);
+  const Tensor& batched = *mutable_input(1).tensor;
+  for (int i = 0; i < 2; ++i) {
+    const Tensor& values = encoded_list(i).get<RaggedTensorVariant>()->values();
+    EXPECT_TRUE(values.SharesBufferWith(batched));
+    test::ExpectTensorEqual<int>(
+        batched.Slice(batched_splits[i], batched_splits[i + 1]), values);
+  }
+}
+
+TEST_F(RaggedTensorToVariantKernelTest, SmallRowsDoNotShareBatchedValues) {
+  // Every row is aligned, but holds an eighth of the batched values, which the
+  // components would keep alive if they shared them.
+  const std::vector<int64_t> batched_splits = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<int> batched_values(8 * 16);
+  std::iota(batched_values.begin(), batched_values.end(), 0);
+
+  BuildEncodeRaggedTensorGraph<int, int64_t>(
+      {batched_splits}, TensorShape({8, 16}), batched_values, true);
+  TF_ASSERT_OK(RunOpKernel());
+
+  const auto& encoded_list = GetOutput(0)->vec<Variant>();
+  ASSERT_EQ(encoded_list.size(), 8);
+  const Tensor& batched = *mutable_input(1).tensor;
+  for (int i = 0; i < 8; ++i) {
+    const Tensor& values = encoded_list(i).get<RaggedTensorVariant>()->values();
+    EXPECT_FALSE(values.SharesBufferWith(batched));
+    test::ExpectTensorEqual<int>(batched.Slice(i, i + 1), values);
+  }
+}
+
 TEST_F(RaggedTensorToVariantKernelTest, 2DBatchedValuesRankTwoInput) {
   // ragged_tensor=
   // [ [[[1, 2], [4, 5]]],
@@ -0,0 +1,318 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_BLOCKED_H_
+#define TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_BLOCKED_H_
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <type_traits>
+
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace functor {
+
+// The reducers supported by BlockedReduction, and the Eigen reducer that
+// accumulates each of them. Mean accumulates a sum that is divided at the end.
+template <typename Reducer>
+struct BlockedReducerTraits {
+  static constexpr bool kSupported = false;
+};
+
+template <typename T, typename AccumulatorT, bool kMean>
+struct BlockedReducerTraitsBase {
+  static constexpr bool kSupported =
+      std::is_same<T, float>::value || std::is_same<T, double>::value;
+  static constexpr bool kIsMean = kMean;
+  typedef AccumulatorT Accumulator;
+};
+
+template <typename T>
+struct BlockedReducerTraits<Eigen::internal::SumReducer<T>>
+    : BlockedReducerTraitsBase<T, Eigen::internal::SumReducer<T>, false> {};
+
+template <typename T>
+struct BlockedReducerTraits<MeanReducer<T>>
+    : BlockedReducerTraitsBase<T, Eigen::internal::SumReducer<T>, true> {};
+
+template <typename T>
+struct BlockedReducerTraits<Eigen::internal::ProdReducer<T>>
+    : BlockedReducerTraitsBase<T, Eigen::internal::ProdReducer<T>, false> {};
+
+template <typename T, int NaNPropagation>
+struct BlockedReducerTraits<Eigen::internal::MaxReducer<T, NaNPropagation>>
+    : BlockedReducerTraitsBase<
+          T, Eigen::internal::MaxReducer<T, NaNPropagation>, false> {};
+
+template <typename T, int NaNPropagation>
+struct BlockedReducerTraits<Eigen::internal::MinReducer<T, NaNPropagation>>
+    : BlockedReducerTraitsBase<
+          T, Eigen::internal::MinReducer<T, NaNPropagation>, false> {};
+
+// Reduces a row-major tensor whose dimensions alternate between reduced and
+// kept ones, as simplified by ReductionHelper, without transposing it first.
+//
+// The innermost dimension is always read contiguously and vectorized. If it is
+// kept, each work item accumulates a block of at most 4KiB of an output row
+// over all the reduced indices, so that the accumulators stay in L1 while the
+// input streams through. If it is reduced, each work item reduces the
+// contiguous inner rows that make up one output element. Work items are
+// parallelized over the kept dimensions. When there are too few of them to
+// occupy the threads, the reduced indices are also split into chunks, whose
+// partial results are combined by a second pass.
+//
+// The split only depends on the shape, and every output element accumulates
+// its inputs in the same order with any number of threads, so the results are
+// deterministic.
+template <typename T, typename Reducer>
+class BlockedReduction {
+ public:
+  typedef gtl::InlinedVector<int64_t, 4> Dims;
+
+  // `dims` is the simplified shape of the input, whose first dimension is
+  // reduced iff `reduce_first_axis`.
+  BlockedReduction(const Dims& dims, bool reduce_first_axis) {
+    const int ndims = dims.size();
+    inner_size_ = dims[ndims - 1];
+    inner_kept_ = (ndims % 2 == 1) != reduce_first_axis;
+    int64_t stride = inner_size_;
+    for (int i = ndims - 2; i >= 0; --i) {
+      const bool reduced = (i % 2 == 0) == reduce_first_axis;
+      Dims& sizes = reduced ? row_sizes_ : outer_sizes_;
+      Dims& strides = reduced ? row_strides_ : outer_strides_;
+      sizes.insert(sizes.begin(), dims[i]);
+      strides.insert(strides.begin(), stride);
+      stride *= dims[i];
+    }
+    num_outer_ = 1;
+    for (int64_t size : outer_sizes_) num_outer_ *= size;
+    num_rows_ = 1;
+    for (int64_t size : row_sizes_) num_rows_ *= size;
+    out_size_ = num_outer_ * (inner_kept_ ? inner_size_ : 1);
+    reduced_size_ = num_rows_ * (inner_kept_ ? 1 : inner_size_);
+
+    block_size_ = inner_kept_ ? std::min<int64_t>(inner_size_, kBlockSize)
+                              : inner_size_;
+    num_blocks_ = (inner_size_ + block_size_ - 1) / block_size_;
+    const int64_t num_items = num_outer_ * num_blocks_;
+    int64_t num_chunks = 1;
+    if (num_items < kMinWorkItems) {
+      const int64_t max_chunks =
+          std::max<int64_t>(1, num_rows_ * block_size_ / kMinChunkSize);
+      num_chunks = std::min(max_chunks,
+                            (kMinWorkItems + num_items - 1) / num_items);
+    }
+    chunk_rows_ = (num_rows_ + num_chunks - 1) / num_chunks;
+    num_chunks_ = (num_rows_ + chunk_rows_ - 1) / chunk_rows_;
+  }
+
+  // Whether a reduction with this shape should use this class rather than
+  // Eigen, which is as fast for reductions along the innermost dimension only.
+  static bool Applies(const Dims& dims, bool reduce_first_axis) {
+    if (!BlockedReducerTraits<Reducer>::kSupported) return false;
+    if (dims.size() < 2 || (dims.size() == 2 && !reduce_first_axis)) {
+      return false;
+    }
+    // Short inner rows do not fill a packet.
+    return dims.back() >= kPacketSize;
+  }
+
+  // The number of elements of the scratch buffer that Reduce() needs for its
+  // partial results, or 0 if it needs none.
+  int64_t num_partials() const {
+    return num_chunks_ > 1 ? num_chunks_ * out_size_ : 0;
+  }
+
+  // Reduces `in` into the `out_size` elements of `out`.
+  void Reduce(const Eigen::ThreadPoolDevice& d, const T* in, T* partials,
+              T* out) const {
+    T* results = num_chunks_ > 1 ? partials : out;
+    const int64_t row_size = inner_kept_ ? block_size_ : inner_size_;
+    const Eigen::TensorOpCost cost(
+        chunk_rows_ * row_size * sizeof(T),
+        (inner_kept_ ? block_size_ : 1) * sizeof(T),
+        chunk_rows_ * row_size * Eigen::NumTraits<T>::AddCost / kPacketSize);
+    const int64_t num_items = num_outer_ * num_blocks_;
+    d.parallelFor(num_chunks_ * num_items, cost,
+                  [&](Eigen::Index first, Eigen::Index last) {
+                    for (Eigen::Index i = first; i < last; ++i) {
+                      const int64_t chunk = i / num_items;
+                      const int64_t outer = (i % num_items) / num_blocks_;
+                      const int64_t block = i % num_blocks_;
+                      T* chunk_results = results + chunk * out_size_;
+                      if (inner_kept_) {
+                        ReduceBlock(in, chunk, outer, block, chunk_results);
+                      } else {
+                        ReduceRows(in, chunk, outer, chunk_results);
+                      }
+                    }
+                  });
+    if (num_chunks_ == 1 && !BlockedReducerTraits<Reducer>::kIsMean) return;
+
+    // Combine the partial results of the chunks in order.
+    const Eigen::TensorOpCost combine_cost(num_chunks_ * sizeof(T), sizeof(T),
+                                           num_chunks_);
+    d.parallelFor(out_size_, combine_cost,
+                  [&](Eigen::Index first, Eigen::Index last) {
+                    for (Eigen::Index i = first; i < last; ++i) {
+                      T result = results[i];
+                      for (int64_t chunk = 1; chunk < num_chunks_; ++chunk) {
+                        accumulator_.reduce(results[chunk * out_size_ + i],
+                                            &result);
+                      }
+                      if (BlockedReducerTraits<Reducer>::kIsMean) {
+                        result /= static_cast<T>(reduced_size_);
+                      }
+                      out[i] = result;
+                    }
+                  });
+  }
+
+ private:
+  typedef typename BlockedReducerTraits<Reducer>::Accumulator Accumulator;
+  typedef typename Eigen::internal::packet_traits<T>::type Packet;
+  static constexpr int kPacketSize = Eigen::internal::packet_traits<T>::size;
+
+  // The largest slice of an output row that a work item accumulates.
+  static constexpr int64_t kBlockSize = 4096 / sizeof(T);
+  // Below this many work items, the reduced indices are split into chunks...
+  static constexpr int64_t kMinWorkItems = 64;
+  // ... of at least this many input elements.
+  static constexpr int64_t kMinChunkSize = 32768;
+
+  // Walks the offsets of the elements of a row-major index space.
+  class OffsetIterator {
+   public:
+    OffsetIterator(const Dims& sizes, const Dims& strides, int64_t start)
+        : sizes_(sizes), strides_(strides), index_(sizes.size()) {
+      for (int i = sizes.size() - 1; i >= 0; --i) {
+        index_[i] = start % sizes[i];
+        start /= sizes[i];
+        offset_ += index_[i] * strides[i];
+      }
+    }
+
+    int64_t offset() const { return offset_; }
+
+    void Next() {
+      for (int i = sizes_.size() - 1; i >= 0; --i) {
+        offset_ += strides_[i];
+        if (++index_[i] < sizes_[i]) return;
+        offset_ -= index_[i] * strides_[i];
+        index_[i] = 0;
+      }
+    }
+
+   private:
+    const Dims& sizes_;
+    const Dims& strides_;
+    Dims index_;
+    int64_t offset_ = 0;
+  };
+
+  int64_t OuterOffset(int64_t outer) const {
+    return OffsetIterator(outer_sizes_, outer_strides_, outer).offset();
+  }
+
+  // Accumulates block `block` of output row `outer` over the rows of `chunk`.
+  void ReduceBlock(const T* in, int64_t chunk, int64_t outer, int64_t block,
+                   T* results) const {
+    const int64_t begin = chunk * chunk_rows_;
+    const int64_t end = std::min(num_rows_, begin + chunk_rows_);
+    const int64_t offset = block * block_size_;
+    const int64_t size = std::min(block_size_, inner_size_ - offset);
+    const T* base = in + OuterOffset(outer) + offset;
+    T* acc = results + outer * inner_size_ + offset;
+
+    OffsetIterator rows(row_sizes_, row_strides_, begin);
+    std::copy_n(base + rows.offset(), size, acc);
+    for (int64_t row = begin + 1; row < end; ++row) {
+      rows.Next();
+      const T* src = base + rows.offset();
+      int64_t j = 0;
+      for (; j + kPacketSize <= size; j += kPacketSize) {
+        Packet p = Eigen::internal::ploadu<Packet>(acc + j);
+        accumulator_.reducePacket(Eigen::internal::ploadu<Packet>(src + j),
+                                  &p);
+        Eigen::internal::pstoreu(acc + j, p);
+      }
+      for (; j < size; ++j) accumulator_.reduce(src[j], acc + j);
+    }
+  }
+
+  // Reduces the contiguous rows of `chunk` into output element `outer`.
+  void ReduceRows(const T* in, int64_t chunk, int64_t outer,
+                  T* results) const {
+    const int64_t begin = chunk * chunk_rows_;
+    const int64_t end = std::min(num_rows_, begin + chunk_rows_);
+    const T* base = in + OuterOffset(outer);
+
+    // Independent accumulators hide the latency of the reduction.
+    Packet acc[4];
+    for (Packet& p : acc) {
+      p = accumulator_.template initializePacket<Packet>();
+    }
+    T scalar_acc = accumulator_.initialize();
+    OffsetIterator rows(row_sizes_, row_strides_, begin);
+    for (int64_t row = begin; row < end; ++row, rows.Next()) {
+      const T* src = base + rows.offset();
+      int64_t j = 0;
+      for (; j + 4 * kPacketSize <= inner_size_; j += 4 * kPacketSize) {
+        for (int k = 0; k < 4; ++k) {
+          accumulator_.reducePacket(
+              Eigen::internal::ploadu<Packet>(src + j + k * kPacketSize),
+              &acc[k]);
+        }
+      }
+      for (; j + kPacketSize <= inner_size_; j += kPacketSize) {
+        accumulator_.reducePacket(Eigen::internal::ploadu<Packet>(src + j),
+                                  &acc[0]);
+      }
+      for (; j < inner_size_; ++j) accumulator_.reduce(src[j], &scalar_acc);
+    }
+    for (int k = 1; k < 4; ++k) accumulator_.reducePacket(acc[k], &acc[0]);
+    results[outer] = accumulator_.finalizeBoth(scalar_acc, acc[0]);
+  }
+
+  Accumulator accumulator_;
+
+  // The kept dimensions other than a kept innermost one.
+  Dims outer_sizes_;
+  Dims outer_strides_;
+  // The reduced dimensions other than a reduced innermost one.
+  Dims row_sizes_;
+  Dims row_strides_;
+  int64_t inner_size_;
+  bool inner_kept_;
+
+  int64_t num_outer_;
+  int64_t num_rows_;
+  int64_t out_size_;
+  int64_t reduced_size_;
+  int64_t block_size_;
+  int64_t num_blocks_;
+  int64_t chunk_rows_;
+  int64_t num_chunks_;
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_REDUCTION_OPS_BLOCKED_H_
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/reduction_ops.h"
+#include "tensorflow/core/kernels/reduction_ops_blocked.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -193,6 +194,10 @@ class ReductionOp : public OpKernel {
         // 3)), [0]). Eigen sometimes crashes in this case, so we do it
         // manually.
         Functor::FillIdentity(d, tmp_out.flat<T>(), reducer);
+      } else if (UseBlockedReduction(helper)) {
+        // Reduce along outer or middle dimensions without transposing.
+        OP_REQUIRES_OK(ctx,
+                       BlockedReduce(ctx, helper, data, alloc_attr, &tmp_out));
       } else if ((helper.ndims() == 1) && helper.reduce_first_axis()) {
         // Reduce to a scalar.
         Functor::Reduce(ctx, helper.out<T, 0>(&tmp_out), helper.in<T, 1>(data),
@@ -221,9 +226,11 @@ class ReductionOp : public OpKernel {
         OP_REQUIRES(ctx, data_reshaped.CopyFrom(data, helper.data_reshape()),
                     errors::Internal("Error during reduction copy."));
         Tensor shuffled;
+        AllocatorAttributes shuffled_attr = alloc_attr;
+        shuffled_attr.set_scratch(true);
         OP_REQUIRES_OK(ctx, ctx->allocate_temp(DataTypeToEnum<T>::value,
                                                helper.shuffled_shape(),
-                                               &shuffled, alloc_attr));
+                                               &shuffled, shuffled_attr));
         OP_REQUIRES_OK(ctx, DoTranspose(d, data_reshaped, helper.permutation(),
                                         &shuffled));
         const int64_t unreduced = tmp_out.NumElements();
@@ -245,6 +252,42 @@ class ReductionOp : public OpKernel {
   }
 
  private:
+  static constexpr bool kBlockedReduction =
+      std::is_same<Device, CPUDevice>::value &&
+      functor::BlockedReducerTraits<Reducer>::kSupported;
+
+  // True if functor::BlockedReduction is faster than Eigen for the reduction.
+  static bool UseBlockedReduction(const ReductionHelper& helper) {
+    if constexpr (kBlockedReduction) {
+      return functor::BlockedReduction<T, Reducer>::Applies(
+          helper.data_reshape().dim_sizes(), helper.reduce_first_axis());
+    }
+    return false;
+  }
+
+  Status BlockedReduce(OpKernelContext* ctx, const ReductionHelper& helper,
+                       const Tensor& data, const AllocatorAttributes& attr,
+                       Tensor* out) {
+    if constexpr (kBlockedReduction) {
+      functor::BlockedReduction<T, Reducer> reduction(
+          helper.data_reshape().dim_sizes(), helper.reduce_first_axis());
+      Tensor partials;
+      T* partials_data = nullptr;
+      if (reduction.num_partials() > 0) {
+        AllocatorAttributes partials_attr = attr;
+        partials_attr.set_scratch(true);
+        TF_RETURN_IF_ERROR(ctx->allocate_temp(
+            DataTypeToEnum<T>::value, TensorShape({reduction.num_partials()}),
+            &partials, partials_attr));
+        partials_data = partials.flat<T>().data();
+      }
+      reduction.Reduce(ctx->eigen_device<CPUDevice>(), data.flat<T>().data(),
+                       partials_data, out->flat<T>().data());
+      return OkStatus();
+    }
+    return errors::Internal("Blocked reduction is not supported.");
+  }
+
   // True if the number of dimensions should be maintained.
   bool keep_dims_;
 };
@@ -81,6 +81,19 @@ static Graph* ThreeDXZReduce(const string& reduce, int num_y, int num_z) {
   return g;
 }
 
+// Creates a Graph which reduces a [n, c, h, w] float tensor along "axes".
+static Graph* FourDReduce(const string& reduce, int n, int c, int h, int w,
+                          const std::vector<int32>& axes) {
+  auto* g = new Graph(OpRegistry::Global());
+  Tensor data(DT_FLOAT, TensorShape({n, c, h, w}));
+  data.flat<float>().setRandom();
+  Tensor axes_t(DT_INT32, TensorShape({static_cast<int64_t>(axes.size())}));
+  for (int i = 0; i < axes.size(); ++i) axes_t.flat<int32>()(i) = axes[i];
+  test::graph::Reduce(g, reduce, test::graph::Constant(g, data),
+                      test::graph::Constant(g, axes_t));
+  return g;
+}
+
 // Creates a bench which reduces a 3D tensor with total "num" floats
 // into a scalar on a "device". Runs the bench for "iters" times.
 template <typename T>
@@ -248,4 +261,53 @@ static void BM_Bool2DToScalarGPU(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+static void Do4DReduce(::testing::benchmark::State& state,
+                       const string& device, const string& reduce,
+                       const std::vector<int32>& axes) {
+  const int n = state.range(0);
+  const int c = state.range(1);
+  const int h = state.range(2);
+  const int w = state.range(3);
+  test::Benchmark(device, FourDReduce(reduce, n, c, h, w, axes),
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * n * c *
+                          h * w);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * n * c *
+                          h * w * sizeof(float));
+}
+
+// Batch norm statistics of NCHW and NHWC activations.
+static void BM_Sum4DNCHWStatsCPU(::testing::benchmark::State& state) {
+  Do4DReduce(state, "cpu", "Sum", {0, 2, 3});
+}
+BENCHMARK(BM_Sum4DNCHWStatsCPU)
+    ->Args({32, 64, 56, 56})
+    ->Args({32, 256, 14, 14});
+
+static void BM_Sum4DNHWCStatsCPU(::testing::benchmark::State& state) {
+  Do4DReduce(state, "cpu", "Sum", {0, 1, 2});
+}
+BENCHMARK(BM_Sum4DNHWCStatsCPU)
+    ->Args({32, 56, 56, 64})
+    ->Args({32, 14, 14, 256});
+
+// Reductions along the outer and a middle dimension.
+static void BM_Sum4DOuterMiddleCPU(::testing::benchmark::State& state) {
+  Do4DReduce(state, "cpu", "Sum", {0, 2});
+}
+BENCHMARK(BM_Sum4DOuterMiddleCPU)
+    ->Args({32, 64, 56, 56})
+    ->Args({8, 3, 512, 512});
+
+static void BM_Mean4DOuterMiddleCPU(::testing::benchmark::State& state) {
+  Do4DReduce(state, "cpu", "Mean", {0, 2});
+}
+BENCHMARK(BM_Mean4DOuterMiddleCPU)->Args({32, 64, 56, 56});
+
+static void BM_Max4DOuterMiddleCPU(::testing::benchmark::State& state) {
+  Do4DReduce(state, "cpu", "Max", {0, 2});
+}
+BENCHMARK(BM_Max4DOuterMiddleCPU)->Args({32, 64, 56, 56});
+
 }  // end namespace tensorflow
@@ -146,7 +146,7 @@ Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
 void ReadVariableOp::Compute(OpKernelContext* ctx) {
   core::RefCountPtr<Var> variable;
   const ResourceHandle& handle = HandleFromInput(ctx, 0);
-  const auto status = LookupResource(ctx, handle, &variable);
+  const auto status = variable_cache_.Lookup(ctx, handle, &variable);
   OP_REQUIRES(ctx, status.ok(),
               errors::FailedPrecondition(
                   "Could not find variable ", handle.name(), ". ",
@@ -426,7 +426,7 @@ class AssignVariableOp : public OpKernel {
     // esoteric cases where the same tensor is used to initialize multiple
     // variables or the tensor is a constant this is safe, as future writes will
     // trigger copies).
-    OP_REQUIRES_OK(context, LookupOrCreateResource<Var>(
+    OP_REQUIRES_OK(context, variable_cache_.LookupOrCreate(
                                 context, HandleFromInput(context, 0), &variable,
                                 [this, &value](Var** ptr) {
                                   *ptr = new Var(dtype_);
@@ -475,12 +475,16 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    if (DirtyRows* dirty_rows = variable->dirty_rows()) {
+      dirty_rows->RecordAll();
+    }
   }
 
  private:
   DataType dtype_;
   bool relax_constraints_;
   bool validate_shape_ = false;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 template <typename Device>
@@ -529,6 +533,9 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
                     DataTypeString(variable->tensor()->dtype()), " got ",
                     DataTypeString(DT_VARIANT)));
     variable->is_initialized = true;
+    if (DirtyRows* dirty_rows = variable->dirty_rows()) {
+      dirty_rows->RecordAll();
+    }
     *variable->tensor() = Tensor(DT_VARIANT, value.shape());
 
     if (input_alias) {
@@ -627,6 +634,9 @@ class AssignUpdateVariableOp : public OpKernel {
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
+    if (DirtyRows* dirty_rows = variable->dirty_rows()) {
+      dirty_rows->RecordAll();
+    }
   }
 };
 
@@ -1049,7 +1059,10 @@ template <typename Device, typename T, typename Index, scatter_op::UpdateOp op>
 Status DoScatter(OpKernelContext* c, Tensor* params, const Tensor& indices,
                  const Tensor& updates, Index num_indices) {
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  // ADD and SUB have a deterministic GPU implementation; the other ops fall
+  // back to the CPU when determinism is required.
   if (std::is_same<Device, GPUDevice>::value &&
+      !scatter_op::HasDeterministicGpuImpl(op) &&
       tensorflow::OpDeterminismRequired() && !DisableScatterOpDeterminism()) {
     return DoScatterOnCpu<T, Index, op>(c, params, indices, updates,
                                         num_indices);
@@ -1183,6 +1196,14 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (N > 0) {
       OP_REQUIRES_OK(
           c, DoScatter<Device, T, Index, op>(c, params, indices, updates, N));
+      if (DirtyRows* dirty_rows = v->dirty_rows()) {
+        // The indices of the kernels of other devices are in device memory.
+        if (isCPUDevice<Device>()) {
+          dirty_rows->Record(indices.flat<Index>().data(), N);
+        } else {
+          dirty_rows->RecordAll();
+        }
+      }
     }
   }
 };
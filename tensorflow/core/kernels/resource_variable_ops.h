@@ -47,6 +47,7 @@ class ReadVariableOp : public OpKernel {
 
  private:
   DataType dtype_;
+  ResourceLookupCache<Var> variable_cache_;
 };
 
 class ReadVariablesOp : public OpKernel {
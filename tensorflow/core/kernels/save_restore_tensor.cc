@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/shared_tensor_store.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/threadpool.h"
@@ -33,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -301,7 +304,13 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && MmapCheckpointTensors()) {
+      // Map the full tensor.
+      Tensor mapped;
+      TF_RETURN_IF_ERROR(reader->LookupMapped(tensor_name, &mapped));
+      context->set_output(idx, std::move(mapped));
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -344,6 +353,10 @@ struct RestoreOp {
                 << restored_tensor->NumElements();
       }
     }
+    if (SharedTensorStore::Enabled()) {
+      // Sessions restoring the same checkpoint share the restored values.
+      *restored_tensor = SharedTensorStore::Global()->Intern(*restored_tensor);
+    }
     VLOG(1) << "Done restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     return OkStatus();
@@ -447,4 +460,24 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   return OkStatus();
 }
 
+bool MmapCheckpointTensors() {
+  static const bool mmap = [] {
+    bool mmap;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_MMAP_CHECKPOINT_TENSORS",
+                                   /*default_val=*/false, &mmap));
+    return mmap;
+  }();
+  return mmap;
+}
+
+int CheckpointNumDataFiles() {
+  static const int num_data_files = [] {
+    int64_t num_data_files;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_CHECKPOINT_NUM_DATA_FILES",
+                                    /*default_val=*/1, &num_data_files));
+    return static_cast<int>(std::max<int64_t>(num_data_files, 1));
+  }();
+  return num_data_files;
+}
+
 }  // namespace tensorflow
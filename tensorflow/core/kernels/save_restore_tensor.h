@@ -68,6 +68,17 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& shape_and_slices,
                         gtl::ArraySlice<DataType> dtypes);
 
+// Whether V2 checkpoints are saved with their tensor data aligned, and whole
+// tensors are restored by memory-mapping it instead of copying it (see
+// BundleReader::LookupMapped()). Set by the environment variable
+// TF_MMAP_CHECKPOINT_TENSORS.
+bool MmapCheckpointTensors();
+
+// The number of data files SaveV2 spreads each checkpoint shard over, writing
+// them concurrently (see BundleWriter::Options::num_data_files). Set by the
+// environment variable TF_CHECKPOINT_NUM_DATA_FILES, 1 by default.
+int CheckpointNumDataFiles();
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_SAVE_RESTORE_TENSOR_H_
@@ -111,7 +111,14 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    BundleWriter::Options writer_options;
+    if (MmapCheckpointTensors()) {
+      // Aligned tensors can be restored by mapping the data files.
+      writer_options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    }
+    // The inputs outlive writer.Finish(), so they need not be snapshotted.
+    writer_options.num_data_files = CheckpointNumDataFiles();
+    BundleWriter writer(Env::Default(), prefix_string, writer_options);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
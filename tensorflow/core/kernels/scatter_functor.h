@@ -39,6 +39,13 @@ namespace scatter_op {
 
 enum class UpdateOp { ASSIGN, ADD, SUB, MUL, DIV, MIN, MAX };
 
+// Returns true if the GPU implementation of `op` has a deterministic path that
+// it takes when op determinism is required: ADD and SUB sort the indices and
+// sum the updates of each index in a fixed order instead of using atomics.
+constexpr bool HasDeterministicGpuImpl(UpdateOp op) {
+  return op == UpdateOp::ADD || op == UpdateOp::SUB;
+}
+
 namespace internal {
 
 template <scatter_op::UpdateOp Op>
@@ -20,8 +20,14 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <limits>
+
 #include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/gpu_prim_helpers.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/kernels/scatter_nd_util.h"
+#include "tensorflow/core/kernels/segment_reduction_ops.h"
+#include "tensorflow/core/kernels/segment_reduction_ops_gpu.cu.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
@@ -124,6 +130,58 @@ __global__ void ScatterScalarOpCustomKernel(T* __restrict__ params,
   }
 }
 
+// Flags the sorted positions that start a new run of equal indices, except
+// the first position, so that an inclusive sum of the flags numbers the runs
+// from 0.
+template <typename Index>
+__global__ void SortedScatterRunFlagsKernel(
+    const Index* __restrict__ sorted_indices, Index indices_size,
+    Index* __restrict__ run_flags) {
+  GPU_1D_KERNEL_LOOP(i, indices_size) {
+    run_flags[i] =
+        i > 0 && ldg(sorted_indices + i) != ldg(sorted_indices + i - 1) ? 1
+                                                                        : 0;
+  }
+}
+
+// Deterministic version of ScatterOpCustomKernel for ADD and SUB. The indices
+// must be sorted, with `run_ids` numbering their runs of equal indices and row
+// run_ids[i] of `sums` holding the sum of the updates of the run of i. The
+// first position of each run applies its sum to `params`, so each element of
+// `params` is updated by a single thread, without atomics.
+template <typename T, typename Index, scatter_op::UpdateOp op>
+__global__ void SortedScatterApplyKernel(T* __restrict__ params,
+                                         const T* __restrict__ sums,
+                                         const Index* __restrict__ sorted_indices,
+                                         const Index* __restrict__ run_ids,
+                                         Index first_dim_size,
+                                         Index updates_size,
+                                         Index indices_size) {
+  using Treduce = typename ReduceType<functor::Sum, T>::type;
+  const Index update_block = updates_size / indices_size;
+  GPU_1D_KERNEL_LOOP(i, updates_size) {
+    const Index row = i / update_block;
+    const Index param_first_index = ldg(sorted_indices + row);
+    if (row > 0 && ldg(sorted_indices + row - 1) == param_first_index) {
+      // Not the first row of its run.
+      continue;
+    }
+    if (!(param_first_index >= 0 && param_first_index < first_dim_size)) {
+      // Ignore indices that are out of range.
+      continue;
+    }
+    const Index column = i % update_block;
+    const Treduce sum = static_cast<Treduce>(
+        ldg(sums + static_cast<int64>(ldg(run_ids + row)) * update_block +
+            column));
+    const int64 params_i =
+        static_cast<int64>(param_first_index) * update_block + column;
+    const Treduce param = static_cast<Treduce>(params[params_i]);
+    params[params_i] = static_cast<T>(
+        op == scatter_op::UpdateOp::ADD ? param + sum : param - sum);
+  }
+}
+
 }  // namespace scatter_op_gpu
 
 namespace functor {
@@ -140,6 +198,14 @@ struct ScatterFunctor<GPUDevice, T, Index, op> {
     const Index first_dim_size = params.dimension(0);
     const Index indices_size = indices.size();
     const Index updates_size = updates.size();
+    if constexpr (scatter_op::HasDeterministicGpuImpl(op)) {
+      if (OpDeterminismRequired() && !DisableScatterOpDeterminism()) {
+        const Status status =
+            DeterministicScatterSum(c, d, params, updates, indices);
+        if (!status.ok()) c->SetStatus(status);
+        return -1;
+      }
+    }
     GpuLaunchConfig config = GetGpuLaunchConfig(updates_size, d);
     TF_CHECK_OK(GpuLaunchKernel(
         scatter_op_gpu::ScatterOpCustomKernel<T, Index, op>, config.block_count,
@@ -147,6 +213,84 @@ struct ScatterFunctor<GPUDevice, T, Index, op> {
         indices.data(), first_dim_size, updates_size, indices_size));
     return -1;
   }
+
+ private:
+  // Sorts the indices and sums the updates of each run of equal indices with a
+  // segmented reduction, which reduces long runs in parallel and in a fixed
+  // order, and then applies the sums to `params`. The result is independent of
+  // thread scheduling.
+  Status DeterministicScatterSum(OpKernelContext* c, const GPUDevice& d,
+                                 typename TTypes<T>::Matrix params,
+                                 typename TTypes<T>::ConstMatrix updates,
+                                 typename TTypes<Index>::ConstFlat indices) {
+    const Index indices_size = indices.size();
+    const Index updates_size = updates.size();
+    if (updates_size == 0) return OkStatus();
+    if (indices_size > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument(
+          "Deterministic GPU scatter supports at most ",
+          std::numeric_limits<int>::max(), " indices, got ", indices_size);
+    }
+    const Index update_block = updates_size / indices_size;
+    Tensor sorted_indices;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &sorted_indices));
+    Tensor permutation;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &permutation));
+    // All the bits are sorted because the indices may be negative. The sort is
+    // stable, so the updates of each index keep their original order.
+    TF_RETURN_IF_ERROR(GpuRadixSort(
+        c, static_cast<int>(indices_size), indices.data(),
+        sorted_indices.flat<Index>().data(),
+        static_cast<const Index*>(nullptr), permutation.flat<Index>().data()));
+
+    // Numbers the runs of equal indices, which are the segments to reduce.
+    Tensor run_flags;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &run_flags));
+    Tensor run_ids;
+    TF_RETURN_IF_ERROR(c->allocate_temp(DataTypeToEnum<Index>::value,
+                                        TensorShape({indices_size}),
+                                        &run_ids));
+    GpuLaunchConfig config = GetGpuLaunchConfig(indices_size, d);
+    TF_RETURN_IF_ERROR(GpuLaunchKernel(
+        scatter_op_gpu::SortedScatterRunFlagsKernel<Index>,
+        config.block_count, config.thread_per_block, 0, d.stream(),
+        sorted_indices.flat<Index>().data(), indices_size,
+        run_flags.flat<Index>().data()));
+    TF_RETURN_IF_ERROR(GpuInclusivePrefixSum(
+        c, static_cast<int>(indices_size), run_flags.flat<Index>().data(),
+        run_ids.flat<Index>().data()));
+
+    // The number of runs is only known on the device, so the sums are sized
+    // for the worst case of one run per index, like `updates`. The runs are
+    // numbered from zero, and the segments past the last run are empty, so
+    // the segmented reduction only writes zeros to them.
+    Tensor sums;
+    TF_RETURN_IF_ERROR(c->allocate_temp(
+        DataTypeToEnum<T>::value, TensorShape({indices_size, update_block}),
+        &sums));
+    using Treduce = typename ReduceType<functor::Sum, T>::type;
+    using Tweights = typename RealTypeIfComplex<T>::type;
+    TF_RETURN_IF_ERROR(SegmentReduceGPU<Treduce>(
+        c, indices_size, update_block, /*nsegments=*/indices_size,
+        functor::Sum(), T(0), T(0), /*is_mean=*/false, /*is_sqrtn=*/false,
+        updates.data(), run_ids.flat<Index>().data(),
+        /*indices=*/permutation.flat<Index>().data(),
+        /*weights=*/static_cast<Tweights*>(nullptr), sums.flat<T>().data()));
+
+    config = GetGpuLaunchConfig(updates_size, d);
+    return GpuLaunchKernel(
+        scatter_op_gpu::SortedScatterApplyKernel<T, Index, op>,
+        config.block_count, config.thread_per_block, 0, d.stream(),
+        params.data(), sums.flat<T>().data(),
+        sorted_indices.flat<Index>().data(), run_ids.flat<Index>().data(),
+        static_cast<Index>(params.dimension(0)), updates_size, indices_size);
+  }
 };
 
 template <typename T, typename Index, scatter_op::UpdateOp op>
@@ -257,6 +257,7 @@ class ScatterNdUpdateOp : public OpKernel {
       OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
       mutex_lock m(*v->mu());
       DoCompute(c);
+      if (c->status().ok()) RecordUpdatedRows(c->input(1), v.get());
     } else if (use_exclusive_lock_) {
       // If we're here, it means the input type is a ref.
       DCHECK(IsRefType(c->input_dtype(0)));
@@ -272,6 +273,25 @@ class ScatterNdUpdateOp : public OpKernel {
   DataType dtype_;
   bool use_exclusive_lock_;
 
+  // Records the rows of `v` updated by the scatter, if they are tracked: the
+  // first coordinates of `indices` on CPU, all the rows otherwise, as the
+  // indices of the kernels of other devices are in device memory.
+  static void RecordUpdatedRows(const Tensor& indices, Var* v) {
+    DirtyRows* dirty_rows = v->dirty_rows();
+    if (dirty_rows == nullptr) return;
+    if (!std::is_same<Device, CPUDevice>::value || indices.dims() == 0 ||
+        indices.dim_size(indices.dims() - 1) == 0) {
+      dirty_rows->RecordAll();
+      return;
+    }
+    const auto indices_mat = indices.flat_inner_dims<Index>();
+    std::vector<Index> rows(indices_mat.dimension(0));
+    for (int64_t i = 0; i < rows.size(); ++i) {
+      rows[i] = indices_mat(i, 0);
+    }
+    dirty_rows->Record(rows.data(), rows.size());
+  }
+
   void DoCompute(OpKernelContext* c) {
     const Tensor& indices = c->input(1);
     const Tensor& updates = c->input(2);
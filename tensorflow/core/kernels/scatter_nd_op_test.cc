@@ -15,13 +15,16 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -240,6 +243,32 @@ TEST_F(ScatterNdUpdateOpTest, Error_MismatchedIndicesAndUpdateDimensions) {
       << s;
 }
 
+TEST_F(ScatterNdUpdateOpTest, ResourceRecordsDirtyRows) {
+  TF_ASSERT_OK(NodeDefBuilder("myop", "ResourceScatterNdUpdate")
+                   .Input(FakeInput(DT_RESOURCE))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  Var* var = new Var(DT_FLOAT);
+  *var->tensor() = test::AsTensor<float>(
+      {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, TensorShape({5, 3}));
+  var->is_initialized = true;
+  DirtyRows* dirty_rows = var->EnableDirtyRowTracking();
+  EXPECT_FALSE(dirty_rows->Take().has_value());
+  AddResourceInput<Var>("", "var", var);
+  AddInputFromArray<int32>(TensorShape({3, 1}), {4, 1, 4});
+  AddInputFromArray<float>(TensorShape({3, 3}),
+                           {1, 1, 1, 2, 2, 2, 3, 3, 3});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::optional<DirtyRows::RowRanges> ranges = dirty_rows->Take();
+  ASSERT_TRUE(ranges.has_value());
+  EXPECT_EQ(*ranges, DirtyRows::RowRanges({{1, 2}, {4, 5}}));
+}
+
 class ScatterNdUpdateBM : public ScatterNdUpdateOpTest {
  public:
   void TestBody() override {}
@@ -73,7 +73,8 @@ class ScatterUpdateOp : public OpKernel {
   //   in the graph?
   explicit ScatterUpdateOp(OpKernelConstruction* c) : OpKernel(c) {
     OP_REQUIRES_OK(c, c->GetAttr("use_locking", &use_exclusive_lock_));
-    if (std::is_same<Device, GPUDevice>::value) {
+    if (std::is_same<Device, GPUDevice>::value &&
+        !scatter_op::HasDeterministicGpuImpl(op)) {
       OP_REQUIRES(
           c, !OpDeterminismRequired(),
           errors::Unimplemented(
@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -127,42 +128,76 @@ class SegmentReductionOp : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
-    Index start = 0, end = 1;
+    // Each shard reduces the segments that start in its range of entries, so
+    // that shards are split at segment boundaries and every output row is set
+    // by exactly one shard.
+    mutex status_mu;
+    Status status;
+    auto work = [&](int64_t begin, int64_t end) {
+      Status shard_status = ReduceSegments(input_flat, segment_vec, output_rows,
+                                           begin, end, output_flat);
+      if (!shard_status.ok()) {
+        mutex_lock l(status_mu);
+        status.Update(shard_status);
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_indices,
+          /*cost_per_unit=*/num_col, work);
+    OP_REQUIRES_OK(context, status);
+  }
 
-    Index uninitialized_index = 0;  // Index from which the output is not set.
-    Index out_index = internal::SubtleMustCopy(segment_vec(start));
+ private:
+  // Reduces the segments whose first entry is in [begin, end) into
+  // `output_flat`, and sets the rows of the empty segments before each of them
+  // to the default value.
+  static Status ReduceSegments(typename TTypes<T>::ConstMatrix input_flat,
+                               typename TTypes<Index>::ConstVec segment_vec,
+                               Index output_rows, int64_t begin, int64_t end,
+                               typename TTypes<T>::Matrix output_flat) {
+    const int64_t num_indices = segment_vec.size();
+    const int64_t num_col = input_flat.dimension(1);
+    // Moves `i` forward to the first entry of a segment.
+    auto segment_start = [&](int64_t i) {
+      while (i > 0 && i < num_indices &&
+             internal::SubtleMustCopy(segment_vec(i)) ==
+                 internal::SubtleMustCopy(segment_vec(i - 1))) {
+        ++i;
+      }
+      return i;
+    };
+    begin = segment_start(begin);
+    end = segment_start(end);
+    if (begin >= end) return OkStatus();
 
-    // TODO(agarwal): if this loop becomes a bottleneck, consider sharding it
-    // across threads.
+    // Index from which the output is not set.
+    Index uninitialized_index =
+        begin == 0 ? 0 : internal::SubtleMustCopy(segment_vec(begin - 1)) + 1;
+    Eigen::IndexList<Eigen::type2index<0> > dims_to_reduce;
     Eigen::DSizes<Eigen::DenseIndex, 1> out_slice_shape(num_col);
-    while (end <= num_indices) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      Index next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
+    typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
+                             Eigen::Unaligned>
+        OutT;
+    int64_t start = begin;
+    while (start < end) {
+      const Index out_index = internal::SubtleMustCopy(segment_vec(start));
+      int64_t segment_end = start + 1;
+      while (segment_end < end &&
+             internal::SubtleMustCopy(segment_vec(segment_end)) == out_index) {
+        ++segment_end;
+      }
+      // Verify that the segment ids are growing. The boundary at `end` is
+      // checked here too; the other shards check their own segments.
+      if (segment_end < num_indices &&
+          out_index >= internal::SubtleMustCopy(segment_vec(segment_end))) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+      if (!FastBoundsCheck(out_index, output_rows)) {
+        return errors::InvalidArgument(
+            "Segment id ", out_index, " out of range [0, ", output_rows,
+            "), possibly because 'segment_ids' input is not sorted.");
       }
-
-      // Process segment [start, end)
-      const T* in_slice_ptr = &input_flat(start, 0);
-      typedef Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>,
-                               Eigen::Unaligned>
-          OutT;
-
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
 
       // If there is a gap between two indices, we need to set that gap to the
       // default value.
@@ -174,34 +209,29 @@ class SegmentReductionOp : public OpKernel {
         gap_slice.setConstant(T(default_value));
       }
 
-      T* out_slice_ptr = &output_flat(out_index, 0);
-      OutT out_slice(out_slice_ptr, out_slice_shape);
-      // We don't use out_slice.device(context->eigen_device<Device>)
-      // because these pieces of work are likely to be very small and
-      // the context switching overhead dwarfs any benefit we get from
-      // using another thread to do this work.
-      if (start == end - 1) {
+      // Process segment [start, segment_end). The reduction over the rows is
+      // vectorized along the row.
+      const T* in_slice_ptr = &input_flat(start, 0);
+      OutT out_slice(&output_flat(out_index, 0), out_slice_shape);
+      if (start == segment_end - 1) {
         typedef Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>,
                                  Eigen::Unaligned>
             InT;
         InT in_slice(in_slice_ptr, out_slice_shape);
         out_slice = in_slice;
       } else {
-        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(end - start,
+        Eigen::DSizes<Eigen::DenseIndex, 2> in_slice_shape(segment_end - start,
                                                            num_col);
         typedef Eigen::TensorMap<Eigen::Tensor<const T, 2, Eigen::RowMajor>,
                                  Eigen::Unaligned>
             InT;
         InT in_slice(in_slice_ptr, in_slice_shape);
-
         out_slice = in_slice.reduce(dims_to_reduce, Reducer());
       }
-      if (end >= num_indices) break;
-      start = end;
-      ++end;
       uninitialized_index = out_index + 1;
-      out_index = next_index;
+      start = segment_end;
     }
+    return OkStatus();
   }
 };
 
@@ -598,32 +628,82 @@ class SparseSegmentReductionOpBase : public OpKernel {
     }
     auto temp_flat = temp.flat_outer_dims<float>();
 
-    int64_t start = 0, end = 1;
-    // Index from which the output is not initialized.
-    SegmentId uninitialized_index = 0;
-    SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
-      // We initialize next_index to 0 to avoid "warning: 'next_index' may be
-      // used uninitialized in this function" in the Mac build (since the
-      // compiler isn't smart enough to realize the code is safe).
-      SegmentId next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
-        // We have a new segment here.  Verify that the segment ids are growing.
-        OP_REQUIRES(context, out_index < next_index,
-                    errors::InvalidArgument("segment ids are not increasing"));
+    // As in SegmentReductionOp, each shard reduces the segments that start in
+    // its range of indices.
+    mutex status_mu;
+    Status status;
+    auto work = [&](int64_t begin, int64_t end) {
+      Status shard_status =
+          ReduceSegments(input_flat, indices_vec, segment_vec, output_rows,
+                         begin, end, output_flat, temp_flat);
+      if (!shard_status.ok()) {
+        mutex_lock l(status_mu);
+        status.Update(shard_status);
       }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_indices,
+          /*cost_per_unit=*/num_col, work);
+    OP_REQUIRES_OK(context, status);
 
-      OP_REQUIRES(
-          context, FastBoundsCheck(out_index, output_rows),
-          errors::InvalidArgument(
-              "Segment id ", out_index, " out of range [0, ", output_rows,
-              "), possibly because 'segment_ids' input is not sorted."));
+    // Fill the gap at the end with the default value.
+    const SegmentId uninitialized_index = last_segment_id_plus_one;
+    if (uninitialized_index < output_rows) {
+      Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+          output_rows - uninitialized_index, num_col);
+      Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
+          gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+      gap_slice.setConstant(default_value_);
+    }
+  }
+
+ private:
+  // Reduces the segments whose first index is in [begin, end) into
+  // `output_flat`, and sets the rows of the empty segments before each of them
+  // to the default value.
+  Status ReduceSegments(typename TTypes<T>::ConstMatrix input_flat,
+                        typename TTypes<Index>::ConstVec indices_vec,
+                        typename TTypes<SegmentId>::ConstVec segment_vec,
+                        Index output_rows, int64_t begin, int64_t end,
+                        typename TTypes<T>::Matrix output_flat,
+                        typename TTypes<float>::Matrix temp_flat) {
+    const int64_t num_indices = segment_vec.size();
+    const int64_t num_col = input_flat.dimension(1);
+    // Moves `i` forward to the first index of a segment.
+    auto segment_start = [&](int64_t i) {
+      while (i > 0 && i < num_indices &&
+             internal::SubtleMustCopy(segment_vec(i)) ==
+                 internal::SubtleMustCopy(segment_vec(i - 1))) {
+        ++i;
+      }
+      return i;
+    };
+    begin = segment_start(begin);
+    end = segment_start(end);
+    if (begin >= end) return OkStatus();
+
+    // Index from which the output is not initialized.
+    SegmentId uninitialized_index =
+        begin == 0 ? 0 : internal::SubtleMustCopy(segment_vec(begin - 1)) + 1;
+    int64_t start = begin;
+    while (start < end) {
+      const SegmentId out_index = internal::SubtleMustCopy(segment_vec(start));
+      int64_t segment_end = start + 1;
+      while (segment_end < end &&
+             internal::SubtleMustCopy(segment_vec(segment_end)) == out_index) {
+        ++segment_end;
+      }
+      // Verify that the segment ids are growing, including at `end`.
+      if (segment_end < num_indices &&
+          out_index >= internal::SubtleMustCopy(segment_vec(segment_end))) {
+        return errors::InvalidArgument("segment ids are not increasing");
+      }
+      if (!FastBoundsCheck(out_index, output_rows)) {
+        return errors::InvalidArgument(
+            "Segment id ", out_index, " out of range [0, ", output_rows,
+            "), possibly because 'segment_ids' input is not sorted.");
+      }
 
       // If there is a gap between two indices, we need to set that gap to the
       // default value.
@@ -638,31 +718,20 @@ class SparseSegmentReductionOpBase : public OpKernel {
       auto out = output_flat.template chip<0>(out_index);
       auto temp = temp_flat.template chip<0>(out_index);
       const int bad_offset = Reduce<T, Index>(input_flat, indices_vec, start,
-                                              end - start, out, temp);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
+                                              segment_end - start, out, temp);
+      if (bad_offset >= 0) {
+        return errors::InvalidArgument(
+            "Bad: indices[", start + bad_offset,
+            "] == ", indices_vec(start + bad_offset), " out of range [0, ",
+            input_flat.dimension(0), ")");
+      }
 
-      start = end;
-      ++end;
       uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
-    }
-
-    // Fill the gap at the end with the default value.
-    if (uninitialized_index < output_rows) {
-      Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-          output_rows - uninitialized_index, num_col);
-      Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-          gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-      gap_slice.setConstant(default_value_);
+      start = segment_end;
     }
+    return OkStatus();
   }
 
- private:
   const DataType dtidx_;
   template <typename Tin>
   using EnableIfBfloat16OrHalf =
@@ -0,0 +1,353 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Eigen/Core"  // from @eigen_archive
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class Combiner { kSum, kMean, kSqrtn };
+
+// The number of rows ahead of the current one whose data is prefetched.
+constexpr int64_t kPrefetchDistance = 4;
+
+Status ParseCombiner(const std::string& combiner_name, Combiner* combiner) {
+  if (combiner_name == "sum") {
+    *combiner = Combiner::kSum;
+  } else if (combiner_name == "mean") {
+    *combiner = Combiner::kMean;
+  } else if (combiner_name == "sqrtn") {
+    *combiner = Combiner::kSqrtn;
+  } else {
+    return errors::InvalidArgument("Unknown combiner: ", combiner_name);
+  }
+  return OkStatus();
+}
+
+// Validates the inputs of a weighted sparse segment reduction, and computes
+// the offsets of the segments: the entries of segment `s` are
+// [offsets[s], offsets[s + 1]). The number of segments is one more than the
+// last segment id.
+template <typename Index, typename SegmentId>
+Status ComputeSegmentOffsets(const Tensor& data, const Tensor& indices,
+                             const Tensor& segment_ids, const Tensor& weights,
+                             std::vector<int64_t>* offsets) {
+  if (!TensorShapeUtils::IsVectorOrHigher(data.shape())) {
+    return errors::InvalidArgument("data must be at least rank 1, got shape ",
+                                   data.shape().DebugString());
+  }
+  if (!TensorShapeUtils::IsVector(indices.shape()) ||
+      !TensorShapeUtils::IsVector(segment_ids.shape()) ||
+      !TensorShapeUtils::IsVector(weights.shape())) {
+    return errors::InvalidArgument(
+        "indices, segment_ids and weights must be vectors, got shapes ",
+        indices.shape().DebugString(), ", ",
+        segment_ids.shape().DebugString(), " and ",
+        weights.shape().DebugString());
+  }
+  const int64_t num_entries = indices.NumElements();
+  if (segment_ids.NumElements() != num_entries ||
+      weights.NumElements() != num_entries) {
+    return errors::InvalidArgument(
+        "indices, segment_ids and weights must have the same size, got ",
+        num_entries, ", ", segment_ids.NumElements(), " and ",
+        weights.NumElements());
+  }
+
+  const auto indices_vec = indices.vec<Index>();
+  const auto segment_vec = segment_ids.vec<SegmentId>();
+  const int64_t num_rows = data.dim_size(0);
+  offsets->assign(1, 0);
+  for (int64_t i = 0; i < num_entries; ++i) {
+    const Index index = internal::SubtleMustCopy(indices_vec(i));
+    if (!FastBoundsCheck(index, num_rows)) {
+      return errors::InvalidArgument("indices[", i, "] = ", index,
+                                     " is not in [0, ", num_rows, ")");
+    }
+    const SegmentId segment_id = internal::SubtleMustCopy(segment_vec(i));
+    if (segment_id < 0) {
+      return errors::InvalidArgument("segment ids must be >= 0");
+    }
+    if (segment_id + 1 < static_cast<int64_t>(offsets->size())) {
+      return errors::InvalidArgument("segment ids are not increasing");
+    }
+    // Close the segments up to and including the empty ones before
+    // `segment_id`.
+    offsets->resize(segment_id + 1, i);
+  }
+  if (num_entries > 0) {
+    offsets->push_back(num_entries);
+  }
+  return OkStatus();
+}
+
+// Returns the factor that the weighted sum of a segment is scaled with:
+// 1 / sum(weights) for "mean", and 1 / sqrt(sum(weights^2)) for "sqrtn". Like
+// `div_no_nan`, the factor is 0 if the divisor is 0.
+template <typename T>
+T NormalizationFactor(Combiner combiner,
+                      typename TTypes<T>::ConstVec weights_vec, int64_t begin,
+                      int64_t end) {
+  if (combiner == Combiner::kSum) {
+    return T(1);
+  }
+  T divisor(0);
+  for (int64_t i = begin; i < end; ++i) {
+    divisor += combiner == Combiner::kMean ? weights_vec(i)
+                                           : weights_vec(i) * weights_vec(i);
+  }
+  if (combiner == Combiner::kSqrtn) {
+    divisor = std::sqrt(divisor);
+  }
+  return divisor == T(0) ? T(0) : T(1) / divisor;
+}
+
+// Runs `work(begin, end)` over ranges of the `num_segments` segments on the
+// CPU worker threads. `num_entries` is the total number of entries, and
+// `num_cols` the size of a row.
+void ShardSegments(OpKernelContext* context, int64_t num_segments,
+                   int64_t num_entries, int64_t num_cols,
+                   const std::function<void(int64_t, int64_t)>& work) {
+  if (num_segments == 0) return;
+  const int64_t cost_per_segment =
+      (num_entries / num_segments + 1) * (num_cols + 10);
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+        cost_per_segment, work);
+}
+
+}  // namespace
+
+// Computes the weighted sums of the gathered rows of each segment in one pass,
+// without materializing the gathered rows. See SparseSegmentWeightedSum in
+// ../ops/math_ops.cc.
+template <typename T, typename Index, typename SegmentId>
+class SparseSegmentWeightedSumOp : public OpKernel {
+ public:
+  explicit SparseSegmentWeightedSumOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(context, ParseCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& data = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& segment_ids = context->input(2);
+    const Tensor& weights = context->input(3);
+
+    std::vector<int64_t> offsets;
+    OP_REQUIRES_OK(context,
+                   (ComputeSegmentOffsets<Index, SegmentId>(
+                       data, indices, segment_ids, weights, &offsets)));
+    const int64_t num_segments = offsets.size() - 1;
+
+    TensorShape output_shape = data.shape();
+    OP_REQUIRES_OK(context, output_shape.SetDimWithStatus(0, num_segments));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+
+    const auto data_flat = data.flat_outer_dims<T>();
+    const int64_t num_cols = data_flat.dimension(1);
+    const auto indices_vec = indices.vec<Index>();
+    const auto weights_vec = weights.vec<T>();
+    auto output_flat = output->flat_outer_dims<T>();
+
+    using Row = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+    using ConstRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+    auto work = [&](int64_t segment_begin, int64_t segment_end) {
+      for (int64_t s = segment_begin; s < segment_end; ++s) {
+        Row out(&output_flat(s, 0), num_cols);
+        out.setZero();
+        const int64_t begin = offsets[s];
+        const int64_t end = offsets[s + 1];
+        for (int64_t i = begin; i < end; ++i) {
+          if (i + kPrefetchDistance < end) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                &data_flat(indices_vec(i + kPrefetchDistance), 0));
+          }
+          out += weights_vec(i) *
+                 ConstRow(&data_flat(indices_vec(i), 0), num_cols);
+        }
+        if (combiner_ != Combiner::kSum) {
+          out *= NormalizationFactor<T>(combiner_, weights_vec, begin, end);
+        }
+      }
+    };
+    ShardSegments(context, num_segments, indices.NumElements(), num_cols,
+                  work);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+// Computes the gradients of SparseSegmentWeightedSum with respect to the
+// gathered rows of `data` and to `weights`, in one pass over the segments.
+template <typename T, typename Index, typename SegmentId>
+class SparseSegmentWeightedSumGradOp : public OpKernel {
+ public:
+  explicit SparseSegmentWeightedSumGradOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::string combiner;
+    OP_REQUIRES_OK(context, context->GetAttr("combiner", &combiner));
+    OP_REQUIRES_OK(context, ParseCombiner(combiner, &combiner_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& grad = context->input(0);
+    const Tensor& data = context->input(1);
+    const Tensor& indices = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+    const Tensor& weights = context->input(4);
+    const Tensor& output = context->input(5);
+
+    std::vector<int64_t> offsets;
+    OP_REQUIRES_OK(context,
+                   (ComputeSegmentOffsets<Index, SegmentId>(
+                       data, indices, segment_ids, weights, &offsets)));
+    const int64_t num_segments = offsets.size() - 1;
+    TensorShape output_shape = data.shape();
+    OP_REQUIRES_OK(context, output_shape.SetDimWithStatus(0, num_segments));
+    OP_REQUIRES(context,
+                grad.shape() == output_shape && output.shape() == output_shape,
+                errors::InvalidArgument(
+                    "grad and output must have shape ",
+                    output_shape.DebugString(), ", got ",
+                    grad.shape().DebugString(), " and ",
+                    output.shape().DebugString()));
+
+    const int64_t num_entries = indices.NumElements();
+    TensorShape data_grad_shape = data.shape();
+    OP_REQUIRES_OK(context, data_grad_shape.SetDimWithStatus(0, num_entries));
+    Tensor* data_grad = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, data_grad_shape, &data_grad));
+    Tensor* weights_grad = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(1, weights.shape(),
+                                                     &weights_grad));
+
+    const auto grad_flat = grad.flat_outer_dims<T>();
+    const auto data_flat = data.flat_outer_dims<T>();
+    const int64_t num_cols = data_flat.dimension(1);
+    const auto indices_vec = indices.vec<Index>();
+    const auto weights_vec = weights.vec<T>();
+    const auto output_flat = output.flat_outer_dims<T>();
+    auto data_grad_flat = data_grad->flat_outer_dims<T>();
+    auto weights_grad_vec = weights_grad->vec<T>();
+
+    using Row = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+    using ConstRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+    auto work = [&](int64_t segment_begin, int64_t segment_end) {
+      for (int64_t s = segment_begin; s < segment_end; ++s) {
+        const int64_t begin = offsets[s];
+        const int64_t end = offsets[s + 1];
+        if (begin == end) continue;
+        const ConstRow g(&grad_flat(s, 0), num_cols);
+        const T factor =
+            NormalizationFactor<T>(combiner_, weights_vec, begin, end);
+        // With output = factor * sum(w_i * x_i), the gradient of w_i is
+        // factor * <g, x_i> plus the gradient through the factor, which is
+        // -factor * <g, output> for "mean", and -factor^2 * w_i * <g, output>
+        // for "sqrtn".
+        const T g_dot_output =
+            combiner_ == Combiner::kSum
+                ? T(0)
+                : (g * ConstRow(&output_flat(s, 0), num_cols)).sum();
+        for (int64_t i = begin; i < end; ++i) {
+          if (i + kPrefetchDistance < end) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                &data_flat(indices_vec(i + kPrefetchDistance), 0));
+          }
+          const ConstRow x(&data_flat(indices_vec(i), 0), num_cols);
+          Row(&data_grad_flat(i, 0), num_cols) = (weights_vec(i) * factor) * g;
+          const T g_dot_x = (g * x).sum();
+          switch (combiner_) {
+            case Combiner::kSum:
+              weights_grad_vec(i) = g_dot_x;
+              break;
+            case Combiner::kMean:
+              weights_grad_vec(i) = factor * (g_dot_x - g_dot_output);
+              break;
+            case Combiner::kSqrtn:
+              weights_grad_vec(i) = factor * g_dot_x - factor * factor *
+                                                           weights_vec(i) *
+                                                           g_dot_output;
+              break;
+          }
+        }
+      }
+    };
+    ShardSegments(context, num_segments, num_entries, num_cols, work);
+  }
+
+ private:
+  Combiner combiner_;
+};
+
+#define REGISTER_CPU_KERNELS(type, index_type, segment_ids_type)              \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SparseSegmentWeightedSum")                                        \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      SparseSegmentWeightedSumOp<type, index_type, segment_ids_type>);        \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("SparseSegmentWeightedSumGrad")                                    \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<type>("T")                                          \
+          .TypeConstraint<index_type>("Tidx")                                 \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),                   \
+      SparseSegmentWeightedSumGradOp<type, index_type, segment_ids_type>);
+#define REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, index_type) \
+  REGISTER_CPU_KERNELS(type, index_type, int32)                         \
+  REGISTER_CPU_KERNELS(type, index_type, int64_t)
+#define REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE(type)       \
+  REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int32) \
+  REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE(type, int64_t)
+
+TF_CALL_float(REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE);
+TF_CALL_double(REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE);
+
+#undef REGISTER_CPU_KERNELS_FOR_EACH_INDEX_TYPE
+#undef REGISTER_CPU_KERNELS_FOR_EACH_SEGMENT_ID_TYPE
+#undef REGISTER_CPU_KERNELS
+
+}  // namespace tensorflow
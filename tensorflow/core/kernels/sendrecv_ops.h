@@ -48,6 +48,7 @@ class RecvOp : public AsyncOpKernel {
   string key_prefix_;
   Rendezvous::ParsedKey parsed_key_;
   bool hostmem_sendrecv_;
+  int64_t max_staleness_steps_;
 
   RecvOp(const RecvOp&) = delete;
   void operator=(const RecvOp&) = delete;
@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/sparse/transpose_op.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/prefetch.h"
 #include "tensorflow/core/platform/threadpool.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -154,12 +155,19 @@ class CSRMatMulOp : public OpKernel {
 
 // CPU Kernel to compute sparse-dense matrix multiplication.
 //
-// Uses Eigen SparseMatrix to compute the sparse-dense multiplication between
-// a CSR SparseMatrix `a` and dense Tensor `b`. If intra-op parallelism is
-// available, the implementation parallelizes the computation across each row
-// of the sparse matrix.
+// Computes the sparse-dense multiplication between a CSR SparseMatrix `a` and
+// dense Tensor `b` directly on the CSR arrays, or with Eigen SparseMatrix if
+// `a` is transposed. If intra-op parallelism is available, the implementation
+// parallelizes the computation across each row of the sparse matrix.
 template <typename T>
 class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
+  // The number of output columns accumulated at once by CSRRowPanelMatMul:
+  // four 64-byte vector registers' worth.
+  static constexpr int64_t kBlockCols =
+      std::max<int64_t>(1, 4 * 64 / sizeof(T));
+  // How many nonzeros ahead CSRRowPanelMatMul prefetches the rhs rows.
+  static constexpr int32 kPrefetchDistance = 4;
+
   using SparseMatrix = Eigen::SparseMatrix<T, Eigen::RowMajor>;
   using Matrix =
       Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
@@ -316,31 +324,68 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
           HandleBatchAndRowRange(
               num_lhs_rows, batch_and_row_begin, batch_and_row_end,
               [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
-                const int64_t num_shard_rows = row_end - row_begin;
-
-                // Define an Eigen::SparseMatrix over the row range:
-                // [row_begin, row_end) of the CSR SparseMatrix A.
-                std::vector<int32> row_ptrs;
-                auto sparse_matrix = GetSparseMatrixRef(
-                    lhs, batch_idx, row_begin, num_shard_rows, &row_ptrs);
-
-                // Map the corresponding rows of the rhs.
-                ConstMatrixMap rhs_map(rhs.flat<T>().data() + batch_idx *
-                                                                  num_rhs_rows *
-                                                                  num_rhs_cols,
-                                       num_rhs_rows, num_rhs_cols);
-
-                // Write to the corresponding rows of the output matrix.
-                MatrixMap output_map(
+                // Write the row range [row_begin, row_end) of A times the
+                // corresponding batch of the rhs to the output.
+                CSRRowPanelMatMul(
+                    lhs.row_pointers_vec(batch_idx).data(),
+                    lhs.col_indices_vec(batch_idx).data(),
+                    lhs.values_vec<T>(batch_idx).data(),
+                    rhs.flat<T>().data() +
+                        batch_idx * num_rhs_rows * num_rhs_cols,
+                    num_rhs_cols, row_begin, row_end,
                     output->flat<T>().data() +
                         batch_idx * num_lhs_rows * num_rhs_cols +
-                        row_begin * num_rhs_cols,
-                    num_shard_rows, num_rhs_cols);
-                output_map.noalias() = sparse_matrix * rhs_map;
+                        row_begin * num_rhs_cols);
               });
         });
   }
 
+  // Computes the rows [row_begin, row_end) of the product of a CSR matrix and
+  // a row-major dense matrix `rhs` with `num_cols` columns, and writes them to
+  // `output`, which points to the first of these rows.
+  //
+  // Each output row is a linear combination of the rhs rows selected by the
+  // column indices of the corresponding CSR row. The output columns are
+  // processed in blocks of kBlockCols, small enough for the accumulator to
+  // stay in vector registers while the nonzeros of the row stream by, so
+  // every output element is written exactly once and the rhs rows are read
+  // sequentially in cache lines.
+  static void CSRRowPanelMatMul(const int32* row_ptrs, const int32* col_indices,
+                                const T* values, const T* rhs,
+                                const int64_t num_cols, const int64_t row_begin,
+                                const int64_t row_end, T* output) {
+    using Block = Eigen::Array<T, 1, kBlockCols>;
+    using Row = Eigen::Array<T, 1, Eigen::Dynamic>;
+    for (int64_t row = row_begin; row < row_end; ++row) {
+      const int32 nnz_begin = row_ptrs[row];
+      const int32 nnz_end = row_ptrs[row + 1];
+      T* output_row = output + (row - row_begin) * num_cols;
+      int64_t col = 0;
+      for (; col + kBlockCols <= num_cols; col += kBlockCols) {
+        Block block = Block::Zero();
+        for (int32 k = nnz_begin; k < nnz_end; ++k) {
+          if (k + kPrefetchDistance < nnz_end) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                rhs + col_indices[k + kPrefetchDistance] * num_cols + col);
+          }
+          block += values[k] * Eigen::Map<const Block>(
+                                   rhs + col_indices[k] * num_cols + col);
+        }
+        Eigen::Map<Block>(output_row + col) = block;
+      }
+      if (col < num_cols) {
+        const int64_t width = num_cols - col;
+        Eigen::Map<Row> block(output_row + col, width);
+        block.setZero();
+        for (int32 k = nnz_begin; k < nnz_end; ++k) {
+          block += values[k] * Eigen::Map<const Row>(
+                                   rhs + col_indices[k] * num_cols + col,
+                                   width);
+        }
+      }
+    }
+  }
+
   // Sparse-Dense Matrix Multiplication assuming the CSRSparseMatrix (LHS) is
   // to be transposed before the operation.
   void SparseDenseMatMulWithTransposedLHS(OpKernelContext* ctx,
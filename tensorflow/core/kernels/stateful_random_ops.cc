@@ -141,6 +141,9 @@ Status UpdateVariableAndFill(
       TF_RETURN_IF_ERROR(CheckPhiloxState(*var_tensor, alg_tag_skip));
       TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, StateElementType>(
           ctx, var_tensor, var->copy_on_read_mode.load()));
+      if (DirtyRows* dirty_rows = var->dirty_rows()) {
+        dirty_rows->RecordAll();
+      }
 
       UpdateVariableAndFill_Philox_Arg arg;
       arg.output_size = output_size;
@@ -308,6 +311,9 @@ class RngSkipOp : public OpKernel {
     using T = StateElementType;
     OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, T>(
                             ctx, var_tensor, var->copy_on_read_mode.load()));
+    if (DirtyRows* dirty_rows = var->dirty_rows()) {
+      dirty_rows->RecordAll();
+    }
     if (read_old_value) {
       Tensor* output;
       OP_REQUIRES_OK(
@@ -334,6 +334,9 @@ class StridedSliceAssignOp : public OpKernel {
                        EnsureSparseVariableAccess<Device, T>(context, v.get()));
         mutex_lock ml(*v->mu());
         old_lhs = v->tensor();
+        if (DirtyRows* dirty_rows = v->dirty_rows()) {
+          dirty_rows->RecordAll();
+        }
         OP_REQUIRES(context, old_lhs->dtype() == DataTypeToEnum<T>::value,
                     errors::InvalidArgument(
                         "l-value dtype ", DataTypeString(old_lhs->dtype()),
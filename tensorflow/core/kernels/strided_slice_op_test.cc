@@ -18,7 +18,10 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
@@ -35,6 +38,37 @@ limitations under the License.
 namespace tensorflow {
 namespace {
 
+class ResourceStridedSliceAssignOpTest : public OpsTestBase {};
+
+// The slice is not mapped back to rows, so the whole variable is dirty.
+TEST_F(ResourceStridedSliceAssignOpTest, RecordsAllRowsDirty) {
+  TF_ASSERT_OK(NodeDefBuilder("myop", "ResourceStridedSliceAssign")
+                   .Input(FakeInput(DT_RESOURCE))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_INT32))
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("T", DT_FLOAT)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+
+  Var* var = new Var(DT_FLOAT);
+  *var->tensor() = test::AsTensor<float>({0, 0, 0, 0}, TensorShape({4}));
+  var->is_initialized = true;
+  DirtyRows* dirty_rows = var->EnableDirtyRowTracking();
+  EXPECT_FALSE(dirty_rows->Take().has_value());
+  AddResourceInput<Var>("", "var", var);
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<int32>(TensorShape({1}), {2});
+  AddInputFromArray<int32>(TensorShape({1}), {1});
+  AddInputFromArray<float>(TensorShape({1}), {7});
+  TF_ASSERT_OK(RunOpKernel());
+
+  EXPECT_EQ(dirty_rows->size(), -1);
+  test::ExpectTensorEqual<float>(
+      *var->tensor(), test::AsTensor<float>({0, 7, 0, 0}, TensorShape({4})));
+}
+
 // For the benchmark, we set up two 2-dimensional tensors, each kDim1 x 'dim'
 // in size, and concat them together along "concat_dimension"
 template <typename T>
@@ -22,7 +22,9 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/op_requires.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace text {
@@ -139,49 +141,79 @@ class StringNGramsOp : public tensorflow::OpKernel {
             0, TensorShape({ngrams_splits_data[num_batch_items]}), &ngrams));
     auto ngrams_data = ngrams->flat<tstring>().data();
 
-    for (int i = 0; i < num_batch_items; ++i) {
-      auto data_start = &input_data[splits_vec(i)];
-      int output_start_idx = ngrams_splits_data[i];
-      for (int ngram_width : ngram_widths_) {
-        auto output_start = &ngrams_data[output_start_idx];
-        int length = splits_vec(i + 1) - splits_vec(i);
-        auto ngrams_or = get_num_ngrams(length, ngram_width);
-        OP_REQUIRES_OK(context, ngrams_or.status());
-        int num_ngrams = ngrams_or.value();
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
-        output_start_idx += num_ngrams;
-      }
-      // If we're preserving short sequences, check to see if no sequence was
-      // generated by comparing the current output start idx to the original
-      // one (ngram_splits_data). If no ngrams were generated, then they will
-      // be equal (since we increment output_start_idx by num_ngrams every
-      // time we create a set of ngrams.)
-      if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
-        int data_length = splits_vec(i + 1) - splits_vec(i);
-        // One legitimate reason to not have any ngrams when preserve_short_
-        // is true is if the sequence itself is empty. In that case, move on.
-        if (data_length == 0) {
-          continue;
+    // Create the ngrams of the batch items in parallel; each writes its own
+    // range of the output.
+    mutex mu;
+    Status status;
+    auto create_batch_item_ngrams = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        Status item_status = CreateBatchItemNgrams(
+            input_data, splits_vec, ngrams_splits_data, i, ngrams_data);
+        if (!item_status.ok()) {
+          mutex_lock l(mu);
+          status.Update(item_status);
+          return;
         }
-        // We don't have to worry about dynamic padding sizes here: if padding
-        // was dynamic, every sequence would have had sufficient padding to
-        // generate at least one ngram.
+      }
+    };
+    const int64_t total_ngrams = ngrams_splits_data[num_batch_items];
+    const int64_t cost_per_batch_item =
+        kCostPerNgram * (total_ngrams / std::max(num_batch_items, 1) + 1);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_batch_items, cost_per_batch_item, create_batch_item_ngrams);
+    OP_REQUIRES_OK(context, status);
+  }
 
-        // If reached here, pad_width should be > 0, pad_width_ = -1,
-        // which indicates max(ngram_widths) - 1 cannot be used here since
-        // ngram_width is not known.
-        OP_REQUIRES(
-            context, pad_width_ >= 0,
-            errors::InvalidArgument("Pad width should be >= 0 when "
-                                    "preserve_short_sequences is True and "
-                                    "ngram_widths are not provided, got ",
-                                    pad_width_));
-        int ngram_width = data_length + 2 * pad_width_;
-        auto output_start = &ngrams_data[output_start_idx];
-        int num_ngrams = 1;
-        CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+  // Creates the ngrams of the ith batch item.
+  Status CreateBatchItemNgrams(
+      const tstring* input_data,
+      const typename TTypes<SPLITS_TYPE>::ConstFlat& splits_vec,
+      const SPLITS_TYPE* ngrams_splits_data, const int64_t i,
+      tstring* ngrams_data) const {
+    auto data_start = &input_data[splits_vec(i)];
+    int output_start_idx = ngrams_splits_data[i];
+    for (int ngram_width : ngram_widths_) {
+      auto output_start = &ngrams_data[output_start_idx];
+      int length = splits_vec(i + 1) - splits_vec(i);
+      auto ngrams_or = get_num_ngrams(length, ngram_width);
+      TF_RETURN_IF_ERROR(ngrams_or.status());
+      int num_ngrams = ngrams_or.value();
+      CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
+      output_start_idx += num_ngrams;
+    }
+    // If we're preserving short sequences, check to see if no sequence was
+    // generated by comparing the current output start idx to the original
+    // one (ngram_splits_data). If no ngrams were generated, then they will
+    // be equal (since we increment output_start_idx by num_ngrams every
+    // time we create a set of ngrams.)
+    if (preserve_short_ && output_start_idx == ngrams_splits_data[i]) {
+      int data_length = splits_vec(i + 1) - splits_vec(i);
+      // One legitimate reason to not have any ngrams when preserve_short_
+      // is true is if the sequence itself is empty. In that case, move on.
+      if (data_length == 0) {
+        return OkStatus();
       }
+      // We don't have to worry about dynamic padding sizes here: if padding
+      // was dynamic, every sequence would have had sufficient padding to
+      // generate at least one ngram.
+
+      // If reached here, pad_width should be > 0, pad_width_ = -1,
+      // which indicates max(ngram_widths) - 1 cannot be used here since
+      // ngram_width is not known.
+      if (pad_width_ < 0) {
+        return errors::InvalidArgument(
+            "Pad width should be >= 0 when "
+            "preserve_short_sequences is True and "
+            "ngram_widths are not provided, got ",
+            pad_width_);
+      }
+      int ngram_width = data_length + 2 * pad_width_;
+      auto output_start = &ngrams_data[output_start_idx];
+      int num_ngrams = 1;
+      CreateNgrams(data_start, output_start, num_ngrams, ngram_width);
     }
+    return OkStatus();
   }
 
   void CreateNgrams(const tstring* data, tstring* output, int num_ngrams,
@@ -250,6 +282,9 @@ class StringNGramsOp : public tensorflow::OpKernel {
     }
   }
 
+  // The approximate cost of creating an ngram.
+  static constexpr int64_t kCostPerNgram = 100;
+
   string separator_;
   string left_pad_;
   string right_pad_;
@@ -578,6 +578,39 @@ TEST_F(NgramKernelTest, TestNoTokensNoPad) {
   assert_int64_equal(expected_splits, *GetOutput(1));
 }
 
+TEST_F(NgramKernelTest, TestLargeBatch) {
+  MakeOp("|", {2}, "LP", "RP", -1, false);
+  // Batch item i is "a", "b", ... of length i % 3, so its bigrams are:
+  // 0:
+  // 1: "LP|a", "a|RP"
+  // 2: "LP|a", "a|b", "b|RP"
+  constexpr int kNumBatchItems = 3000;
+  std::vector<tstring> data;
+  std::vector<int64_t> splits({0});
+  std::vector<tstring> expected_values;
+  std::vector<int64_t> expected_splits({0});
+  for (int i = 0; i < kNumBatchItems; ++i) {
+    const int length = i % 3;
+    if (length >= 1) data.push_back("a");
+    if (length >= 2) data.push_back("b");
+    splits.push_back(data.size());
+    if (length == 1) {
+      expected_values.insert(expected_values.end(), {"LP|a", "a|RP"});
+    } else if (length == 2) {
+      expected_values.insert(expected_values.end(), {"LP|a", "a|b", "b|RP"});
+    }
+    expected_splits.push_back(expected_values.size());
+  }
+  AddInputFromArray<tstring>(TensorShape({static_cast<int64_t>(data.size())}),
+                             data);
+  AddInputFromArray<int64_t>(
+      TensorShape({static_cast<int64_t>(splits.size())}), splits);
+  TF_ASSERT_OK(RunOpKernel());
+
+  assert_string_equal(expected_values, *GetOutput(0));
+  assert_int64_equal(expected_splits, *GetOutput(1));
+}
+
 TEST_F(NgramKernelTest, ShapeFn) {
   ShapeInferenceTestOp op("StringNGrams");
   INFER_OK(op, "?;?", "[?];[?]");
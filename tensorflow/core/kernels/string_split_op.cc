@@ -16,6 +16,7 @@ limitations under the License.
 // See docs in ../ops/string_ops.cc.
 
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -139,10 +141,12 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
     }
     return result;
   }
-  auto p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+  // StringPiece::find scans for the first byte of `sep` with memchr, which
+  // is vectorized.
+  auto p = text.find(sep);
   int split = 0;
-  while (p != text.end()) {
-    StringPiece token = text.substr(0, p - text.begin());
+  while (p != StringPiece::npos) {
+    StringPiece token = text.substr(0, p);
     result.push_back(token);
     text.remove_prefix(token.size());
     text.remove_prefix(sep.size());
@@ -151,7 +155,7 @@ std::vector<StringPiece> SplitV2(const tstring& str, StringPiece sep,
       result.push_back(StringPiece(text));
       return result;
     }
-    p = std::search(text.begin(), text.end(), sep.begin(), sep.end());
+    p = text.find(sep);
   }
   result.push_back(text);
   return result;
@@ -263,21 +267,29 @@ class StringSplitV2Op : public OpKernel {
                                         sep_tensor->shape().DebugString()));
     const auto sep_vec = sep_tensor->flat<tstring>();
     StringPiece sep(sep_vec(0));
-    std::vector<StringPiece> tokens;
-    // Guess that we'll be unpacking a handful of tokens per example.
-    static constexpr int kReserveSize = 4;
-    tokens.reserve(batch_size * kReserveSize);
 
+    // Split the examples in parallel; the tokens point into the input.
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    const int64_t cost_per_example =
+        kCostPerByte * (batch_size > 0 ? input_vec(0).size() : 0) +
+        kCostPerExample;
+    std::vector<std::vector<StringPiece>> tokens(batch_size);
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_example, [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              tokens[i] = SplitV2(input_vec(i), sep, maxsplit_);
+            }
+          });
+
+    // The offset of the first token of each example in the outputs.
     int64_t output_size = 0;
     int64_t max_num_entries = 0;
-    std::vector<int64_t> num_indices(batch_size);
+    std::vector<int64_t> output_offsets(batch_size);
     for (int64_t i = 0; i < batch_size; ++i) {
-      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
-      int64_t n_entries = parts.size();
-      num_indices[i] = n_entries;
+      const int64_t n_entries = tokens[i].size();
+      output_offsets[i] = output_size;
       output_size += n_entries;
       max_num_entries = std::max(max_num_entries, n_entries);
-      tokens.insert(tokens.end(), parts.begin(), parts.end());
     }
 
     Tensor* sp_indices_t;
@@ -294,18 +306,26 @@ class StringSplitV2Op : public OpKernel {
     auto sp_shape = sp_shape_t->vec<int64_t>();
     sp_shape(0) = batch_size;
     sp_shape(1) = max_num_entries;
-    size_t c = 0;
-    for (size_t i = 0; i < batch_size; ++i) {
-      for (size_t j = 0; j < num_indices[i]; ++j) {
-        sp_indices(c, 0) = i;
-        sp_indices(c, 1) = j;
-        sp_tokens(c).assign(tokens[c].data(), tokens[c].size());
-        ++c;
-      }
-    }
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_example, [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+              int64_t c = output_offsets[i];
+              for (int64_t j = 0; j < static_cast<int64_t>(tokens[i].size());
+                   ++j, ++c) {
+                sp_indices(c, 0) = i;
+                sp_indices(c, 1) = j;
+                sp_tokens(c).assign(tokens[i][j].data(), tokens[i][j].size());
+              }
+            }
+          });
   }
 
  private:
+  // The approximate cost of splitting an example, in addition to the cost of
+  // scanning its bytes for the separator.
+  static constexpr int64_t kCostPerExample = 100;
+  static constexpr int64_t kCostPerByte = 2;
+
   int maxsplit_;
 };
 
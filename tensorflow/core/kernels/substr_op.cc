@@ -29,8 +29,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/string_util.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -71,61 +73,40 @@ class SubstrOp : public OpKernel {
                      context->allocate_output("output", input_tensor.shape(),
                                               &output_tensor));
       auto output = output_tensor->flat<tstring>();
-      if (is_scalar) {
-        // Perform Op with scalar pos/len
-        const T pos =
-            tensorflow::internal::SubtleMustCopy(pos_tensor.scalar<T>()());
-        const T len =
-            tensorflow::internal::SubtleMustCopy(len_tensor.scalar<T>()());
-        for (size_t i = 0; i < input_tensor.NumElements(); ++i) {
-          StringPiece in(input(i));
-          T byte_pos = pos;
-          T byte_len = len;
-          switch (unit_) {
-            case CharUnit::UTF8_CHAR:
-              OP_REQUIRES(
-                  context, UpdatePosAndLenForUtf8(in, &byte_pos, &byte_len),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string at index ", i));
-              break;
-            case CharUnit::BYTE:
-              byte_pos = AdjustedPosIndex(byte_pos, in);
-              OP_REQUIRES(
-                  context, FastBoundsCheck(byte_pos, in.size() + 1),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string b'", in, "' at index ", i));
-          }
-          StringPiece sub_in = in.substr(byte_pos, byte_len);
-          output(i).assign(sub_in.data(), sub_in.size());
-        }
-      } else {
-        // Perform Op element-wise with tensor pos/len
-        auto pos_flat = pos_tensor.flat<T>();
-        auto len_flat = len_tensor.flat<T>();
-        for (size_t i = 0; i < input_tensor.NumElements(); ++i) {
-          StringPiece in(input(i));
-          const T pos = tensorflow::internal::SubtleMustCopy(pos_flat(i));
-          const T len = tensorflow::internal::SubtleMustCopy(len_flat(i));
-          T byte_pos = pos;
-          T byte_len = len;
-          switch (unit_) {
-            case CharUnit::UTF8_CHAR:
-              OP_REQUIRES(
-                  context, UpdatePosAndLenForUtf8(in, &byte_pos, &byte_len),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string at index ", i));
-              break;
-            case CharUnit::BYTE:
-              byte_pos = AdjustedPosIndex(byte_pos, in);
-              OP_REQUIRES(
-                  context, FastBoundsCheck(byte_pos, in.size() + 1),
-                  errors::InvalidArgument("pos ", pos, " out of range for ",
-                                          "string b'", in, "' at index ", i));
+      auto pos_flat = pos_tensor.flat<T>();
+      auto len_flat = len_tensor.flat<T>();
+      // Compute the substrings in parallel. Report the error of the first
+      // invalid element, as a sequential loop would.
+      const int64_t num_elements = input_tensor.NumElements();
+      mutex mu;
+      int64_t first_error_index = num_elements;
+      Status status;
+      auto compute_substrings = [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          // Perform Op with scalar pos/len, or element-wise with tensor
+          // pos/len.
+          const T pos = tensorflow::internal::SubtleMustCopy(
+              pos_flat(is_scalar ? 0 : i));
+          const T len = tensorflow::internal::SubtleMustCopy(
+              len_flat(is_scalar ? 0 : i));
+          Status element_status = ComputeSubstr(input(i), pos, len, i,
+                                                &output(i));
+          if (!element_status.ok()) {
+            mutex_lock l(mu);
+            if (i < first_error_index) {
+              first_error_index = i;
+              status = element_status;
+            }
+            return;
           }
-          StringPiece sub_in = in.substr(byte_pos, byte_len);
-          output(i).assign(sub_in.data(), sub_in.size());
         }
-      }
+      };
+      auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+      Shard(worker_threads->num_threads, worker_threads->workers, num_elements,
+            unit_ == CharUnit::UTF8_CHAR ? kUtf8CostPerElement
+                                         : kByteCostPerElement,
+            compute_substrings);
+      OP_REQUIRES_OK(context, status);
     } else {
       // Perform op with broadcasting
       // TODO: Use ternary broadcasting for once available in Eigen. Current
@@ -266,6 +247,35 @@ class SubstrOp : public OpKernel {
   }
 
  private:
+  // The approximate cost of computing one substring.
+  static constexpr int64_t kByteCostPerElement = 50;
+  static constexpr int64_t kUtf8CostPerElement = 200;
+
+  // Assigns the substring of `in` at `pos` and `len` to `out`, where `i` is
+  // the index of the element for error messages.
+  Status ComputeSubstr(const StringPiece in, const T pos, const T len,
+                       const int64_t i, tstring* out) const {
+    T byte_pos = pos;
+    T byte_len = len;
+    switch (unit_) {
+      case CharUnit::UTF8_CHAR:
+        if (!UpdatePosAndLenForUtf8(in, &byte_pos, &byte_len)) {
+          return errors::InvalidArgument("pos ", pos, " out of range for ",
+                                         "string at index ", i);
+        }
+        break;
+      case CharUnit::BYTE:
+        byte_pos = AdjustedPosIndex(byte_pos, in);
+        if (!FastBoundsCheck(byte_pos, in.size() + 1)) {
+          return errors::InvalidArgument("pos ", pos, " out of range for ",
+                                         "string b'", in, "' at index ", i);
+        }
+    }
+    StringPiece sub_in = in.substr(byte_pos, byte_len);
+    out->assign(sub_in.data(), sub_in.size());
+    return OkStatus();
+  }
+
   // This adjusts the requested position. Note it does not perform any bound
   // checks.
   static inline T AdjustedPosIndex(const T pos_requested, const StringPiece s) {
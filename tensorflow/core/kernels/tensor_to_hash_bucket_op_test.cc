@@ -0,0 +1,136 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+class TensorToHashBucketOpTest : public OpsTestBase {
+ protected:
+  Status Init(DataType input_type, int64_t num_buckets) {
+    TF_CHECK_OK(NodeDefBuilder("op", "_TensorToHashBucketFast")
+                    .Input(FakeInput(input_type))
+                    .Attr("num_buckets", num_buckets)
+                    .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+// The buckets must match those of StringToHashBucketFast(AsString(input)).
+int64_t ExpectedBucket(int64_t value, int64_t num_buckets) {
+  return Fingerprint64(strings::StrCat(value)) % num_buckets;
+}
+
+TEST_F(TensorToHashBucketOpTest, Int32) {
+  const int64_t num_buckets = 1000;
+  TF_ASSERT_OK(Init(DT_INT32, num_buckets));
+  const std::vector<int32> values = {0, 1, -1, 42, 2147483647, -2147483647 - 1};
+  AddInputFromArray<int32>(TensorShape({6}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT64, TensorShape({6}));
+  for (size_t i = 0; i < values.size(); ++i) {
+    expected.flat<int64_t>()(i) = ExpectedBucket(values[i], num_buckets);
+  }
+  test::ExpectTensorEqual<int64_t>(expected, *GetOutput(0));
+}
+
+TEST_F(TensorToHashBucketOpTest, Int64) {
+  const int64_t num_buckets = 7;
+  TF_ASSERT_OK(Init(DT_INT64, num_buckets));
+  const std::vector<int64_t> values = {-9223372036854775807LL - 1, -10, 10,
+                                       9223372036854775807LL};
+  AddInputFromArray<int64_t>(TensorShape({2, 2}), values);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_INT64, TensorShape({2, 2}));
+  for (size_t i = 0; i < values.size(); ++i) {
+    expected.flat<int64_t>()(i) = ExpectedBucket(values[i], num_buckets);
+  }
+  test::ExpectTensorEqual<int64_t>(expected, *GetOutput(0));
+}
+
+Graph* SetupTensorToHashBucketGraph(const Tensor& input) {
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(NodeBuilder("hash", "_TensorToHashBucketFast")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("num_buckets", 1 << 20)
+                  .Finalize(g, nullptr /* node */));
+  return g;
+}
+
+static void BM_TensorToHashBucket(::testing::benchmark::State& state) {
+  const int num_elements = state.range(0);
+
+  Tensor input(DT_INT64, TensorShape({num_elements}));
+  input.flat<int64_t>().setRandom();
+  Graph* g = SetupTensorToHashBucketGraph(input);
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_elements);
+}
+
+BENCHMARK(BM_TensorToHashBucket)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(256)
+    ->Arg(16 << 10)
+    ->Arg(1 << 20);
+
+Graph* SetupStringToHashBucketFastGraph(const Tensor& input) {
+  Graph* g = new Graph(OpRegistry::Global());
+  TF_CHECK_OK(NodeBuilder("hash", "StringToHashBucketFast")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("num_buckets", 1 << 20)
+                  .Finalize(g, nullptr /* node */));
+  return g;
+}
+
+static void BM_StringToHashBucketFast(::testing::benchmark::State& state) {
+  const int num_elements = state.range(0);
+
+  Tensor input(DT_STRING, TensorShape({num_elements}));
+  auto input_flat = input.flat<tstring>();
+  for (int i = 0; i < num_elements; ++i) {
+    input_flat(i) = strings::StrCat("feature_", i);
+  }
+  Graph* g = SetupStringToHashBucketFastGraph(input);
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_elements);
+}
+
+BENCHMARK(BM_StringToHashBucketFast)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(256)
+    ->Arg(16 << 10)
+    ->Arg(1 << 20);
+
+}  // namespace
+}  // namespace tensorflow
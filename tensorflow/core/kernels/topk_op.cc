@@ -128,6 +128,55 @@ class TopK : public OpKernel {
 };
 
 namespace functor {
+namespace {
+
+// Rows at least twice as long as this are split into chunks that are searched
+// in parallel if there are fewer rows than threads.
+constexpr int64_t kMinColsPerChunk = 1 << 16;
+
+template <typename T>
+bool HasNaN(const T* data, const int64_t size) {
+  return std::any_of(data, data + size,
+                     [](const T v) { return Eigen::numext::isnan(v); });
+}
+
+// Replaces `top_k` by the indices of the k first values of input_data[begin,
+// end) in the order of `comp`, in no particular order.
+//
+// This keeps the candidates that beat the k-th best value seen so far, and
+// shrinks them back to k with std::nth_element after every k new candidates.
+// Most values thus only cost one comparison with that threshold, and the
+// candidates take O(k) memory. Requires that there are no NaNs in the range,
+// and that `comp` orders larger values first and equal values by increasing
+// index, so that only values larger than the threshold can be candidates.
+template <typename T, typename Tidx, typename Comp>
+void SelectTopK(const T* input_data, const Tidx begin, const Tidx end,
+                const int k, const Comp& comp, std::vector<Tidx>* top_k) {
+  top_k->resize(std::min<int64_t>(k, end - begin));
+  std::iota(top_k->begin(), top_k->end(), begin);
+  if (end - begin <= k) return;
+  top_k->reserve(2 * k);
+  auto shrink = [k, &comp, top_k]() {
+    std::nth_element(top_k->begin(), top_k->begin() + (k - 1), top_k->end(),
+                     comp);
+    top_k->resize(k);
+    return (*top_k)[k - 1];
+  };
+  T threshold = input_data[shrink()];
+  for (Tidx c = begin + k; c < end; ++c) {
+    if (input_data[c] > threshold) {
+      top_k->push_back(c);
+      if (top_k->size() == 2 * static_cast<size_t>(k)) {
+        threshold = input_data[shrink()];
+      }
+    }
+  }
+  if (top_k->size() > static_cast<size_t>(k)) {
+    shrink();
+  }
+}
+
+}  // namespace
 
 template <typename T, typename Tidx>
 struct TopKFunctor<CPUDevice, T, Tidx> {
@@ -162,6 +211,7 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     }
 
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
+      std::vector<Tidx> top_k;
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
         const auto stable_comp = [input_data](const int32_t a,
@@ -177,11 +227,6 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
-        // TODO(ebrevdo): For large k < num_cols, instead of using
-        // TopN, it may be faster to create a temporary vector of
-        // values 0..num_cols - 1 and then use std::partial_sort_copy
-        // of this into indices. Choosing the appropriate minimum k or
-        // ratio of k/num_cols will require some experimentation.
         if (k == num_cols) {
           auto* begin = &indices(b, 0);
           auto* end = &indices(b, k);
@@ -204,8 +249,16 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
             }
             run_begin = run_end;
           }
+        } else if (!HasNaN(input_data, num_cols)) {
+          SelectTopK(input_data, Tidx(0), static_cast<Tidx>(num_cols), k,
+                     stable_comp, &top_k);
+          if (sorted) {
+            std::sort(top_k.begin(), top_k.end(), stable_comp);
+          }
+          std::copy(top_k.begin(), top_k.end(), &indices(b, 0));
         } else {
-          // Use the TopN heap object to sort.
+          // NaNs compare neither larger nor smaller than any value, so
+          // SelectTopK cannot skip values. Use the TopN heap object to sort.
           gtl::TopN<Tidx, decltype(stable_comp)> filter(k, stable_comp);
           filter.reserve(num_cols);
           for (Tidx c = 0; c < num_cols; ++c) {
@@ -248,6 +301,64 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
     auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+    // With fewer long rows than threads, also search each row in parallel.
+    if (k < num_cols && num_rows < worker_threads.num_threads &&
+        num_cols >= 2 * kMinColsPerChunk) {
+      const int64_t num_chunks = std::min<int64_t>(
+          worker_threads.num_threads, num_cols / kMinColsPerChunk);
+      const int64_t chunk_size = Eigen::divup(num_cols, num_chunks);
+      std::vector<std::vector<Tidx>> chunk_top_k(num_chunks);
+      std::vector<char> chunk_has_nan(num_chunks);
+      for (int64_t b = 0; b < num_rows; ++b) {
+        const T* input_data = &input(b, 0);
+        const auto stable_comp = [input_data](const Tidx a, const Tidx b) {
+          if (input_data[b] < input_data[a]) {
+            return true;
+          } else if (input_data[b] > input_data[a]) {
+            return false;
+          } else {
+            return a < b;
+          }
+        };
+        auto select_chunks = [&](int64_t start_chunk, int64_t limit_chunk) {
+          for (int64_t i = start_chunk; i < limit_chunk; ++i) {
+            const int64_t begin = i * chunk_size;
+            const int64_t end = std::min(begin + chunk_size, num_cols);
+            chunk_has_nan[i] = HasNaN(input_data + begin, end - begin);
+            if (!chunk_has_nan[i]) {
+              SelectTopK(input_data, static_cast<Tidx>(begin),
+                         static_cast<Tidx>(end), k, stable_comp,
+                         &chunk_top_k[i]);
+            }
+          }
+        };
+        Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+              static_cast<int64_t>(chunk_size * cmp_cost), select_chunks);
+        if (std::find(chunk_has_nan.begin(), chunk_has_nan.end(), 1) !=
+            chunk_has_nan.end()) {
+          SortIndices(b, b + 1);
+          continue;
+        }
+
+        // The top k of the row are the top k of the chunks' top k.
+        std::vector<Tidx> top_k;
+        for (const auto& chunk : chunk_top_k) {
+          top_k.insert(top_k.end(), chunk.begin(), chunk.end());
+        }
+        std::nth_element(top_k.begin(), top_k.begin() + (k - 1), top_k.end(),
+                         stable_comp);
+        top_k.resize(k);
+        if (sorted) {
+          std::sort(top_k.begin(), top_k.end(), stable_comp);
+        }
+        std::copy(top_k.begin(), top_k.end(), &indices(b, 0));
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+      return OkStatus();
+    }
+
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
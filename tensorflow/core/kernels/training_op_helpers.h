@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
 #include <optional>
+#include <type_traits>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -257,15 +258,44 @@ Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
 // reference and resource variables. For reference variables we can just grab
 // the tensor, grabbing the lock if lock_held is False.
 //
+// Records the rows of `var` about to be updated by the kernel of `ctx`, if they
+// are tracked: those of its "indices" input for sparse updates on CPU, all of
+// them otherwise.
+template <typename Device>
+void RecordDirtyRows(OpKernelContext* ctx, Var* var, bool sparse) {
+  DirtyRows* dirty_rows = var->dirty_rows();
+  if (dirty_rows == nullptr) {
+    return;
+  }
+  const Tensor* indices;
+  if (sparse && std::is_same<Device, Eigen::ThreadPoolDevice>::value &&
+      ctx->input("indices", &indices).ok()) {
+    if (indices->dtype() == DT_INT32) {
+      dirty_rows->Record(indices->flat<int32>().data(),
+                         indices->NumElements());
+      return;
+    }
+    if (indices->dtype() == DT_INT64) {
+      dirty_rows->Record(indices->flat<int64_t>().data(),
+                         indices->NumElements());
+      return;
+    }
+  }
+  dirty_rows->RecordAll();
+}
+
 // For resource variables we, if sparse is true, ensure it's in copy-on-read
 // mode, and then, regardless of the value of sparse, ensure its refcount is 1
 // (by potentially copying its contents). In this case lock_held is ignored.
+// The rows of the variable about to be updated are recorded if they are
+// tracked, see `Var::dirty_rows()`.
 template <typename Device, typename T>
 Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
                                   bool lock_held, bool sparse, Tensor* out) {
   if (ctx->input_dtype(input) == DT_RESOURCE) {
     core::RefCountPtr<Var> var;
     TF_RETURN_IF_ERROR(LookupResource(ctx, HandleFromInput(ctx, input), &var));
+    RecordDirtyRows<Device>(ctx, var.get(), sparse);
     if (sparse) {
       TF_RETURN_IF_ERROR(EnsureSparseVariableAccess<Device, T>(ctx, var.get()));
       *out = *var->tensor();
@@ -17,17 +17,26 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <functional>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/cwise_ops.h"
 #include "tensorflow/core/kernels/cwise_ops_common.h"
 #include "tensorflow/core/kernels/relu_op_functor.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 
 namespace tensorflow {
 
 template <typename T>
 class UnaryOpsComposition;  // forward declare kernel
 
+template <typename T>
+class FusedElementwise;  // forward declare kernel
+
 template <typename T>
 struct UnaryOpsCompositionSupport;
 
@@ -55,6 +64,7 @@ struct UnaryOpsCompositionBase {
 
  private:
   friend class UnaryOpsComposition<T>;
+  friend class FusedElementwise<T>;
 
   Status ExportComputeFns(const std::vector<string>& op_names,
                           std::vector<ComputeFn>* fns, int* cost) {
@@ -418,11 +428,360 @@ struct UnaryOpsCompositionSupport<double> : UnaryOpsCompositionBase<double> {
   // clang-format on
 };
 
+// Binary compute functions of the _FusedElementwise kernel.  Each op is also
+// registered under its name prefixed with "Reverse", which takes the running
+// value as its second operand.
+template <typename T>
+struct FusedElementwiseBinarySupport {
+  using InputBuffer = typename TTypes<T>::ConstFlat;
+  using OutputBuffer = typename TTypes<T>::Flat;
+
+  // Combines `in` with the slice `arg` of the same length.
+  using ComputeFn = void (*)(const InputBuffer& in, const InputBuffer& arg,
+                             OutputBuffer* out);
+  // Combines `in` with the constant `arg`.
+  using ScalarComputeFn = void (*)(const InputBuffer& in, T arg,
+                                   OutputBuffer* out);
+
+  struct ComputeFnRegistration {
+    ComputeFn compute_fn;
+    ScalarComputeFn scalar_compute_fn;
+    int cost;
+  };
+
+  FusedElementwiseBinarySupport() {
+    RegisterComputeFns<functor::add<T>>("Add");
+    RegisterComputeFns<functor::add<T>>("AddV2");
+    RegisterComputeFns<functor::sub<T>>("Sub");
+    RegisterComputeFns<functor::mul<T>>("Mul");
+    RegisterComputeFns<functor::div<T>>("RealDiv");
+    RegisterComputeFns<functor::maximum<T>>("Maximum");
+    RegisterComputeFns<functor::minimum<T>>("Minimum");
+    RegisterComputeFns<functor::squared_difference<T>>("SquaredDifference");
+  }
+
+  // Returns the compute functions of `name`, or nullptr if it is not a
+  // supported binary op.
+  const ComputeFnRegistration* Find(const string& name) const {
+    auto it = compute_fns.find(name);
+    return it == compute_fns.end() ? nullptr : &it->second;
+  }
+
+ private:
+  template <typename Functor, bool kReverse>
+  static void Compute(const InputBuffer& in, const InputBuffer& arg,
+                      OutputBuffer* out) {
+    if (kReverse) {
+      *out = arg.binaryExpr(in, typename Functor::func());
+    } else {
+      *out = in.binaryExpr(arg, typename Functor::func());
+    }
+  }
+
+  template <typename Functor, bool kReverse>
+  static void ComputeScalar(const InputBuffer& in, T arg, OutputBuffer* out) {
+    if (kReverse) {
+      *out = in.constant(arg).binaryExpr(in, typename Functor::func());
+    } else {
+      *out = in.binaryExpr(in.constant(arg), typename Functor::func());
+    }
+  }
+
+  template <typename Functor>
+  void RegisterComputeFns(const string& name) {
+    const int cost =
+        Eigen::internal::functor_traits<typename Functor::func>::Cost;
+    compute_fns[name] = {Compute<Functor, false>,
+                         ComputeScalar<Functor, false>, cost};
+    compute_fns[absl::StrCat("Reverse", name)] = {
+        Compute<Functor, true>, ComputeScalar<Functor, true>, cost};
+  }
+
+  std::unordered_map<string, ComputeFnRegistration> compute_fns;
+};
+
+// Common chains of the _FusedElementwise kernel, which are evaluated as one
+// Eigen expression when all args have the shape of the input.  The running
+// value then stays in registers, instead of going through a tile in memory
+// after each op.
+template <typename T>
+struct FusedElementwiseExpressions {
+  using InputBuffer = typename TTypes<T>::ConstFlat;
+  using OutputBuffer = typename TTypes<T>::Flat;
+
+  // Evaluates the chain on `in` and `args`, slices of the same length.
+  using ComputeFn = void (*)(const InputBuffer& in, const InputBuffer* args,
+                             OutputBuffer* out);
+
+  FusedElementwiseExpressions() {
+    // Both operand orders of the commutative ops give the same results.
+    for (const char* mul : {"Mul", "ReverseMul"}) {
+      for (const char* add : {"Add", "AddV2", "ReverseAdd", "ReverseAddV2"}) {
+        Register({mul, add}, MulAdd);
+        Register({mul, add, "Relu"}, MulAddRelu);
+        Register({add, "Relu"}, AddRelu);
+      }
+      Register({"Sigmoid", mul}, SigmoidMul);
+      Register({"Tanh", mul}, TanhMul);
+    }
+  }
+
+  // Returns the expression of the chain `op_names`, or nullptr if there is
+  // none.
+  ComputeFn Find(const std::vector<string>& op_names) const {
+    auto it = compute_fns.find(absl::StrJoin(op_names, ","));
+    return it == compute_fns.end() ? nullptr : it->second;
+  }
+
+ private:
+  static void MulAdd(const InputBuffer& in, const InputBuffer* args,
+                     OutputBuffer* out) {
+    *out = in * args[0] + args[1];
+  }
+
+  static void MulAddRelu(const InputBuffer& in, const InputBuffer* args,
+                         OutputBuffer* out) {
+    *out = (in * args[0] + args[1]).template cwiseMax<Eigen::PropagateNaN>(
+        static_cast<T>(0));
+  }
+
+  static void AddRelu(const InputBuffer& in, const InputBuffer* args,
+                      OutputBuffer* out) {
+    *out = (in + args[0]).template cwiseMax<Eigen::PropagateNaN>(
+        static_cast<T>(0));
+  }
+
+  static void SigmoidMul(const InputBuffer& in, const InputBuffer* args,
+                         OutputBuffer* out) {
+    *out = in.sigmoid() * args[0];
+  }
+
+  static void TanhMul(const InputBuffer& in, const InputBuffer* args,
+                      OutputBuffer* out) {
+    *out = in.tanh() * args[0];
+  }
+
+  void Register(const std::vector<string>& op_names, ComputeFn compute_fn) {
+    compute_fns[absl::StrJoin(op_names, ",")] = compute_fn;
+  }
+
+  std::unordered_map<string, ComputeFn> compute_fns;
+};
+
+// Evaluates a chain of unary and binary element-wise ops in one pass over the
+// data.  The data is processed in tiles that are small enough for the running
+// value to stay in cache between the ops of the chain.
+template <typename T>
+class FusedElementwise : public OpKernel {
+ public:
+  using Scalar = T;
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+
+  using UnarySupport = UnaryOpsCompositionSupport<T>;
+  using BinarySupport = FusedElementwiseBinarySupport<T>;
+
+  using InputBuffer = typename UnarySupport::InputBuffer;
+  using OutputBuffer = typename UnarySupport::OutputBuffer;
+
+  explicit FusedElementwise(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("op_names", &op_names_));
+    OP_REQUIRES(context, !op_names_.empty(),
+                errors::InvalidArgument(
+                    "Fused element-wise op must have at least one op"));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    UnarySupport unary_support;
+    BinarySupport binary_support;
+    int num_binary_ops = 0;
+    for (const string& op_name : op_names_) {
+      Step step;
+      const auto* binary = binary_support.Find(op_name);
+      if (binary != nullptr) {
+        step.binary = *binary;
+        step.arg = num_binary_ops++;
+        cost_ += binary->cost;
+      } else {
+        std::vector<typename UnarySupport::ComputeFn> fns;
+        OP_REQUIRES_OK(context,
+                       unary_support.ExportComputeFns({op_name}, &fns, &cost_));
+        step.unary = fns[0];
+      }
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, num_binary_ops == num_args,
+                errors::InvalidArgument("Fused element-wise op has ",
+                                        num_binary_ops, " binary ops but ",
+                                        num_args, " args"));
+
+    expression_fn_ = FusedElementwiseExpressions<T>().Find(op_names_);
+
+    VLOG(2) << "Fused element-wise op: [" << absl::StrJoin(op_names_, ", ")
+            << "]; cost=" << cost_
+            << (expression_fn_ != nullptr ? "; single expression" : "");
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    OpInputList args;
+    OP_REQUIRES_OK(ctx, ctx->input_list("args", &args));
+
+    const int64_t row_size = in.dims() > 0 ? in.dim_size(in.dims() - 1) : 1;
+    std::vector<Broadcast> broadcasts(args.size());
+    std::vector<const T*> arg_data(args.size());
+    bool args_alias_input = false;
+    int num_full_args = 0;
+    for (int i = 0; i < args.size(); ++i) {
+      const Tensor& arg = args[i];
+      if (arg.shape() == in.shape()) {
+        broadcasts[i] = Broadcast::kNone;
+        ++num_full_args;
+      } else if (arg.NumElements() == 1 && arg.dims() <= in.dims()) {
+        broadcasts[i] = Broadcast::kScalar;
+      } else if (arg.dims() >= 1 && arg.dims() <= in.dims() &&
+                 arg.dim_size(arg.dims() - 1) == row_size &&
+                 arg.NumElements() == row_size) {
+        broadcasts[i] = Broadcast::kRow;
+      } else {
+        ctx->SetStatus(errors::InvalidArgument(
+            "Fused element-wise arg ", i, " of shape ",
+            arg.shape().DebugString(), " can not be broadcast to the shape ",
+            in.shape().DebugString(), " of the input"));
+        return;
+      }
+      arg_data[i] = arg.flat<T>().data();
+      args_alias_input |= arg.SharesBufferWith(in);
+    }
+
+    // The output is written before the args are read, so the input can only be
+    // forwarded if no arg reads its buffer.
+    Tensor* out = nullptr;
+    if (args_alias_input) {
+      OP_REQUIRES_OK(ctx, ctx->allocate_output(0, in.shape(), &out));
+    } else {
+      OP_REQUIRES_OK(ctx, ctx->forward_input_or_allocate_output(
+                              {0}, 0, in.shape(), &out));
+    }
+
+    const T* in_data = in.flat<T>().data();
+    T* out_data = out->flat<T>().data();
+    std::function<void(int64_t, int64_t)> compute_fn;
+    if (expression_fn_ != nullptr && num_full_args == args.size()) {
+      compute_fn = [&](int64_t begin, int64_t end) {
+        const int64_t len = end - begin;
+        gtl::InlinedVector<InputBuffer, 4> arg_slices;
+        for (const T* arg : arg_data) {
+          arg_slices.emplace_back(arg + begin, len);
+        }
+        OutputBuffer out_slice(out_data + begin, len);
+        expression_fn_(InputBuffer(in_data + begin, len), arg_slices.data(),
+                       &out_slice);
+      };
+    } else {
+      compute_fn = [&](int64_t begin, int64_t end) {
+        for (int64_t tile = begin; tile < end; tile += kTileSize) {
+          ComputeTile(in_data, arg_data, broadcasts, row_size, tile,
+                      std::min(end, tile + kTileSize), out_data);
+        }
+      };
+    }
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int kOverheadCycles = static_cast<int>(steps_.size()) * 10;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * (1 + num_full_args),
+                             /*bytes_stored=*/sizeof(T),
+                             kOverheadCycles + cost_);
+    device.parallelFor(in.NumElements(), cost, AlignBlockSize,
+                       std::move(compute_fn));
+  }
+
+ private:
+  // How an arg is broadcast to the shape of the input.
+  enum class Broadcast { kNone, kScalar, kRow };
+
+  struct Step {
+    typename UnarySupport::ComputeFn unary = nullptr;
+    typename BinarySupport::ComputeFnRegistration binary = {};
+    // Index of the arg of a binary op.
+    int arg = -1;
+  };
+
+  static constexpr int kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+
+  // 16KB of values, which fits in the L1 cache of common CPUs.
+  static constexpr int64_t kTileSize = (16 << 10) / sizeof(T);
+
+  static inline int64_t AlignBlockSize(int64_t block_size) {
+    // Align block size to packet size and account for unrolling in run above.
+    if (block_size >= 16 * kPacketSize) {
+      return (block_size + 4 * kPacketSize - 1) & ~(4 * kPacketSize - 1);
+    }
+    // Aligning to 4 * PacketSize would increase block size by more than 25%.
+    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+  }
+
+  // Applies all the steps to the elements in [begin, end).
+  void ComputeTile(const T* in_data, const std::vector<const T*>& arg_data,
+                   const std::vector<Broadcast>& broadcasts, int64_t row_size,
+                   int64_t begin, int64_t end, T* out_data) const {
+    const int64_t len = end - begin;
+    for (int k = 0; k < steps_.size(); ++k) {
+      // The first step reads the input, the others the running value.
+      const T* src = (k == 0 ? in_data : out_data) + begin;
+      const Step& step = steps_[k];
+      if (step.unary != nullptr) {
+        OutputBuffer out_slice(out_data + begin, len);
+        step.unary(InputBuffer(src, len), &out_slice);
+        continue;
+      }
+      const T* arg = arg_data[step.arg];
+      switch (broadcasts[step.arg]) {
+        case Broadcast::kNone: {
+          OutputBuffer out_slice(out_data + begin, len);
+          step.binary.compute_fn(InputBuffer(src, len),
+                                 InputBuffer(arg + begin, len), &out_slice);
+          break;
+        }
+        case Broadcast::kScalar: {
+          OutputBuffer out_slice(out_data + begin, len);
+          step.binary.scalar_compute_fn(InputBuffer(src, len), arg[0],
+                                        &out_slice);
+          break;
+        }
+        case Broadcast::kRow: {
+          // Split the tile at row boundaries, so that each part reads a
+          // contiguous slice of the arg.
+          for (int64_t i = begin; i < end;) {
+            const int64_t col = i % row_size;
+            const int64_t n = std::min(row_size - col, end - i);
+            OutputBuffer out_slice(out_data + i, n);
+            step.binary.compute_fn(InputBuffer(src + (i - begin), n),
+                                   InputBuffer(arg + col, n), &out_slice);
+            i += n;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  std::vector<string> op_names_;
+  std::vector<Step> steps_;
+  int cost_ = 0;
+  // The single-expression form of the chain, if there is one.
+  typename FusedElementwiseExpressions<T>::ComputeFn expression_fn_ = nullptr;
+};
+
 // Register the CPU kernels.
 #define REGISTER_CPU(T)                                                       \
   REGISTER_KERNEL_BUILDER(                                                    \
       Name("_UnaryOpsComposition").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
-      UnaryOpsComposition<T>);
+      UnaryOpsComposition<T>);                                                \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"),    \
+      FusedElementwise<T>);
 
 REGISTER_CPU(float);
 REGISTER_CPU(Eigen::half);
@@ -80,6 +80,89 @@ TEST_F(UnaryOpsCompositionTest, Compose_Tanh_Relu6_F) {
   RunComposedOp<float>({"Relu6"}, 11.0f, 6.0f);
 }
 
+class FusedElementwiseTest : public OpsTestBase {
+ protected:
+  void MakeOp(const std::vector<string>& op_names, int num_args) {
+    TF_ASSERT_OK(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(num_args, DT_FLOAT))
+                     .Attr("T", DT_FLOAT)
+                     .Attr("num_args", num_args)
+                     .Attr("op_names", op_names)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(FusedElementwiseTest, SameShapeArgs) {
+  MakeOp({"Mul", "Relu", "ReverseSub"}, 2);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, -2, 3, -4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 2, 0.5, -1});
+  AddInputFromArray<float>(TensorShape({2, 2}), {10, 20, 30, 40});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {8, 20, 28.5, 36});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseTest, BroadcastArgs) {
+  MakeOp({"AddV2", "Square", "RealDiv"}, 2);
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<float>(TensorShape({3}), {1, 0, -1});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&expected, {0.5, 0.5, 0.5, 8, 8, 8});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseTest, ArgAliasesInput) {
+  MakeOp({"Sigmoid", "ReverseMul"}, 1);
+  AddInputFromArray<float>(TensorShape({3}), {-1, 0, 2});
+  inputs_.push_back(inputs_[0]);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({3}));
+  test::FillValues<float>(&expected, {-1 / (1 + std::exp(1.0f)), 0,
+                                      2 / (1 + std::exp(-2.0f))});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseTest, SingleExpressionChain) {
+  // Mul, AddV2 and Relu with full-shape args are evaluated as one expression.
+  MakeOp({"Mul", "AddV2", "Relu"}, 2);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, -2, 3, -4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 2, 0.5, -1});
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 1, -2, -1});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {3, 0, 0, 3});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseTest, SingleExpressionChainWithBroadcast) {
+  // A broadcast arg falls back to the op-by-op evaluation.
+  MakeOp({"Mul", "AddV2", "Relu"}, 2);
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, -2, 3, -4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 2, 0.5, -1});
+  AddInputFromArray<float>(TensorShape({}), {-2});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {0, 0, 0, 2});
+  test::ExpectClose(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseTest, InvalidBroadcast) {
+  MakeOp({"Add"}, 1);
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 1, 2, 3, 4, 5});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 // Performance benchmarks below.
 
 string Function(int i) {
@@ -184,5 +267,58 @@ BM_UnaryOpsCompo(1000000, 25, 5, cpu);
 BM_UnaryOpsChain(1000000, 25, 10, cpu);
 BM_UnaryOpsCompo(1000000, 25, 10, cpu);
 
+// x * a + b followed by Relu: as separate graph nodes, or fused.
+static Graph* MulAddReluChain(int tensor_size, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+
+  std::vector<Node*> inputs;
+  for (int i = 0; i < 3; ++i) {
+    Tensor t(DT_FLOAT, TensorShape({tensor_size}));
+    t.flat<float>() = t.flat<float>().setRandom();
+    inputs.push_back(test::graph::Constant(g, t));
+  }
+
+  Node* node;
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedElementwise")
+                    .Input(inputs[0])
+                    .Input({inputs[1], inputs[2]})
+                    .Attr("T", DT_FLOAT)
+                    .Attr("num_args", 2)
+                    .Attr("op_names", {"Mul", "AddV2", "Relu"})
+                    .Finalize(g, &node));
+  } else {
+    node = test::graph::Multi(g, "Mul", {inputs[0], inputs[1]});
+    node = test::graph::Multi(g, "AddV2", {node, inputs[2]});
+    node = test::graph::Unary(g, "Relu", node);
+  }
+
+  return g;
+}
+
+// The bytes processed count the 3 inputs and the output once, so that the
+// fused and unfused variants report comparable bandwidths.
+#define BM_MulAddRelu(N, F, type)                                             \
+  static void BM_MulAddRelu##_##type##_##N##_##F(                             \
+      ::testing::benchmark::State& state) {                                   \
+    test::Benchmark(#type, MulAddReluChain(N, F),                             \
+                    /*old_benchmark_api*/ false)                              \
+        .Run(state);                                                          \
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * N * 4 * \
+                            sizeof(float));                                   \
+  }                                                                           \
+  BENCHMARK(BM_MulAddRelu##_##type##_##N##_##F);
+
+// BenchmarkName(tensor_size, fused, type)
+
+BM_MulAddRelu(100000, false, cpu);
+BM_MulAddRelu(100000, true, cpu);
+
+BM_MulAddRelu(1000000, false, cpu);
+BM_MulAddRelu(1000000, true, cpu);
+
+BM_MulAddRelu(10000000, false, cpu);
+BM_MulAddRelu(10000000, true, cpu);
+
 }  // namespace
 }  // end namespace tensorflow
@@ -15,11 +15,13 @@ limitations under the License.
 
 #include <algorithm>
 #include <limits>
+#include <type_traits>
 #include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/math_utils.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/tensor_utils.h"
 #include "tensorflow/core/platform/errors.h"
@@ -446,6 +448,115 @@ void EvalLhsPerBatchAndRhsPerChannelQuantizedConv(
       });
 }
 
+// Returns true if EvalLhsPerBatchQuantizedConvWithVnni() can compute the
+// convolution of transposed `rhs` into transposed `out`.
+bool CanEvalQuantizedConvWithVnni(
+    const Tensor& rhs, const Tensor& out,
+    const UniformQuantizedConvolutionParams& convolution_params) {
+  if (!vnni::IsSupportedAndEnabled() ||
+      convolution_params.feature_group_count() != 1 ||
+      convolution_params.batch_group_count() != 1) {
+    return false;
+  }
+  auto rhs_tensor = rhs.flat_outer_dims<qint8, 3>();
+  auto out_tensor = out.flat_outer_dims<float, 3>();
+  return std::max<int64_t>(
+             {rhs_tensor.dimension(1) * rhs_tensor.dimension(2),
+              out_tensor.dimension(0), out_tensor.dimension(1),
+              out_tensor.dimension(2)}) <= std::numeric_limits<int>::max();
+}
+
+// Quantized Conv on per-batch quantized padded and dilated transposed lhs and
+// per-tensor or per-channel quantized transposed rhs with vnni::QuantizedGemm,
+// with the same result as EvalLhsPerBatchAndRhsPer{Tensor,Channel}QuantizedConv.
+// Each batch of lhs is unfolded into an [input feature * rhs spatial, out
+// spatial] matrix, which is multiplied with rhs. Requires
+// CanEvalQuantizedConvWithVnni().
+Status EvalLhsPerBatchQuantizedConvWithVnni(
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
+    const UniformQuantizedConvolutionParams& convolution_params,
+    const Tensor& lhs_scales, const Tensor& lhs_zero_points,
+    const Tensor& rhs_scales, const Tensor& rhs_zero_points, Tensor& out) {
+  auto lhs_tensor = lhs.flat_outer_dims<qint8, 3>();
+  auto rhs_tensor = rhs.flat_outer_dims<qint8, 3>();
+  auto out_tensor = out.flat_outer_dims<float, 3>();
+  const int batches = out_tensor.dimension(0);
+  const int out_features = out_tensor.dimension(1);
+  const int out_spatial_size = out_tensor.dimension(2);
+  const int rhs_spatial_size = rhs_tensor.dimension(2);
+  const int accum_depth = rhs_tensor.dimension(1) * rhs_spatial_size;
+  const bool is_rhs_per_channel = rhs_scales.dims() != 0;
+  const float* lhs_scales_data = lhs_scales.flat<float>().data();
+  const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
+  const float* rhs_scales_data = rhs_scales.flat<float>().data();
+  const int32_t* rhs_zero_points_data = rhs_zero_points.flat<int32_t>().data();
+
+  std::vector<int32_t> rhs_offsets(out_features);
+  for (int out_feature_idx = 0; out_feature_idx < out_features;
+       ++out_feature_idx) {
+    rhs_offsets[out_feature_idx] =
+        -rhs_zero_points_data[is_rhs_per_channel ? out_feature_idx : 0];
+  }
+  // The lhs spatial index read by each pair of rhs and out spatial indices.
+  std::vector<int64_t> lhs_spatial_idx(static_cast<size_t>(rhs_spatial_size) *
+                                       out_spatial_size);
+  for (int rhs_spatial_idx = 0; rhs_spatial_idx < rhs_spatial_size;
+       ++rhs_spatial_idx) {
+    for (int out_spatial_idx = 0; out_spatial_idx < out_spatial_size;
+         ++out_spatial_idx) {
+      lhs_spatial_idx[static_cast<size_t>(rhs_spatial_idx) * out_spatial_size +
+                      out_spatial_idx] =
+          ConvolutionTransposedLhsSpatialIdx(
+              convolution_params, lhs.shape(), rhs.shape(), out.shape(),
+              rhs_spatial_idx, out_spatial_idx);
+    }
+  }
+
+  Tensor unfolded_lhs;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_QINT8, {accum_depth, out_spatial_size}, &unfolded_lhs));
+  auto unfolded_lhs_tensor = unfolded_lhs.matrix<qint8>();
+  Tensor acc;
+  TF_RETURN_IF_ERROR(context->allocate_temp(
+      DT_QINT32, {out_features, out_spatial_size}, &acc));
+  auto acc_tensor = acc.matrix<qint32>();
+  std::vector<int32_t> lhs_offsets(out_spatial_size);
+  for (int batch_idx = 0; batch_idx < batches; ++batch_idx) {
+    for (int accum_idx = 0; accum_idx < accum_depth; ++accum_idx) {
+      const int lhs_feature_idx = accum_idx / rhs_spatial_size;
+      const int64_t* row_lhs_spatial_idx =
+          lhs_spatial_idx.data() +
+          static_cast<size_t>(accum_idx % rhs_spatial_size) * out_spatial_size;
+      for (int out_spatial_idx = 0; out_spatial_idx < out_spatial_size;
+           ++out_spatial_idx) {
+        unfolded_lhs_tensor(accum_idx, out_spatial_idx) = lhs_tensor(
+            batch_idx, lhs_feature_idx, row_lhs_spatial_idx[out_spatial_idx]);
+      }
+    }
+    std::fill(lhs_offsets.begin(), lhs_offsets.end(),
+              -lhs_zero_points_data[batch_idx]);
+    vnni::QuantizedGemm(context, /*transpose_a=*/false, /*transpose_b=*/false,
+                        rhs.flat<qint8>().data(),
+                        unfolded_lhs.flat<qint8>().data(),
+                        acc.flat<qint32>().data(), out_features,
+                        out_spatial_size, accum_depth, rhs_offsets.data(),
+                        lhs_offsets.data(), /*lda=*/accum_depth,
+                        /*ldb=*/out_spatial_size, /*ldc=*/out_spatial_size);
+    for (int out_feature_idx = 0; out_feature_idx < out_features;
+         ++out_feature_idx) {
+      const float rhs_scale =
+          rhs_scales_data[is_rhs_per_channel ? out_feature_idx : 0];
+      for (int out_spatial_idx = 0; out_spatial_idx < out_spatial_size;
+           ++out_spatial_idx) {
+        out_tensor(batch_idx, out_feature_idx, out_spatial_idx) =
+            static_cast<int32_t>(acc_tensor(out_feature_idx, out_spatial_idx)) *
+            lhs_scales_data[batch_idx] * rhs_scale;
+      }
+    }
+  }
+  return OkStatus();
+}
+
 // Given quantized `lhs` and quantized `rhs`, performs quantized convolution and
 // writes to `out`. Assumes that `out` is already allocated with correct size.
 template <typename Tin, typename Tout>
@@ -579,7 +690,14 @@ Status EvalHybridConv(
   PadAndDilateTransposedLhs<TlhsQuant>(lhs_quantized, convolution_params,
                                        lhs_zero_points, lhs_padded_and_dilated);
 
-  if (rhs_scales.dims() != 0) {
+  if (std::is_same<Trhs, qint8>() &&
+      CanEvalQuantizedConvWithVnni(rhs_transposed, out_transposed,
+                                   convolution_params)) {
+    TF_RETURN_IF_ERROR(EvalLhsPerBatchQuantizedConvWithVnni(
+        context, lhs_padded_and_dilated, rhs_transposed, convolution_params,
+        lhs_scales, lhs_zero_points, rhs_scales, rhs_zero_points,
+        out_transposed));
+  } else if (rhs_scales.dims() != 0) {
     EvalLhsPerBatchAndRhsPerChannelQuantizedConv<TlhsQuant, Trhs>(
         lhs_padded_and_dilated, rhs_transposed, convolution_params, lhs_scales,
         lhs_zero_points, rhs_scales, rhs_zero_points, out_transposed);
@@ -25,6 +25,8 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/quantization/uniform_quant_ops_attr.pb.h"
 #include "tsl/lib/core/status_test_util.h"
@@ -55,6 +57,77 @@ std::vector<T> Arange(int start, int stop, int step = 1) {
 
 class UniformQuantizedConvolutionTest : public OpsTestBase {
  protected:
+  // Runs UniformQuantizedConvolutionHybrid like a TF Conv2D (data_format=NHWC)
+  // with strides, explicit padding and rhs dilation, on a random [2, 9, 8, 5]
+  // lhs and a random [3, 2, 5, 7] rhs, with the AVX512-VNNI code path enabled
+  // or not, and returns the result.
+  Tensor RandomHybridConv2D(bool per_channel, bool enable_vnni) {
+    UniformQuantizedConvolutionDimensionNumbersAttr dimension_numbers;
+    CHECK(TextFormat::ParseFromString(R"pb(
+                                        input_batch_dimension: 0
+                                        input_feature_dimension: 3
+                                        input_spatial_dimensions: 1
+                                        input_spatial_dimensions: 2
+                                        kernel_output_feature_dimension: 3
+                                        kernel_input_feature_dimension: 2
+                                        kernel_spatial_dimensions: 0
+                                        kernel_spatial_dimensions: 1
+                                        output_batch_dimension: 0
+                                        output_feature_dimension: 3
+                                        output_spatial_dimensions: 1
+                                        output_spatial_dimensions: 2
+                                      )pb",
+                                      &dimension_numbers));
+    inputs_.clear();
+    TF_CHECK_OK(
+        NodeDefBuilder("test", "UniformQuantizedConvolutionHybrid")
+            .Input(FakeInput(DT_FLOAT))
+            .Input(FakeInput(DT_QINT8))
+            .Input(FakeInput(DT_FLOAT))
+            .Input(FakeInput(DT_INT32))
+            .Attr("Tlhs", DT_FLOAT)
+            .Attr("Trhs", DT_QINT8)
+            .Attr("Tout", DT_FLOAT)
+            .Attr("rhs_quantization_axis", per_channel ? 3 : -1)
+            .Attr("rhs_quantization_min_val", kInt8Min)
+            .Attr("rhs_quantization_max_val", kInt8Max)
+            .Attr("window_strides", {2, 1})
+            .Attr("padding", "EXPLICIT")
+            .Attr("explicit_padding", {1, 0, 2, 1})
+            .Attr("rhs_dilation", {1, 2})
+            .Attr("dimension_numbers", dimension_numbers.SerializeAsString())
+            .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+
+    random::PhiloxRandom philox(per_channel ? 3 : 5, 17);
+    random::SimplePhilox rnd(&philox);
+    Tensor lhs(DT_FLOAT, TensorShape({2, 9, 8, 5}));
+    for (int i = 0; i < lhs.NumElements(); ++i) {
+      lhs.flat<float>()(i) = rnd.RandFloat() * 20.0f - 5.0f;
+    }
+    Tensor rhs(DT_QINT8, TensorShape({3, 2, 5, 7}));
+    for (int i = 0; i < rhs.NumElements(); ++i) {
+      rhs.flat<qint8>()(i) = static_cast<int>(rnd.Uniform(256)) - 128;
+    }
+    const TensorShape scales_shape =
+        per_channel ? TensorShape({7}) : TensorShape({});
+    Tensor rhs_scales(DT_FLOAT, scales_shape);
+    Tensor rhs_zero_points(DT_INT32, scales_shape);
+    for (int i = 0; i < rhs_scales.NumElements(); ++i) {
+      rhs_scales.flat<float>()(i) = 0.5f + i;
+      rhs_zero_points.flat<int32>()(i) = static_cast<int>(rnd.Uniform(9)) - 4;
+    }
+    AddInputFromArray<float>(lhs.shape(), lhs.flat<float>());
+    AddInputFromArray<qint8>(rhs.shape(), rhs.flat<qint8>());
+    AddInputFromArray<float>(rhs_scales.shape(), rhs_scales.flat<float>());
+    AddInputFromArray<int32>(rhs_zero_points.shape(),
+                             rhs_zero_points.flat<int32>());
+
+    vnni::SetEnabled(enable_vnni);
+    TF_CHECK_OK(RunOpKernel());
+    vnni::SetEnabled(true);
+    return *GetOutput(0);
+  }
 };
 
 TEST_F(UniformQuantizedConvolutionTest, PerTensorQuantizedDefaultAttrs) {
@@ -1566,4 +1639,19 @@ TEST_F(UniformQuantizedConvolutionTest,
   test::ExpectClose(expected, *GetOutput(0), /*atol=*/11, /*rtol=*/0.02);
 }
 
+// Checks that the AVX512-VNNI code path, used on CPUs that support it, matches
+// the reference kernel.
+TEST_F(UniformQuantizedConvolutionTest, HybridVnniMatchesReference) {
+  if (!vnni::IsSupportedAndEnabled()) {
+    GTEST_SKIP() << "AVX512-VNNI is not supported by this CPU.";
+  }
+  for (bool per_channel : {false, true}) {
+    Tensor vnni_result =
+        RandomHybridConv2D(per_channel, /*enable_vnni=*/true);
+    Tensor reference_result =
+        RandomHybridConv2D(per_channel, /*enable_vnni=*/false);
+    test::ExpectTensorEqual<float>(reference_result, vnni_result);
+  }
+}
+
 }  // namespace tensorflow
@@ -13,7 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/math_utils.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/tensor_utils.h"
 
@@ -228,6 +234,54 @@ void EvalLhsPerBatchAndRhsPerChannelQuantizedDot(
       });
 }
 
+// Performs dot on per-batch (dimension 0) quantized lhs and per-tensor or
+// per-channel (dimension 1) quantized rhs with vnni::QuantizedGemm, with the
+// same result as EvalLhsPerBatchAndRhsPer{Tensor,Channel}QuantizedDot. Requires
+// vnni::IsSupportedAndEnabled() and dimensions that fit in an int.
+Status EvalLhsPerBatchQuantizedDotWithVnni(
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
+    const Tensor& lhs_scales, const Tensor& lhs_zero_points,
+    const Tensor& rhs_scales, const Tensor& rhs_zero_points, Tensor& output) {
+  const int batches = output.dim_size(0);
+  const int output_depth = output.dim_size(1);
+  const int accum_depth = rhs.dim_size(0);
+  const bool is_rhs_per_channel = rhs_scales.dims() != 0;
+  const float* lhs_scales_data = lhs_scales.flat<float>().data();
+  const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
+  const float* rhs_scales_data = rhs_scales.flat<float>().data();
+  const int32_t* rhs_zero_points_data = rhs_zero_points.flat<int32_t>().data();
+
+  std::vector<int32_t> lhs_offsets(batches);
+  for (int b = 0; b < batches; ++b) {
+    lhs_offsets[b] = -lhs_zero_points_data[b];
+  }
+  std::vector<int32_t> rhs_offsets(output_depth);
+  for (int out_c = 0; out_c < output_depth; ++out_c) {
+    rhs_offsets[out_c] =
+        -rhs_zero_points_data[is_rhs_per_channel ? out_c : 0];
+  }
+
+  Tensor acc;
+  TF_RETURN_IF_ERROR(context->allocate_temp(DT_QINT32, output.shape(), &acc));
+  vnni::QuantizedGemm(context, /*transpose_a=*/false, /*transpose_b=*/false,
+                      lhs.flat<qint8>().data(), rhs.flat<qint8>().data(),
+                      acc.flat<qint32>().data(), batches, output_depth,
+                      accum_depth, lhs_offsets.data(), rhs_offsets.data(),
+                      /*lda=*/accum_depth, /*ldb=*/output_depth,
+                      /*ldc=*/output_depth);
+
+  const qint32* acc_data = acc.flat<qint32>().data();
+  float* output_data = output.flat<float>().data();
+  for (int64_t b = 0; b < batches; ++b) {
+    for (int64_t out_c = 0; out_c < output_depth; ++out_c) {
+      const int64_t i = b * output_depth + out_c;
+      output_data[i] = static_cast<int32_t>(acc_data[i]) * lhs_scales_data[b] *
+                       rhs_scales_data[is_rhs_per_channel ? out_c : 0];
+    }
+  }
+  return OkStatus();
+}
+
 // Given quantized lhs and quantized rhs, performs quantized dot on lhs and rhs,
 // and produce quantized output. Assumes that output is already allocated with
 // correct size.
@@ -290,6 +344,14 @@ Status EvalHybridDot(OpKernelContext* context, const Tensor& lhs,
         /*quantization_max_val=*/127, lhs_scales_data[b],
         lhs_zero_points_data[b], lhs_quantized_tensor.template chip<0>(b)));
   }
+  if (std::is_same<Trhs, qint8>() && vnni::IsSupportedAndEnabled() &&
+      std::max<int64_t>({batches, rhs.dim_size(0), rhs.dim_size(1)}) <=
+          std::numeric_limits<int>::max()) {
+    return EvalLhsPerBatchQuantizedDotWithVnni(context, lhs_quantized, rhs,
+                                               lhs_scales, lhs_zero_points,
+                                               rhs_scales, rhs_zero_points,
+                                               output);
+  }
   if (rhs_scales.dims() != 0) {
     EvalLhsPerBatchAndRhsPerChannelQuantizedDot<qint8, Trhs>(
         lhs_quantized, rhs, lhs_scales, lhs_zero_points, rhs_scales,
@@ -16,12 +16,63 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/kernels/quantized_gemm_vnni.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 
 namespace tensorflow {
 
 class UniformQuantizedDotTest : public OpsTestBase {
  protected:
+  // Runs UniformQuantizedDotHybrid on a random [batches, depth] lhs and a
+  // random [depth, channels] rhs, with the AVX512-VNNI code path enabled or
+  // not, and returns the result.
+  Tensor RandomHybridDot(int batches, int depth, int channels,
+                         bool per_channel, bool enable_vnni) {
+    inputs_.clear();
+    TF_CHECK_OK(NodeDefBuilder("test", "UniformQuantizedDotHybrid")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_QINT8))
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_INT32))
+                    .Attr("Tlhs", DT_FLOAT)
+                    .Attr("Trhs", DT_QINT8)
+                    .Attr("Tout", DT_FLOAT)
+                    .Attr("rhs_quantization_min_val", -128)
+                    .Attr("rhs_quantization_max_val", 127)
+                    .Attr("rhs_quantization_axis", per_channel ? 1 : -1)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+
+    random::PhiloxRandom philox(batches * depth * channels + 1, 17);
+    random::SimplePhilox rnd(&philox);
+    Tensor lhs(DT_FLOAT, TensorShape({batches, depth}));
+    for (int i = 0; i < lhs.NumElements(); ++i) {
+      lhs.flat<float>()(i) = rnd.RandFloat() * 20.0f - 5.0f;
+    }
+    Tensor rhs(DT_QINT8, TensorShape({depth, channels}));
+    for (int i = 0; i < rhs.NumElements(); ++i) {
+      rhs.flat<qint8>()(i) = static_cast<int>(rnd.Uniform(256)) - 128;
+    }
+    const TensorShape scales_shape =
+        per_channel ? TensorShape({channels}) : TensorShape({});
+    Tensor rhs_scales(DT_FLOAT, scales_shape);
+    Tensor rhs_zero_points(DT_INT32, scales_shape);
+    for (int i = 0; i < rhs_scales.NumElements(); ++i) {
+      rhs_scales.flat<float>()(i) = 0.5f + i;
+      rhs_zero_points.flat<int32>()(i) = static_cast<int>(rnd.Uniform(9)) - 4;
+    }
+    AddInputFromArray<float>(lhs.shape(), lhs.flat<float>());
+    AddInputFromArray<qint8>(rhs.shape(), rhs.flat<qint8>());
+    AddInputFromArray<float>(rhs_scales.shape(), rhs_scales.flat<float>());
+    AddInputFromArray<int32>(rhs_zero_points.shape(),
+                             rhs_zero_points.flat<int32>());
+
+    vnni::SetEnabled(enable_vnni);
+    TF_CHECK_OK(RunOpKernel());
+    vnni::SetEnabled(true);
+    return *GetOutput(0);
+  }
 };
 
 TEST_F(UniformQuantizedDotTest, PerTensorQuantized) {
@@ -269,4 +320,22 @@ TEST_F(UniformQuantizedDotTest, HybridPerChannelQuantized) {
   test::ExpectClose(expected, *GetOutput(0), /*atol=*/0.1, /*rtol=*/0.01);
 }
 
+// Checks that the AVX512-VNNI code path, used on CPUs that support it, matches
+// the reference kernel on shapes that are not multiples of its blocks.
+TEST_F(UniformQuantizedDotTest, HybridVnniMatchesReference) {
+  if (!vnni::IsSupportedAndEnabled()) {
+    GTEST_SKIP() << "AVX512-VNNI is not supported by this CPU.";
+  }
+  for (bool per_channel : {false, true}) {
+    for (const auto& shape : std::vector<std::vector<int>>{
+             {1, 1, 1}, {7, 37, 19}, {33, 64, 16}, {5, 3, 70}}) {
+      Tensor vnni_result = RandomHybridDot(shape[0], shape[1], shape[2],
+                                           per_channel, /*enable_vnni=*/true);
+      Tensor reference_result = RandomHybridDot(
+          shape[0], shape[1], shape[2], per_channel, /*enable_vnni=*/false);
+      test::ExpectTensorEqual<float>(reference_result, vnni_result);
+    }
+  }
+}
+
 }  // namespace tensorflow
@@ -371,6 +371,47 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+TEST(ThreadPool, ReserveWorkers) {
+  ThreadPool pool(Env::Default(), "test", kNumThreads);
+  EXPECT_EQ(pool.ReserveWorkers(0), nullptr);
+  EXPECT_EQ(pool.ReserveWorkers(kNumThreads), nullptr);
+  for (int iter = 0; iter < 2; iter++) {
+    auto reservation = pool.ReserveWorkers(2);
+    ASSERT_NE(reservation, nullptr);
+    EXPECT_EQ(reservation->NumWorkers(), 2);
+    EXPECT_EQ(pool.ReserveWorkers(1), nullptr);
+
+    // Both the reserved and the other threads finish their work.
+    const int kWorkItems = 100;
+    std::atomic<bool> work[kWorkItems];
+    std::atomic<bool> background_work[kWorkItems];
+    for (int i = 0; i < kWorkItems; i++) {
+      work[i] = false;
+      background_work[i] = false;
+    }
+    absl::BlockingCounter counter(1);
+    pool.Schedule([&]() {
+      pool.ParallelFor(kWorkItems, 1 << 30, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          ASSERT_FALSE(background_work[i].exchange(true));
+        }
+      });
+      counter.DecrementCount();
+    });
+    reservation->ParallelFor(kWorkItems, 1 << 30,
+                             [&work](int64_t begin, int64_t end) {
+                               for (int64_t i = begin; i < end; ++i) {
+                                 ASSERT_FALSE(work[i].exchange(true));
+                               }
+                             });
+    counter.Wait();
+    for (int i = 0; i < kWorkItems; i++) {
+      ASSERT_TRUE(work[i]);
+      ASSERT_TRUE(background_work[i]);
+    }
+  }
+}
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
@@ -441,6 +441,19 @@ REGISTER_OP("AnonymousMutableHashTableOfTensors")
     .SetIsStateful()
     .SetShapeFn(MutableHashTableOfTensorsShapeFn);
 
+REGISTER_OP("TieredHashTableOfTensors")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .Attr("value_shape: shape = {}")
+    .Attr("cache_capacity: int >= 1")
+    .Attr("storage_directory: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(MutableHashTableOfTensorsShapeFn);
+
 REGISTER_OP("MutableDenseHashTable")
     .Input("empty_key: key_dtype")
     .Output("table_handle: Ref(string)")
@@ -550,4 +563,107 @@ REGISTER_OP("InitializeTableFromTextFileV2")
       return OkStatus();
     });
 
+// Approximate nearest-neighbor search.
+
+REGISTER_OP("NearestNeighborIndex")
+    .Output("index_handle: resource")
+    .Attr("dim: int >= 1")
+    .Attr("num_lists: int >= 1")
+    .Attr("metric: {'l2', 'inner_product'} = 'l2'")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("NearestNeighborIndexTrain")
+    .Input("index_handle: resource")
+    .Input("vectors: float")
+    .Attr("num_iterations: int >= 1 = 10")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle vectors;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &vectors));
+      return OkStatus();
+    });
+
+REGISTER_OP("NearestNeighborIndexAdd")
+    .Input("index_handle: resource")
+    .Input("ids: int64")
+    .Input("vectors: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &ids));
+      ShapeHandle vectors;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &vectors));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(ids, 0), c->Dim(vectors, 0), &unused));
+      return OkStatus();
+    });
+
+REGISTER_OP("NearestNeighborIndexSearch")
+    .Input("index_handle: resource")
+    .Input("queries: float")
+    .Input("k: int32")
+    .Input("num_probes: int32")
+    .Output("distances: float")
+    .Output("ids: int64")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle queries;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &queries));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 0, &handle));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 0, &handle));
+      DimensionHandle k;
+      TF_RETURN_IF_ERROR(c->MakeDimForScalarInput(2, &k));
+      ShapeHandle output = c->Matrix(c->Dim(queries, 0), k);
+      c->set_output(0, output);
+      c->set_output(1, output);
+      return OkStatus();
+    });
+
+REGISTER_OP("NearestNeighborIndexSize")
+    .Input("index_handle: resource")
+    .Output("size: int64")
+    .SetShapeFn(ScalarAndTwoElementVectorInputsAndScalarOutputs);
+
+REGISTER_OP("NearestNeighborIndexExport")
+    .Input("index_handle: resource")
+    .Output("centroids: float")
+    .Output("ids: int64")
+    .Output("vectors: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      DimensionHandle size = c->UnknownDim();
+      c->set_output(0, c->Matrix(c->UnknownDim(), c->UnknownDim()));
+      c->set_output(1, c->Vector(size));
+      c->set_output(2, c->Matrix(size, c->UnknownDim()));
+      return OkStatus();
+    });
+
+REGISTER_OP("NearestNeighborIndexImport")
+    .Input("index_handle: resource")
+    .Input("centroids: float")
+    .Input("ids: int64")
+    .Input("vectors: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle handle;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 0, &handle));
+      ShapeHandle centroids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &centroids));
+      ShapeHandle ids;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &ids));
+      ShapeHandle vectors;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 2, &vectors));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(ids, 0), c->Dim(vectors, 0), &unused));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(centroids, 1), c->Dim(vectors, 1), &unused));
+      return OkStatus();
+    });
+
 }  // namespace tensorflow
@@ -339,6 +339,26 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, half, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("op_names: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Applies a chain of element-wise ops to `x` in a single pass over the data.
+
+Unary ops are applied to the running value.  Binary ops combine the running
+value with the next of `args`, which must have the shape of `x`, have a single
+element, or match the last dimension of `x`.  A binary op name prefixed with
+`Reverse` takes the running value as its second operand.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -1679,6 +1699,53 @@ REGISTER_OP("SparseSegmentSqrtNGradV2")
     .Attr("Tsegmentids: {int32, int64} = DT_INT32")
     .SetShapeFn(SparseSegmentReductionGradV2ShapeFn);
 
+REGISTER_OP("SparseSegmentWeightedSum")
+    .Input("data: T")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("weights: T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &unused));
+      TF_RETURN_IF_ERROR(c->Merge(c->input(1), c->input(3), &unused));
+      return SparseSegmentReductionShapeFn(c);
+    });
+
+REGISTER_OP("SparseSegmentWeightedSumGrad")
+    .Input("grad: T")
+    .Input("data: T")
+    .Input("indices: Tidx")
+    .Input("segment_ids: Tsegmentids")
+    .Input("weights: T")
+    .Input("output: T")
+    .Output("data_grad: T")
+    .Output("weights_grad: T")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .Attr("combiner: {'sum', 'mean', 'sqrtn'} = 'sum'")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle data_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 1, &data_shape));
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &indices_shape));
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(3), &indices_shape));
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, c->input(4), &indices_shape));
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(data_shape, 1, &subshape));
+      ShapeHandle data_grad_shape;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(indices_shape, subshape, &data_grad_shape));
+      c->set_output(0, data_grad_shape);
+      c->set_output(1, indices_shape);
+      return OkStatus();
+    });
+
 REGISTER_OP("All")
     .Input("input: bool")
     .Input("reduction_indices: Tidx")
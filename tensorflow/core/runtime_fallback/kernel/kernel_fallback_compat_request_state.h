@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 #include "tensorflow/core/tfrt/graph_executor/config.h"
 #include "tensorflow/core/tfrt/utils/fallback_tensor.h"
 #include "tfrt/host_context/async_value_ref.h"  // from @tf_runtime
@@ -133,6 +134,16 @@ class KernelFallbackCompatRequestState {
 
   tfrt_stub::OpKernelRunnerTable* runner_table() const { return runner_table_; }
 
+  // Nullable. If set, the kernels of stateless ops are created through this
+  // cache, which shares them with the other graphs using it.
+  tfrt_stub::SharedOpKernelRunnerCache* shared_op_kernel_runner_cache() const {
+    return shared_op_kernel_runner_cache_;
+  }
+  void set_shared_op_kernel_runner_cache(
+      tfrt_stub::SharedOpKernelRunnerCache* shared_op_kernel_runner_cache) {
+    shared_op_kernel_runner_cache_ = shared_op_kernel_runner_cache;
+  }
+
   FallbackResourceArray* resource_array() const { return resource_array_; }
 
   std::function<void(std::function<void()>)>* runner() const { return runner_; }
@@ -203,6 +214,9 @@ class KernelFallbackCompatRequestState {
   // kernel fallback compat mode.
   tfrt_stub::OpKernelRunnerTable* runner_table_ = nullptr;
 
+  tfrt_stub::SharedOpKernelRunnerCache* shared_op_kernel_runner_cache_ =
+      nullptr;
+
   // Resource array is used for keeping static values in the runtime. It is
   // accessed through tfrt_fallback_async.set_resource and
   // tfrt_fallback_async.get_resource kernels.
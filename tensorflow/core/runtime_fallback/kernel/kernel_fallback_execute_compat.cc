@@ -554,10 +554,19 @@ tfrt::AsyncValueRef<tfrt::Chain> KernelFallbackCreateOp(
 
   auto op_name = StripTfPrefix(op_name_attr.GetValue());
 
-  auto statusor_runner = OpKernelRunner::Create(
-      op_name, ToAbslStringView(device.GetValue()), num_args.GetValue(),
-      attr_builder, fallback_request_state->device_manager(),
-      fallback_request_state->process_function_library_runtime());
+  auto* shared_cache = fallback_request_state->shared_op_kernel_runner_cache();
+  auto statusor_runner =
+      shared_cache != nullptr
+          ? shared_cache->GetOrCreate(
+                op_name, /*node_name=*/op_name,
+                ToAbslStringView(device.GetValue()), num_args.GetValue(),
+                attr_builder, fallback_request_state->device_manager(),
+                fallback_request_state->process_function_library_runtime())
+          : OpKernelRunner::Create(
+                op_name, ToAbslStringView(device.GetValue()),
+                num_args.GetValue(), attr_builder,
+                fallback_request_state->device_manager(),
+                fallback_request_state->process_function_library_runtime());
   if (!statusor_runner.ok())
     return tfrt::EmitErrorAsync(exec_ctx, statusor_runner.status());
 
@@ -14,7 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
@@ -24,20 +29,27 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/summary/summary_converter.h"
 #include "tensorflow/core/util/events_writer.h"
 
 namespace tensorflow {
 namespace {
 
+auto* dropped_events = monitoring::Counter<0>::New(
+    "/tensorflow/core/summary/dropped_events",
+    "The number of summary events dropped by the asynchronous summary file "
+    "writers because too many events were waiting to be written.");
+
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
       : SummaryWriterInterface(),
-        is_initialized_(false),
         max_queue_(max_queue),
         flush_millis_(flush_millis),
-        env_(env) {}
+        env_(env),
+        is_initialized_(false) {}
 
   Status Initialize(const string& logdir, const string& filename_suffix) {
     const Status is_dir = env_->IsDirectory(logdir);
@@ -162,6 +174,11 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   string DebugString() const override { return "SummaryFileWriter"; }
 
+ protected:
+  const size_t max_queue_;
+  const int flush_millis_;
+  Env* env_;
+
  private:
   double GetWallTime() {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
@@ -179,10 +196,7 @@ class SummaryFileWriter : public SummaryWriterInterface {
   }
 
   bool is_initialized_;
-  const int max_queue_;
-  const int flush_millis_;
   uint64 last_flush_;
-  Env* env_;
   mutex mu_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
   // A pointer to allow deferred construction.
@@ -191,6 +205,118 @@ class SummaryFileWriter : public SummaryWriterInterface {
       TF_GUARDED_BY(mu_);
 };
 
+// A SummaryFileWriter whose events are written by a background thread. The
+// events are only appended to a queue by the callers of WriteEvent(), under a
+// mutex held for the append only, and the background thread takes the whole
+// queue at once to write its events in a batch.
+class AsyncSummaryFileWriter : public SummaryFileWriter {
+ public:
+  AsyncSummaryFileWriter(int max_queue, int flush_millis, int max_pending,
+                         Env* env)
+      : SummaryFileWriter(max_queue, flush_millis, env),
+        max_pending_(std::max(max_pending, 1)) {}
+
+  ~AsyncSummaryFileWriter() override {
+    {
+      mutex_lock ml(pending_mu_);
+      closing_ = true;
+      pending_cv_.notify_one();
+    }
+    thread_.reset();  // Joins the thread, once the pending events are written.
+  }
+
+  Status Initialize(const string& logdir, const string& filename_suffix) {
+    TF_RETURN_IF_ERROR(SummaryFileWriter::Initialize(logdir, filename_suffix));
+    thread_.reset(env_->StartThread(ThreadOptions(),
+                                    "async_summary_file_writer",
+                                    [this] { WriteLoop(); }));
+    return OkStatus();
+  }
+
+  Status WriteEvent(std::unique_ptr<Event> event) override {
+    mutex_lock ml(pending_mu_);
+    if (pending_.size() >= max_pending_) {
+      ++num_dropped_;
+      dropped_events->GetCell()->IncrementBy(1);
+      return OkStatus();
+    }
+    pending_.push_back(std::move(event));
+    if (pending_.size() >= max_queue_) {
+      pending_cv_.notify_one();
+    }
+    return OkStatus();
+  }
+
+  Status Flush() override {
+    mutex_lock ml(pending_mu_);
+    const int64_t flush_id = ++num_flushes_requested_;
+    pending_cv_.notify_one();
+    while (num_flushes_done_ < flush_id) {
+      flushed_cv_.wait(ml);
+    }
+    return std::exchange(status_, OkStatus());
+  }
+
+  string DebugString() const override {
+    mutex_lock ml(pending_mu_);
+    return absl::StrCat("AsyncSummaryFileWriter(dropped_events=",
+                        num_dropped_, ")");
+  }
+
+ private:
+  void WriteLoop() {
+    while (true) {
+      std::vector<std::unique_ptr<Event>> batch;
+      int64_t flush_id;
+      bool closing;
+      {
+        mutex_lock ml(pending_mu_);
+        if (!closing_ && num_flushes_requested_ == num_flushes_done_ &&
+            pending_.size() < max_queue_) {
+          pending_cv_.wait_for(
+              ml, std::chrono::milliseconds(std::max(flush_millis_, 1)));
+        }
+        flush_id = num_flushes_requested_;
+        closing = closing_;
+        batch.swap(pending_);
+      }
+      Status status;
+      for (std::unique_ptr<Event>& event : batch) {
+        status.Update(SummaryFileWriter::WriteEvent(std::move(event)));
+      }
+      // Also flushes the events left by the last batch once the flush
+      // interval is over.
+      if (batch.empty() || flush_id > num_flushes_done_ || closing) {
+        status.Update(SummaryFileWriter::Flush());
+      }
+      {
+        mutex_lock ml(pending_mu_);
+        status_.Update(status);
+        if (flush_id > num_flushes_done_) {
+          num_flushes_done_ = flush_id;
+          flushed_cv_.notify_all();
+        }
+        if (closing && pending_.empty()) {
+          return;
+        }
+      }
+    }
+  }
+
+  const size_t max_pending_;
+  mutable mutex pending_mu_;
+  condition_variable pending_cv_;
+  condition_variable flushed_cv_;
+  std::vector<std::unique_ptr<Event>> pending_ TF_GUARDED_BY(pending_mu_);
+  int64_t num_dropped_ TF_GUARDED_BY(pending_mu_) = 0;
+  int64_t num_flushes_requested_ TF_GUARDED_BY(pending_mu_) = 0;
+  int64_t num_flushes_done_ TF_GUARDED_BY(pending_mu_) = 0;
+  bool closing_ TF_GUARDED_BY(pending_mu_) = false;
+  // The errors of the writes since the last Flush().
+  Status status_ TF_GUARDED_BY(pending_mu_);
+  std::unique_ptr<Thread> thread_;
+};
+
 }  // namespace
 
 Status CreateSummaryFileWriter(int max_queue, int flush_millis,
@@ -208,4 +334,20 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
   return OkStatus();
 }
 
+Status CreateAsyncSummaryFileWriter(int max_queue, int flush_millis,
+                                    int max_pending, const string& logdir,
+                                    const string& filename_suffix, Env* env,
+                                    SummaryWriterInterface** result) {
+  AsyncSummaryFileWriter* w =
+      new AsyncSummaryFileWriter(max_queue, flush_millis, max_pending, env);
+  const Status s = w->Initialize(logdir, filename_suffix);
+  if (!s.ok()) {
+    w->Unref();
+    *result = nullptr;
+    return s;
+  }
+  *result = w;
+  return OkStatus();
+}
+
 }  // namespace tensorflow
@@ -38,6 +38,20 @@ Status CreateSummaryFileWriter(int max_queue, int flush_millis,
                                const string& filename_suffix, Env* env,
                                SummaryWriterInterface** result);
 
+/// \brief Creates SummaryWriterInterface which writes to a file from a
+/// background thread.
+///
+/// Like CreateSummaryFileWriter(), but the events are written and flushed to
+/// the file by a background thread, off the threads writing the summaries,
+/// which only enqueue them. Up to max_pending events wait to be written:
+/// further events are dropped rather than blocking the caller, and counted by
+/// the /tensorflow/core/summary/dropped_events metric. Flush() waits for the
+/// events enqueued before it to be written.
+Status CreateAsyncSummaryFileWriter(int max_queue, int flush_millis,
+                                    int max_pending, const string& logdir,
+                                    const string& filename_suffix, Env* env,
+                                    SummaryWriterInterface** result);
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_SUMMARY_SUMMARY_FILE_WRITER_H_
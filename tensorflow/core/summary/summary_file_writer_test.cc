@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/summary/summary_file_writer.h"
 
+#include <atomic>
+
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/event.pb.h"
@@ -40,6 +43,72 @@ class FakeClockEnv : public EnvWrapper {
   uint64 current_millis_;
 };
 
+// A writable file whose Sync() fails while `*fail_sync` is set.
+class FailingSyncFile : public WritableFile {
+ public:
+  FailingSyncFile(std::unique_ptr<WritableFile> file,
+                  const std::atomic<bool>* fail_sync)
+      : file_(std::move(file)), fail_sync_(fail_sync) {}
+  Status Append(StringPiece data) override { return file_->Append(data); }
+  Status Close() override { return file_->Close(); }
+  Status Flush() override { return file_->Flush(); }
+  Status Name(StringPiece* result) const override {
+    return file_->Name(result);
+  }
+  Status Sync() override {
+    if (*fail_sync_) return errors::DataLoss("Injected sync failure");
+    return file_->Sync();
+  }
+  Status Tell(int64_t* position) override { return file_->Tell(position); }
+
+ private:
+  std::unique_ptr<WritableFile> file_;
+  const std::atomic<bool>* fail_sync_;
+};
+
+class FailingSyncFileSystem : public WrappedFileSystem {
+ public:
+  explicit FailingSyncFileSystem(FileSystem* fs)
+      : WrappedFileSystem(fs, /*token=*/nullptr) {}
+
+  TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
+
+  Status NewWritableFile(const string& fname, TransactionToken* token,
+                         std::unique_ptr<WritableFile>* result) override {
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(WrappedFileSystem::NewWritableFile(fname, token, &file));
+    result->reset(new FailingSyncFile(std::move(file), &fail_sync));
+    return OkStatus();
+  }
+
+  std::atomic<bool> fail_sync{false};
+};
+
+// An Env whose files fail to sync on demand.
+class FailingSyncEnv : public EnvWrapper {
+ public:
+  FailingSyncEnv() : EnvWrapper(Env::Default()) {}
+
+  Status GetFileSystemForFile(const string& fname,
+                              FileSystem** result) override {
+    if (fs_ == nullptr) {
+      FileSystem* fs;
+      TF_RETURN_IF_ERROR(EnvWrapper::GetFileSystemForFile(fname, &fs));
+      fs_ = std::make_unique<FailingSyncFileSystem>(fs);
+    }
+    *result = fs_.get();
+    return OkStatus();
+  }
+
+  void set_fail_sync(bool fail_sync) {
+    CHECK(fs_ != nullptr);
+    fs_->fail_sync = fail_sync;
+  }
+
+ private:
+  std::unique_ptr<FailingSyncFileSystem> fs_;
+};
+
 class SummaryFileWriterTest : public ::testing::Test {
  protected:
   Status SummaryTestHelper(
@@ -281,5 +350,141 @@ TEST_F(SummaryFileWriterTest, AvoidFilenameCollision) {
       << "files = [" << absl::StrJoin(files, ", ") << "]";
 }
 
+// Returns the steps of the summary events written for `test_name`.
+std::vector<int64_t> ReadSummarySteps(Env* env, const string& test_name) {
+  std::vector<string> files;
+  TF_CHECK_OK(env->GetChildren(testing::TmpDir(), &files));
+  std::vector<int64_t> steps;
+  for (const string& f : files) {
+    if (!absl::StrContains(f, test_name)) continue;
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env->NewRandomAccessFile(io::JoinPath(testing::TmpDir(), f),
+                                         &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    while (reader.ReadRecord(&offset, &record).ok()) {
+      Event e;
+      e.ParseFromString(record);
+      if (e.has_summary()) steps.push_back(e.step());
+    }
+  }
+  return steps;
+}
+
+TEST_F(SummaryFileWriterTest, AsyncWritesEventsInOrder) {
+  const string test_name = "async_in_order_test";
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+      /*max_queue=*/8, /*flush_millis=*/1, /*max_pending=*/1000,
+      testing::TmpDir(), test_name, &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  std::vector<int64_t> expected_steps;
+  for (int64_t step = 0; step < 100; ++step) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = step;
+    TF_CHECK_OK(writer->WriteScalar(step, value, "name"));
+    expected_steps.push_back(step);
+  }
+  TF_CHECK_OK(writer->Flush());
+  EXPECT_EQ(ReadSummarySteps(&env_, test_name), expected_steps);
+}
+
+TEST_F(SummaryFileWriterTest, AsyncDropsEventsOverMaxPending) {
+  const string test_name = "async_drop_test";
+  monitoring::testing::CellReader<int64_t> dropped_events(
+      "/tensorflow/core/summary/dropped_events");
+  SummaryWriterInterface* writer;
+  // The background thread only wakes up on Flush().
+  TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+      /*max_queue=*/100, /*flush_millis=*/1000000, /*max_pending=*/2,
+      testing::TmpDir(), test_name, &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  for (int64_t step = 0; step < 5; ++step) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = step;
+    TF_CHECK_OK(writer->WriteScalar(step, value, "name"));
+  }
+  TF_CHECK_OK(writer->Flush());
+  EXPECT_EQ(ReadSummarySteps(&env_, test_name),
+            std::vector<int64_t>({0, 1}));
+  EXPECT_EQ(writer->DebugString(), "AsyncSummaryFileWriter(dropped_events=3)");
+  EXPECT_EQ(dropped_events.Delta(), 3);
+
+  // Writing the pending events makes room for new ones.
+  for (int64_t step = 5; step < 7; ++step) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = step;
+    TF_CHECK_OK(writer->WriteScalar(step, value, "name"));
+  }
+  TF_CHECK_OK(writer->Flush());
+  EXPECT_EQ(ReadSummarySteps(&env_, test_name),
+            std::vector<int64_t>({0, 1, 5, 6}));
+  EXPECT_EQ(dropped_events.Delta(), 0);
+}
+
+TEST_F(SummaryFileWriterTest, AsyncFlushWaitsForEarlierEvents) {
+  const string test_name = "async_flush_test";
+  SummaryWriterInterface* writer;
+  // The background thread only wakes up on Flush().
+  TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+      /*max_queue=*/100, /*flush_millis=*/1000000, /*max_pending=*/100,
+      testing::TmpDir(), test_name, &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  std::vector<int64_t> expected_steps;
+  for (int64_t step = 0; step < 6; ++step) {
+    Tensor value(DT_FLOAT, TensorShape({}));
+    value.scalar<float>()() = step;
+    TF_CHECK_OK(writer->WriteScalar(step, value, "name"));
+    expected_steps.push_back(step);
+    if (step % 3 == 2) {
+      TF_CHECK_OK(writer->Flush());
+      EXPECT_EQ(ReadSummarySteps(&env_, test_name), expected_steps);
+    }
+  }
+  // Nothing left to write.
+  TF_CHECK_OK(writer->Flush());
+  EXPECT_EQ(ReadSummarySteps(&env_, test_name), expected_steps);
+}
+
+TEST_F(SummaryFileWriterTest, AsyncFlushReturnsWriteErrorsOnce) {
+  const string test_name = "async_flush_error_test";
+  FailingSyncEnv env;
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+      /*max_queue=*/100, /*flush_millis=*/1000000, /*max_pending=*/100,
+      testing::TmpDir(), test_name, &env, &writer));
+  core::ScopedUnref deleter(writer);
+  Tensor value(DT_FLOAT, TensorShape({}));
+  value.scalar<float>()() = 0;
+  TF_CHECK_OK(writer->WriteScalar(0, value, "name"));
+  env.set_fail_sync(true);
+  EXPECT_EQ(writer->Flush().code(), absl::StatusCode::kDataLoss);
+  // The error is returned by the first Flush() after it only, and the events
+  // are written once the file syncs again.
+  env.set_fail_sync(false);
+  TF_CHECK_OK(writer->Flush());
+  EXPECT_EQ(ReadSummarySteps(&env_, test_name), std::vector<int64_t>({0}));
+}
+
+TEST_F(SummaryFileWriterTest, AsyncWritesPendingEventsOnDestruction) {
+  const string test_name = "async_destruction_test";
+  {
+    SummaryWriterInterface* writer;
+    // The background thread only wakes up when the writer is destroyed.
+    TF_CHECK_OK(CreateAsyncSummaryFileWriter(
+        /*max_queue=*/100, /*flush_millis=*/1000000, /*max_pending=*/100,
+        testing::TmpDir(), test_name, &env_, &writer));
+    core::ScopedUnref deleter(writer);
+    for (int64_t step = 0; step < 5; ++step) {
+      Tensor value(DT_FLOAT, TensorShape({}));
+      value.scalar<float>()() = step;
+      TF_CHECK_OK(writer->WriteScalar(step, value, "name"));
+    }
+  }
+  EXPECT_EQ(ReadSummarySteps(&env_, test_name),
+            std::vector<int64_t>({0, 1, 2, 3, 4}));
+}
+
 }  // namespace
 }  // namespace tensorflow
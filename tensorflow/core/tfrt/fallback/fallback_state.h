@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
@@ -74,12 +75,18 @@ class FallbackState {
     return func_lib_def_;
   }
 
+  // The kernels of stateless ops shared by the graphs using this state.
+  SharedOpKernelRunnerCache &shared_op_kernel_runner_cache() {
+    return shared_op_kernel_runner_cache_;
+  }
+
  private:
   SessionOptions session_options_;
   StaticDeviceMgr device_manager_;
   DeviceSet device_set_;
   FunctionLibraryDefinition func_lib_def_;
   ProcessFunctionLibraryRuntime pflr_;
+  SharedOpKernelRunnerCache shared_op_kernel_runner_cache_;
 };
 
 }  // namespace tfrt_stub
@@ -140,7 +140,7 @@ OpKernelRunner::OpKernelRunner(
     tensorflow::Device* device,
     tensorflow::FunctionLibraryRuntime* function_library_runtime,
     std::unique_ptr<tensorflow::OpKernel> op_kernel)
-    : op_kernel_(std::move(op_kernel)), info_(std::make_unique<Info>()) {
+    : op_kernel_(std::move(op_kernel)), info_(std::make_shared<Info>()) {
   DCHECK(device);
   DCHECK(function_library_runtime);
 
@@ -121,7 +121,9 @@ class OpKernelRunner {
       tensorflow::FunctionLibraryRuntime* function_library_runtime,
       std::unique_ptr<OpKernel> op_kernel);
 
-  std::unique_ptr<OpKernel> op_kernel_;
+  // The kernel and its info are shared by the copies of the runner, e.g. those
+  // of a stateless kernel shared by the ops of several graphs.
+  std::shared_ptr<OpKernel> op_kernel_;
   absl::Span<const AllocatorAttributes> input_alloc_attrs_;
   absl::Span<const AllocatorAttributes> output_alloc_attrs_;
 
@@ -133,7 +135,7 @@ class OpKernelRunner {
     gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs;
     gtl::InlinedVector<AllocatorAttributes, 1> output_alloc_attrs;
   };
-  std::unique_ptr<Info> info_;
+  std::shared_ptr<Info> info_;
 };
 
 // OpKernelRunState keeps the states needed for per-kernel execution.
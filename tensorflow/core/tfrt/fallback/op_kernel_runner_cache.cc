@@ -15,14 +15,47 @@ limitations under the License.
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner_cache.h"
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/casts.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 
 namespace tensorflow {
 namespace tfrt_stub {
+namespace {
+
+bool HasFunctionAttr(const tensorflow::AttrValueMap& attrs) {
+  return absl::c_any_of(attrs, [](const auto& attr) {
+    return attr.second.has_func() || attr.second.list().func_size() > 0;
+  });
+}
+
+// Returns the key of a stateless op, made of its name, device, number of
+// arguments and its attributes in name order.
+std::string SharedOpKernelKey(absl::string_view op_name,
+                              absl::string_view device_name, int num_args,
+                              const tensorflow::AttrValueMap& attrs) {
+  std::map<absl::string_view, const tensorflow::AttrValue*> sorted_attrs;
+  for (const auto& attr : attrs) sorted_attrs[attr.first] = &attr.second;
+
+  std::string key = absl::StrCat(op_name, ";", device_name, ";", num_args);
+  for (const auto& [attr_name, attr] : sorted_attrs) {
+    std::string attr_value;
+    SerializeToStringDeterministic(*attr, &attr_value);
+    absl::StrAppend(&key, ";", attr_name, "=", attr_value);
+  }
+  return key;
+}
+
+}  // namespace
 
 StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
     tfrt::Location loc, absl::string_view op_name,
@@ -69,5 +102,46 @@ StatusOr<OpKernelRunner*> OpKernelRunnerCache::GetOrCreate(
   return runner_ptr;
 }
 
+StatusOr<OpKernelRunner> SharedOpKernelRunnerCache::GetOrCreate(
+    absl::string_view op_name, absl::string_view node_name,
+    absl::string_view device_name, int num_args,
+    const std::function<Status(tensorflow::AttrValueMap*)>& attr_builder,
+    const tensorflow::DeviceMgr& device_manager,
+    const tensorflow::ProcessFunctionLibraryRuntime&
+        process_function_library_runtime) {
+  tensorflow::AttrValueMap attrs;
+  TF_RETURN_IF_ERROR(attr_builder(&attrs));
+  auto copy_attrs = [&attrs](tensorflow::AttrValueMap* attr_value_map) {
+    *attr_value_map = attrs;
+    return OkStatus();
+  };
+
+  const OpDef* op_def = nullptr;
+  TF_RETURN_IF_ERROR(tensorflow::OpRegistry::Global()->LookUpOpDef(
+      std::string(op_name), &op_def));
+  if (op_def->is_stateful() || HasFunctionAttr(attrs)) {
+    return OpKernelRunner::Create(op_name, node_name, device_name, num_args,
+                                  copy_attrs, device_manager,
+                                  process_function_library_runtime);
+  }
+
+  std::string key = SharedOpKernelKey(op_name, device_name, num_args, attrs);
+  {
+    tf_shared_lock lock(mu_);
+    auto it = map_.find(key);
+    if (it != map_.end()) return it->second;
+  }
+
+  // Kernels are created outside of the lock as that may be expensive. If two
+  // identical ops race, the kernel of the first one is kept.
+  TF_ASSIGN_OR_RETURN(
+      auto runner, OpKernelRunner::Create(op_name, node_name, device_name,
+                                          num_args, copy_attrs, device_manager,
+                                          process_function_library_runtime));
+
+  mutex_lock lock(mu_);
+  return map_.try_emplace(std::move(key), std::move(runner)).first->second;
+}
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
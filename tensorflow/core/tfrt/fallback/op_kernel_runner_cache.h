@@ -15,9 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 #define TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
 #include "tfrt/host_context/location.h"  // from @tf_runtime
@@ -65,6 +68,37 @@ class OpKernelRunnerCache {
       TF_GUARDED_BY(mu_);
 };
 
+// SharedOpKernelRunnerCache shares the kernels of stateless ops with the same
+// attributes on the same device, e.g. between the graphs loaded in the same
+// FallbackState, so that loading another graph does not re-instantiate them.
+// Kernels of stateful ops, and of ops with function attributes, are never
+// shared. It is thread-safe.
+class SharedOpKernelRunnerCache {
+ public:
+  SharedOpKernelRunnerCache() = default;
+
+  // Returns a runner of the op, which shares the kernel of a previously created
+  // identical op if it is stateless. The name of a shared kernel is the
+  // `node_name` of the op that created it.
+  StatusOr<OpKernelRunner> GetOrCreate(
+      absl::string_view op_name, absl::string_view node_name,
+      absl::string_view device_name, int num_args,
+      const std::function<Status(tensorflow::AttrValueMap*)>& attr_builder,
+      const tensorflow::DeviceMgr& device_manager,
+      const tensorflow::ProcessFunctionLibraryRuntime&
+          process_function_library_runtime);
+
+  // Returns the number of shared kernels.
+  int64_t size() const {
+    tf_shared_lock lock(mu_);
+    return map_.size();
+  }
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<std::string, OpKernelRunner> map_ TF_GUARDED_BY(mu_);
+};
+
 }  // namespace tfrt_stub
 }  // namespace tensorflow
 #endif  // TENSORFLOW_CORE_TFRT_FALLBACK_OP_KERNEL_RUNNER_CACHE_H_
@@ -60,6 +60,14 @@ REGISTER_KERNEL_BUILDER(Name("TestOp").Device(DEVICE_CPU), TestOpKernel);
 // not have `f` attribute. Users will not invoke this op directly.
 REGISTER_OP("TestOp").Input("x: int32").Output("y: int32");
 
+REGISTER_KERNEL_BUILDER(Name("TestStatefulOp").Device(DEVICE_CPU),
+                        TestOpKernel);
+
+REGISTER_OP("TestStatefulOp")
+    .Input("x: int32")
+    .Output("y: int32")
+    .SetIsStateful();
+
 TEST(OpKernelRunnerTest, Create) {
   tensorflow::SessionOptions session_options;
   tensorflow::FunctionDefLibrary fdef_lib;
@@ -122,6 +130,45 @@ TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   EXPECT_EQ(runner->op_kernel()->name(), "TestOp_100_0");
 }
 
+TEST(OpKernelRunnerTest, SharedOpKernelRunnerCache) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  SharedOpKernelRunnerCache& cache =
+      fallback_state->shared_op_kernel_runner_cache();
+
+  auto get_or_create = [&](absl::string_view op_name,
+                           absl::string_view node_name) {
+    return cache.GetOrCreate(
+        op_name, node_name,
+        /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+        /*num_args=*/1,
+        /*attr_builder=*/[](tensorflow::AttrValueMap*) { return OkStatus(); },
+        fallback_state->device_manager(),
+        fallback_state->process_function_library_runtime());
+  };
+
+  // Identical stateless ops share their kernel.
+  TF_ASSERT_OK_AND_ASSIGN(auto runner, get_or_create("TestOp", "node_0"));
+  TF_ASSERT_OK_AND_ASSIGN(auto other_runner,
+                          get_or_create("TestOp", "node_1"));
+  ASSERT_TRUE(runner);
+  EXPECT_EQ(runner.op_kernel(), other_runner.op_kernel());
+  EXPECT_EQ(other_runner.op_kernel()->name(), "node_0");
+  EXPECT_EQ(cache.size(), 1);
+
+  // Stateful ops don't.
+  TF_ASSERT_OK_AND_ASSIGN(auto stateful_runner,
+                          get_or_create("TestStatefulOp", "node_2"));
+  TF_ASSERT_OK_AND_ASSIGN(auto other_stateful_runner,
+                          get_or_create("TestStatefulOp", "node_3"));
+  EXPECT_NE(stateful_runner.op_kernel(), other_stateful_runner.op_kernel());
+  EXPECT_EQ(other_stateful_runner.op_kernel()->name(), "node_3");
+  EXPECT_EQ(cache.size(), 1);
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunState) {
   SessionOptions options;
   auto* device_count = options.config.mutable_device_count();
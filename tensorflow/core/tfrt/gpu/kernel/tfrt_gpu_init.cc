@@ -29,7 +29,15 @@ namespace gpu {
 
 Status InitTfrtGpu(const GpuRunnerOptions& options,
                    tensorflow::tfrt_stub::Runtime& runtime) {
-  auto policy = std::make_unique<RoundRobinPolicy>();
+  std::unique_ptr<ServingDeviceSelector::Policy> policy;
+  switch (options.serving_selector_policy) {
+    case ServingDeviceSelectorPolicy::kRoundRobin:
+      policy = std::make_unique<RoundRobinPolicy>();
+      break;
+    case ServingDeviceSelectorPolicy::kMinCompletionTime:
+      policy = std::make_unique<MinCompletionTimePolicy>();
+      break;
+  }
   auto serving_device_selector =
       std::make_unique<tensorflow::gpu::GpuServingDeviceSelector>(
           options.num_gpu_streams, std::move(policy));
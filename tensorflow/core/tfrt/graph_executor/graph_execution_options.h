@@ -96,10 +96,21 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // If true, the executable is recompiled with the recorded costs on a
+    // background thread, and swapped in once ready, instead of within the
+    // request that completes the measurement cycle. Costs are not recorded
+    // while a recompilation is in progress.
+    bool recompile_in_background = false;
   };
 
   CostAnalysisOptions cost_analysis_options;
 
+  // If true, the kernels of identical stateless ops are shared between the
+  // graphs loaded in the same FallbackState, e.g. the client graphs of
+  // different signatures, instead of being created again for each graph.
+  bool share_stateless_op_kernels = false;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
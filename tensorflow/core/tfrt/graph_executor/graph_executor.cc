@@ -247,6 +247,10 @@ StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
               &process_function_library_runtime);
 
   fallback_request_state.set_cost_recorder(cost_recorder);
+  if (options.share_stateless_op_kernels) {
+    fallback_request_state.set_shared_op_kernel_runner_cache(
+        &fallback_state.shared_op_kernel_runner_cache());
+  }
   fallback_request_state.set_client_graph_resource_context(
       client_graph_resource_context);
   fallback_request_state.set_runtime_config(&options.runtime_config);
@@ -468,6 +472,14 @@ GraphExecutor::GraphExecutor(
   SetSessionCreatedMetric();
 }
 
+GraphExecutor::~GraphExecutor() {
+  // The background recompilations use the members of this executor.
+  tensorflow::mutex_lock lock(loaded_client_graphs_mu_);
+  for (auto& [name, loaded_client_graph] : loaded_client_graphs_) {
+    loaded_client_graph->WaitForRecompilation();
+  }
+}
+
 StatusOr<std::unique_ptr<GraphExecutor>> GraphExecutor::Create(
     Options options, std::unique_ptr<FallbackState> fallback_state,
     std::unique_ptr<tfrt::ResourceContext> resource_context,
@@ -611,14 +623,19 @@ tensorflow::Status GraphExecutor::Run(
       &req_deadline_tracker_, loaded_client_graph.stream_callback_id(),
       cost_recorder));
 
-  if (do_recompilation) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
-    tensorflow::mutex_lock l(num_recompilations_mu_);
-    num_recompilations_ += 1;
-  }
-  if (cost_recorder != nullptr) {
-    loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
+  if (do_recompilation &&
+      options_.cost_analysis_options.recompile_in_background) {
+    loaded_client_graph.UpdateCostInBackground(now, runtime());
+  } else {
+    if (do_recompilation) {
+      TF_RETURN_IF_ERROR(
+          loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
+      tensorflow::mutex_lock l(num_recompilations_mu_);
+      num_recompilations_ += 1;
+    }
+    if (cost_recorder != nullptr) {
+      loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
+    }
   }
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
@@ -1034,6 +1051,27 @@ Status GraphExecutor::LoadedClientGraph::UpdateCost(
   return OkStatus();
 }
 
+void GraphExecutor::LoadedClientGraph::UpdateCostInBackground(
+    absl::Time now, const Runtime& runtime) {
+  // The cost analysis data stays unavailable to the other requests until the
+  // recompilation is done, so the previous thread is about to exit if any, and
+  // the cost recorder and the MLIR are only used by the new thread.
+  WaitForRecompilation();
+  recompilation_thread_.reset(tsl::Env::Default()->StartThread(
+      tsl::ThreadOptions(), "tfrt_cost_recompilation", [this, now, &runtime] {
+        Status status =
+            UpdateCost(*cost_analysis_data_.cost_recorder, runtime);
+        UpdateCostAnalysisData(now, /*do_recompilation=*/true);
+        if (!status.ok()) {
+          LOG(ERROR) << "TFRT failed to recompile loaded client graph " << name_
+                     << " with the recorded op costs: " << status;
+          return;
+        }
+        tensorflow::mutex_lock l(graph_executor_->num_recompilations_mu_);
+        graph_executor_->num_recompilations_ += 1;
+      }));
+}
+
 GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     std::string name, SymbolUids symbol_uids, GraphExecutor* graph_executor,
     std::unique_ptr<mlir::MLIRContext> mlir_context,
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/runtime/stream.h"
 #include "tensorflow/core/tfrt/runtime/work_queue_interface.h"
 #include "tensorflow/core/tfrt/utils/tfrt_graph_execution_state.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/thread_annotations.h"
 #include "tfrt/bef/bef_buffer.h"  // from @tf_runtime
 #include "tfrt/bef_executor/bef_file.h"  // from @tf_runtime
@@ -153,6 +154,12 @@ class GraphExecutor {
     // `cost_recorder`.
     Status UpdateCost(const CostRecorder& cost_recorder,
                       const Runtime& runtime);
+    // Like UpdateCost() with this instance's CostRecorder, followed by
+    // UpdateCostAnalysisData(), but on a background thread. Must only be called
+    // after MaybeGetCostRecorder() requested a recompilation.
+    void UpdateCostInBackground(absl::Time now, const Runtime& runtime);
+    // Waits for the background recompilation, if any.
+    void WaitForRecompilation() { recompilation_thread_.reset(); }
     // Updates `cost_analysis_data_` to make it accurate for the next execution.
     // Assumes a cost update occurred this cycle.
     void UpdateCostAnalysisData(absl::Time now, bool do_recompilation);
@@ -213,6 +220,10 @@ class GraphExecutor {
     std::optional<StreamCallbackId> stream_callback_id_;
     FunctionLibraryDefinition flib_def_;
     ProcessFunctionLibraryRuntime pflr_;
+
+    // The thread of the last background recompilation, joined before starting
+    // another one or destroying the members above.
+    std::unique_ptr<tsl::Thread> recompilation_thread_;
   };
 
   // A subgraph constructed by specifying input/output tensors.
@@ -243,6 +254,8 @@ class GraphExecutor {
                     graph_execution_state,
                 std::unique_ptr<mlrt::KernelRegistry> kernel_registry);
 
+  ~GraphExecutor();
+
   // Runs on the graph according to given input/output.
   tensorflow::Status Run(
       const RunOptions& run_options,
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/tfrt/mlrt/kernel/kernel.h"
 #include "tensorflow/core/tfrt/saved_model/saved_model_testutil.h"
 #include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
 #include "tfrt/cpp_tests/test_util.h"  // from @tf_runtime
@@ -55,6 +56,12 @@ class GraphExecutorForTestingCostAnalysis : public GraphExecutor {
     tensorflow::mutex_lock lock(num_recompilations_mu_);
     return num_recompilations_;
   }
+  // Waits until the number of recompilations reaches `n`.
+  void WaitForNumRecompilations(int n) {
+    while (num_recompilations() < n) {
+      tsl::Env::Default()->SleepForMicroseconds(1000);
+    }
+  }
   // This method is not thread safe.
   void AdvanceTime(absl::Duration duration) {
     simulated_duration_ = simulated_duration_ + duration;
@@ -331,6 +338,53 @@ TEST_P(GraphExecutorTest, OnlineCostAnalysisPeriodic) {
   EXPECT_EQ(graph_executor->num_recompilations(), 3);
 }
 
+TEST_P(GraphExecutorTest, OnlineCostAnalysisInBackground) {
+  GraphDef graph_def;
+  TF_ASSERT_OK(GetSimpleGraphDef(graph_def));
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  GraphExecutor::Options options(runtime.get());
+  options.cost_analysis_options.version =
+      GraphExecutionOptions::CostAnalysisOptions::kPeriodic;
+  options.cost_analysis_options.reset_interval = absl::ZeroDuration();
+  options.cost_analysis_options.updates_per_interval = 1;
+  options.cost_analysis_options.recompile_in_background = true;
+  options.enable_mlrt = GetParam();
+
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto fallback_state,
+      tensorflow::tfrt_stub::FallbackState::Create(
+          CreateDefaultSessionOptions(options), graph_def.library()));
+  auto resource_context = std::make_unique<tfrt::ResourceContext>();
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto graph_executor_base,
+      GraphExecutor::Create(std::move(options), std::move(fallback_state),
+                            std::move(resource_context), graph_def,
+                            GetKernelRegistry()));
+  auto graph_executor = std::unique_ptr<GraphExecutorForTestingCostAnalysis>(
+      static_cast<GraphExecutorForTestingCostAnalysis*>(
+          graph_executor_base.release()));
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<std::pair<std::string, tensorflow::Tensor>> inputs;
+  inputs.push_back({"input", CreateTfTensor<int32_t>(
+                                 /*shape=*/{1, 3}, /*data=*/{1, 1, 1})});
+
+  std::vector<tensorflow::Tensor> outputs;
+
+  // Each run initiates a recompilation once the previous one is done, and the
+  // following runs use the recompiled executable.
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(graph_executor->Run(/*run_options=*/{}, inputs,
+                                     /*output_tensor_names=*/{"rank"},
+                                     /*target_tensor_names=*/{}, &outputs));
+    ASSERT_EQ(outputs.size(), 1);
+    EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+                ::testing::ElementsAreArray({2}));
+    graph_executor->WaitForNumRecompilations(i + 1);
+  }
+}
+
 REGISTER_OP("TestCancel")
     .Input("x: T")
     .Output("z: T")
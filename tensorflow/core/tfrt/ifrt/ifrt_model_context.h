@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_MODEL_CONTEXT_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_MODEL_CONTEXT_H_
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -61,10 +62,20 @@ class IfrtModelContext {
     return shape_representation_fn_;
   }
 
+  // The maximum number of executables compiled for different input shapes
+  // that each program keeps. Unbounded if 0.
+  int64_t max_num_executables_per_program() const {
+    return max_num_executables_per_program_;
+  }
+  void set_max_num_executables_per_program(int64_t max_num_executables) {
+    max_num_executables_per_program_ = max_num_executables;
+  }
+
  private:
   std::shared_ptr<xla::ifrt::Client> client_;
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_ =
       tensorflow::IdentityShapeRepresentationFn();
+  int64_t max_num_executables_per_program_ = 0;
 
   std::vector<ServingExecutableRegistry::Handle> handles_;
 };
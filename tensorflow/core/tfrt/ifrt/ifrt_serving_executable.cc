@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
@@ -107,7 +109,8 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
 
     const auto it = ifrt_executables_.find(key);
     if (it != ifrt_executables_.end()) {
-      return it->second;
+      lru_keys_.splice(lru_keys_.begin(), lru_keys_, it->second.lru_position);
+      return it->second.executable;
     }
 
     // Only create promise and future when cache missed.
@@ -116,7 +119,15 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
     future = xla::ifrt::Future<
         absl::StatusOr<std::shared_ptr<xla::ifrt::LoadedExecutable>>>(promise);
 
-    ifrt_executables_.emplace(key, future);
+    lru_keys_.push_front(key);
+    ifrt_executables_.emplace(key, CachedExecutable{future, lru_keys_.begin()});
+    while (max_num_executables_ > 0 &&
+           static_cast<int64_t>(ifrt_executables_.size()) >
+               max_num_executables_) {
+      // In-flight executions keep their executable alive.
+      ifrt_executables_.erase(lru_keys_.back());
+      lru_keys_.pop_back();
+    }
   }
 
   LOG(INFO) << "Cache missed. Building executable";
@@ -144,16 +155,51 @@ IfrtServingExecutable::LookUpOrCreateExecutable(
   return future;
 }
 
+absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
+IfrtServingExecutable::GetOrConvertVariableArray(
+    int index, const tensorflow::Tensor& tensor) {
+  {
+    absl::MutexLock lock(&mutex_);
+    const auto it = variable_arrays_.find(index);
+    if (it != variable_arrays_.end() &&
+        it->second.tensor.dtype() == tensor.dtype() &&
+        it->second.tensor.shape() == tensor.shape() &&
+        it->second.tensor.data() == tensor.data()) {
+      return it->second.array;
+    }
+  }
+
+  TF_ASSIGN_OR_RETURN(auto single_array, ConvertTensorToArray(tensor));
+
+  absl::MutexLock lock(&mutex_);
+  variable_arrays_[index] = VariableArray{tensor, single_array};
+  return single_array;
+}
+
 absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
-    absl::Span<const tensorflow::Tensor> inputs) {
+    absl::Span<const tensorflow::Tensor> inputs,
+    absl::Span<const int> variable_arg_indices) {
   TF_ASSIGN_OR_RETURN(
       std::shared_ptr<xla::ifrt::LoadedExecutable> ifrt_executable,
       LookUpOrCreateExecutable(inputs).Await());
 
+  std::vector<bool> is_variable_arg(inputs.size(), false);
+  for (int index : variable_arg_indices) {
+    if (index < 0 || index >= inputs.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Variable arg index ", index, " is out of range [0, ",
+                       inputs.size(), ")"));
+    }
+    is_variable_arg[index] = true;
+  }
+
   std::vector<tsl::RCReference<xla::ifrt::Array>> args;
   args.reserve(inputs.size());
-  for (auto& tensor : inputs) {
-    TF_ASSIGN_OR_RETURN(auto single_array, ConvertTensorToArray(tensor));
+  for (int i = 0; i < inputs.size(); ++i) {
+    TF_ASSIGN_OR_RETURN(auto single_array,
+                        is_variable_arg[i]
+                            ? GetOrConvertVariableArray(i, inputs[i])
+                            : ConvertTensorToArray(inputs[i]));
     args.push_back(single_array);
   }
 
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_SERVING_EXECUTABLE_H_
 
+#include <cstdint>
+#include <list>
 #include <memory>
 #include <string>
 #include <utility>
@@ -49,12 +51,14 @@ class IfrtServingExecutable {
       absl::string_view model_name, absl::string_view signature_name,
       mlir::OwningOpRef<mlir::ModuleOp> module,
       std::shared_ptr<xla::ifrt::Client> client,
-      tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn)
+      tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn,
+      int64_t max_num_executables = 0)
       : model_name_(std::string(model_name)),
         signature_name_(std::string(signature_name)),
         module_(std::move(module)),
         ifrt_client_(std::move(client)),
-        shape_representation_fn_(std::move(shape_representation_fn)) {}
+        shape_representation_fn_(std::move(shape_representation_fn)),
+        max_num_executables_(max_num_executables) {}
 
   // Movable but not copyable.
   IfrtServingExecutable(IfrtServingExecutable&& other) = default;
@@ -65,15 +69,23 @@ class IfrtServingExecutable {
   absl::string_view model_name() const { return model_name_; }
   absl::string_view signature_name() const { return signature_name_; }
 
-  // Executes the computation.
+  // Executes the computation. The device arrays of the inputs at
+  // `variable_arg_indices`, read from variables, are kept for the next calls
+  // with the same tensors.
   absl::StatusOr<std::vector<tensorflow::Tensor>> Execute(
-      absl::Span<const tensorflow::Tensor> inputs);
+      absl::Span<const tensorflow::Tensor> inputs,
+      absl::Span<const int> variable_arg_indices = {});
 
   int num_executables() const {
     absl::MutexLock lock(&mutex_);
     return ifrt_executables_.size();
   }
 
+  int num_variable_arrays() const {
+    absl::MutexLock lock(&mutex_);
+    return variable_arrays_.size();
+  }
+
  private:
   // In memory cache key.
   struct Key {
@@ -103,14 +115,42 @@ class IfrtServingExecutable {
 
   tensorflow::XlaHelpers::ShapeRepresentationFn shape_representation_fn_;
 
+  // The maximum number of executables compiled for different input shapes
+  // that are kept, evicting the least recently used ones. Unbounded if 0.
+  int64_t max_num_executables_;
+
+  struct CachedExecutable {
+    xla::ifrt::Future<
+        absl::StatusOr<std::shared_ptr<xla::ifrt::LoadedExecutable>>>
+        executable;
+    std::list<Key>::iterator lru_position;
+  };
+
+  // The array of a variable, for as long as the variable holds `tensor`. The
+  // reference to its buffer makes the variable copy it on updates, so it is
+  // never updated in place while cached.
+  struct VariableArray {
+    tensorflow::Tensor tensor;
+    tsl::RCReference<xla::ifrt::Array> array;
+  };
+
   mutable absl::Mutex mutex_;
-  absl::flat_hash_map<Key, xla::ifrt::Future<absl::StatusOr<
-                               std::shared_ptr<xla::ifrt::LoadedExecutable>>>>
-      ifrt_executables_ ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<Key, CachedExecutable> ifrt_executables_
+      ABSL_GUARDED_BY(mutex_);
+  // The keys of `ifrt_executables_`, the most recently used first.
+  std::list<Key> lru_keys_ ABSL_GUARDED_BY(mutex_);
+  // The last array of each variable arg, by arg index.
+  absl::flat_hash_map<int, VariableArray> variable_arrays_
+      ABSL_GUARDED_BY(mutex_);
 
   absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> ConvertTensorToArray(
       const tensorflow::Tensor& tensor);
 
+  // Like ConvertTensorToArray(), but reuses the array of the variable arg at
+  // `index` if it holds the same tensor as in the previous call.
+  absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> GetOrConvertVariableArray(
+      int index, const tensorflow::Tensor& tensor);
+
   xla::ifrt::Future<
       absl::StatusOr<std::shared_ptr<xla::ifrt::LoadedExecutable>>>
   LookUpOrCreateExecutable(absl::Span<const tensorflow::Tensor> inputs);
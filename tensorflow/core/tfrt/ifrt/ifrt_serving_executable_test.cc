@@ -157,6 +157,115 @@ TEST(IfrtServingExecutableTest, MultipleShapes) {
   ASSERT_EQ(executable.num_executables(), 2);
 }
 
+TEST(IfrtServingExecutableTest, EvictsLeastRecentlyUsedExecutables) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtServingExecutable executable("test", "main", std::move(mlir_module),
+                                   client,
+                                   tensorflow::IdentityShapeRepresentationFn(),
+                                   /*max_num_executables=*/2);
+
+  auto make_inputs = [](int dim) {
+    tensorflow::Tensor x(tensorflow::DT_INT32,
+                         tensorflow::TensorShape({1, dim}));
+    tensorflow::Tensor y(tensorflow::DT_INT32,
+                         tensorflow::TensorShape({dim, 1}));
+    for (int i = 0; i < dim; ++i) {
+      x.flat<int32_t>()(i) = i + 1;
+      y.flat<int32_t>()(i) = i + 1;
+    }
+    return std::vector<tensorflow::Tensor>{x, y};
+  };
+
+  for (int dim : {3, 4, 3, 5, 3}) {
+    std::vector<tensorflow::Tensor> inputs = make_inputs(dim);
+    TF_ASSERT_OK_AND_ASSIGN(auto result,
+                            executable.Execute(absl::MakeSpan(inputs)));
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].flat<int32_t>()(0),
+              dim * (dim + 1) * (2 * dim + 1) / 6);
+    EXPECT_LE(executable.num_executables(), 2);
+  }
+  EXPECT_EQ(executable.num_executables(), 2);
+}
+
+TEST(IfrtServingExecutableTest, ReusesVariableArrays) {
+  // Create test input module
+  constexpr absl::string_view kDataDirectory =
+      "tensorflow/core/tfrt/ifrt/testdata";
+  std::string mlir_module_path = tensorflow::GetDataDependencyFilepath(
+      absl::StrCat(kDataDirectory, "/executable.mlir"));
+
+  mlir::DialectRegistry registry;
+  mlir::registerAllDialects(registry);
+  mlir::RegisterAllTensorFlowDialects(registry);
+
+  mlir::MLIRContext context(registry);
+
+  mlir::OwningOpRef<mlir::ModuleOp> mlir_module =
+      mlir::parseSourceFile<mlir::ModuleOp>(mlir_module_path, &context);
+
+  ASSERT_TRUE(mlir_module);
+
+  // Create contexts required for the compiler execution.
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<xla::ifrt::Client> client,
+                          xla::ifrt::test_util::GetClient());
+
+  IfrtServingExecutable executable("test", "main", std::move(mlir_module),
+                                   client,
+                                   tensorflow::IdentityShapeRepresentationFn());
+
+  tensorflow::Tensor x(tensorflow::DT_INT32, tensorflow::TensorShape({1, 3}));
+  tensorflow::Tensor y(tensorflow::DT_INT32, tensorflow::TensorShape({3, 1}));
+  tensorflow::Tensor new_y(tensorflow::DT_INT32,
+                           tensorflow::TensorShape({3, 1}));
+  for (int i = 0; i < 3; ++i) {
+    x.flat<int32_t>()(i) = i + 1;
+    y.flat<int32_t>()(i) = i + 1;
+    new_y.flat<int32_t>()(i) = 2 * (i + 1);
+  }
+
+  // `y` is read from a variable.
+  const std::vector<int> variable_arg_indices = {1};
+  std::vector<tensorflow::Tensor> inputs{x, y};
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(
+        auto result,
+        executable.Execute(absl::MakeSpan(inputs), variable_arg_indices));
+    ASSERT_EQ(result.size(), 1);
+    EXPECT_EQ(result[0].flat<int32_t>()(0), 14);
+    EXPECT_EQ(executable.num_variable_arrays(), 1);
+  }
+
+  // The variable is updated with a new tensor.
+  inputs[1] = new_y;
+  TF_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      executable.Execute(absl::MakeSpan(inputs), variable_arg_indices));
+  ASSERT_EQ(result.size(), 1);
+  EXPECT_EQ(result[0].flat<int32_t>()(0), 28);
+  EXPECT_EQ(executable.num_variable_arrays(), 1);
+}
+
 }  // namespace
 }  // namespace ifrt_serving
 }  // namespace tensorflow
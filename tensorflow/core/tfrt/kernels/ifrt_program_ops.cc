@@ -34,6 +34,8 @@ namespace tfrt_stub {
 
 IfrtCallOp::IfrtCallOp(tensorflow::OpKernelConstruction* ctx) : OpKernel(ctx) {
   OP_REQUIRES_OK(ctx, ctx->GetAttr("program_id", &program_id_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr("variable_arg_indices", &variable_arg_indices_));
 }
 
 void IfrtCallOp::Compute(tensorflow::OpKernelContext* ctx) {
@@ -51,7 +53,8 @@ void IfrtCallOp::Compute(tensorflow::OpKernelContext* ctx) {
     inputs.push_back(ctx->input(i));
   }
 
-  absl::StatusOr<std::vector<Tensor>> results = executable_->Execute(inputs);
+  absl::StatusOr<std::vector<Tensor>> results =
+      executable_->Execute(inputs, variable_arg_indices_);
   OP_REQUIRES(ctx, results.ok(), results.status());
 
   tensorflow::OpOutputList outputs(ctx, 0, results->size());
@@ -19,6 +19,7 @@ limitations under the License.
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "absl/base/call_once.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -40,6 +41,7 @@ class IfrtCallOp : public tensorflow::OpKernel {
  private:
   // Op attributes.
   int64_t program_id_;
+  std::vector<int> variable_arg_indices_;
 
   // Ifrt program to be called. Cached after the first call.
   absl::once_flag init_once_;
@@ -662,16 +662,24 @@ void CreateOp::Invoke() {
     return;
   }
 
-  auto runner = tfrt_stub::OpKernelRunner::Create(
-                    node_def.op(), node_def.name(), node_def.device(),
-                    node_def.input().size(),
-                    [&](tensorflow::AttrValueMap* attr_value_map) {
-                      *attr_value_map = node_def.attr();
-                      return OkStatus();
-                    },
-                    fallback_request_state.device_manager(),
-                    fallback_request_state.process_function_library_runtime())
-                    .value();
+  auto attr_builder = [&](tensorflow::AttrValueMap* attr_value_map) {
+    *attr_value_map = node_def.attr();
+    return OkStatus();
+  };
+  auto* shared_cache = fallback_request_state.shared_op_kernel_runner_cache();
+  auto runner =
+      (shared_cache != nullptr
+           ? shared_cache->GetOrCreate(
+                 node_def.op(), node_def.name(), node_def.device(),
+                 node_def.input().size(), attr_builder,
+                 fallback_request_state.device_manager(),
+                 fallback_request_state.process_function_library_runtime())
+           : tfrt_stub::OpKernelRunner::Create(
+                 node_def.op(), node_def.name(), node_def.device(),
+                 node_def.input().size(), attr_builder,
+                 fallback_request_state.device_manager(),
+                 fallback_request_state.process_function_library_runtime()))
+          .value();
 
   if (!fallback_request_state.runner_table()->Insert(op_key(),
                                                      std::move(runner))) {
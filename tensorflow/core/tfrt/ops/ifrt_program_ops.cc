@@ -25,6 +25,7 @@ REGISTER_OP("IfrtCall")
     .Attr("Tin: list(type) >= 0")
     .Attr("Tout: list(type) >= 0")
     .Attr("program_id: int")
+    .Attr("variable_arg_indices: list(int) = []")
     .SetIsStateful()
     .SetShapeFn(tensorflow::shape_inference::UnknownShape)
     .Doc(R"(
@@ -40,6 +41,8 @@ automatically inserts this op with graph rewrite.
 
 program_id: int64 id that can be used to look up compiled programs from
   `ServingExecutableRegistry`.
+variable_arg_indices: indices of the args read from variables, whose device
+  buffers are kept across calls as long as the variables are not updated.
 )");
 
 }  // namespace tfrt_stub
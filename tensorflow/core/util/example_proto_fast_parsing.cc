@@ -15,7 +15,9 @@ limitations under the License.
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -117,6 +119,37 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// Appends the varints in [begin, end) to `values` as int64s. Runs of eight
+// single-byte varints, which small ids and counts are encoded as, are detected
+// and decoded a word at a time.
+template <typename Result>
+bool ParsePackedVarints(const uint8* begin, const uint8* end, Result* values) {
+  constexpr uint64 kContinuationBits = 0x8080808080808080ULL;
+  const uint8* p = begin;
+  while (p < end) {
+    if (end - p >= sizeof(uint64)) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kContinuationBits) == 0) {
+        for (int i = 0; i < sizeof(word); ++i) {
+          values->push_back(static_cast<int64_t>(p[i]));
+        }
+        p += sizeof(word);
+        continue;
+      }
+    }
+    uint64 value = 0;
+    for (int shift = 0;; shift += 7) {
+      if (p == end || shift >= 64) return false;
+      const uint8 byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) break;
+    }
+    values->push_back(static_cast<int64_t>(value));
+  }
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -303,15 +336,21 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64_t>(n));
+        if (packed_length > 0) {
+          // The stream reads from a flat array, so all of the packed values
+          // are in its buffer unless the feature is truncated.
+          const void* data;
+          int size;
+          if (!stream.GetDirectBufferPointer(&data, &size) ||
+              static_cast<uint32>(size) < packed_length) {
+            return false;
+          }
+          const uint8* packed = static_cast<const uint8*>(data);
+          if (!ParsePackedVarints(packed, packed + packed_length, int64_list)) {
+            return false;
+          }
+          if (!stream.Skip(packed_length)) return false;
         }
-
-        stream.PopLimit(packed_limit);
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1131,23 +1170,36 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
 
 }  // namespace
 
-Status FastParseExample(const Config& config,
-                        gtl::ArraySlice<tstring> serialized,
-                        gtl::ArraySlice<tstring> example_names,
-                        thread::ThreadPool* thread_pool, Result* result) {
-  DCHECK(result != nullptr);
-  // Check config so we can safely CHECK(false) in switches on config.*.dtype
-  TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
+struct FastParseExampleConfigIndex::Rep {
+  explicit Rep(const Config& config)
+      : num_dense(config.dense.size()),
+        num_sparse(config.sparse.size()),
+        num_ragged(config.ragged.size()),
+        config_index(num_dense + num_sparse + num_ragged) {}
 
-  if (config.collect_feature_stats) {
-    result->feature_stats.resize(serialized.size());
-  }
+  // The number of features of each kind of the indexed config.
+  const size_t num_dense;
+  const size_t num_sparse;
+  const size_t num_ragged;
 
-  size_t config_size =
-      config.dense.size() + config.sparse.size() + config.ragged.size();
+  PresizedCuckooMap<std::pair<size_t, Type>> config_index;
   SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
+};
+
+FastParseExampleConfigIndex::FastParseExampleConfigIndex(
+    std::unique_ptr<const Rep> rep)
+    : rep_(std::move(rep)) {}
+
+FastParseExampleConfigIndex::~FastParseExampleConfigIndex() = default;
+
+Status FastParseExampleConfigIndex::Create(
+    const FastParseExampleConfig& config,
+    std::unique_ptr<const FastParseExampleConfigIndex>* index) {
+  TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
+  auto rep = std::make_unique<Rep>(config);
+  const size_t config_size = rep->num_dense + rep->num_sparse + rep->num_ragged;
+  PresizedCuckooMap<std::pair<size_t, Type>>& config_index = rep->config_index;
+  SeededHasher& hasher = rep->hasher;
   bool ok = true;
   for (size_t i = 0; i < 1000; ++i) {
     for (size_t d = 0; d < config.dense.size(); ++d) {
@@ -1173,6 +1225,44 @@ Status FastParseExample(const Config& config,
     return errors::Internal(
         "Could not avoid collision. This should not happen.");
   }
+  index->reset(new FastParseExampleConfigIndex(std::move(rep)));
+  return OkStatus();
+}
+
+bool FastParseExampleConfigIndex::Matches(
+    const FastParseExampleConfig& config) const {
+  return config.dense.size() == rep_->num_dense &&
+         config.sparse.size() == rep_->num_sparse &&
+         config.ragged.size() == rep_->num_ragged;
+}
+
+Status FastParseExample(const Config& config,
+                        gtl::ArraySlice<tstring> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  std::unique_ptr<const FastParseExampleConfigIndex> index;
+  TF_RETURN_IF_ERROR(FastParseExampleConfigIndex::Create(config, &index));
+  return FastParseExample(config, *index, serialized, example_names,
+                          thread_pool, result);
+}
+
+Status FastParseExample(const Config& config,
+                        const FastParseExampleConfigIndex& index,
+                        gtl::ArraySlice<tstring> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result) {
+  DCHECK(result != nullptr);
+  DCHECK(index.Matches(config));
+  // Check config so we can safely CHECK(false) in switches on config.*.dtype
+  TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
+  const PresizedCuckooMap<std::pair<size_t, Type>>& config_index =
+      index.rep().config_index;
+  const SeededHasher& hasher = index.rep().hasher;
+
+  if (config.collect_feature_stats) {
+    result->feature_stats.resize(serialized.size());
+  }
+
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse and ragged have to be buffered).
@@ -1447,9 +1537,21 @@ Status FastParseExample(const Config& config,
 
 Status FastParseSingleExample(const Config& config, StringPiece serialized,
                               Result* result) {
+  std::unique_ptr<const FastParseExampleConfigIndex> index;
+  TF_RETURN_IF_ERROR(FastParseExampleConfigIndex::Create(config, &index));
+  return FastParseSingleExample(config, *index, serialized, result);
+}
+
+Status FastParseSingleExample(const Config& config,
+                              const FastParseExampleConfigIndex& index,
+                              StringPiece serialized, Result* result) {
   DCHECK(result != nullptr);
+  DCHECK(index.Matches(config));
   // Check config so we can safely CHECK(false) in switches on config.*.dtype
   TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
+  const PresizedCuckooMap<std::pair<size_t, Type>>& config_index =
+      index.rep().config_index;
+  const SeededHasher& hasher = index.rep().hasher;
 
   PerExampleFeatureStats* stats = nullptr;
   if (config.collect_feature_stats) {
@@ -1457,37 +1559,6 @@ Status FastParseSingleExample(const Config& config, StringPiece serialized,
     stats = &result->feature_stats.back();
   }
 
-  // TODO(mrry): Cache the construction of this map at Op construction time.
-  size_t config_size =
-      config.dense.size() + config.sparse.size() + config.ragged.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    for (size_t d = 0; d < config.ragged.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.ragged[d].feature_name),
-                                      {d, Type::Ragged});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
 
   result->sparse_indices.reserve(config.sparse.size());
   result->sparse_values.reserve(config.sparse.size());
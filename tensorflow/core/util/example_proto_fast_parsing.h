@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 
 #include <string>
+#include <memory>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -114,6 +115,35 @@ struct PerExampleFeatureStats {
   size_t feature_values_count = 0;
 };
 
+// An index of the features of a FastParseExampleConfig by the hashes of their
+// names, which FastParse[Single]Example() use to look up the features of each
+// example. They build one per call unless they are passed one, so callers that
+// parse many batches with the same features should build it once instead.
+class FastParseExampleConfigIndex {
+ public:
+  // Defined in the .cc file.
+  struct Rep;
+
+  // Builds the index of the features of `config`.
+  static Status Create(
+      const FastParseExampleConfig& config,
+      std::unique_ptr<const FastParseExampleConfigIndex>* index);
+
+  ~FastParseExampleConfigIndex();
+
+  // Returns true if `config` has as many features of each kind as the config
+  // the index was built from. Parsing requires the same features, in the same
+  // order, but `collect_feature_stats` may differ.
+  bool Matches(const FastParseExampleConfig& config) const;
+
+  const Rep& rep() const { return *rep_; }
+
+ private:
+  explicit FastParseExampleConfigIndex(std::unique_ptr<const Rep> rep);
+
+  const std::unique_ptr<const Rep> rep_;
+};
+
 // This is exactly the output of TF's ParseExample Op.
 // Documentation is available in: tensorflow/core/ops/parsing_ops.cc
 struct Result {
@@ -139,12 +169,25 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<tstring> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
-// TODO(mrry): Move the hash table construction into the config object.
+// As above, with the index of the features of `config`, which must have been
+// built from the same features.
+Status FastParseExample(const FastParseExampleConfig& config,
+                        const FastParseExampleConfigIndex& index,
+                        gtl::ArraySlice<tstring> serialized,
+                        gtl::ArraySlice<tstring> example_names,
+                        thread::ThreadPool* thread_pool, Result* result);
+
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
 Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
                               StringPiece serialized, Result* result);
 
+// As above, with the index of the features of `config`, which must have been
+// built from the same features.
+Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
+                              const FastParseExampleConfigIndex& index,
+                              StringPiece serialized, Result* result);
+
 // Parses a batch of serialized SequenceExample protos and converts them into
 // result according to given config.
 // Given example names have to either be empty or the same size as serialized.
@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -255,6 +258,21 @@ static string ExampleWithSomeFeatures() {
 
 TEST(FastParse, SomeFeatures) { TestCorrectness(ExampleWithSomeFeatures()); }
 
+TEST(FastParse, PackedInt64s) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  // Runs of single-byte varints longer and shorter than a word, between
+  // multi-byte and negative values.
+  for (int i = 0; i < 19; ++i) int64_list->add_value(i * 5);
+  int64_list->add_value(300);
+  int64_list->add_value(-1);
+  for (int i = 0; i < 5; ++i) int64_list->add_value(127 - i);
+  int64_list->add_value(int64_t{1} << 62);
+  TestCorrectness(Serialize(example));
+}
+
 static void AddDenseFeature(const char* feature_name, DataType dtype,
                             PartialTensorShape shape, bool variable_length,
                             size_t elements_per_stride,
@@ -277,6 +295,44 @@ static void AddSparseFeature(const char* feature_name, DataType dtype,
   new_feature.dtype = dtype;
 }
 
+TEST(FastParse, WithConfigIndex) {
+  const size_t kNumExamples = 5;
+  std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("bytes_list", DT_STRING, {2}, false, 2, &config);
+  AddDenseFeature("int64_list", DT_INT64, {3}, false, 3, &config);
+  AddSparseFeature("float_list", DT_FLOAT, &config);
+  std::unique_ptr<const FastParseExampleConfigIndex> index;
+  TF_ASSERT_OK(FastParseExampleConfigIndex::Create(config, &index));
+  EXPECT_TRUE(index->Matches(config));
+
+  Result expected;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+  // The same index serves repeated calls.
+  for (int i = 0; i < 2; ++i) {
+    Result result;
+    TF_ASSERT_OK(
+        FastParseExample(config, *index, serialized, {}, nullptr, &result));
+    ASSERT_EQ(result.dense_values.size(), 2);
+    test::ExpectTensorEqual<tstring>(result.dense_values[0],
+                                     expected.dense_values[0]);
+    test::ExpectTensorEqual<int64_t>(result.dense_values[1],
+                                     expected.dense_values[1]);
+    test::ExpectTensorEqual<float>(result.sparse_values[0],
+                                   expected.sparse_values[0]);
+  }
+
+  Result single;
+  TF_ASSERT_OK(FastParseSingleExample(config, *index, serialized[0], &single));
+  test::ExpectTensorEqual<int64_t>(
+      single.dense_values[1], test::AsTensor<int64_t>({3, 270, 86942}, {3}));
+
+  FastParseExampleConfig other_config;
+  AddSparseFeature("float_list", DT_FLOAT, &other_config);
+  EXPECT_FALSE(index->Matches(other_config));
+}
+
 TEST(FastParse, StatsCollection) {
   const size_t kNumExamples = 13;
   std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
@@ -429,6 +485,109 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+// A ranking-like schema: many sparse id features, with few small ids each,
+// some dense scores and a few string features.
+constexpr int kNumIdFeatures = 150;
+constexpr int kNumScoreFeatures = 40;
+constexpr int kNumStringFeatures = 10;
+
+FastParseExampleConfig RankingConfig() {
+  FastParseExampleConfig config;
+  for (int i = 0; i < kNumIdFeatures; ++i) {
+    config.sparse.emplace_back(strings::StrCat("ids_", i), DT_INT64);
+  }
+  for (int i = 0; i < kNumScoreFeatures; ++i) {
+    config.dense.emplace_back(strings::StrCat("score_", i), DT_FLOAT,
+                              PartialTensorShape({1}),
+                              Tensor(DT_FLOAT, TensorShape({})),
+                              /*variable_length=*/false,
+                              /*elements_per_stride=*/1);
+  }
+  for (int i = 0; i < kNumStringFeatures; ++i) {
+    config.sparse.emplace_back(strings::StrCat("query_", i), DT_STRING);
+  }
+  return config;
+}
+
+tstring RankingExample(random::SimplePhilox* rng) {
+  Example example;
+  auto& features = *example.mutable_features()->mutable_feature();
+  for (int i = 0; i < kNumIdFeatures; ++i) {
+    Int64List* ids = features[strings::StrCat("ids_", i)].mutable_int64_list();
+    const int num_ids = rng->Uniform(16);
+    for (int j = 0; j < num_ids; ++j) {
+      // Mostly small vocabulary ids, and a few hashed ones.
+      ids->add_value(rng->OneIn(8) ? rng->Rand64() >> 1 : rng->Uniform(100));
+    }
+  }
+  for (int i = 0; i < kNumScoreFeatures; ++i) {
+    features[strings::StrCat("score_", i)].mutable_float_list()->add_value(
+        rng->RandFloat());
+  }
+  for (int i = 0; i < kNumStringFeatures; ++i) {
+    features[strings::StrCat("query_", i)].mutable_bytes_list()->add_value(
+        RandStr(rng));
+  }
+  return Serialize(example);
+}
+
+// Compares parsing batches of ranking examples with and without a config
+// index built beforehand.
+void BM_FastParseRankingExamples(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const bool with_index = state.range(1);
+  random::PhiloxRandom philox(42);
+  random::SimplePhilox rng(&philox);
+  std::vector<tstring> serialized;
+  for (int i = 0; i < batch_size; ++i) {
+    serialized.push_back(RankingExample(&rng));
+  }
+  const FastParseExampleConfig config = RankingConfig();
+  std::unique_ptr<const FastParseExampleConfigIndex> index;
+  TF_CHECK_OK(FastParseExampleConfigIndex::Create(config, &index));
+  for (auto s : state) {
+    Result result;
+    if (with_index) {
+      TF_CHECK_OK(
+          FastParseExample(config, *index, serialized, {}, nullptr, &result));
+    } else {
+      TF_CHECK_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * batch_size);
+}
+
+BENCHMARK(BM_FastParseRankingExamples)
+    ->ArgPair(1, false)
+    ->ArgPair(1, true)
+    ->ArgPair(32, false)
+    ->ArgPair(32, true)
+    ->ArgPair(256, false)
+    ->ArgPair(256, true);
+
+// Parsing single ranking examples, as the ParseSingleExample kernel does with
+// and without the index it now builds at construction.
+void BM_FastParseSingleRankingExample(::testing::benchmark::State& state) {
+  const bool with_index = state.range(0);
+  random::PhiloxRandom philox(42);
+  random::SimplePhilox rng(&philox);
+  const tstring serialized = RankingExample(&rng);
+  const FastParseExampleConfig config = RankingConfig();
+  std::unique_ptr<const FastParseExampleConfigIndex> index;
+  TF_CHECK_OK(FastParseExampleConfigIndex::Create(config, &index));
+  for (auto s : state) {
+    Result result;
+    if (with_index) {
+      TF_CHECK_OK(FastParseSingleExample(config, *index, serialized, &result));
+    } else {
+      TF_CHECK_OK(FastParseSingleExample(config, serialized, &result));
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_FastParseSingleRankingExample)->Arg(false)->Arg(true);
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
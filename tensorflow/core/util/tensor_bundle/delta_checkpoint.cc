@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_checkpoint.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_slice.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/batch_util.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+RowsSnapshot SnapshotRows(const Tensor& tensor,
+                          const DirtyRows::RowRanges& ranges) {
+  RowsSnapshot snapshot;
+  snapshot.full_shape = tensor.shape();
+  snapshot.ranges = ranges;
+  snapshot.rows.reserve(ranges.size());
+  for (const auto& [begin, end] : ranges) {
+    snapshot.rows.push_back(tensor::DeepCopy(tensor.Slice(begin, end)));
+  }
+  return snapshot;
+}
+
+RowsSnapshot SnapshotAllRows(const Tensor& tensor) {
+  RowsSnapshot snapshot;
+  snapshot.full_shape = tensor.shape();
+  snapshot.ranges.emplace_back(0, tensor.dims() > 0 ? tensor.dim_size(0) : 1);
+  snapshot.rows.push_back(tensor::DeepCopy(tensor));
+  return snapshot;
+}
+
+Status AddRows(BundleWriter* writer, absl::string_view key,
+               const RowsSnapshot& snapshot) {
+  if (snapshot.rows.size() == 1 &&
+      snapshot.rows[0].shape() == snapshot.full_shape) {
+    return writer->Add(key, snapshot.rows[0]);
+  }
+  for (size_t i = 0; i < snapshot.ranges.size(); ++i) {
+    TensorSlice slice(snapshot.full_shape.dims());
+    slice.set_start(0, snapshot.ranges[i].first);
+    slice.set_length(0, snapshot.ranges[i].second - snapshot.ranges[i].first);
+    TF_RETURN_IF_ERROR(
+        writer->AddSlice(key, snapshot.full_shape, slice, snapshot.rows[i]));
+  }
+  return OkStatus();
+}
+
+Status LookupWithDeltas(Env* env, absl::string_view base_prefix,
+                        absl::Span<const std::string> delta_prefixes,
+                        absl::string_view key, Tensor* val) {
+  {
+    BundleReader reader(env, base_prefix);
+    TF_RETURN_IF_ERROR(reader.status());
+    TF_RETURN_IF_ERROR(reader.Lookup(key, val));
+  }
+  for (const std::string& delta_prefix : delta_prefixes) {
+    BundleReader reader(env, delta_prefix);
+    TF_RETURN_IF_ERROR(reader.status());
+    if (!reader.Contains(key)) {
+      continue;
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(reader.LookupTensorShape(key, &shape));
+    if (shape != val->shape()) {
+      return errors::InvalidArgument(
+          "The shape of ", key, " in the delta checkpoint ", delta_prefix, ", ",
+          shape.DebugString(), ", differs from its shape in ", base_prefix,
+          ", ", val->shape().DebugString());
+    }
+    std::vector<TensorSlice> slices;
+    TF_RETURN_IF_ERROR(reader.LookupTensorSlices(key, &slices));
+    if (slices.empty()) {
+      TF_RETURN_IF_ERROR(reader.Lookup(key, val));
+      continue;
+    }
+    for (const TensorSlice& slice : slices) {
+      for (int d = 1; d < slice.dims(); ++d) {
+        if (!slice.IsFullAt(d)) {
+          return errors::InvalidArgument(
+              "The slices of ", key, " in the delta checkpoint ", delta_prefix,
+              " are not rows, got ", slice.DebugString());
+        }
+      }
+      TensorShape rows_shape;
+      TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &rows_shape));
+      if (rows_shape.num_elements() == 0) {
+        continue;
+      }
+      Tensor rows(val->dtype(), rows_shape);
+      TF_RETURN_IF_ERROR(reader.LookupSlice(key, slice, &rows));
+      TF_RETURN_IF_ERROR(batch_util::CopyContiguousSlices(
+          rows, /*src_offset=*/0, /*dst_offset=*/slice.start(0),
+          /*num_slices=*/rows_shape.dim_size(0), val));
+    }
+  }
+  return OkStatus();
+}
+
+bool DeltaCheckpointPolicy::ShouldWriteFull(int num_deltas,
+                                            int64_t num_dirty_rows,
+                                            int64_t num_rows) const {
+  return num_deltas >= max_deltas || num_dirty_rows < 0 ||
+         num_dirty_rows > max_dirty_fraction * num_rows;
+}
+
+}  // namespace tensorflow
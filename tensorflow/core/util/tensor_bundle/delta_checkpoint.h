@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Delta checkpoints of large variables, e.g. embedding tables, of which only
+// a few rows are updated between checkpoints.
+//
+// A delta checkpoint is a tensor bundle holding, for each variable, only the
+// rows updated since the previous checkpoint (as tracked by
+// `Var::EnableDirtyRowTracking()`), saved as slices of the full variable. A
+// variable is restored from the last full checkpoint and the delta checkpoints
+// written after it, applied in order:
+//
+//   // Under the variable lock, e.g. in the training loop.
+//   std::optional<DirtyRows::RowRanges> ranges = var->dirty_rows()->Take();
+//   RowsSnapshot snapshot = ranges.has_value()
+//       ? SnapshotRows(*var->tensor(), *ranges)
+//       : SnapshotAllRows(*var->tensor());
+//
+//   // Later, e.g. on a background thread, without blocking training.
+//   BundleWriter writer(Env::Default(), delta_prefix);
+//   TF_RETURN_IF_ERROR(AddRows(&writer, "var", snapshot));
+//   TF_RETURN_IF_ERROR(writer.Finish());
+//
+//   // On restore.
+//   Tensor var;
+//   TF_RETURN_IF_ERROR(LookupWithDeltas(Env::Default(), base_prefix,
+//                                       {delta_prefix}, "var", &var));
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_CHECKPOINT_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_CHECKPOINT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+
+// A copy of some of the rows (the slices in the first dimension) of a tensor,
+// which stays valid while the tensor is updated.
+struct RowsSnapshot {
+  TensorShape full_shape;
+  // The [begin, end) row ranges, in increasing order.
+  DirtyRows::RowRanges ranges;
+  // The rows of each range.
+  std::vector<Tensor> rows;
+};
+
+// Copies the rows of `ranges` of `tensor`. Only the copy must happen under the
+// lock of the variable of `tensor`, so that its rows can be written
+// asynchronously.
+RowsSnapshot SnapshotRows(const Tensor& tensor,
+                          const DirtyRows::RowRanges& ranges);
+
+// Copies all the rows of `tensor`.
+RowsSnapshot SnapshotAllRows(const Tensor& tensor);
+
+// Adds the rows of `snapshot` to `writer` under `key`, as slices of the full
+// tensor. Nothing is added if there are no rows, and the full tensor is added
+// as such if all its rows are.
+Status AddRows(BundleWriter* writer, absl::string_view key,
+               const RowsSnapshot& snapshot);
+
+// Reads the tensor of `key` from the full checkpoint `base_prefix`, and
+// applies the rows of the delta checkpoints `delta_prefixes` in order. The
+// delta checkpoints need not have all the keys of the full checkpoint.
+Status LookupWithDeltas(Env* env, absl::string_view base_prefix,
+                        absl::Span<const std::string> delta_prefixes,
+                        absl::string_view key, Tensor* val);
+
+// When to write a full checkpoint rather than a delta one, which bounds the
+// cost of restores, and the size of delta checkpoints when most rows change.
+struct DeltaCheckpointPolicy {
+  // The maximum number of delta checkpoints after a full checkpoint.
+  int max_deltas = 10;
+  // The fraction of the rows changed above which a delta checkpoint isn't
+  // worth it.
+  double max_dirty_fraction = 0.5;
+
+  // Returns whether to write a full checkpoint, after `num_deltas` delta
+  // checkpoints since the last full one, when `num_dirty_rows` of
+  // `num_rows` have changed, or all if `num_dirty_rows` is negative (see
+  // `DirtyRows::size()`).
+  bool ShouldWriteFull(int num_deltas, int64_t num_dirty_rows,
+                       int64_t num_rows) const;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_DELTA_CHECKPOINT_H_
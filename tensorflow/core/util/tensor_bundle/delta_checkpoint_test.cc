@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/delta_checkpoint.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
+
+namespace tensorflow {
+namespace {
+
+std::string Prefix(const std::string& prefix) {
+  return io::JoinPath(testing::TmpDir(), prefix);
+}
+
+TEST(DeltaCheckpointTest, RestoresDirtyRowsFromDeltas) {
+  core::RefCountPtr<Var> var(new Var(DT_FLOAT));
+  *var->tensor() = test::AsTensor<float>({0, 0, 1, 1, 2, 2, 3, 3, 4, 4},
+                                         TensorShape({5, 2}));
+  DirtyRows* dirty_rows = var->EnableDirtyRowTracking();
+  ASSERT_FALSE(dirty_rows->Take().has_value());  // Initially all dirty.
+  {
+    BundleWriter writer(Env::Default(), Prefix("base"));
+    TF_ASSERT_OK(AddRows(&writer, "var", SnapshotAllRows(*var->tensor())));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  // Updates rows 1 and 2, then row 4.
+  auto update = [&](int64_t row, float value) {
+    var->tensor()->matrix<float>()(row, 0) = value;
+    var->tensor()->matrix<float>()(row, 1) = value;
+    dirty_rows->Record(&row, 1);
+  };
+  update(1, 10);
+  update(2, 20);
+  std::optional<DirtyRows::RowRanges> ranges = dirty_rows->Take();
+  ASSERT_TRUE(ranges.has_value());
+  RowsSnapshot snapshot = SnapshotRows(*var->tensor(), *ranges);
+  update(2, 30);  // Not in the snapshot.
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta1"));
+    TF_ASSERT_OK(AddRows(&writer, "var", snapshot));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  update(4, 40);
+  ranges = dirty_rows->Take();
+  ASSERT_TRUE(ranges.has_value());
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta2"));
+    TF_ASSERT_OK(
+        AddRows(&writer, "var", SnapshotRows(*var->tensor(), *ranges)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  Tensor restored;
+  TF_ASSERT_OK(LookupWithDeltas(Env::Default(), Prefix("base"),
+                                {Prefix("delta1")}, "var", &restored));
+  test::ExpectTensorEqual<float>(
+      restored, test::AsTensor<float>({0, 0, 10, 10, 20, 20, 3, 3, 4, 4},
+                                      TensorShape({5, 2})));
+  TF_ASSERT_OK(LookupWithDeltas(Env::Default(), Prefix("base"),
+                                {Prefix("delta1"), Prefix("delta2")}, "var",
+                                &restored));
+  test::ExpectTensorEqual<float>(restored, *var->tensor());
+}
+
+TEST(DeltaCheckpointTest, DeltasMayMissKeys) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("base_with_b"));
+    TF_ASSERT_OK(writer.Add("a", test::AsTensor<int64_t>({1, 2})));
+    TF_ASSERT_OK(writer.Add("b", test::AsTensor<int64_t>({3, 4})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(Env::Default(), Prefix("delta_without_b"));
+    TF_ASSERT_OK(writer.Add("a", test::AsTensor<int64_t>({5, 6})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor restored;
+  TF_ASSERT_OK(LookupWithDeltas(Env::Default(), Prefix("base_with_b"),
+                                {Prefix("delta_without_b")}, "a", &restored));
+  test::ExpectTensorEqual<int64_t>(restored, test::AsTensor<int64_t>({5, 6}));
+  TF_ASSERT_OK(LookupWithDeltas(Env::Default(), Prefix("base_with_b"),
+                                {Prefix("delta_without_b")}, "b", &restored));
+  test::ExpectTensorEqual<int64_t>(restored, test::AsTensor<int64_t>({3, 4}));
+}
+
+TEST(DeltaCheckpointTest, Policy) {
+  DeltaCheckpointPolicy policy;
+  policy.max_deltas = 2;
+  policy.max_dirty_fraction = 0.5;
+  EXPECT_FALSE(policy.ShouldWriteFull(0, 10, 100));
+  EXPECT_TRUE(policy.ShouldWriteFull(2, 10, 100));
+  EXPECT_TRUE(policy.ShouldWriteFull(0, 60, 100));
+  EXPECT_TRUE(policy.ShouldWriteFull(0, -1, 100));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -20,9 +20,12 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
@@ -41,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
@@ -82,6 +86,31 @@ const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
 
 namespace {
 
+// Appends the representation of the string length "length" covered by the
+// length checksum to "checksummed_lengths": its uint32 bytes when it fits,
+// because older checkpoints only used uint32s and we should still support
+// them, and its uint64 bytes otherwise.  The lengths of a tensor are gathered
+// this way and checksummed with a single crc32c::Extend() call, which keeps the
+// accelerated crc32c on its wide path instead of one tiny call per element.
+void AppendChecksummedLength(uint64 length, bool need_to_swap_bytes,
+                             string* checksummed_lengths) {
+  if (length <= UINT32_MAX) {
+    uint32 length_uint32 = static_cast<uint32>(length);
+    if (need_to_swap_bytes) {
+      // Checksum would have been computed on the source machine's byte order
+      length_uint32 = BYTE_SWAP_32(length_uint32);
+    }
+    checksummed_lengths->append(reinterpret_cast<const char*>(&length_uint32),
+                                sizeof(uint32));
+  } else {
+    if (need_to_swap_bytes) {
+      length = BYTE_SWAP_64(length);
+    }
+    checksummed_lengths->append(reinterpret_cast<const char*>(&length),
+                                sizeof(uint64));
+  }
+}
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -97,29 +126,15 @@ Status ReadStringTensor(io::InputBuffer* buffered_file, size_t num_elements,
   TF_RETURN_IF_ERROR(buffered_file->Seek(offset));
   TF_RETURN_IF_ERROR(buffered_file->Hint(size));
   std::vector<uint64> string_lengths(num_elements);
+  string checksummed_lengths;
+  checksummed_lengths.reserve(num_elements * sizeof(uint32));
   for (size_t i = 0; i < num_elements; ++i) {
     TF_RETURN_IF_ERROR(buffered_file->ReadVarint64(&string_lengths[i]));
-    if (string_lengths[i] <= UINT32_MAX) {
-      // We need to do this because older checkpoints only used uint32s and we
-      // should still support them.
-      uint32 elem_size_uint32 = static_cast<uint32>(string_lengths[i]);
-      if (need_to_swap_bytes) {
-        // Checksum would have been computed on the source machine's byte order
-        elem_size_uint32 = BYTE_SWAP_32(elem_size_uint32);
-      }
-      *actual_crc32c = crc32c::Extend(
-          *actual_crc32c, reinterpret_cast<const char*>(&elem_size_uint32),
-          sizeof(uint32));
-    } else {
-      uint64 length = string_lengths[i];
-      if (need_to_swap_bytes) {
-        length = BYTE_SWAP_64(length);
-      }
-      *actual_crc32c =
-          crc32c::Extend(*actual_crc32c, reinterpret_cast<const char*>(&length),
-                         sizeof(uint64));
-    }
+    AppendChecksummedLength(string_lengths[i], need_to_swap_bytes,
+                            &checksummed_lengths);
   }
+  *actual_crc32c = crc32c::Extend(*actual_crc32c, checksummed_lengths.data(),
+                                  checksummed_lengths.size());
   if (offset + size < buffered_file->Tell()) {
     return errors::DataLoss("String lengths longer than expected offset ",
                             offset + size);
@@ -270,25 +285,19 @@ Status WriteStringTensor(const Tensor& val, tsl::BufferedWritableFile* out,
   // Writes the varint lengths.
   string lengths;
   lengths.reserve(val.NumElements());  // At least 1 byte per element.
-  *crc32c = 0;
+  string checksummed_lengths;
+  checksummed_lengths.reserve(val.NumElements() * sizeof(uint32));
   for (int64_t i = 0; i < val.NumElements(); ++i) {
     const tstring* elem = &strings[i];
     DCHECK_EQ(elem->size(), static_cast<uint64>(elem->size()));
     const uint64 elem_size = static_cast<uint64>(elem->size());
 
     core::PutVarint64(&lengths, elem_size);
-    if (elem_size <= UINT32_MAX) {
-      // We need to do this because older checkpoints only used uint32s and we
-      // should still support them.
-      const uint32 elem_size_uint32 = static_cast<uint32>(elem_size);
-      *crc32c = crc32c::Extend(*crc32c,
-                               reinterpret_cast<const char*>(&elem_size_uint32),
-                               sizeof(uint32));
-    } else {
-      *crc32c = crc32c::Extend(
-          *crc32c, reinterpret_cast<const char*>(&elem_size), sizeof(uint64));
-    }
+    AppendChecksummedLength(elem_size, /*need_to_swap_bytes=*/false,
+                            &checksummed_lengths);
   }
+  *crc32c = crc32c::Value(checksummed_lengths.data(),
+                          checksummed_lengths.size());
   TF_RETURN_IF_ERROR(out->Append(lengths));
   *bytes_written = lengths.size();
 
@@ -425,14 +434,17 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
+    : env_(env), options_(options), prefix_(prefix) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
+  if (options_.num_data_files < 1) {
+    status_ = errors::InvalidArgument("num_data_files must be positive, got ",
+                                      options_.num_data_files);
+    return;
+  }
 
-  data_path_ = DataFilename(prefix_, 0, 1);
   metadata_path_ = MetaFilename(prefix_);
   if (use_temp_file_) {
-    data_path_ = strings::StrCat(data_path_, ".tempstate", random::New64());
     metadata_path_ =
         strings::StrCat(metadata_path_, ".tempstate", random::New64());
   }
@@ -442,13 +454,53 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::make_unique<tsl::BufferedWritableFile>(
-      std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+  const bool write_in_background =
+      options_.num_data_files > 1 || options_.snapshot_tensors;
+  for (int i = 0; i < options_.num_data_files; ++i) {
+    auto file = std::make_unique<DataFile>();
+    // The final name depends on the number of files used, known by Finish().
+    file->path = strings::StrCat(DataFilename(prefix_, i, 1), ".tempstate",
+                                 random::New64());
+    if (options_.num_data_files == 1) {
+      file->path = DataFilename(prefix_, 0, 1);
+      if (use_temp_file_) {
+        file->path = strings::StrCat(file->path, ".tempstate", random::New64());
+      }
+    }
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(file->path, &wrapper);
+    if (!status_.ok()) return;
+    file->out = std::make_unique<tsl::BufferedWritableFile>(
+        std::move(wrapper), 8 << 20 /* 8MB write buffer */);
+    if (write_in_background) {
+      file->writer = std::make_unique<thread::ThreadPool>(
+          env_, strings::StrCat("bundle_writer_", i), 1);
+    }
+    VLOG(1) << "Writing to file " << file->path;
+    data_files_.push_back(std::move(file));
+  }
+}
 
-  VLOG(1) << "Writing to file " << data_path_;
+Status BundleWriter::WriteEntry(const Tensor& val, DataFile* file,
+                                BundleEntryProto* entry) {
+  entry->set_offset(file->size);
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  file->out->reset_crc32();
+  if (val.dtype() == DT_STRING) {
+    TF_RETURN_IF_ERROR(
+        WriteStringTensor(val, file->out.get(), &data_bytes_written, &crc32c));
+  } else if (val.dtype() == DT_VARIANT) {
+    TF_RETURN_IF_ERROR(
+        WriteVariantTensor(val, file->out.get(), &data_bytes_written, &crc32c));
+  } else {
+    TF_RETURN_IF_ERROR(WriteTensor(val, file->out.get(), &data_bytes_written));
+    crc32c = file->out->crc32();
+  }
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  file->size += data_bytes_written;
+  return PadAlignment(file->out.get(), options_.data_alignment, &file->size);
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
@@ -463,29 +515,29 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
 
-  // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->reset_crc32();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32();
+  // Picks the data file with the fewest bytes added so far.
+  int shard_id = 0;
+  for (int i = 1; i < data_files_.size(); ++i) {
+    if (data_files_[i]->num_bytes < data_files_[shard_id]->num_bytes) {
+      shard_id = i;
+    }
   }
+  DataFile* file = data_files_[shard_id].get();
+  entry->set_shard_id(shard_id);
+  ++file->num_entries;
+  file->num_bytes += val.TotalBytes();
 
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+  if (file->writer == nullptr) {
+    status_ = WriteEntry(val, file, entry);
+    return status_;
   }
-  return status_;
+  // Only the file's writer thread accesses "file" and "entry" until Finish().
+  Tensor data = options_.snapshot_tensors ? tensor::DeepCopy(val) : val;
+  file->writer->Schedule([this, data = std::move(data), file, entry]() {
+    if (file->status.ok()) file->status = WriteEntry(data, file, entry);
+  });
+  return OkStatus();
 }
 
 Status BundleWriter::AddSlice(StringPiece full_tensor_key,
@@ -532,19 +584,46 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
-    if (status_.ok()) {
-      if (use_temp_file_) {
-        status_ =
-            Env::Default()->RenameFile(data_path_, DataFilename(prefix_, 0, 1));
-      }
+  // Waits for the background writes.
+  for (auto& file : data_files_) file->writer.reset();
+  // Drops the empty data files, except the first one so that every bundle has
+  // a data file, and renumbers the others.
+  std::vector<int> shard_ids(data_files_.size(), -1);
+  int num_shards = 0;
+  for (int i = 0; i < data_files_.size(); ++i) {
+    DataFile* file = data_files_[i].get();
+    if (file->out == nullptr) continue;
+    status_.Update(file->status);
+    status_.Update(file->out->Close());
+    file->out = nullptr;
+    if (i == 0 || file->num_entries > 0) {
+      shard_ids[i] = num_shards++;
     } else {
-      Env::Default()->DeleteFile(data_path_).IgnoreError();
+      Env::Default()->DeleteFile(file->path).IgnoreError();
     }
   }
-  if (!status_.ok()) return status_;
+  for (int i = 0; i < data_files_.size() && status_.ok(); ++i) {
+    const DataFile* file = data_files_[i].get();
+    if (shard_ids[i] < 0) continue;
+    const string path = DataFilename(prefix_, shard_ids[i], num_shards);
+    if (file->path != path) {
+      status_ = Env::Default()->RenameFile(file->path, path);
+    }
+  }
+  if (!status_.ok()) {
+    for (const auto& file : data_files_) {
+      Env::Default()->DeleteFile(file->path).IgnoreError();
+    }
+    return status_;
+  }
+  if (num_shards < data_files_.size()) {
+    for (auto& p : entries_) {
+      if (p.second.slices().empty()) {
+        p.second.set_shard_id(shard_ids[p.second.shard_id()]);
+      }
+    }
+  }
+  data_files_.clear();
   // Build key -> BundleEntryProto table.
   std::unique_ptr<WritableFile> file;
   status_ = env_->NewWritableFile(metadata_path_, &file);
@@ -557,7 +636,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_shards);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -1024,6 +1103,136 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+namespace {
+
+// A TensorBuffer that points into a memory-mapped data file, and keeps the
+// mapping alive.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const void* data, size_t size)
+      : TensorBuffer(const_cast<void*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("tensor_bundle_mmap");
+  }
+  // The memory belongs to the mapping, and is read-only.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Returns a mapping of the data file "filename", shared by all the readers of
+// the process, so that restoring each tensor with its own reader (as RestoreOp
+// does) maps each file once rather than once per tensor. A mapping is reused
+// while any tensor backed by it is live, and as long as the file has not been
+// rewritten since it was mapped.
+Status GetSharedMemoryRegion(Env* env, const string& filename,
+                             std::shared_ptr<ReadOnlyMemoryRegion>* region) {
+  struct SharedRegion {
+    std::weak_ptr<ReadOnlyMemoryRegion> region;
+    int64_t mtime_nsec;
+    int64_t length;
+  };
+  static mutex* mu = new mutex;
+  static auto* shared_regions =
+      new absl::flat_hash_map<std::pair<Env*, string>, SharedRegion>;
+
+  FileStatistics stat;
+  TF_RETURN_IF_ERROR(env->Stat(filename, &stat));
+  mutex_lock l(*mu);
+  auto it = shared_regions->find(std::make_pair(env, filename));
+  if (it != shared_regions->end() &&
+      it->second.mtime_nsec == stat.mtime_nsec &&
+      it->second.length == stat.length) {
+    *region = it->second.region.lock();
+    if (*region != nullptr) return OkStatus();
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> new_region;
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &new_region));
+  *region = std::move(new_region);
+  // Drop the entries of files whose mappings are no longer used.
+  absl::erase_if(*shared_regions, [](const auto& entry) {
+    return entry.second.region.expired();
+  });
+  (*shared_regions)[std::make_pair(env, filename)] =
+      SharedRegion{*region, stat.mtime_nsec, stat.length};
+  return OkStatus();
+}
+
+}  // namespace
+
+Status BundleReader::LookupMapped(StringPiece key, Tensor* val,
+                                  bool verify_checksum) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_) {
+    *val = Tensor(entry.dtype(), shape);
+    return Lookup(key, val);
+  }
+
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::shared_ptr<ReadOnlyMemoryRegion> region;
+    Status s = GetSharedMemoryRegion(
+        env_, DataFilename(prefix_, entry.shard_id(), num_shards_), &region);
+    if (!s.ok()) {
+      VLOG(1) << "Copying tensors of shard " << entry.shard_id() << " of "
+              << prefix_ << ", which cannot be mapped: " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  const char* data =
+      region == nullptr
+          ? nullptr
+          : static_cast<const char*>(region->data()) + entry.offset();
+  if (data == nullptr ||
+      reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    *val = Tensor(entry.dtype(), shape);
+    return GetValue(entry, val);
+  }
+  if (entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), " is truncated: entry ", key,
+                            " ends at ", entry.offset() + entry.size(),
+                            " but the file has ", region->length(), " bytes");
+  }
+  const size_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (verify_checksum) {
+    const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the mapped bytes ", actual_crc32c);
+    }
+  }
+  core::RefCountPtr<TensorBuffer> buffer(
+      new MappedTensorBuffer(region, data, entry.size()));
+  *val = Tensor(entry.dtype(), shape, std::move(buffer));
+  return OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -1198,6 +1407,15 @@ Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   return LookupDtypeAndShape(key, &ignored, shape);
 }
 
+Status BundleReader::LookupChecksum(StringPiece key, uint32* crc32c,
+                                    int64_t* size) {
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  *crc32c = entry.crc32c();
+  *size = entry.size();
+  return OkStatus();
+}
+
 string BundleReader::DebugString() {
   // Format used below emulates that of TensorSliceReader::DebugString().
   string shape_str;
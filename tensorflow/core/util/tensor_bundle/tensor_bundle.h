@@ -84,6 +84,7 @@ limitations under the License.
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/tstring.h"
 #include "tensorflow/core/protobuf/tensor_bundle.pb.h"
 #include "tensorflow/core/util/tensor_slice_set.h"
@@ -119,6 +120,17 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files to spread the tensors over, each added tensor
+    // going to the file with the fewest bytes so far. If greater than 1, the
+    // files are written concurrently, one thread each, and Add() returns
+    // before the tensor is written, so the contents of the tensors added must
+    // not change until Finish() returns (unless "snapshot_tensors" is set).
+    // Files left empty are not part of the bundle.
+    int num_data_files{1};
+    // If true, Add() copies the tensor and writes the copy in the
+    // background, so that the caller may modify the tensor as soon as Add()
+    // returns.
+    bool snapshot_tensors{false};
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
@@ -153,15 +165,31 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  struct DataFile {
+    std::string path;
+    std::unique_ptr<tsl::BufferedWritableFile> out;
+    int64_t size = 0;  // Number of bytes written into out.
+    Status status;
+    // Writes the tensors in the background, if any.
+    std::unique_ptr<thread::ThreadPool> writer;
+    // Number of entries and bytes added, for balancing the files.
+    int64_t num_entries = 0;
+    int64_t num_bytes = 0;
+  };
+
+  // Appends "val" to "file", and records where in "entry".
+  Status WriteEntry(const Tensor& val, DataFile* file,
+                    BundleEntryProto* entry);
+
   Env* const env_;  // Not owned.
   const Options options_;
   const std::string prefix_;
   std::string metadata_path_;
-  std::string data_path_;
   bool use_temp_file_;
-  std::unique_ptr<tsl::BufferedWritableFile> out_;
-  int64_t size_;  // Number of bytes written into out_.
   std::map<std::string, BundleEntryProto> entries_;
+  // Destroyed first, so that the background writes complete before
+  // "entries_" goes away.
+  std::vector<std::unique_ptr<DataFile>> data_files_;
   Status status_;
 
   BundleWriter(const BundleWriter&) = delete;
@@ -237,6 +265,14 @@ class BundleReader {
   Status LookupTensorShape(absl::string_view key,
                            TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the crc32c checksum and the size in bytes of the contents of the
+  // tensor keyed by "key", as stored in the index, without reading the
+  // contents. E.g. to tell which tensors changed between two versions of a
+  // checkpoint.
+  // REQUIRES: status().ok()
+  Status LookupChecksum(absl::string_view key, uint32* crc32c,
+                        int64_t* size) TF_MUST_USE_RESULT;
+
   // Looks up the tensor keyed by "key".  If "key" refers to a partitioned
   // tensor, attempts to look up the full contents using all stored slices.
   //
@@ -251,6 +287,27 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(absl::string_view key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup(), but sets "val" to a tensor backed directly by the
+  // memory-mapped data file instead of a copy, if the tensor keyed by "key"
+  // is stored whole, has a memcpy-able dtype, needs no byte swapping, is
+  // aligned in the data file (see BundleWriter::Options::data_alignment), and
+  // the file system supports ReadOnlyMemoryRegion. Otherwise sets "val" to a
+  // newly allocated copy, like Lookup().
+  //
+  // Mapped tensors do not own their memory, so kernels never update them in
+  // place (see Tensor::RefCountIsOne()) and copy them on their first write.
+  // The mapping lives as long as any tensor backed by it, so mapped tensors
+  // may outlive the reader, and the mapped pages are shared with every other
+  // process that maps the same file. Within a process, all readers share one
+  // mapping per data file while it is in use.
+  //
+  // If "verify_checksum" is false, the stored crc32c checksum of mapped
+  // tensors is not validated, so their pages are not read until they are
+  // used.
+  // REQUIRES: status().ok()
+  Status LookupMapped(absl::string_view key, Tensor* val,
+                      bool verify_checksum = true) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -327,6 +384,11 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
+  // The memory-mapped data files, populated by LookupMapped() on demand and
+  // shared with the other readers of the same files. Null for a shard that
+  // could not be mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -1148,6 +1148,160 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+TEST(TensorBundleTest, LookupChecksum) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("checksum"));
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("c", Constant_2x3<float>(2.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("checksum"));
+  TF_ASSERT_OK(reader.status());
+  uint32 crc32c_a, crc32c_b, crc32c_c;
+  int64_t size;
+  TF_ASSERT_OK(reader.LookupChecksum("a", &crc32c_a, &size));
+  EXPECT_EQ(size, 6 * sizeof(float));
+  TF_ASSERT_OK(reader.LookupChecksum("b", &crc32c_b, &size));
+  TF_ASSERT_OK(reader.LookupChecksum("c", &crc32c_c, &size));
+  EXPECT_EQ(crc32c_a, crc32c_b);
+  EXPECT_NE(crc32c_a, crc32c_c);
+  EXPECT_TRUE(
+      errors::IsNotFound(reader.LookupChecksum("missing", &crc32c_a, &size)));
+}
+
+TEST(TensorBundleTest, LookupMapped) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("small", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("big", Constant_100x100<float>(3)));
+    TF_EXPECT_OK(writer.Add("str", Constant<tstring>("x", TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor big, str;
+  {
+    BundleReader reader(Env::Default(), Prefix("mapped"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped("big", &big));
+    TF_ASSERT_OK(reader.LookupMapped("str", &str));
+    EXPECT_TRUE(errors::IsNotFound(reader.LookupMapped("missing", &big)));
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(big, Constant_100x100<float>(3));
+  // Mapped tensors do not own their memory, so they are never updated in
+  // place.
+  EXPECT_FALSE(big.RefCountIsOne());
+  // Tensors that cannot be mapped are copied.
+  test::ExpectTensorEqual<tstring>(str,
+                                   Constant<tstring>("x", TensorShape({2})));
+  EXPECT_TRUE(str.RefCountIsOne());
+}
+
+TEST(TensorBundleTest, LookupMappedSharesMappingsBetweenReaders) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = 64;
+    BundleWriter writer(Env::Default(), Prefix("shared_mapping"), opts);
+    TF_EXPECT_OK(writer.Add("a", Constant_100x100<float>(1)));
+    TF_EXPECT_OK(writer.Add("b", Constant_100x100<float>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Restores each tensor with its own reader, as RestoreOp does.
+  auto lookup = [](const string& key, Tensor* val) {
+    BundleReader reader(Env::Default(), Prefix("shared_mapping"));
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.LookupMapped(key, val));
+  };
+  Tensor a, b, a_again;
+  lookup("a", &a);
+  lookup("b", &b);
+  lookup("a", &a_again);
+  test::ExpectTensorEqual<float>(a, Constant_100x100<float>(1));
+  test::ExpectTensorEqual<float>(b, Constant_100x100<float>(2));
+  // All the tensors point into the same mapping of the data file, where "b"
+  // directly follows "a".
+  EXPECT_EQ(a.tensor_data().data(), a_again.tensor_data().data());
+  EXPECT_EQ(a.tensor_data().data() + a.TotalBytes(), b.tensor_data().data());
+}
+
+TEST(TensorBundleTest, LookupMappedCopiesUnalignedTensors) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("unaligned"));
+    TF_EXPECT_OK(writer.Add("small", Constant(true, TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("big", Constant_100x100<float>(3)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("unaligned"));
+  TF_ASSERT_OK(reader.status());
+  Tensor big;
+  TF_ASSERT_OK(reader.LookupMapped("big", &big));
+  test::ExpectTensorEqual<float>(big, Constant_100x100<float>(3));
+  EXPECT_TRUE(big.RefCountIsOne());
+}
+
+TEST(TensorBundleTest, MultipleDataFiles) {
+  {
+    BundleWriter::Options opts;
+    opts.num_data_files = 4;
+    BundleWriter writer(Env::Default(), Prefix("multi"), opts);
+    for (int i = 0; i < 6; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("foo_", i),
+                              Constant_100x100<float>(i)));
+    }
+    TF_EXPECT_OK(writer.Add("str", Constant<tstring>("x", TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(
+        Env::Default()->FileExists(DataFilename(Prefix("multi"), i, 4)));
+  }
+  BundleReader reader(Env::Default(), Prefix("multi"));
+  TF_ASSERT_OK(reader.status());
+  for (int i = 0; i < 6; ++i) {
+    Expect<float>(&reader, strings::StrCat("foo_", i),
+                  Constant_100x100<float>(i));
+  }
+  Expect<tstring>(&reader, "str", Constant<tstring>("x", TensorShape({2})));
+}
+
+TEST(TensorBundleTest, MultipleDataFilesDropsEmptyFiles) {
+  {
+    BundleWriter::Options opts;
+    opts.num_data_files = 4;
+    BundleWriter writer(Env::Default(), Prefix("few"), opts);
+    TF_EXPECT_OK(writer.Add("foo_0", Constant_2x3<float>(0)));
+    TF_EXPECT_OK(writer.Add("foo_1", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  std::vector<string> files;
+  TF_ASSERT_OK(
+      Env::Default()->GetMatchingPaths(Prefix("few") + ".data*", &files));
+  EXPECT_EQ(files.size(), 2);
+  TF_EXPECT_OK(Env::Default()->FileExists(DataFilename(Prefix("few"), 1, 2)));
+  BundleReader reader(Env::Default(), Prefix("few"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo_0", Constant_2x3<float>(0));
+  Expect<float>(&reader, "foo_1", Constant_2x3<float>(1));
+}
+
+TEST(TensorBundleTest, SnapshotTensors) {
+  {
+    BundleWriter::Options opts;
+    opts.snapshot_tensors = true;
+    BundleWriter writer(Env::Default(), Prefix("snapshot"), opts);
+    Tensor val = Constant_100x100<float>(1);
+    TF_EXPECT_OK(writer.Add("foo", val));
+    // The tensor may be modified as soon as Add() returns.
+    val.flat<float>().setConstant(2);
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("snapshot"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "foo", Constant_100x100<float>(1));
+}
+
 class TensorBundleAlignmentTest : public ::testing::Test {
  protected:
   template <typename T>
@@ -1252,4 +1406,28 @@ static void BM_BundleWriterLargeTensor(::testing::benchmark::State& state) {
 BENCHMARK(BM_BundleWriterLargeTensor)->Arg(1 << 10);
 BENCHMARK(BM_BundleWriterLargeTensor)->Arg(4 << 10);
 
+static void BM_BundleStringTensor(::testing::benchmark::State& state) {
+  const int64_t num_elements = state.range(0);
+  Tensor t(DT_STRING, TensorShape{num_elements});
+  auto t_flat = t.flat<tstring>();
+  for (int64_t i = 0; i < num_elements; ++i) {
+    t_flat(i) = strings::StrCat("string_", i);
+  }
+  const string prefix = Prefix("strings");
+  for (auto s : state) {
+    {
+      BundleWriter writer(Env::Default(), prefix);
+      TF_CHECK_OK(writer.Add("strings", t));
+      TF_CHECK_OK(writer.Finish());
+    }
+    BundleReader reader(Env::Default(), prefix);
+    Tensor restored;
+    TF_CHECK_OK(reader.Lookup("strings", &restored));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_elements);
+}
+
+BENCHMARK(BM_BundleStringTensor)->Range(1, 1 << 20);
+
 }  // namespace tensorflow
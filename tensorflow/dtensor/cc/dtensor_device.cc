@@ -1843,6 +1843,9 @@ void DTensorDevice::ExecuteMultiDeviceOperation(
     const std::vector<TensorWithLayoutTf*>& inputs,
     std::vector<std::unique_ptr<TensorWithLayout>>& outputs,
     TF_Status* status) {
+  profiler::TraceMe activity(
+      [&] { return "DTensorDevice::ExecuteMultiDeviceOperation"; },
+      profiler::TraceMeLevel::kInfo);
   std::vector<TFE_TensorHandle*> eager_inputs;
   for (TensorWithLayoutTf* input : inputs) {
     std::vector<TFE_TensorHandle*> tensors(input->tensors());
@@ -2107,31 +2110,6 @@ void DTensorDevice::ExecuteRegularOperation(
     inputs_tf.push_back(llvm::cast<TensorWithLayoutTf>(input));
   }
 
-  // Extract the global parallel inputs and flatten SparseTensors
-  // into the three component tensors.
-  std::vector<std::vector<TFE_TensorHandle*>> global_parallel_inputs;
-  std::vector<std::vector<TFE_TensorHandle*>> global_parallel_sparse_inputs;
-  absl::flat_hash_set<int> global_sparse_input_indices;
-  for (auto input : inputs_tf) {
-    if (auto* sparse_input = llvm::dyn_cast<SparseTensorWithLayout>(input);
-        sparse_input) {
-      global_parallel_sparse_inputs.emplace_back(
-          sparse_input->indices()->tensors());
-      global_parallel_sparse_inputs.emplace_back(
-          sparse_input->dense_shapes()->tensors());
-      global_parallel_sparse_inputs.emplace_back(
-          sparse_input->values()->tensors());
-    } else {
-      global_parallel_inputs.push_back(input->tensors());
-    }
-  }
-  // Insert SparseTensor components to the end, this is because
-  // in the MLIR handling of SparseTensors, we place SparseTensor components
-  // to the end of the main func arguments for a fixed ordering.
-  global_parallel_inputs.insert(global_parallel_inputs.end(),
-                                global_parallel_sparse_inputs.begin(),
-                                global_parallel_sparse_inputs.end());
-
   // Calculate the number of global outputs.
   const std::vector<TranslatedFunction>& function_list =
       execution_functions->function_list;
@@ -2167,7 +2145,35 @@ void DTensorDevice::ExecuteRegularOperation(
     }
   }
 
+  // The multi-device function is launched once for all the local devices,
+  // with the local tensors of the inputs, see ExecuteMultiDeviceOperation.
+  // Otherwise the functions are launched on each device of their mesh, with
+  // their parallel inputs.
   if (!multi_device_mode) {
+    // Extract the global parallel inputs and flatten SparseTensors
+    // into the three component tensors.
+    std::vector<std::vector<TFE_TensorHandle*>> global_parallel_inputs;
+    std::vector<std::vector<TFE_TensorHandle*>> global_parallel_sparse_inputs;
+    for (auto input : inputs_tf) {
+      if (auto* sparse_input = llvm::dyn_cast<SparseTensorWithLayout>(input);
+          sparse_input) {
+        global_parallel_sparse_inputs.emplace_back(
+            sparse_input->indices()->tensors());
+        global_parallel_sparse_inputs.emplace_back(
+            sparse_input->dense_shapes()->tensors());
+        global_parallel_sparse_inputs.emplace_back(
+            sparse_input->values()->tensors());
+      } else {
+        global_parallel_inputs.push_back(input->tensors());
+      }
+    }
+    // Insert SparseTensor components to the end, this is because
+    // in the MLIR handling of SparseTensors, we place SparseTensor components
+    // to the end of the main func arguments for a fixed ordering.
+    global_parallel_inputs.insert(global_parallel_inputs.end(),
+                                  global_parallel_sparse_inputs.begin(),
+                                  global_parallel_sparse_inputs.end());
+
     ExecuteParallelDeviceOperation(context, attributes, execution_functions,
                                    functions_to_execute, global_parallel_inputs,
                                    inputs.size(), step_id, status);
@@ -176,6 +176,20 @@ int AllReduceCombineOptimizationTopologicalDistance() {
   return topo_dist;
 }
 
+int64_t AllReduceCombineOptimizationMaxGroupBytes() {
+  int64_t max_group_bytes;
+  absl::Status status = tsl::ReadInt64FromEnvVar(
+      "DTENSOR_ALLREDUCE_COMBINE_OPTIMIZATION_MAX_GROUP_BYTES",
+      /*default_val=*/0, &max_group_bytes);
+  if (!status.ok() || max_group_bytes < 0) {
+    LOG(WARNING) << "Invalid DTENSOR_ALLREDUCE_COMBINE_OPTIMIZATION_MAX_GROUP_"
+                    "BYTES, value must be a non-negative integer, using the "
+                    "default value 0.";
+    return 0;
+  }
+  return max_group_bytes;
+}
+
 bool EnableMultiDeviceMode() {
   bool multi_device_mode;
   absl::Status status = tsl::ReadBoolFromEnvVar(
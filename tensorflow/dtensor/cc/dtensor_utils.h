@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_DTENSOR_CC_DTENSOR_UTILS_H_
 #define TENSORFLOW_DTENSOR_CC_DTENSOR_UTILS_H_
 
+#include <cstdint>
 #include <string>
 
 #include "absl/strings/string_view.h"
@@ -84,6 +85,15 @@ int AllReduceCombineOptimizationGroupSize();
 // extended grouping.
 int AllReduceCombineOptimizationTopologicalDistance();
 
+// Returns the maximum total size in bytes of the AllReduce ops to merge into a
+// single AllReduce, in the order they're computed. This value is used to
+// determine AllReduce grouping in dtensor_allreduce_combine_optimization, like
+// the gradient buckets of data-parallel training: the AllReduce of a group can
+// start while the operands of the next groups, e.g. the gradients of the
+// previous layers, are still being computed. When the input value is zero, the
+// behaviour will act as having no extended grouping.
+int64_t AllReduceCombineOptimizationMaxGroupBytes();
+
 // Returns whether to perform multi-device expansion.
 bool EnableMultiDeviceMode();
 }  // namespace dtensor
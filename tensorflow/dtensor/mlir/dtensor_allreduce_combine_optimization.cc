@@ -28,6 +28,7 @@ limitations under the License.
 #include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
 #include "mlir/IR/Block.h"  // from @llvm-project
 #include "mlir/IR/BuiltinOps.h"  // from @llvm-project
+#include "mlir/IR/BuiltinTypes.h"  // from @llvm-project
 #include "mlir/IR/Types.h"  // from @llvm-project
 #include "mlir/IR/Visitors.h"  // from @llvm-project
 #include "mlir/Pass/Pass.h"  // from @llvm-project
@@ -565,6 +566,61 @@ createSubgroupsByExtendedNumOps(
   return all_reduce_new_groups;
 }
 
+// Returns the size in bytes of the result of `all_reduce`, which must have a
+// static shape.
+int64_t AllReduceBytes(mlir::TF::DTensorAllReduceOp all_reduce) {
+  auto type = all_reduce.getType().cast<mlir::RankedTensorType>();
+  mlir::Type element_type = type.getElementType();
+  int64_t element_bits = 0;
+  if (auto complex_type = element_type.dyn_cast<mlir::ComplexType>()) {
+    element_bits = 2 * complex_type.getElementType().getIntOrFloatBitWidth();
+  } else if (element_type.isIntOrFloat()) {
+    element_bits = element_type.getIntOrFloatBitWidth();
+  }
+  return type.getNumElements() * element_bits / 8;
+}
+
+// Experimental extended grouping logics to overlap AllReduces with compute.
+// This function groups all reduce ops in the order they're computed into groups
+// of at most max_group_bytes, as the gradient buckets of data-parallel training
+// do: the merged AllReduce of a group only waits for its own operands, so that
+// it can run while the operands of the next groups are computed. An op larger
+// than max_group_bytes is in a group of its own. When max_group_bytes is zero,
+// the function will act as having no extended grouping.
+std::vector<std::vector<mlir::TF::DTensorAllReduceOp>>
+createSubgroupsByMaxGroupBytes(
+    std::vector<std::vector<mlir::TF::DTensorAllReduceOp>> all_reduce_groups,
+    int64_t max_group_bytes) {
+  VLOG(4) << "max number of bytes in a all-reduce group: " << max_group_bytes;
+  if (max_group_bytes <= 0) return all_reduce_groups;
+  std::vector<std::vector<mlir::TF::DTensorAllReduceOp>> all_reduce_new_groups;
+  for (auto& all_reduce_group : all_reduce_groups) {
+    // Sort by program order, which is only defined within a block.
+    std::stable_sort(all_reduce_group.begin(), all_reduce_group.end(),
+                     [](mlir::TF::DTensorAllReduceOp lhs,
+                        mlir::TF::DTensorAllReduceOp rhs) {
+                       return lhs->getBlock() == rhs->getBlock() &&
+                              lhs->isBeforeInBlock(rhs);
+                     });
+    std::vector<mlir::TF::DTensorAllReduceOp> new_group;
+    int64_t new_group_bytes = 0;
+    for (mlir::TF::DTensorAllReduceOp all_reduce : all_reduce_group) {
+      const int64_t bytes = AllReduceBytes(all_reduce);
+      if (!new_group.empty() && new_group_bytes + bytes > max_group_bytes) {
+        all_reduce_new_groups.push_back(std::move(new_group));
+        new_group.clear();
+        new_group_bytes = 0;
+      }
+      new_group.push_back(all_reduce);
+      new_group_bytes += bytes;
+    }
+    if (!new_group.empty()) all_reduce_new_groups.push_back(new_group);
+  }
+  VLOG(4) << "current number of groups: " << all_reduce_new_groups.size()
+          << " after grouping by max group bytes.";
+  return all_reduce_new_groups;
+}
+
 // Experimental grouping logics to optimize from aggressive grouping.
 // This function first sort by topological level, then create AllReduce sub-
 // groups by accessing each topological distance from its previous AllReduce.
@@ -738,6 +794,14 @@ struct DTensorAllReduceCombineOptimization
                   .getInt());
         }
 
+        // Experimental extended grouping: maximum bytes of AllReduce ops
+        if (module->hasAttrOfType<mlir::IntegerAttr>(kAllReduceMaxGroupBytes)) {
+          all_reduce_groups = createSubgroupsByMaxGroupBytes(
+              all_reduce_groups,
+              module->getAttrOfType<mlir::IntegerAttr>(kAllReduceMaxGroupBytes)
+                  .getInt());
+        }
+
         // Maintain relative order of ALLReduces within the block.
         std::sort(all_reduce_groups.begin(), all_reduce_groups.end(),
                   [](std::vector<mlir::TF::DTensorAllReduceOp> lhs,
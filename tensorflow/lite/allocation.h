@@ -22,7 +22,10 @@ limitations under the License.
 
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
 
 #include "tensorflow/lite/core/api/error_reporter.h"
 
@@ -148,6 +151,59 @@ class MemoryAllocation : public Allocation {
   size_t buffer_size_bytes_ = 0;
 };
 
+/// A file of constant buffers, e.g. the weights of a model, whose ranges are
+/// mapped on demand and unmapped once they are unused, so that the file can be
+/// larger than the RAM or the address space of the device.
+/// The mappings of a range are reference counted, so the interpreters sharing
+/// the file also share its mapped ranges. It is thread-safe.
+/// Note that not all platforms support it. Use `IsSupported()` to check.
+class ExternalWeightsFile {
+ public:
+  /// Opens the provided file, without mapping any of it.
+  ExternalWeightsFile(const char* filename, ErrorReporter* error_reporter);
+  ~ExternalWeightsFile();
+
+  ExternalWeightsFile(const ExternalWeightsFile&) = delete;
+  ExternalWeightsFile& operator=(const ExternalWeightsFile&) = delete;
+
+  /// Whether the file was opened.
+  bool valid() const { return fd_ >= 0; }
+  /// Size in bytes of the file.
+  size_t bytes() const { return bytes_; }
+
+  /// Maps `length` bytes of the file at `offset`, or adds a reference to them
+  /// if they are already mapped, and returns their address. Returns nullptr
+  /// in case of failure.
+  const void* Map(size_t offset, size_t length);
+  /// Removes a reference to the range mapped by `Map(offset, length)`, and
+  /// unmaps it if it was the last one.
+  void Unmap(size_t offset, size_t length);
+
+  /// The number of bytes currently mapped.
+  size_t mapped_bytes() const;
+
+  static bool IsSupported();
+
+ private:
+  struct Mapping {
+    // The page aligned start of the mapping, and its size.
+    void* mapped_buffer;
+    size_t mapped_buffer_size;
+    // The offset of the range in the mapping.
+    size_t offset_in_buffer;
+    int reference_count;
+  };
+
+  ErrorReporter* error_reporter_;
+  int fd_ = -1;
+  size_t bytes_ = 0;
+
+  mutable std::mutex mutex_;
+  // The mapped ranges, keyed by their offset and length.
+  std::map<std::pair<size_t, size_t>, Mapping> mappings_;
+  size_t mapped_bytes_ = 0;
+};
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_ALLOCATION_H_
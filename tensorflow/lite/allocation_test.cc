@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <sys/stat.h>
 
+#include <cstring>
 #include <string>
 
 #include <gtest/gtest.h>
@@ -142,4 +143,66 @@ TEST(MMAPAllocation, TestValidFileDescriptorWithOffset) {
 }
 #endif  // defined(__linux__)
 
+TEST(ExternalWeightsFile, TestInvalidFile) {
+  if (!ExternalWeightsFile::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  ExternalWeightsFile weights("/tmp/tflite_weights_1234", &error_reporter);
+  EXPECT_FALSE(weights.valid());
+  EXPECT_EQ(weights.Map(/*offset=*/0, /*length=*/1), nullptr);
+}
+
+TEST(ExternalWeightsFile, TestInvalidRange) {
+  if (!ExternalWeightsFile::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  ExternalWeightsFile weights("tensorflow/lite/testdata/empty_model.bin",
+                              &error_reporter);
+  ASSERT_TRUE(weights.valid());
+  EXPECT_EQ(weights.Map(/*offset=*/0, /*length=*/0), nullptr);
+  EXPECT_EQ(weights.Map(/*offset=*/0, /*length=*/weights.bytes() + 1), nullptr);
+  EXPECT_EQ(weights.Map(/*offset=*/weights.bytes(), /*length=*/1), nullptr);
+  EXPECT_EQ(weights.mapped_bytes(), 0);
+}
+
+TEST(ExternalWeightsFile, TestMapAndUnmap) {
+  if (!ExternalWeightsFile::IsSupported()) {
+    return;
+  }
+
+  TestErrorReporter error_reporter;
+  MMAPAllocation allocation("tensorflow/lite/testdata/empty_model.bin",
+                            &error_reporter);
+  ASSERT_TRUE(allocation.valid());
+  ExternalWeightsFile weights("tensorflow/lite/testdata/empty_model.bin",
+                              &error_reporter);
+  ASSERT_TRUE(weights.valid());
+  ASSERT_EQ(weights.bytes(), allocation.bytes());
+  ASSERT_GT(weights.bytes(), 10);
+
+  // The ranges don't need to be page aligned.
+  const size_t length = weights.bytes() - 10;
+  const void* data = weights.Map(/*offset=*/10, length);
+  ASSERT_NE(data, nullptr);
+  EXPECT_EQ(std::memcmp(data,
+                        static_cast<const char*>(allocation.base()) + 10,
+                        length),
+            0);
+  EXPECT_GE(weights.mapped_bytes(), length);
+
+  // Mapping the same range again shares the mapping.
+  const size_t mapped_bytes = weights.mapped_bytes();
+  EXPECT_EQ(weights.Map(/*offset=*/10, length), data);
+  EXPECT_EQ(weights.mapped_bytes(), mapped_bytes);
+
+  weights.Unmap(/*offset=*/10, length);
+  EXPECT_EQ(weights.mapped_bytes(), mapped_bytes);
+  weights.Unmap(/*offset=*/10, length);
+  EXPECT_EQ(weights.mapped_bytes(), 0);
+}
+
 }  // namespace tflite
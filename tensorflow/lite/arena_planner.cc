@@ -20,6 +20,7 @@ limitations under the License.
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -37,7 +38,7 @@ constexpr int32_t kScalarTensorBytes = 4;
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
-                           int subgraph_index)
+                           int subgraph_index, bool reuse_allocations)
     : context_(context),
       graph_info_(std::move(graph_info)),
       arena_(kDefaultArenaAlignment, subgraph_index),
@@ -45,6 +46,7 @@ ArenaPlanner::ArenaPlanner(TfLiteContext* context,
       persistent_arena_(kDefaultArenaAlignment, subgraph_index),
       preserve_all_tensors_(preserve_all_tensors),
       tensor_alignment_(tensor_alignment),
+      reuse_allocations_(reuse_allocations),
       last_active_node_(kLastActiveNodeUndefined) {}
 
 ArenaPlanner::~ArenaPlanner() {
@@ -63,6 +65,15 @@ std::intptr_t ArenaPlanner::BasePointer(TfLiteAllocationType type) {
 }
 
 TfLiteStatus ArenaPlanner::ResetAllocations() {
+  if (reuse_allocations_ && last_active_node_ != kLastActiveNodeUndefined) {
+    allocations_retained_ = true;
+    return kTfLiteOk;
+  }
+  return ClearAllocations();
+}
+
+TfLiteStatus ArenaPlanner::ClearAllocations() {
+  allocations_retained_ = false;
   TF_LITE_ENSURE_STATUS(arena_.ClearPlan());
   TF_LITE_ENSURE_STATUS(persistent_arena_.ClearPlan());
   allocs_.clear();
@@ -74,6 +85,46 @@ TfLiteStatus ArenaPlanner::ResetAllocations() {
   return kTfLiteOk;
 }
 
+bool ArenaPlanner::FitsInAllocation(int32_t tensor_index) const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const TfLiteTensor& tensor = tensors[tensor_index];
+  if (tensor.allocation_type == kTfLiteArenaRw) {
+    // A tensor sharing the buffer of another one fits as long as the sharing
+    // is still valid, see CalculateAllocations().
+    auto it = actual_tensor_id_.find(tensor_index);
+    if (it != actual_tensor_id_.end()) {
+      const TfLiteTensor& root_tensor = tensors[it->second];
+      return root_tensor.allocation_type == kTfLiteArenaRw &&
+             root_tensor.bytes == tensor.bytes;
+    }
+  } else if (tensor.allocation_type != kTfLiteArenaRwPersistent) {
+    return true;
+  }
+  return tensor.bytes <= allocs_[tensor_index].size;
+}
+
+TfLiteStatus ArenaPlanner::ResetAllocationsThatDoNotFit(
+    int first_node, int last_node, int* first_node_to_allocate) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const int num_execution_nodes = graph_info_->num_execution_nodes();
+  for (int i = first_node; i <= last_node && i < num_execution_nodes; ++i) {
+    for (int32_t tensor_index : nodes_to_tensors_[i]) {
+      if (FitsInAllocation(tensor_index)) continue;
+      // Persistent allocations can only be reset altogether.
+      if (i == 0 ||
+          tensors[tensor_index].allocation_type == kTfLiteArenaRwPersistent) {
+        *first_node_to_allocate = 0;
+        return ClearAllocations();
+      }
+      *first_node_to_allocate = i;
+      return ResetAllocationsAfter(i - 1);
+    }
+  }
+  // All the tensors of [first_node, last_node] keep their allocation.
+  *first_node_to_allocate = last_node + 1;
+  return kTfLiteOk;
+}
+
 TfLiteStatus ArenaPlanner::ResetAllocationsAfter(int node) {
   TfLiteTensor* tensors = graph_info_->tensors();
   for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
@@ -102,6 +153,28 @@ int ArenaPlanner::FindSharedTensor(int tensor_index) {
   return tensor_index;
 }
 
+void ArenaPlanner::SetConcurrentNodeRanges(
+    const std::vector<std::pair<int, int>>& ranges) {
+  int num_nodes = 0;
+  for (const auto& range : ranges) {
+    num_nodes = std::max(num_nodes, range.second + 1);
+  }
+  last_concurrent_node_.resize(num_nodes);
+  std::iota(last_concurrent_node_.begin(), last_concurrent_node_.end(), 0);
+  for (const auto& [first_node, last_node] : ranges) {
+    for (int i = first_node; i <= last_node; ++i) {
+      last_concurrent_node_[i] = last_node;
+    }
+  }
+}
+
+int32_t ArenaPlanner::LastConcurrentNode(int32_t node) const {
+  if (node < 0 || node >= static_cast<int32_t>(last_concurrent_node_.size())) {
+    return node;
+  }
+  return last_concurrent_node_[node];
+}
+
 bool ArenaPlanner::InputTensorCanBeShared(const TfLiteTensor& input_tensor,
                                           const TfLiteTensor& output_tensor,
                                           int input_id, int output_id,
@@ -200,7 +273,7 @@ void ArenaPlanner::IdentifyInPlaceTensors() {
 TfLiteStatus ArenaPlanner::PlanAllocations() {
   // Invalidate any existing data.
   const size_t num_tensors = graph_info_->num_tensors();
-  TF_LITE_ENSURE_STATUS(ResetAllocations());
+  TF_LITE_ENSURE_STATUS(ClearAllocations());
   // Maybe other verb instead of 'Assigned'
   alloc_node_.assign(num_tensors, kNodeNotAssigned);
   dealloc_node_.assign(num_tensors, kNodeNotAssigned);
@@ -356,9 +429,16 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     }
   }
 
+  int first_node_to_allocate = first_node;
+  if (allocations_retained_) {
+    allocations_retained_ = false;
+    TF_LITE_ENSURE_STATUS(ResetAllocationsThatDoNotFit(
+        first_node, last_node, &first_node_to_allocate));
+  }
+
   std::vector<int32_t> tensors_allocated;
-  TF_LITE_ENSURE_STATUS(
-      CalculateAllocations(first_node, last_node, &tensors_allocated));
+  TF_LITE_ENSURE_STATUS(CalculateAllocations(first_node_to_allocate,
+                                             last_node, &tensors_allocated));
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
 
@@ -367,6 +447,13 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
     for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
     }
+  } else if (reuse_allocations_) {
+    // Resizing a tensor clears its data pointer, including when it still fits
+    // in its retained allocation.
+    for (int32_t tensor_index : GetTensorsToAllocate(
+             std::min(first_node, first_node_to_allocate), last_node)) {
+      TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(tensor_index, tensors));
+    }
   } else {
     for (int i = 0; i < static_cast<int>(tensors_allocated.size()); ++i) {
       TF_LITE_ENSURE_STATUS(
@@ -537,10 +624,15 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      // Extending the lifetime of the tensor to the end of the concurrent
+      // range of its last use is enough to keep it apart from the tensors of
+      // the other nodes of the range: they are all allocated before the end
+      // of the range, and deallocated after its start.
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(
+          context_, tensor_alignment_, tensor.bytes, tensor_index,
+          alloc_node_[tensor_index],
+          LastConcurrentNode(dealloc_node_[tensor_index]),
+          &allocs_[tensor_index]));
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
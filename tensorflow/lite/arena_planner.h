@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -45,6 +46,16 @@ constexpr const int kDefaultArenaAlignment = 64;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// If `reuse_allocations` is true, ResetAllocations() keeps the current
+// allocations, and the next ExecuteAllocations() only replans the tensors
+// from the first node with a tensor that no longer fits in its allocation
+// onwards. Planning once for the largest shapes of the inputs then keeps the
+// plan valid for any smaller shapes.
+//
+// Nodes declared with SetConcurrentNodeRanges() may run at the same time, so
+// a tensor used by a node of such a range keeps its memory until the end of
+// the range, and never shares it with a tensor of another node of the range.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -53,7 +64,7 @@ class ArenaPlanner : public MemoryPlanner {
   // of inference.
   ArenaPlanner(TfLiteContext* context, std::unique_ptr<GraphInfo> graph_info,
                bool preserve_all_tensors, int tensor_alignment,
-               int subgraph_index = 0);
+               int subgraph_index = 0, bool reuse_allocations = false);
   ~ArenaPlanner() override;
   ArenaPlanner(const ArenaPlanner&) = delete;
   ArenaPlanner& operator=(const ArenaPlanner&) = delete;
@@ -62,6 +73,8 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ResetAllocationsAfter(int node) override;
   TfLiteStatus PlanAllocations() override;
   TfLiteStatus ExecuteAllocations(int first_node, int last_node) override;
+  void SetConcurrentNodeRanges(
+      const std::vector<std::pair<int, int>>& ranges) override;
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
@@ -83,6 +96,20 @@ class ArenaPlanner : public MemoryPlanner {
   // Identify tensors which can share memory with another.
   void IdentifyInPlaceTensors();
 
+  // Clears all the allocations, unlike ResetAllocations() which may retain
+  // them.
+  TfLiteStatus ClearAllocations();
+
+  // Returns true if the current allocation of `tensor_index` can hold it.
+  bool FitsInAllocation(int32_t tensor_index) const;
+
+  // Resets the retained allocations of the tensors allocated by the first node
+  // in [first_node, last_node] with a tensor which does not fit in its
+  // allocation, and by all the nodes after it. Returns in
+  // `first_node_to_allocate` the first node left to allocate.
+  TfLiteStatus ResetAllocationsThatDoNotFit(int first_node, int last_node,
+                                            int* first_node_to_allocate);
+
   // Make sure all the arenas have reserved enough memory to store all their
   // tensors.
   TfLiteStatus Commit(bool* arena_reallocated);
@@ -120,6 +147,10 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Returns the last node of the concurrent range `node` belongs to, which is
+  // `node` itself if it is not part of one.
+  int32_t LastConcurrentNode(int32_t node) const;
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -156,9 +187,20 @@ class ArenaPlanner : public MemoryPlanner {
   // Number of bytes that tensor buffers should be aligned to.
   int tensor_alignment_;
 
+  // If true, ResetAllocations() retains the allocations (see above).
+  bool reuse_allocations_;
+
+  // True if ResetAllocations() retained the allocations, and they have not
+  // been checked against the new tensor sizes yet.
+  bool allocations_retained_ = false;
+
   // Index of the last node whose tensors were allocated.
   int last_active_node_;
 
+  // Last node of the concurrent range of each node, empty if no concurrent
+  // ranges were declared.
+  std::vector<int32_t> last_concurrent_node_;
+
   // Holds index of original tensor if the tensor is sharing underlined
   // data with another tensor.
   // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
@@ -208,12 +208,14 @@ void ReportError(TfLiteContext* context, const char* format, ...) {
 
 class ArenaPlannerTest : public ::testing::Test {
  protected:
-  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false) {
+  void SetGraph(TestGraph* graph, bool preserve_all_tensors = false,
+                bool reuse_allocations = false) {
     graph_ = graph;
     context_.ReportError = ReportError;
     planner_ = std::make_unique<ArenaPlanner>(
         &context_, std::unique_ptr<GraphInfo>(new TestGraphInfo(graph)),
-        preserve_all_tensors, kTensorAlignment);
+        preserve_all_tensors, kTensorAlignment, /*subgraph_index=*/0,
+        reuse_allocations);
     CHECK(planner_->ResetAllocations() == kTfLiteOk);
     CHECK(planner_->PlanAllocations() == kTfLiteOk);
   }
@@ -370,6 +372,112 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, ReuseAllocationsOfSmallerTensors) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           /*reuse_allocations=*/true);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) offsets.push_back(GetOffset(i));
+
+  // The retained allocations are large enough for the smaller tensors, so
+  // the tensors keep their offsets, rather than being packed more tightly.
+  ResetAllocations();
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  for (int i = 0; i < 6; ++i) {
+    tensors[i].bytes = 1;
+    tensors[i].data.raw = nullptr;
+  }
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_FALSE(IsUnallocated(i));
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, ReuseAllocationsBeforeGrownTensor) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph, /*preserve_all_tensors=*/false,
+           /*reuse_allocations=*/true);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i < 6; ++i) offsets.push_back(GetOffset(i));
+
+  // Only the output of the third op grows, so only the third op is replanned.
+  ResetAllocations();
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  tensors[3].bytes = 100;
+  tensors[3].data.raw = nullptr;
+  Execute(0, graph.nodes().size() - 1);
+  for (int i : {0, 1, 2, 4, 5}) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+  // The output does not overlap the tensors which are alive at the same time.
+  for (int i : {0, 1, 4, 5}) {
+    EXPECT_TRUE(GetOffsetAfter(i) <= GetOffset(3) ||
+                GetOffsetAfter(3) <= GetOffset(i));
+  }
+
+  // When an input grows, the whole graph is replanned, which gives the same
+  // plan as without reusing allocations.
+  ResetAllocations();
+  tensors[0].bytes = 50;
+  tensors[0].data.raw = nullptr;
+  Execute(0, graph.nodes().size() - 1);
+  offsets.clear();
+  for (int i = 0; i < 6; ++i) offsets.push_back(GetOffset(i));
+
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(GetOffset(i), offsets[i]);
+  }
+}
+
+TEST_F(ArenaPlannerTest, ConcurrentNodesDoNotShareMemory) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {5}},    // First op
+                      {{0}, {2}, {6}},    // Second op
+                      {{1, 2}, {3}, {}}   // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  // The temporaries of the first two ops are not used at the same time.
+  EXPECT_EQ(GetOffset(5), GetOffset(6));
+
+  // Unless the two ops run concurrently.
+  planner_->SetConcurrentNodeRanges({{0, 1}});
+  CHECK(planner_->PlanAllocations() == kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+  for (int i : {0, 1, 5}) {
+    for (int j : {0, 2, 6}) {
+      if (i == j) continue;
+      EXPECT_TRUE(GetOffsetAfter(i) <= GetOffset(j) ||
+                  GetOffsetAfter(j) <= GetOffset(i))
+          << "tensors " << i << " and " << j << " overlap";
+    }
+  }
+  // Tensors used after the concurrent ops can still reuse their memory.
+  EXPECT_EQ(GetOffset(3), GetOffset(6));
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <atomic>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/interop/c/types.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
@@ -33,7 +35,9 @@ namespace async {
 class AsyncSubgraphTestPeer;
 
 // AsyncSubgraph class manages to dispatch I/O information and
-// schedule executions to underlying delegate kernels.
+// schedule executions to underlying delegate kernels. Subgraphs which are not
+// fully delegated to a backend supporting asynchronous execution run with
+// their CPU kernels instead, see CpuAsyncKernel.
 // TODO(b/191883048): Currently we require either `AllocateTensors` or
 // `EnsureTensorAllocation` called to ensure the backend kernels are prepared.
 // However, we don't need to allocate the CPU memory for input / output tensors.
@@ -172,6 +176,10 @@ class AsyncSubgraph {
   // Not owned.
   mutable TfLiteAsyncKernel* async_kernel_ = nullptr;
   TfLiteOpaqueNode* opaque_node_ = nullptr;
+
+  // The kernel running the subgraph on the CPU, if it is not fully delegated
+  // to a backend supporting asynchronous execution.
+  std::unique_ptr<CpuAsyncKernel> cpu_async_kernel_;
 };
 
 }  // namespace async
@@ -14,22 +14,30 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/core/async/async_subgraph.h"
 
+#include <cstdlib>
 #include <memory>
 #include <vector>
 
+#if defined(__linux__)
+#include <unistd.h>
+#endif  // defined(__linux__)
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/lite/core/async/async_kernel_internal.h"
 #include "tensorflow/lite/core/async/backend_async_kernel_interface.h"
 #include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
 #include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
 #include "tensorflow/lite/core/async/interop/c/types.h"
 #include "tensorflow/lite/core/async/task_internal.h"
 #include "tensorflow/lite/core/async/testing/mock_async_kernel.h"
 #include "tensorflow/lite/core/async/testing/test_backend.h"
+#include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/interpreter.h"
 #include "tensorflow/lite/core/kernels/builtin_op_kernels.h"
+#include "tensorflow/lite/util.h"
 
 using ::testing::_;
 
@@ -163,5 +171,127 @@ TEST_F(AsyncSubgraphTest, OutOfBoundTest) {
   delete attrs;
 }
 
+class AsyncSubgraphCpuTest : public ::testing::Test {
+ protected:
+  // Builds the graph `2 = add(0, 1)` without delegates.
+  void SetUp() override {
+    interpreter_.AddTensors(3);
+    interpreter_.SetInputs({0, 1});
+    interpreter_.SetOutputs({2});
+    for (int i = 0; i < 3; ++i) {
+      interpreter_.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {3},
+                                                TfLiteQuantizationParams());
+    }
+    auto* params =
+        static_cast<TfLiteAddParams*>(malloc(sizeof(TfLiteAddParams)));
+    params->activation = kTfLiteActNone;
+    params->pot_scale_int16 = false;
+    interpreter_.AddNodeWithParameters({0, 1}, {2}, nullptr, 0, params,
+                                       ops::builtin::Register_ADD());
+    ASSERT_EQ(kTfLiteOk, interpreter_.AllocateTensors());
+    subgraph_ = std::make_unique<AsyncSubgraph>(interpreter_.subgraph(0));
+  }
+
+  TfLiteBufferHandle RegisterBuffer(TfLiteIoType io_type, float* data) {
+    auto* buffer = TfLiteBackendBufferCreate();
+    TfLiteBackendBufferSetPtr(buffer, data);
+    TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                       kCpuBufferTypeHostMemory);
+    attrs.impl.SetAttr(kTfLiteBufferAttrKeySize, 3 * sizeof(float));
+    TfLiteBufferHandle handle = kTfLiteNullBufferHandle;
+    EXPECT_EQ(kTfLiteOk,
+              subgraph_->RegisterBuffer(io_type, buffer, &attrs, &handle));
+    TfLiteBackendBufferDelete(buffer);
+    return handle;
+  }
+
+  Interpreter interpreter_;
+  std::unique_ptr<AsyncSubgraph> subgraph_;
+};
+
+TEST_F(AsyncSubgraphCpuTest, BindsBuffersWithoutCopies) {
+  alignas(kDefaultTensorAlignment) float lhs[3] = {1, 2, 3};
+  alignas(kDefaultTensorAlignment) float rhs[3] = {10, 20, 30};
+  alignas(kDefaultTensorAlignment) float sum[3] = {};
+  auto* task = subgraph_->CreateTask();
+  task->task->SetBufferHandle(0, RegisterBuffer(kTfLiteIoTypeInput, lhs));
+  task->task->SetBufferHandle(1, RegisterBuffer(kTfLiteIoTypeInput, rhs));
+  task->task->SetBufferHandle(2, RegisterBuffer(kTfLiteIoTypeOutput, sum));
+  ASSERT_EQ(kTfLiteOk, subgraph_->Prepare());
+
+  ASSERT_EQ(kTfLiteOk, subgraph_->InvokeAsync(task));
+  ASSERT_EQ(kTfLiteOk, subgraph_->Wait(task));
+  EXPECT_EQ(interpreter_.tensor(2)->data.f, sum);
+  EXPECT_THAT(sum, ::testing::ElementsAre(11, 22, 33));
+
+  lhs[0] = 4;
+  ASSERT_EQ(kTfLiteOk, subgraph_->InvokeAsync(task));
+  ASSERT_EQ(kTfLiteOk, subgraph_->Wait(task));
+  EXPECT_EQ(sum[0], 14);
+
+  // Once bound, the I/O tensors need a buffer in every task.
+  auto* other_task = subgraph_->CreateTask();
+  EXPECT_EQ(kTfLiteError, subgraph_->InvokeAsync(other_task));
+  subgraph_->Wait(other_task);
+  subgraph_->Finish(other_task);
+  EXPECT_EQ(kTfLiteOk, subgraph_->Finish(task));
+}
+
+TEST_F(AsyncSubgraphCpuTest, RejectsUnsupportedAttributes) {
+  TfLiteAttributeMap attrs(kTfLiteAttrMapTypeBuffer);
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName, "unknown");
+  TfLiteAttributeMap merged(kTfLiteAttrMapTypeBuffer);
+  EXPECT_FALSE(subgraph_->ReconcileRestrictions(0, &attrs, &merged, nullptr));
+
+  attrs.impl.SetAttr(kTfLiteBufferAttrKeyResourceTypeName,
+                     kCpuBufferTypeHostMemory);
+  ASSERT_TRUE(subgraph_->ReconcileRestrictions(0, &attrs, &merged, nullptr));
+  size_t size = 0;
+  EXPECT_TRUE(merged.impl.GetAttr(kTfLiteBufferAttrKeySize, &size));
+  EXPECT_EQ(size, 3 * sizeof(float));
+  EXPECT_EQ(kTfLiteOk, subgraph_->SetAttributes(0, &merged));
+
+  // Outputs are ready when InvokeAsync returns.
+  TfLiteAttributeMap sync(kTfLiteAttrMapTypeSync);
+  sync.impl.SetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName,
+                    kCpuSyncTypeSyncFenceFd);
+  TfLiteAttributeMap merged_sync(kTfLiteAttrMapTypeSync);
+  EXPECT_FALSE(
+      subgraph_->ReconcileRestrictions(2, &sync, &merged_sync, nullptr));
+}
+
+#if defined(__linux__)
+TEST_F(AsyncSubgraphCpuTest, WaitsForInputSyncFences) {
+  TfLiteAttributeMap sync(kTfLiteAttrMapTypeSync);
+  sync.impl.SetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName,
+                    kCpuSyncTypeSyncFenceFd);
+  ASSERT_EQ(kTfLiteOk, subgraph_->SetAttributes(0, &sync));
+
+  // The read end of a pipe is signalled once there is data in the pipe.
+  int fds[2];
+  ASSERT_EQ(0, pipe(fds));
+  auto* fence = TfLiteSynchronizationCreate();
+  TfLiteSynchronizationSetPtr(fence, &fds[0]);
+  auto* task = subgraph_->CreateTask();
+  task->task->SetSynchronization(0, fence);
+  ASSERT_EQ(1, write(fds[1], "x", 1));
+  interpreter_.typed_input_tensor<float>(0)[0] = 1;
+  interpreter_.typed_input_tensor<float>(1)[0] = 2;
+  ASSERT_EQ(kTfLiteOk, subgraph_->InvokeAsync(task));
+  ASSERT_EQ(kTfLiteOk, subgraph_->Wait(task));
+  EXPECT_EQ(interpreter_.typed_output_tensor<float>(0)[0], 3);
+
+  // A closed fence is an error.
+  close(fds[0]);
+  close(fds[1]);
+  fds[0] = 1 << 20;
+  ASSERT_EQ(kTfLiteError, subgraph_->InvokeAsync(task));
+  subgraph_->Wait(task);
+  subgraph_->Finish(task);
+  TfLiteSynchronizationDelete(fence);
+}
+#endif  // defined(__linux__)
+
 }  // namespace async
 }  // namespace tflite
@@ -0,0 +1,428 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/cpu_async_kernel.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/dma-buf.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#endif  // defined(__linux__)
+
+#include "tensorflow/lite/core/async/async_kernel_internal.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/async/interop/c/constants.h"
+#include "tensorflow/lite/core/async/interop/c/types.h"
+#include "tensorflow/lite/core/async/task_internal.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+
+namespace {
+
+CpuAsyncKernel* GetKernel(const TfLiteAsyncKernel* async_kernel) {
+  return reinterpret_cast<CpuAsyncKernel*>(async_kernel->kernel_data);
+}
+
+// Blocks until all `fds` are signalled.
+TfLiteStatus WaitForSyncFences(Subgraph* subgraph,
+                               const std::vector<int>& fds) {
+  if (fds.empty()) return kTfLiteOk;
+#if defined(__linux__)
+  std::vector<pollfd> pfds;
+  for (int fd : fds) pfds.push_back({fd, POLLIN, 0});
+  size_t signalled = 0;
+  while (signalled < pfds.size()) {
+    const int ret = poll(pfds.data(), pfds.size(), /*timeout=*/-1);
+    if (ret == -1 && (errno == EINTR || errno == EAGAIN)) continue;
+    if (ret < 0) {
+      subgraph->ReportError("Failed to wait for the input sync fences.");
+      return kTfLiteError;
+    }
+    for (pollfd& pfd : pfds) {
+      if (pfd.fd == -1) continue;
+      if (pfd.revents & (POLLERR | POLLNVAL)) {
+        subgraph->ReportError("Invalid input sync fence %d.", pfd.fd);
+        return kTfLiteError;
+      }
+      if (pfd.revents & POLLIN) {
+        // Negative file descriptors are ignored by later polls.
+        pfd.fd = -1;
+        ++signalled;
+      }
+    }
+  }
+  return kTfLiteOk;
+#else
+  subgraph->ReportError("Sync fences are not supported on this platform.");
+  return kTfLiteError;
+#endif  // defined(__linux__)
+}
+
+// Starts or ends CPU access to the DMA-BUF `fd`.
+TfLiteStatus SyncDmaBuf(Subgraph* subgraph, int fd, bool writable,
+                        bool start) {
+#if defined(__linux__)
+  dma_buf_sync sync = {};
+  sync.flags = (start ? DMA_BUF_SYNC_START : DMA_BUF_SYNC_END) |
+               (writable ? DMA_BUF_SYNC_RW : DMA_BUF_SYNC_READ);
+  int ret;
+  do {
+    ret = ioctl(fd, DMA_BUF_IOCTL_SYNC, &sync);
+  } while (ret == -1 && (errno == EINTR || errno == EAGAIN));
+  if (ret != 0) {
+    subgraph->ReportError("Failed to sync DMA-BUF %d.", fd);
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+#else
+  return kTfLiteError;
+#endif  // defined(__linux__)
+}
+
+}  // namespace
+
+CpuAsyncKernel::CpuAsyncKernel(Subgraph* subgraph) : subgraph_(subgraph) {
+  buffer_types_.push_back(kCpuBufferTypeHostMemory);
+  input_sync_types_.push_back(kTfLiteSyncTypeNoSyncObj);
+  output_sync_types_.push_back(kTfLiteSyncTypeNoSyncObj);
+#if defined(__linux__)
+  buffer_types_.push_back(kCpuBufferTypeDmaBuf);
+  input_sync_types_.push_back(kCpuSyncTypeSyncFenceFd);
+#endif  // defined(__linux__)
+
+  kernel_.kernel_data = this;
+  kernel_.register_buffer = [](TfLiteAsyncKernel* async_kernel,
+                               TfLiteOpaqueContext*, TfLiteIoType io_type,
+                               const TfLiteBackendBuffer* buffer,
+                               const TfLiteAttributeMap* attrs,
+                               TfLiteBufferHandle handle) {
+    return GetKernel(async_kernel)
+        ->RegisterBuffer(io_type, buffer, attrs, handle);
+  };
+  kernel_.register_buffer_slice = [](TfLiteAsyncKernel* async_kernel,
+                                     TfLiteOpaqueContext*,
+                                     TfLiteBufferHandle buffer_pool,
+                                     const TfLiteAttributeMap* attrs,
+                                     TfLiteBufferHandle handle) {
+    return GetKernel(async_kernel)
+        ->RegisterBufferSlice(buffer_pool, attrs, handle);
+  };
+  kernel_.unregister_buffer = [](TfLiteAsyncKernel* async_kernel,
+                                 TfLiteOpaqueContext*,
+                                 TfLiteBufferHandle handle) {
+    return GetKernel(async_kernel)->UnregisterBuffer(handle);
+  };
+  kernel_.supported_buffer_types = [](const TfLiteAsyncKernel* async_kernel,
+                                      TfLiteIoType io_type,
+                                      const char* const** types,
+                                      size_t* n_types) {
+    const auto& supported = GetKernel(async_kernel)->SupportedTypes(
+        kTfLiteAttrMapTypeBuffer, io_type);
+    *types = supported.data();
+    *n_types = supported.size();
+  };
+  kernel_.supported_synchronizations =
+      [](const TfLiteAsyncKernel* async_kernel, TfLiteIoType io_type,
+         const char* const** types, size_t* n_types) {
+        const auto& supported = GetKernel(async_kernel)->SupportedTypes(
+            kTfLiteAttrMapTypeSync, io_type);
+        *types = supported.data();
+        *n_types = supported.size();
+      };
+  kernel_.reconcile_restrictions =
+      [](const TfLiteAsyncKernel* async_kernel, const TfLiteOpaqueContext*,
+         const TfLiteOpaqueNode*, int tensor_index,
+         const TfLiteAttributeMap* user_provided_attributes,
+         TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) {
+        return GetKernel(async_kernel)
+            ->ReconcileRestrictions(tensor_index, user_provided_attributes,
+                                    merged, conflict);
+      };
+  kernel_.set_attributes = [](TfLiteAsyncKernel* async_kernel,
+                              TfLiteOpaqueContext*, TfLiteOpaqueNode*,
+                              int tensor_index,
+                              const TfLiteAttributeMap* attrs) {
+    return GetKernel(async_kernel)->SetAttributes(tensor_index, attrs);
+  };
+  kernel_.prepare = [](TfLiteAsyncKernel* async_kernel, TfLiteOpaqueContext*,
+                       TfLiteOpaqueNode*) {
+    return GetKernel(async_kernel)->subgraph_->AllocateTensors();
+  };
+  kernel_.eval = [](TfLiteAsyncKernel* async_kernel, TfLiteOpaqueContext*,
+                    TfLiteOpaqueNode*, TfLiteExecutionTask* task) {
+    return GetKernel(async_kernel)->Eval(task);
+  };
+  // Executions finish within `eval`, and tasks hold no kernel resources.
+  kernel_.wait = [](TfLiteAsyncKernel*, TfLiteOpaqueContext*,
+                    TfLiteExecutionTask* task) {
+    return task->task->Status();
+  };
+  kernel_.finish = [](TfLiteAsyncKernel*, TfLiteOpaqueContext*,
+                      TfLiteExecutionTask*) { return kTfLiteOk; };
+}
+
+CpuAsyncKernel::~CpuAsyncKernel() {
+  std::vector<TfLiteBufferHandle> handles;
+  for (const auto& [handle, buffer] : buffers_) handles.push_back(handle);
+  for (TfLiteBufferHandle handle : handles) UnregisterBuffer(handle);
+}
+
+const std::vector<const char*>& CpuAsyncKernel::SupportedTypes(
+    TfLiteAttrMapType attr_type, TfLiteIoType io_type) const {
+  if (attr_type == kTfLiteAttrMapTypeBuffer) return buffer_types_;
+  return io_type == kTfLiteIoTypeInput ? input_sync_types_
+                                       : output_sync_types_;
+}
+
+bool CpuAsyncKernel::IsInput(int tensor_index) const {
+  const std::vector<int>& inputs = subgraph_->inputs();
+  return std::find(inputs.begin(), inputs.end(), tensor_index) !=
+         inputs.end();
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBuffer(TfLiteIoType io_type,
+                                            const TfLiteBackendBuffer* buffer,
+                                            const TfLiteAttributeMap* attrs,
+                                            TfLiteBufferHandle handle) {
+  const char* type = nullptr;
+  Buffer registered;
+  if (!attrs->impl.IsBufferAttributeMap() ||
+      !attrs->impl.GetAttr(kTfLiteBufferAttrKeyResourceTypeName, &type) ||
+      type == nullptr ||
+      !attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &registered.bytes)) {
+    subgraph_->ReportError("The type and size of buffer %d are required.",
+                           handle);
+    return kTfLiteError;
+  }
+  registered.writable = io_type == kTfLiteIoTypeOutput;
+  void* ptr = TfLiteBackendBufferGetPtr(buffer);
+  if (std::strcmp(type, kCpuBufferTypeHostMemory) == 0) {
+    registered.data = static_cast<char*>(ptr);
+#if defined(__linux__)
+  } else if (std::strcmp(type, kCpuBufferTypeDmaBuf) == 0 && ptr != nullptr) {
+    const int fd = *static_cast<const int*>(ptr);
+    void* data = mmap(nullptr, registered.bytes,
+                      PROT_READ | (registered.writable ? PROT_WRITE : 0),
+                      MAP_SHARED, fd, /*offset=*/0);
+    if (data == MAP_FAILED) {
+      subgraph_->ReportError("Failed to map DMA-BUF %d.", fd);
+      return kTfLiteError;
+    }
+    registered.data = static_cast<char*>(data);
+    registered.dmabuf_fd = fd;
+#endif  // defined(__linux__)
+  } else {
+    subgraph_->ReportError("Unsupported buffer type %s.", type);
+    return kTfLiteError;
+  }
+  if (registered.data == nullptr) {
+    subgraph_->ReportError("Buffer %d is null.", handle);
+    return kTfLiteError;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffers_[handle] = registered;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::RegisterBufferSlice(
+    TfLiteBufferHandle buffer_pool, const TfLiteAttributeMap* attrs,
+    TfLiteBufferHandle handle) {
+  size_t offset = 0;
+  size_t bytes = 0;
+  if (!attrs->impl.IsBufferAttributeMap() ||
+      !attrs->impl.GetAttr(kTfLiteBufferAttrKeySize, &bytes)) {
+    subgraph_->ReportError("The size of buffer slice %d is required.", handle);
+    return kTfLiteError;
+  }
+  attrs->impl.GetAttr(kTfLiteBufferAttrKeyOffset, &offset);
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = buffers_.find(buffer_pool);
+  if (it == buffers_.end() || it->second.is_slice ||
+      offset > it->second.bytes || bytes > it->second.bytes - offset) {
+    subgraph_->ReportError("Invalid slice of buffer %d.", buffer_pool);
+    return kTfLiteError;
+  }
+  Buffer slice = it->second;
+  slice.data += offset;
+  slice.bytes = bytes;
+  slice.is_slice = true;
+  buffers_[handle] = slice;
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::UnregisterBuffer(TfLiteBufferHandle handle) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = buffers_.find(handle);
+  if (it == buffers_.end()) {
+    subgraph_->ReportError("Buffer %d is not registered.", handle);
+    return kTfLiteError;
+  }
+#if defined(__linux__)
+  if (it->second.dmabuf_fd != -1 && !it->second.is_slice) {
+    munmap(it->second.data, it->second.bytes);
+  }
+#endif  // defined(__linux__)
+  buffers_.erase(it);
+  return kTfLiteOk;
+}
+
+interop::AttributeMap CpuAsyncKernel::Requirements(
+    int tensor_index, const interop::AttributeMap& attrs) const {
+  const TfLiteAttrMapType attr_type = attrs.IsBufferAttributeMap()
+                                          ? kTfLiteAttrMapTypeBuffer
+                                          : kTfLiteAttrMapTypeSync;
+  const uint32_t type_key =
+      attrs.IsBufferAttributeMap()
+          ? static_cast<uint32_t>(kTfLiteBufferAttrKeyResourceTypeName)
+          : static_cast<uint32_t>(kTfLiteSynchronizationAttrKeyObjectTypeName);
+  const std::vector<const char*>& types = SupportedTypes(
+      attr_type, IsInput(tensor_index) ? kTfLiteIoTypeInput
+                                       : kTfLiteIoTypeOutput);
+  const char* type = types[0];
+  const char* requested_type = nullptr;
+  if (attrs.GetAttr(type_key, &requested_type) && requested_type != nullptr) {
+    for (const char* supported_type : types) {
+      if (std::strcmp(supported_type, requested_type) == 0) {
+        type = supported_type;
+      }
+    }
+  }
+
+  interop::AttributeMap requirements(attr_type);
+  requirements.SetAttr(type_key, type);
+  if (attrs.IsBufferAttributeMap()) {
+    requirements.SetAttr(kTfLiteBufferAttrKeyAlignment,
+                         static_cast<size_t>(kDefaultTensorAlignment));
+    requirements.SetAttr(kTfLiteBufferAttrKeySize,
+                         subgraph_->tensor(tensor_index)->bytes);
+  }
+  return requirements;
+}
+
+bool CpuAsyncKernel::ReconcileRestrictions(
+    int tensor_index, const TfLiteAttributeMap* user_provided_attributes,
+    TfLiteAttributeMap* merged, TfLiteAttributeMap* conflict) const {
+  const interop::AttributeMap& attrs = user_provided_attributes->impl;
+  if (!attrs.IsBufferAttributeMap() && !attrs.IsSyncAttributeMap()) {
+    return false;
+  }
+  return Requirements(tensor_index, attrs)
+      .ReconcileAttributes(&attrs, &merged->impl,
+                           conflict ? &conflict->impl : nullptr);
+}
+
+TfLiteStatus CpuAsyncKernel::SetAttributes(int tensor_index,
+                                           const TfLiteAttributeMap* attrs) {
+  const interop::AttributeMap& attributes = attrs->impl;
+  if (!attributes.IsBufferAttributeMap() && !attributes.IsSyncAttributeMap()) {
+    return kTfLiteError;
+  }
+  const interop::AttributeMap requirements =
+      Requirements(tensor_index, attributes);
+  if (!attributes.CheckAttributeCoverage(&requirements, nullptr)) {
+    subgraph_->ReportError("Unsupported attributes for tensor %d.",
+                           tensor_index);
+    return kTfLiteError;
+  }
+  if (attributes.IsSyncAttributeMap() && IsInput(tensor_index)) {
+    const char* type = nullptr;
+    attributes.GetAttr(kTfLiteSynchronizationAttrKeyObjectTypeName, &type);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (type != nullptr && std::strcmp(type, kCpuSyncTypeSyncFenceFd) == 0) {
+      sync_fence_inputs_.insert(tensor_index);
+    } else {
+      sync_fence_inputs_.erase(tensor_index);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus CpuAsyncKernel::Eval(TfLiteExecutionTask* task) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<int> fences;
+  for (int input : sync_fence_inputs_) {
+    const TfLiteSynchronization* sync =
+        task->task->GetSynchronization(input);
+    const void* fd = sync ? TfLiteSynchronizationGetPtr(sync) : nullptr;
+    if (fd != nullptr && *static_cast<const int*>(fd) != -1) {
+      fences.push_back(*static_cast<const int*>(fd));
+    }
+  }
+  TF_LITE_ENSURE_STATUS(WaitForSyncFences(subgraph_, fences));
+
+  std::vector<const Buffer*> dmabufs;
+  for (const std::vector<int>* tensors :
+       {&subgraph_->inputs(), &subgraph_->outputs()}) {
+    for (int tensor_index : *tensors) {
+      const TfLiteBufferHandle handle =
+          task->task->GetBufferHandle(tensor_index);
+      if (handle == kTfLiteNullBufferHandle) {
+        if (bound_tensors_.count(tensor_index)) {
+          subgraph_->ReportError(
+              "Tensor %d was bound to a buffer by a previous task and has no "
+              "buffer in this one.",
+              tensor_index);
+          return kTfLiteError;
+        }
+        continue;
+      }
+      const auto it = buffers_.find(handle);
+      if (it == buffers_.end()) {
+        subgraph_->ReportError("Buffer %d is not registered.", handle);
+        return kTfLiteError;
+      }
+      const Buffer& buffer = it->second;
+      TF_LITE_ENSURE_STATUS(subgraph_->SetCustomAllocationForTensor(
+          tensor_index, {buffer.data, buffer.bytes}));
+      bound_tensors_.insert(tensor_index);
+      if (buffer.dmabuf_fd != -1) dmabufs.push_back(&buffer);
+    }
+  }
+  TF_LITE_ENSURE_STATUS(subgraph_->AllocateTensors());
+
+  TfLiteStatus status = kTfLiteOk;
+  size_t num_synced = 0;
+  for (const Buffer* buffer : dmabufs) {
+    status = SyncDmaBuf(subgraph_, buffer->dmabuf_fd, buffer->writable,
+                        /*start=*/true);
+    if (status != kTfLiteOk) break;
+    ++num_synced;
+  }
+  if (status == kTfLiteOk) status = subgraph_->Invoke();
+  for (size_t i = 0; i < num_synced; ++i) {
+    const Buffer& buffer = *dmabufs[i];
+    if (SyncDmaBuf(subgraph_, buffer.dmabuf_fd, buffer.writable,
+                   /*start=*/false) != kTfLiteOk) {
+      status = kTfLiteError;
+    }
+  }
+  return status;
+}
+
+}  // namespace async
+}  // namespace tflite
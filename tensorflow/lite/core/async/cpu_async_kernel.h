@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
+
+#include <cstddef>
+#include <map>
+#include <mutex>  // NOLINT(build/c++11)
+#include <set>
+#include <vector>
+
+#include "tensorflow/lite/core/async/async_kernel_internal.h"
+#include "tensorflow/lite/core/async/c/types.h"
+#include "tensorflow/lite/core/async/interop/attribute_map_internal.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+
+namespace tflite {
+namespace async {
+
+// Buffer type name of host memory. The TfLiteBackendBuffer holds the address
+// of the memory, and the buffer attributes must include its size.
+constexpr char kCpuBufferTypeHostMemory[] = "host_memory";
+
+// Buffer type name of a Linux DMA-BUF, which is mapped into host memory while
+// it is registered. The TfLiteBackendBuffer holds a pointer to the file
+// descriptor, and the buffer attributes must include its size.
+constexpr char kCpuBufferTypeDmaBuf[] = "dmabuf";
+
+// Synchronization type name of a sync fence file descriptor. The
+// TfLiteSynchronization holds a pointer to the file descriptor.
+constexpr char kCpuSyncTypeSyncFenceFd[] = "sync_fence_fd";
+
+// Async kernel which runs a subgraph with its CPU kernels, for subgraphs which
+// are not fully delegated to a backend supporting asynchronous execution.
+//
+// Registered buffers are bound as the custom allocations of the I/O tensors,
+// so the kernels read and write them without copies. Once bound, an I/O tensor
+// must be given a buffer by every later task. The subgraph runs on the thread
+// calling InvokeAsync, after waiting for the sync fences of its inputs, so its
+// outputs are ready when InvokeAsync returns and their synchronization type
+// must be kTfLiteSyncTypeNoSyncObj.
+//
+// Buffers must be aligned to kDefaultTensorAlignment. DMA-BUFs and sync fences
+// are only supported on Linux.
+class CpuAsyncKernel {
+ public:
+  // `subgraph` must outlive this kernel.
+  explicit CpuAsyncKernel(Subgraph* subgraph);
+  ~CpuAsyncKernel();
+
+  TfLiteAsyncKernel* kernel() { return &kernel_; }
+
+ private:
+  struct Buffer {
+    char* data = nullptr;
+    size_t bytes = 0;
+    // Whether the buffer was registered as an output.
+    bool writable = false;
+    // The file descriptor of a DMA-BUF, whose mapping this buffer owns if it
+    // is not a slice, or -1.
+    int dmabuf_fd = -1;
+    bool is_slice = false;
+  };
+
+  TfLiteStatus RegisterBuffer(TfLiteIoType io_type,
+                              const TfLiteBackendBuffer* buffer,
+                              const TfLiteAttributeMap* attrs,
+                              TfLiteBufferHandle handle);
+  TfLiteStatus RegisterBufferSlice(TfLiteBufferHandle buffer_pool,
+                                   const TfLiteAttributeMap* attrs,
+                                   TfLiteBufferHandle handle);
+  TfLiteStatus UnregisterBuffer(TfLiteBufferHandle handle);
+  bool ReconcileRestrictions(int tensor_index,
+                             const TfLiteAttributeMap* user_provided_attributes,
+                             TfLiteAttributeMap* merged,
+                             TfLiteAttributeMap* conflict) const;
+  TfLiteStatus SetAttributes(int tensor_index, const TfLiteAttributeMap* attrs);
+  TfLiteStatus Eval(TfLiteExecutionTask* task);
+
+  // Returns the attributes the kernel requires for the I/O tensor at
+  // `tensor_index`, adopting the buffer or synchronization type of `attrs` if
+  // it is supported.
+  interop::AttributeMap Requirements(int tensor_index,
+                                     const interop::AttributeMap& attrs) const;
+
+  // Returns the supported buffer or synchronization types of `io_type`.
+  const std::vector<const char*>& SupportedTypes(TfLiteAttrMapType attr_type,
+                                                 TfLiteIoType io_type) const;
+
+  bool IsInput(int tensor_index) const;
+
+  // Not owned.
+  Subgraph* subgraph_;
+  TfLiteAsyncKernel kernel_;
+
+  std::vector<const char*> buffer_types_;
+  std::vector<const char*> input_sync_types_;
+  std::vector<const char*> output_sync_types_;
+
+  // Guards the members below, and serializes executions.
+  mutable std::mutex mutex_;
+  std::map<TfLiteBufferHandle, Buffer> buffers_;
+  // The inputs whose synchronization type is kCpuSyncTypeSyncFenceFd.
+  std::set<int> sync_fence_inputs_;
+  // The I/O tensors bound to a registered buffer by a previous task.
+  std::set<int> bound_tensors_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_CPU_ASYNC_KERNEL_H_
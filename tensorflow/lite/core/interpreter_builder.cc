@@ -224,7 +224,8 @@ InterpreterBuilder::InterpreterBuilder(
       op_resolver_(op_resolver),
       error_reporter_(ValidateErrorReporter(model.error_reporter())),
       metadata_(model.ReadAllMetadata()),
-      allocation_(model.allocation()) {
+      allocation_(model.allocation()),
+      external_weights_(model.external_weights()) {
   if (options_experimental) {
     options_ = *options_experimental;
   }
@@ -627,6 +628,9 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     if (type == kTfLiteFloat32) {
       ++num_fp32_tensors_;
     }
+    // The data of constant buffers in the external weights is mapped by the
+    // subgraph while it is used, from `external_weights_offset`.
+    size_t external_weights_offset = 0;
     auto get_readonly_data = [&](const char** buffer_data,
                                  size_t* buffer_size) {
       // TODO(aselle): Check what happens if we have an unspecified size
@@ -646,6 +650,18 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
           *buffer_size = array->size();
           *buffer_data = reinterpret_cast<const char*>(array->data());
           return kTfLiteOk;
+        } else if (offset > 1 && external_weights_) {
+          if (buffer->size() > external_weights_->bytes() ||
+              offset > external_weights_->bytes() - buffer->size()) {
+            TF_LITE_REPORT_ERROR(error_reporter_,
+                                 "Constant buffer %d specified an out of range "
+                                 "offset in the external weights.\n",
+                                 tensor->buffer());
+            return kTfLiteError;
+          }
+          *buffer_size = buffer->size();
+          external_weights_offset = offset;
+          return kTfLiteOk;
         } else if (offset > 1 && allocation_) {
           if (offset + buffer->size() > allocation_->bytes()) {
             TF_LITE_REPORT_ERROR(
@@ -681,7 +697,7 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
     }
 
     bool is_variable = tensor->is_variable();
-    if (buffer_ptr) {
+    if (buffer_ptr || external_weights_offset > 0) {
       if (is_variable) {
         TF_LITE_REPORT_ERROR(error_reporter_,
                              "Tensor %d is a variable tensor with buffer. "
@@ -701,11 +717,15 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
 
       if (subgraph->SetTensorParametersReadOnly(
               i, type, get_name(tensor), dims, quantization, buffer_ptr,
-              buffer_size, allocation_, sparsity) != kTfLiteOk) {
+              buffer_size,
+              external_weights_offset > 0 ? nullptr : allocation_,
+              sparsity) != kTfLiteOk) {
         TF_LITE_REPORT_ERROR(error_reporter_,
                              "Tensor %d is invalidly specified in schema.\n",
                              i);
         status = kTfLiteError;
+      } else if (external_weights_offset > 0) {
+        subgraph->SetExternalWeightsTensor(i, external_weights_offset);
       }
     } else {
       if (subgraph->SetTensorParametersReadWrite(
@@ -841,6 +861,7 @@ TfLiteStatus InterpreterBuilder::operator()(
     tflite::Subgraph* modified_subgraph =
         (*interpreter)->subgraph(subgraph_index);
     modified_subgraph->allocation_ = allocation_;
+    modified_subgraph->external_weights_ = external_weights_;
     auto* subgraph_info =
         telemetry_registered
             ? &telemetry_settings->subgraph_infos[subgraph_index]
@@ -162,6 +162,7 @@ class InterpreterBuilder {
   std::vector<TfLiteRegistration> unresolved_custom_ops_;
   std::vector<BuiltinOperator> flatbuffer_op_index_to_registration_types_;
   const Allocation* allocation_ = nullptr;
+  ExternalWeightsFile* external_weights_ = nullptr;
 
   bool has_flex_op_ = false;
   int num_fp32_tensors_ = 0;
@@ -84,6 +84,26 @@ std::unique_ptr<FlatBufferModel> FlatBufferModel::VerifyAndBuildFromFile(
 #endif
 }
 
+std::unique_ptr<FlatBufferModel>
+FlatBufferModel::BuildFromFileWithExternalWeights(
+    const char* filename, const char* weights_filename,
+    ErrorReporter* error_reporter) {
+  error_reporter = ValidateErrorReporter(error_reporter);
+  if (!ExternalWeightsFile::IsSupported()) {
+    TF_LITE_REPORT_ERROR(error_reporter,
+                         "External weights require mmap support.");
+    return nullptr;
+  }
+  auto external_weights =
+      std::make_unique<ExternalWeightsFile>(weights_filename, error_reporter);
+  if (!external_weights->valid()) return nullptr;
+  std::unique_ptr<FlatBufferModel> model =
+      BuildFromFile(filename, error_reporter);
+  if (!model) return nullptr;
+  model->external_weights_ = std::move(external_weights);
+  return model;
+}
+
 }  // namespace impl
 
 #endif
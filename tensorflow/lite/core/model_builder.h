@@ -95,6 +95,21 @@ class FlatBufferModel {
       const char* filename, TfLiteVerifier* extra_verifier = nullptr,
       ErrorReporter* error_reporter = DefaultErrorReporter());
 
+  /// Builds a model based on a file, whose constant buffers stored outside of
+  /// the flatbuffer (those with an `offset` and without `data`) are read from
+  /// `weights_filename` instead of `filename`, at their offset in it. The
+  /// weights file is not mapped as a whole: the buffers of each subgraph or
+  /// each operator are mapped while they are used, if
+  /// `InterpreterOptions::SetMapExternalWeightsPerOp()` is set, and unmapped
+  /// afterwards, so that it can be larger than the RAM or the address space
+  /// of the device. See `ExternalWeightsFile`.
+  /// Caller retains ownership of `error_reporter` and must ensure its lifetime
+  /// is longer than the FlatBufferModel instance.
+  /// Returns a nullptr in case of failure, or if mmap isn't supported.
+  static std::unique_ptr<FlatBufferModel> BuildFromFileWithExternalWeights(
+      const char* filename, const char* weights_filename,
+      ErrorReporter* error_reporter = DefaultErrorReporter());
+
   /// Builds a model based on a pre-loaded flatbuffer.
   /// Caller retains ownership of the buffer and should keep it alive until
   /// the returned object is destroyed. Caller also retains ownership of
@@ -199,6 +214,11 @@ class FlatBufferModel {
   const tflite::Model* GetModel() const { return model_; }
   ErrorReporter* error_reporter() const { return error_reporter_; }
   const Allocation* allocation() const { return allocation_.get(); }
+  /// The file of the constant buffers stored outside of the model, or null if
+  /// they are in the model's allocation.
+  ExternalWeightsFile* external_weights() const {
+    return external_weights_.get();
+  }
 
   // Returns the minimum runtime version from the flatbuffer. This runtime
   // version encodes the minimum required interpreter version to run the
@@ -258,6 +278,9 @@ class FlatBufferModel {
   /// The allocator used for holding memory of the model. Note that this will
   /// be null if the client provides a tflite::Model directly.
   std::unique_ptr<Allocation> allocation_;
+  /// The file of the constant buffers stored outside of the model, if it was
+  /// built with BuildFromFileWithExternalWeights.
+  std::unique_ptr<ExternalWeightsFile> external_weights_;
 };
 
 }  // namespace impl
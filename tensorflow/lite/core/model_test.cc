@@ -815,6 +815,138 @@ TEST(BasicFlatBufferModel, TestHandleZeroSizeConstant) {
   ASSERT_EQ(interpreter->tensor(1)->allocation_type, kTfLiteMmapRo);
 }
 
+// Writes a model which adds a constant tensor to its input, with the data of
+// the constant tensor at `weights_offset` in a separate weights file, and
+// returns the paths of the model and the weights.
+std::pair<std::string, std::string> WriteModelWithExternalWeights(
+    const std::string& name, const std::vector<float>& weights,
+    size_t weights_offset) {
+  flatbuffers::FlatBufferBuilder builder;
+  const int32_t shape[1] = {static_cast<int32_t>(weights.size())};
+  flatbuffers::Offset<Tensor> tensors[3] = {
+      CreateTensor(builder, builder.CreateVector<int32_t>(shape, 1),
+                   TensorType_FLOAT32, /*buffer=*/0, builder.CreateString("X")),
+      CreateTensor(builder, builder.CreateVector<int32_t>(shape, 1),
+                   TensorType_FLOAT32, /*buffer=*/1, builder.CreateString("W")),
+      CreateTensor(builder, builder.CreateVector<int32_t>(shape, 1),
+                   TensorType_FLOAT32, /*buffer=*/0, builder.CreateString("Y")),
+  };
+  flatbuffers::Offset<OperatorCode> op_code =
+      CreateOperatorCode(builder, BuiltinOperator_ADD, /*custom_code=*/0,
+                         /*version=*/1, BuiltinOperator_ADD);
+  const int32_t op_inputs[2] = {0, 1};
+  const int32_t inputs[1] = {0};
+  const int32_t outputs[1] = {2};
+  flatbuffers::Offset<Operator> op = CreateOperator(
+      builder, /*opcode_index=*/0, builder.CreateVector<int32_t>(op_inputs, 2),
+      builder.CreateVector<int32_t>(outputs, 1), BuiltinOptions_AddOptions,
+      CreateAddOptions(builder).Union());
+  flatbuffers::Offset<SubGraph> subgraph =
+      CreateSubGraph(builder, builder.CreateVector(tensors, 3),
+                     builder.CreateVector<int32_t>(inputs, 1),
+                     builder.CreateVector<int32_t>(outputs, 1),
+                     builder.CreateVector(&op, 1), /*name=*/0);
+  flatbuffers::Offset<Buffer> buffers[2] = {
+      CreateBuffer(builder, builder.CreateVector({})),
+      CreateBuffer(builder, /*data=*/0, /*offset=*/weights_offset,
+                   /*size=*/weights.size() * sizeof(float)),
+  };
+  FinishModelBuffer(
+      builder,
+      CreateModel(builder, TFLITE_SCHEMA_VERSION,
+                  builder.CreateVector(&op_code, 1),
+                  builder.CreateVector(&subgraph, 1),
+                  builder.CreateString("external_weights"),
+                  builder.CreateVector(buffers, 2)));
+
+  const std::string model_path = ::testing::TempDir() + "/" + name + ".tflite";
+  std::ofstream model_file(model_path, std::ios::binary);
+  model_file.write(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                   builder.GetSize());
+  model_file.close();
+
+  const std::string weights_path = ::testing::TempDir() + "/" + name + ".bin";
+  std::ofstream weights_file(weights_path, std::ios::binary);
+  const std::string padding(weights_offset, '\0');
+  weights_file.write(padding.data(), padding.size());
+  weights_file.write(reinterpret_cast<const char*>(weights.data()),
+                     weights.size() * sizeof(float));
+  weights_file.close();
+  return {model_path, weights_path};
+}
+
+void TestModelWithExternalWeights(bool map_external_weights_per_op) {
+  // The offset isn't page aligned.
+  const std::vector<float> weights = {1.0f, 2.0f, 3.0f};
+  const auto [model_path, weights_path] = WriteModelWithExternalWeights(
+      map_external_weights_per_op ? "external_weights_per_op"
+                                  : "external_weights",
+      weights, /*weights_offset=*/4100);
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFileWithExternalWeights(model_path.c_str(),
+                                                        weights_path.c_str());
+  ASSERT_NE(model, nullptr);
+  ExternalWeightsFile* external_weights = model->external_weights();
+  ASSERT_NE(external_weights, nullptr);
+
+  InterpreterOptions options;
+  options.SetMapExternalWeightsPerOp(map_external_weights_per_op);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterBuilder builder(*model, resolver, &options);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_NE(interpreter, nullptr);
+  ASSERT_EQ(interpreter->tensor(1)->allocation_type, kTfLiteMmapRo);
+  ASSERT_EQ(interpreter->AllocateTensors(), kTfLiteOk);
+  // The weights are only mapped while they are used.
+  EXPECT_EQ(interpreter->tensor(1)->data.raw, nullptr);
+  EXPECT_EQ(external_weights->mapped_bytes(), 0);
+
+  for (int i = 0; i < 2; ++i) {
+    float* input = interpreter->typed_input_tensor<float>(0);
+    input[0] = 10.0f;
+    input[1] = 20.0f;
+    input[2] = 30.0f;
+    ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+    const float* output = interpreter->typed_output_tensor<float>(0);
+    EXPECT_EQ(output[0], 11.0f);
+    EXPECT_EQ(output[1], 22.0f);
+    EXPECT_EQ(output[2], 33.0f);
+    EXPECT_EQ(interpreter->tensor(1)->data.raw, nullptr);
+    EXPECT_EQ(external_weights->mapped_bytes(), 0);
+  }
+}
+
+TEST(BasicFlatBufferModel, TestExternalWeightsMappedPerSubgraph) {
+  TestModelWithExternalWeights(/*map_external_weights_per_op=*/false);
+}
+
+TEST(BasicFlatBufferModel, TestExternalWeightsMappedPerOp) {
+  TestModelWithExternalWeights(/*map_external_weights_per_op=*/true);
+}
+
+TEST(BasicFlatBufferModel, TestExternalWeightsOutOfRange) {
+  const std::vector<float> weights = {1.0f, 2.0f, 3.0f};
+  const auto [model_path, weights_path] = WriteModelWithExternalWeights(
+      "external_weights_out_of_range", weights, /*weights_offset=*/1 << 20);
+  // The weights are read from a file which is too small.
+  std::unique_ptr<FlatBufferModel> truncated_model =
+      FlatBufferModel::BuildFromFileWithExternalWeights(
+          model_path.c_str(), "tensorflow/lite/testdata/empty_model.bin");
+  ASSERT_NE(truncated_model, nullptr);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  std::unique_ptr<Interpreter> interpreter;
+  EXPECT_NE(InterpreterBuilder(*truncated_model, resolver)(&interpreter),
+            kTfLiteOk);
+}
+
+TEST(BasicFlatBufferModel, TestExternalWeightsInvalidFile) {
+  EXPECT_EQ(FlatBufferModel::BuildFromFileWithExternalWeights(
+                "tensorflow/lite/testdata/test_model.bin",
+                "/tmp/tflite_weights_1234"),
+            nullptr);
+}
+
 // TODO(aselle): Add tests for serialization of builtin op data types.
 // These tests will occur with the evaluation tests of individual operators,
 // not here.
@@ -113,5 +113,21 @@ TfLiteStatus SignatureRunner::SetCustomAllocationForOutputTensor(
   return subgraph_->SetCustomAllocationForTensor(it->second, allocation, flags);
 }
 
+TfLiteStatus SignatureRunner::SetPersistentStateTensor(
+    const char* input_name, const char* output_name) {
+  const auto& input_it = signature_def_->inputs.find(input_name);
+  if (input_it == signature_def_->inputs.end()) {
+    subgraph_->ReportError("Input name %s was not found", input_name);
+    return kTfLiteError;
+  }
+  const auto& output_it = signature_def_->outputs.find(output_name);
+  if (output_it == signature_def_->outputs.end()) {
+    subgraph_->ReportError("Output name %s was not found", output_name);
+    return kTfLiteError;
+  }
+  return subgraph_->SetPersistentStateTensor(input_it->second,
+                                             output_it->second);
+}
+
 }  // namespace impl
 }  // namespace tflite
@@ -204,6 +204,17 @@ class SignatureRunner {
       const char* output_name, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  /// \brief Binds the given input and output into a persistent state tensor,
+  /// such as the key-value cache of a decoder, which the runtime keeps in a
+  /// single buffer and updates in place across invocations instead of
+  /// requiring the output to be copied back into the input. See
+  /// Subgraph::SetPersistentStateTensor for the requirements on the graph.
+  ///
+  /// NOTE: User needs to call AllocateTensors() after this.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus SetPersistentStateTensor(const char* input_name,
+                                        const char* output_name);
+
   /// \brief Set if buffer handle output is allowed.
   ///
   /// When using hardware delegation, Interpreter will make the data of output
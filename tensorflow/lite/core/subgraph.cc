@@ -17,14 +17,19 @@ limitations under the License.
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
 #include <cstdarg>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <numeric>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -40,6 +45,7 @@ limitations under the License.
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -190,8 +196,136 @@ TfLiteStatus VerifyCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+// Returns true if 'node' may write its output 'output_index' to the buffer
+// of its input 'input_index'.
+bool OpUpdatesInputInPlace(const TfLiteNode& node,
+                           const TfLiteRegistration& registration,
+                           int input_index, int output_index) {
+  const bool shared_with_corresponding_output =
+      registration.inplace_operator &
+      kTfLiteInplaceInputCanBeSharedWithCorrespondingOutput;
+  const int loop_end = std::min(kTfLiteMaxSharableOpInputs, node.inputs->size);
+  for (int i = 0; i < loop_end; ++i) {
+    const bool input_shareable =
+        registration.inplace_operator & (kTfLiteInplaceOpInput0Shared << i);
+    if (node.inputs->data[i] != input_index || !input_shareable) continue;
+    const int shared_output = shared_with_corresponding_output ? i : 0;
+    if (shared_output < node.outputs->size &&
+        node.outputs->data[shared_output] == output_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The CPU backend context of the Subgraph::ParallelExecutor worker running on
+// this thread, or nullptr if this thread is not such a worker.
+thread_local TfLiteExternalContext* worker_cpu_backend_context = nullptr;
+
 }  // namespace
 
+// The caller of ParallelFor() runs tasks too, so that a pool of N threads has
+// N - 1 workers. The CPU backend context of the interpreter is not safe to
+// use from several threads, so each worker has its own, which is limited to
+// a single thread once the kernels created it.
+class Subgraph::ParallelExecutor {
+ public:
+  explicit ParallelExecutor(int num_threads) {
+    for (int i = 0; i < num_threads - 1; ++i) {
+      cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+    for (int i = 0; i < num_threads - 1; ++i) {
+      workers_.emplace_back([this, i] { WorkerLoop(i); });
+    }
+  }
+
+  ~ParallelExecutor() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    work_available_.notify_all();
+    for (auto& worker : workers_) worker.join();
+  }
+
+  // Calls `task(i)` for each i in [0, num_tasks) and returns once all the
+  // calls have returned.
+  void ParallelFor(int num_tasks, const std::function<void(int)>& task) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      task_ = &task;
+      num_tasks_ = num_tasks;
+      next_task_ = 0;
+      num_pending_tasks_ = num_tasks;
+      ++generation_;
+    }
+    work_available_.notify_all();
+    RunTasks();
+    std::unique_lock<std::mutex> lock(mutex_);
+    work_done_.wait(lock, [this] { return num_pending_tasks_ == 0; });
+    task_ = nullptr;
+  }
+
+ private:
+  // Runs tasks of the current ParallelFor() until none is left.
+  void RunTasks() {
+    while (true) {
+      const std::function<void(int)>* task;
+      int task_index;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (next_task_ >= num_tasks_) return;
+        task = task_;
+        task_index = next_task_++;
+      }
+      (*task)(task_index);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_pending_tasks_ == 0) work_done_.notify_all();
+    }
+  }
+
+  void WorkerLoop(int worker_index) {
+    ExternalCpuBackendContext* cpu_backend_context =
+        cpu_backend_contexts_[worker_index].get();
+    worker_cpu_backend_context = cpu_backend_context;
+    bool single_threaded = false;
+    int64_t generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        work_available_.wait(lock, [this, generation] {
+          return stopped_ || generation_ != generation;
+        });
+        if (stopped_) return;
+        generation = generation_;
+      }
+      RunTasks();
+      if (!single_threaded &&
+          cpu_backend_context->internal_backend_context() != nullptr) {
+        cpu_backend_context->internal_backend_context()->SetMaxNumThreads(1);
+        single_threaded = true;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      cpu_backend_contexts_;
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  const std::function<void(int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_pending_tasks_ = 0;
+  // Incremented by each ParallelFor(), so that the workers wake up once per
+  // call.
+  int64_t generation_ = 0;
+  bool stopped_ = false;
+};
+
 // A trivial implementation of GraphInfo around the Interpreter.
 // NOTE: this interpreter info represents the subset of the
 // graph that is executed according to execution plan. Thus,
@@ -286,6 +420,10 @@ Subgraph::Subgraph(ErrorReporter* error_reporter,
 }
 
 Subgraph::~Subgraph() {
+  for (auto& [tensor_index, weights] : external_weights_tensors_) {
+    weights.pinned = false;
+  }
+  UnmapAllExternalWeights();
   for (int node_index = 0; node_index < nodes_and_registration_.size();
        ++node_index) {
     CleanupNode(node_index);
@@ -494,9 +632,76 @@ const char* GetDelegateKernalName(const TfLiteRegistration& registration) {
 TfLiteStatus Subgraph::PartitionGraph(const TfLiteIntArray* nodes_to_replace,
                                       std::vector<NodeSubset>* node_subsets) {
   const InterpreterInfo info(this);
-  return PartitionGraphIntoIndependentNodeSubsets(
+  TF_LITE_ENSURE_STATUS(PartitionGraphIntoIndependentNodeSubsets(
       &info, nodes_to_replace, node_subsets,
-      /*greedily=*/!DisableDelegateClustering(), control_edges_);
+      /*greedily=*/!DisableDelegateClustering(), control_edges_));
+  if (!options_ || options_->GetDelegatePartitionSpeedup() <= 0) {
+    return kTfLiteOk;
+  }
+
+  // Move the delegated subset with the lowest estimated gain back to CPU until
+  // all the remaining ones pay off. Each move changes the tensors exchanged by
+  // the neighbouring subsets, so the graph is partitioned again after it.
+  std::vector<int> delegated_nodes(
+      nodes_to_replace->data, nodes_to_replace->data + nodes_to_replace->size);
+  while (true) {
+    const NodeSubset* worst_subset = nullptr;
+    double worst_gain = 0;
+    for (const NodeSubset& node_subset : *node_subsets) {
+      if (node_subset.type != NodeSubset::kTfPartition) continue;
+      const double gain = EstimateDelegationGain(node_subset);
+      if (gain < worst_gain) {
+        worst_subset = &node_subset;
+        worst_gain = gain;
+      }
+    }
+    if (worst_subset == nullptr) return kTfLiteOk;
+
+    const std::unordered_set<int> cpu_nodes(worst_subset->nodes.begin(),
+                                            worst_subset->nodes.end());
+    delegated_nodes.erase(
+        std::remove_if(delegated_nodes.begin(), delegated_nodes.end(),
+                       [&](int node_index) {
+                         return cpu_nodes.count(node_index) != 0;
+                       }),
+        delegated_nodes.end());
+    IntArrayUniquePtr delegated_nodes_array = BuildTfLiteArray(delegated_nodes);
+    TF_LITE_ENSURE_STATUS(PartitionGraphIntoIndependentNodeSubsets(
+        &info, delegated_nodes_array.get(), node_subsets,
+        /*greedily=*/!DisableDelegateClustering(), control_edges_));
+  }
+}
+
+double Subgraph::EstimateDelegationGain(const NodeSubset& node_subset) const {
+  auto bytes = [this](int tensor_index) -> double {
+    return tensor_index == kTfLiteOptionalTensor ? 0
+                                                 : tensors_[tensor_index].bytes;
+  };
+  double cpu_cost = 0;
+  for (int node_index : node_subset.nodes) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      cpu_cost += bytes(tensor_index);
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      cpu_cost += bytes(tensor_index);
+    }
+  }
+  // Constant tensors are usually prepared by the delegate once, so only the
+  // other tensors crossing the subset boundary are transferred.
+  double transferred_bytes = 0;
+  for (int tensor_index : node_subset.input_tensors) {
+    if (tensor_index == kTfLiteOptionalTensor ||
+        tensors_[tensor_index].allocation_type == kTfLiteMmapRo) {
+      continue;
+    }
+    transferred_bytes += bytes(tensor_index);
+  }
+  for (int tensor_index : node_subset.output_tensors) {
+    transferred_bytes += bytes(tensor_index);
+  }
+  return cpu_cost - cpu_cost / options_->GetDelegatePartitionSpeedup() -
+         transferred_bytes * options_->GetDelegatePartitionTransferCost();
 }
 
 TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
@@ -562,6 +767,20 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
                   "for the whole graph.",
                   nodes_to_replace->size, execution_plan_.size(),
                   GetDelegateKernalName(registration), node_subsets.size());
+  if (options_ && options_->GetDelegatePartitionSpeedup() > 0) {
+    int num_delegated_nodes = 0;
+    for (const NodeSubset& node_subset : node_subsets) {
+      if (node_subset.type == NodeSubset::kTfPartition) {
+        num_delegated_nodes += node_subset.nodes.size();
+      }
+    }
+    TFLITE_LOG_PROD(tflite::TFLITE_LOG_INFO,
+                    "Delegate partition cost model moved %d out of %d "
+                    "node(s) claimed by delegate (%s) back to CPU.",
+                    nodes_to_replace->size - num_delegated_nodes,
+                    nodes_to_replace->size,
+                    GetDelegateKernalName(registration));
+  }
 
   execution_plan_.clear();
 
@@ -615,6 +834,10 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      worker_cpu_backend_context != nullptr) {
+    return worker_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1003,7 +1226,14 @@ TfLiteStatus Subgraph::AllocateTensors() {
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
+  TF_LITE_ENSURE_STATUS(AllocatePersistentStateTensors());
+  bool schedule_changed = false;
+  ScheduleConcurrentNodes(&schedule_changed);
   if (memory_planner_) {
+    if (schedule_changed) {
+      memory_planner_->SetConcurrentNodeRanges(ConcurrentNodeRanges());
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
@@ -1467,7 +1697,9 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     tflite::OnTfLiteOpPrepare(GetTFLiteOpName(registration), subgraph_index_,
                               node_index);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
+    TF_LITE_ENSURE_STATUS(MapExternalWeights(node.inputs));
     const TfLiteStatus op_prepare_status = OpPrepare(registration, &node);
+    UnmapExternalWeights(node.inputs);
     if (op_prepare_status != kTfLiteOk) {
       ReportOpError(&context_, node, registration, node_index,
                     "failed to prepare");
@@ -1523,8 +1755,10 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
 #else
     memory_planner_ = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
-        kDefaultTensorAlignment, subgraph_index_);
+        kDefaultTensorAlignment, subgraph_index_,
+        ShouldReuseMemoryPlanOnResize());
 #endif
+    memory_planner_->SetConcurrentNodeRanges(ConcurrentNodeRanges());
     memory_planner_->PlanAllocations();
   }
 
@@ -1578,7 +1812,12 @@ TfLiteStatus Subgraph::RemoveUnusedInputs() {
 }
 
 TfLiteStatus Subgraph::Invoke() {
-  auto status = InvokeImpl();
+  // Unless they are mapped for each op, the external weights are mapped for
+  // the whole invocation.
+  TfLiteStatus status =
+      ShouldMapExternalWeightsPerOp() ? kTfLiteOk : MapAllExternalWeights();
+  if (status == kTfLiteOk) status = InvokeImpl();
+  UnmapAllExternalWeights();
   telemetry::TelemetryReportEvent(&context_, "Invoke", status);
   return status;
 }
@@ -1602,10 +1841,12 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order, except for the nodes of a
+  // concurrent range when they can be invoked concurrently.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
+  const bool invoke_concurrently = CanInvokeNodesConcurrently();
   for (int execution_plan_index = 0;
        execution_plan_index < execution_plan_.size(); execution_plan_index++) {
     if (execution_plan_index == next_execution_plan_index_to_prepare_) {
@@ -1613,6 +1854,15 @@ TfLiteStatus Subgraph::InvokeImpl() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    if (invoke_concurrently &&
+        concurrent_range_end_[execution_plan_index] >
+            execution_plan_index + 1) {
+      const int range_end = concurrent_range_end_[execution_plan_index];
+      TF_LITE_ENSURE_STATUS(
+          InvokeNodesConcurrently(execution_plan_index, range_end));
+      execution_plan_index = range_end - 1;
+      continue;
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1636,52 +1886,16 @@ TfLiteStatus Subgraph::InvokeImpl() {
     TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE(
         profile_op ? profiler_.get() : nullptr, op_name, node_index);
 
-    for (int i = 0; i < node.inputs->size; ++i) {
-      int tensor_index = node.inputs->data[i];
-      if (tensor_index == kTfLiteOptionalTensor) {
-        continue;
-      }
-      TfLiteTensor* tensor = &tensors_[tensor_index];
-      if (tensor->delegate && tensor->delegate != node.delegate &&
-          tensor->data_is_stale) {
-        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
-      }
-      if (tensor->data.raw == nullptr && tensor->bytes > 0) {
-        if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
-            tensor->dims->size != 1) {
-          // In general, having a tensor here with no buffer will be an error.
-          // However, for the reshape operator, the second input tensor is
-          // sometimes only used for the shape, not for the data. Thus, null
-          // buffer is ok in this situation.
-          // The situation where null buffer is not ok for reshape operator is
-          // only when there are 2 inputs given to the node and the one
-          // corresponding to the shape (i == 1) is a vector that contains all
-          // dimensions. See `GetOutputShape()` function in
-          // `tensorflow/lite/kernels/reshape.cc`
-          continue;
-        } else {
-          // In all other cases, we need to return an error as otherwise we will
-          // trigger a null pointer dereference (likely).
-          ReportError("Input tensor %d lacks data", tensor_index);
-          return kTfLiteError;
-        }
-      }
+    const bool map_external_weights = ShouldMapExternalWeightsPerOp();
+    if (map_external_weights) {
+      TF_LITE_ENSURE_STATUS(MapExternalWeights(node.inputs));
     }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
     // Allocate dynamic tensors which memory is required to be allocated
     // before executing the node.
     MayAllocateOpOutput(&node);
 
-    if (check_cancelled_func_ != nullptr &&
-        check_cancelled_func_(cancellation_data_)) {
-      ReportError("Client requested cancel during Invoke()");
-      return kTfLiteError;
-    }
-
-    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
-      // `Cancel` is called and cancellation flag is flipped.
-      ReportError("Client requested cancel during Invoke()");
-      return kTfLiteCancelled;
-    }
+    TF_LITE_ENSURE_STATUS(CheckCancelled());
 
     EnsureTensorsVectorCapacity();
     tensor_resized_since_op_invoke_ = false;
@@ -1690,6 +1904,7 @@ TfLiteStatus Subgraph::InvokeImpl() {
                                "failed to invoke");
       return s == kTfLiteCancelled ? s : err;
     }
+    if (map_external_weights) UnmapExternalWeights(node.inputs);
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -1723,6 +1938,309 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+void Subgraph::SetExternalWeightsTensor(int tensor_index, size_t offset) {
+  TfLiteTensor& tensor = tensors_[tensor_index];
+  // Empty buffers have no data to map.
+  if (tensor.bytes == 0) return;
+  tensor.data.raw = nullptr;
+  external_weights_tensors_[tensor_index] = {offset, tensor.bytes};
+}
+
+TfLiteStatus Subgraph::MapExternalWeights(
+    const TfLiteIntArray* tensor_indices) {
+  if (external_weights_tensors_.empty()) return kTfLiteOk;
+  for (int i = 0; i < tensor_indices->size; ++i) {
+    auto it = external_weights_tensors_.find(tensor_indices->data[i]);
+    if (it == external_weights_tensors_.end() || it->second.pinned) continue;
+    ExternalWeightsTensor& weights = it->second;
+    if (weights.map_count == 0) {
+      const void* data = external_weights_->Map(weights.offset, weights.bytes);
+      if (data == nullptr) {
+        ReportError("Failed to map the external weights of tensor %d.",
+                    it->first);
+        // Remove the users added to the tensors before this one.
+        TfLiteIntArray* mapped_tensor_indices = TfLiteIntArrayCreate(i);
+        std::copy(tensor_indices->data, tensor_indices->data + i,
+                  mapped_tensor_indices->data);
+        UnmapExternalWeights(mapped_tensor_indices);
+        TfLiteIntArrayFree(mapped_tensor_indices);
+        return kTfLiteError;
+      }
+      tensors_[it->first].data.raw =
+          const_cast<char*>(static_cast<const char*>(data));
+    }
+    ++weights.map_count;
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::UnmapExternalWeights(const TfLiteIntArray* tensor_indices) {
+  if (external_weights_tensors_.empty()) return;
+  for (int i = 0; i < tensor_indices->size; ++i) {
+    auto it = external_weights_tensors_.find(tensor_indices->data[i]);
+    if (it == external_weights_tensors_.end() || it->second.pinned) continue;
+    ExternalWeightsTensor& weights = it->second;
+    if (weights.map_count == 0 || --weights.map_count > 0) continue;
+    external_weights_->Unmap(weights.offset, weights.bytes);
+    tensors_[it->first].data.raw = nullptr;
+  }
+}
+
+TfLiteStatus Subgraph::MapAllExternalWeights() {
+  if (external_weights_tensors_.empty()) return kTfLiteOk;
+  TfLiteIntArray* tensor_indices =
+      TfLiteIntArrayCreate(external_weights_tensors_.size());
+  int i = 0;
+  for (const auto& [tensor_index, weights] : external_weights_tensors_) {
+    tensor_indices->data[i++] = tensor_index;
+  }
+  const TfLiteStatus status = MapExternalWeights(tensor_indices);
+  TfLiteIntArrayFree(tensor_indices);
+  return status;
+}
+
+void Subgraph::UnmapAllExternalWeights() {
+  for (auto& [tensor_index, weights] : external_weights_tensors_) {
+    if (weights.pinned || weights.map_count == 0) continue;
+    weights.map_count = 0;
+    external_weights_->Unmap(weights.offset, weights.bytes);
+    tensors_[tensor_index].data.raw = nullptr;
+  }
+}
+
+TfLiteStatus Subgraph::PinDelegatedExternalWeights() {
+  if (external_weights_tensors_.empty()) return kTfLiteOk;
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (node.delegate == nullptr) continue;
+    TF_LITE_ENSURE_STATUS(MapExternalWeights(node.inputs));
+    for (int i = 0; i < node.inputs->size; ++i) {
+      auto it = external_weights_tensors_.find(node.inputs->data[i]);
+      if (it != external_weights_tensors_.end()) it->second.pinned = true;
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::EnsureNodeInputsAreReadable(
+    const TfLiteNode& node, const TfLiteRegistration& registration) {
+  for (int i = 0; i < node.inputs->size; ++i) {
+    int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    TfLiteTensor* tensor = &tensors_[tensor_index];
+    if (tensor->delegate && tensor->delegate != node.delegate &&
+        tensor->data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    if (tensor->data.raw == nullptr && tensor->bytes > 0) {
+      if (registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor->dims->size != 1) {
+        // In general, having a tensor here with no buffer will be an error.
+        // However, for the reshape operator, the second input tensor is
+        // sometimes only used for the shape, not for the data. Thus, null
+        // buffer is ok in this situation.
+        // The situation where null buffer is not ok for reshape operator is
+        // only when there are 2 inputs given to the node and the one
+        // corresponding to the shape (i == 1) is a vector that contains all
+        // dimensions. See `GetOutputShape()` function in
+        // `tensorflow/lite/kernels/reshape.cc`
+        continue;
+      } else {
+        // In all other cases, we need to return an error as otherwise we will
+        // trigger a null pointer dereference (likely).
+        ReportError("Input tensor %d lacks data", tensor_index);
+        return kTfLiteError;
+      }
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::CheckCancelled() {
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::IsConcurrencyBarrier(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  // Delegate kernels manage their own threads, and custom ops or ops with
+  // subgraphs may touch state which is not visible in the graph.
+  if (node.delegate != nullptr ||
+      registration.builtin_code == kTfLiteBuiltinDelegate ||
+      registration.builtin_code == kTfLiteBuiltinCustom ||
+      registration.builtin_code == kTfLiteBuiltinStablehloReduceWindow ||
+      registration.builtin_code == kTfLiteBuiltinStablehloScatter ||
+      OpMightHaveSideEffect(&node, &registration)) {
+    return true;
+  }
+  // Variables and persistent state tensors are updated in place, and string
+  // and variant tensors are
+  // (re)allocated by the kernels, which is not thread-safe.
+  auto has_shared_state = [this](const TfLiteIntArray* tensor_indices) {
+    for (int i = 0; i < tensor_indices->size; ++i) {
+      const int tensor_index = tensor_indices->data[i];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      if (tensor.is_variable || tensor.type == kTfLiteString ||
+          tensor.type == kTfLiteVariant ||
+          IsPersistentStateTensor(tensor_index)) {
+        return true;
+      }
+    }
+    return false;
+  };
+  return has_shared_state(node.inputs) || has_shared_state(node.outputs);
+}
+
+void Subgraph::ScheduleConcurrentNodes(bool* schedule_changed) {
+  *schedule_changed = false;
+  if (NumParallelNodeExecutionThreads() <= 1 ||
+      (!concurrent_range_end_.empty() &&
+       execution_plan_ == scheduled_execution_plan_)) {
+    return;
+  }
+
+  // The level of a node is one more than the highest level of the nodes
+  // producing its inputs, so nodes of the same level do not depend on each
+  // other. A barrier has a level above all the nodes before it, and all the
+  // nodes after it have a level above it.
+  const int num_nodes = execution_plan_.size();
+  std::vector<int> tensor_level(tensors_.size(), 0);
+  std::vector<int> node_level(num_nodes);
+  int max_level = 0;
+  int barrier_level = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const auto& [node, registration] =
+        nodes_and_registration_[execution_plan_[i]];
+    int level = barrier_level + 1;
+    if (IsConcurrencyBarrier(node, registration)) {
+      level = barrier_level = max_level + 1;
+    } else {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        level = std::max(level, tensor_level[tensor_index] + 1);
+      }
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      tensor_level[tensor_index] = level;
+    }
+    node_level[i] = level;
+    max_level = std::max(max_level, level);
+  }
+
+  // Sorting the nodes by level keeps the plan in dependency order.
+  std::vector<int> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&node_level](int a, int b) {
+    return node_level[a] < node_level[b];
+  });
+  std::vector<int> new_execution_plan(num_nodes);
+  std::vector<int> new_concurrent_range_end(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    new_execution_plan[i] = execution_plan_[order[i]];
+  }
+  for (int begin = 0, end = 0; begin < num_nodes; begin = end) {
+    while (end < num_nodes &&
+           node_level[order[end]] == node_level[order[begin]]) {
+      ++end;
+    }
+    std::fill(new_concurrent_range_end.begin() + begin,
+              new_concurrent_range_end.begin() + end, end);
+  }
+
+  *schedule_changed = new_execution_plan != execution_plan_ ||
+                      new_concurrent_range_end != concurrent_range_end_;
+  execution_plan_ = std::move(new_execution_plan);
+  scheduled_execution_plan_ = execution_plan_;
+  concurrent_range_end_ = std::move(new_concurrent_range_end);
+}
+
+std::vector<std::pair<int, int>> Subgraph::ConcurrentNodeRanges() const {
+  std::vector<std::pair<int, int>> ranges;
+  for (int i = 0; i < concurrent_range_end_.size();
+       i = concurrent_range_end_[i]) {
+    if (concurrent_range_end_[i] > i + 1) {
+      ranges.emplace_back(i, concurrent_range_end_[i] - 1);
+    }
+  }
+  return ranges;
+}
+
+bool Subgraph::CanInvokeNodesConcurrently() const {
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+  return false;
+#else
+  // Nodes with dynamic outputs are prepared during the invocation, which
+  // changes the memory plan of the nodes after them, and the profiler would
+  // record overlapping events as nested ones.
+  return NumParallelNodeExecutionThreads() > 1 &&
+         concurrent_range_end_.size() == execution_plan_.size() &&
+         execution_plan_ == scheduled_execution_plan_ &&
+         next_execution_plan_index_to_prepare_ == execution_plan_.size() &&
+         profiler_ == nullptr;
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+}
+
+TfLiteStatus Subgraph::InvokeNodesConcurrently(int first_execution_plan_index,
+                                               int end_execution_plan_index) {
+  const bool map_external_weights = ShouldMapExternalWeightsPerOp();
+  for (int i = first_execution_plan_index; i < end_execution_plan_index; ++i) {
+    auto& [node, registration] = nodes_and_registration_[execution_plan_[i]];
+    if (map_external_weights) {
+      TF_LITE_ENSURE_STATUS(MapExternalWeights(node.inputs));
+    }
+    TF_LITE_ENSURE_STATUS(EnsureNodeInputsAreReadable(node, registration));
+    MayAllocateOpOutput(&node);
+  }
+
+  TF_LITE_ENSURE_STATUS(CheckCancelled());
+
+  EnsureTensorsVectorCapacity();
+  tensor_resized_since_op_invoke_ = false;
+  if (!parallel_executor_) {
+    parallel_executor_ =
+        std::make_unique<ParallelExecutor>(NumParallelNodeExecutionThreads());
+  }
+  const int num_nodes = end_execution_plan_index - first_execution_plan_index;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  parallel_executor_->ParallelFor(num_nodes, [&](int i) {
+    auto& [node, registration] =
+        nodes_and_registration_
+            [execution_plan_[first_execution_plan_index + i]];
+    statuses[i] = OpInvoke(registration, &node);
+  });
+
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[first_execution_plan_index + i];
+    const auto& [node, registration] = nodes_and_registration_[node_index];
+    if (statuses[i] != kTfLiteOk) {
+      auto err = ReportOpError(&context_, node, registration, node_index,
+                               "failed to invoke");
+      return statuses[i] == kTfLiteCancelled ? statuses[i] : err;
+    }
+  }
+  for (int i = first_execution_plan_index; i < end_execution_plan_index; ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    if (map_external_weights) UnmapExternalWeights(node.inputs);
+    MaybeReleaseDynamicTensors(node, node_index);
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -2166,10 +2684,15 @@ TfLiteStatus Subgraph::RedoAllDelegates() {
   delegates_undone_ = false;
   std::vector<TfLiteDelegate*> delegates_to_apply;
   delegates_applied_.swap(delegates_to_apply);
+  // Delegates may read the constant tensors when they are applied.
+  TfLiteStatus status = MapAllExternalWeights();
   for (auto* delegate : delegates_to_apply) {
-    TF_LITE_ENSURE_STATUS(ModifyGraphWithDelegateImpl(delegate));
+    if (status != kTfLiteOk) break;
+    status = ModifyGraphWithDelegateImpl(delegate);
   }
-  return kTfLiteOk;
+  if (status == kTfLiteOk) status = PinDelegatedExternalWeights();
+  UnmapAllExternalWeights();
+  return status;
 }
 
 TfLiteStatus Subgraph::RemoveAllDelegates() {
@@ -2215,7 +2738,11 @@ TfLiteStatus Subgraph::EnsureMemoryAllocations() {
 }
 
 TfLiteStatus Subgraph::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
-  auto status = ModifyGraphWithDelegateImpl(delegate);
+  // Delegates may read the constant tensors when they are applied.
+  TfLiteStatus status = MapAllExternalWeights();
+  if (status == kTfLiteOk) status = ModifyGraphWithDelegateImpl(delegate);
+  if (status == kTfLiteOk) status = PinDelegatedExternalWeights();
+  UnmapAllExternalWeights();
   telemetry::TelemetryReportEvent(&context_, "ModifyGraphWithDelegate", status);
   return status;
 }
@@ -2361,6 +2888,103 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SetPersistentStateTensor(int input_index,
+                                                int output_index) {
+  if (state_ == kStateInvokableAndImmutable) {
+    ReportError(
+        "SetPersistentStateTensor is disallowed when graph is immutable.");
+    return kTfLiteError;
+  }
+  TF_LITE_ENSURE(&context_, std::find(inputs_.begin(), inputs_.end(),
+                                      input_index) != inputs_.end());
+  TF_LITE_ENSURE(&context_, std::find(outputs_.begin(), outputs_.end(),
+                                      output_index) != outputs_.end());
+  TF_LITE_ENSURE(&context_, !IsPersistentStateTensor(input_index) &&
+                                !IsPersistentStateTensor(output_index));
+  const TfLiteTensor* input = tensor(input_index);
+  const TfLiteTensor* output = tensor(output_index);
+  TF_LITE_ENSURE_TYPES_EQ(&context_, input->type, output->type);
+  TF_LITE_ENSURE(&context_, input->type != kTfLiteString &&
+                                input->type != kTfLiteResource &&
+                                input->type != kTfLiteVariant);
+  for (const TfLiteTensor* t : {input, output}) {
+    TF_LITE_ENSURE(&context_,
+                   (t->allocation_type == kTfLiteArenaRw ||
+                    t->allocation_type == kTfLiteArenaRwPersistent ||
+                    t->allocation_type == kTfLiteCustom));
+  }
+
+  PersistentStateTensor state;
+  state.input = input_index;
+  state.output = output_index;
+  persistent_state_tensors_.push_back(std::move(state));
+  // The nodes updating the state can no longer be invoked concurrently.
+  concurrent_range_end_.clear();
+  state_ = kStateUninvokable;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::AllocatePersistentStateTensors() {
+  for (PersistentStateTensor& state : persistent_state_tensors_) {
+    bool updated = false;
+    for (int execution_plan_index : execution_plan_) {
+      const auto& [node, registration] =
+          nodes_and_registration_[execution_plan_index];
+      if (updated) {
+        for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+          if (tensor_index == state.input) {
+            ReportError(
+                "Persistent state tensor %d is read by node %d after it is "
+                "updated.",
+                state.input, execution_plan_index);
+            return kTfLiteError;
+          }
+        }
+        continue;
+      }
+      for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+        if (tensor_index != state.output) continue;
+        if (!OpUpdatesInputInPlace(node, registration, state.input,
+                                   state.output)) {
+          ReportError(
+              "Persistent state tensor %d is not updated in place by node %d.",
+              state.output, execution_plan_index);
+          return kTfLiteError;
+        }
+        updated = true;
+      }
+    }
+    if (!updated) {
+      ReportError("Persistent state tensor %d is not updated.", state.output);
+      return kTfLiteError;
+    }
+
+    const size_t bytes = tensor(state.input)->bytes;
+    if (state.buffer == nullptr || state.bytes < bytes) {
+      state.buffer.reset(new char[bytes + kDefaultTensorAlignment]());
+      state.bytes = bytes;
+    }
+    void* data = state.buffer.get();
+    size_t space = state.bytes + kDefaultTensorAlignment;
+    std::align(kDefaultTensorAlignment, state.bytes, data, space);
+    TfLiteCustomAllocation allocation = {data, state.bytes};
+    TF_LITE_ENSURE_STATUS(
+        SetCustomAllocationForTensor(state.input, allocation));
+    TF_LITE_ENSURE_STATUS(
+        SetCustomAllocationForTensor(state.output, allocation));
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::IsPersistentStateTensor(int tensor_index) const {
+  for (const PersistentStateTensor& state : persistent_state_tensors_) {
+    if (state.input == tensor_index || state.output == tensor_index) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void Subgraph::SetName(const char* name) {
   if (name) {
     name_ = name;
@@ -403,6 +403,25 @@ class Subgraph {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  // Binds the subgraph input `input_index` and output `output_index` (tensor
+  // indices) into a persistent state tensor, such as the key-value cache of a
+  // decoder which is updated by DYNAMIC_UPDATE_SLICE. Both tensors are backed
+  // by a single buffer owned by the subgraph, which keeps its address and
+  // contents across invocations, so the state is updated in place instead of
+  // being copied from the output back to the input after each invocation.
+  // The buffer is zero-initialized when AllocateTensors() (re)allocates it,
+  // which only happens when the input grows.
+  //
+  // AllocateTensors() fails unless, in the execution plan:
+  // 1. The output is produced by an op which may share the input with it (see
+  //    TfLiteInPlaceOp).
+  // 2. No op after that one reads the input.
+  // Ops of a delegate kernel are never updated in place, so the producing op
+  // must not be delegated.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus SetPersistentStateTensor(int input_index, int output_index);
+
   void SetName(const char* name);
   const std::string& GetName() const;
 
@@ -445,6 +464,20 @@ class Subgraph {
     return (options_ && options_->GetEnsureDynamicTensorsAreReleased());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if tensors which still fit in their allocation should keep it when
+  // the tensors are reallocated after a resize.
+  bool ShouldReuseMemoryPlanOnResize() const {
+    return (options_ && options_->GetReuseMemoryPlanOnResize());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads on which independent nodes are invoked, or 1 if the
+  // nodes are invoked one after the other.
+  int NumParallelNodeExecutionThreads() const {
+    return options_ ? options_->GetParallelNodeExecution() : 1;
+  }
+
   /// WARNING: This is an experimental API and subject to change.
   /// Use dynamic tensor allocation and deallocation method for large tensors
   /// instead of static memory planner. Dynamic tensors are allocated just
@@ -461,6 +494,22 @@ class Subgraph {
     return (options_ && (options_->GetDynamicAllocationForLargeTensors() > 0));
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if control flow ops should prepare the subgraphs they run the first
+  // time they run them, as enabled by
+  // `InterpreterOptions::SetLazySubgraphPreparation`.
+  bool ShouldPrepareSubgraphsLazily() {
+    return options_ && options_->GetLazySubgraphPreparation();
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the external weights are mapped for each op instead of for each
+  // invocation of the subgraph, as enabled by
+  // `InterpreterOptions::SetMapExternalWeightsPerOp`.
+  bool ShouldMapExternalWeightsPerOp() {
+    return options_ && options_->GetMapExternalWeightsPerOp();
+  }
+
   // WARNING: This is an experimental API and subject to change.
   // Remove unused inputs of the subgraph. It checks usage of inputs and mark it
   // as kTfLiteOptionalTensor if the input is not used in graph execution.
@@ -658,6 +707,49 @@ class Subgraph {
   // Invoke the operator represented by 'node'.
   TfLiteStatus OpInvoke(const TfLiteRegistration& op_reg, TfLiteNode* node);
 
+  // Runs the nodes of a concurrent range of the execution plan on a pool of
+  // threads, see `SetParallelNodeExecution` in InterpreterOptions.
+  class ParallelExecutor;
+
+  // If parallel node execution is enabled, reorders `execution_plan_` so that
+  // the nodes which can be invoked concurrently are adjacent, and records the
+  // ranges of such nodes. Sets `*schedule_changed` if the memory plan must be
+  // recomputed.
+  void ScheduleConcurrentNodes(bool* schedule_changed);
+
+  // Returns true if 'node' must not be invoked concurrently with any other
+  // node.
+  bool IsConcurrencyBarrier(const TfLiteNode& node,
+                            const TfLiteRegistration& registration) const;
+
+  // Returns the ranges [first, last] of the execution plan whose nodes may be
+  // invoked concurrently, for the memory planner.
+  std::vector<std::pair<int, int>> ConcurrentNodeRanges() const;
+
+  // Returns true if the concurrent ranges of the execution plan can be
+  // invoked concurrently in the next invocation.
+  bool CanInvokeNodesConcurrently() const;
+
+  // Invokes the nodes of the execution plan in [first_execution_plan_index,
+  // end_execution_plan_index) concurrently.
+  TfLiteStatus InvokeNodesConcurrently(int first_execution_plan_index,
+                                       int end_execution_plan_index);
+
+  // Allocates the buffers of the persistent state tensors, see
+  // SetPersistentStateTensor(), after checking that they are updated in place.
+  TfLiteStatus AllocatePersistentStateTensors();
+
+  // Returns true if 'tensor_index' is the input or output of a persistent
+  // state tensor.
+  bool IsPersistentStateTensor(int tensor_index) const;
+
+  // Returns an error if an input of 'node' has no data to read.
+  TfLiteStatus EnsureNodeInputsAreReadable(
+      const TfLiteNode& node, const TfLiteRegistration& registration);
+
+  // Returns an error if the client requested to cancel the invocation.
+  TfLiteStatus CheckCancelled();
+
   // Call OpPrepare() for as many ops as possible, allocating memory for their
   // tensors. If an op containing dynamic tensors is found, preparation will be
   // postponed until this function is called again. This allows the interpreter
@@ -751,9 +843,17 @@ class Subgraph {
   // If control_edges_ == nullptr, PartitionGraph will preserve the original
   // execuion order of nodes with OpMightHaveSideEffect() when finding
   // schedulable orderings.
+  // If the delegate partition cost model of the InterpreterOptions is
+  // enabled, the nodes of the subsets whose delegation is not estimated to pay
+  // off are removed from the delegated nodes.
   TfLiteStatus PartitionGraph(const TfLiteIntArray* nodes_to_replace,
                               std::vector<NodeSubset>* node_subsets);
 
+  // Estimates how much faster `node_subset` runs on a delegate than on CPU
+  // according to the delegate partition cost model, in units of bytes
+  // processed by CPU kernels. Negative if it is slower.
+  double EstimateDelegationGain(const NodeSubset& node_subset) const;
+
   // WARNING: This is an experimental interface that is subject to change.
   // Gets the internal pointer to a TensorFlow lite node by node_index.
   TfLiteStatus GetNodeAndRegistration(int node_index, TfLiteNode** node,
@@ -923,6 +1023,31 @@ class Subgraph {
   // tensors if configured.
   void MaybeReleaseDynamicTensors(const TfLiteNode& node, size_t node_index);
 
+  // Sets the constant tensor `tensor_index`, whose parameters are already set,
+  // to be mapped from `offset` in `external_weights_` while it is used.
+  void SetExternalWeightsTensor(int tensor_index, size_t offset);
+
+  // Maps the data of the tensors of `tensor_indices` which are stored in the
+  // external weights, or adds a user to it if it is already mapped. On
+  // failure, none of them is left with an additional user.
+  TfLiteStatus MapExternalWeights(const TfLiteIntArray* tensor_indices);
+
+  // Removes a user of the data of the tensors of `tensor_indices` which are
+  // stored in the external weights, and unmaps it once it has no user left.
+  void UnmapExternalWeights(const TfLiteIntArray* tensor_indices);
+
+  // Adds a user to the data of all the tensors stored in the external weights.
+  TfLiteStatus MapAllExternalWeights();
+
+  // Unmaps the data of all the tensors stored in the external weights,
+  // regardless of their users, e.g. at the end of an invocation which failed.
+  void UnmapAllExternalWeights();
+
+  // Maps the data of the tensors stored in the external weights which are
+  // inputs of delegated nodes for the lifetime of the subgraph, since
+  // delegates may keep pointers to it.
+  TfLiteStatus PinDelegatedExternalWeights();
+
   // The state of the Subgraph.
   enum State {
     // The Subgraph isn't ready to be invoked.
@@ -1046,9 +1171,29 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // The execution plan as reordered by ScheduleConcurrentNodes(), and for
+  // each of its indices the end of the concurrent range it belongs to. Both
+  // are empty if parallel node execution is disabled.
+  std::vector<int> scheduled_execution_plan_;
+  std::vector<int> concurrent_range_end_;
+
+  // Created on the first concurrent invocation.
+  std::unique_ptr<ParallelExecutor> parallel_executor_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
+  // The input and output tensors bound by SetPersistentStateTensor(), and the
+  // buffer backing them, which is over-allocated by kDefaultTensorAlignment
+  // bytes so that it can be aligned.
+  struct PersistentStateTensor {
+    int input;
+    int output;
+    std::unique_ptr<char[]> buffer;
+    size_t bytes = 0;
+  };
+  std::vector<PersistentStateTensor> persistent_state_tensors_;
+
   // Tracking bit for whether a tensor was resized in the course of an op
   // invocation. This is a useful hint to ensure that dynamic tensor outputs
   // trigger downstream reallocation after op invocation.
@@ -1138,6 +1283,22 @@ class Subgraph {
   /// The allocator used for holding memory of the model. Note that this will
   /// be null if the client provides a tflite::Model directly.
   const Allocation* allocation_ = nullptr;
+
+  /// The file of the constant buffers stored outside of the model, which are
+  /// mapped while they are used. This will be null unless the model was built
+  /// with external weights.
+  ExternalWeightsFile* external_weights_ = nullptr;
+
+  // A constant tensor whose data is mapped from the external weights.
+  struct ExternalWeightsTensor {
+    size_t offset;
+    size_t bytes;
+    // The number of users of the data, which is only mapped while it is > 0.
+    int map_count = 0;
+    // Whether the data stays mapped regardless of its users.
+    bool pinned = false;
+  };
+  std::map<int, ExternalWeightsTensor> external_weights_tensors_;
 };
 
 }  // namespace tflite
@@ -16,16 +16,23 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <cstddef>
 #include <functional>
 #include <memory>
 #include <numeric>
+#include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/util.h"
 
@@ -331,5 +338,255 @@ TEST_F(SubgraphResizeTensorTest,
   std::fill_n(tensor_.dims->data, tensor_.dims->size, 1);
 }
 
+// Op which outputs one more than the sum of its float inputs.
+TfLiteRegistration GetAddOneOpRegistration() {
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < NumElements(output); ++i) {
+      // Reads all the inputs before writing, so that the output can share the
+      // buffer of an input.
+      float sum = 1;
+      for (int input : TfLiteIntArrayView(node->inputs)) {
+        sum += context->tensors[input].data.f[i];
+      }
+      output->data.f[i] = sum;
+    }
+    return kTfLiteOk;
+  };
+  return reg;
+}
+
+// Number of invocations of the rendezvous op so far and running, and the
+// highest number of them which ran at the same time.
+std::atomic<int> rendezvous_arrivals;
+std::atomic<int> rendezvous_running;
+std::atomic<int> rendezvous_max_running;
+
+// Like the op above, but waits for up to a second for another invocation of
+// the op to run at the same time.
+TfLiteRegistration GetRendezvousOpRegistration() {
+  TfLiteRegistration reg = GetAddOneOpRegistration();
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    ++rendezvous_arrivals;
+    ++rendezvous_running;
+    const auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (rendezvous_arrivals < 2 &&
+           std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::yield();
+    }
+    int max_running = rendezvous_max_running;
+    while (max_running < rendezvous_running &&
+           !rendezvous_max_running.compare_exchange_weak(
+               max_running, rendezvous_running)) {
+    }
+    --rendezvous_running;
+    return GetAddOneOpRegistration().invoke(context, node);
+  };
+  return reg;
+}
+
+class ParallelNodeExecutionTest : public testing::Test {
+ protected:
+  // Builds the graph
+  //   1 = rendezvous(0), 2 = add_one(1), 3 = rendezvous(0),
+  //   4 = add_one(2, 3)
+  // in which the two rendezvous ops are independent.
+  void BuildGraph(int num_threads) {
+    options_.SetParallelNodeExecution(num_threads);
+    subgraph_.SetOptions(&options_);
+    ASSERT_EQ(subgraph_.AddTensors(5), kTfLiteOk);
+    ASSERT_EQ(subgraph_.SetInputs({0}), kTfLiteOk);
+    ASSERT_EQ(subgraph_.SetOutputs({4}), kTfLiteOk);
+    for (int i = 0; i < 5; ++i) {
+      ASSERT_EQ(subgraph_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {2}, TfLiteQuantization()),
+                kTfLiteOk);
+    }
+    int node_index;
+    ASSERT_EQ(subgraph_.AddNodeWithParameters({0}, {1}, {}, nullptr, 0,
+                                               nullptr, &rendezvous_op_,
+                                               &node_index),
+              kTfLiteOk);
+    ASSERT_EQ(subgraph_.AddNodeWithParameters({1}, {2}, {}, nullptr, 0,
+                                               nullptr, &add_one_op_,
+                                               &node_index),
+              kTfLiteOk);
+    ASSERT_EQ(subgraph_.AddNodeWithParameters({0}, {3}, {}, nullptr, 0,
+                                               nullptr, &rendezvous_op_,
+                                               &node_index),
+              kTfLiteOk);
+    ASSERT_EQ(subgraph_.AddNodeWithParameters({2, 3}, {4}, {}, nullptr, 0,
+                                               nullptr, &add_one_op_,
+                                               &node_index),
+              kTfLiteOk);
+  }
+
+  TfLiteStatus Invoke(float input) {
+    rendezvous_arrivals = 0;
+    rendezvous_max_running = 0;
+    subgraph_.tensor(0)->data.f[0] = input;
+    subgraph_.tensor(0)->data.f[1] = input;
+    return subgraph_.Invoke();
+  }
+
+  StderrReporter error_reporter_;
+  Subgraph subgraph_{&error_reporter_,
+                     /*external_contexts=*/nullptr,
+                     /*subgraphs=*/nullptr,
+                     /*resources=*/nullptr,
+                     /*resource_ids=*/nullptr,
+                     /*initialization_status_map=*/nullptr};
+  InterpreterOptions options_;
+  TfLiteRegistration add_one_op_ = GetAddOneOpRegistration();
+  TfLiteRegistration rendezvous_op_ = GetRendezvousOpRegistration();
+};
+
+TEST_F(ParallelNodeExecutionTest, InvokesNodesInOrderByDefault) {
+  BuildGraph(/*num_threads=*/1);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(subgraph_.execution_plan(), ElementsAreArray({0, 1, 2, 3}));
+  ASSERT_EQ(Invoke(1), kTfLiteOk);
+  EXPECT_EQ(rendezvous_max_running, 1);
+  EXPECT_EQ(subgraph_.tensor(4)->data.f[0], 6);
+}
+
+TEST_F(ParallelNodeExecutionTest, InvokesIndependentNodesConcurrently) {
+  BuildGraph(/*num_threads=*/2);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(subgraph_.execution_plan(), ElementsAreArray({0, 2, 1, 3}));
+  for (float input : {1, 2}) {
+    ASSERT_EQ(Invoke(input), kTfLiteOk);
+    EXPECT_EQ(rendezvous_max_running, 2);
+    EXPECT_EQ(subgraph_.tensor(4)->data.f[0], 2 * input + 4);
+    EXPECT_EQ(subgraph_.tensor(4)->data.f[1], 2 * input + 4);
+  }
+
+  // The schedule is kept across resizes.
+  ASSERT_EQ(subgraph_.ResizeInputTensor(0, {4}), kTfLiteOk);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  EXPECT_THAT(subgraph_.execution_plan(), ElementsAreArray({0, 2, 1, 3}));
+  ASSERT_EQ(Invoke(3), kTfLiteOk);
+  EXPECT_EQ(rendezvous_max_running, 2);
+  EXPECT_EQ(subgraph_.tensor(4)->data.f[0], 10);
+}
+
+TEST_F(ParallelNodeExecutionTest, CustomOpsAreInvokedAlone) {
+  rendezvous_op_.builtin_code = kTfLiteBuiltinCustom;
+  rendezvous_op_.custom_name = "Rendezvous";
+  BuildGraph(/*num_threads=*/2);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  ASSERT_EQ(Invoke(1), kTfLiteOk);
+  EXPECT_EQ(rendezvous_max_running, 1);
+  EXPECT_EQ(subgraph_.tensor(4)->data.f[0], 6);
+}
+
+class PersistentStateTensorTest : public testing::Test {
+ protected:
+  // Builds the graph `2 = add_one(0, 1)`, whose op may update input 0 in
+  // place, and `3 = add_one(2)` if `read_state_after_update` is set.
+  void BuildGraph(bool read_state_after_update = false) {
+    ASSERT_EQ(subgraph_.AddTensors(4), kTfLiteOk);
+    ASSERT_EQ(subgraph_.SetInputs({0, 1}), kTfLiteOk);
+    ASSERT_EQ(subgraph_.SetOutputs({2, 3}), kTfLiteOk);
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_EQ(subgraph_.SetTensorParametersReadWrite(
+                    i, kTfLiteFloat32, "", {2}, TfLiteQuantization()),
+                kTfLiteOk);
+    }
+    int node_index;
+    ASSERT_EQ(subgraph_.AddNodeWithParameters({0, 1}, {2}, {}, nullptr, 0,
+                                               nullptr, &add_one_op_,
+                                               &node_index),
+              kTfLiteOk);
+    ASSERT_EQ(subgraph_.AddNodeWithParameters(
+                  {read_state_after_update ? 0 : 2}, {3}, {}, nullptr, 0,
+                  nullptr, &add_one_op_, &node_index),
+              kTfLiteOk);
+  }
+
+  StderrReporter error_reporter_;
+  Subgraph subgraph_{&error_reporter_,
+                     /*external_contexts=*/nullptr,
+                     /*subgraphs=*/nullptr,
+                     /*resources=*/nullptr,
+                     /*resource_ids=*/nullptr,
+                     /*initialization_status_map=*/nullptr};
+  TfLiteRegistration add_one_op_ = [] {
+    TfLiteRegistration reg = GetAddOneOpRegistration();
+    reg.inplace_operator = kTfLiteInplaceOpInput0Shared;
+    return reg;
+  }();
+};
+
+TEST_F(PersistentStateTensorTest, UpdatesStateInPlace) {
+  BuildGraph();
+  ASSERT_EQ(subgraph_.SetPersistentStateTensor(0, 2), kTfLiteOk);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* state = subgraph_.tensor(0);
+  EXPECT_EQ(state->allocation_type, kTfLiteCustom);
+  EXPECT_EQ(subgraph_.tensor(2)->data.raw, state->data.raw);
+  EXPECT_EQ(reinterpret_cast<intptr_t>(state->data.raw) %
+                kDefaultTensorAlignment,
+            0);
+  EXPECT_EQ(state->data.f[0], 0);
+
+  char* const state_data = state->data.raw;
+  subgraph_.tensor(1)->data.f[0] = 1;
+  subgraph_.tensor(1)->data.f[1] = 2;
+  for (int i = 1; i <= 3; ++i) {
+    ASSERT_EQ(subgraph_.Invoke(), kTfLiteOk);
+    EXPECT_EQ(state->data.raw, state_data);
+    EXPECT_EQ(state->data.f[0], 2 * i);
+    EXPECT_EQ(state->data.f[1], 3 * i);
+    EXPECT_EQ(subgraph_.tensor(3)->data.f[0], 2 * i + 1);
+  }
+
+  // The state is kept when the tensors are reallocated to the same size, and
+  // reset when they grow.
+  ASSERT_EQ(subgraph_.ResizeInputTensor(1, {1}), kTfLiteOk);
+  ASSERT_EQ(subgraph_.ResizeInputTensor(1, {2}), kTfLiteOk);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(state->data.raw, state_data);
+  EXPECT_EQ(state->data.f[0], 6);
+  ASSERT_EQ(subgraph_.ResizeInputTensor(0, {4}), kTfLiteOk);
+  ASSERT_EQ(subgraph_.ResizeInputTensor(1, {4}), kTfLiteOk);
+  ASSERT_EQ(subgraph_.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(subgraph_.tensor(2)->data.raw, state->data.raw);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(state->data.f[i], 0);
+    subgraph_.tensor(1)->data.f[i] = 1;
+  }
+  ASSERT_EQ(subgraph_.Invoke(), kTfLiteOk);
+  EXPECT_EQ(state->data.f[3], 2);
+}
+
+TEST_F(PersistentStateTensorTest, RequiresAnInPlaceOp) {
+  add_one_op_.inplace_operator = kTfLiteInplaceOpNone;
+  BuildGraph();
+  ASSERT_EQ(subgraph_.SetPersistentStateTensor(0, 2), kTfLiteOk);
+  EXPECT_EQ(subgraph_.AllocateTensors(), kTfLiteError);
+}
+
+TEST_F(PersistentStateTensorTest, RequiresNoReadsAfterUpdate) {
+  BuildGraph(/*read_state_after_update=*/true);
+  ASSERT_EQ(subgraph_.SetPersistentStateTensor(0, 2), kTfLiteOk);
+  EXPECT_EQ(subgraph_.AllocateTensors(), kTfLiteError);
+}
+
+TEST_F(PersistentStateTensorTest, RequiresInputAndOutput) {
+  BuildGraph();
+  EXPECT_EQ(subgraph_.SetPersistentStateTensor(2, 0), kTfLiteError);
+  EXPECT_EQ(subgraph_.SetPersistentStateTensor(0, 3), kTfLiteOk);
+  EXPECT_EQ(subgraph_.SetPersistentStateTensor(0, 2), kTfLiteError);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -173,6 +173,41 @@ TEST_F(TestDelegate, ComplexDelegate) {
             delegate_->FakeFusedRegistration().custom_name);
 }
 
+TEST_F(TestDelegate, PartitionCostModelKeepsProfitablePartitions) {
+  InterpreterOptions options;
+  options.SetDelegatePartitionCostModel(/*delegate_speedup=*/2.0f,
+                                        /*transfer_cost=*/1.0f);
+  ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+  delegate_ = std::unique_ptr<SimpleDelegate>(new SimpleDelegate({0, 1, 2}));
+  ASSERT_EQ(
+      interpreter_->ModifyGraphWithDelegate(delegate_->get_tf_lite_delegate()),
+      kTfLiteOk);
+
+  // The whole graph saves more than it costs to transfer its inputs and
+  // outputs.
+  ASSERT_EQ(interpreter_->execution_plan().size(), 1);
+  EXPECT_EQ(interpreter_->execution_plan()[0], 3);
+}
+
+TEST_F(TestDelegate, PartitionCostModelRejectsUnprofitablePartitions) {
+  InterpreterOptions options;
+  options.SetDelegatePartitionCostModel(/*delegate_speedup=*/2.0f,
+                                        /*transfer_cost=*/1.0f);
+  ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+  delegate_ = std::unique_ptr<SimpleDelegate>(new SimpleDelegate({1, 2}));
+  ASSERT_EQ(
+      interpreter_->ModifyGraphWithDelegate(delegate_->get_tf_lite_delegate()),
+      kTfLiteOk);
+
+  // Moving the inputs of {OP1, OP2} from CPU and their outputs back costs
+  // more than running them on the delegate saves.
+  EXPECT_EQ(interpreter_->execution_plan().size(), 3);
+  for (int node_index : interpreter_->execution_plan()) {
+    EXPECT_EQ(interpreter_->node_and_registration(node_index)->first.delegate,
+              nullptr);
+  }
+}
+
 TEST_F(TestDelegate, SetBufferHandleToInput) {
   delegate_ = std::unique_ptr<SimpleDelegate>(new SimpleDelegate({0, 1, 2}));
   TfLiteDelegate* delegate = delegate_->get_tf_lite_delegate();
@@ -877,6 +877,7 @@ class InferenceEnvironmentImpl : public InferenceEnvironment {
     } else {
       RETURN_IF_ERROR(CreateDefaultGPUDevice(&device));
     }
+    properties_.driver_version = device.GetPlatformVersion();
 
 #ifdef CL_DELEGATE_ALLOW_GL
     properties_.is_gl_sharing_supported = IsGlSharingSupported(device);
@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/gpu/cl/api.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/types/span.h"
+#include "tensorflow/lite/delegates/gpu/api.h"
+#include "tensorflow/lite/delegates/gpu/cl/cl_test.h"
+#include "tensorflow/lite/delegates/gpu/common/data_type.h"
+#include "tensorflow/lite/delegates/gpu/common/model.h"
+#include "tensorflow/lite/delegates/gpu/common/operations.h"
+#include "tensorflow/lite/delegates/gpu/common/shape.h"
+#include "tensorflow/lite/delegates/gpu/common/status.h"
+
+using ::testing::ElementsAre;
+
+namespace tflite {
+namespace gpu {
+namespace cl {
+namespace {
+
+// Builds a graph applying ReLU to a 1x2x2x1 tensor.
+absl::Status BuildReluGraph(GraphFloat32* graph) {
+  Node* node = graph->NewNode();
+  node->operation.type = ToString(OperationType::RELU);
+  node->operation.attributes = ReLUAttributes();
+
+  Value* input = graph->NewValue();
+  input->tensor.type = DataType::FLOAT32;
+  input->tensor.shape = BHWC(1, 2, 2, 1);
+  input->tensor.ref = 0;
+  RETURN_IF_ERROR(graph->AddConsumer(node->id, input->id));
+
+  Value* output = graph->NewValue();
+  output->tensor.type = DataType::FLOAT32;
+  output->tensor.shape = BHWC(1, 2, 2, 1);
+  output->tensor.ref = 1;
+  return graph->SetProducer(node->id, output->id);
+}
+
+// Runs the model of `builder` on CPU memory.
+absl::Status Run(InferenceBuilder* builder, std::vector<float> input,
+                 std::vector<float>* output) {
+  ObjectDef obj_def;
+  obj_def.data_type = DataType::FLOAT32;
+  obj_def.data_layout = DataLayout::BHWC;
+  obj_def.object_type = ObjectType::CPU_MEMORY;
+  obj_def.user_provided = true;
+  RETURN_IF_ERROR(builder->SetInputObjectDef(0, obj_def));
+  RETURN_IF_ERROR(builder->SetOutputObjectDef(0, obj_def));
+  std::unique_ptr<InferenceRunner> runner;
+  RETURN_IF_ERROR(builder->Build(&runner));
+
+  output->resize(input.size());
+  RETURN_IF_ERROR(runner->SetInputObject(
+      0, CpuMemory{input.data(), input.size() * sizeof(float)}));
+  RETURN_IF_ERROR(runner->SetOutputObject(
+      0, CpuMemory{output->data(), output->size() * sizeof(float)}));
+  return runner->Run();
+}
+
+TEST_F(OpenCLTest, SerializedModelRoundTrip) {
+  InferenceEnvironmentOptions env_options;
+  env_options.device = env_.device().id();
+  env_options.context = env_.context().context();
+  env_options.command_queue = env_.queue()->queue();
+  std::unique_ptr<InferenceEnvironment> inf_env;
+  InferenceEnvironmentProperties properties;
+  ASSERT_OK(NewInferenceEnvironment(env_options, &inf_env, &properties));
+  EXPECT_FALSE(properties.driver_version.empty());
+
+  InferenceOptions options;
+  options.priority1 = InferencePriority::MAX_PRECISION;
+  options.usage = InferenceUsage::SUSTAINED_SPEED;
+
+  GraphFloat32 graph;
+  ASSERT_OK(BuildReluGraph(&graph));
+  std::vector<uint8_t> serialized_model;
+  ASSERT_OK(inf_env->BuildSerializedModel(options, std::move(graph),
+                                          &serialized_model));
+  EXPECT_FALSE(serialized_model.empty());
+
+  // Deserializes the model as a new session would.
+  std::unique_ptr<InferenceBuilder> builder;
+  ASSERT_OK(inf_env->NewInferenceBuilder(absl::MakeConstSpan(serialized_model),
+                                         &builder));
+  std::vector<float> output;
+  ASSERT_OK(Run(builder.get(), {-1.0f, 2.0f, -3.0f, 4.0f}, &output));
+  EXPECT_THAT(output, ElementsAre(0.0f, 2.0f, 0.0f, 4.0f));
+
+  // Matches the model built directly from the graph.
+  GraphFloat32 direct_graph;
+  ASSERT_OK(BuildReluGraph(&direct_graph));
+  ASSERT_OK(
+      inf_env->NewInferenceBuilder(options, std::move(direct_graph), &builder));
+  ASSERT_OK(Run(builder.get(), {-1.0f, 2.0f, -3.0f, 4.0f}, &output));
+  EXPECT_THAT(output, ElementsAre(0.0f, 2.0f, 0.0f, 4.0f));
+}
+
+TEST_F(OpenCLTest, CorruptSerializedModelIsRejected) {
+  InferenceEnvironmentOptions env_options;
+  env_options.device = env_.device().id();
+  env_options.context = env_.context().context();
+  env_options.command_queue = env_.queue()->queue();
+  std::unique_ptr<InferenceEnvironment> inf_env;
+  ASSERT_OK(NewInferenceEnvironment(env_options, &inf_env, nullptr));
+
+  const std::vector<uint8_t> corrupt_model = {1, 2, 3, 4};
+  std::unique_ptr<InferenceBuilder> builder;
+  EXPECT_FALSE(
+      inf_env
+          ->NewInferenceBuilder(absl::MakeConstSpan(corrupt_model), &builder)
+          .ok());
+}
+
+}  // namespace
+}  // namespace cl
+}  // namespace gpu
+}  // namespace tflite
@@ -119,6 +119,19 @@ using delegates::SerializationParams;
 
 constexpr char kSerializedDataPrefix[] = "gpuv2_data_";
 
+// Returns the key of the serialized OpenCL data. We use fingerprints of the
+// options and of the GPU driver to ensure compatibility, so that updating the
+// driver does not load, and then discard, the data built with the old one.
+std::string SerializedDataKey(
+    const cl::InferenceOptions& options,
+    const cl::InferenceEnvironmentProperties& properties) {
+  return std::string(kSerializedDataPrefix) +
+         delegates::StrFingerprint(&options, sizeof(cl::InferenceOptions)) +
+         "_" +
+         delegates::StrFingerprint(properties.driver_version.data(),
+                                   properties.driver_version.size());
+}
+
 #if defined(__ANDROID__)
 // Xeno API does not impose alignment or padding requirements.
 constexpr size_t kRequiredByteAlignment = 1;
@@ -174,9 +187,7 @@ class Delegate {
     if (options_.max_delegated_partitions <= 0) {
       options_.max_delegated_partitions = 1;
     }
-    if (options_.experimental_flags &
-            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION &&
-        options_.model_token && options_.serialization_dir) {
+    if (options_.model_token && options_.serialization_dir) {
       SerializationParams params;
       params.model_token = options_.model_token;
       params.cache_dir = options_.serialization_dir;
@@ -191,6 +202,11 @@ class Delegate {
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
   bool async() const { return async_; }
 
+  bool IsSerializationRequired() const {
+    return options_.experimental_flags &
+           TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
+  }
+
   bool IsQuantOpsAllowed() const {
     return options_.experimental_flags &
            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_QUANT;
@@ -271,13 +287,14 @@ class DelegateKernelCore {
   absl::Status MaybeInitializeSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
       std::unique_ptr<InferenceBuilder>* builder, cl::InferenceOptions* options,
-      cl::InferenceEnvironmentOptions* env_options,
-      cl::InferenceEnvironmentProperties* properties,
+      const cl::InferenceEnvironmentProperties& properties,
       Serialization* serialization);
 
   absl::Status SaveSerializedOpenCL(
       TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
-      cl::InferenceOptions* options, Serialization* serialization,
+      cl::InferenceOptions* options,
+      const cl::InferenceEnvironmentProperties& properties,
+      Serialization* serialization,
       const std::vector<uint8_t>& serialized_model);
 
   // The Delegate instance that's shared across all DelegateKernel instances.
@@ -484,25 +501,49 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
         options, std::move(*graph), builder));
   } else {
+    // The environment is needed both to load and to build the serialized
+    // data, which is keyed by the GPU driver it was built with.
+    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
+                                                &properties));
     // If serialization data is found, initialize CL from it & return early.
     if (MaybeInitializeSerializedOpenCL(context, delegate_params, builder,
-                                        &options, &env_options, &properties,
-                                        serialization)
+                                        &options, properties, serialization)
             .ok()) {
       return absl::OkStatus();
     }
 
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
-                                                &properties));
     *graph_is_destroyed = true;
     std::vector<uint8_t> serialized_model;
-    RETURN_IF_ERROR(cl_environment_->BuildSerializedModel(
-        options, std::move(*graph), &serialized_model));
-    RETURN_IF_ERROR(
-        cl_environment_->NewInferenceBuilder(serialized_model, builder));
-
-    RETURN_IF_ERROR(SaveSerializedOpenCL(context, delegate_params, &options,
-                                         serialization, serialized_model));
+    absl::Status build_status = cl_environment_->BuildSerializedModel(
+        options, std::move(*graph), &serialized_model);
+    if (build_status.ok()) {
+      build_status =
+          cl_environment_->NewInferenceBuilder(serialized_model, builder);
+    }
+    if (build_status.ok()) {
+      const absl::Status save_status =
+          SaveSerializedOpenCL(context, delegate_params, &options, properties,
+                               serialization, serialized_model);
+      if (!save_status.ok()) {
+        if (delegate_->IsSerializationRequired()) return save_status;
+        TF_LITE_KERNEL_LOG(context, "Failed to serialize GPU data: %s",
+                           std::string(save_status.message()).c_str());
+      }
+    } else {
+      if (delegate_->IsSerializationRequired()) return build_status;
+      TF_LITE_KERNEL_LOG(context,
+                         "Failed to build serialized GPU data, building "
+                         "without serialization: %s",
+                         std::string(build_status.message()).c_str());
+      // The graph was moved above, so re-create it for the direct build path.
+      GraphFloat32 direct_graph;
+      std::vector<uint32_t> input_refs;
+      std::vector<uint32_t> output_refs;
+      RETURN_IF_ERROR(InitializeGraph(context, delegate_params, &direct_graph,
+                                      &input_refs, &output_refs));
+      RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(
+          options, std::move(direct_graph), builder));
+    }
   }
 
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
@@ -539,24 +580,17 @@ absl::Status DelegateKernelCore::InitializeOpenGlApi(
 absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
     TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
     std::unique_ptr<InferenceBuilder>* builder, cl::InferenceOptions* options,
-    cl::InferenceEnvironmentOptions* env_options,
-    cl::InferenceEnvironmentProperties* properties,
+    const cl::InferenceEnvironmentProperties& properties,
     Serialization* serialization) {
   if (!serialization) return absl::InvalidArgumentError("No serialization");
-  // We use a fingerprint of the options to ensure compatibility.
-  std::string options_fingerprint =
-      delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
   auto data_key = serialization->GetEntryForKernel(
-      std::string(kSerializedDataPrefix) + options_fingerprint, context,
-      delegate_params);
+      SerializedDataKey(*options, properties), context, delegate_params);
 
   std::string model_data;
   auto model_data_status = data_key.GetData(context, &model_data);
   if (model_data_status == kTfLiteOk) {
     absl::Span<const uint8_t> model_span = absl::Span<const uint8_t>{
         reinterpret_cast<const uint8_t*>(model_data.data()), model_data.size()};
-    RETURN_IF_ERROR(cl::NewInferenceEnvironment(*env_options, &cl_environment_,
-                                                properties));
     RETURN_IF_ERROR(cl_environment_->NewInferenceBuilder(model_span, builder));
     TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                          "Initialized OpenCL-based API from serialized data.");
@@ -569,17 +603,15 @@ absl::Status DelegateKernelCore::MaybeInitializeSerializedOpenCL(
 // Returns Ok only if serialization happens successfully.
 absl::Status DelegateKernelCore::SaveSerializedOpenCL(
     TfLiteContext* context, const TfLiteDelegateParams* delegate_params,
-    cl::InferenceOptions* options, Serialization* serialization,
+    cl::InferenceOptions* options,
+    const cl::InferenceEnvironmentProperties& properties,
+    Serialization* serialization,
     const std::vector<uint8_t>& serialized_model) {
   if (!serialization) return absl::InvalidArgumentError("No serialization");
-  // We use a fingerprint of the options to ensure compatibility.
-  std::string options_fingerprint =
-      delegates::StrFingerprint(options, sizeof(cl::InferenceOptions));
 
   // Save data.
   auto data_key = serialization->GetEntryForKernel(
-      std::string(kSerializedDataPrefix) + options_fingerprint, context,
-      delegate_params);
+      SerializedDataKey(*options, properties), context, delegate_params);
   auto save_status = data_key.SetData(
       context, reinterpret_cast<const char*>(serialized_model.data()),
       serialized_model.size());
@@ -61,14 +61,11 @@ enum TfLiteGpuExperimentalFlags {
   // Enforces execution with the provided backend.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY = 1 << 1,
   TFLITE_GPU_EXPERIMENTAL_FLAGS_GL_ONLY = 1 << 2,
-  // Enable serialization of GPU kernels & model data. Speeds up initialization
-  // at the cost of space on disk.
-  // Delegate performs serialization the first time it is applied with a new
-  // model or inference params. Later initializations are fast.
-  // ModifyGraphWithDelegate will fail if data cannot be serialized.
-  //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // Requires serialization of GPU kernels & model data to succeed.
+  // Serialization itself is enabled whenever serialization_dir & model_token
+  // are set in TfLiteGpuDelegateOptionsV2; without this flag, failing to read
+  // or write the serialized data only logs a warning, while with it
+  // ModifyGraphWithDelegate fails if data cannot be serialized.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
 };
@@ -118,6 +115,10 @@ typedef struct {
   int32_t max_delegated_partitions;
 
   // The nul-terminated directory to use for serialization.
+  // When set along with model_token, the delegate stores the compiled GPU
+  // programs and tuned work group sizes there the first time it is applied
+  // with a new model, inference params or GPU driver, and loads them on later
+  // initializations, e.g. across app sessions, which are much faster.
   // Whether serialization actually happens or not is dependent on backend used
   // and validity of this directory.
   // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
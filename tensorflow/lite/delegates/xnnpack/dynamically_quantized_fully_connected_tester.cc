@@ -142,10 +142,13 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
     const {
   std::random_device random_device;
   auto rng = std::mt19937(random_device());
-  auto filter_rng = std::bind(std::uniform_int_distribution<int32_t>(
-                                  -std::numeric_limits<int8_t>::max(),
-                                  std::numeric_limits<int8_t>::max()),
-                              std::ref(rng));
+  const int32_t filter_max =
+      Int4Weights() ? 7 : std::numeric_limits<int8_t>::max();
+  auto filter_rng = std::bind(
+      std::uniform_int_distribution<int32_t>(-filter_max, filter_max),
+      std::ref(rng));
+  auto scale_rng = std::bind(std::uniform_real_distribution<float>(0.5f, 1.0f),
+                             std::ref(rng));
   auto bias_rng =
       std::bind(std::uniform_real_distribution<float>(-10, 10), std::ref(rng));
 
@@ -156,6 +159,23 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
 
   std::vector<int8_t> filter_data(InputChannels() * OutputChannels());
   std::generate(filter_data.begin(), filter_data.end(), std::ref(filter_rng));
+  if (Int4Weights()) {
+    // Pack two values per byte, the first one in the low nibble.
+    std::vector<int8_t> packed_filter_data((filter_data.size() + 1) / 2);
+    for (size_t i = 0; i < filter_data.size(); i++) {
+      packed_filter_data[i / 2] |=
+          static_cast<int8_t>((filter_data[i] & 0xF) << (4 * (i % 2)));
+    }
+    filter_data = std::move(packed_filter_data);
+  }
+  std::vector<float> filter_scales(1, FilterScale());
+  std::vector<int64_t> filter_zero_points(1, 0);
+  if (ChannelWiseScales()) {
+    filter_scales.resize(OutputChannels());
+    std::generate(filter_scales.begin(), filter_scales.end(),
+                  std::ref(scale_rng));
+    filter_zero_points.resize(OutputChannels(), 0);
+  }
   std::vector<float> bias_data(OutputChannels());
   std::generate(bias_data.begin(), bias_data.end(), std::ref(bias_rng));
 
@@ -184,10 +204,12 @@ std::vector<char> DynamicallyQuantizedFullyConnectedTester::CreateTfLiteModel()
   tensors.emplace_back(CreateTensor(
       builder,
       builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
-      TensorType_INT8, /*buffer=*/1, /*name=*/0,
-      CreateQuantizationParameters(builder, /*min=*/0, /*max=*/0,
-                                   builder.CreateVector<float>({FilterScale()}),
-                                   builder.CreateVector<int64_t>({0}))));
+      Int4Weights() ? TensorType_INT4 : TensorType_INT8, /*buffer=*/1,
+      /*name=*/0,
+      CreateQuantizationParameters(
+          builder, /*min=*/0, /*max=*/0,
+          builder.CreateVector<float>(filter_scales),
+          builder.CreateVector<int64_t>(filter_zero_points))));
   if (HasBias()) {
     tensors.emplace_back(CreateTensor(
         builder,
@@ -85,6 +85,23 @@ class DynamicallyQuantizedFullyConnectedTester {
 
   inline float FilterScale() const { return filter_scale_; }
 
+  // Quantizes the filter to 4 bits, packed two values per byte, instead of 8.
+  inline DynamicallyQuantizedFullyConnectedTester& Int4Weights() {
+    int4_weights_ = true;
+    return *this;
+  }
+
+  inline bool Int4Weights() const { return int4_weights_; }
+
+  // Uses a different random scale for every output channel of the filter
+  // instead of FilterScale().
+  inline DynamicallyQuantizedFullyConnectedTester& ChannelWiseScales() {
+    channel_wise_scales_ = true;
+    return *this;
+  }
+
+  inline bool ChannelWiseScales() const { return channel_wise_scales_; }
+
   inline DynamicallyQuantizedFullyConnectedTester& KeepDims(bool keep_dims) {
     keep_dims_ = keep_dims;
     return *this;
@@ -145,6 +162,8 @@ class DynamicallyQuantizedFullyConnectedTester {
   int32_t output_channels_ = 1;
   int32_t filter_zero_point_ = 0;
   float filter_scale_ = 0.75f;
+  bool int4_weights_ = false;
+  bool channel_wise_scales_ = false;
   bool keep_dims_ = false;
   bool has_bias_ = true;
   ::tflite::ActivationFunctionType activation_ =
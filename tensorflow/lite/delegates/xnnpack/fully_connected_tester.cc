@@ -154,6 +154,8 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
   int dequantize_operator_code = -1;
   switch (WeightsType()) {
     case WeightsType::kFP32:
+    case WeightsType::kSparseFP32:
+    case WeightsType::kBlockSparseFP32:
     case WeightsType::kDynamic:
       break;
     case WeightsType::kFP16:
@@ -191,6 +193,7 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
   tflite::TensorType quantized_filter_type = TensorType_FLOAT32;
   flatbuffers::Offset<tflite::QuantizationParameters>
       filter_quantization_params = 0;
+  flatbuffers::Offset<tflite::SparsityParameters> filter_sparsity = 0;
   int filter_buffer_id = 0, quantized_filter_buffer_id = 0;
   const std::vector<int32_t> filter_shape = {OutputChannels(), InputChannels()};
   switch (WeightsType()) {
@@ -201,6 +204,67 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
                        reinterpret_cast<const uint8_t*>(filter_data.data()),
                        sizeof(float) * filter_data.size())));
       break;
+    case WeightsType::kSparseFP32:
+    case WeightsType::kBlockSparseFP32: {
+      // Drop about half of the blocks of each row, and store the remaining
+      // ones in CSR format: output channels are dense, blocks of input
+      // channels are sparse.
+      const int32_t block_size =
+          WeightsType() == WeightsType::kBlockSparseFP32 ? 4 : 1;
+      EXPECT_EQ(InputChannels() % block_size, 0);
+      auto keep_rng =
+          std::bind(std::bernoulli_distribution(0.5), std::ref(rng));
+      std::vector<float> sparse_filter_data;
+      std::vector<int32_t> row_segments{0};
+      std::vector<int32_t> block_indices;
+      for (int32_t oc = 0; oc < OutputChannels(); oc++) {
+        for (int32_t block = 0; block < InputChannels() / block_size;
+             block++) {
+          if (!keep_rng()) {
+            continue;
+          }
+          block_indices.push_back(block);
+          const float* block_data =
+              &filter_data[oc * InputChannels() + block * block_size];
+          sparse_filter_data.insert(sparse_filter_data.end(), block_data,
+                                    block_data + block_size);
+        }
+        row_segments.push_back(block_indices.size());
+      }
+
+      filter_buffer_id = buffers.size();
+      buffers.emplace_back(CreateBuffer(
+          builder,
+          builder.CreateVector(
+              reinterpret_cast<const uint8_t*>(sparse_filter_data.data()),
+              sizeof(float) * sparse_filter_data.size())));
+
+      std::vector<flatbuffers::Offset<DimensionMetadata>> dim_metadata{
+          CreateDimensionMetadata(builder, DimensionType_DENSE,
+                                  /*dense_size=*/OutputChannels()),
+          CreateDimensionMetadata(
+              builder, DimensionType_SPARSE_CSR, /*dense_size=*/0,
+              SparseIndexVector_Int32Vector,
+              CreateInt32Vector(builder, builder.CreateVector(row_segments))
+                  .Union(),
+              SparseIndexVector_Int32Vector,
+              CreateInt32Vector(builder, builder.CreateVector(block_indices))
+                  .Union())};
+      std::vector<int32_t> traversal_order{0, 1};
+      flatbuffers::Offset<flatbuffers::Vector<int32_t>> block_map = 0;
+      if (block_size != 1) {
+        // The block dimension is the innermost one, and blocks input
+        // channels.
+        dim_metadata.push_back(CreateDimensionMetadata(
+            builder, DimensionType_DENSE, /*dense_size=*/block_size));
+        traversal_order.push_back(2);
+        block_map = builder.CreateVector<int32_t>({1});
+      }
+      filter_sparsity = CreateSparsityParameters(
+          builder, builder.CreateVector(traversal_order), block_map,
+          builder.CreateVector(dim_metadata));
+      break;
+    }
     case WeightsType::kFP16: {
       std::vector<uint16_t> quantized_filter_data(filter_data.size());
       std::transform(filter_data.begin(), filter_data.end(),
@@ -324,7 +388,8 @@ std::vector<char> FullyConnectedTester::CreateTfLiteModel() const {
       builder,
       builder.CreateVector<int32_t>(filter_shape.data(), filter_shape.size()),
       TensorType_FLOAT32,
-      /*buffer=*/filter_buffer_id));
+      /*buffer=*/filter_buffer_id, /*name=*/0, /*quantization=*/0,
+      /*is_variable=*/false, filter_sparsity));
 
   const int bias_tensor_id = HasBias() ? tensors.size() : -1;
   if (HasBias()) {
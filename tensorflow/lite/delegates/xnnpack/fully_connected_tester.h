@@ -34,6 +34,8 @@ class FullyConnectedTester {
     kFP16,
     kTensorWiseQuantizedInt8,
     kChannelWiseQuantizedInt8,
+    kSparseFP32,
+    kBlockSparseFP32,
     kDynamic,
   };
   enum class BiasType {
@@ -106,6 +108,20 @@ class FullyConnectedTester {
     return *this;
   }
 
+  // FP32 weights with random sparsity, fed to the operator without a Densify
+  // operator.
+  inline FullyConnectedTester& SparseWeights() {
+    weights_type_ = WeightsType::kSparseFP32;
+    return *this;
+  }
+
+  // FP32 weights with 1x4 block sparsity, fed to the operator without a
+  // Densify operator. Requires a multiple of 4 input channels.
+  inline FullyConnectedTester& BlockSparseWeights() {
+    weights_type_ = WeightsType::kBlockSparseFP32;
+    return *this;
+  }
+
   inline FullyConnectedTester& DynamicWeights() {
     weights_type_ = WeightsType::kDynamic;
     bias_type_ = BiasType::kFP32;
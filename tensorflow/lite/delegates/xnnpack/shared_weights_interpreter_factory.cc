@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/shared_weights_interpreter_factory.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/minimal_logging.h"
+
+namespace tflite {
+namespace xnnpack {
+
+std::unique_ptr<SharedWeightsInterpreterFactory>
+SharedWeightsInterpreterFactory::Create(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const TfLiteXNNPackDelegateOptions& delegate_options) {
+  TfLiteXNNPackDelegateWeightsCache* weights_cache =
+      TfLiteXNNPackDelegateWeightsCacheCreate();
+  if (weights_cache == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "failed to create XNNPACK weights cache");
+    return nullptr;
+  }
+  std::unique_ptr<SharedWeightsInterpreterFactory> factory(
+      new SharedWeightsInterpreterFactory(model, op_resolver, delegate_options,
+                                          weights_cache));
+
+  // Applying the delegate to a first interpreter packs all the weights into
+  // the cache. The interpreter itself is not needed afterwards.
+  std::unique_ptr<Interpreter> interpreter;
+  if (factory->CreateInterpreter(&interpreter) != kTfLiteOk) {
+    return nullptr;
+  }
+  interpreter.reset();
+  if (!TfLiteXNNPackDelegateWeightsCacheFinalizeSoft(weights_cache)) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "failed to finalize XNNPACK weights cache");
+    return nullptr;
+  }
+  return factory;
+}
+
+SharedWeightsInterpreterFactory::SharedWeightsInterpreterFactory(
+    const FlatBufferModel& model, const OpResolver& op_resolver,
+    const TfLiteXNNPackDelegateOptions& delegate_options,
+    TfLiteXNNPackDelegateWeightsCache* weights_cache)
+    : model_(model),
+      op_resolver_(op_resolver),
+      delegate_options_(delegate_options),
+      weights_cache_(weights_cache) {
+  delegate_options_.weights_cache = weights_cache_;
+}
+
+SharedWeightsInterpreterFactory::~SharedWeightsInterpreterFactory() {
+  TfLiteXNNPackDelegateWeightsCacheDelete(weights_cache_);
+}
+
+TfLiteStatus SharedWeightsInterpreterFactory::CreateInterpreter(
+    std::unique_ptr<Interpreter>* interpreter) const {
+  std::unique_ptr<Interpreter> new_interpreter;
+  if (InterpreterBuilder(model_, op_resolver_)(&new_interpreter) !=
+      kTfLiteOk) {
+    return kTfLiteError;
+  }
+  Interpreter::TfLiteDelegatePtr delegate(
+      TfLiteXNNPackDelegateCreate(&delegate_options_),
+      TfLiteXNNPackDelegateDelete);
+  if (delegate == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "failed to create XNNPACK delegate");
+    return kTfLiteError;
+  }
+  // The interpreter takes ownership of the delegate, so that it is destroyed
+  // together with the interpreter.
+  if (new_interpreter->ModifyGraphWithDelegate(std::move(delegate)) !=
+      kTfLiteOk) {
+    return kTfLiteError;
+  }
+  *interpreter = std::move(new_interpreter);
+  return kTfLiteOk;
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
@@ -0,0 +1,79 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_INTERPRETER_FACTORY_H_
+#define TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_INTERPRETER_FACTORY_H_
+
+#include <memory>
+
+#include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+
+namespace tflite {
+namespace xnnpack {
+
+// Builds interpreters for one model that share the packed weights of the
+// operators delegated to XNNPACK.
+//
+// Every interpreter built this way owns an XNNPACK delegate, and so its own
+// activation buffers and XNNPACK runtime, but the delegates pack the weights
+// into a single weights cache. The model's weights are therefore packed once
+// rather than once per interpreter, which is what dominates the memory of
+// running many interpreters of a model, e.g. one per serving thread.
+//
+// The factory packs the weights when it is created, then soft-finalizes the
+// cache, so the interpreters it creates afterwards only look weights up.
+class SharedWeightsInterpreterFactory {
+ public:
+  // Returns nullptr on failure. `model` and `op_resolver` must outlive the
+  // factory and the interpreters it creates. `delegate_options.weights_cache`
+  // is ignored.
+  static std::unique_ptr<SharedWeightsInterpreterFactory> Create(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const TfLiteXNNPackDelegateOptions& delegate_options =
+          TfLiteXNNPackDelegateOptionsDefault());
+
+  ~SharedWeightsInterpreterFactory();
+
+  // Builds a new interpreter with the XNNPACK delegate applied. The
+  // interpreter must be destroyed before the factory. Safe to call from
+  // multiple threads concurrently.
+  TfLiteStatus CreateInterpreter(
+      std::unique_ptr<Interpreter>* interpreter) const;
+
+ private:
+  SharedWeightsInterpreterFactory(
+      const FlatBufferModel& model, const OpResolver& op_resolver,
+      const TfLiteXNNPackDelegateOptions& delegate_options,
+      TfLiteXNNPackDelegateWeightsCache* weights_cache);
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  TfLiteXNNPackDelegateOptions delegate_options_;
+  TfLiteXNNPackDelegateWeightsCache* weights_cache_;
+
+  SharedWeightsInterpreterFactory(const SharedWeightsInterpreterFactory&) =
+      delete;
+  SharedWeightsInterpreterFactory& operator=(
+      const SharedWeightsInterpreterFactory&) = delete;
+};
+
+}  // namespace xnnpack
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_DELEGATES_XNNPACK_SHARED_WEIGHTS_INTERPRETER_FACTORY_H_
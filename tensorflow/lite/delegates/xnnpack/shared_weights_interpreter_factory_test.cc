@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/delegates/xnnpack/shared_weights_interpreter_factory.h"
+
+#include <cstddef>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/delegates/xnnpack/conv_2d_tester.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/mutable_op_resolver.h"
+
+namespace tflite {
+namespace xnnpack {
+
+class DummyOpResolver : public MutableOpResolver {
+ public:
+  DummyOpResolver() {
+    AddBuiltin(BuiltinOperator_CONV_2D, DummyRegistration(), 1, 3);
+  }
+
+ private:
+  static const TfLiteRegistration* DummyRegistration() {
+    static TfLiteRegistration r = {nullptr, nullptr, Prepare, Invoke};
+    return &r;
+  }
+  static TfLiteStatus Prepare(TfLiteContext*, TfLiteNode*) { return kTfLiteOk; }
+  // Only the delegated graph can be invoked.
+  static TfLiteStatus Invoke(TfLiteContext*, TfLiteNode*) {
+    return kTfLiteError;
+  }
+};
+
+std::vector<float> Run(Interpreter* interpreter) {
+  EXPECT_EQ(kTfLiteOk, interpreter->AllocateTensors());
+  TfLiteTensor* input = interpreter->tensor(interpreter->inputs()[0]);
+  float* input_data = interpreter->typed_input_tensor<float>(0);
+  const size_t input_size = input->bytes / sizeof(float);
+  for (size_t i = 0; i < input_size; ++i) {
+    input_data[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+  EXPECT_EQ(kTfLiteOk, interpreter->Invoke());
+  TfLiteTensor* output = interpreter->tensor(interpreter->outputs()[0]);
+  const float* output_data = interpreter->typed_output_tensor<float>(0);
+  return std::vector<float>(output_data,
+                            output_data + output->bytes / sizeof(float));
+}
+
+class SharedWeightsInterpreterFactoryTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    buffer_ = Conv2DTester()
+                  .InputHeight(8)
+                  .InputWidth(8)
+                  .InputChannels(5)
+                  .OutputChannels(7)
+                  .KernelHeight(3)
+                  .KernelWidth(3)
+                  .CreateTfLiteModel();
+    model_ = FlatBufferModel::BuildFromBuffer(buffer_.data(), buffer_.size());
+    ASSERT_NE(model_, nullptr);
+  }
+
+  std::vector<char> buffer_;
+  std::unique_ptr<FlatBufferModel> model_;
+  DummyOpResolver resolver_;
+};
+
+TEST_F(SharedWeightsInterpreterFactoryTest, InterpretersAgree) {
+  auto factory = SharedWeightsInterpreterFactory::Create(*model_, resolver_);
+  ASSERT_NE(factory, nullptr);
+
+  std::unique_ptr<Interpreter> interpreter1;
+  std::unique_ptr<Interpreter> interpreter2;
+  ASSERT_EQ(kTfLiteOk, factory->CreateInterpreter(&interpreter1));
+  ASSERT_EQ(kTfLiteOk, factory->CreateInterpreter(&interpreter2));
+  const std::vector<float> output = Run(interpreter1.get());
+  EXPECT_EQ(output, Run(interpreter2.get()));
+  EXPECT_EQ(output, Run(interpreter1.get()));
+}
+
+TEST_F(SharedWeightsInterpreterFactoryTest, CreateConcurrently) {
+  auto factory = SharedWeightsInterpreterFactory::Create(*model_, resolver_);
+  ASSERT_NE(factory, nullptr);
+  std::unique_ptr<Interpreter> reference;
+  ASSERT_EQ(kTfLiteOk, factory->CreateInterpreter(&reference));
+  const std::vector<float> expected = Run(reference.get());
+
+  constexpr int kNumThreads = 4;
+  std::vector<std::thread> threads;
+  threads.reserve(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&] {
+      std::unique_ptr<Interpreter> interpreter;
+      ASSERT_EQ(kTfLiteOk, factory->CreateInterpreter(&interpreter));
+      EXPECT_EQ(expected, Run(interpreter.get()));
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
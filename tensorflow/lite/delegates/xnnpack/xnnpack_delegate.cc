@@ -306,12 +306,123 @@ xnn_datatype GetXNNPackDatatype(TfLiteContext* context,
       }
       break;
     }
+    case kTfLiteInt4: {
+      if (tensor.quantization.type != kTfLiteAffineQuantization) {
+        TF_LITE_KERNEL_LOG(context,
+                           "unsupported quantization type %d for INT4 "
+                           "tensor %d in XNNPACK delegate",
+                           tensor.quantization.type, t);
+        return xnn_datatype_invalid;
+      }
+      const auto quantization_params =
+          static_cast<const TfLiteAffineQuantization*>(
+              tensor.quantization.params);
+      if (quantization_params->scale == nullptr) {
+        TF_LITE_KERNEL_LOG(context,
+                           "missing scale quantization parameters for INT4 "
+                           "tensor %d in XNNPACK delegate",
+                           t);
+        return xnn_datatype_invalid;
+      }
+      if (quantization_params->zero_point == nullptr) {
+        TF_LITE_KERNEL_LOG(context,
+                           "missing zero point quantization parameters for "
+                           "INT4 tensor %d in XNNPACK delegate",
+                           t);
+        return xnn_datatype_invalid;
+      }
+      // Per-tensor scales of INT4 weights are expanded to per-channel ones
+      // when the weights are repacked in DelegatePrepare.
+      if (NumDimensions(&tensor) < 1 ||
+          quantization_params->scale->size !=
+              SizeOfDimension(&tensor,
+                              quantization_params->quantized_dimension)) {
+        TF_LITE_KERNEL_LOG(
+            context,
+            "unsupported number (%d) of scale quantization parameters for "
+            "INT4 tensor %d in XNNPACK delegate",
+            quantization_params->scale->size, t);
+        return xnn_datatype_invalid;
+      }
+      for (int i = 0; i < quantization_params->scale->size; i++) {
+        const float scale = quantization_params->scale->data[i];
+        if (!std::isnormal(scale) || scale <= 0.0f) {
+          TF_LITE_KERNEL_LOG(context,
+                             "unsupported scale value (%f) in channel %d for "
+                             "INT4 tensor %d in XNNPACK delegate",
+                             scale, i, t);
+          return xnn_datatype_invalid;
+        }
+      }
+      for (int i = 0; i < quantization_params->zero_point->size; i++) {
+        if (quantization_params->zero_point->data[i] != 0) {
+          TF_LITE_KERNEL_LOG(context,
+                             "unsupported zero-point value %d in channel "
+                             "%d of INT4 tensor %d in XNNPACK delegate",
+                             quantization_params->zero_point->data[i], i, t);
+          return xnn_datatype_invalid;
+        }
+      }
+      return xnn_datatype_qcint4;
+    }
     default:
       break;
   }
   return xnn_datatype_invalid;
 }
 
+// Size of the data of a static INT4 tensor repacked by PackInt4ForXNNPack.
+size_t PackedInt4SizeForXNNPack(const TfLiteTensor& tensor) {
+  const int columns = SizeOfDimension(&tensor, NumDimensions(&tensor) - 1);
+  if (columns == 0) {
+    return 0;
+  }
+  const size_t rows = NumElements(&tensor) / columns;
+  return rows * ((columns + 1) / 2);
+}
+
+// Repacks the data of a static INT4 tensor into the layout of XNNPACK INT4
+// weights. TFLite packs the signed values two per byte, low nibble first,
+// contiguously across the whole tensor. XNNPACK expects unsigned values with
+// a zero point of 8, and every row of the innermost dimension to start on a
+// byte boundary.
+void PackInt4ForXNNPack(const TfLiteTensor& tensor, uint8_t* packed_data) {
+  const int columns = SizeOfDimension(&tensor, NumDimensions(&tensor) - 1);
+  if (columns == 0) {
+    return;
+  }
+  const size_t rows = NumElements(&tensor) / columns;
+  const size_t row_bytes = (columns + 1) / 2;
+  const uint8_t* data = GetTensorData<uint8_t>(&tensor);
+  // Padding nibbles hold the zero point.
+  std::fill_n(packed_data, rows * row_bytes, 0x88);
+  for (size_t r = 0; r < rows; r++) {
+    for (int c = 0; c < columns; c++) {
+      const size_t i = r * columns + c;
+      const uint8_t value = (data[i / 2] >> (4 * (i % 2))) & 0xF;
+      const int shift = 4 * (c % 2);
+      uint8_t& packed = packed_data[r * row_bytes + c / 2];
+      packed = (packed & ~(0xF << shift)) | ((value ^ 0x8) << shift);
+    }
+  }
+}
+
+// Converts the data of a static sparse tensor into dense data.
+template <typename T>
+void DensifyStaticTensor(TfLiteContext* context, const TfLiteTensor& tensor,
+                         char* dense_data) {
+  const int dims_count = NumDimensions(&tensor);
+  std::vector<int> vector_shape(dims_count);
+  for (int i = 0; i < dims_count; i++) {
+    vector_shape[i] = SizeOfDimension(&tensor, i);
+  }
+  tflite::internal::sparsity::FormatConverter<T> converter(vector_shape,
+                                                           *tensor.sparsity);
+  converter.SparseToDense(static_cast<const T*>(tensor.data.data),
+                          NumElements(&tensor),
+                          reinterpret_cast<T*>(dense_data), context);
+}
+
 std::vector<size_t> TfLiteDimensionsToXNNPackDimensions(
     const std::vector<int>& tflite_dims) {
   std::vector<size_t> dims(tflite_dims.size());
@@ -624,6 +735,20 @@ class Delegate {
 
   TfLiteXNNPackDelegateOptions options() const { return options_; }
 
+  // Returns the data XNNPACK should use for static tensor t, i.e. either its
+  // unpacked data if it is quasi-static or was unpacked in DelegatePrepare, or
+  // the data of the tensor itself. Returns nullptr for non-static tensors.
+  const void* GetStaticTensorData(const TfLiteTensor* tensors, int t) const {
+    const auto it = static_unpacked_data_map_.find(t);
+    if (it != static_unpacked_data_map_.end()) {
+      return static_unpacked_data_.data() + it->second;
+    }
+    if (tensors[t].allocation_type == kTfLiteMmapRo) {
+      return tensors[t].data.raw_const;
+    }
+    return nullptr;
+  }
+
  private:
   TfLiteDelegate delegate_ = {
       reinterpret_cast<void*>(this),             // .data_
@@ -635,10 +760,11 @@ class Delegate {
   };
 
   // Unpacked data for quasi-static tensors, i.e. tensors produced by
-  // dequantizing or unpacking static buffers.
+  // dequantizing or unpacking static buffers, and for static tensors in a
+  // format XNNPACK does not consume directly, i.e. sparse and INT4 tensors.
   std::vector<char> static_unpacked_data_;
-  // Mapping from a tensor index for a quasi-static tensor to the offset to
-  // its unpacked data within static_unpacked_data_.
+  // Mapping from a tensor index for a quasi-static or unpacked static tensor
+  // to the offset to its unpacked data within static_unpacked_data_.
   std::unordered_map<int, size_t> static_unpacked_data_map_;
   // Set of indices of nodes which unpack static data, e.g. Dequantize
   // operators which convert FP16 static weights to FP32. These nodes are simply
@@ -916,16 +1042,7 @@ class Subgraph {
       }
 
       uint32_t flags = 0;
-      const void* data = nullptr;
-      if (context->tensors[t].allocation_type == kTfLiteMmapRo) {
-        data = context->tensors[t].data.raw_const;
-      } else {
-        // Check for quasi-static data.
-        const auto it = delegate.static_unpacked_data_map_.find(t);
-        if (it != delegate.static_unpacked_data_map_.end()) {
-          data = delegate.static_unpacked_data_.data() + it->second;
-        }
-      }
+      const void* data = delegate.GetStaticTensorData(context->tensors, t);
       if (inputs.count(t) != 0) {
         flags |= XNN_VALUE_FLAG_EXTERNAL_INPUT;
         if (data == nullptr) {
@@ -970,6 +1087,19 @@ class Subgraph {
                   ->quantized_dimension,
               dims.data(), data, XNN_INVALID_VALUE_ID, flags, &xnnpack_id);
           break;
+        case xnn_datatype_qcint4:
+          // The data was repacked with a zero point of 8 in DelegatePrepare.
+          status = xnn_define_channelwise_quantized_tensor_value_v2(
+              subgraph.get(), datatype, /*zero_point=*/8,
+              static_cast<const TfLiteAffineQuantization*>(
+                  context->tensors[t].quantization.params)
+                  ->scale->data,
+              dims.size(),
+              static_cast<const TfLiteAffineQuantization*>(
+                  context->tensors[t].quantization.params)
+                  ->quantized_dimension,
+              dims.data(), data, XNN_INVALID_VALUE_ID, flags, &xnnpack_id);
+          break;
         default:
           status = xnn_define_tensor_value(
               subgraph.get(), datatype, dims.size(), dims.data(), data,
@@ -1873,6 +2003,47 @@ class Subgraph {
     return kTfLiteError;
   }
 
+  static TfLiteStatus CheckTensorQCInt4Type(TfLiteContext* context,
+                                            const TfLiteTensor& tensor,
+                                            int expected_quantized_dimension,
+                                            int tensor_index, int node_index) {
+    TF_LITE_ENSURE_STATUS(CheckTensorType(context, tensor, kTfLiteInt4,
+                                          tensor_index, node_index));
+    if (tensor.quantization.type != kTfLiteAffineQuantization) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context, "unsupported quantization type %d in tensor #%d in node #%d",
+          tensor.quantization.type, tensor_index, node_index);
+      return kTfLiteError;
+    }
+    const TfLiteAffineQuantization* quantization_params =
+        static_cast<const TfLiteAffineQuantization*>(
+            tensor.quantization.params);
+    if (quantization_params->scale == nullptr ||
+        quantization_params->zero_point == nullptr) {
+      TF_LITE_MAYBE_KERNEL_LOG(context,
+                               "missing quantization parameters in "
+                               "tensor #%d in node #%d",
+                               tensor_index, node_index);
+      return kTfLiteError;
+    }
+    if (quantization_params->scale->size > 1 &&
+        quantization_params->quantized_dimension !=
+            expected_quantized_dimension) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context,
+          "unsupported quantized dimension %d in tensor #%d in node #%d",
+          quantization_params->quantized_dimension, tensor_index, node_index);
+      return kTfLiteError;
+    }
+    if (tensor.sparsity != nullptr) {
+      TF_LITE_MAYBE_KERNEL_LOG(
+          context, "unsupported sparse INT4 tensor #%d in node #%d",
+          tensor_index, node_index);
+      return kTfLiteError;
+    }
+    return kTfLiteOk;
+  }
+
   static TfLiteStatus CheckTensorFloat32OrQInt32Type(const Delegate& delegate,
                                                      TfLiteContext* context,
                                                      const TfLiteTensor& tensor,
@@ -3688,9 +3859,15 @@ class Subgraph {
       TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
           logging_context, filter_tensor, node->inputs->data[1], node_index));
     } else {
-      TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQUInt8Type(
-          delegate, logging_context, filter_tensor, node->inputs->data[1],
-          node_index));
+      if (filter_tensor.type == kTfLiteInt4) {
+        TF_LITE_ENSURE_STATUS(CheckTensorQCInt4Type(
+            logging_context, filter_tensor, /*expected_quantized_dimension=*/0,
+            node->inputs->data[1], node_index));
+      } else {
+        TF_LITE_ENSURE_STATUS(CheckTensorFloat32OrQUInt8Type(
+            delegate, logging_context, filter_tensor, node->inputs->data[1],
+            node_index));
+      }
       if (quasi_static_tensors.count(node->inputs->data[1]) == 0) {
         TF_LITE_ENSURE_STATUS(CheckTensorStaticAllocation(
             logging_context, filter_tensor, node->inputs->data[1],
@@ -3736,7 +3913,8 @@ class Subgraph {
 
     bool dynamically_quantized = (delegate.enable_latest_operators() &&
                                   (input_tensor.type == kTfLiteFloat32 &&
-                                   filter_tensor.type == kTfLiteInt8));
+                                   (filter_tensor.type == kTfLiteInt8 ||
+                                    filter_tensor.type == kTfLiteInt4)));
     if (input_tensor.type != output_tensor.type ||
         ((input_tensor.type != filter_tensor.type) && !dynamically_quantized)) {
       TF_LITE_MAYBE_KERNEL_LOG(
@@ -3827,15 +4005,6 @@ class Subgraph {
 
     if (subgraph != nullptr) {
       if (dynamically_quantized) {
-        TfLiteAffineQuantization* filter_params =
-            reinterpret_cast<TfLiteAffineQuantization*>(
-                filter_tensor.quantization.params);
-        if (filter_params->scale->size != output_channels) {
-          TfLiteFloatArrayFree(filter_params->scale);
-          filter_params->scale = TfLiteFloatArrayCreate(output_channels);
-          std::fill_n(filter_params->scale->data, output_channels,
-                      filter_tensor.params.scale);
-        }
         uint32_t dq_quantized_id = XNN_INVALID_VALUE_ID;
         size_t num_nonbatch_dims = 0;
         int ic = 1;
@@ -3878,21 +4047,33 @@ class Subgraph {
               node_index);
           return kTfLiteError;
         }
-        std::vector<size_t> filter_dims(
-            &filter_tensor.dims->data[0],
-            &filter_tensor.dims->data[NumDimensions(&filter_tensor)]);
-        uint32_t kernel_id = XNN_INVALID_VALUE_ID;
-        status = xnn_define_channelwise_quantized_tensor_value(
-            subgraph, xnn_datatype_qcint8, filter_params->scale->data,
-            filter_dims.size(), /*channel_dim=*/0, filter_dims.data(),
-            GetTensorData<int8_t>(&filter_tensor), XNN_INVALID_VALUE_ID,
-            /*flags=*/0, &kernel_id);
-        if (status != xnn_status_success) {
-          TF_LITE_KERNEL_LOG(
-              logging_context, "failed to update filter tensor %s node #%d",
-              EnumNameBuiltinOperator(BuiltinOperator_FULLY_CONNECTED),
-              node_index);
-          return kTfLiteError;
+        // INT4 filters are always defined as channelwise quantized values.
+        uint32_t kernel_id = input_output_tensors.at(node->inputs->data[1]);
+        if (filter_tensor.type == kTfLiteInt8) {
+          TfLiteAffineQuantization* filter_params =
+              reinterpret_cast<TfLiteAffineQuantization*>(
+                  filter_tensor.quantization.params);
+          if (filter_params->scale->size != output_channels) {
+            TfLiteFloatArrayFree(filter_params->scale);
+            filter_params->scale = TfLiteFloatArrayCreate(output_channels);
+            std::fill_n(filter_params->scale->data, output_channels,
+                        filter_tensor.params.scale);
+          }
+          std::vector<size_t> filter_dims(
+              &filter_tensor.dims->data[0],
+              &filter_tensor.dims->data[NumDimensions(&filter_tensor)]);
+          status = xnn_define_channelwise_quantized_tensor_value(
+              subgraph, xnn_datatype_qcint8, filter_params->scale->data,
+              filter_dims.size(), /*channel_dim=*/0, filter_dims.data(),
+              delegate.GetStaticTensorData(tensors, node->inputs->data[1]),
+              XNN_INVALID_VALUE_ID, /*flags=*/0, &kernel_id);
+          if (status != xnn_status_success) {
+            TF_LITE_KERNEL_LOG(
+                logging_context, "failed to update filter tensor %s node #%d",
+                EnumNameBuiltinOperator(BuiltinOperator_FULLY_CONNECTED),
+                node_index);
+            return kTfLiteError;
+          }
         }
         status = xnn_define_fully_connected(
             subgraph, output_min, output_max, dq_quantized_id, kernel_id,
@@ -6405,6 +6586,10 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
   std::unordered_set<int> quasi_static_tensors;
   // Set of quasi-static tensors consumed by the delegated nodes.
   std::unordered_set<int> quasi_static_tensors_to_unpack;
+  // Set of static tensors consumed by the delegated nodes in a format XNNPACK
+  // does not support: sparse tensors fed to an operator without a Densify
+  // operator, and INT4 tensors.
+  std::unordered_set<int> static_tensors_to_unpack;
   // Record all VarHandle nodes. At the point of visiting it, we don't know if
   // it can be delegated yet, because we don't know the type of the variable -
   // we rely on ReadVariable/AssignVariable to tell us the type. So the first
@@ -6524,8 +6709,17 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     }
 
     for (int j = 0; j < node->inputs->size; j++) {
-      if (quasi_static_tensors.count(node->inputs->data[j]) != 0) {
-        quasi_static_tensors_to_unpack.insert(node->inputs->data[j]);
+      const int t = node->inputs->data[j];
+      if (quasi_static_tensors.count(t) != 0) {
+        quasi_static_tensors_to_unpack.insert(t);
+      }
+      if (t >= 0 && context->tensors[t].allocation_type == kTfLiteMmapRo &&
+          (context->tensors[t].type == kTfLiteInt4 ||
+           (context->tensors[t].sparsity != nullptr &&
+            (context->tensors[t].type == kTfLiteFloat16 ||
+             context->tensors[t].type == kTfLiteInt8 ||
+             context->tensors[t].type == kTfLiteFloat32)))) {
+        static_tensors_to_unpack.insert(t);
       }
     }
 
@@ -6747,6 +6941,60 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
     static_unpacked_data_map_[t] = tensor_offset;
   }
 
+  // Unpack static tensors which XNNPACK cannot consume directly: sparse
+  // tensors are densified, and INT4 tensors are repacked.
+  for (int t : static_tensors_to_unpack) {
+    TfLiteTensor& tensor = context->tensors[t];
+    const size_t unpacked_size =
+        tensor.type == kTfLiteInt4
+            ? PackedInt4SizeForXNNPack(tensor)
+            : NumElements(&tensor) * TfLiteTypeGetSize(tensor.type);
+
+    // Align to XNN_EXTRA_BYTES bytes
+    while (static_unpacked_data_.size() % XNN_EXTRA_BYTES != 0) {
+      static_unpacked_data_.push_back(0);
+    }
+    const size_t tensor_offset = static_unpacked_data_.size();
+    static_unpacked_data_.resize(tensor_offset + unpacked_size);
+    char* unpacked_data = static_unpacked_data_.data() + tensor_offset;
+
+    switch (tensor.type) {
+      case kTfLiteInt4: {
+        PackInt4ForXNNPack(tensor, reinterpret_cast<uint8_t*>(unpacked_data));
+        // XNNPACK only supports channelwise INT4 weights, so expand the
+        // per-tensor scale.
+        TfLiteAffineQuantization* quant_params =
+            static_cast<TfLiteAffineQuantization*>(tensor.quantization.params);
+        const int num_channels =
+            SizeOfDimension(&tensor, quant_params->quantized_dimension);
+        if (quant_params->scale->size == 1 && num_channels != 1) {
+          const float scale = quant_params->scale->data[0];
+          TfLiteFloatArrayFree(quant_params->scale);
+          quant_params->scale = TfLiteFloatArrayCreate(num_channels);
+          std::fill_n(quant_params->scale->data, num_channels, scale);
+        }
+        break;
+      }
+      case kTfLiteFloat32:
+        DensifyStaticTensor<float>(context, tensor, unpacked_data);
+        static_sparse_weights_.insert(t);
+        break;
+      case kTfLiteFloat16:
+        DensifyStaticTensor<Eigen::half>(context, tensor, unpacked_data);
+        static_sparse_weights_.insert(t);
+        break;
+      case kTfLiteInt8:
+        DensifyStaticTensor<int8_t>(context, tensor, unpacked_data);
+        static_sparse_weights_.insert(t);
+        break;
+      default:
+        // Only these types are recorded as static tensors to unpack.
+        TFLITE_DCHECK(false);
+    }
+
+    static_unpacked_data_map_[t] = tensor_offset;
+  }
+
   // Add nodes that unpack static data consumed by delegated nodes.
   // Note: this is done purely to avoid the overhead of running these nodes
   // again in TFLite interpreter which would allocate memory for their outputs.
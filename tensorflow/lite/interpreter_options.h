@@ -29,7 +29,13 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_reuse_memory_plan_on_resize_(false),
+        experimental_parallel_node_execution_threads_(1),
+        experimental_lazy_subgraph_preparation_(false),
+        experimental_delegate_partition_speedup_(0),
+        experimental_delegate_partition_transfer_cost_(0),
+        experimental_map_external_weights_per_op_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +99,130 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  // If value == true, `AllocateTensors` after an input is resized keeps the
+  // arena offsets of the tensors which still fit in their previous
+  // allocation, and only plans the tensors of the nodes from the first one
+  // whose tensors grew. Allocating tensors once for the largest expected
+  // input shapes then avoids memory planning for any smaller shapes, at the
+  // cost of keeping the arenas at their largest size.
+  // WARNING: This is an experimental API and subject to change.
+  void SetReuseMemoryPlanOnResize(bool value = true) {
+    experimental_reuse_memory_plan_on_resize_ = value;
+  }
+
+  // Returns if the `experimental_reuse_memory_plan_on_resize_` feature is
+  // enabled.
+  // WARNING: This is an experimental API and subject to change.
+  bool GetReuseMemoryPlanOnResize() {
+    return experimental_reuse_memory_plan_on_resize_;
+  }
+
+  // If num_threads > 1, `Invoke` runs the nodes which do not depend on each
+  // other concurrently on up to `num_threads` threads. The execution plan is
+  // reordered so that independent nodes are adjacent, and the memory plan
+  // keeps the tensors of concurrent nodes alive together, so peak arena usage
+  // may grow. Delegated nodes, control flow ops, custom ops and ops using
+  // resource, variant, string or variable tensors always run on their own.
+  // Each worker thread has its own single threaded CPU backend context, so
+  // this is mostly useful for models with parallel branches of small ops
+  // which can not use the intra-op threads of the interpreter.
+  // WARNING: This is an experimental API and subject to change.
+  void SetParallelNodeExecution(int num_threads) {
+    experimental_parallel_node_execution_threads_ =
+        num_threads > 1 ? num_threads : 1;
+  }
+
+  // Returns the number of threads used to run independent nodes, or 1 if the
+  // `experimental_parallel_node_execution_threads_` feature is disabled.
+  // WARNING: This is an experimental API and subject to change.
+  int GetParallelNodeExecution() {
+    return experimental_parallel_node_execution_threads_;
+  }
+
+  // If value == true, the subgraphs run by control flow ops (e.g. the bodies
+  // of `WHILE` and the branches of `IF`) are prepared the first time they are
+  // run instead of by `AllocateTensors`, and `IF` only prepares the branches
+  // which are taken. This reduces the time and memory spent by
+  // `AllocateTensors` for models with many rarely executed subgraphs, at the
+  // cost of a slower first invocation of them. The outputs of control flow
+  // ops become dynamic tensors.
+  // WARNING: This is an experimental API and subject to change.
+  void SetLazySubgraphPreparation(bool value = true) {
+    experimental_lazy_subgraph_preparation_ = value;
+  }
+
+  // Returns if the `experimental_lazy_subgraph_preparation_` feature is
+  // enabled.
+  // WARNING: This is an experimental API and subject to change.
+  bool GetLazySubgraphPreparation() {
+    return experimental_lazy_subgraph_preparation_;
+  }
+
+  // If delegate_speedup > 0, the node subsets claimed by a delegate are only
+  // delegated if the cost model estimates they run faster than on CPU. The
+  // CPU cost of a node is estimated by the size of its input and output
+  // tensors, which the delegate processes `delegate_speedup` times faster,
+  // and moving each non-constant tensor between CPU and the delegate costs
+  // `transfer_cost` times its size. Partitions which do not pay for the
+  // tensors they exchange with CPU nodes are run on CPU instead, which avoids
+  // many small delegated partitions alternating with CPU fallbacks.
+  // WARNING: This is an experimental API and subject to change.
+  void SetDelegatePartitionCostModel(float delegate_speedup,
+                                     float transfer_cost = 1.0f) {
+    experimental_delegate_partition_speedup_ =
+        delegate_speedup > 0 ? delegate_speedup : 0;
+    experimental_delegate_partition_transfer_cost_ =
+        transfer_cost > 0 ? transfer_cost : 0;
+  }
+
+  // Returns the speedup of delegated nodes over CPU nodes assumed by the
+  // delegate partition cost model, or 0 if it is disabled.
+  // WARNING: This is an experimental API and subject to change.
+  float GetDelegatePartitionSpeedup() {
+    return experimental_delegate_partition_speedup_;
+  }
+
+  // Returns the cost per byte of moving a tensor between CPU and a delegate
+  // assumed by the delegate partition cost model.
+  // WARNING: This is an experimental API and subject to change.
+  float GetDelegatePartitionTransferCost() {
+    return experimental_delegate_partition_transfer_cost_;
+  }
+
+  // Only applies to models built with external weights (see
+  // `FlatBufferModel::BuildFromFileWithExternalWeights`), whose constant
+  // tensors are mapped from the weights file while they are used. By default,
+  // the constant tensors of a subgraph are mapped for each of its
+  // invocations. If value == true, the constant inputs of each op are only
+  // mapped while it is prepared or invoked instead, so that only the weights
+  // of one op at a time occupy memory and address space, e.g. to run the
+  // layers of large language models on small devices, at the cost of mapping
+  // them again for each invocation.
+  // Kernels must not keep pointers to the data of constant tensors across
+  // their prepare and invoke calls.
+  // WARNING: This is an experimental API and subject to change.
+  void SetMapExternalWeightsPerOp(bool value = true) {
+    experimental_map_external_weights_per_op_ = value;
+  }
+
+  // Returns if the `experimental_map_external_weights_per_op_` feature is
+  // enabled.
+  // WARNING: This is an experimental API and subject to change.
+  bool GetMapExternalWeightsPerOp() {
+    return experimental_map_external_weights_per_op_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  bool experimental_reuse_memory_plan_on_resize_;
+  int experimental_parallel_node_execution_threads_;
+  bool experimental_lazy_subgraph_preparation_;
+  float experimental_delegate_partition_speedup_;
+  float experimental_delegate_partition_transfer_cost_;
+  bool experimental_map_external_weights_per_op_;
 };
 
 }  // namespace tflite
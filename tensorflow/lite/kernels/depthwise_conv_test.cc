@@ -1997,6 +1997,68 @@ TEST_P(PerChannelQuantizedDepthwiseConvolutionOpTest,
               })));
 }
 
+class PerChannelQuantized16x8DepthwiseConvolutionOpModel
+    : public BaseDepthwiseConvolutionOpModel {
+ public:
+  using BaseDepthwiseConvolutionOpModel::BaseDepthwiseConvolutionOpModel;
+
+  void SetInput(const std::vector<float>& data) {
+    QuantizeAndPopulate<int16_t>(input_, data);
+  }
+
+  void SetFilter(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(filter_, data);
+  }
+
+  void SetBias(const std::vector<float>& data) {
+    PerChannelQuantizeBias(bias_, data);
+  }
+
+  std::vector<int16_t> GetOutput() { return ExtractVector<int16_t>(output_); }
+};
+
+TEST_P(PerChannelQuantizedDepthwiseConvolutionOpTest,
+       Int16x8MultithreadedMatchesSingleThreaded) {
+  const int batches = 2;
+  const int height = 9;
+  const int width = 6;
+  const int depth = 4;
+  std::vector<float> input(batches * height * width * depth);
+  for (int i = 0; i < input.size(); ++i) {
+    input[i] = (i * 7) % 23 - 11;
+  }
+  std::vector<float> filter(3 * 3 * depth);
+  for (int i = 0; i < filter.size(); ++i) {
+    filter[i] = (i * 5) % 9 - 4;
+  }
+
+  std::vector<std::vector<int16_t>> outputs;
+  for (int num_threads : {1, 4}) {
+    PerChannelQuantized16x8DepthwiseConvolutionOpModel m(
+        GetRegistration(),
+        {TensorType_INT16, {batches, height, width, depth}, -64, 64},
+        {TensorType_INT8,
+         {1, 3, 3, depth},
+         0,
+         0,
+         0,
+         0,
+         /*per_channel_quantization=*/true,
+         /*per_channel_quantization_scales=*/{1, 2, 3, 4},
+         /*per_channel_quantization_offsets=*/{0, 0, 0, 0},
+         /*channel_index=*/3},
+        {TensorType_INT16, {}, -512, 512}, Padding_SAME,
+        /*dilation_factor=*/1, /*stride_width=*/2, /*stride_height=*/2);
+    m.SetInput(input);
+    m.SetFilter(filter);
+    m.SetBias({3, -2, 4, 6});
+    m.SetNumThreads(num_threads);
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+    outputs.push_back(m.GetOutput());
+  }
+  EXPECT_THAT(outputs[1], ElementsAreArray(outputs[0]));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     DepthwiseConvolutionOpTest, DepthwiseConvolutionOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMap)));
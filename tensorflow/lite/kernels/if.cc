@@ -36,6 +36,10 @@ struct OpData {
   int then_subgraph_index;
   int else_subgraph_index;
   bool subgraph_has_dynamic_output_tensors;
+  // Whether the branch subgraphs were prepared for the current input shapes.
+  // Only tracked when the subgraphs are prepared lazily.
+  bool then_subgraph_prepared;
+  bool else_subgraph_prepared;
 };
 
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
@@ -44,6 +48,8 @@ void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   op_data->then_subgraph_index = params->then_subgraph_index;
   op_data->else_subgraph_index = params->else_subgraph_index;
   op_data->subgraph_has_dynamic_output_tensors = false;
+  op_data->then_subgraph_prepared = false;
+  op_data->else_subgraph_prepared = false;
   return op_data;
 }
 
@@ -51,6 +57,26 @@ void Free(TfLiteContext* context, void* buffer) {
   delete reinterpret_cast<OpData*>(buffer);
 }
 
+// Propagates the shapes and types of the node inputs to the inputs of a branch
+// subgraph and allocates its tensors.
+TfLiteStatus PrepareBranchSubgraph(TfLiteContext* context,
+                                   Subgraph* this_subgraph,
+                                   const std::vector<int>& node_inputs,
+                                   Subgraph* subgraph) {
+  TF_LITE_ENSURE_OK(
+      context, CopyTensorsShapeAndType(context, this_subgraph, node_inputs,
+                                       subgraph, subgraph->inputs(), true));
+  for (int input_idx : subgraph->inputs()) {
+    if (input_idx == kTfLiteOptionalTensor) continue;
+    TfLiteTensor* subgraph_input = subgraph->tensor(input_idx);
+    if (!IsResourceOrVariant(subgraph_input)) {
+      // Set the allocation type to custom to prevent memory allocation.
+      subgraph_input->allocation_type = kTfLiteCustom;
+    }
+  }
+  return subgraph->AllocateTensors();
+}
+
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
 
@@ -89,26 +115,27 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   then_subgraph->RemoveUnusedInputs();
   else_subgraph->RemoveUnusedInputs();
 
+  if (this_subgraph->ShouldPrepareSubgraphsLazily()) {
+    // Only prepare the branch which is taken, when it is run. The output
+    // shapes are not known until then.
+    op_data->then_subgraph_prepared = false;
+    op_data->else_subgraph_prepared = false;
+    op_data->subgraph_has_dynamic_output_tensors = true;
+    for (int i = 0; i < num_outputs; ++i) {
+      if (node->outputs->data[i] == kTfLiteOptionalTensor) continue;
+      TfLiteTensor* output;
+      TF_LITE_ENSURE_OK(context, GetOutputSafe(context, node, i, &output));
+      SetTensorToDynamic(output);
+    }
+    return kTfLiteOk;
+  }
+
   const int* const start = node->inputs->data + 1;
   std::vector<int> node_inputs(start, start + num_inputs);
   // Prepare and check the subgraphs.
   for (auto* subgraph : {then_subgraph, else_subgraph}) {
-    TF_LITE_ENSURE_OK(
-        context, CopyTensorsShapeAndType(context, this_subgraph, node_inputs,
-                                         subgraph, subgraph->inputs(), true));
-  }
-
-  for (auto* subgraph : {then_subgraph, else_subgraph}) {
-    for (int i = 0; i < num_inputs; ++i) {
-      int input_idx = subgraph->inputs()[i];
-      if (input_idx == kTfLiteOptionalTensor) continue;
-      TfLiteTensor* subgraph_input = subgraph->tensor(input_idx);
-      if (!IsResourceOrVariant(subgraph_input)) {
-        // Set the allocation type to custom to prevent memory allocation.
-        subgraph_input->allocation_type = kTfLiteCustom;
-      }
-    }
-    TF_LITE_ENSURE_OK(context, subgraph->AllocateTensors());
+    TF_LITE_ENSURE_OK(context, PrepareBranchSubgraph(context, this_subgraph,
+                                                     node_inputs, subgraph));
     op_data->subgraph_has_dynamic_output_tensors |=
         subgraph->HasDynamicTensors();
   }
@@ -270,10 +297,23 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   bool cond_value = cond->data.b[0];
 
   Subgraph* active_branch_subgraph;
+  bool* active_branch_prepared;
   if (cond_value) {
     active_branch_subgraph = then_subgraph;
+    active_branch_prepared = &op_data->then_subgraph_prepared;
   } else {
     active_branch_subgraph = else_subgraph;
+    active_branch_prepared = &op_data->else_subgraph_prepared;
+  }
+
+  if (this_subgraph->ShouldPrepareSubgraphsLazily() &&
+      !*active_branch_prepared) {
+    const int* const start = node->inputs->data + 1;
+    std::vector<int> node_inputs(start, start + node->inputs->size - 1);
+    TF_LITE_ENSURE_OK(
+        context, PrepareBranchSubgraph(context, this_subgraph, node_inputs,
+                                       active_branch_subgraph));
+    *active_branch_prepared = true;
   }
 
   if (op_data->subgraph_has_dynamic_output_tensors) {
@@ -576,6 +576,47 @@ TEST_F(IfTest, TestTriangularNumberSequenceWithShallowCopy) {
   ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
 }
 
+TEST_F(IfTest, TestLazySubgraphPreparation) {
+  interpreter_ = std::make_unique<Interpreter>();
+  AddSubgraphs(2);
+  builder_->BuildAddSubgraph(interpreter_->subgraph(1));
+  builder_->BuildMulSubgraph(interpreter_->subgraph(2));
+  builder_->BuildIfSubgraph(&interpreter_->primary_subgraph());
+
+  InterpreterOptions options;
+  options.SetLazySubgraphPreparation();
+  ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {1});
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {2});
+  interpreter_->ResizeInputTensor(interpreter_->inputs()[2], {1, 2});
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[1]), {5, 7});
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[2]), {1, 2});
+
+  // Neither branch is allocated until it is taken.
+  Subgraph* then_subgraph = interpreter_->subgraph(1);
+  Subgraph* else_subgraph = interpreter_->subgraph(2);
+  TfLiteTensor* then_output =
+      then_subgraph->tensor(then_subgraph->outputs()[0]);
+  TfLiteTensor* else_output =
+      else_subgraph->tensor(else_subgraph->outputs()[0]);
+  EXPECT_EQ(then_output->data.raw, nullptr);
+  EXPECT_EQ(else_output->data.raw, nullptr);
+
+  interpreter_->typed_input_tensor<bool>(0)[0] = false;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  TfLiteTensor* output = interpreter_->tensor(interpreter_->outputs()[0]);
+  CheckIntTensor(output, {1, 2}, {5, 14});
+  EXPECT_EQ(then_output->data.raw, nullptr);
+
+  interpreter_->typed_input_tensor<bool>(0)[0] = true;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  CheckIntTensor(output, {1, 2}, {6, 9});
+  interpreter_->typed_input_tensor<bool>(0)[0] = false;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  CheckIntTensor(output, {1, 2}, {5, 14});
+}
+
 TEST_F(IfTest, TestPadLoop) {
   interpreter_ = std::make_unique<Interpreter>();
   AddSubgraphs(2);
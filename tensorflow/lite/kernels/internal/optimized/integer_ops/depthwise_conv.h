@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/optimized/neon_check.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/reference/depthwiseconv_uint8.h"
+#include "tensorflow/lite/kernels/internal/reference/integer_ops/depthwise_conv.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 
 namespace tflite {
@@ -2022,6 +2023,159 @@ inline void DepthwiseConvPerChannel(
   }
 }
 
+// Computes output_data[thread_start:thread_end] along thread_dim of the 16x8
+// DepthwiseConv with the reference kernel. Rows are split by shifting the
+// padding of each batch entry by the rows before thread_start, so the result
+// is bit-exact with the single threaded reference kernel.
+inline void DepthwiseConvPerChannel16x8Impl(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int16* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int64_t* bias_data, const RuntimeShape& output_shape,
+    int16* output_data, int thread_start, int thread_end, int thread_dim) {
+  TFLITE_DCHECK(thread_dim == 0 || thread_dim == 1);
+  const int batches = MatchingDim(input_shape, 0, output_shape, 0);
+  const int input_height = input_shape.Dims(1);
+  const int input_width = input_shape.Dims(2);
+  const int input_depth = input_shape.Dims(3);
+  const int output_height = output_shape.Dims(1);
+  const int output_width = output_shape.Dims(2);
+  const int output_depth = output_shape.Dims(3);
+  const int input_batch_size = input_height * input_width * input_depth;
+  const int output_row_size = output_width * output_depth;
+
+  if (thread_dim == 0) {
+    const int thread_batches = thread_end - thread_start;
+    reference_integer_ops::DepthwiseConvPerChannel(
+        params, output_multiplier, output_shift,
+        RuntimeShape({thread_batches, input_height, input_width, input_depth}),
+        input_data + thread_start * input_batch_size, filter_shape,
+        filter_data, bias_shape, bias_data,
+        RuntimeShape(
+            {thread_batches, output_height, output_width, output_depth}),
+        output_data + thread_start * output_height * output_row_size);
+    return;
+  }
+
+  DepthwiseParams thread_params = params;
+  thread_params.padding_values.height -= thread_start * params.stride_height;
+  const RuntimeShape thread_input_shape(
+      {1, input_height, input_width, input_depth});
+  const RuntimeShape thread_output_shape(
+      {1, thread_end - thread_start, output_width, output_depth});
+  for (int batch = 0; batch < batches; ++batch) {
+    reference_integer_ops::DepthwiseConvPerChannel(
+        thread_params, output_multiplier, output_shift, thread_input_shape,
+        input_data + batch * input_batch_size, filter_shape, filter_data,
+        bias_shape, bias_data, thread_output_shape,
+        output_data + (batch * output_height + thread_start) * output_row_size);
+  }
+}
+
+struct DepthwiseConv16x8WorkerTask : cpu_backend_threadpool::Task {
+  DepthwiseConv16x8WorkerTask(
+      const DepthwiseParams& params, const int32* output_multiplier,
+      const int32* output_shift, const RuntimeShape& input_shape,
+      const int16* input_data, const RuntimeShape& filter_shape,
+      const int8* filter_data, const RuntimeShape& bias_shape,
+      const int64_t* bias_data, const RuntimeShape& output_shape,
+      int16* output_data, int thread_start, int thread_end, int thread_dim)
+      : params_(params),
+        output_multiplier_(output_multiplier),
+        output_shift_(output_shift),
+        input_shape_(input_shape),
+        input_data_(input_data),
+        filter_shape_(filter_shape),
+        filter_data_(filter_data),
+        bias_shape_(bias_shape),
+        bias_data_(bias_data),
+        output_shape_(output_shape),
+        output_data_(output_data),
+        thread_start_(thread_start),
+        thread_end_(thread_end),
+        thread_dim_(thread_dim) {}
+
+  void Run() override {
+    DepthwiseConvPerChannel16x8Impl(
+        params_, output_multiplier_, output_shift_, input_shape_, input_data_,
+        filter_shape_, filter_data_, bias_shape_, bias_data_, output_shape_,
+        output_data_, thread_start_, thread_end_, thread_dim_);
+  }
+
+ private:
+  const DepthwiseParams& params_;
+  const int32* output_multiplier_;
+  const int32* output_shift_;
+  const RuntimeShape& input_shape_;
+  const int16* input_data_;
+  const RuntimeShape& filter_shape_;
+  const int8* filter_data_;
+  const RuntimeShape& bias_shape_;
+  const int64_t* bias_data_;
+  const RuntimeShape& output_shape_;
+  int16* output_data_;
+  int thread_start_;
+  int thread_end_;
+  int thread_dim_;
+};
+
+// 16x8 DepthwiseConv, multithreaded over batches or output rows like the int8
+// one.
+inline void DepthwiseConvPerChannel(
+    const DepthwiseParams& params, const int32* output_multiplier,
+    const int32* output_shift, const RuntimeShape& input_shape,
+    const int16* input_data, const RuntimeShape& filter_shape,
+    const int8* filter_data, const RuntimeShape& bias_shape,
+    const int64_t* bias_data, const RuntimeShape& output_shape,
+    int16* output_data, CpuBackendContext* cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("DepthwiseConvInt16x8");
+  TFLITE_DCHECK_EQ(input_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(filter_shape.DimensionsCount(), 4);
+  TFLITE_DCHECK_EQ(output_shape.DimensionsCount(), 4);
+
+  const int output_batches = output_shape.Dims(0);
+  const int output_rows = output_shape.Dims(1);
+  int thread_count_batch = HowManyConvThreads(output_shape, filter_shape, 0);
+  int thread_count_row = HowManyConvThreads(output_shape, filter_shape, 1);
+  int thread_dim, thread_count, thread_dim_size;
+  if (thread_count_batch > thread_count_row) {
+    thread_dim = 0;
+    thread_dim_size = output_batches;
+    thread_count = thread_count_batch;
+  } else {
+    thread_dim = 1;
+    thread_dim_size = output_rows;
+    thread_count = thread_count_row;
+  }
+
+  const int max_threads = cpu_backend_context->max_num_threads();
+  thread_count = std::max(1, std::min(thread_count, max_threads));
+
+  if (thread_count == 1) {
+    reference_integer_ops::DepthwiseConvPerChannel(
+        params, output_multiplier, output_shift, input_shape, input_data,
+        filter_shape, filter_data, bias_shape, bias_data, output_shape,
+        output_data);
+    return;
+  }
+
+  std::vector<DepthwiseConv16x8WorkerTask> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end =
+        thread_start + (thread_dim_size - thread_start) / (thread_count - i);
+    tasks.emplace_back(params, output_multiplier, output_shift, input_shape,
+                       input_data, filter_shape, filter_data, bias_shape,
+                       bias_data, output_shape, output_data, thread_start,
+                       thread_end, thread_dim);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 }  // namespace optimized_integer_ops
 }  // namespace tflite
 
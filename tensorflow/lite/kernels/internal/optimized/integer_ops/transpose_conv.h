@@ -16,11 +16,149 @@ limitations under the License.
 #define TENSORFLOW_LITE_KERNELS_INTERNAL_OPTIMIZED_INTEGER_OPS_TRANSPOSE_CONV_H_
 
 #include <algorithm>
+#include <vector>
 
+#include "tensorflow/lite/kernels/cpu_backend_context.h"
+#include "tensorflow/lite/kernels/cpu_backend_threadpool.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 
 namespace tflite {
 namespace optimized_integer_ops {
+namespace transpose_conv {
+
+// How many accumulations or outputs are needed to make it worth using one more
+// thread for the Col2im and the quantization of TransposeConvV2. The GEMM is
+// multithreaded by cpu_backend_gemm.
+constexpr int kMinWorkPerThread = 1 << 14;
+
+inline int HowManyThreads(int work, int units,
+                          CpuBackendContext* cpu_backend_context) {
+  return std::max(1, std::min({cpu_backend_context->max_num_threads(),
+                               work / kMinWorkPerThread, units}));
+}
+
+// Same as optimized_ops::Col2im, but only accumulates the channels
+// [channel_start, channel_end), so that threads can handle disjoint channels.
+inline void Col2imChannels(const int32_t* col_data, int depth,
+                           int channel_start, int channel_end, int height,
+                           int width, int filter_h, int filter_w, int pad_t,
+                           int pad_l, int pad_b, int pad_r, int stride_h,
+                           int stride_w, int32_t* im_data) {
+  const int height_col = (height + pad_t + pad_b - filter_h) / stride_h + 1;
+  const int width_col = (width + pad_l + pad_r - filter_w) / stride_w + 1;
+  const int channels = channel_end - channel_start;
+  col_data += channel_start;
+  im_data += channel_start;
+  int h_pad = -pad_t;
+  for (int h = 0; h < height_col; ++h) {
+    int w_pad = -pad_l;
+    for (int w = 0; w < width_col; ++w) {
+      int32_t* im_patch_data = im_data + (h_pad * width + w_pad) * depth;
+      for (int ih = h_pad; ih < h_pad + filter_h; ++ih) {
+        for (int iw = w_pad; iw < w_pad + filter_w; ++iw) {
+          if (ih >= 0 && ih < height && iw >= 0 && iw < width) {
+            for (int i = 0; i < channels; ++i) {
+              im_patch_data[i] += col_data[i];
+            }
+          }
+          im_patch_data += depth;
+          col_data += depth;
+        }
+        im_patch_data += depth * (width - filter_w);
+      }
+      w_pad += stride_w;
+    }
+    h_pad += stride_h;
+  }
+}
+
+struct Col2imWorkerTask : cpu_backend_threadpool::Task {
+  Col2imWorkerTask(const int32_t* col_data, int depth, int channel_start,
+                   int channel_end, int height, int width, int filter_h,
+                   int filter_w, int pad_t, int pad_l, int pad_b, int pad_r,
+                   int stride_h, int stride_w, int32_t* im_data)
+      : col_data_(col_data),
+        depth_(depth),
+        channel_start_(channel_start),
+        channel_end_(channel_end),
+        height_(height),
+        width_(width),
+        filter_h_(filter_h),
+        filter_w_(filter_w),
+        pad_t_(pad_t),
+        pad_l_(pad_l),
+        pad_b_(pad_b),
+        pad_r_(pad_r),
+        stride_h_(stride_h),
+        stride_w_(stride_w),
+        im_data_(im_data) {}
+
+  void Run() override {
+    Col2imChannels(col_data_, depth_, channel_start_, channel_end_, height_,
+                   width_, filter_h_, filter_w_, pad_t_, pad_l_, pad_b_,
+                   pad_r_, stride_h_, stride_w_, im_data_);
+  }
+
+ private:
+  const int32_t* col_data_;
+  int depth_;
+  int channel_start_;
+  int channel_end_;
+  int height_;
+  int width_;
+  int filter_h_;
+  int filter_w_;
+  int pad_t_;
+  int pad_l_;
+  int pad_b_;
+  int pad_r_;
+  int stride_h_;
+  int stride_w_;
+  int32_t* im_data_;
+};
+
+// Adds the bias to and quantizes `rows` rows of `depth` accumulators.
+template <typename DestinationScalar>
+struct QuantizeWorkerTask : cpu_backend_threadpool::Task {
+  QuantizeWorkerTask(const int32* output_multiplier, const int32* output_shift,
+                     const int32* bias_data, int depth, int rows,
+                     int32 output_offset, int32 output_activation_min,
+                     int32 output_activation_max, int32_t* scratch_data,
+                     DestinationScalar* output_data)
+      : output_multiplier_(output_multiplier),
+        output_shift_(output_shift),
+        bias_data_(bias_data),
+        depth_(depth),
+        rows_(rows),
+        output_offset_(output_offset),
+        output_activation_min_(output_activation_min),
+        output_activation_max_(output_activation_max),
+        scratch_data_(scratch_data),
+        output_data_(output_data) {}
+
+  void Run() override {
+    optimized_ops::BiasAdd(scratch_data_, bias_data_, /*batch_size=*/1, rows_,
+                           /*width=*/1, depth_);
+    optimized_ops::Quantize(output_multiplier_, output_shift_, depth_,
+                            rows_ * depth_, output_offset_,
+                            output_activation_min_, output_activation_max_,
+                            scratch_data_, output_data_);
+  }
+
+ private:
+  const int32* output_multiplier_;
+  const int32* output_shift_;
+  const int32* bias_data_;
+  int depth_;
+  int rows_;
+  int32 output_offset_;
+  int32 output_activation_min_;
+  int32 output_activation_max_;
+  int32_t* scratch_data_;
+  DestinationScalar* output_data_;
+};
+
+}  // namespace transpose_conv
 
 // TransposeConvV2 expect the weights in HWOI order.
 template <typename InputScalar, typename DestinationScalar>
@@ -76,6 +214,15 @@ inline void TransposeConvV2(
   // Since our weight is symmetric quantized, the zp will always be 0.
   lhs_params.zero_point = 0;
 
+  // Col2im is split over the output channels, and the quantization over the
+  // output pixels.
+  const int col2im_thread_count = transpose_conv::HowManyThreads(
+      hwoi_ordered_filter_total_size * input_image_size, output_depth,
+      cpu_backend_context);
+  const int quantize_thread_count = transpose_conv::HowManyThreads(
+      output_offset * batch_size, output_image_size * batch_size,
+      cpu_backend_context);
+
   int32_t* scratch_data_p = scratch_data;
   std::fill_n(scratch_data, output_offset * batch_size, static_cast<int32>(0));
   for (int i = 0; i < batch_size; ++i) {
@@ -95,21 +242,62 @@ inline void TransposeConvV2(
                            input_data + input_offset * i, dst_params,
                            col2im_data, gemm_params, cpu_backend_context);
 
-    optimized_ops::Col2im(
-        col2im_data, output_depth, output_height, output_width, filter_height,
-        filter_width, padding_top, padding_left, padding_bottom, padding_right,
-        stride_height, stride_width, scratch_data_p);
+    if (col2im_thread_count == 1) {
+      optimized_ops::Col2im(col2im_data, output_depth, output_height,
+                            output_width, filter_height, filter_width,
+                            padding_top, padding_left, padding_bottom,
+                            padding_right, stride_height, stride_width,
+                            scratch_data_p);
+    } else {
+      std::vector<transpose_conv::Col2imWorkerTask> tasks;
+      tasks.reserve(col2im_thread_count);
+      int channel_start = 0;
+      for (int t = 0; t < col2im_thread_count; ++t) {
+        const int channel_end =
+            channel_start +
+            (output_depth - channel_start) / (col2im_thread_count - t);
+        tasks.emplace_back(col2im_data, output_depth, channel_start,
+                           channel_end, output_height, output_width,
+                           filter_height, filter_width, padding_top,
+                           padding_left, padding_bottom, padding_right,
+                           stride_height, stride_width, scratch_data_p);
+        channel_start = channel_end;
+      }
+      cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                      cpu_backend_context);
+    }
 
     scratch_data_p += output_offset;
   }
-  scratch_data_p = scratch_data;
-  optimized_ops::BiasAdd(scratch_data_p, bias_data, batch_size, output_height,
-                         output_width, output_depth);
-
-  optimized_ops::Quantize(output_multiplier, output_shift, output_depth,
-                          output_shape.FlatSize(), params.output_offset,
-                          output_activation_min, output_activation_max,
-                          scratch_data, output_data);
+
+  if (quantize_thread_count == 1) {
+    scratch_data_p = scratch_data;
+    optimized_ops::BiasAdd(scratch_data_p, bias_data, batch_size,
+                           output_height, output_width, output_depth);
+
+    optimized_ops::Quantize(output_multiplier, output_shift, output_depth,
+                            output_shape.FlatSize(), params.output_offset,
+                            output_activation_min, output_activation_max,
+                            scratch_data, output_data);
+    return;
+  }
+
+  const int total_rows = output_image_size * batch_size;
+  std::vector<transpose_conv::QuantizeWorkerTask<DestinationScalar>> tasks;
+  tasks.reserve(quantize_thread_count);
+  int row_start = 0;
+  for (int t = 0; t < quantize_thread_count; ++t) {
+    const int row_end =
+        row_start + (total_rows - row_start) / (quantize_thread_count - t);
+    tasks.emplace_back(output_multiplier, output_shift, bias_data,
+                       output_depth, row_end - row_start, params.output_offset,
+                       output_activation_min, output_activation_max,
+                       scratch_data + row_start * output_depth,
+                       output_data + row_start * output_depth);
+    row_start = row_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
 }
 
 }  // namespace optimized_integer_ops
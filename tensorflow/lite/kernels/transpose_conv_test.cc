@@ -1251,6 +1251,65 @@ TEST_P(TransposeConvOpTest, SimpleBiasTestQuantizedPerChannel16x8Bias64) {
   EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 2, 3, 2}));
 }
 
+class LargePerChannelQuantizedTransposeConvOpModel
+    : public PerChannelQuantizedTransposeConvOpModel {
+ public:
+  using PerChannelQuantizedTransposeConvOpModel::
+      PerChannelQuantizedTransposeConvOpModel;
+
+  void SetInput(const std::vector<float>& data) {
+    QuantizeAndPopulate<int8_t>(input_, data);
+  }
+
+  void SetFilter(const std::vector<float>& data) {
+    PerChannelSymmetricQuantizeAndPopulate(filter_, data);
+  }
+
+  std::vector<int8_t> GetOutput() { return ExtractVector<int8_t>(output_); }
+};
+
+// The output is large enough for the optimized kernel to split the Col2im and
+// the quantization across threads.
+TEST_P(TransposeConvOpTest, QuantizedPerChannelMultithreaded) {
+  const std::initializer_list<int8_t> const_filter_data = {
+      -30, 7,   -17, 20,  -4,  -28, 9,   -15, 22,  -2,  -26, 11,  -13, 24, 0,
+      -24, 13,  -11, 26,  2,   -22, 15,  -9,  28,  4,   -20, 17,  -7,  30, 6,
+      -18, 19,  -5,  -29, 8,   -16, 21,  -3,  -27, 10,  -14, 23,  -1,  -25, 12,
+      -12, 25,  1,   -23, 14,  -10, 27,  3,   -21, 16,  -8,  29,  5,   -19, 18,
+      -6,  -30, 7,   -17, 20,  -4,  -28, 9,   -15, 22,  -2,  -26};
+  const std::vector<float> filter_scales = {1, 2, 3, 4, 5, 6, 7, 8};
+  std::vector<float> filter_data;
+  for (int i = 0; i < 8 * 3 * 3; ++i) {
+    filter_data.push_back(const_filter_data.begin()[i] * filter_scales[i / 9]);
+  }
+  std::vector<float> input_data;
+  for (int i = 0; i < 32 * 32; ++i) {
+    input_data.push_back((i * 13) % 31 - 15);
+  }
+
+  std::vector<int8_t> outputs[2];
+  const int num_threads[] = {1, 4};
+  for (int i = 0; i < 2; ++i) {
+    LargePerChannelQuantizedTransposeConvOpModel model(
+        GetRegistration(), {1, 64, 64, 8},
+        {TensorType_INT8, {8, 3, 3, 1}, 0, 0, 0, 0, true, filter_scales,
+         std::vector<int64_t>(8, 0), 0},
+        const_filter_data, {TensorType_INT8, {1, 32, 32, 1}, -16, 16},
+        {TensorType_INT8, {}, -1024, 1024}, Padding_SAME, 2, 2,
+        ActivationFunctionType_NONE, GetTestType(),
+        /* version */ 2);
+    model.SetNumThreads(num_threads[i]);
+    model.SetInput(input_data);
+    if (GetTestType() == TestType::kDynamic) {
+      model.SetFilter(filter_data);
+    }
+    ASSERT_EQ(model.Invoke(), kTfLiteOk);
+    EXPECT_THAT(model.GetOutputShape(), ElementsAreArray({1, 64, 64, 8}));
+    outputs[i] = model.GetOutput();
+  }
+  EXPECT_THAT(outputs[1], ElementsAreArray(outputs[0]));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     TransposeConvOpTest, TransposeConvOpTest,
     ::testing::Combine(
@@ -210,7 +210,8 @@ TfLiteStatus Prepare_impl(TfLiteContext* context, TfLiteNode* node) {
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   Subgraph* this_subgraph = reinterpret_cast<Subgraph*>(context->impl_);
-  if (this_subgraph->ShouldOptimizeMemoryForLargeTensors()) {
+  if (this_subgraph->ShouldOptimizeMemoryForLargeTensors() ||
+      this_subgraph->ShouldPrepareSubgraphsLazily()) {
     OpData* op_data = reinterpret_cast<OpData*>(node->user_data);
     // Call Prepare to ensure input shapes are propagated to the body subgraph.
     op_data->subgraphs_prepared = false;
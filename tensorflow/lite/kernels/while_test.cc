@@ -380,6 +380,39 @@ TEST_F(WhileTest, TestTriangularNumberSequence) {
   }
 }
 
+TEST_F(WhileTest, TestLazySubgraphPreparation) {
+  interpreter_ = std::make_unique<Interpreter>();
+  AddSubgraphs(2);
+  builder_->BuildLessEqualCondSubgraph(interpreter_->subgraph(1), 3);
+  builder_->BuildAccumulateLoopBodySubgraph(interpreter_->subgraph(2));
+  builder_->BuildWhileSubgraph(&interpreter_->primary_subgraph());
+
+  InterpreterOptions options;
+  options.SetLazySubgraphPreparation();
+  ASSERT_EQ(interpreter_->ApplyOptions(&options), kTfLiteOk);
+  ASSERT_EQ(interpreter_->ResizeInputTensor(interpreter_->inputs()[0], {1}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->ResizeInputTensor(interpreter_->inputs()[1], {1}),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[0]), {1});
+  FillIntTensor(interpreter_->tensor(interpreter_->inputs()[1]), {1});
+
+  // The BODY subgraph is not allocated until the WHILE op runs.
+  auto body_subgraph = interpreter_->subgraph(2);
+  TfLiteTensor* body_output =
+      body_subgraph->tensor(body_subgraph->outputs()[1]);
+  EXPECT_EQ(body_output->data.raw, nullptr);
+
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  TfLiteTensor* output1 = interpreter_->tensor(interpreter_->outputs()[0]);
+  CheckIntTensor(output1, {1}, {4});
+  TfLiteTensor* output2 = interpreter_->tensor(interpreter_->outputs()[1]);
+  CheckIntTensor(output2, {1}, {10});
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+  CheckIntTensor(output2, {1}, {10});
+}
+
 TEST_F(WhileTest, TestTriangularNumberSequenceWithShallowCopy) {
   const std::vector<int> expected = {1, 3, 6, 10, 15, 21, 28};
   for (int i = 0; i < expected.size(); ++i) {
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -44,6 +45,14 @@ class MemoryPlanner {
   // Invalidates allocations after the given node execution.
   virtual TfLiteStatus ResetAllocationsAfter(int node) = 0;
 
+  // Declares the intervals [first_node, last_node] of nodes which may be
+  // executed concurrently. The tensors used by any node of an interval must
+  // then stay allocated until the last node of the interval is executed. It
+  // takes effect on the next PlanAllocations(). Planners which never share
+  // memory between tensors can ignore it.
+  virtual void SetConcurrentNodeRanges(
+      const std::vector<std::pair<int, int>>& ranges) {}
+
   // NOTE: The following two methods modify the data pointers for all tensors on
   // the non-persistent arena (inputs, outputs, intermediates). If the user has
   // manually set the pointers for any of these, they would need to be set
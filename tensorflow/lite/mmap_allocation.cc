@@ -131,4 +131,77 @@ bool MMAPAllocation::valid() const { return mmapped_buffer_ != MAP_FAILED; }
 
 bool MMAPAllocation::IsSupported() { return true; }
 
+ExternalWeightsFile::ExternalWeightsFile(const char* filename,
+                                         ErrorReporter* error_reporter)
+    : error_reporter_(error_reporter), fd_(open(filename, O_RDONLY)) {
+  if (fd_ == -1) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Could not open '%s'.", filename);
+    return;
+  }
+  bytes_ = GetFdSizeBytes(fd_);
+}
+
+ExternalWeightsFile::~ExternalWeightsFile() {
+  for (const auto& [range, mapping] : mappings_) {
+    munmap(mapping.mapped_buffer, mapping.mapped_buffer_size);
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+const void* ExternalWeightsFile::Map(size_t offset, size_t length) {
+  if (fd_ < 0 || length == 0 || offset > bytes_ || length > bytes_ - offset) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Asked to map '%zu' bytes at offset '%zu' of a "
+                         "weights file of '%zu' bytes.",
+                         length, offset, bytes_);
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = mappings_.find({offset, length});
+  if (it == mappings_.end()) {
+#ifdef __ANDROID__
+    static int pagesize = getpagesize();
+#else
+    static int pagesize = sysconf(_SC_PAGE_SIZE);
+#endif
+    Mapping mapping;
+    mapping.offset_in_buffer = offset % pagesize;
+    mapping.mapped_buffer_size = length + mapping.offset_in_buffer;
+    mapping.mapped_buffer =
+        mmap(nullptr, mapping.mapped_buffer_size, PROT_READ, MAP_SHARED, fd_,
+             offset - mapping.offset_in_buffer);
+    if (mapping.mapped_buffer == MAP_FAILED) {
+      TF_LITE_REPORT_ERROR(error_reporter_,
+                           "Mmap of '%zu' bytes at offset '%zu' of the "
+                           "weights file failed with error '%d'.",
+                           length, offset, errno);
+      return nullptr;
+    }
+    mapping.reference_count = 0;
+    mapped_bytes_ += mapping.mapped_buffer_size;
+    it = mappings_.emplace(std::make_pair(offset, length), mapping).first;
+  }
+  ++it->second.reference_count;
+  return static_cast<const char*>(it->second.mapped_buffer) +
+         it->second.offset_in_buffer;
+}
+
+void ExternalWeightsFile::Unmap(size_t offset, size_t length) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = mappings_.find({offset, length});
+  if (it == mappings_.end() || --it->second.reference_count > 0) return;
+  munmap(it->second.mapped_buffer, it->second.mapped_buffer_size);
+  mapped_bytes_ -= it->second.mapped_buffer_size;
+  mappings_.erase(it);
+}
+
+size_t ExternalWeightsFile::mapped_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return mapped_bytes_;
+}
+
+bool ExternalWeightsFile::IsSupported() { return true; }
+
 }  // namespace tflite
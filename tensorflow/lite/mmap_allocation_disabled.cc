@@ -47,4 +47,20 @@ bool MMAPAllocation::valid() const { return false; }
 
 bool MMAPAllocation::IsSupported() { return false; }
 
+ExternalWeightsFile::ExternalWeightsFile(const char* filename,
+                                         ErrorReporter* error_reporter)
+    : error_reporter_(error_reporter) {}
+
+ExternalWeightsFile::~ExternalWeightsFile() {}
+
+const void* ExternalWeightsFile::Map(size_t offset, size_t length) {
+  return nullptr;
+}
+
+void ExternalWeightsFile::Unmap(size_t offset, size_t length) {}
+
+size_t ExternalWeightsFile::mapped_bytes() const { return 0; }
+
+bool ExternalWeightsFile::IsSupported() { return false; }
+
 }  // namespace tflite
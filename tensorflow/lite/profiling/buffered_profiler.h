@@ -16,9 +16,11 @@ limitations under the License.
 #define TENSORFLOW_LITE_PROFILING_BUFFERED_PROFILER_H_
 
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/profile_buffer.h"
 
 namespace tflite {
@@ -116,6 +118,18 @@ class BufferedProfiler : public tflite::Profiler {
                      event_metadata2);
   }
 
+  // Counts the hardware performance events of each operator invocation, on the
+  // calling thread, which must be the one invoking the interpreter. Returns
+  // false if counting isn't supported.
+  bool EnableHardwareCounters() {
+    hardware_counters_ = std::make_unique<HardwareCounters>();
+    if (!hardware_counters_->IsSupported()) {
+      hardware_counters_.reset();
+    }
+    buffer_.SetHardwareCounters(hardware_counters_.get());
+    return hardware_counters_ != nullptr;
+  }
+
   void StartProfiling() { buffer_.SetEnabled(true); }
   void StopProfiling() { buffer_.SetEnabled(false); }
   void Reset() { buffer_.Reset(); }
@@ -137,6 +151,7 @@ class BufferedProfiler : public tflite::Profiler {
   ProfileBuffer* GetProfileBuffer() { return &buffer_; }
   ProfileBuffer buffer_;
   const uint64_t supported_event_types_;
+  std::unique_ptr<HardwareCounters> hardware_counters_;
 };
 
 }  // namespace profiling
@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif  // __linux__
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+#ifdef __linux__
+// Opens a counter of the calling thread in the group led by `group_fd`, or as
+// the leader of a new group if it's -1.
+int OpenCounter(uint64_t config, int group_fd) {
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  // The group is enabled once all its counters are opened.
+  attr.disabled = group_fd == -1 ? 1 : 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1, group_fd,
+                 /*flags=*/0);
+}
+#endif  // __linux__
+
+}  // namespace
+
+HardwareCounters::HardwareCounters() {
+#ifdef __linux__
+  group_fd_ = OpenCounter(PERF_COUNT_HW_CPU_CYCLES, -1);
+  if (group_fd_ < 0) return;
+  instructions_fd_ = OpenCounter(PERF_COUNT_HW_INSTRUCTIONS, group_fd_);
+  llc_misses_fd_ = OpenCounter(PERF_COUNT_HW_CACHE_MISSES, group_fd_);
+  ioctl(group_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif  // __linux__
+}
+
+HardwareCounters::~HardwareCounters() {
+#ifdef __linux__
+  if (llc_misses_fd_ >= 0) close(llc_misses_fd_);
+  if (instructions_fd_ >= 0) close(instructions_fd_);
+  if (group_fd_ >= 0) close(group_fd_);
+#endif  // __linux__
+}
+
+HardwareCounterValues HardwareCounters::Read() const {
+  HardwareCounterValues values;
+#ifdef __linux__
+  if (group_fd_ < 0) return values;
+  // The number of counters, followed by their values in the order in which
+  // they were added to the group.
+  uint64_t data[4];
+  const uint64_t num_counters =
+      1 + (instructions_fd_ >= 0 ? 1 : 0) + (llc_misses_fd_ >= 0 ? 1 : 0);
+  const ssize_t size = read(group_fd_, data, sizeof(data));
+  if (size < static_cast<ssize_t>((1 + num_counters) * sizeof(data[0])) ||
+      data[0] != num_counters) {
+    return values;
+  }
+  int index = 1;
+  values.cycles = data[index++];
+  if (instructions_fd_ >= 0) values.instructions = data[index++];
+  if (llc_misses_fd_ >= 0) values.llc_misses = data[index++];
+  values.valid = true;
+#endif  // __linux__
+  return values;
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+#define TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
+
+#include <cstdint>
+
+namespace tflite {
+namespace profiling {
+
+// The values of the hardware performance counters of a thread.
+struct HardwareCounterValues {
+  // The size of the cache lines, to estimate the memory traffic.
+  static constexpr int64_t kCacheLineBytes = 64;
+
+  // Whether the counters were read. The counters which aren't supported by the
+  // CPU are 0.
+  bool valid = false;
+  int64_t cycles = 0;
+  int64_t instructions = 0;
+  // The misses of the last level cache, each of which loads a cache line from
+  // memory.
+  int64_t llc_misses = 0;
+
+  int64_t EstimatedMemoryBytes() const { return llc_misses * kCacheLineBytes; }
+
+  HardwareCounterValues operator+(const HardwareCounterValues& obj) const {
+    HardwareCounterValues res;
+    res.valid = valid && obj.valid;
+    res.cycles = cycles + obj.cycles;
+    res.instructions = instructions + obj.instructions;
+    res.llc_misses = llc_misses + obj.llc_misses;
+    return res;
+  }
+
+  HardwareCounterValues operator-(const HardwareCounterValues& obj) const {
+    HardwareCounterValues res;
+    res.valid = valid && obj.valid;
+    res.cycles = cycles - obj.cycles;
+    res.instructions = instructions - obj.instructions;
+    res.llc_misses = llc_misses - obj.llc_misses;
+    return res;
+  }
+};
+
+// Counts the hardware performance events of the thread which creates it, in
+// user space, using the perf_event interface of Linux and Android. Work done
+// on other threads, e.g. those of the thread pools of the kernels, isn't
+// counted.
+//
+// Counting isn't supported on other platforms, or where perf events aren't
+// allowed, e.g. by /proc/sys/kernel/perf_event_paranoid.
+class HardwareCounters {
+ public:
+  HardwareCounters();
+  ~HardwareCounters();
+
+  HardwareCounters(const HardwareCounters&) = delete;
+  HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+  bool IsSupported() const { return group_fd_ >= 0; }
+
+  // Returns the current values of the counters, which are invalid if counting
+  // isn't supported.
+  HardwareCounterValues Read() const;
+
+ private:
+  // The file descriptor of the cycles counter, which leads the group of
+  // counters, or -1 if it couldn't be opened.
+  int group_fd_ = -1;
+  // The file descriptors of the other counters, or -1 for those which couldn't
+  // be opened.
+  int instructions_fd_ = -1;
+  int llc_misses_fd_ = -1;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_HARDWARE_COUNTERS_H_
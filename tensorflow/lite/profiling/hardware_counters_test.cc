@@ -0,0 +1,70 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/hardware_counters.h"
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+TEST(HardwareCounterValues, AddAndSub) {
+  HardwareCounterValues values1, values2;
+  values1.valid = true;
+  values1.cycles = 500;
+  values1.instructions = 900;
+  values1.llc_misses = 10;
+
+  values2.valid = true;
+  values2.cycles = 200;
+  values2.instructions = 300;
+  values2.llc_misses = 4;
+
+  const auto sum = values1 + values2;
+  EXPECT_TRUE(sum.valid);
+  EXPECT_EQ(700, sum.cycles);
+  EXPECT_EQ(1200, sum.instructions);
+  EXPECT_EQ(14, sum.llc_misses);
+
+  const auto difference = values1 - values2;
+  EXPECT_TRUE(difference.valid);
+  EXPECT_EQ(300, difference.cycles);
+  EXPECT_EQ(600, difference.instructions);
+  EXPECT_EQ(6, difference.llc_misses);
+  EXPECT_EQ(6 * HardwareCounterValues::kCacheLineBytes,
+            difference.EstimatedMemoryBytes());
+
+  EXPECT_FALSE((values1 - HardwareCounterValues()).valid);
+}
+
+TEST(HardwareCounters, Read) {
+  HardwareCounters counters;
+  const HardwareCounterValues begin = counters.Read();
+  EXPECT_EQ(counters.IsSupported(), begin.valid);
+  // Perf events may not be available, e.g. in virtual machines.
+  if (!counters.IsSupported()) return;
+
+  volatile int64_t sum = 0;
+  for (int i = 0; i < 100000; ++i) sum += i;
+  const HardwareCounterValues end = counters.Read();
+  ASSERT_TRUE(end.valid);
+  EXPECT_GT(end.cycles, begin.cycles);
+  EXPECT_GE(end.instructions, begin.instructions);
+  EXPECT_GE(end.llc_misses, begin.llc_misses);
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -43,6 +43,12 @@ uint32_t ProfileBuffer::BeginEvent(const char* tag,
   if (event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
     event_buffer_[index].begin_mem_usage = memory::GetMemoryUsage();
   }
+  // Read the counters last, to leave out the cost of the bookkeeping above.
+  event_buffer_[index].hardware_counters =
+      (hardware_counters_ != nullptr &&
+       event_type == Profiler::EventType::OPERATOR_INVOKE_EVENT)
+          ? hardware_counters_->Read()
+          : HardwareCounterValues();
   current_index_++;
   return index;
 }
@@ -61,6 +67,12 @@ void ProfileBuffer::EndEvent(uint32_t event_handle,
   }
 
   int event_index = event_handle % max_size;
+  if (hardware_counters_ != nullptr &&
+      event_buffer_[event_index].hardware_counters.valid) {
+    event_buffer_[event_index].hardware_counters =
+        hardware_counters_->Read() -
+        event_buffer_[event_index].hardware_counters;
+  }
   event_buffer_[event_index].elapsed_time =
       time::NowMicros() - event_buffer_[event_index].begin_timestamp_us;
   if (event_buffer_[event_index].event_type !=
@@ -105,6 +117,7 @@ void ProfileBuffer::AddEvent(const char* tag,
   event_buffer_[index].extra_event_metadata = event_metadata2;
   event_buffer_[index].begin_timestamp_us = 0;
   event_buffer_[index].elapsed_time = elapsed_time;
+  event_buffer_[index].hardware_counters = HardwareCounterValues();
   current_index_++;
 }
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 #include "tensorflow/lite/profiling/memory_info.h"
 #include "tensorflow/lite/profiling/time.h"
 
@@ -50,6 +51,10 @@ struct ProfileEvent {
   // The memory usage when the event ends.
   memory::MemoryUsage end_mem_usage;
 
+  // The hardware counters of an OPERATOR_INVOKE_EVENT, if the buffer counts
+  // them. Invalid otherwise.
+  HardwareCounterValues hardware_counters;
+
   // The field containing the type of event. This must be one of the event types
   // in EventType.
   EventType event_type;
@@ -83,6 +88,13 @@ class ProfileBuffer {
   // Sets the enabled state of buffer to |enabled|
   void SetEnabled(bool enabled) { enabled_ = enabled; }
 
+  // Sets the hardware counters to read at the beginning and the end of the
+  // OPERATOR_INVOKE_EVENTs, or nullptr to not count them. |counters| is not
+  // owned, and must count the thread adding the events.
+  void SetHardwareCounters(const HardwareCounters* counters) {
+    hardware_counters_ = counters;
+  }
+
   // Sets the end timestamp for event for the handle to current time.
   // If the buffer is disabled or previous event has been overwritten this
   // operation has not effect.
@@ -119,6 +131,7 @@ class ProfileBuffer {
   uint32_t current_index_;
   std::vector<ProfileEvent> event_buffer_;
   const bool allow_dynamic_expansion_;
+  const HardwareCounters* hardware_counters_ = nullptr;
 };
 
 }  // namespace profiling
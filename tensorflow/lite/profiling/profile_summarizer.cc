@@ -139,6 +139,21 @@ void ProfileSummarizer::ProcessProfiles(
 
       stats_calculator->AddNodeStats(node_name_in_stats, type_in_stats,
                                      node_num, node_exec_time, 0 /*memory */);
+
+      if (event->hardware_counters.valid) {
+        auto& op_counters =
+            hardware_counters_map_[subgraph_index][node_name_in_stats];
+        if (op_counters.count == 0) {
+          op_counters.type = type_in_stats;
+          op_counters.run_order = node_num;
+          op_counters.counters = event->hardware_counters;
+        } else {
+          op_counters.counters =
+              op_counters.counters + event->hardware_counters;
+        }
+        ++op_counters.count;
+        op_counters.elapsed_time_us += node_exec_time;
+      }
     } else if (event->event_type ==
                Profiler::EventType::DELEGATE_OPERATOR_INVOKE_EVENT) {
       const std::string node_name(event->tag);
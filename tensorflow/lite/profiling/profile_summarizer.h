@@ -46,7 +46,9 @@ class ProfileSummarizer {
   // summary_formatter_.
   std::string GetOutputString() {
     return summary_formatter_->GetOutputString(stats_calculator_map_,
-                                               *delegate_stats_calculator_);
+                                               *delegate_stats_calculator_) +
+           summary_formatter_->GetHardwareCountersString(
+               hardware_counters_map_);
   }
 
   std::string GetShortSummary() {
@@ -71,6 +73,10 @@ class ProfileSummarizer {
 
   std::unique_ptr<tensorflow::StatsCalculator> delegate_stats_calculator_;
 
+  // Map storing the hardware counters of the operators per subgraph, if the
+  // profile events have them.
+  std::map<uint32_t, OperatorHardwareCountersMap> hardware_counters_map_;
+
   // Summary formatter for customized output formats.
   std::shared_ptr<ProfileSummaryFormatter> summary_formatter_;
 };
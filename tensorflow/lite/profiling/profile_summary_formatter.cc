@@ -15,13 +15,101 @@ limitations under the License.
 
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
 
+#include <algorithm>
+#include <iomanip>
 #include <map>
 #include <memory>
+#include <ostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 namespace tflite {
 namespace profiling {
+namespace {
+
+std::ostream& InitField(std::ostream& stream, int width) {
+  stream << "\t" << std::right << std::setw(width) << std::fixed
+         << std::setprecision(3);
+  return stream;
+}
+
+// Writes the hardware counters of the operators of each subgraph, in their
+// order in a run, as a table or as CSV.
+std::string HardwareCountersReport(
+    const std::map<uint32_t, OperatorHardwareCountersMap>&
+        hardware_counters_map,
+    bool format_as_csv) {
+  if (hardware_counters_map.empty()) return "";
+  std::stringstream stream;
+  stream << "============================== "
+         << "Hardware counters per operator (invoking thread)"
+         << " ==============================" << std::endl;
+  if (format_as_csv) {
+    stream << "subgraph, node type, times called, avg cycles, avg "
+              "instructions, IPC, avg LLC misses, LLC MPKI, est. MB/s, name"
+           << std::endl;
+  } else {
+    InitField(stream, 10) << "[subgraph]";
+    InitField(stream, 40) << "[node type]";
+    InitField(stream, 9) << "[times called]";
+    InitField(stream, 14) << "[avg cycles]";
+    InitField(stream, 14) << "[avg instrs]";
+    InitField(stream, 7) << "[IPC]";
+    InitField(stream, 12) << "[avg LLC misses]";
+    InitField(stream, 10) << "[LLC MPKI]";
+    InitField(stream, 10) << "[est. MB/s]";
+    stream << "\t"
+           << "[Name]" << std::endl;
+  }
+  for (const auto& subgraph_counters : hardware_counters_map) {
+    std::vector<std::pair<std::string, OperatorHardwareCounters>> ops(
+        subgraph_counters.second.begin(), subgraph_counters.second.end());
+    std::sort(ops.begin(), ops.end(), [](const auto& a, const auto& b) {
+      return a.second.run_order < b.second.run_order;
+    });
+    for (const auto& [name, op] : ops) {
+      const HardwareCounterValues& counters = op.counters;
+      const double count = std::max<int64_t>(op.count, 1);
+      const double ipc =
+          counters.cycles > 0
+              ? static_cast<double>(counters.instructions) / counters.cycles
+              : 0.0;
+      // The LLC misses per thousand instructions.
+      const double mpki = counters.instructions > 0
+                              ? 1000.0 * counters.llc_misses /
+                                    counters.instructions
+                              : 0.0;
+      // Bytes per microsecond are MB per second.
+      const double bandwidth_mb_per_s =
+          op.elapsed_time_us > 0
+              ? static_cast<double>(counters.EstimatedMemoryBytes()) /
+                    op.elapsed_time_us
+              : 0.0;
+      if (format_as_csv) {
+        stream << subgraph_counters.first << ", " << op.type << ", "
+               << op.count << ", " << counters.cycles / count << ", "
+               << counters.instructions / count << ", " << ipc << ", "
+               << counters.llc_misses / count << ", " << mpki << ", "
+               << bandwidth_mb_per_s << ", " << name << std::endl;
+      } else {
+        InitField(stream, 10) << subgraph_counters.first;
+        InitField(stream, 40) << op.type;
+        InitField(stream, 9) << op.count;
+        InitField(stream, 14) << counters.cycles / count;
+        InitField(stream, 14) << counters.instructions / count;
+        InitField(stream, 7) << ipc;
+        InitField(stream, 12) << counters.llc_misses / count;
+        InitField(stream, 10) << mpki;
+        InitField(stream, 10) << bandwidth_mb_per_s;
+        stream << "\t" << name << std::endl;
+      }
+    }
+  }
+  return stream.str();
+}
+
+}  // namespace
 
 std::string ProfileSummaryDefaultFormatter::GetOutputString(
     const std::map<uint32_t, std::unique_ptr<tensorflow::StatsCalculator>>&
@@ -88,6 +176,13 @@ ProfileSummaryDefaultFormatter::GetStatSummarizerOptions() const {
   return options;
 }
 
+std::string ProfileSummaryDefaultFormatter::GetHardwareCountersString(
+    const std::map<uint32_t, OperatorHardwareCountersMap>&
+        hardware_counters_map) const {
+  return HardwareCountersReport(hardware_counters_map,
+                                /*format_as_csv=*/false);
+}
+
 tensorflow::StatSummarizerOptions
 ProfileSummaryCSVFormatter::GetStatSummarizerOptions() const {
   auto options = ProfileSummaryDefaultFormatter::GetStatSummarizerOptions();
@@ -95,5 +190,11 @@ ProfileSummaryCSVFormatter::GetStatSummarizerOptions() const {
   return options;
 }
 
+std::string ProfileSummaryCSVFormatter::GetHardwareCountersString(
+    const std::map<uint32_t, OperatorHardwareCountersMap>&
+        hardware_counters_map) const {
+  return HardwareCountersReport(hardware_counters_map, /*format_as_csv=*/true);
+}
+
 }  // namespace profiling
 }  // namespace tflite
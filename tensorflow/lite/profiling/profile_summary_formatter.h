@@ -24,10 +24,25 @@ limitations under the License.
 #include <vector>
 
 #include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/profiling/hardware_counters.h"
 
 namespace tflite {
 namespace profiling {
 
+// The hardware counters of an operator, accumulated over its invocations.
+struct OperatorHardwareCounters {
+  std::string type;
+  // The order of the operator in a run.
+  int64_t run_order = 0;
+  int64_t count = 0;
+  int64_t elapsed_time_us = 0;
+  HardwareCounterValues counters;
+};
+
+// The OperatorHardwareCounters of the operators of a subgraph, by name.
+using OperatorHardwareCountersMap =
+    std::map<std::string, OperatorHardwareCounters>;
+
 // Formats the profile summary in a certain way.
 class ProfileSummaryFormatter {
  public:
@@ -47,6 +62,13 @@ class ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator) const = 0;
   virtual tensorflow::StatSummarizerOptions GetStatSummarizerOptions()
       const = 0;
+  // Returns a string detailing the hardware counters of the operators of each
+  // subgraph, or an empty string if no counters were collected.
+  virtual std::string GetHardwareCountersString(
+      const std::map<uint32_t, OperatorHardwareCountersMap>&
+          hardware_counters_map) const {
+    return "";
+  }
 };
 
 class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
@@ -64,6 +86,9 @@ class ProfileSummaryDefaultFormatter : public ProfileSummaryFormatter {
       const tensorflow::StatsCalculator& delegate_stats_calculator)
       const override;
   tensorflow::StatSummarizerOptions GetStatSummarizerOptions() const override;
+  std::string GetHardwareCountersString(
+      const std::map<uint32_t, OperatorHardwareCountersMap>&
+          hardware_counters_map) const override;
 
  private:
   std::string GenerateReport(
@@ -77,6 +102,9 @@ class ProfileSummaryCSVFormatter : public ProfileSummaryDefaultFormatter {
  public:
   ProfileSummaryCSVFormatter() {}
   tensorflow::StatSummarizerOptions GetStatSummarizerOptions() const override;
+  std::string GetHardwareCountersString(
+      const std::map<uint32_t, OperatorHardwareCountersMap>&
+          hardware_counters_map) const override;
 };
 
 }  // namespace profiling
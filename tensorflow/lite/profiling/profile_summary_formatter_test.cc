@@ -154,6 +154,40 @@ TEST(SummaryWriterTest, DelegationShortSummary) {
   ASSERT_TRUE(absl::StrContains(output, "Delegate internal"));
 }
 
+TEST(SummaryWriterTest, EmptyHardwareCountersString) {
+  ProfileSummaryDefaultFormatter writer;
+  EXPECT_EQ(writer.GetHardwareCountersString(
+                std::map<uint32_t, OperatorHardwareCountersMap>()),
+            "");
+}
+
+TEST(SummaryWriterTest, HardwareCountersString) {
+  std::map<uint32_t, OperatorHardwareCountersMap> hardware_counters_map;
+  OperatorHardwareCounters& op = hardware_counters_map[0]["conv:0"];
+  op.type = "CONV_2D";
+  op.count = 2;
+  op.elapsed_time_us = 100;
+  op.counters.valid = true;
+  op.counters.cycles = 4000;
+  op.counters.instructions = 8000;
+  op.counters.llc_misses = 100;
+
+  ProfileSummaryDefaultFormatter writer;
+  std::string output = writer.GetHardwareCountersString(hardware_counters_map);
+  ASSERT_TRUE(absl::StrContains(output, "Hardware counters per operator"));
+  ASSERT_TRUE(absl::StrContains(output, "[IPC]"));
+  ASSERT_TRUE(absl::StrContains(output, "CONV_2D"));
+  ASSERT_TRUE(absl::StrContains(output, "conv:0"));
+
+  ProfileSummaryCSVFormatter csv_writer;
+  output = csv_writer.GetHardwareCountersString(hardware_counters_map);
+  // 2 calls, 2000 cycles, 4000 instructions, 2 IPC, 50 LLC misses, 12.5 MPKI
+  // and 64 MB/s on average.
+  ASSERT_TRUE(
+      absl::StrContains(output, "0, CONV_2D, 2, 2000, 4000, 2, 50, 12.5, 64, "
+                                "conv:0"));
+}
+
 }  // namespace
 }  // namespace profiling
 }  // namespace tflite
@@ -17,6 +17,7 @@ limitations under the License.
 #include <fstream>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "google/protobuf/text_format.h"
@@ -198,15 +199,13 @@ PyObject* TocoConvert(PyObject* model_flags_proto_txt_raw,
       status = tensorflow::ConvertSavedModelToTFLiteFlatBuffer(
           model_flags, toco_flags, &output_file_contents_txt);
     } else {
-      tensorflow::GraphDef graph_def;
-      if (!graph_def.ParseFromString(input_contents_txt)) {
-        PyErr_SetString(PyExc_ValueError,
-                        "Failed to convert GraphDef to Python String.");
-        return nullptr;
+      // The serialized GraphDef is only needed again for the conversion
+      // summary; release it so that it is not held during the conversion.
+      if (toco_flags.conversion_summary_dir().empty()) {
+        std::string().swap(input_contents_txt);
       }
-
       status = tensorflow::ConvertGraphDefToTFLiteFlatBuffer(
-          model_flags, toco_flags, debug_info, graph_def,
+          model_flags, toco_flags, debug_info, std::move(graph_def),
           &output_file_contents_txt);
       if (!toco_flags.conversion_summary_dir().empty()) {
         PopulateConversionLogHelper(
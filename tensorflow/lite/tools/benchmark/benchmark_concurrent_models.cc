@@ -0,0 +1,389 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_concurrent_models.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <time.h>
+#endif  // __linux__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/memory_usage_monitor.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Exposes the steps of a BenchmarkTfLiteModel run, so that the concurrent run
+// can drive them from its own threads.
+class ConcurrentModel : public BenchmarkTfLiteModel {
+ public:
+  explicit ConcurrentModel(BenchmarkParams params)
+      : BenchmarkTfLiteModel(std::move(params)) {}
+
+  TfLiteStatus Prepare() {
+    TF_LITE_ENSURE_STATUS(ValidateParams());
+    TF_LITE_ENSURE_STATUS(Init());
+    return PrepareInputData();
+  }
+
+  TfLiteStatus Invoke(int64_t* invoke_time_us) {
+    TF_LITE_ENSURE_STATUS(ResetInputsAndOutputs());
+    const int64_t start_us = profiling::time::NowMicros();
+    const TfLiteStatus status = RunImpl();
+    *invoke_time_us = profiling::time::NowMicros() - start_us;
+    return status;
+  }
+};
+
+// Returns the CPU time used by the calling thread, or -1 if it isn't supported.
+int64_t ThreadCpuTimeUs() {
+#ifdef __linux__
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+    return static_cast<int64_t>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+  }
+#endif  // __linux__
+  return -1;
+}
+
+// Returns the CPU time used by the process, or -1 if it isn't supported.
+int64_t ProcessCpuTimeUs() {
+#ifdef __linux__
+  rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0) {
+    return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+            usage.ru_stime.tv_sec) *
+               1000000 +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+  }
+#endif  // __linux__
+  return -1;
+}
+
+// Serves the requests for `model` which arrive in [start_us, end_us) at
+// `arrival_rate` requests per second, one at a time in arrival order. The
+// requests which are still queued at `end_us` are counted but not served.
+TfLiteStatus RunUnderLoad(ConcurrentModel* model, float arrival_rate,
+                          uint32_t seed, int64_t start_us, int64_t end_us,
+                          ConcurrentModelResults* results) {
+  std::mt19937 random_engine(seed);
+  std::exponential_distribution<double> inter_arrival_secs(arrival_rate);
+  const int64_t cpu_start_us = ThreadCpuTimeUs();
+  for (double arrival_us = start_us + inter_arrival_secs(random_engine) * 1e6;
+       arrival_us < end_us;
+       arrival_us += inter_arrival_secs(random_engine) * 1e6) {
+    ++results->num_arrivals;
+    const int64_t now_us = profiling::time::NowMicros();
+    if (now_us >= end_us) continue;
+    if (now_us < arrival_us) {
+      profiling::time::SleepForMicros(
+          static_cast<uint64_t>(std::ceil(arrival_us)) - now_us);
+    }
+    int64_t invoke_time_us = 0;
+    if (model->Invoke(&invoke_time_us) != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to invoke " << results->graph;
+      return kTfLiteError;
+    }
+    results->concurrent_invoke_time_us.UpdateStat(invoke_time_us);
+    results->latencies_us.push_back(
+        static_cast<int64_t>(profiling::time::NowMicros() - arrival_us));
+    ++results->num_completed;
+  }
+  const int64_t cpu_end_us = ThreadCpuTimeUs();
+  if (cpu_start_us >= 0 && cpu_end_us >= 0) {
+    results->invoking_thread_cpu_time_us = cpu_end_us - cpu_start_us;
+  }
+  std::sort(results->latencies_us.begin(), results->latencies_us.end());
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+int64_t ConcurrentModelResults::LatencyPercentileUs(double percentile) const {
+  if (latencies_us.empty()) return -1;
+  // The nearest-rank percentile.
+  const int64_t rank = static_cast<int64_t>(
+      std::ceil(percentile / 100.0 * latencies_us.size()));
+  return latencies_us[std::clamp<int64_t>(rank - 1, 0,
+                                          latencies_us.size() - 1)];
+}
+
+BenchmarkConcurrentModels::BenchmarkConcurrentModels()
+    : params_(DefaultParams()) {
+  model_params_.Merge(BenchmarkTfLiteModel::DefaultParams());
+}
+
+BenchmarkParams BenchmarkConcurrentModels::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("graphs", BenchmarkParam::Create<std::string>(""));
+  params.AddParam("arrival_rates", BenchmarkParam::Create<std::string>("10"));
+  params.AddParam("duration_secs", BenchmarkParam::Create<float>(10.0f));
+  params.AddParam("isolated_runs", BenchmarkParam::Create<int32_t>(10));
+  params.AddParam("arrival_random_seed", BenchmarkParam::Create<int32_t>(0));
+  return params;
+}
+
+std::vector<Flag> BenchmarkConcurrentModels::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "graphs", &params_,
+          "A comma-separated list of the TFLite models to run concurrently."),
+      CreateFlag<std::string>(
+          "arrival_rates", &params_,
+          "A comma-separated list of the request arrival rates of the models, "
+          "in requests per second, or a single rate for all of them."),
+      CreateFlag<float>("duration_secs", &params_,
+                        "The duration of the concurrent run in seconds."),
+      CreateFlag<int32_t>(
+          "isolated_runs", &params_,
+          "The number of runs of each model alone, after a warmup run, to "
+          "measure its invocation time without contention."),
+      CreateFlag<int32_t>("arrival_random_seed", &params_,
+                          "The seed of the random request arrivals."),
+  };
+}
+
+void BenchmarkConcurrentModels::LogParams() {
+  LOG_BENCHMARK_PARAM(std::string, "graphs", "Graphs", /*verbose*/ true);
+  LOG_BENCHMARK_PARAM(std::string, "arrival_rates",
+                      "Arrival rates (requests/s)", /*verbose*/ true);
+  LOG_BENCHMARK_PARAM(float, "duration_secs", "Duration (seconds)",
+                      /*verbose*/ true);
+  LOG_BENCHMARK_PARAM(int32_t, "isolated_runs", "Isolated runs per model",
+                      /*verbose*/ true);
+  LOG_BENCHMARK_PARAM(int32_t, "arrival_random_seed", "Arrival random seed",
+                      /*verbose*/ false);
+  LOG_TOOL_PARAM(model_params_, int32_t, "num_threads",
+                 "Num threads per model", /*verbose*/ true);
+}
+
+TfLiteStatus BenchmarkConcurrentModels::ValidateParams() {
+  graphs_.clear();
+  arrival_rates_.clear();
+  const auto& graphs = params_.Get<std::string>("graphs");
+  if (graphs.empty() || !util::SplitAndParse(graphs, ',', &graphs_)) {
+    TFLITE_LOG(ERROR) << "Please specify the TFLite models to run with "
+                         "--graphs";
+    return kTfLiteError;
+  }
+  const auto& arrival_rates = params_.Get<std::string>("arrival_rates");
+  if (!util::SplitAndParse(arrival_rates, ',', &arrival_rates_) ||
+      (arrival_rates_.size() != 1 &&
+       arrival_rates_.size() != graphs_.size())) {
+    TFLITE_LOG(ERROR) << "Cannot parse --arrival_rates: '" << arrival_rates
+                      << "'. It must have a single rate or one rate per model.";
+    return kTfLiteError;
+  }
+  arrival_rates_.resize(graphs_.size(), arrival_rates_[0]);
+  for (float rate : arrival_rates_) {
+    if (!(rate > 0)) {
+      TFLITE_LOG(ERROR) << "Arrival rates must be positive, but got " << rate;
+      return kTfLiteError;
+    }
+  }
+  if (!(params_.Get<float>("duration_secs") > 0)) {
+    TFLITE_LOG(ERROR) << "--duration_secs must be positive.";
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkConcurrentModels::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkConcurrentModels::Run(int argc, char** argv) {
+  // Parse flags that are supported by this particular binary first.
+  if (TfLiteStatus status = ParseFlags(&argc, argv); status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the flags for concurrent runs: "
+                      << status;
+    return status;
+  }
+
+  // Then parse the flags of the model runs, e.g. --num_threads.
+  BenchmarkTfLiteModel model_flags;
+  model_flags.mutable_params()->Set(model_params_);
+  if (TfLiteStatus status = model_flags.ParseFlags(&argc, argv);
+      status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the flags for model runs: "
+                      << status;
+    return status;
+  }
+  model_params_.Set(*model_flags.mutable_params());
+
+  // Now, the remaining are unrecognized flags and we simply print them out.
+  for (int i = 1; i < argc; ++i) {
+    TFLITE_LOG(WARN) << "WARNING: unrecognized commandline flag: " << argv[i];
+  }
+
+  return Run();
+}
+
+TfLiteStatus BenchmarkConcurrentModels::Run() {
+  TF_LITE_ENSURE_STATUS(ValidateParams());
+  LogParams();
+
+  const int num_models = graphs_.size();
+  results_.clear();
+  results_.resize(num_models);
+  peak_mem_mb_ = profiling::memory::MemoryUsageMonitor::kInvalidMemUsageMB;
+  cpu_utilization_ = -1.0;
+
+  // Initialize the models one at a time, to attribute the memory they use.
+  std::vector<std::unique_ptr<ConcurrentModel>> models;
+  for (int i = 0; i < num_models; ++i) {
+    BenchmarkParams params;
+    params.Merge(model_params_);
+    params.Set<std::string>("graph", graphs_[i]);
+    results_[i].graph = graphs_[i];
+    results_[i].arrival_rate = arrival_rates_[i];
+
+    const auto start_mem_usage = profiling::memory::GetMemoryUsage();
+    models.push_back(std::make_unique<ConcurrentModel>(std::move(params)));
+    if (models.back()->Prepare() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to initialize " << graphs_[i];
+      return kTfLiteError;
+    }
+    results_[i].init_mem_usage =
+        profiling::memory::GetMemoryUsage() - start_mem_usage;
+  }
+
+  // Measure each model alone first, as the baseline of the contention.
+  const int isolated_runs = params_.Get<int32_t>("isolated_runs");
+  for (int i = 0; i < num_models; ++i) {
+    for (int run = -1; run < isolated_runs; ++run) {
+      int64_t invoke_time_us = 0;
+      if (models[i]->Invoke(&invoke_time_us) != kTfLiteOk) {
+        TFLITE_LOG(ERROR) << "Failed to invoke " << graphs_[i];
+        return kTfLiteError;
+      }
+      // The first run is a warmup.
+      if (run >= 0) {
+        results_[i].isolated_invoke_time_us.UpdateStat(invoke_time_us);
+      }
+    }
+  }
+
+  profiling::memory::MemoryUsageMonitor memory_monitor(
+      model_params_.Get<int32_t>("memory_footprint_check_interval_ms"));
+  memory_monitor.Start();
+  const int64_t cpu_start_us = ProcessCpuTimeUs();
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t duration_us =
+      static_cast<int64_t>(params_.Get<float>("duration_secs") * 1e6);
+  const int64_t end_us = start_us + duration_us;
+
+  const uint32_t seed = params_.Get<int32_t>("arrival_random_seed");
+  std::vector<TfLiteStatus> statuses(num_models, kTfLiteOk);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_models; ++i) {
+    threads.emplace_back([&, i]() {
+      statuses[i] = RunUnderLoad(models[i].get(), arrival_rates_[i], seed + i,
+                                 start_us, end_us, &results_[i]);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  const int64_t elapsed_us =
+      std::max<int64_t>(profiling::time::NowMicros() - start_us, duration_us);
+  const int64_t cpu_end_us = ProcessCpuTimeUs();
+  memory_monitor.Stop();
+  peak_mem_mb_ = memory_monitor.GetPeakMemUsageInMB();
+  const unsigned int num_cores = std::thread::hardware_concurrency();
+  if (cpu_start_us >= 0 && cpu_end_us >= 0 && num_cores > 0) {
+    cpu_utilization_ = static_cast<double>(cpu_end_us - cpu_start_us) /
+                       (static_cast<double>(elapsed_us) * num_cores);
+  }
+
+  for (int i = 0; i < num_models; ++i) {
+    if (statuses[i] != kTfLiteOk) return statuses[i];
+    results_[i].throughput = results_[i].num_completed * 1e6 / duration_us;
+  }
+  OutputStats();
+  return kTfLiteOk;
+}
+
+void BenchmarkConcurrentModels::OutputStats() {
+  profiling::memory::MemoryUsage total_init_mem_usage;
+  total_init_mem_usage.mem_footprint_kb = 0;
+  total_init_mem_usage.total_allocated_bytes = 0;
+  total_init_mem_usage.in_use_allocated_bytes = 0;
+  for (int i = 0; i < static_cast<int>(results_.size()); ++i) {
+    const ConcurrentModelResults& results = results_[i];
+    total_init_mem_usage = total_init_mem_usage + results.init_mem_usage;
+    TFLITE_LOG(INFO) << "Model #" << i << ": " << results.graph;
+    TFLITE_LOG(INFO) << "  Offered load: " << results.arrival_rate
+                     << " requests/s, throughput: " << results.throughput
+                     << " requests/s, completed " << results.num_completed
+                     << " of " << results.num_arrivals << " requests.";
+    TFLITE_LOG(INFO) << "  Latency (us): p50="
+                     << results.LatencyPercentileUs(50)
+                     << " p90=" << results.LatencyPercentileUs(90)
+                     << " p99=" << results.LatencyPercentileUs(99)
+                     << " max=" << results.LatencyPercentileUs(100);
+    const double slowdown = results.concurrent_invoke_time_us.avg() /
+                            results.isolated_invoke_time_us.avg();
+    TFLITE_LOG(INFO) << "  Invoke time avg (us): isolated="
+                     << results.isolated_invoke_time_us.avg()
+                     << " concurrent="
+                     << results.concurrent_invoke_time_us.avg()
+                     << " slowdown=" << slowdown << "x";
+    if (results.invoking_thread_cpu_time_us >= 0) {
+      TFLITE_LOG(INFO) << "  Invoking thread CPU time (ms): "
+                       << results.invoking_thread_cpu_time_us / 1e3;
+    }
+    TFLITE_LOG(INFO) << "  Init memory usage: " << results.init_mem_usage;
+  }
+
+  if (cpu_utilization_ >= 0) {
+    TFLITE_LOG(INFO) << "Process CPU utilization: " << cpu_utilization_ * 100
+                     << "% of " << std::thread::hardware_concurrency()
+                     << " cores.";
+  }
+  // The contention for memory: the peak footprint of the models running
+  // together, against the sum of the footprints they took to initialize.
+  TFLITE_LOG(INFO) << "Total init memory usage of the models: "
+                   << total_init_mem_usage;
+  if (peak_mem_mb_ > 0) {
+    TFLITE_LOG(INFO) << "Peak memory footprint of the concurrent run (MB): "
+                     << peak_mem_mb_;
+  }
+}
+
+}  // namespace benchmark
+}  // namespace tflite
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_CONCURRENT_MODELS_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_CONCURRENT_MODELS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/util/stats_calculator.h"
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/memory_usage_monitor.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// The results of one of the models of a concurrent benchmark run.
+struct ConcurrentModelResults {
+  // Returns the given percentile, in [0, 100], of `latencies_us`.
+  int64_t LatencyPercentileUs(double percentile) const;
+
+  std::string graph;
+  // The offered load, in requests per second.
+  float arrival_rate = 0.0f;
+  // The requests which arrived during the run, and those of them which were
+  // completed before its end. The others were still queued.
+  int64_t num_arrivals = 0;
+  int64_t num_completed = 0;
+  // Completed requests per second.
+  double throughput = 0.0;
+  // The time from the arrival to the completion of each completed request, so
+  // including the time it was queued behind earlier requests, sorted.
+  std::vector<int64_t> latencies_us;
+  // The invocation times of the model running alone, before the concurrent
+  // run, and while running concurrently with the other models.
+  tensorflow::Stat<int64_t> isolated_invoke_time_us;
+  tensorflow::Stat<int64_t> concurrent_invoke_time_us;
+  // The CPU time of the thread invoking the model during the concurrent run,
+  // which excludes the interpreter's worker threads, or -1 if it isn't
+  // supported on the platform.
+  int64_t invoking_thread_cpu_time_us = -1;
+  // The memory used by the initialization of the model.
+  profiling::memory::MemoryUsage init_mem_usage;
+};
+
+// Benchmarks several models running concurrently in one process, e.g. to size
+// devices which serve many models at once.
+//
+// Each model runs on its own interpreter, with the parameters given by the
+// BenchmarkTfLiteModel flags (e.g. --num_threads), and is invoked by its own
+// thread. The load is open-loop: the requests for each model arrive as a
+// Poisson process at a fixed rate, and queue up while its interpreter is busy,
+// so that the latencies include the queueing delays caused by contention.
+class BenchmarkConcurrentModels {
+ public:
+  BenchmarkConcurrentModels();
+  virtual ~BenchmarkConcurrentModels() = default;
+
+  TfLiteStatus Run(int argc, char** argv);
+  // Runs with the current parameters.
+  TfLiteStatus Run();
+
+  BenchmarkParams* mutable_params() { return &params_; }
+  // The parameters shared by the models.
+  BenchmarkParams* mutable_model_params() { return &model_params_; }
+
+  // The results of the last run, in the order of --graphs.
+  const std::vector<ConcurrentModelResults>& results() const {
+    return results_;
+  }
+  // The peak memory footprint of the process during the last concurrent run,
+  // or MemoryUsageMonitor::kInvalidMemUsageMB if it isn't available.
+  float peak_mem_mb() const { return peak_mem_mb_; }
+  // The CPU time of the process during the last concurrent run, over its
+  // duration times the number of cores, or -1 if it isn't available.
+  double cpu_utilization() const { return cpu_utilization_; }
+
+ protected:
+  static BenchmarkParams DefaultParams();
+
+  // Unparsable flags will remain in 'argv' in the original order and 'argc'
+  // will be updated accordingly.
+  TfLiteStatus ParseFlags(int* argc, char** argv);
+  virtual std::vector<Flag> GetFlags();
+  virtual void LogParams();
+  TfLiteStatus ValidateParams();
+
+  virtual void OutputStats();
+
+  BenchmarkParams params_;
+  // The BenchmarkTfLiteModel parameters shared by the models, besides "graph".
+  BenchmarkParams model_params_;
+
+  std::vector<std::string> graphs_;
+  std::vector<float> arrival_rates_;
+
+  std::vector<ConcurrentModelResults> results_;
+  float peak_mem_mb_ =
+      profiling::memory::MemoryUsageMonitor::kInvalidMemUsageMB;
+  double cpu_utilization_ = -1.0;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_CONCURRENT_MODELS_H_
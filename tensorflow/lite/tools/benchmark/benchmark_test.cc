@@ -16,6 +16,7 @@ limitations under the License.
 #include <fcntl.h>
 #endif  // !defined(_WIN32)
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/lite/interpreter.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_concurrent_models.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_performance_options.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 #include "tensorflow/lite/tools/command_line_flags.h"
@@ -453,6 +455,47 @@ TEST(BenchmarkTest, RunWithUseCaching) {
   EXPECT_EQ(kTfLiteOk, status);
 }
 
+TEST(BenchmarkTest, RunConcurrentModels) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  ASSERT_THAT(g_int8_model_path, testing::NotNull());
+  BenchmarkConcurrentModels benchmark;
+  ScopedCommandlineArgs scoped_argv(
+      {"--graphs=" + *g_fp32_model_path + "," + *g_int8_model_path,
+       "--arrival_rates=50,20", "--duration_secs=0.5", "--isolated_runs=2",
+       "--num_threads=2"});
+  ASSERT_EQ(kTfLiteOk,
+            benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+
+  const auto& results = benchmark.results();
+  ASSERT_EQ(2, results.size());
+  EXPECT_EQ(*g_fp32_model_path, results[0].graph);
+  EXPECT_EQ(50, results[0].arrival_rate);
+  EXPECT_EQ(20, results[1].arrival_rate);
+  for (const auto& result : results) {
+    EXPECT_EQ(2, result.isolated_invoke_time_us.count());
+    EXPECT_GT(result.num_completed, 0);
+    EXPECT_LE(result.num_completed, result.num_arrivals);
+    EXPECT_EQ(result.num_completed, result.latencies_us.size());
+    EXPECT_EQ(result.num_completed, result.concurrent_invoke_time_us.count());
+    EXPECT_TRUE(std::is_sorted(result.latencies_us.begin(),
+                               result.latencies_us.end()));
+    // A request's latency includes its invocation.
+    EXPECT_GE(result.LatencyPercentileUs(100),
+              result.concurrent_invoke_time_us.max());
+    EXPECT_LE(result.LatencyPercentileUs(50), result.LatencyPercentileUs(99));
+  }
+}
+
+TEST(BenchmarkTest, RunConcurrentModelsWithWrongArrivalRates) {
+  ASSERT_THAT(g_fp32_model_path, testing::NotNull());
+  BenchmarkConcurrentModels benchmark;
+  ScopedCommandlineArgs scoped_argv(
+      {"--graphs=" + *g_fp32_model_path + "," + *g_fp32_model_path,
+       "--arrival_rates=1,2,3"});
+  EXPECT_EQ(kTfLiteError,
+            benchmark.Run(scoped_argv.argc(), scoped_argv.argv()));
+}
+
 class MaxDurationWorksTestListener : public BenchmarkListener {
   void OnBenchmarkEnd(const BenchmarkResults& results) override {
     const int64_t num_actual_runs = results.inference_time_us().count();
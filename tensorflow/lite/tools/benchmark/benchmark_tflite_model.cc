@@ -370,6 +370,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("enable_op_hardware_counters",
+                          BenchmarkParam::Create<bool>(false));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -381,6 +383,10 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(0));
   default_params.AddParam("disable_delegate_clustering",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("delegate_partition_speedup",
+                          BenchmarkParam::Create<float>(0.0f));
+  default_params.AddParam("delegate_partition_transfer_cost",
+                          BenchmarkParam::Create<float>(1.0f));
   default_params.AddParam("output_filepath",
                           BenchmarkParam::Create<std::string>(""));
 
@@ -452,6 +458,10 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<bool>(
+          "enable_op_hardware_counters", &params_,
+          "count cycles, instructions and last level cache misses of each op "
+          "with the perf_event interface when op profiling is enabled"),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -469,6 +479,16 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "Optimize memory usage for large tensors with sacrificing latency."),
       CreateFlag<bool>("disable_delegate_clustering", &params_,
                        "Disable delegate clustering."),
+      CreateFlag<float>(
+          "delegate_partition_speedup", &params_,
+          "If > 0, only delegate the partitions which the delegate partition "
+          "cost model estimates faster than CPU, assuming delegated ops are "
+          "this many times faster than CPU ops."),
+      CreateFlag<float>(
+          "delegate_partition_transfer_cost", &params_,
+          "The cost per byte of moving a tensor between CPU and a delegate "
+          "assumed by the delegate partition cost model, relative to the cost "
+          "per byte of a CPU op."),
       CreateFlag<std::string>(
           "output_filepath", &params_,
           "File path to export outputs layer as binary data."),
@@ -518,6 +538,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(bool, "enable_op_hardware_counters",
+                      "Enable op hardware counters", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -528,6 +550,10 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Optimize memory usage for large tensors", verbose);
   LOG_BENCHMARK_PARAM(bool, "disable_delegate_clustering",
                       "Disable delegate clustering", verbose);
+  LOG_BENCHMARK_PARAM(float, "delegate_partition_speedup",
+                      "Delegate partition cost model speedup", verbose);
+  LOG_BENCHMARK_PARAM(float, "delegate_partition_transfer_cost",
+                      "Delegate partition cost model transfer cost", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_filepath",
                       "File path to export outputs layer to", verbose);
   LOG_BENCHMARK_PARAM(int32_t, "tensor_name_display_length",
@@ -726,6 +752,9 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
       params_.Get<int32_t>("optimize_memory_for_large_tensors"));
   options.SetDisableDelegateClustering(
       params_.Get<bool>("disable_delegate_clustering"));
+  options.SetDelegatePartitionCostModel(
+      params_.Get<float>("delegate_partition_speedup"),
+      params_.Get<float>("delegate_partition_transfer_cost"));
 
   tflite::InterpreterBuilder builder(*model_, *resolver, &options);
   if (builder.SetNumThreads(num_threads) != kTfLiteOk) {
@@ -852,7 +881,10 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
                          << delegate_provider->GetName()
                          << " delegate, and the model graph will be partially"
                          << " executed by the delegate w/ "
-                         << num_delegated_kernels << " delegate kernels.";
+                         << num_delegated_kernels << " delegate kernels and "
+                         << interpreter_->execution_plan().size() -
+                                num_delegated_kernels
+                         << " CPU nodes.";
       } else {
         TFLITE_LOG(INFO)
             << "Though " << delegate_provider->GetName()
@@ -957,7 +989,8 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()),
+      params_.Get<bool>("enable_op_hardware_counters")));
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
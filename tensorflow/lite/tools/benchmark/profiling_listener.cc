@@ -26,7 +26,8 @@ namespace benchmark {
 ProfilingListener::ProfilingListener(
     Interpreter* interpreter, uint32_t max_num_initial_entries,
     bool allow_dynamic_buffer_increase, const std::string& csv_file_path,
-    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter)
+    std::shared_ptr<profiling::ProfileSummaryFormatter> summarizer_formatter,
+    bool enable_hardware_counters)
     : run_summarizer_(summarizer_formatter),
       init_summarizer_(summarizer_formatter),
       csv_file_path_(csv_file_path),
@@ -34,6 +35,11 @@ ProfilingListener::ProfilingListener(
       profiler_(max_num_initial_entries, allow_dynamic_buffer_increase) {
   TFLITE_TOOLS_CHECK(interpreter);
   interpreter_->SetProfiler(&profiler_);
+  if (enable_hardware_counters && !profiler_.EnableHardwareCounters()) {
+    TFLITE_LOG(WARN) << "Hardware counters aren't supported on this platform "
+                        "or aren't allowed, e.g. by "
+                        "/proc/sys/kernel/perf_event_paranoid.";
+  }
 
   // We start profiling here in order to catch events that are recorded during
   // the benchmark run preparation stage where TFLite interpreter is
@@ -75,6 +75,7 @@ See [Importing Data](https://tensorflow.org/guide/datasets) for an overview.
 @@pad_to_cardinality
 @@parallel_interleave
 @@parse_example_dataset
+@@prefetch_embeddings
 @@prefetch_to_device
 @@rejection_resample
 @@sample_from_datasets
@@ -107,6 +108,7 @@ from tensorflow.python.data.experimental.ops.cardinality import INFINITE as INFI
 from tensorflow.python.data.experimental.ops.cardinality import UNKNOWN as UNKNOWN_CARDINALITY
 from tensorflow.python.data.experimental.ops.counter import Counter
 from tensorflow.python.data.experimental.ops.distribute import SHARD_HINT
+from tensorflow.python.data.experimental.ops.embedding_prefetch import prefetch_embeddings
 from tensorflow.python.data.experimental.ops.enumerate_ops import enumerate_dataset
 from tensorflow.python.data.experimental.ops.error_ops import ignore_errors
 from tensorflow.python.data.experimental.ops.from_list import from_list
@@ -0,0 +1,92 @@
+# Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for `tf.data.experimental.prefetch_embeddings()`."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import embedding_prefetch
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import variables
+from tensorflow.python.platform import test
+
+
+prefetch_embeddings = embedding_prefetch.prefetch_embeddings
+
+
+class PrefetchEmbeddingsTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _table(self):
+    table = variables.Variable([[0.0, 0.0], [1.0, 1.0], [2.0, 2.0]])
+    self.evaluate(table.initializer)
+    return table
+
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(max_staleness=[0, 1, 2]),
+      )
+  )
+  def testDenseIds(self, max_staleness):
+    table = self._table()
+    ds = dataset_ops.Dataset.from_tensor_slices({"ids": [[2, 0, 2], [1, 1, 1]]})
+    ds = ds.apply(
+        prefetch_embeddings(table, lambda x: x["ids"], max_staleness)
+    )
+    self.assertDatasetProduces(
+        ds,
+        [
+            (
+                {"ids": [2, 0, 2]},
+                {
+                    "unique_ids": [2, 0],
+                    "rows": [[2.0, 2.0], [0.0, 0.0]],
+                    "indices": [0, 1, 0],
+                },
+            ),
+            (
+                {"ids": [1, 1, 1]},
+                {
+                    "unique_ids": [1],
+                    "rows": [[1.0, 1.0]],
+                    "indices": [0, 0, 0],
+                },
+            ),
+        ],
+    )
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testSparseIds(self):
+    table = self._table()
+    ids = sparse_tensor.SparseTensor(
+        indices=[[0, 0], [0, 2], [1, 1]], values=[1, 2, 1], dense_shape=[2, 3]
+    )
+    ds = dataset_ops.Dataset.from_tensors((ids, 7))
+    ds = ds.apply(prefetch_embeddings(table, lambda x: x[0]))
+    element, embeddings = self.getDatasetOutput(ds)[0]
+    self.assertEqual(element[1], 7)
+    self.assertAllEqual(embeddings["unique_ids"], [1, 2])
+    self.assertAllEqual(embeddings["rows"], [[1.0, 1.0], [2.0, 2.0]])
+    self.assertAllEqual(embeddings["indices"], [0, 1, 0])
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testNegativeStaleness(self):
+    with self.assertRaisesRegex(ValueError, "must be non-negative"):
+      prefetch_embeddings(self._table(), lambda x: x, max_staleness=-1)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -0,0 +1,101 @@
+# Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""The implementation of `tf.data.experimental.prefetch_embeddings`."""
+
+from tensorflow.python.framework import ops
+from tensorflow.python.framework import sparse_tensor
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import embedding_ops
+from tensorflow.python.ops.ragged import ragged_tensor
+from tensorflow.python.util.tf_export import tf_export
+
+
+@tf_export("data.experimental.prefetch_embeddings")
+def prefetch_embeddings(table, ids_fn, max_staleness=1):
+  """Looks up embeddings in the input pipeline, ahead of the training steps.
+
+  Each element `x` of the input dataset is turned into a pair `(x, embeddings)`,
+  where `embeddings` is a dictionary with:
+
+  * `"unique_ids"`: the unique values of `ids_fn(x)`, a 1-D tensor.
+  * `"rows"`: the rows of `table` for `"unique_ids"`.
+  * `"indices"`: a tensor of the shape of the values of `ids_fn(x)`, with the
+    index in `"unique_ids"` of each of its values.
+
+  The lookups of up to `max_staleness` elements are done in the background,
+  while the steps consuming the previous elements run, so a step does not wait
+  for its embeddings. The rows of an element therefore miss the updates to
+  `table` of up to `max_staleness` previous steps; `0` looks them up when the
+  element is requested.
+
+  Since the rows are deduplicated, a step can compute the gradients with
+  respect to `"rows"` and apply them as a sparse update of `table` at
+  `"unique_ids"`:
+
+  ```
+  ds = ds.apply(tf.data.experimental.prefetch_embeddings(
+      table, lambda x: x["ids"], max_staleness=1))
+  for x, embeddings in ds:
+    with tf.GradientTape() as tape:
+      rows = embeddings["rows"]
+      tape.watch(rows)
+      loss = model(x, tf.gather(rows, embeddings["indices"]))
+    grad = tape.gradient(loss, rows)
+    table.scatter_sub(tf.IndexedSlices(
+        learning_rate * grad, embeddings["unique_ids"]))
+  ```
+
+  Args:
+    table: The embedding table: a variable, a list of variables partitioned
+      along the first dimension, or a `ShardedVariable`, as accepted by
+      `tf.nn.embedding_lookup`.
+    ids_fn: A function mapping an element of the dataset to the ids to look up,
+      as a `tf.Tensor`, a `tf.SparseTensor` or a `tf.RaggedTensor`.
+    max_staleness: The number of elements whose embeddings may be looked up
+      before they are consumed.
+
+  Returns:
+    A dataset transformation that can be applied via `Dataset.apply()`.
+  """
+  if max_staleness < 0:
+    raise ValueError(
+        "`max_staleness` must be non-negative, but got "
+        f"{max_staleness}."
+    )
+
+  def lookup(*args):
+    element = args[0] if len(args) == 1 else args
+    ids = ids_fn(element)
+    if isinstance(ids, sparse_tensor.SparseTensor):
+      ids = ids.values
+    elif isinstance(ids, ragged_tensor.RaggedTensor):
+      ids = ids.flat_values
+    ids = ops.convert_to_tensor(ids)
+    unique_ids, indices = array_ops.unique(array_ops.reshape(ids, [-1]))
+    rows = embedding_ops.embedding_lookup_v2(table, unique_ids)
+    indices = array_ops.reshape(indices, array_ops.shape(ids))
+    return element, {
+        "unique_ids": unique_ids,
+        "rows": rows,
+        "indices": indices,
+    }
+
+  def _apply_fn(dataset):
+    dataset = dataset.map(lookup)
+    if max_staleness > 0:
+      dataset = dataset.prefetch(max_staleness)
+    return dataset
+
+  return _apply_fn
@@ -148,6 +148,22 @@ class TFRecordDatasetTest(tf_record_test_base.TFRecordTestBase,
           [self._record(j, i) for i in range(self._num_records)])
     self.assertDatasetProduces(dataset, expected_output=expected_output)
 
+  @combinations.generate(
+      combinations.times(
+          test_base.default_test_combinations(),
+          combinations.combine(
+              buffer_size=[1, 7, 2**20], num_readahead_buffers=[1, 4])))
+  def testReadWithReadahead(self, buffer_size, num_readahead_buffers):
+    dataset = readers.TFRecordDataset(
+        self._filenames,
+        buffer_size=buffer_size,
+        num_readahead_buffers=num_readahead_buffers)
+    expected_output = []
+    for j in range(self._num_files):
+      expected_output.extend(
+          [self._record(j, i) for i in range(self._num_records)])
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
   @combinations.generate(test_base.default_test_combinations())
   def testReadFromDatasetOfFiles(self):
     files = dataset_ops.Dataset.from_tensor_slices(self._filenames)
@@ -22,6 +22,8 @@ from tensorflow.core.protobuf import snapshot_pb2
 from tensorflow.python.data.experimental.service import _pywrap_snapshot_utils
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.data.ops import structured_function
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import tensor_spec
 from tensorflow.python.ops import gen_experimental_dataset_ops as ged_ops
 from tensorflow.python.platform import gfile
 # TODO(b/238903802): Use TypeSpec serialization methods directly.
@@ -69,12 +71,13 @@ def _load(path, element_spec, compression, reader_func):
 
 
 def _load_distributed_snapshot(path, metadata, reader_func):
-  """Loads a distributed snapshot."""
+  """Loads a distributed snapshot.
 
-  chunks_dir = _pywrap_snapshot_utils.TF_DATA_CommittedChunksDirectory(path)
-  chunk_files = [
-      os.path.join(chunks_dir, f) for f in gfile.ListDirectory(chunks_dir)]
-  dataset = dataset_ops.Dataset.from_tensor_slices(chunk_files)
+  The snapshot may still be being written, in which case the dataset reads the
+  chunks committed so far and waits for the remaining ones.
+  """
+
+  dataset = _ListSnapshotChunksDataset(path)
   dataset = dataset.map(
       lambda chunk_file: _SnapshotChunkDataset(  # pylint:disable=g-long-lambda
           chunk_file,
@@ -127,6 +130,24 @@ class _SnapshotChunkDataset(dataset_ops.DatasetSource):
     return self._element_spec
 
 
+class _ListSnapshotChunksDataset(dataset_ops.DatasetSource):
+  """A dataset for listing snapshot chunk files.
+
+  It supports listing partially written snapshots. When a snapshot is being
+  written, it returns the currently available chunk files.
+  """
+
+  def __init__(self, snapshot_path):
+    self._snapshot_path = snapshot_path
+    variant_tensor = ged_ops.list_snapshot_chunks_dataset(
+        snapshot_path, **self._flat_structure)
+    super().__init__(variant_tensor)
+
+  @property
+  def element_spec(self):
+    return tensor_spec.TensorSpec([], dtypes.string)
+
+
 def _validate_snapshot(path, metadata, element_spec, compression):
   """Validates a tf.data distributed snapshot.
 
@@ -152,12 +173,6 @@ def _validate_snapshot(path, metadata, element_spec, compression):
           f"Failed to load tf.data snapshot at {path}. The save job failed to "
           f"write it. Status: {f.read()}")
 
-  done_file = _pywrap_snapshot_utils.TF_DATA_SnapshotDoneFilePath(path)
-  if not gfile.Exists(done_file):
-    raise ValueError(
-        f"Failed to load tf.data snapshot at {path}. The save job has not "
-        "finished writing the snapshot.")
-
   snapshot_element_spec = _parse_element_spec(metadata.element_spec)
   if element_spec and element_spec != snapshot_element_spec:
     raise ValueError(
@@ -229,6 +229,16 @@ class AutotuneOptions(options_lib.OptionsBase):
       docstring="When autotuning is enabled (through `autotune`), determines "
       "the algorithm to use.")
 
+  target_throughput = options_lib.create_option(
+      name="target_throughput",
+      ty=float,
+      docstring="When autotuning is enabled (through `autotune`), determines "
+      "the throughput, in elements per second, that is good enough for the "
+      "consumer of the dataset. Autotuning stops increasing parallelism and "
+      "buffer sizes once it predicts this throughput, leaving the rest of the "
+      "CPU and RAM budgets to other work. If None, autotuning aims for the "
+      "highest throughput the budgets allow.")
+
   def _to_proto(self):
     pb = dataset_options_pb2.AutotuneOptions()
     if self.enabled is not None:
@@ -240,6 +250,8 @@ class AutotuneOptions(options_lib.OptionsBase):
     if self.autotune_algorithm is not None:
       pb.autotune_algorithm = AutotuneAlgorithm._to_proto(  # pylint: disable=protected-access
           self.autotune_algorithm)
+    if self.target_throughput is not None:
+      pb.target_throughput = self.target_throughput
     return pb
 
   def _from_proto(self, pb):
@@ -252,6 +264,8 @@ class AutotuneOptions(options_lib.OptionsBase):
     if pb.WhichOneof("optional_autotune_algorithm") is not None:
       self.autotune_algorithm = AutotuneAlgorithm._from_proto(  # pylint: disable=protected-access
           pb.autotune_algorithm)
+    if pb.WhichOneof("optional_target_throughput") is not None:
+      self.target_throughput = pb.target_throughput
 
   def _set_mutable(self, mutable):
     """Change the mutability value to `mutable` on this options and children."""
@@ -358,6 +372,16 @@ class OptimizationOptions(options_lib.OptionsBase):
       "Whether to fuse map and filter transformations. If None, defaults to "
       "False.")
 
+  map_batch_size = options_lib.create_option(
+      name="map_batch_size",
+      ty=int,
+      docstring=
+      "If greater than 1, stateless parallel map transformations of elements "
+      "with static shapes apply their function to batches of this many "
+      "elements at a time, which amortizes the overhead of each function "
+      "call. This pays off for cheap functions of small elements. If None, "
+      "maps are not batched.")
+
   map_fusion = options_lib.create_option(
       name="map_fusion",
       ty=bool,
@@ -403,6 +427,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       pb.map_and_batch_fusion = self.map_and_batch_fusion
     if self.map_and_filter_fusion is not None:
       pb.map_and_filter_fusion = self.map_and_filter_fusion
+    if self.map_batch_size is not None:
+      pb.map_batch_size = self.map_batch_size
     if self.map_fusion is not None:
       pb.map_fusion = self.map_fusion
     if self.map_parallelization is not None:
@@ -428,6 +454,8 @@ class OptimizationOptions(options_lib.OptionsBase):
       self.map_and_batch_fusion = pb.map_and_batch_fusion
     if pb.WhichOneof("optional_map_and_filter_fusion") is not None:
       self.map_and_filter_fusion = pb.map_and_filter_fusion
+    if pb.WhichOneof("optional_map_batch_size") is not None:
+      self.map_batch_size = pb.map_batch_size
     if pb.WhichOneof("optional_map_fusion") is not None:
       self.map_fusion = pb.map_fusion
     if pb.WhichOneof("optional_map_parallelization") is not None:
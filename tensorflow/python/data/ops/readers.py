@@ -285,7 +285,8 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
                filenames,
                compression_type=None,
                buffer_size=None,
-               name=None):
+               name=None,
+               num_readahead_buffers=None):
     """Creates a `TFRecordDataset`.
 
     Args:
@@ -295,6 +296,9 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
       buffer_size: (Optional.) A `tf.int64` scalar representing the number of
         bytes in the read buffer. 0 means no buffering.
       name: (Optional.) A name for the tf.data operation.
+      num_readahead_buffers: (Optional.) The number of reads of `buffer_size`
+        bytes to keep in flight ahead of the reader. 0 means one read at a
+        time.
     """
     self._filenames = filenames
     self._compression_type = convert.optional_param_to_tensor(
@@ -310,7 +314,8 @@ class _TFRecordDataset(dataset_ops.DatasetSource):
 
     variant_tensor = gen_dataset_ops.tf_record_dataset(
         self._filenames, self._compression_type, self._buffer_size,
-        metadata=self._metadata.SerializeToString())
+        metadata=self._metadata.SerializeToString(),
+        num_readahead_buffers=num_readahead_buffers or 0)
     super(_TFRecordDataset, self).__init__(variant_tensor)
 
   @property
@@ -433,7 +438,8 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
                compression_type=None,
                buffer_size=None,
                num_parallel_reads=None,
-               name=None):
+               name=None,
+               num_readahead_buffers=None):
     """Creates a `TFRecordDataset` to read one or more TFRecord files.
 
     Each element of the dataset will contain a single TFRecord.
@@ -454,6 +460,11 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
         value greater than one to parallelize the I/O. If `None`, files will be
         read sequentially.
       name: (Optional.) A name for the tf.data operation.
+      num_readahead_buffers: (Optional.) A Python integer representing the
+        number of reads of `buffer_size` bytes to keep in flight ahead of each
+        file reader. Overlapping reads lets a single file saturate fast local
+        storage or high-latency remote file systems. If `None` or 0, each file
+        is read one buffer at a time.
 
     Raises:
       TypeError: If any argument does not have the expected type.
@@ -468,7 +479,11 @@ class TFRecordDatasetV2(dataset_ops.DatasetV2):
 
     def creator_fn(filename):
       return _TFRecordDataset(
-          filename, compression_type, buffer_size, name=name)
+          filename,
+          compression_type,
+          buffer_size,
+          name=name,
+          num_readahead_buffers=num_readahead_buffers)
 
     self._impl = _create_dataset_reader(
         creator_fn, filenames, num_parallel_reads, name=name)
@@ -492,9 +507,15 @@ class TFRecordDatasetV1(dataset_ops.DatasetV1Adapter):
                compression_type=None,
                buffer_size=None,
                num_parallel_reads=None,
-               name=None):
+               name=None,
+               num_readahead_buffers=None):
     wrapped = TFRecordDatasetV2(
-        filenames, compression_type, buffer_size, num_parallel_reads, name=name)
+        filenames,
+        compression_type,
+        buffer_size,
+        num_parallel_reads,
+        name=name,
+        num_readahead_buffers=num_readahead_buffers)
     super(TFRecordDatasetV1, self).__init__(wrapped)
 
   __init__.__doc__ = TFRecordDatasetV2.__init__.__doc__
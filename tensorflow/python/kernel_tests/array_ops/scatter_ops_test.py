@@ -353,6 +353,26 @@ class ScatterTest(test.TestCase):
           "ops"):
         self.evaluate(state_ops.scatter_update(v, indices, updates))
 
+  @test_util.run_v1_only("Tests the ref variable kernels")
+  @test_util.run_cuda_only
+  def testDeterministicScatterAdd(self):
+    np.random.seed(8)
+    params = np.random.randn(64, 16).astype(np.float32)
+    indices = np.random.randint(0, 4, size=1000)
+    updates = np.random.randn(1000, 16).astype(np.float32)
+    expected = params.copy()
+    np.add.at(expected, indices, updates)
+    with test_util.deterministic_ops():
+      results = []
+      for _ in range(5):
+        v = ref_variable.RefVariable(params)
+        self.evaluate(v.initializer)
+        results.append(
+            self.evaluate(state_ops.scatter_add(v, indices, updates)))
+      for result in results:
+        self.assertAllEqual(results[0], result)
+      self.assertAllClose(expected, results[0], rtol=1e-4, atol=1e-4)
+
 
 
 
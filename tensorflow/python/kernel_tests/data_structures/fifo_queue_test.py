@@ -1059,6 +1059,56 @@ class FIFOQueueParallelTests(test.TestCase):
       close_op.run()
       dequeue_thread.join()
 
+  def testDequeueWaitsBehindPendingDequeueMany(self):
+    # We need each thread to keep its own device stack or the device scopes
+    # won't be properly nested.
+    ops.get_default_graph().switch_to_thread_local()
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32, ())
+      first_enqueue_op = q.enqueue((10.0,))
+      second_enqueue_op = q.enqueue_many(([20.0, 30.0],))
+      dequeued_many_t = q.dequeue_many(2)
+      dequeued_t = q.dequeue()
+
+      def dequeue_many():
+        self.assertAllEqual([10.0, 20.0], self.evaluate(dequeued_many_t))
+
+      def dequeue():
+        self.assertEqual(30.0, self.evaluate(dequeued_t))
+
+      dequeue_many_thread = self.checkedThread(target=dequeue_many)
+      dequeue_many_thread.start()
+      # The first enqueue should run after the dequeue_many has blocked, and
+      # the dequeue after it took the first element.
+      # TODO(mrry): Figure out how to do this without sleeping.
+      time.sleep(0.1)
+      first_enqueue_op.run()
+      dequeue_thread = self.checkedThread(target=dequeue)
+      dequeue_thread.start()
+      time.sleep(0.1)
+      # The dequeue must not take an element before the pending dequeue_many.
+      second_enqueue_op.run()
+      dequeue_many_thread.join()
+      dequeue_thread.join()
+
+  def testDequeueManyFromClosedQueueWithEnoughElements(self):
+    with self.cached_session() as sess:
+      q = data_flow_ops.FIFOQueue(10, dtypes_lib.float32, ())
+      elems = [10.0, 20.0, 30.0, 40.0, 50.0]
+      enqueue_op = q.enqueue_many((elems,))
+      close_op = q.close()
+      dequeued_t = q.dequeue_many(3)
+      dequeued_up_to_t = q.dequeue_up_to(3)
+
+      enqueue_op.run()
+      close_op.run()
+      self.assertAllEqual(elems[:3], self.evaluate(dequeued_t))
+      # Not enough elements are left, and the queue is unchanged.
+      with self.assertRaisesRegex(errors_impl.OutOfRangeError,
+                                  "is closed and has insufficient"):
+        self.evaluate(dequeued_t)
+      self.assertAllEqual(elems[3:], self.evaluate(dequeued_up_to_t))
+
   def testBlockingDequeueManyButNotAllFromClosedQueue(self):
     # We need each thread to keep its own device stack or the device scopes
     # won't be properly nested.
@@ -1681,6 +1681,30 @@ class DenseHashTableOpTest(test.TestCase):
       result = self.evaluate(output)
       self.assertAllClose([0, -1.5, 3.3, -1.5], result)
 
+  def testLargeLookup(self, is_anonymous):
+    if is_anonymous and not tf2.enabled():
+      self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
+    # Large enough for the lookup to be split across threads.
+    num_keys = 5000
+    keys = np.arange(1, num_keys + 1, dtype=np.int64)
+    table = lookup_ops.DenseHashTable(
+        dtypes.int64,
+        dtypes.int64,
+        default_value=-1,
+        empty_key=0,
+        deleted_key=-2,
+        experimental_is_anonymous=is_anonymous)
+    self.evaluate(table.insert(keys, keys * 10))
+
+    # Half of the looked up keys are missing.
+    lookup_keys = np.arange(1, 2 * num_keys + 1, dtype=np.int64)
+    expected = np.where(lookup_keys <= num_keys, lookup_keys * 10, -1)
+    self.assertAllEqual(expected, self.evaluate(table.lookup(lookup_keys)))
+
+    with self.assertRaisesOpError("empty_key"):
+      self.evaluate(
+          table.lookup(np.append(lookup_keys, np.int64(0)).astype(np.int64)))
+
   def testVectorValues(self, is_anonymous):
     if is_anonymous and not tf2.enabled():
       self.skipTest(SKIP_ANONYMOUS_IN_TF1_REASON)
@@ -4226,6 +4250,77 @@ class MutableHashTableOpTest(test.TestCase):
     self.assertTrue(inferred_shapes[1].is_compatible_with(actual_shapes[1]))
 
 
+class TieredHashTableOfTensorsTest(test.TestCase):
+
+  def _create_table(self, cache_capacity):
+    return gen_lookup_ops.tiered_hash_table_of_tensors(
+        key_dtype=dtypes.int64,
+        value_dtype=dtypes.float32,
+        value_shape=[2],
+        cache_capacity=cache_capacity,
+        storage_directory=self.get_temp_dir())
+
+  def _lookup(self, table, keys):
+    return gen_lookup_ops.lookup_table_find_v2(
+        table, constant_op.constant(keys, dtypes.int64),
+        constant_op.constant([-1.0, -1.0]))
+
+  def testLookupBeyondCacheCapacity(self):
+    table = self._create_table(cache_capacity=3)
+    keys = np.arange(10, dtype=np.int64)
+    values = np.stack([keys, -keys], axis=1).astype(np.float32)
+    self.evaluate(gen_lookup_ops.lookup_table_insert_v2(table, keys, values))
+    self.assertAllEqual(10, self.evaluate(
+        gen_lookup_ops.lookup_table_size_v2(table)))
+
+    # Look up the stored rows repeatedly, in an order that keeps moving rows
+    # between memory and storage.
+    for _ in range(3):
+      self.assertAllClose(
+          values[::-1], self.evaluate(self._lookup(table, keys[::-1])))
+    self.assertAllClose([[4.0, -4.0], [-1.0, -1.0], [4.0, -4.0]],
+                        self.evaluate(self._lookup(table, [4, 20, 4])))
+
+    # Update rows both in memory and in storage.
+    self.evaluate(
+        gen_lookup_ops.lookup_table_insert_v2(
+            table, constant_op.constant([0, 9], dtypes.int64),
+            constant_op.constant([[7.0, 7.0], [8.0, 8.0]])))
+    self.evaluate(
+        gen_lookup_ops.lookup_table_remove_v2(
+            table, constant_op.constant([1, 5, 30], dtypes.int64)))
+    self.assertAllEqual(8, self.evaluate(
+        gen_lookup_ops.lookup_table_size_v2(table)))
+    self.assertAllClose(
+        [[7.0, 7.0], [-1.0, -1.0], [2.0, -2.0], [-1.0, -1.0], [8.0, 8.0]],
+        self.evaluate(self._lookup(table, [0, 1, 2, 5, 9])))
+
+  def testExportImport(self):
+    table = self._create_table(cache_capacity=2)
+    keys = np.arange(6, dtype=np.int64)
+    values = np.stack([keys, keys + 1], axis=1).astype(np.float32)
+    self.evaluate(gen_lookup_ops.lookup_table_insert_v2(table, keys, values))
+
+    exported_keys, exported_values = self.evaluate(
+        gen_lookup_ops.lookup_table_export_v2(
+            table, dtypes.int64, dtypes.float32))
+    order = np.argsort(exported_keys)
+    self.assertAllEqual(keys, exported_keys[order])
+    self.assertAllClose(values, exported_values[order])
+
+    other_table = self._create_table(cache_capacity=4)
+    self.evaluate(
+        gen_lookup_ops.lookup_table_import_v2(other_table, exported_keys,
+                                              exported_values))
+    self.assertAllEqual(6, self.evaluate(
+        gen_lookup_ops.lookup_table_size_v2(other_table)))
+    self.assertAllClose(values, self.evaluate(self._lookup(other_table, keys)))
+
+  def testInvalidCacheCapacity(self):
+    with self.assertRaises((ValueError, errors_impl.InvalidArgumentError)):
+      self.evaluate(self._create_table(cache_capacity=0))
+
+
 class MutableHashTableBenchmark(test.Benchmark):
 
   def _create_table(self):
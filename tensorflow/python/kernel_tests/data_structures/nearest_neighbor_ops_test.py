@@ -0,0 +1,160 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for nearest-neighbor index ops."""
+
+import os
+
+import numpy as np
+
+from tensorflow.python.checkpoint import checkpoint as trackable_checkpoint
+from tensorflow.python.eager import def_function
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import errors
+from tensorflow.python.framework import tensor_spec
+from tensorflow.python.framework import test_util
+from tensorflow.python.ops import nearest_neighbor_ops
+from tensorflow.python.platform import test
+from tensorflow.python.saved_model import load
+from tensorflow.python.saved_model import save
+from tensorflow.python.trackable import autotrackable
+
+
+class NearestNeighborIndexTest(test.TestCase):
+
+  def _vectors(self, n, dim, seed=0):
+    return np.random.RandomState(seed).randn(n, dim).astype(np.float32)
+
+  def _brute_force(self, vectors, queries, k, metric):
+    if metric == "l2":
+      scores = ((queries[:, None, :] - vectors[None, :, :])**2).sum(axis=-1)
+    else:
+      scores = -queries.dot(vectors.T)
+    ids = np.argsort(scores, axis=1, kind="stable")[:, :k]
+    return np.take_along_axis(scores, ids, axis=1), ids
+
+  @test_util.run_in_graph_and_eager_modes
+  def testExactSearch(self):
+    vectors = self._vectors(500, 16)
+    queries = self._vectors(20, 16, seed=1)
+    for metric in ("l2", "inner_product"):
+      index = nearest_neighbor_ops.NearestNeighborIndex(
+          dim=16, num_lists=8, metric=metric)
+      self.evaluate(index.train(vectors))
+      self.evaluate(index.add(np.arange(500), vectors))
+      self.assertEqual(500, self.evaluate(index.size()))
+
+      # Probing all lists is exhaustive.
+      distances, ids = self.evaluate(index.search(queries, k=5, num_probes=8))
+      expected_scores, expected_ids = self._brute_force(
+          vectors, queries, 5, metric)
+      self.assertAllEqual(expected_ids, ids)
+      expected_distances = (
+          expected_scores if metric == "l2" else -expected_scores)
+      self.assertAllClose(expected_distances, distances, rtol=1e-4, atol=1e-4)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testApproximateSearchFindsClusteredNeighbors(self):
+    # Well-separated clusters: the nearest centroid holds the neighbors.
+    centers = self._vectors(4, 8) * 100
+    offsets = self._vectors(400, 8, seed=1)
+    vectors = centers[np.arange(400) % 4] + offsets
+    index = nearest_neighbor_ops.NearestNeighborIndex(dim=8, num_lists=4)
+    self.evaluate(index.train(vectors))
+    self.evaluate(index.add(np.arange(400), vectors))
+
+    _, ids = self.evaluate(index.search(centers, k=10, num_probes=1))
+    _, expected_ids = self._brute_force(vectors, centers, 10, "l2")
+    self.assertAllEqual(expected_ids, ids)
+    self.assertAllEqual(np.tile(np.arange(4)[:, None], [1, 10]), ids % 4)
+
+  @test_util.run_in_graph_and_eager_modes
+  def testSearchPadsMissingNeighbors(self):
+    vectors = self._vectors(4, 3)
+    index = nearest_neighbor_ops.NearestNeighborIndex(dim=3, num_lists=2)
+    self.evaluate(index.train(vectors))
+    self.evaluate(index.add([10, 11, 12, 13], vectors))
+    distances, ids = self.evaluate(
+        index.search(vectors[:1], k=6, num_probes=2))
+    self.assertAllEqual([10, 11, 12, 13], sorted(ids[0, :4]))
+    self.assertEqual(10, ids[0, 0])
+    self.assertAllEqual([-1, -1], ids[0, 4:])
+    self.assertAllEqual([np.inf, np.inf], distances[0, 4:])
+
+  @test_util.run_in_graph_and_eager_modes
+  def testInvalidArguments(self):
+    index = nearest_neighbor_ops.NearestNeighborIndex(dim=3, num_lists=2)
+    with self.assertRaisesOpError("must be trained"):
+      self.evaluate(index.add([0], [[1., 2., 3.]]))
+    with self.assertRaisesOpError("at least num_lists"):
+      self.evaluate(index.train([[1., 2., 3.]]))
+    with self.assertRaises((ValueError, errors.InvalidArgumentError)):
+      self.evaluate(index.train([[1., 2.], [3., 4.]]))
+    with self.assertRaisesOpError("num_probes must be positive"):
+      self.evaluate(index.search([[1., 2., 3.]], k=1, num_probes=0))
+
+    vectors = self._vectors(4, 3)
+    self.evaluate(index.train(vectors))
+    self.evaluate(index.add([0, 1, 2, 3], vectors))
+    with self.assertRaisesOpError("Cannot train"):
+      self.evaluate(index.train(vectors))
+
+  @test_util.run_v2_only
+  def testCheckpoint(self):
+    vectors = self._vectors(100, 4)
+    queries = self._vectors(5, 4, seed=1)
+    index = nearest_neighbor_ops.NearestNeighborIndex(dim=4, num_lists=5)
+    index.train(vectors)
+    index.add(np.arange(100), vectors)
+    expected = index.search(queries, k=3, num_probes=2)
+
+    prefix = os.path.join(self.get_temp_dir(), "ckpt")
+    save_path = trackable_checkpoint.Checkpoint(index=index).save(prefix)
+
+    restored = nearest_neighbor_ops.NearestNeighborIndex(dim=4, num_lists=5)
+    self.assertEqual(0, self.evaluate(restored.size()))
+    trackable_checkpoint.Checkpoint(index=restored).restore(save_path)
+    self.assertEqual(100, self.evaluate(restored.size()))
+    actual = restored.search(queries, k=3, num_probes=2)
+    self.assertAllEqual(expected[1], actual[1])
+    self.assertAllClose(expected[0], actual[0])
+
+  @test_util.run_v2_only
+  def testSavedModel(self):
+    vectors = self._vectors(100, 4)
+    queries = self._vectors(5, 4, seed=1)
+    root = autotrackable.AutoTrackable()
+    root.index = nearest_neighbor_ops.NearestNeighborIndex(
+        dim=4, num_lists=5, metric="inner_product")
+    root.index.train(vectors)
+    root.index.add(np.arange(100), vectors)
+
+    @def_function.function(
+        input_signature=[tensor_spec.TensorSpec([None, 4], dtypes.float32)])
+    def search(queries):
+      return root.index.search(queries, k=3, num_probes=5)
+
+    root.search = search
+    expected = root.search(queries)
+    save_dir = os.path.join(self.get_temp_dir(), "saved_model")
+    save.save(root, save_dir)
+
+    loaded = load.load(save_dir)
+    actual = loaded.search(queries)
+    self.assertAllEqual(expected[1], actual[1])
+    self.assertAllClose(expected[0], actual[0])
+
+
+if __name__ == "__main__":
+  test.main()
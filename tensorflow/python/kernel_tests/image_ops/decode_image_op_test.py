@@ -20,6 +20,9 @@ import numpy as np
 
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import array_ops_stack
+from tensorflow.python.ops import gen_image_ops
 from tensorflow.python.ops import image_ops
 from tensorflow.python.ops import io_ops
 import tensorflow.python.ops.nn_grad  # pylint: disable=unused-import
@@ -113,6 +116,44 @@ class DecodeImageOpTest(test.TestCase):
       with self.assertRaises(errors_impl.InvalidArgumentError):
         self.evaluate(decode)
 
+  def testBatchDecodeAndResizeJpeg(self):
+    paths = [
+        os.path.join(prefix_path, "jpeg", "testdata", "jpeg_merge_test1.jpg"),
+        os.path.join(prefix_path, "jpeg", "testdata", "small.jpg"),
+    ]
+    contents = [io_ops.read_file(path) for path in paths]
+    size = [100, 50]
+    images = gen_image_ops.batch_decode_and_resize_jpeg(
+        array_ops_stack.stack(contents), size, dct_scaling=False)
+    expected = array_ops.concat([
+        gen_image_ops.resize_bilinear(
+            array_ops.expand_dims(image_ops.decode_jpeg(c, channels=3), 0),
+            size,
+            half_pixel_centers=True) for c in contents
+    ], 0)
+    images, expected = self.evaluate([images, expected])
+    self.assertEqual(images.shape, (2, 100, 50, 3))
+    self.assertAllClose(images, expected, rtol=1e-5, atol=1e-3)
+
+  def testBatchDecodeAndResizeJpegDctScaling(self):
+    # The 256x128 image is decoded at a quarter of its size, which is the
+    # output size.
+    path = os.path.join(prefix_path, "jpeg", "testdata", "jpeg_merge_test1.jpg")
+    jpeg0 = io_ops.read_file(path)
+    images = gen_image_ops.batch_decode_and_resize_jpeg(
+        array_ops_stack.stack([jpeg0, jpeg0]), [64, 32], channels=1)
+    expected = image_ops.decode_jpeg(jpeg0, channels=1, ratio=4)
+    images, expected = self.evaluate([images, expected])
+    self.assertEqual(images.shape, (2, 64, 32, 1))
+    self.assertAllEqual(images[0], expected)
+    self.assertAllEqual(images[1], expected)
+
+  def testBatchDecodeAndResizeJpegInvalidBytes(self):
+    with self.assertRaises(errors_impl.InvalidArgumentError):
+      self.evaluate(
+          gen_image_ops.batch_decode_and_resize_jpeg([b"ThisIsNotAnImage!"],
+                                                     [10, 10]))
+
 
 if __name__ == "__main__":
   test.main()
@@ -707,6 +707,22 @@ class CSRSparseMatrixOpsTest(test.TestCase, parameterized.TestCase):
 
     self.assertAllClose(c_t_value, c_dense_t_value, atol=1e-5, rtol=1e-5)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testSparseMatrixMatMulSkewedRows(self):
+    # A few dense rows among many empty or nearly empty ones, times a dense
+    # matrix whose width is not a multiple of the kernel's column blocks.
+    for dtype in [np.float32, np.float64]:
+      a_dense_shape = [3, 200, 150]
+      a_mats = np.zeros(a_dense_shape, dtype=dtype)
+      a_mats[:, ::50, :] = np.random.randn(3, 4, 150)
+      a_mats[:, 1::3, 7] = np.random.randn(3, 67)
+      b_mats = np.random.randn(3, 150, 300).astype(dtype)
+      a_sm = dense_to_csr_sparse_matrix(a_mats)
+      c = sparse_csr_matrix_ops.sparse_matrix_mat_mul(a_sm, b_mats)
+      c_dense = test_util.matmul_without_tf32(a_mats, b_mats)
+      c_value, c_dense_value = self.evaluate((c, c_dense))
+      self.assertAllClose(c_value, c_dense_value, rtol=1e-5, atol=1e-4)
+
   @test_util.run_in_graph_and_eager_modes
   def testSparseMatrixSparseMatMul(self):
     a_indices = np.array([[0, 0], [2, 3]])
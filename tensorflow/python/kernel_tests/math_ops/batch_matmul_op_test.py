@@ -100,6 +100,10 @@ class BatchMatmulOpTest(test.TestCase):
     CompareNonEmpty(self, [7, 2, 3], [7, 3, 5])
     CompareNonEmpty(self, [10, 64, 75], [10, 75, 30])
     CompareNonEmpty(self, [5, 7, 2, 3], [5, 7, 3, 5])
+    # Small matrices with specialized inner and output dimensions.
+    CompareNonEmpty(self, [6, 8, 16], [6, 16, 32])
+    CompareNonEmpty(self, [3, 64, 64], [3, 64, 8])
+    CompareNonEmpty(self, [4, 13, 32], [4, 32, 64])
 
   def _testBroadcasting(self, dtype, adjoint_a, adjoint_b, use_static_shape):
 
@@ -119,6 +123,7 @@ class BatchMatmulOpTest(test.TestCase):
     CompareNonEmpty(self, [2, 3], [5, 2, 3, 5])
     CompareNonEmpty(self, [4, 5, 1, 2, 3], [1, 1, 3, 5])
     CompareNonEmpty(self, [1, 2, 1, 4, 2, 1, 3, 4], [3, 2, 1, 1, 1, 2, 4, 2])
+    CompareNonEmpty(self, [2, 1, 12, 16], [1, 3, 16, 8])
     # need higher tolerance due to larger matrix sizes
     CompareNonEmpty(self, [3, 8, 8, 5, 5], [3, 1, 8, 5, 7], tol=3)
     CompareNonEmpty(self, [3, 8, 8, 5, 5], [3, 8, 1, 5, 7], tol=3)
@@ -312,6 +312,30 @@ class SumReductionTest(BaseReductionTest):
           self.assertAllClose(sum_y, tf_out_sum_y)
           self.assertAllClose(sum_xz, tf_out_sum_xz)
 
+  @test_util.run_deprecated_v1
+  def testOuterAndMiddleAxes(self):
+    # Large enough for inner blocks and chunked partial sums, with inner
+    # dimensions that are not a multiple of the packet size.
+    np.random.seed(7)
+    for dtype in [dtypes.float32, dtypes.float64]:
+      for shape, axes in [((20000, 67), [0]),
+                          ((3, 5000, 17), [1]),
+                          ((4, 3, 2003), [0, 2]),
+                          ((8, 16, 9, 33), [0, 2]),
+                          ((8, 16, 9, 33), [1, 3]),
+                          ((2, 3, 4, 5, 40), [0, 2, 4])]:
+        x = self._makeRandom(shape, dtype)
+        self._compareAll(x, axes)
+
+  @test_util.run_deprecated_v1
+  def testOuterAxesDeterministic(self):
+    x = self._makeRandom((4096, 3, 64), dtypes.float32)
+    with self.session(graph=ops.Graph(), use_gpu=False):
+      y = self._tf_reduce(x, [0], False)
+      first = self.evaluate(y)
+      for _ in range(5):
+        self.assertAllEqual(first, self.evaluate(y))
+
   @test_util.run_deprecated_v1
   def testFloat32BFloat16(self):
     for dtype in [dtypes.float32, dtypes.bfloat16]:
@@ -569,6 +593,14 @@ class MeanReductionTest(BaseReductionTest):
       np_arr = self._makeIncremental((2,) * rank, dtypes.bfloat16)
       self._compareAllAxes(np_arr)
 
+  @test_util.run_deprecated_v1
+  def testOuterAndMiddleAxes(self):
+    for dtype in [dtypes.float32, dtypes.float64]:
+      for shape, axes in [((20000, 67), [0]), ((8, 16, 9, 33), [0, 2]),
+                          ((8, 16, 9, 33), [0, 2, 3])]:
+        x = self._makeRandom(shape, dtype)
+        self._compareAll(x, axes)
+
   @test_util.run_deprecated_v1
   def testFloat64(self):
     for rank in range(1, _MAX_RANK + 1):
@@ -997,6 +1029,13 @@ class MaxReductionTest(test.TestCase):
     self._compareAll(np_arr, [0, 2])
     self._compareAll(np_arr, [0, 1, 2])
 
+  def testFloatReduceOuterAndMiddleAxes(self):
+    np_arr = np.random.randn(8, 16, 9, 33).astype(np.float32)
+    np_arr[1, 2, 3, 4] = np.nan
+    self._compareAll(np_arr, [0, 2])
+    self._compareAll(np_arr, [1, 3])
+    self._compareAll(np.random.randn(20000, 67).astype(np.float64), [0])
+
   def testBfloat16Reduce3D(self):
     # Create a 3D array of floats and reduce across all possible
     # dimensions
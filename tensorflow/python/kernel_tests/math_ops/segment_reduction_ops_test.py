@@ -26,6 +26,7 @@ from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import indexed_slices
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import gradient_checker
 from tensorflow.python.ops import gradient_checker_v2
 from tensorflow.python.ops import gradients
@@ -146,6 +147,40 @@ class SegmentReductionOpTest(SegmentReductionHelper, parameterized.TestCase):
             # and may therefore vary dynamically.
             self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testLargeInputWithGaps(self):
+    # Large enough to be sharded over several threads, with long segments that
+    # span shard boundaries and empty segments in between.
+    np.random.seed(0)
+    num_entries = 200000
+    segment_ids = np.sort(
+        np.random.randint(0, num_entries // 50, size=num_entries) * 3)
+    segment_ids[: num_entries // 4] = segment_ids[0]
+    data = np.random.rand(num_entries, 5).astype(np.float32)
+    num_segments = segment_ids[-1] + 1
+    for np_op, tf_op, initial_value in [
+        (np.add, math_ops.segment_sum, 0),
+        (np.maximum, math_ops.segment_max, np.finfo(np.float32).min),
+        (np.minimum, math_ops.segment_min, np.finfo(np.float32).max),
+    ]:
+      np_ans = np.full((num_segments, 5), initial_value, np.float32)
+      np_op.at(np_ans, segment_ids, data)
+      if tf_op is not math_ops.segment_sum:
+        # Empty segments are 0 rather than the initial value.
+        np_ans[np.setdiff1d(np.arange(num_segments), segment_ids)] = 0
+      with self.cached_session(use_gpu=False):
+        tf_ans = self.evaluate(tf_op(data=data, segment_ids=segment_ids))
+      self.assertAllClose(np_ans, tf_ans, rtol=1e-4)
+
+  @test_util.run_deprecated_v1
+  def testSegmentIdsUnsortedLarge(self):
+    segment_ids = np.arange(100000) // 10
+    segment_ids[60000] = 0
+    data = np.ones([100000, 4], np.float32)
+    with self.cached_session(use_gpu=False):
+      s = math_ops.segment_sum(data=data, segment_ids=segment_ids)
+      with self.assertRaisesOpError("segment ids are not increasing"):
+        self.evaluate(s)
+
   @test_util.run_deprecated_v1
   def testSegmentIdsShape(self):
     shape = [4, 4]
@@ -660,6 +695,36 @@ class SparseSegmentReductionHelper(SegmentReductionHelper):
 
 class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
 
+  def testLargeInput(self):
+    # Large enough to be sharded over several threads.
+    np.random.seed(0)
+    num_indices = 200000
+    data = np.random.rand(1000, 4).astype(np.float32)
+    indices = np.random.randint(0, 1000, size=num_indices)
+    segment_ids = np.sort(np.random.randint(0, num_indices // 20,
+                                            size=num_indices) * 2)
+    num_segments = segment_ids[-1] + 3
+    with self.cached_session(use_gpu=False):
+      for tf_op, dense_op in [
+          (math_ops.sparse_segment_sum, math_ops.segment_sum),
+          (math_ops.sparse_segment_mean, math_ops.segment_mean),
+      ]:
+        expected = self.evaluate(
+            dense_op(data=data[indices], segment_ids=segment_ids))
+        self.assertAllClose(
+            expected,
+            self.evaluate(
+                tf_op(data=data, indices=indices, segment_ids=segment_ids)),
+            rtol=1e-4)
+      with_num_segments = self.evaluate(
+          math_ops.sparse_segment_sum(
+              data=data,
+              indices=indices,
+              segment_ids=segment_ids,
+              num_segments=num_segments))
+      self.assertAllEqual([num_segments, 4], with_num_segments.shape)
+      self.assertAllEqual(np.zeros([2, 4]), with_num_segments[-2:])
+
   def testValues(self):
     dtypes = [
         dtypes_lib.float32,
@@ -1357,6 +1422,76 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
           self.evaluate([s, j])
 
 
+class SparseSegmentWeightedSumTest(test.TestCase, parameterized.TestCase):
+
+  def _reference(self, data, indices, segment_ids, weights, combiner):
+    num_segments = segment_ids[-1] + 1 if len(segment_ids) else 0
+    output = np.zeros((num_segments,) + data.shape[1:], data.dtype)
+    divisors = np.zeros((num_segments,), data.dtype)
+    for index, segment_id, weight in zip(indices, segment_ids, weights):
+      output[segment_id] += weight * data[index]
+      divisors[segment_id] += weight if combiner == "mean" else weight**2
+    if combiner == "sqrtn":
+      divisors = np.sqrt(divisors)
+    if combiner != "sum":
+      for s in range(num_segments):
+        output[s] = output[s] / divisors[s] if divisors[s] else 0
+    return output
+
+  @parameterized.parameters(
+      itertools.product(["sum", "mean", "sqrtn"],
+                        [dtypes_lib.float32, dtypes_lib.float64]))
+  def testValues(self, combiner, dtype):
+    np.random.seed(0)
+    data = np.random.rand(10, 3, 2).astype(dtype.as_numpy_dtype)
+    indices = [8, 3, 0, 9, 3, 5]
+    # Segment 1 is empty, and the weights of segment 3 cancel out.
+    segment_ids = [0, 0, 2, 3, 3, 4]
+    weights = np.array([0.5, 2.0, 1.5, 1.0, -1.0, 3.0],
+                       dtype.as_numpy_dtype)
+    output = gen_math_ops.sparse_segment_weighted_sum(
+        data, indices, segment_ids, weights, combiner=combiner)
+    self.assertAllClose(
+        self._reference(data, indices, segment_ids, weights, combiner),
+        self.evaluate(output))
+
+  @parameterized.parameters(["sum", "mean", "sqrtn"])
+  def testGradient(self, combiner):
+    np.random.seed(0)
+    data = np.random.rand(6, 4)
+    weights = np.random.rand(5) + 0.5
+    indices = [1, 4, 1, 0, 5]
+    segment_ids = [0, 0, 1, 3, 3]
+
+    def f(data, weights):
+      return gen_math_ops.sparse_segment_weighted_sum(
+          data, indices, segment_ids, weights, combiner=combiner)
+
+    theoretical, numerical = gradient_checker_v2.compute_gradient(
+        f, [data, weights])
+    self.assertAllClose(theoretical, numerical)
+
+  def testEmpty(self):
+    output = gen_math_ops.sparse_segment_weighted_sum(
+        np.ones([3, 2], np.float32), np.zeros([0], np.int32),
+        np.zeros([0], np.int32), np.zeros([0], np.float32))
+    self.assertAllEqual(np.zeros([0, 2]), self.evaluate(output))
+
+  def testInvalidInputs(self):
+    data = np.ones([3, 2], np.float32)
+    weights = np.ones([2], np.float32)
+    with self.assertRaisesRegex((ValueError, errors_impl.InvalidArgumentError),
+                                "not in"):
+      self.evaluate(
+          gen_math_ops.sparse_segment_weighted_sum(data, [0, 3], [0, 1],
+                                                   weights))
+    with self.assertRaisesRegex((ValueError, errors_impl.InvalidArgumentError),
+                                "not increasing"):
+      self.evaluate(
+          gen_math_ops.sparse_segment_weighted_sum(data, [0, 1], [1, 0],
+                                                   weights))
+
+
 class SegmentReductionOpBenchmark(test.Benchmark):
   outer_dim_options = [2**x for x in range(9, 14, 2)]
   ratio_options = [2**x for x in range(1, 6, 2)]
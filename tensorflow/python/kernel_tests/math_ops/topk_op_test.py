@@ -216,6 +216,37 @@ class TopKTest(test.TestCase):
     k = constant_op.constant(3)
     self._validateTopK(inputs, k, [19, 18, 17], [11, 3, 7])
 
+  def testTopKLargeRows(self):
+    # Many ties, which must be broken by the lower index.
+    np.random.seed(0)
+    inputs = np.random.randint(0, 1000, size=[3, 100000]).astype(np.int32)
+    for k in [2, 100, 5000]:
+      expected_indices = np.argsort(-inputs, kind="stable")[:, :k]
+      expected_values = np.take_along_axis(inputs, expected_indices, axis=1)
+      self._validateTopK(inputs, k, expected_values, expected_indices)
+
+  def testTopKVeryLongRow(self):
+    # Long enough to be searched in chunks in parallel.
+    np.random.seed(0)
+    inputs = np.random.randint(0, 100000, size=[1, 1 << 20]).astype(np.int32)
+    k = 1000
+    expected_indices = np.argsort(-inputs, kind="stable")[:, :k]
+    expected_values = np.take_along_axis(inputs, expected_indices, axis=1)
+    self._validateTopK(inputs, k, expected_values, expected_indices)
+
+    inputs = np.random.permutation(1 << 20).reshape([1, 1 << 20])
+    expected_indices = np.argsort(-inputs)[:, :k]
+    expected_values = np.take_along_axis(inputs, expected_indices, axis=1)
+    self._validateTopK(
+        inputs, k, expected_values, expected_indices, sorted=False)
+
+  def testTopKLargeRowsWithNaN(self):
+    inputs = np.arange(200000, dtype=np.float32).reshape([2, 100000])
+    inputs[:, 10] = np.nan
+    values, indices = self.evaluate(nn_ops.top_k(inputs, 5))
+    self.assertEqual(values.shape, (2, 5))
+    self.assertAllEqual(inputs[np.arange(2)[:, None], indices], values)
+
   def testTop3ZeroRows(self):
     inputs = np.zeros([0, 10], dtype=np.float32)
     self._validateTopK(inputs, 3, np.zeros([0, 3], dtype=np.float32),
@@ -277,6 +308,26 @@ class TopKBenchmark(test.Benchmark):
                 "Throughput: %0.03g GB/s" % (name, r["wall_time"], throughput))
           sys.stdout.flush()
 
+  def benchmarkTopKLongRows(self):
+    for (m, n, k) in itertools.product(
+        [1, 8],
+        [100000, 1000000, 10000000],
+        [1, 16, 256, 4096]):
+      name = "m_%d_n_%d_k_%d_cpu" % (m, n, k)
+      with ops.Graph().as_default():
+        with ops.device("/cpu:0"):
+          x = random_ops.random_uniform((m, n))
+          v = resource_variable_ops.ResourceVariable(x)
+          op = nn_ops.top_k(v, k)
+        with session.Session() as sess:
+          self.evaluate(v.initializer)
+          r = self.run_op_benchmark(sess, op, min_iters=10, name=name)
+          gb_processed_input = m * n * 4 / 1.0e9
+          throughput = gb_processed_input / r["wall_time"]
+          print("Benchmark: %s \t wall_time: %0.03g s \t "
+                "Throughput: %0.03g GB/s" % (name, r["wall_time"], throughput))
+          sys.stdout.flush()
+
 
 if __name__ == "__main__":
   test.main()
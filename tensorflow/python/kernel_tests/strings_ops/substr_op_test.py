@@ -375,6 +375,24 @@ class SubstrOpTest(test.TestCase, parameterized.TestCase):
       with self.assertRaises(errors_impl.InvalidArgumentError):
         self.evaluate(substr_op)
 
+  @parameterized.parameters(
+      (np.int32, "BYTE"),
+      (np.int64, "BYTE"),
+      (np.int32, "UTF8_CHAR"),
+      (np.int64, "UTF8_CHAR"),
+  )
+  def testOutOfRangeError_ReportsFirstIndex(self, dtype, unit):
+    # Large enough for the elements to be processed in parallel.
+    test_string = [b"good"] * 10000
+    test_string[5000] = b"b"
+    test_string[9000] = b"b"
+    position = np.array(2, dtype)
+    length = np.array(1, dtype)
+    with self.assertRaisesRegex(errors_impl.InvalidArgumentError,
+                                "at index 5000"):
+      self.evaluate(
+          string_ops.substr(test_string, position, length, unit=unit))
+
   @parameterized.parameters(
       (np.int32, "BYTE"),
       (np.int64, "BYTE"),
@@ -28,6 +28,7 @@ from tensorflow.python.ops import clip_ops
 # Imports gradient definitions.
 from tensorflow.python.ops import data_flow_grad  # pylint: disable=unused-import
 from tensorflow.python.ops import data_flow_ops
+from tensorflow.python.ops import gen_math_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import sparse_ops
@@ -1081,6 +1082,18 @@ def embedding_lookup_sparse_impl(
       segment_ids = math_ops.cast(segment_ids, dtypes.int32)
 
     weights = sp_weights.values
+    dtype = embeddings.dtype.base_dtype
+    if dtype in (dtypes.float32, dtypes.float64) and compat.forward_compatible(
+        2023, 12, 13
+    ):
+      # Scale the selected rows and reduce them into segments in one op,
+      # without materializing the gathered rows.
+      if weights.dtype != dtype:
+        weights = math_ops.cast(weights, dtype)
+      return gen_math_ops.sparse_segment_weighted_sum(
+          embeddings, idx, segment_ids, weights, combiner=combiner, name=name
+      )
+
     embeddings = array_ops.gather(embeddings, idx)
 
     original_dtype = embeddings.dtype
@@ -453,6 +453,23 @@ def _SparseSegmentSqrtNWithNumSegmentsGrad(op: ops.Operation, grad):
                                               dim0), None, None, None)
 
 
+@ops.RegisterGradient("SparseSegmentWeightedSum")
+def _SparseSegmentWeightedSumGrad(op: ops.Operation, grad):
+  """Gradient for SparseSegmentWeightedSum."""
+  data, indices, segment_ids, weights = op.inputs
+  data_grad, weights_grad = gen_math_ops.sparse_segment_weighted_sum_grad(
+      grad,
+      data,
+      indices,
+      segment_ids,
+      weights,
+      op.outputs[0],
+      combiner=op.get_attr("combiner"))
+  return (indexed_slices_lib.IndexedSlices(data_grad, indices,
+                                           array_ops.shape(data)), None, None,
+          weights_grad)
+
+
 def _SegmentMinOrMaxGrad(op: ops.Operation, grad):
   """ Gradient for SegmentMin and SegmentMax. """
   zeros = array_ops.zeros_like(op.inputs[0], dtype=op.inputs[0].dtype)
@@ -0,0 +1,167 @@
+# Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Approximate nearest-neighbor search over an in-memory index."""
+
+from tensorflow.python.eager import context
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import gen_lookup_ops
+from tensorflow.python.trackable import resource
+
+
+class NearestNeighborIndex(resource.TrackableResource):
+  """An inverted-file index for approximate nearest-neighbor search.
+
+  The index partitions float vectors of dimension `dim` into `num_lists`
+  inverted lists, one per centroid. A search for a query only scans the lists
+  of its `num_probes` nearest centroids, which trades recall for speed;
+  scanning all lists gives exact results.
+
+  The centroids are computed once with `train`, from a representative sample
+  of the vectors, before vectors are added:
+
+  ```python
+  index = NearestNeighborIndex(dim=64, num_lists=256)
+  index.train(sample_embeddings)
+  index.add(ids, embeddings)
+  distances, neighbor_ids = index.search(queries, k=10, num_probes=8)
+  ```
+
+  The contents of the index are saved in checkpoints and SavedModels.
+  """
+
+  def __init__(self, dim, num_lists, metric="l2", name="NearestNeighborIndex"):
+    """Creates an empty, untrained index.
+
+    Args:
+      dim: The dimension of the indexed vectors.
+      num_lists: The number of centroids, i.e. of inverted lists.
+      metric: `"l2"` to compare vectors by squared L2 distance, or
+        `"inner_product"` to compare them by inner product, where a larger
+        product means a nearer vector.
+      name: A name for the index (optional).
+    """
+    self._dim = dim
+    self._num_lists = num_lists
+    self._metric = metric
+    self._name = name
+    self._shared_name = ""
+    if context.executing_eagerly():
+      # Kernels are cached by attributes when executing eagerly, so each index
+      # needs a unique shared_name to avoid sharing one resource.
+      self._shared_name = "nearest_neighbor_index_%d" % (ops.uid(),)
+    super().__init__()
+    self._resource_handle = self._create_resource()
+
+  def _create_resource(self):
+    return gen_lookup_ops.nearest_neighbor_index(
+        dim=self._dim,
+        num_lists=self._num_lists,
+        metric=self._metric,
+        shared_name=self._shared_name,
+        name=self._name)
+
+  @property
+  def dim(self):
+    return self._dim
+
+  @property
+  def num_lists(self):
+    return self._num_lists
+
+  def train(self, vectors, num_iterations=10, name=None):
+    """Computes the centroids of the empty index by k-means clustering.
+
+    Args:
+      vectors: A `[n, dim]` float tensor with at least `num_lists` rows.
+      num_iterations: The number of k-means iterations.
+      name: A name for the operation (optional).
+
+    Returns:
+      The created Operation.
+    """
+    with ops.name_scope(name, "%s_Train" % self._name,
+                        [self.resource_handle, vectors]):
+      vectors = ops.convert_to_tensor(vectors, dtypes.float32, name="vectors")
+      with ops.colocate_with(self.resource_handle):
+        return gen_lookup_ops.nearest_neighbor_index_train(
+            self.resource_handle, vectors, num_iterations=num_iterations)
+
+  def add(self, ids, vectors, name=None):
+    """Adds `vectors` to the trained index under the matching `ids`.
+
+    Args:
+      ids: A `[n]` int64 tensor.
+      vectors: A `[n, dim]` float tensor.
+      name: A name for the operation (optional).
+
+    Returns:
+      The created Operation.
+    """
+    with ops.name_scope(name, "%s_Add" % self._name,
+                        [self.resource_handle, ids, vectors]):
+      ids = ops.convert_to_tensor(ids, dtypes.int64, name="ids")
+      vectors = ops.convert_to_tensor(vectors, dtypes.float32, name="vectors")
+      with ops.colocate_with(self.resource_handle):
+        return gen_lookup_ops.nearest_neighbor_index_add(
+            self.resource_handle, ids, vectors)
+
+  def search(self, queries, k, num_probes=1, name=None):
+    """Finds the approximate `k` nearest neighbors of each query.
+
+    Args:
+      queries: A `[num_queries, dim]` float tensor.
+      k: The number of neighbors to return for each query.
+      num_probes: The number of inverted lists to scan for each query.
+      name: A name for the operation (optional).
+
+    Returns:
+      A pair of `[num_queries, k]` tensors: the squared L2 distances or inner
+      products of the neighbors, nearest first, and their ids. Queries with
+      fewer than `k` scanned vectors are padded with id -1.
+    """
+    with ops.name_scope(name, "%s_Search" % self._name,
+                        [self.resource_handle, queries]):
+      queries = ops.convert_to_tensor(queries, dtypes.float32, name="queries")
+      with ops.colocate_with(self.resource_handle):
+        return gen_lookup_ops.nearest_neighbor_index_search(
+            self.resource_handle, queries, k, num_probes)
+
+  def size(self, name=None):
+    """Returns the number of vectors in the index."""
+    with ops.name_scope(name, "%s_Size" % self._name, [self.resource_handle]):
+      with ops.colocate_with(self.resource_handle):
+        return gen_lookup_ops.nearest_neighbor_index_size(self.resource_handle)
+
+  def export(self, name=None):
+    """Returns the centroids, and the ids and vectors of the index."""
+    with ops.name_scope(name, "%s_Export" % self._name,
+                        [self.resource_handle]):
+      with ops.colocate_with(self.resource_handle):
+        return gen_lookup_ops.nearest_neighbor_index_export(
+            self.resource_handle)
+
+  def _serialize_to_tensors(self):
+    """Implements checkpointing protocols for `Trackable`."""
+    centroids, ids, vectors = self.export()
+    return {"-centroids": centroids, "-ids": ids, "-vectors": vectors}
+
+  def _restore_from_tensors(self, restored_tensors):
+    """Implements checkpointing protocols for `Trackable`."""
+    with ops.name_scope("%s_Restore" % self._name):
+      with ops.colocate_with(self.resource_handle):
+        return gen_lookup_ops.nearest_neighbor_index_import(
+            self.resource_handle, restored_tensors["-centroids"],
+            restored_tensors["-ids"], restored_tensors["-vectors"])
@@ -0,0 +1,611 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary running the same signature of a SavedModel, on the same inputs,
+// with several runtimes, and reporting their latency, throughput, memory use
+// and numerical differences side by side.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/compare_backends.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/cc/saved_model/reader.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+
+namespace {
+
+class SessionBackend : public Backend {
+ public:
+  SessionBackend(std::unique_ptr<SavedModelBundle> bundle,
+                 const SignatureDef& signature)
+      : bundle_(std::move(bundle)), signature_(signature) {
+    for (const auto& output : signature_.outputs()) {
+      output_names_.push_back(output.first);
+    }
+    std::sort(output_names_.begin(), output_names_.end());
+    for (const string& name : output_names_) {
+      output_tensor_names_.push_back(signature_.outputs().at(name).name());
+    }
+  }
+
+  Status Run(const NamedTensors& inputs, NamedTensors* outputs) override {
+    NamedTensors feeds;
+    feeds.reserve(inputs.size());
+    for (const auto& input : inputs) {
+      const auto it = signature_.inputs().find(input.first);
+      if (it == signature_.inputs().end()) {
+        return errors::InvalidArgument("The signature has no input ",
+                                       input.first);
+      }
+      feeds.emplace_back(it->second.name(), input.second);
+    }
+    std::vector<Tensor> fetched;
+    TF_RETURN_IF_ERROR(
+        bundle_->session->Run(feeds, output_tensor_names_, {}, &fetched));
+    outputs->clear();
+    for (int i = 0; i < fetched.size(); ++i) {
+      outputs->emplace_back(output_names_[i], std::move(fetched[i]));
+    }
+    return OkStatus();
+  }
+
+  // Only the allocations of the CPU devices are tracked, and only once
+  // EnableCPUAllocatorStats() was called.
+  void ResetPeakMemory() override { (void)cpu_allocator()->ClearStats(); }
+
+  int64_t PeakMemoryBytes() override {
+    const auto stats = cpu_allocator()->GetStats();
+    return stats ? stats->peak_bytes_in_use : -1;
+  }
+
+ private:
+  std::unique_ptr<SavedModelBundle> bundle_;
+  const SignatureDef signature_;
+  std::vector<string> output_names_;
+  std::vector<string> output_tensor_names_;
+};
+
+Status GetTfType(TfLiteType type, DataType* dtype) {
+  switch (type) {
+    case kTfLiteFloat32:
+      *dtype = DT_FLOAT;
+      return OkStatus();
+    case kTfLiteFloat64:
+      *dtype = DT_DOUBLE;
+      return OkStatus();
+    case kTfLiteInt32:
+      *dtype = DT_INT32;
+      return OkStatus();
+    case kTfLiteInt64:
+      *dtype = DT_INT64;
+      return OkStatus();
+    case kTfLiteUInt8:
+      *dtype = DT_UINT8;
+      return OkStatus();
+    case kTfLiteInt8:
+      *dtype = DT_INT8;
+      return OkStatus();
+    case kTfLiteBool:
+      *dtype = DT_BOOL;
+      return OkStatus();
+    default:
+      return errors::Unimplemented("Unsupported TFLite tensor type ",
+                                   TfLiteTypeGetName(type));
+  }
+}
+
+class TfLiteBackend : public Backend {
+ public:
+  TfLiteBackend(std::unique_ptr<tflite::FlatBufferModel> model,
+                std::unique_ptr<tflite::Interpreter> interpreter,
+                tflite::SignatureRunner* runner)
+      : model_(std::move(model)),
+        interpreter_(std::move(interpreter)),
+        runner_(runner) {
+    for (const char* name : runner_->output_names()) {
+      output_names_.push_back(name);
+    }
+    std::sort(output_names_.begin(), output_names_.end());
+  }
+
+  Status Run(const NamedTensors& inputs, NamedTensors* outputs) override {
+    // Resizing to the current shape, and allocating the tensors again when no
+    // shape changed, are no-ops.
+    for (const auto& input : inputs) {
+      const std::vector<int> dims(input.second.shape().dim_sizes().begin(),
+                                  input.second.shape().dim_sizes().end());
+      if (runner_->ResizeInputTensor(input.first.c_str(), dims) != kTfLiteOk) {
+        return errors::InvalidArgument("Cannot resize the TFLite input ",
+                                       input.first, " to ",
+                                       input.second.shape().DebugString());
+      }
+    }
+    if (runner_->AllocateTensors() != kTfLiteOk) {
+      return errors::Internal("Cannot allocate the TFLite tensors");
+    }
+    for (const auto& input : inputs) {
+      TfLiteTensor* tensor = runner_->input_tensor(input.first.c_str());
+      DataType dtype;
+      TF_RETURN_IF_ERROR(GetTfType(tensor->type, &dtype));
+      if (dtype != input.second.dtype() ||
+          tensor->bytes != input.second.TotalBytes()) {
+        return errors::InvalidArgument(
+            "The TFLite input ", input.first, " has type ",
+            DataTypeString(dtype), " and ", tensor->bytes,
+            " bytes, but was given ", input.second.DebugString());
+      }
+      std::memcpy(tensor->data.raw, input.second.tensor_data().data(),
+                  tensor->bytes);
+    }
+    if (runner_->Invoke() != kTfLiteOk) {
+      return errors::Internal("Failed to invoke the TFLite signature");
+    }
+    outputs->clear();
+    for (const string& name : output_names_) {
+      const TfLiteTensor* tensor = runner_->output_tensor(name.c_str());
+      DataType dtype;
+      TF_RETURN_IF_ERROR(GetTfType(tensor->type, &dtype));
+      TensorShape shape;
+      for (int i = 0; i < tensor->dims->size; ++i) {
+        TF_RETURN_IF_ERROR(shape.AddDimWithStatus(tensor->dims->data[i]));
+      }
+      Tensor output(dtype, shape);
+      if (output.TotalBytes() != tensor->bytes) {
+        return errors::Internal("The TFLite output ", name, " has ",
+                                tensor->bytes, " bytes, expected ",
+                                output.TotalBytes());
+      }
+      std::memcpy(output.data(), tensor->data.raw, tensor->bytes);
+      outputs->emplace_back(name, std::move(output));
+    }
+    return OkStatus();
+  }
+
+ private:
+  // The interpreter refers to the model, and the runner to the interpreter.
+  std::unique_ptr<tflite::FlatBufferModel> model_;
+  std::unique_ptr<tflite::Interpreter> interpreter_;
+  tflite::SignatureRunner* runner_;
+  std::vector<string> output_names_;
+};
+
+template <typename T, typename Distribution>
+void FillRandom(Distribution distribution, std::mt19937* generator,
+                Tensor* tensor) {
+  auto flat = tensor->flat<T>();
+  for (int64_t i = 0; i < flat.size(); ++i) {
+    flat(i) = static_cast<T>(distribution(*generator));
+  }
+}
+
+template <typename T>
+double MaxAbsDiffOf(const Tensor& a, const Tensor& b) {
+  const auto flat_a = a.flat<T>();
+  const auto flat_b = b.flat<T>();
+  double diff = 0;
+  for (int64_t i = 0; i < flat_a.size(); ++i) {
+    const double element_diff = std::abs(static_cast<double>(flat_a(i)) -
+                                         static_cast<double>(flat_b(i)));
+    // NaNs in either tensor count as an infinite difference.
+    diff = std::isnan(element_diff) ? INFINITY : std::max(diff, element_diff);
+  }
+  return diff;
+}
+
+double Percentile(const std::vector<int64_t>& sorted_values, int percentile) {
+  return sorted_values[(sorted_values.size() - 1) * percentile / 100];
+}
+
+}  // namespace
+
+Status CreateSessionBackend(const string& export_dir,
+                            const std::unordered_set<string>& tags,
+                            const string& signature_key, bool xla_jit,
+                            int num_threads,
+                            std::unique_ptr<Backend>* backend) {
+  SessionOptions options;
+  ConfigProto& config = options.config;
+  if (num_threads > 0) {
+    config.set_intra_op_parallelism_threads(num_threads);
+    config.set_inter_op_parallelism_threads(num_threads);
+  }
+  if (xla_jit) {
+    // Auto-clustering only considers CPU devices when this flag is set. It is
+    // not consulted when the session does not enable the JIT.
+    GetMarkForCompilationPassFlags()->tf_xla_cpu_global_jit = true;
+    config.mutable_graph_options()
+        ->mutable_optimizer_options()
+        ->set_global_jit_level(OptimizerOptions::ON_2);
+  }
+  auto bundle = std::make_unique<SavedModelBundle>();
+  TF_RETURN_IF_ERROR(LoadSavedModel(options, RunOptions(), export_dir, tags,
+                                    bundle.get()));
+  const auto& signatures = bundle->meta_graph_def.signature_def();
+  const auto it = signatures.find(signature_key);
+  if (it == signatures.end()) {
+    return errors::NotFound("The SavedModel at ", export_dir,
+                            " has no signature ", signature_key);
+  }
+  const SignatureDef signature = it->second;
+  *backend = std::make_unique<SessionBackend>(std::move(bundle), signature);
+  return OkStatus();
+}
+
+Status CreateTfLiteBackend(const string& tflite_model,
+                           const string& signature_key, int num_threads,
+                           bool use_xnnpack,
+                           std::unique_ptr<Backend>* backend) {
+  std::unique_ptr<tflite::FlatBufferModel> model =
+      tflite::FlatBufferModel::BuildFromFile(tflite_model.c_str());
+  if (model == nullptr) {
+    return errors::InvalidArgument("Cannot load the TFLite model ",
+                                   tflite_model);
+  }
+  std::unique_ptr<tflite::Interpreter> interpreter;
+  TfLiteStatus status;
+  if (use_xnnpack) {
+    tflite::ops::builtin::BuiltinOpResolver resolver;
+    status = tflite::InterpreterBuilder(*model, resolver)(&interpreter,
+                                                          num_threads);
+  } else {
+    tflite::ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+    status = tflite::InterpreterBuilder(*model, resolver)(&interpreter,
+                                                          num_threads);
+  }
+  if (status != kTfLiteOk || interpreter == nullptr) {
+    return errors::Internal("Cannot create a TFLite interpreter for ",
+                            tflite_model);
+  }
+  tflite::SignatureRunner* runner =
+      interpreter->GetSignatureRunner(signature_key.c_str());
+  if (runner == nullptr) {
+    return errors::NotFound("The TFLite model ", tflite_model,
+                            " has no signature ", signature_key);
+  }
+  *backend = std::make_unique<TfLiteBackend>(
+      std::move(model), std::move(interpreter), runner);
+  return OkStatus();
+}
+
+Status CreateSignatureInputs(const SignatureDef& signature,
+                             int64_t unknown_dim_size, int seed,
+                             NamedTensors* inputs) {
+  std::vector<string> names;
+  for (const auto& input : signature.inputs()) {
+    names.push_back(input.first);
+  }
+  std::sort(names.begin(), names.end());
+
+  std::mt19937 generator(seed);
+  inputs->clear();
+  for (const string& name : names) {
+    const TensorInfo& info = signature.inputs().at(name);
+    if (info.tensor_shape().unknown_rank()) {
+      return errors::InvalidArgument("The input ", name,
+                                     " has an unknown rank");
+    }
+    TensorShape shape;
+    for (const auto& dim : info.tensor_shape().dim()) {
+      TF_RETURN_IF_ERROR(shape.AddDimWithStatus(
+          dim.size() < 0 ? unknown_dim_size : dim.size()));
+    }
+    Tensor tensor(info.dtype(), shape);
+    // Integer inputs are often indices, so they are kept small.
+    std::uniform_real_distribution<double> real_distribution(-1.0, 1.0);
+    std::uniform_int_distribution<int> int_distribution(0, 9);
+    switch (info.dtype()) {
+      case DT_FLOAT:
+        FillRandom<float>(real_distribution, &generator, &tensor);
+        break;
+      case DT_DOUBLE:
+        FillRandom<double>(real_distribution, &generator, &tensor);
+        break;
+      case DT_INT32:
+        FillRandom<int32>(int_distribution, &generator, &tensor);
+        break;
+      case DT_INT64:
+        FillRandom<int64_t>(int_distribution, &generator, &tensor);
+        break;
+      case DT_UINT8:
+        FillRandom<uint8>(int_distribution, &generator, &tensor);
+        break;
+      case DT_INT8:
+        FillRandom<int8>(int_distribution, &generator, &tensor);
+        break;
+      case DT_BOOL:
+        FillRandom<bool>(std::bernoulli_distribution(), &generator, &tensor);
+        break;
+      default:
+        return errors::Unimplemented("The input ", name, " has type ",
+                                     DataTypeString(info.dtype()),
+                                     ", which cannot be generated");
+    }
+    inputs->emplace_back(name, std::move(tensor));
+  }
+  return OkStatus();
+}
+
+Status MaxAbsDiff(const Tensor& a, const Tensor& b, double* diff) {
+  if (a.dtype() != b.dtype() || a.shape() != b.shape()) {
+    return errors::InvalidArgument("Cannot compare ", a.DebugString(), " and ",
+                                   b.DebugString());
+  }
+  switch (a.dtype()) {
+    case DT_FLOAT:
+      *diff = MaxAbsDiffOf<float>(a, b);
+      return OkStatus();
+    case DT_DOUBLE:
+      *diff = MaxAbsDiffOf<double>(a, b);
+      return OkStatus();
+    case DT_INT32:
+      *diff = MaxAbsDiffOf<int32>(a, b);
+      return OkStatus();
+    case DT_INT64:
+      *diff = MaxAbsDiffOf<int64_t>(a, b);
+      return OkStatus();
+    case DT_UINT8:
+      *diff = MaxAbsDiffOf<uint8>(a, b);
+      return OkStatus();
+    case DT_INT8:
+      *diff = MaxAbsDiffOf<int8>(a, b);
+      return OkStatus();
+    case DT_BOOL:
+      *diff = MaxAbsDiffOf<bool>(a, b);
+      return OkStatus();
+    default:
+      return errors::Unimplemented("Cannot compare tensors of type ",
+                                   DataTypeString(a.dtype()));
+  }
+}
+
+Status CompareBackends(
+    const std::vector<std::pair<string, Backend*>>& backends,
+    const NamedTensors& inputs, int warmup_runs, int num_runs,
+    double max_time_s, std::vector<BackendResult>* results) {
+  if (num_runs <= 0 && max_time_s <= 0) {
+    return errors::InvalidArgument(
+        "Either the number of runs or the maximum time must be positive");
+  }
+  Env* env = Env::Default();
+  results->clear();
+  NamedTensors reference_outputs;
+  for (const auto& [name, backend] : backends) {
+    LOG(INFO) << "Running " << name;
+    NamedTensors outputs;
+    for (int i = 0; i < warmup_runs; ++i) {
+      TF_RETURN_IF_ERROR(backend->Run(inputs, &outputs));
+    }
+
+    backend->ResetPeakMemory();
+    std::vector<int64_t> latencies_us;
+    int64_t total_time_us = 0;
+    for (int i = 0; num_runs <= 0 || i < num_runs; ++i) {
+      const uint64_t start_us = env->NowMicros();
+      TF_RETURN_IF_ERROR(backend->Run(inputs, &outputs));
+      const int64_t latency_us = env->NowMicros() - start_us;
+      latencies_us.push_back(latency_us);
+      total_time_us += latency_us;
+      if (max_time_s > 0.0 && total_time_us / 1000000.0 > max_time_s) {
+        break;
+      }
+    }
+
+    BackendResult result;
+    result.name = name;
+    result.num_runs = latencies_us.size();
+    result.mean_latency_us =
+        static_cast<double>(total_time_us) / latencies_us.size();
+    std::sort(latencies_us.begin(), latencies_us.end());
+    result.p50_latency_us = Percentile(latencies_us, 50);
+    result.p99_latency_us = Percentile(latencies_us, 99);
+    if (total_time_us > 0) {
+      result.throughput = latencies_us.size() * 1000000.0 / total_time_us;
+    }
+    result.peak_memory_bytes = backend->PeakMemoryBytes();
+
+    if (results->empty()) {
+      reference_outputs = std::move(outputs);
+    } else {
+      if (outputs.size() != reference_outputs.size()) {
+        return errors::InvalidArgument(name, " has ", outputs.size(),
+                                       " outputs, but ", results->front().name,
+                                       " has ", reference_outputs.size());
+      }
+      for (int i = 0; i < outputs.size(); ++i) {
+        if (outputs[i].first != reference_outputs[i].first) {
+          return errors::InvalidArgument(
+              name, " has an output ", outputs[i].first, " where ",
+              results->front().name, " has ", reference_outputs[i].first);
+        }
+        double diff;
+        const Status status =
+            MaxAbsDiff(outputs[i].second, reference_outputs[i].second, &diff);
+        if (!status.ok()) {
+          return errors::InvalidArgument("The output ", outputs[i].first,
+                                         " of ", name, " differs from ",
+                                         results->front().name, ": ",
+                                         status.message());
+        }
+        result.max_abs_diff = std::max(result.max_abs_diff, diff);
+      }
+    }
+    results->push_back(std::move(result));
+  }
+  return OkStatus();
+}
+
+string FormatResults(const std::vector<BackendResult>& results) {
+  string table =
+      absl::StrFormat("%-10s %8s %12s %12s %12s %10s %14s %14s\n", "backend",
+                      "runs", "mean (us)", "p50 (us)", "p99 (us)", "runs/s",
+                      "peak mem (MB)", "max abs diff");
+  for (const BackendResult& result : results) {
+    const string memory =
+        result.peak_memory_bytes < 0
+            ? "n/a"
+            : absl::StrFormat("%.2f", result.peak_memory_bytes / 1048576.0);
+    absl::StrAppendFormat(
+        &table, "%-10s %8d %12.1f %12.1f %12.1f %10.2f %14s %14.6g\n",
+        result.name, result.num_runs, result.mean_latency_us,
+        result.p50_latency_us, result.p99_latency_us, result.throughput,
+        memory, result.max_abs_diff);
+  }
+  return table;
+}
+
+int CompareBackendsMain(int argc, char** argv) {
+  string saved_model_dir = "";
+  string tags_string = "serve";
+  string signature = "serving_default";
+  string backends_string = "tf,xla";
+  string tflite_model = "";
+  bool tflite_use_xnnpack = true;
+  int num_threads = -1;
+  int64_t unknown_dim_size = 1;
+  int seed = 0;
+  int warmup_runs = 1;
+  int max_num_runs = 100;
+  float max_time = 10.0;
+
+  std::vector<Flag> flag_list = {
+      Flag("saved_model_dir", &saved_model_dir, "SavedModel directory"),
+      Flag("tags", &tags_string, "comma-separated tags of the MetaGraph"),
+      Flag("signature", &signature, "signature to run"),
+      Flag("backends", &backends_string,
+           "comma-separated backends to compare, among tf, xla and tflite; "
+           "the first one is the reference for the numerical differences"),
+      Flag("tflite_model", &tflite_model,
+           "TFLite model converted from the SavedModel, run by the tflite "
+           "backend"),
+      Flag("tflite_use_xnnpack", &tflite_use_xnnpack,
+           "whether to apply the default TFLite delegates"),
+      Flag("num_threads", &num_threads, "number of threads"),
+      Flag("unknown_dim_size", &unknown_dim_size,
+           "size of the unknown dimensions of the inputs"),
+      Flag("seed", &seed, "seed of the random inputs"),
+      Flag("warmup_runs", &warmup_runs, "how many runs to initialize model"),
+      Flag("max_num_runs", &max_num_runs, "number of runs max"),
+      Flag("max_time", &max_time, "length to run max, in seconds"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+
+  if (!parse_result || saved_model_dir.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  const std::vector<string> tag_list = absl::StrSplit(tags_string, ',');
+  const std::unordered_set<string> tags(tag_list.begin(), tag_list.end());
+  MetaGraphDef meta_graph_def;
+  Status s = ReadMetaGraphDefFromSavedModel(saved_model_dir, tags,
+                                            &meta_graph_def);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not read the SavedModel: " << s;
+    return -1;
+  }
+  const auto signature_it = meta_graph_def.signature_def().find(signature);
+  if (signature_it == meta_graph_def.signature_def().end()) {
+    LOG(ERROR) << "The SavedModel has no signature " << signature;
+    return -1;
+  }
+  NamedTensors inputs;
+  s = CreateSignatureInputs(signature_it->second, unknown_dim_size, seed,
+                            &inputs);
+  if (!s.ok()) {
+    LOG(ERROR) << "Could not create the inputs: " << s;
+    return -1;
+  }
+
+  EnableCPUAllocatorStats();
+  std::vector<std::unique_ptr<Backend>> owned_backends;
+  std::vector<std::pair<string, Backend*>> backends;
+  const std::vector<string> backend_names =
+      absl::StrSplit(backends_string, ',', absl::SkipEmpty());
+  for (const string& name : backend_names) {
+    std::unique_ptr<Backend> backend;
+    if (name == "tf" || name == "xla") {
+      s = CreateSessionBackend(saved_model_dir, tags, signature,
+                               /*xla_jit=*/name == "xla", num_threads,
+                               &backend);
+    } else if (name == "tflite") {
+      if (tflite_model.empty()) {
+        LOG(ERROR) << "The tflite backend needs --tflite_model";
+        return -1;
+      }
+      s = CreateTfLiteBackend(tflite_model, signature, num_threads,
+                              tflite_use_xnnpack, &backend);
+    } else {
+      s = errors::InvalidArgument("Unknown backend ", name);
+    }
+    if (!s.ok()) {
+      LOG(ERROR) << "Could not create the " << name << " backend: " << s;
+      return -1;
+    }
+    backends.emplace_back(name, backend.get());
+    owned_backends.push_back(std::move(backend));
+  }
+
+  std::vector<BackendResult> results;
+  s = CompareBackends(backends, inputs, warmup_runs, max_num_runs, max_time,
+                      &results);
+  if (!s.ok()) {
+    LOG(ERROR) << "Comparison failed: " << s;
+    return -1;
+  }
+  LOG(INFO) << "\n" << FormatResults(results);
+  return 0;
+}
+
+}  // namespace benchmark_model
+}  // namespace tensorflow
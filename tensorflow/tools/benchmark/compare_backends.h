@@ -0,0 +1,103 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_COMPARE_BACKENDS_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_COMPARE_BACKENDS_H_
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+
+// Tensors keyed by the input or output names of a signature.
+using NamedTensors = std::vector<std::pair<string, Tensor>>;
+
+// A runtime able to run one signature of a model.
+class Backend {
+ public:
+  virtual ~Backend() = default;
+
+  // Runs the signature on `inputs`, and returns all its outputs sorted by name.
+  virtual Status Run(const NamedTensors& inputs, NamedTensors* outputs) = 0;
+
+  // Resets the peak memory reported by PeakMemoryBytes().
+  virtual void ResetPeakMemory() {}
+
+  // Returns the peak number of bytes allocated since the last call to
+  // ResetPeakMemory(), or -1 if the backend does not track it.
+  virtual int64_t PeakMemoryBytes() { return -1; }
+};
+
+// Loads the SavedModel at `export_dir` into a session running the signature
+// `signature_key`, with XLA auto-clustering enabled if `xla_jit` is set.
+Status CreateSessionBackend(const string& export_dir,
+                            const std::unordered_set<string>& tags,
+                            const string& signature_key, bool xla_jit,
+                            int num_threads, std::unique_ptr<Backend>* backend);
+
+// Loads the TFLite model at `tflite_model`, converted from the same
+// SavedModel, to run its signature `signature_key`. If `use_xnnpack` is false,
+// the default delegates are not applied.
+Status CreateTfLiteBackend(const string& tflite_model,
+                           const string& signature_key, int num_threads,
+                           bool use_xnnpack, std::unique_ptr<Backend>* backend);
+
+// Creates deterministic inputs for `signature`, with the unknown dimensions of
+// their shapes set to `unknown_dim_size`.
+Status CreateSignatureInputs(const SignatureDef& signature,
+                             int64_t unknown_dim_size, int seed,
+                             NamedTensors* inputs);
+
+// Returns in `diff` the largest absolute difference between the elements of
+// `a` and `b`, which must have the same type and shape.
+Status MaxAbsDiff(const Tensor& a, const Tensor& b, double* diff);
+
+struct BackendResult {
+  string name;
+  int64_t num_runs = 0;
+  double mean_latency_us = 0;
+  double p50_latency_us = 0;
+  double p99_latency_us = 0;
+  double throughput = 0;  // Runs per second.
+  int64_t peak_memory_bytes = -1;
+  // The largest difference with the outputs of the first backend.
+  double max_abs_diff = 0;
+};
+
+// Runs `inputs` on each backend `warmup_runs` times, then `num_runs` times, or
+// until `max_time_s` seconds have passed if it is positive.
+Status CompareBackends(
+    const std::vector<std::pair<string, Backend*>>& backends,
+    const NamedTensors& inputs, int warmup_runs, int num_runs,
+    double max_time_s, std::vector<BackendResult>* results);
+
+// Formats `results` as a table, one backend per row.
+string FormatResults(const std::vector<BackendResult>& results);
+
+// Handles all setup and argument parsing.
+int CompareBackendsMain(int argc, char** argv);
+
+}  // namespace benchmark_model
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_COMPARE_BACKENDS_H_
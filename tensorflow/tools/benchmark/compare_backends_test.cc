@@ -0,0 +1,130 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/compare_backends.h"
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace benchmark_model {
+namespace {
+
+// Returns its inputs, scaled by `scale`, as outputs.
+class ScalingBackend : public Backend {
+ public:
+  explicit ScalingBackend(float scale) : scale_(scale) {}
+
+  Status Run(const NamedTensors& inputs, NamedTensors* outputs) override {
+    outputs->clear();
+    for (const auto& input : inputs) {
+      Tensor output(DT_FLOAT, input.second.shape());
+      output.flat<float>() = input.second.flat<float>() * scale_;
+      outputs->emplace_back(input.first, output);
+    }
+    return OkStatus();
+  }
+
+ private:
+  const float scale_;
+};
+
+TEST(CompareBackendsTest, CreateSignatureInputs) {
+  SignatureDef signature;
+  TensorInfo& x = (*signature.mutable_inputs())["x"];
+  x.set_dtype(DT_FLOAT);
+  x.mutable_tensor_shape()->add_dim()->set_size(-1);
+  x.mutable_tensor_shape()->add_dim()->set_size(3);
+  TensorInfo& ids = (*signature.mutable_inputs())["ids"];
+  ids.set_dtype(DT_INT64);
+  ids.mutable_tensor_shape()->add_dim()->set_size(5);
+
+  NamedTensors inputs;
+  TF_ASSERT_OK(CreateSignatureInputs(signature, /*unknown_dim_size=*/4,
+                                     /*seed=*/0, &inputs));
+  ASSERT_EQ(inputs.size(), 2);
+  EXPECT_EQ(inputs[0].first, "ids");
+  EXPECT_EQ(inputs[0].second.shape(), TensorShape({5}));
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_GE(inputs[0].second.vec<int64_t>()(i), 0);
+    EXPECT_LT(inputs[0].second.vec<int64_t>()(i), 10);
+  }
+  EXPECT_EQ(inputs[1].first, "x");
+  EXPECT_EQ(inputs[1].second.shape(), TensorShape({4, 3}));
+
+  // The same seed gives the same inputs.
+  NamedTensors other_inputs;
+  TF_ASSERT_OK(CreateSignatureInputs(signature, /*unknown_dim_size=*/4,
+                                     /*seed=*/0, &other_inputs));
+  test::ExpectTensorEqual<int64_t>(inputs[0].second, other_inputs[0].second);
+  test::ExpectTensorEqual<float>(inputs[1].second, other_inputs[1].second);
+
+  (*signature.mutable_inputs())["s"].set_dtype(DT_STRING);
+  EXPECT_EQ(CreateSignatureInputs(signature, 4, 0, &inputs).code(),
+            absl::StatusCode::kUnimplemented);
+}
+
+TEST(CompareBackendsTest, MaxAbsDiff) {
+  double diff;
+  TF_ASSERT_OK(MaxAbsDiff(test::AsTensor<float>({1, 2, 3}),
+                          test::AsTensor<float>({1, 2.5, 2}), &diff));
+  EXPECT_EQ(diff, 1.0);
+  TF_ASSERT_OK(MaxAbsDiff(test::AsTensor<float>({1, NAN}),
+                          test::AsTensor<float>({1, 2}), &diff));
+  EXPECT_EQ(diff, INFINITY);
+  EXPECT_FALSE(MaxAbsDiff(test::AsTensor<float>({1, 2}),
+                          test::AsTensor<float>({1, 2, 3}), &diff)
+                   .ok());
+  EXPECT_FALSE(MaxAbsDiff(test::AsTensor<float>({1}),
+                          test::AsTensor<int32>({1}), &diff)
+                   .ok());
+}
+
+TEST(CompareBackendsTest, CompareBackends) {
+  ScalingBackend reference(1.0f);
+  ScalingBackend other(2.0f);
+  const NamedTensors inputs = {{"x", test::AsTensor<float>({1, -3})}};
+
+  std::vector<BackendResult> results;
+  TF_ASSERT_OK(CompareBackends({{"reference", &reference}, {"other", &other}},
+                               inputs, /*warmup_runs=*/1, /*num_runs=*/5,
+                               /*max_time_s=*/0, &results));
+  ASSERT_EQ(results.size(), 2);
+  EXPECT_EQ(results[0].name, "reference");
+  EXPECT_EQ(results[0].num_runs, 5);
+  EXPECT_EQ(results[0].max_abs_diff, 0);
+  EXPECT_EQ(results[0].peak_memory_bytes, -1);
+  EXPECT_EQ(results[1].name, "other");
+  EXPECT_EQ(results[1].max_abs_diff, 3);
+  EXPECT_LE(results[1].p50_latency_us, results[1].p99_latency_us);
+
+  const string table = FormatResults(results);
+  EXPECT_NE(table.find("reference"), string::npos);
+  EXPECT_NE(table.find("other"), string::npos);
+
+  EXPECT_FALSE(CompareBackends({{"reference", &reference}}, inputs,
+                               /*warmup_runs=*/0, /*num_runs=*/0,
+                               /*max_time_s=*/0, &results)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace benchmark_model
+}  // namespace tensorflow
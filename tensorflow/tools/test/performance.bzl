@@ -31,6 +31,14 @@ def tf_cc_logged_benchmark(
 
     all_tags = tags + ["benchmark-test", "local", "manual", "regression-test"]
 
+    # C++ tests run their benchmarks with the flag of the benchmark library,
+    # which test_main also writes as test_log.proto when TEST_REPORT_FILE_PREFIX
+    # is set.
+    if benchmark_type == "cpp_microbenchmark":
+        benchmarks_arg = "--benchmark_filter=%s" % benchmarks
+    else:
+        benchmarks_arg = "--benchmarks=%s" % benchmarks
+
     tf_py_strict_test(
         name = name,
         tags = all_tags,
@@ -39,7 +47,7 @@ def tf_cc_logged_benchmark(
         args = [
             "--name=//%s:%s" % (native.package_name(), name),
             "--test_name=" + target,
-            "--test_args=--benchmarks=%s" % benchmarks,
+            "--test_args=" + benchmarks_arg,
             "--benchmark_type=%s" % benchmark_type,
         ],
         data = [
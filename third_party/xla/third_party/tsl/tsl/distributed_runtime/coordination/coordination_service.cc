@@ -388,7 +388,9 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
           // Heartbeat check.
           Status status = OkStatus();
           {
-            mutex_lock l(state_mu_);
+            // Scan for stale tasks under a shared lock, so that the scan of a
+            // large cluster does not block the heartbeats of its tasks.
+            tf_shared_lock l(state_mu_);
             for (const auto& [task_name, task_state] : cluster_state_) {
               // Skip tasks that are not registered or in error state
               if (task_state->GetState() !=
@@ -401,15 +403,33 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
                        << " stale?=" << is_stale;
               if (is_stale) {
                 stale_task_names.push_back(task_name);
-                status = MakeCoordinationError(errors::Unavailable(
-                    "Task ", task_name,
-                    " heartbeat timeout. This indicates that the remote task "
-                    "has failed, got preempted, or crashed unexpectedly. Check "
-                    "the task logs for an earlier error to debug further."));
-                SetTaskError(task_name, status);
               }
             }
           }
+          if (!stale_task_names.empty()) {
+            mutex_lock l(state_mu_);
+            // The tasks may have sent a heartbeat or changed state since the
+            // scan.
+            int num_stale_tasks = 0;
+            for (absl::string_view task_name : stale_task_names) {
+              TaskState* task_state = cluster_state_[task_name].get();
+              if (task_state->GetState() ==
+                      CoordinatedTaskState::TASKSTATE_CONNECTED &&
+                  task_state->TimeSinceLastHeartbeatMs() >
+                      heartbeat_timeout_ms_) {
+                stale_task_names[num_stale_tasks++] = task_name;
+              }
+            }
+            stale_task_names.resize(num_stale_tasks);
+            for (const auto& stale_task_name : stale_task_names) {
+              status = MakeCoordinationError(errors::Unavailable(
+                  "Task ", stale_task_name,
+                  " heartbeat timeout. This indicates that the remote task "
+                  "has failed, got preempted, or crashed unexpectedly. Check "
+                  "the task logs for an earlier error to debug further."));
+              SetTaskError(stale_task_name, status);
+            }
+          }
           // Propagate heartbeat timeout errors to other connected tasks.
           if (!stale_task_names.empty()) {
             if (!has_service_to_client_connection) {
@@ -716,29 +736,33 @@ Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   const std::string& task_name = GetTaskName(task);
   Status s = OkStatus();
   {
-    mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
+    // Heartbeats only read the cluster state; the heartbeat time of a task
+    // has its own lock. Taking `state_mu_` shared lets the heartbeats of all
+    // tasks be processed concurrently.
+    tf_shared_lock l(state_mu_);
+    auto it = cluster_state_.find(task_name);
+    if (it == cluster_state_.end()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Unexpected heartbeat request from task: ", task_name,
           ". This usually implies an earlier error that caused coordination "
           "service to shut down before the workers disconnect. Check the task "
           "leader's logs for an earlier error to debug the root cause."));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
+    TaskState* task_state = it->second.get();
+    if (!task_state->GetStatus().ok()) {
+      return task_state->GetStatus();
+    } else if (task_state->GetState() ==
                    CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages"));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
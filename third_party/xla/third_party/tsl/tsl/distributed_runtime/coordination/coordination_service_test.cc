@@ -450,6 +450,49 @@ TEST_F(CoordinateTwoTasksTest, TestTaskHeartbeatTimeout) {
       coord_service_->RecordHeartbeat(task_1_, incarnation_1_)));
 }
 
+TEST_F(CoordinateTwoTasksTest, HeartbeatTimeoutOnlyForStaleTask) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_1_, incarnation_1_));
+
+  // Only task 0 keeps sending heartbeats while the leader checks staleness.
+  const int64_t end_us = Env::Default()->NowMicros() +
+                         absl::ToInt64Microseconds(2 * kHeartbeatTimeout);
+  while (Env::Default()->NowMicros() < end_us) {
+    TF_ASSERT_OK(coord_service_->RecordHeartbeat(task_0_, incarnation_0_));
+    Env::Default()->SleepForMicroseconds(
+        absl::ToInt64Microseconds(kHeartbeatTimeout / 10));
+  }
+  TF_EXPECT_OK(coord_service_->RecordHeartbeat(task_0_, incarnation_0_));
+  EXPECT_TRUE(absl::IsUnavailable(
+      coord_service_->RecordHeartbeat(task_1_, incarnation_1_)));
+  // The error of task 1 is propagated to task 0.
+  EXPECT_TRUE(absl::IsUnavailable(client_0_.GetStatus()));
+}
+
+TEST_F(CoordinateTwoTasksTest, ConcurrentHeartbeats) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_1_, incarnation_1_));
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumHeartbeats = 1000;
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    const CoordinatedTask& task = i % 2 == 0 ? task_0_ : task_1_;
+    const uint64_t incarnation = i % 2 == 0 ? incarnation_0_ : incarnation_1_;
+    threads.emplace_back(Env::Default()->StartThread(
+        {}, absl::StrCat("heartbeat_", i), [this, &task, incarnation]() {
+          for (int j = 0; j < kNumHeartbeats; ++j) {
+            TF_EXPECT_OK(coord_service_->RecordHeartbeat(task, incarnation));
+          }
+        }));
+  }
+  threads.clear();  // Joins the threads.
+
+  EXPECT_TRUE(absl::IsAborted(coord_service_->RecordHeartbeat(task_0_, 0)));
+}
+
 TEST_F(CoordinateTwoTasksTest,
        HeartbeatTimeoutWithoutServerToClientConnection) {
   EnableCoordinationService(/*has_service_to_client_connection=*/false);
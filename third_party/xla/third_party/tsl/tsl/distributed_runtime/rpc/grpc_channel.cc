@@ -189,8 +189,13 @@ using CachingGrpcChannelCache = GenericCachingChannelCache<GrpcChannelCache>;
 class MultiGrpcChannelCache : public CachingGrpcChannelCache {
  public:
   explicit MultiGrpcChannelCache(const std::vector<GrpcChannelCache*>& caches,
-                                 int num_channels_per_target)
-      : CachingGrpcChannelCache(num_channels_per_target), caches_(caches) {}
+                                 int num_channels_per_target,
+                                 int num_bulk_data_channels_per_target,
+                                 bool least_loaded)
+      : CachingGrpcChannelCache(num_channels_per_target,
+                                num_bulk_data_channels_per_target,
+                                least_loaded),
+        caches_(caches) {}
 
   ~MultiGrpcChannelCache() override {
     for (GrpcChannelCache* cache : caches_) {
@@ -242,6 +247,18 @@ class MultiGrpcChannelCache : public CachingGrpcChannelCache {
     return nullptr;
   }
 
+  SharedGrpcChannelPtr FindBulkDataChannelOnce(const string& target) override {
+    for (GrpcChannelCache* cache : caches_) {
+      SharedGrpcChannelPtr ch(cache->FindBulkDataChannel(target));
+      if (ch) {
+        mutex_lock l(mu_);
+        target_caches_.insert({target, cache});
+        return ch;
+      }
+    }
+    return nullptr;
+  }
+
  private:
   // List of channels used by this MultiGrpcChannelCache.
   const std::vector<GrpcChannelCache*> caches_;
@@ -258,8 +275,12 @@ class SparseGrpcChannelCache : public CachingGrpcChannelCache {
   SparseGrpcChannelCache(const string& job_id,
                          const std::map<int, string>& host_ports,
                          ChannelCreationFunction channel_func,
-                         int num_channels_per_target)
-      : CachingGrpcChannelCache(num_channels_per_target),
+                         int num_channels_per_target,
+                         int num_bulk_data_channels_per_target,
+                         bool least_loaded)
+      : CachingGrpcChannelCache(num_channels_per_target,
+                                num_bulk_data_channels_per_target,
+                                least_loaded),
         job_id_(job_id),
         host_ports_(host_ports),
         channel_func_(std::move(channel_func)) {
@@ -361,13 +382,18 @@ GrpcChannelCache* NewGrpcChannelCache(const GrpcChannelSpec& spec,
   caches.reserve(num_jobs);
   for (auto& job : spec.host_ports_jobs()) {
     VLOG(2) << "Creating Grpc Channel Cache for: " << job.job_id;
-    caches.push_back(
-        new SparseGrpcChannelCache(job.job_id, job.host_ports, channel_func,
-                                   options.num_channels_per_target()));
+    caches.push_back(new SparseGrpcChannelCache(
+        job.job_id, job.host_ports, channel_func,
+        options.num_channels_per_target(),
+        options.num_bulk_data_channels_per_target(),
+        options.least_loaded_channel_selection()));
   }
-  return caches.size() == 1 ? caches[0]
-                            : new MultiGrpcChannelCache(
-                                  caches, options.num_channels_per_target());
+  return caches.size() == 1
+             ? caches[0]
+             : new MultiGrpcChannelCache(
+                   caches, options.num_channels_per_target(),
+                   options.num_bulk_data_channels_per_target(),
+                   options.least_loaded_channel_selection());
 }
 
 }  // namespace tsl
@@ -73,6 +73,13 @@ class GrpcChannelCache {
   // E.g., /job:mnist/task:2
   virtual SharedGrpcChannelPtr FindWorkerChannel(const string& target) = 0;
 
+  // Like FindWorkerChannel(), but for the RPCs that carry tensors. Returns
+  // nullptr if this cache has no separate channels for them, in which case
+  // they should use the channel returned by FindWorkerChannel().
+  virtual SharedGrpcChannelPtr FindBulkDataChannel(const string& target) {
+    return nullptr;
+  }
+
   // Translates a string in the form `/job:X/task:Z` into a host_port.
   virtual string TranslateTask(const string& task) = 0;
 };
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_RPC_GRPC_CHANNEL_COMMON_H_
 #define TENSORFLOW_TSL_DISTRIBUTED_RUNTIME_RPC_GRPC_CHANNEL_COMMON_H_
 
+#include <algorithm>
 #include <unordered_map>
 #include <vector>
 
@@ -31,71 +32,114 @@ namespace tsl {
 // GenericCachingChannelCache allows using multiple channels to communiate with
 // same target to provide throughput gains. When multiple channels exist for
 // the same target they are chosen in a simple round robin fashion on each call
-// to FindWorkerChannel.
+// to FindWorkerChannel, or, if `least_loaded` is true, the one shared by the
+// fewest callers is chosen. If `num_bulk_data_channels_per_target` is
+// positive, FindBulkDataChannel chooses among a separate set of channels.
 template <typename ChannelCacheT>
 class GenericCachingChannelCache : public ChannelCacheT {
  public:
-  explicit GenericCachingChannelCache(int num_channels_per_target)
+  explicit GenericCachingChannelCache(int num_channels_per_target,
+                                      int num_bulk_data_channels_per_target = 0,
+                                      bool least_loaded = false)
       : num_channels_per_target_(
-            num_channels_per_target > 0 ? num_channels_per_target : 1) {}
+            num_channels_per_target > 0 ? num_channels_per_target : 1),
+        num_bulk_data_channels_per_target_(
+            std::max(num_bulk_data_channels_per_target, 0)),
+        least_loaded_(least_loaded) {}
 
   ~GenericCachingChannelCache() override {}
 
   SharedGrpcChannelPtr FindWorkerChannel(const string& target) override {
+    return FindChannel(target, /*bulk_data=*/false);
+  }
+
+  SharedGrpcChannelPtr FindBulkDataChannel(const string& target) override {
+    if (num_bulk_data_channels_per_target_ == 0) return nullptr;
+    return FindChannel(target, /*bulk_data=*/true);
+  }
+
+ protected:
+  // Find the ClientChannel for "target".  Only called when no channel was
+  // found in the channels_ cache for "target".  A non nullptr result will be
+  // cached in channels_.
+  virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
+
+  // Like FindChannelOnce(), but for the channels returned by
+  // FindBulkDataChannel().
+  virtual SharedGrpcChannelPtr FindBulkDataChannelOnce(const string& target) {
+    return FindChannelOnce(target);
+  }
+
+ private:
+  struct ChannelState {
+    std::vector<SharedGrpcChannelPtr> channels;
+    int last_used;
+  };
+
+  SharedGrpcChannelPtr FindChannel(const string& target, bool bulk_data) {
     {
       mutex_lock l(mu_);
-      auto iter = channels_.find(target);
-      if (iter != channels_.end()) {
+      auto& channels = bulk_data ? bulk_data_channels_ : channels_;
+      auto iter = channels.find(target);
+      if (iter != channels.end()) {
         return GetNextChannelPtrAndUpdateState(iter->second);
       }
     }
+    const int num_channels = bulk_data ? num_bulk_data_channels_per_target_
+                                       : num_channels_per_target_;
     ChannelState new_chan_state;
-    for (int indx = 0; indx < num_channels_per_target_; indx++) {
-      auto ch = FindChannelOnce(target);
+    for (int indx = 0; indx < num_channels; indx++) {
+      auto ch = bulk_data ? FindBulkDataChannelOnce(target)
+                          : FindChannelOnce(target);
       if (!ch) return nullptr;
       new_chan_state.channels.push_back(ch);
     }
-    new_chan_state.last_used = num_channels_per_target_ - 1;
+    new_chan_state.last_used = num_channels - 1;
 
     {
       mutex_lock l(mu_);
+      auto& channels = bulk_data ? bulk_data_channels_ : channels_;
       typename absl::flat_hash_map<string, ChannelState>::iterator iter;
       bool was_inserted;
-      std::tie(iter, was_inserted) = channels_.insert({target, new_chan_state});
+      std::tie(iter, was_inserted) = channels.insert({target, new_chan_state});
       VLOG(2) << "Channel cache for target: " << target
               << " Size: " << new_chan_state.channels.size()
-              << " insertion: " << was_inserted;
+              << " insertion: " << was_inserted
+              << " bulk data: " << bulk_data;
       return GetNextChannelPtrAndUpdateState(iter->second);
     }
   }
 
- protected:
-  // Find the ClientChannel for "target".  Only called when no channel was
-  // found in the channels_ cache for "target".  A non nullptr result will be
-  // cached in channels_.
-  virtual SharedGrpcChannelPtr FindChannelOnce(const string& target) = 0;
-
- private:
-  struct ChannelState {
-    std::vector<SharedGrpcChannelPtr> channels;
-    int last_used;
-  };
-
   // Should be called with mu_ held.
   SharedGrpcChannelPtr GetNextChannelPtrAndUpdateState(
       ChannelState& chan_state) {
-    // Following statement is marked as Crash OK as this is an invariant of
-    // code flow in this class.
-    CHECK_EQ(chan_state.channels.size(), num_channels_per_target_);  // Crash OK
-    chan_state.last_used =
-        (chan_state.last_used + 1) % num_channels_per_target_;
+    const int num_channels = chan_state.channels.size();
+    chan_state.last_used = (chan_state.last_used + 1) % num_channels;
+    if (least_loaded_) {
+      // Every caller shares the channel returned to it, so the use count of a
+      // channel tracks how many callers are using it. Ties go to the channel
+      // after the one last used.
+      int least_loaded = chan_state.last_used;
+      for (int i = 1; i < num_channels; ++i) {
+        const int indx = (chan_state.last_used + i) % num_channels;
+        if (chan_state.channels[indx].use_count() <
+            chan_state.channels[least_loaded].use_count()) {
+          least_loaded = indx;
+        }
+      }
+      chan_state.last_used = least_loaded;
+    }
     return chan_state.channels[chan_state.last_used];
   }
 
   const int num_channels_per_target_;
+  const int num_bulk_data_channels_per_target_;
+  const bool least_loaded_;
   // TODO(zhifengc): Eviction when the map becomes too big.
   mutex mu_;
   absl::flat_hash_map<string, ChannelState> channels_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, ChannelState> bulk_data_channels_
+      TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tsl
@@ -293,6 +293,75 @@ TEST(GrpcChannelTest, HostPortsMultiGrpcMultiChannelPerTarget) {
   }
 }
 
+TEST(GrpcChannelTest, BulkDataChannels) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {{0, "a:1"}, {1, "b:2"}}));
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist2", {{0, "a:1"}}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  {
+    // No separate channels by default.
+    std::unique_ptr<GrpcChannelCache> cc(
+        NewGrpcChannelCache(spec, channel_func));
+    EXPECT_EQ(nullptr, cc->FindBulkDataChannel("/job:mnist/replica:0/task:0"));
+  }
+
+  tensorflow::RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(2);
+  rpc_options.set_num_bulk_data_channels_per_target(2);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, rpc_options));
+  EXPECT_EQ(nullptr, cc->FindBulkDataChannel("/job:other/replica:0/task:0"));
+
+  for (const string& target :
+       {"/job:mnist/replica:0/task:0", "/job:mnist2/replica:0/task:0"}) {
+    std::vector<SharedGrpcChannelPtr> channels, bulk_data_channels;
+    for (int i = 0; i < 4; i++) {
+      channels.push_back(cc->FindWorkerChannel(target));
+      bulk_data_channels.push_back(cc->FindBulkDataChannel(target));
+    }
+    for (int i = 0; i < 2; i++) {
+      ASSERT_NE(nullptr, bulk_data_channels[i]);
+      // Same channel every 2 calls.
+      EXPECT_EQ(bulk_data_channels[i].get(), bulk_data_channels[i + 2].get());
+      EXPECT_NE(bulk_data_channels[i].get(), bulk_data_channels[i + 1].get());
+      // Never one of the channels for the other RPCs.
+      for (int j = 0; j < 4; j++) {
+        EXPECT_NE(bulk_data_channels[i].get(), channels[j].get());
+      }
+    }
+  }
+}
+
+TEST(GrpcChannelTest, LeastLoadedChannelSelection) {
+  GrpcChannelSpec spec;
+  TF_EXPECT_OK(spec.AddHostPortsJob("mnist", {{0, "a:1"}}));
+  ChannelCreationFunction channel_func =
+      ConvertToChannelCreationFunction(NewHostPortGrpcChannel);
+  tensorflow::RPCOptions rpc_options;
+  rpc_options.set_num_channels_per_target(3);
+  rpc_options.set_least_loaded_channel_selection(true);
+  std::unique_ptr<GrpcChannelCache> cc(
+      NewGrpcChannelCache(spec, channel_func, rpc_options));
+
+  const string target = "/job:mnist/replica:0/task:0";
+  SharedGrpcChannelPtr busy = cc->FindWorkerChannel(target);
+  ASSERT_NE(nullptr, busy);
+  // The other channels are chosen while `busy` is in use.
+  for (int i = 0; i < 6; i++) {
+    EXPECT_NE(busy.get(), cc->FindWorkerChannel(target).get());
+  }
+  SharedGrpcChannelPtr also_busy = cc->FindWorkerChannel(target);
+  EXPECT_NE(busy.get(), also_busy.get());
+  // Only one channel is left unused.
+  const ::grpc::Channel* idle = cc->FindWorkerChannel(target).get();
+  EXPECT_NE(busy.get(), idle);
+  EXPECT_NE(also_busy.get(), idle);
+  for (int i = 0; i < 6; i++) {
+    EXPECT_EQ(idle, cc->FindWorkerChannel(target).get());
+  }
+}
+
 TEST(GrpcChannelTest, SparseHostPorts) {
   GrpcChannelSpec spec;
   TF_EXPECT_OK(
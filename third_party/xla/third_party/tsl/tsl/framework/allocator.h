@@ -33,6 +33,21 @@ limitations under the License.
 
 namespace tsl {
 
+// A hint about how long an allocation will live, relative to the other
+// allocations of the same computation.
+enum class AllocationLifetime {
+  kUnknown,
+  // Expected to be deallocated soon, e.g. a tensor whose only consumers run
+  // shortly after its producer.
+  kShort,
+  // Expected to stay live while many other allocations come and go, e.g. an
+  // activation that is only consumed by the backward pass.
+  kLong,
+  // Expected to outlive the step that allocates it, e.g. a tensor that is
+  // returned to the caller or stored in a variable or a queue.
+  kPersistent,
+};
+
 // Attributes for a single allocation call. Different calls to the same
 // allocator could potentially have different allocation attributes.
 struct AllocationAttributes {
@@ -61,6 +76,9 @@ struct AllocationAttributes {
   // a memory chunk whose freed_at_count is at this value or earlier may be
   // returned.
   std::function<uint64()>* freed_by_func = nullptr;  // Not owned.
+  // A hint that allocators may use to keep allocations of different lifetimes
+  // apart, and so reduce fragmentation.
+  AllocationLifetime lifetime = AllocationLifetime::kUnknown;
 
   AllocationAttributes(const AllocationAttributes&) = delete;
   void operator=(const AllocationAttributes&) = delete;
@@ -326,6 +344,10 @@ struct AllocatorAttributes {
   bool gpu_compatible() const { return value & (0x1 << 2); }
   void set_use_pjrt_allocator(bool v) { value |= (static_cast<int>(v) << 3); }
   bool use_pjrt_allocator() const { return value & (0x1 << 3); }
+  // The allocation is a temporary that is freed before the kernel that
+  // allocates it finishes, so that it may come from a per-thread arena.
+  void set_scratch(bool v) { value |= (static_cast<int>(v) << 4); }
+  bool scratch() const { return value & (0x1 << 4); }
   void Merge(AllocatorAttributes other) {
     value |= other.value;
     if (scope_id != other.scope_id) {
@@ -412,6 +434,31 @@ class SubAllocator {
     return AllocatorMemoryType::kUnknown;
   }
 
+  // Returns true if this allocator can release the memory backing parts of the
+  // regions it returned, e.g. by unmapping the physical pages of a virtual
+  // address range, and back them again on demand.
+  virtual bool SupportsDecommit() const { return false; }
+
+  // Releases the memory backing the pages that lie entirely within
+  // [ptr, ptr + num_bytes), which must be within a region returned by Alloc()
+  // and must not be accessed until it is committed again. Returns the number
+  // of bytes released.
+  virtual size_t Decommit(void* ptr, size_t num_bytes) { return 0; }
+
+  // Returns the number of decommitted bytes in the pages that overlap
+  // [ptr, ptr + num_bytes).
+  virtual size_t DecommittedBytes(const void* ptr, size_t num_bytes) const {
+    return 0;
+  }
+
+  // Backs all decommitted pages that overlap [ptr, ptr + num_bytes) with
+  // memory again, and adds the number of bytes it backed to
+  // `*bytes_committed`. Returns false if some of the pages could not be
+  // backed.
+  virtual bool Commit(void* ptr, size_t num_bytes, size_t* bytes_committed) {
+    return true;
+  }
+
  protected:
   // Implementation of Alloc() method must call this on newly allocated
   // value.
@@ -20,8 +20,10 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "tsl/framework/allocator_retry.h"
+#include "tsl/framework/memory_timeline.h"
 #include "tsl/lib/core/bits.h"
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/logging.h"
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/types.h"
+#include "tsl/profiler/lib/mutex_contention.h"
 #include "tsl/profiler/lib/scoped_memory_debug_annotation.h"
 #include "tsl/profiler/lib/traceme.h"
 #include "tsl/protobuf/bfc_memory_map.pb.h"
@@ -39,6 +42,13 @@ namespace tsl {
 
 constexpr BFCAllocator::ChunkHandle BFCAllocator::kInvalidChunkHandle;
 
+namespace {
+uint64 NextAllocatorId() {
+  static std::atomic<uint64> next_id{0};
+  return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+}  // namespace
+
 BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
                            size_t total_memory, const string& name,
                            const Options& opts)
@@ -47,7 +57,9 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       sub_allocator_(std::move(sub_allocator)),
       name_(name),
       free_chunks_list_(kInvalidChunkHandle),
-      next_allocation_id_(1) {
+      next_allocation_id_(1),
+      id_(NextAllocatorId()),
+      timeline_id_(MemoryTimeline::Global()->RegisterAllocator(name)) {
   if (opts.allow_growth) {
     // 2MiB smallest initial allocation, unless total memory available
     // is less.
@@ -84,9 +96,11 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+  profiler::SetMutexName(&lock_, strings::StrCat("BFCAllocator:", name));
 }
 
 BFCAllocator::~BFCAllocator() {
+  profiler::ClearMutexName(&lock_);
   // Return memory back.
   VLOG(2) << "Number of regions allocated: "
           << region_manager_.regions().size();
@@ -112,7 +126,8 @@ const BFCAllocator::Chunk* BFCAllocator::ChunkFromHandle(ChunkHandle h) const {
 }
 
 bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
-  size_t available_bytes = memory_limit_ - *stats_.pool_bytes;
+  size_t available_bytes =
+      memory_limit_ - (*stats_.pool_bytes - decommitted_bytes_);
   // Rounds available_bytes down to the nearest multiple of kMinAllocationSize.
   available_bytes = (available_bytes / kMinAllocationSize) * kMinAllocationSize;
 
@@ -242,19 +257,20 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   if (allocation_attr.freed_by_func != nullptr) {
     freed_by_count = (*allocation_attr.freed_by_func)();
   }
-  void* r =
-      AllocateRawInternal(unused_alignment, num_bytes, false, freed_by_count);
+  const bool long_lived = IsLongLived(allocation_attr);
+  void* r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                                freed_by_count, long_lived);
   if (r != nullptr) {
     return r;
   } else {
     static const int64_t kMaxMillisToWait = 10000;  // 10 seconds
     r = retry_helper_.AllocateRaw(
-        [this, &allocation_attr](size_t a, size_t nb, bool v) {
+        [this, &allocation_attr, long_lived](size_t a, size_t nb, bool v) {
           uint64 freed_by_count = 0;
           if (allocation_attr.freed_by_func != nullptr) {
             freed_by_count = (*allocation_attr.freed_by_func)();
           }
-          return AllocateRawInternal(a, nb, v, freed_by_count);
+          return AllocateRawInternal(a, nb, v, freed_by_count, long_lived);
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
     return r;
@@ -264,6 +280,15 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const bool use_thread_cache = UsesThreadCache(num_bytes, allocation_attr);
+  if (use_thread_cache) {
+    void* result = AllocateFromThreadCache(RoundedBytes(num_bytes));
+    if (result != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result
+              << " (thread cache)";
+      return result;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -287,8 +312,9 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       if (allocation_attr.freed_by_func != nullptr) {
         freed_by_count = (*allocation_attr.freed_by_func)();
       }
-      void* res = AllocateRawInternal(unused_alignment, num_bytes,
-                                      dump_log_on_failure, freed_by_count);
+      void* res =
+          AllocateRawInternal(unused_alignment, num_bytes, dump_log_on_failure,
+                              freed_by_count, IsLongLived(allocation_attr));
       if (res == nullptr) {
         int32 counter_value = log_counter.load(std::memory_order_relaxed);
         if (counter_value < kMaxFailureLogs) {
@@ -310,10 +336,133 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                           allocation_attr);
     }
   }();
+  if (use_thread_cache && result != nullptr) {
+    MarkThreadCached(result, RoundedBytes(num_bytes));
+  }
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
   return result;
 }
 
+bool BFCAllocator::UsesThreadCache(
+    size_t num_bytes, const AllocationAttributes& allocation_attr) const {
+  return opts_.thread_cache_bytes > 0 && timing_counter_ == nullptr &&
+         allocation_attr.freed_by_func == nullptr &&
+         !IsLongLived(allocation_attr) && num_bytes > 0 &&
+         RoundedBytes(num_bytes) <= kMaxThreadCachedChunkSize;
+}
+
+BFCAllocator::ThreadCache* BFCAllocator::GetThreadCache() {
+  // The caches of the calling thread, by allocator id. They are destroyed when
+  // the thread exits, after which the allocator flushes them.
+  thread_local absl::flat_hash_map<uint64, std::shared_ptr<ThreadCache>>
+      caches;
+  std::shared_ptr<ThreadCache>& cache = caches[id_];
+  if (cache == nullptr) {
+    cache = std::make_shared<ThreadCache>();
+    mutex_lock l(lock_);
+    FlushThreadCaches(/*only_exited_threads=*/true);
+    thread_caches_.push_back(cache);
+  }
+  return cache.get();
+}
+
+void* BFCAllocator::AllocateFromThreadCache(size_t rounded_bytes) {
+  ThreadCache* cache = GetThreadCache();
+  mutex_lock l(cache->mu);
+  std::vector<CachedChunk>& free_chunks =
+      cache->free_chunks[rounded_bytes / kMinAllocationSize - 1];
+  if (free_chunks.empty()) return nullptr;
+  const CachedChunk chunk = free_chunks.back();
+  free_chunks.pop_back();
+  cache->cached_bytes -= chunk.size;
+  ++cache->num_hits;
+  return chunk.ptr;
+}
+
+void BFCAllocator::MarkThreadCached(void* ptr, size_t rounded_bytes) {
+  size_t chunk_size;
+  {
+    mutex_lock l(lock_);
+    Chunk* c = ChunkFromHandle(region_manager_.get_handle(ptr));
+    // The chunk will serve other allocations of the same rounded size.
+    c->requested_size = c->size;
+    chunk_size = c->size;
+  }
+  ThreadCachedChunkShard& shard = ShardFor(ptr);
+  mutex_lock l(shard.mu);
+  shard.chunks[ptr] = {static_cast<int>(rounded_bytes / kMinAllocationSize - 1),
+                       chunk_size};
+}
+
+bool BFCAllocator::DeallocateToThreadCache(void* ptr) {
+  ThreadCachedChunkInfo info;
+  {
+    ThreadCachedChunkShard& shard = ShardFor(ptr);
+    mutex_lock l(shard.mu);
+    auto it = shard.chunks.find(ptr);
+    if (it == shard.chunks.end()) return false;
+    info = it->second;
+  }
+  ThreadCache* cache = GetThreadCache();
+  bool is_full;
+  {
+    mutex_lock l(cache->mu);
+    cache->free_chunks[info.size_class].push_back({ptr, info.size});
+    cache->cached_bytes += info.size;
+    is_full = cache->cached_bytes > opts_.thread_cache_bytes;
+  }
+  if (is_full) {
+    // Flushes half of the cache, so that a thread that frees more than it
+    // allocates only takes the lock once every few frees.
+    std::vector<void*> ptrs;
+    TakeCachedChunks(cache, opts_.thread_cache_bytes / 2, &ptrs);
+    mutex_lock l(lock_);
+    FreeCachedChunks(ptrs);
+  }
+  return true;
+}
+
+/*static*/ void BFCAllocator::TakeCachedChunks(ThreadCache* cache,
+                                             size_t max_bytes,
+                                             std::vector<void*>* ptrs) {
+  mutex_lock l(cache->mu);
+  // Takes the largest chunks first, since they hold the most memory.
+  for (int size_class = kNumThreadCacheSizeClasses - 1;
+       size_class >= 0 && cache->cached_bytes > max_bytes; --size_class) {
+    std::vector<CachedChunk>& free_chunks = cache->free_chunks[size_class];
+    while (!free_chunks.empty() && cache->cached_bytes > max_bytes) {
+      ptrs->push_back(free_chunks.back().ptr);
+      cache->cached_bytes -= free_chunks.back().size;
+      free_chunks.pop_back();
+    }
+  }
+}
+
+void BFCAllocator::FreeCachedChunks(const std::vector<void*>& ptrs) {
+  for (void* ptr : ptrs) {
+    {
+      ThreadCachedChunkShard& shard = ShardFor(ptr);
+      mutex_lock l(shard.mu);
+      shard.chunks.erase(ptr);
+    }
+    FreeChunk(region_manager_.get_handle(ptr));
+  }
+  if (!ptrs.empty()) retry_helper_.NotifyDealloc();
+}
+
+bool BFCAllocator::FlushThreadCaches(bool only_exited_threads) {
+  std::vector<void*> ptrs;
+  for (auto it = thread_caches_.begin(); it != thread_caches_.end();) {
+    const bool exited = it->use_count() == 1;
+    if (exited || !only_exited_threads) {
+      TakeCachedChunks(it->get(), /*max_bytes=*/0, &ptrs);
+    }
+    it = exited ? thread_caches_.erase(it) : it + 1;
+  }
+  FreeCachedChunks(ptrs);
+  return !ptrs.empty();
+}
+
 // static
 size_t BFCAllocator::RoundedBytes(size_t bytes) {
   size_t rounded_bytes =
@@ -408,6 +557,8 @@ void BFCAllocator::DeallocateRegions(
     }
 
     // Deallocate the memory.
+    decommitted_bytes_ -=
+        sub_allocator_->DecommittedBytes(it->ptr(), it->memory_size());
     sub_allocator_->Free(it->ptr(), it->memory_size());
     *stats_.pool_bytes -= it->memory_size();
     it = region_manager_.RemoveAllocationRegion(it);
@@ -417,7 +568,7 @@ void BFCAllocator::DeallocateRegions(
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
-                                        uint64 freed_before) {
+                                        uint64 freed_before, bool long_lived) {
   if (num_bytes == 0) {
     VLOG(2) << "tried to allocate 0 bytes";
     return nullptr;
@@ -435,7 +586,8 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     // Merge timestamped chunks whose counts have become safe for general use.
     MergeTimestampedChunks(0);
   }
-  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+  void* ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                           long_lived);
   if (ptr != nullptr) {
     AddTraceMe("MemoryAllocation", ptr);
     return ptr;
@@ -443,7 +595,8 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
 
   // Try to extend
   if (Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       long_lived);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
       return ptr;
@@ -456,7 +609,8 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     // timestamped chunks more aggressively until a free chunk of the necessary
     // size is formed.
     if (MergeTimestampedChunks(rounded_bytes)) {
-      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+      ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                         long_lived);
       if (ptr != nullptr) {
         AddTraceMe("MemoryAllocation", ptr);
         return ptr;
@@ -464,13 +618,36 @@ void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
     }
   }
 
+  // Return the chunks held by the thread caches to the bins, in case they can
+  // be coalesced into a large enough chunk.
+  if (FlushThreadCaches(/*only_exited_threads=*/false)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       long_lived);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
+  // Release the memory of the free chunks, which may be too fragmented to
+  // serve the request, so that it can back a new region.
+  if (DecommitFreeChunks() > 0 && Extend(unused_alignment, rounded_bytes)) {
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       long_lived);
+    if (ptr != nullptr) {
+      AddTraceMe("MemoryAllocation", ptr);
+      return ptr;
+    }
+  }
+
   // Reaching this point means that no chunks can satisfy the request. Also,
   // the unallocated bytes cannot satisfy the request. Before giving up, let's
   // try deallocating free regions so that suballocator can combine them with
   // the unallocated bytes and form a larger region.
   if (DeallocateFreeRegions(rounded_bytes) &&
       Extend(unused_alignment, rounded_bytes)) {
-    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before);
+    ptr = FindChunkPtr(bin_num, rounded_bytes, num_bytes, freed_before,
+                       long_lived);
     if (ptr != nullptr) {
       AddTraceMe("MemoryAllocation", ptr);
       return ptr;
@@ -556,7 +733,8 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
 }
 
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
-                                 size_t num_bytes, uint64 freed_before) {
+                                 size_t num_bytes, uint64 freed_before,
+                                 bool long_lived) {
   // First identify the first bin that could satisfy rounded_bytes.
   for (; bin_num < kNumBins; bin_num++) {
     // Start searching from the first bin for the smallest chunk that fits
@@ -571,10 +749,6 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         continue;
       }
       if (chunk->size >= rounded_bytes) {
-        // We found an existing chunk that fits us that wasn't in use, so remove
-        // it from the free bin structure prior to using.
-        RemoveFreeChunkIterFromBin(&b->free_chunks, citer);
-
         // If we can break the size of the chunk into two reasonably large
         // pieces, do don't waste more than max_internal_fragmentation_bytes on
         // padding. If this threshold is not set by the user, then use 128MB as
@@ -583,12 +757,38 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             (opts_.fragmentation_fraction > 0.0)
                 ? opts_.fragmentation_fraction * memory_limit_
                 : 128 << 20;
-
-        if (chunk->size >= rounded_bytes * 2 ||
+        const bool split =
+            chunk->size >= rounded_bytes * 2 ||
             static_cast<int64_t>(chunk->size) - rounded_bytes >=
-                max_internal_fragmentation_bytes) {
-          SplitChunk(h, rounded_bytes);
-          chunk = ChunkFromHandle(h);  // Update chunk pointer in case it moved
+                max_internal_fragmentation_bytes;
+
+        // Skip the chunk if the part of it that will be used was decommitted,
+        // and cannot be committed again.
+        if (decommitted_bytes_ > 0) {
+          char* used_ptr = static_cast<char*>(chunk->ptr);
+          if (split && long_lived) {
+            used_ptr += chunk->size - rounded_bytes;
+          }
+          if (!EnsureCommitted(used_ptr, rounded_bytes)) {
+            continue;
+          }
+        }
+
+        // We found an existing chunk that fits us that wasn't in use, so remove
+        // it from the free bin structure prior to using.
+        RemoveFreeChunkIterFromBin(&b->free_chunks, citer);
+
+        if (split) {
+          // Long-lived allocations take the end of the chunk, so that they
+          // stay apart from the short-lived allocations at its start.
+          ChunkHandle h_used = h;
+          if (long_lived) {
+            h_used = SplitChunkFromEnd(h, rounded_bytes);
+          } else {
+            SplitChunk(h, rounded_bytes);
+          }
+          // Update chunk pointer in case it moved.
+          chunk = ChunkFromHandle(h_used);
         }
 
         // The requested size of the returned chunk is what the user
@@ -609,6 +809,10 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (MemoryTimeline::IsRecording()) {
+          MemoryTimeline::Global()->Record(timeline_id_, chunk->size,
+                                           stats_.bytes_in_use);
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -681,9 +885,61 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
   InsertFreeChunkIntoBin(h_new_chunk);
 }
 
+size_t BFCAllocator::DecommitFreeMemory() {
+  mutex_lock l(lock_);
+  return DecommitFreeChunks();
+}
+
+size_t BFCAllocator::DecommitFreeChunks() {
+  if (!sub_allocator_->SupportsDecommit()) {
+    return 0;
+  }
+  FlushThreadCaches(/*only_exited_threads=*/false);
+  size_t num_bytes = 0;
+  for (BinNum b = 0; b < kNumBins; b++) {
+    for (const ChunkHandle h : BinFromIndex(b)->free_chunks) {
+      const Chunk* c = ChunkFromHandle(h);
+      num_bytes += sub_allocator_->Decommit(c->ptr, c->size);
+    }
+  }
+  decommitted_bytes_ += num_bytes;
+  if (num_bytes > 0) {
+    VLOG(1) << "Decommitted " << strings::HumanReadableNumBytes(num_bytes)
+            << " of free memory for " << Name() << ".";
+  }
+  return num_bytes;
+}
+
+bool BFCAllocator::EnsureCommitted(void* ptr, size_t num_bytes) {
+  const size_t decommitted = sub_allocator_->DecommittedBytes(ptr, num_bytes);
+  if (decommitted == 0) {
+    return true;
+  }
+  if (*stats_.pool_bytes - decommitted_bytes_ + decommitted > memory_limit_) {
+    return false;
+  }
+  size_t committed = 0;
+  const bool ok = sub_allocator_->Commit(ptr, num_bytes, &committed);
+  decommitted_bytes_ -= committed;
+  return ok;
+}
+
+BFCAllocator::ChunkHandle BFCAllocator::SplitChunkFromEnd(
+    BFCAllocator::ChunkHandle h, size_t num_bytes) {
+  SplitChunk(h, ChunkFromHandle(h)->size - num_bytes);
+  const ChunkHandle h_end = ChunkFromHandle(h)->next;
+  RemoveFreeChunkFromBin(h_end);
+  InsertFreeChunkIntoBin(h);
+  return h_end;
+}
+
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (opts_.thread_cache_bytes > 0 && ptr != nullptr &&
+      DeallocateToThreadCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -704,6 +960,19 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   int64_t req_bytes = chunk->requested_size;
   int64_t alloc_bytes = chunk->size;
 
+  FreeChunk(h);
+
+  // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
+  // correct aggregation stats (bytes_in_use, fragmentation).
+  AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
+
+  if (VLOG_IS_ON(4)) {
+    LOG(INFO) << "F: " << RenderOccupancy();
+  }
+}
+
+void BFCAllocator::FreeChunk(ChunkHandle h) {
+  CHECK(h != kInvalidChunkHandle);
   MarkFree(h);
 
   // Consider coalescing it.
@@ -713,14 +982,6 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
   } else {
     InsertFreeChunkIntoBin(TryToCoalesce(h, false));
   }
-
-  // TraceMe needs to be added after MarkFree and InsertFreeChunkIntoBin for
-  // correct aggregation stats (bytes_in_use, fragmentation).
-  AddTraceMe("MemoryDeallocation", chunk_ptr, req_bytes, alloc_bytes);
-
-  if (VLOG_IS_ON(4)) {
-    LOG(INFO) << "F: " << RenderOccupancy();
-  }
 }
 
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
@@ -806,6 +1067,10 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
+  if (MemoryTimeline::IsRecording()) {
+    MemoryTimeline::Global()->Record(
+        timeline_id_, -static_cast<int64_t>(c->size), stats_.bytes_in_use);
+  }
 
 #ifdef TENSORFLOW_MEM_DEBUG
   if (ShouldRecordOpName()) {
@@ -1207,11 +1472,23 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  *stats.pool_bytes -= decommitted_bytes_;
+  for (const auto& cache : thread_caches_) {
+    mutex_lock cache_lock(cache->mu);
+    stats.bytes_in_use -= cache->cached_bytes;
+    stats.num_allocs += cache->num_hits;
+  }
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  for (const auto& cache : thread_caches_) {
+    mutex_lock cache_lock(cache->mu);
+    cache->num_hits = 0;
+  }
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
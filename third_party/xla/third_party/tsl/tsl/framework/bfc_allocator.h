@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_TSL_FRAMEWORK_BFC_ALLOCATOR_H_
 
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tsl/framework/allocator.h"
 #include "tsl/framework/allocator_retry.h"
@@ -68,6 +70,28 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, each thread keeps up to this many bytes of freed small
+    // chunks (of at most kMaxThreadCachedChunkSize bytes) in a cache, and
+    // serves small allocations from its cache without taking the allocator's
+    // lock. A cache is flushed back to the bins when it is full, and all caches
+    // are flushed before the allocator runs out of memory. Allocations with a
+    // `freed_by_func`, and allocators with a timing counter, do not use the
+    // caches.
+    //
+    // The chunks held by the caches are not counted in the `bytes_in_use` of
+    // GetStats(), but may be counted in its `peak_bytes_in_use`. The
+    // RequestedSize() of a small allocation is its allocated size, and its
+    // AllocationId() identifies its chunk rather than the allocation.
+    size_t thread_cache_bytes = 0;
+
+    // If true, allocations whose AllocationAttributes::lifetime is kLong are
+    // carved from the end of the free chunk that serves them, and all other
+    // allocations from its start. Long-lived allocations thus accumulate at
+    // the top of each region and short-lived ones at the bottom, so that the
+    // holes left by freed short-lived allocations coalesce with each other
+    // rather than being separated by long-lived allocations.
+    bool lifetime_aware_placement = false;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,12 +131,28 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // If the sub-allocator supports decommitting memory, releases the memory
+  // backing the free chunks (e.g. the physical pages of GPU virtual memory),
+  // and returns the number of bytes released. The chunks stay available, and
+  // are backed again when they are allocated. This is also done before
+  // running out of memory, so that the released memory can back a new region
+  // and serve an allocation that no free chunk is large enough for.
+  size_t DecommitFreeMemory();
+
+  // Returns whether the sub-allocator supports decommitting memory, without
+  // which DecommitFreeMemory() releases nothing.
+  bool SupportsDecommit() const { return sub_allocator_->SupportsDecommit(); }
+
+  // The largest chunk size that is kept in thread caches.
+  static constexpr size_t kMaxThreadCachedChunkSize = 64 << 10;
+
  private:
   struct Bin;
+  struct ThreadCache;
 
   void* AllocateRawInternal(size_t alignment, size_t num_bytes,
-                            bool dump_log_on_failure,
-                            uint64 freed_before_count);
+                            bool dump_log_on_failure, uint64 freed_before_count,
+                            bool long_lived);
 
   void* AllocateRawInternalWithRetry(
       size_t alignment, size_t num_bytes,
@@ -120,6 +160,50 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns true if allocations of `num_bytes` bytes with `allocation_attr`
+  // may be served by the thread caches.
+  bool UsesThreadCache(size_t num_bytes,
+                       const AllocationAttributes& allocation_attr) const;
+
+  // Returns the cache of the calling thread, creating it if needed.
+  ThreadCache* GetThreadCache() TF_LOCKS_EXCLUDED(lock_);
+
+  // Returns a chunk of `rounded_bytes` bytes from the calling thread's cache,
+  // or nullptr if it has none.
+  void* AllocateFromThreadCache(size_t rounded_bytes) TF_LOCKS_EXCLUDED(lock_);
+
+  // Makes `ptr`, which was just allocated from the bins for `rounded_bytes`
+  // bytes, a chunk that is returned to the thread caches when it is freed.
+  void MarkThreadCached(void* ptr, size_t rounded_bytes)
+      TF_LOCKS_EXCLUDED(lock_);
+
+  // Returns `ptr` to the calling thread's cache, if it is a chunk returned by
+  // `MarkThreadCached()`. Returns false if `ptr` must be freed to the bins.
+  bool DeallocateToThreadCache(void* ptr) TF_LOCKS_EXCLUDED(lock_);
+
+  // Removes chunks from `cache` until it holds at most `max_bytes` bytes,
+  // and appends them to `ptrs`.
+  static void TakeCachedChunks(ThreadCache* cache, size_t max_bytes,
+                               std::vector<void*>* ptrs);
+
+  // Returns thread-cached chunks to the bins.
+  void FreeCachedChunks(const std::vector<void*>& ptrs)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Flushes the caches of the threads that have exited, or of all threads if
+  // `only_exited_threads` is false, and forgets the caches of the threads that
+  // have exited. Returns true if any chunk was returned to the bins.
+  bool FlushThreadCaches(bool only_exited_threads)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Implementation of DecommitFreeMemory().
+  size_t DecommitFreeChunks() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns true if [ptr, ptr + num_bytes) is backed by memory, committing
+  // its decommitted pages if they fit within the memory limit.
+  bool EnsureCommitted(void* ptr, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -466,16 +550,31 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns true if the allocation should be placed at the end of its chunk.
+  bool IsLongLived(const AllocationAttributes& allocation_attr) const {
+    return opts_.lifetime_aware_placement &&
+           (allocation_attr.lifetime == AllocationLifetime::kLong ||
+            allocation_attr.lifetime == AllocationLifetime::kPersistent);
+  }
+
   // Returns a pointer to an underlying allocated chunk of size
-  // 'rounded_bytes'.
+  // 'rounded_bytes'. If 'long_lived' is true, a chunk that is split is
+  // split with SplitChunkFromEnd().
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
-                     uint64 freed_before) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+                     uint64 freed_before, bool long_lived)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Splits the chunk specified by 'h' into two chunks, one at least
   // of size 'num_bytes'.
   void SplitChunk(ChunkHandle h, size_t num_bytes)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Splits the chunk specified by 'h', which must not be in a bin, into two
+  // chunks, the second of which has size 'num_bytes'. Adds the first chunk to
+  // the proper free bin, and returns the handle of the second.
+  ChunkHandle SplitChunkFromEnd(ChunkHandle h, size_t num_bytes)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Merges the two chunk handles.  Requires that the chunks are
   // contiguous in their allocation.
   void Merge(ChunkHandle h, ChunkHandle h2) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -511,6 +610,9 @@ class BFCAllocator : public Allocator {
 
   void MarkFree(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Frees the chunk 'h' and returns it to the bins.
+  void FreeChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle TryToCoalesce(ChunkHandle h, bool ignore_freed_at)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -612,6 +714,61 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // The number of bytes of the regions that are currently decommitted. They
+  // do not count towards the memory limit.
+  size_t decommitted_bytes_ TF_GUARDED_BY(lock_) = 0;
+
+  // Identifies this allocator in the thread-local cache maps.
+  const uint64 id_;
+
+  // Identifies this allocator in the MemoryTimeline.
+  const int timeline_id_;
+
+  static constexpr int kNumThreadCacheSizeClasses =
+      kMaxThreadCachedChunkSize / kMinAllocationSize;
+
+  struct CachedChunk {
+    void* ptr;
+    size_t size;
+  };
+
+  // The freed small chunks kept by one thread, by rounded allocation size. The
+  // lock is only contended while the cache is being flushed or its stats are
+  // read by another thread.
+  struct ThreadCache {
+    mutex mu;
+    std::array<std::vector<CachedChunk>, kNumThreadCacheSizeClasses>
+        free_chunks TF_GUARDED_BY(mu);
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+    int64_t num_hits TF_GUARDED_BY(mu) = 0;
+  };
+
+  // The caches of all threads that used this allocator. A cache that is only
+  // referenced from here belongs to a thread that has exited.
+  std::vector<std::shared_ptr<ThreadCache>> thread_caches_ TF_GUARDED_BY(lock_);
+
+  // The chunks that are returned to the thread caches when they are freed.
+  // They remain in use from the point of view of the bins until they are
+  // flushed. Sharded by address, so that frees from different threads rarely
+  // contend.
+  struct ThreadCachedChunkInfo {
+    int size_class;
+    size_t size;
+  };
+  struct ThreadCachedChunkShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, ThreadCachedChunkInfo> chunks
+        TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumThreadCachedChunkShards = 64;
+  ThreadCachedChunkShard& ShardFor(const void* ptr) {
+    return thread_cached_chunk_shards_[(reinterpret_cast<std::uintptr_t>(ptr) >>
+                                        kMinAllocationBits) %
+                                       kNumThreadCachedChunkShards];
+  }
+  std::array<ThreadCachedChunkShard, kNumThreadCachedChunkShards>
+      thread_cached_chunk_shards_;
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_) = 0;
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
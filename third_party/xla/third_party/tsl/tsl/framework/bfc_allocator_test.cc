@@ -0,0 +1,340 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/framework/bfc_allocator.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tsl/framework/allocator.h"
+#include "tsl/framework/memory_timeline.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mem.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/test.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace {
+
+class HostSubAllocator : public SubAllocator {
+ public:
+  HostSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, Allocator::kAllocatorAlignment);
+  }
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+  bool SupportsCoalescing() const override { return false; }
+};
+
+// Hands out consecutive ranges of one reserved address range, like
+// GpuVirtualMemAllocator, and records which of its pages are decommitted.
+class DecommittingSubAllocator : public SubAllocator {
+ public:
+  static constexpr size_t kPageSize = 64 << 10;
+
+  explicit DecommittingSubAllocator(size_t reserved_bytes)
+      : SubAllocator({}, {}),
+        base_(static_cast<char*>(
+            port::AlignedMalloc(reserved_bytes, kPageSize))),
+        reserved_bytes_(reserved_bytes),
+        decommitted_(reserved_bytes / kPageSize, false) {}
+  ~DecommittingSubAllocator() override { port::AlignedFree(base_); }
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    num_bytes = (num_bytes + kPageSize - 1) / kPageSize * kPageSize;
+    if (next_offset_ + num_bytes > reserved_bytes_) return nullptr;
+    void* ptr = base_ + next_offset_;
+    next_offset_ += num_bytes;
+    *bytes_received = num_bytes;
+    return ptr;
+  }
+  void Free(void* ptr, size_t num_bytes) override {}
+  bool SupportsCoalescing() const override { return true; }
+
+  bool SupportsDecommit() const override { return true; }
+
+  size_t Decommit(void* ptr, size_t num_bytes) override {
+    const size_t offset = static_cast<char*>(ptr) - base_;
+    size_t decommitted_bytes = 0;
+    for (size_t page = (offset + kPageSize - 1) / kPageSize;
+         page < (offset + num_bytes) / kPageSize; ++page) {
+      if (!decommitted_[page]) decommitted_bytes += kPageSize;
+      decommitted_[page] = true;
+    }
+    return decommitted_bytes;
+  }
+
+  size_t DecommittedBytes(const void* ptr, size_t num_bytes) const override {
+    const size_t offset = static_cast<const char*>(ptr) - base_;
+    size_t decommitted_bytes = 0;
+    for (size_t page = offset / kPageSize;
+         page < (offset + num_bytes + kPageSize - 1) / kPageSize; ++page) {
+      if (decommitted_[page]) decommitted_bytes += kPageSize;
+    }
+    return decommitted_bytes;
+  }
+
+  bool Commit(void* ptr, size_t num_bytes, size_t* bytes_committed) override {
+    const size_t offset = static_cast<char*>(ptr) - base_;
+    for (size_t page = offset / kPageSize;
+         page < (offset + num_bytes + kPageSize - 1) / kPageSize; ++page) {
+      if (decommitted_[page]) *bytes_committed += kPageSize;
+      decommitted_[page] = false;
+    }
+    return true;
+  }
+
+ private:
+  char* const base_;
+  const size_t reserved_bytes_;
+  size_t next_offset_ = 0;
+  std::vector<bool> decommitted_;
+};
+
+std::unique_ptr<BFCAllocator> NewAllocator(
+    size_t total_memory, size_t thread_cache_bytes,
+    bool lifetime_aware_placement = false) {
+  BFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  opts.thread_cache_bytes = thread_cache_bytes;
+  opts.lifetime_aware_placement = lifetime_aware_placement;
+  return std::make_unique<BFCAllocator>(std::make_unique<HostSubAllocator>(),
+                                        total_memory, "test", opts);
+}
+
+TEST(BFCAllocatorThreadCacheTest, ReusesFreedChunks) {
+  auto a = NewAllocator(1 << 20, /*thread_cache_bytes=*/1 << 16);
+  void* p = a->AllocateRaw(1, 1000);
+  ASSERT_NE(nullptr, p);
+  EXPECT_EQ(1024, a->AllocatedSize(p));
+  EXPECT_EQ(1024, a->RequestedSize(p));
+  a->DeallocateRaw(p);
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+
+  // Another allocation of the same rounded size is served by the cache.
+  void* q = a->AllocateRaw(1, 1024);
+  EXPECT_EQ(p, q);
+  stats = a->GetStats();
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(1024, stats->bytes_in_use);
+  a->DeallocateRaw(q);
+
+  // Large allocations bypass the cache.
+  void* large = a->AllocateRaw(1, BFCAllocator::kMaxThreadCachedChunkSize + 1);
+  ASSERT_NE(nullptr, large);
+  a->DeallocateRaw(large);
+  stats = a->GetStats();
+  EXPECT_EQ(3, stats->num_allocs);
+  EXPECT_EQ(0, stats->bytes_in_use);
+}
+
+TEST(BFCAllocatorThreadCacheTest, FlushesCachesBeforeRunningOutOfMemory) {
+  // Room for 64 chunks of 16KiB.
+  constexpr size_t kTotalMemory = 1 << 20;
+  auto a = NewAllocator(kTotalMemory, /*thread_cache_bytes=*/kTotalMemory);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a->AllocateRaw(1, 16 << 10));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  EXPECT_EQ(nullptr, a->AllocateRaw(1, 256));
+  for (void* p : ptrs) {
+    a->DeallocateRaw(p);
+  }
+  // All of the memory is held by the cache, and must be coalesced to serve
+  // this allocation.
+  void* all = a->AllocateRaw(1, kTotalMemory);
+  EXPECT_NE(nullptr, all);
+  a->DeallocateRaw(all);
+}
+
+TEST(BFCAllocatorThreadCacheTest, FreesFromOtherThreads) {
+  auto a = NewAllocator(64 << 20, /*thread_cache_bytes=*/64 << 10);
+  mutex mu;
+  std::vector<void*> shared_ptrs;
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&, t]() {
+        for (int i = 0; i < 1000; ++i) {
+          void* p = a->AllocateRaw(1, 256 * (1 + (i + t) % 64));
+          ASSERT_NE(nullptr, p);
+          // Frees about half of the allocations on another thread.
+          void* to_free = p;
+          if (i % 2 == 0) {
+            mutex_lock l(mu);
+            shared_ptrs.push_back(p);
+            to_free = shared_ptrs.size() > 1 ? shared_ptrs.front() : nullptr;
+            if (to_free != nullptr) shared_ptrs.erase(shared_ptrs.begin());
+          }
+          a->DeallocateRaw(to_free);
+        }
+      });
+    }
+  }
+  for (void* p : shared_ptrs) {
+    a->DeallocateRaw(p);
+  }
+  absl::optional<AllocatorStats> stats = a->GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(8000, stats->num_allocs);
+}
+
+// Interleaves short- and long-lived allocations, frees the short-lived ones,
+// and returns the size of the largest free block.
+int64_t LargestFreeBlockAfterShortLivedAllocationsAreFreed(
+    BFCAllocator* a) {
+  std::vector<void*> short_lived;
+  std::vector<void*> long_lived;
+  for (int i = 0; i < 16; ++i) {
+    short_lived.push_back(a->AllocateRaw(1, 16 << 10));
+    AllocationAttributes attr;
+    attr.lifetime = AllocationLifetime::kLong;
+    long_lived.push_back(a->AllocateRaw(1, 16 << 10, attr));
+  }
+  for (void* p : short_lived) {
+    a->DeallocateRaw(p);
+  }
+  const int64_t largest_free_block = a->GetStats()->largest_free_block_bytes;
+  for (void* p : long_lived) {
+    a->DeallocateRaw(p);
+  }
+  return largest_free_block;
+}
+
+TEST(BFCAllocatorLifetimeTest, SeparatesLongLivedAllocations) {
+  constexpr size_t kTotalMemory = 1 << 20;
+  auto a = NewAllocator(kTotalMemory, /*thread_cache_bytes=*/0,
+                        /*lifetime_aware_placement=*/true);
+  AllocationAttributes attr;
+  attr.lifetime = AllocationLifetime::kLong;
+  void* long_lived = a->AllocateRaw(1, 1024, attr);
+  void* short_lived = a->AllocateRaw(1, 1024);
+  EXPECT_LT(short_lived, long_lived);
+  a->DeallocateRaw(long_lived);
+  a->DeallocateRaw(short_lived);
+
+  EXPECT_EQ(kTotalMemory - 16 * (16 << 10),
+            LargestFreeBlockAfterShortLivedAllocationsAreFreed(a.get()));
+  EXPECT_EQ(kTotalMemory, a->GetStats()->largest_free_block_bytes);
+}
+
+TEST(BFCAllocatorLifetimeTest, IgnoresHintsByDefault) {
+  constexpr size_t kTotalMemory = 1 << 20;
+  auto a = NewAllocator(kTotalMemory, /*thread_cache_bytes=*/0);
+  // The freed short-lived allocations are separated by long-lived ones, so
+  // only the end of the region is a large free block.
+  EXPECT_EQ(kTotalMemory - 32 * (16 << 10),
+            LargestFreeBlockAfterShortLivedAllocationsAreFreed(a.get()));
+}
+
+std::unique_ptr<BFCAllocator> NewDecommittingAllocator(
+    size_t total_memory, DecommittingSubAllocator** sub_allocator) {
+  auto sub = std::make_unique<DecommittingSubAllocator>(2 * total_memory);
+  *sub_allocator = sub.get();
+  BFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  return std::make_unique<BFCAllocator>(std::move(sub), total_memory, "test",
+                                        opts);
+}
+
+TEST(BFCAllocatorDecommitTest, DecommitsFreeChunks) {
+  constexpr size_t kPageSize = DecommittingSubAllocator::kPageSize;
+  constexpr size_t kTotalMemory = 16 * kPageSize;
+  DecommittingSubAllocator* sub;
+  auto a = NewDecommittingAllocator(kTotalMemory, &sub);
+  void* p = a->AllocateRaw(1, 100 << 10);
+  ASSERT_NE(nullptr, p);
+
+  // Only the pages after the one that `p` ends in are free.
+  EXPECT_EQ(14 * kPageSize, a->DecommitFreeMemory());
+  EXPECT_EQ(2 * kPageSize, *a->GetStats()->pool_bytes);
+  EXPECT_EQ(0, a->DecommitFreeMemory());
+
+  // The pages of a new allocation are committed again.
+  void* q = a->AllocateRaw(1, 200 << 10);
+  ASSERT_NE(nullptr, q);
+  EXPECT_EQ(0, sub->DecommittedBytes(q, 200 << 10));
+  EXPECT_EQ(5 * kPageSize, *a->GetStats()->pool_bytes);
+  a->DeallocateRaw(q);
+  a->DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorDecommitTest, ServesFragmentedMemoryFromNewRegion) {
+  constexpr size_t kPageSize = DecommittingSubAllocator::kPageSize;
+  constexpr size_t kTotalMemory = 16 * kPageSize;
+  DecommittingSubAllocator* sub;
+  auto a = NewDecommittingAllocator(kTotalMemory, &sub);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(a->AllocateRaw(1, kPageSize));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  // Frees every other page, so that no two free pages are adjacent.
+  for (int i = 0; i < 16; i += 2) {
+    a->DeallocateRaw(ptrs[i]);
+  }
+
+  // The free pages are decommitted, and their memory backs a new region.
+  void* large = a->AllocateRaw(1, 4 * kPageSize);
+  ASSERT_NE(nullptr, large);
+  EXPECT_GE(large, static_cast<char*>(ptrs[15]) + kPageSize);
+  void* more = a->AllocateRaw(1, 4 * kPageSize);
+  ASSERT_NE(nullptr, more);
+  EXPECT_EQ(kTotalMemory, *a->GetStats()->pool_bytes);
+
+  // All of the memory is committed, so the decommitted chunks cannot be used.
+  EXPECT_EQ(nullptr, a->AllocateRaw(1, kPageSize));
+
+  a->DeallocateRaw(more);
+  a->DeallocateRaw(large);
+  for (int i = 1; i < 16; i += 2) {
+    a->DeallocateRaw(ptrs[i]);
+  }
+}
+
+TEST(BFCAllocatorTimelineTest, RecordsAllocationsInTheTimeline) {
+  auto a = NewAllocator(1 << 20, /*thread_cache_bytes=*/0);
+  MemoryTimeline* timeline = MemoryTimeline::Global();
+  timeline->Start(/*capacity=*/16, /*sample_every=*/1);
+  void* p = a->AllocateRaw(1, 1000);
+  void* q = a->AllocateRaw(1, 4000);
+  a->DeallocateRaw(p);
+  a->DeallocateRaw(q);
+  timeline->Stop();
+
+  std::vector<MemoryTimeline::Event> events = timeline->Events();
+  ASSERT_EQ(4, events.size());
+  EXPECT_EQ("test", timeline->AllocatorName(events[0].allocator_id));
+  EXPECT_EQ(1024, events[0].bytes);
+  EXPECT_EQ(1024, events[0].bytes_in_use);
+  EXPECT_EQ(4096, events[1].bytes);
+  EXPECT_EQ(1024 + 4096, events[1].bytes_in_use);
+  EXPECT_EQ(-1024, events[2].bytes);
+  EXPECT_EQ(4096, events[2].bytes_in_use);
+  EXPECT_EQ(0, events[3].bytes_in_use);
+}
+
+}  // namespace
+}  // namespace tsl
@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/framework/memory_timeline.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "tsl/platform/env_time.h"
+#include "tsl/platform/logging.h"
+#include "tsl/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tsl {
+namespace {
+
+// Returns the value of the environment variable `name`, or `default_value`
+// if it is not set or not an integer.
+int64_t Int64FromEnv(const char* name, int64_t default_value) {
+  const char* value = std::getenv(name);
+  int64_t result;
+  if (value == nullptr || !absl::SimpleAtoi(value, &result)) {
+    return default_value;
+  }
+  return result;
+}
+
+}  // namespace
+
+std::atomic<bool> MemoryTimeline::recording_{false};
+
+MemoryTimeline::MemoryTimeline() = default;
+
+MemoryTimeline* MemoryTimeline::Global() {
+  static MemoryTimeline* timeline = [] {
+    auto* timeline = new MemoryTimeline;
+    const int64_t sample_every =
+        Int64FromEnv("TF_MEMORY_TIMELINE_SAMPLE_EVERY", 0);
+    if (sample_every > 0) {
+      const int64_t capacity =
+          Int64FromEnv("TF_MEMORY_TIMELINE_CAPACITY", kDefaultCapacity);
+      VLOG(1) << "Recording one in every " << sample_every
+              << " allocations in a timeline of " << capacity << " events";
+      timeline->Start(std::max<int64_t>(capacity, 1), sample_every);
+    }
+    return timeline;
+  }();
+  return timeline;
+}
+
+int MemoryTimeline::RegisterAllocator(absl::string_view name) {
+  mutex_lock l(mu_);
+  auto it = std::find(allocator_names_.begin(), allocator_names_.end(), name);
+  if (it != allocator_names_.end()) {
+    return it - allocator_names_.begin();
+  }
+  allocator_names_.emplace_back(name);
+  return allocator_names_.size() - 1;
+}
+
+std::string MemoryTimeline::AllocatorName(int allocator_id) const {
+  mutex_lock l(mu_);
+  DCHECK_GE(allocator_id, 0);
+  DCHECK_LT(allocator_id, allocator_names_.size());
+  return allocator_names_[allocator_id];
+}
+
+void MemoryTimeline::Start(size_t capacity, int64_t sample_every) {
+  mutex_lock l(mu_);
+  events_.clear();
+  capacity_ = std::max<size_t>(capacity, 1);
+  next_ = 0;
+  sample_every_.store(std::max<int64_t>(sample_every, 1),
+                      std::memory_order_relaxed);
+  num_events_seen_.store(0, std::memory_order_relaxed);
+  recording_.store(true, std::memory_order_relaxed);
+}
+
+void MemoryTimeline::Stop() {
+  mutex_lock l(mu_);
+  recording_.store(false, std::memory_order_relaxed);
+}
+
+void MemoryTimeline::Record(int allocator_id, int64_t bytes,
+                            int64_t bytes_in_use) {
+  if (!IsRecording()) return;
+  const int64_t sample_every = sample_every_.load(std::memory_order_relaxed);
+  if (sample_every > 1 &&
+      num_events_seen_.fetch_add(1, std::memory_order_relaxed) %
+              sample_every !=
+          0) {
+    return;
+  }
+  const char* op_name =
+      profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation()
+          .pending_op_name;
+  Event event{EnvTime::NowNanos(), bytes, bytes_in_use, allocator_id,
+              op_name != nullptr ? op_name : ""};
+  mutex_lock l(mu_);
+  // Recording may have stopped in the meantime.
+  if (!IsRecording()) return;
+  if (events_.size() < capacity_) {
+    events_.push_back(std::move(event));
+  } else {
+    events_[next_] = std::move(event);
+  }
+  next_ = (next_ + 1) % capacity_;
+}
+
+std::vector<MemoryTimeline::Event> MemoryTimeline::Events() const {
+  mutex_lock l(mu_);
+  if (events_.size() < capacity_) return events_;
+  std::vector<Event> events;
+  events.reserve(events_.size());
+  events.insert(events.end(), events_.begin() + next_, events_.end());
+  events.insert(events.end(), events_.begin(), events_.begin() + next_);
+  return events;
+}
+
+}  // namespace tsl
@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_FRAMEWORK_MEMORY_TIMELINE_H_
+#define TENSORFLOW_TSL_FRAMEWORK_MEMORY_TIMELINE_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+
+// MemoryTimeline records allocations and deallocations of the allocators that
+// report to it (BFCAllocator and TrackingAllocator) in a fixed-size ring
+// buffer, so that the memory usage of a process over time can be inspected,
+// e.g. as a track of a profile.
+//
+// Recording is off by default, and costs a relaxed atomic load per event
+// then. When it is on, one in every `sample_every` events is recorded, which
+// keeps it cheap enough to leave on in production. Each event carries the
+// bytes in use by its allocator, so the sampled events still trace the
+// memory usage over time faithfully.
+//
+// Recording can be started at process startup by setting the environment
+// variable TF_MEMORY_TIMELINE_SAMPLE_EVERY to a positive value, and
+// optionally TF_MEMORY_TIMELINE_CAPACITY to the number of events to keep.
+//
+// This class is thread-safe.
+class MemoryTimeline {
+ public:
+  struct Event {
+    // As returned by EnvTime::NowNanos().
+    uint64 timestamp_ns;
+    // Positive for allocations, negative for deallocations.
+    int64_t bytes;
+    // The bytes in use by the allocator after the event.
+    int64_t bytes_in_use;
+    int allocator_id;
+    // The op that was running when the memory was allocated, if known.
+    std::string op_name;
+  };
+
+  static constexpr size_t kDefaultCapacity = 1 << 16;
+
+  // Returns the process-wide timeline.
+  static MemoryTimeline* Global();
+
+  // Whether events are being recorded. Allocators should check this before
+  // calling Record().
+  static bool IsRecording() {
+    return recording_.load(std::memory_order_relaxed);
+  }
+
+  // Returns the id of the allocator called `name`, for use in Record().
+  // Allocators of the same name share an id.
+  int RegisterAllocator(absl::string_view name);
+
+  // Returns the name of the allocator with id `allocator_id`.
+  std::string AllocatorName(int allocator_id) const;
+
+  // Starts recording one in every `sample_every` events into a ring buffer
+  // of `capacity` events, discarding any previously recorded events.
+  void Start(size_t capacity, int64_t sample_every);
+
+  // Stops recording. The recorded events are kept until the next Start().
+  void Stop();
+
+  // Records an allocation (positive `bytes`) or deallocation (negative
+  // `bytes`) by the allocator with id `allocator_id`, which has
+  // `bytes_in_use` bytes in use after it.
+  void Record(int allocator_id, int64_t bytes, int64_t bytes_in_use);
+
+  // Returns the recorded events, oldest first.
+  std::vector<Event> Events() const;
+
+ private:
+  MemoryTimeline();
+
+  static std::atomic<bool> recording_;
+
+  mutable mutex mu_;
+  std::vector<std::string> allocator_names_ TF_GUARDED_BY(mu_);
+  std::atomic<int64_t> sample_every_{1};
+  std::atomic<uint64> num_events_seen_{0};
+  // The ring buffer. Once it is full, `next_` is the oldest event.
+  std::vector<Event> events_ TF_GUARDED_BY(mu_);
+  size_t capacity_ TF_GUARDED_BY(mu_) = 0;
+  size_t next_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_FRAMEWORK_MEMORY_TIMELINE_H_
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/framework/memory_timeline.h"
+
+#include <vector>
+
+#include "tsl/platform/test.h"
+#include "tsl/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tsl {
+namespace {
+
+TEST(MemoryTimelineTest, RegistersAllocatorsByName) {
+  MemoryTimeline* timeline = MemoryTimeline::Global();
+  const int a = timeline->RegisterAllocator("timeline_test_a");
+  const int b = timeline->RegisterAllocator("timeline_test_b");
+  EXPECT_NE(a, b);
+  EXPECT_EQ(a, timeline->RegisterAllocator("timeline_test_a"));
+  EXPECT_EQ("timeline_test_b", timeline->AllocatorName(b));
+}
+
+TEST(MemoryTimelineTest, RecordsEventsOnlyWhileRecording) {
+  MemoryTimeline* timeline = MemoryTimeline::Global();
+  const int id = timeline->RegisterAllocator("timeline_test");
+  timeline->Start(/*capacity=*/16, /*sample_every=*/1);
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation("my_op");
+    timeline->Record(id, 100, 100);
+  }
+  timeline->Record(id, -100, 0);
+  timeline->Stop();
+  timeline->Record(id, 50, 50);
+  EXPECT_FALSE(MemoryTimeline::IsRecording());
+
+  std::vector<MemoryTimeline::Event> events = timeline->Events();
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ(id, events[0].allocator_id);
+  EXPECT_EQ(100, events[0].bytes);
+  EXPECT_EQ(100, events[0].bytes_in_use);
+  EXPECT_EQ("my_op", events[0].op_name);
+  EXPECT_EQ(-100, events[1].bytes);
+  EXPECT_EQ(0, events[1].bytes_in_use);
+  EXPECT_EQ("", events[1].op_name);
+  EXPECT_LE(events[0].timestamp_ns, events[1].timestamp_ns);
+}
+
+TEST(MemoryTimelineTest, KeepsTheLatestEvents) {
+  MemoryTimeline* timeline = MemoryTimeline::Global();
+  const int id = timeline->RegisterAllocator("timeline_test");
+  timeline->Start(/*capacity=*/4, /*sample_every=*/1);
+  for (int i = 1; i <= 10; ++i) timeline->Record(id, i, i);
+  timeline->Stop();
+  std::vector<MemoryTimeline::Event> events = timeline->Events();
+  ASSERT_EQ(4, events.size());
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(7 + i, events[i].bytes);
+}
+
+TEST(MemoryTimelineTest, SamplesEvents) {
+  MemoryTimeline* timeline = MemoryTimeline::Global();
+  const int id = timeline->RegisterAllocator("timeline_test");
+  timeline->Start(/*capacity=*/100, /*sample_every=*/3);
+  for (int i = 0; i < 10; ++i) timeline->Record(id, i, i);
+  timeline->Stop();
+  std::vector<MemoryTimeline::Event> events = timeline->Events();
+  ASSERT_EQ(4, events.size());
+  EXPECT_EQ(0, events[0].bytes);
+  EXPECT_EQ(3, events[1].bytes);
+  EXPECT_EQ(9, events[3].bytes);
+}
+
+}  // namespace
+}  // namespace tsl
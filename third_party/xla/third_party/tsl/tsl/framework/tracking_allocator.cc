@@ -15,8 +15,10 @@ limitations under the License.
 
 #include "tsl/framework/tracking_allocator.h"
 
+#include "tsl/framework/memory_timeline.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/logging.h"
+#include "tsl/platform/strcat.h"
 
 namespace tsl {
 
@@ -46,6 +48,7 @@ void* TrackingAllocator::AllocateRaw(
       high_watermark_ = std::max(high_watermark_, allocated_);
       total_bytes_ += allocated_bytes;
       allocations_.emplace_back(allocated_bytes, Env::Default()->NowMicros());
+      RecordInTimeline(allocated_bytes);
       ++ref_;
     }
   } else if (track_sizes_locally_) {
@@ -62,6 +65,7 @@ void* TrackingAllocator::AllocateRaw(
     high_watermark_ = std::max(high_watermark_, allocated_);
     total_bytes_ += allocated_bytes;
     allocations_.emplace_back(allocated_bytes, Env::Default()->NowMicros());
+    RecordInTimeline(allocated_bytes);
     ++ref_;
   } else {
     mutex_lock lock(mu_);
@@ -100,6 +104,7 @@ void TrackingAllocator::DeallocateRaw(void* ptr) {
       CHECK_GE(allocated_, allocated_bytes);
       allocated_ -= allocated_bytes;
       allocations_.emplace_back(-allocated_bytes, Env::Default()->NowMicros());
+      RecordInTimeline(-static_cast<int64_t>(allocated_bytes));
     }
     should_delete = UnRef();
   }
@@ -196,6 +201,16 @@ gtl::InlinedVector<AllocRecord, 4> TrackingAllocator::GetCurrentRecords() {
   return allocations;
 }
 
+void TrackingAllocator::RecordInTimeline(int64_t bytes) {
+  if (!MemoryTimeline::IsRecording()) return;
+  if (timeline_id_ < 0) {
+    // Registered lazily, as wrappers are created for every op.
+    timeline_id_ = MemoryTimeline::Global()->RegisterAllocator(
+        strings::StrCat(allocator_->Name(), "_tracking"));
+  }
+  MemoryTimeline::Global()->Record(timeline_id_, bytes, allocated_);
+}
+
 bool TrackingAllocator::UnRef() {
   CHECK_GE(ref_, 1);
   --ref_;
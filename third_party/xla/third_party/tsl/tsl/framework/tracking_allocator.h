@@ -98,6 +98,10 @@ class TrackingAllocator : public Allocator {
  private:
   bool UnRef() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Records an allocation or deallocation of `bytes` in the MemoryTimeline,
+  // if it is recording. The bytes in use are those charged to this wrapper.
+  void RecordInTimeline(int64_t bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Allocator* allocator_;  // not owned.
   mutable mutex mu_;
   // the number of calls to AllocateRaw that have not yet been matched
@@ -130,6 +134,9 @@ class TrackingAllocator : public Allocator {
   };
   std::unordered_map<const void*, Chunk> in_use_ TF_GUARDED_BY(mu_);
   int64_t next_allocation_id_ TF_GUARDED_BY(mu_);
+  // Identifies the wrappers of `allocator_` in the MemoryTimeline, or -1 if
+  // none has been recorded yet.
+  int timeline_id_ TF_GUARDED_BY(mu_) = -1;
 };
 
 }  // end namespace tsl
@@ -20,6 +20,11 @@ limitations under the License.
 namespace tsl {
 namespace io {
 
+// Reads of at least this many bytes are taken to be a buffered, sequential
+// scan, and ask the file to fetch the same number of bytes that follow them in
+// the background.
+static constexpr int64_t kMinReadAheadSize = 64 * 1024;
+
 RandomAccessInputStream::RandomAccessInputStream(RandomAccessFile* file,
                                                  bool owns_file)
     : file_(file), owns_file_(owns_file) {}
@@ -47,6 +52,9 @@ Status RandomAccessInputStream::ReadNBytes(int64_t bytes_to_read,
   if (s.ok() || errors::IsOutOfRange(s)) {
     pos_ += data.size();
   }
+  if (s.ok() && bytes_to_read >= kMinReadAheadSize) {
+    file_->ReadAhead(pos_, bytes_to_read).IgnoreError();
+  }
   return s;
 }
 
@@ -61,6 +69,9 @@ Status RandomAccessInputStream::ReadNBytes(int64_t bytes_to_read,
   if (s.ok() || errors::IsOutOfRange(s)) {
     pos_ += result->size() - current_size;
   }
+  if (s.ok() && bytes_to_read >= kMinReadAheadSize) {
+    file_->ReadAhead(pos_, bytes_to_read).IgnoreError();
+  }
   return s;
 }
 #endif
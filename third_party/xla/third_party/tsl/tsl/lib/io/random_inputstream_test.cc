@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tsl/lib/io/random_inputstream.h"
 
+#include <cstring>
+#include <utility>
+#include <vector>
+
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/test.h"
@@ -23,6 +27,24 @@ namespace tsl {
 namespace io {
 namespace {
 
+// Serves zeros and records the ranges it is asked to read ahead.
+class ReadAheadRecordingFile : public RandomAccessFile {
+ public:
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    memset(scratch, 0, n);
+    *result = StringPiece(scratch, n);
+    return OkStatus();
+  }
+
+  Status ReadAhead(uint64 offset, size_t n) const override {
+    read_ahead_.emplace_back(offset, n);
+    return OkStatus();
+  }
+
+  mutable std::vector<std::pair<uint64, size_t>> read_ahead_;
+};
+
 TEST(RandomInputStream, ReadNBytes) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/random_inputbuffer_test";
@@ -142,6 +164,20 @@ TEST(RandomInputStream, Seek) {
   EXPECT_EQ(5, in.Tell());
 }
 
+TEST(RandomInputStream, ReadAhead) {
+  ReadAheadRecordingFile file;
+  tstring read;
+  RandomAccessInputStream in(&file);
+  // Small reads are not taken to be a sequential scan.
+  TF_ASSERT_OK(in.ReadNBytes(16, &read));
+  EXPECT_TRUE(file.read_ahead_.empty());
+  // Large reads ask for the range that follows them.
+  TF_ASSERT_OK(in.ReadNBytes(256 << 10, &read));
+  ASSERT_EQ(file.read_ahead_.size(), 1);
+  EXPECT_EQ(file.read_ahead_[0].first, 16 + (256 << 10));
+  EXPECT_EQ(file.read_ahead_[0].second, 256 << 10);
+}
+
 }  // anonymous namespace
 }  // namespace io
 }  // namespace tsl
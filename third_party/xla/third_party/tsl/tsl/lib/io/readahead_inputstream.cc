@@ -0,0 +1,137 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           int64_t buffer_size,
+                                           int num_buffers)
+    : file_(file),
+      buffer_size_(buffer_size),
+      num_buffers_(num_buffers),
+      file_stream_(file),
+      thread_pool_(std::make_unique<thread::ThreadPool>(
+          Env::Default(), "readahead_inputstream", num_buffers)) {
+  DCHECK_GT(buffer_size, 0);
+  DCHECK_GT(num_buffers, 0);
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() { thread_pool_.reset(); }
+
+void ReadaheadInputStream::FillBuffers() {
+  while (!eof_ && buffers_.size() < static_cast<size_t>(num_buffers_)) {
+    auto buffer = std::make_shared<Buffer>(next_offset_);
+    next_offset_ += buffer_size_;
+    buffers_.push_back(buffer);
+    thread_pool_->Schedule([this, buffer]() {
+      buffer->data.resize_uninitialized(buffer_size_);
+      char* scratch = &buffer->data[0];
+      StringPiece data;
+      Status s = file_->Read(buffer->offset, buffer_size_, &data, scratch);
+      if (data.data() != scratch) {
+        memmove(scratch, data.data(), data.size());
+      }
+      buffer->data.resize(data.size());
+      buffer->status = s;
+      mutex_lock l(buffer->mu);
+      buffer->done = true;
+      buffer->cv.notify_all();
+    });
+  }
+}
+
+void ReadaheadInputStream::DropBuffers() {
+  buffers_.clear();
+  next_offset_ = pos_;
+}
+
+Status ReadaheadInputStream::Consume(int64_t bytes, tstring* result) {
+  while (bytes > 0) {
+    FillBuffers();
+    if (buffers_.empty()) {
+      return errors::OutOfRange("reached end of file");
+    }
+    std::shared_ptr<Buffer> buffer = buffers_.front();
+    {
+      mutex_lock l(buffer->mu);
+      while (!buffer->done) buffer->cv.wait(l);
+    }
+    if (!buffer->status.ok() && !errors::IsOutOfRange(buffer->status)) {
+      // Retry from the current position on the next call.
+      DropBuffers();
+      return buffer->status;
+    }
+
+    const int64_t begin = pos_ - buffer->offset;
+    const int64_t end = buffer->data.size();
+    const int64_t size = std::min(bytes, end - begin);
+    if (result != nullptr) result->append(buffer->data.data() + begin, size);
+    pos_ += size;
+    bytes -= size;
+    if (begin + size == end) {
+      buffers_.pop_front();
+      if (end < buffer_size_) {
+        // The reads behind this one are past the end of the file.
+        eof_ = true;
+        DropBuffers();
+      }
+    }
+  }
+  return OkStatus();
+}
+
+Status ReadaheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Cannot read negative number of bytes");
+  }
+  result->clear();
+  return Consume(bytes_to_read, result);
+}
+
+Status ReadaheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  if (pos_ + bytes_to_skip <= next_offset_ || eof_) {
+    return Consume(bytes_to_skip, nullptr);
+  }
+  DropBuffers();
+  TF_RETURN_IF_ERROR(file_stream_.Seek(pos_));
+  Status s = file_stream_.SkipNBytes(bytes_to_skip);
+  pos_ = file_stream_.Tell();
+  eof_ = errors::IsOutOfRange(s);
+  DropBuffers();
+  return s;
+}
+
+Status ReadaheadInputStream::Reset() {
+  pos_ = 0;
+  eof_ = false;
+  DropBuffers();
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
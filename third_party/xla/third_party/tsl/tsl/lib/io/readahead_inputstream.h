@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tsl/lib/io/inputstream_interface.h"
+#include "tsl/lib/io/random_inputstream.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/threadpool.h"
+
+namespace tsl {
+namespace io {
+
+// Reads a RandomAccessFile sequentially while keeping up to `num_buffers`
+// reads of `buffer_size` bytes in flight ahead of the current position.
+//
+// A BufferedInputStream issues one read at a time, so a single file is read at
+// the speed of one outstanding request. Overlapping several large reads lets a
+// single file saturate fast local storage or a high-latency file system.
+//
+// Skips that land in the readahead window consume the buffered bytes. Longer
+// skips, and Reset(), drop the buffers and restart reading at the new position.
+//
+// A given instance is NOT safe for concurrent use by multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Does not take ownership of `file`, which must outlive *this.
+  ReadaheadInputStream(RandomAccessFile* file, int64_t buffer_size,
+                       int num_buffers);
+
+  ~ReadaheadInputStream() override;
+
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override { return pos_; }
+
+  Status Reset() override;
+
+ private:
+  // The result of a read of at most `buffer_size_` bytes at `offset`. The
+  // other fields are set by the reading thread, and may only be accessed
+  // by the stream once `done` is true.
+  struct Buffer {
+    explicit Buffer(int64_t offset) : offset(offset) {}
+
+    const int64_t offset;
+    tstring data;
+    Status status;
+    bool done TF_GUARDED_BY(mu) = false;
+    mutex mu;
+    condition_variable cv;
+  };
+
+  // Schedules reads until `num_buffers_` are in flight, unless the end of
+  // the file has been reached.
+  void FillBuffers();
+
+  // Drops the buffers, whose reads may still be in flight, and restarts the
+  // readahead at `pos_`.
+  void DropBuffers();
+
+  // Consumes the next `bytes` bytes of the buffers, and appends them to
+  // `result` unless it is null.
+  Status Consume(int64_t bytes, tstring* result);
+
+  RandomAccessFile* const file_;
+  const int64_t buffer_size_;
+  const int num_buffers_;
+
+  // Serves the skips beyond the readahead window.
+  RandomAccessInputStream file_stream_;
+
+  int64_t pos_ = 0;
+  // The offset of the next read to schedule.
+  int64_t next_offset_ = 0;
+  // Whether a read returned less than `buffer_size_` bytes.
+  bool eof_ = false;
+  std::deque<std::shared_ptr<Buffer>> buffers_;
+
+  // Destroyed first, which waits for the reads in flight.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  ReadaheadInputStream(const ReadaheadInputStream&) = delete;
+  void operator=(const ReadaheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
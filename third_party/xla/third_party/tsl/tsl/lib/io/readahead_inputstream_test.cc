@@ -0,0 +1,138 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/readahead_inputstream.h"
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+struct ReadaheadParams {
+  int64_t buffer_size;
+  int num_buffers;
+};
+
+std::vector<ReadaheadParams> AllParams() {
+  return {{1, 1}, {1, 4}, {3, 1}, {3, 2}, {4, 3}, {10, 2}, {64, 8}};
+}
+
+class ReadaheadInputStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Env* env = Env::Default();
+    string fname = testing::TmpDir() + "/readahead_inputstream_test";
+    TF_ASSERT_OK(WriteStringToFile(env, fname, "0123456789"));
+    TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_));
+  }
+
+  std::unique_ptr<RandomAccessFile> file_;
+};
+
+TEST_F(ReadaheadInputStreamTest, ReadNBytes) {
+  for (const ReadaheadParams& params : AllParams()) {
+    ReadaheadInputStream in(file_.get(), params.buffer_size,
+                            params.num_buffers);
+    tstring read;
+    TF_ASSERT_OK(in.ReadNBytes(3, &read));
+    EXPECT_EQ(read, "012");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(0, &read));
+    EXPECT_EQ(read, "");
+    EXPECT_EQ(3, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(5, &read));
+    EXPECT_EQ(read, "34567");
+    EXPECT_EQ(8, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(20, &read)));
+    EXPECT_EQ(read, "89");
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    EXPECT_EQ(read, "");
+    TF_ASSERT_OK(in.ReadNBytes(0, &read));
+    EXPECT_EQ(10, in.Tell());
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, SkipNBytes) {
+  for (const ReadaheadParams& params : AllParams()) {
+    ReadaheadInputStream in(file_.get(), params.buffer_size,
+                            params.num_buffers);
+    tstring read;
+    TF_ASSERT_OK(in.SkipNBytes(1));
+    EXPECT_EQ(1, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "12");
+    TF_ASSERT_OK(in.SkipNBytes(4));
+    EXPECT_EQ(7, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(1, &read));
+    EXPECT_EQ(read, "7");
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(5)));
+    EXPECT_EQ(10, in.Tell());
+    EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+    EXPECT_EQ(read, "");
+  }
+}
+
+TEST_F(ReadaheadInputStreamTest, Reset) {
+  for (const ReadaheadParams& params : AllParams()) {
+    ReadaheadInputStream in(file_.get(), params.buffer_size,
+                            params.num_buffers);
+    tstring read;
+    TF_ASSERT_OK(in.ReadNBytes(4, &read));
+    EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(100)));
+    TF_ASSERT_OK(in.Reset());
+    EXPECT_EQ(0, in.Tell());
+    TF_ASSERT_OK(in.ReadNBytes(10, &read));
+    EXPECT_EQ(read, "0123456789");
+    TF_ASSERT_OK(in.Reset());
+    TF_ASSERT_OK(in.SkipNBytes(6));
+    TF_ASSERT_OK(in.ReadNBytes(2, &read));
+    EXPECT_EQ(read, "67");
+  }
+}
+
+TEST(ReadaheadInputStream, LargeFile) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/readahead_inputstream_large_test";
+  string contents;
+  for (int i = 0; i < 100000; ++i) contents += static_cast<char>(i * 7 % 251);
+  TF_ASSERT_OK(WriteStringToFile(env, fname, contents));
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+
+  ReadaheadInputStream in(file.get(), 4096, 4);
+  tstring read;
+  int64_t pos = 0;
+  // Alternate reads with skips that stay in the readahead window and skips
+  // that go beyond it.
+  for (int64_t step : {1000, 5000, 30000, 7, 10000}) {
+    TF_ASSERT_OK(in.ReadNBytes(step, &read));
+    EXPECT_EQ(read, contents.substr(pos, step));
+    pos += step;
+    const int64_t skip = step % 2 == 0 ? 3000 : 40000;
+    TF_ASSERT_OK(in.SkipNBytes(skip));
+    pos += skip;
+    EXPECT_EQ(pos, in.Tell());
+  }
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(100000, &read)));
+  EXPECT_EQ(read, contents.substr(pos));
+}
+
+}  // anonymous namespace
+}  // namespace io
+}  // namespace tsl
@@ -46,6 +46,12 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If both buffer_size and num_readahead_buffers are non-zero, up to
+  // num_readahead_buffers reads of buffer_size bytes are kept in flight ahead
+  // of the reader, so that a single file can saturate fast storage. Reads must
+  // be sequential, as with buffer_size alone.
+  int num_readahead_buffers = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -0,0 +1,130 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/record_table.h"
+
+#include <utility>
+
+#include "tsl/platform/coding.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/raw_coding.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+constexpr size_t kRecordKeySize = sizeof(uint64);
+
+// Sorts after the key of any record.
+constexpr char kNumRecordsKey[] = "\xff\xff\xff\xff\xff\xff\xff\xff\xff";
+
+table::Options TableOptions(const RecordTableOptions& options) {
+  table::Options table_options;
+  table_options.block_size = options.block_size;
+  table_options.compression = options.compression;
+  return table_options;
+}
+
+// Big-endian, so that the keys sort in record order.
+void EncodeRecordKey(uint64 index, char* key) {
+  for (int i = kRecordKeySize - 1; i >= 0; --i) {
+    key[i] = static_cast<char>(index & 0xff);
+    index >>= 8;
+  }
+}
+
+}  // namespace
+
+RecordTableWriter::RecordTableWriter(WritableFile* dest,
+                                     const RecordTableOptions& options)
+    : options_(TableOptions(options)), builder_(options_, dest) {}
+
+RecordTableWriter::~RecordTableWriter() {
+  if (!closed_) builder_.Abandon();
+}
+
+Status RecordTableWriter::WriteRecord(StringPiece data) {
+  if (closed_) {
+    return errors::FailedPrecondition("Writer is closed.");
+  }
+  char key[kRecordKeySize];
+  EncodeRecordKey(num_records_, key);
+  builder_.Add(StringPiece(key, kRecordKeySize), data);
+  ++num_records_;
+  return builder_.status();
+}
+
+Status RecordTableWriter::Close() {
+  if (closed_) return OkStatus();
+  closed_ = true;
+  char value[sizeof(uint64)];
+  core::EncodeFixed64(value, num_records_);
+  builder_.Add(StringPiece(kNumRecordsKey, sizeof(kNumRecordsKey) - 1),
+               StringPiece(value, sizeof(value)));
+  return builder_.Finish();
+}
+
+RecordTableReader::RecordTableReader(std::unique_ptr<table::Table> table,
+                                     uint64 num_records)
+    : table_(std::move(table)),
+      iter_(table_->NewIterator()),
+      num_records_(num_records) {}
+
+Status RecordTableReader::Open(RandomAccessFile* file, uint64 file_size,
+                               std::unique_ptr<RecordTableReader>* reader) {
+  table::Table* raw_table = nullptr;
+  TF_RETURN_IF_ERROR(
+      table::Table::Open(table::Options(), file, file_size, &raw_table));
+  std::unique_ptr<table::Table> table(raw_table);
+
+  const StringPiece num_records_key(kNumRecordsKey,
+                                    sizeof(kNumRecordsKey) - 1);
+  std::unique_ptr<table::Iterator> iter(table->NewIterator());
+  iter->Seek(num_records_key);
+  TF_RETURN_IF_ERROR(iter->status());
+  if (!iter->Valid() || iter->key() != num_records_key ||
+      iter->value().size() != sizeof(uint64)) {
+    return errors::DataLoss("Record table is missing its number of records.");
+  }
+  const uint64 num_records = core::DecodeFixed64(iter->value().data());
+  reader->reset(new RecordTableReader(std::move(table), num_records));
+  return OkStatus();
+}
+
+Status RecordTableReader::ReadRecord(uint64 index, tstring* record) {
+  if (index >= num_records_) {
+    return errors::OutOfRange("Record index ", index, " is out of range [0, ",
+                              num_records_, ")");
+  }
+  char key_data[kRecordKeySize];
+  EncodeRecordKey(index, key_data);
+  const StringPiece key(key_data, kRecordKeySize);
+  if (iter_->Valid() && index == iter_index_ + 1) {
+    iter_->Next();
+  } else if (!iter_->Valid() || index != iter_index_) {
+    iter_->Seek(key);
+  }
+  TF_RETURN_IF_ERROR(iter_->status());
+  if (!iter_->Valid() || iter_->key() != key) {
+    iter_.reset(table_->NewIterator());
+    return errors::DataLoss("Record ", index, " is missing from the table.");
+  }
+  iter_index_ = index;
+  record->assign(iter_->value().data(), iter_->value().size());
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
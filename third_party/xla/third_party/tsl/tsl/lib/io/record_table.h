@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A seekable, block-compressed record file.
+//
+// A compressed TFRecord file is a single zlib or snappy stream, so it can only
+// be read from the start. A record table stores the records of a file as the
+// values of a table::Table keyed by their index. The table compresses its
+// data blocks independently and ends with an index of the blocks, so any
+// record can be read by decompressing only the block that holds it, and a
+// reader can be split into ranges of records without scanning the file.
+//
+// File format: a table::Table (see table_format.txt) which maps the 8-byte
+// big-endian index of each record to its contents. The table additionally
+// holds a single trailing entry, which sorts after all the records, with the
+// fixed64-encoded number of records.
+
+#ifndef TENSORFLOW_TSL_LIB_IO_RECORD_TABLE_H_
+#define TENSORFLOW_TSL_LIB_IO_RECORD_TABLE_H_
+
+#include <memory>
+
+#include "tsl/lib/io/iterator.h"
+#include "tsl/lib/io/table.h"
+#include "tsl/lib/io/table_builder.h"
+#include "tsl/lib/io/table_options.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+
+class RandomAccessFile;
+class WritableFile;
+
+namespace io {
+
+struct RecordTableOptions {
+  // Approximate number of uncompressed record bytes per block. Smaller blocks
+  // make random access cheaper, larger blocks compress better.
+  size_t block_size = 64 << 10;
+
+  table::CompressionType compression = table::kSnappyCompression;
+};
+
+class RecordTableWriter {
+ public:
+  // Creates a writer that will write a record table to "*dest", which must be
+  // initially empty and remain live while this writer is in use. Does not
+  // close the file.
+  explicit RecordTableWriter(
+      WritableFile* dest, const RecordTableOptions& options = {});
+
+  // Abandons the table if Close() has not been called.
+  ~RecordTableWriter();
+
+  // Appends `data` as the next record.
+  Status WriteRecord(StringPiece data);
+
+  // Writes the trailing entry and the index of the table. No records may be
+  // written afterwards.
+  Status Close();
+
+  uint64 num_records() const { return num_records_; }
+
+ private:
+  table::Options options_;
+  table::TableBuilder builder_;
+  uint64 num_records_ = 0;
+  bool closed_ = false;
+
+  RecordTableWriter(const RecordTableWriter&) = delete;
+  void operator=(const RecordTableWriter&) = delete;
+};
+
+// Reads the records of a record table by index.
+//
+// Reading consecutive records only decompresses each block once. A given
+// instance is NOT safe for concurrent use by multiple threads; readers that
+// read disjoint ranges of records in parallel should each open their own
+// instance.
+class RecordTableReader {
+ public:
+  // Opens the record table stored in bytes [0..file_size) of "*file", which
+  // must remain live while the reader is in use.
+  static Status Open(RandomAccessFile* file, uint64 file_size,
+                     std::unique_ptr<RecordTableReader>* reader);
+
+  uint64 num_records() const { return num_records_; }
+
+  // Reads the record at `index` into "*record". Returns OUT_OF_RANGE if
+  // `index` is not less than num_records().
+  Status ReadRecord(uint64 index, tstring* record);
+
+ private:
+  RecordTableReader(std::unique_ptr<table::Table> table, uint64 num_records);
+
+  std::unique_ptr<table::Table> table_;
+  std::unique_ptr<table::Iterator> iter_;
+  const uint64 num_records_;
+  // The index of the record at `iter_`, if it is valid.
+  uint64 iter_index_ = 0;
+
+  RecordTableReader(const RecordTableReader&) = delete;
+  void operator=(const RecordTableReader&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_RECORD_TABLE_H_
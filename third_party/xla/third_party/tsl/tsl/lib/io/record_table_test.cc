@@ -0,0 +1,156 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/lib/io/record_table.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/lib/io/table_builder.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+string Record(int i) {
+  return strings::StrCat("record", i, string(i % 50, 'x'));
+}
+
+class RecordTableTest : public ::testing::Test {
+ protected:
+  void Write(const std::vector<string>& records,
+             const RecordTableOptions& options) {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(env_->NewWritableFile(fname_, &file));
+    RecordTableWriter writer(file.get(), options);
+    for (const string& record : records) {
+      TF_ASSERT_OK(writer.WriteRecord(record));
+    }
+    EXPECT_EQ(records.size(), writer.num_records());
+    TF_ASSERT_OK(writer.Close());
+    TF_ASSERT_OK(file->Close());
+  }
+
+  void Open(std::unique_ptr<RecordTableReader>* reader) {
+    uint64 file_size;
+    TF_ASSERT_OK(env_->GetFileSize(fname_, &file_size));
+    std::unique_ptr<RandomAccessFile> file;
+    TF_ASSERT_OK(env_->NewRandomAccessFile(fname_, &file));
+    TF_ASSERT_OK(RecordTableReader::Open(file.get(), file_size, reader));
+    files_.push_back(std::move(file));
+  }
+
+  Env* env_ = Env::Default();
+  string fname_ = testing::TmpDir() + "/record_table_test";
+  std::vector<std::unique_ptr<RandomAccessFile>> files_;
+};
+
+TEST_F(RecordTableTest, ReadSequentially) {
+  for (auto compression :
+       {table::kNoCompression, table::kSnappyCompression}) {
+    RecordTableOptions options;
+    options.block_size = 1000;
+    options.compression = compression;
+    std::vector<string> records;
+    for (int i = 0; i < 5000; ++i) records.push_back(Record(i));
+    Write(records, options);
+
+    std::unique_ptr<RecordTableReader> reader;
+    Open(&reader);
+    ASSERT_EQ(5000, reader->num_records());
+    tstring record;
+    for (int i = 0; i < 5000; ++i) {
+      TF_ASSERT_OK(reader->ReadRecord(i, &record));
+      EXPECT_EQ(records[i], record);
+    }
+    EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRecord(5000, &record)));
+  }
+}
+
+TEST_F(RecordTableTest, ReadRandomly) {
+  RecordTableOptions options;
+  options.block_size = 500;
+  std::vector<string> records;
+  for (int i = 0; i < 2000; ++i) records.push_back(Record(i));
+  Write(records, options);
+
+  std::unique_ptr<RecordTableReader> reader;
+  Open(&reader);
+  tstring record;
+  for (int i : {1999, 0, 17, 17, 18, 1000, 3, 1999, 1}) {
+    TF_ASSERT_OK(reader->ReadRecord(i, &record));
+    EXPECT_EQ(records[i], record);
+  }
+}
+
+TEST_F(RecordTableTest, ReadShardsWithSeparateReaders) {
+  std::vector<string> records;
+  for (int i = 0; i < 1000; ++i) records.push_back(Record(i));
+  RecordTableOptions options;
+  options.block_size = 256;
+  Write(records, options);
+
+  // Each reader reads a contiguous range of records, without reading the
+  // blocks of the other ranges.
+  constexpr int kNumShards = 3;
+  std::vector<std::unique_ptr<RecordTableReader>> readers(kNumShards);
+  for (auto& reader : readers) Open(&reader);
+  std::vector<string> read;
+  for (int shard = 0; shard < kNumShards; ++shard) {
+    const uint64 n = readers[shard]->num_records();
+    tstring record;
+    for (uint64 i = shard * n / kNumShards; i < (shard + 1) * n / kNumShards;
+         ++i) {
+      TF_ASSERT_OK(readers[shard]->ReadRecord(i, &record));
+      read.push_back(record);
+    }
+  }
+  EXPECT_EQ(records, read);
+}
+
+TEST_F(RecordTableTest, Empty) {
+  Write({}, RecordTableOptions());
+  std::unique_ptr<RecordTableReader> reader;
+  Open(&reader);
+  EXPECT_EQ(0, reader->num_records());
+  tstring record;
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRecord(0, &record)));
+}
+
+TEST_F(RecordTableTest, MissingNumRecords) {
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(env_->NewWritableFile(fname_, &file));
+  table::TableBuilder builder(table::Options(), file.get());
+  builder.Add("key", "value");
+  TF_ASSERT_OK(builder.Finish());
+  TF_ASSERT_OK(file->Close());
+
+  uint64 file_size;
+  TF_ASSERT_OK(env_->GetFileSize(fname_, &file_size));
+  std::unique_ptr<RandomAccessFile> random_access_file;
+  TF_ASSERT_OK(env_->NewRandomAccessFile(fname_, &random_access_file));
+  std::unique_ptr<RecordTableReader> reader;
+  EXPECT_TRUE(errors::IsDataLoss(RecordTableReader::Open(
+      random_access_file.get(), file_size, &reader)));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
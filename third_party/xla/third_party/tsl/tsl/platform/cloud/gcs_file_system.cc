@@ -45,6 +45,7 @@ limitations under the License.
 #include "tsl/platform/cloud/file_block_cache.h"
 #include "tsl/platform/cloud/google_auth_provider.h"
 #include "tsl/platform/cloud/ram_file_block_cache.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/cloud/time_util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -852,9 +853,14 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (!make_default_cache) {
     max_bytes = 0;
   }
+  StringPiece eviction_policy;
+  if (GetEnvVar(kCacheEvictionPolicy, StringPieceIdentity, &eviction_policy)) {
+    scan_resistant_cache_ = absl::AsciiStrToLower(eviction_policy) == "2q";
+  }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "scan resistant = " << scan_resistant_cache_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -977,6 +983,11 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   }
 
   retry_config_ = GetGcsRetryConfig();
+
+  int32 read_parallelism;
+  if (GetEnvVar(kReadParallelism, strings::safe_strto32, &read_parallelism)) {
+    SetReadParallelism(read_parallelism);
+  }
 }
 
 GcsFileSystem::GcsFileSystem(
@@ -1084,13 +1095,29 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(),
+      scan_resistant_cache_ ? RamFileBlockCache::EvictionPolicy::kTwoQueue
+                            : RamFileBlockCache::EvictionPolicy::kLru));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
   return file_block_cache;
 }
 
+void GcsFileSystem::SetReadParallelism(int read_parallelism,
+                                       size_t min_chunk_size) {
+  read_parallelism_ = std::max(read_parallelism, 1);
+  min_parallel_read_chunk_size_ = std::max<size_t>(min_chunk_size, 1);
+  read_thread_pool_.reset();
+  if (read_parallelism_ > 1) {
+    read_thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "gcs_read", read_parallelism_ - 1);
+  }
+  VLOG(1) << "GCS read parallelism = " << read_parallelism_ << " ; "
+          << "min chunk size = " << min_parallel_read_chunk_size_;
+}
+
 // A helper function to actually read the data from GCS.
 Status GcsFileSystem::LoadBufferFromGCS(const string& fname, size_t offset,
                                         size_t n, char* buffer,
@@ -1103,24 +1130,62 @@ Status GcsFileSystem::LoadBufferFromGCS(const string& fname, size_t offset,
   profiler::TraceMe activity(
       [fname]() { return absl::StrCat("LoadBufferFromGCS ", fname); });
 
-  std::unique_ptr<HttpRequest> request;
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&request),
-                                  "when reading gs://", bucket, "/", object);
-
-  request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
-                                  request->EscapeString(object)));
-  request->SetRange(offset, offset + n - 1);
-  request->SetResultBufferDirect(buffer, n);
-  request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
+  // Split large reads into contiguous chunks fetched over separate
+  // connections. The requests are created in order, so that they are
+  // admitted by the throttle in order.
+  const size_t num_chunks =
+      std::max<size_t>(1, std::min<size_t>(read_parallelism_,
+                                           n / min_parallel_read_chunk_size_));
+  const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+  std::vector<std::unique_ptr<HttpRequest>> requests(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i) {
+    const size_t chunk_offset = i * chunk_size;
+    const size_t chunk_n = std::min(chunk_size, n - chunk_offset);
+    std::unique_ptr<HttpRequest>& request = requests[i];
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(CreateHttpRequest(&request),
+                                    "when reading gs://", bucket, "/", object);
+
+    request->SetUri(strings::StrCat("https://", kStorageHost, "/", bucket, "/",
+                                    request->EscapeString(object)));
+    request->SetRange(offset + chunk_offset,
+                      offset + chunk_offset + chunk_n - 1);
+    request->SetResultBufferDirect(buffer + chunk_offset, chunk_n);
+    request->SetTimeouts(timeouts_.connect, timeouts_.idle, timeouts_.read);
+  }
 
   if (stats_ != nullptr) {
     stats_->RecordBlockLoadRequest(fname, offset);
   }
 
-  TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when reading gs://",
-                                  bucket, "/", object);
-
-  size_t bytes_read = request->GetResultBufferDirectBytesTransferred();
+  std::vector<Status> statuses(num_chunks);
+  {
+    BlockingCounter counter(num_chunks - 1);
+    for (size_t i = 1; i < num_chunks; ++i) {
+      read_thread_pool_->Schedule([&requests, &statuses, &counter, i]() {
+        statuses[i] = requests[i]->Send();
+        counter.DecrementCount();
+      });
+    }
+    statuses[0] = requests[0]->Send();
+    counter.Wait();
+  }
+  for (const Status& status : statuses) {
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(status, " when reading gs://", bucket, "/",
+                                    object);
+  }
+
+  size_t bytes_read = 0;
+  for (size_t i = 0; i < num_chunks; ++i) {
+    const size_t chunk_bytes_read =
+        requests[i]->GetResultBufferDirectBytesTransferred();
+    if (chunk_bytes_read > 0 && bytes_read < i * chunk_size) {
+      // An earlier chunk ended before the end of the file.
+      return errors::Internal(strings::Printf(
+          "File contents are inconsistent for file: %s @ %lu.", fname.c_str(),
+          offset + bytes_read));
+    }
+    bytes_read += chunk_bytes_read;
+  }
   *bytes_transferred = bytes_read;
   VLOG(1) << "Successful read of gs://" << bucket << "/" << object << " @ "
           << offset << " of size: " << bytes_read;
@@ -32,6 +32,7 @@ limitations under the License.
 #include "tsl/platform/file_system.h"
 #include "tsl/platform/retrying_file_system.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/threadpool.h"
 
 namespace tsl {
 
@@ -62,6 +63,18 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that selects how blocks are evicted from the cache:
+// "lru" (the default) or "2q", which keeps a single pass over large files from
+// evicting the blocks of files that are read repeatedly.
+constexpr char kCacheEvictionPolicy[] = "GCS_READ_CACHE_EVICTION_POLICY";
+// The environment variable that overrides the number of concurrent ranged
+// requests that a single read from GCS (e.g. of a cache block) is split into.
+// A single stream is limited to the bandwidth of one connection, so large
+// reads can go much faster over several.
+constexpr char kReadParallelism[] = "GCS_READ_PARALLELISM";
+constexpr int kDefaultReadParallelism = 1;
+// Reads are not split into ranged requests smaller than this many bytes.
+constexpr size_t kDefaultMinParallelReadChunkSize = 8 * 1024 * 1024;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -215,6 +228,8 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  bool scan_resistant_cache() const { return scan_resistant_cache_; }
+  int read_parallelism() const { return read_parallelism_; }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -284,6 +299,14 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Splits each read of at least `2 * min_chunk_size` bytes into up to
+  /// `read_parallelism` ranged requests, which are sent concurrently.
+  ///
+  /// Must not be called concurrently with reads.
+  void SetReadParallelism(
+      int read_parallelism,
+      size_t min_chunk_size = kDefaultMinParallelReadChunkSize);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -415,6 +438,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // Whether the block cache uses 2Q instead of LRU eviction. Declared before
+  // file_block_cache_, which is created with it.
+  bool scan_resistant_cache_ = false;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -436,6 +463,14 @@ class GcsFileSystem : public FileSystem {
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
 
+  // The maximum number of concurrent ranged requests per read, and the
+  // minimum number of bytes per request.
+  int read_parallelism_ = kDefaultReadParallelism;
+  size_t min_parallel_read_chunk_size_ = kDefaultMinParallelReadChunkSize;
+  // Sends the ranged requests of a read other than the first one, which is
+  // sent by the reading thread. Only set if read_parallelism_ > 1.
+  std::unique_ptr<thread::ThreadPool> read_thread_pool_;
+
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
   // Additional header material to be transmitted with all GCS requests
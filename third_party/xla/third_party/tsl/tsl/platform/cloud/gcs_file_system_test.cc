@@ -914,6 +914,113 @@ TEST(GcsFileSystemTest, NewRandomAccessFile_InconsistentRead) {
       errors::IsInternal(file->Read(0, sizeof(scratch), &result, scratch)));
 }
 
+TEST(GcsFileSystemTest, NewRandomAccessFile_ParallelReads) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-4\n"
+           "Timeouts: 5 1 20\n",
+           "01234"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 5-9\n"
+           "Timeouts: 5 1 20\n",
+           "56789"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 10-13\n"
+           "Timeouts: 5 1 20\n",
+           "abcd"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 14-17\n"
+           "Timeouts: 5 1 20\n",
+           "ef"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 18-21\n"
+           "Timeouts: 5 1 20\n",
+           ""),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 22-24\n"
+           "Timeouts: 5 1 20\n",
+           "xyz")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetReadParallelism(3, 4 /* min chunk size */);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  char scratch[12];
+  StringPiece result;
+
+  // 10 bytes are split into two chunks of at least 4 bytes.
+  TF_EXPECT_OK(file->Read(0, 10, &result, scratch));
+  EXPECT_EQ("0123456789", result);
+
+  // 12 bytes are split into three chunks, the last two past the end of file.
+  EXPECT_TRUE(errors::IsOutOfRange(file->Read(10, 12, &result, scratch)));
+  EXPECT_EQ("abcdef", result);
+
+  // Reads too small to split are sent as a single request.
+  TF_EXPECT_OK(file->Read(22, 3, &result, scratch));
+  EXPECT_EQ("xyz", result);
+}
+
+TEST(GcsFileSystemTest, NewRandomAccessFile_ParallelReads_Inconsistent) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 0-3\n"
+           "Timeouts: 5 1 20\n",
+           "01"),
+       new FakeHttpRequest(
+           "Uri: https://storage.googleapis.com/bucket/random_access.txt\n"
+           "Auth Token: fake_token\n"
+           "Range: 4-7\n"
+           "Timeouts: 5 1 20\n",
+           "4567")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  fs.SetReadParallelism(2, 4 /* min chunk size */);
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("gs://bucket/random_access.txt", nullptr, &file));
+
+  // The second chunk has data past the end of the first one.
+  char scratch[8];
+  StringPiece result;
+  EXPECT_TRUE(
+      errors::IsInternal(file->Read(0, sizeof(scratch), &result, scratch)));
+}
+
 TEST(GcsFileSystemTest, NewWritableFile) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
@@ -3640,6 +3747,7 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(3600, fs1.timeouts().metadata);
   EXPECT_EQ(3600, fs1.timeouts().read);
   EXPECT_EQ(3600, fs1.timeouts().write);
+  EXPECT_EQ(1, fs1.read_parallelism());
 
   // Verify legacy readahead buffer override sets block size.
   unsetenv("GCS_READ_CACHE_BLOCK_SIZE_MB");
@@ -3679,6 +3787,12 @@ TEST(GcsFileSystemTest, OverrideCacheParameters) {
   EXPECT_EQ(20, fs5.timeouts().metadata);
   EXPECT_EQ(30, fs5.timeouts().read);
   EXPECT_EQ(40, fs5.timeouts().write);
+
+  // Verify read parallelism override.
+  setenv("GCS_READ_PARALLELISM", "8", 1);
+  GcsFileSystem fs6;
+  EXPECT_EQ(8, fs6.read_parallelism());
+  unsetenv("GCS_READ_PARALLELISM");
 }
 
 TEST(GcsFileSystemTest, CreateHttpRequest) {
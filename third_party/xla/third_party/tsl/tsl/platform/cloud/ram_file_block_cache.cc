@@ -51,9 +51,17 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
-  lru_list_.push_front(key);
+  if (eviction_policy_ == EvictionPolicy::kTwoQueue && !RemoveGhost(key)) {
+    // Only blocks that are read again after leaving the FIFO queue go to the
+    // LRU list.
+    fifo_list_.push_front(key);
+    new_entry->lru_iterator = fifo_list_.begin();
+    new_entry->in_fifo = true;
+  } else {
+    lru_list_.push_front(key);
+    new_entry->lru_iterator = lru_list_.begin();
+  }
   lra_list_.push_front(key);
-  new_entry->lru_iterator = lru_list_.begin();
   new_entry->lra_iterator = lra_list_.begin();
   new_entry->timestamp = env_->NowSeconds();
   block_map_.emplace(std::make_pair(key, new_entry));
@@ -62,11 +70,38 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
 
 // Remove blocks from the cache until we do not exceed our maximum size.
 void RamFileBlockCache::Trim() {
-  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
-    RemoveBlock(block_map_.find(lru_list_.back()));
+  while (cache_size_ > max_bytes_) {
+    if (!fifo_list_.empty() &&
+        (fifo_size_ > max_bytes_ / 4 || lru_list_.empty())) {
+      const Key key = fifo_list_.back();
+      RemoveBlock(block_map_.find(key));
+      AddGhost(key);
+    } else if (!lru_list_.empty()) {
+      RemoveBlock(block_map_.find(lru_list_.back()));
+    } else {
+      break;
+    }
+  }
+}
+
+void RamFileBlockCache::AddGhost(const Key& key) {
+  if (max_ghost_entries_ == 0 || ghost_map_.count(key) > 0) return;
+  ghost_list_.push_front(key);
+  ghost_map_.emplace(key, ghost_list_.begin());
+  if (ghost_list_.size() > max_ghost_entries_) {
+    ghost_map_.erase(ghost_list_.back());
+    ghost_list_.pop_back();
   }
 }
 
+bool RamFileBlockCache::RemoveGhost(const Key& key) {
+  auto it = ghost_map_.find(key);
+  if (it == ghost_map_.end()) return false;
+  ghost_list_.erase(it->second);
+  ghost_map_.erase(it);
+  return true;
+}
+
 /// Move the block to the front of the LRU list if it isn't already there.
 Status RamFileBlockCache::UpdateLRU(const Key& key,
                                     const std::shared_ptr<Block>& block) {
@@ -75,7 +110,7 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
     // The block was evicted from another thread. Allow it to remain evicted.
     return OkStatus();
   }
-  if (block->lru_iterator != lru_list_.begin()) {
+  if (!block->in_fifo && block->lru_iterator != lru_list_.begin()) {
     lru_list_.erase(block->lru_iterator);
     lru_list_.push_front(key);
     block->lru_iterator = lru_list_.begin();
@@ -112,6 +147,10 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
             // Use capacity() instead of size() to account for all  memory
             // used by the cache.
             cache_size_ += block->data.capacity();
+            if (block->in_fifo) {
+              fifo_size_ += block->data.capacity() - block->fifo_bytes;
+              block->fifo_bytes = block->data.capacity();
+            }
             // Put to beginning of LRA list.
             lra_list_.erase(block->lra_iterator);
             lra_list_.push_front(key);
@@ -273,7 +312,11 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  fifo_list_.clear();
+  ghost_list_.clear();
+  ghost_map_.clear();
   cache_size_ = 0;
+  fifo_size_ = 0;
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
@@ -295,7 +338,12 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
-  lru_list_.erase(entry->second->lru_iterator);
+  if (entry->second->in_fifo) {
+    fifo_list_.erase(entry->second->lru_iterator);
+    fifo_size_ -= entry->second->fifo_bytes;
+  } else {
+    lru_list_.erase(entry->second->lru_iterator);
+  }
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.capacity();
   block_map_.erase(entry);
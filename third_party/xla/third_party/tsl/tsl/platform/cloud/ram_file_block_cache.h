@@ -40,6 +40,18 @@ namespace tsl {
 /// filesystem (e.g. GCS).
 class RamFileBlockCache : public FileBlockCache {
  public:
+  /// How blocks are chosen for eviction when the cache is full.
+  enum class EvictionPolicy {
+    /// Evicts the least recently used block.
+    kLru,
+    /// 2Q: new blocks enter a FIFO queue that holds up to a quarter of the
+    /// cache, and are only admitted to the main LRU queue if they are read
+    /// again after leaving it. A single pass over a large dataset then only
+    /// cycles through the FIFO queue, instead of evicting the blocks of the
+    /// files that are read over and over.
+    kTwoQueue,
+  };
+
   /// The callback executed when a block is not found in the cache, and needs to
   /// be fetched from the backing filesystem. This callback is provided when the
   /// cache is constructed. The returned Status should be OK as long as the
@@ -51,12 +63,15 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    EvictionPolicy eviction_policy = EvictionPolicy::kLru)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        eviction_policy_(eviction_policy),
+        max_ghost_entries_(block_size > 0 ? max_bytes / block_size / 2 : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
@@ -131,6 +146,10 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  const EvictionPolicy eviction_policy_;
+  /// The maximum number of keys of blocks evicted from the FIFO queue that the
+  /// 2Q policy remembers.
+  const size_t max_ghost_entries_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -169,8 +188,13 @@ class RamFileBlockCache : public FileBlockCache {
   struct Block {
     /// The block data.
     std::vector<char> data;
-    /// A list iterator pointing to the block's position in the LRU list.
+    /// A list iterator pointing to the block's position in the LRU list, or in
+    /// the FIFO list if `in_fifo` is true.
     std::list<Key>::iterator lru_iterator;
+    /// Whether the block is in the FIFO queue of the 2Q policy.
+    bool in_fifo = false;
+    /// The bytes of the block counted in `fifo_size_`.
+    size_t fifo_bytes = 0;
     /// A list iterator pointing to the block's position in the LRA list.
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
@@ -203,6 +227,13 @@ class RamFileBlockCache : public FileBlockCache {
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Remember the key of a block evicted from the FIFO queue.
+  void AddGhost(const Key& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Forget the key of a block evicted from the FIFO queue. Returns whether
+  /// the key was remembered.
+  bool RemoveGhost(const Key& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   /// Update the LRU iterator for the block at `key`.
   Status UpdateLRU(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
@@ -238,6 +269,18 @@ class RamFileBlockCache : public FileBlockCache {
   /// fetched from the underlying block store.
   std::list<Key> lra_list_ TF_GUARDED_BY(mu_);
 
+  /// The FIFO queue of the 2Q policy. The front of the list identifies the most
+  /// recently added block. Hits do not move blocks within this list.
+  std::list<Key> fifo_list_ TF_GUARDED_BY(mu_);
+
+  /// The number of bytes in the blocks of the FIFO queue.
+  size_t fifo_size_ TF_GUARDED_BY(mu_) = 0;
+
+  /// The keys of the blocks most recently evicted from the FIFO queue, most
+  /// recent first, and their positions in that list.
+  std::list<Key> ghost_list_ TF_GUARDED_BY(mu_);
+  std::map<Key, std::list<Key>::iterator> ghost_map_ TF_GUARDED_BY(mu_);
+
   /// The combined number of bytes in all of the cached blocks.
   size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
 
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
 #include <cstring>
+#include <map>
 
 #include "tsl/lib/core/status_test_util.h"
 #include "tsl/platform/blocking_counter.h"
@@ -317,6 +318,78 @@ TEST(RamFileBlockCacheTest, LRU) {
   TF_EXPECT_OK(ReadCache(&cache, "", 0, 1, &out));
 }
 
+TEST(RamFileBlockCacheTest, TwoQueueIsScanResistant) {
+  const size_t block_size = 16;
+  std::map<string, int> calls;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    ++calls[filename];
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  for (auto policy : {RamFileBlockCache::EvictionPolicy::kLru,
+                      RamFileBlockCache::EvictionPolicy::kTwoQueue}) {
+    calls.clear();
+    RamFileBlockCache cache(block_size, 8 * block_size, 0, fetcher,
+                            Env::Default(), policy);
+    std::vector<char> out;
+    // Read the hot block, then enough other blocks to evict it.
+    TF_EXPECT_OK(ReadCache(&cache, "hot", 0, 1, &out));
+    for (int i = 0; i < 8; ++i) {
+      TF_EXPECT_OK(ReadCache(&cache, "scan", i * block_size, 1, &out));
+    }
+    // Read the hot block again, and repeatedly while scanning a large file.
+    TF_EXPECT_OK(ReadCache(&cache, "hot", 0, 1, &out));
+    EXPECT_EQ(2, calls["hot"]);
+    for (int i = 8; i < 100; ++i) {
+      // Repeated reads of a block of the scan don't protect it.
+      TF_EXPECT_OK(ReadCache(&cache, "scan", i * block_size, 1, &out));
+      TF_EXPECT_OK(ReadCache(&cache, "scan", i * block_size + 1, 1, &out));
+      if (i % 10 == 0) {
+        TF_EXPECT_OK(ReadCache(&cache, "hot", 0, 1, &out));
+      }
+    }
+    EXPECT_EQ(100, calls["scan"]);
+    if (policy == RamFileBlockCache::EvictionPolicy::kLru) {
+      EXPECT_GT(calls["hot"], 2);
+    } else {
+      EXPECT_EQ(2, calls["hot"]);
+    }
+    EXPECT_LE(cache.CacheSize(), 8 * block_size);
+  }
+}
+
+TEST(RamFileBlockCacheTest, TwoQueueRemoveFileAndFlush) {
+  const size_t block_size = 16;
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    ++calls;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  RamFileBlockCache cache(block_size, 4 * block_size, 0, fetcher,
+                          Env::Default(),
+                          RamFileBlockCache::EvictionPolicy::kTwoQueue);
+  std::vector<char> out;
+  for (int i = 0; i < 6; ++i) {
+    TF_EXPECT_OK(ReadCache(&cache, "a", i * block_size, 1, &out));
+  }
+  EXPECT_EQ(6, calls);
+  EXPECT_LE(cache.CacheSize(), 4 * block_size);
+  cache.RemoveFile("a");
+  EXPECT_EQ(0, cache.CacheSize());
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 1, &out));
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 1, &out));
+  EXPECT_EQ(7, calls);
+  cache.Flush();
+  EXPECT_EQ(0, cache.CacheSize());
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 1, &out));
+  EXPECT_EQ(8, calls);
+}
+
 TEST(RamFileBlockCacheTest, MaxStaleness) {
   int calls = 0;
   auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
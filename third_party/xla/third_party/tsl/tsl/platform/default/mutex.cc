@@ -17,10 +17,14 @@ limitations under the License.
 
 #include <time.h>
 
+#include <atomic>
+#include <chrono>  // NOLINT
+
 #include "nsync_cv.h"       // NOLINT
 #include "nsync_mu.h"       // NOLINT
 #include "nsync_mu_wait.h"  // NOLINT
 #include "nsync_time.h"     // NOLINT
+#include "tsl/platform/macros.h"
 
 namespace tsl {
 
@@ -36,15 +40,69 @@ static inline nsync::nsync_mu *mu_cast(internal::MuData *mu) {
   return reinterpret_cast<nsync::nsync_mu *>(mu);
 }
 
+namespace {
+
+std::atomic<MutexContentionHandler> contention_handler{nullptr};
+
+// Set while the contention handler runs on this thread, so that the
+// contention of the mutexes it acquires is not reported.
+thread_local bool in_contention_handler = false;
+
+// Returns the contention handler, unless none is installed or it is already
+// running on this thread.
+inline MutexContentionHandler GetContentionHandler() {
+  MutexContentionHandler handler =
+      contention_handler.load(std::memory_order_relaxed);
+  if (TF_PREDICT_TRUE(handler == nullptr) || in_contention_handler) {
+    return nullptr;
+  }
+  return handler;
+}
+
+void ReportContention(MutexContentionHandler handler, const mutex *mu,
+                      std::chrono::steady_clock::time_point wait_start) {
+  const auto wait = std::chrono::steady_clock::now() - wait_start;
+  in_contention_handler = true;
+  handler(mu,
+          std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+  in_contention_handler = false;
+}
+
+}  // namespace
+
+void SetMutexContentionHandler(MutexContentionHandler handler) {
+  contention_handler.store(handler, std::memory_order_relaxed);
+}
+
 mutex::mutex() { nsync::nsync_mu_init(mu_cast(&mu_)); }
 
-void mutex::lock() { nsync::nsync_mu_lock(mu_cast(&mu_)); }
+void mutex::lock() {
+  MutexContentionHandler handler = GetContentionHandler();
+  if (handler == nullptr) {
+    nsync::nsync_mu_lock(mu_cast(&mu_));
+    return;
+  }
+  if (nsync::nsync_mu_trylock(mu_cast(&mu_))) return;
+  const auto wait_start = std::chrono::steady_clock::now();
+  nsync::nsync_mu_lock(mu_cast(&mu_));
+  ReportContention(handler, this, wait_start);
+}
 
 bool mutex::try_lock() { return nsync::nsync_mu_trylock(mu_cast(&mu_)) != 0; };
 
 void mutex::unlock() { nsync::nsync_mu_unlock(mu_cast(&mu_)); }
 
-void mutex::lock_shared() { nsync::nsync_mu_rlock(mu_cast(&mu_)); }
+void mutex::lock_shared() {
+  MutexContentionHandler handler = GetContentionHandler();
+  if (handler == nullptr) {
+    nsync::nsync_mu_rlock(mu_cast(&mu_));
+    return;
+  }
+  if (nsync::nsync_mu_rtrylock(mu_cast(&mu_))) return;
+  const auto wait_start = std::chrono::steady_clock::now();
+  nsync::nsync_mu_rlock(mu_cast(&mu_));
+  ReportContention(handler, this, wait_start);
+}
 
 bool mutex::try_lock_shared() {
   return nsync::nsync_mu_rtrylock(mu_cast(&mu_)) != 0;
@@ -97,6 +97,19 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  Status ReadAhead(uint64 offset, size_t n) const override {
+#if defined(__linux__)
+    // Queues asynchronous reads of the range into the page cache, so the
+    // device keeps working while the caller consumes the current buffer.
+    int err = posix_fadvise(fd_, static_cast<off_t>(offset),
+                            static_cast<off_t>(n), POSIX_FADV_WILLNEED);
+    if (err != 0) {
+      return IOError(filename_, err);
+    }
+#endif
+    return OkStatus();
+  }
+
 #if defined(TF_CORD_SUPPORT)
   Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
@@ -149,6 +149,17 @@ class Condition {
   static bool ReturnBool(const Condition* cond);  // access *(bool *)arg_
 };
 
+// Called by a thread that had to wait `wait_ns` nanoseconds to acquire `mu` in
+// lock() or lock_shared(), once it holds `mu`. The handler must not acquire
+// `mu`, and its own mutexes are acquired without reporting their contention.
+typedef void (*MutexContentionHandler)(const mutex* mu, uint64 wait_ns);
+
+// Installs `handler` to be called on each contended acquisition of a mutex, or
+// stops profiling the contention if `handler` is null. While no handler is
+// installed, the profiling costs a relaxed atomic load per acquisition.
+// See tsl/profiler/lib/mutex_contention.h for the default handler.
+void SetMutexContentionHandler(MutexContentionHandler handler);
+
 // Mimic a subset of the std::unique_lock<tsl::mutex> functionality.
 class TF_SCOPED_LOCKABLE mutex_lock {
  public:
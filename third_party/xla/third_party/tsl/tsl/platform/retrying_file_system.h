@@ -190,6 +190,10 @@ class RetryingRandomAccessFile : public RandomAccessFile {
         retry_config_);
   }
 
+  Status ReadAhead(uint64 offset, size_t n) const override {
+    return base_file_->ReadAhead(offset, n);
+  }
+
  private:
   std::unique_ptr<RandomAccessFile> base_file_;
   const RetryConfig retry_config_;
@@ -18,6 +18,7 @@ limitations under the License.
 // the --benchmark_filter flag which specifies which benchmarks to run,
 // we will either run benchmarks or run the gtest tests in the program.
 
+#include <cstdlib>
 #include <string>
 
 #include "absl/strings/match.h"
@@ -25,6 +26,8 @@ limitations under the License.
 #include "tsl/platform/stacktrace_handler.h"
 #include "tsl/platform/test.h"
 #include "tsl/platform/test_benchmark.h"
+#include "tsl/util/benchmark_reporter.h"
+#include "tsl/util/reporter.h"
 
 GTEST_API_ int main(int argc, char** argv) {
   tsl::testing::InstallStacktraceHandler();
@@ -40,7 +43,13 @@ GTEST_API_ int main(int argc, char** argv) {
       // facility, which is not known to absl flags.
       // FIXME(vyng): Fix this mess once we make benchmark use absl flags
       testing::InitGoogleTest(&argc, argv);
-      ::benchmark::RunSpecifiedBenchmarks();
+      if (std::getenv(tsl::TestReporter::kTestReporterEnv) != nullptr) {
+        // Also write the results as test_log.proto BenchmarkEntries.
+        tsl::TestLogBenchmarkReporter reporter;
+        ::benchmark::RunSpecifiedBenchmarks(&reporter);
+      } else {
+        ::benchmark::RunSpecifiedBenchmarks();
+      }
       return 0;
     }
   }
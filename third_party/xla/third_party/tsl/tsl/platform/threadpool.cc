@@ -17,6 +17,12 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tsl/platform/blocking_counter.h"
@@ -95,6 +101,74 @@ struct EigenEnvironment {
   }
 };
 
+namespace {
+
+// Schedules the work on the threads [start, limit) of "pool".
+class ThreadRangePool : public Eigen::ThreadPoolInterface {
+ public:
+  ThreadRangePool(Eigen::ThreadPoolInterface* pool, int start, int limit)
+      : pool_(pool), start_(start), limit_(limit) {}
+
+  void Schedule(std::function<void()> fn) override {
+    pool_->ScheduleWithHint(std::move(fn), start_, limit_);
+  }
+
+  void ScheduleWithHint(std::function<void()> fn, int start,
+                        int limit) override {
+    pool_->ScheduleWithHint(std::move(fn), start_ + start,
+                            std::min(start_ + limit, limit_));
+  }
+
+  int NumThreads() const override { return limit_ - start_; }
+
+  int CurrentThreadId() const override {
+    const int id = pool_->CurrentThreadId();
+    return id >= start_ && id < limit_ ? id - start_ : -1;
+  }
+
+ private:
+  Eigen::ThreadPoolInterface* const pool_;
+  const int start_;
+  const int limit_;
+};
+
+// Schedules the work on the threads of "pool" that are not reserved, which
+// are all of them but the first "num_reserved_workers".
+class UnreservedThreadPool : public Eigen::ThreadPoolInterface {
+ public:
+  UnreservedThreadPool(Eigen::ThreadPoolInterface* pool,
+                       const std::atomic<int>* num_reserved_workers)
+      : pool_(pool), num_reserved_workers_(num_reserved_workers) {}
+
+  void Schedule(std::function<void()> fn) override {
+    const int num_reserved_workers =
+        num_reserved_workers_->load(std::memory_order_relaxed);
+    if (num_reserved_workers == 0) {
+      pool_->Schedule(std::move(fn));
+    } else {
+      pool_->ScheduleWithHint(std::move(fn), num_reserved_workers,
+                              pool_->NumThreads());
+    }
+  }
+
+  void ScheduleWithHint(std::function<void()> fn, int start,
+                        int limit) override {
+    pool_->ScheduleWithHint(std::move(fn), start, limit);
+  }
+
+  void Cancel() override { pool_->Cancel(); }
+
+  int NumThreads() const override { return pool_->NumThreads(); }
+
+  int CurrentThreadId() const override { return pool_->CurrentThreadId(); }
+
+ private:
+  Eigen::ThreadPoolInterface* const pool_;
+  const std::atomic<int>* const num_reserved_workers_;
+};
+
+}  // namespace
+
 ThreadPool::ThreadPool(Env* env, const string& name, int num_threads)
     : ThreadPool(env, ThreadOptions(), name, num_threads, true, nullptr) {}
 
@@ -116,7 +190,9 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
       EigenEnvironment(env, thread_options, "tf_" + name)));
-  underlying_threadpool_ = eigen_threadpool_.get();
+  unreserved_threadpool_ = std::make_unique<UnreservedThreadPool>(
+      eigen_threadpool_.get(), &num_reserved_workers_);
+  underlying_threadpool_ = unreserved_threadpool_.get();
   threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
                                                        num_threads, allocator));
 }
@@ -277,9 +353,70 @@ void ThreadPool::SetStealPartitions(
   // constructor that does not take user_threadpool. Thus we assume
   // eigen_threadpool_ is not null here.
   DCHECK(eigen_threadpool_ != nullptr);
+  {
+    mutex_lock l(reservation_mu_);
+    DCHECK(!has_reservation_);
+    has_steal_partitions_ = true;
+  }
   eigen_threadpool_->SetStealPartitions(partitions);
 }
 
+std::unique_ptr<ThreadPool::WorkerReservation> ThreadPool::ReserveWorkers(
+    int num_workers) {
+  if (eigen_threadpool_ == nullptr) return nullptr;
+  const int num_threads = eigen_threadpool_->NumThreads();
+  if (num_workers < 1 || num_workers >= num_threads) return nullptr;
+  {
+    mutex_lock l(reservation_mu_);
+    if (has_reservation_ || has_steal_partitions_) return nullptr;
+    has_reservation_ = true;
+  }
+  // Makes the reserved threads, and the other threads, look for work among
+  // themselves before stealing it from the whole pool.
+  const unsigned reserved = num_workers;
+  const unsigned all = num_threads;
+  std::vector<std::pair<unsigned, unsigned>> partitions(num_threads);
+  for (unsigned i = 0; i < all; ++i) {
+    partitions[i] = i < reserved ? std::make_pair(0u, reserved)
+                                 : std::make_pair(reserved, all);
+  }
+  eigen_threadpool_->SetStealPartitions(partitions);
+  num_reserved_workers_.store(num_workers, std::memory_order_relaxed);
+  return std::unique_ptr<WorkerReservation>(
+      new WorkerReservation(this, num_workers));
+}
+
+void ThreadPool::ReleaseWorkers() {
+  const unsigned num_threads = eigen_threadpool_->NumThreads();
+  num_reserved_workers_.store(0, std::memory_order_relaxed);
+  eigen_threadpool_->SetStealPartitions(
+      std::vector<std::pair<unsigned, unsigned>>(
+          num_threads, std::make_pair(0u, num_threads)));
+  mutex_lock l(reservation_mu_);
+  has_reservation_ = false;
+}
+
+ThreadPool::WorkerReservation::WorkerReservation(ThreadPool* pool,
+                                                 int num_workers)
+    : pool_(pool),
+      num_workers_(num_workers),
+      reserved_threadpool_(std::make_unique<ThreadRangePool>(
+          pool->eigen_threadpool_.get(), 0, num_workers)),
+      threadpool_device_(std::make_unique<Eigen::ThreadPoolDevice>(
+          reserved_threadpool_.get(), num_workers)) {}
+
+ThreadPool::WorkerReservation::~WorkerReservation() { pool_->ReleaseWorkers(); }
+
+void ThreadPool::WorkerReservation::ParallelFor(
+    int64_t total, int64_t cost_per_unit,
+    const std::function<void(int64_t, int64_t)>& fn) {
+  CHECK_GE(total, 0);
+  CHECK_EQ(total, (int64_t)(Eigen::Index)total);
+  threadpool_device_->parallelFor(
+      total, Eigen::TensorOpCost(0, 0, cost_per_unit),
+      [&fn](Eigen::Index first, Eigen::Index last) { fn(first, last); });
+}
+
 Eigen::ThreadPoolInterface* ThreadPool::AsEigenThreadPool() const {
   DCHECK(underlying_threadpool_ != nullptr);
   return underlying_threadpool_;
@@ -16,12 +16,15 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_THREADPOOL_H_
 #define TENSORFLOW_TSL_PLATFORM_THREADPOOL_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 
 #include "absl/types/optional.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/macros.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
 #include "tsl/platform/threadpool_interface.h"
 #include "tsl/platform/types.h"
 
@@ -99,6 +102,42 @@ class ThreadPool {
     absl::optional<int64_t> block_size_;
   };
 
+  // A reservation of some of the threads of a pool for latency-critical work,
+  // e.g. the intra-op shards of a high-priority request, made by
+  // ReserveWorkers(). While it is held, the work scheduled through the
+  // reservation is queued on the reserved threads, which look for work among
+  // themselves first, and all other work scheduled through the pool, including
+  // the shards of its ParallelFor calls, is queued on the other threads.
+  //
+  // The reservation is best effort: idle threads still steal queued work from
+  // the whole pool, so that no work is starved, and work queued before the
+  // reservation was made may still run on the reserved threads.
+  class WorkerReservation {
+   public:
+    // Releases the reserved threads back to the pool.
+    ~WorkerReservation();
+
+    // Returns the number of reserved threads.
+    int NumWorkers() const { return num_workers_; }
+
+    // Same as ThreadPool::ParallelFor, but the shards are scheduled on the
+    // reserved threads.
+    void ParallelFor(int64_t total, int64_t cost_per_unit,
+                     const std::function<void(int64_t, int64_t)>& fn);
+
+   private:
+    friend class ThreadPool;
+
+    WorkerReservation(ThreadPool* pool, int num_workers);
+
+    ThreadPool* const pool_;
+    const int num_workers_;
+    std::unique_ptr<Eigen::ThreadPoolInterface> reserved_threadpool_;
+    std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
+    WorkerReservation(const WorkerReservation&) = delete;
+    void operator=(const WorkerReservation&) = delete;
+  };
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
   // given ThreadOptions. If "low_latency_hint" is true the thread pool
@@ -211,6 +250,13 @@ class ThreadPool {
   // thread in the pool. Returns -1 otherwise.
   int CurrentThreadId() const;
 
+  // Reserves "num_workers" threads of the pool for latency-critical work until
+  // the returned reservation is destroyed; see WorkerReservation. Returns null
+  // if the pool was constructed with a user_threadpool, if "num_workers" is
+  // not in [1, NumThreads()), or if the pool already has a reservation or
+  // steal partitions, in which case the caller should use ParallelFor instead.
+  std::unique_ptr<WorkerReservation> ReserveWorkers(int num_workers);
+
   // If ThreadPool implementation is compatible with Eigen::ThreadPoolInterface,
   // returns a non-null pointer. The caller does not own the object the returned
   // pointer points to, and should not attempt to delete.
@@ -228,12 +274,25 @@ class ThreadPool {
       const int64_t total, const int64_t block_size,
       const std::function<void(int64_t, int64_t)>& fn);
 
+  // Releases the threads reserved by ReserveWorkers().
+  void ReleaseWorkers();
+
+  // The number of threads reserved by ReserveWorkers(), which are the first
+  // ones of eigen_threadpool_.
+  std::atomic<int> num_reserved_workers_{0};
+  mutex reservation_mu_;
+  bool has_reservation_ TF_GUARDED_BY(reservation_mu_) = false;
+  bool has_steal_partitions_ TF_GUARDED_BY(reservation_mu_) = false;
+
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
-  // provided in the constructor. Otherwise it is the eigen_threadpool_.
+  // provided in the constructor. Otherwise it is the unreserved_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
   // eigen_threadpool_ is instantiated and owned by thread::ThreadPool if
   // user_threadpool is not in the constructor.
   std::unique_ptr<Eigen::ThreadPoolTempl<EigenEnvironment>> eigen_threadpool_;
+  // Schedules the work on the threads of eigen_threadpool_ that are not
+  // reserved by ReserveWorkers().
+  std::unique_ptr<Eigen::ThreadPoolInterface> unreserved_threadpool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> threadpool_device_;
   ThreadPool(const ThreadPool&) = delete;
   void operator=(const ThreadPool&) = delete;
@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/lib/mutex_contention.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tsl/lib/monitoring/sampler.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+#include "tsl/util/env_var.h"
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tsl/profiler/backends/cpu/traceme_recorder.h"
+#include "tsl/profiler/lib/traceme.h"
+#include "tsl/profiler/lib/traceme_encode.h"
+#include "tsl/profiler/utils/time_utils.h"
+#endif
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+auto* mutex_wait_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/mutex_wait_time_usecs",
+     "Microseconds spent waiting to acquire the mutexes of the given name.",
+     "name"},
+    // Scale of 1, power of 2, max of 2^29 usecs (about 9 minutes).
+    monitoring::Buckets::Exponential(1, 2, 30));
+
+struct Registry {
+  // Names are read on every contended acquisition, and rarely written.
+  mutex names_mu;
+  absl::flat_hash_map<const mutex*, std::string> names TF_GUARDED_BY(names_mu);
+  mutex contention_mu;
+  absl::flat_hash_map<std::string, MutexContention> contention
+      TF_GUARDED_BY(contention_mu);
+};
+
+std::atomic<bool> profiling_enabled{false};
+// The size of Registry::names, so that contention is ignored without locking
+// when no mutex is named.
+std::atomic<int64_t> num_named_mutexes{0};
+
+Registry* GetRegistry() {
+  static Registry* registry = new Registry();
+  return registry;
+}
+
+void HandleContention(const mutex* mu, uint64 wait_ns) {
+  if (num_named_mutexes.load(std::memory_order_relaxed) == 0) return;
+  Registry* registry = GetRegistry();
+  // The registry mutexes are held when their own contention is reported.
+  if (mu == &registry->names_mu || mu == &registry->contention_mu) return;
+  std::string name;
+  {
+    tf_shared_lock lock(registry->names_mu);
+    const auto it = registry->names.find(mu);
+    if (it == registry->names.end()) return;
+    name = it->second;
+  }
+  {
+    mutex_lock lock(registry->contention_mu);
+    MutexContention& contention = registry->contention[name];
+    contention.name = name;
+    ++contention.num_waits;
+    contention.total_wait_ns += wait_ns;
+    contention.max_wait_ns =
+        std::max(contention.max_wait_ns, static_cast<int64_t>(wait_ns));
+  }
+  mutex_wait_time_usecs->GetCell(name)->Add(wait_ns / 1000.0);
+#if !defined(IS_MOBILE_PLATFORM)
+  if (TraceMeRecorder::Active(TraceMeLevel::kInfo)) {
+    const int64_t end_time = GetCurrentTimeNanos();
+    TraceMeRecorder::Record({TraceMeEncode("MutexWait", {{"name", name}}),
+                             end_time - static_cast<int64_t>(wait_ns),
+                             end_time});
+  }
+#endif
+}
+
+[[maybe_unused]] const bool enabled_from_env = [] {
+  bool enabled = false;
+  const Status status =
+      ReadBoolFromEnvVar("TF_MUTEX_CONTENTION_PROFILING", false, &enabled);
+  if (!status.ok()) {
+    LOG(WARNING) << status;
+  }
+  if (enabled) {
+    EnableMutexContentionProfiling();
+  }
+  return enabled;
+}();
+
+}  // namespace
+
+void SetMutexName(const mutex* mu, absl::string_view name) {
+  if (!MutexContentionProfilingEnabled()) return;
+  Registry* registry = GetRegistry();
+  mutex_lock lock(registry->names_mu);
+  if (registry->names.insert_or_assign(mu, std::string(name)).second) {
+    num_named_mutexes.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void ClearMutexName(const mutex* mu) {
+  if (num_named_mutexes.load(std::memory_order_relaxed) == 0) return;
+  Registry* registry = GetRegistry();
+  mutex_lock lock(registry->names_mu);
+  if (registry->names.erase(mu) > 0) {
+    num_named_mutexes.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void EnableMutexContentionProfiling() {
+  Registry* registry = GetRegistry();
+  {
+    mutex_lock lock(registry->contention_mu);
+    registry->contention.clear();
+  }
+  SetMutexContentionHandler(&HandleContention);
+  profiling_enabled.store(true, std::memory_order_relaxed);
+}
+
+void DisableMutexContentionProfiling() {
+  SetMutexContentionHandler(nullptr);
+  profiling_enabled.store(false, std::memory_order_relaxed);
+}
+
+bool MutexContentionProfilingEnabled() {
+  return profiling_enabled.load(std::memory_order_relaxed);
+}
+
+std::vector<MutexContention> GetMutexContention() {
+  std::vector<MutexContention> contention;
+  {
+    Registry* registry = GetRegistry();
+    mutex_lock lock(registry->contention_mu);
+    for (const auto& name_and_contention : registry->contention) {
+      contention.push_back(name_and_contention.second);
+    }
+  }
+  std::sort(contention.begin(), contention.end(),
+            [](const MutexContention& a, const MutexContention& b) {
+              return a.total_wait_ns > b.total_wait_ns;
+            });
+  return contention;
+}
+
+}  // namespace profiler
+}  // namespace tsl
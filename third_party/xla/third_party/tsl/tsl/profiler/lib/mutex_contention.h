@@ -0,0 +1,77 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_LIB_MUTEX_CONTENTION_H_
+#define TENSORFLOW_TSL_PROFILER_LIB_MUTEX_CONTENTION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tsl/platform/mutex.h"
+
+namespace tsl {
+namespace profiler {
+
+// Mutex contention profiling reports the time threads wait to acquire named
+// mutexes:
+// - as a histogram per name in the /tensorflow/core/mutex_wait_time_usecs
+//   metric;
+// - as "MutexWait" TraceMe events, at level kInfo, on the waiting threads;
+// - in GetMutexContention().
+// It is disabled by default, and enabled at startup if the environment
+// variable TF_MUTEX_CONTENTION_PROFILING is true.
+
+// Names `mu` in the contention profile. Only the contention of named mutexes
+// is reported, and mutexes with the same name, e.g. those of the instances of
+// a class, are reported together. `mu` must not be the mutex of a metric or of
+// the TraceMe recorder.
+//
+// Does nothing unless the profiling is enabled, so that naming mutexes costs
+// nothing otherwise. The mutexes of long-lived objects are thus only named if
+// the profiling is enabled when they are constructed, e.g. at startup with
+// TF_MUTEX_CONTENTION_PROFILING.
+void SetMutexName(const mutex* mu, absl::string_view name);
+
+// Removes the name of `mu`, if it has one. Must be called before a named mutex
+// is destroyed.
+void ClearMutexName(const mutex* mu);
+
+// Starts profiling the contention of the named mutexes, and clears the
+// contention returned by GetMutexContention().
+void EnableMutexContentionProfiling();
+
+// Stops profiling the contention of the mutexes.
+void DisableMutexContentionProfiling();
+
+// Returns whether the contention of the named mutexes is profiled.
+bool MutexContentionProfilingEnabled();
+
+// The contention of the mutexes of a name.
+struct MutexContention {
+  std::string name;
+  int64_t num_waits = 0;
+  int64_t total_wait_ns = 0;
+  int64_t max_wait_ns = 0;
+};
+
+// Returns the contention of each name since the profiling was enabled, by
+// decreasing total wait time.
+std::vector<MutexContention> GetMutexContention();
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_LIB_MUTEX_CONTENTION_H_
@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/lib/mutex_contention.h"
+
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+// Returns the contention of `name`, or of an empty name if it has none.
+MutexContention GetContention(absl::string_view name) {
+  for (const MutexContention& contention : GetMutexContention()) {
+    if (contention.name == name) return contention;
+  }
+  return MutexContention();
+}
+
+// Makes another thread wait for `mu` until the contention of `name` is
+// reported, or a few attempts failed because the thread did not block.
+void Contend(mutex& mu, absl::string_view name) {
+  for (int attempt = 0; attempt < 10; ++attempt) {
+    mu.lock();
+    std::unique_ptr<Thread> thread(Env::Default()->StartThread(
+        ThreadOptions(), "contend", [&mu] { mutex_lock lock(mu); }));
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+    mu.unlock();
+    thread.reset();
+    if (GetContention(name).num_waits > 0) return;
+  }
+}
+
+TEST(MutexContentionTest, ReportsNamedMutexes) {
+  mutex named;
+  mutex unnamed;
+  EnableMutexContentionProfiling();
+  SetMutexName(&named, "named");
+
+  Contend(named, "named");
+  Contend(unnamed, "");
+  const MutexContention contention = GetContention("named");
+  EXPECT_EQ(contention.name, "named");
+  EXPECT_GE(contention.num_waits, 1);
+  EXPECT_GT(contention.total_wait_ns, 0);
+  EXPECT_GE(contention.total_wait_ns, contention.max_wait_ns);
+  for (const MutexContention& other : GetMutexContention()) {
+    EXPECT_NE(other.name, "");
+  }
+
+  DisableMutexContentionProfiling();
+  const int64_t num_waits = GetContention("named").num_waits;
+  Contend(named, "named");
+  EXPECT_EQ(GetContention("named").num_waits, num_waits);
+  ClearMutexName(&named);
+}
+
+TEST(MutexContentionTest, RanksByTotalWaitTime) {
+  mutex short_waits;
+  mutex long_waits;
+  EnableMutexContentionProfiling();
+  SetMutexName(&short_waits, "short_waits");
+  SetMutexName(&long_waits, "long_waits");
+
+  Contend(short_waits, "short_waits");
+  for (int i = 0; i < 3; ++i) {
+    Contend(long_waits, "long_waits");
+  }
+  const std::vector<MutexContention> contention = GetMutexContention();
+  ASSERT_EQ(contention.size(), 2);
+  EXPECT_GE(contention[0].total_wait_ns, contention[1].total_wait_ns);
+
+  DisableMutexContentionProfiling();
+  ClearMutexName(&short_waits);
+  ClearMutexName(&long_waits);
+}
+
+TEST(MutexContentionTest, DoesNotNameMutexesWhileDisabled) {
+  mutex mu;
+  SetMutexName(&mu, "named_while_disabled");
+  EnableMutexContentionProfiling();
+
+  Contend(mu, "named_while_disabled");
+  EXPECT_EQ(GetContention("named_while_disabled").num_waits, 0);
+
+  DisableMutexContentionProfiling();
+  ClearMutexName(&mu);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
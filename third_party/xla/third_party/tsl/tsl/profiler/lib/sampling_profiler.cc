@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/lib/sampling_profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/status.h"
+#include "tsl/profiler/lib/profiler_lock.h"
+#include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+#include "tsl/profiler/utils/tf_xplane_visitor.h"
+#include "tsl/profiler/utils/time_utils.h"
+#include "tsl/profiler/utils/xplane_schema.h"
+#include "tsl/profiler/utils/xplane_visitor.h"
+
+namespace tsl {
+namespace profiler {
+
+/*static*/ tensorflow::ProfileOptions
+SamplingProfiler::DefaultProfileOptions() {
+  tensorflow::ProfileOptions options = ProfilerSession::DefaultOptions();
+  options.set_host_tracer_level(1);
+  options.set_enable_hlo_proto(false);
+  options.set_include_dataset_ops(false);
+  return options;
+}
+
+/*static*/ SamplingProfiler* SamplingProfiler::Get() {
+  static SamplingProfiler* profiler = new SamplingProfiler();
+  return profiler;
+}
+
+void SamplingProfiler::Enable(const Options& options) {
+  mutex_lock lock(mutex_);
+  options_ = options;
+  options_.sample_every_n_steps =
+      std::max<int64_t>(options_.sample_every_n_steps, 1);
+  options_.max_sampled_steps = std::max<int64_t>(options_.max_sampled_steps, 1);
+  if (!options_.profile_options.has_value()) {
+    options_.profile_options = DefaultProfileOptions();
+  }
+  steps_since_sample_ = 0;
+  next_sample_time_ns_ = 0;
+  sampled_steps_.clear();
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::Disable() {
+  mutex_lock lock(mutex_);
+  enabled_.store(false, std::memory_order_relaxed);
+  session_.reset();
+}
+
+void SamplingProfiler::StepBegin(int64_t step_id) {
+  if (!enabled()) return;
+  mutex_lock lock(mutex_);
+  if (session_ != nullptr) return;  // Unbalanced StepBegin.
+  if (++steps_since_sample_ < options_.sample_every_n_steps) return;
+  const int64_t begin_ns = GetCurrentTimeNanos();
+  if (begin_ns < next_sample_time_ns_ || ProfilerLock::HasActiveSession()) {
+    return;
+  }
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(*options_.profile_options);
+  if (!session->Status().ok()) return;
+  session_ = std::move(session);
+  steps_since_sample_ = 0;
+  current_step_ = SampledStep();
+  current_step_.step_id = step_id;
+  current_step_.start_time_ns = GetCurrentTimeNanos();
+  current_step_cost_ns_ = current_step_.start_time_ns - begin_ns;
+}
+
+void SamplingProfiler::StepEnd() {
+  if (!enabled()) return;
+  mutex_lock lock(mutex_);
+  if (session_ == nullptr) return;
+  const int64_t end_ns = GetCurrentTimeNanos();
+  current_step_.duration_ns = end_ns - current_step_.start_time_ns;
+
+  tensorflow::profiler::XSpace space;
+  Status status = session_->CollectData(&space);
+  session_.reset();
+  if (!status.ok()) {
+    VLOG(1) << "Failed to collect a sampled step: " << status;
+    return;
+  }
+  current_step_.events = SummarizeEvents(space, options_.max_events_per_step);
+  sampled_steps_.push_back(std::move(current_step_));
+  while (sampled_steps_.size() >
+         static_cast<size_t>(options_.max_sampled_steps)) {
+    sampled_steps_.pop_front();
+  }
+
+  // Wait long enough before the next sample for the cost of this one to stay
+  // under the maximum overhead.
+  const int64_t now_ns = GetCurrentTimeNanos();
+  current_step_cost_ns_ += now_ns - end_ns;
+  next_sample_time_ns_ =
+      now_ns + static_cast<int64_t>(current_step_cost_ns_ /
+                                    std::max(options_.max_overhead, 1e-6));
+}
+
+std::vector<SampledStep> SamplingProfiler::GetSampledSteps() const {
+  mutex_lock lock(mutex_);
+  return std::vector<SampledStep>(sampled_steps_.begin(),
+                                  sampled_steps_.end());
+}
+
+std::string SamplingProfiler::DebugString() const {
+  std::string out;
+  for (const SampledStep& step : GetSampledSteps()) {
+    absl::StrAppendFormat(&out, "Step %d at %d ns: %.3f ms\n", step.step_id,
+                          step.start_time_ns, step.duration_ns / 1e6);
+    for (const SampledEvent& event : step.events) {
+      absl::StrAppendFormat(&out, "  %s %s x%d: %.3f ms, %d bytes\n",
+                            event.device, event.name, event.occurrences,
+                            event.duration_ps / 1e9, event.bytes_allocated);
+    }
+  }
+  return out;
+}
+
+/*static*/ std::vector<SampledEvent> SamplingProfiler::SummarizeEvents(
+    const tensorflow::profiler::XSpace& space, int64_t max_events) {
+  std::vector<SampledEvent> events;
+  for (const tensorflow::profiler::XPlane& raw_plane : space.planes()) {
+    XPlaneVisitor plane = CreateTfXPlaneVisitor(&raw_plane);
+    absl::flat_hash_map<absl::string_view, SampledEvent> events_by_name;
+    plane.ForEachLine([&](const XLineVisitor& line) {
+      line.ForEachEvent([&](const XEventVisitor& event) {
+        SampledEvent& sampled = events_by_name[event.Name()];
+        ++sampled.occurrences;
+        sampled.duration_ps += event.DurationPs();
+        if (auto stat = event.GetStat(StatType::kBytesAllocated)) {
+          sampled.bytes_allocated += stat->IntOrUintValue();
+        }
+      });
+    });
+    for (auto& [name, sampled] : events_by_name) {
+      sampled.device = std::string(plane.Name());
+      sampled.name = std::string(name);
+      events.push_back(std::move(sampled));
+    }
+  }
+  auto longer = [](const SampledEvent& a, const SampledEvent& b) {
+    return a.duration_ps > b.duration_ps;
+  };
+  if (max_events >= 0 && events.size() > static_cast<size_t>(max_events)) {
+    std::partial_sort(events.begin(), events.begin() + max_events,
+                      events.end(), longer);
+    events.resize(max_events);
+  } else {
+    std::sort(events.begin(), events.end(), longer);
+  }
+  return events;
+}
+
+}  // namespace profiler
+}  // namespace tsl
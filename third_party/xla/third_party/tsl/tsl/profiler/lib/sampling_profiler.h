@@ -0,0 +1,146 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_LIB_SAMPLING_PROFILER_H_
+#define TENSORFLOW_TSL_PROFILER_LIB_SAMPLING_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tsl {
+namespace profiler {
+
+// The events of the same name on the same device (XPlane) during a sampled
+// step.
+struct SampledEvent {
+  std::string device;
+  std::string name;
+  int64_t occurrences = 0;
+  int64_t duration_ps = 0;
+  int64_t bytes_allocated = 0;
+};
+
+// A sampled step, with its most expensive events.
+struct SampledStep {
+  int64_t step_id = 0;
+  int64_t start_time_ns = 0;
+  int64_t duration_ns = 0;
+  std::vector<SampledEvent> events;
+};
+
+// SamplingProfiler profiles every Nth step of a program, e.g. of a training or
+// serving loop, and keeps a compact summary of the last sampled steps in a ring
+// buffer, so that a profile of recent steps is available at any time without
+// an on-demand profiling session, e.g. through the Monitor RPC of the
+// ProfilerService.
+//
+// A step is only sampled once the time since the previous sample covers the
+// cost of that sample (starting and collecting the profiling session and
+// summarizing its events) divided by `max_overhead`, which bounds the overhead
+// whatever the step time is. Steps are never sampled while another profiling
+// session is active.
+//
+// Thread-safety: SamplingProfiler is thread-safe, but the steps are expected to
+// be delimited by a single thread.
+class SamplingProfiler {
+ public:
+  struct Options {
+    // Samples at most one of every `sample_every_n_steps` steps.
+    int64_t sample_every_n_steps = 100;
+    // The number of sampled steps kept in the ring buffer.
+    int64_t max_sampled_steps = 16;
+    // The number of events, in decreasing duration, kept of each sampled step.
+    int64_t max_events_per_step = 64;
+    // The maximum fraction of the wall time spent sampling.
+    double max_overhead = 0.01;
+    // The options of the profiling sessions of the sampled steps, or
+    // DefaultProfileOptions() if unset.
+    std::optional<tensorflow::ProfileOptions> profile_options;
+  };
+
+  // Lightweight tracing only: TraceMe level 1 and device activity.
+  static tensorflow::ProfileOptions DefaultProfileOptions();
+
+  // Returns the process-wide sampling profiler, which is disabled until
+  // Enable() is called.
+  static SamplingProfiler* Get();
+
+  SamplingProfiler() = default;
+
+  // Starts sampling the subsequent steps, and clears the sampled steps.
+  void Enable(const Options& options) TF_LOCKS_EXCLUDED(mutex_);
+
+  // Stops sampling the steps. The sampled steps are kept.
+  void Disable() TF_LOCKS_EXCLUDED(mutex_);
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  // Delimit a step. Steps are sampled between these calls.
+  void StepBegin(int64_t step_id) TF_LOCKS_EXCLUDED(mutex_);
+  void StepEnd() TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the sampled steps, from the oldest to the newest.
+  std::vector<SampledStep> GetSampledSteps() const TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns a human-readable summary of the sampled steps.
+  std::string DebugString() const TF_LOCKS_EXCLUDED(mutex_);
+
+  // Summarizes the events of `space` with their durations and allocated bytes
+  // aggregated per device and name, keeping the `max_events` longest ones.
+  static std::vector<SampledEvent> SummarizeEvents(
+      const tensorflow::profiler::XSpace& space, int64_t max_events);
+
+  // Delimits a step of the process-wide sampling profiler.
+  class ScopedStep {
+   public:
+    explicit ScopedStep(int64_t step_id) { Get()->StepBegin(step_id); }
+    ~ScopedStep() { Get()->StepEnd(); }
+
+    ScopedStep(const ScopedStep&) = delete;
+    ScopedStep& operator=(const ScopedStep&) = delete;
+  };
+
+ private:
+  SamplingProfiler(const SamplingProfiler&) = delete;
+  SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+  std::atomic<bool> enabled_ = false;
+
+  mutable mutex mutex_;
+  Options options_ TF_GUARDED_BY(mutex_);
+  int64_t steps_since_sample_ TF_GUARDED_BY(mutex_) = 0;
+  // The earliest time at which the next step may be sampled.
+  int64_t next_sample_time_ns_ TF_GUARDED_BY(mutex_) = 0;
+  // The profiling session of the current step, if sampled.
+  std::unique_ptr<ProfilerSession> session_ TF_GUARDED_BY(mutex_);
+  SampledStep current_step_ TF_GUARDED_BY(mutex_);
+  int64_t current_step_cost_ns_ TF_GUARDED_BY(mutex_) = 0;
+  std::deque<SampledStep> sampled_steps_ TF_GUARDED_BY(mutex_);
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_LIB_SAMPLING_PROFILER_H_
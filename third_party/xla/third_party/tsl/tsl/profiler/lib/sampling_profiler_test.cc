@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tsl/profiler/lib/sampling_profiler.h"
+
+#include <vector>
+
+#include "tsl/platform/test.h"
+#include "tsl/profiler/lib/profiler_lock.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+#include "tsl/profiler/utils/xplane_builder.h"
+#include "tsl/profiler/utils/xplane_schema.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+using tensorflow::profiler::XSpace;
+
+TEST(SamplingProfilerTest, SummarizeEventsAggregatesAndKeepsLongest) {
+  XSpace space;
+  XPlaneBuilder plane(space.add_planes());
+  plane.SetName("/device:GPU:0");
+  XLineBuilder line = plane.GetOrCreateLine(0);
+  const XStatMetadata& bytes_allocated =
+      *plane.GetOrCreateStatMetadata(GetStatTypeStr(StatType::kBytesAllocated));
+  auto add_event = [&](const char* name, int64_t duration_ps, int64_t bytes) {
+    XEventBuilder event = line.AddEvent(*plane.GetOrCreateEventMetadata(name));
+    event.SetDurationPs(duration_ps);
+    event.AddStatValue(bytes_allocated, bytes);
+  };
+  add_event("MatMul", 300, 16);
+  add_event("Add", 100, 0);
+  add_event("MatMul", 200, 8);
+  add_event("Relu", 50, 0);
+
+  std::vector<SampledEvent> events =
+      SamplingProfiler::SummarizeEvents(space, /*max_events=*/2);
+  ASSERT_EQ(events.size(), 2);
+  EXPECT_EQ(events[0].device, "/device:GPU:0");
+  EXPECT_EQ(events[0].name, "MatMul");
+  EXPECT_EQ(events[0].occurrences, 2);
+  EXPECT_EQ(events[0].duration_ps, 500);
+  EXPECT_EQ(events[0].bytes_allocated, 24);
+  EXPECT_EQ(events[1].name, "Add");
+}
+
+TEST(SamplingProfilerTest, SamplesEveryNthStepIntoRingBuffer) {
+  SamplingProfiler profiler;
+  SamplingProfiler::Options options;
+  options.sample_every_n_steps = 2;
+  options.max_sampled_steps = 2;
+  options.max_overhead = 1e6;  // Don't wait between the samples.
+  profiler.Enable(options);
+  for (int64_t step_id = 1; step_id <= 8; ++step_id) {
+    profiler.StepBegin(step_id);
+    profiler.StepEnd();
+  }
+  std::vector<SampledStep> steps = profiler.GetSampledSteps();
+  ASSERT_EQ(steps.size(), 2);
+  EXPECT_EQ(steps[0].step_id, 6);
+  EXPECT_EQ(steps[1].step_id, 8);
+  EXPECT_FALSE(ProfilerLock::HasActiveSession());
+}
+
+TEST(SamplingProfilerTest, SkipsStepsDuringOtherSessions) {
+  SamplingProfiler profiler;
+  SamplingProfiler::Options options;
+  options.sample_every_n_steps = 1;
+  profiler.Enable(options);
+  {
+    StatusOr<ProfilerLock> lock = ProfilerLock::Acquire();
+    ASSERT_TRUE(lock.ok());
+    profiler.StepBegin(1);
+    profiler.StepEnd();
+  }
+  EXPECT_TRUE(profiler.GetSampledSteps().empty());
+
+  profiler.Disable();
+  profiler.StepBegin(2);
+  profiler.StepEnd();
+  EXPECT_TRUE(profiler.GetSampledSteps().empty());
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
@@ -28,6 +28,7 @@ limitations under the License.
 #include "tsl/platform/mutex.h"
 #include "tsl/platform/status.h"
 #include "tsl/profiler/lib/profiler_session.h"
+#include "tsl/profiler/lib/sampling_profiler.h"
 #include "tsl/profiler/protobuf/profiler_service.grpc.pb.h"
 #include "tsl/profiler/protobuf/profiler_service.pb.h"
 #include "tsl/profiler/protobuf/xplane.pb.h"
@@ -68,7 +69,14 @@ class ProfilerServiceImpl : public tensorflow::grpc::ProfilerService::Service {
  public:
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    // Report the steps sampled by the process-wide sampling profiler, if any.
+    SamplingProfiler* sampling_profiler = SamplingProfiler::Get();
+    if (!sampling_profiler->enabled()) {
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                            "The sampling profiler is not enabled.");
+    }
+    response->set_data(sampling_profiler->DebugString());
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
@@ -53,6 +53,8 @@ TF_CONST_INIT extern const absl::string_view kCuptiDriverApiPlaneName;
 TF_CONST_INIT extern const absl::string_view kRoctracerApiPlaneName;
 // Name of XPlane that contains profile metadata such as XLA debug info.
 TF_CONST_INIT extern const absl::string_view kMetadataPlaneName;
+// Name of XPlane that contains the allocations recorded by MemoryTimeline.
+TF_CONST_INIT extern const absl::string_view kMemoryTimelinePlaneName;
 // Name of XPlane that contains kpi related metrics.
 TF_CONST_INIT extern const absl::string_view kTFStreamzPlaneName;
 // Name of XPlane that contains events from python tracer.
@@ -0,0 +1,90 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/util/benchmark_reporter.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/status.h"
+#include "tsl/util/reporter.h"
+
+namespace tsl {
+namespace {
+
+std::string GetReportFilePrefix() {
+  const char* prefix = std::getenv(TestReporter::kTestReporterEnv);
+  return prefix != nullptr ? prefix : "";
+}
+
+// Writes `run` with `reporter`, which is initialized.
+Status WriteRun(const ::benchmark::BenchmarkReporter::Run& run,
+                TestReporter& reporter) {
+  const double multiplier = ::benchmark::GetTimeUnitMultiplier(run.time_unit);
+  const int64_t iters = run.iterations;
+  double throughput = 0;
+  for (const auto& [name, counter] : run.counters) {
+    if (name == "bytes_per_second") {
+      throughput = counter.value;
+    } else {
+      TF_RETURN_IF_ERROR(reporter.AddMetric(name, counter.value));
+    }
+  }
+  TF_RETURN_IF_ERROR(
+      reporter.Benchmark(iters, run.GetAdjustedCPUTime() * iters / multiplier,
+                         run.GetAdjustedRealTime() * iters / multiplier,
+                         throughput));
+  if (!run.report_label.empty()) {
+    TF_RETURN_IF_ERROR(reporter.SetProperty("label", run.report_label));
+  }
+  return reporter.Close();
+}
+
+}  // namespace
+
+TestLogBenchmarkReporter::TestLogBenchmarkReporter()
+    : TestLogBenchmarkReporter(GetReportFilePrefix()) {}
+
+TestLogBenchmarkReporter::TestLogBenchmarkReporter(std::string fname_prefix)
+    : fname_prefix_(std::move(fname_prefix)) {}
+
+void TestLogBenchmarkReporter::ReportRuns(const std::vector<Run>& runs) {
+  ConsoleReporter::ReportRuns(runs);
+  if (fname_prefix_.empty()) return;
+  for (const Run& run : runs) {
+    // Aggregates, e.g. the mean of repetitions, are derived from the runs.
+    if (run.error_occurred || run.run_type != Run::RT_Iteration) continue;
+    // Each repetition of a benchmark gets its own file.
+    std::string name = run.benchmark_name();
+    if (run.repetitions > 1) {
+      absl::StrAppend(&name, "/repetition:", run.repetition_index);
+    }
+    TestReporter reporter(fname_prefix_, name);
+    Status status = reporter.Initialize();
+    if (status.ok()) status = WriteRun(run, reporter);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to write the results of " << name << ": "
+                 << status;
+    }
+  }
+}
+
+}  // namespace tsl
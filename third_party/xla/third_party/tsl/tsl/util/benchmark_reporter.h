@@ -0,0 +1,50 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_UTIL_BENCHMARK_REPORTER_H_
+#define TENSORFLOW_TSL_UTIL_BENCHMARK_REPORTER_H_
+
+#include <string>
+#include <vector>
+
+#include "tsl/platform/test_benchmark.h"
+
+namespace tsl {
+
+// A benchmark reporter which, in addition to printing the results to the
+// console, writes each benchmark run as a BenchmarkEntries proto of
+// test_log.proto, with TestReporter, so that the results of benchmark targets
+// are machine-readable and can be tracked across releases, e.g. with
+// tensorflow/tools/test/run_and_gather_logs.
+//
+// The runs are written to files prefixed by `fname_prefix`, which defaults to
+// the TEST_REPORT_FILE_PREFIX environment variable. Nothing is written if it
+// is empty. The wall and CPU times are in seconds per iteration; the user
+// counters, e.g. items_per_second, are written as metrics and
+// bytes_per_second as the throughput.
+class TestLogBenchmarkReporter : public ::benchmark::ConsoleReporter {
+ public:
+  TestLogBenchmarkReporter();
+  explicit TestLogBenchmarkReporter(std::string fname_prefix);
+
+  void ReportRuns(const std::vector<Run>& runs) override;
+
+ private:
+  const std::string fname_prefix_;
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_UTIL_BENCHMARK_REPORTER_H_
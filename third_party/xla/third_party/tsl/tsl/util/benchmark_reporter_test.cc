@@ -0,0 +1,67 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/util/benchmark_reporter.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+#include "tsl/protobuf/test_log.pb.h"
+
+namespace tsl {
+namespace {
+
+TEST(TestLogBenchmarkReporterTest, WritesRunsAsBenchmarkEntries) {
+  const std::string prefix =
+      io::JoinPath(testing::TmpDir(), "benchmark_reporter_");
+  TestLogBenchmarkReporter reporter(prefix);
+
+  ::benchmark::BenchmarkReporter::Run run;
+  run.run_name.function_name = "BM_Foo";
+  run.run_name.args = "8";
+  run.iterations = 100;
+  run.time_unit = ::benchmark::kMicrosecond;
+  run.real_accumulated_time = 0.02;  // In seconds, for all the iterations.
+  run.cpu_accumulated_time = 0.01;
+  run.counters["bytes_per_second"] = ::benchmark::Counter(1000);
+  run.counters["items_per_second"] = ::benchmark::Counter(5);
+  ::benchmark::BenchmarkReporter::Run aggregate = run;
+  aggregate.run_type = ::benchmark::BenchmarkReporter::Run::RT_Aggregate;
+  aggregate.aggregate_name = "mean";
+  reporter.ReportRuns({run, aggregate});
+
+  std::string serialized;
+  TF_ASSERT_OK(ReadFileToString(
+      Env::Default(), absl::StrCat(prefix, "BM_Foo__8"), &serialized));
+  tensorflow::BenchmarkEntries entries;
+  ASSERT_TRUE(entries.ParseFromString(serialized));
+  ASSERT_EQ(entries.entry_size(), 1);
+  const tensorflow::BenchmarkEntry& entry = entries.entry(0);
+  EXPECT_EQ(entry.name(), "BM_Foo/8");
+  EXPECT_EQ(entry.iters(), 100);
+  EXPECT_NEAR(entry.wall_time(), 2e-4, 1e-9);
+  EXPECT_NEAR(entry.cpu_time(), 1e-4, 1e-9);
+  EXPECT_EQ(entry.throughput(), 1000);
+  ASSERT_EQ(entry.metrics_size(), 1);
+  EXPECT_EQ(entry.metrics(0).name(), "items_per_second");
+  EXPECT_EQ(entry.metrics(0).value(), 5);
+}
+
+}  // namespace
+}  // namespace tsl
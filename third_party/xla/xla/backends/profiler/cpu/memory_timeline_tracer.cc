@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tsl/framework/memory_timeline.h"
+#include "tsl/platform/env_time.h"
+#include "tsl/platform/status.h"
+#include "tsl/profiler/lib/profiler_factory.h"
+#include "tsl/profiler/lib/profiler_interface.h"
+#include "tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+#include "tsl/profiler/utils/xplane_builder.h"
+#include "tsl/profiler/utils/xplane_schema.h"
+#include "tsl/profiler/utils/xplane_utils.h"
+
+namespace xla {
+namespace profiler {
+namespace {
+
+// MemoryTimelineTracer exports the allocations recorded by the
+// tsl::MemoryTimeline during a profiling session, with one line per
+// allocator.
+//
+// If the timeline is not already recording (e.g. at a sampling rate set in the
+// environment), it records every allocation during the session.
+//
+// Thread-safety: This class is go/thread-compatible.
+class MemoryTimelineTracer : public tsl::profiler::ProfilerInterface {
+ public:
+  MemoryTimelineTracer() = default;
+
+  tsl::Status Start() override {
+    tsl::MemoryTimeline* timeline = tsl::MemoryTimeline::Global();
+    owns_recording_ = !tsl::MemoryTimeline::IsRecording();
+    if (owns_recording_) {
+      timeline->Start(tsl::MemoryTimeline::kDefaultCapacity,
+                      /*sample_every=*/1);
+    }
+    start_ns_ = tsl::EnvTime::NowNanos();
+    return tsl::OkStatus();
+  }
+
+  tsl::Status Stop() override {
+    const uint64_t stop_ns = tsl::EnvTime::NowNanos();
+    tsl::MemoryTimeline* timeline = tsl::MemoryTimeline::Global();
+    if (owns_recording_) timeline->Stop();
+    for (auto& event : timeline->Events()) {
+      if (event.timestamp_ns >= start_ns_ && event.timestamp_ns <= stop_ns) {
+        events_.push_back(std::move(event));
+      }
+    }
+    return tsl::OkStatus();
+  }
+
+  tsl::Status CollectData(tsl::profiler::XSpace* space) override {
+    if (events_.empty()) return tsl::OkStatus();
+    tsl::profiler::XPlaneBuilder plane(
+        tsl::profiler::FindOrAddMutablePlaneWithName(
+            space, tsl::profiler::kMemoryTimelinePlaneName));
+    const tsl::profiler::XEventMetadata& allocation =
+        *plane.GetOrCreateEventMetadata("MemoryAllocation");
+    const tsl::profiler::XEventMetadata& deallocation =
+        *plane.GetOrCreateEventMetadata("MemoryDeallocation");
+    const tsl::profiler::XStatMetadata& bytes_stat =
+        *plane.GetOrCreateStatMetadata("bytes");
+    const tsl::profiler::XStatMetadata& bytes_in_use_stat =
+        *plane.GetOrCreateStatMetadata("bytes_in_use");
+    const tsl::profiler::XStatMetadata& op_stat =
+        *plane.GetOrCreateStatMetadata("tf_op");
+    tsl::MemoryTimeline* timeline = tsl::MemoryTimeline::Global();
+    for (const auto& event : events_) {
+      tsl::profiler::XLineBuilder line =
+          plane.GetOrCreateLine(event.allocator_id);
+      if (line.NumEvents() == 0) {
+        line.SetName(timeline->AllocatorName(event.allocator_id));
+        line.SetTimestampNs(start_ns_);
+      }
+      tsl::profiler::XEventBuilder xevent =
+          line.AddEvent(event.bytes >= 0 ? allocation : deallocation);
+      xevent.SetTimestampNs(event.timestamp_ns);
+      xevent.SetDurationNs(0);
+      xevent.AddStatValue(bytes_stat, event.bytes);
+      xevent.AddStatValue(bytes_in_use_stat, event.bytes_in_use);
+      if (!event.op_name.empty()) {
+        xevent.AddStatValue(op_stat, event.op_name);
+      }
+    }
+    events_.clear();
+    return tsl::OkStatus();
+  }
+
+ private:
+  bool owns_recording_ = false;
+  uint64_t start_ns_ = 0;
+  std::vector<tsl::MemoryTimeline::Event> events_;
+
+  MemoryTimelineTracer(const MemoryTimelineTracer&) = delete;
+  void operator=(const MemoryTimelineTracer&) = delete;
+};
+
+std::unique_ptr<tsl::profiler::ProfilerInterface> CreateMemoryTimelineTracer(
+    const tensorflow::ProfileOptions& options) {
+  return options.host_tracer_level() > 0
+             ? std::make_unique<MemoryTimelineTracer>()
+             : nullptr;
+}
+
+}  // namespace
+
+auto register_memory_timeline_tracer_factory = [] {
+  RegisterProfilerFactory(&CreateMemoryTimelineTracer);
+  return 0;
+}();
+
+}  // namespace profiler
+}  // namespace xla
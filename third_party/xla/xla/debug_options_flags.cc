@@ -76,6 +76,10 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 #endif
   opts.set_xla_cpu_use_xla_runtime(false);
   opts.set_xla_cpu_sparse_cuda_threads(0);
+  opts.set_xla_cpu_parallel_codegen_split_count(0);
+  opts.set_xla_cpu_compilation_cache_dir("");
+  opts.set_xla_cpu_enable_concurrent_ops(false);
+  opts.set_xla_cpu_enable_onednn_fusion(false);
 
   opts.set_xla_cpu_enable_fast_math(false);
   // Disable forms of fast math that have caused users problems in the past.
@@ -102,6 +106,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.add_xla_gpu_enable_command_buffer(DebugOptions::CUBLAS);
   opts.set_xla_gpu_graph_num_runs_to_instantiate(-1);
   opts.set_xla_gpu_enable_persistent_temp_buffers(false);
+  opts.set_xla_gpu_enable_shared_temp_buffers(false);
   opts.set_xla_gpu_graph_min_graph_size(5);
   opts.set_xla_gpu_graph_enable_concurrent_region(false);
   opts.set_xla_gpu_graph_eviction_timeout_seconds(60);
@@ -119,6 +124,7 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
   opts.set_xla_gpu_reduce_scatter_combine_threshold_bytes(kDefaultThreshold);
   opts.set_xla_gpu_enable_all_gather_combine_by_dim(true);
   opts.set_xla_gpu_enable_reduce_scatter_combine_by_dim(true);
+  opts.set_xla_gpu_enable_overlap_aware_collective_combining(false);
 
   opts.set_xla_gpu_enable_async_collectives(false);
   opts.set_xla_gpu_enable_async_all_reduce(true);
@@ -633,6 +639,32 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_cpu_sparse_cuda_threads(),
       "Sets number fo CUDA threads for sparse GPU acceleration in the CPU "
       "backend (0 = off)."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_parallel_codegen_split_count",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+      debug_options->xla_cpu_parallel_codegen_split_count(),
+      "Splits the LLVM module of a program into this many shards, which the "
+      "CPU backend optimizes and compiles in parallel (0 or 1 = off)."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_compilation_cache_dir",
+      debug_options->mutable_xla_cpu_compilation_cache_dir(),
+      "If non-empty, a directory where the CPU backend caches the object "
+      "files it compiles, to reuse them when compiling the same programs "
+      "again, e.g. after a restart."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_enable_concurrent_ops",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_concurrent_ops),
+      debug_options->xla_cpu_enable_concurrent_ops(),
+      "Runs the independent expensive ops of the entry computation "
+      "concurrently with each other on the intra-op thread pool."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_enable_onednn_fusion",
+      bool_setter_for(&DebugOptions::set_xla_cpu_enable_onednn_fusion),
+      debug_options->xla_cpu_enable_onednn_fusion(),
+      "Rewrites matmuls and convolutions, along with their bias, activation "
+      "and residual add epilogues, to oneDNN primitives on CPU (when XLA is "
+      "built with oneDNN)."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_crash_on_verification_failures",
       bool_setter_for(
@@ -926,6 +958,14 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       debug_options->xla_gpu_enable_reduce_scatter_combine_by_dim(),
       "Combine reduce-scatter ops with the same dimension or irrespective of "
       "their dimension."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_overlap_aware_collective_combining",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_overlap_aware_collective_combining),
+      debug_options->xla_gpu_enable_overlap_aware_collective_combining(),
+      "Size the combined all-gather, all-reduce and reduce-scatter ops by the "
+      "compute the latency hiding scheduler can overlap them with, within the "
+      "combine thresholds."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_all_reduce_contiguous",
       bool_setter_for(&DebugOptions::set_xla_gpu_all_reduce_contiguous),
@@ -1042,6 +1082,13 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "Allocate temp buffers once during the first execution of an executable. "
       "Reuse the allocated buffers in subsequent executions. Executables cannot"
       " run concurrently if this is enabled."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_shared_temp_buffers",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_shared_temp_buffers),
+      debug_options->xla_gpu_enable_shared_temp_buffers(),
+      "Share the temp buffers of the executables compiled with this flag and "
+      "run by the same client in one arena per device, sized to the largest of "
+      "them. The executions of these executables are serialized."));
   flag_list->push_back(
       tsl::Flag("xla_dump_disable_metadata",
                 bool_setter_for(&DebugOptions::set_xla_dump_disable_metadata),
@@ -1299,6 +1346,20 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "unless the name ends with .txt or .textproto. It will be loaded at most "
       "once per process. This only works on CUDA. In tests, the TEST_WORKSPACE "
       "prefix can be used to load files from their data dependencies."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_cache_dir),
+      debug_options->xla_gpu_autotune_cache_dir(),
+      "Directory of the persistent autotune cache. If set, the autotuning "
+      "results of GEMMs and convolutions are looked up in this directory, and "
+      "written to it on misses. It may be shared by several processes."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_remote_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_remote_cache_dir),
+      debug_options->xla_gpu_autotune_remote_cache_dir(),
+      "Directory of an autotune cache shared by several hosts, on any "
+      "filesystem supported by TensorFlow. It is looked up on misses of "
+      "--xla_gpu_autotune_cache_dir, and written to along with it."));
   flag_list->push_back(tsl::Flag(
       "xla_gpu_auto_spmd_partitioning_memory_budget_gb",
       int32_setter_for(
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "xla/pjrt/gpu/se_gpu_pjrt_client.h"
 
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <memory>
 #include <optional>
@@ -38,13 +40,17 @@ limitations under the License.
 #include "absl/strings/str_split.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xla/client/local_client.h"
 #include "xla/client/xla_computation.h"
 #include "xla/pjrt/distributed/topology_util.h"
+#include "xla/pjrt/event_pool.h"
 #include "xla/pjrt/gpu/gpu_helpers.h"
+#include "xla/pjrt/local_device_state.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/pjrt/pjrt_compiler.h"
 #include "xla/pjrt/pjrt_executable.h"
+#include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/pjrt_stream_executor_client.h"
 #include "xla/pjrt/stream_executor_executable.h"
 #include "xla/pjrt/tracked_device_buffer.h"
@@ -80,6 +86,7 @@ limitations under the License.
 
 #include "xla/client/client_library.h"
 #include "xla/service/gpu/gpu_executable_run_options.h"
+#include "xla/service/gpu/shared_temp_buffers.h"
 #include "xla/service/platform_util.h"
 #include "xla/statusor.h"
 #include "xla/stream_executor/integrations/device_host_allocator.h"
@@ -93,6 +100,10 @@ namespace xla {
 class AsyncHostToDeviceTransferManager
     : public xla::PjRtClient::AsyncHostToDeviceTransferManager {
  public:
+  // The transfers of TransferRawDataToBuffers up to this size are staged
+  // together into a single pinned host buffer.
+  static constexpr int64_t kMaxStagedTransferSize = 64 * 1024;
+
   static StatusOr<std::unique_ptr<AsyncHostToDeviceTransferManager>> Create(
       absl::Span<const Shape> shapes, PjRtStreamExecutorDevice* device,
       PjRtStreamExecutorClient* client) {
@@ -337,6 +348,131 @@ class AsyncHostToDeviceTransferManager
     return OkStatus();
   }
 
+  StatusOr<std::vector<PjRtFuture<Status>>> TransferRawDataToBuffers(
+      absl::Span<const int> buffer_indices,
+      absl::Span<const absl::string_view> data) override {
+    tsl::profiler::TraceMe traceme(
+        "AsyncHostToDeviceTransferManager::TransferRawDataToBuffers");
+    if (buffer_indices.size() != data.size()) {
+      return InvalidArgument(
+          "TransferRawDataToBuffers got %d buffer indices but %d host buffers",
+          buffer_indices.size(), data.size());
+    }
+    LocalDeviceState* local_device = device_->local_device_state();
+    auto* stream = local_device->host_to_device_stream();
+    auto* se_client =
+        tensorflow::down_cast<PjRtStreamExecutorClient*>(device_->client());
+    DCHECK(se_client);
+    tsl::Allocator* host_allocator = se_client->host_memory_allocator();
+    auto is_staged = [&](absl::string_view data) {
+      return host_allocator != nullptr &&
+             data.size() <= kMaxStagedTransferSize;
+    };
+
+    absl::ReleasableMutexLock l(&mu_);
+    // Check all the transfers before starting any of them.
+    std::vector<bool> requested(buffer_ptrs_.size(), false);
+    int64_t staging_size = 0;
+    for (int i = 0; i < buffer_indices.size(); ++i) {
+      const int buffer_index = buffer_indices[i];
+      if (buffer_index < 0 || buffer_index >= buffer_ptrs_.size()) {
+        return InvalidArgument(
+            "TransferRawDataToBuffers requested for buffer index %d but there "
+            "are %d buffers",
+            buffer_index, buffer_ptrs_.size());
+      }
+      if (last_transfer_started_[buffer_index] || requested[buffer_index]) {
+        return InvalidArgument(
+            "TransferRawDataToBuffers requested for buffer index %d which has "
+            "already been fully transferred",
+            buffer_index);
+      }
+      requested[buffer_index] = true;
+      DCHECK(buffer_ptrs_[buffer_index]);
+      if (buffer_ptrs_[buffer_index]->device_memory().empty()) {
+        return InvalidArgument(
+            "TransferRawDataToBuffers requested for buffer index %d which has "
+            "been donated. Async transfer of donated buffers is not supported "
+            "in SE:GPU",
+            buffer_index);
+      }
+      if (data[i].size() != buffer_sizes_[buffer_index]) {
+        return InvalidArgument(
+            "TransferRawDataToBuffers got %d bytes for buffer index %d which "
+            "has size %d",
+            data[i].size(), buffer_index, buffer_sizes_[buffer_index]);
+      }
+      if (is_staged(data[i])) {
+        staging_size += RoundUpTo<int64_t>(data[i].size(),
+                                           tsl::Allocator::kAllocatorAlignment);
+      }
+    }
+    std::vector<EventPool::Handle> events;
+    events.reserve(buffer_indices.size());
+    for (int i = 0; i < buffer_indices.size(); ++i) {
+      TF_ASSIGN_OR_RETURN(EventPool::Handle event,
+                          local_device->event_pool().AllocateEvent(
+                              stream->parent()));
+      events.push_back(std::move(event));
+    }
+
+    // Copy the small host buffers into a single pinned host buffer, from which
+    // the transfers are asynchronous, instead of each being staged separately
+    // by the driver.
+    char* staging = nullptr;
+    if (staging_size > 0) {
+      staging = static_cast<char*>(host_allocator->AllocateRaw(
+          tsl::Allocator::kAllocatorAlignment, staging_size));
+    }
+    int64_t staging_offset = 0;
+    for (int i = 0; i < buffer_indices.size(); ++i) {
+      const int buffer_index = buffer_indices[i];
+      last_transfer_started_[buffer_index] = true;
+      if (data[i].empty()) {
+        continue;
+      }
+      const void* src = data[i].data();
+      if (staging != nullptr && is_staged(data[i])) {
+        std::memcpy(staging + staging_offset, data[i].data(), data[i].size());
+        src = staging + staging_offset;
+        staging_offset += RoundUpTo<int64_t>(
+            data[i].size(), tsl::Allocator::kAllocatorAlignment);
+      }
+      stream->ThenMemcpy(&buffer_ptrs_[buffer_index]->device_memory()[0], src,
+                         data[i].size());
+    }
+    for (EventPool::Handle& event : events) {
+      local_device->event_pool().ThenRecordEvent(stream, event);
+    }
+    ++transfers_in_flight_;
+    // Release the lock before calling ThenDoHostCallback in case cleanup
+    // could be called on this thread, to avoid deadlock.
+    l.Release();
+
+    std::vector<PjRtFuture<Status>::Promise> promises;
+    std::vector<PjRtFuture<Status>> futures;
+    promises.reserve(buffer_indices.size());
+    futures.reserve(buffer_indices.size());
+    for (int i = 0; i < buffer_indices.size(); ++i) {
+      promises.push_back(PjRtFuture<Status>::CreatePromise());
+      futures.push_back(PjRtFuture<Status>(promises.back()));
+    }
+    auto cleanup = [this, buffer_indices = std::vector<int>(
+                              buffer_indices.begin(), buffer_indices.end()),
+                    events = std::move(events), stream, host_allocator,
+                    staging, promises = std::move(promises)]() mutable {
+      if (staging != nullptr) {
+        host_allocator->DeallocateRaw(staging);
+      }
+      CleanUpBatch(buffer_indices, std::move(events), stream);
+      for (PjRtFuture<Status>::Promise& promise : promises) {
+        promise.Set(OkStatus());
+      }
+    };
+    stream->ThenDoHostCallback(std::move(cleanup));
+    return futures;
+  }
+
   void SetBufferError(int buffer_index, Status error) override {
     {
       absl::MutexLock l(&mu_);
@@ -403,6 +539,26 @@ class AsyncHostToDeviceTransferManager
     // Call on_done after finishing all housekeeping and releasing the lock.
     std::move(on_done)();
   }
+
+  // Like CleanUp, for the last transfers of several buffers enqueued together.
+  void CleanUpBatch(absl::Span<const int> buffer_indices,
+                    std::vector<EventPool::Handle> events, se::Stream* stream) {
+    absl::MutexLock l(&mu_);
+    CHECK_GT(transfers_in_flight_, 0);
+    --transfers_in_flight_;
+    for (int i = 0; i < buffer_indices.size(); ++i) {
+      const int buffer_index = buffer_indices[i];
+      CHECK(buffer_ptrs_[buffer_index]);
+      buffer_ptrs_[buffer_index] = nullptr;
+      CHECK_GT(remaining_buffer_count_, 0);
+      --remaining_buffer_count_;
+      definition_events_[buffer_index]->SetSequencingEvent(std::move(events[i]),
+                                                           stream);
+    }
+    if (remaining_buffer_count_ == 0) {
+      VLOG(1) << "TransferRawDataToBuffers for all buffers is done.";
+    }
+  }
 };
 
 absl::string_view StreamExecutorGpuClient::platform_version() const {
@@ -916,6 +1072,11 @@ StatusOr<std::unique_ptr<PjRtClient>> GetStreamExecutorGpuClient(
   if (options.enable_mock_nccl) {
     gpu_run_options->set_enable_mock_nccl_collectives();
   }
+  // The temp buffers of the executables compiled with
+  // xla_gpu_enable_shared_temp_buffers are shared by all the executables of
+  // the client.
+  gpu_run_options->set_shared_temp_buffers(
+      std::make_shared<gpu::SharedTempBuffers>());
   absl::flat_hash_map<std::string, std::string> device_maps;
   absl::Mutex mu;
   PjRtClient::KeyValueGetCallback kv_get = options.kv_get;
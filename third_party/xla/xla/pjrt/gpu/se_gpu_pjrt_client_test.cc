@@ -35,6 +35,7 @@ limitations under the License.
 #include "xla/literal.h"
 #include "xla/literal_util.h"
 #include "xla/pjrt/pjrt_client.h"
+#include "xla/pjrt/pjrt_future.h"
 #include "xla/pjrt/utils.h"
 #include "xla/service/hlo_parser.h"
 #include "xla/statusor.h"
@@ -372,6 +373,52 @@ TEST(StreamExecutorGpuClientTest, FromHostAsync) {
         literals[i]->Relayout(src_literals[i].shape().layout()).data<float>());
   }
 }
+
+TEST(StreamExecutorGpuClientTest, TransferRawDataToBuffersTogether) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client,
+                          GetStreamExecutorGpuClient(GpuClientOptions()));
+  ASSERT_GE(client->addressable_devices().size(), 1);
+
+  // Small buffers, which are staged together, and a large one, which isn't.
+  std::vector<Literal> src_literals;
+  std::vector<Shape> src_shapes;
+  for (int size : {1, 2, 3, 4, 128 * 1024}) {
+    std::vector<float> data(size);
+    std::iota(data.begin(), data.end(), static_cast<float>(size));
+    src_literals.emplace_back(LiteralUtil::CreateR1<float>(data));
+    src_shapes.push_back(src_literals.back().shape());
+  }
+  TF_ASSERT_OK_AND_ASSIGN(auto transfer_manager,
+                          client->CreateBuffersForAsyncHostToDevice(
+                              src_shapes, client->addressable_devices()[0]));
+
+  std::vector<int> buffer_indices;
+  std::vector<absl::string_view> data;
+  for (int i = 0; i < src_literals.size(); ++i) {
+    buffer_indices.push_back(i);
+    data.emplace_back(static_cast<char*>(src_literals[i].untyped_data()),
+                      src_literals[i].size_bytes());
+  }
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<PjRtFuture<Status>> futures,
+      transfer_manager->TransferRawDataToBuffers(buffer_indices, data));
+  ASSERT_EQ(futures.size(), src_literals.size());
+  for (PjRtFuture<Status>& future : futures) {
+    TF_EXPECT_OK(future.Await());
+  }
+
+  // The buffers can't be transferred into again.
+  EXPECT_FALSE(
+      transfer_manager->TransferRawDataToBuffers({0}, {data[0]}).ok());
+
+  for (int i = 0; i < src_literals.size(); ++i) {
+    std::unique_ptr<PjRtBuffer> buffer = transfer_manager->RetrieveBuffer(i);
+    TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> literal,
+                            buffer->ToLiteralSync());
+    EXPECT_TRUE(LiteralTestUtil::Equal(src_literals[i], *literal));
+  }
+}
+
 TEST(StreamExecutorGpuClientTest, CopyRawToHostFullBuffer) {
   TF_ASSERT_OK_AND_ASSIGN(auto client,
                           GetStreamExecutorGpuClient(GpuClientOptions()));
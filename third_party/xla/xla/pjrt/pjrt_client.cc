@@ -18,9 +18,12 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/casts.h"
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "absl/types/span.h"
 #include "xla/hlo/ir/hlo_module.h"
 #include "xla/pjrt/utils.h"
 #include "xla/util.h"
@@ -43,6 +46,27 @@ StatusOr<std::uintptr_t> PjRtClient::UnsafeBufferPointer(PjRtBuffer* buffer) {
   return absl::bit_cast<std::uintptr_t>(ptr);
 }
 
+StatusOr<std::vector<PjRtFuture<Status>>>
+PjRtClient::AsyncHostToDeviceTransferManager::TransferRawDataToBuffers(
+    absl::Span<const int> buffer_indices,
+    absl::Span<const absl::string_view> data) {
+  if (buffer_indices.size() != data.size()) {
+    return InvalidArgument(
+        "TransferRawDataToBuffers got %d buffer indices but %d host buffers",
+        buffer_indices.size(), data.size());
+  }
+  std::vector<PjRtFuture<Status>> futures;
+  futures.reserve(data.size());
+  for (int i = 0; i < data.size(); ++i) {
+    auto promise = PjRtFuture<Status>::CreatePromise();
+    TF_RETURN_IF_ERROR(TransferRawDataToBuffer(
+        buffer_indices[i], data[i],
+        [promise]() mutable { promise.Set(OkStatus()); }));
+    futures.push_back(PjRtFuture<Status>(std::move(promise)));
+  }
+  return futures;
+}
+
 PjRtFuture<Status> PjRtBuffer::CopyRawToHostFuture(
     PjRtFuture<StatusOr<void*>> dst, int64_t offset, int64_t transfer_size) {
   auto promise = PjRtFuture<Status>::CreatePromise();
@@ -678,6 +678,16 @@ class PjRtClient {
         int buffer_index, absl::string_view data,
         absl::AnyInvocable<void() &&> on_done) = 0;
 
+    // Transfers each of 'data' into the buffer of the same position in
+    // 'buffer_indices', as TransferRawDataToBuffer does, and returns a future
+    // for each of them, which becomes ready once its transfer is complete.
+    // Implementations may coalesce the transfers, e.g. stage the small ones
+    // together, which is cheaper than transferring them one by one. 'data'
+    // must remain in scope until all the futures are ready.
+    virtual StatusOr<std::vector<PjRtFuture<Status>>> TransferRawDataToBuffers(
+        absl::Span<const int> buffer_indices,
+        absl::Span<const absl::string_view> data);
+
     // Transfers 'data' into a sub-buffer of buffer_index starting at offset, of
     // length transfer_size. 'data' must be already laid out in the correct
     // on-device format, for example returned by a call to
@@ -234,6 +234,29 @@ inline __m256i Unpack<8, Extract::kHi>(__m256i a, __m256i b) {
 #endif
 #endif
 
+#ifdef __AVX512F__
+template <size_t element_size, Extract>
+__m512i Unpack(__m512i a, __m512i b);
+
+template <>
+inline __m512i Unpack<4, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi32(a, b);
+}
+template <>
+inline __m512i Unpack<4, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi32(a, b);
+}
+
+template <>
+inline __m512i Unpack<8, Extract::kLo>(__m512i a, __m512i b) {
+  return _mm512_unpacklo_epi64(a, b);
+}
+template <>
+inline __m512i Unpack<8, Extract::kHi>(__m512i a, __m512i b) {
+  return _mm512_unpackhi_epi64(a, b);
+}
+#endif
+
 #ifdef XLA_HAS_SSE2
 template <size_t element_size, Extract>
 __m128i Unpack(__m128i a, __m128i b);
@@ -688,6 +711,49 @@ struct AvxRectangularTransposeMicroKernelImpl {
 };
 #endif
 
+#ifdef __AVX512F__
+// The same approach as AvxSquareTransposeMicroKernelImpl, over the four 128-bit
+// lanes of 512-bit vectors: the lanes of each vector are loaded from rows a
+// quarter of the block apart, so that the 4x4 lane blocks only need to be
+// transposed within each lane.
+template <typename T, int bs>
+struct Avx512SquareTransposeMicroKernelImpl {
+  XLA_FLATTEN static void Apply(const char* __restrict a, int64_t lda,
+                                char* __restrict b, int64_t ldb) {
+    constexpr size_t element_size = sizeof(T);
+    static_assert(element_size == 4 || element_size == 8);
+    static_assert(bs % 4 == 0);
+    static_assert(element_size * bs == sizeof(__m512i));
+    std::array<__m512i, bs> last_transpose;
+    XLA_UNROLL
+    for (int i = 0; i < bs / 4; ++i) {
+      auto* row0 = reinterpret_cast<const __m128i*>(a + lda * (i + 0));
+      auto* row1 = reinterpret_cast<const __m128i*>(a + lda * (i + bs / 4));
+      auto* row2 = reinterpret_cast<const __m128i*>(a + lda * (i + bs / 2));
+      auto* row3 = reinterpret_cast<const __m128i*>(a + lda * (i + 3 * bs / 4));
+      XLA_UNROLL
+      for (int lane = 0; lane < 4; ++lane) {
+        __m512i v = _mm512_castsi128_si512(_mm_loadu_si128(row0 + lane));
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(row1 + lane), 1);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(row2 + lane), 2);
+        v = _mm512_inserti32x4(v, _mm_loadu_si128(row3 + lane), 3);
+        last_transpose[i + lane * bs / 4] = v;
+      }
+    }
+
+    last_transpose =
+        UnpackSequence<element_size, /*step_size=*/1,
+                       /*unpack_limit=*/sizeof(__m128i)>(last_transpose);
+
+    XLA_UNROLL
+    for (int i = 0; i < bs; ++i) {
+      _mm512_storeu_si512(reinterpret_cast<void*>(b + ldb * i),
+                          last_transpose[i]);
+    }
+  }
+};
+#endif
+
 // The transpose kernel requires its input to be contiguous in one of the two
 // dimensions being transposed, and the output to be contiguous in the other
 // dimension.
@@ -698,6 +764,13 @@ struct TransposeMicroKernel {
   static void Apply(const char* __restrict a, int64_t lda, char* __restrict b,
                     int64_t ldb) {
     if constexpr (bs % 2 == 0) {
+#ifdef __AVX512F__
+      if constexpr (sizeof(T) * bs == sizeof(__m512i) &&
+                    (sizeof(T) == 4 || sizeof(T) == 8)) {
+        return Avx512SquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b,
+                                                                  ldb);
+      }
+#endif
 #ifdef __AVX__
       if constexpr (sizeof(T) * bs == sizeof(__m256i)) {
         return AvxSquareTransposeMicroKernelImpl<T, bs>::Apply(a, lda, b, ldb);
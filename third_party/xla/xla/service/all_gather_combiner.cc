@@ -186,12 +186,14 @@ std::optional<GroupKey> CombineKey(const HloInstruction* instruction,
 
 }  // namespace
 
-AllGatherCombiner::AllGatherCombiner(int64_t combine_threshold_in_bytes,
-                                     int64_t combine_threshold_count,
-                                     bool combine_by_dim)
+AllGatherCombiner::AllGatherCombiner(
+    int64_t combine_threshold_in_bytes, int64_t combine_threshold_count,
+    bool combine_by_dim,
+    std::optional<CollectiveCombineOverlapModel> overlap_model)
     : combine_threshold_in_bytes_(combine_threshold_in_bytes),
       combine_threshold_count_(combine_threshold_count),
-      combine_by_dim_(combine_by_dim) {}
+      combine_by_dim_(combine_by_dim),
+      overlap_model_(std::move(overlap_model)) {}
 
 StatusOr<bool> AllGatherCombiner::Run(
     HloModule* module,
@@ -226,9 +228,10 @@ StatusOr<bool> AllGatherCombiner::Run(
 
     TF_ASSIGN_OR_RETURN(
         bool computation_changed,
-        CombineInstructionsByKey<GroupKey>(computation, key_fn, combine_fn,
-                                           combine_threshold_in_bytes_,
-                                           combine_threshold_count_));
+        CombineInstructionsByKey<GroupKey>(
+            computation, key_fn, combine_fn, combine_threshold_in_bytes_,
+            combine_threshold_count_,
+            overlap_model_ ? &*overlap_model_ : nullptr));
     changed |= computation_changed;
   }
 
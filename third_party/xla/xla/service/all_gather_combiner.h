@@ -16,8 +16,11 @@ limitations under the License.
 #ifndef XLA_SERVICE_ALL_GATHER_COMBINER_H_
 #define XLA_SERVICE_ALL_GATHER_COMBINER_H_
 
+#include <optional>
+
 #include "absl/strings/string_view.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/collective_combiner_utils.h"
 #include "xla/service/hlo_pass_interface.h"
 #include "xla/statusor.h"
 #include "xla/xla_data.pb.h"
@@ -31,7 +34,9 @@ namespace xla {
 class AllGatherCombiner : public HloModulePass {
  public:
   AllGatherCombiner(int64_t combine_threshold_in_bytes,
-                    int64_t combine_threshold_count, bool combine_by_dim);
+                    int64_t combine_threshold_count, bool combine_by_dim,
+                    std::optional<CollectiveCombineOverlapModel> overlap_model =
+                        std::nullopt);
 
   absl::string_view name() const override { return "all-gather-combiner"; }
 
@@ -49,6 +54,10 @@ class AllGatherCombiner : public HloModulePass {
 
   // Combine only all-gather ops with the same gather dimension.
   bool combine_by_dim_;
+
+  // If set, sizes the combined ops by the compute they overlap with, within
+  // the thresholds above.
+  std::optional<CollectiveCombineOverlapModel> overlap_model_;
 };
 
 }  // namespace xla
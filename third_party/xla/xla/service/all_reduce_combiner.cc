@@ -103,10 +103,12 @@ Status CombineAllReduces(absl::Span<HloInstruction* const> to_combine) {
 }
 }  // namespace
 
-AllReduceCombiner::AllReduceCombiner(int64_t combine_threshold_in_bytes,
-                                     int64_t combine_threshold_count)
+AllReduceCombiner::AllReduceCombiner(
+    int64_t combine_threshold_in_bytes, int64_t combine_threshold_count,
+    std::optional<CollectiveCombineOverlapModel> overlap_model)
     : combine_threshold_in_bytes_(combine_threshold_in_bytes),
-      combine_threshold_count_(combine_threshold_count) {}
+      combine_threshold_count_(combine_threshold_count),
+      overlap_model_(std::move(overlap_model)) {}
 
 StatusOr<bool> AllReduceCombiner::Run(
     HloModule* module,
@@ -143,7 +145,8 @@ StatusOr<bool> AllReduceCombiner::Run(
         bool computation_changed,
         CombineInstructionsByKey<AllReduceKey>(
             computation, key_fn, &CombineAllReduces,
-            combine_threshold_in_bytes_, combine_threshold_count_));
+            combine_threshold_in_bytes_, combine_threshold_count_,
+            overlap_model_ ? &*overlap_model_ : nullptr));
     changed |= computation_changed;
   }
 
@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef XLA_SERVICE_ALL_REDUCE_COMBINER_H_
 #define XLA_SERVICE_ALL_REDUCE_COMBINER_H_
 
+#include <optional>
+
 #include "absl/strings/string_view.h"
 #include "xla/array2d.h"
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/collective_combiner_utils.h"
 #include "xla/service/hlo_pass_interface.h"
 #include "xla/statusor.h"
 #include "xla/xla_data.pb.h"
@@ -32,7 +35,9 @@ namespace xla {
 class AllReduceCombiner : public HloModulePass {
  public:
   AllReduceCombiner(int64_t combine_threshold_in_bytes,
-                    int64_t combine_threshold_count);
+                    int64_t combine_threshold_count,
+                    std::optional<CollectiveCombineOverlapModel> overlap_model =
+                        std::nullopt);
 
   absl::string_view name() const override { return "all-reduce-combiner"; }
 
@@ -47,6 +52,10 @@ class AllReduceCombiner : public HloModulePass {
 
   // Combine all reduce ops up to this threshold (number of operands).
   int64_t combine_threshold_count_;
+
+  // If set, sizes the combined ops by the compute they overlap with, within
+  // the thresholds above.
+  std::optional<CollectiveCombineOverlapModel> overlap_model_;
 };
 
 }  // namespace xla
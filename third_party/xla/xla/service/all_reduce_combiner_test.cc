@@ -25,6 +25,8 @@ limitations under the License.
 #include "xla/hlo/utils/hlo_matchers.h"
 #include "xla/literal.h"
 #include "xla/literal_util.h"
+#include "xla/service/collective_combiner_utils.h"
+#include "xla/service/latency_hiding_scheduler.h"
 #include "xla/shape_util.h"
 #include "xla/tests/hlo_test_base.h"
 #include "xla/xla_data.pb.h"
@@ -477,5 +479,58 @@ ENTRY %comp {
       op::Tuple(op::GetTupleElement(crs1, 0), op::GetTupleElement(crs1, 1)));
 }
 
+TEST_F(AllReduceCombinerTest, SizeByOverlap) {
+  const char* const hlo_string = R"(
+HloModule module
+
+%add {
+  lhs = f32[] parameter(0)
+  rhs = f32[] parameter(1)
+  ROOT add = f32[] add(lhs, rhs)
+}
+
+ENTRY %comp {
+  p0 = f32[256] parameter(0)
+  p1 = f32[256] parameter(1)
+  p2 = f32[256] parameter(2)
+  p3 = f32[256] parameter(3)
+
+  crs0 = f32[256] all-reduce(p0), to_apply=add
+  crs1 = f32[256] all-reduce(p1), to_apply=add
+  mul0 = f32[256] multiply(p2, p2)
+  mul1 = f32[256] multiply(mul0, mul0)
+  mul2 = f32[256] multiply(mul1, mul1)
+  mul3 = f32[256] multiply(mul2, mul2)
+  crs2 = f32[256] all-reduce(mul3), to_apply=add
+  crs3 = f32[256] all-reduce(p3), to_apply=add
+  ROOT tuple = (f32[256], f32[256], f32[256], f32[256])
+    tuple(crs0, crs1, crs2, crs3)
+})";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+
+  // Each instruction costs 1, and an all-reduce of 1 KiB costs 3, so that crs0
+  // and crs1 combined still overlap with the multiplies that follow them, while
+  // crs2 and crs3 overlap with nothing and are combined to save a latency.
+  CollectiveCombineOverlapModel overlap_model;
+  overlap_model.latency_estimator =
+      std::make_shared<ApproximateLatencyEstimator>();
+  overlap_model.collective_latency = 2;
+  overlap_model.cost_per_byte = 1.0 / 1024;
+  AllReduceCombiner combine(1024 * 1024, kMaxCombineCount, overlap_model);
+  ASSERT_EQ(AllReduceCount(*module), 4);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, combine.Run(module.get()));
+  EXPECT_EQ(AllReduceCount(*module), 2);
+  EXPECT_TRUE(changed);
+
+  auto crs01 = op::AllReduce(op::Parameter(0), op::Parameter(1));
+  auto crs23 = op::AllReduce(op::Multiply(), op::Parameter(3));
+  EXPECT_THAT(module->entry_computation()->root_instruction(),
+              op::Tuple(op::GetTupleElement(crs01, 0),
+                        op::GetTupleElement(crs01, 1),
+                        op::GetTupleElement(crs23, 0),
+                        op::GetTupleElement(crs23, 1)));
+}
+
 }  // namespace
 }  // namespace xla
@@ -17,6 +17,7 @@ limitations under the License.
 #define XLA_SERVICE_COLLECTIVE_COMBINER_UTILS_H_
 
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -28,6 +29,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/ir/hlo_reachability.h"
 #include "xla/service/hlo_domain_map.h"
+#include "xla/service/latency_hiding_scheduler.h"
 #include "xla/shape_util.h"
 #include "xla/status_macros.h"
 #include "xla/xla_data.pb.h"
@@ -35,6 +37,56 @@ limitations under the License.
 
 namespace xla {
 
+// Estimates, in the cost units of the latency hiding scheduler, how long the
+// combined collectives take and how much compute they can overlap with, so that
+// the combiners size each combined collective to hide behind compute.
+struct CollectiveCombineOverlapModel {
+  // Estimates the cost of the instructions collectives overlap with.
+  std::shared_ptr<const LatencyEstimator> latency_estimator;
+  // The cost of a collective, regardless of its size.
+  LatencyEstimator::TimeCost collective_latency = 0;
+  // The cost of each byte a collective moves.
+  LatencyEstimator::TimeCost cost_per_byte = 0;
+
+  LatencyEstimator::TimeCost CollectiveCost(int64_t bytes) const {
+    return collective_latency + cost_per_byte * bytes;
+  }
+};
+
+// Returns, for each instruction with a key, the cost of the instructions without
+// a key that follow it in post-order and do not depend on it, i.e. the compute a
+// collective that starts with it can overlap with.
+template <typename K>
+absl::flat_hash_map<const HloInstruction*, LatencyEstimator::TimeCost>
+ComputeOverlapCosts(HloComputation* computation,
+                    const absl::flat_hash_map<HloInstruction*, K>& keys,
+                    const LatencyEstimator& latency_estimator) {
+  absl::flat_hash_map<const HloInstruction*, LatencyEstimator::TimeCost>
+      overlap_costs;
+  std::unique_ptr<HloReachabilityMap> reachability =
+      HloReachabilityMap::Build(computation);
+  std::vector<HloInstruction*> post_order =
+      computation->MakeInstructionPostOrder();
+  std::vector<std::pair<const HloInstruction*, LatencyEstimator::TimeCost>>
+      later_costs;
+  for (auto it = post_order.rbegin(); it != post_order.rend(); ++it) {
+    const HloInstruction* instruction = *it;
+    if (!keys.contains(instruction)) {
+      later_costs.push_back(
+          {instruction, latency_estimator.NodeCost(instruction)});
+      continue;
+    }
+    LatencyEstimator::TimeCost overlap_cost = 0;
+    for (const auto& [later, cost] : later_costs) {
+      if (!reachability->IsReachable(instruction, later)) {
+        overlap_cost += cost;
+      }
+    }
+    overlap_costs[instruction] = overlap_cost;
+  }
+  return overlap_costs;
+}
+
 // Combines instructions with matching keys together.
 //
 // Instructions are combined in topological post-order.
@@ -42,12 +94,19 @@ namespace xla {
 // `key_fn` should return equal keys for two instructions that might be combined
 // together. Instructions will be combined until the threshold for output byte
 // size or instruction count is reached.
+//
+// If `overlap_model` is set, an instruction is also only added to a combined
+// instruction if the latter still overlaps with the compute that follows it,
+// or if neither of them would overlap anyway, in which case combining them
+// saves a collective latency. The overlap of each instruction is estimated
+// once, before any is combined.
 template <typename K>
 StatusOr<bool> CombineInstructionsByKey(
     HloComputation* computation,
     absl::FunctionRef<std::optional<K>(const HloInstruction*)> key_fn,
     absl::FunctionRef<Status(absl::Span<HloInstruction* const>)> combine_fn,
-    int64_t combine_threshold_bytes, int64_t combine_threshold_count) {
+    int64_t combine_threshold_bytes, int64_t combine_threshold_count,
+    const CollectiveCombineOverlapModel* overlap_model = nullptr) {
   // Cache keys for each instruction and build sets of instructions with the
   // same key that might be combined together.
   absl::flat_hash_map<HloInstruction*, K> keys;
@@ -61,12 +120,21 @@ StatusOr<bool> CombineInstructionsByKey(
     }
   }
 
+  absl::flat_hash_map<const HloInstruction*, LatencyEstimator::TimeCost>
+      overlap_costs;
+  if (overlap_model != nullptr) {
+    overlap_costs = ComputeOverlapCosts(computation, keys,
+                                        *overlap_model->latency_estimator);
+  }
+
   bool changed = false;
 
   // Keys are removed after the instruction is combined (or never will be).
   while (!keys.empty()) {
     std::vector<HloInstruction*> to_combine;
     int64_t to_combine_bytes = 0;
+    // The compute the combined instruction can overlap with so far.
+    LatencyEstimator::TimeCost to_combine_overlap_cost = 0;
     absl::flat_hash_set<HloInstruction*>* group = nullptr;
 
     // Recompute reachability after every combine group because we can't
@@ -129,9 +197,28 @@ StatusOr<bool> CombineInstructionsByKey(
         break;
       }
 
+      LatencyEstimator::TimeCost overlap_cost = 0;
+      if (overlap_model != nullptr) {
+        overlap_cost = overlap_costs[instruction];
+        if (!to_combine.empty()) {
+          const bool overlapped =
+              overlap_model->CollectiveCost(to_combine_bytes +
+                                            instruction_bytes) <= overlap_cost;
+          const bool exposed =
+              overlap_model->CollectiveCost(to_combine_bytes) >
+                  to_combine_overlap_cost &&
+              overlap_model->CollectiveCost(instruction_bytes) > overlap_cost;
+          if (!overlapped && !exposed) {
+            VLOG(1) << "Combined instruction would not overlap with compute.";
+            break;
+          }
+        }
+      }
+
       VLOG(1) << "Adding instruction to set.";
       to_combine.push_back(instruction);
       to_combine_bytes += instruction_bytes;
+      to_combine_overlap_cost = overlap_cost;
       keys.erase(it);
 
       if (to_combine.size() >= combine_threshold_count) {
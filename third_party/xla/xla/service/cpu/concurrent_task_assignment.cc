@@ -0,0 +1,193 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/concurrent_task_assignment.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/hlo/utils/hlo_query.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+#include "xla/util.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"  // IWYU pragma: keep
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Returns whether 'instruction', or one of the HLOs of the computations it
+// calls, must not run concurrently with other HLOs: those with side effects,
+// collectives, and custom calls, which may not be thread-safe.
+bool HasUnsafeOps(const HloInstruction* instruction) {
+  if (instruction->HasSideEffect() ||
+      instruction->opcode() == HloOpcode::kCustomCall ||
+      hlo_query::IsCollectiveCommunicationOp(instruction->opcode())) {
+    return true;
+  }
+  for (const HloComputation* computation :
+       instruction->called_computations()) {
+    for (const HloInstruction* called : computation->instructions()) {
+      if (HasUnsafeOps(called)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool MayRunAsTask(const HloInstruction* instruction) {
+  switch (instruction->opcode()) {
+    // These don't compute anything.
+    case HloOpcode::kAddDependency:
+    case HloOpcode::kAfterAll:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kConstant:
+    case HloOpcode::kGetTupleElement:
+    case HloOpcode::kParameter:
+    case HloOpcode::kTuple:
+      return false;
+    default:
+      break;
+  }
+  return !instruction->HasControlDependencies() && !HasUnsafeOps(instruction);
+}
+
+}  // namespace
+
+bool IsConcurrentTaskComputation(const HloComputation& computation) {
+  auto backend_config_or =
+      computation.root_instruction()->backend_config<BackendConfig>();
+  return backend_config_or.ok() && backend_config_or->concurrent_tasks();
+}
+
+bool HasConcurrentTasks(const HloModule& module) {
+  for (const HloComputation* computation : module.computations()) {
+    if (IsConcurrentTaskComputation(*computation)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+StatusOr<bool> ConcurrentTaskAssigner::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  XLA_VLOG_LINES(2, "ConcurrentTaskAssigner ENTRY");
+  XLA_VLOG_LINES(3, module->ToString());
+  HloComputation* computation = module->entry_computation();
+
+  HloCostAnalysis cost_analysis(shape_size_function_);
+  const bool has_cost_analysis =
+      computation->root_instruction()->Accept(&cost_analysis).ok();
+  auto is_expensive = [&](const HloInstruction* instruction) {
+    if (!has_cost_analysis) {
+      // Note that HloCostAnalysis can return an error status (likely because
+      // HLOs like CustomCall are not yet implemented in the HloCostAnalysis),
+      // so fall back to the size of the output, relative to the L2 cache size.
+      return shape_size_function_(instruction->shape()) >= (256LL << 10);
+    }
+    // The same linear cost model in cycles as for parallel tasks.
+    const int64_t cost = cost_analysis.flop_count(*instruction) +
+                         2 * cost_analysis.transcendental_count(*instruction) +
+                         10 * cost_analysis.bytes_accessed(*instruction);
+    return cost >= min_task_cost_;
+  };
+
+  // The candidate tasks of each depth, in post order.
+  absl::flat_hash_map<const HloInstruction*, int64_t> depths;
+  std::map<int64_t, std::vector<HloInstruction*>> tasks_by_depth;
+  for (HloInstruction* instruction : computation->MakeInstructionPostOrder()) {
+    int64_t depth = 0;
+    for (const HloInstruction* operand : instruction->operands()) {
+      depth = std::max(depth, depths.at(operand) + 1);
+    }
+    for (const HloInstruction* predecessor :
+         instruction->control_predecessors()) {
+      depth = std::max(depth, depths.at(predecessor) + 1);
+    }
+    depths[instruction] = depth;
+    if (MayRunAsTask(instruction) && is_expensive(instruction)) {
+      tasks_by_depth[depth].push_back(instruction);
+    }
+  }
+
+  bool changed = false;
+  for (auto& [depth, tasks] : tasks_by_depth) {
+    if (tasks.size() < 2) {
+      continue;
+    }
+    // Outline each task into its own computation.
+    std::vector<HloInstruction*> calls;
+    calls.reserve(tasks.size());
+    for (HloInstruction* task : tasks) {
+      calls.push_back(module->OutlineExpressionFromComputation(
+          {task}, absl::StrCat("concurrent_", task->name()), computation));
+    }
+
+    // Outline the calls together, behind a tuple of their results, as the
+    // outlined expression must have a single output.
+    HloInstruction* tuple =
+        computation->AddInstruction(HloInstruction::CreateTuple(calls));
+    for (int64_t i = 0; i < calls.size(); ++i) {
+      HloInstruction* call = calls[i];
+      HloInstruction* get_tuple_element = computation->AddInstruction(
+          HloInstruction::CreateGetTupleElement(call->shape(), tuple, i));
+      const std::vector<HloInstruction*> users = call->users();
+      for (HloInstruction* user : users) {
+        if (user != tuple) {
+          TF_RETURN_IF_ERROR(call->ReplaceUseWith(user, get_tuple_element));
+        }
+      }
+      if (computation->root_instruction() == call) {
+        computation->set_root_instruction(get_tuple_element);
+      }
+    }
+    std::vector<HloInstruction*> to_outline = calls;
+    to_outline.push_back(tuple);
+    HloInstruction* concurrent_call = module->OutlineExpressionFromComputation(
+        to_outline, absl::StrCat("concurrent_tasks_", depth), computation);
+
+    BackendConfig backend_config;
+    backend_config.set_concurrent_tasks(true);
+    TF_RETURN_IF_ERROR(
+        concurrent_call->to_apply()->root_instruction()->set_backend_config(
+            backend_config));
+
+    VLOG(2) << "Assigned " << calls.size()
+            << " concurrent tasks to: " << concurrent_call->name();
+    changed = true;
+  }
+
+  XLA_VLOG_LINES(2, "ConcurrentTaskAssigner EXIT");
+  XLA_VLOG_LINES(3, module->ToString());
+  return changed;
+}
+
+}  // namespace cpu
+}  // namespace xla
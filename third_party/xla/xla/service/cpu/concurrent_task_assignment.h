@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_CONCURRENT_TASK_ASSIGNMENT_H_
+#define XLA_SERVICE_CPU_CONCURRENT_TASK_ASSIGNMENT_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/service/hlo_pass_interface.h"
+#include "xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// ConcurrentTaskAssigner lets the independent HLOs of the entry computation,
+// e.g. those of the parallel branches of a graph, run concurrently with each
+// other on the intra-op thread pool.
+//
+// The HLOs at the same depth in the entry computation (the length of the
+// longest path to them from its parameters) don't depend on each other. Those
+// of each depth which are expensive enough are each outlined into their own
+// computation, and the calls of these tasks are outlined together into a
+// computation marked with the 'concurrent_tasks' backend config, which is
+// lowered in codegen to a runtime concurrent fork/join call.
+//
+// The tasks run in any order, so buffers must only be shared along the
+// dependencies of the HLOs of a module with concurrent tasks, see
+// HasConcurrentTasks().
+class ConcurrentTaskAssigner : public HloModulePass {
+ public:
+  // The default for 'min_task_cost', 100us of work on a 2GHz core as for
+  // parallel tasks.
+  static constexpr int64_t kDefaultMinTaskCost = 100000;
+
+  // 'shape_size': shape size function used by HloCostAnalysis to estimate the
+  //               cost of the HLOs.
+  // 'min_task_cost': the cost in cycles under which an HLO isn't worth running
+  //                  as a concurrent task.
+  explicit ConcurrentTaskAssigner(
+      const HloCostAnalysis::ShapeSizeFunction& shape_size,
+      int64_t min_task_cost = kDefaultMinTaskCost)
+      : shape_size_function_(shape_size), min_task_cost_(min_task_cost) {}
+  ~ConcurrentTaskAssigner() override = default;
+
+  absl::string_view name() const override {
+    return "cpu-concurrent-task-assigner";
+  }
+
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  HloCostAnalysis::ShapeSizeFunction shape_size_function_;
+  const int64_t min_task_cost_;
+};
+
+// Returns whether the calls of 'computation' are concurrent tasks.
+bool IsConcurrentTaskComputation(const HloComputation& computation);
+
+// Returns whether 'module' has concurrent tasks.
+bool HasConcurrentTasks(const HloModule& module);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_CPU_CONCURRENT_TASK_ASSIGNMENT_H_
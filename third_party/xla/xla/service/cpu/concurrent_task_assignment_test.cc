@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/concurrent_task_assignment.h"
+
+#include <memory>
+#include <string>
+
+#include "xla/hlo/ir/hlo_computation.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/hlo/ir/hlo_opcode.h"
+#include "xla/service/cpu/cpu_executable.h"
+#include "xla/test.h"
+#include "xla/tests/hlo_test_base.h"
+#include "tsl/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+class ConcurrentTaskAssignmentTest : public HloTestBase {
+ protected:
+  StatusOr<bool> RunConcurrentTaskAssigner(HloModule* module) {
+    return cpu::ConcurrentTaskAssigner(cpu::CpuExecutable::ShapeSizeBytes)
+        .Run(module);
+  }
+};
+
+TEST_F(ConcurrentTaskAssignmentTest, IndependentOpsAssigned) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentTasks
+    ENTRY entry {
+      p0 = f32[256,256]{1,0} parameter(0)
+      p1 = f32[256,256]{1,0} parameter(1)
+      dot0 = f32[256,256]{1,0} dot(p0, p0),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      dot1 = f32[256,256]{1,0} dot(p1, p1),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      ROOT add = f32[256,256]{1,0} add(dot0, dot1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_TRUE(cpu::HasConcurrentTasks(*m));
+
+  // The dots are called by the computation of concurrent tasks, whose results
+  // the add reads back from its tuple.
+  const HloInstruction* add = m->entry_computation()->root_instruction();
+  ASSERT_EQ(add->opcode(), HloOpcode::kAdd);
+  const HloInstruction* concurrent_call = add->operand(0)->operand(0);
+  ASSERT_EQ(concurrent_call->opcode(), HloOpcode::kCall);
+  EXPECT_EQ(add->operand(1)->operand(0), concurrent_call);
+  const HloComputation* tasks = concurrent_call->to_apply();
+  EXPECT_TRUE(cpu::IsConcurrentTaskComputation(*tasks));
+  int num_tasks = 0;
+  for (const HloInstruction* instruction : tasks->instructions()) {
+    if (instruction->opcode() == HloOpcode::kCall) {
+      ++num_tasks;
+      EXPECT_EQ(instruction->to_apply()->root_instruction()->opcode(),
+                HloOpcode::kDot);
+    }
+  }
+  EXPECT_EQ(num_tasks, 2);
+}
+
+TEST_F(ConcurrentTaskAssignmentTest, DependentOpsNotAssigned) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentTasks_Dependent
+    ENTRY entry {
+      p0 = f32[256,256]{1,0} parameter(0)
+      dot0 = f32[256,256]{1,0} dot(p0, p0),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+      ROOT dot1 = f32[256,256]{1,0} dot(dot0, dot0),
+        lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+  EXPECT_FALSE(cpu::HasConcurrentTasks(*m));
+}
+
+TEST_F(ConcurrentTaskAssignmentTest, CheapOpsNotAssigned) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentTasks_Cheap
+    ENTRY entry {
+      p0 = f32[16]{0} parameter(0)
+      p1 = f32[16]{0} parameter(1)
+      exp = f32[16]{0} exponential(p0)
+      log = f32[16]{0} log(p1)
+      ROOT add = f32[16]{0} add(exp, log)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ConcurrentTaskAssignmentTest, SideEffectingOpsNotAssigned) {
+  const std::string hlo_string = R"(
+    HloModule TestConcurrentTasks_SideEffects
+    ENTRY entry {
+      p0 = f32[] parameter(0)
+      p1 = f32[] parameter(1)
+      rng0 = f32[1024,1024]{1,0} rng(p0, p1), distribution=rng_uniform
+      rng1 = f32[1024,1024]{1,0} rng(p0, p1), distribution=rng_uniform
+      ROOT add = f32[1024,1024]{1,0} add(rng0, rng1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunConcurrentTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace xla
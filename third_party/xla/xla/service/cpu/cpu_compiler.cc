@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "xla/service/cpu/cpu_compiler.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
@@ -42,8 +43,11 @@ limitations under the License.
 #include "absl/strings/string_view.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
@@ -55,6 +59,7 @@ limitations under the License.
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -62,6 +67,7 @@ limitations under the License.
 #include "llvm/TargetParser/Host.h"
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/TargetParser/X86TargetParser.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"  // from @llvm-project
 #include "mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h"  // from @llvm-project
 #include "mlir/Dialect/Affine/IR/AffineOps.h"  // from @llvm-project
@@ -135,6 +141,7 @@ limitations under the License.
 #include "xla/service/copy_insertion.h"
 #include "xla/service/cpu/buffer_info_util.h"
 #include "xla/service/cpu/compiler_functor.h"
+#include "xla/service/cpu/concurrent_task_assignment.h"
 #include "xla/service/cpu/conv_canonicalization.h"
 #include "xla/service/cpu/cpu_executable.h"
 #include "xla/service/cpu/cpu_instruction_fusion.h"
@@ -143,6 +150,7 @@ limitations under the License.
 #include "xla/service/cpu/dot_op_emitter.h"
 #include "xla/service/cpu/hlo_xla_runtime_pipeline.h"
 #include "xla/service/cpu/ir_emitter.h"
+#include "xla/service/cpu/object_file_cache.h"
 #include "xla/service/cpu/parallel_task_assignment.h"
 #include "xla/service/cpu/runtime/collectives.h"
 #include "xla/service/cpu/runtime/convolution_call.h"
@@ -227,12 +235,15 @@ limitations under the License.
 #include "xla/util.h"
 #include "xla/xla.pb.h"
 #include "xla/xla_data.pb.h"
+#include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/casts.h"
 #include "tsl/platform/cpu_info.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/logging.h"  // IWYU pragma: keep
 #include "tsl/platform/status.h"
 #include "tsl/platform/statusor.h"
+#include "tsl/platform/threadpool.h"
 
 #if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
 #include "xla/service/cpu/onednn_rewriter.h"
@@ -698,9 +709,10 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
   // Rewrite to custom calls with target as oneDNN library calls.
 #if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
   // AOT compiled code runs in single thread.
-  if (!is_aot_compile) {
-    // Temporarily disabling oneDNN rewriter because it causes JAX regression.
-    // pipeline.AddPass<OneDnnRewriter>();
+  // The oneDNN rewriter is opt-in because it caused JAX regressions.
+  if (!is_aot_compile &&
+      module->config().debug_options().xla_cpu_enable_onednn_fusion()) {
+    pipeline.AddPass<OneDnnRewriter>();
   }
 #endif  // INTEL_MKL && ENABLE_ONEDNN_V3
 
@@ -934,6 +946,12 @@ Status CpuCompiler::RunHloPassesAfterLayoutAssn(
     // TODO(b/29630486) Support multi-threaded AOT.
     pipeline.AddPass<ParallelTaskAssigner>(
         max_parallelism, ShapeSizeBytesFunction(), target_machine_features);
+    // The concurrent tasks are lowered to calls of the fork/join runtime by
+    // the IrEmitter.
+    if (!is_mlir_compile &&
+        module->config().debug_options().xla_cpu_enable_concurrent_ops()) {
+      pipeline.AddPass<ConcurrentTaskAssigner>(ShapeSizeBytesFunction());
+    }
   }
   // Copy insertion should be performed immediately before IR emission to
   // avoid inserting unnecessary copies (later pass adds an instruction which
@@ -965,6 +983,18 @@ int64_t memory_alignment(LogicalBuffer::Color) {
   return cpu_function_runtime::MinAlign();
 }
 
+// Returns the ordering of the HLOs of 'module' to assign its buffers with. The
+// 'schedule' of the HLOs enables tighter buffer liveness analysis and reduced
+// memory usage, but the concurrent tasks of a module only run in the order of
+// their dependencies.
+std::unique_ptr<HloOrdering> CreateHloOrdering(const HloModule* module,
+                                               const HloSchedule& schedule) {
+  if (HasConcurrentTasks(*module)) {
+    return std::make_unique<DependencyHloOrdering>(module);
+  }
+  return std::make_unique<SequentialHloOrdering>(schedule);
+}
+
 llvm::TargetOptions CompilerTargetOptions(
     const HloModuleConfig& module_config) {
   llvm::TargetOptions target_options;
@@ -991,7 +1021,8 @@ llvm::CodeGenOptLevel CodeGenOptLevel(const HloModuleConfig& module_config) {
 std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
     const HloModule& hlo_module,
     const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
-    const LLVMCompiler::ModuleHook& user_post_optimization_hook) {
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    absl::string_view filename_suffix = "") {
   // Create the IR hooks. If applicable, each IR hook does the following:
   //
   //  * Calls the user supplied module hook.
@@ -999,14 +1030,14 @@ std::pair<LLVMCompiler::ModuleHook, LLVMCompiler::ModuleHook> GetIRModuleHooks(
   //    --xla_dump_to
   const HloModule* hlo_module_ptr = &hlo_module;
   auto hook = [user_pre_optimization_hook, user_post_optimization_hook,
-               hlo_module_ptr](bool optimized,
-                               const llvm::Module& llvm_module) {
+               hlo_module_ptr, suffix = std::string(filename_suffix)](
+                  bool optimized, const llvm::Module& llvm_module) {
     const auto& user_hook =
         !optimized ? user_pre_optimization_hook : user_post_optimization_hook;
     if (user_hook) {
       user_hook(llvm_module);
     }
-    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized);
+    llvm_ir::DumpIrIfEnabled(*hlo_module_ptr, llvm_module, optimized, suffix);
   };
   return {[hook](const llvm::Module& llvm_module) {
             return hook(/*optimized=*/false, llvm_module);
@@ -1097,10 +1128,9 @@ StatusOr<std::unique_ptr<BufferAssignment>> CpuCompiler::AssignBuffers(
   // Run buffer allocation on the HLO graph.
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<BufferAssignment> assignment,
-      BufferAssigner::Run(
-          module, std::make_unique<SequentialHloOrdering>(module->schedule()),
-          BufferSizeBytesFunction(), memory_alignment,
-          /*allocate_buffers_for_constants=*/true));
+      BufferAssigner::Run(module, CreateHloOrdering(module, module->schedule()),
+                          BufferSizeBytesFunction(), memory_alignment,
+                          /*allocate_buffers_for_constants=*/true));
 
   return std::move(assignment);
 }
@@ -1112,11 +1142,15 @@ namespace {
 // Dumps machine code if dumping is enabled for the module.
 struct OrcJITPostCompilationHook {
   // Gets an std::function that implements this hook.
+  //
+  // The machine code of the shards of a module compiled in parallel is dumped
+  // to different files, distinguished by `filename_suffix`.
   static std::function<void(const llvm::object::ObjectFile& obj_file)> Create(
-      const HloModule* module) {
+      const HloModule* module, absl::string_view filename_suffix = "") {
     // This struct is not copyable, but std::functions must be.  So to create an
     // std::function out of this struct, we have to wrap it in a shared_ptr.
-    auto wrapped = std::make_shared<OrcJITPostCompilationHook>(module);
+    auto wrapped =
+        std::make_shared<OrcJITPostCompilationHook>(module, filename_suffix);
     return [wrapped](const llvm::object::ObjectFile& obj_file) {
       (*wrapped)(obj_file);
     };
@@ -1124,22 +1158,183 @@ struct OrcJITPostCompilationHook {
 
   // Constructor can't be private because we want to call it from
   // std::make_shared, but users should call Create() instead.
-  explicit OrcJITPostCompilationHook(const HloModule* module)
-      : module(module) {}
+  OrcJITPostCompilationHook(const HloModule* module,
+                            absl::string_view filename_suffix)
+      : module(module),
+        file_suffix(filename_suffix.empty()
+                        ? "o"
+                        : absl::StrCat(filename_suffix, ".o")) {}
 
  private:
   void operator()(const llvm::object::ObjectFile& obj_file) {
     if (!DumpingEnabledForHloModule(*module)) {
       return;
     }
-    DumpToFileInDir(*module, /*file_prefix=*/"", /*file_suffix=*/"o",
+    DumpToFileInDir(*module, /*file_prefix=*/"", file_suffix,
                     absl::string_view(obj_file.getData().data(),
                                       obj_file.getData().size()));
   }
 
   const HloModule* module;
+  const std::string file_suffix;
 };
 
+// Copies `module` into `context`, so that it can be compiled on another
+// thread.
+std::unique_ptr<llvm::Module> CopyToContext(const llvm::Module& module,
+                                            llvm::LLVMContext& context) {
+  llvm::SmallString<0> bitcode;
+  llvm::raw_svector_ostream bitcode_ostream(bitcode);
+  llvm::WriteBitcodeToFile(module, bitcode_ostream);
+
+  llvm::Expected<std::unique_ptr<llvm::Module>> new_module =
+      llvm::parseBitcodeFile(
+          llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()),
+                                "split_module"),
+          context);
+  CHECK(new_module) << "Failed to parse bitcode "
+                    << llvm::toString(new_module.takeError());
+  return std::move(new_module.get());
+}
+
+// Compiles `llvm_module` to machine code added to `jit`, instead of letting
+// the JIT compile it as a whole.
+//
+// The module is split into up to `split_count` shards, one per group of
+// functions, which are optimized and compiled in parallel. Their objects are
+// linked by the JIT. If `cache` isn't null, the objects of the shards which
+// were compiled before, e.g. by a previous process, are reused from it, and
+// the others are stored in it.
+//
+// The user hooks may be called concurrently, once per shard.
+Status CompileLlvmModuleInShards(
+    const HloModule& hlo_module, std::unique_ptr<llvm::Module> llvm_module,
+    int split_count, const ObjectFileCache* cache,
+    const LLVMCompiler::ModuleHook& user_pre_optimization_hook,
+    const LLVMCompiler::ModuleHook& user_post_optimization_hook,
+    SimpleOrcJIT& jit) {
+  XLA_SCOPED_LOGGING_TIMER("CpuCompiler - Compiling LLVM module in shards");
+  const HloModuleConfig& config = hlo_module.config();
+  const llvm::CodeGenOptLevel opt_level = CodeGenOptLevel(config);
+  const bool optimize_for_size = options::OptimizeForSizeRequested(config);
+  const bool disable_expensive_passes =
+      config.debug_options().xla_llvm_disable_expensive_passes();
+  const bool disable_slp_vectorizer = options::SlpVectorizerDisabled(config);
+  const llvm::FastMathFlags fast_math_flags =
+      llvm_ir::GetCpuFastMathFlags(config);
+
+  // The options which change the generated code, besides the target machine,
+  // to key the cached objects.
+  std::string codegen_options;
+  llvm::raw_string_ostream codegen_options_ostream(codegen_options);
+  codegen_options_ostream << static_cast<int>(opt_level) << ";"
+                          << optimize_for_size << ";"
+                          << disable_expensive_passes << ";"
+                          << disable_slp_vectorizer << ";";
+  fast_math_flags.print(codegen_options_ostream);
+  codegen_options_ostream.flush();
+
+  int num_functions = 0;
+  for (const llvm::Function& function : llvm_module->functions()) {
+    if (!function.isDeclaration()) {
+      num_functions++;
+    }
+  }
+  std::vector<std::unique_ptr<llvm::Module>> shards;
+  const int num_shards = std::min(split_count, num_functions);
+  if (num_shards > 1) {
+    // The local symbols referenced by several shards are made external, so
+    // that the JIT links them.
+    llvm::SplitModule(
+        *llvm_module, num_shards,
+        [&](std::unique_ptr<llvm::Module> shard) {
+          shards.push_back(std::move(shard));
+        },
+        /*PreserveLocals=*/false);
+  } else {
+    shards.push_back(std::move(llvm_module));
+  }
+
+  // Compiles the shard `i` in `context`, or returns its cached object.
+  auto compile_shard = [&](int i, llvm::LLVMContext* context)
+      -> StatusOr<std::unique_ptr<llvm::MemoryBuffer>> {
+    std::unique_ptr<llvm::Module> copy;
+    llvm::Module* shard = shards[i].get();
+    if (context != nullptr) {
+      copy = CopyToContext(*shard, *context);
+      shard = copy.get();
+    }
+    // The target machines aren't thread-safe, so each shard has its own.
+    std::unique_ptr<llvm::TargetMachine> target_machine =
+        SimpleOrcJIT::InferTargetMachineForJIT(CompilerTargetOptions(config),
+                                               opt_level);
+    std::string key;
+    if (cache != nullptr) {
+      key = ObjectFileCache::Key(*shard, *target_machine, codegen_options);
+      if (std::unique_ptr<llvm::MemoryBuffer> object = cache->Lookup(key)) {
+        VLOG(2) << "Reusing the cached object " << key << " of shard " << i;
+        return std::move(object);
+      }
+    }
+    const std::string filename_suffix =
+        shards.size() > 1 ? absl::StrCat("shard-", i) : "";
+    LLVMCompiler::ModuleHook pre_optimization_ir_hook;
+    LLVMCompiler::ModuleHook post_optimization_ir_hook;
+    std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
+        GetIRModuleHooks(hlo_module, user_pre_optimization_hook,
+                         user_post_optimization_hook, filename_suffix);
+    CompilerFunctor compiler(
+        target_machine.get(), static_cast<int>(opt_level), optimize_for_size,
+        disable_expensive_passes, disable_slp_vectorizer, fast_math_flags,
+        std::move(pre_optimization_ir_hook),
+        std::move(post_optimization_ir_hook),
+        OrcJITPostCompilationHook::Create(&hlo_module, filename_suffix));
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+        compiler(*shard);
+    if (!object) {
+      return InternalError("Compiling shard %d failed: %s", i,
+                           llvm::toString(object.takeError()));
+    }
+    if (cache != nullptr) {
+      Status status = cache->Store(key, (*object)->getBuffer());
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to cache the object of shard " << i << ": "
+                     << status;
+      }
+    }
+    return std::move(*object);
+  };
+
+  std::vector<StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> objects(
+      shards.size());
+  if (shards.size() == 1) {
+    objects[0] = compile_shard(0, /*context=*/nullptr);
+  } else {
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(),
+                                        "xla_cpu_parallel_codegen",
+                                        static_cast<int>(shards.size()));
+    tsl::BlockingCounter counter(shards.size());
+    for (int i = 0; i < shards.size(); ++i) {
+      thread_pool.Schedule([&, i] {
+        // Each thread has its own context to avoid race conditions.
+        llvm::LLVMContext context;
+        objects[i] = compile_shard(i, &context);
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+
+  for (auto& object : objects) {
+    TF_RETURN_IF_ERROR(object.status());
+    if (llvm::Error error = jit.AddObjectFile(std::move(*object))) {
+      return InternalError("Adding an object to the JIT failed: %s",
+                           llvm::toString(std::move(error)));
+    }
+  }
+  return absl::OkStatus();
+}
+
 void InitializeLLVMCommandLineOptions(const HloModuleConfig& config) {
   llvm_ir::InitializeLLVMCommandLineOptions(
       config.debug_options().xla_backend_extra_options());
@@ -1393,7 +1588,7 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   TF_ASSIGN_OR_RETURN(
       std::unique_ptr<BufferAssignment> assignment,
       BufferAssigner::Run(module.get(),
-                          std::make_unique<SequentialHloOrdering>(schedule),
+                          CreateHloOrdering(module.get(), schedule),
                           BufferSizeBytesFunction(), memory_alignment,
                           /*allocate_buffers_for_constants=*/true));
   DumpHloModuleIfEnabled(*module, *assignment,
@@ -1460,9 +1655,23 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  const DebugOptions& debug_options = module->config().debug_options();
+  if (debug_options.xla_cpu_parallel_codegen_split_count() > 1 ||
+      !debug_options.xla_cpu_compilation_cache_dir().empty()) {
+    std::optional<ObjectFileCache> cache;
+    if (!debug_options.xla_cpu_compilation_cache_dir().empty()) {
+      cache.emplace(debug_options.xla_cpu_compilation_cache_dir());
+    }
+    TF_RETURN_IF_ERROR(CompileLlvmModuleInShards(
+        *module, std::move(llvm_module),
+        debug_options.xla_cpu_parallel_codegen_split_count(),
+        cache.has_value() ? &*cache : nullptr, user_pre_optimization_hook_,
+        user_post_optimization_hook_, **jit));
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   TF_ASSIGN_OR_RETURN(
       auto cpu_executable,
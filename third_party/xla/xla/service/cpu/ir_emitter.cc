@@ -58,6 +58,7 @@ limitations under the License.
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/collective_ops_utils.h"
 #include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/concurrent_task_assignment.h"
 #include "xla/service/cpu/cpu_options.h"
 #include "xla/service/cpu/cpu_runtime.h"
 #include "xla/service/cpu/dot_op_emitter.h"
@@ -85,6 +86,7 @@ limitations under the License.
 
 #if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
 #include "xla/service/cpu/onednn_memory_util.h"
+#include "tsl/platform/fingerprint.h"
 #endif
 
 namespace xla {
@@ -174,6 +176,7 @@ StatusOr<llvm::Function*> IrEmitter::EmitComputation(
   is_top_level_computation_ = is_top_level_computation;
   allow_reassociation_ = allow_reassociation;
   num_dynamic_loop_bounds_ = 0;
+  concurrent_tasks_emitted_ = false;
   auto backend_config_or =
       computation->root_instruction()->backend_config<BackendConfig>();
   if (backend_config_or.ok() &&
@@ -2227,6 +2230,15 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
 
   TF_RETURN_IF_ERROR(EmitTargetAddressForOp(call));
 
+  if (IsConcurrentTaskComputation(*call->parent())) {
+    // All the calls of a computation of concurrent tasks run together.
+    if (!concurrent_tasks_emitted_) {
+      TF_RETURN_IF_ERROR(EmitConcurrentTasks(*call->parent()));
+      concurrent_tasks_emitted_ = true;
+    }
+    return OkStatus();
+  }
+
   auto backend_config_or =
       computation->root_instruction()->backend_config<BackendConfig>();
   if (backend_config_or.ok() &&
@@ -2253,7 +2265,7 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
     TF_RETURN_IF_ERROR(EmitCallToParallelForkJoin(
         call_args, root->shape(),
         backend_config_or->outer_dimension_partitions(), &b_, call_ir_function,
-        computation->name()));
+        computation->name(), runtime::kParallelForkJoinSymbolName));
 
     if (ComputationTransitivelyContainsCustomCall(computation)) {
       EmitEarlyReturnIfErrorStatus();
@@ -2410,38 +2422,91 @@ Status IrEmitter::HandleTopK(HloInstruction* hlo) {
 }
 
 #if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
-Status IrEmitter::HandleOneDnnMatMul(HloInstruction* custom_call) {
-  auto lhs = custom_call->operand(0);
-  llvm_ir::IrArray lhs_array(GetIrArrayFor(lhs));
-  auto lhs_stack_alloca = GetAllocaAndEmitMemrefInfo(b_, lhs_array);
+namespace {
 
-  auto rhs = custom_call->operand(1);
-  llvm_ir::IrArray rhs_array(GetIrArrayFor(rhs));
-  auto rhs_stack_alloca = GetAllocaAndEmitMemrefInfo(b_, rhs_array);
+// Returns the fingerprint of 'weights' if it is a constant, which the oneDNN
+// runtime then reorders only once, or 0.
+uint64_t ConstantWeightsFingerprint(const HloInstruction* weights) {
+  if (weights->opcode() != HloOpcode::kConstant) {
+    return 0;
+  }
+  const Literal& literal = weights->literal();
+  return std::max<uint64_t>(
+      1, tsl::Fingerprint64(absl::string_view(
+             static_cast<const char*>(literal.untyped_data()),
+             literal.size_bytes())));
+}
 
-  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(custom_call));
-  llvm_ir::IrArray result_array = GetIrArrayFor(custom_call);
-  auto result_stack_alloca = GetAllocaAndEmitMemrefInfo(b_, result_array);
+}  // namespace
 
-  auto typed_custom_call = Cast<HloCustomCallInstruction>(custom_call);
-  auto backend_config = typed_custom_call->backend_config<BackendConfig>();
+Status IrEmitter::HandleOneDnnMatMul(HloInstruction* custom_call) {
+  TF_ASSIGN_OR_RETURN(auto backend_config,
+                      custom_call->backend_config<BackendConfig>());
   OneDnnMatMulConfig matmul_config;
-  matmul_config.CopyFrom(backend_config->onednn_matmul_config());
+  matmul_config.CopyFrom(backend_config.onednn_matmul_config());
+  matmul_config.set_constant_weights_fingerprint(
+      ConstantWeightsFingerprint(custom_call->operand(1)));
   std::string str_config;
   matmul_config.SerializeToString(&str_config);
+  return EmitOneDnnCall(custom_call, runtime::kOneDnnMatMulSymbolName,
+                        str_config);
+}
 
-  EmitCallToFunc(runtime::kOneDnnMatMulSymbolName,
-                 {
-                     GetExecutableRunOptionsArgument(),
-                     lhs_stack_alloca.value,
-                     rhs_stack_alloca.value,
-                     result_stack_alloca.value,
-                     b_.CreateGlobalStringPtr(llvm_ir::AsStringRef(str_config)),
-                 },
-                 b_.getVoidTy());
+Status IrEmitter::HandleOneDnnConvolution(HloInstruction* custom_call) {
+  TF_ASSIGN_OR_RETURN(auto backend_config,
+                      custom_call->backend_config<BackendConfig>());
+  OneDnnConvolutionConfig conv_config;
+  conv_config.CopyFrom(backend_config.onednn_conv_config());
+  conv_config.set_constant_weights_fingerprint(
+      ConstantWeightsFingerprint(custom_call->operand(1)));
+  std::string str_config;
+  conv_config.SerializeToString(&str_config);
+  return EmitOneDnnCall(custom_call, runtime::kOneDnnConvolutionSymbolName,
+                        str_config);
+}
+
+Status IrEmitter::EmitOneDnnCall(HloInstruction* custom_call,
+                                 absl::string_view symbol_name,
+                                 const std::string& config) {
+  // The arguments of the runtime call, see onednn_matmul.h. The serialized
+  // config may hold null bytes, hence its size.
+  const int64_t num_args = 4 + custom_call->operand_count();
+  llvm::Value* num_args_ptr = llvm_ir::EmitAllocaAtFunctionEntry(
+      b_.getInt64Ty(), "onednn_num_args", &b_);
+  Store(b_.getInt64(num_args), num_args_ptr);
+  llvm::Value* config_size_ptr = llvm_ir::EmitAllocaAtFunctionEntry(
+      b_.getInt64Ty(), "onednn_config_size", &b_);
+  Store(b_.getInt64(config.size()), config_size_ptr);
+  std::vector<llvm::Value*> args = {
+      num_args_ptr,
+      GetExecutableRunOptionsArgument(),
+      b_.CreateGlobalStringPtr(llvm_ir::AsStringRef(config)),
+      config_size_ptr,
+  };
+
+  std::vector<StackAlloca> operand_stack_allocas;
+  for (HloInstruction* operand : custom_call->operands()) {
+    llvm_ir::IrArray operand_array(GetIrArrayFor(operand));
+    operand_stack_allocas.push_back(
+        GetAllocaAndEmitMemrefInfo(b_, operand_array));
+    args.push_back(operand_stack_allocas.back().value);
+  }
+  llvm::Value* args_ptr = llvm_ir::EmitAllocaAtFunctionEntryWithCount(
+      b_.getPtrTy(), b_.getInt32(num_args), "onednn_args", &b_);
+  for (int64_t i = 0; i < num_args; ++i) {
+    Store(args[i], b_.CreateConstInBoundsGEP1_64(b_.getPtrTy(), args_ptr, i));
+  }
+
+  TF_RETURN_IF_ERROR(EmitTargetAddressForOp(custom_call));
+  llvm_ir::IrArray result_array = GetIrArrayFor(custom_call);
+  auto result_stack_alloca = GetAllocaAndEmitMemrefInfo(b_, result_array);
+
+  EmitCallToFunc(std::string(symbol_name),
+                 {result_stack_alloca.value, args_ptr}, b_.getVoidTy());
 
-  lhs_stack_alloca.EmitLifetimeEnd();
-  rhs_stack_alloca.EmitLifetimeEnd();
+  for (StackAlloca& operand_stack_alloca : operand_stack_allocas) {
+    operand_stack_alloca.EmitLifetimeEnd();
+  }
   result_stack_alloca.EmitLifetimeEnd();
 
   return OkStatus();
@@ -2462,6 +2527,9 @@ Status IrEmitter::HandleCustomCall(HloInstruction* custom_call) {
   if (custom_call->custom_call_target() == "__onednn$matmul") {
     return HandleOneDnnMatMul(custom_call);
   }
+  if (custom_call->custom_call_target() == "__onednn$convolution") {
+    return HandleOneDnnConvolution(custom_call);
+  }
 #endif  // INTEL_MKL && ENABLE_ONEDNN_V3
   absl::Span<HloInstruction* const> operands(custom_call->operands());
   llvm::AllocaInst* operands_alloca =
@@ -3530,6 +3598,68 @@ void IrEmitter::EmitGlobalCall(const HloComputation& callee,
   }
 }
 
+Status IrEmitter::EmitConcurrentTasks(const HloComputation& computation) {
+  std::vector<const HloComputation*> tasks;
+  for (const HloInstruction* instruction : computation.instructions()) {
+    if (instruction->opcode() == HloOpcode::kCall) {
+      tasks.push_back(instruction->to_apply());
+    }
+  }
+  const int64_t num_tasks = tasks.size();
+  TF_RET_CHECK(num_tasks > 1);
+
+  // Emit a function which makes the global call of the task given by the
+  // start of its dynamic loop bounds, in place of a partition of an output.
+  std::unique_ptr<IrFunction> caller_function = std::move(compute_function_);
+  compute_function_ = std::make_unique<IrFunction>(
+      name_uniquer_.GetUniqueName(
+          absl::StrCat(computation.name(), "_concurrent_tasks")),
+      llvm::GlobalValue::InternalLinkage, hlo_module_config_, module_, &b_,
+      /*num_dynamic_loop_bounds=*/1);
+  llvm::Function* tasks_function = compute_function_->function();
+  llvm::Value* task_index = compute_function_->GetDynamicLoopBounds()[0].first;
+  llvm::BasicBlock* done_block = llvm::BasicBlock::Create(
+      module_->getContext(), "concurrent_tasks_done", tasks_function);
+  llvm::SwitchInst* task_switch =
+      b_.CreateSwitch(task_index, done_block, num_tasks);
+  for (int64_t i = 0; i < num_tasks; ++i) {
+    llvm::BasicBlock* task_block = llvm::BasicBlock::Create(
+        module_->getContext(), absl::StrCat("concurrent_task_", i),
+        tasks_function);
+    task_switch->addCase(b_.getInt64(i), task_block);
+    b_.SetInsertPoint(task_block);
+    EmitGlobalCall(*tasks[i], tasks[i]->name());
+    b_.CreateBr(done_block);
+  }
+  b_.SetInsertPoint(done_block);
+  // Deleting the tasks function finalizes it and restores the caller IR
+  // insert point.
+  compute_function_.reset();
+  compute_function_ = std::move(caller_function);
+
+  // The concurrent fork/join runtime calls the tasks function once for each
+  // task, with the loop bounds of the partitions of a shape of one element per
+  // task.
+  std::vector<llvm::Value*> call_args = GetArrayFunctionCallArguments(
+      {}, &b_, computation.name(),
+      /*return_value_buffer=*/llvm::Constant::getNullValue(b_.getPtrTy()),
+      /*exec_run_options_arg=*/GetExecutableRunOptionsArgument(),
+      /*buffer_table_arg=*/GetBufferTableArgument(),
+      /*status_arg=*/GetStatusArgument(),
+      /*profile_counters_arg=*/GetProfileCountersArgument());
+  TF_RETURN_IF_ERROR(EmitCallToParallelForkJoin(
+      call_args, ShapeUtil::MakeShapeWithDescendingLayout(PRED, {num_tasks}),
+      {num_tasks}, &b_, tasks_function, computation.name(),
+      runtime::kConcurrentForkJoinSymbolName));
+
+  if (absl::c_any_of(tasks, [&](const HloComputation* task) {
+        return ComputationTransitivelyContainsCustomCall(task);
+      })) {
+    EmitEarlyReturnIfErrorStatus();
+  }
+  return OkStatus();
+}
+
 llvm::Value* IrEmitter::GetBufferForGlobalCallReturnValue(
     const HloComputation& callee) {
   const HloInstruction* root_inst = callee.root_instruction();
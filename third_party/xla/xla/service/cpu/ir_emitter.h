@@ -195,6 +195,12 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   Status HandleAllReduceMultipleReplica(HloInstruction* crs);
 #if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
   Status HandleOneDnnMatMul(HloInstruction* hlo);
+  Status HandleOneDnnConvolution(HloInstruction* hlo);
+  // Emits a call to the oneDNN runtime function 'symbol_name' with the
+  // serialized 'config' and the operands of 'custom_call'.
+  Status EmitOneDnnCall(HloInstruction* custom_call,
+                        absl::string_view symbol_name,
+                        const std::string& config);
 #endif  // INTEL_MKL && ENABLE_ONEDNN_V3
   // Private helper to initialize an IR function for the computation.
   void InitializeIrFunction(const std::string& function_name);
@@ -306,6 +312,11 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   // to explicitly pass parameters or return results.
   void EmitGlobalCall(const HloComputation& callee, absl::string_view name);
 
+  // Emits a call to the concurrent fork/join runtime, which runs all the
+  // global calls of 'computation' (see ConcurrentTaskAssigner) concurrently
+  // with each other.
+  Status EmitConcurrentTasks(const HloComputation& computation);
+
   // Returns the buffer to which a global call to `callee` would have written
   // its result.
   llvm::Value* GetBufferForGlobalCallReturnValue(const HloComputation& callee);
@@ -544,6 +555,10 @@ class IrEmitter : public DfsHloVisitorWithDefault,
   // ParallelLoopEmitter).
   int64_t num_dynamic_loop_bounds_ = 0;
 
+  // Whether the concurrent tasks of the computation being emitted have been
+  // emitted, which happens with its first call.
+  bool concurrent_tasks_emitted_ = false;
+
   // Returns whether the given instruction should be emitted as a parallel loop.
   bool ShouldEmitParallelLoopFor(const HloInstruction& op) const {
     // Emit parallel loop for root instruction if dynamic outer-dimension loop
@@ -237,7 +237,8 @@ std::vector<llvm::Value*> GetArrayFunctionCallArguments(
 Status EmitCallToParallelForkJoin(
     const std::vector<llvm::Value*>& arguments, const Shape& shape,
     absl::Span<const int64_t> dimension_partition_counts, llvm::IRBuilder<>* b,
-    llvm::Function* parallel_function, absl::string_view name) {
+    llvm::Function* parallel_function, absl::string_view name,
+    llvm::StringRef fork_join_symbol_name) {
   llvm::Module* module = b->GetInsertBlock()->getModule();
 
   // Build ParallelForkJoin function type.
@@ -262,8 +263,7 @@ Status EmitCallToParallelForkJoin(
 
   llvm::Function* fork_join_func = llvm::dyn_cast<llvm::Function>(
       module
-          ->getOrInsertFunction(runtime::kParallelForkJoinSymbolName,
-                                fork_join_type)
+          ->getOrInsertFunction(fork_join_symbol_name, fork_join_type)
           .getCallee());
   fork_join_func->setCallingConv(llvm::CallingConv::C);
   fork_join_func->setDoesNotThrow();
@@ -17,6 +17,7 @@ limitations under the License.
 #define XLA_SERVICE_CPU_IR_FUNCTION_H_
 
 #include "absl/types/span.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Module.h"
@@ -145,10 +146,13 @@ std::vector<llvm::Value*> GetArrayFunctionCallArguments(
 
 // Emits a call to a runtime fork/join function which dispatches parallel
 // calls to 'parallel_function' (and joins threads before returning).
+// 'fork_join_symbol_name' names the runtime fork/join function, either
+// ParallelForkJoin or ConcurrentForkJoin.
 Status EmitCallToParallelForkJoin(
     const std::vector<llvm::Value*>& arguments, const Shape& shape,
     absl::Span<const int64_t> dimension_partition_counts, llvm::IRBuilder<>* b,
-    llvm::Function* parallel_function, absl::string_view name);
+    llvm::Function* parallel_function, absl::string_view name,
+    llvm::StringRef fork_join_symbol_name);
 
 }  // namespace cpu
 }  // namespace xla
@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/object_file_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "xla/status.h"
+#include "xla/util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
+#include "tsl/platform/path.h"
+
+namespace xla {
+namespace cpu {
+
+/*static*/ std::string ObjectFileCache::Key(
+    const llvm::Module& module, const llvm::TargetMachine& target_machine,
+    absl::string_view options) {
+  std::string bitcode;
+  llvm::raw_string_ostream bitcode_ostream(bitcode);
+  llvm::WriteBitcodeToFile(module, bitcode_ostream);
+  bitcode_ostream.flush();
+
+  const std::string target = absl::StrCat(
+      target_machine.getTargetTriple().str(), ";",
+      target_machine.getTargetCPU().str(), ";",
+      target_machine.getTargetFeatureString().str(), ";", LLVM_VERSION_STRING,
+      ";", options);
+  const tsl::Fprint128 fingerprint = tsl::FingerprintCat128(
+      tsl::Fingerprint128(bitcode), tsl::Fingerprint128(target));
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> ObjectFileCache::Lookup(
+    absl::string_view key) const {
+  std::string object;
+  if (!tsl::ReadFileToString(tsl::Env::Default(), Path(key), &object).ok()) {
+    return nullptr;
+  }
+  return llvm::MemoryBuffer::getMemBufferCopy(object,
+                                              absl::StrCat("cached_", key));
+}
+
+Status ObjectFileCache::Store(absl::string_view key,
+                              llvm::StringRef object) const {
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir_));
+  // Write to a file of this process, which is renamed once complete.
+  std::string temp_path = Path(key);
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return InternalError("Failed to create a temporary file name for %s",
+                         Path(key));
+  }
+  TF_RETURN_IF_ERROR(tsl::WriteStringToFile(
+      env, temp_path, absl::string_view(object.data(), object.size())));
+  Status status = env->RenameFile(temp_path, Path(key));
+  if (!status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return status;
+}
+
+std::string ObjectFileCache::Path(absl::string_view key) const {
+  return tsl::io::JoinPath(dir_, absl::StrCat(key, ".o"));
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,68 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_OBJECT_FILE_CACHE_H_
+#define XLA_SERVICE_CPU_OBJECT_FILE_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Target/TargetMachine.h"
+#include "xla/status.h"
+
+namespace xla {
+namespace cpu {
+
+// A persistent cache of the object files compiled from LLVM modules, stored in
+// a directory, so that the processes compiling the same programs again, e.g.
+// after a restart, don't have to optimize and compile them to machine code.
+//
+// The directory may be shared by several processes: the objects are written
+// to temporary files which are then renamed, so that they are never read
+// partially written.
+class ObjectFileCache {
+ public:
+  explicit ObjectFileCache(std::string dir) : dir_(std::move(dir)) {}
+
+  // Returns the key of the object compiled from `module` for `target_machine`.
+  // It's the fingerprint of the module's bitcode, of the target, CPU and
+  // features of `target_machine`, of the LLVM version, and of `options`, which
+  // describe the other options the module is compiled with, e.g. the
+  // optimization level.
+  static std::string Key(const llvm::Module& module,
+                         const llvm::TargetMachine& target_machine,
+                         absl::string_view options);
+
+  // Returns the object of `key`, or nullptr if it isn't in the cache.
+  std::unique_ptr<llvm::MemoryBuffer> Lookup(absl::string_view key) const;
+
+  // Stores `object` as the object of `key`, replacing any previous one.
+  Status Store(absl::string_view key, llvm::StringRef object) const;
+
+ private:
+  std::string Path(absl::string_view key) const;
+
+  const std::string dir_;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // XLA_SERVICE_CPU_OBJECT_FILE_CACHE_H_
@@ -0,0 +1,94 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/cpu/object_file_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Target/TargetOptions.h"
+#include "xla/service/cpu/simple_orc_jit.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class ObjectFileCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    target_machine_ = SimpleOrcJIT::InferTargetMachineForJIT(
+        llvm::TargetOptions(), llvm::CodeGenOptLevel::Default);
+  }
+
+  // Returns a module declaring a function of the given name.
+  std::unique_ptr<llvm::Module> CreateModule(const std::string& name) {
+    auto module = std::make_unique<llvm::Module>("test_module", context_);
+    llvm::Function::Create(
+        llvm::FunctionType::get(llvm::Type::getVoidTy(context_), false),
+        llvm::GlobalValue::ExternalLinkage, name, *module);
+    return module;
+  }
+
+  llvm::LLVMContext context_;
+  std::unique_ptr<llvm::TargetMachine> target_machine_;
+};
+
+TEST_F(ObjectFileCacheTest, KeyDependsOnModuleAndOptions) {
+  auto module = CreateModule("f");
+  const std::string key =
+      ObjectFileCache::Key(*module, *target_machine_, "options");
+
+  EXPECT_EQ(key, ObjectFileCache::Key(*CreateModule("f"), *target_machine_,
+                                      "options"));
+  EXPECT_NE(key, ObjectFileCache::Key(*CreateModule("g"), *target_machine_,
+                                      "options"));
+  EXPECT_NE(key,
+            ObjectFileCache::Key(*module, *target_machine_, "other_options"));
+}
+
+TEST_F(ObjectFileCacheTest, StoreAndLookup) {
+  ObjectFileCache cache(
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "object_file_cache"));
+  EXPECT_EQ(cache.Lookup("key"), nullptr);
+
+  TF_ASSERT_OK(cache.Store("key", "object"));
+  std::unique_ptr<llvm::MemoryBuffer> object = cache.Lookup("key");
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(object->getBuffer(), "object");
+
+  TF_ASSERT_OK(cache.Store("key", "new_object"));
+  object = cache.Lookup("key");
+  ASSERT_NE(object, nullptr);
+  EXPECT_EQ(object->getBuffer(), "new_object");
+  EXPECT_EQ(cache.Lookup("other_key"), nullptr);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
+
+#include "xla/service/cpu/onednn_convolution.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define EIGEN_USE_THREADS
+
+#include "dnnl.hpp"
+#include "absl/base/dynamic_annotations.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "xla/executable_run_options.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/onednn_memory_util.h"
+#include "xla/service/cpu/onednn_util.h"
+#include "xla/service/cpu/runtime_lightweight_check.h"
+#include "tsl/util/onednn_threadpool.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+using dnnl::algorithm;
+using dnnl::convolution_forward;
+using dnnl::engine;
+using dnnl::memory;
+using dnnl::prop_kind;
+using dnnl::stream;
+
+OneDnnPrimitiveCache& ConvolutionCache() {
+  static OneDnnPrimitiveCache* cache = new OneDnnPrimitiveCache();
+  return *cache;
+}
+
+memory::dims ToOneDnnDims(const tsl::protobuf::RepeatedField<int64_t>& dims) {
+  return memory::dims(dims.begin(), dims.end());
+}
+}  // namespace
+
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnConvolution(
+    void* result, void** args) {
+  // args[0]: ptr to nargs
+  // args[1]: ptr to ExecutableRunOptions
+  // args[2]: ptr to OneDnnConvolutionConfig
+  // args[3]: ptr to the size of the config
+  // args[4...]: ptrs to operands
+  int arg_indx = 0;
+  const int64_t num_args = *(static_cast<int64_t*>(args[arg_indx++]));
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(args[arg_indx++]);
+  XLA_LIGHTWEIGHT_CHECK(run_options != nullptr);
+  XLA_LIGHTWEIGHT_CHECK(run_options->intra_op_thread_pool() != nullptr);
+  tsl::OneDnnThreadPool thread_pool(
+      run_options->intra_op_thread_pool()->getPool(), false);
+  engine& cpu_engine = OneDnnCpuEngine();
+#ifndef ENABLE_ONEDNN_OPENMP
+  auto onednn_stream =
+      stream(dnnl::threadpool_interop::make_stream(cpu_engine, &thread_pool));
+#else
+  auto onednn_stream = stream(cpu_engine);
+#endif  // ENABLE_ONEDNN_OPENMP
+
+  const char* config_data = static_cast<const char*>(args[arg_indx++]);
+  const int64_t config_size = *(static_cast<int64_t*>(args[arg_indx++]));
+  std::string config_str(config_data, config_size);
+  OneDnnConvolutionConfig conv_config;
+  XLA_LIGHTWEIGHT_CHECK(conv_config.ParseFromString(config_str));
+
+  MemrefInfo input_minfo(args[arg_indx++]);
+  MemrefInfo kernel_minfo(args[arg_indx++]);
+  MemrefInfo result_minfo(result);
+  std::vector<MemrefInfo> fused_operands;
+  while (arg_indx < num_args) {
+    fused_operands.emplace_back(args[arg_indx++]);
+  }
+
+  // The strides of the memory descriptors keep the layouts of XLA, whatever
+  // the order of the dimensions oneDNN expects.
+  auto src_md = PermuteToOneDnnOrder(input_minfo.GetOneDnnMemDesc(),
+                                     conv_config.input_dims());
+  auto weights_md = PermuteToOneDnnOrder(kernel_minfo.GetOneDnnMemDesc(),
+                                         conv_config.kernel_dims());
+  auto dst_md = PermuteToOneDnnOrder(result_minfo.GetOneDnnMemDesc(),
+                                     conv_config.output_dims());
+
+  // The bias is a vector of the output features.
+  const memory::dims bias_dims = {dst_md.get_dims()[1]};
+  OneDnnFusion fusion(conv_config.fused_ops(), fused_operands, bias_dims,
+                      conv_config.output_dims());
+
+  std::vector<memory::desc> mds = {src_md, weights_md, dst_md};
+  fusion.AppendMemDescs(mds);
+  const bool constant_weights = conv_config.constant_weights_fingerprint() != 0;
+  auto weights_mem = memory(weights_md, cpu_engine, kernel_minfo.Data());
+  std::shared_ptr<const OneDnnPrimitiveCache::Entry> cached =
+      ConvolutionCache().GetOrCreate(
+          OneDnnPrimitiveCache::Key(config_str, mds), [&]() {
+            // Let oneDNN pick the layout of a constant kernel, which is only
+            // reordered once.
+            memory::desc primitive_weights_md =
+                constant_weights
+                    ? memory::desc(weights_md.get_dims(),
+                                   weights_md.get_data_type(),
+                                   memory::format_tag::any)
+                    : weights_md;
+            const memory::dims strides = ToOneDnnDims(conv_config.strides());
+            const memory::dims dilations =
+                ToOneDnnDims(conv_config.dilations());
+            const memory::dims padding_left =
+                ToOneDnnDims(conv_config.padding_left());
+            const memory::dims padding_right =
+                ToOneDnnDims(conv_config.padding_right());
+            dnnl::primitive_attr attributes = fusion.CreateAttributes();
+            auto conv_pd =
+                fusion.has_bias()
+                    ? convolution_forward::primitive_desc(
+                          cpu_engine, prop_kind::forward_inference,
+                          algorithm::convolution_direct, src_md,
+                          primitive_weights_md, fusion.bias_md(), dst_md,
+                          strides, dilations, padding_left, padding_right,
+                          attributes)
+                    : convolution_forward::primitive_desc(
+                          cpu_engine, prop_kind::forward_inference,
+                          algorithm::convolution_direct, src_md,
+                          primitive_weights_md, dst_md, strides, dilations,
+                          padding_left, padding_right, attributes);
+            OneDnnPrimitiveCache::Entry entry{convolution_forward(conv_pd)};
+            if (constant_weights) {
+              entry.weights = ReorderWeights(
+                  weights_mem, conv_pd.weights_desc(), onednn_stream);
+            }
+            return entry;
+          });
+
+  auto src_mem = memory(src_md, cpu_engine, input_minfo.Data());
+  auto dst_mem = memory(dst_md, cpu_engine, result_minfo.Data());
+
+  std::unordered_map<int, memory> conv_args;
+  conv_args.insert({DNNL_ARG_SRC, src_mem});
+  conv_args.insert({DNNL_ARG_WEIGHTS, cached->weights.value_or(weights_mem)});
+  conv_args.insert({DNNL_ARG_DST, dst_mem});
+  fusion.AddArguments(conv_args);
+
+  cached->primitive.execute(onednn_stream, conv_args);
+}
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // INTEL_MKL && ENABLE_ONEDNN_V3
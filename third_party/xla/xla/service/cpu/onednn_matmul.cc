@@ -20,6 +20,9 @@ limitations under the License.
 #include <algorithm>
 #include <cmath>
 #include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #define EIGEN_USE_THREADS
@@ -30,6 +33,7 @@ limitations under the License.
 #include "xla/executable_run_options.h"
 #include "xla/service/cpu/backend_config.pb.h"
 #include "xla/service/cpu/onednn_memory_util.h"
+#include "xla/service/cpu/onednn_util.h"
 #include "xla/service/cpu/runtime_lightweight_check.h"
 #include "tsl/util/onednn_threadpool.h"
 
@@ -40,18 +44,29 @@ using dnnl::engine;
 using dnnl::matmul;
 using dnnl::memory;
 using dnnl::stream;
+
+OneDnnPrimitiveCache& MatMulCache() {
+  static OneDnnPrimitiveCache* cache = new OneDnnPrimitiveCache();
+  return *cache;
+}
 }  // namespace
 
 ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMul(
-    const void* run_options_ptr, void* lhs, void* rhs, void* result,
-    void* config) {
+    void* result, void** args) {
+  // args[0]: ptr to nargs
+  // args[1]: ptr to ExecutableRunOptions
+  // args[2]: ptr to OneDnnMatMulConfig
+  // args[3]: ptr to the size of the config
+  // args[4...]: ptrs to operands
+  int arg_indx = 0;
+  const int64_t num_args = *(static_cast<int64_t*>(args[arg_indx++]));
   const xla::ExecutableRunOptions* run_options =
-      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+      static_cast<const xla::ExecutableRunOptions*>(args[arg_indx++]);
   XLA_LIGHTWEIGHT_CHECK(run_options != nullptr);
   XLA_LIGHTWEIGHT_CHECK(run_options->intra_op_thread_pool() != nullptr);
   tsl::OneDnnThreadPool thread_pool(
       run_options->intra_op_thread_pool()->getPool(), false);
-  engine cpu_engine(engine::kind::cpu, 0);
+  engine& cpu_engine = OneDnnCpuEngine();
 #ifndef ENABLE_ONEDNN_OPENMP
   auto onednn_stream =
       stream(dnnl::threadpool_interop::make_stream(cpu_engine, &thread_pool));
@@ -59,36 +74,75 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_OneDnnMatMul(
   auto onednn_stream = stream(cpu_engine);
 #endif  // ENABLE_ONEDNN_OPENMP
 
-  MemrefInfo lhs_minfo(lhs);
-  MemrefInfo rhs_minfo(rhs);
-  MemrefInfo result_minfo(result);
-
-  std::string config_str(static_cast<const char*>(config));
+  const char* config_data = static_cast<const char*>(args[arg_indx++]);
+  const int64_t config_size = *(static_cast<int64_t*>(args[arg_indx++]));
+  std::string config_str(config_data, config_size);
   OneDnnMatMulConfig matmul_config;
-  matmul_config.ParseFromString(config_str);
+  XLA_LIGHTWEIGHT_CHECK(matmul_config.ParseFromString(config_str));
 
-  // Currently, no fusion is supported.
-  XLA_LIGHTWEIGHT_CHECK(matmul_config.fused_ops().empty());
+  MemrefInfo lhs_minfo(args[arg_indx++]);
+  MemrefInfo rhs_minfo(args[arg_indx++]);
+  MemrefInfo result_minfo(result);
+  std::vector<MemrefInfo> fused_operands;
+  while (arg_indx < num_args) {
+    fused_operands.emplace_back(args[arg_indx++]);
+  }
 
   auto src_md = lhs_minfo.GetOneDnnMemDesc();
   auto weights_md = rhs_minfo.GetOneDnnMemDesc();
   auto dst_md = result_minfo.GetOneDnnMemDesc();
 
-  auto src_mem = memory(src_md, cpu_engine, lhs_minfo.Data());
-  auto weights_mem = memory(weights_md, cpu_engine, rhs_minfo.Data());
-  auto dst_mem = memory(dst_md, cpu_engine, result_minfo.Data());
+  // The bias is broadcast along all dimensions but the last one.
+  memory::dims bias_dims(dst_md.get_ndims(), 1);
+  bias_dims.back() = dst_md.get_dims().back();
+  OneDnnFusion fusion(matmul_config.fused_ops(), fused_operands, bias_dims,
+                      /*dims_order=*/{});
 
-  auto matmul_pd =
-      matmul::primitive_desc(cpu_engine, src_md, weights_md, dst_md);
+  std::vector<memory::desc> mds = {src_md, weights_md, dst_md};
+  fusion.AppendMemDescs(mds);
+  const bool constant_weights =
+      matmul_config.constant_weights_fingerprint() != 0;
+  auto weights_mem = memory(weights_md, cpu_engine, rhs_minfo.Data());
+  std::shared_ptr<const OneDnnPrimitiveCache::Entry> cached =
+      MatMulCache().GetOrCreate(
+          OneDnnPrimitiveCache::Key(config_str, mds), [&]() {
+            // Let oneDNN pick the layout of constant weights, which are only
+            // reordered once.
+            memory::desc primitive_weights_md =
+                constant_weights
+                    ? memory::desc(weights_md.get_dims(),
+                                   weights_md.get_data_type(),
+                                   memory::format_tag::any)
+                    : weights_md;
+            dnnl::primitive_attr attributes = fusion.CreateAttributes();
+            auto matmul_pd =
+                fusion.has_bias()
+                    ? matmul::primitive_desc(cpu_engine, src_md,
+                                             primitive_weights_md,
+                                             fusion.bias_md(), dst_md,
+                                             attributes)
+                    : matmul::primitive_desc(cpu_engine, src_md,
+                                             primitive_weights_md, dst_md,
+                                             attributes);
+            OneDnnPrimitiveCache::Entry entry{matmul(matmul_pd)};
+            if (constant_weights) {
+              entry.weights = ReorderWeights(
+                  weights_mem, matmul_pd.weights_desc(), onednn_stream);
+            }
+            return entry;
+          });
 
-  auto matmul_prim = matmul(matmul_pd);
+  auto src_mem = memory(src_md, cpu_engine, lhs_minfo.Data());
+  auto dst_mem = memory(dst_md, cpu_engine, result_minfo.Data());
 
   std::unordered_map<int, memory> matmul_args;
   matmul_args.insert({DNNL_ARG_SRC, src_mem});
-  matmul_args.insert({DNNL_ARG_WEIGHTS, weights_mem});
+  matmul_args.insert(
+      {DNNL_ARG_WEIGHTS, cached->weights.value_or(weights_mem)});
   matmul_args.insert({DNNL_ARG_DST, dst_mem});
+  fusion.AddArguments(matmul_args);
 
-  matmul_prim.execute(onednn_stream, matmul_args);
+  cached->primitive.execute(onednn_stream, matmul_args);
 }
 
 }  // namespace cpu
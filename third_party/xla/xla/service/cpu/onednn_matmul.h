@@ -21,19 +21,16 @@ namespace xla {
 namespace cpu {
 
 extern "C" {
-// TODO(intel-tf): Change the function signature as
-//    void onednn_matmul(void* result, void** args)
-// where
-//        args[0]: num_args (>=3, including itself)
+// The arguments of the oneDNN runtime calls are
+//        result: MemrefInfo of the result
+//        args[0]: num_args (>=4, including itself)
 //        args[1]: ExecutableRunOption
-//        args[2]: OneDnnMatMulConfig
-//        args[3...]: Actual Operands
-// so that it can take variable number of arguments.
-//
-// For now, we are using a fixed number of arguments.
-extern void __xla_cpu_runtime_OneDnnMatMul(const void* run_options_ptr,
-                                           void* lhs, void* rhs, void* result,
-                                           void* config);
+//        args[2]: serialized OneDnnMatMulConfig (or OneDnnConvolutionConfig)
+//        args[3]: size of the serialized config
+//        args[4...]: MemrefInfo of the operands, the inputs first and then the
+//                    operands of the fused ops
+// so that they can take a variable number of arguments.
+extern void __xla_cpu_runtime_OneDnnMatMul(void* result, void** args);
 }  // extern "C"
 
 }  // namespace cpu
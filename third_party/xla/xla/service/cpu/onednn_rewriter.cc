@@ -17,6 +17,9 @@ limitations under the License.
 
 #include "xla/service/cpu/onednn_rewriter.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "xla/hlo/ir/dfs_hlo_visitor_with_default.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/service/cpu/backend_config.pb.h"
@@ -31,6 +34,9 @@ namespace cpu {
 namespace {
 namespace m = match;
 
+constexpr absl::string_view kOneDnnMatMulTarget = "__onednn$matmul";
+constexpr absl::string_view kOneDnnConvolutionTarget = "__onednn$convolution";
+
 Status ValidateDotDimensionNumbers(const DotDimensionNumbers& dim_numbers) {
   // Checks some invariants that do not hold in general, but DotDecomposer
   // should have established for us.
@@ -60,6 +66,35 @@ bool IsSupportedType(xla::PrimitiveType dtype) {
   return false;
 }
 
+// Returns whether 'instr' is a oneDNN matmul or convolution whose epilogue,
+// its only user, can be fused into it.
+bool IsFusibleOneDnnCall(const HloInstruction* instr) {
+  return instr->opcode() == HloOpcode::kCustomCall &&
+         (instr->custom_call_target() == kOneDnnMatMulTarget ||
+          instr->custom_call_target() == kOneDnnConvolutionTarget) &&
+         instr->user_count() == 1 && !instr->HasControlDependencies();
+}
+
+tsl::protobuf::RepeatedField<int>* MutableFusedOps(
+    const HloInstruction* onednn_call, BackendConfig& backend_config) {
+  if (onednn_call->custom_call_target() == kOneDnnMatMulTarget) {
+    return backend_config.mutable_onednn_matmul_config()->mutable_fused_ops();
+  }
+  return backend_config.mutable_onednn_conv_config()->mutable_fused_ops();
+}
+
+// Returns the dimension of the result of 'onednn_call' along which a bias is
+// broadcast: the last one of matmuls and the output feature of convolutions.
+StatusOr<int64_t> BiasDimension(const HloInstruction* onednn_call) {
+  if (onednn_call->custom_call_target() == kOneDnnMatMulTarget) {
+    return onednn_call->shape().rank() - 1;
+  }
+  TF_ASSIGN_OR_RETURN(auto backend_config,
+                      onednn_call->backend_config<BackendConfig>());
+  TF_RET_CHECK(backend_config.onednn_conv_config().output_dims_size() > 1);
+  return backend_config.onednn_conv_config().output_dims(1);
+}
+
 }  // namespace
 
 class OneDnnRewriterVisitor : public DfsHloRewriteVisitor {
@@ -122,14 +157,148 @@ class OneDnnRewriterVisitor : public DfsHloRewriteVisitor {
         dot_instr->AddInstruction(HloInstruction::CreateCustomCall(
             output_shape,
             {dot_instr->mutable_operand(0), dot_instr->mutable_operand(1)},
-            "__onednn$matmul"));
-    // Set additional info via config, e.g., fusion info.
+            kOneDnnMatMulTarget));
+    // Set additional info via config, e.g., fusion info. The fused ops are
+    // added as the epilogue is rewritten.
     BackendConfig backend_config;
-    // No fusion is supported now, so nothing to add to the config.
     TF_RETURN_IF_ERROR(matmul_call->set_backend_config(backend_config));
     TF_RETURN_IF_ERROR(ReplaceInstruction(dot_instr, matmul_call));
     return OkStatus();
   }
+
+  // Matches convolutions supported by oneDNN, which are replaced by custom
+  // calls whose config holds the window and the order of the dimensions.
+  Status HandleConvolution(HloInstruction* conv) override {
+    if (conv->HasControlDependencies()) return OkStatus();
+    const PrimitiveType element_type = conv->shape().element_type();
+    if (!IsSupportedType(element_type)) return OkStatus();
+    const HloInstruction* input = conv->operand(0);
+    const HloInstruction* kernel = conv->operand(1);
+    if (input->shape().element_type() != element_type ||
+        kernel->shape().element_type() != element_type) {
+      return OkStatus();
+    }
+    if (ShapeUtil::IsZeroElementArray(input->shape()) ||
+        ShapeUtil::IsZeroElementArray(kernel->shape()) ||
+        ShapeUtil::IsZeroElementArray(conv->shape())) {
+      return OkStatus();
+    }
+    // TODO(intel-tf): Add grouped and depthwise convolutions.
+    if (conv->feature_group_count() != 1 || conv->batch_group_count() != 1) {
+      return OkStatus();
+    }
+    const ConvolutionDimensionNumbers& dnums =
+        conv->convolution_dimension_numbers();
+    const int64_t num_spatial_dims = dnums.input_spatial_dimensions_size();
+    if (num_spatial_dims < 1 || num_spatial_dims > 3) return OkStatus();
+
+    OneDnnConvolutionConfig conv_config;
+    conv_config.add_input_dims(dnums.input_batch_dimension());
+    conv_config.add_input_dims(dnums.input_feature_dimension());
+    conv_config.add_kernel_dims(dnums.kernel_output_feature_dimension());
+    conv_config.add_kernel_dims(dnums.kernel_input_feature_dimension());
+    conv_config.add_output_dims(dnums.output_batch_dimension());
+    conv_config.add_output_dims(dnums.output_feature_dimension());
+    for (int64_t i = 0; i < num_spatial_dims; ++i) {
+      conv_config.add_input_dims(dnums.input_spatial_dimensions(i));
+      conv_config.add_kernel_dims(dnums.kernel_spatial_dimensions(i));
+      conv_config.add_output_dims(dnums.output_spatial_dimensions(i));
+      const WindowDimension& window = conv->window().dimensions(i);
+      // oneDNN doesn't dilate the input (i.e. transposed convolutions) nor
+      // crops it with negative padding.
+      if (window.base_dilation() != 1 || window.window_reversal() ||
+          window.padding_low() < 0 || window.padding_high() < 0) {
+        return OkStatus();
+      }
+      conv_config.add_strides(window.stride());
+      conv_config.add_padding_left(window.padding_low());
+      conv_config.add_padding_right(window.padding_high());
+      conv_config.add_dilations(window.window_dilation() - 1);
+    }
+
+    HloInstruction* conv_call =
+        conv->AddInstruction(HloInstruction::CreateCustomCall(
+            conv->shape(),
+            {conv->mutable_operand(0), conv->mutable_operand(1)},
+            kOneDnnConvolutionTarget));
+    BackendConfig backend_config;
+    *backend_config.mutable_onednn_conv_config() = conv_config;
+    TF_RETURN_IF_ERROR(conv_call->set_backend_config(backend_config));
+    TF_RETURN_IF_ERROR(ReplaceInstruction(conv, conv_call));
+    return OkStatus();
+  }
+
+  // Matches the bias add of a oneDNN matmul or convolution, i.e. the add of a
+  // vector broadcast along its features, or the add of a tensor of its shape.
+  Status HandleAdd(HloInstruction* add) override {
+    for (int64_t i = 0; i < 2; ++i) {
+      HloInstruction* onednn_call = add->mutable_operand(i);
+      HloInstruction* addend = add->mutable_operand(1 - i);
+      if (!IsFusibleOneDnnCall(onednn_call) || addend == onednn_call) {
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(auto backend_config,
+                          onednn_call->backend_config<BackendConfig>());
+      TF_ASSIGN_OR_RETURN(int64_t bias_dim, BiasDimension(onednn_call));
+      // oneDNN applies the bias before all the other fused ops.
+      if (MutableFusedOps(onednn_call, backend_config)->empty() &&
+          addend->opcode() == HloOpcode::kBroadcast &&
+          addend->operand(0)->shape().rank() == 1 &&
+          addend->dimensions().size() == 1 &&
+          addend->dimensions(0) == bias_dim) {
+        return FuseEpilogue(onednn_call, add, OneDnnMatMulConfig::BIAS,
+                            addend->mutable_operand(0));
+      }
+      if (ShapeUtil::Equal(addend->shape(), onednn_call->shape())) {
+        return FuseEpilogue(onednn_call, add, OneDnnMatMulConfig::BINARY_ADD,
+                            addend);
+      }
+    }
+    return OkStatus();
+  }
+
+  // Matches the relu of a oneDNN matmul or convolution.
+  Status HandleMaximum(HloInstruction* maximum) override {
+    for (int64_t i = 0; i < 2; ++i) {
+      HloInstruction* onednn_call = maximum->mutable_operand(i);
+      if (IsFusibleOneDnnCall(onednn_call) &&
+          Match(maximum->operand(1 - i),
+                m::Broadcast(m::ConstantScalar(0)))) {
+        return FuseEpilogue(onednn_call, maximum, OneDnnMatMulConfig::RELU);
+      }
+    }
+    return OkStatus();
+  }
+
+  // Matches the tanh of a oneDNN matmul or convolution.
+  Status HandleTanh(HloInstruction* tanh) override {
+    HloInstruction* onednn_call = tanh->mutable_operand(0);
+    if (IsFusibleOneDnnCall(onednn_call)) {
+      return FuseEpilogue(onednn_call, tanh, OneDnnMatMulConfig::TANH);
+    }
+    return OkStatus();
+  }
+
+ private:
+  // Replaces 'epilogue' and the oneDNN call 'onednn_call' it reads by a copy
+  // of the call which also runs 'kind', with 'operand' as the operand of the
+  // fused op (if any).
+  Status FuseEpilogue(HloInstruction* onednn_call, HloInstruction* epilogue,
+                      OneDnnMatMulConfig::FusionKind kind,
+                      HloInstruction* operand = nullptr) {
+    TF_ASSIGN_OR_RETURN(auto backend_config,
+                        onednn_call->backend_config<BackendConfig>());
+    MutableFusedOps(onednn_call, backend_config)->Add(kind);
+    std::vector<HloInstruction*> operands(onednn_call->operands().begin(),
+                                          onednn_call->operands().end());
+    if (operand != nullptr) {
+      operands.push_back(operand);
+    }
+    HloInstruction* fused_call = epilogue->AddInstruction(
+        onednn_call->CloneWithNewOperands(epilogue->shape(), operands));
+    TF_RETURN_IF_ERROR(fused_call->set_backend_config(backend_config));
+    return ReplaceInstruction(epilogue, fused_call);
+  }
 };
 
 StatusOr<bool> OneDnnRewriter::Run(
@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
+
+#include "xla/service/cpu/onednn_util.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "dnnl.hpp"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/onednn_memory_util.h"
+#include "xla/service/cpu/runtime_lightweight_check.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+using dnnl::algorithm;
+using dnnl::memory;
+}  // namespace
+
+dnnl::engine& OneDnnCpuEngine() {
+  static dnnl::engine* engine = new dnnl::engine(dnnl::engine::kind::cpu, 0);
+  return *engine;
+}
+
+memory::desc PermuteToOneDnnOrder(const memory::desc& md,
+                                  absl::Span<const int64_t> dims_order) {
+  if (dims_order.empty()) {
+    return md;
+  }
+  // 'permutation[i]' is the oneDNN dimension of the i-th XLA dimension.
+  std::vector<int> permutation(dims_order.size());
+  for (int i = 0; i < dims_order.size(); ++i) {
+    permutation[dims_order[i]] = i;
+  }
+  return md.permute_axes(permutation);
+}
+
+OneDnnFusion::OneDnnFusion(const tsl::protobuf::RepeatedField<int>& fused_ops,
+                           std::vector<MemrefInfo>& fused_operands,
+                           const memory::dims& bias_dims,
+                           absl::Span<const int64_t> dims_order) {
+  auto next_operand = fused_operands.begin();
+  for (int fused_op : fused_ops) {
+    switch (fused_op) {
+      case OneDnnMatMulConfig::BIAS: {
+        XLA_LIGHTWEIGHT_CHECK(next_operand != fused_operands.end());
+        XLA_LIGHTWEIGHT_CHECK(post_ops_.len() == 0);
+        // The bias is a dense vector, broadcast to 'bias_dims'.
+        memory::dims strides(bias_dims.size());
+        memory::dim stride = 1;
+        for (int i = bias_dims.size() - 1; i >= 0; --i) {
+          strides[i] = stride;
+          stride *= bias_dims[i];
+        }
+        bias_md_ = memory::desc(bias_dims, next_operand->GetOneDnnDataType(),
+                                strides);
+        bias_data_ = next_operand->Data();
+        ++next_operand;
+        break;
+      }
+      case OneDnnMatMulConfig::RELU:
+        post_ops_.append_eltwise(algorithm::eltwise_relu, 0.f, 0.f);
+        break;
+      case OneDnnMatMulConfig::TANH:
+        post_ops_.append_eltwise(algorithm::eltwise_tanh, 0.f, 0.f);
+        break;
+      case OneDnnMatMulConfig::GELU_ERF:
+        post_ops_.append_eltwise(algorithm::eltwise_gelu_erf, 0.f, 0.f);
+        break;
+      case OneDnnMatMulConfig::GELU_TANH:
+        post_ops_.append_eltwise(algorithm::eltwise_gelu_tanh, 0.f, 0.f);
+        break;
+      case OneDnnMatMulConfig::BINARY_ADD: {
+        XLA_LIGHTWEIGHT_CHECK(next_operand != fused_operands.end());
+        memory::desc md = PermuteToOneDnnOrder(next_operand->GetOneDnnMemDesc(),
+                                               dims_order);
+        binary_operands_.push_back(
+            {post_ops_.len(), md, next_operand->Data()});
+        post_ops_.append_binary(algorithm::binary_add, md);
+        ++next_operand;
+        break;
+      }
+      default:
+        XLA_LIGHTWEIGHT_CHECK(false);
+    }
+  }
+  XLA_LIGHTWEIGHT_CHECK(next_operand == fused_operands.end());
+}
+
+dnnl::primitive_attr OneDnnFusion::CreateAttributes() const {
+  dnnl::primitive_attr attributes;
+  attributes.set_post_ops(post_ops_);
+  return attributes;
+}
+
+void OneDnnFusion::AppendMemDescs(std::vector<memory::desc>& mds) const {
+  if (has_bias()) {
+    mds.push_back(bias_md_);
+  }
+  for (const BinaryOperand& operand : binary_operands_) {
+    mds.push_back(operand.md);
+  }
+}
+
+void OneDnnFusion::AddArguments(std::unordered_map<int, memory>& args) const {
+  if (has_bias()) {
+    args.insert(
+        {DNNL_ARG_BIAS, memory(bias_md_, OneDnnCpuEngine(), bias_data_)});
+  }
+  for (const BinaryOperand& operand : binary_operands_) {
+    args.insert(
+        {DNNL_ARG_ATTR_MULTIPLE_POST_OP(operand.post_op_index) | DNNL_ARG_SRC_1,
+         memory(operand.md, OneDnnCpuEngine(), operand.data)});
+  }
+}
+
+/*static*/ std::string OneDnnPrimitiveCache::Key(
+    absl::string_view config, absl::Span<const memory::desc> mds) {
+  std::string key(config);
+  for (const memory::desc& md : mds) {
+    absl::StrAppend(&key, ";", static_cast<int>(md.get_data_type()), ":",
+                    absl::StrJoin(md.get_dims(), ","), ":",
+                    absl::StrJoin(md.get_strides(), ","));
+  }
+  return key;
+}
+
+std::shared_ptr<const OneDnnPrimitiveCache::Entry>
+OneDnnPrimitiveCache::GetOrCreate(const std::string& key,
+                                  absl::FunctionRef<Entry()> create) {
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      return it->second;
+    }
+  }
+  // Create the primitive outside of the lock, as this may take a while. Racing
+  // executions may create it more than once, and keep the first one.
+  auto entry = std::make_shared<const Entry>(create());
+  absl::MutexLock lock(&mu_);
+  if (entries_.size() >= kMaxEntries) {
+    entries_.clear();
+  }
+  return entries_.emplace(key, std::move(entry)).first->second;
+}
+
+memory ReorderWeights(memory weights, const memory::desc& md,
+                      dnnl::stream& stream) {
+  if (weights.get_desc() == md) {
+    return weights;
+  }
+  memory reordered(md, OneDnnCpuEngine());
+  dnnl::reorder(weights, reordered).execute(stream, weights, reordered);
+  stream.wait();
+  return reordered;
+}
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // INTEL_MKL && ENABLE_ONEDNN_V3
@@ -0,0 +1,133 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_CPU_ONEDNN_UTIL_H_
+#define XLA_SERVICE_CPU_ONEDNN_UTIL_H_
+#if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "dnnl.hpp"
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xla/service/cpu/backend_config.pb.h"
+#include "xla/service/cpu/onednn_memory_util.h"
+#include "tsl/platform/protobuf.h"
+
+namespace xla {
+namespace cpu {
+
+// Returns the oneDNN CPU engine which all the primitives of the runtime are
+// created and executed with.
+dnnl::engine& OneDnnCpuEngine();
+
+// Returns 'md', of a tensor with XLA dimensions, with its dimensions in the
+// order oneDNN expects them: 'dims_order[i]' is the XLA dimension of the i-th
+// oneDNN dimension. An empty 'dims_order' keeps the XLA order.
+dnnl::memory::desc PermuteToOneDnnOrder(const dnnl::memory::desc& md,
+                                        absl::Span<const int64_t> dims_order);
+
+// The epilogue of a oneDNN matmul or convolution: its bias and its post-ops.
+class OneDnnFusion {
+ public:
+  // 'fused_ops': the epilogue ops of the config of the primitive.
+  // 'fused_operands': the operands of the ops that have one, in order.
+  // 'bias_dims': the dimensions of the bias, as the primitive expects them.
+  // 'dims_order': the order of the dimensions of the result, see
+  //               PermuteToOneDnnOrder().
+  OneDnnFusion(
+      const tsl::protobuf::RepeatedField<int>& fused_ops,
+      std::vector<MemrefInfo>& fused_operands,
+      const dnnl::memory::dims& bias_dims,
+      absl::Span<const int64_t> dims_order);
+
+  bool has_bias() const { return bias_data_ != nullptr; }
+  const dnnl::memory::desc& bias_md() const { return bias_md_; }
+
+  // Returns the attributes of the primitive, with its post-ops.
+  dnnl::primitive_attr CreateAttributes() const;
+
+  // Adds the memory descriptors of the fused operands to 'mds'.
+  void AppendMemDescs(std::vector<dnnl::memory::desc>& mds) const;
+
+  // Adds the fused operands to the execution arguments 'args'.
+  void AddArguments(std::unordered_map<int, dnnl::memory>& args) const;
+
+ private:
+  dnnl::post_ops post_ops_;
+  dnnl::memory::desc bias_md_;
+  void* bias_data_ = nullptr;
+  // The post-op index, memory descriptor and data of each binary operand.
+  struct BinaryOperand {
+    int post_op_index;
+    dnnl::memory::desc md;
+    void* data;
+  };
+  std::vector<BinaryOperand> binary_operands_;
+};
+
+// Caches the primitives of the oneDNN runtime across executions, so that they
+// are only created once for each config and set of operand layouts.
+//
+// Primitives whose weights are a constant of the program hold the weights
+// reordered once into the layout the primitive prefers. Their config holds
+// the fingerprint of the constant, so that the entries outliving a program
+// are never used for other weights.
+class OneDnnPrimitiveCache {
+ public:
+  struct Entry {
+    dnnl::primitive primitive;
+    // The weights reordered for the primitive, if they are constant.
+    std::optional<dnnl::memory> weights;
+  };
+
+  // Returns the cache key of a primitive of 'config', with operands described
+  // by 'mds'.
+  static std::string Key(absl::string_view config,
+                         absl::Span<const dnnl::memory::desc> mds);
+
+  // Returns the entry of 'key', created by 'create' if it isn't cached yet.
+  std::shared_ptr<const Entry> GetOrCreate(
+      const std::string& key, absl::FunctionRef<Entry()> create);
+
+ private:
+  // Bounds the memory held by the cache, e.g. for programs with dynamic
+  // shapes compiled over and over again.
+  static constexpr int kMaxEntries = 4096;
+
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const Entry>> entries_
+      ABSL_GUARDED_BY(mu_);
+};
+
+// Returns 'weights' reordered into the layout 'md' (if they differ), with
+// 'stream'.
+dnnl::memory ReorderWeights(dnnl::memory weights, const dnnl::memory::desc& md,
+                            dnnl::stream& stream);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // INTEL_MKL && ENABLE_ONEDNN_V3
+#endif  // XLA_SERVICE_CPU_ONEDNN_UTIL_H_
@@ -17,6 +17,13 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "absl/base/dynamic_annotations.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -29,6 +36,41 @@ limitations under the License.
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      void*, int64_t*, uint64_t*);
 
+namespace {
+
+// Joins the error messages of the failed 'statuses' of partitions (if any)
+// into the status of the fork/join call.
+void SetFailureFromPartitionStatuses(
+    std::vector<XlaCustomCallStatus>& statuses, void* status) {
+  // Collect all error messages (if any).
+  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
+  for (int32_t i = 0; i < statuses.size(); ++i) {
+    std::optional<absl::string_view> msg =
+        xla::CustomCallStatusGetMessage(&statuses[i]);
+    if (msg) {
+      error_messages.emplace_back(i, *msg);
+    }
+  }
+
+  if (!error_messages.empty()) {
+    // Join all error messages into a single string to serve as the message for
+    // the returned status.
+    std::string error_message = absl::StrJoin(
+        error_messages, "\n",
+        [](std::string* out, std::pair<int32_t, absl::string_view> p) {
+          int32_t idx = p.first;
+          absl::string_view msg = p.second;
+          absl::StrAppend(out,
+                          absl::StrFormat("Partition %d error: %s", idx, msg));
+        });
+    XlaCustomCallStatusSetFailure(
+        reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
+        error_message.length());
+  }
+}
+
+}  // namespace
+
 // Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
 // Calls 'function_ptr' for first partition inline.
 // Uses blocking counter to synchronize threads after parallel calls complete.
@@ -102,30 +144,67 @@ ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   VLOG(3) << "ParallelForkJoin partition 0 done.";
   bc.Wait();
 
-  // Collect all error messages (if any).
-  std::vector<std::pair<int32_t, absl::string_view>> error_messages;
-  for (int32_t i = 0; i < num_partitions; ++i) {
-    std::optional<absl::string_view> msg =
-        xla::CustomCallStatusGetMessage(&statuses[i]);
-    if (msg) {
-      error_messages.emplace_back(i, *msg);
+  SetFailureFromPartitionStatuses(statuses, status);
+  VLOG(2) << "ParallelForkJoin EXIT";
+}
+
+// Dispatches the 'num_partitions' calls to 'function_ptr' of concurrent tasks,
+// with the same arguments as ParallelForkJoin.
+//
+// Unlike parallel partitions, concurrent tasks can themselves fork parallel
+// partitions (or run multi-threaded Eigen kernels) and block on them, so at
+// most 'num_threads - 1' workers of the intra-op thread pool run the tasks,
+// along with the calling thread, which leaves a thread free to make progress
+// on the nested work. The workers take the next task to run from a shared
+// counter, which balances tasks of different costs.
+ABSL_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ConcurrentForkJoin(
+    void* result_ptr, const void* run_options_ptr, const void** params,
+    void** buffer_table, void* status, uint64_t* prof_counters,
+    int32_t num_partitions, int64_t* partitions, int32_t num_partitioned_dims,
+    void* function_ptr) {
+  VLOG(2) << "ConcurrentForkJoin ENTRY"
+          << " num_partitions: " << num_partitions
+          << " num_partitioned_dims: " << num_partitioned_dims;
+  CHECK_EQ(params, nullptr);
+  CHECK_GT(num_partitions, 1);
+  CHECK_GT(num_partitioned_dims, 0);
+  CHECK_NE(function_ptr, nullptr);
+  CHECK_NE(partitions, nullptr);
+  const xla::ExecutableRunOptions* run_options =
+      static_cast<const xla::ExecutableRunOptions*>(run_options_ptr);
+  CHECK_NE(run_options, nullptr);
+  CHECK_NE(run_options->intra_op_thread_pool(), nullptr);
+
+  ComputeFunctionType function =
+      reinterpret_cast<ComputeFunctionType>(function_ptr);
+  // Compute partition stride in 'partitions' array.
+  const int64_t stride = 2 * num_partitioned_dims;
+
+  std::vector<XlaCustomCallStatus> statuses(num_partitions);
+  std::atomic<int32_t> next_partition(0);
+  auto run_partitions = [&]() {
+    for (int32_t i = next_partition.fetch_add(1); i < num_partitions;
+         i = next_partition.fetch_add(1)) {
+      function(result_ptr, run_options_ptr, nullptr, buffer_table,
+               &statuses[i], &partitions[i * stride], prof_counters);
+      VLOG(3) << "ConcurrentForkJoin partition " << i << " done.";
     }
-  }
+  };
 
-  if (!error_messages.empty()) {
-    // Join all error messages into a single string to serve as the message for
-    // the returned status.
-    std::string error_message = absl::StrJoin(
-        error_messages, "\n",
-        [](std::string* out, std::pair<int32_t, absl::string_view> p) {
-          int32_t idx = p.first;
-          absl::string_view msg = p.second;
-          absl::StrAppend(out,
-                          absl::StrFormat("Partition %d error: %s", idx, msg));
+  const int32_t num_workers = std::min<int32_t>(
+      num_partitions - 1,
+      run_options->intra_op_thread_pool()->numThreads() - 1);
+  tsl::BlockingCounter bc(std::max(num_workers, 0));
+  for (int32_t i = 0; i < num_workers; ++i) {
+    run_options->intra_op_thread_pool()->enqueueNoNotification(
+        [&run_partitions, &bc]() {
+          run_partitions();
+          bc.DecrementCount();
         });
-    XlaCustomCallStatusSetFailure(
-        reinterpret_cast<XlaCustomCallStatus*>(status), error_message.data(),
-        error_message.length());
   }
-  VLOG(2) << "ParallelForkJoin EXIT";
+  run_partitions();
+  bc.Wait();
+
+  SetFailureFromPartitionStatuses(statuses, status);
+  VLOG(2) << "ConcurrentForkJoin EXIT";
 }
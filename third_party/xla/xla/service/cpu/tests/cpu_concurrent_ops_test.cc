@@ -0,0 +1,71 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "xla/literal.h"
+#include "xla/literal_util.h"
+#include "xla/service/cpu/concurrent_task_assignment.h"
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+#include "xla/tests/literal_test_util.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+constexpr char kHloText[] = R"(
+HloModule module
+
+ENTRY entry {
+  p0 = f32[256,256] parameter(0)
+  p1 = f32[256,256] parameter(1)
+  dot0 = f32[256,256] dot(p0, p0),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  dot1 = f32[256,256] dot(p1, p1),
+    lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  ROOT add = f32[256,256] add(dot0, dot1)
+}
+)";
+
+class CpuConcurrentOpsTest : public CpuCodegenTest {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_enable_concurrent_ops(true);
+    return debug_options;
+  }
+};
+
+TEST_F(CpuConcurrentOpsTest, RunsIndependentDotsConcurrently) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  TF_ASSERT_OK_AND_ASSIGN(auto optimized_module,
+                          GetOptimizedModule(module->Clone()));
+  EXPECT_TRUE(HasConcurrentTasks(*optimized_module));
+
+  Literal ones =
+      LiteralUtil::CreateFullWithDescendingLayout<float>({256, 256}, 1.0f);
+  Literal twos =
+      LiteralUtil::CreateFullWithDescendingLayout<float>({256, 256}, 2.0f);
+  Literal result = ExecuteAndTransfer(std::move(module), {&ones, &twos});
+  // Each element is 256 * 1 * 1 + 256 * 2 * 2.
+  EXPECT_TRUE(LiteralTestUtil::Equal(
+      LiteralUtil::CreateFullWithDescendingLayout<float>({256, 256}, 1280.0f),
+      result));
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
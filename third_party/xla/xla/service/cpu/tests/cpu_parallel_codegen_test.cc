@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "xla/service/cpu/tests/cpu_codegen_test.h"
+#include "xla/tests/literal_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/path.h"
+#include "tsl/platform/test.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+constexpr char kHloText[] = R"(
+HloModule module
+
+f1 {
+  f1.p0 = s32[] parameter(0)
+  ROOT f1.sum = s32[] add(f1.p0, f1.p0)
+}
+
+f2 {
+  f2.p0 = s32[] parameter(0)
+  f2.p1 = s32[] parameter(1)
+  ROOT f2.sum = s32[] add(f2.p0, f2.p1)
+}
+
+body {
+  body.p0 = s32[] parameter(0)
+  sum2 = s32[] fusion(body.p0), kind=kLoop, calls=f1
+  ROOT sum3 = s32[] fusion(sum2, body.p0), kind=kLoop, calls=f2
+}
+
+cond {
+  cond.p0 = s32[] parameter(0)
+  cond.c1 = s32[] constant(1)
+  ROOT cond.root = pred[] compare(cond.p0, cond.c1), direction=EQ
+}
+
+ENTRY entry {
+  entry.c1 = s32[] constant(1)
+  ROOT entry.root = s32[] while(entry.c1), condition=cond, body=body
+}
+)";
+
+class CpuParallelCodegenTest : public CpuCodegenTest {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_parallel_codegen_split_count(4);
+    debug_options.set_xla_cpu_compilation_cache_dir(cache_dir_);
+    return debug_options;
+  }
+
+  int NumCachedObjects() {
+    std::vector<std::string> children;
+    TF_CHECK_OK(tsl::Env::Default()->GetChildren(cache_dir_, &children));
+    return children.size();
+  }
+
+  const std::string cache_dir_ =
+      tsl::io::JoinPath(tsl::testing::TmpDir(), "cpu_parallel_codegen_cache");
+};
+
+TEST_F(CpuParallelCodegenTest, CompilesShardsAndReusesCachedObjects) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  LiteralTestUtil::ExpectR0Equal(3, ExecuteAndTransfer(module->Clone(), {}));
+  const int num_cached_objects = NumCachedObjects();
+  EXPECT_GT(num_cached_objects, 0);
+
+  // Compiling the module again reuses the objects of all its shards.
+  LiteralTestUtil::ExpectR0Equal(3, ExecuteAndTransfer(module->Clone(), {}));
+  EXPECT_EQ(NumCachedObjects(), num_cached_objects);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <optional>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -24,6 +25,8 @@ limitations under the License.
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
 #include "xla/autotune_results.pb.h"
@@ -33,10 +36,14 @@ limitations under the License.
 #include "xla/service/gpu/stream_executor_util.h"
 #include "xla/status.h"
 #include "xla/status_macros.h"
+#include "xla/stream_executor/device_description.h"
+#include "xla/stream_executor/dnn.h"
 #include "xla/util.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
+#include "tsl/platform/fingerprint.h"
 #include "tsl/platform/path.h"
+#include "tsl/platform/protobuf.h"
 #include "tsl/platform/statusor.h"
 
 namespace xla {
@@ -48,6 +55,123 @@ static absl::Mutex autotune_cache_mu(absl::kConstInit);
 static auto& autotune_cache ABSL_GUARDED_BY(autotune_cache_mu) =
     *new AutotuneCacheMap();
 
+namespace {
+
+// Bump this version whenever you change the structure of the results.
+// LINT.IfChange(version)
+constexpr int kVersion = 2;
+// LINT.ThenChange()
+
+bool IsTextProtoPath(absl::string_view file_path) {
+  return absl::EndsWith(file_path, ".txt") ||
+         absl::EndsWith(file_path, ".textproto") ||
+         absl::EndsWith(file_path, ".prototxt");
+}
+
+// Returns the versions of the driver and of cuDNN of the device of `config`,
+// which the results of autotuning depend on.
+std::string GetDeviceVersions(const AutotuneConfig& config) {
+  se::StreamExecutor* stream_exec = config.GetExecutor();
+  const se::DeviceDescription& description =
+      stream_exec->GetDeviceDescription();
+  std::string dnn_version = "none";
+  if (se::dnn::DnnSupport* dnn = stream_exec->AsDnn()) {
+    StatusOr<se::dnn::VersionInfo> version = dnn->GetVersion();
+    if (version.ok()) {
+      dnn_version = absl::StrCat(version->major_version(), ".",
+                                 version->minor_version(), ".",
+                                 version->patch());
+    }
+  }
+  return absl::StrCat("driver=", description.driver_version(),
+                      ";runtime=", description.runtime_version(),
+                      ";dnn=", dnn_version);
+}
+
+// Returns the path of the file of `key` in the persistent autotune cache
+// `dir`: the fingerprint of the key, the device versions and kVersion.
+std::string GetCacheFilePath(absl::string_view dir, const AutotuneCacheKey& key,
+                             absl::string_view device_versions) {
+  const tsl::Fprint128 fingerprint = tsl::FingerprintCat128(
+      tsl::Fingerprint128(absl::StrCat(kVersion, ";", key.GetModelStr(), ";",
+                                       device_versions)),
+      tsl::Fingerprint128(key.GetHlo()));
+  return tsl::io::JoinPath(
+      dir, absl::StrFormat("%016x%016x.textproto", fingerprint.high64,
+                           fingerprint.low64));
+}
+
+std::optional<AutotuneResult> TryFindInCacheDir(
+    absl::string_view dir, const AutotuneCacheKey& key,
+    absl::string_view device_versions) {
+  const std::string file_path = GetCacheFilePath(dir, key, device_versions);
+  std::string textproto;
+  if (!tsl::ReadFileToString(tsl::Env::Default(), file_path, &textproto)
+           .ok()) {
+    return std::nullopt;
+  }
+  AutotuneResults results;
+  if (!tsl::protobuf::TextFormat::ParseFromString(textproto, &results) ||
+      results.version() != kVersion || results.results_size() != 1) {
+    LOG(WARNING) << "Ignoring invalid autotune cache file: " << file_path;
+    return std::nullopt;
+  }
+  // The file name is only a fingerprint of the key.
+  const AutotuneResults::Entry& entry = results.results(0);
+  if (entry.device() != key.GetModelStr() || entry.hlo() != key.GetHlo()) {
+    return std::nullopt;
+  }
+  VLOG(1) << "Autotune cache hit in " << file_path;
+  return entry.result();
+}
+
+Status WriteToCacheDir(absl::string_view dir, const AutotuneCacheKey& key,
+                       absl::string_view device_versions,
+                       const AutotuneResult& result) {
+  AutotuneResults results;
+  results.set_version(kVersion);
+  AutotuneResults::Entry& entry = *results.add_results();
+  entry.set_device(std::string(key.GetModelStr()));
+  entry.set_hlo(std::string(key.GetHlo()));
+  *entry.mutable_result() = result;
+  std::string textproto;
+  if (!tsl::protobuf::TextFormat::PrintToString(results, &textproto)) {
+    return Internal("Failed to serialize the autotune result.");
+  }
+
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(std::string(dir)));
+  // Write to a file of this process, which is renamed once complete, as the
+  // cache may be shared by several processes.
+  const std::string file_path = GetCacheFilePath(dir, key, device_versions);
+  std::string temp_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return Internal("Failed to create a temporary file name for %s",
+                    file_path);
+  }
+  TF_RETURN_IF_ERROR(tsl::WriteStringToFile(env, temp_path, textproto));
+  Status status = env->RenameFile(temp_path, file_path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+  }
+  return status;
+}
+
+void TryToWriteToCacheDir(absl::string_view dir, const AutotuneCacheKey& key,
+                          absl::string_view device_versions,
+                          const AutotuneResult& result) {
+  if (dir.empty()) {
+    return;
+  }
+  Status status = WriteToCacheDir(dir, key, device_versions, result);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to write to the autotune cache " << dir << ": "
+                 << status;
+  }
+}
+
+}  // anonymous namespace
+
 /*static*/ Status AutotunerUtil::SerializeAutotuneResults(
     AutotuneResults* results) {
   absl::MutexLock lock(&autotune_cache_mu);
@@ -147,6 +271,13 @@ static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
   return inserted;
 }
 
+static AutotuneResult InsertInCache(const AutotuneCacheKey& key,
+                                    const AutotuneResult& result) {
+  absl::MutexLock lock(&autotune_cache_mu);
+  auto [it, inserted] = autotune_cache.emplace(key, result);
+  return it->second;
+}
+
 /*static*/ StatusOr<AutotuneResult> AutotunerUtil::Autotune(
     const HloInstruction* instr, const AutotuneConfig& config,
     const AutotuneNoCacheFn& autotune_fn) {
@@ -155,28 +286,41 @@ static AutotuneResult* TryFindInCache(const AutotuneCacheKey& key) {
     return *res;
   }
 
-  TF_ASSIGN_OR_RETURN(AutotuneResult autotune_result, autotune_fn());
-
-  absl::MutexLock lock(&autotune_cache_mu);
-  auto [it, inserted] = autotune_cache.emplace(key, autotune_result);
-  return it->second;
-}
-
-namespace {
+  // The persistent caches are keyed by the device versions, which are only
+  // known with a device.
+  const std::string& cache_dir = config.GetAutotuneCacheDir();
+  const std::string& remote_cache_dir = config.GetAutotuneRemoteCacheDir();
+  const bool use_persistent_cache =
+      !config.IsDeviceless() &&
+      (!cache_dir.empty() || !remote_cache_dir.empty());
+  std::string device_versions;
+  if (use_persistent_cache) {
+    device_versions = GetDeviceVersions(config);
+    if (!cache_dir.empty()) {
+      if (std::optional<AutotuneResult> result =
+              TryFindInCacheDir(cache_dir, key, device_versions)) {
+        return InsertInCache(key, *result);
+      }
+    }
+    if (!remote_cache_dir.empty()) {
+      if (std::optional<AutotuneResult> result =
+              TryFindInCacheDir(remote_cache_dir, key, device_versions)) {
+        TryToWriteToCacheDir(cache_dir, key, device_versions, *result);
+        return InsertInCache(key, *result);
+      }
+    }
+  }
 
-// Bump this version whenever you change the structure of the results.
-// LINT.IfChange(version)
-constexpr int kVersion = 2;
-// LINT.ThenChange()
+  TF_ASSIGN_OR_RETURN(AutotuneResult autotune_result, autotune_fn());
 
-bool IsTextProtoPath(absl::string_view file_path) {
-  return absl::EndsWith(file_path, ".txt") ||
-         absl::EndsWith(file_path, ".textproto") ||
-         absl::EndsWith(file_path, ".prototxt");
+  if (use_persistent_cache) {
+    TryToWriteToCacheDir(cache_dir, key, device_versions, autotune_result);
+    TryToWriteToCacheDir(remote_cache_dir, key, device_versions,
+                         autotune_result);
+  }
+  return InsertInCache(key, autotune_result);
 }
 
-}  // anonymous namespace
-
 /*static*/ Status AutotunerUtil::LoadAutotuneResults(absl::string_view data,
                                                      bool as_textproto) {
   AutotuneResults results;
@@ -105,7 +105,10 @@ class AutotuneConfig {
         should_crash_on_check_failure_(
             debug_options.xla_gpu_crash_on_verification_failures()),
         exhaustive_tiling_search_(
-            debug_options.xla_gpu_exhaustive_tiling_search()) {}
+            debug_options.xla_gpu_exhaustive_tiling_search()),
+        autotune_cache_dir_(debug_options.xla_gpu_autotune_cache_dir()),
+        autotune_remote_cache_dir_(
+            debug_options.xla_gpu_autotune_remote_cache_dir()) {}
 
   absl::string_view GetModelStr() const {
     if (auto deviceless_config = std::get_if<DevicelessConfig>(&config_)) {
@@ -145,11 +148,19 @@ class AutotuneConfig {
 
   bool ExhaustiveTilingSearch() const { return exhaustive_tiling_search_; }
 
+  // The directories of the persistent autotune caches, empty if disabled.
+  const std::string& GetAutotuneCacheDir() const { return autotune_cache_dir_; }
+  const std::string& GetAutotuneRemoteCacheDir() const {
+    return autotune_remote_cache_dir_;
+  }
+
  private:
   std::variant<DeviceConfig, DevicelessConfig> config_;
   int32_t autotune_level_;
   bool should_crash_on_check_failure_;
   bool exhaustive_tiling_search_;
+  std::string autotune_cache_dir_;
+  std::string autotune_remote_cache_dir_;
 };
 
 using AutotuneNoCacheFn = std::function<StatusOr<AutotuneResult>()>;
@@ -161,6 +172,9 @@ struct AutotunerUtil {
       se::RedzoneAllocator& allocator, const Shape& shape,
       const AutotuneConfig& config, int64_t& rng_state);
 
+  // Returns the autotuning result of `instr`, running `autotune_fn` only if it
+  // is neither in the in-memory cache nor, if enabled, in the persistent
+  // autotune caches of `config`. New results are written back to the latter.
   static StatusOr<AutotuneResult> Autotune(
       const HloInstruction* instr, const AutotuneConfig& config,
       const AutotuneNoCacheFn& autotune_fn);
@@ -24,8 +24,13 @@ limitations under the License.
 #include "absl/log/scoped_mock_log.h"
 #include "absl/strings/string_view.h"
 #include "xla/autotune_results.pb.h"
+#include "xla/autotuning.pb.h"
+#include "xla/hlo/ir/hlo_instruction.h"
+#include "xla/statusor.h"
 #include "xla/tests/hlo_test_base.h"
+#include "xla/xla.pb.h"
 #include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/path.h"
 
 namespace xla {
 namespace gpu {
@@ -123,6 +128,52 @@ TEST_F(AutotunerUtilTest, LoadAutotuneResultsFromFile_Protobuf) {
   TF_EXPECT_OK(AutotunerUtil::LoadAutotuneResultsFromFile(kFilePath));
 }
 
+TEST_F(AutotunerUtilTest, AutotuneUsesPersistentCache) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(kHloText));
+  const HloInstruction* dot = module->entry_computation()->root_instruction();
+  DebugOptions debug_options = GetDebugOptionsForTest();
+  debug_options.set_xla_gpu_autotune_cache_dir(
+      tsl::io::JoinPath(TempDir(), "autotune_cache"));
+  debug_options.set_xla_gpu_autotune_remote_cache_dir(
+      tsl::io::JoinPath(TempDir(), "autotune_remote_cache"));
+  AutotuneConfig config(
+      DeviceConfig{backend().default_stream_executor(), nullptr},
+      debug_options);
+
+  AutotuneResult expected;
+  expected.mutable_gemm()->set_algorithm(42);
+  int num_autotunings = 0;
+  auto autotune_fn = [&]() -> StatusOr<AutotuneResult> {
+    ++num_autotunings;
+    return expected;
+  };
+  AutotunerUtil::ClearAutotuneResults();
+  TF_ASSERT_OK_AND_ASSIGN(AutotuneResult result,
+                          AutotunerUtil::Autotune(dot, config, autotune_fn));
+  EXPECT_EQ(result.gemm().algorithm(), 42);
+  EXPECT_EQ(num_autotunings, 1);
+
+  // The result is found in the persistent cache, as in a new process.
+  AutotunerUtil::ClearAutotuneResults();
+  TF_ASSERT_OK_AND_ASSIGN(result,
+                          AutotunerUtil::Autotune(dot, config, autotune_fn));
+  EXPECT_EQ(result.gemm().algorithm(), 42);
+  EXPECT_EQ(num_autotunings, 1);
+
+  // And in the remote cache, as on another host.
+  debug_options.set_xla_gpu_autotune_cache_dir(
+      tsl::io::JoinPath(TempDir(), "autotune_other_cache"));
+  AutotuneConfig other_config(
+      DeviceConfig{backend().default_stream_executor(), nullptr},
+      debug_options);
+  AutotunerUtil::ClearAutotuneResults();
+  TF_ASSERT_OK_AND_ASSIGN(
+      result, AutotunerUtil::Autotune(dot, other_config, autotune_fn));
+  EXPECT_EQ(result.gemm().algorithm(), 42);
+  EXPECT_EQ(num_autotunings, 1);
+  AutotunerUtil::ClearAutotuneResults();
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace xla
@@ -68,6 +68,55 @@ void RemoveTrailingIntermediates(HloInstructionSequence& seq) {
 
 constexpr int kMinNumCommands = 2;
 
+// The maximum number of branches of a conditional recorded into a command
+// buffer, see se::gpu::GpuCommandBuffer::kMaxCaseBranches.
+constexpr int64_t kMaxNumConditionalBranches = 8;
+
+using CommandTypes = absl::flat_hash_set<DebugOptions::CommandBufferCmdType>;
+
+bool IsCommand(const HloInstruction* inst, const CommandTypes& command_types);
+
+// Returns whether all instructions of the computation are commands, or only
+// forward buffers to them, so that it can be recorded as a nested command
+// buffer of a conditional command.
+bool IsCommandComputation(const HloComputation* computation,
+                          const CommandTypes& command_types) {
+  return absl::c_all_of(
+      computation->instructions(), [&](const HloInstruction* inst) {
+        switch (inst->opcode()) {
+          case HloOpcode::kGetTupleElement:
+          case HloOpcode::kParameter:
+          case HloOpcode::kTuple:
+            return true;
+          default:
+            return IsCommand(inst, command_types);
+        }
+      });
+}
+
+bool IsCommand(const HloInstruction* inst, const CommandTypes& command_types) {
+  switch (inst->opcode()) {
+    case HloOpcode::kFusion:
+      return command_types.contains(DebugOptions::FUSION);
+    case HloOpcode::kConditional:
+      if (!command_types.contains(DebugOptions::CONDITIONALS) ||
+          inst->branch_count() > kMaxNumConditionalBranches) {
+        return false;
+      }
+      return absl::c_all_of(inst->branch_computations(),
+                            [&](const HloComputation* branch) {
+                              return IsCommandComputation(branch,
+                                                          command_types);
+                            });
+    case HloOpcode::kWhile:
+      return command_types.contains(DebugOptions::CONDITIONALS) &&
+             IsCommandComputation(inst->while_condition(), command_types) &&
+             IsCommandComputation(inst->while_body(), command_types);
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 // The input is a scheduled sequence of instructions. This function collects
@@ -168,24 +217,35 @@ CommandBufferScheduling::BuildCommandBuffer(HloInstructionSequence seq) {
   // We copy instructions from the sequence to the computation and map the
   // original instruction to its clone.
   absl::flat_hash_map<HloInstruction*, HloInstruction*> instructions_map;
+  auto mapped_operands = [&](HloInstruction* inst) {
+    std::vector<HloInstruction*> operands;
+    for (HloInstruction* operand : inst->operands()) {
+      auto it = parameters_map.find(operand);
+      if (it != parameters_map.end()) {
+        operands.push_back(it->second);
+      } else {
+        operands.push_back(instructions_map[operand]);
+      }
+    }
+    return operands;
+  };
   for (HloInstruction* inst : seq.instructions()) {
     switch (inst->opcode()) {
       case HloOpcode::kFusion: {
-        std::vector<HloInstruction*> operands;
-        for (HloInstruction* operand : inst->operands()) {
-          auto it = parameters_map.find(operand);
-          if (it != parameters_map.end()) {
-            operands.push_back(it->second);
-          } else {
-            operands.push_back(instructions_map[operand]);
-          }
-        }
+        std::vector<HloInstruction*> operands = mapped_operands(inst);
         instructions_map[inst] =
             builder.AddInstruction(HloInstruction::CreateFusion(
                 inst->shape(), inst->fusion_kind(), operands,
                 inst->fused_instructions_computation()));
         break;
       }
+      // Conditionals and while loops keep calling their computations, which
+      // are recorded as nested command buffers.
+      case HloOpcode::kConditional:
+      case HloOpcode::kWhile:
+        instructions_map[inst] = builder.AddInstruction(
+            inst->CloneWithNewOperands(inst->shape(), mapped_operands(inst)));
+        break;
       case HloOpcode::kConstant:
         instructions_map[inst] = builder.AddInstruction(
             HloInstruction::CreateConstant(inst->literal().Clone()));
@@ -236,7 +296,7 @@ StatusOr<bool> CommandBufferScheduling::Run(
   HloComputation* entry = module->entry_computation();
   MoveParametersToFront(entry);
 
-  absl::flat_hash_set<DebugOptions::CommandBufferCmdType> command_types;
+  CommandTypes command_types;
   for (auto cmd_type_num :
        module->config().debug_options().xla_gpu_enable_command_buffer()) {
     DebugOptions::CommandBufferCmdType cmd_type =
@@ -247,10 +307,7 @@ StatusOr<bool> CommandBufferScheduling::Run(
   std::function<bool(const HloInstruction*)> is_command =
       [&command_types =
            std::as_const(command_types)](const HloInstruction* inst) {
-        if (inst->opcode() == HloOpcode::kFusion) {
-          if (command_types.contains(DebugOptions::FUSION)) return true;
-        }
-        return false;
+        return IsCommand(inst, command_types);
       };
 
   std::vector<HloInstructionSequence> sequences = CollectCommandBufferSequences(
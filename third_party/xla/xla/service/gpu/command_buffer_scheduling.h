@@ -33,7 +33,9 @@ limitations under the License.
 
 namespace xla::gpu {
 
-// Lift fusion instructions to command buffers.
+// Lift fusion instructions to command buffers. With CONDITIONALS commands
+// enabled, conditionals and while loops whose computations only have commands
+// are lifted too, and recorded as conditional command buffers.
 //
 // Before the pass:
 //   %fused_computation (param_0: s32[], param_1: s32[]) -> s32[] {
@@ -36,7 +36,14 @@ namespace xla::gpu {
 
 namespace {
 
-class CommandBufferSchedulingTest : public HloTestBase {};
+class CommandBufferSchedulingTest : public HloTestBase {
+ public:
+  DebugOptions GetDebugOptionsForTest() override {
+    auto debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.add_xla_gpu_enable_command_buffer(DebugOptions::CONDITIONALS);
+    return debug_options;
+  }
+};
 
 TEST_F(CommandBufferSchedulingTest, SingleCommandBuffer) {
   const char* hlo = R"(
@@ -421,6 +428,106 @@ TEST_F(CommandBufferSchedulingTest, RelayControlDependencies) {
                             });
 }
 
+TEST_F(CommandBufferSchedulingTest, WhileNotCommand) {
+  const char* hlo = R"(
+      HloModule TestModule, is_scheduled=true
+
+      %fused_computation (param_0: s32[], param_1: s32[]) -> s32[] {
+        %p0 = s32[] parameter(0)
+        %p1 = s32[] parameter(1)
+        ROOT %add = s32[] add(s32[] %p0, s32[] %p1)
+      }
+
+      %cond (param: s32[]) -> pred[] {
+        %param = s32[] parameter(0)
+        %constant = s32[] constant(10)
+        ROOT %compare = pred[] compare(s32[] %param, s32[] %constant), direction=LT
+      }
+
+      %body (param: s32[]) -> s32[] {
+        %param = s32[] parameter(0)
+        ROOT %custom-call = s32[] custom-call(s32[] %param), custom_call_target="some target"
+      }
+
+      ENTRY %main (a: s32[], b: s32[]) -> s32[] {
+        %a = s32[] parameter(0)
+        %b = s32[] parameter(1)
+        %fusion = s32[] fusion(s32[] %a, s32[] %b), kind=kLoop, calls=%fused_computation
+        ROOT %while = s32[] while(s32[] %fusion), condition=%cond, body=%body
+      })";
+
+  const char* expected = R"(
+// CHECK-NOT: %command_buffer
+// CHECK: ENTRY %main (a: s32[], b: s32[]) -> s32[] {
+// CHECK:   %fusion = s32[] fusion(%a, %b), kind=kLoop, calls=%fused_computation
+// CHECK:   ROOT %while = s32[] while(%fusion), condition=%cond, body=%body
+// CHECK: })";
+
+  RunAndFilecheckHloRewrite(hlo, CommandBufferScheduling(), expected);
+}
+
+TEST_F(CommandBufferSchedulingTest, WhileCommand) {
+  const char* hlo = R"(
+      HloModule TestModule, is_scheduled=true
+
+      %fused_computation (param_0: s32[], param_1: s32[]) -> s32[] {
+        %p0 = s32[] parameter(0)
+        %p1 = s32[] parameter(1)
+        ROOT %add = s32[] add(s32[] %p0, s32[] %p1)
+      }
+
+      %fused_computation.1 (param_0: s32[]) -> pred[] {
+        %p0 = s32[] parameter(0)
+        %constant = s32[] constant(10)
+        ROOT %compare = pred[] compare(s32[] %p0, s32[] %constant), direction=LT
+      }
+
+      %fused_computation.2 (param_0: s32[]) -> s32[] {
+        %p0 = s32[] parameter(0)
+        %constant = s32[] constant(1)
+        ROOT %add = s32[] add(s32[] %p0, s32[] %constant)
+      }
+
+      %cond (param: s32[]) -> pred[] {
+        %param = s32[] parameter(0)
+        ROOT %fusion = pred[] fusion(s32[] %param), kind=kLoop, calls=%fused_computation.1
+      }
+
+      %body (param: s32[]) -> s32[] {
+        %param = s32[] parameter(0)
+        ROOT %fusion = s32[] fusion(s32[] %param), kind=kLoop, calls=%fused_computation.2
+      }
+
+      ENTRY %main (a: s32[], b: s32[]) -> s32[] {
+        %a = s32[] parameter(0)
+        %b = s32[] parameter(1)
+        %fusion = s32[] fusion(s32[] %a, s32[] %b), kind=kLoop, calls=%fused_computation
+        %while = s32[] while(s32[] %fusion), condition=%cond, body=%body
+        ROOT %custom-call = s32[] custom-call(s32[] %while), custom_call_target="some target"
+      })";
+
+  const char* expected = R"(
+// CHECK: %command_buffer (param: s32[], param.1: s32[]) -> (s32[], s32[]) {
+// CHECK:   %param = s32[] parameter(0)
+// CHECK:   %param.1 = s32[] parameter(1)
+// CHECK:   %[[FUSION:.+]] = s32[] fusion(%param, %param.1), kind=kLoop, calls=%fused_computation
+// CHECK:   %[[WHILE:.+]] = s32[] while(%[[FUSION]]), condition=%cond, body=%body
+// CHECK:   ROOT %tuple = (s32[], s32[]) tuple(%[[FUSION]], %[[WHILE]])
+// CHECK: }
+//
+// CHECK: ENTRY %main (a: s32[], b: s32[]) -> s32[] {
+// CHECK:   %call = (s32[], s32[]) call(%a, %b), to_apply=%command_buffer
+// CHECK:   %get-tuple-element.1 = s32[] get-tuple-element(%call), index=1
+// CHECK:   ROOT %custom-call = s32[] custom-call(%get-tuple-element.1), custom_call_target="some target"
+// CHECK: })";
+
+  RunAndFilecheckHloRewrite(hlo, CommandBufferScheduling(), expected,
+                            [](HloModule* module) {
+                              EXPECT_TRUE(module->has_schedule());
+                              TF_CHECK_OK(module->schedule().Verify());
+                            });
+}
+
 }  // namespace
 
 }  // namespace xla::gpu
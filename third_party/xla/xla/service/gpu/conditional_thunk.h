@@ -57,10 +57,16 @@ class ConditionalThunk : public Thunk {
                     ExecutableSource src) override;
   Status ExecuteOnStream(const ExecuteParams& params) override;
 
-  absl::Span<const std::unique_ptr<SequentialThunk>> branch_thunks() {
+  absl::Span<const std::unique_ptr<SequentialThunk>> branch_thunks() const {
     return config_.branch_thunks;
   }
 
+  const BufferAllocation::Slice& branch_index_buffer() const {
+    return branch_index_buffer_index_;
+  }
+
+  bool branch_index_is_bool() const { return config_.branch_index_is_bool; }
+
  private:
   const ConditionalThunkConfig config_;
   BufferAllocation::Slice branch_index_buffer_index_;
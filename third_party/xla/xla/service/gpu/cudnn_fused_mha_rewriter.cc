@@ -115,6 +115,37 @@ auto OptionalBroadcast(Pattern pattern) {
   return m::AnyOf<HloInstruction>(m::Broadcast(shared), shared);
 }
 
+// Returns true if `instr` is one of the ops that build attention masks from
+// positions, e.g. the padding mask iota < broadcast(sequence_lengths) of a
+// batch of variable length sequences.
+bool IsMaskBuildingOp(const HloInstruction* instr) {
+  switch (instr->opcode()) {
+    case HloOpcode::kAnd:
+    case HloOpcode::kBitcast:
+    case HloOpcode::kBroadcast:
+    case HloOpcode::kCompare:
+    case HloOpcode::kConstant:
+    case HloOpcode::kConvert:
+    case HloOpcode::kIota:
+    case HloOpcode::kNot:
+    case HloOpcode::kOr:
+    case HloOpcode::kReshape:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Returns true if the masks `a` and `b` are the same instruction, or are built
+// the same way from the same inputs. Masks derived from sequence lengths are
+// typically recomputed for the backward pass, e.g. by rematerialization, rather
+// than shared with the forward pass.
+bool AreEquivalentMasks(const HloInstruction* a, const HloInstruction* b) {
+  if (a == b) return true;
+  if (!IsMaskBuildingOp(a)) return false;
+  return a->Identical(*b, AreEquivalentMasks);
+}
+
 bool IsBatchedMatmul(const HloInstruction* instr) {
   if (instr->opcode() != HloOpcode::kDot) return false;
   const DotDimensionNumbers& dot_dims = instr->dot_dimension_numbers();
@@ -843,8 +874,8 @@ MatchBwdResult MatchBwdBmmSoftmaxDropoutBmm(MatchBwdResult previous_result,
           m::Exp(&exp_1, m::Op()))));
 
   // Backward mask input pattern
-  // we already matched this in the fwd. Just make sure the same mask is used in
-  // the bwd
+  // we already matched this in the fwd. Just make sure the same mask, or an
+  // equivalent recomputation of it, is used in the bwd
   HloInstruction* bwd_mask_input = nullptr;
   HloInstruction* bwd_mask = nullptr;
   auto bwd_mask_pattern = OptionalConvert(
@@ -869,7 +900,8 @@ MatchBwdResult MatchBwdBmmSoftmaxDropoutBmm(MatchBwdResult previous_result,
     intermediate_input = bwd_scale_input;
   }
 
-  has_mask = Match(intermediate_input, bwd_mask_pattern) && mask == bwd_mask;
+  has_mask = Match(intermediate_input, bwd_mask_pattern) && mask != nullptr &&
+             AreEquivalentMasks(mask, bwd_mask);
 
   if (has_mask) {
     intermediate_input = bwd_mask_input;
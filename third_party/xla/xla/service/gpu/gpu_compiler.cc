@@ -85,6 +85,7 @@ limitations under the License.
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/buffer_value.h"
 #include "xla/service/call_inliner.h"
+#include "xla/service/collective_combiner_utils.h"
 #include "xla/service/collective_permute_decomposer.h"
 #include "xla/service/collective_pipeliner.h"
 #include "xla/service/collectives_schedule_linearizer.h"
@@ -861,17 +862,23 @@ Status GpuCompiler::OptimizeHloModule(HloModule* hlo_module,
 
   {
     HloPassPipeline pipeline("post-fusion optimization");
+    std::optional<CollectiveCombineOverlapModel> overlap_model;
+    if (debug_options.xla_gpu_enable_overlap_aware_collective_combining()) {
+      overlap_model = GetCollectiveCombineOverlapModel();
+    }
     pipeline.AddPass<AllGatherCombiner>(
         debug_options.xla_gpu_all_gather_combine_threshold_bytes(),
         /*combine_threshold_count=*/256,
-        debug_options.xla_gpu_enable_all_gather_combine_by_dim());
+        debug_options.xla_gpu_enable_all_gather_combine_by_dim(),
+        overlap_model);
     pipeline.AddPass<AllReduceCombiner>(
         debug_options.xla_gpu_all_reduce_combine_threshold_bytes(),
-        /*combine_threshold_count=*/256);
+        /*combine_threshold_count=*/256, overlap_model);
     pipeline.AddPass<ReduceScatterCombiner>(
         debug_options.xla_gpu_reduce_scatter_combine_threshold_bytes(),
         /*combine_threshold_count=*/256,
-        debug_options.xla_gpu_enable_reduce_scatter_combine_by_dim());
+        debug_options.xla_gpu_enable_reduce_scatter_combine_by_dim(),
+        overlap_model);
 
     if (debug_options.xla_gpu_all_reduce_contiguous()) {
       pipeline.AddPass<AllReduceContiguous>();
@@ -1667,6 +1674,10 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
       module->config().debug_options().xla_debug_buffer_assignment_show_max();
   bool enable_persistent_temp_buffers =
       module->config().debug_options().xla_gpu_enable_persistent_temp_buffers();
+  // Autotuning compilations run alone, and don't need to share temp buffers.
+  bool enable_shared_temp_buffers =
+      module->config().debug_options().xla_gpu_enable_shared_temp_buffers() &&
+      !options.is_autotuning_compilation;
 
   TF_ASSIGN_OR_RETURN(
       auto gpu_executable,
@@ -1689,6 +1700,7 @@ StatusOr<std::unique_ptr<Executable>> GpuCompiler::RunBackend(
           /*buffer_assignment=*/
           std::move(res.compile_module_results.buffer_assignment),
           /*enable_persistent_temp_buffers=*/enable_persistent_temp_buffers,
+          /*enable_shared_temp_buffers=*/enable_shared_temp_buffers,
           /*debug_buffer_assignment_show_max=*/debug_buffer_assignment_show_max,
           /*debug_module=*/options.is_autotuning_compilation
               ? std::unique_ptr<HloModule>()
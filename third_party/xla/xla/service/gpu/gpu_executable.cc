@@ -26,6 +26,8 @@ limitations under the License.
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
@@ -41,8 +43,10 @@ limitations under the License.
 #include "xla/service/buffer_assignment.h"
 #include "xla/service/gpu/buffer_allocations.h"
 #include "xla/service/gpu/gpu_constants.h"
+#include "xla/service/gpu/gpu_executable_run_options.h"
 #include "xla/service/gpu/non_atomically_upgradeable_rw_lock.h"
 #include "xla/service/gpu/runtime/executable.h"
+#include "xla/service/gpu/shared_temp_buffers.h"
 #include "xla/service/gpu/stream_executor_util.h"
 #include "xla/service/gpu/thunk.h"
 #include "xla/service/hlo_parser.h"
@@ -131,6 +135,7 @@ GpuExecutable::GpuExecutable(GpuExecutable::Params params)
       allocations_(std::move(params.mlir_allocations)),
       buffer_assignment_(std::move(params.buffer_assignment)),
       enable_persistent_temp_buffers_(params.enable_persistent_temp_buffers),
+      enable_shared_temp_buffers_(params.enable_shared_temp_buffers),
       debug_buffer_assignment_show_max_(
           params.debug_buffer_assignment_show_max),
       constants_(std::move(params.constants)),
@@ -578,8 +583,8 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
   absl::MutexLockMaybe lock(
       enable_persistent_temp_buffers_ ? &persistent_temp_buffers_mu_ : nullptr);
 
-  // Map from buffer allocation to persistent temp buffers. It is empty if
-  // persistent temp buffer is not enabled.
+  // Map from buffer allocation to persistent or shared temp buffers. It is
+  // empty if neither persistent nor shared temp buffers are enabled.
   BufferAllocToDeviceMemoryMap persistent_buffers_map = {};
 
   if (enable_persistent_temp_buffers_) {
@@ -588,6 +593,57 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
     persistent_buffers_map = persistent_temp_buffers_[executor];
   }
 
+  // If the temp buffers are shared with other executables, the execution holds
+  // the lock of the arena of the device until it is enqueued.
+  SharedTempBuffers::Arena* shared_arena = nullptr;
+  if (enable_shared_temp_buffers_ && !enable_persistent_temp_buffers_) {
+    const GpuExecutableRunOptions* gpu_run_options =
+        run_options->run_options().gpu_executable_run_options();
+    if (gpu_run_options && gpu_run_options->shared_temp_buffers() &&
+        absl::c_any_of(GetAllocations(), [](const BufferAllocation& alloc) {
+          return alloc.IsPreallocatedTempBuffer();
+        })) {
+      shared_arena = &gpu_run_options->shared_temp_buffers()->GetArena(
+          executor->device_ordinal());
+    }
+  }
+  absl::MutexLockMaybe shared_arena_lock(
+      shared_arena ? &shared_arena->mutex() : nullptr);
+  // Once acquired, the arena is released on every path, so that the next
+  // executions wait for whatever this one enqueued before failing.
+  bool shared_arena_acquired = false;
+  absl::Cleanup release_shared_arena = [&] {
+    if (!shared_arena_acquired) return;
+    shared_arena->mutex().AssertHeld();
+    Status status = shared_arena->Release(run_options->stream());
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to release the shared temp buffers: " << status;
+    }
+  };
+
+  if (shared_arena) {
+    shared_arena->mutex().AssertHeld();
+    // The temp buffers are laid out one after the other in the arena.
+    std::vector<std::pair<BufferAllocation::Index, int64_t>> offsets;
+    int64_t arena_size = 0;
+    for (const BufferAllocation& allocation : GetAllocations()) {
+      if (allocation.IsPreallocatedTempBuffer()) {
+        offsets.emplace_back(allocation.index(), arena_size);
+        arena_size += RoundUpTo<int64_t>(allocation.size(),
+                                         kXlaAllocatedBufferAlignBytes);
+      }
+    }
+    TF_ASSIGN_OR_RETURN(se::DeviceMemoryBase arena,
+                        shared_arena->Acquire(run_options->stream(),
+                                              memory_allocator, arena_size));
+    shared_arena_acquired = true;
+    for (const auto& [index, offset] : offsets) {
+      persistent_buffers_map[index] = se::DeviceMemoryBase(
+          static_cast<char*>(arena.opaque()) + offset,
+          GetAllocations()[index].size());
+    }
+  }
+
   // Force synchronous execution if the allocator requires it.
   const bool block_host_until_done =
       !memory_allocator->AllowsAsynchronousDeallocation();
@@ -737,6 +793,11 @@ StatusOr<ExecutionOutput> GpuExecutable::ExecuteAsyncOnStreamImpl(
 
   TF_RETURN_IF_ERROR(ExecuteThunksOrXlaRuntime(
       run_options, buffer_allocations, block_host_until_done, gpu_lock));
+  if (shared_arena_acquired) {
+    shared_arena->mutex().AssertHeld();
+    shared_arena_acquired = false;
+    TF_RETURN_IF_ERROR(shared_arena->Release(run_options->stream()));
+  }
 
   // Free all temporary allocations.
   std::vector<BufferAllocation> non_persistent_allocations;
@@ -96,6 +96,7 @@ class GpuExecutable : public Executable {
     std::optional<std::vector<BufferAllocation>> mlir_allocations;
     std::unique_ptr<const BufferAssignment> buffer_assignment;
     bool enable_persistent_temp_buffers;
+    bool enable_shared_temp_buffers;
     int64_t debug_buffer_assignment_show_max;
     std::unique_ptr<HloModule> debug_module = nullptr;
     bool enable_debug_info_manager = true;
@@ -309,6 +310,10 @@ class GpuExecutable : public Executable {
 
   bool enable_persistent_temp_buffers_ = false;
 
+  // Whether the temp buffers are in the arena shared with other executables,
+  // provided by the GpuExecutableRunOptions, see SharedTempBuffers.
+  bool enable_shared_temp_buffers_ = false;
+
   absl::Mutex persistent_temp_buffers_mu_;
   // Temp buffers can be allocated once and be reused whenever the GpuExecutable
   // is executed. The persistent temp buffer is stored in a map that maps from
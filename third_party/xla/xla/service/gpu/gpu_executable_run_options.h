@@ -18,12 +18,14 @@ limitations under the License.
 
 #include <functional>
 #include <map>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "xla/service/global_device_id.h"
+#include "xla/service/gpu/shared_temp_buffers.h"
 #include "xla/service/service_executable_run_options.h"
 #include "xla/statusor.h"
 #include "xla/stream_executor/stream_executor.h"
@@ -106,11 +108,25 @@ class GpuExecutableRunOptions {
     return *this;
   }
 
+  // The temp buffers shared by the executables compiled with
+  // xla_gpu_enable_shared_temp_buffers. Without them, these executables
+  // allocate their own temp buffers.
+  SharedTempBuffers* shared_temp_buffers() const {
+    return shared_temp_buffers_.get();
+  }
+
+  GpuExecutableRunOptions& set_shared_temp_buffers(
+      std::shared_ptr<SharedTempBuffers> shared_temp_buffers) {
+    shared_temp_buffers_ = std::move(shared_temp_buffers);
+    return *this;
+  }
+
  private:
   bool requires_exclusive_lock_on_gpu_ = false;
   bool enable_mock_nccl_collectives_ = false;
   std::optional<std::map<int, GlobalDeviceId>> gpu_global_device_ids_;
   NcclUniqueIdCallback nccl_unique_id_callback_;
+  std::shared_ptr<SharedTempBuffers> shared_temp_buffers_;
 };
 
 // NCCL-related execution parameters.
@@ -43,6 +43,7 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_schedule.h"
 #include "xla/hlo/utils/hlo_query.h"
 #include "xla/service/buffer_value.h"
+#include "xla/service/collective_combiner_utils.h"
 #include "xla/service/gpu/backend_configs.pb.h"
 #include "xla/service/gpu/cublas_cudnn.h"
 #include "xla/service/gpu/gpu_schedule_postprocessing.h"
@@ -398,6 +399,10 @@ class GpuAsyncTracker : public GpuAsyncTrackerBase {
 
 class GpuLatencyEstimator : public ApproximateLatencyEstimator {
  public:
+  // The latency of an async collective.
+  static constexpr TimeCost kCollectiveLatency =
+      ApproximateLatencyEstimator::kHighLatency;
+
   explicit GpuLatencyEstimator(
       GetCanonicalAsyncOpFunc func = GpuGetCanonicalAsyncOp)
       : ApproximateLatencyEstimator(func) {}
@@ -604,8 +609,21 @@ Status IsProfileApplicable(
   return OkStatus();
 }
 
+// The number of bytes a collective moves in about its latency, i.e. the size
+// from which its cost is dominated by the bandwidth.
+constexpr int64_t kCollectiveBytesPerLatency = 32 * 1024 * 1024;
+
 }  // end namespace
 
+CollectiveCombineOverlapModel GetCollectiveCombineOverlapModel() {
+  CollectiveCombineOverlapModel model;
+  model.latency_estimator = std::make_shared<GpuLatencyEstimator>();
+  model.collective_latency = GpuLatencyEstimator::kCollectiveLatency;
+  model.cost_per_byte =
+      GpuLatencyEstimator::kCollectiveLatency / kCollectiveBytesPerLatency;
+  return model;
+}
+
 int64_t GetSizeOfShape(const Shape& shape, int pointer_size) {
   int64_t size = ShapeUtil::ByteSizeOf(shape, pointer_size);
   if (shape.is_static() || shape.IsTuple()) {
@@ -17,6 +17,7 @@ limitations under the License.
 #define XLA_SERVICE_GPU_GPU_HLO_SCHEDULE_H_
 
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/collective_combiner_utils.h"
 #include "xla/stream_executor/device_description.h"
 
 namespace xla {
@@ -24,6 +25,11 @@ namespace gpu {
 
 int64_t GetSizeOfShape(const Shape& shape, int pointer_size);
 
+// Returns the costs the latency hiding scheduler assigns to collectives and
+// compute, for the collective combiners to size the combined collectives so
+// that the scheduler can overlap them with compute.
+CollectiveCombineOverlapModel GetCollectiveCombineOverlapModel();
+
 // Determines the schedule of HLO instructions for a module run on the GPU.
 Status ScheduleGpuModule(HloModule* module, int64_t pointer_size,
                          int64_t memory_limit,
@@ -372,6 +372,9 @@ int DeriveNumWarpsFromTritonSoftmaxComputation(
   return num_warps;
 }
 
+StatusOr<CommandBufferCmdSequence> ConvertToCommands(
+    const ThunkSequence& sequence);
+
 StatusOr<std::unique_ptr<CommandBufferCmd>> ConvertToCommand(
     const Thunk& thunk) {
   switch (thunk.kind()) {
@@ -383,6 +386,38 @@ StatusOr<std::unique_ptr<CommandBufferCmd>> ConvertToCommand(
           kernel_thunk.launch_dimensions(), kernel_thunk.shmem_bytes());
       return kernel_cmd;
     }
+    // Control flow is recorded as conditional command buffers, which are
+    // launched by the device, so that the whole computation is a single launch.
+    case Thunk::Kind::kConditional: {
+      auto& conditional_thunk = static_cast<const ConditionalThunk&>(thunk);
+      std::vector<CommandBufferCmdSequence> branches;
+      for (const std::unique_ptr<SequentialThunk>& branch_thunk :
+           conditional_thunk.branch_thunks()) {
+        TF_ASSIGN_OR_RETURN(CommandBufferCmdSequence branch,
+                            ConvertToCommands(branch_thunk->thunks()));
+        branches.push_back(std::move(branch));
+      }
+      if (conditional_thunk.branch_index_is_bool()) {
+        TF_RET_CHECK(branches.size() == 2);
+        return std::make_unique<IfElseCmd>(
+            conditional_thunk.branch_index_buffer(), std::move(branches[0]),
+            std::move(branches[1]));
+      }
+      return std::make_unique<CaseCmd>(conditional_thunk.branch_index_buffer(),
+                                       std::move(branches));
+    }
+    case Thunk::Kind::kWhile: {
+      auto& while_thunk = static_cast<const WhileThunk&>(thunk);
+      TF_ASSIGN_OR_RETURN(
+          CommandBufferCmdSequence cond_cmds,
+          ConvertToCommands(while_thunk.condition_thunk_sequence()->thunks()));
+      TF_ASSIGN_OR_RETURN(
+          CommandBufferCmdSequence body_cmds,
+          ConvertToCommands(while_thunk.body_thunk_sequence()->thunks()));
+      return std::make_unique<WhileCmd>(while_thunk.condition_result_buffer(),
+                                        std::move(cond_cmds),
+                                        std::move(body_cmds));
+    }
     default:
       return InternalError("Unsupported thunk kind");
   }
@@ -3664,8 +3699,13 @@ Status IrEmitterUnnested::EmitHloInstruction(const HloInstruction* instr) {
       TF_RETURN_IF_ERROR(EmitFusion(fusion, fusion_analysis));
       return OkStatus();
     }
+    case HloOpcode::kConditional:
+      return EmitConditional(instr);
+    case HloOpcode::kWhile:
+      return EmitWhile(instr);
     // We don't need to emit thunks for these operations because their semantics
     // are encoded by buffers.
+    case HloOpcode::kBitcast:
     case HloOpcode::kGetTupleElement:
     case HloOpcode::kParameter:
     case HloOpcode::kTuple: {
@@ -3680,13 +3720,68 @@ Status IrEmitterUnnested::EmitHloInstruction(const HloInstruction* instr) {
 
 Status IrEmitterUnnested::EmitHloComputation(
     const HloComputation* computation) {
-  ThunkSequence thunk_sequence;
-  for (const HloInstruction* instr : computation->instructions()) {
+  // Thunks run in the order they are emitted, so follow the schedule of the
+  // computation if it has one.
+  const HloModule* module = computation->parent();
+  if (module->has_schedule() &&
+      module->schedule().is_computation_scheduled(computation)) {
+    for (const HloInstruction* instr :
+         module->schedule().sequence(computation).instructions()) {
+      TF_RETURN_IF_ERROR(EmitHloInstruction(instr));
+    }
+    return OkStatus();
+  }
+  for (const HloInstruction* instr : computation->MakeInstructionPostOrder()) {
     TF_RETURN_IF_ERROR(EmitHloInstruction(instr));
   }
   return OkStatus();
 }
 
+Status IrEmitterUnnested::EmitConditional(const HloInstruction* instr) {
+  ConditionalThunkConfig config;
+  config.branch_index_is_bool =
+      instr->operand(0)->shape().element_type() == PRED;
+  config.branch_count = instr->branch_count();
+  config.branch_thunks.reserve(config.branch_count);
+  for (const HloComputation* branch : instr->branch_computations()) {
+    auto ir_emitter = IrEmitterUnnested::Create(ir_emitter_context_);
+    TF_RETURN_IF_ERROR(ir_emitter->EmitHloComputation(branch));
+    // The branch thunks are "part of" the ConditionalThunk, and shouldn't be
+    // profiled separately from it.
+    config.branch_thunks.emplace_back(
+        new SequentialThunk(Thunk::ThunkInfo(nullptr),
+                            std::move(*ir_emitter->ConsumeThunkSequence())));
+  }
+
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice branch_index,
+                      GetAllocationSliceForHlo(instr->operand(0), {}));
+  AddThunkToThunkSequence(std::make_unique<ConditionalThunk>(
+      Thunk::ThunkInfo::WithProfileAnnotation(instr), std::move(config),
+      branch_index));
+  return OkStatus();
+}
+
+Status IrEmitterUnnested::EmitWhile(const HloInstruction* instr) {
+  const HloInstruction* cond_root =
+      instr->while_condition()->root_instruction();
+  TF_RET_CHECK(ShapeUtil::IsScalarWithElementType(cond_root->shape(), PRED))
+      << "While condition computation must return bool";
+
+  auto ir_emitter_condition = IrEmitterUnnested::Create(ir_emitter_context_);
+  TF_RETURN_IF_ERROR(
+      ir_emitter_condition->EmitHloComputation(instr->while_condition()));
+  auto ir_emitter_body = IrEmitterUnnested::Create(ir_emitter_context_);
+  TF_RETURN_IF_ERROR(ir_emitter_body->EmitHloComputation(instr->while_body()));
+
+  TF_ASSIGN_OR_RETURN(BufferAllocation::Slice pred,
+                      GetAllocationSliceForHlo(cond_root, {}));
+  AddThunkToThunkSequence(std::make_unique<WhileThunk>(
+      Thunk::ThunkInfo::WithProfileAnnotation(instr), pred,
+      ir_emitter_condition->ConsumeThunkSequence(),
+      ir_emitter_body->ConsumeThunkSequence()));
+  return OkStatus();
+}
+
 void IrEmitterUnnested::GetDependentDialects(mlir::DialectRegistry& registry) {
   registry.insert<mlir::arith::ArithDialect, mlir::func::FuncDialect,
                   mlir::gpu::GPUDialect, mlir::lmhlo::LmhloDialect,
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/log/log.h"
@@ -59,7 +60,16 @@ Status CommandBufferCmdSequence::Initialize(
 
 Status CommandBufferCmdSequence::Record(
     const CommandBufferCmd::RecordParams& params,
-    se::CommandBuffer* command_buffer) {
+    se::CommandBuffer* command_buffer, RecordMode mode) {
+  // Conditional command buffers are updated and finalized by the parent
+  // command, and must record all commands every time the parent does.
+  if (mode == RecordMode::kConditional) {
+    for (auto& cmd : commands_) {
+      TF_RETURN_IF_ERROR(cmd->Record(params, command_buffer));
+    }
+    return OkStatus();
+  }
+
   if (command_buffer->state() == se::CommandBuffer::State::kFinalized) {
     TF_RETURN_IF_ERROR(command_buffer->Update());
   }
@@ -73,6 +83,15 @@ Status CommandBufferCmdSequence::Record(
   return command_buffer->Finalize();
 }
 
+CommandBufferCmd::Slices CommandBufferCmdSequence::slices() {
+  CommandBufferCmd::Slices slices;
+  for (auto& cmd : commands_) {
+    CommandBufferCmd::Slices cmd_slices = cmd->slices();
+    slices.insert(slices.end(), cmd_slices.begin(), cmd_slices.end());
+  }
+  return slices;
+}
+
 bool CommandBufferCmdSequence::ShouldUpdateCmd(
     const CommandBufferCmd::RecordParams& params) {
   bool should_update = false;
@@ -225,4 +244,129 @@ CommandBufferCmd::Slices GemmCmd::slices() {
   return {lhs_buffer_, rhs_buffer_, output_buffer_};
 }
 
+//===----------------------------------------------------------------------===//
+// Conditional commands
+//===----------------------------------------------------------------------===//
+
+// Returns a builder recording `commands` into a conditional command buffer.
+static se::CommandBuffer::Builder ConditionalBuilder(
+    CommandBufferCmdSequence* commands,
+    const CommandBufferCmd::RecordParams& params) {
+  return [commands, &params](se::CommandBuffer* command_buffer) {
+    return commands->Record(params, command_buffer,
+                            CommandBufferCmdSequence::RecordMode::kConditional);
+  };
+}
+
+//===----------------------------------------------------------------------===//
+// IfElseCmd
+//===----------------------------------------------------------------------===//
+
+IfElseCmd::IfElseCmd(BufferAllocation::Slice pred,
+                     CommandBufferCmdSequence then_commands,
+                     CommandBufferCmdSequence else_commands)
+    : pred_(pred),
+      then_commands_(std::move(then_commands)),
+      else_commands_(std::move(else_commands)) {}
+
+Status IfElseCmd::Initialize(se::StreamExecutor* executor,
+                             ExecutableSource source) {
+  TF_RETURN_IF_ERROR(then_commands_.Initialize(executor, source));
+  return else_commands_.Initialize(executor, source);
+}
+
+Status IfElseCmd::Record(const RecordParams& params,
+                         se::CommandBuffer* command_buffer) {
+  VLOG(5) << "IfElseCmd: pred=" << pred_;
+  se::DeviceMemory<bool> pred(
+      params.buffer_allocations->GetDeviceAddress(pred_));
+  return command_buffer->IfElse(pred,
+                                ConditionalBuilder(&then_commands_, params),
+                                ConditionalBuilder(&else_commands_, params));
+}
+
+CommandBufferCmd::Slices IfElseCmd::slices() {
+  Slices slices = {pred_};
+  for (const Slices& branch_slices :
+       {then_commands_.slices(), else_commands_.slices()}) {
+    slices.insert(slices.end(), branch_slices.begin(), branch_slices.end());
+  }
+  return slices;
+}
+
+//===----------------------------------------------------------------------===//
+// CaseCmd
+//===----------------------------------------------------------------------===//
+
+CaseCmd::CaseCmd(BufferAllocation::Slice index,
+                 std::vector<CommandBufferCmdSequence> branches_commands)
+    : index_(index), branches_commands_(std::move(branches_commands)) {}
+
+Status CaseCmd::Initialize(se::StreamExecutor* executor,
+                           ExecutableSource source) {
+  for (CommandBufferCmdSequence& branch : branches_commands_) {
+    TF_RETURN_IF_ERROR(branch.Initialize(executor, source));
+  }
+  return OkStatus();
+}
+
+Status CaseCmd::Record(const RecordParams& params,
+                       se::CommandBuffer* command_buffer) {
+  VLOG(5) << "CaseCmd: index=" << index_
+          << ", branches=" << branches_commands_.size();
+  se::DeviceMemory<int32_t> index(
+      params.buffer_allocations->GetDeviceAddress(index_));
+  std::vector<se::CommandBuffer::Builder> branches;
+  branches.reserve(branches_commands_.size());
+  for (CommandBufferCmdSequence& branch : branches_commands_) {
+    branches.push_back(ConditionalBuilder(&branch, params));
+  }
+  return command_buffer->Case(index, std::move(branches));
+}
+
+CommandBufferCmd::Slices CaseCmd::slices() {
+  Slices slices = {index_};
+  for (CommandBufferCmdSequence& branch : branches_commands_) {
+    Slices branch_slices = branch.slices();
+    slices.insert(slices.end(), branch_slices.begin(), branch_slices.end());
+  }
+  return slices;
+}
+
+//===----------------------------------------------------------------------===//
+// WhileCmd
+//===----------------------------------------------------------------------===//
+
+WhileCmd::WhileCmd(BufferAllocation::Slice pred,
+                   CommandBufferCmdSequence cond_commands,
+                   CommandBufferCmdSequence body_commands)
+    : pred_(pred),
+      cond_commands_(std::move(cond_commands)),
+      body_commands_(std::move(body_commands)) {}
+
+Status WhileCmd::Initialize(se::StreamExecutor* executor,
+                            ExecutableSource source) {
+  TF_RETURN_IF_ERROR(cond_commands_.Initialize(executor, source));
+  return body_commands_.Initialize(executor, source);
+}
+
+Status WhileCmd::Record(const RecordParams& params,
+                        se::CommandBuffer* command_buffer) {
+  VLOG(5) << "WhileCmd: pred=" << pred_;
+  se::DeviceMemory<bool> pred(
+      params.buffer_allocations->GetDeviceAddress(pred_));
+  return command_buffer->While(pred,
+                               ConditionalBuilder(&cond_commands_, params),
+                               ConditionalBuilder(&body_commands_, params));
+}
+
+CommandBufferCmd::Slices WhileCmd::slices() {
+  Slices slices = {pred_};
+  for (const Slices& nested_slices :
+       {cond_commands_.slices(), body_commands_.slices()}) {
+    slices.insert(slices.end(), nested_slices.begin(), nested_slices.end());
+  }
+  return slices;
+}
+
 }  // namespace xla::gpu
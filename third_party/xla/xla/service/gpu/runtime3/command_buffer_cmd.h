@@ -96,9 +96,22 @@ class CommandBufferCmdSequence {
   Status Initialize(se::StreamExecutor* executor,
                     CommandBufferCmd::ExecutableSource source);
 
+  // In kExclusive mode the sequence owns the command buffer: it begins and
+  // finalizes the updates of the command buffer, and skips recording if no
+  // buffer allocations changed since the last call. In kConditional mode the
+  // sequence only records its commands, into a conditional command buffer
+  // owned by a parent command (see IfElseCmd, CaseCmd and WhileCmd).
+  enum class RecordMode { kExclusive, kConditional };
+
   // Records all commands added to a sequence into the given command buffer.
   Status Record(const CommandBufferCmd::RecordParams& params,
-                se::CommandBuffer* command_buffer);
+                se::CommandBuffer* command_buffer,
+                RecordMode mode = RecordMode::kExclusive);
+
+  // Returns buffer slices of all commands added to a sequence.
+  CommandBufferCmd::Slices slices();
+
+  bool empty() const { return commands_.empty(); }
 
  private:
   // Traverse the list of commands and figures out if any of them requires an
@@ -190,6 +203,84 @@ class GemmCmd : public CommandBufferCmd {
   const bool deterministic_;
 };
 
+//===----------------------------------------------------------------------===//
+// IfElseCmd
+//===----------------------------------------------------------------------===//
+
+// Runs `then_commands` if the predicate in the `pred` buffer is true, and
+// `else_commands` otherwise, as a conditional HLO operation with a boolean
+// branch index.
+class IfElseCmd : public CommandBufferCmd {
+ public:
+  IfElseCmd(BufferAllocation::Slice pred,
+            CommandBufferCmdSequence then_commands,
+            CommandBufferCmdSequence else_commands);
+
+  Status Initialize(se::StreamExecutor* executor,
+                    ExecutableSource source) override;
+
+  Status Record(const RecordParams& params,
+                se::CommandBuffer* command_buffer) override;
+
+  Slices slices() override;
+
+ private:
+  BufferAllocation::Slice pred_;
+  CommandBufferCmdSequence then_commands_;
+  CommandBufferCmdSequence else_commands_;
+};
+
+//===----------------------------------------------------------------------===//
+// CaseCmd
+//===----------------------------------------------------------------------===//
+
+// Runs the commands of the branch at the index in the `index` buffer, or of
+// the last branch if it is out of range, as a conditional HLO operation with
+// an s32 branch index.
+class CaseCmd : public CommandBufferCmd {
+ public:
+  CaseCmd(BufferAllocation::Slice index,
+          std::vector<CommandBufferCmdSequence> branches_commands);
+
+  Status Initialize(se::StreamExecutor* executor,
+                    ExecutableSource source) override;
+
+  Status Record(const RecordParams& params,
+                se::CommandBuffer* command_buffer) override;
+
+  Slices slices() override;
+
+ private:
+  BufferAllocation::Slice index_;
+  std::vector<CommandBufferCmdSequence> branches_commands_;
+};
+
+//===----------------------------------------------------------------------===//
+// WhileCmd
+//===----------------------------------------------------------------------===//
+
+// Runs `body_commands` while the predicate computed into the `pred` buffer by
+// `cond_commands` is true, as a while HLO operation. The loop runs on the
+// device, so the trip count doesn't have to be known on the host.
+class WhileCmd : public CommandBufferCmd {
+ public:
+  WhileCmd(BufferAllocation::Slice pred, CommandBufferCmdSequence cond_commands,
+           CommandBufferCmdSequence body_commands);
+
+  Status Initialize(se::StreamExecutor* executor,
+                    ExecutableSource source) override;
+
+  Status Record(const RecordParams& params,
+                se::CommandBuffer* command_buffer) override;
+
+  Slices slices() override;
+
+ private:
+  BufferAllocation::Slice pred_;
+  CommandBufferCmdSequence cond_commands_;
+  CommandBufferCmdSequence body_commands_;
+};
+
 }  // namespace xla::gpu
 
 #endif  // XLA_SERVICE_GPU_RUNTIME3_COMMAND_BUFFER_CMD_H_
@@ -0,0 +1,78 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/shared_temp_buffers.h"
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/synchronization/mutex.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_allocator.h"
+#include "xla/stream_executor/event.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/util.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/statusor.h"
+
+namespace xla::gpu {
+
+StatusOr<se::DeviceMemoryBase> SharedTempBuffers::Arena::Acquire(
+    se::Stream* stream, se::DeviceMemoryAllocator* allocator, int64_t size) {
+  if (done_ != nullptr && last_stream_ != stream) {
+    stream->ThenWaitFor(done_.get());
+  }
+  if (buffer_->size() < size) {
+    // The previous executions may still use the arena, and other allocations
+    // may reuse its memory once freed.
+    if (done_ != nullptr) {
+      TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+    }
+    TF_RETURN_IF_ERROR(buffer_.Free());
+    VLOG(2) << "Growing the shared temp buffers of device "
+            << stream->parent()->device_ordinal() << " to " << size
+            << " bytes";
+    TF_ASSIGN_OR_RETURN(
+        buffer_,
+        allocator->Allocate(stream->parent()->device_ordinal(), size));
+  }
+  return se::DeviceMemoryBase(buffer_->opaque(), size);
+}
+
+Status SharedTempBuffers::Arena::Release(se::Stream* stream) {
+  if (done_ == nullptr) {
+    done_ = std::make_unique<se::Event>(stream->parent());
+    if (!done_->Init()) {
+      // Without the event, the next executions can't wait for this one, so
+      // wait for it here instead.
+      done_ = nullptr;
+      TF_RETURN_IF_ERROR(stream->BlockHostUntilDone());
+      return InternalError("Failed to create the shared temp buffers event");
+    }
+  }
+  stream->ThenRecordEvent(done_.get());
+  last_stream_ = stream;
+  return OkStatus();
+}
+
+SharedTempBuffers::Arena& SharedTempBuffers::GetArena(int device_ordinal) {
+  absl::MutexLock lock(&mu_);
+  return arenas_[device_ordinal];
+}
+
+}  // namespace xla::gpu
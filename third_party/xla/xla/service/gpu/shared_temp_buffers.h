@@ -0,0 +1,81 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_SERVICE_GPU_SHARED_TEMP_BUFFERS_H_
+#define XLA_SERVICE_GPU_SHARED_TEMP_BUFFERS_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "xla/status.h"
+#include "xla/statusor.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_allocator.h"
+#include "xla/stream_executor/event.h"
+#include "xla/stream_executor/stream.h"
+
+namespace xla::gpu {
+
+// Device memory shared by the temp buffers of the executables compiled with
+// xla_gpu_enable_shared_temp_buffers, and run with the same
+// GpuExecutableRunOptions, e.g. all those loaded into a PjRt client. Instead
+// of each executable allocating its own temp buffers, each device has a single
+// arena, sized to the largest temp buffers of the executables run on it.
+//
+// The executions sharing an arena are serialized: an execution holds the arena
+// lock while it is enqueued, and runs on the device after all the executions
+// enqueued before it, even if they are enqueued on another stream.
+class SharedTempBuffers {
+ public:
+  class Arena {
+   public:
+    absl::Mutex& mutex() ABSL_LOCK_RETURNED(mu_) { return mu_; }
+
+    // Returns 'size' bytes of the arena for an execution enqueued on 'stream',
+    // which waits for the previous executions. The arena grows with
+    // 'allocator' if it is smaller.
+    StatusOr<se::DeviceMemoryBase> Acquire(se::Stream* stream,
+                                           se::DeviceMemoryAllocator* allocator,
+                                           int64_t size)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+    // Records that the execution using the arena is enqueued on 'stream', so
+    // that the next executions wait for it. Must be called after every
+    // successful Acquire(), including when the execution fails to be enqueued
+    // entirely. If the event can't be recorded, waits for 'stream' instead.
+    Status Release(se::Stream* stream) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+   private:
+    absl::Mutex mu_;
+    se::OwningDeviceMemory buffer_ ABSL_GUARDED_BY(mu_);
+    // Recorded after the last execution using the arena, on 'last_stream_'.
+    std::unique_ptr<se::Event> done_ ABSL_GUARDED_BY(mu_);
+    se::Stream* last_stream_ ABSL_GUARDED_BY(mu_) = nullptr;
+  };
+
+  // Returns the arena of the device 'device_ordinal'.
+  Arena& GetArena(int device_ordinal);
+
+ private:
+  absl::Mutex mu_;
+  absl::node_hash_map<int, Arena> arenas_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace xla::gpu
+
+#endif  // XLA_SERVICE_GPU_SHARED_TEMP_BUFFERS_H_
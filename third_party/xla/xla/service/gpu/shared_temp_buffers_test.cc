@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/service/gpu/shared_temp_buffers.h"
+
+#include <atomic>
+
+#include "absl/synchronization/mutex.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/device_memory_allocator.h"
+#include "xla/stream_executor/multi_platform_manager.h"
+#include "xla/stream_executor/platform.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/stream_executor.h"
+#include "tsl/lib/core/status_test_util.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/statusor.h"
+#include "tsl/platform/test.h"
+
+#if GOOGLE_CUDA
+#define PLATFORM "CUDA"
+#else
+#define PLATFORM "ROCM"
+#endif
+
+namespace xla::gpu {
+namespace {
+
+class SharedTempBuffersTest : public ::testing::Test {
+ protected:
+  SharedTempBuffersTest()
+      : executor_(se::MultiPlatformManager::PlatformWithName(PLATFORM)
+                      .value()
+                      ->ExecutorForDevice(0)
+                      .value()),
+        allocator_(executor_) {}
+
+  se::StreamExecutor* executor_;
+  se::StreamExecutorMemoryAllocator allocator_;
+  SharedTempBuffers shared_temp_buffers_;
+};
+
+TEST_F(SharedTempBuffersTest, ArenaGrowsToLargestAcquire) {
+  se::Stream stream(executor_);
+  stream.Init();
+  SharedTempBuffers::Arena& arena = shared_temp_buffers_.GetArena(0);
+  absl::MutexLock lock(&arena.mutex());
+
+  TF_ASSERT_OK_AND_ASSIGN(se::DeviceMemoryBase first,
+                          arena.Acquire(&stream, &allocator_, 1024));
+  EXPECT_EQ(first.size(), 1024);
+  TF_ASSERT_OK(arena.Release(&stream));
+
+  // A smaller execution reuses the arena.
+  TF_ASSERT_OK_AND_ASSIGN(se::DeviceMemoryBase smaller,
+                          arena.Acquire(&stream, &allocator_, 512));
+  EXPECT_EQ(smaller.opaque(), first.opaque());
+  EXPECT_EQ(smaller.size(), 512);
+  TF_ASSERT_OK(arena.Release(&stream));
+
+  TF_ASSERT_OK_AND_ASSIGN(se::DeviceMemoryBase larger,
+                          arena.Acquire(&stream, &allocator_, 4096));
+  EXPECT_EQ(larger.size(), 4096);
+  TF_ASSERT_OK(arena.Release(&stream));
+
+  TF_ASSERT_OK_AND_ASSIGN(se::DeviceMemoryBase again,
+                          arena.Acquire(&stream, &allocator_, 1024));
+  EXPECT_EQ(again.opaque(), larger.opaque());
+  TF_ASSERT_OK(arena.Release(&stream));
+  TF_ASSERT_OK(stream.BlockHostUntilDone());
+}
+
+TEST_F(SharedTempBuffersTest, ArenasArePerDevice) {
+  EXPECT_EQ(&shared_temp_buffers_.GetArena(0),
+            &shared_temp_buffers_.GetArena(0));
+  EXPECT_NE(&shared_temp_buffers_.GetArena(0),
+            &shared_temp_buffers_.GetArena(1));
+}
+
+TEST_F(SharedTempBuffersTest, ExecutionsOnOtherStreamsWaitForPrevious) {
+  se::Stream first_stream(executor_);
+  first_stream.Init();
+  se::Stream second_stream(executor_);
+  second_stream.Init();
+  SharedTempBuffers::Arena& arena = shared_temp_buffers_.GetArena(0);
+  std::atomic<bool> first_done = false;
+  bool second_ran_after_first = false;
+  {
+    absl::MutexLock lock(&arena.mutex());
+    TF_ASSERT_OK(arena.Acquire(&first_stream, &allocator_, 1024).status());
+    first_stream.ThenDoHostCallback([&first_done] {
+      tsl::Env::Default()->SleepForMicroseconds(100 * 1000);
+      first_done = true;
+    });
+    TF_ASSERT_OK(arena.Release(&first_stream));
+
+    TF_ASSERT_OK(arena.Acquire(&second_stream, &allocator_, 1024).status());
+    second_stream.ThenDoHostCallback([&] {
+      second_ran_after_first = first_done;
+    });
+    TF_ASSERT_OK(arena.Release(&second_stream));
+  }
+  TF_ASSERT_OK(second_stream.BlockHostUntilDone());
+  TF_ASSERT_OK(first_stream.BlockHostUntilDone());
+  EXPECT_TRUE(second_ran_after_first);
+}
+
+}  // namespace
+}  // namespace xla::gpu
@@ -49,10 +49,16 @@ class WhileThunk : public Thunk {
                     ExecutableSource src) override;
   Status ExecuteOnStream(const ExecuteParams& params) override;
 
-  SequentialThunk* condition_thunk_sequence() {
+  SequentialThunk* condition_thunk_sequence() const {
     return condition_thunk_sequence_.get();
   }
-  SequentialThunk* body_thunk_sequence() { return body_thunk_sequence_.get(); }
+  SequentialThunk* body_thunk_sequence() const {
+    return body_thunk_sequence_.get();
+  }
+
+  const BufferAllocation::Slice& condition_result_buffer() const {
+    return condition_result_buffer_index_;
+  }
 
  private:
   const BufferAllocation::Slice condition_result_buffer_index_;
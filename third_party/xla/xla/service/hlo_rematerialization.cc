@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <memory>
@@ -2816,6 +2817,35 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   return changed;
 }
 
+/*static*/ std::function<StatusOr<bool>(HloModule*, int64_t)>
+HloRematerialization::CreateHostOffloadFunction(
+    HloCostAnalysis::Options cost_analysis_options,
+    HostMemoryOffloadConfig host_memory_offload_config,
+    int64_t min_remat_size) {
+  return [cost_analysis_options = std::move(cost_analysis_options),
+          host_memory_offload_config, min_remat_size](
+             HloModule* module, int64_t memory_limit_bytes) -> StatusOr<bool> {
+    HloCostAnalysis cost_analysis(cost_analysis_options);
+    Options options(cost_analysis,
+                    RematerializationModeConfig(/*recompute=*/false,
+                                                /*compress=*/false,
+                                                /*host_offload=*/true),
+                    memory_limit_bytes, /*block_size_limit=*/1,
+                    /*block_rematerialization_factor=*/1, min_remat_size,
+                    /*compact_shape_function=*/nullptr,
+                    host_memory_offload_config);
+    RematerializationSizes sizes;
+    HloRematerialization rematerialization(options, sizes);
+    TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(module));
+    if (changed) {
+      VLOG(1) << "Host offloading reduced the peak memory from "
+              << HumanReadableNumBytes(sizes.before_bytes) << " to "
+              << HumanReadableNumBytes(sizes.after_bytes);
+    }
+    return changed;
+  };
+}
+
 StatusOr<bool> HloRematerialization::Run(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
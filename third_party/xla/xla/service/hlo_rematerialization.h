@@ -15,6 +15,8 @@
 #ifndef XLA_SERVICE_HLO_REMATERIALIZATION_H_
 #define XLA_SERVICE_HLO_REMATERIALIZATION_H_
 
+#include <cstdint>
+#include <functional>
 #include <optional>
 #include <utility>
 
@@ -147,6 +149,16 @@ class HloRematerialization : public HloModulePass {
   explicit HloRematerialization(Options options, RematerializationSizes& sizes)
       : options_(std::move(options)), sizes_(sizes) {}
 
+  // Returns a function which offloads buffers of a scheduled module to host
+  // memory, with the kHostOffload strategy only, until its peak memory fits in
+  // the given limit in bytes. This lets a scheduler, e.g. as the host offload
+  // function of LatencyHidingScheduler, decide on offloading with the memory
+  // model of this pass.
+  static std::function<StatusOr<bool>(HloModule*, int64_t)>
+  CreateHostOffloadFunction(HloCostAnalysis::Options cost_analysis_options,
+                            HostMemoryOffloadConfig host_memory_offload_config,
+                            int64_t min_remat_size = 0);
+
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -77,6 +77,10 @@ CanonicalAsyncOp DefaultGetCanonicalAsyncOp(const HloInstruction& hlo) {
       return {HloOpcode::kAsyncDone, HloOpcode::kAllGather};
     case HloOpcode::kCollectivePermuteDone:
       return {HloOpcode::kAsyncDone, HloOpcode::kCollectivePermute};
+    case HloOpcode::kCopyStart:
+      return {HloOpcode::kAsyncStart, HloOpcode::kCopy};
+    case HloOpcode::kCopyDone:
+      return {HloOpcode::kAsyncDone, HloOpcode::kCopy};
     default:
       return {hlo.opcode(), hlo.opcode()};
   }
@@ -133,6 +137,8 @@ bool AsyncTracker::IsSupportedAsyncDone(const HloInstruction& hlo) const {
       case HloOpcode::kCollectivePermute:
       case HloOpcode::kReduceScatter:
         return true;
+      case HloOpcode::kCopy:
+        return config_.schedule_async_copies;
       default:
         return false;
     }
@@ -160,6 +166,8 @@ bool AsyncTracker::IsSupportedAsyncStart(const HloInstruction& hlo) const {
       case HloOpcode::kCollectivePermute:
       case HloOpcode::kReduceScatter:
         return true;
+      case HloOpcode::kCopy:
+        return config_.schedule_async_copies;
       default:
         return false;
     }
@@ -182,6 +190,8 @@ ResourcesVector AsyncTracker::GetResourcesFromInstruction(
         return ResourceType::kCollectivePermute;
       case HloOpcode::kReduceScatter:
         return ResourceType::kReduceScatter;
+      case HloOpcode::kCopy:
+        return ResourceType::kCopy;
       default:
         return ResourceType::kNoResource;
     }
@@ -329,6 +339,8 @@ void AsyncTracker::SetConcurrentResourceLimits(
       config_.send_recv_host_overlap_limit;
   max_concurrent_resource[ResourceTypeToIndex(ResourceType::kRecvHost)] =
       config_.send_recv_host_overlap_limit;
+  max_concurrent_resource[ResourceTypeToIndex(ResourceType::kCopy)] =
+      config_.copy_overlap_limit;
   // Set the limits for target-defined resources
   const int64_t first_target_resource =
       AsyncTracker::GetFirstTargetDefinedResource();
@@ -356,6 +368,8 @@ absl::string_view AsyncTracker::GetResourceName(int64_t resource_type) const {
       return "kSendHost";
     case ResourceTypeToIndex(ResourceType::kRecvHost):
       return "kRecvHost";
+    case ResourceTypeToIndex(ResourceType::kCopy):
+      return "kCopy";
     default:
       return "Not a valid default resource";
   }
@@ -1921,11 +1935,10 @@ void LatencyHidingScheduler::LogScheduleStatistics(
                         async_tracker_.get(), shape_size_bytes_)));
 }
 
-StatusOr<bool> LatencyHidingScheduler::Run(
+StatusOr<absl::flat_hash_map<HloComputation*, std::vector<HloInstruction*>>>
+LatencyHidingScheduler::ScheduleComputations(
     HloModule* module,
     const absl::flat_hash_set<absl::string_view>& execution_threads) {
-  VLOG(5) << "Original module:";
-  XLA_VLOG_LINES(5, module->ToString());
   // Currently we expect that a schedule that minimizes memory pressure is
   // provided as a base. It's not necessary for the algorithm itself but it
   // allows us to not having to think for now about memory pressure.
@@ -1943,11 +1956,11 @@ StatusOr<bool> LatencyHidingScheduler::Run(
     }
   }
 
-  if (computations_to_schedule.empty()) {
-    return false;
-  }
   absl::flat_hash_map<HloComputation*, std::vector<HloInstruction*>>
       saved_schedules;
+  if (computations_to_schedule.empty()) {
+    return saved_schedules;
+  }
   TF_RETURN_IF_ERROR(scheduler_core_->InitializeScheduler(module));
   for (HloComputation* computation : computations_to_schedule) {
     TF_ASSIGN_OR_RETURN(std::vector<HloInstruction*> new_schedule,
@@ -1975,11 +1988,50 @@ StatusOr<bool> LatencyHidingScheduler::Run(
   }
   LOG(INFO) << "LatencyHidingScheduler current memory usage: "
             << scheduler_core_->GetMemoryPeak() << " bytes.";
-  for (HloComputation* computation : computations_to_schedule) {
+  return saved_schedules;
+}
+
+StatusOr<bool> LatencyHidingScheduler::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  VLOG(5) << "Original module:";
+  XLA_VLOG_LINES(5, module->ToString());
+  const uint64_t memory_limit = scheduler_core_->GetMemoryLimit();
+  TF_ASSIGN_OR_RETURN(auto saved_schedules,
+                      ScheduleComputations(module, execution_threads));
+
+  // If the schedule still doesn't fit, offload buffers to host memory. The
+  // offloading is decided on the latency hiding schedule, then the module is
+  // scheduled again to overlap the copies to and from the host with compute.
+  // Without latency hiding opportunities yet, the offloading decides on the
+  // existing schedule whether the module fits.
+  bool offloaded = false;
+  if (host_offload_ &&
+      memory_limit < std::numeric_limits<int64_t>::max() &&
+      (saved_schedules.empty() ||
+       scheduler_core_->GetMemoryPeak() > memory_limit)) {
+    for (auto& [computation, schedule] : saved_schedules) {
+      module->schedule().set_sequence(computation,
+                                      absl::MakeConstSpan(schedule));
+    }
+    TF_ASSIGN_OR_RETURN(offloaded, host_offload_(module, memory_limit));
+    if (offloaded) {
+      LOG(INFO) << "LatencyHidingScheduler offloaded buffers to host memory, "
+                   "scheduling the module again";
+      scheduler_core_->SetMemoryLimit(memory_limit);
+      TF_ASSIGN_OR_RETURN(saved_schedules,
+                          ScheduleComputations(module, execution_threads));
+    }
+  }
+
+  if (saved_schedules.empty()) {
+    return offloaded;
+  }
+  for (auto& [computation, schedule] : saved_schedules) {
     VLOG(1) << "Statistics before scheduling:";
     LogScheduleStatistics(computation);
-    module->schedule().set_sequence(
-        computation, absl::MakeConstSpan(saved_schedules[computation]));
+    module->schedule().set_sequence(computation,
+                                    absl::MakeConstSpan(schedule));
     VLOG(1) << "Statistics after scheduling:";
     LogScheduleStatistics(computation);
   }
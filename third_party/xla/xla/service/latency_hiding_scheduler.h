@@ -26,12 +26,15 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/str_cat.h"
 #include "xla/hlo/ir/hlo_instruction.h"
 #include "xla/service/hlo_alias_analysis.h"
 #include "xla/service/hlo_cost_analysis.h"
 #include "xla/service/hlo_pass_interface.h"
+#include "xla/statusor.h"
 #include "xla/xla.pb.h"
 
 namespace xla {
@@ -60,7 +63,8 @@ enum class ResourceType {
   kSendRecv = 6,
   kSendHost = 7,
   kRecvHost = 8,
-  kNumResources = 9,
+  kCopy = 9,
+  kNumResources = 10,
   kTargetDefinedResourcesBound = 10000,
 };
 
@@ -99,8 +103,12 @@ struct SchedulerConfig {
   int64_t reduce_scatter_overlap_limit = 1;
   int64_t send_recv_overlap_limit = 1;
   int64_t send_recv_host_overlap_limit = 1;
+  int64_t copy_overlap_limit = 1;
   uint64_t memory_limit = UINT64_MAX;
   bool schedule_send_recvs = false;
+  // Schedule copy-start/copy-done as asynchronous operations, e.g. to hide the
+  // latency of the copies of the buffers offloaded to host memory.
+  bool schedule_async_copies = false;
   // Consider send recv as the same resource. Some platforms do not take well
   // overlapping the send/recv ops between themselves.
   bool force_send_recv_to_use_same_resource = false;
@@ -869,15 +877,26 @@ class LatencyHidingScheduler : public HloModulePass {
     int64_t memory_pressure_peak = 0;
   };
 
+  // Offloads buffers of a scheduled module to host memory, with async copies,
+  // so that its peak memory fits in the given limit in bytes. Returns whether
+  // the module changed.
+  using HostOffloadFunction =
+      std::function<StatusOr<bool>(HloModule* module, int64_t memory_limit)>;
+
+  // If 'host_offload' is set, it is called when the scheduled module doesn't
+  // fit in the memory limit of the scheduler, and the module is then scheduled
+  // again to hide the latency of the added copies.
   LatencyHidingScheduler(
       std::unique_ptr<LatencyEstimator> latency_estimator,
       std::unique_ptr<AsyncTracker> async_tracker,
       std::unique_ptr<SchedulerCore> scheduler_core,
-      const HloCostAnalysis::ShapeSizeFunction& shape_size_bytes)
+      const HloCostAnalysis::ShapeSizeFunction& shape_size_bytes,
+      HostOffloadFunction host_offload = nullptr)
       : latency_estimator_(std::move(latency_estimator)),
         async_tracker_(std::move(async_tracker)),
         scheduler_core_(std::move(scheduler_core)),
-        shape_size_bytes_(shape_size_bytes) {}
+        shape_size_bytes_(shape_size_bytes),
+        host_offload_(std::move(host_offload)) {}
   absl::string_view name() const override { return "latency-hiding-scheduler"; }
 
   // Returns some printable statistics about the latency hiding for
@@ -899,10 +918,18 @@ class LatencyHidingScheduler : public HloModulePass {
   virtual void LogScheduleStatistics(const HloComputation* computation);
 
  private:
+  // Schedules the computations with latency hiding opportunities, returning
+  // their new schedules.
+  StatusOr<absl::flat_hash_map<HloComputation*, std::vector<HloInstruction*>>>
+  ScheduleComputations(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads);
+
   std::unique_ptr<LatencyEstimator> latency_estimator_;
   std::unique_ptr<AsyncTracker> async_tracker_;
   std::unique_ptr<SchedulerCore> scheduler_core_;
   const HloCostAnalysis::ShapeSizeFunction shape_size_bytes_;
+  HostOffloadFunction host_offload_;
   absl::flat_hash_set<HloComputation*> computations_to_schedule_;
 };
 
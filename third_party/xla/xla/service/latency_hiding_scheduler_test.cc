@@ -31,6 +31,8 @@ limitations under the License.
 #include "xla/hlo/ir/hlo_opcode.h"
 #include "xla/hlo/ir/hlo_schedule.h"
 #include "xla/service/async_collective_creator.h"
+#include "xla/service/hlo_cost_analysis.h"
+#include "xla/service/hlo_rematerialization.h"
 #include "xla/tests/hlo_test_base.h"
 
 namespace xla {
@@ -130,7 +132,8 @@ class TestLatencyEstimator : public LatencyEstimator {
 StatusOr<bool> RunScheduler(
     HloModule* module, SchedulerConfig sched_config = GetDefaultSchedConfig(),
     std::unique_ptr<LatencyEstimator> latency_estimator =
-        std::make_unique<ApproximateLatencyEstimator>()) {
+        std::make_unique<ApproximateLatencyEstimator>(),
+    LatencyHidingScheduler::HostOffloadFunction host_offload = nullptr) {
   AsyncCollectiveCreator::CollectiveCreatorConfig config{
       /*convert_all_reduce=*/HloPredicateTrue,
       /*convert_all_gather=*/HloPredicateTrue,
@@ -153,9 +156,10 @@ StatusOr<bool> RunScheduler(
       shape_size_bytes, async_tracker.get(), latency_estimator.get(),
       sched_config);
   TF_ASSIGN_OR_RETURN(
-      value, LatencyHidingScheduler(std::move(latency_estimator),
-                                    std::move(async_tracker),
-                                    std::move(scheduler_core), shape_size_bytes)
+      value, LatencyHidingScheduler(
+                 std::move(latency_estimator), std::move(async_tracker),
+                 std::move(scheduler_core), shape_size_bytes,
+                 std::move(host_offload))
                  .Run(module));
 
   return value;
@@ -2916,4 +2920,70 @@ TEST_F(LatencyHidingSchedulerTest, RerunWithSmallerMemoryLimit) {
   EXPECT_LT(PositionInVector(new_instruction_sequence, s),
             PositionInVector(new_instruction_sequence, cps));
 }
+
+TEST_F(LatencyHidingSchedulerTest, OffloadToHostAndHideCopies) {
+  absl::string_view hlo_string = R"(
+    HloModule offload_test, is_scheduled=true
+    ENTRY main {
+      p0 = f32[1024]{0} parameter(0)
+      p1 = f32[1024]{0} parameter(1)
+      res_3 = f32[1024]{0} add(p0, p1)
+      res_4 = f32[1024]{0} tanh(res_3)
+      res_5 = f32[1024]{0} tanh(res_4)
+      res_6 = f32[1024]{0} tanh(res_5)
+      res_7 = f32[1024]{0} add(res_6, res_6)
+      res_8 = f32[1024]{0} add(res_7, res_5)
+      res_9 = f32[1024]{0} add(res_8, res_4)
+      res_10 = f32[1024]{0} add(res_9, res_3)
+      ROOT res_11 = f32[1024]{0} tanh(res_10)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module, ParseHloText(hlo_string));
+  // Compute is much slower than the copies to and from the host, so that
+  // offloading is preferred.
+  HloCostAnalysis::Options cost_analysis_options;
+  cost_analysis_options.shape_size = [](const Shape& shape) {
+    return ShapeUtil::ByteSizeOf(shape, /*pointer_size=*/8);
+  };
+  cost_analysis_options.set_flops_per_second(2 * 1024);
+  cost_analysis_options.set_transcendentals_per_second(2 * 1024);
+  HloRematerialization::HostMemoryOffloadConfig host_memory_offload_config(
+      /*host_memory_space=*/5, /*bandwidth_to_host_bytes_per_second=*/4 * 1024,
+      /*bandwidth_from_host_bytes_per_second=*/4 * 1024);
+
+  auto sched_config = GetDefaultSchedConfig();
+  sched_config.memory_limit = 10 * 1024;
+  sched_config.schedule_async_copies = true;
+  TF_ASSERT_OK_AND_ASSIGN(
+      bool changed,
+      RunScheduler(hlo_module.get(), sched_config,
+                   std::make_unique<ApproximateLatencyEstimator>(),
+                   HloRematerialization::CreateHostOffloadFunction(
+                       cost_analysis_options, host_memory_offload_config)));
+  EXPECT_TRUE(changed);
+
+  // Buffers are offloaded, and each async copy overlaps some compute.
+  std::vector<HloInstruction*> new_instruction_sequence =
+      hlo_module->schedule()
+          .sequence(hlo_module->entry_computation())
+          .instructions();
+  if (VLOG_IS_ON(1)) {
+    for (auto* new_i : new_instruction_sequence) {
+      VLOG(1) << new_i->ToString();
+    }
+  }
+  int num_copies = 0;
+  for (const HloInstruction* instr : new_instruction_sequence) {
+    if (instr->opcode() != HloOpcode::kCopyDone) {
+      continue;
+    }
+    ++num_copies;
+    EXPECT_GT(PositionInVector(new_instruction_sequence, instr),
+              PositionInVector(new_instruction_sequence, instr->operand(0)) +
+                  1);
+  }
+  EXPECT_GT(num_copies, 0);
+}
+
 }  // namespace xla
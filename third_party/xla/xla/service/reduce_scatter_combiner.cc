@@ -21,6 +21,7 @@ limitations under the License.
 #include <iterator>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -166,12 +167,14 @@ Status CombineReduceScatters(absl::Span<HloInstruction* const> to_combine) {
 }
 }  // namespace
 
-ReduceScatterCombiner::ReduceScatterCombiner(int64_t combine_threshold_in_bytes,
-                                             int64_t combine_threshold_count,
-                                             bool combine_by_dim)
+ReduceScatterCombiner::ReduceScatterCombiner(
+    int64_t combine_threshold_in_bytes, int64_t combine_threshold_count,
+    bool combine_by_dim,
+    std::optional<CollectiveCombineOverlapModel> overlap_model)
     : combine_threshold_in_bytes_(combine_threshold_in_bytes),
       combine_threshold_count_(combine_threshold_count),
-      combine_by_dim_(combine_by_dim) {}
+      combine_by_dim_(combine_by_dim),
+      overlap_model_(std::move(overlap_model)) {}
 
 StatusOr<bool> ReduceScatterCombiner::Run(
     HloModule* module,
@@ -218,7 +221,8 @@ StatusOr<bool> ReduceScatterCombiner::Run(
         bool computation_changed,
         CombineInstructionsByKey<ReduceScatterKey>(
             computation, key_fn, &CombineReduceScatters,
-            combine_threshold_in_bytes_, combine_threshold_count_));
+            combine_threshold_in_bytes_, combine_threshold_count_,
+            overlap_model_ ? &*overlap_model_ : nullptr));
     changed |= computation_changed;
   }
 
@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef XLA_SERVICE_REDUCE_SCATTER_COMBINER_H_
 #define XLA_SERVICE_REDUCE_SCATTER_COMBINER_H_
 
+#include <optional>
+
 #include "xla/hlo/ir/hlo_module.h"
+#include "xla/service/collective_combiner_utils.h"
 #include "xla/service/hlo_pass_interface.h"
 #include "xla/statusor.h"
 
@@ -28,8 +31,11 @@ namespace xla {
 // more efficient than many small ones.
 class ReduceScatterCombiner : public HloModulePass {
  public:
-  ReduceScatterCombiner(int64_t combine_threshold_in_bytes,
-                        int64_t combine_threshold_count, bool combine_by_dim);
+  ReduceScatterCombiner(
+      int64_t combine_threshold_in_bytes, int64_t combine_threshold_count,
+      bool combine_by_dim,
+      std::optional<CollectiveCombineOverlapModel> overlap_model =
+          std::nullopt);
 
   absl::string_view name() const override { return "reduce-scatter-combiner"; }
 
@@ -47,6 +53,10 @@ class ReduceScatterCombiner : public HloModulePass {
 
   // Combine only reduce-scatter ops with the same dimension.
   bool combine_by_dim_;
+
+  // If set, sizes the combined ops by the compute they overlap with, within
+  // the thresholds above.
+  std::optional<CollectiveCombineOverlapModel> overlap_model_;
 };
 
 }  // namespace xla
@@ -18,6 +18,7 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
@@ -110,6 +111,25 @@ tsl::Status CommandBuffer::If(DeviceMemory<bool> pred, Builder then_builder) {
   return implementation_->If(executor_, pred, std::move(then_builder));
 }
 
+tsl::Status CommandBuffer::IfElse(DeviceMemory<bool> pred, Builder then_builder,
+                                  Builder else_builder) {
+  return implementation_->IfElse(executor_, pred, std::move(then_builder),
+                                 std::move(else_builder));
+}
+
+tsl::Status CommandBuffer::Case(DeviceMemory<int32_t> index,
+                                std::vector<Builder> branches) {
+  return implementation_->Case(executor_, index, std::move(branches));
+}
+
+tsl::Status CommandBuffer::While(DeviceMemory<bool> pred, Builder cond_builder,
+                                 Builder body_builder) {
+  // Compute the initial value of the predicate in this command buffer.
+  TF_RETURN_IF_ERROR(cond_builder(this));
+  return implementation_->While(executor_, pred, std::move(cond_builder),
+                                std::move(body_builder));
+}
+
 CommandBuffer::Mode CommandBuffer::mode() const {
   return implementation_->mode();
 }
@@ -19,6 +19,7 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "absl/functional/any_invocable.h"
 #include "xla/stream_executor/device_memory.h"
@@ -119,6 +120,30 @@ class CommandBuffer {
   // for updating and finalizing conditional command buffers.
   tsl::Status If(DeviceMemory<bool> pred, Builder then_builder);
 
+  // Adds a conditional operation that will execute a command buffer constructed
+  // by `then_builder` if predicate is true, or a command buffer constructed by
+  // `else_builder` if predicate is false.
+  tsl::Status IfElse(DeviceMemory<bool> pred, Builder then_builder,
+                     Builder else_builder);
+
+  // Adds a conditional operation that will execute a command buffer constructed
+  // by the `branches` builder at `index`. If `index` is out of range, then it
+  // will run a conditional command buffer constructed by the last builder.
+  tsl::Status Case(DeviceMemory<int32_t> index, std::vector<Builder> branches);
+
+  // Adds a conditional operation that will execute a command buffer constructed
+  // by `body_builder` while the predicate computed by `cond_builder` is true:
+  //
+  //   cond_builder()
+  //   while (pred):
+  //     body_builder()
+  //     cond_builder()
+  //
+  // Commands of `cond_builder` are recorded twice, into this command buffer and
+  // into the conditional one, so it is called twice.
+  tsl::Status While(DeviceMemory<bool> pred, Builder cond_builder,
+                    Builder body_builder);
+
   // Finalizes command buffer and makes it executable. Once command buffer is
   // finalized no commands can be added to it.
   tsl::Status Finalize();
@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdint>
+
 #include "third_party/gpus/cuda/include/cuda.h"
 
 namespace stream_executor {
@@ -21,8 +23,54 @@ namespace {
 
 #if CUDA_VERSION >= 12030
 
-__global__ void SetCondition(cudaGraphConditionalHandle handle,
-                             bool* predicate) {
+__global__ void SetIfCondition(cudaGraphConditionalHandle then_handle,
+                               bool* predicate) {
+#if defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
+  if (*predicate) {
+    cudaGraphSetConditional(then_handle, 1);
+  } else {
+    cudaGraphSetConditional(then_handle, 0);
+  }
+#endif  // defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
+}
+
+__global__ void SetIfElseCondition(cudaGraphConditionalHandle then_handle,
+                                   cudaGraphConditionalHandle else_handle,
+                                   bool* predicate) {
+#if defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
+  if (*predicate) {
+    cudaGraphSetConditional(then_handle, 1);
+    cudaGraphSetConditional(else_handle, 0);
+  } else {
+    cudaGraphSetConditional(then_handle, 0);
+    cudaGraphSetConditional(else_handle, 1);
+  }
+#endif  // defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
+}
+
+// Enables the conditional command buffer of the branch at `index`, or of the
+// last one if `index` is out of [0, num_handles) range, as for a conditional
+// HLO operation. Only the first `num_handles` handles are valid.
+__global__ void SetCaseCondition(
+    cudaGraphConditionalHandle h0, cudaGraphConditionalHandle h1,
+    cudaGraphConditionalHandle h2, cudaGraphConditionalHandle h3,
+    cudaGraphConditionalHandle h4, cudaGraphConditionalHandle h5,
+    cudaGraphConditionalHandle h6, cudaGraphConditionalHandle h7,
+    int32_t* index, int32_t num_handles) {
+#if defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
+  cudaGraphConditionalHandle handles[] = {h0, h1, h2, h3, h4, h5, h6, h7};
+  int32_t branch = *index;
+  if (branch < 0 || branch >= num_handles) {
+    branch = num_handles - 1;
+  }
+  for (int32_t i = 0; i < num_handles; ++i) {
+    cudaGraphSetConditional(handles[i], i == branch ? 1 : 0);
+  }
+#endif  // defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
+}
+
+__global__ void SetWhileCondition(cudaGraphConditionalHandle handle,
+                                  bool* predicate) {
 #if defined(XLA_GPU_USE_CUDA_GRAPH_CONDITIONAL)
   if (*predicate) {
     cudaGraphSetConditional(handle, 1);
@@ -33,15 +81,30 @@ __global__ void SetCondition(cudaGraphConditionalHandle handle,
 }
 
 #else
-__global__ void SetCondition() {}
+__global__ void SetIfCondition() {}
+__global__ void SetIfElseCondition() {}
+__global__ void SetCaseCondition() {}
+__global__ void SetWhileCondition() {}
 #endif  // CUDA_VERSION >= 12030
 
 }  // namespace
 }  // namespace cuda
 
 namespace gpu {
-void* GetSetConditionKernel() {
-  return reinterpret_cast<void*>(&cuda::SetCondition);
+void* GetSetIfConditionKernel() {
+  return reinterpret_cast<void*>(&cuda::SetIfCondition);
+}
+
+void* GetSetIfElseConditionKernel() {
+  return reinterpret_cast<void*>(&cuda::SetIfElseCondition);
+}
+
+void* GetSetCaseConditionKernel() {
+  return reinterpret_cast<void*>(&cuda::SetCaseCondition);
+}
+
+void* GetSetWhileConditionKernel() {
+  return reinterpret_cast<void*>(&cuda::SetWhileCondition);
 }
 }  // namespace gpu
 
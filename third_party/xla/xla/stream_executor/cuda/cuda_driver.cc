@@ -758,6 +758,9 @@ GpuDriver::GraphAddNode(CUgraphNode* node, CUgraph graph,
       case GpuDriver::GpuGraphConditionalNodeParams::Type::kIf:
         cu_params.conditional.type = CU_GRAPH_COND_TYPE_IF;
         break;
+      case GpuDriver::GpuGraphConditionalNodeParams::Type::kWhile:
+        cu_params.conditional.type = CU_GRAPH_COND_TYPE_WHILE;
+        break;
     }
 
     RETURN_IF_CUDA_RES_ERROR(
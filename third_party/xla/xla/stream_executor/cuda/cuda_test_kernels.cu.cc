@@ -34,6 +34,12 @@ __global__ void AddI32Ptrs3(Ptrs3<int32_t> ptrs) {
   ptrs.c[index] = ptrs.a[index] + ptrs.b[index];
 }
 
+__global__ void IncAndCmp(int32_t* counter, bool* pred, int32_t value) {
+  unsigned idx = threadIdx.x + blockIdx.x * blockDim.x;
+  pred[idx] = counter[idx] < value;
+  counter[idx] += 1;
+}
+
 void* GetAddI32CudaKernel() { return reinterpret_cast<void*>(&AddI32); }
 
 void* GetMulI32CudaKernel() { return reinterpret_cast<void*>(&MulI32); }
@@ -42,4 +48,6 @@ void* GetAddI32Ptrs3CudaKernel() {
   return reinterpret_cast<void*>(&AddI32Ptrs3);
 }
 
+void* GetIncAndCmpCudaKernel() { return reinterpret_cast<void*>(&IncAndCmp); }
+
 }  // namespace stream_executor::cuda::internal
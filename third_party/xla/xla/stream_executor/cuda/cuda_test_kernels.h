@@ -93,6 +93,15 @@ void* GetMulI32CudaKernel();
 // StreamExecutor arguments packing for custom C++ types.
 void* GetAddI32Ptrs3CudaKernel();
 
+// Returns a pointer to device kernel that sets `pred` to `counter < value` and
+// increments `counter`, to test loops in command buffers:
+//
+//  __global__ void inc_and_cmp(int* counter, bool* pred, int value) {
+//    pred[0] = counter[0] < value;
+//    counter[0] += 1;
+//  }
+void* GetIncAndCmpCudaKernel();
+
 }  // namespace stream_executor::cuda::internal
 
 #endif  // XLA_STREAM_EXECUTOR_CUDA_CUDA_TEST_KERNELS_H_
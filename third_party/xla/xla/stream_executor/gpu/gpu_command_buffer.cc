@@ -15,10 +15,14 @@ limitations under the License.
 
 #include "xla/stream_executor/gpu/gpu_command_buffer.h"
 
+#include <array>
 #include <atomic>
+#include <cstddef>
 #include <cstdint>
+#include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #include "absl/functional/any_invocable.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "xla/stream_executor/command_buffer.h"
 #include "xla/stream_executor/device_memory.h"
@@ -40,6 +45,7 @@ limitations under the License.
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
 
 namespace stream_executor::gpu {
 
@@ -265,43 +271,52 @@ tsl::Status GpuCommandBuffer::MemcpyDeviceToDevice(DeviceMemoryBase* dst,
   return UnsupportedStateError(state_);
 }
 
-tsl::Status GpuCommandBuffer::If(StreamExecutor* executor,
-                                 DeviceMemory<bool> predicate,
-                                 CommandBuffer::Builder then_builder) {
-  DCHECK(executor->implementation() == parent_);  // NOLINT
+//===----------------------------------------------------------------------===//
+// Command buffer conditional commands API
+//===----------------------------------------------------------------------===//
+
+// Loads a device kernel updating conditional handles from an in-process symbol.
+template <typename Kernel>
+static tsl::Status LoadConditionKernel(StreamExecutor* executor, void* symbol,
+                                       absl::string_view name, Kernel* kernel) {
+  // TODO(ezhulenev): Keep kernels in `GpuCommandBuffer` to avoid loading them
+  // on every call to conditional commands.
+  MultiKernelLoaderSpec spec(/*arity=*/Kernel::kNumberOfParameters);
+  spec.AddInProcessSymbol(symbol, std::string(name));
+  return executor->GetKernel(spec, kernel);
+}
 
-  // TODO(ezhulenev): Keep kernel in `GpuCommandBuffer` to avoid loading it on
-  // every call to `If`.
-  SetConditionKernel set_condition(executor);
+/*static*/ GpuCommandBuffer::ConditionBuilder
+GpuCommandBuffer::ToConditionBuilder(CommandBuffer::Builder builder) {
+  return [builder = std::move(builder)](CommandBuffer* cmd_buffer,
+                                        GpuGraphConditionalHandle) {
+    return builder(cmd_buffer);
+  };
+}
 
-  {  // Load kernels that update condition handle value.
-    MultiKernelLoaderSpec spec(/*arity=*/1);
-    spec.AddInProcessSymbol(gpu::GetSetConditionKernel(), "set_condition");
-    TF_RETURN_IF_ERROR(executor->GetKernel(spec, &set_condition));
+tsl::StatusOr<std::vector<GpuGraphConditionalHandle>>
+GpuCommandBuffer::CreateConditionalHandles(size_t num_handles) {
+  std::vector<GpuGraphConditionalHandle> handles;
+  for (size_t i = 0; i < num_handles; ++i) {
+    TF_RETURN_IF_ERROR(GpuDriver::GraphConditionalHandleCreate(
+        &handles.emplace_back(), graph_, parent_->gpu_context(), 0, 0));
   }
+  return handles;
+}
 
+tsl::StatusOr<std::vector<GpuGraphHandle>>
+GpuCommandBuffer::CreateConditionalNodes(
+    ConditionType type, absl::Span<const GpuGraphConditionalHandle> handles) {
   using ConditionalParams = GpuDriver::GpuGraphConditionalNodeParams;
   using ConditionalResult = GpuDriver::GpuGraphConditionalNodeParams::Result;
 
-  // Conditional command buffers always created in nested mode.
-  CommandBuffer::Mode nested = CommandBuffer::Mode::kNested;
-
-  if (state_ == State::kCreate) {
-    // Create a handle for a conditional node.
-    GpuGraphConditionalHandle handle;
-    TF_RETURN_IF_ERROR(GpuDriver::GraphConditionalHandleCreate(
-        &handle, graph_, parent_->gpu_context(), 0, 0));
-
-    // Add a kernel to update conditional handle value based on a predicate.
-    TF_RETURN_IF_ERROR(
-        Launch(set_condition, ThreadDim(), BlockDim(), handle, predicate));
-
-    // Add conditional node to the graph.
+  std::vector<GpuGraphHandle> conditional_graphs;
+  for (GpuGraphConditionalHandle handle : handles) {
     Dependencies deps = GetDependencies();
     GpuGraphNodeHandle* node = &nodes_.emplace_back();
 
     ConditionalParams params;
-    params.type = ConditionalParams::Type::kIf;
+    params.type = type;
     params.handle = handle;
     params.context = parent_->gpu_context();
 
@@ -309,19 +324,84 @@ tsl::Status GpuCommandBuffer::If(StreamExecutor* executor,
         GpuDriver::GpuGraphNodeResult result,
         GpuDriver::GraphAddNode(node, graph_, absl::MakeSpan(deps), params));
 
-    // Set up conditional command buffer.
-    GpuGraphHandle then_graph = std::get<ConditionalResult>(result).graph;
+    conditional_graphs.push_back(std::get<ConditionalResult>(result).graph);
+  }
+  return conditional_graphs;
+}
+
+tsl::StatusOr<std::vector<CommandBuffer>>
+GpuCommandBuffer::CreateConditionalCommandBuffers(
+    StreamExecutor* executor,
+    absl::Span<const GpuGraphConditionalHandle> handles,
+    absl::Span<const GpuGraphHandle> graphs,
+    absl::Span<const ConditionBuilder> builders) {
+  std::vector<CommandBuffer> cmd_buffers;
+
+  // Conditional command buffers always created in nested mode and with
+  // underlying graphs owned by a conditional node.
+  CommandBuffer::Mode nested = CommandBuffer::Mode::kNested;
+  bool is_owned_graph = false;
+
+  for (size_t i = 0; i < handles.size(); ++i) {
+    auto command_buffer_impl = parent_->GetCommandBufferImplementation(
+        nested, graphs[i], is_owned_graph);
+
+    auto command_buffer =
+        CommandBuffer::Wrap(executor, std::move(command_buffer_impl));
+
+    TF_RETURN_IF_ERROR(builders[i](&command_buffer, handles[i]));
+    TF_RETURN_IF_ERROR(command_buffer.Finalize());
+
+    cmd_buffers.push_back(std::move(command_buffer));
+  }
+
+  return cmd_buffers;
+}
+
+tsl::Status GpuCommandBuffer::UpdateConditionalCommandBuffers(
+    absl::Span<const GpuGraphConditionalHandle> handles,
+    absl::Span<CommandBuffer> command_buffers,
+    absl::Span<const ConditionBuilder> builders) {
+  for (size_t i = 0; i < command_buffers.size(); ++i) {
+    // Use parent graph executable for conditional command buffer update.
+    ScopedGpuGraphExec scoped_exec(Cast(&command_buffers[i]), exec_);
+
+    // Update command buffer using user-provided builder callback.
+    TF_RETURN_IF_ERROR(command_buffers[i].Update());
+    TF_RETURN_IF_ERROR(builders[i](&command_buffers[i], handles[i]));
+    TF_RETURN_IF_ERROR(command_buffers[i].Finalize());
+  }
+  return tsl::OkStatus();
+}
+
+tsl::Status GpuCommandBuffer::CreateConditionalCommand(
+    StreamExecutor* executor, ConditionType type, SetConditionFn set_condition,
+    absl::Span<const ConditionBuilder> builders) {
+  DCHECK(executor->implementation() == parent_);  // NOLINT
+  TF_RETURN_IF_ERROR(CheckNotFinalized());
 
-    // Wrap conditional graph into command buffer and pass it to the builder.
-    auto then_cmd_buffer = CommandBuffer::Wrap(
-        executor, parent_->GetCommandBufferImplementation(
-                      nested, then_graph, /*is_owned_graph=*/false));
-    TF_RETURN_IF_ERROR(then_builder(&then_cmd_buffer));
-    TF_RETURN_IF_ERROR(then_cmd_buffer.Finalize());
+  if (state_ == State::kCreate) {
+    // Every conditional command buffer is controlled by its own handle.
+    TF_ASSIGN_OR_RETURN(auto handles,
+                        CreateConditionalHandles(builders.size()));
 
-    // Keep track of conditional handle and command buffers for update.
-    auto& command_buffers = conditional_command_buffers_.emplace_back();
-    command_buffers.Add(handle, std::move(then_cmd_buffer));
+    // Add a kernel to update conditional handles values.
+    TF_RETURN_IF_ERROR(set_condition(handles));
+
+    // Add conditional nodes to the graph.
+    TF_ASSIGN_OR_RETURN(auto graphs, CreateConditionalNodes(type, handles));
+
+    // Construct conditional command buffers.
+    TF_ASSIGN_OR_RETURN(auto cmd_buffers, CreateConditionalCommandBuffers(
+                                              executor, handles, graphs,
+                                              builders));
+
+    // Keep track of created conditional handles and command buffers.
+    ConditionalCommandBuffers& cond_cmd_buffers =
+        conditional_command_buffers_.emplace_back();
+    for (size_t i = 0; i < handles.size(); ++i) {
+      cond_cmd_buffers.Add(handles[i], std::move(cmd_buffers[i]));
+    }
 
     return tsl::OkStatus();
   }
@@ -331,36 +411,145 @@ tsl::Status GpuCommandBuffer::If(StreamExecutor* executor,
         conditional_command_buffers_[update_state_.conditional_idx++];
 
     // Sanity check that we got the correct conditional command buffers.
-    if (cond_cmd_buffers.handles.size() != 1 ||
-        cond_cmd_buffers.command_buffers.size() != 1) {
-      return absl::InternalError(
-          "`If` command expected one conditional command buffer");
+    if (cond_cmd_buffers.handles.size() != builders.size() ||
+        cond_cmd_buffers.command_buffers.size() != builders.size()) {
+      return absl::InternalError(absl::StrCat(
+          "Conditional command expected ", builders.size(),
+          " conditional command buffers, got ",
+          cond_cmd_buffers.command_buffers.size()));
     }
 
-    GpuGraphConditionalHandle& handle = cond_cmd_buffers.handles[0];
-    CommandBuffer& then_cmd_buffer = cond_cmd_buffers.command_buffers[0];
+    // Update a kernel that updates conditional handles values.
+    TF_RETURN_IF_ERROR(set_condition(cond_cmd_buffers.handles));
 
-    // Update a kernel that updates conditional handle based on a predicate.
-    TF_RETURN_IF_ERROR(
-        Launch(set_condition, ThreadDim(), BlockDim(), handle, predicate));
+    // Conditional handles created only when we add conditional nodes first
+    // time and then owned by a `graph_`. We also don't need to update
+    // conditional nodes themselves, as they reuse the same handles.
+    update_state_.node_idx += cond_cmd_buffers.handles.size();
 
-    // Conditional handle created only when we add conditional node first time
-    // and then owned by a `graph_`. We also don't need to update conditional
-    // node itself, as it reuses the same handle.
-    update_state_.node_idx++;  // skip conditional node
+    // Update conditional command buffers.
+    return UpdateConditionalCommandBuffers(
+        cond_cmd_buffers.handles,
+        absl::MakeSpan(cond_cmd_buffers.command_buffers), builders);
+  }
 
-    // Use parent graph executable for conditional command buffer update.
-    ScopedGpuGraphExec scoped_exec(Cast(&then_cmd_buffer), exec_);
+  return UnsupportedStateError(state_);
+}
+
+tsl::Status GpuCommandBuffer::If(StreamExecutor* executor,
+                                 DeviceMemory<bool> predicate,
+                                 CommandBuffer::Builder then_builder) {
+  SetIfConditionKernel set_if_condition(executor);
+  TF_RETURN_IF_ERROR(LoadConditionKernel(executor, GetSetIfConditionKernel(),
+                                         "set_if_condition",
+                                         &set_if_condition));
 
-    // Update `then` command buffer using user-provided builder callback.
-    TF_RETURN_IF_ERROR(then_cmd_buffer.Update());
-    TF_RETURN_IF_ERROR(then_builder(&then_cmd_buffer));
-    TF_RETURN_IF_ERROR(then_cmd_buffer.Finalize());
+  auto set_cond_fn = [&](absl::Span<const GpuGraphConditionalHandle> handles) {
+    return Launch(set_if_condition, ThreadDim(), BlockDim(), handles[0],
+                  predicate);
+  };
 
-    return tsl::OkStatus();
+  std::array<ConditionBuilder, 1> builders = {
+      ToConditionBuilder(std::move(then_builder))};
+
+  return CreateConditionalCommand(executor, ConditionType::kIf, set_cond_fn,
+                                  builders);
+}
+
+tsl::Status GpuCommandBuffer::IfElse(StreamExecutor* executor,
+                                     DeviceMemory<bool> predicate,
+                                     CommandBuffer::Builder then_builder,
+                                     CommandBuffer::Builder else_builder) {
+  SetIfElseConditionKernel set_if_else_condition(executor);
+  TF_RETURN_IF_ERROR(LoadConditionKernel(executor,
+                                         GetSetIfElseConditionKernel(),
+                                         "set_if_else_condition",
+                                         &set_if_else_condition));
+
+  auto set_cond_fn = [&](absl::Span<const GpuGraphConditionalHandle> handles) {
+    return Launch(set_if_else_condition, ThreadDim(), BlockDim(), handles[0],
+                  handles[1], predicate);
+  };
+
+  std::array<ConditionBuilder, 2> builders = {
+      ToConditionBuilder(std::move(then_builder)),
+      ToConditionBuilder(std::move(else_builder))};
+
+  return CreateConditionalCommand(executor, ConditionType::kIf, set_cond_fn,
+                                  builders);
+}
+
+tsl::Status GpuCommandBuffer::Case(
+    StreamExecutor* executor, DeviceMemory<int32_t> index,
+    std::vector<CommandBuffer::Builder> branches) {
+  if (branches.empty() || branches.size() > kMaxCaseBranches) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Case command supports from 1 to ", kMaxCaseBranches,
+                     " branches, got: ", branches.size()));
   }
 
-  return UnsupportedStateError(state_);
+  SetCaseConditionKernel set_case_condition(executor);
+  TF_RETURN_IF_ERROR(LoadConditionKernel(executor, GetSetCaseConditionKernel(),
+                                         "set_case_condition",
+                                         &set_case_condition));
+
+  auto set_cond_fn = [&](absl::Span<const GpuGraphConditionalHandle> handles) {
+    int32_t num_handles = handles.size();
+
+    // Pad handles up to the kernel arity with the first one, the kernel only
+    // updates the first `num_handles` handles.
+    std::array<GpuGraphConditionalHandle, kMaxCaseBranches> padded_handles;
+    for (int32_t i = 0; i < kMaxCaseBranches; ++i) {
+      padded_handles[i] = handles[i < num_handles ? i : 0];
+    }
+
+    return Launch(set_case_condition, ThreadDim(), BlockDim(),
+                  padded_handles[0], padded_handles[1], padded_handles[2],
+                  padded_handles[3], padded_handles[4], padded_handles[5],
+                  padded_handles[6], padded_handles[7], index, num_handles);
+  };
+
+  std::vector<ConditionBuilder> builders;
+  builders.reserve(branches.size());
+  for (CommandBuffer::Builder& branch : branches) {
+    builders.push_back(ToConditionBuilder(std::move(branch)));
+  }
+
+  return CreateConditionalCommand(executor, ConditionType::kIf, set_cond_fn,
+                                  builders);
+}
+
+tsl::Status GpuCommandBuffer::While(StreamExecutor* executor,
+                                    DeviceMemory<bool> predicate,
+                                    CommandBuffer::Builder cond_builder,
+                                    CommandBuffer::Builder body_builder) {
+  SetWhileConditionKernel set_while_condition(executor);
+  TF_RETURN_IF_ERROR(LoadConditionKernel(executor,
+                                         GetSetWhileConditionKernel(),
+                                         "set_while_condition",
+                                         &set_while_condition));
+
+  // The initial value of the predicate was computed by `cond_builder` commands
+  // recorded into this command buffer by `CommandBuffer::While`.
+  auto set_cond_fn = [&](absl::Span<const GpuGraphConditionalHandle> handles) {
+    return Launch(set_while_condition, ThreadDim(), BlockDim(), handles[0],
+                  predicate);
+  };
+
+  // The conditional command buffer runs the body, and then updates the
+  // predicate and the conditional handle for the next iteration.
+  ConditionBuilder body = [&](CommandBuffer* body_cmd_buffer,
+                              GpuGraphConditionalHandle handle) {
+    TF_RETURN_IF_ERROR(body_builder(body_cmd_buffer));
+    TF_RETURN_IF_ERROR(cond_builder(body_cmd_buffer));
+    return body_cmd_buffer->Launch(set_while_condition, ThreadDim(),
+                                   BlockDim(), handle, predicate);
+  };
+
+  std::array<ConditionBuilder, 1> builders = {std::move(body)};
+
+  return CreateConditionalCommand(executor, ConditionType::kWhile, set_cond_fn,
+                                  builders);
 }
 
 tsl::Status GpuCommandBuffer::Finalize() {
@@ -16,14 +16,18 @@ limitations under the License.
 #ifndef XLA_STREAM_EXECUTOR_GPU_GPU_COMMAND_BUFFER_H_
 #define XLA_STREAM_EXECUTOR_GPU_GPU_COMMAND_BUFFER_H_
 
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <type_traits>
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/types/span.h"
 #include "xla/stream_executor/command_buffer.h"
 #include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/gpu/gpu_driver.h"
 #include "xla/stream_executor/gpu/gpu_executor.h"
 #include "xla/stream_executor/gpu/gpu_types.h"
 #include "xla/stream_executor/kernel.h"
@@ -31,6 +35,7 @@ limitations under the License.
 #include "xla/stream_executor/stream_executor_internal.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/status.h"
+#include "tsl/platform/statusor.h"
 
 namespace stream_executor::gpu {
 
@@ -57,6 +62,17 @@ class GpuCommandBuffer : public internal::CommandBufferInterface {
   tsl::Status If(StreamExecutor* executor, DeviceMemory<bool> predicate,
                  CommandBuffer::Builder then_builder) override;
 
+  tsl::Status IfElse(StreamExecutor* executor, DeviceMemory<bool> predicate,
+                     CommandBuffer::Builder then_builder,
+                     CommandBuffer::Builder else_builder) override;
+
+  tsl::Status Case(StreamExecutor* executor, DeviceMemory<int32_t> index,
+                   std::vector<CommandBuffer::Builder> branches) override;
+
+  tsl::Status While(StreamExecutor* executor, DeviceMemory<bool> predicate,
+                    CommandBuffer::Builder cond_builder,
+                    CommandBuffer::Builder body_builder) override;
+
   tsl::Status Finalize() override;
   tsl::Status Update() override;
 
@@ -97,10 +113,41 @@ class GpuCommandBuffer : public internal::CommandBufferInterface {
  private:
   using Dependencies = absl::InlinedVector<GpuGraphNodeHandle, 1>;
 
-  // A signature of a device kernels updating conditional handle.
-  using SetConditionKernel =
+  // The maximum number of branches of a `Case` command.
+  static constexpr int32_t kMaxCaseBranches = 8;
+
+  // Signatures of the device kernels updating conditional handles.
+  using SetIfConditionKernel =
       TypedKernel<GpuGraphConditionalHandle, DeviceMemory<bool>>;
 
+  using SetIfElseConditionKernel =
+      TypedKernel<GpuGraphConditionalHandle, GpuGraphConditionalHandle,
+                  DeviceMemory<bool>>;
+
+  using SetCaseConditionKernel =
+      TypedKernel<GpuGraphConditionalHandle, GpuGraphConditionalHandle,
+                  GpuGraphConditionalHandle, GpuGraphConditionalHandle,
+                  GpuGraphConditionalHandle, GpuGraphConditionalHandle,
+                  GpuGraphConditionalHandle, GpuGraphConditionalHandle,
+                  DeviceMemory<int32_t>, int32_t>;
+
+  using SetWhileConditionKernel =
+      TypedKernel<GpuGraphConditionalHandle, DeviceMemory<bool>>;
+
+  using ConditionType = GpuDriver::GpuGraphConditionalNodeParams::Type;
+
+  // A callback to launch a kernel that updates the values of conditional
+  // handles, from device memory.
+  using SetConditionFn = std::function<tsl::Status(
+      absl::Span<const GpuGraphConditionalHandle>)>;
+
+  // An extension of `CommandBuffer::Builder` for building the command buffer
+  // of a conditional handle.
+  using ConditionBuilder =
+      std::function<tsl::Status(CommandBuffer*, GpuGraphConditionalHandle)>;
+
+  static ConditionBuilder ToConditionBuilder(CommandBuffer::Builder builder);
+
   // Overwrites the `exec_` handle in a Gpu command buffer by `exec`, and
   // restores to the original handle when destroyed. This allows us updating
   // primary graph executable using nested command buffers (command buffers that
@@ -124,6 +171,33 @@ class GpuCommandBuffer : public internal::CommandBufferInterface {
     std::vector<CommandBuffer> command_buffers;
   };
 
+  // Adds a conditional command of `type`, with a conditional command buffer
+  // built by each of `builders`, and a kernel launched by `set_condition` that
+  // enables them before the conditional nodes.
+  tsl::Status CreateConditionalCommand(
+      StreamExecutor* executor, ConditionType type,
+      SetConditionFn set_condition,
+      absl::Span<const ConditionBuilder> builders);
+
+  tsl::StatusOr<std::vector<GpuGraphConditionalHandle>>
+  CreateConditionalHandles(size_t num_handles);
+
+  // Adds a conditional node for each of `handles` to the graph, and returns
+  // their conditional graphs.
+  tsl::StatusOr<std::vector<GpuGraphHandle>> CreateConditionalNodes(
+      ConditionType type, absl::Span<const GpuGraphConditionalHandle> handles);
+
+  tsl::StatusOr<std::vector<CommandBuffer>> CreateConditionalCommandBuffers(
+      StreamExecutor* executor,
+      absl::Span<const GpuGraphConditionalHandle> handles,
+      absl::Span<const GpuGraphHandle> graphs,
+      absl::Span<const ConditionBuilder> builders);
+
+  tsl::Status UpdateConditionalCommandBuffers(
+      absl::Span<const GpuGraphConditionalHandle> handles,
+      absl::Span<CommandBuffer> command_buffers,
+      absl::Span<const ConditionBuilder> builders);
+
   // TODO(ezhulenev): Currently we serialize all Gpu nodes by adding a
   // dependency between all nodes added to a command buffer. We need a concept
   // of a barrier at a command buffer level.
@@ -197,7 +271,10 @@ inline tsl::Status GpuCommandBuffer::Launch(
 // values, and allow implementing on-device control flow via conditional command
 // buffers.
 
-void* GetSetConditionKernel();
+void* GetSetIfConditionKernel();
+void* GetSetIfElseConditionKernel();
+void* GetSetCaseConditionKernel();
+void* GetSetWhileConditionKernel();
 
 }  // namespace stream_executor::gpu
 
@@ -19,14 +19,29 @@ namespace stream_executor {
 namespace rocm {
 namespace {
 
-__global__ void SetCondition() {}
+__global__ void SetIfCondition() {}
+__global__ void SetIfElseCondition() {}
+__global__ void SetCaseCondition() {}
+__global__ void SetWhileCondition() {}
 
 }  // namespace
 }  // namespace rocm
 
 namespace gpu {
-void* GetSetConditionKernel() {
-  return reinterpret_cast<void*>(&rocm::SetCondition);
+void* GetSetIfConditionKernel() {
+  return reinterpret_cast<void*>(&rocm::SetIfCondition);
+}
+
+void* GetSetIfElseConditionKernel() {
+  return reinterpret_cast<void*>(&rocm::SetIfElseCondition);
+}
+
+void* GetSetCaseConditionKernel() {
+  return reinterpret_cast<void*>(&rocm::SetCaseCondition);
+}
+
+void* GetSetWhileConditionKernel() {
+  return reinterpret_cast<void*>(&rocm::SetWhileCondition);
 }
 }  // namespace gpu
 
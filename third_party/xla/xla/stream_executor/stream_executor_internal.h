@@ -150,6 +150,30 @@ class CommandBufferInterface {
   virtual tsl::Status If(StreamExecutor* executor, DeviceMemory<bool> predicate,
                          CommandBuffer::Builder then_builder) = 0;
 
+  // Adds a conditional operation that will run a command buffer constructed by
+  // `then_builder` if `predicate` value is `true`, or a command buffer
+  // constructed by `else_builder` if `predicate` is `false`.
+  virtual tsl::Status IfElse(StreamExecutor* executor,
+                             DeviceMemory<bool> predicate,
+                             CommandBuffer::Builder then_builder,
+                             CommandBuffer::Builder else_builder) = 0;
+
+  // Adds a conditional operation that will run a command buffer constructed by
+  // the `branches` builder at `index`. If `index` is out of range, then it
+  // will run a command buffer constructed by the last builder.
+  virtual tsl::Status Case(StreamExecutor* executor,
+                           DeviceMemory<int32_t> index,
+                           std::vector<CommandBuffer::Builder> branches) = 0;
+
+  // Adds a conditional operation that will run command buffers constructed by
+  // `body_builder` and `cond_builder` while `predicate` value is `true`. The
+  // commands of `cond_builder` must already be recorded into *this, to compute
+  // the initial value of `predicate` (see CommandBuffer::While).
+  virtual tsl::Status While(StreamExecutor* executor,
+                            DeviceMemory<bool> predicate,
+                            CommandBuffer::Builder cond_builder,
+                            CommandBuffer::Builder body_builder) = 0;
+
   // Finalizes command buffer and makes it executable. Once command buffer is
   // finalized no commands can be added to it.
   virtual tsl::Status Finalize() = 0;
@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if defined(INTEL_MKL) && defined(ENABLE_ONEDNN_V3)
+
+#include "xla/test.h"
+#include "xla/tests/hlo_test_base.h"
+#include "xla/tests/test_macros.h"
+
+namespace xla {
+namespace cpu {
+
+class ConvolutionTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_enable_onednn_fusion(true);
+    return debug_options;
+  }
+
+  const char* conv_rewrite_str_ = R"(
+  ; CHECK: custom_call_target="__onednn$convolution"
+  )";
+  const char* fused_conv_bias_relu_ = R"(
+  ; CHECK: custom_call_target="__onednn$convolution"
+  ; CHECK-SAME: "fused_ops":["BIAS","RELU"]
+  )";
+};
+
+TEST_F(ConvolutionTest, Simple2DTestF32) {
+  const char* convolution_module_str = R"(
+  HloModule convolution.test.f32
+
+  ENTRY convolution.test.f32 {
+    arg.0 = f32[1,22,22,1]{3,2,1,0} parameter(0)
+    arg.1 = f32[8,8,1,1]{3,2,1,0} parameter(1)
+    ROOT convolution = f32[1,11,11,1]{3,2,1,0} convolution(arg.0, arg.1), window={size=8x8 stride=2x2 pad=3_3x3_3}, dim_labels=b01f_01io->b01f
+  })";
+
+  EXPECT_TRUE(RunAndCompare(convolution_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(convolution_module_str, conv_rewrite_str_);
+}
+
+TEST_F(ConvolutionTest, Simple3DTestF32) {
+  const char* convolution_module_str = R"(
+  HloModule convolution.test.f32
+
+  ENTRY convolution.test.f32 {
+    arg.0 = f32[2,3,3,3,4]{4,3,2,1,0} parameter(0)
+    arg.1 = f32[2,2,2,4,5]{4,3,2,1,0} parameter(1)
+    ROOT convolution = f32[2,3,3,3,5]{4,3,2,1,0} convolution(arg.0, arg.1), window={size=2x2x2 pad=0_1x0_1x0_1 rhs_dilate=1x1x1}, dim_labels=b012f_012io->b012f
+  })";
+
+  EXPECT_TRUE(RunAndCompare(convolution_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(convolution_module_str, conv_rewrite_str_);
+}
+
+TEST_F(ConvolutionTest, BiasAddReluFusionF32) {
+  const char* convolution_module_str = R"(
+  HloModule convolution.bias.relu.f32
+
+  ENTRY convolution.bias.relu.f32 {
+    arg.0 = f32[4,16,16,8]{3,2,1,0} parameter(0)
+    arg.1 = f32[3,3,8,16]{3,2,1,0} parameter(1)
+    arg.2 = f32[16]{0} parameter(2)
+    convolution = f32[4,16,16,16]{3,2,1,0} convolution(arg.0, arg.1), window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f
+    bias = f32[4,16,16,16]{3,2,1,0} broadcast(arg.2), dimensions={3}
+    add = f32[4,16,16,16]{3,2,1,0} add(convolution, bias)
+    zero = f32[] constant(0)
+    zeros = f32[4,16,16,16]{3,2,1,0} broadcast(zero), dimensions={}
+    ROOT relu = f32[4,16,16,16]{3,2,1,0} maximum(add, zeros)
+  })";
+
+  EXPECT_TRUE(RunAndCompare(convolution_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(convolution_module_str, fused_conv_bias_relu_);
+}
+
+TEST_F(ConvolutionTest, GroupedConvolutionIsNotRewritten) {
+  const char* convolution_module_str = R"(
+  HloModule convolution.grouped.f32
+
+  ENTRY convolution.grouped.f32 {
+    arg.0 = f32[1,8,8,4]{3,2,1,0} parameter(0)
+    arg.1 = f32[3,3,2,4]{3,2,1,0} parameter(1)
+    ROOT convolution = f32[1,8,8,4]{3,2,1,0} convolution(arg.0, arg.1), window={size=3x3 pad=1_1x1_1}, dim_labels=b01f_01io->b01f, feature_group_count=2
+  })";
+
+  EXPECT_TRUE(RunAndCompare(convolution_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(convolution_module_str, R"(
+  ; CHECK-NOT: custom_call_target="__onednn$convolution"
+  )");
+}
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // INTEL_MKL && ENABLE_ONEDNN_V3
@@ -28,7 +28,27 @@ limitations under the License.
 namespace xla {
 namespace cpu {
 
-class MatmulTest : public HloTestBase {};
+class MatmulTest : public HloTestBase {
+ protected:
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = HloTestBase::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_enable_onednn_fusion(true);
+    return debug_options;
+  }
+
+  const char* fused_matmul_bias_ = R"(
+  ; CHECK: custom_call_target="__onednn$matmul"
+  ; CHECK-SAME: "fused_ops":["BIAS"]
+  )";
+  const char* fused_matmul_bias_relu_ = R"(
+  ; CHECK: custom_call_target="__onednn$matmul"
+  ; CHECK-SAME: "fused_ops":["BIAS","RELU"]
+  )";
+  const char* fused_matmul_binary_add_ = R"(
+  ; CHECK: custom_call_target="__onednn$matmul"
+  ; CHECK-SAME: "fused_ops":["BINARY_ADD"]
+  )";
+};
 
 TEST_F(MatmulTest, SimpleTestF32) {
   const char* matmul_module_str = R"(
@@ -77,6 +97,73 @@ TEST_F(MatmulTest, SimpleTestF32TransposeB) {
   EXPECT_TRUE(RunAndCompare(matmul_module_str, ErrorSpec{1e-4, 1e-4}));
 }
 
+TEST_F(MatmulTest, BiasAddFusionF32) {
+  const char* matmul_module_str = R"(
+  HloModule matmul.bias.f32
+
+  ENTRY matmul.bias.f32 {
+    arg.0 = f32[32,64]{1,0} parameter(0)
+    arg.1 = f32[64,16]{1,0} parameter(1)
+    arg.2 = f32[16]{0} parameter(2)
+    dot = f32[32,16]{1,0} dot(arg.0, arg.1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    bias = f32[32,16]{1,0} broadcast(arg.2), dimensions={1}
+    ROOT add = f32[32,16]{1,0} add(dot, bias)
+  })";
+
+  EXPECT_TRUE(RunAndCompare(matmul_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(matmul_module_str, fused_matmul_bias_);
+}
+
+TEST_F(MatmulTest, BiasAddReluFusionF32) {
+  const char* matmul_module_str = R"(
+  HloModule matmul.bias.relu.f32
+
+  ENTRY matmul.bias.relu.f32 {
+    arg.0 = f32[2,8,4,16]{3,2,1,0} parameter(0)
+    arg.1 = f32[2,8,16,32]{3,2,1,0} parameter(1)
+    arg.2 = f32[32]{0} parameter(2)
+    dot = f32[2,8,4,32]{3,2,1,0} dot(arg.0, arg.1), lhs_batch_dims={0,1}, lhs_contracting_dims={3}, rhs_batch_dims={0,1}, rhs_contracting_dims={2}
+    bias = f32[2,8,4,32]{3,2,1,0} broadcast(arg.2), dimensions={3}
+    add = f32[2,8,4,32]{3,2,1,0} add(dot, bias)
+    zero = f32[] constant(0)
+    zeros = f32[2,8,4,32]{3,2,1,0} broadcast(zero), dimensions={}
+    ROOT relu = f32[2,8,4,32]{3,2,1,0} maximum(add, zeros)
+  })";
+
+  EXPECT_TRUE(RunAndCompare(matmul_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(matmul_module_str, fused_matmul_bias_relu_);
+}
+
+TEST_F(MatmulTest, ResidualAddFusionF32) {
+  const char* matmul_module_str = R"(
+  HloModule matmul.residual.f32
+
+  ENTRY matmul.residual.f32 {
+    arg.0 = f32[32,64]{1,0} parameter(0)
+    arg.1 = f32[64,64]{1,0} parameter(1)
+    dot = f32[32,64]{1,0} dot(arg.0, arg.1), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    ROOT add = f32[32,64]{1,0} add(arg.0, dot)
+  })";
+
+  EXPECT_TRUE(RunAndCompare(matmul_module_str, ErrorSpec{1e-4, 1e-4}));
+  MatchOptimizedHlo(matmul_module_str, fused_matmul_binary_add_);
+}
+
+TEST_F(MatmulTest, ConstantWeightsF32) {
+  // The weights are reordered once, and reused by the second execution.
+  const char* matmul_module_str = R"(
+  HloModule matmul.constant.f32
+
+  ENTRY matmul.constant.f32 {
+    arg.0 = f32[4,3]{1,0} parameter(0)
+    weights = f32[3,2]{1,0} constant({{1, 2}, {3, 4}, {5, 6}})
+    ROOT dot = f32[4,2]{1,0} dot(arg.0, weights), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+  })";
+
+  EXPECT_TRUE(RunAndCompare(matmul_module_str, ErrorSpec{1e-4, 1e-4}));
+  EXPECT_TRUE(RunAndCompare(matmul_module_str, ErrorSpec{1e-4, 1e-4}));
+}
+
 }  // namespace cpu
 }  // namespace xla
 